@@ -35,6 +35,10 @@ elseif(SSE3_FOUND)
     set(SIMD_FLAG ${SSE3_FLAG})
 endif()
 
+if(WITH_NEON AND NEON_FOUND)
+    add_definitions(-DPADDLE_WITH_NEON)
+endif()
+
 if(WIN32)
   # windows header option for all targets.
   add_definitions(-D_XKEYCHECK_H)
@@ -95,5 +95,19 @@ int main()
     return 0;
 }" AVX512F_FOUND)
 
+# Check NEON, which is always there on aarch64, the kernels use the
+# aarch64 only intrinsics.
+set(CMAKE_REQUIRED_FLAGS "")
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "aarch64|arm64")
+CHECK_CXX_SOURCE_COMPILES("
+#include <arm_neon.h>
+int main()
+{
+    float32x4_t a = vdupq_n_f32(1.0f);
+    float32x4_t result = vrndmq_f32(vfmaq_f32(a, a, a));
+    return static_cast<int>(vaddvq_f32(result));
+}" NEON_FOUND)
+endif()
+
 set(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_RETAINED})
-mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND)
+mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND NEON_FOUND)
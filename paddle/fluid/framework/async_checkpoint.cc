@@ -0,0 +1,164 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/async_checkpoint.h"
+#include <gflags/gflags.h>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/port.h"
+#include "paddle/fluid/string/string_helper.h"
+
+DEFINE_bool(async_checkpoint, false,
+            "Whether the save and save_combine ops write the files in the "
+            "background. If true, the ops copy the variables to the host "
+            "memory and return, and the files are written by the IO threads. "
+            "Call fluid.io.wait_async_checkpoints to wait for the files.");
+
+namespace paddle {
+namespace framework {
+
+void SnapshotTensor(const Tensor& src, Tensor* dst) {
+  src.check_memory_size();
+  dst->Resize(src.dims());
+  dst->set_layout(src.layout());
+  size_t size = src.numel() * SizeOfType(src.type());
+  if (platform::is_gpu_place(src.place())) {
+#ifdef PADDLE_WITH_CUDA
+    platform::CUDAPinnedPlace pinned;
+    auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(src.place()));
+    memory::Copy(pinned, dst->mutable_data(pinned, src.type()),
+                 BOOST_GET_CONST(platform::CUDAPlace, src.place()),
+                 src.data<void>(), size, dev_ctx->stream());
+    dev_ctx->Wait();
+#else
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "CUDAPlace is not supported when not compiled with CUDA."));
+#endif
+  } else {
+    std::memcpy(dst->mutable_data(platform::CPUPlace(), src.type()),
+                src.data<void>(), size);
+  }
+}
+
+AsyncCheckpointWriter& AsyncCheckpointWriter::Instance() {
+  static AsyncCheckpointWriter writer;
+  return writer;
+}
+
+void AsyncCheckpointWriter::Write(const std::string& path, WriteFn write_fn) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [&] { return pending_.count(path) == 0; });
+    pending_.insert(path);
+  }
+  VLOG(3) << "Write the checkpoint file " << path << " asynchronously.";
+  ThreadPoolIO::GetInstanceIO()->Run(
+      [this, path, write_fn] { Run(path, write_fn); });
+}
+
+void AsyncCheckpointWriter::Run(const std::string& path,
+                                const WriteFn& write_fn) {
+  std::string error;
+  std::string tmp_path = path + ".tmp";
+  try {
+    MkDirRecursively(DirName(path).c_str());
+    std::ofstream fout(tmp_path, std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Cannot open %s to save variables.", tmp_path));
+    write_fn(&fout);
+    fout.close();
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Failed to write the variables to %s.", tmp_path));
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    PADDLE_ENFORCE_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0,
+                      platform::errors::Unavailable(
+                          "Failed to rename %s to %s.", tmp_path, path));
+  } catch (const std::exception& e) {
+    error = e.what();
+    std::remove(tmp_path.c_str());
+    LOG(WARNING) << "Failed to write the checkpoint file " << path << ": "
+                 << error;
+  }
+
+  std::map<int, Callback> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks = callbacks_;
+  }
+  for (auto& callback : callbacks) {
+    callback.second(path, error);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(path);
+    if (error.empty()) {
+      errors_.erase(path);
+    } else {
+      errors_[path] = error;
+    }
+  }
+  finished_.notify_all();
+}
+
+void AsyncCheckpointWriter::Wait(const std::string& path) {
+  std::vector<std::string> errors;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [&] {
+      return path.empty() ? pending_.empty() : pending_.count(path) == 0;
+    });
+    for (auto it = errors_.begin(); it != errors_.end();) {
+      if (path.empty() || it->first == path) {
+        errors.push_back(it->first + ": " + it->second);
+        it = errors_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  PADDLE_ENFORCE_EQ(errors.empty(), true,
+                    platform::errors::Unavailable(
+                        "Failed to write the checkpoint files:\n%s",
+                        string::join_strings(errors, '\n')));
+}
+
+bool AsyncCheckpointWriter::IsPending(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.count(path) > 0;
+}
+
+int AsyncCheckpointWriter::AddCallback(Callback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callbacks_.emplace(next_callback_id_, std::move(callback));
+  return next_callback_id_++;
+}
+
+void AsyncCheckpointWriter::RemoveCallback(int id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callbacks_.erase(id);
+}
+
+}  // namespace framework
+}  // namespace paddle
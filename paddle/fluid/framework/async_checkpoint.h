@@ -0,0 +1,82 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace framework {
+
+// Copy the tensor to the host memory, in the pinned memory if it is on the
+// GPU, and wait for the copy. Unlike TensorCopy, the memory is never shared
+// copy-on-write, since a parameter may share its memory with the fused
+// buffer which the optimizer ops write.
+void SnapshotTensor(const Tensor& src, Tensor* dst);
+
+/*
+ * Writes the checkpoint files on the IO threads, so that the save ops of
+ * FLAGS_async_checkpoint only take a snapshot of the variables in host
+ * memory and return. Each file is written to <path>.tmp and renamed to
+ * <path> when it is complete, so a reader finds either the old file or the
+ * complete new one.
+ */
+class AsyncCheckpointWriter {
+ public:
+  // Called on the IO thread when a file is written, the error is empty if
+  // the file is written successfully.
+  using Callback =
+      std::function<void(const std::string& path, const std::string& error)>;
+  using WriteFn = std::function<void(std::ostream* os)>;
+
+  static AsyncCheckpointWriter& Instance();
+
+  // Write the file in the background. The writes of the same path are kept
+  // in order, a write waits if the previous one of the path is pending.
+  void Write(const std::string& path, WriteFn write_fn);
+
+  // Wait for the pending write of the path, or all the pending writes if the
+  // path is empty. Throw the errors of the writes waited for, each error is
+  // thrown once.
+  void Wait(const std::string& path = "");
+
+  bool IsPending(const std::string& path);
+
+  // Return the id to remove the callback.
+  int AddCallback(Callback callback);
+  void RemoveCallback(int id);
+
+ private:
+  AsyncCheckpointWriter() = default;
+
+  void Run(const std::string& path, const WriteFn& write_fn);
+
+  std::mutex mutex_;
+  std::condition_variable finished_;
+  std::unordered_set<std::string> pending_;
+  std::map<std::string, std::string> errors_;
+  std::map<int, Callback> callbacks_;
+  int next_callback_id_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,78 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/async_checkpoint.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <string>
+#include <vector>
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/port.h"
+
+namespace paddle {
+namespace framework {
+
+static std::string ReadFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::binary);
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  return ss.str();
+}
+
+TEST(AsyncCheckpointWriter, write_and_wait) {
+  auto& writer = AsyncCheckpointWriter::Instance();
+  std::vector<std::string> written;
+  std::mutex mutex;
+  int id = writer.AddCallback(
+      [&](const std::string& path, const std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) written.push_back(path);
+      });
+
+  for (int i = 0; i < 3; ++i) {
+    // the writes of the same path are in order
+    writer.Write("async_checkpoint_test/a", [i](std::ostream* os) {
+      *os << "a" << i;
+    });
+  }
+  writer.Write("async_checkpoint_test/b",
+               [](std::ostream* os) { *os << "b"; });
+  writer.Wait();
+
+  EXPECT_FALSE(writer.IsPending("async_checkpoint_test/a"));
+  EXPECT_EQ(ReadFile("async_checkpoint_test/a"), "a2");
+  EXPECT_EQ(ReadFile("async_checkpoint_test/b"), "b");
+  EXPECT_FALSE(FileExists("async_checkpoint_test/a.tmp"));
+  EXPECT_EQ(written.size(), 4UL);
+  writer.RemoveCallback(id);
+}
+
+TEST(AsyncCheckpointWriter, error) {
+  auto& writer = AsyncCheckpointWriter::Instance();
+  writer.Write("async_checkpoint_test/c", [](std::ostream* os) {
+    *os << "c";
+    PADDLE_THROW(platform::errors::Unavailable("Disk is full."));
+  });
+  EXPECT_THROW(writer.Wait("async_checkpoint_test/c"),
+               platform::EnforceNotMet);
+  // the failed file is not renamed, and the error is thrown once
+  EXPECT_FALSE(FileExists("async_checkpoint_test/c"));
+  EXPECT_FALSE(FileExists("async_checkpoint_test/c.tmp"));
+  writer.Wait();
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -29,8 +29,8 @@ VarDesc *BlockDesc::Var(const std::string &name) {
   if (it != vars_.end()) {
     return it->second.get();
   }
-  need_update_ = true;
-  auto *var = new VarDesc(name);
+  MarkUpdated();
+  auto *var = Own(new VarDesc(name));
   vars_[name].reset(var);
   return var;
 }
@@ -52,9 +52,9 @@ VarDesc *BlockDesc::RenameVar(const std::string &old_name,
   if (!this->HasVar(old_name)) {
     return nullptr;
   }
-  need_update_ = true;
+  MarkUpdated();
   auto *var = this->Var(old_name);
-  VarDesc *new_var = new VarDesc(*(var->Proto()));
+  VarDesc *new_var = Own(new VarDesc(*(var->Proto())));
   new_var->SetName(new_name);
   vars_[new_name].reset(new_var);
   // rename inputs and outputs
@@ -122,31 +122,33 @@ std::vector<VarDesc *> BlockDesc::AllVars() const {
 }
 
 OpDesc *BlockDesc::AppendOp() {
-  need_update_ = true;
-  ops_.emplace_back(new OpDesc(this));
+  MarkUpdated();
+  ops_.emplace_back(Own(new OpDesc(this)));
   return ops_.back().get();
 }
 
 void BlockDesc::AppendAllocatedOp(std::unique_ptr<OpDesc> &&op_desc) {
-  need_update_ = true;
+  MarkUpdated();
+  Own(op_desc.get());
   ops_.emplace_back(std::move(op_desc));
 }
 
 OpDesc *BlockDesc::PrependOp() {
-  need_update_ = true;
-  ops_.emplace_front(new OpDesc(this));
+  MarkUpdated();
+  ops_.emplace_front(Own(new OpDesc(this)));
   return ops_.front().get();
 }
 
 void BlockDesc::PrependAllocatedOp(std::unique_ptr<OpDesc> &&op_desc) {
-  need_update_ = true;
+  MarkUpdated();
+  Own(op_desc.get());
   ops_.emplace_front(std::move(op_desc));
 }
 
 OpDesc *BlockDesc::InsertOp(size_t index) {
-  need_update_ = true;
+  MarkUpdated();
   auto it = ops_.begin() + index;
-  std::unique_ptr<OpDesc> new_op(new OpDesc(this));
+  std::unique_ptr<OpDesc> new_op(Own(new OpDesc(this)));
   it = ops_.insert(it, std::move(new_op));
   return (*it).get();
 }
@@ -155,11 +157,12 @@ void BlockDesc::RemoveOp(size_t s, size_t e) {
   if (ops_.begin() + s >= ops_.end() || ops_.begin() + e > ops_.end()) {
     return;
   }
-  need_update_ = true;
+  MarkUpdated();
   ops_.erase(ops_.begin() + s, ops_.begin() + e);
 }
 
 void BlockDesc::RemoveOpInternal(const OpDesc *op_desc) {
+  MarkUpdated();
   // TODO(minqiyang): make this faster
   for (auto it = ops_.begin(); it != ops_.end(); ++it) {
     if (it->get() == op_desc) {
@@ -207,24 +210,26 @@ proto::BlockDesc *BlockDesc::Proto() {
 BlockDesc::BlockDesc(ProgramDesc *prog, proto::BlockDesc *desc)
     : prog_(prog), desc_(desc), need_update_(false) {
   for (const proto::VarDesc &var_desc : desc_->vars()) {
-    vars_[var_desc.name()].reset(new VarDesc(var_desc));
+    vars_[var_desc.name()].reset(Own(new VarDesc(var_desc)));
   }
   for (const proto::OpDesc &op_desc : desc_->ops()) {
-    ops_.emplace_back(new OpDesc(op_desc, this));
+    ops_.emplace_back(Own(new OpDesc(op_desc, this)));
   }
+  SetRevision(NextDescRevision());
 }
 
 BlockDesc::BlockDesc(const BlockDesc &other, proto::BlockDesc *desc,
                      ProgramDesc *prog)
     : prog_(prog), desc_(desc) {
-  need_update_ = true;
+  MarkUpdated();
   for (auto &op : other.ops_) {
-    ops_.emplace_back(new OpDesc(*op, this));
+    ops_.emplace_back(Own(new OpDesc(*op, this)));
   }
   for (auto &it : other.vars_) {
-    auto *var = new VarDesc(*it.second);
+    auto *var = Own(new VarDesc(*it.second));
     vars_[it.first].reset(var);
   }
+  SetRevision(NextDescRevision());
 }
 
 void BlockDesc::SetForwardBlockID(int32_t forward_block_id) {
@@ -234,6 +239,12 @@ void BlockDesc::SetForwardBlockID(int32_t forward_block_id) {
           "Block %d's parent block ID has been set to %d, cannot be set to %d.",
           desc_->idx(), desc_->forward_block_idx(), forward_block_id));
   desc_->set_forward_block_idx(forward_block_id);
+  MarkUpdated();
+}
+
+void BlockDesc::SetRevision(uint64_t revision) {
+  revision_ = revision;
+  prog_->SetRevision(revision);
 }
 
 BlockDesc *BlockDesc::ForwardBlock() const {
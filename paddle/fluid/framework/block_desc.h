@@ -95,7 +95,10 @@ class BlockDesc {
 
   void RemoveOpInternal(const OpDesc *op_desc);
 
-  void RemoveVar(const std::string &name) { vars_.erase(name); }
+  void RemoveVar(const std::string &name) {
+    MarkUpdated();
+    vars_.erase(name);
+  }
 
   std::vector<OpDesc *> AllOps() const;
 
@@ -109,10 +112,33 @@ class BlockDesc {
 
   ProgramDesc *Program() const { return this->prog_; }
 
+  // The latest revision of the block and its ops and vars, see
+  // NextDescRevision.
+  uint64_t Revision() const { return revision_; }
+
  private:
+  void MarkUpdated() {
+    need_update_ = true;
+    SetRevision(NextDescRevision());
+  }
+
+  // Called with the new revision of the block or any of its ops and vars,
+  // which is passed to the program.
+  void SetRevision(uint64_t revision);
+
+  template <typename DescType>
+  DescType *Own(DescType *desc) {
+    desc->owner_.set(this);
+    return desc;
+  }
+
+  friend class OpDesc;
+  friend class VarDesc;
+
   ProgramDesc *prog_;       // not_own
   proto::BlockDesc *desc_;  // not_own
   bool need_update_;
+  uint64_t revision_ = NextDescRevision();
 
   std::deque<std::unique_ptr<OpDesc>> ops_;
   std::unordered_map<std::string, std::unique_ptr<VarDesc>> vars_;
@@ -21,11 +21,15 @@
 
 #include <glog/logging.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
 #include <condition_variable>  // NOLINT
 #include <deque>
+#include <functional>
 #include <limits>
 #include <memory>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/expect.h"
@@ -43,11 +47,42 @@ class ChannelObject {
     capacity_ = (std::min)(MaxCapacity(), capacity);
   }
 
-  const std::deque<T>& GetData() const { return data_; }
+  const std::deque<T>& GetData() const {
+    CHECK(shards_.empty()) << "GetData is not supported by sharded channel";
+    return data_;
+  }
   void Clear() {
     std::unique_lock<std::mutex> lock(mutex_);
     data_.clear();
     data_.shrink_to_fit();
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> shard_lock(shard->mutex);
+      sharded_size_ -= shard->data.size();
+      shard->data.clear();
+      shard->data.shrink_to_fit();
+    }
+  }
+
+  size_t ShardNum() { return shards_.empty() ? 1 : shards_.size(); }
+
+  // Split the channel into shard_num shards, each of which is locked by its
+  // own mutex. A writer appends to the shard of its thread, and a reader
+  // takes data from all the shards starting from the one of its thread, so
+  // that the concurrent readers and writers rarely contend for one lock. The
+  // global mutex is only locked to wait when the channel is empty or full.
+  //
+  // The data is not read in FIFO order if shard_num > 1. It must be called
+  // when the channel is empty and not used by other threads.
+  void SetShardNum(size_t shard_num) {
+    CHECK(shard_num >= 1) << "shard num must be >= 1";
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(EmptyUnlocked()) << "shard num can only be set on empty channel";
+    shards_.clear();
+    if (shard_num > 1) {
+      for (size_t i = 0; i < shard_num; ++i) {
+        shards_.emplace_back(new Shard);
+      }
+    }
   }
 
   size_t Capacity() {
@@ -97,7 +132,7 @@ class ChannelObject {
 
   size_t Size() {
     std::lock_guard<std::mutex> lock(mutex_);
-    return data_.size();
+    return data_.size() + sharded_size_;
   }
 
   bool Empty() {
@@ -105,6 +140,10 @@ class ChannelObject {
     return EmptyUnlocked();
   }
 
+  // the seconds the readers and the writers are blocked, summed over threads
+  double ReadBlockedTime() { return read_blocked_ns_ * 1e-9; }
+  double WriteBlockedTime() { return write_blocked_ns_ * 1e-9; }
+
   // blocking operation
   bool Get(T& val) { return Read(1, &val) != 0; }  // NOLINT
 
@@ -114,6 +153,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      return ShardedRead(n, p);
+    }
 
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = Read(n, p, lock);
@@ -133,6 +175,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      return ShardedWrite(n, p, [](const T& val) -> const T& { return val; });
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = Write(n, p, lock);
     Notify();
@@ -144,6 +189,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      return ShardedWrite(n, p, [](T& val) -> T&& { return std::move(val); });
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = WriteMove(n, p, lock);
     Notify();
@@ -180,23 +228,42 @@ class ChannelObject {
   size_t Write(std::vector<T>&& p) { return WriteMove(p.size(), &p[0]); }
 
  private:
+  // pad the shards to different cache lines
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::deque<T> data;
+  };
+
   size_t capacity_ = MaxCapacity();
   size_t block_size_ = 1024;
-  bool closed_ = false;
+  std::atomic<bool> closed_{false};
   std::mutex mutex_;
   // use deque to store data
   std::deque<T> data_;
   size_t reading_count_ = 0;
-  int empty_waiters_ = 0;
-  int full_waiters_ = 0;
+  // the waiters are checked without mutex_ by the sharded channel
+  std::atomic<int> empty_waiters_{0};
+  std::atomic<int> full_waiters_{0};
   std::condition_variable empty_cond_;
   std::condition_variable full_cond_;
+  // the data is stored in the shards instead of data_ if it is not empty
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> sharded_size_{0};
+  std::atomic<size_t> sharded_reading_count_{0};
+  std::atomic<uint64_t> read_blocked_ns_{0};
+  std::atomic<uint64_t> write_blocked_ns_{0};
 
   static constexpr size_t MaxCapacity() {
     return (std::numeric_limits<size_t>::max)() / 2;
   }
 
   void Notify() {
+    if (!shards_.empty()) {
+      // the sharded readers and writers wait for different conditions
+      empty_cond_.notify_all();
+      full_cond_.notify_all();
+      return;
+    }
     if (empty_waiters_ != 0 && (!EmptyUnlocked() || closed_)) {
       empty_cond_.notify_one();
     }
@@ -205,7 +272,18 @@ class ChannelObject {
     }
   }
 
-  bool EmptyUnlocked() { return data_.empty(); }
+  // wait on cond, and add the time waited to blocked_ns
+  static void TimedWait(std::condition_variable* cond,
+                        std::unique_lock<std::mutex>* lock,
+                        std::atomic<uint64_t>* blocked_ns) {
+    auto begin = std::chrono::steady_clock::now();
+    cond->wait(*lock);
+    *blocked_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  }
+
+  bool EmptyUnlocked() { return data_.empty() && sharded_size_ == 0; }
 
   bool FullUnlocked() { return data_.size() >= capacity_ + reading_count_; }
 
@@ -219,7 +297,7 @@ class ChannelObject {
         full_cond_.notify_one();
       }
       empty_waiters_++;
-      empty_cond_.wait(lock);
+      TimedWait(&empty_cond_, &lock, &read_blocked_ns_);
       empty_waiters_--;
     }
     return !EmptyUnlocked();
@@ -235,7 +313,7 @@ class ChannelObject {
         empty_cond_.notify_one();
       }
       full_waiters_++;
-      full_cond_.wait(lock);
+      TimedWait(&full_cond_, &lock, &write_blocked_ns_);
       full_waiters_--;
     }
     return !closed_;
@@ -284,6 +362,91 @@ class ChannelObject {
     }
     return finished;
   }
+
+  size_t ShardIndex() {
+    static thread_local size_t hash =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    return hash % shards_.size();
+  }
+
+  // the number of data which can be written without waiting, it may be
+  // inaccurate since it is computed without lock
+  size_t ShardedWritable() {
+    size_t limit = capacity_ + sharded_reading_count_;
+    size_t size = sharded_size_;
+    return limit > size ? limit - size : 0;
+  }
+
+  // Wake up the waiters after the sharded channel is changed. Since the
+  // waiters are counted before they check the condition with mutex_ held,
+  // notifying with mutex_ held never misses a waiter.
+  void NotifySharded() {
+    if (empty_waiters_ != 0 || full_waiters_ != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Notify();
+    }
+  }
+
+  size_t ShardedRead(size_t n, T* p) {
+    size_t finished = 0;
+    sharded_reading_count_ += n;
+    NotifySharded();
+    size_t start = ShardIndex();
+    while (finished < n) {
+      for (size_t i = 0; i < shards_.size() && finished < n; ++i) {
+        Shard& shard = *shards_[(start + i) % shards_.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t m = std::min(n - finished, shard.data.size());
+        for (size_t j = 0; j < m; ++j) {
+          p[finished++] = std::move(shard.data.front());
+          shard.data.pop_front();
+        }
+        sharded_size_ -= m;
+      }
+      if (finished < n) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        empty_waiters_++;
+        while (sharded_size_ == 0 && !closed_) {
+          TimedWait(&empty_cond_, &lock, &read_blocked_ns_);
+        }
+        empty_waiters_--;
+        if (sharded_size_ == 0) {
+          break;
+        }
+      }
+    }
+    sharded_reading_count_ -= n;
+    NotifySharded();
+    return finished;
+  }
+
+  template <class U, class Convert>
+  size_t ShardedWrite(size_t n, U* p, Convert convert) {
+    size_t finished = 0;
+    Shard& shard = *shards_[ShardIndex()];
+    while (finished < n && !closed_) {
+      size_t m = std::min(n - finished, ShardedWritable());
+      if (m == 0) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        full_waiters_++;
+        while (ShardedWritable() == 0 && !closed_) {
+          TimedWait(&full_cond_, &lock, &write_blocked_ns_);
+        }
+        full_waiters_--;
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = 0; i < m; ++i) {
+          shard.data.push_back(convert(p[finished++]));
+        }
+        // counted with the shard locked, so that it never underflows
+        sharded_size_ += m;
+      }
+      NotifySharded();
+    }
+    return finished;
+  }
 };  // NOLINT
 
 template <class T>
@@ -294,6 +457,16 @@ Channel<T> MakeChannel(size_t capacity = (std::numeric_limits<size_t>::max)()) {
   return std::make_shared<ChannelObject<T>>(capacity);
 }
 
+// see ChannelObject::SetShardNum
+template <class T>
+Channel<T> MakeShardedChannel(
+    size_t shard_num,
+    size_t capacity = (std::numeric_limits<size_t>::max)()) {
+  Channel<T> chan = std::make_shared<ChannelObject<T>>(capacity);
+  chan->SetShardNum(shard_num);
+  return chan;
+}
+
 template <class T, class U>
 Channel<T> MakeChannel(const Channel<U>& other) {
   CHECK(other != nullptr) << "channel can not be NULL";
@@ -0,0 +1,105 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/channel.h"
+#include <algorithm>
+#include <limits>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+static void TestMultiReadersAndWriters(size_t shard_num, size_t capacity) {
+  auto chan = MakeShardedChannel<uint64_t>(shard_num, capacity);
+  chan->SetBlockSize(7);
+  EXPECT_EQ(chan->ShardNum(), shard_num);
+  const uint64_t kWriterNum = 8;
+  const uint64_t kReaderNum = 8;
+  const uint64_t kCount = 10000;
+  std::vector<std::thread> writers;
+  for (uint64_t w = 0; w < kWriterNum; ++w) {
+    writers.emplace_back([&chan, w, kWriterNum]() {
+      std::vector<uint64_t> block;
+      for (uint64_t i = w; i < kCount; i += kWriterNum) {
+        block.push_back(i);
+        if (block.size() == 13) {
+          EXPECT_EQ(chan->Write(std::move(block)), 13UL);
+          block.clear();
+        }
+      }
+      chan->Write(block);
+    });
+  }
+  std::vector<std::vector<uint64_t>> results(kReaderNum);
+  std::vector<std::thread> readers;
+  for (uint64_t r = 0; r < kReaderNum; ++r) {
+    readers.emplace_back([&chan, &results, r]() {
+      std::vector<uint64_t> block;
+      while (chan->Read(block) != 0) {
+        results[r].insert(results[r].end(), block.begin(), block.end());
+      }
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  chan->Close();
+  for (auto& t : readers) {
+    t.join();
+  }
+  std::vector<int> seen(kCount, 0);
+  for (auto& result : results) {
+    for (auto i : result) {
+      ASSERT_LT(i, kCount);
+      ++seen[i];
+    }
+  }
+  for (uint64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(seen[i], 1);
+  }
+  EXPECT_TRUE(chan->Empty());
+}
+
+TEST(Channel, MultiReadersAndWriters) {
+  TestMultiReadersAndWriters(1, 100);
+  TestMultiReadersAndWriters(1, (std::numeric_limits<size_t>::max)());
+}
+
+TEST(Channel, ShardedMultiReadersAndWriters) {
+  TestMultiReadersAndWriters(4, 0);
+  TestMultiReadersAndWriters(4, 100);
+  TestMultiReadersAndWriters(16, (std::numeric_limits<size_t>::max)());
+}
+
+TEST(Channel, ShardedReadAll) {
+  auto chan = MakeShardedChannel<int>(4);
+  std::vector<int> data = {1, 2, 3, 4, 5};
+  EXPECT_EQ(chan->Write(data), data.size());
+  EXPECT_EQ(chan->Size(), data.size());
+  chan->Close();
+  EXPECT_FALSE(chan->Put(6));
+  std::vector<int> result;
+  EXPECT_EQ(chan->ReadAll(result), data.size());
+  std::sort(result.begin(), result.end());
+  EXPECT_EQ(result, data);
+  chan->Open();
+  EXPECT_TRUE(chan->Put(6));
+  chan->Clear();
+  EXPECT_EQ(chan->Size(), 0UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
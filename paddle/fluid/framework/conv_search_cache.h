@@ -14,18 +14,34 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator_kernel_configs.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
+#include "paddle/fluid/platform/gpu_info.h"
+
+DECLARE_string(cudnn_algo_cache_file);
 
 namespace paddle {
 namespace framework {
 
 using framework::AlgorithmsCache;
 
+// The first line of the files of the persistent algorithm caches.
+static const char kAlgoCacheMagic[] = "paddle_cudnn_algo_cache_v1";
+
 // ConvSearchCache using framework::AlgorithmsCache to search
 // cudnnConvolutionFwdAlgo_t, cudnnConvolutionBwdDataAlgo_t or
-// cudnnConvolutionBwdFilterAlgo_t
+// cudnnConvolutionBwdFilterAlgo_t.
+//
+// If FLAGS_cudnn_algo_cache_file is set, the algorithms are loaded from the
+// file when the cache is created and saved to it when the process exits. The
+// file begins with the GPU model and the cuDNN version, and is ignored if
+// they are different from the current ones.
 class ConvSearchCache {
  public:
   static ConvSearchCache& Instance() {
@@ -46,9 +62,85 @@ class ConvSearchCache {
     return &fusion_forward_cache_;
   }
 
+  size_t Size() {
+    return forward_cache_.Size() + backward_data_cache_.Size() +
+           backward_filter_cache_.Size() + fusion_forward_cache_.Size();
+  }
+
+  // Add the algorithms in the file to the caches. Return false if the file
+  // does not exist or is not written on this GPU model and cuDNN version.
+  bool Load(const std::string& path) {
+    std::ifstream fin(path);
+    if (!fin) return false;
+    std::string magic, device_name, cudnn_version;
+    std::getline(fin, magic);
+    std::getline(fin, device_name);
+    std::getline(fin, cudnn_version);
+    if (magic != kAlgoCacheMagic || device_name != device_name_ ||
+        cudnn_version != std::to_string(cudnn_version_)) {
+      LOG(WARNING) << "Ignore the cuDNN algorithm cache " << path
+                   << " written on " << device_name << " with cuDNN "
+                   << cudnn_version << ", the current GPU is " << device_name_
+                   << " with cuDNN " << cudnn_version_;
+      return false;
+    }
+    bool ok = forward_cache_.Load(&fin) && backward_data_cache_.Load(&fin) &&
+              backward_filter_cache_.Load(&fin) &&
+              fusion_forward_cache_.Load(&fin);
+    if (!ok) {
+      LOG(WARNING) << "The cuDNN algorithm cache " << path << " is broken";
+    }
+    VLOG(3) << "Load " << Size() << " cuDNN algorithms from " << path;
+    return ok;
+  }
+
+  // The file is written to a temporary file first and then renamed, so the
+  // processes saving the same file do not see the half written ones.
+  void Save(const std::string& path) {
+    std::string tmp_path =
+        path + ".tmp" + std::to_string(std::random_device()());
+    {
+      std::ofstream fout(tmp_path);
+      fout << kAlgoCacheMagic << "\n"
+           << device_name_ << "\n"
+           << cudnn_version_ << "\n";
+      forward_cache_.Save(&fout);
+      backward_data_cache_.Save(&fout);
+      backward_filter_cache_.Save(&fout);
+      fusion_forward_cache_.Save(&fout);
+      if (!fout) {
+        LOG(WARNING) << "Failed to write the cuDNN algorithm cache "
+                     << tmp_path;
+        std::remove(tmp_path.c_str());
+        return;
+      }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      LOG(WARNING) << "Failed to rename " << tmp_path << " to " << path;
+      std::remove(tmp_path.c_str());
+    }
+  }
+
  private:
-  ConvSearchCache() {}
-  ~ConvSearchCache() {}
+  ConvSearchCache()
+      : device_name_(
+            platform::GetCUDADeviceName(platform::GetCurrentDeviceId())),
+        cudnn_version_(platform::dynload::cudnnGetVersion()) {
+    if (!FLAGS_cudnn_algo_cache_file.empty()) {
+      Load(FLAGS_cudnn_algo_cache_file);
+    }
+    loaded_size_ = Size();
+  }
+
+  ~ConvSearchCache() {
+    if (FLAGS_cudnn_algo_cache_file.empty() || Size() == loaded_size_) {
+      return;
+    }
+    // Merge the algorithms saved by the other processes since this one
+    // started.
+    Load(FLAGS_cudnn_algo_cache_file);
+    Save(FLAGS_cudnn_algo_cache_file);
+  }
   ConvSearchCache(const ConvSearchCache&) {}
   ConvSearchCache& operator=(const ConvSearchCache&) {}
 
@@ -56,6 +148,10 @@ class ConvSearchCache {
   AlgorithmsCache<cudnnConvolutionBwdDataAlgo_t> backward_data_cache_;
   AlgorithmsCache<cudnnConvolutionBwdFilterAlgo_t> backward_filter_cache_;
   AlgorithmsCache<cudnnConvolutionFwdAlgo_t> fusion_forward_cache_;
+
+  std::string device_name_;
+  size_t cudnn_version_;
+  size_t loaded_size_{0};
 };
 
 }  // namespace framework
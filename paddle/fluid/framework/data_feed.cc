@@ -19,11 +19,14 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_feed.h"
 #ifdef _LINUX
+#include <fcntl.h>
 #include <stdio_ext.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif
+#include <algorithm>
 #include <utility>
 #include "gflags/gflags.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
@@ -35,6 +38,8 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/fleet/box_wrapper.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/framework/slot_text_parser.h"
+#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/timer.h"
 
 namespace paddle {
@@ -126,10 +131,19 @@ bool DataFeed::PickOneFile(std::string* filename) {
     return false;
   }
   VLOG(3) << "file_idx_=" << *file_idx_;
-  *filename = filelist_[(*file_idx_)++];
+  picked_file_index_ = (*file_idx_)++;
+  *filename = filelist_[picked_file_index_];
   return true;
 }
 
+std::shared_ptr<FILE> DataFeed::OpenPickedFile(const std::string& filename,
+                                               int* err_no) {
+  if (file_read_ahead_ != nullptr) {
+    return file_read_ahead_->Open(picked_file_index_, err_no, pipe_command_);
+  }
+  return fs_open_read(filename, err_no, pipe_command_);
+}
+
 void DataFeed::CheckInit() {
   PADDLE_ENFORCE(finish_init_, "Initialization did not succeed.");
 }
@@ -187,7 +201,7 @@ void PrivateQueueDataFeed<T>::ReadThread() {
   std::string filename;
   while (PickOneFile(&filename)) {
     int err_no = 0;
-    fp_ = fs_open_read(filename, &err_no, pipe_command_);
+    fp_ = OpenPickedFile(filename, &err_no);
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
     T instance;
     while (ParseOneInstanceFromPipe(&instance)) {
@@ -250,6 +264,9 @@ bool InMemoryDataFeed<T>::Start() {
     input_channel_->Read(data);
     output_channel_->Write(std::move(data));
   }
+  // the batches of each pass are the same with the same seed
+  bucket_engine_.seed(bucket_seed_ + thread_id_);
+  bucket_batches_.clear();
 #endif
   this->finish_start_ = true;
   return true;
@@ -261,14 +278,37 @@ int InMemoryDataFeed<T>::Next() {
   this->CheckStart();
   CHECK(output_channel_ != nullptr);
   CHECK(consume_channel_ != nullptr);
+  uint64_t begin_ns = DataPipelineStat::NowNs();
+  if (pipeline_stat_ != nullptr && last_next_end_ns_ != 0) {
+    pipeline_stat_->Add(kConsumeStage, this->batch_size_, 0,
+                        last_next_end_ns_, begin_ns);
+  }
   VLOG(3) << "output_channel_ size=" << output_channel_->Size()
           << ", consume_channel_ size=" << consume_channel_->Size()
           << ", thread_id=" << thread_id_;
   int index = 0;
   T instance;
   std::vector<T> ins_vec;
+  if (bucket_window_ > 0) {
+    if (bucket_batches_.empty()) {
+      FillBucketBatches();
+    }
+    if (!bucket_batches_.empty()) {
+      ins_vec = std::move(bucket_batches_.front());
+      bucket_batches_.pop_front();
+      index = ins_vec.size();
+    }
+  }
   ins_vec.reserve(this->default_batch_size_);
-  while (index < this->default_batch_size_) {
+  while (bucket_window_ <= 0 && index < this->default_batch_size_) {
+    if (streaming_output_) {
+      if (!output_channel_->Get(instance)) {
+        break;
+      }
+      ins_vec.push_back(std::move(instance));
+      ++index;
+      continue;
+    }
     if (output_channel_->Size() == 0) {
       break;
     }
@@ -288,12 +328,62 @@ int InMemoryDataFeed<T>::Next() {
             << ", consume_channel_ size=" << consume_channel_->Size()
             << ", thread_id=" << thread_id_;
   }
+  last_next_end_ns_ = DataPipelineStat::NowNs();
+  if (pipeline_stat_ != nullptr) {
+    // the time blocked on output_channel_ is counted in feed stage
+    pipeline_stat_->Add(kFeedStage, this->batch_size_, 0, begin_ns,
+                        last_next_end_ns_);
+  }
+  if (this->batch_size_ == 0) {
+    last_next_end_ns_ = 0;
+  }
   return this->batch_size_;
 #else
   return 0;
 #endif
 }
 
+template <typename T>
+void InMemoryDataFeed<T>::FillBucketBatches() {
+  std::vector<T> window;
+  window.reserve(bucket_window_);
+  T instance;
+  while (window.size() < static_cast<size_t>(bucket_window_)) {
+    if (streaming_output_) {
+      if (!output_channel_->Get(instance)) {
+        break;
+      }
+      window.push_back(std::move(instance));
+      continue;
+    }
+    if (output_channel_->Size() == 0) {
+      break;
+    }
+    output_channel_->Get(instance);
+    window.push_back(instance);
+    consume_channel_->Put(std::move(instance));
+  }
+  // stable sort, so that the batches are deterministic
+  std::vector<std::pair<uint64_t, size_t>> order(window.size());
+  for (size_t i = 0; i < window.size(); ++i) {
+    order[i] = std::make_pair(InstanceLength(window[i]), i);
+  }
+  std::sort(order.begin(), order.end());
+  std::vector<std::vector<T>> batches;
+  for (size_t i = 0; i < order.size(); i += this->default_batch_size_) {
+    size_t end = std::min(order.size(), i + this->default_batch_size_);
+    batches.emplace_back();
+    batches.back().reserve(end - i);
+    for (size_t j = i; j < end; ++j) {
+      batches.back().push_back(std::move(window[order[j].second]));
+    }
+  }
+  std::shuffle(batches.begin(), batches.end(), bucket_engine_);
+  for (auto& batch : batches) {
+    bucket_batches_.push_back(std::move(batch));
+  }
+}
+
 template <typename T>
 void InMemoryDataFeed<T>::SetInputChannel(void* channel) {
   input_channel_ = static_cast<paddle::framework::ChannelObject<T>*>(channel);
@@ -357,6 +447,11 @@ void InMemoryDataFeed<T>::SetCurrentPhase(int current_phase) {
   current_phase_ = current_phase;
 }
 
+template <typename T>
+void InMemoryDataFeed<T>::SetStreamingOutput(bool streaming_output) {
+  streaming_output_ = streaming_output;
+}
+
 template <typename T>
 void InMemoryDataFeed<T>::SetParseInsId(bool parse_ins_id) {
   parse_ins_id_ = parse_ins_id;
@@ -377,7 +472,7 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     } else {
 #endif
       int err_no = 0;
-      this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
+      this->fp_ = this->OpenPickedFile(filename, &err_no);
 #ifdef PADDLE_WITH_BOX_PS
     }
 #endif
@@ -387,11 +482,19 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     T instance;
     platform::Timer timeline;
     timeline.Start();
+    uint64_t begin_ns = DataPipelineStat::NowNs();
+    uint64_t begin_bytes = parsed_bytes_;
+    uint64_t records = 0;
     while (ParseOneInstanceFromPipe(&instance)) {
       writer << std::move(instance);
       instance = T();
+      ++records;
     }
     writer.Flush();
+    if (pipeline_stat_ != nullptr) {
+      pipeline_stat_->Add(kReadStage, records, parsed_bytes_ - begin_bytes,
+                          begin_ns, DataPipelineStat::NowNs());
+    }
     timeline.Pause();
     VLOG(3) << "LoadIntoMemory() read all lines, file=" << filename
             << ", cost time=" << timeline.ElapsedSec()
@@ -462,7 +565,7 @@ void MultiSlotDataFeed::ReadThread() {
   std::string filename;
   while (PickOneFile(&filename)) {
     int err_no = 0;
-    fp_ = fs_open_read(filename, &err_no, pipe_command_);
+    fp_ = OpenPickedFile(filename, &err_no);
     CHECK(fp_ != nullptr);
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
     std::vector<MultiSlotType> instance;
@@ -602,13 +705,10 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
     instance->resize(use_slots_num);
 
     const char* str = reader.get();
-    std::string line = std::string(str);
-    // VLOG(3) << line;
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotTextParser parser(str, str + reader.length());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = static_cast<int>(parser.NextUint64());
       PADDLE_ENFORCE_NE(
           num, 0,
           platform::errors::InvalidArgument(
@@ -621,23 +721,17 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = parser.NextFloat();
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = parser.NextUint64();
             (*instance)[idx].AddValue(feasign);
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        parser.SkipTokens(num);
       }
     }
     return true;
@@ -655,11 +749,10 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
     instance->resize(use_slots_num);
     // parse line
     const char* str = line.c_str();
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotTextParser parser(str, str + line.size());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = static_cast<int>(parser.NextUint64());
       PADDLE_ENFORCE(
           num,
           "The number of ids can not be zero, you need padding "
@@ -672,20 +765,17 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = parser.NextFloat();
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = parser.NextUint64();
             (*instance)[idx].AddValue(feasign);
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        parser.SkipTokens(num);
       }
     }
   } else {
@@ -811,6 +901,24 @@ void MultiSlotInMemoryDataFeed::Init(
                        1);  // Each lod info will prepend a zero
   }
   visit_.resize(all_slot_num, false);
+  bucket_window_ = data_feed_desc.bucket_window();
+  bucket_seed_ = data_feed_desc.bucket_seed();
+  if (bucket_window_ > 0) {
+    auto it = std::find(use_slots_.begin(), use_slots_.end(),
+                        data_feed_desc.bucket_slot());
+    PADDLE_ENFORCE_EQ(it != use_slots_.end(), true,
+                      platform::errors::InvalidArgument(
+                          "The bucket slot %s is not a used slot.",
+                          data_feed_desc.bucket_slot()));
+    bucket_slot_index_ = it - use_slots_.begin();
+  }
+  zero_copy_feed_ = data_feed_desc.zero_copy_feed();
+  if (zero_copy_feed_) {
+    feed_capacity_.assign(use_slots_.size(), 0);
+    slot_pos_.resize(use_slots_.size());
+    float_dst_.resize(use_slots_.size());
+    uint64_dst_.resize(use_slots_.size());
+  }
   pipe_command_ = data_feed_desc.pipe_command();
   finish_init_ = true;
   input_type_ = data_feed_desc.input_type();
@@ -838,10 +946,9 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     return false;
   } else {
     const char* str = reader.get();
-    std::string line = std::string(str);
-    // VLOG(3) << line;
     char* endptr = const_cast<char*>(str);
     int pos = 0;
+    parsed_bytes_ += reader.length() + 1;
     if (parse_ins_id_) {
       int num = strtol(&str[pos], &endptr, 10);
       CHECK(num == 1);  // NOLINT
@@ -887,9 +994,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       instance->rank = rank;
       pos += len + 1;
     }
+    SlotTextParser parser(str + pos, str + reader.length());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = static_cast<int>(parser.NextUint64());
       PADDLE_ENFORCE(
           num,
           "The number of ids can not be zero, you need padding "
@@ -900,7 +1008,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = parser.NextFloat();
             // if float feasign is equal to zero, ignore it
             // except when slot is dense
             if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
@@ -912,7 +1020,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = parser.NextUint64();
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
             if (feasign == 0 && !use_slots_is_dense_[i]) {
@@ -923,14 +1031,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
             instance->uint64_feasigns_.push_back(FeatureItem(f, idx));
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        parser.SkipTokens(num);
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -942,6 +1044,17 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
 #endif
 }
 
+uint64_t MultiSlotInMemoryDataFeed::InstanceLength(const Record& instance) {
+  uint64_t length = 0;
+  for (auto& item : instance.uint64_feasigns_) {
+    length += item.slot() == bucket_slot_index_;
+  }
+  for (auto& item : instance.float_feasigns_) {
+    length += item.slot() == bucket_slot_index_;
+  }
+  return length;
+}
+
 bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
 #ifdef _LINUX
   std::string line;
@@ -949,11 +1062,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
     VLOG(3) << line;
     // parse line
     const char* str = line.c_str();
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotTextParser parser(str, str + line.size());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = static_cast<int>(parser.NextUint64());
       PADDLE_ENFORCE(
           num,
           "The number of ids can not be zero, you need padding "
@@ -965,7 +1077,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = parser.NextFloat();
             if (fabs(feasign) < 1e-6) {
               continue;
             }
@@ -975,7 +1087,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = parser.NextUint64();
             if (feasign == 0) {
               continue;
             }
@@ -984,11 +1096,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
             instance->uint64_feasigns_.push_back(FeatureItem(f, idx));
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        parser.SkipTokens(num);
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -1004,6 +1113,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
 void MultiSlotInMemoryDataFeed::PutToFeedVec(
     const std::vector<Record>& ins_vec) {
 #ifdef _LINUX
+  if (zero_copy_feed_) {
+    PutToFeedVecZeroCopy(ins_vec);
+    return;
+  }
   for (size_t i = 0; i < batch_float_feasigns_.size(); ++i) {
     batch_float_feasigns_[i].clear();
     batch_uint64_feasigns_[i].clear();
@@ -1066,35 +1179,631 @@ void MultiSlotInMemoryDataFeed::PutToFeedVec(
           {total_instance, 1}, this->place_);
       CopyToFeedTensor(tensor_ptr, feasign, total_instance * sizeof(int64_t));
     }
-    auto& slot_offset = offset_[i];
-    if (this->input_type_ == 0) {
+    SetFeedLoDAndShape(i);
+  }
+#endif
+}
+
+void MultiSlotInMemoryDataFeed::SetFeedLoDAndShape(size_t i) {
+  auto& slot_offset = offset_[i];
+  size_t total_instance = slot_offset.back();
+  if (this->input_type_ == 0) {
+    LoD data_lod{slot_offset};
+    feed_vec_[i]->set_lod(data_lod);
+  } else if (this->input_type_ == 1) {
+    if (!use_slots_is_dense_[i]) {
+      std::vector<size_t> tmp_offset;
+      PADDLE_ENFORCE_EQ(slot_offset.size(), 2,
+                        platform::errors::InvalidArgument(
+                            "In batch reader, the sparse tensor lod size "
+                            "must be 2, but received %d",
+                            slot_offset.size()));
+      const auto& max_size = slot_offset[1];
+      tmp_offset.reserve(max_size + 1);
+      for (unsigned int k = 0; k <= max_size; k++) {
+        tmp_offset.emplace_back(k);
+      }
+      slot_offset = tmp_offset;
       LoD data_lod{slot_offset};
       feed_vec_[i]->set_lod(data_lod);
-    } else if (this->input_type_ == 1) {
-      if (!use_slots_is_dense_[i]) {
-        std::vector<size_t> tmp_offset;
-        PADDLE_ENFORCE_EQ(slot_offset.size(), 2,
-                          platform::errors::InvalidArgument(
-                              "In batch reader, the sparse tensor lod size "
-                              "must be 2, but received %d",
-                              slot_offset.size()));
-        const auto& max_size = slot_offset[1];
-        tmp_offset.reserve(max_size + 1);
-        for (unsigned int k = 0; k <= max_size; k++) {
-          tmp_offset.emplace_back(k);
+    }
+  }
+  if (use_slots_is_dense_[i]) {
+    if (inductive_shape_index_[i] != -1) {
+      use_slots_shape_[i][inductive_shape_index_[i]] =
+          total_instance / total_dims_without_inductive_[i];
+    }
+    feed_vec_[i]->Resize(framework::make_ddim(use_slots_shape_[i]));
+  }
+}
+
+char* MultiSlotInMemoryDataFeed::NextStagingBuffer(size_t size) {
+  cur_staging_buffer_ ^= 1;
+  auto& buffer = staging_buffers_[cur_staging_buffer_];
+#ifdef PADDLE_WITH_CUDA
+  auto& event = staging_events_[cur_staging_buffer_];
+  if (event == nullptr) {
+    int dev_idx = BOOST_GET_CONST(platform::CUDAPlace, this->place_).device;
+    event = platform::CudaEventResourcePool::Instance().New(dev_idx);
+  }
+  // Wait for the copy issued from this buffer two batches ago.
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventSynchronize(event.get()));
+  if (buffer == nullptr || buffer->size() < size) {
+    buffer.reset();
+    buffer = memory::Alloc(platform::CUDAPinnedPlace(), size);
+  }
+#else
+  PADDLE_THROW(platform::errors::Unavailable(
+      "The staging buffer of the DataFeed is only used for GPU places, "
+      "please compile with WITH_GPU option."));
+#endif
+  return reinterpret_cast<char*>(buffer->ptr());
+}
+
+void MultiSlotInMemoryDataFeed::PutToFeedVecZeroCopy(
+    const std::vector<Record>& ins_vec) {
+#ifdef _LINUX
+  // The first pass computes the LoD of each slot. A slot without any feasign
+  // in a record is filled with one zero, as in PutToFeedVec.
+  const size_t slot_num = use_slots_.size();
+  for (size_t j = 0; j < slot_num; ++j) {
+    offset_[j].clear();
+    offset_[j].push_back(0);
+    slot_pos_[j] = 0;
+  }
+  ins_content_vec_.clear();
+  ins_content_vec_.reserve(ins_vec.size());
+  ins_id_vec_.clear();
+  ins_id_vec_.reserve(ins_vec.size());
+  for (auto& r : ins_vec) {
+    ins_id_vec_.push_back(r.ins_id_);
+    ins_content_vec_.push_back(r.content_);
+    for (auto& item : r.float_feasigns_) {
+      ++slot_pos_[item.slot()];
+    }
+    for (auto& item : r.uint64_feasigns_) {
+      ++slot_pos_[item.slot()];
+    }
+    for (size_t j = 0; j < slot_num; ++j) {
+      offset_[j].push_back(offset_[j].back() +
+                           std::max<size_t>(slot_pos_[j], 1));
+      slot_pos_[j] = 0;
+    }
+  }
+
+  // Find the destination of each slot. On CPU, the feasigns are written into
+  // the feed tensors directly; on GPU, they are written into a pinned staging
+  // buffer and copied to the feed tensors asynchronously.
+  bool on_gpu = platform::is_gpu_place(this->place_);
+  const size_t kAlignment = 64;
+  size_t staging_size = 0;
+  for (size_t j = 0; j < slot_num; ++j) {
+    float_dst_[j] = nullptr;
+    uint64_dst_[j] = nullptr;
+    if (feed_vec_[j] == nullptr) continue;
+    size_t total_instance = offset_[j].back();
+    feed_capacity_[j] = std::max(feed_capacity_[j], total_instance);
+    if (on_gpu) {
+      staging_size += (total_instance * sizeof(int64_t) + kAlignment - 1) /
+                      kAlignment * kAlignment;
+    }
+  }
+  char* staging = on_gpu ? NextStagingBuffer(staging_size) : nullptr;
+  for (size_t j = 0; j < slot_num; ++j) {
+    if (feed_vec_[j] == nullptr) continue;
+    int64_t total_instance = offset_[j].back();
+    const auto& type = all_slots_type_[j];
+    if (on_gpu) {
+      if (type[0] == 'f') {  // float
+        float_dst_[j] = reinterpret_cast<float*>(staging);
+      } else if (type[0] == 'u') {  // uint64
+        uint64_dst_[j] = reinterpret_cast<int64_t*>(staging);
+      }
+      staging += (total_instance * sizeof(int64_t) + kAlignment - 1) /
+                 kAlignment * kAlignment;
+    } else if (type[0] == 'f') {  // float
+      float_dst_[j] = feed_vec_[j]->mutable_data<float>(
+          {total_instance, 1}, this->place_,
+          feed_capacity_[j] * sizeof(float));
+    } else if (type[0] == 'u') {  // uint64
+      uint64_dst_[j] = feed_vec_[j]->mutable_data<int64_t>(
+          {total_instance, 1}, this->place_,
+          feed_capacity_[j] * sizeof(int64_t));
+    }
+  }
+
+  // The second pass scatters the feasigns.
+  for (size_t i = 0; i < ins_vec.size(); ++i) {
+    auto& r = ins_vec[i];
+    for (auto& item : r.float_feasigns_) {
+      float* dst = float_dst_[item.slot()];
+      if (dst != nullptr) {
+        dst[slot_pos_[item.slot()]] = item.sign().float_feasign_;
+      }
+      ++slot_pos_[item.slot()];
+    }
+    for (auto& item : r.uint64_feasigns_) {
+      int64_t* dst = uint64_dst_[item.slot()];
+      if (dst != nullptr) {
+        dst[slot_pos_[item.slot()]] =
+            static_cast<int64_t>(item.sign().uint64_feasign_);
+      }
+      ++slot_pos_[item.slot()];
+    }
+    for (size_t j = 0; j < slot_num; ++j) {
+      if (slot_pos_[j] == offset_[j][i]) {
+        // fill slot value with default value 0
+        if (float_dst_[j] != nullptr) {
+          float_dst_[j][slot_pos_[j]] = 0.0;
+        } else if (uint64_dst_[j] != nullptr) {
+          uint64_dst_[j][slot_pos_[j]] = 0;
         }
-        slot_offset = tmp_offset;
-        LoD data_lod{slot_offset};
-        feed_vec_[i]->set_lod(data_lod);
       }
+      slot_pos_[j] = offset_[j][i + 1];
     }
-    if (use_slots_is_dense_[i]) {
-      if (inductive_shape_index_[i] != -1) {
-        use_slots_shape_[i][inductive_shape_index_[i]] =
-            total_instance / total_dims_without_inductive_[i];
+  }
+
+#ifdef PADDLE_WITH_CUDA
+  if (on_gpu) {
+    auto gpu_place = BOOST_GET_CONST(platform::CUDAPlace, this->place_);
+    auto stream = static_cast<platform::CUDADeviceContext*>(
+                      platform::DeviceContextPool::Instance().Get(gpu_place))
+                      ->stream();
+    // The copies are issued to the compute stream, so they are ordered
+    // after the ops which read the feed tensors of the last batch.
+    for (size_t j = 0; j < slot_num; ++j) {
+      if (feed_vec_[j] == nullptr) continue;
+      int64_t total_instance = offset_[j].back();
+      const auto& type = all_slots_type_[j];
+      void* src = nullptr;
+      void* dst = nullptr;
+      size_t size = 0;
+      if (type[0] == 'f') {  // float
+        src = float_dst_[j];
+        size = total_instance * sizeof(float);
+        dst = feed_vec_[j]->mutable_data<float>(
+            {total_instance, 1}, this->place_,
+            feed_capacity_[j] * sizeof(float));
+      } else if (type[0] == 'u') {  // uint64
+        src = uint64_dst_[j];
+        size = total_instance * sizeof(int64_t);
+        dst = feed_vec_[j]->mutable_data<int64_t>(
+            {total_instance, 1}, this->place_,
+            feed_capacity_[j] * sizeof(int64_t));
       }
-      feed_vec_[i]->Resize(framework::make_ddim(use_slots_shape_[i]));
+      if (size == 0) continue;
+      memory::Copy(gpu_place, dst, platform::CUDAPinnedPlace(), src, size,
+                   stream);
     }
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(
+        staging_events_[cur_staging_buffer_].get(), stream));
+  }
+#endif
+
+  for (size_t j = 0; j < slot_num; ++j) {
+    if (feed_vec_[j] == nullptr) continue;
+    SetFeedLoDAndShape(j);
+  }
+#endif
+}
+
+constexpr char MultiSlotBinaryInMemoryDataFeed::kBinaryMagic[8];
+constexpr uint32_t MultiSlotBinaryInMemoryDataFeed::kBinaryInsId;
+constexpr uint32_t MultiSlotBinaryInMemoryDataFeed::kBinaryContent;
+constexpr uint32_t MultiSlotBinaryInMemoryDataFeed::kBinaryLogKey;
+constexpr size_t MultiSlotBinaryInMemoryDataFeed::kBinaryBlockRecordNum;
+
+template <typename T>
+static T ReadBinaryValue(const char** cursor, const char* end) {
+  PADDLE_ENFORCE_LE(sizeof(T), static_cast<size_t>(end - *cursor),
+                    platform::errors::InvalidArgument(
+                        "The binary data file is truncated or corrupted."));
+  T value;
+  memcpy(&value, *cursor, sizeof(T));
+  *cursor += sizeof(T);
+  return value;
+}
+
+// Returns the start of an array of num elements, and moves cursor to its end.
+template <typename T>
+static const char* SkipBinaryArray(const char** cursor, const char* end,
+                                   size_t num) {
+  PADDLE_ENFORCE_LE(num * sizeof(T), static_cast<size_t>(end - *cursor),
+                    platform::errors::InvalidArgument(
+                        "The binary data file is truncated or corrupted."));
+  const char* array = *cursor;
+  *cursor += num * sizeof(T);
+  return array;
+}
+
+template <typename T>
+static T BinaryArrayAt(const char* array, size_t index) {
+  T value;
+  memcpy(&value, array + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+static void WriteBinaryBytes(const void* data, size_t size, FILE* fp) {
+  if (size == 0) return;
+  PADDLE_ENFORCE_EQ(fwrite(data, 1, size, fp), size,
+                    platform::errors::Unavailable(
+                        "Fail to write the binary data file, errno is %d.",
+                        errno));
+}
+
+template <typename T>
+static void WriteBinaryValue(const T& value, FILE* fp) {
+  WriteBinaryBytes(&value, sizeof(T), fp);
+}
+
+template <typename T>
+static void WriteBinaryArray(const std::vector<T>& values, FILE* fp) {
+  WriteBinaryBytes(values.data(), values.size() * sizeof(T), fp);
+}
+
+static bool ReadBinaryBytes(FILE* fp, size_t size, std::string* buffer) {
+  size_t old_size = buffer->size();
+  buffer->resize(old_size + size);
+  return fread(&(*buffer)[old_size], 1, size, fp) == size;
+}
+
+size_t MultiSlotBinaryInMemoryDataFeed::ParseBinaryHeader(const char* data,
+                                                          size_t size) {
+  PADDLE_ENFORCE_EQ(
+      size >= sizeof(kBinaryMagic) &&
+          memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) == 0,
+      true, platform::errors::InvalidArgument(
+                "The file is not a binary data file, please convert it by "
+                "InMemoryDataset.convert_to_binary first."));
+  const char* cursor = data + sizeof(kBinaryMagic);
+  const char* end = data + size;
+  binary_flags_ = ReadBinaryValue<uint32_t>(&cursor, end);
+  PADDLE_ENFORCE_EQ(
+      !(parse_ins_id_ || parse_logkey_) || (binary_flags_ & kBinaryInsId),
+      true, platform::errors::InvalidArgument(
+                "The binary data file has no ins_id, please convert it with "
+                "parse_ins_id=True."));
+  PADDLE_ENFORCE_EQ(
+      !parse_content_ || (binary_flags_ & kBinaryContent), true,
+      platform::errors::InvalidArgument(
+          "The binary data file has no content, please convert it with "
+          "parse_content=True."));
+  PADDLE_ENFORCE_EQ(
+      !parse_logkey_ || (binary_flags_ & kBinaryLogKey), true,
+      platform::errors::InvalidArgument(
+          "The binary data file has no logkey, please convert it with "
+          "parse_logkey=True."));
+
+  auto slot_num = ReadBinaryValue<uint32_t>(&cursor, end);
+  binary_slot_map_.assign(slot_num, -1);
+  std::vector<bool> found(use_slots_.size(), false);
+  for (uint32_t i = 0; i < slot_num; ++i) {
+    auto len = ReadBinaryValue<uint16_t>(&cursor, end);
+    std::string name(SkipBinaryArray<char>(&cursor, end, len), len);
+    auto type = ReadBinaryValue<char>(&cursor, end);
+    for (size_t j = 0; j < all_slots_.size(); ++j) {
+      if (all_slots_[j] != name || use_slots_index_[j] == -1) continue;
+      PADDLE_ENFORCE_EQ(type, all_slots_type_[j][0],
+                        platform::errors::InvalidArgument(
+                            "The type of slot %s is %s, but it is %c in the "
+                            "binary data file.",
+                            name, all_slots_type_[j], type));
+      binary_slot_map_[i] = use_slots_index_[j];
+      found[use_slots_index_[j]] = true;
+      break;
+    }
+  }
+  for (size_t i = 0; i < use_slots_.size(); ++i) {
+    PADDLE_ENFORCE_EQ(found[i], true,
+                      platform::errors::InvalidArgument(
+                          "The slot %s is not in the binary data file.",
+                          use_slots_[i]));
+  }
+  return cursor - data;
+}
+
+void MultiSlotBinaryInMemoryDataFeed::ParseBinaryBlock(
+    const char* data, size_t size, std::vector<Record>* records) {
+  const char* cursor = data;
+  const char* end = data + size;
+  auto record_num = ReadBinaryValue<uint32_t>(&cursor, end);
+  ReadBinaryValue<uint32_t>(&cursor, end);
+  auto uint64_num = ReadBinaryValue<uint64_t>(&cursor, end);
+  auto float_num = ReadBinaryValue<uint64_t>(&cursor, end);
+  auto* uint64_counts = SkipBinaryArray<uint32_t>(&cursor, end, record_num);
+  auto* float_counts = SkipBinaryArray<uint32_t>(&cursor, end, record_num);
+  auto* uint64_values = SkipBinaryArray<uint64_t>(&cursor, end, uint64_num);
+  auto* float_values = SkipBinaryArray<float>(&cursor, end, float_num);
+  auto* uint64_slots = SkipBinaryArray<uint16_t>(&cursor, end, uint64_num);
+  auto* float_slots = SkipBinaryArray<uint16_t>(&cursor, end, float_num);
+
+  auto parse_strings = [&](std::vector<std::string>* strs) {
+    auto* lens = SkipBinaryArray<uint32_t>(&cursor, end, record_num);
+    strs->resize(record_num);
+    for (uint32_t i = 0; i < record_num; ++i) {
+      auto len = BinaryArrayAt<uint32_t>(lens, i);
+      (*strs)[i].assign(SkipBinaryArray<char>(&cursor, end, len), len);
+    }
+  };
+  std::vector<std::string> ins_ids, contents;
+  if (binary_flags_ & kBinaryInsId) parse_strings(&ins_ids);
+  if (binary_flags_ & kBinaryContent) parse_strings(&contents);
+  const char *search_ids = nullptr, *cmatchs = nullptr, *ranks = nullptr;
+  if (binary_flags_ & kBinaryLogKey) {
+    search_ids = SkipBinaryArray<uint64_t>(&cursor, end, record_num);
+    cmatchs = SkipBinaryArray<uint32_t>(&cursor, end, record_num);
+    ranks = SkipBinaryArray<uint32_t>(&cursor, end, record_num);
+  }
+
+  auto map_slot = [&](uint16_t slot) {
+    PADDLE_ENFORCE_LT(slot, binary_slot_map_.size(),
+                      platform::errors::InvalidArgument(
+                          "The binary data file is corrupted."));
+    return binary_slot_map_[slot];
+  };
+  size_t uint64_offset = 0, float_offset = 0;
+  records->resize(record_num);
+  for (uint32_t i = 0; i < record_num; ++i) {
+    auto& record = (*records)[i];
+    size_t uint64_end =
+        uint64_offset + BinaryArrayAt<uint32_t>(uint64_counts, i);
+    size_t float_end = float_offset + BinaryArrayAt<uint32_t>(float_counts, i);
+    PADDLE_ENFORCE_EQ(uint64_end <= uint64_num && float_end <= float_num, true,
+                      platform::errors::InvalidArgument(
+                          "The binary data file is corrupted."));
+    record.uint64_feasigns_.reserve(uint64_end - uint64_offset);
+    for (; uint64_offset < uint64_end; ++uint64_offset) {
+      int idx = map_slot(BinaryArrayAt<uint16_t>(uint64_slots, uint64_offset));
+      if (idx == -1) continue;
+      FeatureKey f;
+      f.uint64_feasign_ = BinaryArrayAt<uint64_t>(uint64_values, uint64_offset);
+      record.uint64_feasigns_.push_back(FeatureItem(f, idx));
+    }
+    record.float_feasigns_.reserve(float_end - float_offset);
+    for (; float_offset < float_end; ++float_offset) {
+      int idx = map_slot(BinaryArrayAt<uint16_t>(float_slots, float_offset));
+      if (idx == -1) continue;
+      FeatureKey f;
+      f.float_feasign_ = BinaryArrayAt<float>(float_values, float_offset);
+      record.float_feasigns_.push_back(FeatureItem(f, idx));
+    }
+    if (parse_ins_id_ || parse_logkey_) record.ins_id_ = std::move(ins_ids[i]);
+    if (parse_content_) record.content_ = std::move(contents[i]);
+    if (parse_logkey_) {
+      record.search_id = BinaryArrayAt<uint64_t>(search_ids, i);
+      record.cmatch = BinaryArrayAt<uint32_t>(cmatchs, i);
+      record.rank = BinaryArrayAt<uint32_t>(ranks, i);
+    }
+  }
+}
+
+void MultiSlotBinaryInMemoryDataFeed::WriteBinaryHeader(FILE* fp) {
+  binary_flags_ = 0;
+  if (parse_ins_id_ || parse_logkey_) binary_flags_ |= kBinaryInsId;
+  if (parse_content_) binary_flags_ |= kBinaryContent;
+  if (parse_logkey_) binary_flags_ |= kBinaryLogKey;
+  WriteBinaryBytes(kBinaryMagic, sizeof(kBinaryMagic), fp);
+  WriteBinaryValue(binary_flags_, fp);
+  // The slots of the records are the indexes of use_slots_.
+  WriteBinaryValue(static_cast<uint32_t>(use_slots_.size()), fp);
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    if (use_slots_index_[i] == -1) continue;
+    WriteBinaryValue(static_cast<uint16_t>(all_slots_[i].size()), fp);
+    WriteBinaryBytes(all_slots_[i].data(), all_slots_[i].size(), fp);
+    WriteBinaryValue(all_slots_type_[i][0], fp);
+  }
+}
+
+void MultiSlotBinaryInMemoryDataFeed::WriteBinaryBlock(
+    const std::vector<Record>& records, FILE* fp) {
+  std::vector<uint32_t> uint64_counts, float_counts;
+  std::vector<uint64_t> uint64_values;
+  std::vector<float> float_values;
+  std::vector<uint16_t> uint64_slots, float_slots;
+  std::vector<uint32_t> ins_id_lens, content_lens, cmatchs, ranks;
+  std::vector<uint64_t> search_ids;
+  std::string ins_ids, contents;
+  for (auto& record : records) {
+    uint64_counts.push_back(record.uint64_feasigns_.size());
+    for (auto& item : record.uint64_feasigns_) {
+      uint64_values.push_back(item.sign().uint64_feasign_);
+      uint64_slots.push_back(item.slot());
+    }
+    float_counts.push_back(record.float_feasigns_.size());
+    for (auto& item : record.float_feasigns_) {
+      float_values.push_back(item.sign().float_feasign_);
+      float_slots.push_back(item.slot());
+    }
+    if (binary_flags_ & kBinaryInsId) {
+      ins_id_lens.push_back(record.ins_id_.size());
+      ins_ids += record.ins_id_;
+    }
+    if (binary_flags_ & kBinaryContent) {
+      content_lens.push_back(record.content_.size());
+      contents += record.content_;
+    }
+    if (binary_flags_ & kBinaryLogKey) {
+      search_ids.push_back(record.search_id);
+      cmatchs.push_back(record.cmatch);
+      ranks.push_back(record.rank);
+    }
+  }
+
+  uint64_t block_bytes =
+      2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) +
+      (uint64_counts.size() + float_counts.size()) * sizeof(uint32_t) +
+      uint64_values.size() * sizeof(uint64_t) +
+      float_values.size() * sizeof(float) +
+      (uint64_slots.size() + float_slots.size()) * sizeof(uint16_t) +
+      (ins_id_lens.size() + content_lens.size()) * sizeof(uint32_t) +
+      ins_ids.size() + contents.size() + search_ids.size() * sizeof(uint64_t) +
+      (cmatchs.size() + ranks.size()) * sizeof(uint32_t);
+  WriteBinaryValue(block_bytes, fp);
+  WriteBinaryValue(static_cast<uint32_t>(records.size()), fp);
+  WriteBinaryValue(static_cast<uint32_t>(0), fp);
+  WriteBinaryValue(static_cast<uint64_t>(uint64_values.size()), fp);
+  WriteBinaryValue(static_cast<uint64_t>(float_values.size()), fp);
+  WriteBinaryArray(uint64_counts, fp);
+  WriteBinaryArray(float_counts, fp);
+  WriteBinaryArray(uint64_values, fp);
+  WriteBinaryArray(float_values, fp);
+  WriteBinaryArray(uint64_slots, fp);
+  WriteBinaryArray(float_slots, fp);
+  if (binary_flags_ & kBinaryInsId) {
+    WriteBinaryArray(ins_id_lens, fp);
+    WriteBinaryBytes(ins_ids.data(), ins_ids.size(), fp);
+  }
+  if (binary_flags_ & kBinaryContent) {
+    WriteBinaryArray(content_lens, fp);
+    WriteBinaryBytes(contents.data(), contents.size(), fp);
+  }
+  if (binary_flags_ & kBinaryLogKey) {
+    WriteBinaryArray(search_ids, fp);
+    WriteBinaryArray(cmatchs, fp);
+    WriteBinaryArray(ranks, fp);
+  }
+}
+
+void MultiSlotBinaryInMemoryDataFeed::LoadIntoMemory() {
+#ifdef _LINUX
+  VLOG(3) << "LoadIntoMemory() begin, thread_id=" << thread_id_;
+  std::string filename;
+  while (this->PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+    paddle::framework::ChannelWriter<Record> writer(input_channel_);
+    std::vector<Record> records;
+    uint64_t record_num = 0;
+    auto write_records = [&]() {
+      record_num += records.size();
+      for (auto& record : records) {
+        writer << std::move(record);
+      }
+      records.clear();
+    };
+    platform::Timer timeline;
+    timeline.Start();
+    uint64_t begin_ns = DataPipelineStat::NowNs();
+    uint64_t bytes = 0;
+    if (fs_select_internal(filename) == 0 &&
+        (pipe_command_.empty() || pipe_command_ == "cat")) {
+      int fd = open(filename.c_str(), O_RDONLY);
+      PADDLE_ENFORCE_NE(fd, -1, platform::errors::NotFound(
+                                    "Fail to open file: %s", filename));
+      struct stat sb;
+      fstat(fd, &sb);
+      size_t size = static_cast<size_t>(sb.st_size);
+      char* data = nullptr;
+      if (size > 0) {
+        data = reinterpret_cast<char*>(
+            mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0));
+        PADDLE_ENFORCE_NE(data, MAP_FAILED,
+                          platform::errors::Unavailable(
+                              "Fail to mmap file %s: %s", filename,
+                              strerror(errno)));
+        madvise(data, size, MADV_SEQUENTIAL);
+      }
+      bytes = size;
+      size_t offset = ParseBinaryHeader(data, size);
+      while (offset < size) {
+        const char* cursor = data + offset;
+        auto block_bytes = ReadBinaryValue<uint64_t>(&cursor, data + size);
+        SkipBinaryArray<char>(&cursor, data + size, block_bytes);
+        ParseBinaryBlock(cursor - block_bytes, block_bytes, &records);
+        write_records();
+        offset = cursor - data;
+      }
+      if (data != nullptr) munmap(data, size);
+      close(fd);
+    } else {
+      int err_no = 0;
+      this->fp_ = this->OpenPickedFile(filename, &err_no);
+      CHECK(this->fp_ != nullptr);
+      FILE* fp = this->fp_.get();
+      // The header is read piece by piece since its size is unknown.
+      std::string buffer;
+      bool ok = ReadBinaryBytes(fp, sizeof(kBinaryMagic) + 8, &buffer);
+      PADDLE_ENFORCE_EQ(
+          ok && memcmp(buffer.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0,
+          true, platform::errors::InvalidArgument(
+                    "The file %s is not a binary data file, please convert it "
+                    "by InMemoryDataset.convert_to_binary first.",
+                    filename));
+      uint32_t slot_num = 0;
+      if (ok) memcpy(&slot_num, &buffer[sizeof(kBinaryMagic) + 4], 4);
+      for (uint32_t i = 0; ok && i < slot_num; ++i) {
+        ok = ReadBinaryBytes(fp, sizeof(uint16_t), &buffer);
+        uint16_t len = 0;
+        if (ok) memcpy(&len, &buffer[buffer.size() - sizeof(len)], sizeof(len));
+        ok = ok && ReadBinaryBytes(fp, len + 1, &buffer);
+      }
+      PADDLE_ENFORCE_EQ(ok, true, platform::errors::InvalidArgument(
+                                      "The binary data file %s is truncated.",
+                                      filename));
+      ParseBinaryHeader(buffer.data(), buffer.size());
+      bytes = buffer.size();
+      uint64_t block_bytes = 0;
+      while (fread(&block_bytes, sizeof(block_bytes), 1, fp) == 1) {
+        buffer.clear();
+        PADDLE_ENFORCE_EQ(ReadBinaryBytes(fp, block_bytes, &buffer), true,
+                          platform::errors::InvalidArgument(
+                              "The binary data file %s is truncated.",
+                              filename));
+        bytes += sizeof(block_bytes) + buffer.size();
+        ParseBinaryBlock(buffer.data(), buffer.size(), &records);
+        write_records();
+      }
+    }
+    writer.Flush();
+    if (pipeline_stat_ != nullptr) {
+      pipeline_stat_->Add(kReadStage, record_num, bytes, begin_ns,
+                          DataPipelineStat::NowNs());
+    }
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemory() read all blocks, file=" << filename
+            << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+  VLOG(3) << "LoadIntoMemory() end, thread_id=" << thread_id_;
+#endif
+}
+
+void MultiSlotBinaryInMemoryDataFeed::ConvertToBinary(
+    const std::string& output_dir) {
+#ifdef _LINUX
+  std::string filename;
+  while (this->PickOneFile(&filename)) {
+    int err_no = 0;
+    this->fp_ = this->OpenPickedFile(filename, &err_no);
+    CHECK(this->fp_ != nullptr);
+    __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+
+    auto pos = filename.find_last_of('/');
+    std::string output_file =
+        output_dir + "/" +
+        (pos == std::string::npos ? filename : filename.substr(pos + 1));
+    auto output_fp = fs_open_write(output_file, &err_no, "");
+    PADDLE_ENFORCE_NOT_NULL(
+        output_fp.get(),
+        platform::errors::Unavailable("Fail to open file: %s", output_file));
+
+    WriteBinaryHeader(output_fp.get());
+    std::vector<Record> records;
+    records.reserve(kBinaryBlockRecordNum);
+    Record instance;
+    while (ParseOneInstanceFromPipe(&instance)) {
+      records.emplace_back(std::move(instance));
+      instance = Record();
+      if (records.size() == kBinaryBlockRecordNum) {
+        WriteBinaryBlock(records, output_fp.get());
+        records.clear();
+      }
+    }
+    if (!records.empty()) {
+      WriteBinaryBlock(records, output_fp.get());
+    }
+    VLOG(3) << "ConvertToBinary() " << filename << " to " << output_file
+            << ", thread_id=" << thread_id_;
   }
 #endif
 }
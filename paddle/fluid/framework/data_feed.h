@@ -23,6 +23,7 @@ limitations under the License. */
 #include <future>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
+#include <random>
 #include <sstream>
 #include <string>
 #include <thread>  // NOLINT
@@ -35,10 +36,16 @@ limitations under the License. */
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/data_feed.pb.h"
+#include "paddle/fluid/framework/data_pipeline_stat.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/framework/io/fs.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/memory/malloc.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_resource_pool.h"
+#endif
 #include "paddle/fluid/string/string_helper.h"
 
 namespace paddle {
@@ -163,10 +170,22 @@ class DataFeed {
   virtual void SetParseLogKey(bool parse_logkey) {}
   virtual void SetEnablePvMerge(bool enable_pv_merge) {}
   virtual void SetCurrentPhase(int current_phase) {}
+  // If set, the output channel is filled while reading, so Next() waits for
+  // it until it is closed, and the records are not kept for the next pass.
+  virtual void SetStreamingOutput(bool streaming_output) {}
   virtual void SetFileListMutex(std::mutex* mutex) {
     mutex_for_pick_file_ = mutex;
   }
   virtual void SetFileListIndex(size_t* file_index) { file_idx_ = file_index; }
+  // If set, the picked files are opened by file_read_ahead, whose file list
+  // must be the same as the one of this DataFeed.
+  virtual void SetFileReadAhead(FileReadAhead* file_read_ahead) {
+    file_read_ahead_ = file_read_ahead;
+  }
+  // the stages of the DataFeed are counted in pipeline_stat if it is set
+  virtual void SetPipelineStat(DataPipelineStat* pipeline_stat) {
+    pipeline_stat_ = pipeline_stat;
+  }
   virtual const std::vector<std::string>& GetInsIdVec() const {
     return ins_id_vec_;
   }
@@ -177,6 +196,10 @@ class DataFeed {
   virtual void LoadIntoMemory() {
     PADDLE_THROW("This function(LoadIntoMemory) is not implemented.");
   }
+  // convert the files into the binary format, and write them to output_dir
+  virtual void ConvertToBinary(const std::string& output_dir) {
+    PADDLE_THROW("This function(ConvertToBinary) is not implemented.");
+  }
   virtual void SetPlace(const paddle::platform::Place& place) {
     place_ = place;
   }
@@ -194,11 +217,17 @@ class DataFeed {
   // This function is used to pick one file from the global filelist(thread
   // safe).
   virtual bool PickOneFile(std::string* filename);
+  // Open the file picked last time, the same as fs_open_read.
+  std::shared_ptr<FILE> OpenPickedFile(const std::string& filename,
+                                       int* err_no);
   virtual void CopyToFeedTensor(void* dst, const void* src, size_t size);
 
   std::vector<std::string> filelist_;
   size_t* file_idx_;
   std::mutex* mutex_for_pick_file_;
+  size_t picked_file_index_{0};
+  FileReadAhead* file_read_ahead_{nullptr};
+  DataPipelineStat* pipeline_stat_{nullptr};
 
   // the alias of used slots, and its order is determined by
   // data_feed_desc(proto object)
@@ -302,12 +331,19 @@ class InMemoryDataFeed : public DataFeed {
   virtual void SetParseLogKey(bool parse_logkey);
   virtual void SetEnablePvMerge(bool enable_pv_merge);
   virtual void SetCurrentPhase(int current_phase);
+  virtual void SetStreamingOutput(bool streaming_output);
   virtual void LoadIntoMemory();
 
  protected:
   virtual bool ParseOneInstance(T* instance) = 0;
   virtual bool ParseOneInstanceFromPipe(T* instance) = 0;
   virtual void PutToFeedVec(const std::vector<T>& ins_vec) = 0;
+  // The length of the instance which the batches are bucketed by.
+  virtual uint64_t InstanceLength(const T& instance) { return 0; }
+  // Read bucket_window_ instances from output_channel_, sort them by length,
+  // and split them into the batches of similar lengths, which are appended to
+  // bucket_batches_ in random order.
+  void FillBucketBatches();
 
   int thread_id_;
   int thread_num_;
@@ -316,6 +352,17 @@ class InMemoryDataFeed : public DataFeed {
   bool parse_logkey_;
   bool enable_pv_merge_;
   int current_phase_{-1};  // only for untest
+  bool streaming_output_{false};
+  // the bytes parsed by ParseOneInstanceFromPipe, for DataPipelineStat
+  uint64_t parsed_bytes_{0};
+  // the time the last Next() returns, for DataPipelineStat
+  uint64_t last_next_end_ns_{0};
+  // the batches are bucketed by length if bucket_window_ > 0, and the order
+  // of the batches is determined by bucket_seed_
+  int bucket_window_{0};
+  int bucket_seed_{0};
+  std::mt19937_64 bucket_engine_;
+  std::deque<std::vector<T>> bucket_batches_;
   std::ifstream file_;
   std::shared_ptr<FILE> fp_;
   paddle::framework::ChannelObject<T>* input_channel_;
@@ -659,10 +706,38 @@ class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
   virtual void PutToFeedVec(const std::vector<Record>& ins_vec);
   virtual void GetMsgFromLogKey(const std::string& log_key, uint64_t* search_id,
                                 uint32_t* cmatch, uint32_t* rank);
+  // the number of feasigns of the bucket slot in the instance
+  virtual uint64_t InstanceLength(const Record& instance);
+  // Scatter the records into the feed tensors directly, without the
+  // intermediate batch_*_feasigns_. It is used if zero_copy_feed is set.
+  void PutToFeedVecZeroCopy(const std::vector<Record>& ins_vec);
+  // Set the LoD and the shape of the i-th feed tensor by offset_[i].
+  void SetFeedLoDAndShape(size_t i);
+  // Return the staging buffer of at least size bytes for the next batch.
+  char* NextStagingBuffer(size_t size);
+
   std::vector<std::vector<float>> batch_float_feasigns_;
   std::vector<std::vector<uint64_t>> batch_uint64_feasigns_;
   std::vector<std::vector<size_t>> offset_;
   std::vector<bool> visit_;
+  // the index in use_slots_ of the slot which the batches are bucketed by
+  int bucket_slot_index_{-1};
+
+  bool zero_copy_feed_{false};
+  // The largest number of feasigns of each slot in history. The feed tensors
+  // are allocated with it, so that they are not reallocated in most batches.
+  std::vector<size_t> feed_capacity_;
+  std::vector<size_t> slot_pos_;
+  std::vector<float*> float_dst_;
+  std::vector<int64_t*> uint64_dst_;
+  // The double buffered pinned memory to stage the batch when the feed
+  // tensors are on GPU. The batch is scattered into one buffer while the
+  // copy from the other one may still be running.
+  memory::AllocationPtr staging_buffers_[2];
+  int cur_staging_buffer_{0};
+#ifdef PADDLE_WITH_CUDA
+  std::shared_ptr<platform::CudaEventObject> staging_events_[2];
+#endif
 };
 
 class PaddleBoxDataFeed : public MultiSlotInMemoryDataFeed {
@@ -684,6 +759,57 @@ class PaddleBoxDataFeed : public MultiSlotInMemoryDataFeed {
   int pv_batch_size_;
 };
 
+// This DataFeed loads the slot-columnar binary files converted by
+// ConvertToBinary, which are much cheaper to load than text files since no
+// number is parsed.
+// The format of the binary file:
+//   header: magic(8 bytes) flags(uint32) slot_num(uint32)
+//           [name_len(uint16) name type(char)]*
+//   block:  block_bytes(uint64) record_num(uint32) reserved(uint32)
+//           uint64_num(uint64) float_num(uint64)
+//           uint64_counts(uint32[record_num]) float_counts(uint32[record_num])
+//           uint64_values(uint64[uint64_num]) float_values(float[float_num])
+//           uint64_slots(uint16[uint64_num]) float_slots(uint16[float_num])
+//           [ins_id_lens(uint32[record_num]) ins_ids]       if kBinaryInsId
+//           [content_lens(uint32[record_num]) contents]     if kBinaryContent
+//           [search_ids(uint64[record_num]) cmatchs(uint32[record_num])
+//            ranks(uint32[record_num])]                      if kBinaryLogKey
+// where the slots are the indexes in the slot list of the header, and
+// block_bytes is the size of the block after itself.
+// Local files are mmapped, and the others are read through pipe_command.
+class MultiSlotBinaryInMemoryDataFeed : public MultiSlotInMemoryDataFeed {
+ public:
+  static constexpr char kBinaryMagic[8] = {'P', 'D', 'M', 'S',
+                                           'L', 'O', 'T', '1'};
+  static constexpr uint32_t kBinaryInsId = 1;
+  static constexpr uint32_t kBinaryContent = 2;
+  static constexpr uint32_t kBinaryLogKey = 4;
+  // the number of records in each block written by ConvertToBinary
+  static constexpr size_t kBinaryBlockRecordNum = 4096;
+
+  MultiSlotBinaryInMemoryDataFeed() {}
+  virtual ~MultiSlotBinaryInMemoryDataFeed() {}
+  virtual void LoadIntoMemory();
+  // parse the text files with the slots of data_feed_desc, and write them
+  // to output_dir in the binary format, with the same file names.
+  virtual void ConvertToBinary(const std::string& output_dir);
+
+ protected:
+  // parse the header, and return its size
+  size_t ParseBinaryHeader(const char* data, size_t size);
+  // parse a block (after block_bytes) into records
+  void ParseBinaryBlock(const char* data, size_t size,
+                        std::vector<Record>* records);
+  void WriteBinaryHeader(FILE* fp);
+  void WriteBinaryBlock(const std::vector<Record>& records, FILE* fp);
+
+  // the flags of the current file
+  uint32_t binary_flags_{0};
+  // from the slot index of the current file to the index of use_slots_,
+  // -1 if the slot is not used.
+  std::vector<int> binary_slot_map_;
+};
+
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
 template <typename T>
 class PrivateInstantDataFeed : public DataFeed {
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <limits>
+#include <map>
+#include <string>
+
+namespace paddle {
+namespace framework {
+
+enum DataPipelineStage {
+  // read and parse the files into the input channel
+  kReadStage = 0,
+  // shuffle the records locally or globally, the bytes are the ones sent
+  kShuffleStage,
+  // merge the records by ins id
+  kMergeStage,
+  // copy the records of the batches to the feed tensors
+  kFeedStage,
+  // train with the batches, i.e., the time between two calls of Next()
+  kConsumeStage,
+  kStageNum
+};
+
+// DataPipelineStat counts the records and the bytes processed by each stage
+// of the dataset pipeline and the time it costs, so that it can be told
+// whether a job is bound by IO, parsing or training. It is always on, and it
+// is updated with a few relaxed atomic operations per file or per batch.
+class DataPipelineStat {
+ public:
+  static uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static const char* StageName(int stage) {
+    static const char* names[kStageNum] = {"read", "shuffle", "merge", "feed",
+                                           "consume"};
+    return names[stage];
+  }
+
+  // The stage processed records and bytes in [begin_ns, end_ns).
+  void Add(DataPipelineStage stage, uint64_t records, uint64_t bytes,
+           uint64_t begin_ns, uint64_t end_ns) {
+    auto& s = stages_[stage];
+    s.records.fetch_add(records, std::memory_order_relaxed);
+    s.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    s.busy_ns.fetch_add(end_ns - begin_ns, std::memory_order_relaxed);
+    AtomicMin(&s.first_begin_ns, begin_ns);
+    AtomicMax(&s.last_end_ns, end_ns);
+  }
+
+  void Reset() {
+    for (auto& s : stages_) {
+      s.records = 0;
+      s.bytes = 0;
+      s.busy_ns = 0;
+      s.first_begin_ns = (std::numeric_limits<uint64_t>::max)();
+      s.last_end_ns = 0;
+    }
+  }
+
+  // For each stage, records and bytes, busy_sec which is summed over the
+  // threads, wall_sec from the first begin to the last end, and the
+  // records_per_sec and bytes_per_sec in the wall time.
+  std::map<std::string, std::map<std::string, double>> ToMap() const {
+    std::map<std::string, std::map<std::string, double>> ret;
+    for (int i = 0; i < kStageNum; ++i) {
+      auto& s = stages_[i];
+      auto& m = ret[StageName(i)];
+      uint64_t first = s.first_begin_ns, last = s.last_end_ns;
+      double wall_sec = last > first ? (last - first) * 1e-9 : 0.0;
+      m["records"] = s.records;
+      m["bytes"] = s.bytes;
+      m["busy_sec"] = s.busy_ns * 1e-9;
+      m["wall_sec"] = wall_sec;
+      m["records_per_sec"] = wall_sec > 0 ? s.records / wall_sec : 0.0;
+      m["bytes_per_sec"] = wall_sec > 0 ? s.bytes / wall_sec : 0.0;
+    }
+    return ret;
+  }
+
+ private:
+  struct StageStat {
+    std::atomic<uint64_t> records{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> busy_ns{0};
+    std::atomic<uint64_t> first_begin_ns{
+        (std::numeric_limits<uint64_t>::max)()};
+    std::atomic<uint64_t> last_end_ns{0};
+  };
+
+  static void AtomicMin(std::atomic<uint64_t>* x, uint64_t v) {
+    uint64_t old = x->load(std::memory_order_relaxed);
+    while (v < old && !x->compare_exchange_weak(old, v)) {
+    }
+  }
+
+  static void AtomicMax(std::atomic<uint64_t>* x, uint64_t v) {
+    uint64_t old = x->load(std::memory_order_relaxed);
+    while (v > old && !x->compare_exchange_weak(old, v)) {
+    }
+  }
+
+  StageStat stages_[kStageNum];
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/framework/data_set.h"
 #include <algorithm>
+#include <deque>
+#include <iterator>
+#include <limits>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
@@ -23,8 +26,10 @@
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 #include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/timer.h"
 #include "xxhash.h"  // NOLINT
+#include "zlib.h"    // NOLINT
 
 #if defined _WIN32 || defined __APPLE__
 #else
@@ -34,6 +39,56 @@
 namespace paddle {
 namespace framework {
 
+// The message types of global shuffle, the compressed message is
+// [uint64 length of the archive][archive compressed by zlib].
+static constexpr int kShuffleMsg = 0;
+static constexpr int kCompressedShuffleMsg = 1;
+
+// The reader threads are IO threads, see platform::BindThreadToKind.
+static void LoadIntoMemoryOnIOThread(std::shared_ptr<DataFeed> reader,
+                                     int index) {
+  platform::BindThreadToKind(platform::ThreadKind::kIO, index);
+  reader->LoadIntoMemory();
+}
+
+static std::string CompressShuffleMsg(const char* data, size_t len) {
+  uLongf compressed_len = compressBound(len);
+  std::string msg(sizeof(uint64_t) + compressed_len, '\0');
+  uint64_t raw_len = len;
+  memcpy(&msg[0], &raw_len, sizeof(uint64_t));
+  int ret = compress2(reinterpret_cast<Bytef*>(&msg[sizeof(uint64_t)]),
+                      &compressed_len, reinterpret_cast<const Bytef*>(data),
+                      len, Z_BEST_SPEED);
+  PADDLE_ENFORCE_EQ(ret, Z_OK, platform::errors::External(
+                                   "Failed to compress the global shuffle "
+                                   "message, zlib error code is %d.",
+                                   ret));
+  msg.resize(sizeof(uint64_t) + compressed_len);
+  return msg;
+}
+
+static std::string DecompressShuffleMsg(const std::string& msg) {
+  PADDLE_ENFORCE_GE(msg.length(), sizeof(uint64_t),
+                    platform::errors::InvalidArgument(
+                        "The compressed global shuffle message is too short, "
+                        "its length is %d.",
+                        msg.length()));
+  uint64_t raw_len = 0;
+  memcpy(&raw_len, msg.data(), sizeof(uint64_t));
+  std::string raw(raw_len, '\0');
+  uLongf len = raw_len;
+  int ret = uncompress(reinterpret_cast<Bytef*>(&raw[0]), &len,
+                       reinterpret_cast<const Bytef*>(msg.data()) +
+                           sizeof(uint64_t),
+                       msg.length() - sizeof(uint64_t));
+  PADDLE_ENFORCE_EQ(ret == Z_OK && len == raw_len, true,
+                    platform::errors::External(
+                        "Failed to decompress the global shuffle message, "
+                        "zlib error code is %d.",
+                        ret));
+  return raw;
+}
+
 // constructor
 template <typename T>
 DatasetImpl<T>::DatasetImpl() {
@@ -45,6 +100,9 @@ DatasetImpl<T>::DatasetImpl() {
   cur_channel_ = 0;
   fleet_send_batch_size_ = 1024;
   fleet_send_sleep_seconds_ = 0;
+  fleet_send_window_size_ = 16;
+  compress_shuffle_msg_ = false;
+  channel_shard_num_ = 1;
   merge_by_insid_ = false;
   merge_by_sid_ = true;
   enable_pv_merge_ = false;
@@ -112,6 +170,10 @@ template <typename T>
 void DatasetImpl<T>::SetDataFeedDesc(const std::string& data_feed_desc_str) {
   google::protobuf::TextFormat::ParseFromString(data_feed_desc_str,
                                                 &data_feed_desc_);
+  if (data_feed_desc_.has_io_thread_cpus()) {
+    platform::SetThreadKindCPUs(platform::ThreadKind::kIO,
+                                data_feed_desc_.io_thread_cpus());
+  }
 }
 
 template <typename T>
@@ -178,18 +240,21 @@ std::vector<paddle::framework::DataFeed*> DatasetImpl<T>::GetReaders() {
 template <typename T>
 void DatasetImpl<T>::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<T>();
+    input_channel_ =
+        paddle::framework::MakeShardedChannel<T>(channel_shard_num_);
   }
   if (multi_output_channel_.size() == 0) {
     multi_output_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
-      multi_output_channel_.push_back(paddle::framework::MakeChannel<T>());
+      multi_output_channel_.push_back(
+          paddle::framework::MakeShardedChannel<T>(channel_shard_num_));
     }
   }
   if (multi_consume_channel_.size() == 0) {
     multi_consume_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
-      multi_consume_channel_.push_back(paddle::framework::MakeChannel<T>());
+      multi_consume_channel_.push_back(
+          paddle::framework::MakeShardedChannel<T>(channel_shard_num_));
     }
   }
   if (input_pv_channel_ == nullptr) {
@@ -214,10 +279,13 @@ template <typename T>
 void DatasetImpl<T>::RegisterClientToClientMsgHandler() {
   auto fleet_ptr = FleetWrapper::GetInstance();
   VLOG(3) << "RegisterClientToClientMsgHandler";
-  fleet_ptr->RegisterClientToClientMsgHandler(
-      0, [this](int msg_type, int client_id, const std::string& msg) -> int {
-        return this->ReceiveFromClient(msg_type, client_id, msg);
-      });
+  for (int msg_type : {kShuffleMsg, kCompressedShuffleMsg}) {
+    fleet_ptr->RegisterClientToClientMsgHandler(
+        msg_type,
+        [this](int msg_type, int client_id, const std::string& msg) -> int {
+          return this->ReceiveFromClient(msg_type, client_id, msg);
+        });
+  }
   VLOG(3) << "RegisterClientToClientMsgHandler done";
 }
 
@@ -225,13 +293,17 @@ void DatasetImpl<T>::RegisterClientToClientMsgHandler() {
 // which will later be fed into readers' channel
 template <typename T>
 void DatasetImpl<T>::LoadIntoMemory() {
+  if (!spill_dir_.empty()) {
+    LoadIntoSpillBuckets();
+    return;
+  }
   VLOG(3) << "DatasetImpl<T>::LoadIntoMemory() begin";
   platform::Timer timeline;
   timeline.Start();
   std::vector<std::thread> load_threads;
   for (int64_t i = 0; i < thread_num_; ++i) {
-    load_threads.push_back(std::thread(
-        &paddle::framework::DataFeed::LoadIntoMemory, readers_[i].get()));
+    load_threads.push_back(std::thread(LoadIntoMemoryOnIOThread, readers_[i],
+                                       static_cast<int>(i)));
   }
   for (std::thread& t : load_threads) {
     t.join();
@@ -246,23 +318,171 @@ void DatasetImpl<T>::LoadIntoMemory() {
           << ", cost time=" << timeline.ElapsedSec() << " seconds";
 }
 
+template <typename T>
+void DatasetImpl<T>::LoadIntoSpillBuckets() {
+  VLOG(3) << "DatasetImpl<T>::LoadIntoSpillBuckets() begin";
+  PADDLE_ENFORCE_EQ(
+      enable_pv_merge_, false,
+      platform::errors::Unimplemented(
+          "The spill mode of Dataset does not support pv merge."));
+  platform::Timer timeline;
+  timeline.Start();
+  StopSpillStream();
+  spill_buckets_.reset();
+  fs_mkdir(spill_dir_);
+  // Half of the budget buffers the buckets, and the input channel is bounded
+  // so that the readers wait for the spill threads instead of filling the
+  // memory.
+  spill_buckets_.reset(new SpillBuckets<T>(spill_dir_, spill_bucket_num_,
+                                           spill_memory_budget_ / 2));
+  const size_t kSpillBlockSize = 1024;
+  input_channel_->Open();
+  input_channel_->SetBlockSize(kSpillBlockSize);
+  input_channel_->SetCapacity(kSpillBlockSize * 4 * thread_num_);
+
+  std::vector<std::thread> spill_threads;
+  for (int64_t i = 0; i < thread_num_; ++i) {
+    spill_threads.push_back(std::thread([this]() {
+      auto& engine = FleetWrapper::GetInstance()->LocalRandomEngine();
+      std::vector<T> data;
+      while (this->input_channel_->Read(data)) {
+        this->spill_buckets_->Add(&data, &engine);
+      }
+    }));
+  }
+  std::vector<std::thread> load_threads;
+  for (int64_t i = 0; i < thread_num_; ++i) {
+    load_threads.push_back(std::thread(LoadIntoMemoryOnIOThread, readers_[i],
+                                       static_cast<int>(i)));
+  }
+  for (std::thread& t : load_threads) {
+    t.join();
+  }
+  input_channel_->Close();
+  for (std::thread& t : spill_threads) {
+    t.join();
+  }
+  spill_buckets_->Flush();
+  input_channel_->SetCapacity(std::numeric_limits<size_t>::max());
+
+  timeline.Pause();
+  VLOG(3) << "DatasetImpl<T>::LoadIntoSpillBuckets() end"
+          << ", spilled data size=" << spill_buckets_->Size()
+          << ", spilled bytes=" << spill_buckets_->SpilledBytes()
+          << ", cost time=" << timeline.ElapsedSec() << " seconds";
+}
+
+template <typename T>
+void DatasetImpl<T>::StartSpillStream() {
+  PADDLE_ENFORCE_NOT_NULL(
+      spill_buckets_,
+      platform::errors::PreconditionNotMet(
+          "The spill buckets are empty, please call load_into_memory first."));
+  StopSpillStream();
+  VLOG(3) << "DatasetImpl<T>::StartSpillStream() begin";
+  for (auto& reader : readers_) {
+    reader->SetStreamingOutput(true);
+  }
+  auto channels = ReaderOutputChannels();
+  PADDLE_ENFORCE_GT(channels.size(), 0,
+                    platform::errors::PreconditionNotMet(
+                        "The output channels of Dataset are not created."));
+  // Bound the records waiting in the channels by the other half of the
+  // memory budget, with the average size of the spilled records.
+  size_t record_bytes = std::max<size_t>(
+      spill_buckets_->SpilledBytes() /
+          std::max<size_t>(spill_buckets_->Size(), 1),
+      1);
+  size_t capacity = std::max<size_t>(
+      spill_memory_budget_ / 2 / record_bytes / channels.size(), 1024);
+  for (auto& channel : channels) {
+    channel->Clear();
+    channel->Open();
+    channel->SetCapacity(capacity);
+  }
+  spill_stream_thread_ = std::thread([this, channels]() {
+    const size_t kChunkSize = 256;
+    auto& engine = FleetWrapper::GetInstance()->LocalRandomEngine();
+    std::vector<T> data;
+    size_t next = 0;
+    for (size_t index : this->spill_buckets_->ShuffledOrder(&engine)) {
+      this->spill_buckets_->ReadBucket(index, &data, &engine);
+      VLOG(3) << "stream spill bucket " << index << ", size=" << data.size();
+      for (size_t begin = 0; begin < data.size(); begin += kChunkSize) {
+        size_t end = std::min(begin + kChunkSize, data.size());
+        std::vector<T> chunk(std::make_move_iterator(data.begin() + begin),
+                             std::make_move_iterator(data.begin() + end));
+        channels[next++ % channels.size()]->Write(std::move(chunk));
+      }
+      data.clear();
+    }
+    for (auto& channel : channels) {
+      channel->Close();
+    }
+  });
+}
+
+template <typename T>
+void DatasetImpl<T>::WaitSpillStreamDone() {
+  if (spill_stream_thread_.joinable()) {
+    spill_stream_thread_.join();
+  }
+  VLOG(3) << "DatasetImpl<T>::WaitSpillStreamDone() end";
+}
+
+template <typename T>
+void DatasetImpl<T>::StopSpillStream() {
+  if (!spill_stream_thread_.joinable()) {
+    return;
+  }
+  for (auto& channel : ReaderOutputChannels()) {
+    if (channel) {
+      channel->Close();
+    }
+  }
+  spill_stream_thread_.join();
+}
+
+template <typename T>
+void DatasetImpl<T>::ConvertToBinary(const std::string& output_dir) {
+  VLOG(3) << "DatasetImpl<T>::ConvertToBinary() begin";
+  platform::Timer timeline;
+  timeline.Start();
+  fs_mkdir(output_dir);
+  std::vector<std::thread> convert_threads;
+  for (int64_t i = 0; i < thread_num_; ++i) {
+    convert_threads.push_back(
+        std::thread(&paddle::framework::DataFeed::ConvertToBinary,
+                    readers_[i].get(), output_dir));
+  }
+  for (std::thread& t : convert_threads) {
+    t.join();
+  }
+  timeline.Pause();
+  VLOG(3) << "DatasetImpl<T>::ConvertToBinary() end, cost time="
+          << timeline.ElapsedSec() << " seconds";
+}
+
 template <typename T>
 void DatasetImpl<T>::PreLoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::PreLoadIntoMemory() begin";
+  PADDLE_ENFORCE_EQ(spill_dir_.empty(), true,
+                    platform::errors::Unimplemented(
+                        "The spill mode of Dataset does not support preload, "
+                        "please use load_into_memory instead."));
   if (preload_thread_num_ != 0) {
     CHECK(static_cast<size_t>(preload_thread_num_) == preload_readers_.size());
     preload_threads_.clear();
     for (int64_t i = 0; i < preload_thread_num_; ++i) {
-      preload_threads_.push_back(
-          std::thread(&paddle::framework::DataFeed::LoadIntoMemory,
-                      preload_readers_[i].get()));
+      preload_threads_.push_back(std::thread(
+          LoadIntoMemoryOnIOThread, preload_readers_[i], static_cast<int>(i)));
     }
   } else {
     CHECK(static_cast<size_t>(thread_num_) == readers_.size());
     preload_threads_.clear();
     for (int64_t i = 0; i < thread_num_; ++i) {
       preload_threads_.push_back(std::thread(
-          &paddle::framework::DataFeed::LoadIntoMemory, readers_[i].get()));
+          LoadIntoMemoryOnIOThread, readers_[i], static_cast<int>(i)));
     }
   }
   VLOG(3) << "DatasetImpl<T>::PreLoadIntoMemory() end";
@@ -284,6 +504,8 @@ void DatasetImpl<T>::WaitPreLoadDone() {
 template <typename T>
 void DatasetImpl<T>::ReleaseMemory() {
   VLOG(3) << "DatasetImpl<T>::ReleaseMemory() begin";
+  StopSpillStream();
+  spill_buckets_.reset();
   if (input_channel_) {
     input_channel_->Clear();
     input_channel_ = nullptr;
@@ -343,15 +565,19 @@ void DatasetImpl<T>::LocalShuffle() {
     return;
   }
   auto fleet_ptr = FleetWrapper::GetInstance();
+  uint64_t begin_ns = DataPipelineStat::NowNs();
   input_channel_->Close();
   std::vector<T> data;
   input_channel_->ReadAll(data);
+  uint64_t records = data.size();
   std::shuffle(data.begin(), data.end(), fleet_ptr->LocalRandomEngine());
   input_channel_->Open();
   input_channel_->Write(std::move(data));
   data.clear();
   data.shrink_to_fit();
   input_channel_->Close();
+  pipeline_stat_.Add(kShuffleStage, records, 0, begin_ns,
+                     DataPipelineStat::NowNs());
 
   timeline.Pause();
   VLOG(3) << "DatasetImpl<T>::LocalShuffle() end, cost time="
@@ -360,6 +586,10 @@ void DatasetImpl<T>::LocalShuffle() {
 
 template <typename T>
 void DatasetImpl<T>::GlobalShuffle(int thread_num) {
+  PADDLE_ENFORCE_EQ(spill_dir_.empty(), true,
+                    platform::errors::Unimplemented(
+                        "The spill mode of Dataset does not support global "
+                        "shuffle, the records are shuffled when streaming."));
 #ifdef PADDLE_WITH_PSLIB
   VLOG(3) << "DatasetImpl<T>::GlobalShuffle() begin";
   platform::Timer timeline;
@@ -395,16 +625,22 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
     }
   };
 
+  // Each thread keeps at most fleet_send_window_size_ messages in flight, so
+  // the next batch is serialized while the last ones are being sent, and the
+  // thread blocks only when the receivers fall behind.
   auto global_shuffle_func = [this, get_client_id]() {
     auto fleet_ptr = FleetWrapper::GetInstance();
     std::vector<T> data;
+    std::deque<std::future<int32_t>> in_flight;
+    size_t window_size = std::max(this->fleet_send_window_size_, 1);
+    uint64_t begin_ns = DataPipelineStat::NowNs();
     while (this->input_channel_->Read(data)) {
+      uint64_t bytes = 0;
       std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
       for (auto& t : data) {
         auto client_id = get_client_id(t);
         ars[client_id] << t;
       }
-      std::vector<std::future<int32_t>> total_status;
       std::vector<int> send_index(this->trainer_num_);
       for (int i = 0; i < this->trainer_num_; ++i) {
         send_index[i] = i;
@@ -416,24 +652,44 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
         if (ars[i].Length() == 0) {
           continue;
         }
-        std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
-        total_status.push_back(std::move(ret));
+        while (in_flight.size() >= window_size) {
+          in_flight.front().wait();
+          in_flight.pop_front();
+        }
+        bytes += ars[i].Length();
+        if (this->compress_shuffle_msg_) {
+          auto msg = CompressShuffleMsg(ars[i].Buffer(), ars[i].Length());
+          in_flight.push_back(
+              fleet_ptr->SendClientToClientMsg(kCompressedShuffleMsg, i, msg));
+        } else {
+          std::string msg(ars[i].Buffer(), ars[i].Length());
+          in_flight.push_back(
+              fleet_ptr->SendClientToClientMsg(kShuffleMsg, i, msg));
+        }
       }
-      for (auto& t : total_status) {
-        t.wait();
+      if (this->fleet_send_window_size_ == 0) {
+        while (!in_flight.empty()) {
+          in_flight.front().wait();
+          in_flight.pop_front();
+        }
       }
+      uint64_t end_ns = DataPipelineStat::NowNs();
+      this->pipeline_stat_.Add(kShuffleStage, data.size(), bytes, begin_ns,
+                               end_ns);
+      begin_ns = end_ns;
       ars.clear();
       ars.shrink_to_fit();
       data.clear();
       data.shrink_to_fit();
-      // currently we find bottleneck is server not able to handle large data
-      // in time, so we can remove this sleep and set fleet_send_batch_size to
-      // 1024, and set server thread to 24.
+      // the sleep is kept for compatibility, the send window bounds the
+      // pressure on the receivers instead.
       if (fleet_send_sleep_seconds_ != 0) {
         sleep(this->fleet_send_sleep_seconds_);
       }
     }
+    for (auto& t : in_flight) {
+      t.wait();
+    }
   };
 
   std::vector<std::thread> global_shuffle_threads;
@@ -539,8 +795,10 @@ void DatasetImpl<T>::DynamicAdjustChannelNum(int channel_num,
   for (int i = 0; i < channel_num; ++i) {
     local_vec.clear();
     total_data_channel->Read(local_vec);
-    new_other_channels.push_back(paddle::framework::MakeChannel<T>());
-    new_channels.push_back(paddle::framework::MakeChannel<T>());
+    new_other_channels.push_back(
+        paddle::framework::MakeShardedChannel<T>(channel_shard_num_));
+    new_channels.push_back(
+        paddle::framework::MakeShardedChannel<T>(channel_shard_num_));
     new_channels[i]->Write(std::move(local_vec));
     new_other_pv_channels.push_back(
         paddle::framework::MakeChannel<PvInstance>());
@@ -593,6 +851,105 @@ void DatasetImpl<T>::SetFleetSendSleepSeconds(int seconds) {
   fleet_send_sleep_seconds_ = seconds;
 }
 
+template <typename T>
+void DatasetImpl<T>::SetFleetSendWindowSize(int window_size) {
+  fleet_send_window_size_ = window_size;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetCompressShuffleMsg(bool compress) {
+  compress_shuffle_msg_ = compress;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetChannelShardNum(int shard_num) {
+  PADDLE_ENFORCE_GT(shard_num, 0,
+                    platform::errors::InvalidArgument(
+                        "The channel shard num must be larger than 0, but "
+                        "received %d.",
+                        shard_num));
+  channel_shard_num_ = shard_num;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetSpillConfig(const std::string& spill_dir,
+                                    int64_t memory_budget_mb, int bucket_num) {
+  PADDLE_ENFORCE_GT(memory_budget_mb, 0,
+                    platform::errors::InvalidArgument(
+                        "The memory budget of the spill mode must be larger "
+                        "than 0, but received %d.",
+                        memory_budget_mb));
+  PADDLE_ENFORCE_GT(bucket_num, 0,
+                    platform::errors::InvalidArgument(
+                        "The bucket num of the spill mode must be larger than "
+                        "0, but received %d.",
+                        bucket_num));
+  spill_dir_ = spill_dir;
+  spill_memory_budget_ = static_cast<size_t>(memory_budget_mb) << 20;
+  spill_bucket_num_ = bucket_num;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetReadAhead(int depth, const std::string& tmp_dir,
+                                  int download_thread_num,
+                                  int decompress_thread_num) {
+  PADDLE_ENFORCE_GE(depth, 0, platform::errors::InvalidArgument(
+                                  "The read ahead depth must be non-negative, "
+                                  "but received %d.",
+                                  depth));
+  if (depth > 0) {
+    PADDLE_ENFORCE_EQ(download_thread_num > 0 && decompress_thread_num > 0,
+                      true, platform::errors::InvalidArgument(
+                                "The download thread num and the decompress "
+                                "thread num of read ahead must be larger than "
+                                "0, but received %d and %d.",
+                                download_thread_num, decompress_thread_num));
+  }
+  read_ahead_depth_ = depth;
+  read_ahead_tmp_dir_ = tmp_dir;
+  read_ahead_download_thread_num_ = download_thread_num;
+  read_ahead_decompress_thread_num_ = decompress_thread_num;
+}
+
+template <typename T>
+FileReadAhead* DatasetImpl<T>::ResetFileReadAhead() {
+  file_read_ahead_.reset();
+  if (read_ahead_depth_ > 0) {
+    file_read_ahead_ = std::make_shared<FileReadAhead>(
+        filelist_, read_ahead_tmp_dir_, read_ahead_depth_,
+        read_ahead_download_thread_num_, read_ahead_decompress_thread_num_);
+  }
+  return file_read_ahead_.get();
+}
+
+template <typename T>
+std::map<std::string, std::map<std::string, double>>
+DatasetImpl<T>::GetPipelineStat() {
+  auto ret = pipeline_stat_.ToMap();
+  auto add_channel = [&ret](const std::string& name,
+                            const std::vector<Channel<T>>& channels) {
+    auto& m = ret[name];
+    m["size"] = 0;
+    m["read_blocked_sec"] = 0;
+    m["write_blocked_sec"] = 0;
+    for (auto& channel : channels) {
+      if (channel == nullptr) continue;
+      m["size"] += channel->Size();
+      m["read_blocked_sec"] += channel->ReadBlockedTime();
+      m["write_blocked_sec"] += channel->WriteBlockedTime();
+    }
+  };
+  add_channel("input_channel", {input_channel_});
+  add_channel("output_channel", multi_output_channel_);
+  add_channel("consume_channel", multi_consume_channel_);
+  return ret;
+}
+
+template <typename T>
+void DatasetImpl<T>::ResetPipelineStat() {
+  pipeline_stat_.Reset();
+}
+
 template <typename T>
 void DatasetImpl<T>::CreateReaders() {
   VLOG(3) << "Calling CreateReaders()";
@@ -609,6 +966,7 @@ void DatasetImpl<T>::CreateReaders() {
     return;
   }
   VLOG(3) << "data feed class name: " << data_feed_desc_.name();
+  FileReadAhead* file_read_ahead = ResetFileReadAhead();
   int channel_idx = 0;
   for (int i = 0; i < thread_num_; ++i) {
     readers_.push_back(DataFeedFactory::CreateDataFeed(data_feed_desc_.name()));
@@ -618,6 +976,8 @@ void DatasetImpl<T>::CreateReaders() {
     readers_[i]->SetFileListMutex(&mutex_for_pick_file_);
     readers_[i]->SetFileListIndex(&file_idx_);
     readers_[i]->SetFileList(filelist_);
+    readers_[i]->SetFileReadAhead(file_read_ahead);
+    readers_[i]->SetPipelineStat(&pipeline_stat_);
     readers_[i]->SetParseInsId(parse_ins_id_);
     readers_[i]->SetParseContent(parse_content_);
     readers_[i]->SetParseLogKey(parse_logkey_);
@@ -659,6 +1019,7 @@ void DatasetImpl<T>::DestroyReaders() {
   VLOG(3) << "readers size1: " << readers_.size();
   std::vector<std::shared_ptr<paddle::framework::DataFeed>>().swap(readers_);
   VLOG(3) << "readers size: " << readers_.size();
+  file_read_ahead_.reset();
   file_idx_ = 0;
   cur_channel_ = 1 - cur_channel_;
 }
@@ -677,6 +1038,7 @@ void DatasetImpl<T>::CreatePreLoadReaders() {
   CHECK(preload_thread_num_ > 0) << "thread num should > 0";
   CHECK(input_channel_ != nullptr);
   preload_readers_.clear();
+  FileReadAhead* file_read_ahead = ResetFileReadAhead();
   for (int i = 0; i < preload_thread_num_; ++i) {
     preload_readers_.push_back(
         DataFeedFactory::CreateDataFeed(data_feed_desc_.name()));
@@ -686,6 +1048,8 @@ void DatasetImpl<T>::CreatePreLoadReaders() {
     preload_readers_[i]->SetFileListMutex(&mutex_for_pick_file_);
     preload_readers_[i]->SetFileListIndex(&file_idx_);
     preload_readers_[i]->SetFileList(filelist_);
+    preload_readers_[i]->SetFileReadAhead(file_read_ahead);
+    preload_readers_[i]->SetPipelineStat(&pipeline_stat_);
     preload_readers_[i]->SetParseInsId(parse_ins_id_);
     preload_readers_[i]->SetParseContent(parse_content_);
     preload_readers_[i]->SetParseLogKey(parse_logkey_);
@@ -705,12 +1069,16 @@ void DatasetImpl<T>::DestroyPreLoadReaders() {
   preload_readers_.clear();
   std::vector<std::shared_ptr<paddle::framework::DataFeed>>().swap(
       preload_readers_);
+  file_read_ahead_.reset();
   file_idx_ = 0;
   VLOG(3) << "End DestroyPreLoadReaders";
 }
 
 template <typename T>
 int64_t DatasetImpl<T>::GetMemoryDataSize() {
+  if (spill_buckets_ != nullptr) {
+    return spill_buckets_->Size();
+  }
   return input_channel_->Size();
 }
 
@@ -742,8 +1110,14 @@ int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
   if (msg.length() == 0) {
     return 0;
   }
+  std::string raw;
+  if (msg_type == kCompressedShuffleMsg) {
+    raw = DecompressShuffleMsg(msg);
+  }
+  const std::string& content = msg_type == kCompressedShuffleMsg ? raw : msg;
   paddle::framework::BinaryArchive ar;
-  ar.SetReadBuffer(const_cast<char*>(msg.c_str()), msg.length(), nullptr);
+  ar.SetReadBuffer(const_cast<char*>(content.c_str()), content.length(),
+                   nullptr);
   if (ar.Cursor() == ar.Finish()) {
     return 0;
   }
@@ -962,6 +1336,7 @@ void MultiSlotDataset::MergeByInsId() {
     }
   }
   CHECK(multi_output_channel_.size() != 0);  // NOLINT
+  uint64_t begin_ns = DataPipelineStat::NowNs();
   auto channel_data = paddle::framework::MakeChannel<Record>();
   VLOG(3) << "multi_output_channel_.size() " << multi_output_channel_.size();
   for (size_t i = 0; i < multi_output_channel_.size(); ++i) {
@@ -978,6 +1353,7 @@ void MultiSlotDataset::MergeByInsId() {
   recs.reserve(channel_data->Size());
   channel_data->ReadAll(recs);
   channel_data->Clear();
+  uint64_t records = recs.size();
   std::sort(recs.begin(), recs.end(), [](const Record& a, const Record& b) {
     return a.ins_id_ < b.ins_id_;
   });
@@ -1138,6 +1514,8 @@ void MultiSlotDataset::MergeByInsId() {
   }
   CHECK(channel_data->Size() == 0);  // NOLINT
   channel_data->Clear();
+  pipeline_stat_.Add(kMergeStage, records, 0, begin_ns,
+                     DataPipelineStat::NowNs());
   VLOG(3) << "MultiSlotDataset::MergeByInsId end";
 }
 
@@ -26,6 +26,8 @@
 #include <vector>
 
 #include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/data_pipeline_stat.h"
+#include "paddle/fluid/framework/spill_buckets.h"
 
 namespace paddle {
 namespace framework {
@@ -99,6 +101,9 @@ class Dataset {
   virtual void RegisterClientToClientMsgHandler() = 0;
   // load all data into memory
   virtual void LoadIntoMemory() = 0;
+  // convert all data files into the binary format of
+  // MultiSlotBinaryInMemoryDataFeed, and write them to output_dir
+  virtual void ConvertToBinary(const std::string& output_dir) = 0;
   // load all data into memory in async mode
   virtual void PreLoadIntoMemory() = 0;
   // wait async load done
@@ -145,6 +150,35 @@ class Dataset {
   virtual void DynamicAdjustReadersNum(int thread_num) = 0;
   // set fleet send sleep seconds
   virtual void SetFleetSendSleepSeconds(int seconds) = 0;
+  // set the max number of messages each global shuffle thread keeps in
+  // flight, 0 means to wait for all messages of a batch before the next one
+  virtual void SetFleetSendWindowSize(int window_size) = 0;
+  // set whether to compress the messages of global shuffle
+  virtual void SetCompressShuffleMsg(bool compress) = 0;
+  // set the shard num of the record channels, which must be called before
+  // CreateChannel. see ChannelObject::SetShardNum
+  virtual void SetChannelShardNum(int shard_num) = 0;
+  // set the spill mode. If spill_dir is not empty, the loaded records are
+  // partitioned into bucket_num shuffle buckets in spill_dir, and at most
+  // memory_budget_mb MB is used to buffer them
+  virtual void SetSpillConfig(const std::string& spill_dir,
+                              int64_t memory_budget_mb, int bucket_num) = 0;
+  // stream the spilled buckets in random order to the readers
+  virtual void StartSpillStream() = 0;
+  // wait until the spilled buckets are all streamed
+  virtual void WaitSpillStreamDone() = 0;
+  // set the read-ahead of the files. If depth > 0, at most depth files after
+  // the ones being read are downloaded into tmp_dir in the background, by
+  // download_thread_num threads, and .gz files are decompressed by
+  // decompress_thread_num threads
+  virtual void SetReadAhead(int depth, const std::string& tmp_dir,
+                            int download_thread_num,
+                            int decompress_thread_num) = 0;
+  // get the stat of each stage of the pipeline, see DataPipelineStat, and
+  // the sizes and the blocked seconds of the channels
+  virtual std::map<std::string, std::map<std::string, double>>
+  GetPipelineStat() = 0;
+  virtual void ResetPipelineStat() = 0;
 
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
@@ -157,7 +191,7 @@ template <typename T>
 class DatasetImpl : public Dataset {
  public:
   DatasetImpl();
-  virtual ~DatasetImpl() {}
+  virtual ~DatasetImpl() { StopSpillStream(); }
 
   virtual void SetFileList(const std::vector<std::string>& filelist);
   virtual void SetThreadNum(int thread_num);
@@ -198,6 +232,7 @@ class DatasetImpl : public Dataset {
   virtual void CreateChannel();
   virtual void RegisterClientToClientMsgHandler();
   virtual void LoadIntoMemory();
+  virtual void ConvertToBinary(const std::string& output_dir);
   virtual void PreLoadIntoMemory();
   virtual void WaitPreLoadDone();
   virtual void ReleaseMemory();
@@ -228,10 +263,34 @@ class DatasetImpl : public Dataset {
                                        bool discard_remaining_ins = false);
   virtual void DynamicAdjustReadersNum(int thread_num);
   virtual void SetFleetSendSleepSeconds(int seconds);
+  virtual void SetFleetSendWindowSize(int window_size);
+  virtual void SetCompressShuffleMsg(bool compress);
+  virtual void SetChannelShardNum(int shard_num);
+  virtual void SetSpillConfig(const std::string& spill_dir,
+                              int64_t memory_budget_mb, int bucket_num);
+  virtual void StartSpillStream();
+  virtual void WaitSpillStreamDone();
+  virtual void SetReadAhead(int depth, const std::string& tmp_dir,
+                            int download_thread_num,
+                            int decompress_thread_num);
+  virtual std::map<std::string, std::map<std::string, double>>
+  GetPipelineStat();
+  virtual void ResetPipelineStat();
 
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
                                 const std::string& msg);
+  // load the records into spill_buckets_ instead of input_channel_
+  void LoadIntoSpillBuckets();
+  // close the reader channels and wait for the stream thread, so that it
+  // does not block on the channels which are not consumed any more
+  void StopSpillStream();
+  // create a new file_read_ahead_ for the readers, since the file index is
+  // reset to zero
+  FileReadAhead* ResetFileReadAhead();
+  std::vector<paddle::framework::Channel<T>>& ReaderOutputChannels() {
+    return cur_channel_ == 0 ? multi_output_channel_ : multi_consume_channel_;
+  }
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers_;
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> preload_readers_;
   paddle::framework::Channel<T> input_channel_;
@@ -260,6 +319,9 @@ class DatasetImpl : public Dataset {
   std::string fs_ugi_;
   int64_t fleet_send_batch_size_;
   int64_t fleet_send_sleep_seconds_;
+  int fleet_send_window_size_;
+  bool compress_shuffle_msg_;
+  int channel_shard_num_;
   std::vector<std::thread> preload_threads_;
   bool merge_by_insid_;
   bool parse_ins_id_;
@@ -276,6 +338,17 @@ class DatasetImpl : public Dataset {
   int64_t global_index_ = 0;
   std::vector<std::shared_ptr<ThreadPool>> consume_task_pool_;
   std::vector<T> input_records_;  // only for paddleboxdatafeed
+  std::string spill_dir_;
+  size_t spill_memory_budget_ = 0;
+  int spill_bucket_num_ = 0;
+  std::unique_ptr<SpillBuckets<T>> spill_buckets_;
+  std::thread spill_stream_thread_;
+  int read_ahead_depth_ = 0;
+  std::string read_ahead_tmp_dir_;
+  int read_ahead_download_thread_num_ = 0;
+  int read_ahead_decompress_thread_num_ = 0;
+  std::shared_ptr<FileReadAhead> file_read_ahead_;
+  DataPipelineStat pipeline_stat_;
 };
 
 // use std::vector<MultiSlotType> or Record as data type
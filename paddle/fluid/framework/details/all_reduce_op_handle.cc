@@ -21,6 +21,10 @@
 #include "paddle/fluid/platform/profiler.h"
 
 #ifdef PADDLE_WITH_NCCL
+#include "paddle/fluid/framework/details/fp16_allreduce_cast.h"
+#include "paddle/fluid/platform/comm_stats.h"
+#include "paddle/fluid/platform/cuda_device_guard.h"
+
 DECLARE_bool(sync_nccl_allreduce);
 #endif
 
@@ -123,6 +127,11 @@ void AllReduceOpHandle::AllReduceFunc(
   if (is_gpu_place(places[0])) {
 #if defined(PADDLE_WITH_NCCL)
     PADDLE_ENFORCE_NOT_NULL(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
+    if (fp16_allreduce_ && dtype == proto::VarType::FP32) {
+      FP16AllReduceFunc(lod_tensor_data, numel, places, out_var_names[0]);
+      VLOG(10) << Name() << " fp16 size:" << numel * sizeof(platform::float16);
+      return;
+    }
     ncclDataType_t nccl_dtype = platform::ToNCCLDataType(dtype);
     std::vector<std::function<void()>> all_reduce_calls;
     for (size_t i = 0; i < local_exec_scopes_.size(); ++i) {
@@ -132,7 +141,8 @@ void AllReduceOpHandle::AllReduceFunc(
         NCCLAllReduce(p, buffer, buffer, numel, nccl_dtype, ncclSum);
       });
     }
-    NCCLAllReduceFunc(all_reduce_calls);
+    NCCLAllReduceFunc(all_reduce_calls, out_var_names[0],
+                      numel * SizeOfType(dtype));
 #else
     PADDLE_THROW("Not compiled with CUDA.");
 #endif
@@ -163,7 +173,26 @@ void AllReduceOpHandle::AllReduceFunc(
 
 #if defined(PADDLE_WITH_NCCL)
 void AllReduceOpHandle::NCCLAllReduceFunc(
-    const std::vector<std::function<void()>> &all_reduce_calls) {
+    const std::vector<std::function<void()>> &all_reduce_calls,
+    const std::string &bucket, size_t bytes) {
+  auto *nccl_ctxs =
+      nccl_ctxs_->GetRunEnvNCCLCtx(run_order_, use_hierarchical_allreduce_);
+  int nranks = 1;
+  if (platform::CommStats::IsEnabled()) {
+    auto &nccl_ctx = nccl_ctxs->at(
+        BOOST_GET_CONST(platform::CUDAPlace, places_[0]).device);
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        platform::dynload::ncclCommCount(nccl_ctx.comm(), &nranks));
+  }
+  platform::RecordComm record_comm(
+      Name(), "allreduce", bucket, nranks, bytes, [this, nccl_ctxs] {
+        for (auto &p : places_) {
+          int dev_id = BOOST_GET_CONST(platform::CUDAPlace, p).device;
+          PADDLE_ENFORCE_CUDA_SUCCESS(
+              cudaStreamSynchronize(nccl_ctxs->at(dev_id).stream()));
+        }
+      });
+  record_comm.BeginTransfer();
   this->RunAndRecordEvent([&] {
     if (all_reduce_calls.size() == 1UL) {
       // Do not use NCCLGroup when manage NCCL by per thread per device
@@ -175,10 +204,72 @@ void AllReduceOpHandle::NCCLAllReduceFunc(
       }
     }
   });
+  record_comm.EndTransfer();
 
   SyncNCCLAllReduce();
 }
 
+void AllReduceOpHandle::FP16AllReduceFunc(
+    const std::vector<const void *> &lod_tensor_data, int64_t numel,
+    const std::vector<platform::Place> &places, const std::string &bucket) {
+  size_t num_places = places.size();
+  if (fp16_buffers_.size() != num_places) {
+    fp16_buffers_.resize(num_places);
+    fp16_residuals_.resize(num_places);
+  }
+  auto *nccl_ctxs =
+      nccl_ctxs_->GetRunEnvNCCLCtx(run_order_, use_hierarchical_allreduce_);
+
+  // The casting kernels are launched on the NCCL streams, so that they are
+  // ordered with the all reduce calls without any extra synchronization.
+  std::vector<cudaStream_t> streams(num_places);
+  std::vector<float *> grads(num_places);
+  std::vector<platform::float16 *> halfs(num_places);
+  for (size_t i = 0; i < num_places; ++i) {
+    auto &p = places[i];
+    int dev_id = BOOST_GET_CONST(platform::CUDAPlace, p).device;
+    streams[i] = nccl_ctxs->at(dev_id).stream();
+    grads[i] = static_cast<float *>(const_cast<void *>(lod_tensor_data.at(i)));
+    halfs[i] = fp16_buffers_[i].mutable_data<platform::float16>(
+        framework::make_ddim({numel}), p);
+
+    platform::CUDADeviceGuard guard(dev_id);
+    float *residual = nullptr;
+    if (fp16_allreduce_error_feedback_) {
+      auto &residual_tensor = fp16_residuals_[i];
+      bool need_reset = !residual_tensor.IsInitialized() ||
+                        residual_tensor.numel() != numel;
+      residual = residual_tensor.mutable_data<float>(
+          framework::make_ddim({numel}), p);
+      if (need_reset) {
+        PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemsetAsync(
+            residual, 0, numel * sizeof(float), streams[i]));
+      }
+    }
+    CastFP32ToFP16(grads[i], residual, halfs[i], numel, streams[i]);
+  }
+
+  std::vector<std::function<void()>> all_reduce_calls;
+  ncclDataType_t nccl_dtype = platform::ToNCCLDataType(proto::VarType::FP16);
+  for (size_t i = 0; i < num_places; ++i) {
+    auto &p = places[i];
+    void *buffer = halfs[i];
+    all_reduce_calls.emplace_back([=] {
+      NCCLAllReduce(p, buffer, buffer, numel, nccl_dtype, ncclSum);
+    });
+  }
+  NCCLAllReduceFunc(all_reduce_calls, bucket,
+                    numel * sizeof(platform::float16));
+
+  this->RunAndRecordEvent([&] {
+    for (size_t i = 0; i < num_places; ++i) {
+      int dev_id = BOOST_GET_CONST(platform::CUDAPlace, places[i]).device;
+      platform::CUDADeviceGuard guard(dev_id);
+      CastFP16ToFP32(halfs[i], grads[i], numel, streams[i]);
+    }
+  });
+}
+
 void AllReduceOpHandle::SyncNCCLAllReduce() {
   if (FLAGS_sync_nccl_allreduce) {
     for (auto &p : places_) {
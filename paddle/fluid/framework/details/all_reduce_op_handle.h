@@ -47,6 +47,20 @@ class AllReduceOpHandle : public OpHandleBase {
   // performance. Disable this feature by returning false.
   bool IsMultiDeviceTransfer() override { return true; };
 
+  // Cast the FP32 gradients to FP16 before all reducing them on GPU, and cast
+  // the results back. If error_feedback is true, the casting error of each
+  // step is added to the gradients of the next step.
+  void SetFP16AllReduce(bool fp16_allreduce, bool error_feedback) {
+    fp16_allreduce_ = fp16_allreduce;
+    fp16_allreduce_error_feedback_ = fp16_allreduce && error_feedback;
+  }
+
+  bool IsFP16AllReduce() const { return fp16_allreduce_; }
+
+  bool IsFP16AllReduceErrorFeedback() const {
+    return fp16_allreduce_error_feedback_;
+  }
+
  protected:
   void RunImpl() override;
 
@@ -61,12 +75,26 @@ class AllReduceOpHandle : public OpHandleBase {
 #endif
 
 #if defined(PADDLE_WITH_NCCL)
+  // The bucket and the bytes of each place are recorded in the CommStats.
   void NCCLAllReduceFunc(
-      const std::vector<std::function<void()>> &all_reduce_calls);
+      const std::vector<std::function<void()>> &all_reduce_calls,
+      const std::string &bucket, size_t bytes);
 
   void SyncNCCLAllReduce();
+
+  void FP16AllReduceFunc(const std::vector<const void *> &lod_tensor_data,
+                         int64_t numel,
+                         const std::vector<platform::Place> &places,
+                         const std::string &bucket);
+
+  // The FP16 buffers and the casting errors of each place.
+  std::vector<Tensor> fp16_buffers_;
+  std::vector<Tensor> fp16_residuals_;
 #endif
 
+  bool fp16_allreduce_{false};
+  bool fp16_allreduce_error_feedback_{false};
+
   void AllReduceImpl(const std::vector<VarHandle *> &in_var_handles,
                      const std::vector<VarHandle *> &out_var_handles);
 
@@ -58,6 +58,7 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     AppendPassWithCheck(strategy_.enable_sequential_execution_,
                         "sequential_execution_pass");
     AppendPassWithCheck(strategy_.sync_batch_norm_, "sync_batch_norm_pass");
+    AppendPassWithCheck(strategy_.enable_recompute_, "recompute_pass");
 
     AppendOpFusePasses();
     AppendPrintGraphPass("graph_viz_pass", "_fused_graph");
@@ -74,6 +75,9 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
                         "runtime_context_cache_pass");
     AppendPassWithCheck(strategy_.remove_unnecessary_lock_,
                         "modify_op_lock_and_record_event_pass");
+    // It should be after modify_op_lock_and_record_event_pass, since the ops
+    // with pending ops on the other streams need to record their events.
+    AppendPassWithCheck(strategy_.num_streams_ > 1, "stream_assignment_pass");
     // Note: This pass is used to check whether the multi_device_graph is right.
     AppendPass("multi_devices_check_pass");
 
@@ -112,6 +116,12 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
              "mode.";
       strategy_.fuse_all_reduce_ops_ = false;
     }
+    if (strategy_.reduce_ != BuildStrategy::ReduceStrategy::kReduce ||
+        strategy_.is_distribution_ || strategy_.async_mode_) {
+      LOG_IF(WARNING, strategy_.shard_optimizer_states_)
+          << "Currently, shard_optimizer_states only works under Reduce "
+             "mode of non-distributed training.";
+    }
     if (strategy_.reduce_ == BuildStrategy::ReduceStrategy::kAllReduce) {
       LOG_IF(WARNING, strategy_.fuse_broadcast_ops_ == true)
           << "Currently, fuse_broadcast_ops only works under Reduce "
@@ -164,11 +174,11 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     AppendPassWithCheck(strategy_.fuse_relu_depthwise_conv_,
                         "fuse_relu_depthwise_conv_pass");
     AppendPassWithCheck(strategy_.fuse_bn_act_ops_, "fuse_bn_act_pass");
-#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__)
+    AppendPassWithCheck(strategy_.fuse_bn_add_act_ops_, "fuse_bn_add_act_pass");
+#if !defined(_WIN32) && !defined(__APPLE__)
     AppendPassWithCheck(strategy_.enable_auto_fusion_, "fusion_group_pass");
 #else
-    LOG(WARNING) << "fusion_group is not enabled for Windows/MacOS now, and "
-                    "only effective when running with CUDA GPU.";
+    LOG(WARNING) << "fusion_group is not enabled for Windows/MacOS now.";
 #endif
     AppendPassWithCheck(strategy_.fuse_elewise_add_act_ops_,
                         "fuse_elewise_add_act_pass");
@@ -184,6 +194,10 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
       AppendPass("fuse_adam_op_pass");
       AppendPass("fuse_sgd_op_pass");
       AppendPass("fuse_momentum_op_pass");
+      AppendPass("fuse_adagrad_op_pass");
+      AppendPass("fuse_rmsprop_op_pass");
+      AppendPass("fuse_lamb_op_pass");
+      AppendPass("fuse_lars_momentum_op_pass");
     }
   }
 
@@ -357,6 +371,14 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
     } else if (pass->Type() == "coalesce_grad_tensor_pass") {
       pass->Erase(kNRanks);
       pass->Set<size_t>(kNRanks, new size_t(nranks));
+    } else if (pass->Type() == "recompute_pass") {
+      pass->Erase("recompute_checkpoints");
+      pass->Set<std::vector<std::string>>(
+          "recompute_checkpoints",
+          new std::vector<std::string>(recompute_checkpoints_));
+      pass->Erase("recompute_memory_budget");
+      pass->Set<int64_t>("recompute_memory_budget",
+                         new int64_t(recompute_memory_budget_));
     } else if (pass->Type() == "sequential_execution_pass") {
       LOG(INFO) << "set enable_sequential_execution:"
                 << enable_sequential_execution_;
@@ -379,19 +401,29 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
       }
     } else if (pass->Type() == "fusion_group_pass") {
       pass->Set<bool>("use_gpu", new bool(use_cuda));
+    } else if (pass->Type() == "fuse_bn_act_pass") {
       if (!use_cuda) {
-        LOG(WARNING) << "fusion_group_pass is only supported on GPU, skipped.";
+        LOG(WARNING) << "fuse_bn_act_pass is only supported on "
+                        "GPU, skipped.";
         continue;
       }
-    } else if (pass->Type() == "fuse_bn_act_pass") {
+    } else if (pass->Type() == "fuse_bn_add_act_pass") {
       if (!use_cuda) {
-        LOG(WARNING) << "fuse_bn_act_pass is only supported on "
+        LOG(WARNING) << "fuse_bn_add_act_pass is only supported on "
                         "GPU, skipped.";
         continue;
       }
     } else if (pass->Type() == "mkldnn_placement_pass") {
       pass->Set("mkldnn_enabled_op_types",
                 new std::unordered_set<std::string>(mkldnn_enabled_op_types_));
+    } else if (pass->Type() == "stream_assignment_pass") {
+      if (!use_cuda) {
+        LOG(WARNING) << "stream_assignment_pass is only supported on "
+                        "GPU, skipped.";
+        continue;
+      }
+      pass->Erase("num_streams");
+      pass->Set<size_t>("num_streams", new size_t(num_streams_));
     } else if (pass->Type() == "backward_optimizer_op_deps_pass") {
       if (!use_cuda) {
         VLOG(1) << "backward_optimizer_op_deps_pass is only supported on "
@@ -412,9 +444,11 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
 }  // namespace paddle
 
 USE_PASS(sync_batch_norm_pass);
+USE_PASS(recompute_pass);
 USE_PASS(fuse_relu_depthwise_conv_pass);
 USE_PASS(fuse_elewise_add_act_pass);
 USE_PASS(fuse_bn_act_pass);
+USE_PASS(fuse_bn_add_act_pass);
 USE_PASS(graph_viz_pass);
 USE_PASS(multi_batch_merge_pass);
 USE_PASS(reduce_mode_multi_devices_pass);
@@ -426,18 +460,23 @@ USE_PASS(sequential_execution_pass);
 USE_PASS(all_reduce_deps_pass);
 USE_PASS(backward_optimizer_op_deps_pass);
 USE_PASS(modify_op_lock_and_record_event_pass);
+USE_PASS(stream_assignment_pass);
 USE_PASS(lock_free_optimize_pass);
 USE_PASS(coalesce_grad_tensor_pass);
 USE_PASS(graph_to_program_pass);
 USE_PASS(fuse_adam_op_pass);
 USE_PASS(fuse_sgd_op_pass);
 USE_PASS(fuse_momentum_op_pass);
+USE_PASS(fuse_adagrad_op_pass);
+USE_PASS(fuse_rmsprop_op_pass);
+USE_PASS(fuse_lamb_op_pass);
+USE_PASS(fuse_lars_momentum_op_pass);
 USE_PASS(fuse_all_reduce_op_pass);
 USE_PASS(runtime_context_cache_pass);
 USE_PASS(add_reader_dependency_pass);
 #ifdef PADDLE_WITH_MKLDNN
 USE_PASS(mkldnn_placement_pass);
 #endif
-#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__)
+#if !defined(_WIN32) && !defined(__APPLE__)
 USE_PASS(fusion_group_pass);
 #endif
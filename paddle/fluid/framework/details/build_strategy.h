@@ -79,6 +79,9 @@ struct BuildStrategy {
   // will be removed in the near future.
   bool enable_sequential_execution_{false};
   bool remove_unnecessary_lock_{true};
+  // The number of CUDA streams of every device, the independent ops run
+  // concurrently on different streams if it is larger than 1.
+  size_t num_streams_{1};
   // TODO(dev-paddle): cache_runtime_context may cause some models to hang up
   // while running.
   bool cache_runtime_context_{false};
@@ -87,6 +90,7 @@ struct BuildStrategy {
   // TODO(dev-paddle): fuse_elewise_add_act_ops may cause some models have
   // cycle.
   bool fuse_bn_act_ops_{false};
+  bool fuse_bn_add_act_ops_{false};
   bool fuse_elewise_add_act_ops_{false};
   bool enable_auto_fusion_{false};
   // Fuse_all_optimizer_ops and fuse_all_reduce_ops require that gradients
@@ -103,6 +107,18 @@ struct BuildStrategy {
   boost::optional<bool> fuse_broadcast_ops_{boost::none};
   // replace batch_norm with sync_batch_norm.
   bool sync_batch_norm_{false};
+  // In Reduce mode, balance the parameters across devices by the bytes of
+  // their gradients and optimizer states, and only keep the optimizer states
+  // in the device which updates the parameter.
+  bool shard_optimizer_states_{false};
+  // recompute the activations between checkpoints in backward instead of
+  // holding them from forward to backward.
+  bool enable_recompute_{false};
+  // The checkpoints of recompute, which are picked automatically if empty.
+  std::vector<std::string> recompute_checkpoints_;
+  // The estimated bytes of activations between two checkpoints picked
+  // automatically, 0 means picking sqrt(n) checkpoints.
+  int64_t recompute_memory_budget_{0};
 
   // mkldnn_enabled_op_types specify the operator type list to
   // use MKLDNN acceleration. It is null in default, means
@@ -139,6 +155,16 @@ struct BuildStrategy {
   // Nccl ranks bewteen nodes when use hierarchical allreduce, it's set to
   // nodes number.
   size_t hierarchical_allreduce_exter_nranks_{0};
+  // Cast the FP32 gradients to FP16 before all reducing them with NCCL, and
+  // cast the results back, which halves the communication volume.
+  bool fp16_allreduce_{false};
+  // Add the casting error of each step to the gradient of the next step when
+  // fp16_allreduce_ is enabled.
+  bool fp16_allreduce_error_feedback_{false};
+  // Merge the duplicated rows of the sparse gradients locally, all gather
+  // them with NCCL and merge them again on every device, instead of reducing
+  // them to one device and broadcasting the result.
+  bool use_sparse_all_gather_{false};
 
   // NOTE:
   // Before you add new options, think if it's a general strategy that works
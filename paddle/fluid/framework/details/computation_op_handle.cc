@@ -28,10 +28,28 @@ ComputationOpHandle::ComputationOpHandle(ir::Node *node, Scope *scope,
       place_(place),
       scope_idx_(scope_idx) {}
 
+void ComputationOpHandle::SetStreamId(size_t stream_id) {
+  is_multi_stream_ = true;
+  stream_id_ = stream_id;
+  SetDeviceContext(place_,
+                   platform::DeviceContextPool::Instance().GetStreamContext(
+                       place_, stream_id));
+}
+
 void ComputationOpHandle::RunImpl() {
   WaitInputVarGenerated(place_);
+  if (is_multi_stream_) {
+    WaitControlDepsOnOtherStreams();
+  }
 
-  auto run_func = [this]() { op_->Run(*local_exec_scopes_[0], place_); };
+  auto run_func = [this]() {
+    if (stream_id_ == 0) {
+      op_->Run(*local_exec_scopes_[0], place_);
+    } else {
+      platform::DeviceContextGuard guard(dev_ctxes_.at(place_));
+      op_->Run(*local_exec_scopes_[0], place_);
+    }
+  };
 
   if (is_lock_and_record_event_free_) {
     run_func();
@@ -47,6 +65,18 @@ bool ComputationOpHandle::NeedWait(VarHandleBase *in_var) {
   return need_wait;
 }
 
+void ComputationOpHandle::WaitControlDepsOnOtherStreams() {
+  auto *dev_ctx = dev_ctxes_.at(place_);
+  for (auto *in_var : inputs_) {
+    if (dynamic_cast<DummyVarHandle *>(in_var) == nullptr) continue;
+    auto *prev_op = dynamic_cast<ComputationOpHandle *>(in_var->GeneratedOp());
+    if (prev_op != nullptr && prev_op->GetPlace() == place_ &&
+        prev_op->DeviceContext(place_) != dev_ctx) {
+      prev_op->RecordWaitEventOnCtx(dev_ctx);
+    }
+  }
+}
+
 std::string ComputationOpHandle::Name() const { return op_->Type(); }
 }  // namespace details
 }  // namespace framework
@@ -48,11 +48,21 @@ class ComputationOpHandle : public OpHandleBase {
 
   size_t GetScopeIdx() const { return scope_idx_; }
 
+  // Run the op on the stream_id-th stream of its place, the 0-th one is the
+  // default stream. It is set by stream_assignment_pass.
+  void SetStreamId(size_t stream_id);
+
+  size_t GetStreamId() const { return stream_id_; }
+
  protected:
   void RunImpl() override;
 
   bool NeedWait(VarHandleBase *in_var) override;
 
+  // The control dependencies carry no event, so the ops generating them on
+  // the other streams are waited explicitly.
+  void WaitControlDepsOnOtherStreams();
+
   std::vector<Scope *> GetLocalScopes() override { return {scope_}; }
 
  private:
@@ -61,6 +71,8 @@ class ComputationOpHandle : public OpHandleBase {
   platform::Place place_;
   size_t scope_idx_;
   bool is_lock_and_record_event_free_{false};
+  bool is_multi_stream_{false};
+  size_t stream_id_{0};
 };
 }  // namespace details
 }  // namespace framework
@@ -17,6 +17,7 @@
 #include <utility>
 
 #include "paddle/fluid/framework/details/eager_deletion_op_handle.h"
+#include "paddle/fluid/framework/details/computation_op_handle.h"
 #include "paddle/fluid/framework/ir/memory_optimize_pass/memory_optimization_var_info.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/scope.h"
@@ -125,10 +126,34 @@ void EagerDeletionOpHandle::RunImpl() {
   }
 
   if (!garbages.empty()) {
+#ifdef PADDLE_WITH_CUDA
+    // The memory used on the other streams goes back to the free list of the
+    // stream of dev_ctx_, so that it is only reused after the waiting.
+    if (dev_ctx_ != nullptr && WaitOpsOnOtherStreams()) {
+      for (auto &garbage : garbages) {
+        memory::RecordStream(garbage.get(), *dev_ctx_);
+      }
+    }
+#endif
     ClearGarbages(&garbages);
   }
 }
 
+#ifdef PADDLE_WITH_CUDA
+bool EagerDeletionOpHandle::WaitOpsOnOtherStreams() {
+  bool waited = false;
+  for (auto *in_var : inputs_) {
+    auto *op = dynamic_cast<ComputationOpHandle *>(in_var->GeneratedOp());
+    if (op != nullptr && op->GetPlace() == place_ &&
+        op->DeviceContext(place_) != dev_ctx_) {
+      op->RecordWaitEventOnCtx(dev_ctx_);
+      waited = true;
+    }
+  }
+  return waited;
+}
+#endif
+
 void EagerDeletionOpHandle::ClearGarbages(
     std::deque<std::shared_ptr<memory::Allocation>> *garbages) {
 #ifdef PADDLE_WITH_CUDA
@@ -64,6 +64,12 @@ class EagerDeletionOpHandle : public OpHandleBase {
 
   void CallOnce();
 
+#ifdef PADDLE_WITH_CUDA
+  // Let the stream of dev_ctx_ wait for the ops using the variables on the
+  // other streams. Returns false if there are no such ops.
+  bool WaitOpsOnOtherStreams();
+#endif
+
   Scope *scope_;
   size_t scope_idx_;
   platform::Place place_;
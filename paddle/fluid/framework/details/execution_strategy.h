@@ -41,6 +41,16 @@ struct ExecutionStrategy {
   // only use with async_ssa_graph_executor
   // and pyreader with data queue
   size_t num_iteration_per_run_{1};
+
+  // Run the ready ops in the descending order of their critical path lengths
+  // to the end of the graph, so that the ops which the communication depends
+  // on start earlier. Only used by the kExperimental executor.
+  bool use_critical_path_priority_{false};
+
+  // Detach the variables and kid scopes of the local execution scopes when
+  // dropping them, and destroy them on a background thread, so that the
+  // training thread is not blocked by releasing the memory.
+  bool drop_scope_in_background_{false};
 };
 
 }  //  namespace details
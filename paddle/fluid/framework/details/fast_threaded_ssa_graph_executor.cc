@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
+#include <algorithm>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -48,12 +50,18 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     }
   }
   PADDLE_ENFORCE_GT(op_deps_.size(), 0, "The graph doesn't have operators.");
+  if (strategy_.use_critical_path_priority_) {
+    ComputeOpPriorities();
+  }
   PrepareAtomicOpDeps();
 }
 
 FetchResultType FastThreadedSSAGraphExecutor::Run(
     const std::vector<std::string> &fetch_tensors, bool return_merged) {
   VLOG(3) << "enter FastThreadedSSAGraphExecutor Run";
+  if (shared_timeline_ == nullptr) {
+    timeline_.BeginStep();
+  }
   std::unique_ptr<platform::RecordEvent> event(
       new platform::RecordEvent("FastThreadedSSAGraphExecutorPrepare"));
   std::unique_ptr<std::unordered_map<OpHandleBase *, std::atomic<int>>>
@@ -89,11 +97,15 @@ FetchResultType FastThreadedSSAGraphExecutor::Run(
   } else {
     traced_ops_.clear();
     remaining_ = 0;
+    // The ready ops may be left by the last run if it failed.
+    ready_ops_ = decltype(ready_ops_)();
     auto complete_q = std::make_shared<BlockingQueue<size_t>>();
     for (auto op : bootstrap_ops_) {
+      Timeline()->RecordReady(op, nullptr, timeline_pid_);
       RunOpAsync(op_deps.get(), op, complete_q);
     }
     for (auto op : ready_fetch_ops) {
+      Timeline()->RecordReady(op, nullptr, timeline_pid_);
       RunOpAsync(op_deps.get(), op, complete_q);
     }
 
@@ -120,6 +132,9 @@ FetchResultType FastThreadedSSAGraphExecutor::Run(
   }
   // Wait FetchOps.
   ClearFetchOp(graph_, &fetch_ops);
+  if (shared_timeline_ == nullptr) {
+    timeline_.EndStep();
+  }
   return fetches;
 }
 
@@ -203,6 +218,10 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
     OpHandleBase *op,
     const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
+  if (strategy_.use_critical_path_priority_) {
+    RunOpAsyncByPriority(op_deps, op, complete_q);
+    return;
+  }
   ++remaining_;
   this->pool_.enqueue([=] {
     std::deque<OpHandleBase *> op_queue;
@@ -217,12 +236,14 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
         return;
       }
 
+      auto *finished_op = op_to_run;
       auto &outputs = op_to_run->Outputs();
       op_to_run = nullptr;
       for (auto &output : outputs) {
         for (auto &pending_op : output->PendingOps()) {
           std::atomic<int> &deps = op_deps->at(pending_op);
           if (deps.fetch_sub(1) != 1) continue;
+          Timeline()->RecordReady(pending_op, finished_op, timeline_pid_);
 
           // NOTE(zjl): op with highest priority should run
           // first without switching to another thread.
@@ -247,6 +268,120 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
   });
 }
 
+void FastThreadedSSAGraphExecutor::RunOpAsyncByPriority(
+    std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+    OpHandleBase *op,
+    const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
+  {
+    std::lock_guard<std::mutex> guard(ready_ops_mutex_);
+    ready_ops_.emplace(OpPriority(op), op);
+  }
+  ++remaining_;
+  this->pool_.enqueue([=] {
+    size_t complete = 0;
+    while (true) {
+      OpHandleBase *op_to_run = nullptr;
+      {
+        std::lock_guard<std::mutex> guard(ready_ops_mutex_);
+        if (ready_ops_.empty()) break;
+        op_to_run = ready_ops_.top().second;
+        ready_ops_.pop();
+      }
+
+      if (!RunOp(op_to_run, complete_q, &complete)) {
+        return;
+      }
+
+      // The first ready op is left for this thread, and each of the others
+      // starts a new thread.
+      bool keep_one = true;
+      for (auto &output : op_to_run->Outputs()) {
+        for (auto &pending_op : output->PendingOps()) {
+          std::atomic<int> &deps = op_deps->at(pending_op);
+          if (deps.fetch_sub(1) != 1) continue;
+          Timeline()->RecordReady(pending_op, op_to_run, timeline_pid_);
+
+          if (keep_one) {
+            std::lock_guard<std::mutex> guard(ready_ops_mutex_);
+            ready_ops_.emplace(OpPriority(pending_op), pending_op);
+            keep_one = false;
+          } else {
+            RunOpAsyncByPriority(op_deps, pending_op, complete_q);
+          }
+        }
+      }
+    }
+    --remaining_;
+    complete_q->Push(complete);
+  });
+}
+
+// The priority of an op is the length of the longest path from it to the end
+// of the graph, where each op counts 1 and each multi-device transfer op, e.g.
+// all reduce, counts kMultiDeviceTransferOpWeight, so the ops which the
+// communication depends on run first.
+void FastThreadedSSAGraphExecutor::ComputeOpPriorities() {
+  constexpr int64_t kMultiDeviceTransferOpWeight = 10;
+
+  std::unordered_map<OpHandleBase *, std::unordered_set<OpHandleBase *>>
+      preceding_ops;
+  std::unordered_map<OpHandleBase *, size_t> num_pending_ops;
+  for (auto &pair : op_deps_) {
+    auto *op = pair.first;
+    std::unordered_set<OpHandleBase *> pending_ops;
+    for (auto *output : op->Outputs()) {
+      for (auto *pending_op : output->PendingOps()) {
+        if (op_deps_.count(pending_op) > 0) {
+          pending_ops.insert(pending_op);
+        }
+      }
+    }
+    num_pending_ops[op] = pending_ops.size();
+    for (auto *pending_op : pending_ops) {
+      preceding_ops[pending_op].insert(op);
+    }
+  }
+
+  std::vector<OpHandleBase *> ops_to_visit;
+  for (auto &pair : num_pending_ops) {
+    if (pair.second == 0) {
+      ops_to_visit.emplace_back(pair.first);
+    }
+  }
+
+  // The longest path from the pending ops of each op.
+  std::unordered_map<OpHandleBase *, int64_t> pending_path_lengths;
+  op_priorities_.clear();
+  while (!ops_to_visit.empty()) {
+    auto *op = ops_to_visit.back();
+    ops_to_visit.pop_back();
+    int64_t weight = op->IsMultiDeviceTransfer() ? kMultiDeviceTransferOpWeight
+                                                 : 1;
+    int64_t priority = pending_path_lengths[op] + weight;
+    op_priorities_[op] = priority;
+    for (auto *preceding_op : preceding_ops[op]) {
+      auto &length = pending_path_lengths[preceding_op];
+      length = std::max(length, priority);
+      if (--num_pending_ops[preceding_op] == 0) {
+        ops_to_visit.emplace_back(preceding_op);
+      }
+    }
+  }
+  PADDLE_ENFORCE_EQ(op_priorities_.size(), op_deps_.size(),
+                    platform::errors::InvalidArgument(
+                        "The graph of the ParallelExecutor has a cycle."));
+}
+
+int64_t FastThreadedSSAGraphExecutor::OpPriority(OpHandleBase *op) const {
+  // The highest priority ops, e.g. eager deletion, run as soon as possible.
+  if (op->GetPriority() == OpHandleBase::Priority::kHighest) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  // The fetch ops are created for each run and have no priorities.
+  auto it = op_priorities_.find(op);
+  return it == op_priorities_.end() ? 0 : it->second;
+}
+
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
   atomic_op_deps_ = prepare_pool_.enqueue([&] {
     auto *op_deps = new std::unordered_map<OpHandleBase *, std::atomic<int>>;
@@ -284,9 +419,11 @@ bool FastThreadedSSAGraphExecutor::RunTracedOps(
 bool FastThreadedSSAGraphExecutor::RunOpSync(OpHandleBase *op) {
   try {
     VLOG(10) << op << " " << op->Name() << " : " << op->DebugString();
+    Timeline()->RecordStart(op);
     if (LIKELY(!strategy_.dry_run_)) {
       op->Run(strategy_.use_cuda_);
     }
+    Timeline()->RecordEnd(op);
     VLOG(10) << op << " " << op->Name() << " Done ";
     return true;
   } catch (...) {
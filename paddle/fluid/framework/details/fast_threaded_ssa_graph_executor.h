@@ -14,13 +14,18 @@
 
 #pragma once
 #include <ThreadPool.h>
+#include <cstdint>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <queue>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
+#include "paddle/fluid/framework/details/op_handle_timeline.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
 
 namespace paddle {
@@ -40,6 +45,13 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
                       bool return_merged) override;
   const ir::Graph &Graph() const override;
 
+  // Record the ops into `timeline` with `pid`, whose steps are begun and
+  // ended by the caller, instead of the timeline of this executor.
+  void SetTimeline(OpHandleTimeline *timeline, int pid) {
+    shared_timeline_ = timeline;
+    timeline_pid_ = pid;
+  }
+
  private:
   // Note(zcd): the ThreadPool should be placed last so that ThreadPool should
   // be destroyed first.
@@ -65,6 +77,21 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   std::vector<OpHandleBase *> traced_ops_;
 
+  // The critical path length from each op to the end of the graph, which is
+  // only computed if strategy_.use_critical_path_priority_ is set.
+  std::unordered_map<OpHandleBase *, int64_t> op_priorities_;
+  // The ready ops to run and their priorities.
+  std::mutex ready_ops_mutex_;
+  std::priority_queue<std::pair<int64_t, OpHandleBase *>> ready_ops_;
+
+  OpHandleTimeline timeline_;
+  OpHandleTimeline *shared_timeline_{nullptr};
+  int timeline_pid_{0};
+
+  OpHandleTimeline *Timeline() {
+    return shared_timeline_ != nullptr ? shared_timeline_ : &timeline_;
+  }
+
   bool RunOp(OpHandleBase *op,
              const std::shared_ptr<BlockingQueue<size_t>> &complete_q,
              size_t *complete);
@@ -73,6 +100,17 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
                   OpHandleBase *op,
                   const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
 
+  // Push op into ready_ops_, and start a thread which runs the ready ops with
+  // the highest priorities until ready_ops_ is empty.
+  void RunOpAsyncByPriority(
+      std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+      OpHandleBase *op,
+      const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
+
+  void ComputeOpPriorities();
+
+  int64_t OpPriority(OpHandleBase *op) const;
+
   void PrepareAtomicOpDeps();
 
   inline void RecordOps(OpHandleBase *op);
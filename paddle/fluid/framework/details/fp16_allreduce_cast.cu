@@ -0,0 +1,70 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/fp16_allreduce_cast.h"
+#include <algorithm>
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+static constexpr int kNumCUDAThreads = 512;
+static constexpr int64_t kMaxNumCUDABlocks = 4096;
+
+static inline int NumBlocks(int64_t numel) {
+  return static_cast<int>(std::min(
+      (numel + kNumCUDAThreads - 1) / kNumCUDAThreads, kMaxNumCUDABlocks));
+}
+
+__global__ void CastFP32ToFP16Kernel(const float *in, float *residual,
+                                     platform::float16 *out, int64_t numel) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    float x = in[i];
+    if (residual != nullptr) {
+      x += residual[i];
+    }
+    platform::float16 h(x);
+    out[i] = h;
+    if (residual != nullptr) {
+      residual[i] = x - static_cast<float>(h);
+    }
+  }
+}
+
+__global__ void CastFP16ToFP32Kernel(const platform::float16 *in, float *out,
+                                     int64_t numel) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    out[i] = static_cast<float>(in[i]);
+  }
+}
+
+void CastFP32ToFP16(const float *in, float *residual, platform::float16 *out,
+                    int64_t numel, cudaStream_t stream) {
+  if (numel <= 0) return;
+  CastFP32ToFP16Kernel<<<NumBlocks(numel), kNumCUDAThreads, 0, stream>>>(
+      in, residual, out, numel);
+}
+
+void CastFP16ToFP32(const platform::float16 *in, float *out, int64_t numel,
+                    cudaStream_t stream) {
+  if (numel <= 0) return;
+  CastFP16ToFP32Kernel<<<NumBlocks(numel), kNumCUDAThreads, 0, stream>>>(
+      in, out, numel);
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,36 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda_runtime.h>
+#include <cstdint>
+
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// Cast `in` to FP16. If `residual` is not nullptr, it is added to `in` before
+// casting, and the casting error is stored back to it.
+void CastFP32ToFP16(const float *in, float *residual, platform::float16 *out,
+                    int64_t numel, cudaStream_t stream);
+
+void CastFP16ToFP32(const platform::float16 *in, float *out, int64_t numel,
+                    cudaStream_t stream);
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -207,6 +207,24 @@ void CheckNanInf<paddle::platform::float16>(
 }
 #endif
 
+// bf16 is summed in fp32, its few mantissa bits make a bf16 sum lossy
+template <>
+void CheckNanInf<paddle::platform::bfloat16>(
+    const paddle::platform::bfloat16* value, const size_t numel, int print_num,
+    const std::string& op_type, const std::string& var_name) {
+  float sum = 0.0f;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+ : sum)
+#endif
+  for (size_t i = 0; i < numel; ++i) {
+    sum += static_cast<float>(value[i] - value[i]);
+  }
+
+  if (std::isnan(sum) || std::isinf(sum)) {
+    PrintNanInf(value, numel, print_num, op_type, var_name);
+  }
+}
+
 template <>
 template <typename T>
 void TensorCheckerVisitor<platform::CPUDeviceContext>::apply(
@@ -217,6 +235,16 @@ void TensorCheckerVisitor<platform::CPUDeviceContext>::apply(
               var_name_);
 }
 
+template <>
+template <typename T>
+void TensorCheckerVisitor<platform::CPUDeviceContext>::apply(
+    typename std::enable_if<
+        std::is_same<T, platform::bfloat16>::value>::type*) const {
+  int print_num = 3;
+  CheckNanInf(tensor_.data<T>(), tensor_.numel(), print_num, op_type_,
+              var_name_);
+}
+
 template <>
 void tensor_check<platform::CPUDeviceContext>(const std::string& op_type,
                                               const std::string& var_name,
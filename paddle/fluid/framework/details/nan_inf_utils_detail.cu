@@ -172,6 +172,14 @@ void TensorCheckerVisitor<platform::CUDADeviceContext>::apply(
       tensor_.data<T>(), tensor_.numel(), print_num, gpu_str_ptr);
 }
 
+template <>
+template <typename T>
+void TensorCheckerVisitor<platform::CUDADeviceContext>::apply(
+    typename std::enable_if<
+        std::is_same<T, platform::bfloat16>::value>::type*) const {
+  VLOG(10) << var_name_ << " need not to check, bf16 has no cuda kernels";
+}
+
 template <>
 void tensor_check<platform::CUDADeviceContext>(const std::string& op_type,
                                                const std::string& var_name,
@@ -43,6 +43,10 @@ struct TensorCheckerVisitor {
   void apply(typename std::enable_if<std::is_floating_point<T>::value>::type* =
                  0) const;
 
+  template <typename T>
+  void apply(typename std::enable_if<
+             std::is_same<T, platform::bfloat16>::value>::type* = 0) const;
+
   std::string op_type_;
   std::string var_name_;
   const framework::Tensor& tensor_;
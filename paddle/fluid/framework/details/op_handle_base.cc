@@ -79,6 +79,29 @@ void OpHandleBase::InitCUDA() {
 #endif
 }
 
+void OpHandleBase::InitRunPeriod() {
+  if (!node_->IsOp() || node_->Op() == nullptr ||
+      !node_->Op()->HasAttr(kOpRunPeriodAttr)) {
+    return;
+  }
+  SetRunPeriod(BOOST_GET_CONST(int, node_->Op()->GetAttr(kOpRunPeriodAttr)),
+               BOOST_GET_CONST(int, node_->Op()->GetAttr(kOpRunPhaseAttr)));
+}
+
+void OpHandleBase::SetRunPeriod(int period, int phase) {
+  PADDLE_ENFORCE_GT(period, 0, platform::errors::InvalidArgument(
+                                   "The run period of %s should be larger "
+                                   "than 0, but got %d.",
+                                   node_->Name(), period));
+  PADDLE_ENFORCE_EQ(phase >= 0 && phase < period, true,
+                    platform::errors::InvalidArgument(
+                        "The run phase of %s should be in [0, %d), but got "
+                        "%d.",
+                        node_->Name(), period, phase));
+  run_period_ = period;
+  run_phase_ = phase;
+}
+
 void OpHandleBase::Run(bool use_cuda) {
 #ifdef PADDLE_WITH_CUDA
   if (events_.empty() && use_cuda && dev_ctxes_.size() > 0) {
@@ -88,6 +111,10 @@ void OpHandleBase::Run(bool use_cuda) {
   PADDLE_ENFORCE(!use_cuda);
 #endif
 
+  if (run_period_ > 1 && run_step_++ % run_period_ != run_phase_) {
+    VLOG(10) << "Skip " << Name() << " at step " << run_step_ - 1;
+    return;
+  }
   RunImpl();
 }
 
@@ -30,6 +30,12 @@ class Scope;
 
 namespace details {
 
+// The attributes of OpDesc which make the op handle run only on the steps
+// where step % op_run_period == op_run_phase, e.g., the optimize ops of the
+// runtime gradient accumulation of multi_batch_merge_pass.
+constexpr char kOpRunPeriodAttr[] = "op_run_period";
+constexpr char kOpRunPhaseAttr[] = "op_run_phase";
+
 // Wraps ir::Node and provide helper utilities.
 // It's responsible for populating necessary fields of ir::Node.
 class OpHandleBase {
@@ -44,6 +50,7 @@ class OpHandleBase {
   // Owned by `node`. No need to be deleted explicitly.
   explicit OpHandleBase(ir::Node *node) : node_(node) {
     node_->WrappedBy(this);
+    InitRunPeriod();
   }
 
   virtual ~OpHandleBase() PADDLE_MAY_THROW;
@@ -113,6 +120,13 @@ class OpHandleBase {
   void SetLocalExecScopes(
       const std::unordered_map<Scope *, Scope *> &scope_map);
 
+  // Run only on the steps where step % period == phase.
+  void SetRunPeriod(int period, int phase);
+
+  int RunPeriod() const { return run_period_; }
+
+  int RunPhase() const { return run_phase_; }
+
  protected:
   virtual std::vector<Scope *> GetLocalScopes() = 0;
 
@@ -125,6 +139,8 @@ class OpHandleBase {
 
   virtual void InitCUDA();
 
+  void InitRunPeriod();
+
   ir::Node *node_;
   std::vector<VarHandleBase *> inputs_;
   std::vector<VarHandleBase *> outputs_;
@@ -132,6 +148,10 @@ class OpHandleBase {
 
   std::vector<Scope *> local_exec_scopes_;
 
+  int run_period_{1};
+  int run_phase_{0};
+  int64_t run_step_{0};
+
 #ifdef PADDLE_WITH_CUDA
   std::unordered_map<int, cudaEvent_t> events_;
 #endif
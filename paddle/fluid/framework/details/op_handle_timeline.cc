@@ -0,0 +1,158 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/op_handle_timeline.h"
+#include <fstream>
+#include <sstream>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_string(pe_timeline_fname, "",
+              "The file to write the op handle timeline of the SSA graph "
+              "executors to, in the chrome trace format. Empty means the "
+              "timeline is not recorded.");
+DEFINE_int32(pe_timeline_step, 10,
+             "The step of the SSA graph executors whose op handle timeline is "
+             "recorded when FLAGS_pe_timeline_fname is set. The first steps "
+             "are usually slower than the others, so they are skipped.");
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+void OpHandleTimeline::BeginStep() {
+  enabled_ =
+      !FLAGS_pe_timeline_fname.empty() && step_ == FLAGS_pe_timeline_step;
+  ++step_;
+  if (enabled_) {
+    records_.clear();
+    thread_ids_.clear();
+    begin_ = Clock::now();
+  }
+}
+
+void OpHandleTimeline::EndStep() {
+  if (!enabled_) return;
+  enabled_ = false;
+  std::ofstream fout(FLAGS_pe_timeline_fname);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Cannot open %s to write the op handle timeline.",
+                        FLAGS_pe_timeline_fname));
+  fout << ToChromeTrace();
+  LOG(INFO) << "The op handle timeline of " << records_.size()
+            << " ops is written to " << FLAGS_pe_timeline_fname;
+  records_.clear();
+}
+
+void OpHandleTimeline::RecordReady(OpHandleBase *op, OpHandleBase *ready_by,
+                                   int pid) {
+  if (!enabled_) return;
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto &record = records_[op];
+  record.pid = pid;
+  record.ready_by = ready_by;
+  record.ready = now;
+}
+
+void OpHandleTimeline::RecordStart(OpHandleBase *op) {
+  if (!enabled_) return;
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto &record = records_[op];
+  auto it = thread_ids_.find(std::this_thread::get_id());
+  if (it == thread_ids_.end()) {
+    it = thread_ids_
+             .emplace(std::this_thread::get_id(), thread_ids_.size())
+             .first;
+  }
+  record.tid = it->second;
+  // The ops run by the traced order have no ready time.
+  if (record.ready == Clock::time_point()) {
+    record.ready = now;
+  }
+  record.start = now;
+}
+
+void OpHandleTimeline::RecordEnd(OpHandleBase *op) {
+  if (!enabled_) return;
+  auto now = Clock::now();
+  auto name = op->Name();
+  auto debug_string = op->DebugString();
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto &record = records_[op];
+  record.end = now;
+  record.name = std::move(name);
+  record.debug_string = std::move(debug_string);
+  if (record.ready_by != nullptr) {
+    auto it = records_.find(record.ready_by);
+    if (it != records_.end()) {
+      record.ready_by_name = it->second.name;
+    }
+  }
+}
+
+static std::string EscapeJson(const std::string &str) {
+  std::string result;
+  result.reserve(str.size());
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+      result.push_back(c);
+    } else if (c == '\n') {
+      result.append("\\n");
+    } else {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+std::string OpHandleTimeline::ToChromeTrace() const {
+  auto to_us = [this](Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - begin_)
+        .count();
+  };
+
+  std::stringstream ss;
+  ss << "{\"traceEvents\": [";
+  bool first = true;
+  for (auto &pair : records_) {
+    auto &record = pair.second;
+    // The op which has not finished, e.g. because of an exception.
+    if (record.end == Clock::time_point()) continue;
+    if (!first) ss << ",";
+    first = false;
+    auto ready_us = to_us(record.ready);
+    auto start_us = to_us(record.start);
+    auto end_us = to_us(record.end);
+    ss << "\n{\"name\": \"" << EscapeJson(record.name)
+       << "\", \"cat\": \"op_handle\", \"ph\": \"X\", \"pid\": " << record.pid
+       << ", \"tid\": " << record.tid << ", \"ts\": " << start_us
+       << ", \"dur\": " << end_us - start_us << ", \"args\": {"
+       << "\"ready_us\": " << ready_us
+       << ", \"wait_us\": " << start_us - ready_us << ", \"ready_by\": \""
+       << EscapeJson(record.ready_by_name) << "\", \"vars\": \""
+       << EscapeJson(record.debug_string) << "\"}}";
+  }
+  ss << "\n]}\n";
+  return ss.str();
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+class OpHandleBase;
+
+/**
+ * OpHandleTimeline records when each op handle of one step of the SSA graph
+ * executors gets ready, starts and ends, and which op made it ready, i.e.,
+ * the last dependency it waited for. The step FLAGS_pe_timeline_step is
+ * recorded and written to FLAGS_pe_timeline_fname in the chrome trace
+ * format, which can be opened by chrome://tracing.
+ *
+ * The executor calls BeginStep and EndStep around each step, and the
+ * Record* methods, which can be called by multiple threads, in the step.
+ * All methods are no-ops if FLAGS_pe_timeline_fname is empty.
+ */
+class OpHandleTimeline {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  OpHandleTimeline() = default;
+
+  void BeginStep();
+
+  void EndStep();
+
+  bool IsEnabled() const { return enabled_; }
+
+  // `ready_by` is the op whose completion makes `op` ready, or nullptr if op
+  // is ready at the beginning of the step. `pid` is the id of the executor,
+  // e.g., the device id of the ParallelSSAGraphExecutor.
+  void RecordReady(OpHandleBase *op, OpHandleBase *ready_by, int pid = 0);
+
+  void RecordStart(OpHandleBase *op);
+
+  void RecordEnd(OpHandleBase *op);
+
+ private:
+  struct Record {
+    int pid{0};
+    size_t tid{0};
+    OpHandleBase *ready_by{nullptr};
+    // The names are got when the op ends, since the fetch ops are destroyed
+    // before the step ends.
+    std::string name;
+    std::string debug_string;
+    std::string ready_by_name;
+    Clock::time_point ready;
+    Clock::time_point start;
+    Clock::time_point end;
+  };
+
+  std::string ToChromeTrace() const;
+
+  int64_t step_{0};
+  bool enabled_{false};
+  Clock::time_point begin_;
+
+  std::mutex mtx_;
+  std::unordered_map<OpHandleBase *, Record> records_;
+  std::unordered_map<std::thread::id, size_t> thread_ids_;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -131,6 +131,7 @@ ParallelSSAGraphExecutor::ParallelSSAGraphExecutor(
     executors_.emplace_back(new details::FastThreadedSSAGraphExecutor(
         strategy_, local_scopes_, local_exec_scopes, {places_[i]},
         graphs_.at(i).get()));
+    executors_.back()->SetTimeline(&timeline_, static_cast<int>(i));
   }
 }
 
@@ -162,6 +163,7 @@ FetchResultType ParallelSSAGraphExecutor::Run(
   std::vector<FetchResultType> fetch_data;
   fetch_data.reserve(place_num);
   exception_holder_.Clear();
+  timeline_.BeginStep();
 
   for (size_t i = 0; i < place_num; ++i) {
     auto call = [&, i]() -> FetchResultType {
@@ -197,6 +199,7 @@ FetchResultType ParallelSSAGraphExecutor::Run(
       fetch_data.emplace_back(f.get());
     }
   }
+  timeline_.EndStep();
 
   bool has_exception = exception_holder_.IsCaught();
   if (!support_partial_feed_ && has_exception) {
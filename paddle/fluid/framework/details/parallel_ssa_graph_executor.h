@@ -20,6 +20,7 @@
 #include "ThreadPool.h"
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/op_handle_timeline.h"
 #include "paddle/fluid/framework/ir/graph.h"
 
 namespace paddle {
@@ -73,6 +74,8 @@ class ParallelSSAGraphExecutor : public SSAGraphExecutor {
   std::vector<std::unique_ptr<details::FastThreadedSSAGraphExecutor>>
       executors_;
   ExceptionHolder exception_holder_;
+  // The timeline of the ops of all devices, where the pid is the device index.
+  OpHandleTimeline timeline_;
 
   bool support_partial_feed_{false};
   std::vector<FeedStatus> feed_status_;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
+#include <iterator>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -76,7 +77,11 @@ FetchResultType ScopeBufferedSSAGraphExecutor::Run(
   ++drop_scope_counter_;
   if (drop_scope_counter_ == strategy_.num_iteration_per_drop_scope_ ||
       DropScopeOrNot()) {
-    DropLocalExeScopes();
+    if (strategy_.drop_scope_in_background_) {
+      DropLocalExeScopesInBackground();
+    } else {
+      DropLocalExeScopes();
+    }
   }
 
   if (VLOG_IS_ON(5)) {
@@ -140,9 +145,10 @@ void ScopeBufferedSSAGraphExecutor::InitVariables() {
 
 void ScopeBufferedSSAGraphExecutor::DropLocalExeScopes() {
   platform::RecordEvent drop_scope_event("DropLocalExeScopes");
+  WaitBackgroundDropScope();
   drop_scope_counter_ = 0;
   for (auto &p : places_) {
-    platform::DeviceContextPool::Instance().Get(p)->Wait();
+    platform::DeviceContextPool::Instance().WaitAllStreams(p);
   }
   scope_monitor_.ClearHistoryLocalExecScopes();
   for (size_t i = 0; i < local_exec_scopes_.size(); ++i) {
@@ -155,6 +161,51 @@ void ScopeBufferedSSAGraphExecutor::DropLocalExeScopes() {
   }
 }
 
+void ScopeBufferedSSAGraphExecutor::DropLocalExeScopesInBackground() {
+  platform::RecordEvent drop_scope_event("DropLocalExeScopesInBackground");
+  // Only one drop is in flight, so that the memory of at most two droppings
+  // is held.
+  WaitBackgroundDropScope();
+  drop_scope_counter_ = 0;
+  // The kernels which may use the memory must finish before the memory is
+  // released and reused by the others.
+  for (auto &p : places_) {
+    platform::DeviceContextPool::Instance().WaitAllStreams(p);
+  }
+  scope_monitor_.ClearHistoryLocalExecScopes();
+
+  struct DroppedVars {
+    std::vector<std::unique_ptr<Variable>> vars;
+    std::vector<std::unique_ptr<Scope>> kids;
+  };
+  auto dropped = std::make_shared<DroppedVars>();
+  for (size_t i = 0; i < local_exec_scopes_.size(); ++i) {
+    local_exec_scopes_[i]->EraseVarsExcept(preserve_vars_[i], &dropped->vars);
+    auto kids = local_exec_scopes_[i]->DetachKids();
+    std::move(kids.begin(), kids.end(), std::back_inserter(dropped->kids));
+    // Move the content out, which leaves the preserved variable cleared.
+    for (auto &preserve_var : preserve_vars_[i]) {
+      dropped->vars.emplace_back(new Variable(std::move(*preserve_var)));
+    }
+    VLOG(3) << "Drop local execution scope in background: " << local_scopes_[i];
+  }
+
+  if (!drop_scope_pool_) {
+    drop_scope_pool_.reset(new ::ThreadPool(1));
+  }
+  drop_scope_future_ = drop_scope_pool_->enqueue([dropped] {
+    platform::RecordEvent event("DestroyDroppedLocalExeScopes");
+    dropped->kids.clear();
+    dropped->vars.clear();
+  });
+}
+
+void ScopeBufferedSSAGraphExecutor::WaitBackgroundDropScope() {
+  if (drop_scope_future_.valid()) {
+    drop_scope_future_.get();
+  }
+}
+
 void ScopeBufferedSSAGraphExecutor::PrepareLocalExeScopes() {
   // Create local scopes.
   preserve_vars_.resize(local_scopes_.size());
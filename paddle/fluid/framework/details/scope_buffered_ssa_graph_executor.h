@@ -53,6 +53,8 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
   FetchResultType Run(const std::vector<std::string>& fetch_tensors,
                       bool return_merged) override;
 
+  // Drop the local execution scopes, and wait until the variables of them
+  // are destroyed.
   void DropLocalExeScopes();
 
   bool NeedCreateLocalExeScope();
@@ -64,6 +66,12 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
 
   bool DropScopeOrNot() const;
 
+  // Detach the variables of the local execution scopes and destroy them on
+  // drop_scope_pool_.
+  void DropLocalExeScopesInBackground();
+
+  void WaitBackgroundDropScope();
+
   size_t drop_scope_counter_{0};
   ExecutionStrategy strategy_;
   std::unique_ptr<SSAGraphExecutor> underlying_executor_;
@@ -80,6 +88,11 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
   std::vector<platform::Place> places_;
 
   ScopeBufferedMonitor scope_monitor_;
+
+  // NOTE: the thread pool should be destroyed first, so that the detached
+  // variables are destroyed before the other members.
+  std::unique_ptr<::ThreadPool> drop_scope_pool_;
+  std::future<void> drop_scope_future_;
 };
 }  // namespace details
 }  // namespace framework
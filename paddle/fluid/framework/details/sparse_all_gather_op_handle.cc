@@ -0,0 +1,274 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/sparse_all_gather_op_handle.h"
+#include <algorithm>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/details/container_cast.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/platform/profiler.h"
+
+DECLARE_bool(sync_nccl_allreduce);
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+SparseAllGatherOpHandle::SparseAllGatherOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const platform::NCCLCommunicator *ctxs, int nranks)
+    : NCCLOpHandleBase(node, places, ctxs),
+      local_scopes_(local_scopes),
+      nranks_(nranks) {
+  PADDLE_ENFORCE_EQ(places_.size(), local_scopes_.size(),
+                    platform::errors::InvalidArgument(
+                        "The number of places and the number of local scopes "
+                        "should be equal, but got %d and %d.",
+                        places_.size(), local_scopes_.size()));
+  PADDLE_ENFORCE_GE(
+      nranks_, static_cast<int>(places_.size()),
+      platform::errors::InvalidArgument(
+          "The number of ranks(%d) should not be less than the number of "
+          "places(%d).",
+          nranks_, places_.size()));
+}
+
+void SparseAllGatherOpHandle::RunImpl() {
+  platform::RecordEvent record_event(Name());
+
+  WaitInputVarGenerated();
+  auto in_var_handles = DynamicCast<VarHandle>(this->Inputs());
+  auto out_var_handles = DynamicCast<VarHandle>(this->Outputs());
+  PADDLE_ENFORCE_EQ(
+      in_var_handles.size(), places_.size(),
+      platform::errors::PreconditionNotMet(
+          "The number of inputs should be equal to the number of places."));
+  PADDLE_ENFORCE_EQ(
+      out_var_handles.size(), places_.size(),
+      platform::errors::PreconditionNotMet(
+          "The number of outputs should be equal to the number of places."));
+  PADDLE_ENFORCE_NOT_NULL(nccl_ctxs_, platform::errors::PreconditionNotMet(
+                                          "nccl_ctxs should not be nullptr."));
+
+  auto *var = local_exec_scopes_[0]->FindVar(in_var_handles[0]->name());
+  PADDLE_ENFORCE_NOT_NULL(var, platform::errors::NotFound(
+                                   "Variable %s is not found in scope.",
+                                   in_var_handles[0]->name()));
+  auto dtype = var->Get<SelectedRows>().value().type();
+  switch (dtype) {
+    case proto::VarType::FP32:
+      AllGatherSelectedRows<float>(in_var_handles, out_var_handles);
+      break;
+    case proto::VarType::FP64:
+      AllGatherSelectedRows<double>(in_var_handles, out_var_handles);
+      break;
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "SparseAllGatherOpHandle only supports float and double gradients, "
+          "but got %s.",
+          DataTypeToString(dtype)));
+  }
+}
+
+template <typename T>
+void SparseAllGatherOpHandle::AllGatherSelectedRows(
+    const std::vector<VarHandle *> &in_var_handles,
+    const std::vector<VarHandle *> &out_var_handles) {
+  size_t num_places = places_.size();
+  if (buffers_.size() != num_places) {
+    buffers_.resize(num_places);
+    local_counts_.resize(num_places);
+  }
+  auto *nccl_ctxs = nccl_ctxs_->GetFlatCtx(run_order_);
+  operators::math::scatter::MergeAdd<platform::CUDADeviceContext, T> merge_add;
+  platform::CPUPlace cpu_place;
+
+  // 1. Merge the duplicated rows on each device, and all gather the numbers
+  // of the merged rows.
+  int64_t height = -1;
+  int64_t width = -1;
+  std::vector<std::function<void()>> all_gather_calls;
+  for (size_t i = 0; i < num_places; ++i) {
+    auto &p = places_[i];
+    auto *var = local_exec_scopes_[i]->FindVar(in_var_handles[i]->name());
+    PADDLE_ENFORCE_NOT_NULL(var, platform::errors::NotFound(
+                                     "Variable %s is not found in scope.",
+                                     in_var_handles[i]->name()));
+    auto &in = var->Get<SelectedRows>();
+    auto &dims = in.value().dims();
+    int64_t in_width = dims.size() > 1
+                           ? framework::product(
+                                 framework::slice_ddim(dims, 1, dims.size()))
+                           : 1;
+    if (i == 0) {
+      height = in.height();
+      width = in_width;
+    }
+    PADDLE_ENFORCE_EQ(in_width, width,
+                      platform::errors::InvalidArgument(
+                          "The widths of %s on different places should be "
+                          "equal, but got %d and %d.",
+                          in_var_handles[i]->name(), in_width, width));
+
+    auto &buffers = buffers_[i];
+    auto *dev_ctx = nccl_ctxs->DevCtx(p);
+    buffers.merged.mutable_rows()->clear();
+    if (!in.rows().empty()) {
+      merge_add(*dev_ctx, in, &buffers.merged);
+    }
+    local_counts_[i] = static_cast<int64_t>(buffers.merged.rows().size());
+
+    // The last element is the sending buffer.
+    auto *counts = buffers.counts.mutable_data<int64_t>(
+        framework::make_ddim({nranks_ + 1}), p);
+    auto stream = dev_ctx->stream();
+    memory::Copy(BOOST_GET_CONST(platform::CUDAPlace, p), counts + nranks_,
+                 cpu_place, &local_counts_[i], sizeof(int64_t), stream);
+    auto comm = nccl_ctxs->at(p).comm();
+    all_gather_calls.emplace_back([=] {
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllGather(
+          counts + nranks_, counts, 1, ncclInt64, comm, stream));
+    });
+  }
+  NCCLAllGather(all_gather_calls);
+
+  // The gathered numbers are the same on every device, so only the ones of
+  // the first device are copied.
+  std::vector<int64_t> counts(nranks_);
+  auto stream0 = nccl_ctxs->DevCtx(places_[0])->stream();
+  memory::Copy(cpu_place, counts.data(),
+               BOOST_GET_CONST(platform::CUDAPlace, places_[0]),
+               buffers_[0].counts.data<int64_t>(), nranks_ * sizeof(int64_t),
+               stream0);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream0));
+  int64_t max_count = *std::max_element(counts.begin(), counts.end());
+  VLOG(10) << Name() << " " << in_var_handles[0]->name()
+           << " max rows:" << max_count << ", width:" << width;
+
+  if (max_count == 0) {
+    for (size_t i = 0; i < num_places; ++i) {
+      auto *out = local_exec_scopes_[i]
+                      ->FindVar(out_var_handles[i]->name())
+                      ->GetMutable<SelectedRows>();
+      out->mutable_rows()->clear();
+      out->set_height(height);
+    }
+    return;
+  }
+
+  // 2. Pad the merged rows and values to max_count, and all gather them.
+  all_gather_calls.clear();
+  ncclDataType_t nccl_dtype =
+      platform::ToNCCLDataType(DataTypeTrait<T>::DataType());
+  for (size_t i = 0; i < num_places; ++i) {
+    auto &p = places_[i];
+    auto place = BOOST_GET_CONST(platform::CUDAPlace, p);
+    auto &buffers = buffers_[i];
+    auto stream = nccl_ctxs->DevCtx(p)->stream();
+    auto comm = nccl_ctxs->at(p).comm();
+
+    auto *send_rows = buffers.send_rows.mutable_data<int64_t>(
+        framework::make_ddim({max_count}), p);
+    auto *send_values = buffers.send_values.mutable_data<T>(
+        framework::make_ddim({max_count, width}), p);
+    auto *recv_rows = buffers.recv_rows.mutable_data<int64_t>(
+        framework::make_ddim({nranks_ * max_count}), p);
+    auto *recv_values = buffers.recv_values.mutable_data<T>(
+        framework::make_ddim({nranks_ * max_count, width}), p);
+
+    int64_t count = local_counts_[i];
+    if (count > 0) {
+      memory::Copy(place, send_rows, place,
+                   buffers.merged.rows().CUDAData(p), count * sizeof(int64_t),
+                   stream);
+      memory::Copy(place, send_values, place,
+                   buffers.merged.value().data<T>(),
+                   count * width * sizeof(T), stream);
+    }
+
+    all_gather_calls.emplace_back([=] {
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllGather(
+          send_rows, recv_rows, max_count, ncclInt64, comm, stream));
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllGather(
+          send_values, recv_values, max_count * width, nccl_dtype, comm,
+          stream));
+    });
+  }
+  NCCLAllGather(all_gather_calls);
+
+  // The rows are needed on CPU to merge them.
+  std::vector<int64_t> rows(nranks_ * max_count);
+  memory::Copy(cpu_place, rows.data(),
+               BOOST_GET_CONST(platform::CUDAPlace, places_[0]),
+               buffers_[0].recv_rows.data<int64_t>(),
+               rows.size() * sizeof(int64_t), stream0);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream0));
+
+  // 3. Merge the gathered rows of all ranks on every device, skipping the
+  // padded ones.
+  this->RunAndRecordEvent([&] {
+    for (size_t i = 0; i < num_places; ++i) {
+      auto &p = places_[i];
+      std::vector<SelectedRows> parts(nranks_);
+      std::vector<const SelectedRows *> part_ptrs;
+      part_ptrs.reserve(nranks_);
+      for (int r = 0; r < nranks_; ++r) {
+        if (counts[r] == 0) continue;
+        auto begin = rows.begin() + r * max_count;
+        parts[r].set_rows(std::vector<int64_t>(begin, begin + counts[r]));
+        parts[r].set_height(height);
+        *parts[r].mutable_value() = buffers_[i].recv_values.Slice(
+            r * max_count, r * max_count + counts[r]);
+        part_ptrs.emplace_back(&parts[r]);
+      }
+
+      auto *out = local_exec_scopes_[i]
+                      ->FindVar(out_var_handles[i]->name())
+                      ->GetMutable<SelectedRows>();
+      merge_add(*nccl_ctxs->DevCtx(p), part_ptrs, out);
+    }
+  });
+}
+
+void SparseAllGatherOpHandle::NCCLAllGather(
+    const std::vector<std::function<void()>> &calls) {
+  this->RunAndRecordEvent([&] {
+    if (calls.size() == 1UL) {
+      calls[0]();
+    } else {
+      platform::NCCLGroupGuard guard;
+      for (auto &call : calls) {
+        call();
+      }
+    }
+  });
+
+  if (FLAGS_sync_nccl_allreduce) {
+    auto *nccl_ctxs = nccl_ctxs_->GetFlatCtx(run_order_);
+    for (auto &p : places_) {
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaStreamSynchronize(nccl_ctxs->DevCtx(p)->stream()));
+    }
+  }
+}
+
+std::string SparseAllGatherOpHandle::Name() const {
+  return "sparse_all_gather";
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/details/nccl_op_handle.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/platform/nccl_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+/**
+ * SparseAllGatherOpHandle sums the SelectedRows gradients of all ranks
+ * without a reduce device:
+ *
+ * 1. The duplicated rows of the gradient are merged on each device.
+ * 2. The numbers of merged rows are all gathered, and the rows and values of
+ *    every rank are padded to the maximum number and all gathered with NCCL.
+ * 3. The gathered gradients are merged again on every device, so that every
+ *    device gets the same summed gradient.
+ */
+class SparseAllGatherOpHandle : public NCCLOpHandleBase {
+ public:
+  SparseAllGatherOpHandle(ir::Node *node,
+                          const std::vector<Scope *> &local_scopes,
+                          const std::vector<platform::Place> &places,
+                          const platform::NCCLCommunicator *ctxs, int nranks);
+
+  std::string Name() const override;
+
+  bool IsMultiDeviceTransfer() override { return true; }
+
+ protected:
+  void RunImpl() override;
+
+  std::vector<Scope *> GetLocalScopes() override { return local_scopes_; }
+
+ private:
+  template <typename T>
+  void AllGatherSelectedRows(const std::vector<VarHandle *> &in_var_handles,
+                             const std::vector<VarHandle *> &out_var_handles);
+
+  void NCCLAllGather(const std::vector<std::function<void()>> &calls);
+
+  // The buffers of each place. They are kept between iterations, so that
+  // they are alive until the asynchronous copies and NCCL calls finish.
+  struct AllGatherBuffers {
+    SelectedRows merged;
+    Tensor counts;
+    Tensor send_rows;
+    Tensor send_values;
+    Tensor recv_rows;
+    Tensor recv_values;
+  };
+
+  std::vector<Scope *> local_scopes_;
+  int nranks_;
+  std::vector<AllGatherBuffers> buffers_;
+  std::vector<int64_t> local_counts_;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -82,6 +82,7 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
 
   exception_holder_.Clear();
   event.reset(nullptr);
+  timeline_.BeginStep();
 
   // Step 3. Execution
   if (strategy_.num_threads_ == 1 && traced_ops_.size() == num_ops) {
@@ -105,6 +106,9 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
     };
     // Clean run context
     run_op_futures_.clear();
+    for (auto *op : ready_ops) {
+      timeline_.RecordReady(op, nullptr);
+    }
 
     while (!pending_vars.empty()) {
       // 1. Run All Ready ops
@@ -133,6 +137,7 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
           auto &deps = pending_ops[op];
           --deps;
           if (deps == 0) {
+            timeline_.RecordReady(op, ready_var->GeneratedOp());
             ready_ops.insert(op);
           }
         }
@@ -143,6 +148,7 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
 
   // Wait FetchOps.
   ClearFetchOp(graph_, &fetch_ops);
+  timeline_.EndStep();
 
   return fetch_data;
 }
@@ -338,9 +344,11 @@ bool ThreadedSSAGraphExecutor::RunTracedOps(
 bool ThreadedSSAGraphExecutor::RunOpSync(OpHandleBase *op) {
   try {
     VLOG(10) << op << " " << op->Name() << " : " << op->DebugString();
+    timeline_.RecordStart(op);
     if (LIKELY(!strategy_.dry_run_)) {
       op->Run(strategy_.use_cuda_);
     }
+    timeline_.RecordEnd(op);
     VLOG(10) << op << " " << op->Name() << " Done ";
     return true;
   } catch (...) {
@@ -24,6 +24,21 @@ void DeviceWorker::SetDataFeed(DataFeed* data_feed) {
   device_reader_ = data_feed;
 }
 
+int DeviceWorker::ReadNextBatch() {
+  platform::RecordStepPhase phase(platform::StepPhase::kDataWait,
+                                  "DataFeed::Next");
+  return device_reader_->Next();
+}
+
+void DeviceWorker::PrintStepPhases(int64_t batch_num) {
+  int batch_per_print = fetch_config_.print_period();
+  if (batch_per_print <= 0 || batch_num % batch_per_print != 0) return;
+  auto* times = platform::ThreadStepPhaseTimes();
+  fprintf(stderr, "batch %s, %s\n", std::to_string(batch_num).c_str(),
+          times->Summary(batch_per_print).c_str());
+  times->Reset();
+}
+
 template <typename T>
 std::string PrintLodTensorType(Tensor* tensor, int64_t start, int64_t end) {
   auto count = tensor->numel();
@@ -14,7 +14,10 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <fstream>
 #include <map>
 #include <memory>
@@ -36,6 +39,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/reader/blocking_queue.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/port.h"
+#include "paddle/fluid/platform/step_phase.h"
 #include "paddle/fluid/platform/timer.h"
 
 #if defined(PADDLE_WITH_NCCL)
@@ -157,6 +161,11 @@ class DeviceWorker {
   virtual void DumpParam(const Scope& scope, const int batch_id);
   virtual void DumpField(const Scope& scope, int dump_mode,
                          int dump_interval = 10000);
+  // Read the next batch of the data feed in the data wait phase.
+  int ReadNextBatch();
+  // Print the data wait, compute and comm time of the thread per batch every
+  // print_period batches.
+  void PrintStepPhases(int64_t batch_num);
   Scope* root_scope_ = nullptr;
   Scope* thread_scope_;
   paddle::platform::Place place_;
@@ -192,6 +201,37 @@ class CPUWorkerBase : public DeviceWorker {
   int thread_id_;
 };
 
+// The ops a worker thread runs on one scope for every batch. The skipped ops
+// are left out and the variables of each op are resolved into its
+// RuntimeContext once, as NaiveExecutor does, while the ops keep the kernels
+// they choose and the outputs stay in the scope between the batches. The
+// contexts are bound again only when a variable of the scope or its
+// ancestors is created, erased or renamed, so running a batch looks up no
+// variable by name.
+class PreparedOps {
+ public:
+  void Prepare(const std::vector<OperatorBase*>& ops,
+               const std::vector<std::string>& skip_ops, const Scope* scope);
+  bool IsPrepared() const { return scope_ != nullptr; }
+  void Run(const platform::Place& place);
+
+ private:
+  struct PreparedOp {
+    OperatorBase* op;
+    std::unique_ptr<RuntimeContext> ctx;
+    // The variables of ctx, the inputs followed by the outputs.
+    std::vector<Variable*> vars;
+  };
+
+  void Bind();
+  bool Outdated() const;
+
+  const Scope* scope_ = nullptr;
+  std::vector<PreparedOp> ops_;
+  // The versions of the scope and its ancestors when the contexts are bound.
+  std::vector<std::pair<const Scope*, uint64_t>> bound_scopes_;
+};
+
 class HogwildWorker : public CPUWorkerBase {
  public:
   HogwildWorker() {}
@@ -213,6 +253,7 @@ class HogwildWorker : public CPUWorkerBase {
  protected:
   void CreateThreadOperators(const ProgramDesc& program);
   void CreateThreadScope(const ProgramDesc& program);
+  void BindNumaNode();
 
   std::vector<std::string> op_names_;
   std::vector<OperatorBase*> ops_;
@@ -221,6 +262,8 @@ class HogwildWorker : public CPUWorkerBase {
   HogwildWorkerParameter param_;
   std::vector<std::string> skip_ops_;
   std::map<std::string, int> stat_var_name_map_;
+  // ops_ without skip_ops_ prepared on thread_scope_.
+  PreparedOps prepared_ops_;
 };
 
 class DownpourWorker : public HogwildWorker {
@@ -232,12 +275,30 @@ class DownpourWorker : public HogwildWorker {
   virtual void TrainFilesWithProfiler();
 
  protected:
+  // A batch read by the data feed with its sparse values. With
+  // pipeline_pull_sparse, there are two of them in the kids of thread_scope_
+  // holding the feed and the embedding vars, so the next batch is read and
+  // pulled while the current one computes.
+  struct SparseBatch {
+    Scope* scope = nullptr;
+    int batch_size = 0;
+    std::map<uint64_t, std::vector<uint64_t>> features;
+    std::map<uint64_t, std::vector<std::vector<float>>> feature_values;
+    std::map<uint64_t, std::vector<float>> feature_labels;
+    std::vector<float> nid_show;
+    PreparedOps ops;
+  };
+
   std::shared_ptr<paddle::framework::FleetWrapper> fleet_ptr_;
   std::shared_ptr<paddle::framework::PullDenseWorker> pull_dense_worker_;
-  void FillSparseValue(size_t table_id);
-  void PushGradients();
-  void CollectLabelInfo(size_t table_id);
-  void AdjustInsWeight();
+  // The helpers work on thread_scope_ and the members if batch is null.
+  void FillSparseValue(size_t table_id, SparseBatch* batch = nullptr);
+  void PushGradients(int batch_size, SparseBatch* batch = nullptr);
+  void CollectLabelInfo(size_t table_id, SparseBatch* batch = nullptr);
+  void AdjustInsWeight(SparseBatch* batch = nullptr);
+  // Read the next batch into batch and pull its sparse values.
+  void PrefetchSparseBatch(SparseBatch* batch);
+  void TrainFilesPipelined();
   void CopySparseTable();
   void CopyDenseTable();
   void CopyDenseVars();
@@ -278,6 +339,8 @@ class DownpourWorker : public HogwildWorker {
   std::map<uint64_t, std::vector<std::string>> dense_value_names_;
   std::map<uint64_t, uint64_t> table_dependency_;
   std::vector<std::pair<uint64_t, uint64_t>> copy_dense_tables_;
+  bool pipeline_pull_sparse_ = false;
+  SparseBatch sparse_batches_[2];
 
  private:
   // std::vector<std::string> dump_param_;
@@ -342,6 +405,57 @@ class SyncFunctor {
   void Synchronize();
 };
 
+// The one-forward-one-backward (1F1B) schedule of a pipeline. The pipeline of
+// 2n-1 sections has n stages: the stage i (i < n-1) consists of the forward
+// section i and the backward section 2n-2-i, and the stage n-1 is the middle
+// section which runs both the forward and backward of the last stage.
+//
+// The forward section of stage i waits before running a micro-batch until
+// less than n-i micro-batches are in flight in the stage, i.e., have finished
+// the forward but not the backward of the stage. So after the warm-up, each
+// stage alternates one forward and one backward, and at most n micro-batches
+// hold their activations at the same time. The pipeline is flushed every
+// num_microbatches micro-batches.
+class PipelineScheduler {
+ public:
+  PipelineScheduler(int section_num, int num_microbatches);
+
+  int StageNum() const { return stage_num_; }
+
+  // Called by the section before running a micro-batch. It blocks the forward
+  // sections until the micro-batch is allowed to run.
+  void BeforeRun(int section_id);
+  // Called by the section after running a micro-batch.
+  void AfterRun(int section_id);
+
+  // Returns the statistics of the overlap between stages.
+  std::string Report() const;
+
+ private:
+  bool IsForward(int section_id) const { return section_id < stage_num_ - 1; }
+  bool IsBackward(int section_id) const { return section_id > stage_num_ - 1; }
+  int StageOf(int section_id) const {
+    return std::min(section_id, section_num_ - 1 - section_id);
+  }
+  // Accumulates the time since the last event to the busy stage count.
+  void Accumulate();
+
+  const int section_num_;
+  const int stage_num_;
+  const int num_microbatches_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  int64_t microbatch_id_{0};
+  std::vector<int> in_flight_;
+  std::vector<int> running_sections_;
+  int busy_stages_{0};
+  // busy_time_[i] is the time in seconds when i stages are running.
+  std::vector<double> busy_time_;
+  std::chrono::steady_clock::time_point last_event_;
+  bool started_{false};
+};
+
 class SectionWorker : public DeviceWorker {
  public:
   SectionWorker() {}
@@ -380,11 +494,16 @@ class SectionWorker : public DeviceWorker {
   }
   SyncFunctor* sync_func_ = nullptr;
   void SetSyncFunctor(SyncFunctor* sync_func) { sync_func_ = sync_func; }
+  void SetPipelineScheduler(PipelineScheduler* scheduler) {
+    scheduler_ = scheduler;
+  }
 
   static std::atomic<int> cpu_id_;
 
  protected:
   void AutoSetCPUAffinity(bool reuse);
+  // Receive the scope from the previous section in the data wait phase.
+  bool ReceiveScope(Scope** scope);
   int section_id_;
   int pipeline_id_;
   int section_num_;
@@ -399,6 +518,7 @@ class SectionWorker : public DeviceWorker {
   std::mutex* worker_count_mutex_ = nullptr;
   int* worker_count_ = nullptr;
   paddle::platform::Place next_section_place_;
+  PipelineScheduler* scheduler_ = nullptr;
 
   std::vector<std::unique_ptr<OperatorBase>> ops_;
 
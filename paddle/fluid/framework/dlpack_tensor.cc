@@ -94,6 +94,7 @@ struct DLContextVisitor : public boost::static_visitor<::DLContext> {
 DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
   // init data, data buffer
   t_.data = const_cast<void *>(tensor.data<void>());
+  holder_ = tensor.Holder();
 
   // init ctx, DLContext type with device_type and device_id
   auto place = tensor.place();
@@ -149,10 +150,13 @@ DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
   tensor->deleter = [](DLManagedTensor *arg) {
     delete[] arg->dl_tensor.shape;
     delete[] arg->dl_tensor.strides;
+    delete static_cast<std::shared_ptr<memory::Allocation> *>(
+        arg->manager_ctx);
     delete arg;
   };
 
-  tensor->manager_ctx = nullptr;
+  // the consumer holds a reference of the memory until the deleter is called
+  tensor->manager_ctx = new std::shared_ptr<memory::Allocation>(holder_);
 
   return tensor;
 }
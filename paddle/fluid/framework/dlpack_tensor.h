@@ -15,6 +15,7 @@
 #pragma once
 
 #include <dlpack/dlpack.h>
+#include <memory>
 #include "paddle/fluid/framework/tensor.h"
 
 namespace paddle {
@@ -33,11 +34,15 @@ class DLPackTensor {
 
   inline operator ::DLTensor&() { return t_; }
 
+  // The returned tensor shares the memory of the tensor and keeps it alive
+  // until its deleter is called, even if the tensor is destroyed or resized.
   ::DLManagedTensor* ToCudfCompatibleDLManagedTensor();
 
  private:
   ::DLTensor t_;
 
+  std::shared_ptr<memory::Allocation> holder_;
+
   // The shape in DLTensor is defined as int64_t*
   // Add this member to make TVMTensor init without heap allocation
   ShapeType shape_[DDim::kMaxRank];
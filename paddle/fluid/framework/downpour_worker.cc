@@ -72,6 +72,7 @@ void DownpourWorker::Initialize(const TrainerDesc& desc) {
 
   need_to_push_sparse_ = param_.push_sparse();
   need_to_push_dense_ = param_.push_dense();
+  pipeline_pull_sparse_ = param_.pipeline_pull_sparse();
 
   fleet_ptr_ = FleetWrapper::GetInstance();
   fetch_config_ = desc.fetch_config();
@@ -109,10 +110,11 @@ void DownpourWorker::Initialize(const TrainerDesc& desc) {
   }
 }
 
-void DownpourWorker::CollectLabelInfo(size_t table_idx) {
+void DownpourWorker::CollectLabelInfo(size_t table_idx, SparseBatch* batch) {
   if (no_cvm_) {
     return;
   }
+  Scope* scope = batch == nullptr ? thread_scope_ : batch->scope;
   uint64_t table_id = static_cast<uint64_t>(
       param_.program_config(0).pull_sparse_table_id(table_idx));
 
@@ -123,10 +125,11 @@ void DownpourWorker::CollectLabelInfo(size_t table_idx) {
       break;
     }
   }
-  auto& feature = features_[table_id];
-  auto& feature_label = feature_labels_[table_id];
+  auto& feature = (batch == nullptr ? features_ : batch->features)[table_id];
+  auto& feature_label =
+      (batch == nullptr ? feature_labels_ : batch->feature_labels)[table_id];
   feature_label.resize(feature.size());
-  Variable* var = thread_scope_->FindVar(label_var_name_[table_id]);
+  Variable* var = scope->FindVar(label_var_name_[table_id]);
   LoDTensor* tensor = var->GetMutable<LoDTensor>();
   int64_t* label_ptr = tensor->data<int64_t>();
 
@@ -134,7 +137,7 @@ void DownpourWorker::CollectLabelInfo(size_t table_idx) {
   for (size_t i = 0; i < sparse_key_names_[table_id].size(); ++i) {
     VLOG(3) << "sparse_key_names_[" << i
             << "]: " << sparse_key_names_[table_id][i];
-    Variable* fea_var = thread_scope_->FindVar(sparse_key_names_[table_id][i]);
+    Variable* fea_var = scope->FindVar(sparse_key_names_[table_id][i]);
     if (fea_var == nullptr) {
       continue;
     }
@@ -143,8 +146,7 @@ void DownpourWorker::CollectLabelInfo(size_t table_idx) {
                              << sparse_key_names_[table_id][i] << " is null";
 
     // skip slots which do not have embedding
-    Variable* emb_var =
-        thread_scope_->FindVar(sparse_value_names_[table_id][i]);
+    Variable* emb_var = scope->FindVar(sparse_value_names_[table_id][i]);
     if (emb_var == nullptr) {
       continue;
     }
@@ -167,7 +169,9 @@ void DownpourWorker::CollectLabelInfo(size_t table_idx) {
       << "expect fea info size:" << feature.size() << " real:" << global_index;
 }
 
-void DownpourWorker::FillSparseValue(size_t table_idx) {
+void DownpourWorker::FillSparseValue(size_t table_idx, SparseBatch* batch) {
+  Scope* scope = batch == nullptr ? thread_scope_ : batch->scope;
+  auto& nid_show = batch == nullptr ? nid_show_ : batch->nid_show;
   uint64_t table_id = static_cast<uint64_t>(
       param_.program_config(0).pull_sparse_table_id(table_idx));
 
@@ -179,14 +183,15 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
     }
   }
 
-  auto& fea_value = feature_values_[table_id];
+  auto& fea_value =
+      (batch == nullptr ? feature_values_ : batch->feature_values)[table_id];
   auto fea_idx = 0u;
 
   std::vector<float> init_value(table.fea_dim());
   for (size_t i = 0; i < sparse_key_names_[table_id].size(); ++i) {
     std::string slot_name = sparse_key_names_[table_id][i];
     std::string emb_slot_name = sparse_value_names_[table_id][i];
-    Variable* var = thread_scope_->FindVar(slot_name);
+    Variable* var = scope->FindVar(slot_name);
     if (var == nullptr) {
       continue;
     }
@@ -194,7 +199,7 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
     CHECK(tensor != nullptr) << "tensor of var " << slot_name << " is null";
     int64_t* ids = tensor->data<int64_t>();
     int len = tensor->numel();
-    Variable* var_emb = thread_scope_->FindVar(emb_slot_name);
+    Variable* var_emb = scope->FindVar(emb_slot_name);
     if (var_emb == nullptr) {
       continue;
     }
@@ -209,7 +214,7 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
     bool is_nid = (adjust_ins_weight_config_.need_adjust() &&
                    adjust_ins_weight_config_.nid_slot() == emb_slot_name);
     if (is_nid) {
-      nid_show_.clear();
+      nid_show.clear();
     }
     int nid_ins_index = 0;
 
@@ -219,7 +224,7 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
           memcpy(ptr + table.emb_dim() * index, init_value.data(),
                  sizeof(float) * table.emb_dim());
           if (is_nid) {
-            nid_show_.push_back(-1);
+            nid_show.push_back(-1);
             ++nid_ins_index;
           }
           continue;
@@ -228,7 +233,7 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
                sizeof(float) * table.emb_dim());
         if (is_nid &&
             static_cast<size_t>(index) == tensor->lod()[0][nid_ins_index]) {
-          nid_show_.push_back(fea_value[fea_idx][0]);
+          nid_show.push_back(fea_value[fea_idx][0]);
           ++nid_ins_index;
         }
         fea_idx++;
@@ -237,7 +242,7 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
           memcpy(ptr + table.emb_dim() * index, init_value.data() + 2,
                  sizeof(float) * table.emb_dim());
           if (is_nid) {
-            nid_show_.push_back(-1);
+            nid_show.push_back(-1);
             ++nid_ins_index;
           }
           continue;
@@ -246,7 +251,7 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
                sizeof(float) * table.emb_dim());
         if (is_nid &&
             static_cast<size_t>(index) == tensor->lod()[0][nid_ins_index]) {
-          nid_show_.push_back(fea_value[fea_idx][0]);
+          nid_show.push_back(fea_value[fea_idx][0]);
           ++nid_ins_index;
         }
         fea_idx++;
@@ -255,15 +260,16 @@ void DownpourWorker::FillSparseValue(size_t table_idx) {
   }
 }
 
-void DownpourWorker::AdjustInsWeight() {
+void DownpourWorker::AdjustInsWeight(SparseBatch* batch) {
 #ifdef _LINUX
+  Scope* scope = batch == nullptr ? thread_scope_ : batch->scope;
+  auto& nid_show_vec = batch == nullptr ? nid_show_ : batch->nid_show;
   // check var and tensor not null
   if (!adjust_ins_weight_config_.need_adjust()) {
     VLOG(0) << "need_adjust=false, skip adjust ins weight";
     return;
   }
-  Variable* nid_var =
-      thread_scope_->FindVar(adjust_ins_weight_config_.nid_slot());
+  Variable* nid_var = scope->FindVar(adjust_ins_weight_config_.nid_slot());
   if (nid_var == nullptr) {
     VLOG(0) << "nid slot var " << adjust_ins_weight_config_.nid_slot()
             << " is nullptr, skip adjust ins weight";
@@ -276,7 +282,7 @@ void DownpourWorker::AdjustInsWeight() {
     return;
   }
   Variable* ins_weight_var =
-      thread_scope_->FindVar(adjust_ins_weight_config_.ins_weight_slot());
+      scope->FindVar(adjust_ins_weight_config_.ins_weight_slot());
   if (ins_weight_var == nullptr) {
     VLOG(0) << "ins weight var " << adjust_ins_weight_config_.ins_weight_slot()
             << " is nullptr, skip adjust ins weight";
@@ -293,16 +299,16 @@ void DownpourWorker::AdjustInsWeight() {
   float* ins_weights = ins_weight_tensor->data<float>();
   size_t len = ins_weight_tensor->numel();  // len = batch size
   // here we assume nid_show slot only has one feasign in each instance
-  CHECK(len == nid_show_.size()) << "ins_weight size should be equal to "
-                                 << "nid_show size, " << len << " vs "
-                                 << nid_show_.size();
+  CHECK(len == nid_show_vec.size())
+      << "ins_weight size should be equal to "
+      << "nid_show size, " << len << " vs " << nid_show_vec.size();
   float nid_adjw_threshold = adjust_ins_weight_config_.nid_adjw_threshold();
   float nid_adjw_ratio = adjust_ins_weight_config_.nid_adjw_ratio();
   int64_t nid_adjw_num = 0;
   double nid_adjw_weight = 0.0;
   size_t ins_index = 0;
   for (size_t i = 0; i < len; ++i) {
-    float nid_show = nid_show_[i];
+    float nid_show = nid_show_vec[i];
     VLOG(3) << "nid_show " << nid_show;
     if (nid_show < 0) {
       VLOG(3) << "nid_show < 0, continue";
@@ -430,6 +436,7 @@ void DownpourWorker::CopyDenseVars() {
 void DownpourWorker::TrainFilesWithProfiler() {
   VLOG(3) << "Begin to train files with profiler";
   platform::SetNumThreads(1);
+  BindNumaNode();
   device_reader_->Start();
   std::vector<double> op_total_time;
   std::vector<std::string> op_name;
@@ -465,7 +472,7 @@ void DownpourWorker::TrainFilesWithProfiler() {
   int batch_cnt = 0;
   uint64_t total_inst = 0;
   timeline.Start();
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = ReadNextBatch()) > 0) {
     timeline.Pause();
     read_time += timeline.ElapsedSec();
     total_time += timeline.ElapsedSec();
@@ -721,13 +728,240 @@ void DownpourWorker::TrainFilesWithProfiler() {
   }
 }
 
+void DownpourWorker::PushGradients(int batch_size, SparseBatch* batch) {
+  Scope* scope = batch == nullptr ? thread_scope_ : batch->scope;
+  auto& features = batch == nullptr ? features_ : batch->features;
+  auto& feature_labels =
+      batch == nullptr ? feature_labels_ : batch->feature_labels;
+  if (need_to_push_sparse_) {
+    // push gradients here
+    for (int i = 0; i < param_.program_config(0).push_sparse_table_id_size();
+         ++i) {
+      uint64_t tid = static_cast<uint64_t>(
+          param_.program_config(0).push_sparse_table_id(i));
+      TableParameter table;
+      for (auto i : param_.sparse_table()) {
+        if (i.table_id() == tid) {
+          table = i;
+          break;
+        }
+      }
+      fleet_ptr_->PushSparseVarsWithLabelAsync(
+          *scope, tid, features[tid], feature_labels[tid],
+          sparse_key_names_[tid], sparse_grad_names_[tid], table.emb_dim(),
+          &feature_grads_[tid], &push_sparse_status_, batch_size, use_cvm_,
+          dump_slot_, &sparse_push_keys_[tid], no_cvm_);
+    }
+  }
+
+#ifdef PADDLE_WITH_PSLIB
+  if (copy_table_config_.need_copy()) {
+    if (copy_table_config_.sparse_copy_by_feasign()) {
+      for (size_t i = 0; i < copy_sparse_tables_.size(); ++i) {
+        uint64_t tid = copy_sparse_tables_[i].first;
+        feasign_set_[tid].insert(sparse_push_keys_[tid].begin(),
+                                 sparse_push_keys_[tid].end());
+      }
+    }
+  }
+#endif
+
+  if (need_to_push_dense_) {
+    for (int i = 0; i < param_.program_config(0).push_dense_table_id_size();
+         ++i) {
+      uint64_t tid = static_cast<uint64_t>(
+          param_.program_config(0).push_dense_table_id(i));
+      fleet_ptr_->PushDenseVarsAsync(
+          *scope, tid, dense_grad_names_[tid], &push_sparse_status_,
+          scale_datanorm_, batch_size);
+    }
+    VLOG(3) << "push dense gradient done.";
+
+    // the following code should be more precise and clean
+    // TODO(guru4elephant)
+    int32_t tmp_push_dense_wait_times = -1;
+    static uint32_t push_dense_wait_times =
+        static_cast<uint32_t>(tmp_push_dense_wait_times);
+
+    if (push_dense_status_.size() >= push_dense_wait_times) {
+      platform::RecordStepPhase comm(platform::StepPhase::kComm,
+                                     "PushDenseWait");
+      for (auto& t : push_dense_status_) {
+        t.wait();
+      }
+      push_dense_status_.resize(0);
+    }
+
+    if (tmp_push_dense_wait_times == -1) {
+      push_dense_status_.resize(0);
+    }
+  }
+
+  if (need_to_push_sparse_) {
+    VLOG(3) << "push sparse gradient done.";
+    int32_t tmp_push_sparse_wait_times = -1;
+    static uint32_t push_sparse_wait_times =
+        static_cast<uint32_t>(tmp_push_sparse_wait_times);
+    if (push_sparse_status_.size() >= push_sparse_wait_times) {
+      platform::RecordStepPhase comm(platform::StepPhase::kComm,
+                                     "PushSparseWait");
+      for (auto& t : push_sparse_status_) {
+        t.wait();
+      }
+      push_sparse_status_.resize(0);
+    }
+
+    if (tmp_push_sparse_wait_times == -1) {
+      push_sparse_status_.resize(0);
+    }
+  }
+
+  if (need_to_push_dense_) {
+    for (int i = 0; i < param_.program_config(0).push_dense_table_id_size();
+         ++i) {
+      uint64_t tid = static_cast<uint64_t>(
+          param_.program_config(0).push_dense_table_id(i));
+      pull_dense_worker_->IncreaseThreadVersion(thread_id_, tid);
+    }
+  }
+}
+
+void DownpourWorker::PrefetchSparseBatch(SparseBatch* batch) {
+  device_reader_->AssignFeedVar(*batch->scope);
+  batch->batch_size = ReadNextBatch();
+  if (batch->batch_size <= 0) {
+    return;
+  }
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    TableParameter table;
+    for (auto j : param_.sparse_table()) {
+      if (j.table_id() == tid) {
+        table = j;
+        break;
+      }
+    }
+    fleet_ptr_->PullSparseVarsSync(
+        *batch->scope, tid, sparse_key_names_[tid], &batch->features[tid],
+        &batch->feature_values[tid], table.fea_dim(), sparse_value_names_[tid]);
+    CollectLabelInfo(i, batch);
+    FillSparseValue(i, batch);
+    auto nid_iter = std::find(sparse_value_names_[tid].begin(),
+                              sparse_value_names_[tid].end(),
+                              adjust_ins_weight_config_.nid_slot());
+    if (nid_iter != sparse_value_names_[tid].end()) {
+      AdjustInsWeight(batch);
+    }
+  }
+}
+
+// The batches are double buffered: while the ops run on one of them, the
+// next one is read and its sparse values are pulled on another thread. So
+// the sparse values pulled may miss the push of the batch just before,
+// their staleness is bounded by one step.
+void DownpourWorker::TrainFilesPipelined() {
+  VLOG(3) << "Begin to train files with pipelined sparse pull";
+  platform::SetNumThreads(1);
+  BindNumaNode();
+  PADDLE_ENFORCE_EQ(need_dump_field_, false,
+                    platform::errors::Unimplemented(
+                        "Dumping fields is not supported with "
+                        "pipeline_pull_sparse, since the data feed is "
+                        "reading the next batch."));
+  for (auto& batch : sparse_batches_) {
+    if (batch.scope != nullptr) continue;
+    batch.scope = &thread_scope_->NewScope();
+    for (auto& name : device_reader_->GetUseSlotAlias()) {
+      batch.scope->Var(name)->GetMutable<LoDTensor>();
+    }
+    for (auto& it : sparse_value_names_) {
+      for (auto& name : it.second) {
+        batch.scope->Var(name)->GetMutable<LoDTensor>();
+      }
+    }
+    batch.ops.Prepare(ops_, skip_ops_, batch.scope);
+  }
+
+  device_reader_->Start();
+  int batch_cnt = 0;
+  int cur = 0;
+  PrefetchSparseBatch(&sparse_batches_[cur]);
+  while (sparse_batches_[cur].batch_size > 0) {
+    if (copy_table_config_.need_copy()) {
+      if (batch_cnt % copy_table_config_.batch_num() == 0) {
+        CopySparseTable();
+        CopyDenseTable();
+        CopyDenseVars();
+      }
+    }
+    SparseBatch& batch = sparse_batches_[cur];
+    SparseBatch* next = &sparse_batches_[1 - cur];
+    auto prefetch = std::async(std::launch::async, [this, next] {
+      platform::RecordStepPhase comm(platform::StepPhase::kComm,
+                                     "PrefetchSparseBatch");
+      PrefetchSparseBatch(next);
+    });
+
+    {
+      platform::RecordStepPhase compute(platform::StepPhase::kCompute,
+                                        "DownpourWorker");
+      batch.ops.Run(place_);
+    }
+
+    // check inf and nan
+    for (std::string& var_name : check_nan_var_names_) {
+      Variable* var = batch.scope->FindVar(var_name);
+      if (var == nullptr) {
+        continue;
+      }
+      LoDTensor* tensor = var->GetMutable<LoDTensor>();
+      if (tensor == nullptr) {
+        continue;
+      }
+      PADDLE_ENFORCE_EQ(framework::TensorContainsInf(*tensor), false,
+                        "Tensor %s contains Inf", var_name);
+      PADDLE_ENFORCE_EQ(framework::TensorContainsNAN(*tensor), false,
+                        "Tensor %s contains NAN", var_name);
+    }
+
+    PushGradients(batch.batch_size, &batch);
+    if (need_dump_param_ && thread_id_ == 0) {
+      DumpParam(*batch.scope, batch_cnt);
+    }
+
+    PrintFetchVars();
+    batch.scope->DropKids();
+    prefetch.get();
+    cur = 1 - cur;
+    ++batch_cnt;
+  }
+  if (need_dump_param_) {
+    writer_.Flush();
+  }
+  if (copy_table_config_.need_copy()) {
+    CopySparseTable();
+    CopyDenseTable();
+    CopyDenseVars();
+  }
+}
+
 void DownpourWorker::TrainFiles() {
+  if (pipeline_pull_sparse_) {
+    TrainFilesPipelined();
+    return;
+  }
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
+  BindNumaNode();
+  if (!prepared_ops_.IsPrepared()) {
+    prepared_ops_.Prepare(ops_, skip_ops_, thread_scope_);
+  }
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = ReadNextBatch()) > 0) {
     if (copy_table_config_.need_copy()) {
       if (batch_cnt % copy_table_config_.batch_num() == 0) {
         CopySparseTable();
@@ -747,9 +981,13 @@ void DownpourWorker::TrainFiles() {
           break;
         }
       }
-      fleet_ptr_->PullSparseVarsSync(
-          *thread_scope_, tid, sparse_key_names_[tid], &features_[tid],
-          &feature_values_[tid], table.fea_dim(), sparse_value_names_[tid]);
+      {
+        platform::RecordStepPhase comm(platform::StepPhase::kComm,
+                                       "PullSparseVarsSync");
+        fleet_ptr_->PullSparseVarsSync(
+            *thread_scope_, tid, sparse_key_names_[tid], &features_[tid],
+            &feature_values_[tid], table.fea_dim(), sparse_value_names_[tid]);
+      }
       CollectLabelInfo(i);
       FillSparseValue(i);
       auto nid_iter = std::find(sparse_value_names_[tid].begin(),
@@ -762,61 +1000,52 @@ void DownpourWorker::TrainFiles() {
     VLOG(3) << "fill sparse value for all sparse table done.";
 
     // do computation here
-    for (auto& op : ops_) {
-      bool need_skip = false;
-      for (auto t = 0u; t < skip_ops_.size(); ++t) {
-        if (op->Type().find(skip_ops_[t]) != std::string::npos) {
-          need_skip = true;
-          break;
-        }
-      }
-      if (!need_skip) {
+    platform::RecordStepPhase compute(platform::StepPhase::kCompute,
+                                      "DownpourWorker");
 #ifdef PADDLE_WITH_PSLIB
-        try {
-          op->Run(*thread_scope_, place_);
-        } catch (std::exception& e) {
-          fprintf(stderr, "error message: %s\n", e.what());
-          auto& ins_id_vec = device_reader_->GetInsIdVec();
-          size_t batch_size = device_reader_->GetCurBatchSize();
-          std::string s = "";
-          for (auto& ins_id : ins_id_vec) {
-            if (s != "") s += ",";
-            s += ins_id;
-          }
-          fprintf(stderr, "batch_size: %zu, ins_ids_vec: %s\n", batch_size,
-                  s.c_str());
-          s = "";
-          for (auto& param : all_param_) {
-            Variable* var = thread_scope_->FindVar(param);
-            if (var == nullptr) {
-              continue;
-            }
-            Tensor* tensor = nullptr;
-            int64_t len = 0;
-            if (var->IsType<framework::LoDTensor>()) {
-              tensor = var->GetMutable<LoDTensor>();
-              len = tensor->numel();
-            } else if (var->IsType<SelectedRows>()) {
-              auto selected_rows = var->GetMutable<SelectedRows>();
-              tensor = selected_rows->mutable_value();
-              len = tensor->numel();
-            }
-            if (!tensor->IsInitialized()) {
-              continue;
-            }
-            s += param + ":" + std::to_string(len) + ":";
-            s += PrintLodTensor(tensor, 0, len);
-            fprintf(stderr, "%s\n", s.c_str());
-            fflush(stderr);
-            s = "";
-          }
-          throw e;
+    try {
+      prepared_ops_.Run(place_);
+    } catch (std::exception& e) {
+      fprintf(stderr, "error message: %s\n", e.what());
+      auto& ins_id_vec = device_reader_->GetInsIdVec();
+      size_t batch_size = device_reader_->GetCurBatchSize();
+      std::string s = "";
+      for (auto& ins_id : ins_id_vec) {
+        if (s != "") s += ",";
+        s += ins_id;
+      }
+      fprintf(stderr, "batch_size: %zu, ins_ids_vec: %s\n", batch_size,
+              s.c_str());
+      s = "";
+      for (auto& param : all_param_) {
+        Variable* var = thread_scope_->FindVar(param);
+        if (var == nullptr) {
+          continue;
         }
-#else
-        op->Run(*thread_scope_, place_);
-#endif
+        Tensor* tensor = nullptr;
+        int64_t len = 0;
+        if (var->IsType<framework::LoDTensor>()) {
+          tensor = var->GetMutable<LoDTensor>();
+          len = tensor->numel();
+        } else if (var->IsType<SelectedRows>()) {
+          auto selected_rows = var->GetMutable<SelectedRows>();
+          tensor = selected_rows->mutable_value();
+          len = tensor->numel();
+        }
+        if (!tensor->IsInitialized()) {
+          continue;
+        }
+        s += param + ":" + std::to_string(len) + ":";
+        s += PrintLodTensor(tensor, 0, len);
+        fprintf(stderr, "%s\n", s.c_str());
+        fflush(stderr);
+        s = "";
       }
+      throw e;
     }
+#else
+    prepared_ops_.Run(place_);
+#endif
 
     // check inf and nan
     for (std::string& var_name : check_nan_var_names_) {
@@ -834,93 +1063,7 @@ void DownpourWorker::TrainFiles() {
                         "Tensor %s contains NAN", var_name);
     }
 
-    if (need_to_push_sparse_) {
-      // push gradients here
-      for (int i = 0; i < param_.program_config(0).push_sparse_table_id_size();
-           ++i) {
-        uint64_t tid = static_cast<uint64_t>(
-            param_.program_config(0).push_sparse_table_id(i));
-        TableParameter table;
-        for (auto i : param_.sparse_table()) {
-          if (i.table_id() == tid) {
-            table = i;
-            break;
-          }
-        }
-        fleet_ptr_->PushSparseVarsWithLabelAsync(
-            *thread_scope_, tid, features_[tid], feature_labels_[tid],
-            sparse_key_names_[tid], sparse_grad_names_[tid], table.emb_dim(),
-            &feature_grads_[tid], &push_sparse_status_, cur_batch, use_cvm_,
-            dump_slot_, &sparse_push_keys_[tid], no_cvm_);
-      }
-    }
-
-#ifdef PADDLE_WITH_PSLIB
-    if (copy_table_config_.need_copy()) {
-      if (copy_table_config_.sparse_copy_by_feasign()) {
-        for (size_t i = 0; i < copy_sparse_tables_.size(); ++i) {
-          uint64_t tid = copy_sparse_tables_[i].first;
-          feasign_set_[tid].insert(sparse_push_keys_[tid].begin(),
-                                   sparse_push_keys_[tid].end());
-        }
-      }
-    }
-#endif
-
-    if (need_to_push_dense_) {
-      for (int i = 0; i < param_.program_config(0).push_dense_table_id_size();
-           ++i) {
-        uint64_t tid = static_cast<uint64_t>(
-            param_.program_config(0).push_dense_table_id(i));
-        fleet_ptr_->PushDenseVarsAsync(
-            *thread_scope_, tid, dense_grad_names_[tid], &push_sparse_status_,
-            scale_datanorm_, cur_batch);
-      }
-      VLOG(3) << "push dense gradient done.";
-
-      // the following code should be more precise and clean
-      // TODO(guru4elephant)
-      int32_t tmp_push_dense_wait_times = -1;
-      static uint32_t push_dense_wait_times =
-          static_cast<uint32_t>(tmp_push_dense_wait_times);
-
-      if (push_dense_status_.size() >= push_dense_wait_times) {
-        for (auto& t : push_dense_status_) {
-          t.wait();
-        }
-        push_dense_status_.resize(0);
-      }
-
-      if (tmp_push_dense_wait_times == -1) {
-        push_dense_status_.resize(0);
-      }
-    }
-
-    if (need_to_push_sparse_) {
-      VLOG(3) << "push sparse gradient done.";
-      int32_t tmp_push_sparse_wait_times = -1;
-      static uint32_t push_sparse_wait_times =
-          static_cast<uint32_t>(tmp_push_sparse_wait_times);
-      if (push_sparse_status_.size() >= push_sparse_wait_times) {
-        for (auto& t : push_sparse_status_) {
-          t.wait();
-        }
-        push_sparse_status_.resize(0);
-      }
-
-      if (tmp_push_sparse_wait_times == -1) {
-        push_sparse_status_.resize(0);
-      }
-    }
-
-    if (need_to_push_dense_) {
-      for (int i = 0; i < param_.program_config(0).push_dense_table_id_size();
-           ++i) {
-        uint64_t tid = static_cast<uint64_t>(
-            param_.program_config(0).push_dense_table_id(i));
-        pull_dense_worker_->IncreaseThreadVersion(thread_id_, tid);
-      }
-    }
+    PushGradients(cur_batch);
     if (need_dump_field_) {
       DumpField(*thread_scope_, dump_mode_, dump_interval_);
     }
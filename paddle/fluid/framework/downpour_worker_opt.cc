@@ -309,6 +309,7 @@ void DownpourWorkerOpt::CreateThreadOperatorsWithRerank(
 void DownpourWorkerOpt::TrainFiles() {
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
+  BindNumaNode();
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch;
@@ -327,7 +328,7 @@ void DownpourWorkerOpt::TrainFiles() {
     }
   }
   // pre-defined for the first op run with async-pulled embedding
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = ReadNextBatch()) > 0) {
     if (copy_table_config_.need_copy()) {
       if (copy_table_config_.sparse_copy_by_feasign()) {
         for (size_t i = 0; i < copy_sparse_tables_.size(); ++i) {
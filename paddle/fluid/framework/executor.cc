@@ -13,8 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/executor.h"
+#include <algorithm>
+#include <condition_variable>  // NOLINT
 #include <deque>
+#include <exception>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -35,11 +40,21 @@ limitations under the License. */
 #include "paddle/fluid/operators/controlflow/recurrent_op_helper.h"
 #include "paddle/fluid/operators/controlflow/while_op_helper.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(benchmark);
 DEFINE_bool(use_mkldnn, false, "Use MKLDNN to run");
+DEFINE_int32(executor_num_threads, 1,
+             "The number of threads to run the independent ops of a block in "
+             "parallel in Executor on CPU. If it is not greater than 1, the "
+             "ops are run one by one in the program order.");
+DEFINE_int32(executor_prepare_cache_capacity, 8,
+             "The maximum number of prepared contexts cached in each "
+             "Executor, so that running the same program repeatedly does not "
+             "create the operators and the garbage collection plan again. "
+             "0 means disabling the cache.");
 
 namespace paddle {
 namespace framework {
@@ -73,6 +88,87 @@ void ExecutorPrepareContext::PrepareUnusedVars(
   unused_vars_ = GetUnusedVars(prog_.Block(block_id_), ops_, keep_vars);
 }
 
+// The ops without kernels, e.g., feed, fetch and the control flow ops, may
+// access any variable in the scope, so they are run after all the previous
+// ops, and before all the following ops.
+static bool IsBarrierOp(const OperatorBase& op) {
+  return dynamic_cast<const OperatorWithKernel*>(&op) == nullptr;
+}
+
+void ExecutorPrepareContext::PrepareOpDependencies() {
+  size_t op_num = ops_.size();
+  downstream_ops_.assign(op_num, std::vector<size_t>());
+  num_upstream_ops_.assign(op_num, 0);
+
+  std::unordered_map<std::string, size_t> last_writers;
+  std::unordered_map<std::string, std::vector<size_t>> readers;
+  std::unordered_map<std::string, std::vector<size_t>> users;
+  int64_t last_barrier = -1;
+
+  for (size_t i = 0; i < op_num; ++i) {
+    auto* op = ops_[i].get();
+    std::set<size_t> upstream_ops;
+    if (IsBarrierOp(*op)) {
+      for (size_t j = last_barrier + 1; j < i; ++j) {
+        upstream_ops.insert(j);
+      }
+    } else if (last_barrier >= 0) {
+      upstream_ops.insert(last_barrier);
+    }
+
+    std::unordered_set<std::string> input_names, output_names;
+    for (auto& pair : op->Inputs()) {
+      input_names.insert(pair.second.begin(), pair.second.end());
+    }
+    for (auto& pair : op->Outputs()) {
+      output_names.insert(pair.second.begin(), pair.second.end());
+    }
+    input_names.erase(kEmptyVarName);
+    output_names.erase(kEmptyVarName);
+
+    // Read after write.
+    for (auto& name : input_names) {
+      auto iter = last_writers.find(name);
+      if (iter != last_writers.end()) upstream_ops.insert(iter->second);
+    }
+    // Write after write, and write after read.
+    for (auto& name : output_names) {
+      auto iter = last_writers.find(name);
+      if (iter != last_writers.end()) upstream_ops.insert(iter->second);
+      for (auto reader : readers[name]) upstream_ops.insert(reader);
+    }
+    // The unused variables are deleted after the op runs, so that all the
+    // other ops which use them must run before it.
+    auto unused_iter = unused_vars_.find(op);
+    if (unused_iter != unused_vars_.end()) {
+      for (auto& name : unused_iter->second) {
+        for (auto user : users[name]) upstream_ops.insert(user);
+      }
+    }
+    upstream_ops.erase(i);
+
+    for (auto& name : input_names) {
+      readers[name].push_back(i);
+      users[name].push_back(i);
+    }
+    for (auto& name : output_names) {
+      last_writers[name] = i;
+      readers[name].clear();
+      users[name].push_back(i);
+    }
+    if (IsBarrierOp(*op)) {
+      last_barrier = i;
+      last_writers.clear();
+      readers.clear();
+    }
+
+    for (auto upstream_op : upstream_ops) {
+      downstream_ops_[upstream_op].push_back(i);
+    }
+    num_upstream_ops_[i] = upstream_ops.size();
+  }
+}
+
 ExecutorPrepareContext::~ExecutorPrepareContext() {
   VLOG(5) << "destroy ExecutorPrepareContext";
 }
@@ -150,6 +246,14 @@ std::shared_ptr<TrainerBase> Executor::InitForDataset(
                     platform::errors::PreconditionNotMet(
                         "Fail to parse TrainerDesc from string:\n%s",
                         trainer_desc_str.c_str()));
+  if (trainer_desc.has_compute_thread_cpus()) {
+    platform::SetThreadKindCPUs(platform::ThreadKind::kCompute,
+                                trainer_desc.compute_thread_cpus());
+  }
+  if (trainer_desc.has_comm_thread_cpus()) {
+    platform::SetThreadKindCPUs(platform::ThreadKind::kComm,
+                                trainer_desc.comm_thread_cpus());
+  }
   VLOG(3) << "Going to create trainer, trainer class is "
           << trainer_desc.class_name();
   std::shared_ptr<TrainerBase> trainer;
@@ -187,9 +291,20 @@ void Executor::Run(const ProgramDesc& pdesc, Scope* scope, int block_id,
                    bool force_disable_gc, bool keep_kid_scopes) {
   platform::RecordBlock b(block_id);
   if (FLAGS_use_mkldnn) EnableMKLDNN(pdesc);
-  auto ctx = Prepare(pdesc, block_id, skip_ref_cnt_vars, force_disable_gc);
-  RunPreparedContext(ctx.get(), scope, create_local_scope, create_vars,
+  if (FLAGS_executor_prepare_cache_capacity <= 0) {
+    auto ctx = Prepare(pdesc, block_id, skip_ref_cnt_vars, force_disable_gc);
+    RunPreparedContext(ctx.get(), scope, create_local_scope, create_vars,
+                       keep_kid_scopes);
+    return;
+  }
+  auto entry = AcquirePreparedContext(
+      PrepareCacheKey(pdesc, block_id, skip_ref_cnt_vars, force_disable_gc),
+      block_id, skip_ref_cnt_vars, force_disable_gc, [&pdesc]() {
+        return std::unique_ptr<ProgramDesc>(new ProgramDesc(pdesc));
+      });
+  RunPreparedContext(entry.ctx.get(), scope, create_local_scope, create_vars,
                      keep_kid_scopes);
+  ReleasePreparedContext(std::move(entry));
 }
 
 // Check whether the block already has feed operators and feed_holder.
@@ -317,64 +432,131 @@ void Executor::Run(const ProgramDesc& program, Scope* scope,
   bool has_fetch_ops =
       has_fetch_operators(program.Block(0), *fetch_targets, fetch_holder_name);
 
-  ProgramDesc* copy_program = const_cast<ProgramDesc*>(&program);
-  std::unique_ptr<ProgramDesc> unique_ptr_of_copy_program;
-  if (!has_feed_ops || !has_fetch_ops) {
-    unique_ptr_of_copy_program.reset(new ProgramDesc(program));
-    copy_program = unique_ptr_of_copy_program.get();
-  }
-  auto* global_block = copy_program->MutableBlock(0);
-
-  if (!has_feed_ops) {
-    // create feed_holder variable
-    auto* feed_holder = global_block->Var(feed_holder_name);
-    feed_holder->SetType(proto::VarType::FEED_MINIBATCH);
-    feed_holder->SetPersistable(true);
-
-    int i = 0;
-    for (auto& feed_target : (*feed_targets)) {
-      std::string var_name = feed_target.first;
-      VLOG(3) << "feed target's name: " << var_name;
-
-      // prepend feed op
-      auto* op = global_block->PrependOp();
-      op->SetType(kFeedOpType);
-      op->SetInput("X", {feed_holder_name});
-      op->SetOutput("Out", {var_name});
-      op->SetAttr("col", {static_cast<int>(i)});
-      op->CheckAttrs();
+  // A copy of the program with the feed and fetch ops it lacks.
+  auto copy_program = [&]() {
+    std::unique_ptr<ProgramDesc> copy(new ProgramDesc(program));
+    auto* global_block = copy->MutableBlock(0);
+
+    if (!has_feed_ops) {
+      // create feed_holder variable
+      auto* feed_holder = global_block->Var(feed_holder_name);
+      feed_holder->SetType(proto::VarType::FEED_MINIBATCH);
+      feed_holder->SetPersistable(true);
+
+      int i = 0;
+      for (auto& feed_target : (*feed_targets)) {
+        std::string var_name = feed_target.first;
+        VLOG(3) << "feed target's name: " << var_name;
+
+        // prepend feed op
+        auto* op = global_block->PrependOp();
+        op->SetType(kFeedOpType);
+        op->SetInput("X", {feed_holder_name});
+        op->SetOutput("Out", {var_name});
+        op->SetAttr("col", {static_cast<int>(i)});
+        op->CheckAttrs();
+
+        i++;
+      }
+    }
 
-      i++;
+    if (!has_fetch_ops) {
+      // create fetch_holder variable
+      auto* fetch_holder = global_block->Var(fetch_holder_name);
+      fetch_holder->SetType(proto::VarType::FETCH_LIST);
+      fetch_holder->SetPersistable(true);
+
+      int i = 0;
+      for (auto& fetch_target : (*fetch_targets)) {
+        std::string var_name = fetch_target.first;
+        VLOG(3) << "fetch target's name: " << var_name;
+
+        // append fetch op
+        auto* op = global_block->AppendOp();
+        op->SetType(kFetchOpType);
+        op->SetInput("X", {var_name});
+        op->SetOutput("Out", {fetch_holder_name});
+        op->SetAttr("col", {static_cast<int>(i)});
+        op->CheckAttrs();
+
+        i++;
+      }
     }
+    return copy;
+  };
+
+  if (FLAGS_executor_prepare_cache_capacity <= 0) {
+    std::unique_ptr<ProgramDesc> copy;
+    if (!has_feed_ops || !has_fetch_ops) copy = copy_program();
+    auto ctx = Prepare(copy == nullptr ? program : *copy, 0);
+    RunPreparedContext(ctx.get(), scope, feed_targets, fetch_targets,
+                       create_local_scope, create_vars, feed_holder_name,
+                       fetch_holder_name);
+    return;
   }
+  // The feed and fetch ops added depend on the targets and the holders.
+  std::ostringstream key;
+  key << PrepareCacheKey(program, 0, {}, false) << ' ' << feed_holder_name
+      << ' ' << fetch_holder_name;
+  for (auto& feed_target : *feed_targets) key << ' ' << feed_target.first;
+  key << " ->";
+  for (auto& fetch_target : *fetch_targets) key << ' ' << fetch_target.first;
+  auto entry = AcquirePreparedContext(key.str(), 0, {}, false, copy_program);
+  RunPreparedContext(entry.ctx.get(), scope, feed_targets, fetch_targets,
+                     create_local_scope, create_vars, feed_holder_name,
+                     fetch_holder_name);
+  ReleasePreparedContext(std::move(entry));
+}
 
-  if (!has_fetch_ops) {
-    // create fetch_holder variable
-    auto* fetch_holder = global_block->Var(fetch_holder_name);
-    fetch_holder->SetType(proto::VarType::FETCH_LIST);
-    fetch_holder->SetPersistable(true);
-
-    int i = 0;
-    for (auto& fetch_target : (*fetch_targets)) {
-      std::string var_name = fetch_target.first;
-      VLOG(3) << "fetch target's name: " << var_name;
-
-      // append fetch op
-      auto* op = global_block->AppendOp();
-      op->SetType(kFetchOpType);
-      op->SetInput("X", {var_name});
-      op->SetOutput("Out", {fetch_holder_name});
-      op->SetAttr("col", {static_cast<int>(i)});
-      op->CheckAttrs();
+std::string Executor::PrepareCacheKey(
+    const ProgramDesc& program, int block_id,
+    const std::vector<std::string>& skip_ref_cnt_vars, bool force_disable_gc) {
+  // The garbage collection plan also depends on whether eager deletion is
+  // enabled when preparing. The revision is changed by any modification of
+  // the program, and is never reused by another program at the same address.
+  std::ostringstream key;
+  key << &program << ' ' << program.Revision() << ' ' << block_id << ' '
+      << force_disable_gc << ' ' << (GetEagerDeletionThreshold() >= 0) << ' '
+      << skip_ref_cnt_vars.size();
+  for (auto& var : skip_ref_cnt_vars) {
+    key << ' ' << var.size() << ':' << var;
+  }
+  return key.str();
+}
 
-      i++;
+Executor::PrepareCacheEntry Executor::AcquirePreparedContext(
+    const std::string& key, int block_id,
+    const std::vector<std::string>& skip_ref_cnt_vars, bool force_disable_gc,
+    const std::function<std::unique_ptr<ProgramDesc>()>& copy_program) {
+  PrepareCacheEntry entry;
+  entry.key = key;
+  {
+    std::lock_guard<std::mutex> guard(prepare_cache_mutex_);
+    for (auto iter = prepare_cache_.begin(); iter != prepare_cache_.end();
+         ++iter) {
+      if (iter->key == entry.key) {
+        entry = std::move(*iter);
+        prepare_cache_.erase(iter);
+        return entry;
+      }
     }
   }
 
-  auto ctx = Prepare(*copy_program, 0);
-  RunPreparedContext(ctx.get(), scope, feed_targets, fetch_targets,
-                     create_local_scope, create_vars, feed_holder_name,
-                     fetch_holder_name);
+  VLOG(3) << "Prepare block " << block_id << " and cache the context";
+  entry.program = copy_program();
+  entry.ctx =
+      Prepare(*entry.program, block_id, skip_ref_cnt_vars, force_disable_gc);
+  return entry;
+}
+
+void Executor::ReleasePreparedContext(PrepareCacheEntry&& entry) {
+  std::lock_guard<std::mutex> guard(prepare_cache_mutex_);
+  prepare_cache_.emplace_front(std::move(entry));
+  while (prepare_cache_.size() >
+         static_cast<size_t>(
+             std::max(FLAGS_executor_prepare_cache_capacity, 0))) {
+    prepare_cache_.pop_back();
+  }
 }
 
 std::unique_ptr<ExecutorPrepareContext> Executor::Prepare(
@@ -435,6 +617,7 @@ void Executor::RunPartialPreparedContext(ExecutorPrepareContext* ctx,
                                          bool create_local_scope,
                                          bool create_vars, bool keep_kids) {
   platform::RecordBlock b(kProgramId);
+  platform::RecordStep step;
   PADDLE_ENFORCE_NOT_NULL(
       scope, platform::errors::InvalidArgument("Scope shouldn't be null"));
   Scope* local_scope = scope;
@@ -459,18 +642,25 @@ void Executor::RunPartialPreparedContext(ExecutorPrepareContext* ctx,
       }
     } else if (platform::is_cpu_place(place_)) {
 #endif
-      gc.reset(new CPUGarbageCollector(
-          BOOST_GET_CONST(platform::CPUPlace, place_), max_memory_size));
+      gc = CreateCPUGarbageCollector(
+          BOOST_GET_CONST(platform::CPUPlace, place_), max_memory_size);
 #ifdef PADDLE_WITH_CUDA
     }
 #endif
   }
 
-  for (int64_t i = start_op_index; i < end_op_index; ++i) {
-    auto& op = ctx->ops_[i];
-    op->Run(*local_scope, place_);
-    if (gc) {
-      DeleteUnusedTensors(*local_scope, op.get(), ctx->unused_vars_, gc.get());
+  if (FLAGS_executor_num_threads > 1 && platform::is_cpu_place(place_) &&
+      start_op_index == 0 &&
+      end_op_index == static_cast<int64_t>(ctx->ops_.size())) {
+    RunOpsInParallel(ctx, local_scope, gc.get());
+  } else {
+    for (int64_t i = start_op_index; i < end_op_index; ++i) {
+      auto& op = ctx->ops_[i];
+      op->Run(*local_scope, place_);
+      if (gc) {
+        DeleteUnusedTensors(*local_scope, op.get(), ctx->unused_vars_,
+                            gc.get());
+      }
     }
   }
 
@@ -492,6 +682,91 @@ void Executor::RunPartialPreparedContext(ExecutorPrepareContext* ctx,
   }
 }
 
+void Executor::RunOpsInParallel(ExecutorPrepareContext* ctx, Scope* scope,
+                                GarbageCollector* gc) {
+  std::call_once(ctx->op_dependencies_once_,
+                 [ctx] { ctx->PrepareOpDependencies(); });
+  std::call_once(op_thread_pool_once_, [this] {
+    op_thread_pool_.reset(new ThreadPool(FLAGS_executor_num_threads));
+  });
+
+  auto run_op = [&](size_t i) {
+    auto* op = ctx->ops_[i].get();
+    op->Run(*scope, place_);
+    if (gc) {
+      DeleteUnusedTensors(*scope, op, ctx->unused_vars_, gc);
+    }
+  };
+
+  // The ready ops and the pending numbers are only accessed by the current
+  // thread, while the ops finished in op_thread_pool_ are sent back through
+  // finished_ops.
+  std::vector<size_t> num_pending_ops = ctx->num_upstream_ops_;
+  std::vector<size_t> ready_ops;
+  for (size_t i = 0; i < num_pending_ops.size(); ++i) {
+    if (num_pending_ops[i] == 0) ready_ops.push_back(i);
+  }
+  auto finish_op = [&](size_t i) {
+    for (auto j : ctx->downstream_ops_[i]) {
+      if (--num_pending_ops[j] == 0) ready_ops.push_back(j);
+    }
+  };
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::vector<size_t> finished_ops;
+  std::exception_ptr exception;
+  size_t num_running_ops = 0;
+  bool stopped = false;
+
+  while (!ready_ops.empty() || num_running_ops > 0) {
+    // Run the op in the current thread if there is no parallelism.
+    if (ready_ops.size() == 1 && num_running_ops == 0) {
+      size_t i = ready_ops.back();
+      ready_ops.pop_back();
+      run_op(i);
+      finish_op(i);
+      continue;
+    }
+
+    for (auto i : ready_ops) {
+      ++num_running_ops;
+      op_thread_pool_->Run([&, i] {
+        std::exception_ptr op_exception;
+        try {
+          run_op(i);
+        } catch (...) {
+          op_exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> guard(mtx);
+        if (op_exception != nullptr && exception == nullptr) {
+          exception = op_exception;
+        }
+        finished_ops.push_back(i);
+        cv.notify_one();
+      });
+    }
+    ready_ops.clear();
+
+    std::vector<size_t> cur_finished_ops;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [&] { return !finished_ops.empty(); });
+      cur_finished_ops.swap(finished_ops);
+      // Wait for the running ops but do not run any new op after an op fails.
+      stopped = (exception != nullptr);
+    }
+    num_running_ops -= cur_finished_ops.size();
+    if (!stopped) {
+      for (auto i : cur_finished_ops) finish_op(i);
+    }
+  }
+
+  if (exception != nullptr) {
+    std::rethrow_exception(exception);
+  }
+}
+
 void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
                                   bool create_local_scope, bool create_vars,
                                   bool keep_kids) {
@@ -547,7 +822,10 @@ void Executor::EnableMKLDNN(const ProgramDesc& program) {
   for (size_t bid = 0; bid < program.Size(); ++bid) {
     auto* block = const_cast<ProgramDesc&>(program).MutableBlock(bid);
     for (auto* op : block->AllOps()) {
-      if (op->HasAttr("use_mkldnn")) {
+      // only set once, so the revision of the program is not changed by
+      // every run
+      if (op->HasAttr("use_mkldnn") &&
+          !op->GetAttrIfExists<bool>("use_mkldnn")) {
         op->SetAttr("use_mkldnn", true);
       }
     }
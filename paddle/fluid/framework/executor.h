@@ -14,8 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <functional>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -26,6 +29,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/framework/trainer.h"
 #include "paddle/fluid/platform/device_context.h"
 
@@ -40,6 +44,10 @@ struct ExecutorPrepareContext {
   void PrepareUnusedVars(const std::vector<std::string>& keep_vars,
                          bool force_disable_gc = false);
 
+  // Build the dependencies between ops_, which is used to run the
+  // independent ops in parallel. It must be called after PrepareUnusedVars.
+  void PrepareOpDependencies();
+
   const framework::ProgramDesc& prog_;
   const size_t block_id_;
 
@@ -48,6 +56,12 @@ struct ExecutorPrepareContext {
   std::unordered_map<const OperatorBase*, std::vector<std::string>>
       unused_vars_;
   bool force_disable_gc_{false};
+
+  // downstream_ops_[i] are the ops which can only run after ops_[i], and
+  // num_upstream_ops_[i] is the number of ops which ops_[i] depends on.
+  std::vector<std::vector<size_t>> downstream_ops_;
+  std::vector<size_t> num_upstream_ops_;
+  std::once_flag op_dependencies_once_;
 };
 
 class Executor {
@@ -137,7 +151,46 @@ class Executor {
   const platform::Place GetPlace() const { return place_; }
 
  private:
+  // The context prepared for a block of a copy of the program. The key is
+  // made of the identity of the program and the arguments of Prepare.
+  struct PrepareCacheEntry {
+    std::string key;
+    std::unique_ptr<ProgramDesc> program;
+    std::unique_ptr<ExecutorPrepareContext> ctx;
+  };
+
+  // The key of the program and the arguments of Prepare, which is made of the
+  // address and the revision of the program rather than its contents.
+  static std::string PrepareCacheKey(
+      const ProgramDesc& program, int block_id,
+      const std::vector<std::string>& skip_ref_cnt_vars,
+      bool force_disable_gc);
+
+  // Take the context prepared with key out of prepare_cache_, or prepare a
+  // new one for the program made by copy_program if there is no such context.
+  PrepareCacheEntry AcquirePreparedContext(
+      const std::string& key, int block_id,
+      const std::vector<std::string>& skip_ref_cnt_vars, bool force_disable_gc,
+      const std::function<std::unique_ptr<ProgramDesc>()>& copy_program);
+
+  // Put the context back to prepare_cache_ after it finishes running, and
+  // evict the least recently used ones.
+  void ReleasePreparedContext(PrepareCacheEntry&& entry);
+
+  // Run all the ops of ctx in the order of their dependencies, where the
+  // independent ops are run in parallel in op_thread_pool_.
+  void RunOpsInParallel(ExecutorPrepareContext* ctx, Scope* scope,
+                        GarbageCollector* gc);
+
   const platform::Place place_;
+
+  std::unique_ptr<ThreadPool> op_thread_pool_;
+  std::once_flag op_thread_pool_once_;
+
+  // The most recently used entry is at the front. A context is taken out
+  // while it is running, so that it is never run by two threads at once.
+  std::list<PrepareCacheEntry> prepare_cache_;
+  std::mutex prepare_cache_mutex_;
 };
 
 }  // namespace framework
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/feed_fetch_method.h"
+#include <gflags/gflags.h>
 #include <string>
 #include <vector>
 #include "glog/logging.h"
@@ -20,6 +21,12 @@ limitations under the License. */
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/platform/place.h"
 
+DEFINE_bool(borrow_numpy_feed, false,
+            "Feed the C-contiguous numpy arrays on CPUPlace to Executor.run "
+            "without copying them. The arrays are referenced until they are "
+            "fed again, they must not be modified meanwhile, and they are "
+            "copied before any op writes them in place.");
+
 namespace paddle {
 namespace framework {
 
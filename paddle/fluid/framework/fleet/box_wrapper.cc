@@ -15,10 +15,12 @@
 #ifdef PADDLE_WITH_BOX_PS
 #include "paddle/fluid/framework/fleet/box_wrapper.h"
 #include <algorithm>
+#include <cstring>
 #include <ctime>
 #include <memory>
 #include <numeric>
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/cuda_device_guard.h"
 #include "paddle/fluid/platform/gpu_info.h"
 
 namespace paddle {
@@ -31,7 +33,80 @@ AfsManager* BoxWrapper::afs_manager = nullptr;
 int BoxWrapper::embedx_dim_ = 8;
 int BoxWrapper::expand_embed_dim_ = 0;
 
+void BasicAucCalculator::add_data(const float* pred, const int64_t* label,
+                                  const int64_t* mask, size_t num) {
+  // The bucket of the i-th prediction is buckets[i] / 2 in the table of
+  // the label buckets[i] % 2.
+  std::vector<int> buckets;
+  buckets.reserve(num);
+  double abserr = 0, sqrerr = 0, pred_sum = 0;
+  for (size_t i = 0; i < num; ++i) {
+    if (mask != nullptr && mask[i] != 1) continue;
+    buckets.emplace_back(bucket(pred[i], label[i]) * 2 +
+                         static_cast<int>(label[i]));
+    abserr += fabs(pred[i] - label[i]);
+    sqrerr += (pred[i] - label[i]) * (pred[i] - label[i]);
+    pred_sum += pred[i];
+  }
+  std::lock_guard<std::mutex> lock(_table_mutex);
+  _local_abserr += abserr;
+  _local_sqrerr += sqrerr;
+  _local_pred += pred_sum;
+  for (int b : buckets) {
+    _table[b % 2][b / 2]++;
+  }
+}
+
+void BasicAucCalculator::merge_device_tables() {
+  std::lock_guard<std::mutex> device_lock(_device_mutex);
+  std::vector<uint64_t> host_table;
+  for (size_t dev = 0; dev < _device_tables.size(); ++dev) {
+    if (_device_tables[dev] == nullptr) continue;
+    host_table.resize(device_table_size());
+    size_t bytes = host_table.size() * sizeof(uint64_t);
+    platform::CUDADeviceGuard guard(static_cast<int>(dev));
+    // The kernels are on the streams of the workers.
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaDeviceSynchronize());
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemcpy(host_table.data(),
+                                           _device_tables[dev]->ptr(), bytes,
+                                           cudaMemcpyDeviceToHost));
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaMemset(_device_tables[dev]->ptr(), 0, bytes));
+
+    const uint64_t* sums = host_table.data() + 2 * _table_size;
+    PADDLE_ENFORCE_EQ(sums[3], 0,
+                      platform::errors::PreconditionNotMet(
+                          "%d predictions on GPU %d are not in [0, 1] or "
+                          "their labels are not 0 or 1.",
+                          sums[3], dev));
+    double err[3];
+    std::memcpy(err, sums, sizeof(err));
+    std::lock_guard<std::mutex> lock(_table_mutex);
+    for (int i = 0; i < 2; ++i) {
+      for (int j = 0; j < _table_size; ++j) {
+        _table[i][j] += host_table[i * _table_size + j];
+      }
+    }
+    _local_abserr += err[0];
+    _local_sqrerr += err[1];
+    _local_pred += err[2];
+  }
+}
+
+void BasicAucCalculator::reset_device_tables() {
+  std::lock_guard<std::mutex> device_lock(_device_mutex);
+  for (size_t dev = 0; dev < _device_tables.size(); ++dev) {
+    if (_device_tables[dev] == nullptr) continue;
+    platform::CUDADeviceGuard guard(static_cast<int>(dev));
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaDeviceSynchronize());
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaMemset(_device_tables[dev]->ptr(), 0,
+                   device_table_size() * sizeof(uint64_t)));
+  }
+}
+
 void BasicAucCalculator::compute() {
+  merge_device_tables();
   double* table[2] = {&_table[0][0], &_table[1][0]};
 
   double area = 0;
@@ -59,6 +134,23 @@ void BasicAucCalculator::compute() {
   _size = fp + tp;
 }
 
+void BoxWrapper::SlotTable::Reset(const platform::CUDAPlace& place,
+                                  size_t bytes) {
+  size_ = 0;
+  if (bytes <= capacity_) return;
+  // Grow by half at least, as the batches vary in the number of keys.
+  capacity_ = std::max(bytes, capacity_ + capacity_ / 2);
+  host_buf_ = memory::Alloc(platform::CUDAPinnedPlace(), capacity_);
+  dev_buf_ = memory::Alloc(place, capacity_);
+}
+
+void BoxWrapper::SlotTable::CopyToDevice(cudaStream_t stream) {
+  if (size_ == 0) return;
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemcpyAsync(dev_buf_->ptr(),
+                                              host_buf_->ptr(), size_,
+                                              cudaMemcpyHostToDevice, stream));
+}
+
 void BoxWrapper::CheckEmbedSizeIsValid(int embedx_dim, int expand_embed_dim) {
   PADDLE_ENFORCE_EQ(
       embedx_dim_, embedx_dim,
@@ -148,6 +240,7 @@ void BoxWrapper::PushSparseGrad(const paddle::platform::Place& place,
 }
 
 void BasicAucCalculator::calculate_bucket_error() {
+  merge_device_tables();
   double last_ctr = -1;
   double impression_sum = 0;
   double ctr_sum = 0.0;
@@ -17,8 +17,10 @@
 #include <ctime>
 #include <memory>
 #include <numeric>
+#include "cub/cub.cuh"
 #include "paddle/fluid/framework/fleet/box_wrapper.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
 #include "paddle/fluid/platform/gpu_info.h"
 
 namespace paddle {
@@ -101,8 +103,8 @@ __global__ void CopyKeysKernel(uint64_t** src_keys, uint64_t* dest_total_keys,
 template <size_t EMBEDX_DIM, size_t EXPAND_EMBED_DIM>
 __global__ void PushCopy(
     boxps::FeaturePushValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>* dest, float** src,
-    int64_t* len, int hidden, int expand_dim, int slot_num, int total_len,
-    int bs, int* slot_vector) {
+    const int64_t* len, int hidden, int expand_dim, int slot_num,
+    int total_len, int bs, const int* slot_vector) {
   CUDA_KERNEL_LOOP(i, total_len) {
     int low = 0;
     int high = slot_num - 1;
@@ -132,9 +134,76 @@ __global__ void PushCopy(
   }
 }
 
+// The counts of the buckets are added by atomics, and the errors are reduced
+// in the blocks first, so that one atomic per block adds each of them.
+template <int BlockDim>
+__global__ void AucHistogramKernel(const float* pred, const int64_t* label,
+                                   const int64_t* mask, int num,
+                                   int table_size,
+                                   unsigned long long* table) {  // NOLINT
+  typedef cub::BlockReduce<double, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage storage;
+  double abserr = 0, sqrerr = 0, pred_sum = 0;
+  CUDA_KERNEL_LOOP(i, num) {
+    if (mask != nullptr && mask[i] != 1) continue;
+    double p = pred[i];
+    int64_t l = label[i];
+    if (!(p >= 0 && p <= 1) || (l != 0 && l != 1)) {
+      atomicAdd(table + 2 * table_size + 3, 1ULL);
+      continue;
+    }
+    int pos = min(static_cast<int>(p * table_size), table_size - 1);
+    atomicAdd(table + l * table_size + pos, 1ULL);
+    abserr += fabs(p - l);
+    sqrerr += (p - l) * (p - l);
+    pred_sum += p;
+  }
+  double* sums = reinterpret_cast<double*>(table + 2 * table_size);
+  abserr = BlockReduce(storage).Sum(abserr);
+  __syncthreads();
+  sqrerr = BlockReduce(storage).Sum(sqrerr);
+  __syncthreads();
+  pred_sum = BlockReduce(storage).Sum(pred_sum);
+  if (threadIdx.x == 0) {
+    platform::CudaAtomicAdd(sums, abserr);
+    platform::CudaAtomicAdd(sums + 1, sqrerr);
+    platform::CudaAtomicAdd(sums + 2, pred_sum);
+  }
+}
+
+void BasicAucCalculator::add_data_gpu(const platform::CUDAPlace& place,
+                                      cudaStream_t stream, const float* pred,
+                                      const int64_t* label,
+                                      const int64_t* mask, int num) {
+  if (num == 0) return;
+  void* table = nullptr;
+  {
+    std::lock_guard<std::mutex> device_lock(_device_mutex);
+    size_t dev = static_cast<size_t>(place.GetDeviceId());
+    if (_device_tables.size() <= dev) _device_tables.resize(dev + 1);
+    if (_device_tables[dev] == nullptr) {
+      size_t bytes = device_table_size() * sizeof(uint64_t);
+      _device_tables[dev] = memory::Alloc(place, bytes);
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaMemsetAsync(_device_tables[dev]->ptr(), 0, bytes, stream));
+      // The other workers on the GPU add to it on their streams.
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+    }
+    table = _device_tables[dev]->ptr();
+  }
+  constexpr int kBlockDim = 512;
+  int grid = std::min((num + kBlockDim - 1) / kBlockDim,
+                      platform::GetCUDAMultiProcessors(place.GetDeviceId()) *
+                          (platform::GetCUDAMaxThreadsPerMultiProcessor(
+                               place.GetDeviceId()) /
+                           kBlockDim));
+  AucHistogramKernel<kBlockDim><<<grid, kBlockDim, 0, stream>>>(
+      pred, label, mask, num, _table_size,
+      reinterpret_cast<unsigned long long*>(table));  // NOLINT
+}
+
 void BoxWrapper::CopyForPull(const paddle::platform::Place& place,
-                             uint64_t** gpu_keys,
-                             const std::vector<float*>& values,
+                             uint64_t** gpu_keys, float** gpu_values,
                              void* total_values_gpu, const int64_t* gpu_len,
                              const int slot_num, const int hidden_size,
                              const int expand_embed_dim,
@@ -143,10 +212,6 @@ void BoxWrapper::CopyForPull(const paddle::platform::Place& place,
                     platform::DeviceContextPool::Instance().Get(
                         BOOST_GET_CONST(platform::CUDAPlace, place)))
                     ->stream();
-  auto buf_value = memory::AllocShared(place, values.size() * sizeof(float*));
-  float** gpu_values = reinterpret_cast<float**>(buf_value->ptr());
-  cudaMemcpy(gpu_values, values.data(), values.size() * sizeof(float*),
-             cudaMemcpyHostToDevice);
 #define EMBEDX_CASE(i, ...)                                                  \
   case i: {                                                                  \
     constexpr size_t EmbedxDim = i;                                          \
@@ -196,36 +261,15 @@ void BoxWrapper::CopyKeys(const paddle::platform::Place& place,
 }
 
 void BoxWrapper::CopyForPush(const paddle::platform::Place& place,
-                             const std::vector<const float*>& grad_values,
-                             void* total_grad_values_gpu,
-                             const std::vector<int64_t>& slot_lengths,
-                             const int hidden_size, const int expand_embed_dim,
+                             float** gpu_values, void* total_grad_values_gpu,
+                             const int64_t* gpu_len, const int* gpu_slot_vector,
+                             const int slot_num, const int hidden_size,
+                             const int expand_embed_dim,
                              const int64_t total_length, const int batch_size) {
   auto stream = dynamic_cast<platform::CUDADeviceContext*>(
                     platform::DeviceContextPool::Instance().Get(
                         BOOST_GET_CONST(platform::CUDAPlace, place)))
                     ->stream();
-  auto slot_lengths_lod = slot_lengths;
-  for (int i = 1; i < slot_lengths_lod.size(); i++) {
-    slot_lengths_lod[i] += slot_lengths_lod[i - 1];
-  }
-  auto buf_grad_value =
-      memory::AllocShared(place, grad_values.size() * sizeof(float*));
-  auto buf_length =
-      memory::AllocShared(place, slot_lengths.size() * sizeof(int64_t));
-  auto buf_slot_vector =
-      memory::AllocShared(place, slot_lengths_lod.size() * sizeof(int));
-
-  float** gpu_values = reinterpret_cast<float**>(buf_grad_value->ptr());
-  int64_t* gpu_len = reinterpret_cast<int64_t*>(buf_length->ptr());
-  int* d_slot_vector = reinterpret_cast<int*>(buf_slot_vector->ptr());
-
-  cudaMemcpy(gpu_values, grad_values.data(),
-             grad_values.size() * sizeof(float*), cudaMemcpyHostToDevice);
-  cudaMemcpy(gpu_len, slot_lengths_lod.data(),
-             slot_lengths.size() * sizeof(int64_t), cudaMemcpyHostToDevice);
-  cudaMemcpy(d_slot_vector, slot_vector_.data(),
-             slot_lengths_lod.size() * sizeof(int), cudaMemcpyHostToDevice);
 
 #define EMBEDX_CASE(i, ...)                                                  \
   case i: {                                                                  \
@@ -245,8 +289,8 @@ void BoxWrapper::CopyForPush(const paddle::platform::Place& place,
              ExpandDim><<<(total_length + 512 - 1) / 512, 512, 0, stream>>>( \
         reinterpret_cast<boxps::FeaturePushValueGpu<EmbedxDim, ExpandDim>*>( \
             total_grad_values_gpu),                                          \
-        gpu_values, gpu_len, hidden_size, expand_embed_dim,                  \
-        slot_lengths.size(), total_length, batch_size, d_slot_vector);       \
+        gpu_values, gpu_len, hidden_size, expand_embed_dim, slot_num,        \
+        total_length, batch_size, gpu_slot_vector);                          \
   } break
 
   switch (hidden_size - 3) {
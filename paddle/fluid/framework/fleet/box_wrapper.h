@@ -26,6 +26,7 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <ctime>
 #include <deque>
 #include <map>
@@ -40,6 +41,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_set.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/timer.h"
@@ -57,6 +59,8 @@ class BasicAucCalculator {
   BasicAucCalculator() {}
   void init(int table_size) { set_table_size(table_size); }
   void reset() {
+    reset_device_tables();
+    std::lock_guard<std::mutex> lock(_table_mutex);
     for (int i = 0; i < 2; i++) {
       _table[i].assign(_table_size, 0.0);
     }
@@ -65,29 +69,24 @@ class BasicAucCalculator {
     _local_pred = 0;
   }
   void add_data(double pred, int label) {
-    PADDLE_ENFORCE_GE(pred, 0.0, platform::errors::PreconditionNotMet(
-                                     "pred should be greater than 0"));
-    PADDLE_ENFORCE_LE(pred, 1.0, platform::errors::PreconditionNotMet(
-                                     "pred should be lower than 1"));
-    PADDLE_ENFORCE_EQ(
-        label * label, label,
-        platform::errors::PreconditionNotMet(
-            "label must be equal to 0 or 1, but its value is: %d", label));
-    int pos = std::min(static_cast<int>(pred * _table_size), _table_size - 1);
-    PADDLE_ENFORCE_GE(
-        pos, 0,
-        platform::errors::PreconditionNotMet(
-            "pos must be equal or greater than 0, but its value is: %d", pos));
-    PADDLE_ENFORCE_LT(
-        pos, _table_size,
-        platform::errors::PreconditionNotMet(
-            "pos must be less than table_size, but its value is: %d", pos));
+    int pos = bucket(pred, label);
     std::lock_guard<std::mutex> lock(_table_mutex);
     _local_abserr += fabs(pred - label);
     _local_sqrerr += (pred - label) * (pred - label);
     _local_pred += pred;
     _table[label][pos]++;
   }
+  // Add the predictions whose mask is 1, or all of them if mask is null.
+  // The buckets and the errors of the batch are found before taking the
+  // lock, which is taken once, so the worker threads hardly wait for it.
+  void add_data(const float* pred, const int64_t* label, const int64_t* mask,
+                size_t num);
+  // Add the predictions on the GPU of place by a histogram kernel on stream,
+  // without copying them to the host. The tables on the GPUs are merged by
+  // compute() and calculate_bucket_error().
+  void add_data_gpu(const platform::CUDAPlace& place, cudaStream_t stream,
+                    const float* pred, const int64_t* label,
+                    const int64_t* mask, int num);
   void compute();
   int table_size() const { return _table_size; }
   double bucket_error() const { return _bucket_error; }
@@ -117,6 +116,32 @@ class BasicAucCalculator {
   double _bucket_error = 0;
 
  private:
+  int bucket(double pred, int64_t label) const {
+    PADDLE_ENFORCE_GE(pred, 0.0, platform::errors::PreconditionNotMet(
+                                     "pred should be greater than 0"));
+    PADDLE_ENFORCE_LE(pred, 1.0, platform::errors::PreconditionNotMet(
+                                     "pred should be lower than 1"));
+    PADDLE_ENFORCE_EQ(
+        label * label, label,
+        platform::errors::PreconditionNotMet(
+            "label must be equal to 0 or 1, but its value is: %d", label));
+    int pos = std::min(static_cast<int>(pred * _table_size), _table_size - 1);
+    PADDLE_ENFORCE_GE(
+        pos, 0,
+        platform::errors::PreconditionNotMet(
+            "pos must be equal or greater than 0, but its value is: %d", pos));
+    PADDLE_ENFORCE_LT(
+        pos, _table_size,
+        platform::errors::PreconditionNotMet(
+            "pos must be less than table_size, but its value is: %d", pos));
+    return pos;
+  }
+  // The table of a GPU holds the counts of the negative and the positive
+  // buckets, then the sums of abserr, sqrerr and pred, and the number of the
+  // invalid predictions or labels.
+  size_t device_table_size() const { return 2 * _table_size + 4; }
+  void merge_device_tables();
+  void reset_device_tables();
   void set_table_size(int table_size) {
     _table_size = table_size;
     for (int i = 0; i < 2; i++) {
@@ -129,6 +154,8 @@ class BasicAucCalculator {
   static constexpr double kRelativeErrorBound = 0.05;
   static constexpr double kMaxSpan = 0.01;
   std::mutex _table_mutex;
+  std::mutex _device_mutex;
+  std::vector<memory::AllocationPtr> _device_tables;
 };
 
 class AfsStreamFile {
@@ -370,16 +397,67 @@ class BoxWrapper {
                       const int hidden_size, const int expand_embed_dim,
                       const int batch_size);
 
+  // The pointers of the keys and the values of the slots of a batch, the
+  // offsets of the slots and the slot ids, packed in a pinned buffer and
+  // copied to the device with one H2D, instead of one allocation and one
+  // copy per array. Every device reuses its tables, which grow when needed,
+  // so a table must be copied again only after the kernels reading it end.
+  class SlotTable {
+   public:
+    static constexpr size_t kAlignment = 8;
+
+    static size_t AlignedSize(size_t num, size_t size) {
+      return (num * size + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    // Make room for bytes, dropping the arrays appended before.
+    void Reset(const platform::CUDAPlace& place, size_t bytes);
+
+    // Return the offset of the copy of the array in the table.
+    template <typename T>
+    size_t Append(const T* data, size_t num) {
+      size_t bytes = AlignedSize(num, sizeof(T));
+      PADDLE_ENFORCE_LE(size_ + bytes, capacity_,
+                        platform::errors::OutOfRange(
+                            "The slot table holds %d bytes, but %d bytes "
+                            "are appended.",
+                            capacity_, size_ + bytes));
+      size_t offset = size_;
+      if (num > 0) {
+        std::memcpy(static_cast<char*>(host_buf_->ptr()) + offset, data,
+                    num * sizeof(T));
+      }
+      size_ += bytes;
+      return offset;
+    }
+
+    void CopyToDevice(cudaStream_t stream);
+
+    // The array at offset on the device, valid after CopyToDevice.
+    template <typename T>
+    T* Get(size_t offset) const {
+      return reinterpret_cast<T*>(static_cast<char*>(dev_buf_->ptr()) +
+                                  offset);
+    }
+
+   private:
+    memory::AllocationPtr host_buf_;
+    memory::AllocationPtr dev_buf_;
+    size_t capacity_{0};
+    size_t size_{0};
+  };
+
+  // gpu_values are the outputs of the slots, followed by the expanded
+  // embeddings if expand_embed_dim > 0.
   void CopyForPull(const paddle::platform::Place& place, uint64_t** gpu_keys,
-                   const std::vector<float*>& values, void* total_values_gpu,
+                   float** gpu_values, void* total_values_gpu,
                    const int64_t* gpu_len, const int slot_num,
                    const int hidden_size, const int expand_embed_dim,
                    const int64_t total_length);
 
-  void CopyForPush(const paddle::platform::Place& place,
-                   const std::vector<const float*>& grad_values,
-                   void* total_grad_values_gpu,
-                   const std::vector<int64_t>& slot_lengths,
+  void CopyForPush(const paddle::platform::Place& place, float** gpu_values,
+                   void* total_grad_values_gpu, const int64_t* gpu_len,
+                   const int* gpu_slot_vector, const int slot_num,
                    const int hidden_size, const int expand_embed_dim,
                    const int64_t total_length, const int batch_size);
 
@@ -417,6 +495,8 @@ class BoxWrapper {
       }
       slot_vector_ = slot_vector;
       keys_tensor.resize(platform::GetCUDADeviceCount());
+      pull_tables_.resize(platform::GetCUDADeviceCount());
+      push_tables_.resize(platform::GetCUDADeviceCount());
     }
   }
 
@@ -521,15 +601,54 @@ class BoxWrapper {
     int MetricPhase() const { return metric_phase_; }
     BasicAucCalculator* GetCalculator() { return calculator; }
     virtual void add_data(const Scope* exe_scope) {
+      if (add_data_on_gpu(exe_scope, "")) return;
       std::vector<int64_t> label_data;
       get_data<int64_t>(exe_scope, label_varname_, &label_data);
       std::vector<float> pred_data;
       get_data<float>(exe_scope, pred_varname_, &pred_data);
-      auto cal = GetCalculator();
-      auto batch_size = label_data.size();
-      for (size_t i = 0; i < batch_size; ++i) {
-        cal->add_data(pred_data[i], label_data[i]);
+      GetCalculator()->add_data(pred_data.data(), label_data.data(), nullptr,
+                                label_data.size());
+    }
+    static const LoDTensor& get_tensor(const Scope* exe_scope,
+                                       const std::string& varname) {
+      auto* var = exe_scope->FindVar(varname.c_str());
+      PADDLE_ENFORCE_NOT_NULL(
+          var, platform::errors::NotFound(
+                   "Error: var %s is not found in scope.", varname.c_str()));
+      return var->Get<LoDTensor>();
+    }
+    // Add the batch by the histogram kernel if the labels, the predictions
+    // and the mask are on the same GPU, which saves copying them to the host.
+    bool add_data_on_gpu(const Scope* exe_scope,
+                         const std::string& mask_varname) {
+      auto& label = get_tensor(exe_scope, label_varname_);
+      auto& pred = get_tensor(exe_scope, pred_varname_);
+      if (!platform::is_gpu_place(label.place()) ||
+          !(pred.place() == label.place())) {
+        return false;
       }
+      const int64_t* mask_data = nullptr;
+      if (!mask_varname.empty()) {
+        auto& mask = get_tensor(exe_scope, mask_varname);
+        if (!(mask.place() == label.place())) return false;
+        PADDLE_ENFORCE_GE(mask.numel(), label.numel(),
+                          platform::errors::PreconditionNotMet(
+                              "illegal batch size: mask[%d] and label[%d]",
+                              mask.numel(), label.numel()));
+        mask_data = mask.data<int64_t>();
+      }
+      PADDLE_ENFORCE_GE(pred.numel(), label.numel(),
+                        platform::errors::PreconditionNotMet(
+                            "illegal batch size: pred[%d] and label[%d]",
+                            pred.numel(), label.numel()));
+      auto place = BOOST_GET_CONST(platform::CUDAPlace, label.place());
+      auto stream = dynamic_cast<platform::CUDADeviceContext*>(
+                        platform::DeviceContextPool::Instance().Get(place))
+                        ->stream();
+      GetCalculator()->add_data_gpu(place, stream, pred.data<float>(),
+                                    label.data<int64_t>(), mask_data,
+                                    static_cast<int>(label.numel()));
+      return true;
     }
     template <class T = float>
     static void get_data(const Scope* exe_scope, const std::string& varname,
@@ -613,17 +732,20 @@ class BoxWrapper {
                 "illegal batch size: batch_size[%lu] and pred_data[%lu]",
                 batch_size, pred_data_list[i].size()));
       }
-      auto cal = GetCalculator();
+      std::vector<float> preds;
+      std::vector<int64_t> labels;
       for (size_t i = 0; i < batch_size; ++i) {
         auto cmatch_rank_it =
             std::find(cmatch_rank_v.begin(), cmatch_rank_v.end(),
                       parse_cmatch_rank(cmatch_rank_data[i]));
         if (cmatch_rank_it != cmatch_rank_v.end()) {
-          cal->add_data(pred_data_list[std::distance(cmatch_rank_v.begin(),
-                                                     cmatch_rank_it)][i],
-                        label_data[i]);
+          preds.emplace_back(pred_data_list[std::distance(
+              cmatch_rank_v.begin(), cmatch_rank_it)][i]);
+          labels.emplace_back(label_data[i]);
         }
       }
+      GetCalculator()->add_data(preds.data(), labels.data(), nullptr,
+                                labels.size());
     }
 
    protected:
@@ -674,16 +796,19 @@ class BoxWrapper {
           platform::errors::PreconditionNotMet(
               "illegal batch size: cmatch_rank[%lu] and pred_data[%lu]",
               batch_size, pred_data.size()));
-      auto cal = GetCalculator();
+      // The mask of the predictions whose cmatch_rank is wanted.
+      std::vector<int64_t> mask_data(batch_size, 0);
       for (size_t i = 0; i < batch_size; ++i) {
         const auto& cur_cmatch_rank = parse_cmatch_rank(cmatch_rank_data[i]);
         for (size_t j = 0; j < cmatch_rank_v.size(); ++j) {
           if (cmatch_rank_v[j] == cur_cmatch_rank) {
-            cal->add_data(pred_data[i], label_data[i]);
+            mask_data[i] = 1;
             break;
           }
         }
       }
+      GetCalculator()->add_data(pred_data.data(), label_data.data(),
+                                mask_data.data(), batch_size);
     }
 
    protected:
@@ -704,19 +829,15 @@ class BoxWrapper {
     }
     virtual ~MaskMetricMsg() {}
     void add_data(const Scope* exe_scope) override {
+      if (add_data_on_gpu(exe_scope, mask_varname_)) return;
       std::vector<int64_t> label_data;
       get_data<int64_t>(exe_scope, label_varname_, &label_data);
       std::vector<float> pred_data;
       get_data<float>(exe_scope, pred_varname_, &pred_data);
       std::vector<int64_t> mask_data;
       get_data<int64_t>(exe_scope, mask_varname_, &mask_data);
-      auto cal = GetCalculator();
-      auto batch_size = label_data.size();
-      for (size_t i = 0; i < batch_size; ++i) {
-        if (mask_data[i] == 1) {
-          cal->add_data(pred_data[i], label_data[i]);
-        }
-      }
+      GetCalculator()->add_data(pred_data.data(), label_data.data(),
+                                mask_data.data(), label_data.size());
     }
 
    protected:
@@ -825,6 +946,8 @@ class BoxWrapper {
   std::vector<std::string> metric_name_list_;
   std::vector<int> slot_vector_;
   std::vector<LoDTensor> keys_tensor;  // Cache for pull_sparse
+  std::vector<SlotTable> pull_tables_;
+  std::vector<SlotTable> push_tables_;
   bool use_afs_api_ = false;
 
  public:
@@ -55,15 +55,20 @@ void BoxWrapper::PullSparseCase(const paddle::platform::Place& place,
     for (size_t i = 1; i < slot_lengths_lod.size(); i++) {
       slot_lengths_lod[i] += slot_lengths_lod[i - 1];
     }
-    auto buf_key = memory::AllocShared(place, keys.size() * sizeof(uint64_t*));
-    auto buf_length =
-        memory::AllocShared(place, slot_lengths.size() * sizeof(int64_t));
-    uint64_t** gpu_keys = reinterpret_cast<uint64_t**>(buf_key->ptr());
-    int64_t* gpu_len = reinterpret_cast<int64_t*>(buf_length->ptr());
-    cudaMemcpy(gpu_keys, keys.data(), keys.size() * sizeof(uint64_t*),
-               cudaMemcpyHostToDevice);
-    cudaMemcpy(gpu_len, slot_lengths_lod.data(),
-               slot_lengths.size() * sizeof(int64_t), cudaMemcpyHostToDevice);
+    SlotTable& table = pull_tables_[device_id];
+    table.Reset(BOOST_GET_CONST(platform::CUDAPlace, place),
+                SlotTable::AlignedSize(keys.size(), sizeof(uint64_t*)) +
+                    SlotTable::AlignedSize(slot_lengths_lod.size(),
+                                           sizeof(int64_t)) +
+                    SlotTable::AlignedSize(values.size(), sizeof(float*)));
+    size_t keys_offset = table.Append(keys.data(), keys.size());
+    size_t len_offset =
+        table.Append(slot_lengths_lod.data(), slot_lengths_lod.size());
+    size_t values_offset = table.Append(values.data(), values.size());
+    table.CopyToDevice(stream_list_[device_id]);
+    uint64_t** gpu_keys = table.Get<uint64_t*>(keys_offset);
+    int64_t* gpu_len = table.Get<int64_t>(len_offset);
+    float** gpu_values = table.Get<float*>(values_offset);
 
     this->CopyKeys(place, gpu_keys, total_keys, gpu_len,
                    static_cast<int>(slot_lengths.size()),
@@ -79,7 +84,7 @@ void BoxWrapper::PullSparseCase(const paddle::platform::Place& place,
 
     VLOG(3) << "Begin Copy result to tensor, total_length[" << total_length
             << "]";
-    this->CopyForPull(place, gpu_keys, values,
+    this->CopyForPull(place, gpu_keys, gpu_values,
                       reinterpret_cast<void*>(total_values_gpu), gpu_len,
                       static_cast<int>(slot_lengths.size()), hidden_size,
                       expand_embed_dim, total_length);
@@ -129,9 +134,28 @@ void BoxWrapper::PushSparseGradCase(
     LoDTensor& cached_total_keys_tensor = keys_tensor[device_id];
     uint64_t* total_keys =
         reinterpret_cast<uint64_t*>(cached_total_keys_tensor.data<int64_t>());
+    auto slot_lengths_lod = slot_lengths;
+    for (size_t i = 1; i < slot_lengths_lod.size(); i++) {
+      slot_lengths_lod[i] += slot_lengths_lod[i - 1];
+    }
+    SlotTable& table = push_tables_[device_id];
+    table.Reset(
+        BOOST_GET_CONST(platform::CUDAPlace, place),
+        SlotTable::AlignedSize(grad_values.size(), sizeof(float*)) +
+            SlotTable::AlignedSize(slot_lengths_lod.size(), sizeof(int64_t)) +
+            SlotTable::AlignedSize(slot_vector_.size(), sizeof(int)));
+    size_t values_offset = table.Append(grad_values.data(), grad_values.size());
+    size_t len_offset =
+        table.Append(slot_lengths_lod.data(), slot_lengths_lod.size());
+    size_t slot_offset = table.Append(slot_vector_.data(), slot_vector_.size());
+    table.CopyToDevice(stream_list_[device_id]);
+
     VLOG(3) << "Begin copy grad tensor to boxps struct";
-    this->CopyForPush(place, grad_values, total_grad_values_gpu, slot_lengths,
-                      hidden_size, expand_embed_dim, total_length, batch_size);
+    this->CopyForPush(place, table.Get<float*>(values_offset),
+                      total_grad_values_gpu, table.Get<int64_t>(len_offset),
+                      table.Get<int>(slot_offset),
+                      static_cast<int>(slot_lengths.size()), hidden_size,
+                      expand_embed_dim, total_length, batch_size);
 
     VLOG(3) << "Begin call PushSparseGPU in BoxPS";
     push_boxps_timer.Start();
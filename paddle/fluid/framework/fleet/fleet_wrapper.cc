@@ -343,8 +343,32 @@ void FleetWrapper::PullSparseVarsSync(
   for (auto& t : *fea_values) {
     pull_result_ptr.push_back(t.data());
   }
-  auto status = pslib_ptr_->_worker_ptr->pull_sparse(
-      pull_result_ptr.data(), table_id, fea_keys->data(), fea_keys->size());
+  auto cache_it = sparse_row_caches_.find(table_id);
+  SparseRowCache* cache =
+      cache_it == sparse_row_caches_.end() ? nullptr : cache_it->second.get();
+  std::vector<uint64_t> miss_keys;
+  std::vector<float*> miss_result_ptr;
+  if (cache != nullptr) {
+    // only the rows missed in the cache are pulled from the servers
+    std::vector<size_t> miss_indices;
+    cache->Lookup(fea_keys->data(), fea_keys->size(), fea_value_dim,
+                  pull_result_ptr.data(), &miss_indices);
+    miss_keys.reserve(miss_indices.size());
+    miss_result_ptr.reserve(miss_indices.size());
+    for (auto i : miss_indices) {
+      miss_keys.push_back((*fea_keys)[i]);
+      miss_result_ptr.push_back(pull_result_ptr[i]);
+    }
+  }
+  uint64_t* keys = cache != nullptr ? miss_keys.data() : fea_keys->data();
+  float** values =
+      cache != nullptr ? miss_result_ptr.data() : pull_result_ptr.data();
+  size_t num = cache != nullptr ? miss_keys.size() : fea_keys->size();
+  if (num == 0) {
+    return;
+  }
+  auto status =
+      pslib_ptr_->_worker_ptr->pull_sparse(values, table_id, keys, num);
   pull_sparse_status.push_back(std::move(status));
   for (auto& t : pull_sparse_status) {
     t.wait();
@@ -355,9 +379,36 @@ void FleetWrapper::PullSparseVarsSync(
       exit(-1);
     }
   }
+  if (cache != nullptr) {
+    cache->Update(keys, num, fea_value_dim, values);
+  }
 #endif
 }
 
+void FleetWrapper::SetSparseRowCache(const uint64_t table_id, size_t capacity,
+                                     int64_t max_age) {
+  if (capacity == 0) {
+    sparse_row_caches_.erase(table_id);
+    return;
+  }
+  sparse_row_caches_[table_id].reset(new SparseRowCache(capacity, max_age));
+}
+
+void FleetWrapper::PrintSparseRowCacheStat(const uint64_t table_id) {
+  auto it = sparse_row_caches_.find(table_id);
+  if (it == sparse_row_caches_.end()) {
+    LOG(WARNING) << "table " << table_id << " has no sparse row cache";
+    return;
+  }
+  uint64_t hit = it->second->HitCount();
+  uint64_t miss = it->second->MissCount();
+  LOG(WARNING) << "table " << table_id << " sparse row cache size "
+               << it->second->Size() << ", hit " << hit << ", miss " << miss
+               << ", hit ratio "
+               << (hit + miss == 0 ? 0.0
+                                   : static_cast<double>(hit) / (hit + miss));
+}
+
 void FleetWrapper::PullSparseToTensorSync(const uint64_t table_id, int fea_dim,
                                           uint64_t padding_id,
                                           platform::Place place,
@@ -28,6 +28,7 @@ limitations under the License. */
 #include <unordered_map>
 #include <vector>
 
+#include "paddle/fluid/framework/fleet/sparse_row_cache.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -146,6 +147,14 @@ class FleetWrapper {
                                std::vector<std::vector<float>>* fea_values,
                                int fea_value_dim);
   void ClearLocalTable();
+
+  // Cache at most capacity hot rows of table_id in the worker, which are
+  // served by PullSparseVarsSync for at most max_age steps, capacity = 0
+  // disables the cache. It must be called before training.
+  void SetSparseRowCache(const uint64_t table_id, size_t capacity,
+                         int64_t max_age);
+  // print the hit ratio of the sparse row cache of table_id
+  void PrintSparseRowCacheStat(const uint64_t table_id);
   std::vector<std::unordered_map<uint64_t, std::vector<float>>>&
   GetLocalTable() {
     return local_tables_;
@@ -306,6 +315,7 @@ class FleetWrapper {
   int pull_local_thread_num_;
   std::unique_ptr<::ThreadPool> pull_to_local_pool_{nullptr};
   int local_table_shard_num_;
+  std::map<uint64_t, std::unique_ptr<SparseRowCache>> sparse_row_caches_;
   DISABLE_COPY_AND_ASSIGN(FleetWrapper);
 };
 
@@ -0,0 +1,128 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/fleet/sparse_row_cache.h"
+#include <algorithm>
+#include <cstring>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+SparseRowCache::SparseRowCache(size_t capacity, int64_t max_age,
+                               size_t shard_num)
+    : max_age_(max_age) {
+  PADDLE_ENFORCE_GT(capacity, 0,
+                    platform::errors::InvalidArgument(
+                        "The capacity of SparseRowCache must be larger than "
+                        "0, but received %d.",
+                        capacity));
+  PADDLE_ENFORCE_GT(max_age, 0,
+                    platform::errors::InvalidArgument(
+                        "The max age of SparseRowCache must be larger than "
+                        "0, but received %d.",
+                        max_age));
+  shard_num = std::max<size_t>(std::min(shard_num, capacity), 1);
+  shard_capacity_ = (capacity + shard_num - 1) / shard_num;
+  for (size_t i = 0; i < shard_num; ++i) {
+    shards_.emplace_back(new Shard);
+  }
+}
+
+void SparseRowCache::Lookup(const uint64_t* keys, size_t num, int dim,
+                            float* const* values,
+                            std::vector<size_t>* miss_indices) {
+  int64_t step = ++step_;
+  size_t hit = 0;
+  for (size_t i = 0; i < num; ++i) {
+    Shard& shard = GetShard(keys[i]);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto it = shard.rows.find(keys[i]);
+    if (it == shard.rows.end() || step - it->second.step > max_age_) {
+      miss_indices->push_back(i);
+      continue;
+    }
+    Row& row = it->second;
+    PADDLE_ENFORCE_EQ(row.value.size(), static_cast<size_t>(dim),
+                      platform::errors::InvalidArgument(
+                          "The dim of the cached row is %d, but %d is "
+                          "expected.",
+                          row.value.size(), dim));
+    std::memcpy(values[i], row.value.data(), dim * sizeof(float));
+    row.hit = true;
+    ++hit;
+  }
+  hit_count_ += hit;
+  miss_count_ += num - hit;
+}
+
+void SparseRowCache::Update(const uint64_t* keys, size_t num, int dim,
+                            const float* const* values) {
+  int64_t step = step_;
+  for (size_t i = 0; i < num; ++i) {
+    Shard& shard = GetShard(keys[i]);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto it = shard.rows.find(keys[i]);
+    if (it == shard.rows.end()) {
+      if (shard.rows.size() >= shard_capacity_) {
+        Evict(&shard, step);
+        if (shard.rows.size() >= shard_capacity_) {
+          continue;
+        }
+      }
+      it = shard.rows.emplace(keys[i], Row{{}, step, false}).first;
+    }
+    Row& row = it->second;
+    row.value.assign(values[i], values[i] + dim);
+    row.step = step;
+  }
+}
+
+void SparseRowCache::Evict(Shard* shard, int64_t step) {
+  // sweep at most once every max_age steps, so that the rows are given the
+  // chance to be hit
+  if (step - shard->evict_step < max_age_) {
+    return;
+  }
+  shard->evict_step = step;
+  for (auto it = shard->rows.begin(); it != shard->rows.end();) {
+    if (!it->second.hit || step - it->second.step > max_age_) {
+      it = shard->rows.erase(it);
+    } else {
+      it->second.hit = false;
+      ++it;
+    }
+  }
+}
+
+void SparseRowCache::Clear() {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mtx);
+    shard->rows.clear();
+    shard->evict_step = 0;
+  }
+  step_ = 0;
+}
+
+size_t SparseRowCache::Size() {
+  size_t size = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mtx);
+    size += shard->rows.size();
+  }
+  return size;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,87 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// SparseRowCache is a worker-local cache of the hot rows of a sparse table.
+// The rows are looked up in it before they are pulled from the servers.
+//
+// Each Lookup() is a step, and a cached row is served for at most max_age
+// steps after it is pulled, so the staleness of the rows is bounded. The
+// gradients are still pushed to the servers directly (write-through), and an
+// expired row is pulled and cached again.
+//
+// At most capacity rows are cached. When a shard of the cache is full, the
+// rows which are expired or not hit in the recent max_age steps are evicted,
+// and the new rows are not cached until there is room for them. Therefore,
+// the rows which are accessed frequently stay in the cache.
+//
+// All the methods are thread-safe.
+class SparseRowCache {
+ public:
+  SparseRowCache(size_t capacity, int64_t max_age, size_t shard_num = 64);
+
+  // Copy the cached rows of keys into values, each of which has dim floats,
+  // and append the indices of the keys which are missed to miss_indices.
+  void Lookup(const uint64_t* keys, size_t num, int dim, float* const* values,
+              std::vector<size_t>* miss_indices);
+
+  // Cache the rows pulled from the servers.
+  void Update(const uint64_t* keys, size_t num, int dim,
+              const float* const* values);
+
+  void Clear();
+
+  size_t Size();
+  uint64_t HitCount() const { return hit_count_; }
+  uint64_t MissCount() const { return miss_count_; }
+
+ private:
+  struct Row {
+    std::vector<float> value;
+    int64_t step;
+    bool hit;
+  };
+
+  struct Shard {
+    std::mutex mtx;
+    std::unordered_map<uint64_t, Row> rows;
+    int64_t evict_step{0};
+  };
+
+  Shard& GetShard(uint64_t key) { return *shards_[key % shards_.size()]; }
+
+  // Evict the rows which are expired or not hit since the last eviction,
+  // shard->mtx must be held.
+  void Evict(Shard* shard, int64_t step);
+
+  size_t shard_capacity_;
+  int64_t max_age_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<int64_t> step_{0};
+  std::atomic<uint64_t> hit_count_{0};
+  std::atomic<uint64_t> miss_count_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
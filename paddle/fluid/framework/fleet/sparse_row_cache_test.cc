@@ -0,0 +1,90 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/fleet/sparse_row_cache.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+// Pull the rows of keys through the cache, the row of key k is filled with
+// k + version.
+static size_t Pull(SparseRowCache* cache, const std::vector<uint64_t>& keys,
+                   float version, std::vector<std::vector<float>>* values) {
+  const int kDim = 3;
+  values->assign(keys.size(), std::vector<float>(kDim, -1));
+  std::vector<float*> ptrs;
+  for (auto& v : *values) {
+    ptrs.push_back(v.data());
+  }
+  std::vector<size_t> misses;
+  cache->Lookup(keys.data(), keys.size(), kDim, ptrs.data(), &misses);
+  std::vector<uint64_t> miss_keys;
+  std::vector<float*> miss_ptrs;
+  for (auto i : misses) {
+    for (int j = 0; j < kDim; ++j) {
+      ptrs[i][j] = keys[i] + version;
+    }
+    miss_keys.push_back(keys[i]);
+    miss_ptrs.push_back(ptrs[i]);
+  }
+  cache->Update(miss_keys.data(), miss_keys.size(), kDim, miss_ptrs.data());
+  return misses.size();
+}
+
+TEST(SparseRowCache, HitAndExpire) {
+  SparseRowCache cache(100, 2, 4);
+  std::vector<uint64_t> keys = {1, 2, 3};
+  std::vector<std::vector<float>> values;
+  EXPECT_EQ(Pull(&cache, keys, 0, &values), 3UL);
+  EXPECT_EQ(cache.Size(), 3UL);
+  // served from the cache within max_age steps
+  EXPECT_EQ(Pull(&cache, keys, 10, &values), 0UL);
+  EXPECT_EQ(Pull(&cache, keys, 10, &values), 0UL);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(values[i][2], keys[i]);
+  }
+  // expired, and pulled again
+  EXPECT_EQ(Pull(&cache, keys, 10, &values), 3UL);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(values[i][0], keys[i] + 10);
+  }
+  EXPECT_EQ(cache.HitCount(), 6UL);
+  EXPECT_EQ(cache.MissCount(), 6UL);
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0UL);
+}
+
+TEST(SparseRowCache, KeepHotRows) {
+  SparseRowCache cache(10, 4, 1);
+  std::vector<uint64_t> hot = {1, 2, 3, 4, 5};
+  std::vector<std::vector<float>> values;
+  uint64_t cold = 1000;
+  for (int step = 0; step < 100; ++step) {
+    std::vector<uint64_t> keys = hot;
+    for (int i = 0; i < 5; ++i) {
+      keys.push_back(cold++);
+    }
+    Pull(&cache, keys, 0, &values);
+    EXPECT_LE(cache.Size(), 10UL);
+  }
+  // the hot rows are pulled once every max_age steps at most, and the cold
+  // rows are always missed
+  EXPECT_GT(cache.HitCount(), 300UL);
+  EXPECT_LT(cache.MissCount(), 650UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -13,10 +13,12 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/platform/cuda_device_guard.h"
@@ -28,6 +30,7 @@
 DECLARE_double(eager_delete_tensor_gb);
 DECLARE_double(memory_fraction_of_eager_deletion);
 DECLARE_bool(fast_eager_deletion_mode);
+DECLARE_double(async_cpu_garbage_collection_mb);
 
 namespace paddle {
 namespace framework {
@@ -50,6 +53,86 @@ void CPUGarbageCollector::ClearCallback(const std::function<void()> &callback) {
   callback();
 }
 
+// The background thread which runs the callbacks in the order they are
+// added. It is never destroyed, like the allocators which the garbage is
+// returned to.
+class GarbageCollectionThread {
+ public:
+  static GarbageCollectionThread &Instance() {
+    static auto *instance = new GarbageCollectionThread();
+    return *instance;
+  }
+
+  void Run(std::function<void()> callback) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      callbacks_.emplace_back(std::move(callback));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  GarbageCollectionThread() { std::thread([this] { Loop(); }).detach(); }
+
+  void Loop() {
+    while (true) {
+      std::function<void()> callback;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !callbacks_.empty(); });
+        callback = std::move(callbacks_.front());
+        callbacks_.pop_front();
+      }
+      callback();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> callbacks_;
+};
+
+AsyncCPUGarbageCollector::AsyncCPUGarbageCollector(
+    const platform::CPUPlace &place, size_t max_memory_size)
+    : GarbageCollector(place, max_memory_size),
+      pending_(std::make_shared<PendingBatches>()) {}
+
+void AsyncCPUGarbageCollector::Wait() const {
+  std::unique_lock<std::mutex> lock(pending_->mutex);
+  pending_->cv.wait(lock, [this] { return pending_->num == 0; });
+}
+
+void AsyncCPUGarbageCollector::ClearCallback(
+    const std::function<void()> &callback) {
+  {
+    std::unique_lock<std::mutex> lock(pending_->mutex);
+    pending_->cv.wait(lock,
+                      [this] { return pending_->num < kMaxPendingBatches; });
+    ++pending_->num;
+  }
+  auto pending = pending_;
+  GarbageCollectionThread::Instance().Run([callback, pending] {
+    callback();
+    {
+      std::lock_guard<std::mutex> guard(pending->mutex);
+      --pending->num;
+    }
+    pending->cv.notify_all();
+  });
+}
+
+std::unique_ptr<GarbageCollector> CreateCPUGarbageCollector(
+    const platform::CPUPlace &place, size_t max_memory_size) {
+  if (FLAGS_async_cpu_garbage_collection_mb < 0) {
+    return std::unique_ptr<GarbageCollector>(
+        new CPUGarbageCollector(place, max_memory_size));
+  }
+  auto async_memory_size = static_cast<size_t>(
+      FLAGS_async_cpu_garbage_collection_mb * (static_cast<int64_t>(1) << 20));
+  return std::unique_ptr<GarbageCollector>(new AsyncCPUGarbageCollector(
+      place, (std::max)(max_memory_size, async_memory_size)));
+}
+
 #ifdef PADDLE_WITH_CUDA
 UnsafeFastGPUGarbageCollector::UnsafeFastGPUGarbageCollector(
     const platform::CUDAPlace &place, size_t max_memory_size)
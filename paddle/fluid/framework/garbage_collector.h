@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <functional>
 #include <memory>
@@ -59,6 +60,36 @@ class CPUGarbageCollector : public GarbageCollector {
   void ClearCallback(const std::function<void()> &callback) override;
 };
 
+// AsyncCPUGarbageCollector hands the garbage batches to a background thread,
+// which is shared by all the AsyncCPUGarbageCollectors, so that the memory is
+// not released by the executing threads. At most kMaxPendingBatches batches
+// of each collector wait to be released; adding more garbage blocks until
+// the background thread catches up.
+class AsyncCPUGarbageCollector : public GarbageCollector {
+ public:
+  static constexpr size_t kMaxPendingBatches = 64;
+
+  AsyncCPUGarbageCollector(const platform::CPUPlace &place,
+                           size_t max_memory_size);
+
+  // Wait until all the garbage added to this collector is released.
+  void Wait() const override;
+
+ protected:
+  void ClearCallback(const std::function<void()> &callback) override;
+
+ private:
+  struct PendingBatches {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t num{0};
+  };
+
+  // Shared with the background thread, since the batches of a collector may
+  // be released after the collector is destroyed.
+  std::shared_ptr<PendingBatches> pending_;
+};
+
 #ifdef PADDLE_WITH_CUDA
 class UnsafeFastGPUGarbageCollector : public GarbageCollector {
  public:
@@ -137,6 +168,11 @@ void GarbageCollector::Add(Container &&objs, Callback &&callback) {
   }
 }
 
+// Create an AsyncCPUGarbageCollector if FLAGS_async_cpu_garbage_collection_mb
+// is not less than 0, otherwise a CPUGarbageCollector.
+std::unique_ptr<GarbageCollector> CreateCPUGarbageCollector(
+    const platform::CPUPlace &place, size_t max_memory_size);
+
 int64_t GetEagerDeletionThreshold();
 bool IsFastEagerDeletionModeEnabled();
 
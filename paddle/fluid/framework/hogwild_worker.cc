@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
+#include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
@@ -22,6 +23,90 @@ limitations under the License. */
 namespace paddle {
 namespace framework {
 
+void PreparedOps::Prepare(const std::vector<OperatorBase *> &ops,
+                          const std::vector<std::string> &skip_ops,
+                          const Scope *scope) {
+  PADDLE_ENFORCE_NOT_NULL(
+      scope, platform::errors::InvalidArgument(
+                 "The scope to prepare the ops on should not be null."));
+  scope_ = scope;
+  ops_.clear();
+  for (auto *op : ops) {
+    bool need_skip = false;
+    for (auto &skip_op : skip_ops) {
+      if (op->Type().find(skip_op) != std::string::npos) {
+        need_skip = true;
+        break;
+      }
+    }
+    if (need_skip) continue;
+    PreparedOp prepared_op;
+    prepared_op.op = op;
+    prepared_op.ctx.reset(
+        new RuntimeContext(VariableValueMap(), VariableValueMap()));
+    for (auto &pair : op->Inputs()) {
+      prepared_op.ctx->inputs[pair.first].resize(pair.second.size());
+    }
+    for (auto &pair : op->Outputs()) {
+      prepared_op.ctx->outputs[pair.first].resize(pair.second.size());
+    }
+    ops_.emplace_back(std::move(prepared_op));
+  }
+  VLOG(3) << "Prepare " << ops_.size() << " of " << ops.size()
+          << " ops on scope " << scope_;
+  Bind();
+}
+
+void PreparedOps::Bind() {
+  // Take the versions before finding, so that the variables created in the
+  // meantime by other threads make the contexts outdated.
+  bound_scopes_.clear();
+  for (const Scope *s = scope_; s != nullptr; s = s->parent()) {
+    bound_scopes_.emplace_back(s, s->version());
+  }
+  for (auto &prepared_op : ops_) {
+    prepared_op.vars.clear();
+    for (auto *names : {&prepared_op.op->Inputs(),
+                        &prepared_op.op->Outputs()}) {
+      for (auto &pair : *names) {
+        for (auto &name : pair.second) {
+          prepared_op.vars.push_back(scope_->FindVar(name));
+        }
+      }
+    }
+  }
+}
+
+bool PreparedOps::Outdated() const {
+  for (auto &pair : bound_scopes_) {
+    if (pair.first->version() != pair.second) return true;
+  }
+  return false;
+}
+
+void PreparedOps::Run(const platform::Place &place) {
+  PADDLE_ENFORCE_EQ(IsPrepared(), true,
+                    platform::errors::PreconditionNotMet(
+                        "The ops should be prepared before running."));
+  for (auto &prepared_op : ops_) {
+    // The previous ops may create or erase variables.
+    if (Outdated()) {
+      Bind();
+    }
+    // The variables in the context may be replaced by the transformed ones
+    // in the last run, so they are filled again each time.
+    auto var_iter = prepared_op.vars.begin();
+    for (auto *vars : {&prepared_op.ctx->inputs, &prepared_op.ctx->outputs}) {
+      for (auto &pair : *vars) {
+        for (auto &var : pair.second) {
+          var = *var_iter++;
+        }
+      }
+    }
+    prepared_op.op->Run(*scope_, place, prepared_op.ctx.get());
+  }
+}
+
 void HogwildWorker::Initialize(const TrainerDesc &desc) {
   fetch_config_ = desc.fetch_config();
   param_ = desc.hogwild_param();
@@ -106,8 +191,29 @@ void HogwildWorker::CreateDeviceResource(const ProgramDesc &main_prog) {
   CreateThreadOperators(main_prog);
 }
 
+void HogwildWorker::BindNumaNode() {
+  // The CPUs of the compute threads are set, each trainer thread runs on
+  // one of them.
+  if (platform::BindThreadToKind(platform::ThreadKind::kCompute,
+                                 thread_id_)) {
+    return;
+  }
+  // With the NUMA allocator, each thread allocates from the node it runs on,
+  // so the threads are spread over the nodes to keep their memory local.
+  if (memory::allocation::GetCPUAllocatorStrategy() !=
+      memory::allocation::CPUAllocatorStrategy::kNuma) {
+    return;
+  }
+  int node = thread_id_ % platform::GetNumaNodeCount();
+  if (!platform::BindThreadToNumaNode(node)) {
+    LOG(WARNING) << "Fail to bind thread " << thread_id_ << " to NUMA node "
+                 << node;
+  }
+}
+
 void HogwildWorker::TrainFilesWithProfiler() {
   platform::SetNumThreads(1);
+  BindNumaNode();
   device_reader_->Start();
   std::vector<double> op_total_time;
   std::vector<std::string> op_name;
@@ -125,11 +231,13 @@ void HogwildWorker::TrainFilesWithProfiler() {
   int batch_cnt = 0;
   timeline.Start();
   uint64_t total_inst = 0;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = ReadNextBatch()) > 0) {
     VLOG(3) << "read a batch in thread " << thread_id_;
     timeline.Pause();
     read_time += timeline.ElapsedSec();
     total_time += timeline.ElapsedSec();
+    platform::RecordStepPhase compute(platform::StepPhase::kCompute,
+                                      "HogwildWorker");
     for (size_t i = 0; i < ops_.size(); ++i) {
       bool need_skip = false;
       for (auto t = 0u; t < skip_ops_.size(); ++t) {
@@ -188,23 +296,18 @@ void HogwildWorker::TrainFilesWithProfiler() {
 
 void HogwildWorker::TrainFiles() {
   platform::SetNumThreads(1);
+  BindNumaNode();
 
   // how to accumulate fetched values here
+  if (!prepared_ops_.IsPrepared()) {
+    prepared_ops_.Prepare(ops_, skip_ops_, thread_scope_);
+  }
   device_reader_->Start();
   int cur_batch;
-  while ((cur_batch = device_reader_->Next()) > 0) {
-    for (auto &op : ops_) {
-      bool need_skip = false;
-      for (auto t = 0u; t < skip_ops_.size(); ++t) {
-        if (op->Type().find(skip_ops_[t]) != std::string::npos) {
-          need_skip = true;
-          break;
-        }
-      }
-      if (!need_skip) {
-        op->Run(*thread_scope_, place_);
-      }
-    }
+  while ((cur_batch = ReadNextBatch()) > 0) {
+    platform::RecordStepPhase compute(platform::StepPhase::kCompute,
+                                      "HogwildWorker");
+    prepared_ops_.Run(place_);
 
     PrintFetchVars();
     thread_scope_->DropKids();
@@ -229,6 +332,7 @@ void HogwildWorker::PrintFetchVars() {
                            fetch_config_.fetch_var_str_format(i));
       }
     }
+    PrintStepPhases(batch_num_);
   }
 }
 
@@ -35,8 +35,12 @@
 #include <cryptopp/modes.h>
 #include <cryptopp/smartptr.h>
 
+#include <algorithm>
+#include <fstream>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/io/crypto/cipher_utils.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -44,6 +48,145 @@
 namespace paddle {
 namespace framework {
 
+namespace {
+
+// Decrypt the file of the IV, the ciphertext and, for GCM, the tag, one chunk
+// at a time. CryptoPP uses AES-NI for the AES rounds if the CPU has it.
+class AESDecryptStreamBuf : public std::streambuf {
+ public:
+  AESDecryptStreamBuf(const std::string& filename, const std::string& key,
+                      size_t iv_bytes, size_t tag_bytes, bool authenticated)
+      : fin_(filename, std::ios::binary),
+        authenticated_(authenticated),
+        iv_bytes_(iv_bytes),
+        tag_bytes_(authenticated ? tag_bytes : 0),
+        buffer_(kChunkSize) {
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin_), true,
+                      paddle::platform::errors::Unavailable(
+                          "Cannot open the encrypted file %s.", filename));
+    fin_.seekg(0, std::ios::end);
+    int64_t file_size = fin_.tellg();
+    PADDLE_ENFORCE_GE(
+        file_size, static_cast<int64_t>(iv_bytes_ + tag_bytes_),
+        paddle::platform::errors::InvalidArgument(
+            "The encrypted file %s is truncated.", filename));
+    plain_size_ = file_size - iv_bytes_ - tag_bytes_;
+    fin_.seekg(0, std::ios::beg);
+    std::string iv(iv_bytes_, '\0');
+    fin_.read(&iv[0], iv.size());
+    const auto* key_char = reinterpret_cast<const unsigned char*>(key.data());
+    const auto* iv_char = reinterpret_cast<const unsigned char*>(iv.data());
+    if (authenticated_) {
+      gcm_.SetKeyWithIV(key_char, key.size(), iv_char, iv.size());
+    } else {
+      ctr_.SetKeyWithIV(key_char, key.size(), iv_char, iv.size());
+    }
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+  }
+
+ protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if (decrypted_ >= plain_size_) return traits_type::eof();
+    size_t num = static_cast<size_t>(
+        std::min<int64_t>(kChunkSize, plain_size_ - decrypted_));
+    fin_.read(buffer_.data(), num);
+    PADDLE_ENFORCE_EQ(static_cast<size_t>(fin_.gcount()), num,
+                      paddle::platform::errors::Unavailable(
+                          "Failed to read the encrypted file."));
+    auto* data = reinterpret_cast<unsigned char*>(buffer_.data());
+    if (authenticated_) {
+      gcm_.ProcessData(data, data, num);
+    } else {
+      ctr_.ProcessData(data, data, num);
+    }
+    chunk_begin_ = decrypted_;
+    decrypted_ += num;
+    // no plaintext of a tampered file is returned after the last chunk
+    if (authenticated_ && decrypted_ == plain_size_) Verify();
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + num);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override {
+    int64_t base = 0;
+    if (dir == std::ios_base::cur) {
+      base = chunk_begin_ + (gptr() - eback());
+    } else if (dir == std::ios_base::end) {
+      base = plain_size_;
+    }
+    return seekpos(pos_type(base + off), which);
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    int64_t target = static_cast<int64_t>(pos);
+    if (target < 0 || target > plain_size_ || !(which & std::ios_base::in)) {
+      return pos_type(off_type(-1));
+    }
+    int64_t chunk_end = chunk_begin_ + (egptr() - eback());
+    if (target >= chunk_begin_ && target <= chunk_end) {
+      setg(eback(), eback() + (target - chunk_begin_), egptr());
+      return pos;
+    }
+    // the GCM tag is computed over the whole ciphertext in order
+    if (authenticated_) return pos_type(off_type(-1));
+    fin_.clear();
+    fin_.seekg(iv_bytes_ + target);
+    ctr_.Seek(target);
+    chunk_begin_ = decrypted_ = target;
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+    return pos;
+  }
+
+ private:
+  static constexpr int64_t kChunkSize = 1 << 20;
+
+  void Verify() {
+    std::string tag(tag_bytes_, '\0');
+    fin_.read(&tag[0], tag.size());
+    bool verified =
+        static_cast<size_t>(fin_.gcount()) == tag.size() &&
+        gcm_.TruncatedVerify(reinterpret_cast<const unsigned char*>(tag.data()),
+                             tag.size());
+    PADDLE_ENFORCE_EQ(
+        verified, true,
+        paddle::platform::errors::InvalidArgument("Integrity check failed. "
+                                                  "Invalid ciphertext input."));
+  }
+
+  std::ifstream fin_;
+  bool authenticated_;
+  size_t iv_bytes_;
+  size_t tag_bytes_;
+  int64_t plain_size_{0};
+  // the plaintext offsets of the buffer and of the next chunk
+  int64_t chunk_begin_{0};
+  int64_t decrypted_{0};
+  std::vector<char> buffer_;
+  CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption ctr_;
+  CryptoPP::GCM<CryptoPP::AES>::Decryption gcm_;
+};
+
+constexpr int64_t AESDecryptStreamBuf::kChunkSize;
+
+class AESDecryptStream : public std::istream {
+ public:
+  AESDecryptStream(const std::string& filename, const std::string& key,
+                   size_t iv_bytes, size_t tag_bytes, bool authenticated)
+      : std::istream(nullptr),
+        buf_(filename, key, iv_bytes, tag_bytes, authenticated) {
+    rdbuf(&buf_);
+    // rethrow the errors of the decryption instead of only setting badbit
+    exceptions(std::ios::badbit);
+  }
+
+ private:
+  AESDecryptStreamBuf buf_;
+};
+
+}  // namespace
+
 void AESCipher::Init(const std::string& cipher_name, const int& iv_size,
                      const int& tag_size) {
   aes_cipher_name_ = cipher_name;
@@ -277,5 +420,16 @@ std::string AESCipher::DecryptFromFile(const std::string& key,
   return Decrypt(ciphertext, key);
 }
 
+std::unique_ptr<std::istream> AESCipher::DecryptStreamFromFile(
+    const std::string& key, const std::string& filename) {
+  if (aes_cipher_name_ != "AES_CTR_NoPadding" &&
+      aes_cipher_name_ != "AES_GCM_NoPadding") {
+    return Cipher::DecryptStreamFromFile(key, filename);
+  }
+  return std::unique_ptr<std::istream>(
+      new AESDecryptStream(filename, key, iv_size_ / 8, tag_size_ / 8,
+                           is_authenticated_cipher_));
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -59,6 +59,11 @@ class AESCipher : public Cipher {
                      const std::string& filename) override;
   std::string DecryptFromFile(const std::string& key,
                               const std::string& filename) override;
+  // AES_CTR_NoPadding and AES_GCM_NoPadding are decrypted chunk by chunk,
+  // the other ciphers are decrypted as a whole. The CTR stream can be
+  // seeked, and the GCM stream is checked when its last chunk is decrypted.
+  std::unique_ptr<std::istream> DecryptStreamFromFile(
+      const std::string& key, const std::string& filename) override;
 
   void Init(const std::string& cipher_name, const int& iv_size,
             const int& tag_size);
@@ -18,6 +18,8 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -113,5 +115,50 @@ TEST_F(AESTest, encrypt_to_file) {
   }
 }
 
+TEST_F(AESTest, decrypt_stream_from_file) {
+  std::vector<std::string> name_list(
+      {"AES_CTR_NoPadding", "AES_CBC_PKCSPadding", "AES_ECB_PKCSPadding",
+       "AES_GCM_NoPadding"});
+  // several chunks of the stream
+  std::string plaintext(3 * (1 << 20) + 123, '\0');
+  for (size_t i = 0; i < plaintext.size(); ++i) {
+    plaintext[i] = static_cast<char>(i * 31 + 7);
+  }
+  std::string filename("aes_test.ciphertext");
+  for (auto& i : name_list) {
+    AESTest::GenConfigFile(i);
+    auto cipher = CipherFactory::CreateCipher("aes_test.conf");
+    cipher->EncryptToFile(plaintext, AESTest::key, filename);
+    auto fin = cipher->DecryptStreamFromFile(AESTest::key, filename);
+    std::string plaintext1{std::istreambuf_iterator<char>(*fin),
+                           std::istreambuf_iterator<char>()};
+    EXPECT_EQ(plaintext, plaintext1) << i;
+    if (i == "AES_CTR_NoPadding") {
+      fin = cipher->DecryptStreamFromFile(AESTest::key, filename);
+      char c;
+      fin->seekg(2 * (1 << 20) + 5);
+      fin->read(&c, 1);
+      EXPECT_EQ(c, plaintext[2 * (1 << 20) + 5]);
+      fin->seekg(10);
+      fin->read(&c, 1);
+      EXPECT_EQ(c, plaintext[10]);
+    }
+  }
+
+  // the tampered ciphertext fails the integrity check of GCM
+  std::ifstream file(filename, std::ios::binary);
+  std::string ciphertext{std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>()};
+  file.close();
+  ciphertext[ciphertext.size() / 2] ^= 1;
+  std::ofstream fout(filename, std::ios::binary);
+  fout.write(ciphertext.data(), ciphertext.size());
+  fout.close();
+  auto cipher = CipherFactory::CreateCipher("aes_test.conf");
+  auto fin = cipher->DecryptStreamFromFile(AESTest::key, filename);
+  std::string buffer(plaintext.size(), '\0');
+  EXPECT_ANY_THROW(fin->read(&buffer[0], buffer.size()));
+}
+
 }  // namespace framework
 }  // namespace paddle
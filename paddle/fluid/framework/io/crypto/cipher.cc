@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/io/crypto/cipher.h"
+#include <sstream>
 #include "paddle/fluid/framework/io/crypto/aes_cipher.h"
 #include "paddle/fluid/framework/io/crypto/cipher_utils.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -20,6 +21,12 @@
 namespace paddle {
 namespace framework {
 
+std::unique_ptr<std::istream> Cipher::DecryptStreamFromFile(
+    const std::string& key, const std::string& filename) {
+  return std::unique_ptr<std::istream>(
+      new std::istringstream(DecryptFromFile(key, filename)));
+}
+
 std::shared_ptr<Cipher> CipherFactory::CreateCipher(
     const std::string& config_file) {
   std::string cipher_name;
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <istream>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -39,6 +40,11 @@ class Cipher {
   // read from file and decrypt them
   virtual std::string DecryptFromFile(const std::string& key,
                                       const std::string& filename) = 0;
+  // read from file and decrypt it as a stream, so that the plaintext can be
+  // deserialized without being held in memory as a whole. It decrypts the
+  // whole file by DecryptFromFile by default.
+  virtual std::unique_ptr<std::istream> DecryptStreamFromFile(
+      const std::string& key, const std::string& filename);
 };
 
 class CipherFactory {
@@ -14,9 +14,19 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/io/fs.h"
 
+#include <ThreadPool.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <thread>  // NOLINT
 
 #include "paddle/fluid/platform/enforce.h"
+#include "zlib.h"  // NOLINT
 
 namespace paddle {
 namespace framework {
@@ -236,8 +246,210 @@ void set_download_command(const std::string& x) {
   customized_download_cmd_internal() = x;
 }
 
+static std::string& hdfs_range_read_command_internal() {
+  static std::string x = "";
+  return x;
+}
+
+const std::string& hdfs_range_read_command() {
+  return hdfs_range_read_command_internal();
+}
+
+void hdfs_set_range_read_command(const std::string& x) {
+  hdfs_range_read_command_internal() = x;
+}
+
+static size_t& hdfs_parallel_read_thread_num_internal() {
+  static size_t x = 8;
+  return x;
+}
+
+static size_t& hdfs_parallel_read_chunk_size_internal() {
+  static size_t x = 64 << 20;
+  return x;
+}
+
+void hdfs_set_parallel_read(size_t thread_num, size_t chunk_size) {
+  PADDLE_ENFORCE_GT(thread_num, 0,
+                    platform::errors::InvalidArgument(
+                        "The thread num of the parallel read must be larger "
+                        "than 0."));
+  PADDLE_ENFORCE_GT(chunk_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The chunk size of the parallel read must be larger "
+                        "than 0."));
+  hdfs_parallel_read_thread_num_internal() = thread_num;
+  hdfs_parallel_read_chunk_size_internal() = chunk_size;
+}
+
+// Fetch the range of the file by the range read command, with retries.
+static std::string hdfs_read_range_internal(const std::string& path,
+                                            int64_t offset, size_t length) {
+  std::string cmd = string::format_string(
+      "%s %lld %lu \"%s\"", hdfs_range_read_command().c_str(),
+      static_cast<long long>(offset), length, path.c_str());  // NOLINT
+  std::string data(length, '\0');
+  const int kMaxRetry = 3;
+  for (int retry = 0; retry < kMaxRetry; ++retry) {
+    int err_no = 0;
+    size_t n = 0;
+    {
+      auto fp = shell_popen(cmd, "r", &err_no);
+      if (fp != nullptr) {
+        n = fread(&data[0], 1, length, &*fp);
+        // the range should end here
+        if (n == length && fgetc(&*fp) != EOF) n = 0;
+      }
+    }
+    if (n == length && err_no == 0) return data;
+    LOG(WARNING) << "Failed to read " << length << " bytes at " << offset
+                 << " of " << path << ", retry " << retry;
+  }
+  PADDLE_THROW(platform::errors::Unavailable(
+      "Failed to read %d bytes at %d of %s by the range read command.", length,
+      offset, path));
+}
+
+static bool fs_write_all_internal(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Fetch the chunks of the file concurrently, and write them in order to fd,
+// decompressed if is_gz. Return false if the reader closed the pipe early.
+static bool hdfs_parallel_read_to_fd_internal(const std::string& path,
+                                              int64_t size, bool is_gz,
+                                              int fd) {
+  size_t thread_num = hdfs_parallel_read_thread_num_internal();
+  size_t chunk_size = hdfs_parallel_read_chunk_size_internal();
+  size_t chunk_num = (size + chunk_size - 1) / chunk_size;
+  ::ThreadPool pool(thread_num);
+  std::deque<std::future<std::string>> pending;
+  size_t next = 0;
+
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  // 16 for the gzip header
+  if (is_gz) {
+    PADDLE_ENFORCE_EQ(inflateInit2(&zs, 16 + MAX_WBITS), Z_OK,
+                      platform::errors::External(
+                          "Failed to init the gzip decompression of %s.",
+                          path));
+  }
+  std::shared_ptr<z_stream> zs_guard(
+      &zs, [is_gz](z_stream* zs) {
+        if (is_gz) inflateEnd(zs);
+      });
+  const size_t kOutSize = 1 << 20;
+  std::unique_ptr<char[]> out(new char[kOutSize]);
+  int ret = Z_OK;
+
+  for (size_t i = 0; i < chunk_num; ++i) {
+    // at most one chunk waits for each thread besides the fetching ones
+    while (next < chunk_num && pending.size() < 2 * thread_num) {
+      int64_t offset = static_cast<int64_t>(next * chunk_size);
+      size_t length = std::min<int64_t>(chunk_size, size - offset);
+      pending.emplace_back(pool.enqueue([&path, offset, length]() {
+        return hdfs_read_range_internal(path, offset, length);
+      }));
+      ++next;
+    }
+    std::string chunk = pending.front().get();
+    pending.pop_front();
+    if (!is_gz) {
+      if (!fs_write_all_internal(fd, chunk.data(), chunk.size())) return false;
+      continue;
+    }
+    zs.next_in = reinterpret_cast<Bytef*>(&chunk[0]);
+    zs.avail_in = static_cast<uInt>(chunk.size());
+    while (zs.avail_in > 0) {
+      // the concatenated gzip members
+      if (ret == Z_STREAM_END) inflateReset(&zs);
+      zs.next_out = reinterpret_cast<Bytef*>(out.get());
+      zs.avail_out = kOutSize;
+      ret = inflate(&zs, Z_NO_FLUSH);
+      PADDLE_ENFORCE_EQ(ret == Z_OK || ret == Z_STREAM_END, true,
+                        platform::errors::External(
+                            "Failed to decompress %s, the zlib error is %d.",
+                            path, ret));
+      if (!fs_write_all_internal(fd, out.get(), kOutSize - zs.avail_out)) {
+        return false;
+      }
+    }
+  }
+  PADDLE_ENFORCE_EQ(
+      !is_gz || ret == Z_STREAM_END, true,
+      platform::errors::External("The gzip file %s is truncated.", path));
+  return true;
+}
+
+static std::shared_ptr<FILE> hdfs_open_parallel_read_internal(
+    const std::string& path, int64_t size, bool is_gz, int* err_no) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    *err_no = -1;
+    return nullptr;
+  }
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  auto failed = std::make_shared<std::atomic<bool>>(false);
+  int write_fd = fds[1];
+  auto writer = std::make_shared<std::thread>([=]() {
+    // writing the pipe closed by the reader fails with EPIPE instead
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    try {
+      hdfs_parallel_read_to_fd_internal(path, size, is_gz, write_fd);
+    } catch (std::exception& e) {
+      LOG(WARNING) << "Failed to read " << path << " in parallel: "
+                   << e.what();
+      *failed = true;
+    }
+    close(write_fd);
+  });
+  FILE* fp = fdopen(fds[0], "r");
+  if (fp == nullptr) {
+    close(fds[0]);
+    writer->join();
+    *err_no = -1;
+    return nullptr;
+  }
+  std::shared_ptr<FILE> result(fp, [writer, failed, err_no](FILE* fp) {
+    if (fclose(fp) != 0) *err_no = -1;
+    writer->join();
+    if (*failed) *err_no = -1;
+  });
+
+  size_t buffer_size = hdfs_buffer_size();
+  if (buffer_size > 0) {
+    char* buffer = new char[buffer_size];
+    CHECK_EQ(0, setvbuf(&*result, buffer, _IOFBF, buffer_size));
+    result = {&*result, [result, buffer](FILE*) mutable {  // NOLINT
+                result = nullptr;
+                delete[] buffer;
+              }};
+  }
+  return result;
+}
+
 std::shared_ptr<FILE> hdfs_open_read(std::string path, int* err_no,
                                      const std::string& converter) {
+  if (hdfs_range_read_command() != "" && converter == "") {
+    int64_t size = hdfs_file_size(path);
+    if (size > static_cast<int64_t>(hdfs_parallel_read_chunk_size_internal())) {
+      return hdfs_open_parallel_read_internal(
+          path, size, fs_end_with_internal(path, ".gz"), err_no);
+    }
+  }
+
   if (fs_end_with_internal(path, ".gz")) {
     path = string::format_string("%s -text \"%s\"", hdfs_command().c_str(),
                                  path.c_str());
@@ -270,6 +482,20 @@ std::shared_ptr<FILE> hdfs_open_write(std::string path, int* err_no,
   return fs_open_internal(path, is_pipe, "w", hdfs_buffer_size(), err_no);
 }
 
+int64_t hdfs_file_size(const std::string& path) {
+  std::string size = shell_get_command_output(string::format_string(
+      "%s -stat %%b \"%s\"", hdfs_command().c_str(), path.c_str()));
+  size = string::trim_spaces(size);
+  char* end = nullptr;
+  int64_t x = strtoll(size.c_str(), &end, 10);
+  PADDLE_ENFORCE_EQ(!size.empty() && *end == '\0', true,
+                    platform::errors::External(
+                        "Failed to get the size of %s, the output of the "
+                        "stat command is \"%s\".",
+                        path, size));
+  return x;
+}
+
 void hdfs_remove(const std::string& path) {
   if (path == "") {
     return;
@@ -416,9 +642,13 @@ int64_t fs_file_size(const std::string& path) {
     case 0:
       return localfs_file_size(path);
 
+    case 1:
+      return hdfs_file_size(path);
+
     default:
       PADDLE_THROW(platform::errors::Unimplemented(
-          "Unsupport file system. Now only supports local file system."));
+          "Unsupport file system. Now only supports local file system and "
+          "HDFS."));
   }
 
   return 0;
@@ -518,5 +748,177 @@ void fs_mv(const std::string& src, const std::string& dest) {
   }
 }
 
+class FileReadAhead::Pool : public ::ThreadPool {
+ public:
+  explicit Pool(size_t thread_num) : ::ThreadPool(thread_num) {}
+};
+
+// Copy the content of fp to the local file path, return false if failed.
+static bool fs_copy_to_local_internal(const std::shared_ptr<FILE>& fp,
+                                      const std::string& path) {
+  if (fp == nullptr) {
+    return false;
+  }
+  FILE* out = fopen(path.c_str(), "wb");
+  PADDLE_ENFORCE_NOT_NULL(
+      out, platform::errors::Unavailable(
+               "Failed to create the read ahead file %s.", path));
+  const size_t kBufferSize = 1 << 20;
+  std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+  bool ok = true;
+  size_t n = 0;
+  while ((n = fread(buffer.get(), 1, kBufferSize, &*fp)) > 0) {
+    if (fwrite(buffer.get(), 1, n, out) != n) {
+      ok = false;
+      break;
+    }
+  }
+  ok = ok && !ferror(&*fp);
+  fclose(out);
+  return ok;
+}
+
+FileReadAhead::FileReadAhead(const std::vector<std::string>& filelist,
+                             const std::string& tmp_dir, size_t depth,
+                             size_t download_thread_num,
+                             size_t decompress_thread_num)
+    : filelist_(filelist), tmp_dir_(tmp_dir), depth_(depth) {
+  PADDLE_ENFORCE_GT(download_thread_num, 0,
+                    platform::errors::InvalidArgument(
+                        "The download thread num of FileReadAhead must be "
+                        "larger than 0."));
+  PADDLE_ENFORCE_GT(decompress_thread_num, 0,
+                    platform::errors::InvalidArgument(
+                        "The decompress thread num of FileReadAhead must be "
+                        "larger than 0."));
+  localfs_mkdir(tmp_dir_);
+  download_pool_.reset(new Pool(download_thread_num));
+  decompress_pool_.reset(new Pool(decompress_thread_num));
+}
+
+FileReadAhead::~FileReadAhead() {
+  // The download tasks enqueue the decompress tasks, so they are joined
+  // first.
+  download_pool_.reset();
+  decompress_pool_.reset();
+  for (auto& pair : local_paths_) {
+    try {
+      std::string path = pair.second.get();
+      if (!path.empty()) {
+        unlink(path.c_str());
+      }
+    } catch (...) {
+      VLOG(3) << "FileReadAhead failed to prefetch " << filelist_[pair.first];
+    }
+  }
+}
+
+std::string FileReadAhead::Download(size_t index) {
+  const std::string& path = filelist_[index];
+  std::string local_path = string::format_string(
+      "%s/read_ahead_%d_%p_%lu", tmp_dir_.c_str(), getpid(), this, index);
+  bool is_gz = fs_end_with_internal(path, ".gz");
+  if (fs_select_internal(path) == 0) {
+    // only the compressed local files are prefetched
+    return path;
+  }
+  std::string download_path = is_gz ? local_path + ".gz" : local_path;
+  std::string cmd = string::format_string("%s -cat \"%s\"",
+                                          hdfs_command().c_str(), path.c_str());
+  if (download_cmd() != "" && !is_gz) {  // the same as hdfs_open_read
+    cmd = string::format_string("%s \"%s\"", download_cmd().c_str(),
+                                path.c_str());
+  }
+  const int kMaxRetry = 3;
+  int err_no = 0;
+  for (int retry = 0; retry < kMaxRetry; ++retry) {
+    err_no = 0;
+    bool ok = fs_copy_to_local_internal(shell_popen(cmd, "r", &err_no),
+                                        download_path);
+    if (ok && err_no == 0) break;
+    LOG(WARNING) << "FileReadAhead failed to download " << path << ", retry "
+                 << retry;
+    err_no = -1;
+  }
+  PADDLE_ENFORCE_EQ(err_no, 0, platform::errors::Unavailable(
+                                   "FileReadAhead failed to download %s.",
+                                   path));
+  return download_path;
+}
+
+void FileReadAhead::Schedule(size_t index, size_t end) {
+  end = std::min(end, filelist_.size());
+  for (size_t i = std::max(index, scheduled_end_); i < end; ++i) {
+    const std::string& path = filelist_[i];
+    bool is_gz = fs_end_with_internal(path, ".gz");
+    if (fs_select_internal(path) == 0 && !is_gz) {
+      continue;
+    }
+    auto promise = std::make_shared<std::promise<std::string>>();
+    local_paths_[i] = promise->get_future().share();
+    download_pool_->enqueue([this, i, is_gz, promise]() {
+      std::string download_path;
+      try {
+        download_path = Download(i);
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+        return;
+      }
+      if (!is_gz) {
+        promise->set_value(download_path);
+        return;
+      }
+      decompress_pool_->enqueue([this, i, download_path, promise]() {
+        try {
+          std::string local_path = string::format_string(
+              "%s/read_ahead_%d_%p_%lu", tmp_dir_.c_str(), getpid(), this, i);
+          bool ok = fs_copy_to_local_internal(
+              localfs_open_read(download_path, ""), local_path);
+          if (download_path != filelist_[i]) {
+            unlink(download_path.c_str());
+          }
+          PADDLE_ENFORCE_EQ(ok, true,
+                            platform::errors::Unavailable(
+                                "FileReadAhead failed to decompress %s.",
+                                filelist_[i]));
+          promise->set_value(local_path);
+        } catch (...) {
+          promise->set_exception(std::current_exception());
+        }
+      });
+    });
+  }
+  scheduled_end_ = std::max(scheduled_end_, end);
+}
+
+std::shared_ptr<FILE> FileReadAhead::Open(size_t index, int* err_no,
+                                          const std::string& converter) {
+  PADDLE_ENFORCE_LT(index, filelist_.size(),
+                    platform::errors::OutOfRange(
+                        "The file index %d is out of range of the file list, "
+                        "whose size is %d.",
+                        index, filelist_.size()));
+  std::shared_future<std::string> local_path;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Schedule(index, index + depth_ + 1);
+    auto it = local_paths_.find(index);
+    if (it != local_paths_.end()) {
+      local_path = it->second;
+      local_paths_.erase(it);
+    }
+  }
+  if (!local_path.valid()) {
+    return fs_open_read(filelist_[index], err_no, converter);
+  }
+  std::string path = local_path.get();
+  auto fp = localfs_open_read(path, converter);
+  // remove the temporary file when it is closed
+  return {&*fp, [fp, path](FILE*) mutable {
+            fp = nullptr;
+            unlink(path.c_str());
+          }};
+}
+
 }  // end namespace framework
 }  // end namespace paddle
@@ -15,7 +15,10 @@
 #pragma once
 
 #include <stdio.h>
+#include <future>  // NOLINT
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 #include "glog/logging.h"
@@ -65,12 +68,27 @@ extern const std::string& download_cmd();
 
 extern void set_download_command(const std::string& x);
 
+// The parallel ranged read of the large files. If the range read command is
+// set, hdfs_open_read fetches the files larger than chunk_size by thread_num
+// concurrent commands, each for a chunk, and the chunks are reassembled in
+// order into the returned pipe, where the .gz files are decompressed too. The
+// command is run as `<command> <offset> <length> "<path>"`, and should write
+// the bytes [offset, offset + length) of the file to stdout. The files read
+// with a converter are always read by a single stream.
+extern const std::string& hdfs_range_read_command();
+
+extern void hdfs_set_range_read_command(const std::string& x);
+
+extern void hdfs_set_parallel_read(size_t thread_num, size_t chunk_size);
+
 extern std::shared_ptr<FILE> hdfs_open_read(std::string path, int* err_no,
                                             const std::string& converter);
 
 extern std::shared_ptr<FILE> hdfs_open_write(std::string path, int* err_no,
                                              const std::string& converter);
 
+extern int64_t hdfs_file_size(const std::string& path);
+
 extern void hdfs_remove(const std::string& path);
 
 extern std::vector<std::string> hdfs_list(const std::string& path);
@@ -108,5 +126,49 @@ extern void fs_mkdir(const std::string& path);
 
 extern void fs_mv(const std::string& src, const std::string& dest);
 
+// FileReadAhead prefetches the files of a file list in the background, so
+// that the download of the next files is overlapped with reading the current
+// ones. The files are downloaded into temporary files of tmp_dir by
+// download_thread_num threads, and the .gz files are decompressed by another
+// decompress_thread_num threads. At most depth files after the last opened
+// one are prefetched. The local files which are not compressed are opened
+// directly.
+//
+// Open() is thread-safe, and each file of the list should be opened once.
+class FileReadAhead {
+ public:
+  FileReadAhead(const std::vector<std::string>& filelist,
+                const std::string& tmp_dir, size_t depth,
+                size_t download_thread_num, size_t decompress_thread_num);
+
+  ~FileReadAhead();
+
+  // Open the index-th file of the list, the same as fs_open_read, and the
+  // temporary file is removed when it is closed.
+  std::shared_ptr<FILE> Open(size_t index, int* err_no,
+                             const std::string& converter);
+
+ private:
+  class Pool;
+
+  // Prefetch the files in [index, end) which are not prefetched yet,
+  // mtx_ must be held.
+  void Schedule(size_t index, size_t end);
+
+  // Download the index-th file, and return the local path of it.
+  std::string Download(size_t index);
+
+  std::vector<std::string> filelist_;
+  std::string tmp_dir_;
+  size_t depth_;
+  std::unique_ptr<Pool> download_pool_;
+  std::unique_ptr<Pool> decompress_pool_;
+
+  std::mutex mtx_;
+  // the local paths of the prefetched files, empty if not prefetched
+  std::map<size_t, std::shared_future<std::string>> local_paths_;
+  size_t scheduled_end_{0};
+};
+
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,8 @@
 
 #include <gtest/gtest.h>
 #include <fstream>
+#include <string>
+#include <vector>
 #include "paddle/fluid/framework/io/fs.h"
 
 #if defined _WIN32 || defined __APPLE__
@@ -45,3 +47,111 @@ TEST(FS, mv) {
   }
 #endif
 }
+
+TEST(FS, read_ahead) {
+#ifdef _LINUX
+  std::vector<std::string> filelist;
+  std::vector<std::string> contents;
+  for (int i = 0; i < 6; ++i) {
+    std::string content;
+    for (int j = 0; j < 1000; ++j) {
+      content += std::to_string(i * j) + "\n";
+    }
+    std::string path = "read_ahead_" + std::to_string(i) + ".txt";
+    std::ofstream out(path);
+    out << content;
+    out.close();
+    if (i % 2 == 0) {
+      ASSERT_EQ(system(("gzip -f " + path).c_str()), 0);
+      path += ".gz";
+    }
+    filelist.push_back(path);
+    contents.push_back(content);
+  }
+  paddle::framework::FileReadAhead read_ahead(filelist, "./read_ahead_tmp", 2,
+                                              2, 2);
+  for (size_t i = 0; i < filelist.size(); ++i) {
+    int err_no = 0;
+    auto fp = read_ahead.Open(i, &err_no, "");
+    ASSERT_EQ(err_no, 0);
+    std::string content;
+    char buffer[1024];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), &*fp)) > 0) {
+      content.append(buffer, n);
+    }
+    EXPECT_EQ(content, contents[i]);
+  }
+  for (auto& path : filelist) {
+    paddle::framework::localfs_remove(path);
+  }
+  paddle::framework::localfs_remove("./read_ahead_tmp");
+#endif
+}
+
+TEST(FS, parallel_read) {
+#ifdef _LINUX
+  // the local files are read as HDFS files by the fake commands
+  std::ofstream fake_hdfs("fake_hdfs.sh");
+  fake_hdfs << "[ \"$1\" = \"-stat\" ] && stat -c %s \"${3#hdfs:}\"\n"
+            << "[ \"$1\" = \"-cat\" ] && cat \"${2#hdfs:}\"\n";
+  fake_hdfs.close();
+  std::ofstream range_read("range_read.sh");
+  range_read << "dd if=\"${3#hdfs:}\" iflag=skip_bytes,count_bytes bs=64K "
+             << "skip=$1 count=$2 2>/dev/null\n";
+  range_read.close();
+  std::string hdfs_command = paddle::framework::hdfs_command();
+  paddle::framework::hdfs_set_command("sh fake_hdfs.sh");
+  paddle::framework::hdfs_set_range_read_command("sh range_read.sh");
+  paddle::framework::hdfs_set_parallel_read(3, 1000);
+
+  std::string content;
+  for (int i = 0; i < 5000; ++i) {
+    content += std::to_string(i) + "\n";
+  }
+  std::ofstream out("parallel_read.txt");
+  out << content;
+  out.close();
+  // two gzip members
+  ASSERT_EQ(system("gzip -c parallel_read.txt > parallel_read.txt.gz && "
+                   "gzip -c parallel_read.txt >> parallel_read.txt.gz"),
+            0);
+  EXPECT_EQ(paddle::framework::fs_file_size("hdfs:parallel_read.txt"),
+            static_cast<int64_t>(content.size()));
+
+  std::vector<std::string> expected{content, content + content};
+  std::vector<std::string> paths{"hdfs:parallel_read.txt",
+                                 "hdfs:parallel_read.txt.gz"};
+  for (size_t i = 0; i < paths.size(); ++i) {
+    int err_no = 0;
+    std::string read;
+    {
+      auto fp = paddle::framework::fs_open_read(paths[i], &err_no, "");
+      char buffer[777];
+      size_t n = 0;
+      while ((n = fread(buffer, 1, sizeof(buffer), &*fp)) > 0) {
+        read.append(buffer, n);
+      }
+    }
+    EXPECT_EQ(err_no, 0);
+    EXPECT_EQ(read, expected[i]);
+  }
+
+  // closed before reading all
+  int err_no = 0;
+  {
+    auto fp =
+        paddle::framework::fs_open_read("hdfs:parallel_read.txt", &err_no, "");
+    char buffer[10];
+    ASSERT_EQ(fread(buffer, 1, sizeof(buffer), &*fp), sizeof(buffer));
+  }
+  EXPECT_EQ(err_no, 0);
+
+  paddle::framework::hdfs_set_command(hdfs_command);
+  paddle::framework::hdfs_set_range_read_command("");
+  for (auto path : {"fake_hdfs.sh", "range_read.sh", "parallel_read.txt",
+                    "parallel_read.txt.gz"}) {
+    paddle::framework::localfs_remove(path);
+  }
+#endif
+}
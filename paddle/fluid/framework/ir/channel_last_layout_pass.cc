@@ -0,0 +1,356 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/channel_last_layout_pass.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+const std::vector<int> kToChannelLast{0, 2, 3, 1};
+const std::vector<int> kToChannelFirst{0, 3, 1, 2};
+
+const std::unordered_set<std::string> kActivationOps(
+    {"relu", "relu6", "leaky_relu", "sigmoid", "tanh", "swish", "hard_swish",
+     "hard_sigmoid", "elu", "gelu", "scale"});
+
+const std::unordered_set<std::string> kElementwiseOps(
+    {"elementwise_add", "elementwise_sub", "elementwise_mul",
+     "elementwise_div"});
+
+Node* FindVar(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+// The 4-D tensors computed by the ops, whose layout can be changed.
+bool IsFeatureMap(const Node* var) {
+  return var && var->Var() && !var->Var()->Persistable() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetShape().size() == 4;
+}
+
+bool IsChannelFirst(const OpDesc& op, const std::string& attr) {
+  if (!op.HasAttr(attr)) return true;
+  auto layout = boost::get<std::string>(op.GetAttr(attr));
+  return layout == "NCHW" || layout == "AnyLayout";
+}
+
+std::vector<int64_t> Permute(const std::vector<int64_t>& shape,
+                             const std::vector<int>& perm) {
+  std::vector<int64_t> permuted(perm.size());
+  for (size_t i = 0; i < perm.size(); ++i) permuted[i] = shape[perm[i]];
+  return permuted;
+}
+
+void ReplaceNode(std::vector<Node*>* nodes, Node* from, Node* to) {
+  std::replace(nodes->begin(), nodes->end(), from, to);
+}
+
+void RemoveNode(std::vector<Node*>* nodes, Node* node) {
+  nodes->erase(std::remove(nodes->begin(), nodes->end(), node), nodes->end());
+}
+
+Node* CreateVar(Graph* graph, const std::string& name, const Node* like,
+                const std::vector<int64_t>& shape) {
+  VarDesc desc(name);
+  desc.SetType(proto::VarType::LOD_TENSOR);
+  desc.SetDataType(like->Var()->GetDataType());
+  desc.SetShape(shape);
+  return graph->CreateVarNode(&desc);
+}
+
+// Insert the op transposing x to out.
+void InsertTranspose(Graph* graph, Node* x, Node* out,
+                     const std::vector<int>& perm) {
+  auto x_shape = x->Var()->GetShape();
+  x_shape.insert(x_shape.begin(), 0);
+  auto* xshape = CreateVar(graph, out->Name() + "_xshape", x, x_shape);
+
+  OpDesc desc;
+  desc.SetType("transpose2");
+  desc.SetInput("X", {x->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetOutput("XShape", {xshape->Name()});
+  desc.SetAttr("axis", perm);
+  auto* op = graph->CreateOpNode(&desc);
+  IR_NODE_LINK_TO(x, op);
+  IR_NODE_LINK_TO(op, out);
+  IR_NODE_LINK_TO(op, xshape);
+}
+
+}  // namespace
+
+bool ChannelLastLayoutPass::Convertible(Node* op, OpLayout* layout) const {
+  if (!op->IsOp() || !op->Op()) return false;
+  auto* desc = op->Op();
+  std::string type = desc->Type();
+  std::vector<std::string> input_slots{"X"};
+  std::string output_slot = "Out";
+  if (type == "conv2d") {
+    input_slots = {"Input"};
+    output_slot = "Output";
+    auto inputs = desc->Inputs();
+    if (!IsChannelFirst(*desc, "data_format") ||
+        (inputs.count("ResidualData") && !inputs["ResidualData"].empty())) {
+      return false;
+    }
+  } else if (type == "batch_norm") {
+    output_slot = "Y";
+    if (!IsChannelFirst(*desc, "data_layout")) return false;
+  } else if (type == "pool2d") {
+    if (!IsChannelFirst(*desc, "data_format")) return false;
+  } else if (kElementwiseOps.count(type)) {
+    if (desc->Input("Y").size() != 1) return false;
+    auto* y = FindVar(op->inputs, desc->Input("Y")[0]);
+    int axis = desc->GetAttrIfExists<int>("axis");
+    if (IsFeatureMap(y)) {
+      // the same layout as X, or the bias per channel
+      if (axis != -1 && axis != 0) return false;
+      input_slots.push_back("Y");
+    } else if (!y || !y->Var() || !y->Var()->Persistable() ||
+               y->Var()->GetShape().size() != 1 || axis != 1) {
+      return false;
+    }
+  } else if (!kActivationOps.count(type)) {
+    return false;
+  }
+
+  layout->inputs.clear();
+  for (auto& slot : input_slots) {
+    if (desc->Input(slot).size() != 1) return false;
+    auto* var = FindVar(op->inputs, desc->Input(slot)[0]);
+    if (!IsFeatureMap(var)) return false;
+    layout->inputs.push_back(var);
+  }
+  if (desc->Output(output_slot).size() != 1) return false;
+  layout->output = FindVar(op->outputs, desc->Output(output_slot)[0]);
+  if (!IsFeatureMap(layout->output)) return false;
+  for (auto* in : layout->inputs) {
+    // the inplace ops are not converted
+    if (in->Name() == layout->output->Name()) return false;
+  }
+  if (layout->inputs.size() == 2 &&
+      layout->inputs[0]->Var()->GetShape() !=
+          layout->inputs[1]->Var()->GetShape()) {
+    return false;
+  }
+  return true;
+}
+
+void ChannelLastLayoutPass::ConvertRegion(
+    Graph* graph, const std::vector<Node*>& region,
+    const std::unordered_map<Node*, OpLayout>& layouts,
+    std::unordered_map<Node*, Node*>* channel_last_vars) const {
+  std::unordered_set<Node*> in_region(region.begin(), region.end());
+  auto is_layout_input = [&](Node* op, Node* var) {
+    if (!in_region.count(op)) return false;
+    auto& inputs = layouts.at(op).inputs;
+    return std::find(inputs.begin(), inputs.end(), var) != inputs.end();
+  };
+
+  std::vector<Node*> vars;
+  for (auto* op : region) {
+    for (auto* in : layouts.at(op).inputs) vars.push_back(in);
+    vars.push_back(layouts.at(op).output);
+  }
+  std::sort(vars.begin(), vars.end());
+  vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+
+  for (auto* var : vars) {
+    bool produced_inside = var->inputs.size() == 1 &&
+                           in_region.count(var->inputs[0]) &&
+                           layouts.at(var->inputs[0]).output == var;
+    std::vector<Node*> inside_consumers;
+    bool used_outside = var->outputs.empty();
+    for (auto* consumer : var->outputs) {
+      if (is_layout_input(consumer, var)) {
+        inside_consumers.push_back(consumer);
+      } else {
+        used_outside = true;
+      }
+    }
+    auto shape = Permute(var->Var()->GetShape(), kToChannelLast);
+    if (produced_inside && !used_outside) {
+      var->Var()->SetShape(shape);
+      continue;
+    }
+
+    Node* channel_last = nullptr;
+    auto it = channel_last_vars->find(var);
+    if (it != channel_last_vars->end()) {
+      channel_last = it->second;
+    } else {
+      channel_last =
+          CreateVar(graph, var->Name() + "_channel_last", var, shape);
+      (*channel_last_vars)[var] = channel_last;
+      if (produced_inside) {
+        auto* producer = var->inputs[0];
+        producer->Op()->RenameOutput(var->Name(), channel_last->Name());
+        ReplaceNode(&producer->outputs, var, channel_last);
+        channel_last->inputs.push_back(producer);
+        var->inputs.clear();
+        InsertTranspose(graph, channel_last, var, kToChannelFirst);
+      } else {
+        InsertTranspose(graph, var, channel_last, kToChannelLast);
+      }
+    }
+    for (auto* consumer : inside_consumers) {
+      consumer->Op()->RenameInput(var->Name(), channel_last->Name());
+      ReplaceNode(&consumer->inputs, var, channel_last);
+      RemoveNode(&var->outputs, consumer);
+      channel_last->outputs.push_back(consumer);
+    }
+  }
+
+  for (auto* op : region) {
+    auto* desc = op->Op();
+    std::string type = desc->Type();
+    if (type == "conv2d" || type == "pool2d") {
+      desc->SetAttr("data_format", std::string("NHWC"));
+    } else if (type == "batch_norm") {
+      desc->SetAttr("data_layout", std::string("NHWC"));
+    } else if (kElementwiseOps.count(type) &&
+               layouts.at(op).inputs.size() == 1) {
+      // the bias per channel is on the last axis now
+      desc->SetAttr("axis", 3);
+    }
+  }
+}
+
+int ChannelLastLayoutPass::CancelTransposes(Graph* graph) const {
+  auto perm_of = [](Node* op) {
+    return op->Op()->GetAttrIfExists<std::vector<int>>("axis");
+  };
+  int cancelled = 0;
+  std::unordered_set<const Node*> nodes_to_remove;
+  for (auto* second : graph->Nodes()) {
+    if (!second->IsOp() || !second->Op() ||
+        second->Op()->Type() != "transpose2" || nodes_to_remove.count(second))
+      continue;
+    auto* mid = FindVar(second->inputs, second->Op()->Input("X")[0]);
+    if (!mid || mid->inputs.size() != 1) continue;
+    auto* first = mid->inputs[0];
+    if (!first->IsOp() || !first->Op() ||
+        first->Op()->Type() != "transpose2" || nodes_to_remove.count(first))
+      continue;
+    auto first_perm = perm_of(first);
+    auto second_perm = perm_of(second);
+    if (first_perm.size() != second_perm.size()) continue;
+    bool identity = true;
+    for (size_t i = 0; i < second_perm.size(); ++i) {
+      identity &= first_perm[second_perm[i]] == static_cast<int>(i);
+    }
+    auto* x = FindVar(first->inputs, first->Op()->Input("X")[0]);
+    auto* out = FindVar(second->outputs, second->Op()->Output("Out")[0]);
+    // the outputs without consumers may be fetched by name
+    if (!identity || !x || !out || out->outputs.empty()) continue;
+
+    for (auto* consumer : out->outputs) {
+      consumer->Op()->RenameInput(out->Name(), x->Name());
+      ReplaceNode(&consumer->inputs, out, x);
+      x->outputs.push_back(consumer);
+    }
+    nodes_to_remove.insert(second);
+    for (auto* var : second->outputs) nodes_to_remove.insert(var);
+    RemoveNode(&mid->outputs, second);
+    if (mid->outputs.empty()) {
+      nodes_to_remove.insert(first);
+      nodes_to_remove.insert(mid);
+      for (auto* var : first->outputs) nodes_to_remove.insert(var);
+    }
+    ++cancelled;
+  }
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+  return cancelled;
+}
+
+void ChannelLastLayoutPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+
+  std::unordered_map<Node*, OpLayout> layouts;
+  for (auto* node : graph->Nodes()) {
+    OpLayout layout;
+    if (Convertible(node, &layout)) layouts[node] = layout;
+  }
+
+  // The regions connected by the feature maps, which contain convolutions.
+  std::unordered_set<Node*> visited;
+  std::vector<std::vector<Node*>> regions;
+  for (auto& item : layouts) {
+    if (visited.count(item.first)) continue;
+    std::vector<Node*> region;
+    std::vector<Node*> stack{item.first};
+    visited.insert(item.first);
+    bool has_conv = false;
+    while (!stack.empty()) {
+      auto* op = stack.back();
+      stack.pop_back();
+      region.push_back(op);
+      has_conv |= op->Op()->Type() == "conv2d";
+      auto& layout = layouts.at(op);
+      std::vector<Node*> neighbors;
+      for (auto* in : layout.inputs) {
+        for (auto* producer : in->inputs) {
+          auto it = layouts.find(producer);
+          if (it != layouts.end() && it->second.output == in) {
+            neighbors.push_back(producer);
+          }
+        }
+      }
+      for (auto* consumer : layout.output->outputs) {
+        auto it = layouts.find(consumer);
+        if (it != layouts.end() &&
+            std::count(it->second.inputs.begin(), it->second.inputs.end(),
+                       layout.output)) {
+          neighbors.push_back(consumer);
+        }
+      }
+      for (auto* next : neighbors) {
+        if (visited.insert(next).second) stack.push_back(next);
+      }
+    }
+    if (has_conv) regions.push_back(std::move(region));
+  }
+
+  std::unordered_map<Node*, Node*> channel_last_vars;
+  int converted_ops = 0;
+  for (auto& region : regions) {
+    ConvertRegion(graph, region, layouts, &channel_last_vars);
+    converted_ops += region.size();
+  }
+  int cancelled = CancelTransposes(graph);
+  VLOG(3) << "Convert " << converted_ops << " ops in " << regions.size()
+          << " regions to NHWC, and cancel " << cancelled
+          << " pairs of transposes.";
+  AddStatis(converted_ops);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(channel_last_layout_pass,
+              paddle::framework::ir::ChannelLastLayoutPass);
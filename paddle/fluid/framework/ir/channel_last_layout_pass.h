@@ -0,0 +1,68 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Convert the connected regions of conv2d, batch_norm, pool2d, elementwise
+ * and activation ops to the channel-last (NHWC) layout, so that cuDNN runs
+ * the FP16 convolutions on the tensor cores without transposing every op.
+ * The models are stored as NCHW, so transpose2 ops are inserted only on the
+ * edges of the regions, and the pairs of the transposes cancelling each
+ * other are removed afterwards. The filters keep the OIHW layout.
+ *
+ * It only pays off for the FP16 kernels on Volta or later GPUs, otherwise
+ * cuDNN transposes the data back internally, so it is not in the default
+ * pass lists.
+ */
+class ChannelLastLayoutPass : public FusePassBase {
+ public:
+  virtual ~ChannelLastLayoutPass() {}
+
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  struct OpLayout {
+    std::vector<Node*> inputs;
+    Node* output;
+  };
+
+  bool Convertible(Node* op, OpLayout* layout) const;
+
+  void ConvertRegion(
+      Graph* graph, const std::vector<Node*>& region,
+      const std::unordered_map<Node*, OpLayout>& layouts,
+      std::unordered_map<Node*, Node*>* channel_last_vars) const;
+
+  // Remove the transpose2 ops which restore the inputs of the transpose2 ops
+  // before them.
+  int CancelTransposes(Graph* graph) const;
+
+  const std::string name_scope_{"channel_last_layout_pass"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,145 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/channel_last_layout_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::pair<std::string, std::string>>& inputs,
+           const std::vector<std::pair<std::string, std::string>>& outputs,
+           const AttributeMap& attrs = {}) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) op->SetInput(input.first, {input.second});
+  for (auto& output : outputs) op->SetOutput(output.first, {output.second});
+  for (auto& attr : attrs) op->SetAttr(attr.first, attr.second);
+}
+
+// operator                                  layout
+// --------------------------------------------------
+// (x, filter)->conv2d->c1                   NCHW
+// (c1, scale, bias, mean, var)->bn->c2      NCHW
+// c2->relu->c3
+// c3->pool2d->c4                            NCHW
+// (c4, channel_bias)->elementwise_add->c5   axis 1
+// c5->transpose2->c6                        (0, 2, 3, 1) if transposed
+// c5 or c6->softmax->c7
+ProgramDesc BuildProgramDesc(bool transposed) {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  for (auto& name : {"x", "c1", "c2", "c3", "c4", "c5", "c6", "c7"}) {
+    auto* var = block->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetShape({-1, 3, 8, 8});
+  }
+  for (auto& name :
+       {"filter", "scale", "bias", "mean", "var", "channel_bias"}) {
+    auto* var = block->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetShape({3});
+    var->SetPersistable(true);
+  }
+  block->Var("filter")->SetShape({3, 3, 1, 1});
+  block->Var("c6")->SetShape({-1, 8, 8, 3});
+
+  SetOp(&prog, "conv2d", {{"Input", "x"}, {"Filter", "filter"}},
+        {{"Output", "c1"}}, {{"data_format", std::string("NCHW")}});
+  SetOp(&prog, "batch_norm",
+        {{"X", "c1"},
+         {"Scale", "scale"},
+         {"Bias", "bias"},
+         {"Mean", "mean"},
+         {"Variance", "var"}},
+        {{"Y", "c2"}}, {{"data_layout", std::string("NCHW")}});
+  SetOp(&prog, "relu", {{"X", "c2"}}, {{"Out", "c3"}});
+  SetOp(&prog, "pool2d", {{"X", "c3"}}, {{"Out", "c4"}},
+        {{"data_format", std::string("NCHW")}});
+  SetOp(&prog, "elementwise_add", {{"X", "c4"}, {"Y", "channel_bias"}},
+        {{"Out", "c5"}}, {{"axis", 1}});
+  if (transposed) {
+    SetOp(&prog, "transpose2", {{"X", "c5"}}, {{"Out", "c6"}},
+          {{"axis", std::vector<int>({0, 2, 3, 1})}});
+    SetOp(&prog, "softmax", {{"X", "c6"}}, {{"Out", "c7"}});
+  } else {
+    SetOp(&prog, "softmax", {{"X", "c5"}}, {{"Out", "c7"}});
+  }
+  return prog;
+}
+
+Node* GetOpNode(const std::unique_ptr<Graph>& graph,
+                const std::string& type) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type) return node;
+  }
+  return nullptr;
+}
+
+std::unique_ptr<Graph> ApplyPass(bool transposed) {
+  std::unique_ptr<Graph> graph(new Graph(BuildProgramDesc(transposed)));
+  auto pass = PassRegistry::Instance().Get("channel_last_layout_pass");
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  auto* conv = GetOpNode(graph, "conv2d");
+  EXPECT_EQ(boost::get<std::string>(conv->Op()->GetAttr("data_format")),
+            "NHWC");
+  EXPECT_EQ(boost::get<std::string>(
+                GetOpNode(graph, "batch_norm")->Op()->GetAttr("data_layout")),
+            "NHWC");
+  EXPECT_EQ(boost::get<std::string>(
+                GetOpNode(graph, "pool2d")->Op()->GetAttr("data_format")),
+            "NHWC");
+  EXPECT_EQ(boost::get<int>(
+                GetOpNode(graph, "elementwise_add")->Op()->GetAttr("axis")),
+            3);
+  // the feature maps inside the region are NHWC
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == "c2") {
+      EXPECT_EQ(node->Var()->GetShape(), std::vector<int64_t>({-1, 8, 8, 3}));
+    }
+  }
+  // x is transposed once before conv2d
+  EXPECT_EQ(conv->Op()->Input("Input")[0], "x_channel_last");
+  return graph;
+}
+
+TEST(ChannelLastLayoutPass, region_boundaries) {
+  auto graph = ApplyPass(false);
+  // x is transposed to NHWC, and c5 back to NCHW
+  EXPECT_EQ(GetNumOpNodes(graph, "transpose2"), 2);
+  auto* softmax = GetOpNode(graph, "softmax");
+  EXPECT_EQ(softmax->Op()->Input("X")[0], "c5");
+  EXPECT_EQ(softmax->inputs[0]->Var()->GetShape(),
+            std::vector<int64_t>({-1, 3, 8, 8}));
+}
+
+TEST(ChannelLastLayoutPass, cancel_transposes) {
+  auto graph = ApplyPass(true);
+  // the transpose of c5 back to NCHW and the one of the model cancel out
+  EXPECT_EQ(GetNumOpNodes(graph, "transpose2"), 1);
+  auto* softmax = GetOpNode(graph, "softmax");
+  EXPECT_EQ(softmax->Op()->Input("X")[0], "c5_channel_last");
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(channel_last_layout_pass);
@@ -40,6 +40,12 @@ DEFINE_int32(
     "the number of parameters' gradient. If the fuse_parameter_groups_size is "
     "-1, it means that there are only one group. The default value is 3, it is "
     "an experimental value.");
+DEFINE_bool(fuse_grad_in_ready_order, false,
+            "Group the gradients in the order they are generated in the "
+            "backward, instead of grouping them by layers in the order of "
+            "parameters, so that the first group can be communicated as soon "
+            "as possible. The limits of fuse_parameter_memory_size and "
+            "fuse_parameter_groups_size still apply.");
 
 namespace paddle {
 namespace framework {
@@ -111,7 +117,8 @@ class CoalesceGradTensorPass : public ir::Pass {
         details::kGroupParamsAndDenseGrads);
     // Note: the order of p_g_dense_grad may be changed by
     // SetGroupParamsAndGrads.
-    SetGroupParamsAndGrads(vars_info, p_g_dense_grad, &group_params_grads);
+    SetGroupParamsAndGrads(result, vars_info, p_g_dense_grad,
+                           &group_params_grads);
 
     p_g_dense_grad.clear();
     p_g_dense_grad.reserve(num_of_p_g_dense_grad);
@@ -212,10 +219,16 @@ class CoalesceGradTensorPass : public ir::Pass {
   }
 
   void SetGroupParamsAndGrads(
+      const ir::Graph &graph,
       const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
       const details::ParamsAndGrads &params_grads,
       details::GroupParamsAndGrads *group_params_grads) const {
-    SetGroupAccordingToLayers(vars_info, params_grads, group_params_grads);
+    if (FLAGS_fuse_grad_in_ready_order) {
+      SetGroupAccordingToReadyOrder(graph, vars_info, params_grads,
+                                    group_params_grads);
+    } else {
+      SetGroupAccordingToLayers(vars_info, params_grads, group_params_grads);
+    }
     SetGroupAccordingToMemorySize(vars_info, group_params_grads);
     if (!IsUnifiedDtype(params_grads, vars_info)) {
       ReGroupByDtype(vars_info, group_params_grads);
@@ -258,6 +271,50 @@ class CoalesceGradTensorPass : public ir::Pass {
     }
   }
 
+  // Put each gradient into a group, in the order of the last operator which
+  // writes it in the topological order, i.e., the order the gradients are
+  // ready. The groups are merged by SetGroupAccordingToMemorySize later.
+  void SetGroupAccordingToReadyOrder(
+      const ir::Graph &graph,
+      const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
+      const details::ParamsAndGrads &params_grads,
+      details::GroupParamsAndGrads *group_params_grads) const {
+    std::unordered_map<ir::Node *, size_t> op_order;
+    for (auto *node : ir::TopologySortOperations(graph)) {
+      op_order.emplace(node, op_order.size());
+    }
+
+    std::vector<std::pair<size_t, size_t>> ready_order;
+    ready_order.reserve(params_grads.size());
+    for (size_t i = 0; i < params_grads.size(); ++i) {
+      size_t order = 0;
+      auto iter = vars_info.find(params_grads[i].second);
+      if (iter != vars_info.end()) {
+        for (auto *var_node : iter->second) {
+          for (auto *op_node : var_node->inputs) {
+            auto order_iter = op_order.find(op_node);
+            if (order_iter != op_order.end()) {
+              order = std::max(order, order_iter->second);
+            }
+          }
+        }
+      }
+      ready_order.emplace_back(order, i);
+    }
+    std::stable_sort(ready_order.begin(), ready_order.end());
+
+    for (auto &order_and_idx : ready_order) {
+      group_params_grads->emplace_back();
+      group_params_grads->back().emplace_back(
+          params_grads[order_and_idx.second]);
+    }
+
+    if (VLOG_IS_ON(10)) {
+      VLOG(10) << "SetGroupAccordingToReadyOrder: ";
+      PrintGroupInfo(vars_info, group_params_grads);
+    }
+  }
+
   void PrintGroupInfo(
       const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
       details::GroupParamsAndGrads *group_params_grads) const {
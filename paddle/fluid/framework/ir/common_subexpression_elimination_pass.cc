@@ -0,0 +1,213 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/common_subexpression_elimination_pass.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The attributes which do not change the computation of an op.
+const std::unordered_set<std::string> kIgnoredAttrs({
+    OpProtoAndCheckerMaker::OpCreationCallstackAttrName(),
+    OpProtoAndCheckerMaker::OpNamescopeAttrName(),
+    OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+});
+
+Node* FindVarNode(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && !node->IsCtrlVar() && node->Name() == name) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+// The control dependency var written by op, created if there is none.
+Node* FirstControlDepVar(Graph* graph, Node* op) {
+  for (auto* out : op->outputs) {
+    if (out->IsCtrlVar()) return out;
+  }
+  auto* dep = graph->CreateControlDepVar();
+  dep->inputs.push_back(op);
+  op->outputs.push_back(dep);
+  return dep;
+}
+
+}  // namespace
+
+std::string CommonSubexpressionEliminationPass::OpKey(
+    Node* op, const std::unordered_map<std::string, int>& writers,
+    const std::unordered_set<std::string>& skipped_vars) const {
+  auto* desc = op->Op();
+  if (!desc || !IsPureOp(*desc)) {
+    return "";
+  }
+  // the outputs must be the temporary tensors written by this op only, so
+  // that the consumers can read the outputs of another op instead
+  bool has_output = false;
+  for (auto* out : op->outputs) {
+    if (!out->IsVar() || out->IsCtrlVar()) continue;
+    auto it = writers.find(out->Name());
+    if (!out->Var() || out->Var()->Persistable() || it == writers.end() ||
+        it->second != 1 || skipped_vars.count(out->Name())) {
+      return "";
+    }
+    has_output = true;
+  }
+  if (!has_output) return "";
+
+  // The versions of the inputs are told by the ids of the var nodes.
+  std::stringstream key;
+  key << desc->Type() << ";";
+  for (auto& slot : desc->Inputs()) {
+    key << slot.first << ":";
+    for (auto& name : slot.second) {
+      auto* in = FindVarNode(op->inputs, name);
+      if (!in) return "";
+      key << in->id() << ",";
+    }
+    key << ";";
+  }
+  proto::OpDesc attrs;
+  for (auto& attr : desc->Proto()->attrs()) {
+    if (!kIgnoredAttrs.count(attr.name())) {
+      *attrs.add_attrs() = attr;
+    }
+  }
+  std::sort(attrs.mutable_attrs()->begin(), attrs.mutable_attrs()->end(),
+            [](const proto::OpDesc::Attr& a, const proto::OpDesc::Attr& b) {
+              return a.name() < b.name();
+            });
+  key << attrs.SerializePartialAsString();
+  return key.str();
+}
+
+void CommonSubexpressionEliminationPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+
+  // The vars used by the ops of the sub blocks and the fetch ops can not be
+  // renamed.
+  std::unordered_map<std::string, int> writers;
+  std::unordered_set<std::string> skipped_vars;
+  auto& program = graph->OriginProgram();
+  for (size_t i = 1; i < program.Size(); ++i) {
+    for (auto* op : program.Block(i).AllOps()) {
+      for (auto& name : op->OutputArgumentNames()) {
+        ++writers[name];
+        skipped_vars.insert(name);
+      }
+      for (auto& name : op->InputArgumentNames()) {
+        skipped_vars.insert(name);
+      }
+    }
+  }
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    for (auto* out : node->outputs) {
+      if (out->IsVar() && !out->IsCtrlVar()) ++writers[out->Name()];
+    }
+    if (node->Op() && node->Op()->Type() == "fetch") {
+      for (auto* in : node->inputs) skipped_vars.insert(in->Name());
+    }
+  }
+
+  std::unordered_map<std::string, Node*> first_ops;
+  std::unordered_set<const Node*> nodes_to_remove;
+  for (auto* op : TopologySortOperations(*graph)) {
+    auto key = OpKey(op, writers, skipped_vars);
+    if (key.empty()) continue;
+    auto it = first_ops.find(key);
+    if (it == first_ops.end()) {
+      first_ops.emplace(key, op);
+      continue;
+    }
+    auto* first = it->second;
+    VLOG(4) << "Merge the op " << op->Op()->Type() << " into the same op "
+            << "writing " << first->Op()->OutputArgumentNames()[0];
+    // The outputs of the same slots of the two ops correspond to each other.
+    for (auto& slot : op->Op()->Outputs()) {
+      auto& first_names = first->Op()->Output(slot.first);
+      PADDLE_ENFORCE_EQ(first_names.size(), slot.second.size(),
+                        platform::errors::PreconditionNotMet(
+                            "The equivalent ops of %s should have the same "
+                            "number of outputs %s.",
+                            op->Op()->Type(), slot.first));
+      for (size_t i = 0; i < slot.second.size(); ++i) {
+        auto* out = FindVarNode(op->outputs, slot.second[i]);
+        auto* first_out = FindVarNode(first->outputs, first_names[i]);
+        if (!out || !first_out) continue;
+        for (auto* consumer : out->outputs) {
+          auto& inputs = consumer->inputs;
+          if (std::count(inputs.begin(), inputs.end(), first_out)) {
+            inputs.erase(std::remove(inputs.begin(), inputs.end(), out),
+                         inputs.end());
+          } else {
+            std::replace(inputs.begin(), inputs.end(), out, first_out);
+            first_out->outputs.push_back(consumer);
+          }
+          if (consumer->Op()) {
+            consumer->Op()->RenameInput(out->Name(), first_out->Name());
+          }
+        }
+        out->outputs.clear();
+        nodes_to_remove.insert(out);
+      }
+    }
+    // The ops depending on the merged op depend on first instead.
+    for (auto* dep : op->outputs) {
+      if (!dep->IsCtrlVar()) continue;
+      if (!dep->outputs.empty()) {
+        auto* first_dep = FirstControlDepVar(graph, first);
+        for (auto* consumer : dep->outputs) {
+          auto& inputs = consumer->inputs;
+          if (std::count(inputs.begin(), inputs.end(), first_dep)) {
+            inputs.erase(std::remove(inputs.begin(), inputs.end(), dep),
+                         inputs.end());
+          } else {
+            std::replace(inputs.begin(), inputs.end(), dep, first_dep);
+            first_dep->outputs.push_back(consumer);
+          }
+        }
+        dep->outputs.clear();
+      }
+      nodes_to_remove.insert(dep);
+    }
+    nodes_to_remove.insert(op);
+  }
+  if (nodes_to_remove.empty()) return;
+
+  int merged_ops = 0;
+  for (auto* node : nodes_to_remove) merged_ops += node->IsOp() ? 1 : 0;
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+  AddStatis(merged_ops);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(common_subexpression_elimination_pass,
+              paddle::framework::ir::CommonSubexpressionEliminationPass);
@@ -0,0 +1,51 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Merge the equivalent ops, i.e., the ops of the same type and attributes
+ * reading the same versions of the same inputs, e.g. the shape/slice/cast
+ * chains repeated by each layer. The consumers of the outputs of a merged op
+ * read the outputs of the first op instead, so the chains are merged one op
+ * after another in the topological order.
+ */
+class CommonSubexpressionEliminationPass : public FusePassBase {
+ public:
+  virtual ~CommonSubexpressionEliminationPass() {}
+
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  // The key of the op, empty if the op can not be merged.
+  std::string OpKey(Node* op,
+                    const std::unordered_map<std::string, int>& writers,
+                    const std::unordered_set<std::string>& skipped_vars) const;
+
+  const std::string name_scope_{"common_subexpression_elimination_pass"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,137 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/common_subexpression_elimination_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(CommonSubexpressionEliminationPass, repeated_chains) {
+  // inputs                           operator            output
+  // ------------------------------------------------------------------
+  // (x)                              relu           ->   relu_out_0
+  // (x)                              relu           ->   relu_out_1
+  // (relu_out_0)                     scale          ->   scale_out_0
+  // (relu_out_1)                     scale          ->   scale_out_1
+  // (relu_out_1)                     scale(3.f)     ->   scale_out_2
+  // (scale_out_0, scale_out_1)       elementwise_add ->  add_out
+  // (add_out, scale_out_2)           elementwise_add ->  (fetched)
+  Layers layers;
+  auto* x = layers.data("x", {4});
+  auto* relu_out_0 = layers.relu(x);
+  auto* relu_out_1 = layers.relu(x);
+  auto* scale_out_0 = layers.scale(relu_out_0, 2.f, 0.f, true);
+  auto* scale_out_1 = layers.scale(relu_out_1, 2.f, 0.f, true);
+  auto* scale_out_2 = layers.scale(relu_out_1, 3.f, 0.f, true);
+  auto* add_out = layers.elementwise_add(scale_out_0, scale_out_1);
+  layers.fetch(layers.elementwise_add(add_out, scale_out_2));
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass =
+      PassRegistry::Instance().Get("common_subexpression_elimination_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  // the scale with another attribute is not merged
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 2);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 2);
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "elementwise_add" &&
+        op->Output("Out")[0] == add_out->Name()) {
+      EXPECT_EQ(op->Input("X")[0], scale_out_0->Name());
+      EXPECT_EQ(op->Input("Y")[0], scale_out_0->Name());
+    }
+    if (op->Type() == "scale") {
+      EXPECT_EQ(op->Input("X")[0], relu_out_0->Name());
+    }
+  }
+}
+
+TEST(CommonSubexpressionEliminationPass, random_ops) {
+  Layers layers;
+  auto* x = layers.data("x", {4});
+  auto* dropout_out_0 = layers.dropout(x, 0.5f, "upscale_in_train");
+  auto* dropout_out_1 = layers.dropout(x, 0.5f, "upscale_in_train");
+  layers.fetch(layers.elementwise_add(dropout_out_0, dropout_out_1));
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass =
+      PassRegistry::Instance().Get("common_subexpression_elimination_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "dropout"), 2);
+}
+
+TEST(CommonSubexpressionEliminationPass, control_dependencies) {
+  // The sigmoid depends on the relu writing relu_out_1, which is merged.
+  Layers layers;
+  auto* x = layers.data("x", {4});
+  auto* relu_out_0 = layers.relu(x);
+  auto* relu_out_1 = layers.relu(x);
+  auto* sigmoid_out = layers.sigmoid(x);
+  layers.fetch(layers.elementwise_add(relu_out_0, relu_out_1));
+  layers.fetch(sigmoid_out, 1);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  Node* relu_1 = nullptr;
+  Node* sigmoid = nullptr;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    if (node->Op()->Type() == "relu" &&
+        node->Op()->Output("Out")[0] == relu_out_1->Name()) {
+      relu_1 = node;
+    }
+    if (node->Op()->Type() == "sigmoid") sigmoid = node;
+  }
+  ASSERT_NE(relu_1, nullptr);
+  ASSERT_NE(sigmoid, nullptr);
+  auto* dep = graph->CreateControlDepVar();
+  relu_1->outputs.push_back(dep);
+  dep->inputs.push_back(relu_1);
+  dep->outputs.push_back(sigmoid);
+  sigmoid->inputs.push_back(dep);
+
+  auto pass =
+      PassRegistry::Instance().Get("common_subexpression_elimination_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  // the sigmoid depends on the relu left instead
+  int deps = 0;
+  for (auto* in : sigmoid->inputs) {
+    if (!in->IsCtrlVar()) continue;
+    ++deps;
+    ASSERT_EQ(in->inputs.size(), 1UL);
+    EXPECT_EQ(in->inputs[0]->Op()->Type(), "relu");
+    EXPECT_TRUE(graph->Nodes().count(in->inputs[0]));
+  }
+  EXPECT_EQ(deps, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(common_subexpression_elimination_pass);
+USE_OP(relu);
+USE_OP(sigmoid);
+USE_OP(elementwise_add);
+USE_OP(scale);
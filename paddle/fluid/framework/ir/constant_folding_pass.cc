@@ -0,0 +1,178 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool IsInitializedTensor(const Scope& scope, const std::string& name) {
+  auto* var = scope.FindVar(name);
+  return var && var->IsType<LoDTensor>() &&
+         var->Get<LoDTensor>().IsInitialized();
+}
+
+}  // namespace
+
+bool ConstantFoldingPass::Foldable(
+    Node* op, const std::unordered_map<std::string, int>& writers,
+    const std::unordered_set<std::string>& constants) const {
+  if (!op->Op() || !IsPureOp(*op->Op())) {
+    return false;
+  }
+  bool has_output = false;
+  for (auto* out : op->outputs) {
+    if (!out->IsVar() || !out->Var()) continue;
+    // the outputs must be the temporary tensors written by this op only
+    auto it = writers.find(out->Name());
+    if (out->Var()->GetType() != proto::VarType::LOD_TENSOR ||
+        out->Var()->Persistable() || it == writers.end() || it->second != 1) {
+      return false;
+    }
+    has_output = true;
+  }
+  if (!has_output) return false;
+  for (auto* in : op->inputs) {
+    if (!in->IsVar() || !in->Var()) continue;
+    if (!constants.count(in->Name())) return false;
+  }
+  return true;
+}
+
+bool ConstantFoldingPass::Fold(Node* op, Scope* scope) const {
+  std::vector<std::string> outputs;
+  for (auto* out : op->outputs) {
+    if (out->IsVar() && out->Var()) {
+      scope->Var(out->Name());
+      outputs.push_back(out->Name());
+    }
+  }
+  try {
+    auto folded = OpRegistry::CreateOp(*op->Op());
+    folded->Run(*scope, platform::CPUPlace());
+  } catch (const std::exception& e) {
+    VLOG(3) << "Failed to fold the op " << op->Op()->Type() << ": "
+            << e.what();
+    scope->EraseVars(outputs);
+    return false;
+  }
+  for (auto& name : outputs) {
+    if (!IsInitializedTensor(*scope, name)) {
+      scope->EraseVars(outputs);
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConstantFoldingPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+  auto* scope = param_scope();
+
+  // The vars read or written by the ops of the sub blocks, which are not
+  // in the graph.
+  std::unordered_map<std::string, int> writers;
+  std::unordered_set<std::string> sub_block_vars;
+  auto& program = graph->OriginProgram();
+  for (size_t i = 1; i < program.Size(); ++i) {
+    for (auto* op : program.Block(i).AllOps()) {
+      for (auto& name : op->OutputArgumentNames()) {
+        ++writers[name];
+        sub_block_vars.insert(name);
+      }
+      for (auto& name : op->InputArgumentNames()) {
+        sub_block_vars.insert(name);
+      }
+    }
+  }
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    for (auto* out : node->outputs) {
+      if (out->IsVar() && out->Var()) ++writers[out->Name()];
+    }
+  }
+
+  std::unordered_set<std::string> constants;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var() && node->Var()->Persistable() &&
+        !writers.count(node->Name()) &&
+        IsInitializedTensor(*scope, node->Name())) {
+      constants.insert(node->Name());
+    }
+  }
+
+  std::unordered_set<const Node*> folded_ops;
+  std::unordered_set<std::string> folded_vars;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (!Foldable(op, writers, constants) || !Fold(op, scope)) continue;
+    VLOG(4) << "Fold the op " << op->Op()->Type();
+    folded_ops.insert(op);
+    for (auto* out : op->outputs) {
+      if (out->IsVar() && out->Var()) {
+        constants.insert(out->Name());
+        folded_vars.insert(out->Name());
+      }
+    }
+  }
+  if (folded_ops.empty()) return;
+
+  // Remove the folded ops, and the vars which are not used by the other ops
+  // any more.
+  std::unordered_set<std::string> used_vars(sub_block_vars);
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || folded_ops.count(node)) continue;
+    for (auto* var : node->inputs) used_vars.insert(var->Name());
+    for (auto* var : node->outputs) used_vars.insert(var->Name());
+  }
+  std::unordered_set<const Node*> nodes_to_remove(folded_ops);
+  std::vector<std::string> vars_to_erase;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsVar()) continue;
+    bool linked = false;
+    for (auto* op : node->inputs) linked |= folded_ops.count(op) > 0;
+    for (auto* op : node->outputs) linked |= folded_ops.count(op) > 0;
+    if (!linked) continue;
+    if (used_vars.count(node->Name())) {
+      if (node->Var() && folded_vars.count(node->Name())) {
+        node->Var()->SetPersistable(true);
+      }
+    } else {
+      nodes_to_remove.insert(node);
+      if (node->Var()) vars_to_erase.push_back(node->Name());
+    }
+  }
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+  scope->EraseVars(vars_to_erase);
+
+  AddStatis(folded_ops.size());
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
@@ -0,0 +1,53 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Evaluate the ops whose inputs are all constants, i.e., the initialized
+ * persistable variables in the param scope or the outputs of the ops folded
+ * before, once on the CPU, and replace their outputs with persistable
+ * variables holding the results. The ops without inputs, e.g. fill_constant
+ * and assign_value, are folded too.
+ */
+class ConstantFoldingPass : public FusePassBase {
+ public:
+  virtual ~ConstantFoldingPass() {}
+
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  bool Foldable(Node* op,
+                const std::unordered_map<std::string, int>& writers,
+                const std::unordered_set<std::string>& constants) const;
+
+  // Run the op on the CPU in the param scope, return false if it fails.
+  bool Fold(Node* op, Scope* scope) const;
+
+  const std::string name_scope_{"constant_folding_pass"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
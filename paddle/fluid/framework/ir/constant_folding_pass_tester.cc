@@ -0,0 +1,84 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(scale);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(ConstantFoldingPass, scale_chain) {
+  // inputs                           operator            output
+  // ------------------------------------------------------------------
+  // (w)                              scale          ->   scale_out_0
+  // (scale_out_0)                    scale          ->   scale_out_1
+  // (x, scale_out_1)                 elementwise_add ->  add_out
+  // (add_out)                        scale          ->   (...)
+  Layers layers;
+  auto* x = layers.data("x", {4});
+  auto* w = layers.data("w", {4}, true);
+  auto* scale_out_0 = layers.scale(w, 2.f, 1.f, true);
+  auto* scale_out_1 = layers.scale(scale_out_0, 3.f, 0.f, true);
+  auto* add_out = layers.elementwise_add(x, scale_out_1);
+  layers.scale(add_out, 2.f, 0.f, true);
+
+  auto* param_scope = new Scope();
+  auto* tensor = param_scope->Var("w")->GetMutable<LoDTensor>();
+  tensor->Resize({4});
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 4; ++i) data[i] = i;
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  graph->Set("__param_scope__", param_scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  int num_scale_nodes_before = GetNumOpNodes(graph, "scale");
+  VLOG(3) << DebugString(graph);
+
+  graph.reset(pass->Apply(graph.release()));
+  int num_scale_nodes_after = GetNumOpNodes(graph, "scale");
+  VLOG(3) << DebugString(graph);
+
+  EXPECT_EQ(num_scale_nodes_before, 3);
+  // the scale on add_out depends on the non-persistable x
+  EXPECT_EQ(num_scale_nodes_after, 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+
+  // the folded result replaces the chain, and the unused w is erased
+  EXPECT_EQ(param_scope->FindVar("w"), nullptr);
+  EXPECT_EQ(param_scope->FindVar(scale_out_0->Name()), nullptr);
+  auto* folded = param_scope->FindVar(scale_out_1->Name());
+  ASSERT_NE(folded, nullptr);
+  auto& result = folded->Get<LoDTensor>();
+  ASSERT_EQ(result.numel(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FLOAT_EQ(result.data<float>()[i], (i * 2.f + 1.f) * 3.f);
+  }
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == scale_out_1->Name()) {
+      EXPECT_TRUE(node->Var()->Persistable());
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
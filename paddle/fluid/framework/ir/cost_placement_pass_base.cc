@@ -0,0 +1,214 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/cost_placement_pass_base.h"
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+const char kNativeLibrary[] = "native";
+
+// The unknown dims, e.g. the batch size, are taken as 1.
+int64_t NumElements(const Node* var) {
+  if (!var->Var()) return 0;
+  int64_t numel = 1;
+  for (auto dim : var->Var()->GetShape()) {
+    numel *= dim > 0 ? dim : 1;
+  }
+  return numel;
+}
+
+bool IsPlaced(const Node* n, const std::string& attr_name) {
+  return n->IsOp() && n->Op() && n->Op()->HasAttr(attr_name) &&
+         n->Op()->GetAttrIfExists<bool>(attr_name);
+}
+
+// The data variables flowing between the ops, the persistable parameters are
+// converted once when the kernels run for the first time.
+bool IsActivation(const Node* var) {
+  return var->IsVar() && var->Var() && !var->Var()->Persistable();
+}
+
+}  // namespace
+
+PlacementCostTable PlacementCostTable::Load(const std::string& path) {
+  std::ifstream file(path);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Can not open the placement cost table %s.", path));
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return LoadFromString(ss.str());
+}
+
+PlacementCostTable PlacementCostTable::LoadFromString(const std::string& str) {
+  PlacementCostTable table;
+  std::istringstream is(str);
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ls(line);
+    std::string kind;
+    if (!(ls >> kind) || kind[0] == '#') continue;
+    std::string first, second;
+    bool ok = false;
+    if (kind == "op") {
+      double fixed, per_k_elements;
+      ok = static_cast<bool>(ls >> first >> second >> fixed >> per_k_elements);
+      table.ops_[std::make_pair(first, second)] =
+          std::make_pair(fixed, per_k_elements);
+    } else if (kind == "convert") {
+      double per_k_elements;
+      ok = static_cast<bool>(ls >> first >> second >> per_k_elements);
+      table.converts_[std::make_pair(first, second)] = per_k_elements;
+    }
+    PADDLE_ENFORCE_EQ(ok, true,
+                      platform::errors::InvalidArgument(
+                          "Invalid line of the placement cost table: %s",
+                          line));
+  }
+  return table;
+}
+
+bool PlacementCostTable::OpCost(const std::string& op_type,
+                                const std::string& library, int64_t numel,
+                                double* cost) const {
+  auto it = ops_.find(std::make_pair(op_type, library));
+  if (it == ops_.end()) return false;
+  *cost = it->second.first + it->second.second * numel / 1000.;
+  return true;
+}
+
+double PlacementCostTable::ConvertCost(const std::string& from,
+                                       const std::string& to,
+                                       int64_t numel) const {
+  auto it = converts_.find(std::make_pair(from, to));
+  return it == converts_.end() ? 0. : it->second * numel / 1000.;
+}
+
+std::vector<std::vector<Node*>> CostPlacementPassBase::PlacedGroups(
+    ir::Graph* graph) const {
+  std::string attr_name = GetAttrName();
+  std::unordered_map<Node*, int> group_of;
+  std::vector<std::vector<Node*>> groups;
+  for (auto* n : graph->Nodes()) {
+    if (!IsPlaced(n, attr_name) || group_of.count(n)) continue;
+    groups.emplace_back();
+    auto& group = groups.back();
+    std::vector<Node*> stack{n};
+    group_of[n] = groups.size() - 1;
+    while (!stack.empty()) {
+      auto* op = stack.back();
+      stack.pop_back();
+      group.push_back(op);
+      std::vector<Node*> neighbors;
+      for (auto* var : op->inputs) {
+        if (!IsActivation(var)) continue;
+        neighbors.insert(neighbors.end(), var->inputs.begin(),
+                         var->inputs.end());
+      }
+      for (auto* var : op->outputs) {
+        if (!IsActivation(var)) continue;
+        neighbors.insert(neighbors.end(), var->outputs.begin(),
+                         var->outputs.end());
+      }
+      for (auto* next : neighbors) {
+        if (IsPlaced(next, attr_name) && !group_of.count(next)) {
+          group_of[next] = groups.size() - 1;
+          stack.push_back(next);
+        }
+      }
+    }
+  }
+  return groups;
+}
+
+void CostPlacementPassBase::ApplyImpl(ir::Graph* graph) const {
+  std::string library = GetLibraryName();
+  std::string attr_name = GetAttrName();
+  auto table = PlacementCostTable::Load(Get<std::string>("cost_table"));
+  VLOG(3) << "Applies the cost model to the " << library << " placement.";
+
+  int moved_groups = 0;
+  for (auto& group : PlacedGroups(graph)) {
+    std::unordered_set<Node*> in_group(group.begin(), group.end());
+    double native_cost = 0., placed_cost = 0.;
+    for (auto* op : group) {
+      int64_t numel = 0;
+      for (auto* out : op->outputs) {
+        if (out->IsVar() && out->Var()) {
+          numel = NumElements(out);
+          break;
+        }
+      }
+      double native, placed;
+      // the ops missing in the table are taken as equally fast
+      if (table.OpCost(op->Op()->Type(), kNativeLibrary, numel, &native) &&
+          table.OpCost(op->Op()->Type(), library, numel, &placed)) {
+        native_cost += native;
+        placed_cost += placed;
+      }
+    }
+    // the conversions of the variables crossing the edges of the group
+    std::unordered_set<Node*> converted;
+    for (auto* op : group) {
+      for (auto* var : op->inputs) {
+        if (!IsActivation(var) || converted.count(var)) continue;
+        bool from_outside = var->inputs.empty();
+        for (auto* producer : var->inputs) {
+          from_outside |= !in_group.count(producer);
+        }
+        if (from_outside) {
+          converted.insert(var);
+          placed_cost +=
+              table.ConvertCost(kNativeLibrary, library, NumElements(var));
+        }
+      }
+      for (auto* var : op->outputs) {
+        if (!IsActivation(var) || converted.count(var)) continue;
+        bool to_outside = var->outputs.empty();
+        for (auto* consumer : var->outputs) {
+          to_outside |= !in_group.count(consumer);
+        }
+        if (to_outside) {
+          converted.insert(var);
+          placed_cost +=
+              table.ConvertCost(library, kNativeLibrary, NumElements(var));
+        }
+      }
+    }
+
+    VLOG(4) << "The group of " << group.size() << " ops costs "
+            << placed_cost << "us on " << library << ", " << native_cost
+            << "us on the native kernels.";
+    if (placed_cost >= native_cost && placed_cost > 0.) {
+      for (auto* op : group) {
+        op->Op()->SetAttr(attr_name, false);
+      }
+      ++moved_groups;
+    }
+  }
+  VLOG(3) << moved_groups << " groups of ops are moved from " << library
+          << " to the native kernels.";
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,77 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * The costs of the ops and the layout conversions measured on the target
+ * hardware, loaded from a text file with one entry per line:
+ *
+ *   op <op_type> <library> <fixed_us> <us_per_k_elements>
+ *   convert <from_library> <to_library> <us_per_k_elements>
+ *
+ * The library is "native", "mkldnn" or "cudnn". The cost of an op is scaled
+ * by the number of elements of its first output, and the cost of a
+ * conversion by the number of elements of the converted variable. Lines
+ * starting with '#' are comments.
+ */
+class PlacementCostTable {
+ public:
+  static PlacementCostTable Load(const std::string& path);
+  static PlacementCostTable LoadFromString(const std::string& str);
+
+  // Return false if the op of the library is not in the table.
+  bool OpCost(const std::string& op_type, const std::string& library,
+              int64_t numel, double* cost) const;
+  // Zero if the conversion is not in the table.
+  double ConvertCost(const std::string& from, const std::string& to,
+                     int64_t numel) const;
+
+ private:
+  std::map<std::pair<std::string, std::string>, std::pair<double, double>>
+      ops_;
+  std::map<std::pair<std::string, std::string>, double> converts_;
+};
+
+/*
+ * Runs after a placement pass, and moves every connected group of the ops
+ * placed on a library back to the native kernels, if the group is not faster
+ * than the native kernels according to the cost table, including the layout
+ * conversions on the edges of the group.
+ */
+class CostPlacementPassBase : public Pass {
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+
+  virtual const std::string GetLibraryName() const = 0;
+  virtual const std::string GetAttrName() const = 0;
+
+ private:
+  // The groups of the placed ops connected by the non-persistable variables.
+  std::vector<std::vector<Node*>> PlacedGroups(ir::Graph* graph) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
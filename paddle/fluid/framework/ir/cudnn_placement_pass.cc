@@ -15,4 +15,5 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/cudnn_placement_pass.h"
 
 REGISTER_PASS(cudnn_placement_pass, paddle::framework::ir::CUDNNPlacementPass)
-    .RequirePassAttr("cudnn_enabled_op_types");
+    .RequirePassAttr("cudnn_enabled_op_types")
+    .PreserveAllAnalyses();
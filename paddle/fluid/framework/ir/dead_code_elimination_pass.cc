@@ -0,0 +1,153 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/dead_code_elimination_pass.h"
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+const std::unordered_set<std::string> kSideEffectOps({
+    "feed", "fetch", "print", "save", "save_combine", "send", "recv",
+    "send_barrier", "fetch_barrier", "listen_and_serv", "checkpoint_notify",
+    "py_func", "enqueue", "dequeue",
+});
+
+std::vector<BlockDesc*> SubBlocks(const OpDesc& op) {
+  std::vector<BlockDesc*> blocks;
+  for (auto& name : op.AttrNames()) {
+    auto type = op.GetAttrType(name);
+    if (type == proto::AttrType::BLOCK) {
+      blocks.push_back(BOOST_GET_CONST(BlockDesc*, op.GetAttr(name)));
+    } else if (type == proto::AttrType::BLOCKS) {
+      auto sub_blocks =
+          BOOST_GET_CONST(std::vector<BlockDesc*>, op.GetAttr(name));
+      blocks.insert(blocks.end(), sub_blocks.begin(), sub_blocks.end());
+    }
+  }
+  return blocks;
+}
+
+}  // namespace
+
+bool DeadCodeEliminationPass::HasSideEffect(Node* op) const {
+  if (!op->Op() || kSideEffectOps.count(op->Op()->Type())) return true;
+  bool has_output = false;
+  for (auto* out : op->outputs) {
+    if (!out->IsVar() || out->IsCtrlVar()) continue;
+    if (!out->Var() || out->Var()->Persistable()) return true;
+    has_output = true;
+  }
+  if (!has_output) return true;
+  for (auto* sub_block : SubBlocks(*op->Op())) {
+    for (auto* sub_op : sub_block->AllOps()) {
+      if (HasSideEffect(*sub_op, sub_block)) return true;
+    }
+  }
+  return false;
+}
+
+bool DeadCodeEliminationPass::HasSideEffect(const OpDesc& op,
+                                            const BlockDesc* block) const {
+  if (kSideEffectOps.count(op.Type()) || op.OutputArgumentNames().empty()) {
+    return true;
+  }
+  for (auto& name : op.OutputArgumentNames()) {
+    auto* var = block->FindVarRecursive(name);
+    if (!var || var->Persistable()) return true;
+  }
+  for (auto* sub_block : SubBlocks(op)) {
+    for (auto* sub_op : sub_block->AllOps()) {
+      if (HasSideEffect(*sub_op, sub_block)) return true;
+    }
+  }
+  return false;
+}
+
+void DeadCodeEliminationPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  bool has_fetch = false;
+  for (auto* node : graph->Nodes()) {
+    has_fetch |= node->IsOp() && node->Op() && node->Op()->Type() == "fetch";
+  }
+  if (!has_fetch) {
+    VLOG(3) << "The graph has no fetch op, no op is removed.";
+    return;
+  }
+
+  // The vars read by the ops of the sub blocks, any version of them may be
+  // read.
+  std::unordered_set<std::string> sub_block_inputs;
+  auto& program = graph->OriginProgram();
+  for (size_t i = 1; i < program.Size(); ++i) {
+    for (auto* op : program.Block(i).AllOps()) {
+      for (auto& name : op->InputArgumentNames()) {
+        sub_block_inputs.insert(name);
+      }
+    }
+  }
+
+  std::unordered_set<const Node*> live_nodes;
+  std::vector<Node*> stack;
+  auto mark = [&](Node* node) {
+    if (live_nodes.insert(node).second) stack.push_back(node);
+  };
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && HasSideEffect(node)) {
+      mark(node);
+    } else if (node->IsVar() && sub_block_inputs.count(node->Name())) {
+      mark(node);
+    }
+  }
+  // An op is live if it writes a live var, and a var is live if it is read
+  // by a live op.
+  while (!stack.empty()) {
+    auto* node = stack.back();
+    stack.pop_back();
+    for (auto* in : node->inputs) mark(in);
+  }
+
+  std::unordered_set<const Node*> nodes_to_remove;
+  int removed_ops = 0;
+  for (auto* node : graph->Nodes()) {
+    if (live_nodes.count(node)) continue;
+    if (node->IsOp()) {
+      nodes_to_remove.insert(node);
+      ++removed_ops;
+      continue;
+    }
+    // the dead vars which become isolated
+    bool linked = false;
+    for (auto* op : node->inputs) linked |= live_nodes.count(op) > 0;
+    for (auto* op : node->outputs) linked |= live_nodes.count(op) > 0;
+    if (!linked && (!node->inputs.empty() || !node->outputs.empty())) {
+      nodes_to_remove.insert(node);
+    }
+  }
+  VLOG(3) << "Remove " << removed_ops << " dead ops.";
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(dead_code_elimination_pass,
+              paddle::framework::ir::DeadCodeEliminationPass);
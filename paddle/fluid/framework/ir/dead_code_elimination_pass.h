@@ -0,0 +1,43 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Remove the ops which the fetch targets do not depend on. The ops with side
+ * effects, e.g. feed, fetch, save and the ops writing persistable variables,
+ * are kept. The control flow ops are kept if their outputs are used or their
+ * sub blocks have side effects, and the variables read by the sub blocks
+ * keep their producers. Nothing is removed if the graph has no fetch op.
+ */
+class DeadCodeEliminationPass : public Pass {
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  bool HasSideEffect(Node* op) const;
+  // For the ops of the sub blocks, which are not in the graph.
+  bool HasSideEffect(const OpDesc& op, const BlockDesc* block) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
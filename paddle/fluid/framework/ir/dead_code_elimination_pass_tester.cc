@@ -0,0 +1,72 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/dead_code_elimination_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(DeadCodeEliminationPass, unfetched_ops) {
+  // inputs                           operator            output
+  // ------------------------------------------------------------------
+  // (x)                              relu           ->   relu_out
+  // (relu_out)                       fetch
+  // (x)                              sigmoid        ->   sigmoid_out
+  // (sigmoid_out, relu_out)          elementwise_add ->  add_out
+  // (add_out)                        tanh           ->   tanh_out
+  Layers layers;
+  auto* x = layers.data("x", {4});
+  auto* relu_out = layers.relu(x);
+  layers.fetch(relu_out);
+  auto* sigmoid_out = layers.sigmoid(x);
+  auto* add_out = layers.elementwise_add(sigmoid_out, relu_out);
+  auto* tanh_out = layers.tanh(add_out);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("dead_code_elimination_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "fetch"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "sigmoid"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "tanh"), 0);
+  for (auto* node : graph->Nodes()) {
+    EXPECT_NE(node->Name(), sigmoid_out->Name());
+    EXPECT_NE(node->Name(), tanh_out->Name());
+  }
+}
+
+TEST(DeadCodeEliminationPass, no_fetch) {
+  Layers layers;
+  auto* x = layers.data("x", {4});
+  layers.tanh(layers.relu(x));
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("dead_code_elimination_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "tanh"), 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(dead_code_elimination_pass);
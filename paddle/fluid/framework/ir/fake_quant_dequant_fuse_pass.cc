@@ -0,0 +1,92 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fake_quant_dequant_fuse_pass.h"
+#include <string>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+#define GET_IR_NODE(node__) GET_IR_NODE_FROM_SUBGRAPH(node__, node__, pattern);
+#define GET_NODES               \
+  GET_IR_NODE(quant_in);        \
+  GET_IR_NODE(quant_op);        \
+  GET_IR_NODE(quant_out);       \
+  GET_IR_NODE(quant_out_scale); \
+  GET_IR_NODE(dequant_op);      \
+  GET_IR_NODE(dequant_out);
+
+void FakeQuantDequantFusePass::ApplyImpl(ir::Graph* graph) const {
+  const std::string pattern_name = "fake_quant_dequant_fuse";
+  FusePassBase::Init(pattern_name, graph);
+
+  GraphPatternDetector gpd;
+  patterns::FakeQuantDequantPattern pattern(gpd.mutable_pattern(),
+                                            pattern_name);
+  pattern();
+
+  int found_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    GET_NODES;
+    auto* quant_desc = quant_op->Op();
+    int bit_length = BOOST_GET_CONST(int, quant_desc->GetAttr("bit_length"));
+    float max_range =
+        BOOST_GET_CONST(float, dequant_op->Op()->GetAttr("max_range"));
+    // The dequant op should restore the range of the quant op.
+    if (max_range != static_cast<float>((1 << (bit_length - 1)) - 1)) {
+      VLOG(4) << "The max_range " << max_range << " of dequant op does not "
+              << "match the bit_length " << bit_length << " of quant op.";
+      return;
+    }
+
+    OpDesc desc(quant_desc->Block());
+    desc.SetType("fake_quantize_dequantize_moving_average_abs_max");
+    for (auto& in : quant_desc->Inputs()) {
+      desc.SetInput(in.first, in.second);
+    }
+    for (auto& out : quant_desc->Outputs()) {
+      desc.SetOutput(out.first, out.second);
+    }
+    desc.SetOutput("Out", {dequant_out->Name()});
+    for (auto& attr : quant_desc->GetAttrMap()) {
+      desc.SetAttr(attr.first, attr.second);
+    }
+    auto* fused_op = g->CreateOpNode(&desc);
+
+    for (auto* in : quant_op->inputs) {
+      IR_NODE_LINK_TO(in, fused_op);
+    }
+    for (auto* out : quant_op->outputs) {
+      if (out != quant_out) {
+        IR_NODE_LINK_TO(fused_op, out);
+      }
+    }
+    IR_NODE_LINK_TO(fused_op, dequant_out);
+
+    GraphSafeRemoveNodes(graph, {quant_op, quant_out, dequant_op});
+    ++found_count;
+  };
+
+  gpd(graph, handler);
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fake_quant_dequant_fuse_pass,
+              paddle::framework::ir::FakeQuantDequantFusePass);
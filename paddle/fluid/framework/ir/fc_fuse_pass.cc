@@ -127,6 +127,10 @@ int FCFusePass::ApplyFCPattern(Graph* graph, bool with_relu) const {
         desc.Flush();
       }
     }
+    // The W is persistable, so it can be packed once by the CPU kernel.
+    if (!use_gpu && !desc.GetAttrIfExists<bool>("padding_weights")) {
+      desc.SetAttr("use_packed_weights", true);
+    }
 
     // For anakin subgraph int8
     // When in anakin subgraph int8 mode, the pattern like "fake_quant + mul +
@@ -0,0 +1,292 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_bn_add_act_pass.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/enforce.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cudnn_helper.h"
+#endif
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void FuseBatchNormAddActPass::ApplyImpl(ir::Graph *graph) const {
+#ifdef PADDLE_WITH_CUDA
+#if CUDNN_VERSION_MIN(7, 4, 1)
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument(
+                 "The input graph of FuseBatchNormAddAct should not be "
+                 "nullptr."));
+  FusePassBase::Init("bn_add_act", graph);
+  std::unordered_set<std::string> act_types = {"relu"};
+  std::unordered_set<std::string> act_grad_types = {"relu_grad"};
+  auto forwards = DetectBatchNormAddAct(graph, act_types);
+  auto backwards = DetectBatchNormAddActGrad(graph, act_grad_types);
+
+  int found_bn_add_act_count = 0;
+  for (auto &item : forwards) {
+    auto &fwd = item.second;
+    auto it = backwards.find(item.first);
+    if (it == backwards.end()) {
+      // Without the backward, batch_norm must be the only reader of its
+      // output, e.g. in the forward only programs.
+      if (fwd.bn_out->outputs.size() != 1) continue;
+    } else {
+      auto &bwd = it->second;
+      // elementwise_add_grad reads the output of batch_norm, besides the
+      // elementwise_add.
+      if (fwd.bn_out->outputs.size() != 2) continue;
+      if (bwd.act_out->Name() != fwd.act_out->Name()) continue;
+      // The grad of the output of batch_norm is in the same slot as the
+      // output of batch_norm.
+      bool bn_out_is_x =
+          fwd.elewise_add->Op()->Input("X")[0] == fwd.bn_out->Name();
+      bool d_bn_out_is_x =
+          bwd.elewise_add_grad->Op()->Output(GradVarName("X"))[0] ==
+          bwd.d_bn_out->Name();
+      if (bn_out_is_x != d_bn_out_is_x) continue;
+      FuseBatchNormAddActGrad(graph, bwd);
+    }
+    FuseBatchNormAddAct(graph, fwd);
+    found_bn_add_act_count++;
+  }
+
+  AddStatis(found_bn_add_act_count);
+#endif
+#endif
+}
+
+// act(bn(x) + z)
+std::unordered_map<std::string, FuseBatchNormAddActPass::ForwardNodes>
+FuseBatchNormAddActPass::DetectBatchNormAddAct(
+    ir::Graph *graph, const std::unordered_set<std::string> &act_types) const {
+  GraphPatternDetector gpd;
+  auto *x = gpd.mutable_pattern()
+                ->NewNode("bn_add_act/x")
+                ->AsInput()
+                ->assert_is_op_input("batch_norm", "X")
+                ->assert_var_dtype(proto::VarType::FP16);
+  patterns::BatchNormAddAct bn_add_act_pattern(gpd.mutable_pattern(),
+                                               "bn_add_act");
+  bn_add_act_pattern(x, act_types);
+
+  std::unordered_map<std::string, ForwardNodes> matches;
+  auto handler = [&](const GraphPatternDetector::subgraph_t &subgraph,
+                     Graph *g) {
+    VLOG(4) << "handle FuseBatchNormAddAct fuse";
+    // BN inputs
+    GET_IR_NODE_FROM_SUBGRAPH(bn_scale, bn_scale, bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_bias, bn_bias, bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_variance, bn_variance, bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_mean, bn_mean, bn_add_act_pattern);
+    // BN outputs
+    GET_IR_NODE_FROM_SUBGRAPH(bn_mean_out, bn_mean_out, bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_variance_out, bn_variance_out,
+                              bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_saved_variance, bn_saved_variance,
+                              bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_saved_mean, bn_saved_mean,
+                              bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_reserve_space, bn_reserve_space,
+                              bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_out, bn_out, bn_add_act_pattern);
+    // elementwise_add and ACT
+    GET_IR_NODE_FROM_SUBGRAPH(elewise_add_in, elewise_add_in,
+                              bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(elewise_add_out, elewise_add_out,
+                              bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(act_out, act_out, bn_add_act_pattern);
+    // ops
+    GET_IR_NODE_FROM_SUBGRAPH(batch_norm, batch_norm, bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(elewise_add, elewise_add, bn_add_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(act, act, bn_add_act_pattern);
+
+    // cudnn adds z without broadcasting.
+    if (!elewise_add_in->Var() || !bn_out->Var() ||
+        elewise_add_in->Var()->GetShape() != bn_out->Var()->GetShape()) {
+      return;
+    }
+    matches[bn_reserve_space->Name()] = ForwardNodes{
+        subgraph.at(x),    bn_scale,          bn_bias,
+        bn_variance,       bn_mean,           bn_mean_out,
+        bn_variance_out,   bn_saved_variance, bn_saved_mean,
+        bn_reserve_space,  bn_out,            elewise_add_in,
+        elewise_add_out,   act_out,           batch_norm,
+        elewise_add,       act};
+  };
+
+  gpd(graph, handler);
+  return matches;
+}
+
+// the backward of act(bn(x) + z)
+std::unordered_map<std::string, FuseBatchNormAddActPass::BackwardNodes>
+FuseBatchNormAddActPass::DetectBatchNormAddActGrad(
+    ir::Graph *graph,
+    const std::unordered_set<std::string> &act_grad_types) const {
+  GraphPatternDetector gpd;
+  auto *d_act_out =
+      gpd.mutable_pattern()
+          ->NewNode("bn_add_act_grad/x")
+          ->AsInput()
+          ->assert_is_ops_input(act_grad_types, GradVarName("Out"));
+  patterns::BatchNormAddActGrad bn_add_act_grad_pattern(gpd.mutable_pattern(),
+                                                        "bn_add_act_grad");
+  bn_add_act_grad_pattern(d_act_out, act_grad_types);
+
+  std::unordered_map<std::string, BackwardNodes> matches;
+  auto handler = [&](const GraphPatternDetector::subgraph_t &subgraph,
+                     Graph *g) {
+    VLOG(4) << "handle FuseBatchNormAddActGrad fuse";
+    GET_IR_NODE_FROM_SUBGRAPH(act_grad, act_grad, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(elewise_add_grad, elewise_add_grad,
+                              bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(batch_norm_grad, batch_norm_grad,
+                              bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(act_out, act_out, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(d_act_x, d_act_x, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(d_bn_out, d_bn_out, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(d_elewise_add_in, d_elewise_add_in,
+                              bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_x, bn_x, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_scale, bn_scale, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_bias, bn_bias, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_saved_mean, bn_saved_mean,
+                              bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_saved_variance, bn_saved_variance,
+                              bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_reserve_space, bn_reserve_space,
+                              bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(d_bn_x, d_bn_x, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(d_bn_scale, d_bn_scale, bn_add_act_grad_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(d_bn_bias, d_bn_bias, bn_add_act_grad_pattern);
+
+    matches[bn_reserve_space->Name()] = BackwardNodes{
+        subgraph.at(d_act_out), act_out,           d_act_x,
+        d_bn_out,               d_elewise_add_in,  bn_x,
+        bn_scale,               bn_bias,           bn_saved_mean,
+        bn_saved_variance,      bn_reserve_space,  d_bn_x,
+        d_bn_scale,             d_bn_bias,         act_grad,
+        elewise_add_grad,       batch_norm_grad};
+  };
+
+  gpd(graph, handler);
+  return matches;
+}
+
+void FuseBatchNormAddActPass::FuseBatchNormAddAct(
+    ir::Graph *graph, const ForwardNodes &n) const {
+  OpDesc desc;
+  desc.SetType("fused_bn_add_activation");
+  desc.SetInput("X", {n.bn_x->Name()});
+  desc.SetInput("Z", {n.elewise_add_in->Name()});
+  desc.SetInput("Scale", {n.bn_scale->Name()});
+  desc.SetInput("Bias", {n.bn_bias->Name()});
+  desc.SetInput("Mean", {n.bn_mean->Name()});
+  desc.SetInput("Variance", {n.bn_variance->Name()});
+  desc.SetOutput("Y", {n.act_out->Name()});
+  desc.SetOutput("MeanOut", {n.bn_mean_out->Name()});
+  desc.SetOutput("VarianceOut", {n.bn_variance_out->Name()});
+  desc.SetOutput("SavedMean", {n.bn_saved_mean->Name()});
+  desc.SetOutput("SavedVariance", {n.bn_saved_variance->Name()});
+  desc.SetOutput("ReserveSpace", {n.bn_reserve_space->Name()});
+  for (auto &op : {n.act->Op(), n.batch_norm->Op()}) {
+    for (auto &m : op->GetAttrMap()) {
+      desc.SetAttr(m.first, m.second);
+    }
+  }
+  desc.SetAttr("act_type", n.act->Name());
+
+  auto *fused_node = graph->CreateOpNode(&desc);
+  for (auto *in : {n.bn_x, n.elewise_add_in, n.bn_scale, n.bn_bias, n.bn_mean,
+                   n.bn_variance}) {
+    IR_NODE_LINK_TO(in, fused_node);
+  }
+  for (auto *out : {n.act_out, n.bn_mean_out, n.bn_variance_out,
+                    n.bn_saved_mean, n.bn_saved_variance, n.bn_reserve_space}) {
+    IR_NODE_LINK_TO(fused_node, out);
+  }
+
+  VLOG(4) << "\n\t " << n.bn_x->Name() << " -> " << n.batch_norm->Name()
+          << " -> " << n.bn_out->Name() << "\n\t " << n.bn_out->Name()
+          << " and " << n.elewise_add_in->Name() << " -> "
+          << n.elewise_add->Name() << " -> " << n.elewise_add_out->Name()
+          << "\n\t " << n.elewise_add_out->Name() << " -> " << n.act->Name()
+          << " -> " << n.act_out->Name();
+
+  // The grad of elementwise_add has been fused, so the output of batch_norm
+  // is not read by any other op.
+  GraphSafeRemoveNodes(graph, {n.batch_norm, n.elewise_add, n.act, n.bn_out,
+                               n.elewise_add_out});
+}
+
+void FuseBatchNormAddActPass::FuseBatchNormAddActGrad(
+    ir::Graph *graph, const BackwardNodes &n) const {
+  OpDesc desc;
+  desc.SetType("fused_bn_add_activation_grad");
+  desc.SetInput("X", {n.bn_x->Name()});
+  desc.SetInput("Y", {n.act_out->Name()});
+  desc.SetInput(GradVarName("Y"), {n.d_act_out->Name()});
+  desc.SetInput("Scale", {n.bn_scale->Name()});
+  desc.SetInput("Bias", {n.bn_bias->Name()});
+  desc.SetInput("SavedMean", {n.bn_saved_mean->Name()});
+  desc.SetInput("SavedVariance", {n.bn_saved_variance->Name()});
+  desc.SetInput("ReserveSpace", {n.bn_reserve_space->Name()});
+  desc.SetOutput(GradVarName("X"), {n.d_bn_x->Name()});
+  desc.SetOutput(GradVarName("Z"), {n.d_elewise_add_in->Name()});
+  desc.SetOutput(GradVarName("Scale"), {n.d_bn_scale->Name()});
+  desc.SetOutput(GradVarName("Bias"), {n.d_bn_bias->Name()});
+  for (auto &op : {n.act_grad->Op(), n.batch_norm_grad->Op()}) {
+    for (auto &m : op->GetAttrMap()) {
+      desc.SetAttr(m.first, m.second);
+    }
+  }
+  std::string act = n.act_grad->Name();
+  act = act.substr(0, act.length() - 5);  // remove "_grad"
+  desc.SetAttr("act_type", act);
+
+  auto *fused_node = graph->CreateOpNode(&desc);
+  for (auto *in : {n.bn_x, n.act_out, n.d_act_out, n.bn_scale, n.bn_bias,
+                   n.bn_saved_mean, n.bn_saved_variance, n.bn_reserve_space}) {
+    IR_NODE_LINK_TO(in, fused_node);
+  }
+  for (auto *out :
+       {n.d_bn_x, n.d_elewise_add_in, n.d_bn_scale, n.d_bn_bias}) {
+    IR_NODE_LINK_TO(fused_node, out);
+  }
+
+  VLOG(4) << "\n\t " << n.d_act_out->Name() << " -> " << n.act_grad->Name()
+          << " -> " << n.d_act_x->Name() << "\n\t " << n.d_act_x->Name()
+          << " -> " << n.elewise_add_grad->Name() << " -> "
+          << n.d_bn_out->Name() << " and " << n.d_elewise_add_in->Name()
+          << "\n\t " << n.d_bn_out->Name() << " -> "
+          << n.batch_norm_grad->Name() << " -> " << n.d_bn_x->Name();
+
+  GraphSafeRemoveNodes(graph, {n.act_grad, n.elewise_add_grad,
+                               n.batch_norm_grad, n.d_act_x, n.d_bn_out});
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_bn_add_act_pass,
+              paddle::framework::ir::FuseBatchNormAddActPass);
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the BatchNorm, the residual elementwise_add and the activation, i.e.
+ * act(bn(x) + z), into fused_bn_add_activation, and their grads into
+ * fused_bn_add_activation_grad. The forward and the backward of a block are
+ * fused together or not at all, since the grad op reads the reserve space
+ * written by the forward op.
+ */
+class FuseBatchNormAddActPass : public FusePassBase {
+ public:
+  virtual ~FuseBatchNormAddActPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override;
+
+ private:
+  struct ForwardNodes {
+    Node *bn_x, *bn_scale, *bn_bias, *bn_variance, *bn_mean;
+    Node *bn_mean_out, *bn_variance_out, *bn_saved_variance, *bn_saved_mean;
+    Node *bn_reserve_space, *bn_out;
+    Node *elewise_add_in, *elewise_add_out, *act_out;
+    Node *batch_norm, *elewise_add, *act;
+  };
+
+  struct BackwardNodes {
+    Node *d_act_out, *act_out, *d_act_x, *d_bn_out, *d_elewise_add_in;
+    Node *bn_x, *bn_scale, *bn_bias, *bn_saved_mean, *bn_saved_variance;
+    Node *bn_reserve_space, *d_bn_x, *d_bn_scale, *d_bn_bias;
+    Node *act_grad, *elewise_add_grad, *batch_norm_grad;
+  };
+
+  // The matches are keyed by the name of the reserve space of batch_norm.
+  std::unordered_map<std::string, ForwardNodes> DetectBatchNormAddAct(
+      ir::Graph *graph, const std::unordered_set<std::string> &act_types) const;
+
+  std::unordered_map<std::string, BackwardNodes> DetectBatchNormAddActGrad(
+      ir::Graph *graph,
+      const std::unordered_set<std::string> &act_grad_types) const;
+
+  void FuseBatchNormAddAct(ir::Graph *graph, const ForwardNodes &nodes) const;
+
+  void FuseBatchNormAddActGrad(ir::Graph *graph,
+                               const BackwardNodes &nodes) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
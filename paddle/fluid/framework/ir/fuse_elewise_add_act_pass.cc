@@ -25,14 +25,33 @@ namespace paddle {
 namespace framework {
 namespace ir {
 
+namespace {
+
+// The scale functor of fused_elemwise_activation doesn't add the bias.
+bool IsUnsupportedScale(const Node *act) {
+  return act->Op()->Type() == "scale" &&
+         act->Op()->GetAttrIfExists<float>("bias") != 0.f;
+}
+
+}  // namespace
+
 void FuseElewiseAddActPass::ApplyImpl(ir::Graph *graph) const {
-  std::unordered_set<std::string> act_types = {"relu", "scale", "tanh"};
-  graph = FuseActElewiseAdd(graph, act_types);
-  graph = FuseElewiseAddAct(graph, act_types);
+  std::unordered_set<std::string> act_types = {"relu", "scale", "tanh",
+                                               "sigmoid"};
+  std::unordered_set<std::string> binary_types = {"elementwise_add",
+                                                  "elementwise_mul"};
+  graph = FuseActElewiseAdd(graph, act_types, binary_types);
+  graph = FuseElewiseAddAct(graph, act_types, binary_types);
   // backward
   {
-    std::unordered_set<std::string> in_place_act_types = {"relu_grad"};
-    graph = FuseElewiseAddActInplaceGrad(graph, in_place_act_types);
+    // The grads of these acts only take Out, so the fused grad op doesn't
+    // need the intermediate_out.
+    std::unordered_set<std::string> in_place_act_types = {
+        "relu_grad", "tanh_grad", "sigmoid_grad"};
+    std::unordered_set<std::string> binary_grad_types = {
+        "elementwise_add_grad", "elementwise_mul_grad"};
+    graph = FuseElewiseAddActInplaceGrad(graph, in_place_act_types,
+                                         binary_grad_types);
   }
 
   // Remove the removable intermediate_out.
@@ -41,7 +60,8 @@ void FuseElewiseAddActPass::ApplyImpl(ir::Graph *graph) const {
 
 // ele_add(x, act(y))
 ir::Graph *FuseElewiseAddActPass::FuseElewiseAddAct(
-    ir::Graph *graph, const std::unordered_set<std::string> &act_types) const {
+    ir::Graph *graph, const std::unordered_set<std::string> &act_types,
+    const std::unordered_set<std::string> &binary_types) const {
   PADDLE_ENFORCE(graph);
   FusePassBase::Init("elewise_add_act", graph);
 
@@ -49,11 +69,11 @@ ir::Graph *FuseElewiseAddActPass::FuseElewiseAddAct(
   auto *x = gpd.mutable_pattern()
                 ->NewNode("elewise_add_act/x")
                 ->AsInput()
-                ->assert_is_op_input("elementwise_add", "X");
+                ->assert_is_ops_input(binary_types, "X");
   patterns::ElewiseAddAct elewise_add_act_pattern(gpd.mutable_pattern(),
                                                   "elementwise_add");
 
-  elewise_add_act_pattern(x, act_types);
+  elewise_add_act_pattern(x, act_types, binary_types);
 
   int found_elewise_add_act_count = 0;
 
@@ -66,6 +86,7 @@ ir::Graph *FuseElewiseAddActPass::FuseElewiseAddAct(
     GET_IR_NODE_FROM_SUBGRAPH(act_out, act_out, elewise_add_act_pattern);
     GET_IR_NODE_FROM_SUBGRAPH(act, act, elewise_add_act_pattern);
     GET_IR_NODE_FROM_SUBGRAPH(ele_add, ele_add, elewise_add_act_pattern);
+    if (IsUnsupportedScale(act)) return;
 
     std::string ele_x_n = subgraph.at(x)->Name();
     std::string ele_y_n = ele_y->Name();
@@ -92,7 +113,8 @@ ir::Graph *FuseElewiseAddActPass::FuseElewiseAddAct(
 
 // act(ele_add(x,y))
 ir::Graph *FuseElewiseAddActPass::FuseActElewiseAdd(
-    ir::Graph *graph, const std::unordered_set<std::string> &act_types) const {
+    ir::Graph *graph, const std::unordered_set<std::string> &act_types,
+    const std::unordered_set<std::string> &binary_types) const {
   PADDLE_ENFORCE(graph);
   FusePassBase::Init("act_elewise_add", graph);
 
@@ -104,7 +126,7 @@ ir::Graph *FuseElewiseAddActPass::FuseActElewiseAdd(
   patterns::ActElewiseAdd act_elewise_add_pattern(gpd.mutable_pattern(),
                                                   "act_elewise_add");
 
-  act_elewise_add_pattern(x, act_types);
+  act_elewise_add_pattern(x, act_types, binary_types);
 
   int found_elewise_add_act_count = 0;
 
@@ -117,6 +139,7 @@ ir::Graph *FuseElewiseAddActPass::FuseActElewiseAdd(
                               act_elewise_add_pattern);
     GET_IR_NODE_FROM_SUBGRAPH(act, act, act_elewise_add_pattern);
     GET_IR_NODE_FROM_SUBGRAPH(ele_add, ele_add, act_elewise_add_pattern);
+    if (IsUnsupportedScale(act)) return;
 
     std::string act_i_n = subgraph.at(x)->Name();
     std::string act_o_n = act_out->Name();
@@ -143,8 +166,10 @@ ir::Graph *FuseElewiseAddActPass::FuseActElewiseAdd(
 // the backward of act(ele_add(x,y))
 // act_grad: in["Out", "Out@GRAD"], out["X@GRAD"]
 // ele_add_grad: in["Y", "Out@GRAD"], out["X@GRAD", "Y@GRAD"]
+// ele_mul_grad: in["X", "Y", "Out@GRAD"], out["X@GRAD", "Y@GRAD"]
 ir::Graph *FuseElewiseAddActPass::FuseElewiseAddActInplaceGrad(
-    ir::Graph *graph, const std::unordered_set<std::string> &act_types) const {
+    ir::Graph *graph, const std::unordered_set<std::string> &act_types,
+    const std::unordered_set<std::string> &binary_grad_types) const {
   PADDLE_ENFORCE(graph);
   FusePassBase::Init("elewise_add_act_grad", graph);
 
@@ -155,7 +180,7 @@ ir::Graph *FuseElewiseAddActPass::FuseElewiseAddActInplaceGrad(
                         ->assert_is_ops_input(act_types, GradVarName("Out"));
   patterns::ElewiseAddActInplaceGrad elewise_add_act_grad_pattern(
       gpd.mutable_pattern(), "elewise_add_act_grad_inplace");
-  elewise_add_act_grad_pattern(d_act_out, act_types);
+  elewise_add_act_grad_pattern(d_act_out, act_types, binary_grad_types);
 
   int found_elewise_add_act_count = 0;
 
@@ -182,7 +207,13 @@ ir::Graph *FuseElewiseAddActPass::FuseElewiseAddActInplaceGrad(
     OpDesc desc;
     desc.SetType("fused_elemwise_activation_grad");
     desc.SetInput("IntermediateOut", {});
-    desc.SetInput("X", {});
+    // Only the grad of elementwise_mul reads X, which is linked to the fused
+    // op by ReLinkNodes.
+    if (ele_add_grad->Op()->Type() == "elementwise_mul_grad") {
+      desc.SetInput("X", ele_add_grad->Op()->Input("X"));
+    } else {
+      desc.SetInput("X", {});
+    }
     desc.SetInput("Y", std::vector<std::string>({ele_y_n}));
     desc.SetInput("Out", std::vector<std::string>({act_out_n}));
     desc.SetInput(GradVarName("Out"), std::vector<std::string>({d_act_out_n}));
@@ -27,7 +27,8 @@ namespace framework {
 namespace ir {
 
 /*
- * Fuse the ElewiseAdd and activation
+ * Fuse the ElewiseAdd and activation, and their backward. The ElewiseAdd
+ * could be replaced by ElewiseMul.
  */
 class FuseElewiseAddActPass : public FusePassBase {
  public:
@@ -37,13 +38,16 @@ class FuseElewiseAddActPass : public FusePassBase {
   void ApplyImpl(ir::Graph *graph) const override;
 
   ir::Graph *FuseElewiseAddAct(
-      ir::Graph *graph, const std::unordered_set<std::string> &act_types) const;
+      ir::Graph *graph, const std::unordered_set<std::string> &act_types,
+      const std::unordered_set<std::string> &binary_types) const;
 
   ir::Graph *FuseActElewiseAdd(
-      ir::Graph *graph, const std::unordered_set<std::string> &act_types) const;
+      ir::Graph *graph, const std::unordered_set<std::string> &act_types,
+      const std::unordered_set<std::string> &binary_types) const;
 
   ir::Graph *FuseElewiseAddActInplaceGrad(
-      ir::Graph *graph, const std::unordered_set<std::string> &act_types) const;
+      ir::Graph *graph, const std::unordered_set<std::string> &act_types,
+      const std::unordered_set<std::string> &binary_grad_types) const;
 
   /**
    * Remove the removable intermediate_out.
@@ -0,0 +1,91 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class FuseAdagradOpPass : public FuseOptimizerOpPass {
+ private:
+  virtual const std::string GetOpType() const { return "adagrad"; }
+
+  virtual const std::vector<std::string> GetAuxiliaryVarNames() const {
+    return {"Moment"};
+  }
+
+  // Fuse Adagrad Ops
+  virtual ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>> &vars_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &adagrad_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(
+        adagrad_ops.size(), static_cast<size_t>(0),
+        platform::errors::InvalidArgument("No adagrad op to be fused."));
+
+    // Check attributions
+    // NOTE: If new attribution is added, the following code maybe need change.
+    int op_role =
+        BOOST_GET_CONST(int, adagrad_ops[0]->Op()->GetAttr(
+                                 OpProtoAndCheckerMaker::OpRoleAttrName()));
+    float epsilon =
+        BOOST_GET_CONST(float, adagrad_ops[0]->Op()->GetAttr("epsilon"));
+
+    for (auto &adagrad_op : adagrad_ops) {
+      PADDLE_ENFORCE_EQ(
+          epsilon,
+          BOOST_GET_CONST(float, adagrad_op->Op()->GetAttr("epsilon")),
+          platform::errors::PreconditionNotMet(
+              "All adagrad ops should have the same epsilon."));
+      PADDLE_ENFORCE_EQ(
+          op_role,
+          BOOST_GET_CONST(int, adagrad_op->Op()->GetAttr(
+                                   OpProtoAndCheckerMaker::OpRoleAttrName())),
+          platform::errors::PreconditionNotMet(
+              "All adagrad ops should have the same op role."));
+    }
+
+    // NOTE: fused_var is only exist in scope, so the graph doesn't have
+    // fused_var node.
+
+    VLOG(6) << "Insert adagrad to graph ";
+    OpDesc adagrad_desc(adagrad_ops[0]->Op()->Block());
+    adagrad_desc.SetType("adagrad");
+    adagrad_desc.SetInput(kParam, {fused_vars_name.at(kParam)});
+    adagrad_desc.SetInput(kGrad, {fused_vars_name.at(kGrad)});
+    adagrad_desc.SetInput("Moment", {fused_vars_name.at("Moment")});
+    // TODO(zcd): The LearningRate should be equal.
+    adagrad_desc.SetInput(kLearningRate,
+                          adagrad_ops[0]->Op()->Input(kLearningRate));
+
+    adagrad_desc.SetOutput("ParamOut", {fused_vars_name.at(kParam)});
+    adagrad_desc.SetOutput("MomentOut", {fused_vars_name.at("Moment")});
+    adagrad_desc.SetAttr("epsilon", epsilon);
+    adagrad_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), op_role);
+
+    return graph->CreateOpNode(&adagrad_desc);
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_adagrad_op_pass, paddle::framework::ir::FuseAdagradOpPass);
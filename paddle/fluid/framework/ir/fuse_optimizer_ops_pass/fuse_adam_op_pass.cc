@@ -28,6 +28,10 @@ class FuseAdamOpPass : public FuseOptimizerOpPass {
  private:
   const std::string GetOpType() const { return "adam"; }
 
+  const std::string GetMultiTensorOpType() const {
+    return "multi_tensor_adam";
+  }
+
   const std::vector<std::string> GetAuxiliaryVarNames() const {
     return {"Moment1", "Moment2", "Beta1Pow", "Beta2Pow"};
   }
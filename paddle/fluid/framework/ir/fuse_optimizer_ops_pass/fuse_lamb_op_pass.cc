@@ -0,0 +1,145 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class FuseLambOpPass : public FuseOptimizerOpPass {
+ private:
+  virtual const std::string GetOpType() const { return "lamb"; }
+
+  // NOTE: Beta1Pow and Beta2Pow are not used by the lamb kernel, so they are
+  // not fused.
+  virtual const std::vector<std::string> GetAuxiliaryVarNames() const {
+    return {"Moment1", "Moment2"};
+  }
+
+  // Fuse Lamb Ops. The trust ratio of LAMB is layer-wise, so the fused op
+  // gets the number of elements and the weight decay of each parameter.
+  virtual ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>> &vars_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &lamb_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(
+        lamb_ops.size(), static_cast<size_t>(0),
+        platform::errors::InvalidArgument("No lamb op to be fused."));
+
+    // Check attributions
+    // NOTE: If new attribution is added, the following code maybe need change.
+    int op_role =
+        BOOST_GET_CONST(int, lamb_ops[0]->Op()->GetAttr(
+                                 OpProtoAndCheckerMaker::OpRoleAttrName()));
+    float beta1 = BOOST_GET_CONST(float, lamb_ops[0]->Op()->GetAttr("beta1"));
+    float beta2 = BOOST_GET_CONST(float, lamb_ops[0]->Op()->GetAttr("beta2"));
+    float epsilon =
+        BOOST_GET_CONST(float, lamb_ops[0]->Op()->GetAttr("epsilon"));
+
+    for (auto &lamb_op : lamb_ops) {
+      PADDLE_ENFORCE_EQ(
+          beta1, BOOST_GET_CONST(float, lamb_op->Op()->GetAttr("beta1")),
+          platform::errors::PreconditionNotMet(
+              "All lamb ops should have the same beta1."));
+      PADDLE_ENFORCE_EQ(
+          beta2, BOOST_GET_CONST(float, lamb_op->Op()->GetAttr("beta2")),
+          platform::errors::PreconditionNotMet(
+              "All lamb ops should have the same beta2."));
+      PADDLE_ENFORCE_EQ(
+          epsilon, BOOST_GET_CONST(float, lamb_op->Op()->GetAttr("epsilon")),
+          platform::errors::PreconditionNotMet(
+              "All lamb ops should have the same epsilon."));
+      PADDLE_ENFORCE_EQ(
+          op_role,
+          BOOST_GET_CONST(int, lamb_op->Op()->GetAttr(
+                                   OpProtoAndCheckerMaker::OpRoleAttrName())),
+          platform::errors::PreconditionNotMet(
+              "All lamb ops should have the same op role."));
+    }
+
+    // The ops are in the same order as the fused parameters.
+    auto &params = vars_set.at(kParam);
+    PADDLE_ENFORCE_EQ(params.size(), lamb_ops.size(),
+                      platform::errors::InvalidArgument(
+                          "The numbers of parameters (%d) and lamb ops (%d) "
+                          "should be the same.",
+                          params.size(), lamb_ops.size()));
+    std::vector<int64_t> param_numels;
+    std::vector<float> weight_decays;
+    for (size_t i = 0; i < lamb_ops.size(); ++i) {
+      param_numels.emplace_back(ParamNumel(lamb_ops[i], params[i]));
+      weight_decays.emplace_back(
+          BOOST_GET_CONST(float, lamb_ops[i]->Op()->GetAttr("weight_decay")));
+    }
+
+    // NOTE: fused_var is only exist in scope, so the graph doesn't have
+    // fused_var node.
+
+    VLOG(6) << "Insert lamb to graph ";
+    OpDesc lamb_desc(lamb_ops[0]->Op()->Block());
+    lamb_desc.SetType("lamb");
+    lamb_desc.SetInput(kParam, {fused_vars_name.at(kParam)});
+    lamb_desc.SetInput(kGrad, {fused_vars_name.at(kGrad)});
+    lamb_desc.SetInput("Moment1", {fused_vars_name.at("Moment1")});
+    lamb_desc.SetInput("Moment2", {fused_vars_name.at("Moment2")});
+    lamb_desc.SetInput("Beta1Pow", lamb_ops[0]->Op()->Input("Beta1Pow"));
+    lamb_desc.SetInput("Beta2Pow", lamb_ops[0]->Op()->Input("Beta2Pow"));
+    // TODO(zcd): The LearningRate should be equal.
+    lamb_desc.SetInput(kLearningRate, lamb_ops[0]->Op()->Input(kLearningRate));
+
+    lamb_desc.SetOutput("ParamOut", {fused_vars_name.at(kParam)});
+    lamb_desc.SetOutput("Moment1Out", {fused_vars_name.at("Moment1")});
+    lamb_desc.SetOutput("Moment2Out", {fused_vars_name.at("Moment2")});
+    lamb_desc.SetAttr("weight_decay", weight_decays[0]);
+    lamb_desc.SetAttr("beta1", beta1);
+    lamb_desc.SetAttr("beta2", beta2);
+    lamb_desc.SetAttr("epsilon", epsilon);
+    lamb_desc.SetAttr("fused_param_numels", param_numels);
+    lamb_desc.SetAttr("fused_weight_decays", weight_decays);
+    lamb_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), op_role);
+
+    return graph->CreateOpNode(&lamb_desc);
+  }
+
+  int64_t ParamNumel(ir::Node *lamb_op, const std::string &param) const {
+    for (auto *var : lamb_op->inputs) {
+      if (var->IsVar() && var->Var() && var->Name() == param) {
+        int64_t numel = 1;
+        for (auto dim : var->Var()->GetShape()) {
+          PADDLE_ENFORCE_GT(dim, 0,
+                            platform::errors::InvalidArgument(
+                                "The shape of the parameter %s should be "
+                                "known to fuse the lamb ops.",
+                                param));
+          numel *= dim;
+        }
+        return numel;
+      }
+    }
+    PADDLE_THROW(platform::errors::NotFound(
+        "The parameter %s is not found in the inputs of the lamb op.", param));
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_lamb_op_pass, paddle::framework::ir::FuseLambOpPass);
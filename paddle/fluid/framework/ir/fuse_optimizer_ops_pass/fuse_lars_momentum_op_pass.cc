@@ -0,0 +1,140 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class FuseLarsMomentumOpPass : public FuseOptimizerOpPass {
+ private:
+  virtual const std::string GetOpType() const { return "lars_momentum"; }
+
+  virtual const std::vector<std::string> GetAuxiliaryVarNames() const {
+    return {"Velocity"};
+  }
+
+  // Fuse Lars Momentum Ops. The local learning rate of LARS is layer-wise,
+  // so the fused op gets the number of elements of each parameter.
+  virtual ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>> &vars_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &lars_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(
+        lars_ops.size(), static_cast<size_t>(0),
+        platform::errors::InvalidArgument("No lars_momentum op to be fused."));
+
+    // Check attributions
+    // NOTE: If new attribution is added, the following code maybe need change.
+    int op_role =
+        BOOST_GET_CONST(int, lars_ops[0]->Op()->GetAttr(
+                                 OpProtoAndCheckerMaker::OpRoleAttrName()));
+    float mu = BOOST_GET_CONST(float, lars_ops[0]->Op()->GetAttr("mu"));
+    float lars_coeff =
+        BOOST_GET_CONST(float, lars_ops[0]->Op()->GetAttr("lars_coeff"));
+    float lars_weight_decay =
+        BOOST_GET_CONST(float, lars_ops[0]->Op()->GetAttr("lars_weight_decay"));
+
+    for (auto &lars_op : lars_ops) {
+      PADDLE_ENFORCE_EQ(
+          mu, BOOST_GET_CONST(float, lars_op->Op()->GetAttr("mu")),
+          platform::errors::PreconditionNotMet(
+              "All lars_momentum ops should have the same mu."));
+      PADDLE_ENFORCE_EQ(
+          lars_coeff,
+          BOOST_GET_CONST(float, lars_op->Op()->GetAttr("lars_coeff")),
+          platform::errors::PreconditionNotMet(
+              "All lars_momentum ops should have the same lars_coeff."));
+      PADDLE_ENFORCE_EQ(
+          lars_weight_decay,
+          BOOST_GET_CONST(float, lars_op->Op()->GetAttr("lars_weight_decay")),
+          platform::errors::PreconditionNotMet(
+              "All lars_momentum ops should have the same "
+              "lars_weight_decay."));
+      PADDLE_ENFORCE_EQ(
+          op_role,
+          BOOST_GET_CONST(int, lars_op->Op()->GetAttr(
+                                   OpProtoAndCheckerMaker::OpRoleAttrName())),
+          platform::errors::PreconditionNotMet(
+              "All lars_momentum ops should have the same op role."));
+    }
+
+    // The ops are in the same order as the fused parameters.
+    auto &params = vars_set.at(kParam);
+    PADDLE_ENFORCE_EQ(params.size(), lars_ops.size(),
+                      platform::errors::InvalidArgument(
+                          "The numbers of parameters (%d) and lars_momentum "
+                          "ops (%d) should be the same.",
+                          params.size(), lars_ops.size()));
+    std::vector<int64_t> param_numels;
+    for (size_t i = 0; i < lars_ops.size(); ++i) {
+      param_numels.emplace_back(ParamNumel(lars_ops[i], params[i]));
+    }
+
+    // NOTE: fused_var is only exist in scope, so the graph doesn't have
+    // fused_var node.
+
+    VLOG(6) << "Insert lars_momentum to graph ";
+    OpDesc lars_desc(lars_ops[0]->Op()->Block());
+    lars_desc.SetType("lars_momentum");
+    lars_desc.SetInput(kParam, {fused_vars_name.at(kParam)});
+    lars_desc.SetInput(kGrad, {fused_vars_name.at(kGrad)});
+    lars_desc.SetInput("Velocity", {fused_vars_name.at("Velocity")});
+    // TODO(zcd): The LearningRate should be equal.
+    lars_desc.SetInput(kLearningRate, lars_ops[0]->Op()->Input(kLearningRate));
+
+    lars_desc.SetOutput("ParamOut", {fused_vars_name.at(kParam)});
+    lars_desc.SetOutput("VelocityOut", {fused_vars_name.at("Velocity")});
+    lars_desc.SetAttr("mu", mu);
+    lars_desc.SetAttr("lars_coeff", lars_coeff);
+    lars_desc.SetAttr("lars_weight_decay", lars_weight_decay);
+    lars_desc.SetAttr("fused_param_numels", param_numels);
+    lars_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), op_role);
+
+    return graph->CreateOpNode(&lars_desc);
+  }
+
+  int64_t ParamNumel(ir::Node *lars_op, const std::string &param) const {
+    for (auto *var : lars_op->inputs) {
+      if (var->IsVar() && var->Var() && var->Name() == param) {
+        int64_t numel = 1;
+        for (auto dim : var->Var()->GetShape()) {
+          PADDLE_ENFORCE_GT(dim, 0,
+                            platform::errors::InvalidArgument(
+                                "The shape of the parameter %s should be "
+                                "known to fuse the lars_momentum ops.",
+                                param));
+          numel *= dim;
+        }
+        return numel;
+      }
+    }
+    PADDLE_THROW(platform::errors::NotFound(
+        "The parameter %s is not found in the inputs of the lars_momentum op.",
+        param));
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_lars_momentum_op_pass,
+              paddle::framework::ir::FuseLarsMomentumOpPass);
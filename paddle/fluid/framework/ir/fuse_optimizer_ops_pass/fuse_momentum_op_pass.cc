@@ -28,6 +28,10 @@ class FuseMomentumOpPass : public FuseOptimizerOpPass {
  private:
   virtual const std::string GetOpType() const { return "momentum"; }
 
+  virtual const std::string GetMultiTensorOpType() const {
+    return "multi_tensor_momentum";
+  }
+
   virtual const std::vector<std::string> GetAuxiliaryVarNames() const {
     return {"Velocity"};
   }
@@ -40,6 +40,12 @@ void FuseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
   // Note: Only take care about the dense gradients.
   for (auto &node : topo_nodes) {
     if (node->Op()->Type() == fuse_op_type) {
+      // NOTE: The op which only runs on some steps, e.g., the optimize op of
+      // gradient accumulation, is not fused.
+      if (node->Op()->HasAttr(details::kOpRunPeriodAttr)) {
+        ++opt_ops_num;
+        continue;
+      }
       auto grad_name = node->Op()->Input(kGrad);
       PADDLE_ENFORCE_EQ(grad_name.size(), static_cast<size_t>(1),
                         "The %s operator has multiple gradient input. Expected "
@@ -60,6 +66,9 @@ void FuseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
     auto &opt_type = result.Get<details::FusedOptType>(details::kFusedOptType);
     VLOG(6) << "Currently only support fusing one type of optimizer op, "
             << opt_type << " has been fused.";
+    if (!HasVarDepsBetweenOps(topo_nodes, opt_nodes)) {
+      FuseByMultiTensorOps(opt_nodes, graph);
+    }
     return;
   }
 
@@ -141,6 +150,7 @@ void FuseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
         // Note(chenweihang): Because the dtype of those gradients is not
         //   unified,so the number of fused gradients is more than one,
         //   but it is not supported currently.
+        FuseByMultiTensorOps(opt_nodes, graph);
         return;
       }
       auto &fused_vars = result.Get<details::FusedVars>(details::kFusedVars);
@@ -172,6 +182,7 @@ void FuseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
       if (fusing_var_dtype != GetDtypeOfVar(vars_info, var_name)) {
         // Note(chenweihang): Currently the fuse_optimizer_ops strategy
         //   in mixed precision scenarios is not yet supported.
+        FuseByMultiTensorOps(opt_nodes, graph);
         return;
       }
     }
@@ -184,6 +195,7 @@ void FuseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
       // Note(chenweihang): Currently the fuse_optimizer_ops strategy is risky
       //   when gradient generated operator with kernel just support CPU or
       //   GPU device, so close it.
+      FuseByMultiTensorOps(opt_nodes, graph);
       return;
     }
   }
@@ -216,6 +228,108 @@ void FuseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
   }
 }
 
+void FuseOptimizerOpPass::FuseByMultiTensorOps(
+    const std::vector<Node *> &opt_nodes, ir::Graph *graph) const {
+  const std::string multi_tensor_op_type = GetMultiTensorOpType();
+  if (multi_tensor_op_type.empty()) return;
+  auto vars_info = GetVarInfo(*graph);
+  const auto &attr_protos =
+      OpInfoMap::Instance().Get(multi_tensor_op_type).Proto().attrs();
+  const std::unordered_set<std::string> skipped_attrs = {
+      OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+      OpProtoAndCheckerMaker::OpNamescopeAttrName(),
+      OpProtoAndCheckerMaker::OpCreationCallstackAttrName()};
+
+  // Every input and output except LearningRate has one variable per op, all
+  // in the same dtype, and the optional inputs are not set.
+  auto can_fuse = [&](const OpDesc &op) -> bool {
+    auto dtype = GetDtypeOfVar(vars_info, op.Input(kParam)[0]);
+    for (auto &in : op.Inputs()) {
+      if (in.first == kLearningRate) continue;
+      if (in.second.size() != 1 ||
+          GetDtypeOfVar(vars_info, in.second[0]) != dtype) {
+        return false;
+      }
+    }
+    for (auto &out : op.Outputs()) {
+      if (out.second.size() != 1) return false;
+    }
+    return true;
+  };
+  // The ops sharing the learning rate, the dtype and the attributes are
+  // updated by the same multi-tensor op.
+  auto same_group = [&](const OpDesc &op, const OpDesc &first) -> bool {
+    if (op.Input(kLearningRate) != first.Input(kLearningRate) ||
+        GetDtypeOfVar(vars_info, op.Input(kParam)[0]) !=
+            GetDtypeOfVar(vars_info, first.Input(kParam)[0])) {
+      return false;
+    }
+    for (auto &attr : attr_protos) {
+      if (skipped_attrs.count(attr.name())) continue;
+      if (op.HasAttr(attr.name()) != first.HasAttr(attr.name()) ||
+          (op.HasAttr(attr.name()) &&
+           !(op.GetAttr(attr.name()) == first.GetAttr(attr.name())))) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<std::vector<Node *>> groups;
+  for (auto *node : opt_nodes) {
+    if (!can_fuse(*node->Op())) continue;
+    auto iter = std::find_if(groups.begin(), groups.end(),
+                             [&](const std::vector<Node *> &group) {
+                               return same_group(*node->Op(),
+                                                 *group.front()->Op());
+                             });
+    if (iter == groups.end()) {
+      groups.emplace_back(std::vector<Node *>{node});
+    } else {
+      iter->emplace_back(node);
+    }
+  }
+
+  for (auto &group : groups) {
+    if (group.size() <= 1) continue;
+    VLOG(6) << "Update " << group.size() << " " << GetOpType()
+            << " operators by " << multi_tensor_op_type << ".";
+    const OpDesc &first = *group.front()->Op();
+    OpDesc desc(group.front()->Op()->Block());
+    desc.SetType(multi_tensor_op_type);
+    for (auto &in : first.Inputs()) {
+      if (in.first == kLearningRate) {
+        desc.SetInput(in.first, in.second);
+        continue;
+      }
+      std::vector<std::string> args;
+      for (auto *node : group) {
+        args.emplace_back(node->Op()->Input(in.first)[0]);
+      }
+      desc.SetInput(in.first, args);
+    }
+    for (auto &out : first.Outputs()) {
+      std::vector<std::string> args;
+      for (auto *node : group) {
+        args.emplace_back(node->Op()->Output(out.first)[0]);
+      }
+      desc.SetOutput(out.first, args);
+    }
+    for (auto &attr : attr_protos) {
+      if (skipped_attrs.count(attr.name()) || !first.HasAttr(attr.name())) {
+        continue;
+      }
+      desc.SetAttr(attr.name(), first.GetAttr(attr.name()));
+    }
+
+    auto *multi_tensor_node = graph->CreateOpNode(&desc);
+    InsertInputAndOutputForFusedOpNode(group, graph, multi_tensor_node);
+    for (auto *node : group) {
+      graph->RemoveNode(node);
+    }
+  }
+}
+
 bool FuseOptimizerOpPass::HasVarDepsBetweenOps(
     const std::vector<Node *> &topo_nodes,
     const std::vector<Node *> &opt_nodes) const {
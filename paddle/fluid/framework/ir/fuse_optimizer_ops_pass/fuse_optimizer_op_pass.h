@@ -48,6 +48,14 @@ class FuseOptimizerOpPass : public ir::Pass {
  private:
   virtual const std::string GetOpType() const = 0;
 
+  // The op which updates a list of parameters that are not coalesced into
+  // a continuous space by one kernel launch, it is used when the optimizer
+  // ops can not be fused. Empty if the optimizer has no such op.
+  virtual const std::string GetMultiTensorOpType() const { return ""; }
+
+  void FuseByMultiTensorOps(const std::vector<ir::Node *> &opt_nodes,
+                            ir::Graph *graph) const;
+
   virtual const std::vector<std::string> GetAuxiliaryVarNames() const = 0;
 
   virtual ir::Node *FuseOptimizerOps(
@@ -0,0 +1,117 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class FuseRMSPropOpPass : public FuseOptimizerOpPass {
+ private:
+  virtual const std::string GetOpType() const { return "rmsprop"; }
+
+  virtual const std::vector<std::string> GetAuxiliaryVarNames() const {
+    return {"Moment", "MeanSquare", "MeanGrad"};
+  }
+
+  // Fuse RMSProp Ops
+  virtual ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>> &vars_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &rmsprop_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(
+        rmsprop_ops.size(), static_cast<size_t>(0),
+        platform::errors::InvalidArgument("No rmsprop op to be fused."));
+
+    // Check attributions
+    // NOTE: If new attribution is added, the following code maybe need change.
+    int op_role =
+        BOOST_GET_CONST(int, rmsprop_ops[0]->Op()->GetAttr(
+                                 OpProtoAndCheckerMaker::OpRoleAttrName()));
+    float epsilon =
+        BOOST_GET_CONST(float, rmsprop_ops[0]->Op()->GetAttr("epsilon"));
+    float decay = BOOST_GET_CONST(float, rmsprop_ops[0]->Op()->GetAttr("decay"));
+    float momentum =
+        BOOST_GET_CONST(float, rmsprop_ops[0]->Op()->GetAttr("momentum"));
+    bool centered =
+        BOOST_GET_CONST(bool, rmsprop_ops[0]->Op()->GetAttr("centered"));
+
+    for (auto &rmsprop_op : rmsprop_ops) {
+      PADDLE_ENFORCE_EQ(
+          epsilon,
+          BOOST_GET_CONST(float, rmsprop_op->Op()->GetAttr("epsilon")),
+          platform::errors::PreconditionNotMet(
+              "All rmsprop ops should have the same epsilon."));
+      PADDLE_ENFORCE_EQ(
+          decay, BOOST_GET_CONST(float, rmsprop_op->Op()->GetAttr("decay")),
+          platform::errors::PreconditionNotMet(
+              "All rmsprop ops should have the same decay."));
+      PADDLE_ENFORCE_EQ(
+          momentum,
+          BOOST_GET_CONST(float, rmsprop_op->Op()->GetAttr("momentum")),
+          platform::errors::PreconditionNotMet(
+              "All rmsprop ops should have the same momentum."));
+      PADDLE_ENFORCE_EQ(
+          centered,
+          BOOST_GET_CONST(bool, rmsprop_op->Op()->GetAttr("centered")),
+          platform::errors::PreconditionNotMet(
+              "All rmsprop ops should have the same centered."));
+      PADDLE_ENFORCE_EQ(
+          op_role,
+          BOOST_GET_CONST(int, rmsprop_op->Op()->GetAttr(
+                                   OpProtoAndCheckerMaker::OpRoleAttrName())),
+          platform::errors::PreconditionNotMet(
+              "All rmsprop ops should have the same op role."));
+    }
+
+    // NOTE: fused_var is only exist in scope, so the graph doesn't have
+    // fused_var node.
+
+    VLOG(6) << "Insert rmsprop to graph ";
+    OpDesc rmsprop_desc(rmsprop_ops[0]->Op()->Block());
+    rmsprop_desc.SetType("rmsprop");
+    rmsprop_desc.SetInput(kParam, {fused_vars_name.at(kParam)});
+    rmsprop_desc.SetInput(kGrad, {fused_vars_name.at(kGrad)});
+    rmsprop_desc.SetInput("Moment", {fused_vars_name.at("Moment")});
+    rmsprop_desc.SetInput("MeanSquare", {fused_vars_name.at("MeanSquare")});
+    rmsprop_desc.SetInput("MeanGrad", {fused_vars_name.at("MeanGrad")});
+    // TODO(zcd): The LearningRate should be equal.
+    rmsprop_desc.SetInput(kLearningRate,
+                          rmsprop_ops[0]->Op()->Input(kLearningRate));
+
+    rmsprop_desc.SetOutput("ParamOut", {fused_vars_name.at(kParam)});
+    rmsprop_desc.SetOutput("MomentOut", {fused_vars_name.at("Moment")});
+    rmsprop_desc.SetOutput("MeanSquareOut", {fused_vars_name.at("MeanSquare")});
+    rmsprop_desc.SetOutput("MeanGradOut", {fused_vars_name.at("MeanGrad")});
+    rmsprop_desc.SetAttr("epsilon", epsilon);
+    rmsprop_desc.SetAttr("decay", decay);
+    rmsprop_desc.SetAttr("momentum", momentum);
+    rmsprop_desc.SetAttr("centered", centered);
+    rmsprop_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), op_role);
+
+    return graph->CreateOpNode(&rmsprop_desc);
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_rmsprop_op_pass, paddle::framework::ir::FuseRMSPropOpPass);
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
+#include <algorithm>
 #include <sstream>
 #include <unordered_set>
 #include "paddle/fluid/framework/ir/fusion_group/code_generator_helper.h"
@@ -45,16 +46,30 @@ std::string ExtractDataType(const std::vector<Node*>& nodes) {
   return dtype_str;
 }
 
-CodeGenerator::CodeGenerator() {
-  // Only support elementwise operations now.
-  code_templates_.resize(1);
+CodeGenerator::CodeGenerator(bool use_cpu) : use_cpu_(use_cpu) {
+  // Support elementwise operations, and the rowwise operations with
+  // broadcasts and reductions over the last axis. Only the elementwise
+  // operations are supported on CPU.
+  code_templates_.resize(2);
 
-  CodeTemplate elementwise_t(cuda_kernel_template_1d);
+  CodeTemplate elementwise_t(use_cpu ? cpu_kernel_template_1d
+                                     : cuda_kernel_template_1d);
   code_templates_[0] = elementwise_t;
+
+  CodeTemplate rowwise_t(cuda_kernel_template_rowwise);
+  code_templates_[1] = rowwise_t;
 }
 
 std::string CodeGenerator::Generate(SubGraph* subgraph) {
   std::vector<OperationExpression> expressions = ConvertToExpressions(subgraph);
+  if (subgraph->GetType() == 1) {
+    std::unordered_map<int, int> layouts;
+    for (auto& iter : EncodeVarNodes(subgraph)) {
+      layouts[iter.second] = subgraph->GetLayout(iter.first);
+    }
+    return GenerateRowwise(subgraph->GetFuncName(), subgraph->GetCols(),
+                           expressions, layouts);
+  }
   return Generate(subgraph->GetFuncName(), expressions);
 }
 
@@ -138,6 +153,26 @@ std::vector<OperationExpression> CodeGenerator::ConvertToExpressions(
   return expressions;
 }
 
+static std::string EmitPredefinedFunctions(
+    const std::unordered_map<int, std::string>& dtypes) {
+  std::set<std::string> all_dtype;
+  for (const auto& type : dtypes) {
+    all_dtype.insert(type.second);
+  }
+  std::string predefined_cuda_functions = "";
+  if (all_dtype.find("float") != all_dtype.end() &&
+      all_dtype.find("__half") == all_dtype.end()) {
+    predefined_cuda_functions += predefined_cuda_functions_fp32;
+  }
+  if (all_dtype.find("double") != all_dtype.end()) {
+    predefined_cuda_functions += predefined_cuda_functions_fp64;
+  }
+  if (all_dtype.find("__half") != all_dtype.end()) {
+    predefined_cuda_functions += predefined_cuda_functions_fp16;
+  }
+  return predefined_cuda_functions;
+}
+
 // In order to get the right result of expression, we need to calculate and
 // store the expression as suffix Expressions using vector.
 std::string CodeGenerator::Generate(
@@ -152,28 +187,52 @@ std::string CodeGenerator::Generate(
       std::move(DistilDtypes(expressions));
   TemplateVariable template_var;
   template_var.Add("func_name", func_name);
-  template_var.Add("parameters", EmitParameters(input_ids, output_ids,
-                                                intermediate_ids, dtypes));
+  template_var.Add(
+      "parameters",
+      use_cpu_
+          ? EmitCPUParameters(input_ids, output_ids, intermediate_ids, dtypes)
+          : EmitParameters(input_ids, output_ids, intermediate_ids, dtypes));
   template_var.Add("compute_body",
                    EmitComputeBody(expressions, input_ids, output_ids,
                                    intermediate_ids, dtypes));
+  std::string predefined_functions =
+      use_cpu_ ? predefined_cpu_functions : EmitPredefinedFunctions(dtypes);
+  return predefined_functions + code_templates_[0].Format(template_var);
+}
 
-  std::set<std::string> all_dtype;
+std::string CodeGenerator::GenerateRowwise(
+    std::string func_name, int64_t cols,
+    const std::vector<OperationExpression>& expressions,
+    const std::unordered_map<int, int>& layouts) {
+  PADDLE_ENFORCE_EQ(use_cpu_, false,
+                    platform::errors::Unimplemented(
+                        "The rowwise kernel is not supported on CPU."));
+  std::set<int> input_ids = std::move(DistilInputIds(expressions));
+  std::set<int> output_ids = std::move(DistilOutputIds(expressions));
+  std::set<int> intermediate_ids =
+      std::move(DistilIntermediateIds(expressions));
+  std::unordered_map<int, std::string> dtypes =
+      std::move(DistilDtypes(expressions));
+  // The reductions are accumulated in float for float16.
+  std::string acc_type = "float";
   for (const auto& type : dtypes) {
-    all_dtype.insert(type.second);
-  }
-  std::string predefined_cuda_functions = "";
-  if (all_dtype.find("float") != all_dtype.end() &&
-      all_dtype.find("__half") == all_dtype.end()) {
-    predefined_cuda_functions += predefined_cuda_functions_fp32;
-  }
-  if (all_dtype.find("double") != all_dtype.end()) {
-    predefined_cuda_functions += predefined_cuda_functions_fp64;
-  }
-  if (all_dtype.find("__half") != all_dtype.end()) {
-    predefined_cuda_functions += predefined_cuda_functions_fp16;
+    if (type.second == "double") {
+      acc_type = "double";
+    }
   }
-  return predefined_cuda_functions + code_templates_[0].Format(template_var);
+  TemplateVariable template_var;
+  template_var.Add("func_name", func_name);
+  template_var.Add("parameters", EmitParameters(input_ids, output_ids,
+                                                intermediate_ids, dtypes));
+  template_var.Add("compute_body",
+                   EmitRowwiseComputeBody(expressions, input_ids, output_ids,
+                                          intermediate_ids, dtypes, layouts,
+                                          acc_type));
+  template_var.Add("cols", std::to_string(cols));
+  template_var.Add("acc_type", acc_type);
+  return EmitPredefinedFunctions(dtypes) +
+         predefined_cuda_functions_block_reduce +
+         code_templates_[1].Format(template_var);
 }
 
 std::set<int> CodeGenerator::DistilInputIds(
@@ -283,6 +342,33 @@ std::string CodeGenerator::EmitParameters(
   return ret.str();
 }
 
+// The arguments are passed by the pointers to them, in the same order as
+// EmitParameters.
+std::string CodeGenerator::EmitCPUParameters(
+    const std::set<int>& input_ids, const std::set<int>& output_ids,
+    const std::set<int>& intermediate_ids,
+    const std::unordered_map<int, std::string>& dtypes) const {
+  std::stringstream ret;
+  int index = 0;
+  ret << "int N = static_cast<int>(*static_cast<size_t*>(args[" << index++
+      << "]));";
+  for (auto id : input_ids) {
+    if (output_ids.find(id) == output_ids.end()) {
+      ret << "const " << dtypes.at(id) << "* __restrict__ " << ArgName(id)
+          << " = *static_cast<const " << dtypes.at(id) << "**>(args["
+          << index++ << "]);";
+    }
+  }
+  for (auto id : output_ids) {
+    if (intermediate_ids.find(id) == intermediate_ids.end()) {
+      ret << dtypes.at(id) << "* __restrict__ " << ArgName(id)
+          << " = *static_cast<" << dtypes.at(id) << "**>(args[" << index++
+          << "]);";
+    }
+  }
+  return ret.str();
+}
+
 std::string CodeGenerator::EmitComputeBody(
     const std::vector<OperationExpression>& expressions,
     const std::set<int>& input_ids, const std::set<int>& output_ids,
@@ -300,9 +386,14 @@ std::string CodeGenerator::EmitComputeBody(
   for (auto id : input_ids) {
     if (output_ids.find(id) == output_ids.end() &&
         used.find(id) != used.end()) {
-      load << dtypes.at(id) << " " << TmpName(id) << " = "
-           << "__ldg(&" << VarName(id) << ")"
-           << ";";
+      if (use_cpu_) {
+        load << dtypes.at(id) << " " << TmpName(id) << " = " << VarName(id)
+             << ";";
+      } else {
+        load << dtypes.at(id) << " " << TmpName(id) << " = "
+             << "__ldg(&" << VarName(id) << ")"
+             << ";";
+      }
     }
   }
   // Store temporal variables to memory.
@@ -316,6 +407,139 @@ std::string CodeGenerator::EmitComputeBody(
   return load.str() + compute.str() + store.str();
 }
 
+static bool IsReduction(const OperationExpression& expression) {
+  return OperationMap::Instance().Get(expression.GetOpType()).type == 1;
+}
+
+static std::string Cast(const std::string& from_type,
+                        const std::string& to_type, const std::string& value) {
+  if (from_type == to_type) {
+    return value;
+  } else if (from_type == "__half") {
+    return "__half2float(" + value + ")";
+  } else if (to_type == "__half") {
+    return "__float2half(" + value + ")";
+  }
+  return "static_cast<" + to_type + ">(" + value + ")";
+}
+
+// Get the non-reduction expressions before end which are needed to compute
+// the ids. The outputs of the reductions are computed once for each row.
+static std::vector<size_t> GetNeededExpressions(
+    const std::vector<OperationExpression>& expressions, size_t end,
+    std::unordered_set<int> ids) {
+  std::vector<size_t> needed;
+  for (size_t i = end; i > 0; --i) {
+    const auto& expression = expressions[i - 1];
+    if (IsReduction(expression)) {
+      continue;
+    }
+    bool is_needed = false;
+    for (auto id : expression.GetOutputIds()) {
+      is_needed |= ids.find(id) != ids.end();
+    }
+    if (is_needed) {
+      needed.push_back(i - 1);
+      for (auto id : expression.GetInputIds()) {
+        ids.insert(id);
+      }
+    }
+  }
+  std::reverse(needed.begin(), needed.end());
+  return needed;
+}
+
+std::string CodeGenerator::EmitRowwiseComputeBody(
+    const std::vector<OperationExpression>& expressions,
+    const std::set<int>& input_ids, const std::set<int>& output_ids,
+    const std::set<int>& intermediate_ids,
+    const std::unordered_map<int, std::string>& dtypes,
+    const std::unordered_map<int, int>& layouts,
+    const std::string& acc_type) const {
+  // Loop over the columns of a row, computing the needed expressions and
+  // then the tail.
+  auto emit_loop = [&](const std::vector<size_t>& needed, int tail_input_id,
+                       const std::string& tail) -> std::string {
+    std::ostringstream compute;
+    std::unordered_set<int> used;
+    if (tail_input_id >= 0) {
+      used.insert(tail_input_id);
+    }
+    for (auto i : needed) {
+      VLOG(3) << DebugString(expressions[i]);
+      compute << expressions[i].GetExpression(&used);
+    }
+
+    // Load input to temporal variables, according to its layout.
+    std::ostringstream load;
+    for (auto id : input_ids) {
+      if (output_ids.find(id) == output_ids.end() &&
+          used.find(id) != used.end()) {
+        int layout = layouts.at(id);
+        std::string index =
+            layout == kFull ? "idx" : (layout == kCol ? "col" : "row");
+        load << dtypes.at(id) << " " << TmpName(id) << " = __ldg(&"
+             << ArgName(id) << "[" << index << "]);";
+      }
+    }
+    return "for(int col = threadIdx.x; col < cols; col += blockDim.x) {"
+           "int idx = row * cols + col;" +
+           load.str() + compute.str() + tail + "}";
+  };
+
+  std::ostringstream body;
+  std::unordered_set<int> reduction_out_ids;
+  for (size_t i = 0; i < expressions.size(); ++i) {
+    if (!IsReduction(expressions[i])) {
+      continue;
+    }
+    VLOG(3) << DebugString(expressions[i]);
+    int in_id = expressions[i].GetInputIds()[0];
+    int out_id = expressions[i].GetOutputIds()[0];
+    reduction_out_ids.insert(out_id);
+
+    std::string sum = "sum" + std::to_string(out_id);
+    body << acc_type << " " << sum << " = 0;";
+    body << emit_loop(GetNeededExpressions(expressions, i, {in_id}), in_id,
+                      sum + " += " +
+                          Cast(dtypes.at(in_id), acc_type, TmpName(in_id)) +
+                          ";");
+    std::string value = "BlockReduceSum(" + sum + ", shared)";
+    if (expressions[i].GetOpType() == "reduce_mean") {
+      value = "(" + value + " / cols)";
+    }
+    body << dtypes.at(out_id) << " " << TmpName(out_id) << " = "
+         << Cast(acc_type, dtypes.at(out_id), value) << ";";
+    if (intermediate_ids.find(out_id) == intermediate_ids.end()) {
+      body << "if (threadIdx.x == 0) " << ArgName(out_id)
+           << "[row] = " << TmpName(out_id) << ";";
+    }
+  }
+
+  // Store temporal variables to memory, and the vars broadcast along the
+  // rows are stored once for each row.
+  std::unordered_set<int> store_ids;
+  std::ostringstream store;
+  for (auto id : output_ids) {
+    if (intermediate_ids.find(id) == intermediate_ids.end() &&
+        reduction_out_ids.find(id) == reduction_out_ids.end()) {
+      store_ids.insert(id);
+      if (layouts.at(id) == kFull) {
+        store << ArgName(id) << "[idx] = " << TmpName(id) << ";";
+      } else {
+        store << "if (col == 0) " << ArgName(id) << "[row] = " << TmpName(id)
+              << ";";
+      }
+    }
+  }
+  if (!store_ids.empty()) {
+    body << emit_loop(
+        GetNeededExpressions(expressions, expressions.size(), store_ids), -1,
+        store.str());
+  }
+  return body.str();
+}
+
 std::unordered_map<std::string, int> CodeGenerator::EncodeVarNodes(
     SubGraph* subgraph) {
   const auto& input_var_nodes = subgraph->GetInputVarNodes();
@@ -29,11 +29,19 @@ namespace fusion_group {
 
 class CodeGenerator {
  public:
-  CodeGenerator();
+  // Generate the C++ kernels for CPU if use_cpu is true.
+  explicit CodeGenerator(bool use_cpu = false);
 
   std::string Generate(std::string func_name,
                        const std::vector<OperationExpression>& expressions);
 
+  // Generate the kernel of type 1, in which each block computes the rows of
+  // cols elements, and the layouts of the vars are indexed by the ids.
+  std::string GenerateRowwise(
+      std::string func_name, int64_t cols,
+      const std::vector<OperationExpression>& expressions,
+      const std::unordered_map<int, int>& layouts);
+
   std::string Generate(SubGraph* subgraph);
 
   std::vector<OperationExpression> ConvertToExpressions(SubGraph* subgraph);
@@ -53,6 +61,10 @@ class CodeGenerator {
       const std::set<int>& input_ids, const std::set<int>& output_ids,
       const std::set<int>& intermediate_ids,
       const std::unordered_map<int, std::string>& dtypes) const;
+  std::string EmitCPUParameters(
+      const std::set<int>& input_ids, const std::set<int>& output_ids,
+      const std::set<int>& intermediate_ids,
+      const std::unordered_map<int, std::string>& dtypes) const;
 
   std::string EmitComputeBody(
       const std::vector<OperationExpression>& expressions,
@@ -60,10 +72,19 @@ class CodeGenerator {
       const std::set<int>& intermediate_ids,
       const std::unordered_map<int, std::string>& dtypes) const;
 
+  std::string EmitRowwiseComputeBody(
+      const std::vector<OperationExpression>& expressions,
+      const std::set<int>& input_ids, const std::set<int>& output_ids,
+      const std::set<int>& intermediate_ids,
+      const std::unordered_map<int, std::string>& dtypes,
+      const std::unordered_map<int, int>& layouts,
+      const std::string& acc_type) const;
+
   // Encode all var nodes in the subgraph with an unique number.
   std::unordered_map<std::string, int> EncodeVarNodes(SubGraph* subgraph);
 
  private:
+  bool use_cpu_{false};
   std::vector<CodeTemplate> code_templates_;
 };
 
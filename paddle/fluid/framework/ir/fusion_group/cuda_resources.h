@@ -316,6 +316,67 @@ extern "C" __global__ void $func_name($parameters) {
   }
 }
 )";
+
+// The C++ functions of the kernels compiled for CPU.
+static constexpr char predefined_cpu_functions[] = R"(
+#include <cmath>
+#include <cstddef>
+
+inline float Max(float x, float y) { return std::fmax(x, y); }
+inline float Exp(float x) { return std::exp(x); }
+inline float Log(float x) { return std::log(x); }
+inline float Sqrt(float x) { return std::sqrt(x); }
+
+inline double Max(double x, double y) { return std::fmax(x, y); }
+inline double Exp(double x) { return std::exp(x); }
+inline double Log(double x) { return std::log(x); }
+inline double Sqrt(double x) { return std::sqrt(x); }
+
+)";
+
+// The args are the pointers to the arguments, the same as the CUDA kernels.
+// The loop is vectorized, and split to the threads when it is long enough.
+static constexpr char cpu_kernel_template_1d[] = R"(
+extern "C" void $func_name(void** args) {
+  $parameters
+#pragma omp parallel for simd if(N >= 16384)
+  for(int idx = 0; idx < N; ++idx) {
+    $compute_body
+  }
+}
+)";
+
+// The number of threads in a block should be a power of 2, and no more than
+// 1024.
+static constexpr char predefined_cuda_functions_block_reduce[] = R"(
+template <typename T>
+__device__ T BlockReduceSum(T val, T* shared) {
+  int tid = threadIdx.x;
+  __syncthreads();
+  shared[tid] = val;
+  __syncthreads();
+  for (int s = blockDim.x / 2; s > 0; s >>= 1) {
+    if (tid < s) {
+      shared[tid] += shared[tid + s];
+    }
+    __syncthreads();
+  }
+  return shared[0];
+}
+
+)";
+
+// Each block computes a row of cols elements at a time.
+static constexpr char cuda_kernel_template_rowwise[] = R"(
+extern "C" __global__ void $func_name($parameters) {
+  __shared__ $acc_type shared[1024];
+  int cols = $cols;
+  int rows = N / cols;
+  for(int row = blockIdx.x; row < rows; row += gridDim.x) {
+    $compute_body
+  }
+}
+)";
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
@@ -25,6 +25,7 @@ namespace ir {
 namespace fusion_group {
 
 static std::unordered_set<std::string> elementwise_op_types;
+static std::unordered_set<std::string> reduction_op_types;
 
 static std::unordered_set<std::string>& GetElementwiseOpTypes() {
   if (elementwise_op_types.empty()) {
@@ -33,6 +34,13 @@ static std::unordered_set<std::string>& GetElementwiseOpTypes() {
   return elementwise_op_types;
 }
 
+static std::unordered_set<std::string>& GetReductionOpTypes() {
+  if (reduction_op_types.empty()) {
+    reduction_op_types = OperationMap::Instance().Find(/* type= */ 1);
+  }
+  return reduction_op_types;
+}
+
 static bool IsSpecifiedOp(const std::unordered_set<std::string>& op_types,
                           const Node* n) {
   if (n && n->IsOp() && n->Op() && n->outputs.size() > 0U) {
@@ -60,6 +68,65 @@ static bool IsEqualAndNotEmpty(const std::vector<int64_t>& l,
   return l.size() != 0U && r.size() != 0U && l == r;
 }
 
+// Return the var node of the first argument of the op's input.
+static const Node* GetInputVar(const Node* n, const std::string& name) {
+  auto& inputs = n->Op()->Inputs();
+  auto iter = inputs.find(name);
+  if (iter == inputs.end() || iter->second.empty()) {
+    return nullptr;
+  }
+  for (auto* in : n->inputs) {
+    if (in && in->IsVar() && in->Var() && in->Name() == iter->second[0]) {
+      return in;
+    }
+  }
+  return nullptr;
+}
+
+static std::vector<int64_t> GetShape(const Node* n) {
+  return n && n->Var() ? n->Var()->GetShape() : std::vector<int64_t>();
+}
+
+static bool IsReductionOverLastAxis(const Node* n) {
+  auto* op = n->Op();
+  std::vector<int64_t> x_shape = GetShape(GetInputVar(n, "X"));
+  if (x_shape.size() == 0U || x_shape.back() <= 1 ||
+      op->GetAttrIfExists<bool>("reduce_all")) {
+    return false;
+  }
+  int rank = static_cast<int>(x_shape.size());
+  auto dims = op->GetAttrIfExists<std::vector<int>>("dim");
+  return dims.size() == 1U && (dims[0] == -1 || dims[0] == rank - 1);
+}
+
+// Get the layout of a var in the rowwise subgraph whose full vars are in
+// full_shape, or -1 if the var cannot be viewed in any layout.
+static int GetRowwiseLayout(const std::vector<int64_t>& shape,
+                            const std::vector<int64_t>& full_shape) {
+  std::vector<int64_t> row_shape(full_shape);
+  row_shape.back() = 1;
+  std::vector<int64_t> squeezed_row_shape(full_shape.begin(),
+                                          full_shape.end() - 1);
+  if (shape.size() == 0U) {
+    return -1;
+  } else if (shape == full_shape) {
+    return kFull;
+  } else if (shape == row_shape) {
+    return kRow;
+  } else if (shape == squeezed_row_shape) {
+    return kSqueezedRow;
+  } else if (shape.size() <= full_shape.size() &&
+             shape.back() == full_shape.back()) {
+    for (size_t i = 0; i + 1 < shape.size(); ++i) {
+      if (shape[i] != 1) {
+        return -1;
+      }
+    }
+    return kCol;
+  }
+  return -1;
+}
+
 bool GroupDetector::CheckPrecondition(const Node* n) {
   auto check_data_type = [&](const std::vector<Node*>& nodes) -> bool {
     bool is_first = true;
@@ -73,7 +140,7 @@ bool GroupDetector::CheckPrecondition(const Node* n) {
         proto::VarType::Type data_type_i = n->Var()->GetDataType();
         if (data_type_i == proto::VarType::FP32 ||
             data_type_i == proto::VarType::FP64 ||
-            data_type_i == proto::VarType::FP16) {
+            (use_gpu_ && data_type_i == proto::VarType::FP16)) {
           if (is_first) {
             data_type_0 = data_type_i;
             is_first = false;
@@ -104,7 +171,8 @@ bool GroupDetector::CheckPrecondition(const Node* n) {
     return false;
   };
 
-  return n && n->IsOp() && n->Op() && !check_running_on_cpu(n) &&
+  return n && n->IsOp() && n->Op() &&
+         (!use_gpu_ || !check_running_on_cpu(n)) &&
          check_data_type(n->inputs) && check_data_type(n->outputs);
 }
 
@@ -148,6 +216,153 @@ std::vector<std::vector<Node*>> ElementwiseGroupDetector::operator()(
   return SubgraphDetector(graph, teller)();
 }
 
+bool RowwiseGroupDetector::IsRowwiseOp(const Node* n) {
+  if (IsSpecifiedOp(GetReductionOpTypes(), n)) {
+    return !IsGradOp(n) && IsReductionOverLastAxis(n);
+  }
+  if (!IsSpecifiedOp(GetElementwiseOpTypes(), n) || IsGradOp(n)) {
+    return false;
+  }
+  auto op = n->Op();
+  std::vector<std::string> output_names =
+      OperationMap::Instance().Get(op->Type()).output_names;
+  for (auto& name : output_names) {
+    if (op->Output(name).size() < 1U) {
+      return false;
+    }
+  }
+
+  bool is_first = true;
+  bool is_same_shape = true;
+  std::vector<int64_t> shape_0;
+  for (auto* in_i : n->inputs) {
+    if (in_i && in_i->IsVar() && in_i->Var()) {
+      std::vector<int64_t> shape_i = in_i->Var()->GetShape();
+      if (is_first) {
+        shape_0 = shape_i;
+        is_first = false;
+      } else if (!IsEqualAndNotEmpty(shape_0, shape_i)) {
+        is_same_shape = false;
+      }
+    }
+  }
+  if (is_same_shape) {
+    return true;
+  }
+
+  // Y of the binary operations is broadcast to X, along the rows or the
+  // columns.
+  std::vector<int64_t> x_shape = GetShape(GetInputVar(n, "X"));
+  std::vector<int64_t> y_shape = GetShape(GetInputVar(n, "Y"));
+  if (x_shape.size() == 0U || y_shape.size() == 0U || x_shape.back() <= 1) {
+    return false;
+  }
+  int x_rank = static_cast<int>(x_shape.size());
+  int y_rank = static_cast<int>(y_shape.size());
+  int axis = op->HasAttr("axis") ? op->GetAttrIfExists<int>("axis") : -1;
+  switch (GetRowwiseLayout(y_shape, x_shape)) {
+    case kCol:
+      return axis == -1 || axis == x_rank - y_rank;
+    case kRow:
+      return axis == -1 || axis == 0;
+    case kSqueezedRow:
+      return axis == 0;
+    default:
+      return false;
+  }
+}
+
+std::vector<std::vector<Node*>> RowwiseGroupDetector::operator()(
+    Graph* graph) {
+  auto teller = [&](const Node* n) -> bool {
+    return CheckPrecondition(n) && IsRowwiseOp(n);
+  };
+
+  return SubgraphDetector(graph, teller)();
+}
+
+bool RowwiseGroupDetector::SetLayouts(SubGraph* subgraph) {
+  // The full vars are the inputs of the reductions, or X of the broadcast
+  // operations.
+  std::vector<int64_t> full_shape;
+  bool has_reduction = false;
+  for (auto* n : subgraph->SortedNodes()) {
+    if (!(n && n->IsOp() && n->Op())) {
+      continue;
+    }
+    std::vector<int64_t> x_shape = GetShape(GetInputVar(n, "X"));
+    if (IsSpecifiedOp(GetReductionOpTypes(), n)) {
+      has_reduction = true;
+      if (full_shape.empty()) {
+        full_shape = x_shape;
+      }
+    } else if (full_shape.empty() && x_shape.size() > 0U &&
+               GetInputVar(n, "Y") &&
+               x_shape != GetShape(GetInputVar(n, "Y"))) {
+      full_shape = x_shape;
+    }
+  }
+  if (full_shape.empty()) {
+    return false;
+  }
+
+  std::unordered_map<std::string, int> layouts;
+  bool has_broadcast = false;
+  for (auto* n : subgraph->Nodes()) {
+    if (n && n->IsVar() && n->Var()) {
+      int layout = GetRowwiseLayout(n->Var()->GetShape(), full_shape);
+      if (layout < 0) {
+        VLOG(3) << "The shape of " << n->Name()
+                << " does not match any layout of the rowwise subgraph.";
+        return false;
+      }
+      layouts[n->Name()] = layout;
+      has_broadcast |= (layout != kFull);
+    }
+  }
+  if (!has_reduction && !has_broadcast) {
+    return false;
+  }
+
+  for (auto* n : subgraph->Nodes()) {
+    if (!(n && n->IsOp() && n->Op())) {
+      continue;
+    }
+    bool is_reduction = IsSpecifiedOp(GetReductionOpTypes(), n);
+    bool out_of_full = false;
+    for (auto* in : n->inputs) {
+      if (in && in->IsVar() && in->Var()) {
+        int layout = layouts[in->Name()];
+        if (is_reduction && layout != kFull) {
+          return false;
+        }
+        out_of_full |= (layout == kFull || layout == kCol);
+      }
+    }
+    for (auto* out : n->outputs) {
+      if (out && out->IsVar() && out->Var()) {
+        // The vars broadcast along the rows are only loaded from the inputs.
+        int layout = layouts[out->Name()];
+        if (layout == kCol || (is_reduction && layout == kFull) ||
+            (!is_reduction && out_of_full != (layout == kFull))) {
+          return false;
+        }
+      }
+    }
+  }
+
+  bool has_full_input = false;
+  for (auto* n : subgraph->GetInputVarNodes()) {
+    has_full_input |= (layouts[n->Name()] == kFull);
+  }
+  if (!has_full_input) {
+    return false;
+  }
+
+  subgraph->SetRowwiseLayouts(full_shape.back(), layouts);
+  return true;
+}
+
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
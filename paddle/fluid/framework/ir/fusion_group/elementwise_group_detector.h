@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <vector>
+#include "paddle/fluid/framework/ir/fusion_group/subgraph.h"
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/ir/node.h"
 
@@ -24,18 +25,43 @@ namespace ir {
 namespace fusion_group {
 
 class GroupDetector {
+ public:
+  // float16 is not supported on CPU, and all the ops run on CPU then.
+  explicit GroupDetector(bool use_gpu = true) : use_gpu_(use_gpu) {}
+
  protected:
   bool CheckPrecondition(const Node* n);
+
+  bool use_gpu_;
 };
 
 class ElementwiseGroupDetector : GroupDetector {
  public:
+  explicit ElementwiseGroupDetector(bool use_gpu = true)
+      : GroupDetector(use_gpu) {}
+
   std::vector<std::vector<Node*>> operator()(Graph* graph);
 
  private:
   bool IsElementwiseOp(const Node* n);
 };
 
+// Detect the groups of elementwise operations, in which some inputs are
+// broadcast along the last axis or the other axes, and the reductions over
+// the last axis, i.e. reduce_sum and reduce_mean.
+class RowwiseGroupDetector : GroupDetector {
+ public:
+  std::vector<std::vector<Node*>> operator()(Graph* graph);
+
+  // Set the layouts of all the vars in the subgraph. Return false if the
+  // layouts are not consistent, or there is neither reduction nor broadcast
+  // in the subgraph.
+  static bool SetLayouts(SubGraph* subgraph);
+
+ private:
+  bool IsRowwiseOp(const Node* n);
+};
+
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
@@ -29,6 +29,7 @@ namespace ir {
 
 void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
   FusePassBase::Init("fusion_group_pass", graph);
+  fusion_group::OperationMap::Init();
   if (Get<bool>("use_gpu")) {
     // TODO(liuyiqun): open this check.
     // if (!platform::CUDADeviceCode::IsAvailable()) {
@@ -38,21 +39,38 @@ void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
     //   return 0;
     // }
 
-    fusion_group::OperationMap::Init();
+    // The rowwise groups are detected first, and the elementwise operations
+    // left are fused then.
+    int num_rowwise_groups = DetectFusionGroup(graph, 1);
+    int num_elementwise_groups = DetectFusionGroup(graph, 0);
+    AddStatis(num_rowwise_groups + num_elementwise_groups);
+    LOG(INFO) << "Detect " << num_rowwise_groups << " rowwise and "
+              << num_elementwise_groups << " elementwise fusion groups.";
+  } else {
+    // Only the elementwise groups are compiled to the C++ loops on CPU.
     int num_elementwise_groups = DetectFusionGroup(graph, 0);
     AddStatis(num_elementwise_groups);
     LOG(INFO) << "Detect " << num_elementwise_groups
-              << " elementwise fusion groups.";
+              << " elementwise fusion groups on CPU.";
   }
 }
 
-int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
+static platform::Place GetPlace(bool use_gpu) {
   // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
+  if (use_gpu) {
+    return platform::CUDAPlace(0);
+  }
+  return platform::CPUPlace();
+}
+
+int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
+  bool use_gpu = Get<bool>("use_gpu");
+  platform::Place place = GetPlace(use_gpu);
   int index = platform::DeviceCodePool::Init({place}).size(place);
 
   std::vector<std::vector<Node*>> subgraphs =
-      fusion_group::ElementwiseGroupDetector()(graph);
+      type == 1 ? fusion_group::RowwiseGroupDetector()(graph)
+                : fusion_group::ElementwiseGroupDetector(use_gpu)(graph);
 
   int num_subgraphs = 0;
   size_t min_subgraph_size = 2;
@@ -68,8 +86,13 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
     if (subgraph.RemoveIntermediateOut()) {
       subgraph.DetectIntermediateOutWithGraph(graph);
     }
+    if (type == 1 &&
+        !fusion_group::RowwiseGroupDetector::SetLayouts(&subgraph)) {
+      continue;
+    }
     if (subgraph.IsValid(min_subgraph_size)) {
-      subgraph.SetFuncName("fused_elementwise_" + std::to_string(index++));
+      std::string prefix = type == 1 ? "fused_rowwise_" : "fused_elementwise_";
+      subgraph.SetFuncName(prefix + std::to_string(index++));
       if (GenerateCode(&subgraph)) {
         InsertFusionGroupOp(graph, &subgraph);
         num_subgraphs++;
@@ -80,14 +103,35 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
 }
 
 bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph) const {
-  fusion_group::CodeGenerator code_generator;
+  bool use_gpu = Get<bool>("use_gpu");
+  fusion_group::CodeGenerator code_generator(/* use_cpu= */ !use_gpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(4) << code_str;
 
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  std::unique_ptr<platform::CUDADeviceCode> device_code(
-      new platform::CUDADeviceCode(place, subgraph->GetFuncName(), code_str));
+  platform::Place place = GetPlace(use_gpu);
+  std::unique_ptr<platform::DeviceCode> device_code;
+  if (!use_gpu) {
+    device_code.reset(new platform::CPUDeviceCode(
+        place, subgraph->GetFuncName(), code_str));
+  } else {
+#ifdef PADDLE_WITH_CUDA
+    auto* cuda_device_code = new platform::CUDADeviceCode(
+        place, subgraph->GetFuncName(), code_str);
+    if (subgraph->GetType() == 1) {
+      // The block reduction needs a power of 2 threads, one thread for each
+      // column at best.
+      int num_threads = 32;
+      while (num_threads < subgraph->GetCols() && num_threads < 1024) {
+        num_threads *= 2;
+      }
+      cuda_device_code->SetNumThreads(num_threads);
+    }
+    device_code.reset(cuda_device_code);
+#else
+    PADDLE_THROW(platform::errors::PreconditionNotMet(
+        "CUDAPlace is not supported, please re-compile with WITH_GPU=ON."));
+#endif
+  }
   bool is_compiled = device_code->Compile();
   if (is_compiled) {
     platform::DeviceCodePool& pool = platform::DeviceCodePool::Init({place});
@@ -128,15 +172,18 @@ void FusionGroupPass::InsertFusionGroupOp(
 
   std::vector<std::string> input_names;
   std::vector<std::string> inputs_data_types;
+  std::vector<int> inputs_layout;
   for (auto* n : input_vars_of_subgraph) {
     input_names.push_back(n->Name());
     inputs_data_types.push_back(DataTypeToString(n->Var()->GetDataType()));
+    inputs_layout.push_back(subgraph->GetLayout(n->Name()));
     external_nodes.insert(n);
   }
   op_desc.SetInput("Inputs", input_names);
 
   std::vector<std::string> output_names;
   std::vector<std::string> outs_data_types;
+  std::vector<int> outs_layout;
   std::vector<Node*> output_var_without_intermediate;
   for (auto* n : output_vars_of_subgraph) {
     auto it_input =
@@ -147,6 +194,7 @@ void FusionGroupPass::InsertFusionGroupOp(
         it_input == input_vars_of_subgraph.end()) {
       output_names.push_back(n->Name());
       outs_data_types.push_back(DataTypeToString(n->Var()->GetDataType()));
+      outs_layout.push_back(subgraph->GetLayout(n->Name()));
       output_var_without_intermediate.push_back(n);
     }
     external_nodes.insert(n);
@@ -156,6 +204,10 @@ void FusionGroupPass::InsertFusionGroupOp(
   op_desc.SetAttr("inputs_data_type", inputs_data_types);
   op_desc.SetAttr("outs_data_type", outs_data_types);
   op_desc.SetAttr("type", subgraph->GetType());
+  if (subgraph->GetType() == 1) {
+    op_desc.SetAttr("inputs_layout", inputs_layout);
+    op_desc.SetAttr("outs_layout", outs_layout);
+  }
   op_desc.SetAttr("func_name", subgraph->GetFuncName());
   op_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
                   ExtractOpRole(subgraph));
@@ -133,10 +133,57 @@ std::unique_ptr<Graph> BuildElementwiseTreeGraph(bool backward = false) {
 #endif
 }
 
-int TestMain(std::unique_ptr<Graph> graph, std::string prefix) {
+std::unique_ptr<Graph> BuildRowwiseGraph() {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // x                          reduce_mean      -> tmp_0
+  // (x, tmp_0)                 elementwise_sub  -> tmp_1
+  // (tmp_1, tmp_1)             elementwise_mul  -> tmp_2
+  // tmp_2                      reduce_mean      -> tmp_3
+  // (tmp_1, scale)             elementwise_mul  -> tmp_4
+  // (tmp_4, bias)              elementwise_add  -> tmp_5
+  // tmp_5                      relu             -> tmp_6
+  //
+  // Expression: tmp_3 = mean((x - mean(x))^2)
+  //             tmp_6 = relu((x - mean(x)) * scale + bias)
+  Layers layers;
+  std::vector<int64_t> shape = {16, 32};
+  std::vector<int64_t> row_shape = {16, 1};
+  auto* x = layers.data("x", shape);
+  auto* tmp_0 = layers.reduce_mean(x, -1, true);
+  auto* tmp_1 = layers.elementwise_sub(x, tmp_0);
+  auto* tmp_2 = layers.elementwise_mul(tmp_1, tmp_1);
+  auto* tmp_3 = layers.reduce_mean(tmp_2, -1, true);
+  auto* scale = layers.data("scale", {32});
+  auto* tmp_4 = layers.elementwise_mul(tmp_1, scale);
+  auto* bias = layers.data("bias", {32});
+  auto* tmp_5 = layers.elementwise_add(tmp_4, bias);
+  auto* tmp_6 = layers.relu(tmp_5);
+  for (auto* var : {tmp_1, tmp_2, tmp_4, tmp_5, tmp_6}) {
+    var->SetShape(shape);
+  }
+  for (auto* var : {tmp_0, tmp_3}) {
+    var->SetShape(row_shape);
+  }
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  for (auto* n : graph->Nodes()) {
+    if (n && n->IsVar() && n->Var()) {
+      n->Var()->SetDataType(proto::VarType::FP32);
+    }
+  }
+#ifdef __clang__
+  return graph;
+#else
+  return std::move(graph);
+#endif
+}
+
+int TestMain(std::unique_ptr<Graph> graph, std::string prefix,
+             bool use_gpu = true) {
   // VisualizeGraph(&graph, prefix + ".dot");
   auto pass = PassRegistry::Instance().Get("fusion_group_pass");
-  pass->Set("use_gpu", new bool(true));
+  pass->Set("use_gpu", new bool(use_gpu));
   VLOG(3) << DebugString(graph);
 
   graph.reset(pass->Apply(graph.release()));
@@ -147,6 +194,7 @@ int TestMain(std::unique_ptr<Graph> graph, std::string prefix) {
   return num_fusion_group_ops;
 }
 
+#ifdef PADDLE_WITH_CUDA
 TEST(FusionGroupPass, elementwise_list) {
   std::unique_ptr<Graph> graph = BuildElementwiseListGraph(true);
   int num_fusion_group_ops = TestMain(std::move(graph), "elementwise_list");
@@ -159,6 +207,20 @@ TEST(FusionGroupPass, elementwise_tree) {
   EXPECT_EQ(num_fusion_group_ops, 4);
 }
 
+TEST(FusionGroupPass, rowwise) {
+  std::unique_ptr<Graph> graph = BuildRowwiseGraph();
+  int num_fusion_group_ops = TestMain(std::move(graph), "rowwise");
+  EXPECT_EQ(num_fusion_group_ops, 1);
+}
+#endif
+
+TEST(FusionGroupPass, elementwise_list_cpu) {
+  std::unique_ptr<Graph> graph = BuildElementwiseListGraph(true);
+  int num_fusion_group_ops =
+      TestMain(std::move(graph), "elementwise_list_cpu", /* use_gpu= */ false);
+  EXPECT_EQ(num_fusion_group_ops, 2);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
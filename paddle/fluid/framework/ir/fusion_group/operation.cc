@@ -26,6 +26,7 @@ OperationMap::OperationMap() {
   InsertUnaryElementwiseOperations();
   InsertBinaryElementwiseOperations();
   InsertMultivariateElementwiseOperations();
+  InsertReductionOperations();
 }
 
 std::unordered_set<std::string> OperationMap::Find(int type) {
@@ -209,6 +210,24 @@ void OperationMap::InsertMultivariateElementwiseOperations() {
   insert_handler_without_input("fill_constant", "${str_value}", {});
 }
 
+void OperationMap::InsertReductionOperations() {
+  // For the reductions over the last axis, the expression is the value
+  // accumulated for each element, which is reduced by the code generator.
+  //  ${0} - x
+  auto insert_handler = [&](std::string op_type, std::string expr) {
+    int type = 1;
+    int num_oprands = 1;
+    Insert(type, num_oprands, op_type, expr, {}, {"X"}, {"Out"});
+  };
+
+  // reduce_sum:
+  //  out = x_0 + x_1 + ... + x_cols-1
+  insert_handler("reduce_sum", "${0}");
+  // reduce_mean:
+  //  out = (x_0 + x_1 + ... + x_cols-1) / cols
+  insert_handler("reduce_mean", "${0}");
+}
+
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
@@ -107,6 +107,7 @@ class OperationMap {
   void InsertUnaryElementwiseOperations();
   void InsertBinaryElementwiseOperations();
   void InsertMultivariateElementwiseOperations();
+  void InsertReductionOperations();
 
  private:
   static OperationMap* map;
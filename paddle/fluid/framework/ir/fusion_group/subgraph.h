@@ -29,6 +29,16 @@ namespace framework {
 namespace ir {
 namespace fusion_group {
 
+// The fusion of type 1 computes on the rows of the last axis of the full
+// vars, whose size is cols. The other vars are broadcast along the rows or
+// the columns, or reduced from the full vars.
+enum RowwiseLayout {
+  kFull = 0,         // [..., cols]
+  kRow = 1,          // one value per row, [..., 1]
+  kSqueezedRow = 2,  // one value per row, [...]
+  kCol = 3           // one value per column, [1, ..., cols]
+};
+
 class SubGraph {
  public:
   SubGraph() = default;
@@ -71,6 +81,18 @@ class SubGraph {
   void SetFuncName(std::string func_name) { func_name_ = func_name; }
   std::string GetFuncName() const { return func_name_; }
 
+  // Only used by the fusion of type 1.
+  void SetRowwiseLayouts(int64_t cols,
+                         const std::unordered_map<std::string, int>& layouts) {
+    cols_ = cols;
+    layouts_ = layouts;
+  }
+  int64_t GetCols() const { return cols_; }
+  int GetLayout(const std::string& var_name) const {
+    auto iter = layouts_.find(var_name);
+    return iter == layouts_.end() ? kFull : iter->second;
+  }
+
   const std::unordered_set<Node*>& Nodes() const { return nodes_set_; }
   const std::vector<Node*>& SortedNodes() {
     if (!is_sorted_) {
@@ -234,6 +256,8 @@ class SubGraph {
   std::string data_type_;
   std::string func_name_;
   bool save_intermediate_out_{true};
+  int64_t cols_{0};
+  std::unordered_map<std::string, int> layouts_;
 
   std::unordered_set<Node*> nodes_set_;
   std::vector<Node*> intermediate_out_nodes_{};
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -147,6 +148,52 @@ class Graph {
 
   const std::unordered_set<ir::Node *> &Nodes() const { return node_set_; }
 
+  // The analyses cached on the graph, e.g. the topological order of the
+  // operations in graph_helper.h. An analysis is built on its first use, and
+  // rebuilt after a node is added or removed, or after the nodes are relinked
+  // by IR_NODE_LINK_TO, IR_OP_VAR_LINK or GraphSafeRemoveNodes. It's dropped
+  // after a pass which doesn't preserve it. A pass editing the inputs or the
+  // outputs of the nodes directly should call InvalidateAnalyses() before
+  // reading an analysis again.
+  template <typename AnalysisType>
+  const AnalysisType &GetOrBuildAnalysis(
+      const std::string &name,
+      const std::function<AnalysisType()> &build) const {
+    auto it = analyses_.find(name);
+    if (it != analyses_.end() && it->second.link_epoch != Node::LinkEpoch()) {
+      analyses_.erase(it);
+      it = analyses_.end();
+    }
+    if (it == analyses_.end()) {
+      VLOG(4) << "Build the analysis " << name << " of the graph.";
+      uint64_t link_epoch = Node::LinkEpoch();
+      it = analyses_.emplace(name, CachedAnalysis{build(), link_epoch}).first;
+    }
+    auto *analysis = boost::any_cast<AnalysisType>(&it->second.value);
+    PADDLE_ENFORCE_NOT_NULL(
+        analysis, platform::errors::InvalidArgument(
+                      "Invalid type for the analysis %s, actual: %s", name,
+                      platform::demangle(it->second.value.type().name())));
+    return *analysis;
+  }
+
+  bool HasAnalysis(const std::string &name) const {
+    auto it = analyses_.find(name);
+    return it != analyses_.end() && it->second.link_epoch == Node::LinkEpoch();
+  }
+
+  // Drop all the cached analyses except the preserved ones.
+  void InvalidateAnalyses(
+      const std::unordered_set<std::string> &preserved = {}) {
+    for (auto it = analyses_.begin(); it != analyses_.end();) {
+      if (preserved.count(it->first)) {
+        ++it;
+      } else {
+        it = analyses_.erase(it);
+      }
+    }
+  }
+
   // Create a normal variable with non-null VarDesc.
   ir::Node *CreateVarNode(VarDesc *var_desc) {
     PADDLE_ENFORCE_NOT_NULL(
@@ -197,6 +244,7 @@ class Graph {
     }
     nodes_.clear();
     node_set_.clear();
+    analyses_.clear();
     return ret;
   }
 
@@ -208,6 +256,7 @@ class Graph {
     ret.reset(nodes_.at(node).release());
     nodes_.erase(node);
     node_set_.erase(node);
+    analyses_.clear();
     return ret;
   }
 
@@ -234,6 +283,7 @@ class Graph {
                           "The node to be added already exists."));
     nodes_[node].reset(node);
     node_set_.insert(node);
+    analyses_.clear();
     return node;
   }
 
@@ -254,6 +304,12 @@ class Graph {
   std::map<std::string, std::function<void(void)>> attr_dels_;
   std::map<ir::Node *, std::unique_ptr<ir::Node>> nodes_;
   std::unordered_set<ir::Node *> node_set_;
+  struct CachedAnalysis {
+    boost::any value;
+    // Node::LinkEpoch() when the analysis is built.
+    uint64_t link_epoch;
+  };
+  mutable std::map<std::string, CachedAnalysis> analyses_;
   size_t num_node_created_{0};  // help to generate a unique node id.
 };
 
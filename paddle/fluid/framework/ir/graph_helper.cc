@@ -19,9 +19,11 @@ limitations under the License. */
 #include <iosfwd>
 #include <ostream>
 #include <stack>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include "paddle/fluid/framework/ir/graph_traits.h"
+#include "paddle/fluid/framework/operator.h"
 
 DEFINE_string(print_sub_graph_dir, "",
               "FLAGS_print_sub_graph_dir is used "
@@ -99,6 +101,61 @@ bool HasCircleInternal(
 }
 }  // namespace
 
+bool HasSubBlock(const OpDesc &op) {
+  for (auto &name : op.AttrNames()) {
+    auto type = op.GetAttrType(name);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsPureOp(const OpDesc &op) {
+  // The ops whose outputs differ from run to run, or which have side effects.
+  static const std::unordered_set<std::string> kImpureOps({
+      // IO
+      "feed", "fetch", "read", "create_py_reader",
+      "create_double_buffer_reader", "print", "save", "save_combine", "load",
+      "load_combine",
+      // random, including the sampling ones
+      "uniform_random", "gaussian_random", "truncated_gaussian_random",
+      "uniform_random_batch_size_like", "gaussian_random_batch_size_like",
+      "randint", "randperm", "random_crop", "sampling_id", "dropout", "seed",
+      "nce", "sample_logits", "shuffle_batch",
+      // stateful
+      "increment", "py_func",
+      // distributed and collective
+      "send", "recv", "send_barrier", "fetch_barrier", "listen_and_serv",
+      "fl_listen_and_serv", "checkpoint_notify", "prefetch", "recv_save",
+      "distributed_lookup_table", "distributed_lookup_table_wait",
+      "lookup_sparse_table", "gen_nccl_id", "allreduce", "broadcast",
+      "c_gen_nccl_id", "c_comm_init", "c_comm_init_all", "c_allgather",
+      "c_allreduce_max", "c_allreduce_min", "c_allreduce_prod",
+      "c_allreduce_sum", "c_broadcast", "c_reducescatter",
+      "c_sync_calc_stream", "c_sync_comm_stream",
+  });
+  if (kImpureOps.count(op.Type()) || HasSubBlock(op)) return false;
+  // Conservatively, the ops unknown to run with kernels, e.g. the ones
+  // running by themselves or not linked, the ops calling back to Python, and
+  // the ops prefetching from the parameter servers are not pure either.
+  if (!OperatorWithKernel::AllOpKernels().count(op.Type())) return false;
+  static const std::string kCallableSuffix = "callable_id";
+  for (auto &name : op.AttrNames()) {
+    if (name.size() >= kCallableSuffix.size() &&
+        name.compare(name.size() - kCallableSuffix.size(),
+                     kCallableSuffix.size(), kCallableSuffix) == 0) {
+      return false;
+    }
+    if (name == "remote_prefetch" &&
+        op.GetAttrType(name) == proto::AttrType::BOOLEAN &&
+        BOOST_GET_CONST(bool, op.GetAttr(name))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool HasCircle(const Graph &graph) {
   return HasCircleInternal(BuildOperationAdjList(graph), nullptr);
 }
@@ -148,6 +205,13 @@ std::vector<ir::Node *> TopologySortOperations(const Graph &graph) {
   return ret;
 }
 
+const std::vector<ir::Node *> &CachedTopologySortOperations(
+    const Graph &graph) {
+  return graph.GetOrBuildAnalysis<std::vector<ir::Node *>>(
+      kTopologySortAnalysis,
+      [&graph] { return TopologySortOperations(graph); });
+}
+
 // Build operator inlink edge table.
 std::map<ir::Node *, std::set<ir::Node *, ir::NodeComp>, ir::NodeComp>
 BuildOperationAdjList(const Graph &graph) {
@@ -51,10 +51,27 @@ bool FindCircleSubGraph(const Graph &graph,
 
 size_t GraphNum(const Graph &graph);
 
+// Test if the op has a sub block, e.g. while and conditional_block.
+bool HasSubBlock(const OpDesc &op);
+
+// Test if the outputs of the op only depend on its inputs and attributes,
+// and the op has no side effects, i.e. it is not a random, IO, stateful,
+// distributed or sub block op, so that it can be folded into constants or
+// merged with the same op. The ops without kernels or calling back to Python
+// are not taken as pure.
+bool IsPureOp(const OpDesc &op);
+
 // Topology Sort the operations in the graph from inputs to outputs.
 // `graph` cannot contain circle.
 std::vector<ir::Node *> TopologySortOperations(const Graph &graph);
 
+// The names of the analyses cached on the graph, see
+// Graph::GetOrBuildAnalysis.
+constexpr char kTopologySortAnalysis[] = "topology_sort_operations";
+
+// The cached analysis, the reference is valid until the graph drops it.
+const std::vector<ir::Node *> &CachedTopologySortOperations(const Graph &graph);
+
 // Topological sort, but try to DFS.
 std::vector<ir::Node *> TopologyDfsSortOperations(const Graph &graph);
 
@@ -16,6 +16,8 @@ limitations under the License. */
 #include <string>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
 
 namespace paddle {
@@ -222,6 +224,46 @@ TEST(GraphHelperTest, GraphNum) {
   ASSERT_EQ(GraphNum(g3), 2UL);
 }
 
+TEST(GraphHelperTest, CachedAnalyses) {
+  ProgramDesc prog;
+  Graph g(prog);
+  BuildNoCircleGraph(&g);
+  ir::Node* v5 = g.CreateEmptyNode("var5", Node::Type::kVariable);
+
+  auto& sorted = CachedTopologySortOperations(g);
+  ASSERT_EQ(sorted.size(), 5UL);
+  ASSERT_EQ(sorted[0]->Name(), "op1");
+  ASSERT_TRUE(g.HasAnalysis(kTopologySortAnalysis));
+  ASSERT_EQ(&CachedTopologySortOperations(g), &sorted);
+
+  // the analyses are dropped once the nodes are relinked
+  ir::Node* o1 = sorted[0];
+  ir::Node* o5 = nullptr;
+  for (auto* n : sorted) {
+    if (n->Name() == "op5") o5 = n;
+  }
+  ASSERT_NE(o5, nullptr);
+  IR_NODE_LINK_TO(v5, o1);
+  ASSERT_FALSE(g.HasAnalysis(kTopologySortAnalysis));
+  ASSERT_EQ(CachedTopologySortOperations(g).size(), 5UL);
+  ASSERT_TRUE(g.HasAnalysis(kTopologySortAnalysis));
+
+  // and once the nodes are added
+  ir::Node* o6 = g.CreateEmptyNode("op6", Node::Type::kOperation);
+  ASSERT_FALSE(g.HasAnalysis(kTopologySortAnalysis));
+  ir::Node* v6 = g.CreateEmptyNode("var6", Node::Type::kVariable);
+  IR_NODE_LINK_TO(o5, v6);
+  IR_NODE_LINK_TO(v6, o6);
+  ASSERT_EQ(CachedTopologySortOperations(g).back(), o6);
+
+  g.InvalidateAnalyses({kTopologySortAnalysis});
+  ASSERT_TRUE(g.HasAnalysis(kTopologySortAnalysis));
+  g.InvalidateAnalyses();
+  ASSERT_FALSE(g.HasAnalysis(kTopologySortAnalysis));
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
+
+USE_OP(scale);
@@ -109,12 +109,35 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
+  // Index the ops by type, so the PDNodes asserted to be some op types are
+  // only told against the ops of these types.
+  std::vector<Node *> nodes;
+  std::unordered_set<Node *> visited;
+  std::unordered_map<std::string, std::vector<Node *>> ops_by_type;
   for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+    if (!visited.insert(&node).second) continue;
+    nodes.push_back(&node);
+    if (node.IsOp() && node.Op()) {
+      ops_by_type[node.Op()->Type()].push_back(&node);
+    }
+  }
+
+  for (const auto &pdnode : pattern_.nodes()) {
+    auto mark = [&](Node *node) {
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        pdnodes2nodes_[pdnode.get()].insert(node);
       }
+    };
+    auto *op_types = pdnode->op_types();
+    if (op_types == nullptr) {
+      for (auto *node : nodes) mark(node);
+      continue;
+    }
+    for (auto &op_type : *op_types) {
+      auto it = ops_by_type.find(op_type);
+      if (it == ops_by_type.end()) continue;
+      for (auto *node : it->second) mark(node);
     }
   }
   // Check to early stop if some PDNode can't find matched Node.
@@ -197,14 +220,56 @@ bool IsNodesLink(Node *a, Node *b) {
   return false;
 }
 
+// Order the edges to start from the most selective PDNode, and to expand
+// along the edges from the PDNodes already matched, so that each edge
+// extends a group from the neighbors of its matched Node.
+static std::vector<std::pair<PDNode *, PDNode *>> OrderEdges(
+    const std::vector<std::pair<PDNode *, PDNode *>> &edges,
+    const std::function<size_t(PDNode *)> &num_candidates,
+    PDNode **anchor) {
+  std::vector<std::pair<PDNode *, PDNode *>> ordered;
+  if (edges.empty()) return ordered;
+  *anchor = edges.front().first;
+  for (auto &edge : edges) {
+    for (auto *pdnode : {edge.first, edge.second}) {
+      if (num_candidates(pdnode) < num_candidates(*anchor)) *anchor = pdnode;
+    }
+  }
+
+  std::unordered_set<PDNode *> matched{*anchor};
+  std::vector<bool> used(edges.size(), false);
+  while (ordered.size() < edges.size()) {
+    size_t next = edges.size();
+    for (size_t i = 0; i < edges.size(); ++i) {
+      if (used[i]) continue;
+      if (matched.count(edges[i].first) || matched.count(edges[i].second)) {
+        next = i;
+        break;
+      }
+      // a disconnected pattern, continue from the first unused edge
+      if (next == edges.size()) next = i;
+    }
+    used[next] = true;
+    matched.insert(edges[next].first);
+    matched.insert(edges[next].second);
+    ordered.push_back(edges[next]);
+  }
+  return ordered;
+}
+
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
   std::vector<GraphPatternDetector::subgraph_t> result;
   std::vector<HitGroup> init_groups;
   std::array<std::vector<HitGroup>, 2> bi_records;
-  auto *first_pnode = pattern_.edges().empty() ? pattern().nodes().front().get()
-                                               : pattern_.edges().front().first;
+  auto num_candidates = [this](PDNode *pdnode) -> size_t {
+    auto it = pdnodes2nodes_.find(pdnode);
+    return it == pdnodes2nodes_.end() ? 0UL : it->second.size();
+  };
+  PDNode *first_pnode = nullptr;
+  auto edges = OrderEdges(pattern_.edges(), num_candidates, &first_pnode);
+  if (edges.empty()) first_pnode = pattern().nodes().front().get();
   if (!pdnodes2nodes_.count(first_pnode)) return result;
   for (auto *node : pdnodes2nodes_[first_pnode]) {
     HitGroup group;
@@ -217,32 +282,61 @@ GraphPatternDetector::DetectPatterns() {
 
   // Extend a PDNode to subgraphs by deducing the connection relations defined
   // in edges of PDNodes.
-  for (const auto &edge : pattern_.edges()) {
+  for (const auto &edge : edges) {
     VLOG(4) << "check " << edge.first->name() << " -> " << edge.second->name();
-    // TODO(Superjomn) Fix bug here, the groups might be duplicate here.
     // Each role has two PDNodes, which indicates two roles.
     // Detect two Nodes that can match these two roles and they are connected.
     auto &pre_groups = bi_records[step % 2];
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
-    // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
-        VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+    auto &sources = pdnodes2nodes_[edge.first];
+    auto &targets = pdnodes2nodes_[edge.second];
+    auto try_extend = [&](const HitGroup &group, Node *source, Node *target) {
+      HitGroup new_group = group;
+      if (new_group.Match(source, edge.first) &&
+          new_group.Match(target, edge.second)) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        cur_groups.push_back(new_group);
+      }
+    };
+    // The linked pairs, only needed by the groups matching neither end of
+    // the edge, i.e., in a disconnected pattern.
+    std::vector<std::pair<Node *, Node *>> links;
+    bool links_ready = false;
+
+    for (const auto &group : pre_groups) {
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      if (source_it != group.roles.end()) {
+        // source -> target, the outputs may hold a Node more than once
+        std::unordered_set<Node *> checked;
+        for (auto *target : source_it->second->outputs) {
+          if (targets.count(target) && checked.insert(target).second) {
+            try_extend(group, source_it->second, target);
+          }
+        }
+      } else if (target_it != group.roles.end()) {
+        std::unordered_set<Node *> checked;
+        for (auto *source : target_it->second->inputs) {
+          if (sources.count(source) && checked.insert(source).second) {
+            try_extend(group, source, target_it->second);
+          }
+        }
+      } else {
+        if (!links_ready) {
+          for (Node *source : sources) {
+            for (Node *target : targets) {
+              if (IsNodesLink(source, target)) {
+                links.emplace_back(source, target);
+              }
             }
           }
+          links_ready = true;
+        }
+        for (auto &link : links) {
+          try_extend(group, link.first, link.second);
         }
       }
     }
@@ -374,9 +468,21 @@ PDNode *PDNode::assert_is_op(const std::string &op_type) {
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
+  RestrictOpTypes({op_type});
   return this;
 }
 
+void PDNode::RestrictOpTypes(const std::unordered_set<std::string> &op_types) {
+  if (!has_op_types_) {
+    op_types_ = op_types;
+    has_op_types_ = true;
+    return;
+  }
+  for (auto it = op_types_.begin(); it != op_types_.end();) {
+    it = op_types.count(*it) ? std::next(it) : op_types_.erase(it);
+  }
+}
+
 PDNode *PDNode::assert_is_var() {
   asserts_.emplace_back([](Node *x) { return x && x->IsVar(); });
   return this;
@@ -544,6 +650,7 @@ PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
+  RestrictOpTypes(op_types);
   return this;
 }
 
@@ -702,6 +809,7 @@ void GraphSafeRemoveNodes(Graph *graph,
       }
     }
   }
+  Node::BumpLinkEpoch();
 }
 
 bool VarLinksFromOp(Node *node, const std::string &op_type) {
@@ -1050,25 +1158,26 @@ PDNode *patterns::GRU::operator()(PDNode *x) {
 
 PDNode *patterns::ActElewiseAdd::operator()(
     paddle::framework::ir::PDNode *in_var,
-    std::unordered_set<std::string> act_types) {
+    std::unordered_set<std::string> act_types,
+    std::unordered_set<std::string> binary_types) {
   in_var->assert_is_ops_input(act_types, "X");
 
   auto *act = pattern->NewNode(act_repr())->assert_is_ops(act_types);
   auto *act_out_var = pattern->NewNode(act_out_repr())
                           ->assert_is_not_ctrl_var()
                           ->assert_is_ops_output(act_types);
-  act_out_var->AsIntermediate()->assert_is_op_input("elementwise_add");
+  act_out_var->AsIntermediate()->assert_is_ops_input(binary_types);
 
   auto *ele_x_var = pattern->NewNode(ele_x_repr())
                         ->assert_is_not_ctrl_var()
-                        ->assert_is_op_input("elementwise_add")
+                        ->assert_is_ops_input(binary_types)
                         ->AsInput();
   auto *elementwise_add =
-      pattern->NewNode(ele_add_repr())->assert_is_op("elementwise_add");
+      pattern->NewNode(ele_add_repr())->assert_is_ops(binary_types);
 
   auto *elewise_add_out = pattern->NewNode(elewise_add_out_repr())
                               ->AsOutput()
-                              ->assert_is_op_output("elementwise_add", "Out");
+                              ->assert_is_ops_output(binary_types, "Out");
 
   act->LinksFrom({in_var}).LinksTo({act_out_var});
   elementwise_add->LinksFrom({act_out_var, ele_x_var})
@@ -1188,17 +1297,159 @@ PDNode *patterns::BatchNormActGrad::operator()(
   return bn_grad;
 }
 
+PDNode *patterns::BatchNormAddAct::operator()(
+    paddle::framework::ir::PDNode *bn_x_var,
+    std::unordered_set<std::string> act_types) {
+  auto *bn_scale_var = pattern->NewNode(bn_scale_repr())
+                           ->assert_is_op_input("batch_norm", "Scale");
+  auto *bn_bias_var = pattern->NewNode(bn_bias_repr())
+                          ->assert_is_op_input("batch_norm", "Bias");
+  auto *bn_variance_var = pattern->NewNode(bn_variance_repr())
+                              ->assert_is_op_input("batch_norm", "Variance");
+  auto *bn_mean_var = pattern->NewNode(bn_mean_repr())
+                          ->assert_is_op_input("batch_norm", "Mean");
+
+  auto *bn = pattern->NewNode(batch_norm_repr())
+                 ->assert_is_op("batch_norm")
+                 ->assert_is_not_op_input("MomentumTensor")
+                 ->assert_op_attr<bool>("is_test", false)
+                 ->assert_op_attr<bool>("use_global_stats", false)
+                 ->assert_op_attr<std::string>("data_layout", "NHWC");
+
+  auto *bn_mean_out_var = pattern->NewNode(bn_mean_out_repr())
+                              ->assert_is_op_output("batch_norm", "MeanOut");
+  auto *bn_variance_out_var =
+      pattern->NewNode(bn_variance_out_repr())
+          ->assert_is_op_output("batch_norm", "VarianceOut");
+  auto *bn_saved_variance_var =
+      pattern->NewNode(bn_saved_variance_repr())
+          ->assert_is_op_output("batch_norm", "SavedVariance");
+  auto *bn_saved_mean_var =
+      pattern->NewNode(bn_saved_mean_repr())
+          ->assert_is_op_output("batch_norm", "SavedMean");
+  auto *bn_reserve_space =
+      pattern->NewNode(bn_reserve_space_repr())
+          ->assert_is_op_output("batch_norm", "ReserveSpace");
+  // The output of batch_norm is also read by elementwise_add_grad, so it is
+  // not an intermediate node of the pattern.
+  auto *bn_out_var = pattern->NewNode(bn_out_repr())
+                         ->assert_is_op_output("batch_norm", "Y")
+                         ->assert_is_op_input("elementwise_add");
+
+  auto *elewise_add =
+      pattern->NewNode(elewise_add_repr())
+          ->assert_is_op("elementwise_add")
+          ->assert_op_attr<int>("axis", -1);
+  auto *elewise_add_in_var = pattern->NewNode(elewise_add_in_repr())
+                                 ->assert_is_not_ctrl_var()
+                                 ->assert_is_op_input("elementwise_add")
+                                 ->assert_var_dtype(proto::VarType::FP16);
+  auto *elewise_add_out_var =
+      pattern->NewNode(elewise_add_out_repr())
+          ->assert_is_op_output("elementwise_add", "Out")
+          ->assert_has_n_outputs(1);
+  elewise_add_out_var->AsIntermediate()->assert_is_ops_input(act_types);
+
+  auto *act = pattern->NewNode(act_repr())->assert_is_ops(act_types);
+
+  auto *act_out_var =
+      pattern->NewNode(act_out_repr())->assert_is_ops_output(act_types, "Out");
+
+  bn->LinksFrom(
+        {bn_x_var, bn_scale_var, bn_bias_var, bn_variance_var, bn_mean_var})
+      .LinksTo({bn_mean_out_var, bn_variance_out_var, bn_saved_variance_var,
+                bn_saved_mean_var, bn_reserve_space, bn_out_var});
+  elewise_add->LinksFrom({bn_out_var, elewise_add_in_var})
+      .LinksTo({elewise_add_out_var});
+  act->LinksFrom({elewise_add_out_var}).LinksTo({act_out_var});
+
+  return act_out_var;
+}
+
+PDNode *patterns::BatchNormAddActGrad::operator()(
+    paddle::framework::ir::PDNode *d_act_out_var,
+    std::unordered_set<std::string> act_grad_types) {
+  auto *act_grad =
+      pattern->NewNode(act_grad_repr())->assert_is_ops(act_grad_types);
+  auto *elewise_add_grad = pattern->NewNode(elewise_add_grad_repr())
+                               ->assert_is_op("elementwise_add_grad")
+                               ->assert_op_attr<int>("axis", -1);
+  auto *bn_grad = pattern->NewNode(batch_norm_grad_repr())
+                      ->assert_is_op("batch_norm_grad")
+                      ->assert_op_attr<bool>("use_global_stats", false)
+                      ->assert_op_attr<std::string>("data_layout", "NHWC");
+
+  auto *act_out_var = pattern->NewNode(act_out_repr())
+                          ->assert_is_ops_input(act_grad_types, "Out");
+  auto *d_act_x_var =
+      pattern->NewNode(d_act_x_repr())
+          ->assert_is_ops_output(act_grad_types, GradVarName("X"))
+          ->assert_has_n_outputs(1);
+  d_act_x_var->AsIntermediate()->assert_is_op_input("elementwise_add_grad",
+                                                    GradVarName("Out"));
+  auto *d_bn_out_var =
+      pattern->NewNode(d_bn_out_repr())
+          ->assert_is_not_ctrl_var()
+          ->assert_is_op_output("elementwise_add_grad")
+          ->assert_has_n_outputs(1);
+  d_bn_out_var->AsIntermediate()->assert_is_op_input("batch_norm_grad",
+                                                     GradVarName("Y"));
+  auto *d_elewise_add_in_var =
+      pattern->NewNode(d_elewise_add_in_repr())
+          ->assert_is_not_ctrl_var()
+          ->assert_is_op_output("elementwise_add_grad");
+
+  auto *bn_x_var = pattern->NewNode(bn_x_repr())
+                       ->assert_is_op_input("batch_norm_grad", "X")
+                       ->assert_var_dtype(proto::VarType::FP16);
+  auto *bn_scale_var = pattern->NewNode(bn_scale_repr())
+                           ->assert_is_op_input("batch_norm_grad", "Scale");
+  auto *bn_bias_var = pattern->NewNode(bn_bias_repr())
+                          ->assert_is_op_input("batch_norm_grad", "Bias");
+  auto *bn_saved_mean_var =
+      pattern->NewNode(bn_saved_mean_repr())
+          ->assert_is_op_input("batch_norm_grad", "SavedMean");
+  auto *bn_saved_variance_var =
+      pattern->NewNode(bn_saved_variance_repr())
+          ->assert_is_op_input("batch_norm_grad", "SavedVariance");
+  auto *bn_reserve_space =
+      pattern->NewNode(bn_reserve_space_repr())
+          ->assert_is_op_input("batch_norm_grad", "ReserveSpace");
+  auto *d_bn_x_var =
+      pattern->NewNode(d_bn_x_repr())
+          ->assert_is_not_ctrl_var()
+          ->assert_is_op_output("batch_norm_grad", GradVarName("X"));
+  auto *d_bn_scale_var =
+      pattern->NewNode(d_bn_scale_repr())
+          ->assert_is_not_ctrl_var()
+          ->assert_is_op_output("batch_norm_grad", GradVarName("Scale"));
+  auto *d_bn_bias_var =
+      pattern->NewNode(d_bn_bias_repr())
+          ->assert_is_not_ctrl_var()
+          ->assert_is_op_output("batch_norm_grad", GradVarName("Bias"));
+
+  act_grad->LinksFrom({d_act_out_var, act_out_var}).LinksTo({d_act_x_var});
+  elewise_add_grad->LinksFrom({d_act_x_var})
+      .LinksTo({d_bn_out_var, d_elewise_add_in_var});
+  bn_grad
+      ->LinksFrom({bn_x_var, d_bn_out_var, bn_scale_var, bn_bias_var,
+                   bn_saved_mean_var, bn_saved_variance_var, bn_reserve_space})
+      .LinksTo({d_bn_x_var, d_bn_scale_var, d_bn_bias_var});
+
+  return bn_grad;
+}
+
 PDNode *patterns::ElewiseAddAct::operator()(
     paddle::framework::ir::PDNode *ele_x_var,
-    std::unordered_set<std::string> act_types) {
+    std::unordered_set<std::string> act_types,
+    std::unordered_set<std::string> binary_types) {
   auto *ele_y_var = pattern->NewNode(ele_y_repr())
-                        ->assert_is_op_input("elementwise_add", "Y");
+                        ->assert_is_ops_input(binary_types, "Y");
 
-  auto *ele_add =
-      pattern->NewNode(ele_add_repr())->assert_is_op("elementwise_add");
+  auto *ele_add = pattern->NewNode(ele_add_repr())->assert_is_ops(binary_types);
 
   auto *ele_out_var = pattern->NewNode(elewise_add_out_repr())
-                          ->assert_is_op_output("elementwise_add", "Out");
+                          ->assert_is_ops_output(binary_types, "Out");
 
   ele_out_var->AsIntermediate()->assert_is_ops_input(act_types);
 
@@ -1215,7 +1466,8 @@ PDNode *patterns::ElewiseAddAct::operator()(
 
 PDNode *patterns::ElewiseAddActInplaceGrad::operator()(
     paddle::framework::ir::PDNode *d_act_out_var,
-    std::unordered_set<std::string> act_types) {
+    std::unordered_set<std::string> act_types,
+    std::unordered_set<std::string> binary_grad_types) {
   // act_grad: in["Out", "Out@GRAD"], out["X@GRAD"]
   // ele_add_grad: in["Y", "Out@GRAD"], out["X@GRAD", "Y@GRAD"]
   auto *act_grad = pattern->NewNode(act_grad_repr())->assert_is_ops(act_types);
@@ -1232,20 +1484,20 @@ PDNode *patterns::ElewiseAddActInplaceGrad::operator()(
 
   auto *ele_y_var = pattern->NewNode(ele_y_repr())
                         ->assert_is_not_ctrl_var()
-                        ->assert_is_op_input("elementwise_add_grad", "Y");
+                        ->assert_is_ops_input(binary_grad_types, "Y");
 
   auto *ele_add_grad = pattern->NewNode(ele_add_grad_repr())
-                           ->assert_is_op("elementwise_add_grad");
+                           ->assert_is_ops(binary_grad_types);
 
   auto *d_ele_x_var =
       pattern->NewNode(d_ele_x_repr())
           ->assert_is_not_ctrl_var()
-          ->assert_is_op_output("elementwise_add_grad", GradVarName("X"));
+          ->assert_is_ops_output(binary_grad_types, GradVarName("X"));
 
   auto *d_ele_y_var =
       pattern->NewNode(d_ele_y_repr())
           ->assert_is_not_ctrl_var()
-          ->assert_is_op_output("elementwise_add_grad", GradVarName("Y"));
+          ->assert_is_ops_output(binary_grad_types, GradVarName("Y"));
 
   ele_add_grad->LinksFrom({d_intermediate_var, ele_y_var})
       .LinksTo({d_ele_x_var, d_ele_y_var});
@@ -2137,6 +2389,33 @@ void patterns::DeleteQuantDequantOpPattern::operator()() {
   any_op2->LinksFrom({quant_dequant_out});
 }
 
+void patterns::FakeQuantDequantPattern::operator()() {
+  const std::string quant_type = "fake_quantize_moving_average_abs_max";
+  const std::string dequant_type = "fake_dequantize_max_abs";
+  auto quant_in = pattern->NewNode(quant_in_repr())
+                      ->assert_is_op_input(quant_type, "X")
+                      ->AsInput();
+  auto quant_op = pattern->NewNode(quant_op_repr())->assert_is_op(quant_type);
+  // The quantized tensor is only used by the dequant op.
+  auto quant_out = pattern->NewNode(quant_out_repr())
+                       ->assert_is_op_output(quant_type, "Out")
+                       ->assert_is_op_input(dequant_type, "X")
+                       ->assert_has_n_outputs(1)
+                       ->AsIntermediate();
+  auto quant_out_scale = pattern->NewNode(quant_out_scale_repr())
+                             ->assert_is_op_output(quant_type, "OutScale")
+                             ->assert_is_op_input(dequant_type, "Scale")
+                             ->AsOutput();
+  auto dequant_op =
+      pattern->NewNode(dequant_op_repr())->assert_is_op(dequant_type);
+  auto dequant_out = pattern->NewNode(dequant_out_repr())
+                         ->assert_is_op_output(dequant_type, "Out")
+                         ->AsOutput();
+
+  quant_op->LinksFrom({quant_in}).LinksTo({quant_out, quant_out_scale});
+  dequant_op->LinksFrom({quant_out, quant_out_scale}).LinksTo({dequant_out});
+}
+
 PDNode *patterns::ReshapeTransposeMatmulPattern::operator()(
     bool with_reshape_xshape, bool with_transpose_xshape) {
   auto reshape_op =
@@ -71,6 +71,12 @@ struct PDNode {
   bool IsOp() const { return type_ == Type::kOp; }
   bool IsVar() const { return type_ == Type::kVar; }
 
+  // The op types asserted by assert_is_op(s), which index the candidates of
+  // the node, nullptr if the node is not restricted to some op types.
+  const std::unordered_set<std::string>* op_types() const {
+    return teller_ || !has_op_types_ ? nullptr : &op_types_;
+  }
+
   const std::string& name() const { return name_; }
 
   PDNode& operator=(const PDNode&) = delete;
@@ -165,6 +171,9 @@ struct PDNode {
 
   PDNode(PDNode&& other) = default;
 
+  // Intersect with the op types of the previous assertions.
+  void RestrictOpTypes(const std::unordered_set<std::string>& op_types);
+
   friend class PDPattern;
 
   // Will removed latter.
@@ -174,6 +183,8 @@ struct PDNode {
   std::string name_;
   Type type_;
   Role role_{Role::kUnknown};
+  bool has_op_types_{false};
+  std::unordered_set<std::string> op_types_;
 };
 
 /*
@@ -295,6 +306,7 @@ class GraphPatternDetector {
 #ifdef PADDLE_WITH_TESTING
   FRIEND_TEST(GraphPatternDetecter, MarkPDNodesInGraph);
   FRIEND_TEST(GraphPatternDetecter, DetectPatterns);
+  FRIEND_TEST(GraphPatternDetector, IndexedMatch);
 #endif
 
  private:
@@ -654,7 +666,78 @@ struct BatchNormActGrad : public PatternBase {
   PATTERN_DECL_NODE(d_bn_bias);
 };
 
-// The following patterns are used to fuse elewise_add and act
+// The following pattern is used to fuse batch_norm, elementwise_add and act,
+// as the end of the residual blocks. The output of batch_norm could be either
+// input of elementwise_add.
+// formula: act(bn(x) + z)
+// op: batch_norm + elementwise_add + act
+struct BatchNormAddAct : public PatternBase {
+  BatchNormAddAct(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "bn_add_act") {}
+
+  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts);
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(batch_norm);
+  PATTERN_DECL_NODE(elewise_add);
+  PATTERN_DECL_NODE(act);
+  // declare variable node's name
+  // BN inputs
+  PATTERN_DECL_NODE(bn_scale);
+  PATTERN_DECL_NODE(bn_bias);
+  PATTERN_DECL_NODE(bn_variance);
+  PATTERN_DECL_NODE(bn_mean);
+  // BN outputs
+  PATTERN_DECL_NODE(bn_mean_out);
+  PATTERN_DECL_NODE(bn_variance_out);
+  PATTERN_DECL_NODE(bn_saved_variance);
+  PATTERN_DECL_NODE(bn_saved_mean);
+  PATTERN_DECL_NODE(bn_reserve_space);
+  PATTERN_DECL_NODE(bn_out);
+  // the other input of elementwise_add
+  PATTERN_DECL_NODE(elewise_add_in);
+  PATTERN_DECL_NODE(elewise_add_out);
+  // ACT output
+  PATTERN_DECL_NODE(act_out);
+};
+
+// the backward of act(bn(x) + z)
+// op: batch_norm_grad + elementwise_add_grad + act_grad
+struct BatchNormAddActGrad : public PatternBase {
+  BatchNormAddActGrad(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "bn_add_act_grad") {}
+
+  // act_grad: in["Out", "Out@GRAD"], out["X@GRAD"]
+  // elewise_add_grad: in["Out@GRAD"], out["X@GRAD", "Y@GRAD"]
+  // bn_grad: in["X", "Y@GRAD", "Scale", "Bias", "SavedMean", "SavedVariance",
+  // "ReserveSpace"],
+  // out["X@GRAD", "Scale@GRAD", "Bias@GRAD"]
+  PDNode* operator()(PDNode* x, std::unordered_set<std::string> act_grad_types);
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(act_grad);
+  PATTERN_DECL_NODE(elewise_add_grad);
+  PATTERN_DECL_NODE(batch_norm_grad);
+  // declare variable node's name
+  PATTERN_DECL_NODE(act_out);
+  PATTERN_DECL_NODE(d_act_x);
+  // the grads of the inputs of elementwise_add
+  PATTERN_DECL_NODE(d_bn_out);
+  PATTERN_DECL_NODE(d_elewise_add_in);
+  PATTERN_DECL_NODE(bn_x);
+  PATTERN_DECL_NODE(bn_scale);
+  PATTERN_DECL_NODE(bn_bias);
+  PATTERN_DECL_NODE(bn_saved_mean);
+  PATTERN_DECL_NODE(bn_saved_variance);
+  PATTERN_DECL_NODE(bn_reserve_space);
+  PATTERN_DECL_NODE(d_bn_x);
+  PATTERN_DECL_NODE(d_bn_scale);
+  PATTERN_DECL_NODE(d_bn_bias);
+};
+
+// The following patterns are used to fuse elewise_add and act, the
+// elementwise_add could be replaced by the other binary ops, e.g.
+// elementwise_mul.
 // formula: act(ele_add(x, y))
 // op: elementwise_add + act
 // named nodes: elementwise_add, act
@@ -663,7 +746,9 @@ struct ElewiseAddAct : public PatternBase {
   ElewiseAddAct(PDPattern* pattern, const std::string& name_scope)
       : PatternBase(pattern, name_scope, "elewise_add_act") {}
 
-  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts);
+  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts,
+                     std::unordered_set<std::string> binary_types = {
+                         "elementwise_add"});
 
   // declare operator node's name
   PATTERN_DECL_NODE(ele_add);
@@ -682,7 +767,9 @@ struct ActElewiseAdd : public PatternBase {
   ActElewiseAdd(PDPattern* pattern, const std::string& name_scope)
       : PatternBase(pattern, name_scope, "act_elewise_add") {}
 
-  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts);
+  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts,
+                     std::unordered_set<std::string> binary_types = {
+                         "elementwise_add"});
 
   // declare operator node's name
   PATTERN_DECL_NODE(act);
@@ -704,7 +791,9 @@ struct ElewiseAddActInplaceGrad : public PatternBase {
 
   // act_grad: in["Out", "Out@GRAD"], out["X@GRAD"]
   // ele_add_grad: in["Y", "Out@GRAD"], out["X@GRAD", "Y@GRAD"]
-  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts);
+  PDNode* operator()(PDNode* x, std::unordered_set<std::string> acts,
+                     std::unordered_set<std::string> binary_grad_types = {
+                         "elementwise_add_grad"});
 
   // declare operator node's name
   PATTERN_DECL_NODE(act_grad);
@@ -1197,6 +1286,24 @@ struct DeleteQuantDequantOpPattern : public PatternBase {
   PATTERN_DECL_NODE(any_op2);
 };
 
+// fake_quantize_moving_average_abs_max + fake_dequantize_max_abs
+// named nodes:
+// quant_in, quant_op, quant_out, quant_out_scale,
+// dequant_op, dequant_out
+struct FakeQuantDequantPattern : public PatternBase {
+  FakeQuantDequantPattern(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "fake_quant_dequant") {}
+
+  void operator()();
+
+  PATTERN_DECL_NODE(quant_in);
+  PATTERN_DECL_NODE(quant_op);
+  PATTERN_DECL_NODE(quant_out);
+  PATTERN_DECL_NODE(quant_out_scale);
+  PATTERN_DECL_NODE(dequant_op);
+  PATTERN_DECL_NODE(dequant_out);
+};
+
 // Reshape + Transpose + Matmul
 // named nodes:
 // reshape_op, reshape_out, reshape_xshape,
@@ -1243,13 +1350,15 @@ struct MatmulTransposeReshapePattern : public PatternBase {
 // Link two ir::Nodes from each other.
 #define IR_NODE_LINK_TO(a, b) \
   a->outputs.push_back(b);    \
-  b->inputs.push_back(a);
+  b->inputs.push_back(a);     \
+  ::paddle::framework::ir::Node::BumpLinkEpoch();
 
 // Set the out_var as the output of the op
 #define IR_OP_VAR_LINK(op, out_var) \
   op->outputs.push_back(out_var);   \
   out_var->inputs.clear();          \
-  out_var->inputs.push_back(op);
+  out_var->inputs.push_back(op);    \
+  ::paddle::framework::ir::Node::BumpLinkEpoch();
 
 }  // namespace ir
 }  // namespace framework
@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 
 #include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
 
 namespace paddle {
 namespace framework {
@@ -201,6 +202,70 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(PDNode, op_types) {
+  PDPattern pattern;
+  auto* op = pattern.NewNode("op")->assert_is_ops({"mul", "relu", "fc"});
+  ASSERT_EQ(op->op_types()->size(), 3UL);
+  op->assert_is_op("mul");
+  ASSERT_EQ(*op->op_types(), std::unordered_set<std::string>({"mul"}));
+
+  auto* var = pattern.NewNode("var")->assert_is_op_output("mul");
+  ASSERT_EQ(var->op_types(), nullptr);
+  auto* teller = pattern.NewNode([](Node* x) { return true; }, "teller");
+  ASSERT_EQ(teller->op_types(), nullptr);
+}
+
+TEST(GraphPatternDetector, IndexedMatch) {
+  // n times of mul -> elementwise_add -> relu, the outputs of the relu are
+  // multiplied by the next mul
+  const int n = 200;
+  Layers layers;
+  auto* x = layers.data("x", {1, 128});
+  auto* w = layers.data("w", {128, 128}, true);
+  auto* b = layers.data("b", {128}, true);
+  for (int i = 0; i < n; ++i) {
+    x = layers.relu(layers.elementwise_add(layers.mul(x, w), b));
+  }
+  Graph graph(layers.main_program());
+
+  GraphPatternDetector detector;
+  auto* pattern = detector.mutable_pattern();
+  auto* mul = pattern->NewNode("mul")->assert_is_op("mul");
+  auto* mul_out = pattern->NewNode("mul_out")
+                      ->assert_is_op_output("mul")
+                      ->assert_is_op_input("elementwise_add")
+                      ->AsIntermediate();
+  auto* add = pattern->NewNode("add")->assert_is_op("elementwise_add");
+  auto* add_out = pattern->NewNode("add_out")
+                      ->assert_is_op_output("elementwise_add")
+                      ->AsOutput();
+  // declare the edges from the end of the pattern
+  add->LinksTo({add_out});
+  mul_out->LinksTo({add});
+  mul->LinksTo({mul_out});
+
+  int count = 0;
+  detector(&graph, [&](const GraphPatternDetector::subgraph_t& s, Graph* g) {
+    ASSERT_EQ(s.at(mul)->outputs[0], s.at(mul_out));
+    ASSERT_EQ(s.at(add)->outputs[0], s.at(add_out));
+    ++count;
+  });
+  ASSERT_EQ(count, n);
+
+  // two disconnected edges, mul -> mul_out and relu -> relu_out
+  GraphPatternDetector disconnected;
+  pattern = disconnected.mutable_pattern();
+  mul = pattern->NewNode("mul")->assert_is_op("mul");
+  mul_out = pattern->NewNode("mul_out")->assert_is_op_output("mul");
+  auto* relu = pattern->NewNode("relu")->assert_is_op("relu");
+  auto* relu_out = pattern->NewNode("relu_out")->assert_is_op_output("relu");
+  mul->LinksTo({mul_out});
+  relu->LinksTo({relu_out});
+  ASSERT_TRUE(disconnected.MarkPDNodesInGraph(graph));
+  ASSERT_EQ(disconnected.DetectPatterns().size(),
+            static_cast<size_t>(n * n));
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -64,7 +64,7 @@ void GraphToProgramPass::ApplyImpl(ir::Graph* graph) const {
     nodes = TopologyVarientSort(
         *graph, static_cast<framework::ir::SortKind>(sort_kind));
   } else {
-    nodes = TopologySortOperations(*graph);
+    nodes = CachedTopologySortOperations(*graph);
   }
 
   for (ir::Node* n : nodes) {
@@ -80,4 +80,5 @@ void GraphToProgramPass::ApplyImpl(ir::Graph* graph) const {
 }  // namespace framework
 }  // namespace paddle
 
-REGISTER_PASS(graph_to_program_pass, paddle::framework::ir::GraphToProgramPass);
+REGISTER_PASS(graph_to_program_pass, paddle::framework::ir::GraphToProgramPass)
+    .PreserveAllAnalyses();
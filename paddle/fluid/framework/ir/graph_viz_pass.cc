@@ -143,4 +143,5 @@ GraphVizPass::marked_nodes_t GraphVizPass::ConsumeMarkedNodes(
 }  // namespace paddle
 
 REGISTER_PASS(graph_viz_pass, paddle::framework::ir::GraphVizPass)
-    .RequirePassAttr(paddle::framework::ir::kGraphvizPath);
+    .RequirePassAttr(paddle::framework::ir::kGraphvizPath)
+    .PreserveAllAnalyses();
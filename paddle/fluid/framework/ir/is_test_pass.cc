@@ -52,4 +52,5 @@ void IsTestPass::ApplyImpl(ir::Graph* graph) const {
 }  // namespace framework
 }  // namespace paddle
 
-REGISTER_PASS(is_test_pass, paddle::framework::ir::IsTestPass);
+REGISTER_PASS(is_test_pass, paddle::framework::ir::IsTestPass)
+    .PreserveAllAnalyses();
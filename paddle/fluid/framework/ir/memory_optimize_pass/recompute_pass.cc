@@ -0,0 +1,338 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/garbage_collector.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The names of the checkpoint variables, whose type is
+// std::vector<std::string>. The activations between checkpoints are
+// recomputed in backward.
+constexpr char kRecomputeCheckpoints[] = "recompute_checkpoints";
+// The estimated bytes of the activations between two checkpoints which are
+// picked automatically, whose type is int64_t. The unknown dimensions (-1)
+// are taken as 1, so it is the bytes per sample for most models. It is only
+// used when no checkpoint is given, and sqrt(n) checkpoints are picked if it
+// is not positive.
+constexpr char kRecomputeMemoryBudget[] = "recompute_memory_budget";
+
+constexpr char kRecomputeVarSuffix[] = "@RECOMPUTE";
+
+/*
+ * RecomputePass trades compute for memory. The forward ops are split into
+ * segments by the checkpoints. The activations of a segment which are read
+ * by the backward ops are recomputed by copies of the forward ops of the
+ * segment, and the backward ops read the recomputed ones instead.
+ *
+ * The recomputed ops depend on the backward op right before the first
+ * backward op which reads the segment, so that they run just before the
+ * activations are needed. Since the original activations are only read by
+ * the forward ops then, the reference counting of eager_deletion_pass frees
+ * them after the forward, and frees the recomputed ones after the backward
+ * of the segment.
+ *
+ * The ops with random outputs, sub-blocks or inplace outputs are not
+ * recomputed, and their outputs are kept as checkpoints.
+ */
+class RecomputePass : public Pass {
+ protected:
+  void ApplyImpl(Graph *graph) const override;
+
+ private:
+  std::unordered_set<std::string> PickCheckpoints(
+      const std::vector<Node *> &forward_ops,
+      const std::unordered_set<Node *> &dropped_vars) const;
+};
+
+static int GetOpRole(Node *node) {
+  return BOOST_GET_CONST(
+      int, node->Op()->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+}
+
+static bool IsForwardOp(Node *node) {
+  return (GetOpRole(node) & ~static_cast<int>(OpRole::kLoss)) ==
+         static_cast<int>(OpRole::kForward);
+}
+
+static bool IsBackwardOp(Node *node) {
+  return (GetOpRole(node) & static_cast<int>(OpRole::kBackward)) != 0;
+}
+
+static bool CanRecompute(Node *op) {
+  static const std::unordered_set<std::string> kRandomOps = {
+      "dropout",        "uniform_random",
+      "gaussian_random", "truncated_gaussian_random",
+      "sampling_id",    "random_crop",
+      "uniform_random_batch_size_like",
+      "gaussian_random_batch_size_like"};
+  auto *op_desc = op->Op();
+  if (kRandomOps.count(op_desc->Type()) > 0) return false;
+  for (auto &attr_name : op_desc->AttrNames()) {
+    auto type = op_desc->GetAttrType(attr_name);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return false;
+    }
+  }
+  auto inputs = op_desc->InputArgumentNames();
+  std::unordered_set<std::string> input_set(inputs.begin(), inputs.end());
+  for (auto &out : op_desc->OutputArgumentNames()) {
+    if (input_set.count(out) > 0) return false;
+  }
+  return true;
+}
+
+static bool IsReadByBackwardOp(Node *var) {
+  return std::any_of(var->outputs.begin(), var->outputs.end(),
+                     [](Node *op) { return IsBackwardOp(op); });
+}
+
+static bool IsActivation(Node *var) {
+  return var->IsVar() && !var->IsCtrlVar() && var->Var() != nullptr &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         !var->Var()->Persistable();
+}
+
+static int64_t EstimateBytes(const VarDesc &var) {
+  int64_t numel = 1;
+  for (auto dim : var.GetShape()) {
+    numel *= std::max<int64_t>(std::abs(dim), 1);
+  }
+  return numel * static_cast<int64_t>(SizeOfType(var.GetDataType()));
+}
+
+std::unordered_set<std::string> RecomputePass::PickCheckpoints(
+    const std::vector<Node *> &forward_ops,
+    const std::unordered_set<Node *> &dropped_vars) const {
+  int64_t budget = Has(kRecomputeMemoryBudget)
+                       ? Get<int64_t>(kRecomputeMemoryBudget)
+                       : static_cast<int64_t>(0);
+  if (budget <= 0 && !dropped_vars.empty()) {
+    int64_t total = 0;
+    for (auto *var : dropped_vars) {
+      total += EstimateBytes(*var->Var());
+    }
+    budget = static_cast<int64_t>(
+        total / std::sqrt(static_cast<double>(dropped_vars.size())));
+  }
+
+  std::unordered_set<std::string> checkpoints;
+  int64_t bytes = 0;
+  for (auto *op : forward_ops) {
+    std::vector<std::string> outputs;
+    for (auto *out : op->outputs) {
+      if (dropped_vars.count(out) > 0) {
+        bytes += EstimateBytes(*out->Var());
+        outputs.emplace_back(out->Name());
+      }
+    }
+    if (!outputs.empty() && bytes >= budget) {
+      checkpoints.insert(outputs.begin(), outputs.end());
+      bytes = 0;
+    }
+  }
+  VLOG(3) << "Pick " << checkpoints.size()
+          << " checkpoints with memory budget " << budget;
+  return checkpoints;
+}
+
+void RecomputePass::ApplyImpl(Graph *graph) const {
+  if (GetEagerDeletionThreshold() < 0) {
+    LOG(WARNING) << "recompute_pass saves no memory since eager deletion is "
+                    "disabled, please set FLAGS_eager_delete_tensor_gb >= 0";
+  }
+
+  auto ops = TopologySortOperations(*graph);
+  std::unordered_map<Node *, size_t> op_idx;
+  std::vector<Node *> forward_ops;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    op_idx[ops[i]] = i;
+    if (IsForwardOp(ops[i])) {
+      forward_ops.emplace_back(ops[i]);
+    }
+  }
+
+  // The activations which are generated by the forward ops and read by the
+  // backward ops, i.e., the memory held from forward to backward.
+  std::unordered_set<Node *> dropped_vars;
+  for (auto *op : forward_ops) {
+    if (!CanRecompute(op)) continue;
+    for (auto *out : op->outputs) {
+      if (IsActivation(out) && IsReadByBackwardOp(out)) {
+        dropped_vars.insert(out);
+      }
+    }
+  }
+
+  std::unordered_set<std::string> checkpoints;
+  if (Has(kRecomputeCheckpoints) &&
+      !Get<std::vector<std::string>>(kRecomputeCheckpoints).empty()) {
+    auto &names = Get<std::vector<std::string>>(kRecomputeCheckpoints);
+    checkpoints.insert(names.begin(), names.end());
+  } else {
+    checkpoints = PickCheckpoints(forward_ops, dropped_vars);
+  }
+
+  // Split the forward ops into segments by the checkpoints.
+  std::vector<std::vector<Node *>> segments(1);
+  for (auto *op : forward_ops) {
+    segments.back().emplace_back(op);
+    bool is_checkpoint_op =
+        std::any_of(op->outputs.begin(), op->outputs.end(),
+                    [&](Node *out) { return checkpoints.count(out->Name()); });
+    if (is_checkpoint_op) segments.emplace_back();
+  }
+
+  std::unordered_set<Node *> recompute_ops;
+  size_t recompute_var_num = 0;
+  for (auto &segment : segments) {
+    std::unordered_set<Node *> segment_ops(segment.begin(), segment.end());
+    // Find the ops to recompute in reverse order.
+    std::unordered_set<Node *> needed_vars;
+    std::unordered_set<Node *> needed_ops;
+    for (auto it = segment.rbegin(); it != segment.rend(); ++it) {
+      auto *op = *it;
+      if (!CanRecompute(op)) continue;
+      bool needed = false;
+      for (auto *out : op->outputs) {
+        if (checkpoints.count(out->Name()) > 0) continue;
+        if (dropped_vars.count(out) > 0 || needed_vars.count(out) > 0) {
+          needed = true;
+        }
+      }
+      if (!needed) continue;
+      needed_ops.insert(op);
+      for (auto *in : op->inputs) {
+        if (IsActivation(in) && !in->inputs.empty() &&
+            segment_ops.count(in->inputs[0]) > 0 &&
+            checkpoints.count(in->Name()) == 0) {
+          needed_vars.insert(in);
+        }
+      }
+    }
+    if (needed_ops.empty()) continue;
+
+    // The first backward op which reads the activations of the segment.
+    size_t first_reader_idx = ops.size();
+    for (auto *op : needed_ops) {
+      for (auto *out : op->outputs) {
+        for (auto *reader : out->outputs) {
+          if (IsBackwardOp(reader) && recompute_ops.count(reader) == 0) {
+            first_reader_idx = std::min(first_reader_idx, op_idx.at(reader));
+          }
+        }
+      }
+    }
+    Node *trigger = nullptr;
+    for (size_t i = first_reader_idx; i > 0 && i <= ops.size(); --i) {
+      if (IsBackwardOp(ops[i - 1])) {
+        trigger = ops[i - 1];
+        break;
+      }
+    }
+    if (trigger == nullptr) {
+      VLOG(3) << "Skip the segment read by the first backward op";
+      continue;
+    }
+
+    std::unordered_map<Node *, Node *> recomputed;
+    for (auto *op : segment) {
+      if (needed_ops.count(op) == 0) continue;
+      OpDesc op_desc(*op->Op(), op->Op()->Block());
+      op_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                      static_cast<int>(OpRole::kBackward));
+      std::vector<Node *> inputs, outputs;
+      for (auto *in : op->inputs) {
+        if (in->IsCtrlVar()) continue;
+        auto iter = recomputed.find(in);
+        if (iter != recomputed.end()) {
+          op_desc.RenameInput(in->Name(), iter->second->Name());
+          inputs.emplace_back(iter->second);
+        } else {
+          inputs.emplace_back(in);
+        }
+      }
+      for (auto *out : op->outputs) {
+        if (out->IsCtrlVar() || out->Var() == nullptr) continue;
+        VarDesc var_desc(*out->Var());
+        var_desc.SetName(out->Name() + kRecomputeVarSuffix);
+        var_desc.SetPersistable(false);
+        auto *var = graph->CreateVarNode(&var_desc);
+        op_desc.RenameOutput(out->Name(), var_desc.Name());
+        recomputed[out] = var;
+        outputs.emplace_back(var);
+      }
+
+      auto *recompute_op = graph->CreateOpNode(&op_desc);
+      for (auto *in : inputs) {
+        recompute_op->inputs.emplace_back(in);
+        in->outputs.emplace_back(recompute_op);
+      }
+      for (auto *out : outputs) {
+        recompute_op->outputs.emplace_back(out);
+        out->inputs.emplace_back(recompute_op);
+      }
+      auto *dep_var = graph->CreateControlDepVar();
+      trigger->outputs.emplace_back(dep_var);
+      dep_var->inputs.emplace_back(trigger);
+      dep_var->outputs.emplace_back(recompute_op);
+      recompute_op->inputs.emplace_back(dep_var);
+      recompute_ops.insert(recompute_op);
+    }
+
+    // Let the backward ops read the recomputed activations. The recomputed
+    // ops of other segments still read the original ones, otherwise they
+    // would wait for each other.
+    for (auto &pair : recomputed) {
+      auto *origin = pair.first;
+      auto *var = pair.second;
+      for (auto it = origin->outputs.begin(); it != origin->outputs.end();) {
+        auto *reader = *it;
+        if (!IsBackwardOp(reader) || recompute_ops.count(reader) > 0) {
+          ++it;
+          continue;
+        }
+        reader->Op()->RenameInput(origin->Name(), var->Name());
+        std::replace(reader->inputs.begin(), reader->inputs.end(), origin,
+                     var);
+        var->outputs.emplace_back(reader);
+        it = origin->outputs.erase(it);
+      }
+    }
+    recompute_var_num += recomputed.size();
+  }
+
+  VLOG(1) << "recompute_pass splits " << forward_ops.size()
+          << " forward ops into " << segments.size() << " segments, and "
+          << "recomputes " << recompute_ops.size() << " ops, "
+          << recompute_var_num << " variables";
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(recompute_pass, paddle::framework::ir::RecomputePass);
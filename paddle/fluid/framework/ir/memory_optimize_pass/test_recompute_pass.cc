@@ -0,0 +1,129 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void SetOp(ProgramDesc *prog, const std::string &type,
+                  const std::string &name,
+                  const std::vector<std::string> &inputs,
+                  const std::vector<std::string> &outputs, OpRole role) {
+  auto *op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("name", name);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(role));
+}
+
+// forward:  a->f1->b->f2->c->f3->d->loss_op->loss
+// backward: fill->d@GRAD, (d, d@GRAD)->g3->c@GRAD,
+//           (c, c@GRAD)->g2->b@GRAD, (b, b@GRAD)->g1->a@GRAD
+static ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto &v : std::vector<std::string>(
+           {"a", "b", "c", "d", "loss", "d@GRAD", "c@GRAD", "b@GRAD",
+            "a@GRAD"})) {
+    prog.MutableBlock(0)->Var(v)->SetShape({-1, 32});
+  }
+  SetOp(&prog, "relu", "f1", {"a"}, {"b"}, OpRole::kForward);
+  SetOp(&prog, "relu", "f2", {"b"}, {"c"}, OpRole::kForward);
+  SetOp(&prog, "relu", "f3", {"c"}, {"d"}, OpRole::kForward);
+  SetOp(&prog, "mean", "loss_op", {"d"}, {"loss"},
+        static_cast<OpRole>(static_cast<int>(OpRole::kForward) |
+                            static_cast<int>(OpRole::kLoss)));
+  SetOp(&prog, "fill_constant", "fill", {}, {"d@GRAD"},
+        static_cast<OpRole>(static_cast<int>(OpRole::kBackward) |
+                            static_cast<int>(OpRole::kLoss)));
+  SetOp(&prog, "relu_grad", "g3", {"d", "d@GRAD"}, {"c@GRAD"},
+        OpRole::kBackward);
+  SetOp(&prog, "relu_grad", "g2", {"c", "c@GRAD"}, {"b@GRAD"},
+        OpRole::kBackward);
+  SetOp(&prog, "relu_grad", "g1", {"b", "b@GRAD"}, {"a@GRAD"},
+        OpRole::kBackward);
+  return prog;
+}
+
+static std::vector<std::string> InputsOf(const Graph &graph,
+                                         const std::string &op_name) {
+  for (auto *node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->HasAttr("name") &&
+        BOOST_GET_CONST(std::string, node->Op()->GetAttr("name")) ==
+            op_name &&
+        node->Op()->Type() == "relu_grad") {
+      return node->Op()->Input("X");
+    }
+  }
+  return {};
+}
+
+TEST(RecomputePass, given_checkpoints) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<Graph> graph(new Graph(prog));
+  auto pass = PassRegistry::Instance().Get("recompute_pass");
+  pass->Set<std::vector<std::string>>(
+      "recompute_checkpoints", new std::vector<std::string>({"c"}));
+  graph.reset(pass->Apply(graph.release()));
+
+  ASSERT_FALSE(HasCircle(*graph));
+  int recompute_op_num = 0;
+  for (auto *node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "relu" &&
+        BOOST_GET_CONST(int, node->Op()->GetAttr(
+                                 OpProtoAndCheckerMaker::OpRoleAttrName())) ==
+            static_cast<int>(OpRole::kBackward)) {
+      ++recompute_op_num;
+    }
+  }
+  // f1 and f3 are recomputed, and f2 generates the checkpoint.
+  ASSERT_EQ(recompute_op_num, 2);
+  ASSERT_EQ(InputsOf(*graph, "g1"),
+            std::vector<std::string>({"b@RECOMPUTE", "b@GRAD"}));
+  ASSERT_EQ(InputsOf(*graph, "g2"),
+            std::vector<std::string>({"c", "c@GRAD"}));
+  ASSERT_EQ(InputsOf(*graph, "g3"),
+            std::vector<std::string>({"d@RECOMPUTE", "d@GRAD"}));
+}
+
+TEST(RecomputePass, auto_checkpoints) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<Graph> graph(new Graph(prog));
+  auto pass = PassRegistry::Instance().Get("recompute_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  ASSERT_FALSE(HasCircle(*graph));
+  // b, c and d hold 128 bytes each, so the budget is 384 / sqrt(3) bytes and
+  // c is picked as the checkpoint.
+  ASSERT_EQ(InputsOf(*graph, "g1"),
+            std::vector<std::string>({"b@RECOMPUTE", "b@GRAD"}));
+  ASSERT_EQ(InputsOf(*graph, "g2"),
+            std::vector<std::string>({"c", "c@GRAD"}));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(recompute_pass);
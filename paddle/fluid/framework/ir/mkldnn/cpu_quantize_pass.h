@@ -60,6 +60,10 @@ class CPUQuantizePass : public FusePassBase {
 
   void QuantizeMatmul(Graph* graph) const;
 
+  // Both inputs and the output are quantized with the scale of the output,
+  // so that the int8 sum of the inputs is the quantized output.
+  void QuantizeElementwiseAdd(Graph* graph) const;
+
   void QuantizeInput(Graph* g, Node* op, Node* input, std::string input_name,
                      double scale_to_one, bool is_unsigned,
                      std::string scale_attr_name = "") const;
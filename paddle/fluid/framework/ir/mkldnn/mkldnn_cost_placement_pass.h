@@ -0,0 +1,36 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/cost_placement_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Moves the groups of the ops placed on MKLDNN back to the native kernels
+ * if they are not faster according to the cost table.
+ */
+class MKLDNNCostPlacementPass : public CostPlacementPassBase {
+ private:
+  const std::string GetLibraryName() const override { return "mkldnn"; }
+  const std::string GetAttrName() const override { return "use_mkldnn"; }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,105 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/mkldnn/mkldnn_cost_placement_pass.h"
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+bool UseMKLDNN(const std::unique_ptr<Graph>& graph,
+               const std::string& op_type) {
+  for (auto* n : graph->Nodes()) {
+    if (n->IsOp() && n->Op()->Type() == op_type) {
+      return n->Op()->GetAttrIfExists<bool>("use_mkldnn");
+    }
+  }
+  return false;
+}
+
+TEST(MKLDNNCostPlacementPass, conversions) {
+  // operator                        use_mkldnn
+  // ------------------------------------------------
+  // (x, filter, bias)->conv2d->c1   true
+  // c1->relu->c2                    true
+  // c2->softmax->c3                 false
+  // c3->scale->c4                   true
+  Layers layers;
+  auto* x = layers.data("x", {1, 1000});
+  auto* filter = layers.data("filter", {1, 1, 1, 1}, true);
+  auto* bias = layers.data("bias", {1}, true);
+  auto* c1 = layers.conv2d(x, filter, bias);
+  auto* c2 = layers.relu(c1);
+  auto* c3 = layers.softmax(c2, -1);
+  auto* c4 = layers.scale(c3, 2.f, 0.f, true);
+  for (auto* var : {c1, c2, c3, c4}) {
+    var->SetShape({-1, 1000});
+  }
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  for (auto* n : graph->Nodes()) {
+    if (n->IsOp()) {
+      n->Op()->SetAttr("use_mkldnn", n->Op()->Type() != "softmax");
+    }
+  }
+
+  // the conv2d and relu are faster on MKLDNN even with the conversions of
+  // x and c2, and the conversions of c3 and c4 cost more than the scale
+  std::string table_path = "mkldnn_cost_table.txt";
+  std::ofstream table(table_path);
+  table << "# op type library fixed_us us_per_k_elements\n"
+        << "op conv2d native 100 10\n"
+        << "op conv2d mkldnn 10 1\n"
+        << "op relu native 1 1\n"
+        << "op relu mkldnn 1 0.5\n"
+        << "op scale native 1 1\n"
+        << "op scale mkldnn 1 0.5\n"
+        << "convert native mkldnn 2\n"
+        << "convert mkldnn native 2\n";
+  table.close();
+
+  auto pass = PassRegistry::Instance().Get("mkldnn_cost_placement_pass");
+  pass->Set("cost_table", new std::string(table_path));
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_TRUE(UseMKLDNN(graph, "conv2d"));
+  EXPECT_TRUE(UseMKLDNN(graph, "relu"));
+  EXPECT_FALSE(UseMKLDNN(graph, "softmax"));
+  EXPECT_FALSE(UseMKLDNN(graph, "scale"));
+}
+
+TEST(PlacementCostTable, load) {
+  auto table = PlacementCostTable::LoadFromString(
+      "op relu native 1 2\n"
+      "\n"
+      "convert native mkldnn 4\n");
+  double cost;
+  ASSERT_TRUE(table.OpCost("relu", "native", 500, &cost));
+  EXPECT_DOUBLE_EQ(cost, 2.);
+  EXPECT_FALSE(table.OpCost("relu", "mkldnn", 500, &cost));
+  EXPECT_DOUBLE_EQ(table.ConvertCost("native", "mkldnn", 2000), 8.);
+  EXPECT_DOUBLE_EQ(table.ConvertCost("mkldnn", "native", 2000), 0.);
+  EXPECT_ANY_THROW(PlacementCostTable::LoadFromString("op relu native\n"));
+  EXPECT_ANY_THROW(PlacementCostTable::LoadFromString("unknown\n"));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(mkldnn_cost_placement_pass);
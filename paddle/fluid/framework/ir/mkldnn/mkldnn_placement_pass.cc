@@ -15,4 +15,5 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/mkldnn/mkldnn_placement_pass.h"
 
 REGISTER_PASS(mkldnn_placement_pass, paddle::framework::ir::MKLDNNPlacementPass)
-    .RequirePassAttr("mkldnn_enabled_op_types");
+    .RequirePassAttr("mkldnn_enabled_op_types")
+    .PreserveAllAnalyses();
@@ -14,11 +14,13 @@
 
 #include "paddle/fluid/framework/ir/multi_batch_merge_pass.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include "paddle/fluid/framework/details/op_handle_base.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
 
@@ -27,6 +29,7 @@ namespace framework {
 namespace ir {
 
 static const char kNumRepeats[] = "num_repeats";
+static const char kRuntimeAccumulation[] = "runtime_accumulation";
 typedef std::unordered_map<std::string, std::vector<ir::Node*>> SSAVarList;
 
 ir::Node* SameNameVar(std::unordered_set<ir::Node*> all, ir::Node* target) {
@@ -69,8 +72,157 @@ VarDesc UpdateGradVarDesc(
   return *var_desc;
 }
 
+static int GetOpRole(ir::Node* node) {
+  PADDLE_ENFORCE_NOT_NULL(node->Op(), platform::errors::InvalidArgument(
+                                          "Node %s must have an OpDesc.",
+                                          node->Name()));
+  return BOOST_GET_CONST(
+      int, node->Op()->GetAttr(
+               framework::OpProtoAndCheckerMaker::OpRoleAttrName()));
+}
+
+static bool IsOptimizeOrLRSchedOp(ir::Node* node) {
+  int op_role = GetOpRole(node);
+  return (op_role & static_cast<int>(framework::OpRole::kOptimize)) ||
+         (op_role & static_cast<int>(framework::OpRole::kDist)) ||
+         (op_role & static_cast<int>(framework::OpRole::kRPC)) ||
+         (op_role & static_cast<int>(framework::OpRole::kLRSched));
+}
+
+static ir::Node* CreateOpWithIO(ir::Graph* graph, OpDesc* op_desc,
+                                const std::vector<ir::Node*>& inputs,
+                                const std::vector<ir::Node*>& outputs) {
+  op_desc->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                   static_cast<int>(OpRole::kBackward));
+  auto* op_node = graph->CreateOpNode(op_desc);
+  for (auto* in : inputs) {
+    op_node->inputs.push_back(in);
+    in->outputs.push_back(op_node);
+  }
+  for (auto* out : outputs) {
+    op_node->outputs.push_back(out);
+    out->inputs.push_back(op_node);
+  }
+  return op_node;
+}
+
+// Instead of copying the forward and backward ops num_repeats times, run the
+// same graph num_repeats times and accumulate the gradients into persistable
+// buffers. For each gradient g read by the optimize ops, it inserts:
+//
+//   fill_zeros_like(g) -> g@MERGED      (on the first step of num_repeats)
+//   sum(g@MERGED, g) -> g@MERGED        (on every step)
+//   scale(g@MERGED, 1/num_repeats) -> g (on the last step of num_repeats)
+//
+// and the optimize and lr ops only run on the last step. Since the collective
+// ops are inserted after the ops which generate g, the gradients are still
+// all-reduced on every step when there are multiple devices.
+static void ApplyRuntimeAccumulation(ir::Graph* graph, int num_repeats) {
+  std::vector<ir::Node*> optimize_ops;
+  std::unordered_set<std::string> grad_names;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (!IsOptimizeOrLRSchedOp(node)) continue;
+    optimize_ops.push_back(node);
+    if (!node->Op()->HasAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName())) {
+      continue;
+    }
+    auto op_role_vars = BOOST_GET_CONST(
+        std::vector<std::string>,
+        node->Op()->GetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName()));
+    for (size_t i = 1; i < op_role_vars.size(); i += 2) {
+      grad_names.insert(op_role_vars[i]);
+    }
+  }
+
+  std::unordered_set<ir::Node*> optimize_op_set(optimize_ops.begin(),
+                                                optimize_ops.end());
+  for (auto* node : optimize_ops) {
+    node->Op()->SetAttr(details::kOpRunPeriodAttr, num_repeats);
+    node->Op()->SetAttr(details::kOpRunPhaseAttr, num_repeats - 1);
+  }
+
+  // The gradient nodes generated by the backward ops and read by the
+  // optimize ops.
+  std::map<std::string, ir::Node*> grad_nodes;
+  for (auto* node : optimize_ops) {
+    for (auto* in : node->inputs) {
+      if (!in->IsVar() || in->IsCtrlVar() ||
+          grad_names.count(in->Name()) == 0) {
+        continue;
+      }
+      bool generated_by_optimize_op =
+          !in->inputs.empty() && optimize_op_set.count(in->inputs[0]) > 0;
+      if (!generated_by_optimize_op) {
+        grad_nodes.emplace(in->Name(), in);
+      }
+    }
+  }
+
+  for (auto& pair : grad_nodes) {
+    auto* grad_node = pair.second;
+    PADDLE_ENFORCE_EQ(
+        grad_node->Var()->GetType(), proto::VarType::LOD_TENSOR,
+        platform::errors::Unimplemented(
+            "The runtime gradient accumulation only supports dense "
+            "gradients, but %s is not a LoDTensor.",
+            pair.first));
+
+    VarDesc merged_var(pair.first + "@MERGED");
+    merged_var.SetType(proto::VarType::LOD_TENSOR);
+    merged_var.SetShape(grad_node->Var()->GetShape());
+    merged_var.SetDataType(grad_node->Var()->GetDataType());
+    merged_var.SetPersistable(true);
+    auto* zeroed_node = graph->CreateVarNode(&merged_var);
+    auto* merged_node = graph->CreateVarNode(&merged_var);
+    auto* scaled_node = graph->CreateVarNode(grad_node->Var());
+
+    OpDesc fill_op;
+    fill_op.SetType("fill_zeros_like");
+    fill_op.SetInput("X", {pair.first});
+    fill_op.SetOutput("Out", {merged_var.Name()});
+    fill_op.SetAttr(details::kOpRunPeriodAttr, num_repeats);
+    fill_op.SetAttr(details::kOpRunPhaseAttr, 0);
+    CreateOpWithIO(graph, &fill_op, {grad_node}, {zeroed_node});
+
+    OpDesc sum_op;
+    sum_op.SetType("sum");
+    sum_op.SetInput("X", {merged_var.Name(), pair.first});
+    sum_op.SetOutput("Out", {merged_var.Name()});
+    CreateOpWithIO(graph, &sum_op, {zeroed_node, grad_node}, {merged_node});
+
+    OpDesc scale_op;
+    scale_op.SetType("scale");
+    scale_op.SetInput("X", {merged_var.Name()});
+    scale_op.SetOutput("Out", {pair.first});
+    scale_op.SetAttr("scale", static_cast<float>(1.0f / num_repeats));
+    scale_op.SetAttr(details::kOpRunPeriodAttr, num_repeats);
+    scale_op.SetAttr(details::kOpRunPhaseAttr, num_repeats - 1);
+    CreateOpWithIO(graph, &scale_op, {merged_node}, {scaled_node});
+
+    // Let the optimize ops read the accumulated gradient.
+    for (auto it = grad_node->outputs.begin();
+         it != grad_node->outputs.end();) {
+      if (optimize_op_set.count(*it) == 0) {
+        ++it;
+        continue;
+      }
+      auto* op = *it;
+      std::replace(op->inputs.begin(), op->inputs.end(), grad_node,
+                   scaled_node);
+      scaled_node->outputs.push_back(op);
+      it = grad_node->outputs.erase(it);
+    }
+    VLOG(3) << "accumulate " << pair.first << " in " << merged_var.Name()
+            << " for " << num_repeats << " steps";
+  }
+}
+
 void BatchMergePass::ApplyImpl(ir::Graph* graph) const {
   int num_repeats = Get<const int>(kNumRepeats);
+  if (Has(kRuntimeAccumulation) && Get<bool>(kRuntimeAccumulation)) {
+    ApplyRuntimeAccumulation(graph, num_repeats);
+    return;
+  }
   std::vector<Node*> forward_backward_ops;
   std::vector<Node*> optimize_ops;
   std::vector<Node*> lr_ops;  // ops other than forward/backward/optimize
@@ -30,6 +30,11 @@ namespace ir {
 // This pass is extremely useful when doing large batch-size distributed
 // sync training, we can simulate even large batch size as if we have more
 // GPUs.
+// If the attribute runtime_accumulation is true, the ops are not copied.
+// Instead, the same graph runs num_repeats times and accumulates the
+// gradients in persistable buffers, and the optimize ops only run on every
+// num_repeats-th step, so that the graph size does not grow with
+// num_repeats.
 
 class BatchMergePass : public Pass {
  public:
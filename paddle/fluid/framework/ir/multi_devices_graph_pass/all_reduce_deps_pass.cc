@@ -28,6 +28,9 @@
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
+#if defined(PADDLE_WITH_NCCL)
+#include "paddle/fluid/framework/details/sparse_all_gather_op_handle.h"
+#endif
 
 namespace paddle {
 namespace framework {
@@ -113,8 +116,17 @@ class AllReduceDepsPass : public ir::Pass {
           dynamic_cast<details::AllReduceOpHandle*>(op_handle);
       auto fused_all_reduce_op_handle =
           dynamic_cast<details::FusedAllReduceOpHandle*>(op_handle);
+      bool is_collective_op =
+          all_reduce_op_handle || fused_all_reduce_op_handle;
+#if defined(PADDLE_WITH_NCCL)
+      // The sparse all gather ops are ordered with the all reduce ops, since
+      // they share the same NCCL communicators.
+      is_collective_op =
+          is_collective_op ||
+          dynamic_cast<details::SparseAllGatherOpHandle*>(op_handle);
+#endif
 
-      if (all_reduce_op_handle || fused_all_reduce_op_handle) {
+      if (is_collective_op) {
         current_all_reduce_op_handles.emplace_back(op_handle);
       }
     }
@@ -140,6 +140,11 @@ class FuseAllReduceOpPass : public ir::Pass {
                             ir::Graph *result) const {
     std::vector<details::VarHandleBase *> inputs;
     std::vector<details::VarHandleBase *> outputs;
+    // The fused op communicates in the same precision as the fused ones.
+    auto &first_all_reduce = dynamic_cast<details::AllReduceOpHandle &>(
+        all_reduce_ops.at(0)->Wrapper<details::OpHandleBase>());
+    bool fp16_allreduce = first_all_reduce.IsFP16AllReduce();
+    bool error_feedback = first_all_reduce.IsFP16AllReduceErrorFeedback();
     for (auto &op : all_reduce_ops) {
       auto &op_handle = op->Wrapper<details::OpHandleBase>();
       inputs.insert(inputs.end(), op_handle.Inputs().begin(),
@@ -162,16 +167,18 @@ class FuseAllReduceOpPass : public ir::Pass {
     }
 
 #if defined(PADDLE_WITH_NCCL)
-    CreateFusedAllReduceOp(inputs, outputs, num_of_all_reduce, places,
-                           local_scopes, multi_nccl_ctxs, result);
+    auto *op_handle =
+        CreateFusedAllReduceOp(inputs, outputs, num_of_all_reduce, places,
+                               local_scopes, multi_nccl_ctxs, result);
 #else
-    CreateFusedAllReduceOp(inputs, outputs, num_of_all_reduce, places,
-                           local_scopes, result);
+    auto *op_handle = CreateFusedAllReduceOp(
+        inputs, outputs, num_of_all_reduce, places, local_scopes, result);
 #endif
+    op_handle->SetFP16AllReduce(fp16_allreduce, error_feedback);
   }
 
  private:
-  void CreateFusedAllReduceOp(
+  details::FusedAllReduceOpHandle *CreateFusedAllReduceOp(
       const std::vector<details::VarHandleBase *> &inputs,
       const std::vector<details::VarHandleBase *> &outputs,
       const size_t num_of_all_reduce,
@@ -206,6 +213,7 @@ class FuseAllReduceOpPass : public ir::Pass {
 #else
     SetCommunicationContext(places, op_handle);
 #endif
+    return op_handle;
   }
 
   void SetCommunicationContext(
@@ -20,6 +20,7 @@
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/details/all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/broadcast_op_handle.h"
 #include "paddle/fluid/framework/details/computation_op_handle.h"
@@ -34,6 +35,9 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
+#if defined(PADDLE_WITH_NCCL)
+#include "paddle/fluid/framework/details/sparse_all_gather_op_handle.h"
+#endif
 #if defined(PADDLE_WITH_DGC)
 #include "paddle/fluid/framework/details/sparse_all_reduce_op_handle.h"
 #endif
@@ -487,7 +491,14 @@ void MultiDevSSAGraphBuilderBase::CreateAllReduceOp(ir::Graph *result,
             result->CreateEmptyNode("allreduce", ir::Node::Type::kOperation),
             scopes, places));
 #endif
-    return result->Get<GraphOps>(kGraphOps).back();
+    auto *all_reduce_op = result->Get<GraphOps>(kGraphOps).back();
+    // The encoded gradients of DGC are compressed already.
+    if (!is_encoded) {
+      dynamic_cast<details::AllReduceOpHandle *>(all_reduce_op)
+          ->SetFP16AllReduce(strategy_.fp16_allreduce_,
+                             strategy_.fp16_allreduce_error_feedback_);
+    }
+    return all_reduce_op;
   };
 
   if (!strategy_.enable_parallel_graph_)
@@ -515,6 +526,45 @@ void MultiDevSSAGraphBuilderBase::CreateAllReduceOp(ir::Graph *result,
   }
 }
 
+bool MultiDevSSAGraphBuilderBase::UseSparseAllGather(
+    const std::string &og) const {
+#if defined(PADDLE_WITH_NCCL)
+  return strategy_.use_sparse_all_gather_ && multi_nccl_ctxs_ != nullptr &&
+         !strategy_.enable_parallel_graph_ &&
+         !strategy_.use_hierarchical_allreduce_ && IsSparseGradient(og);
+#else
+  return false;
+#endif
+}
+
+void MultiDevSSAGraphBuilderBase::CreateSparseAllGatherOp(
+    ir::Graph *result, const std::string &og) const {
+#if defined(PADDLE_WITH_NCCL)
+  auto *op_handle = new details::SparseAllGatherOpHandle(
+      result->CreateEmptyNode("sparse_all_gather", ir::Node::Type::kOperation),
+      local_scopes_, places_, multi_nccl_ctxs_,
+      strategy_.num_trainers_ * places_.size());
+  result->Get<GraphOps>(kGraphOps).emplace_back(op_handle);
+
+  for (size_t i = 0; i < places_.size(); ++i) {
+    auto &vars = result->Get<details::GraphVars>(details::kGraphVars)[i][og];
+    PADDLE_ENFORCE_EQ(vars.empty(), false,
+                      platform::errors::NotFound(
+                          "Cannot find the gradient %s on place %d.", og, i));
+    op_handle->AddInput(vars.back());
+
+    auto var = new details::VarHandle(
+        result->CreateEmptyNode(og, ir::Node::Type::kVariable), vars.size(), i,
+        og, places_[i]);
+    vars.emplace_back(var);
+    op_handle->AddOutput(var);
+  }
+#else
+  PADDLE_THROW(platform::errors::Unavailable(
+      "SparseAllGatherOpHandle needs Paddle compiled with NCCL."));
+#endif
+}
+
 void MultiDevSSAGraphBuilderBase::CreateScaleLossGradOp(
     ir::Graph *result, const std::string &loss_grad_name,
     ir::Node *out_var_node, size_t loss_scale,
@@ -606,7 +656,9 @@ void MultiDevSSAGraphBuilderBase::CreateIsolatedVarNode(
 void AllReduceSSAGraphBuilder::InsertCollectiveOp(
     ir::Graph *result, const std::string &p_name,
     const std::string &g_name) const {
-  if (IsSparseGradient(g_name)) {
+  if (UseSparseAllGather(g_name)) {
+    CreateSparseAllGatherOp(result, g_name);
+  } else if (IsSparseGradient(g_name)) {
     CreateReduceOp(result, g_name, 0);
     CreateBroadcastOp(result, g_name, 0);
   } else {
@@ -658,6 +710,9 @@ size_t BalanceVarSSAGraphBuilder::GetAppropriateDeviceID(
     auto dim = framework::make_ddim(var_desc->GetShape());
     int64_t numel = framework::product(dim);
     PADDLE_ENFORCE_GT(numel, 0);
+    if (strategy_.shard_optimizer_states_) {
+      numel *= static_cast<int64_t>(SizeOfType(var_desc->GetDataType()));
+    }
     numel_sum += numel;
   }
 
@@ -676,6 +731,70 @@ void BalanceVarSSAGraphBuilder::ResetState() const {
   balance_vars_.resize(places_.size(), 0);
 }
 
+void ReduceSSAGraphBuilder::ApplyImpl(ir::Graph *graph) const {
+  optimizer_states_.clear();
+  if (strategy_.shard_optimizer_states_) {
+    CollectOptimizerStates(*graph);
+  }
+  MultiDevSSAGraphBuilderBase::ApplyImpl(graph);
+
+  auto *sharded_vars = new ShardedVarDevices();
+  for (auto &pair : optimizer_states_) {
+    int dev_id = GetVarDeviceID(pair.first);
+    if (dev_id < 0) continue;
+    for (auto &state : pair.second) {
+      sharded_vars->emplace(state, static_cast<size_t>(dev_id));
+    }
+  }
+  VLOG(3) << "Shard " << sharded_vars->size() << " optimizer states";
+  graph->Set(kShardedVarDevices, sharded_vars);
+}
+
+void ReduceSSAGraphBuilder::CollectOptimizerStates(
+    const ir::Graph &graph) const {
+  // The ops which read or write each variable.
+  std::unordered_map<std::string, std::unordered_set<ir::Node *>> var_ops;
+  for (auto *node : graph.Nodes()) {
+    if (!node->IsOp() || node->Op() == nullptr) continue;
+    for (auto *var : node->inputs) var_ops[var->Name()].insert(node);
+    for (auto *var : node->outputs) var_ops[var->Name()].insert(node);
+  }
+
+  for (auto *node : graph.Nodes()) {
+    if (!node->IsOp() || node->Op() == nullptr ||
+        !OpHaveRole(*node, OpRole::kOptimize)) {
+      continue;
+    }
+    auto param_grad = details::GetOpRoleVarsOrEmpty(*node->Op());
+    if (param_grad.size() != 2U) continue;
+    auto &states = optimizer_states_[param_grad[1]];
+    for (auto *var : node->inputs) {
+      if (var->Var() == nullptr || !var->Var()->Persistable() ||
+          var->Var()->GetType() != proto::VarType::LOD_TENSOR ||
+          var->Name() == param_grad[0] || var->Name() == param_grad[1]) {
+        continue;
+      }
+      auto &ops = var_ops.at(var->Name());
+      if (ops.size() == 1 &&
+          std::find(states.begin(), states.end(), var->Name()) ==
+              states.end()) {
+        states.emplace_back(var->Name());
+      }
+    }
+  }
+}
+
+std::vector<std::string> ReduceSSAGraphBuilder::BalancedVarNames(
+    const std::string &g_name) const {
+  std::vector<std::string> var_names{g_name};
+  auto iter = optimizer_states_.find(g_name);
+  if (iter != optimizer_states_.end()) {
+    var_names.insert(var_names.end(), iter->second.begin(),
+                     iter->second.end());
+  }
+  return var_names;
+}
+
 void ReduceSSAGraphBuilder::Init() const {
   MultiDevSSAGraphBuilderBase::Init();
   ResetState();
@@ -690,7 +809,7 @@ void ReduceSSAGraphBuilder::ResetState() const {
 void ReduceSSAGraphBuilder::InsertCollectiveOp(
     ir::Graph *result, const std::string &p_name,
     const std::string &g_name) const {
-  size_t cur_device_id = GetAppropriateDeviceID({g_name});
+  size_t cur_device_id = GetAppropriateDeviceID(BalancedVarNames(g_name));
   CreateReduceOp(result, g_name, cur_device_id);
   sharded_var_device_.emplace(g_name, cur_device_id);
   bcast_var_name_set_[cur_device_id].emplace(p_name);
@@ -790,7 +909,8 @@ std::vector<ir::Node *> ReduceSSAGraphBuilder::SortForReduceMode(
       auto backward_vars = details::GetOpRoleVarsOrEmpty(*(node->Op()));
       for (size_t i = 0; i < backward_vars.size(); i += 2) {
         auto &g_name = backward_vars[i + 1];
-        size_t cur_device_id = GetAppropriateDeviceID({g_name});
+        size_t cur_device_id =
+            GetAppropriateDeviceID(BalancedVarNames(g_name));
         insert_delayed_op(g_name, static_cast<int>(cur_device_id));
       }
     } else if (op_dev_id == -2) {
@@ -1048,7 +1168,9 @@ void DistSSAGraphBuilder::InsertCollectiveOp(ir::Graph *result,
       sharded_var_device_.emplace(g_name, cur_device_id);
       break;
     case details::BuildStrategy::ReduceStrategy::kAllReduce:
-      if (IsSparseGradient(g_name)) {
+      if (UseSparseAllGather(g_name)) {
+        CreateSparseAllGatherOp(result, g_name);
+      } else if (IsSparseGradient(g_name)) {
         CreateReduceOp(result, g_name, 0);
         CreateBroadcastOp(result, g_name, 0);
       } else {
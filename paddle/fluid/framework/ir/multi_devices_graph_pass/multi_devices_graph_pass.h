@@ -35,6 +35,10 @@ namespace ir {
 
 constexpr char kLossVarName[] = "loss_var_name";
 constexpr char kStrategy[] = "strategy";
+// The optimizer states which are only kept in one device, whose type is
+// ShardedVarDevices.
+constexpr char kShardedVarDevices[] = "sharded_var_devices";
+typedef std::unordered_map<std::string, size_t> ShardedVarDevices;
 
 class MultiDevSSAGraphBuilderBase : public ir::Pass {
  protected:
@@ -82,6 +86,12 @@ class MultiDevSSAGraphBuilderBase : public ir::Pass {
   void CreateBroadcastOp(ir::Graph *result, const std::string &p_name,
                          size_t src_dev_id) const;
 
+  // Whether to all gather the sparse gradient og instead of reducing it to
+  // one device and broadcasting it.
+  bool UseSparseAllGather(const std::string &og) const;
+
+  void CreateSparseAllGatherOp(ir::Graph *result, const std::string &og) const;
+
   void InsertScaleLossGradOp(ir::Graph *result, const ir::Node *node) const;
 
   void CreateFusedBroadcastOp(
@@ -158,6 +168,8 @@ class BalanceVarSSAGraphBuilder : public MultiDevSSAGraphBuilderBase {
 
 class ReduceSSAGraphBuilder : public BalanceVarSSAGraphBuilder {
  protected:
+  void ApplyImpl(ir::Graph *graph) const override;
+
   virtual void Init() const;
 
   virtual void InsertCollectiveOp(ir::Graph *result, const std::string &p_name,
@@ -178,7 +190,17 @@ class ReduceSSAGraphBuilder : public BalanceVarSSAGraphBuilder {
   std::vector<ir::Node *> SortForReduceMode(
       const std::vector<ir::Node *> &topo_ops) const;
 
+  // Find the optimizer states which are only used by the optimizer ops of
+  // one parameter, e.g., the moments of Adam.
+  void CollectOptimizerStates(const ir::Graph &graph) const;
+
+  // The variables to balance across devices when assigning the gradient.
+  std::vector<std::string> BalancedVarNames(const std::string &g_name) const;
+
   mutable std::vector<std::unordered_set<std::string>> bcast_var_name_set_;
+  // From the gradient name to the names of its optimizer states.
+  mutable std::unordered_map<std::string, std::vector<std::string>>
+      optimizer_states_;
 };
 
 class DistSSAGraphBuilder : public BalanceVarSSAGraphBuilder {
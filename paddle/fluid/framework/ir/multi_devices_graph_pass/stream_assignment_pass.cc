@@ -0,0 +1,135 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/details/computation_op_handle.h"
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/memory_optimize_pass/op_graph_view.h"
+#include "paddle/fluid/memory/allocation/allocator_strategy.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/**
+ * Assign the computation ops on every CUDAPlace to `num_streams` streams, so
+ * that the independent chains of ops, e.g. the branches of inception blocks
+ * or the towers of multi-tower models, run concurrently.
+ *
+ * The ops are visited in topological order. An op continues the chain of the
+ * earliest preceding op on its place which is still the last op of its
+ * stream, and the op starting a new chain is put on the streams in round
+ * robin. The ops on different streams are synchronized by the events of the
+ * op handles, so an op must record its event if any pending op is on the
+ * other stream.
+ *
+ * The memory allocated by the ops on the non-default streams is reused only
+ * on the same stream after it is freed, which needs
+ * FLAGS_allocator_strategy=auto_growth.
+ */
+class StreamAssignmentPass : public ir::Pass {
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override {
+    size_t num_streams = Get<size_t>("num_streams");
+    if (num_streams <= 1) return;
+    if (memory::allocation::GetAllocatorStrategy() !=
+        memory::allocation::AllocatorStrategy::kAutoGrowth) {
+      LOG(WARNING) << "stream_assignment_pass only works when "
+                      "FLAGS_allocator_strategy=auto_growth, skipped.";
+      return;
+    }
+
+    auto all_ops = ir::FilterByNodeWrapper<details::OpHandleBase>(*graph);
+    OpGraphView graph_view(all_ops);
+
+    std::vector<details::ComputationOpHandle *> compute_ops;
+    std::unordered_map<details::OpHandleBase *, size_t> op_order;
+    for (auto *node : ir::TopologySortOperations(*graph)) {
+      if (!node->IsWrappedBy<details::OpHandleBase>()) continue;
+      auto *compute_op = dynamic_cast<details::ComputationOpHandle *>(
+          &node->Wrapper<details::OpHandleBase>());
+      if (compute_op == nullptr ||
+          !platform::is_gpu_place(compute_op->GetPlace())) {
+        continue;
+      }
+      op_order[compute_op] = compute_ops.size();
+      compute_ops.emplace_back(compute_op);
+    }
+
+    // The last op of every stream, and the stream of the next new chain.
+    struct PlaceStreams {
+      std::vector<details::ComputationOpHandle *> last_ops;
+      size_t next_stream{0};
+    };
+    std::map<platform::Place, PlaceStreams> place_streams;
+
+    for (auto *op : compute_ops) {
+      auto &streams = place_streams[op->GetPlace()];
+      streams.last_ops.resize(num_streams, nullptr);
+
+      details::ComputationOpHandle *chain_op = nullptr;
+      for (auto *preceding_op : graph_view.PrecedingOps(op)) {
+        auto *prev_op =
+            dynamic_cast<details::ComputationOpHandle *>(preceding_op);
+        if (prev_op == nullptr || op_order.count(prev_op) == 0 ||
+            !(prev_op->GetPlace() == op->GetPlace()) ||
+            streams.last_ops[prev_op->GetStreamId()] != prev_op) {
+          continue;
+        }
+        if (chain_op == nullptr ||
+            op_order.at(prev_op) < op_order.at(chain_op)) {
+          chain_op = prev_op;
+        }
+      }
+
+      size_t stream_id;
+      if (chain_op != nullptr) {
+        stream_id = chain_op->GetStreamId();
+      } else {
+        stream_id = streams.next_stream;
+        streams.next_stream = (streams.next_stream + 1) % num_streams;
+      }
+      op->SetStreamId(stream_id);
+      streams.last_ops[stream_id] = op;
+      VLOG(10) << "Run " << op->DebugString() << " on stream " << stream_id;
+    }
+
+    for (auto *op : compute_ops) {
+      bool record_event = op->GetStreamId() != 0;
+      for (auto *pending_op : graph_view.PendingOps(op)) {
+        auto *next_op =
+            dynamic_cast<details::ComputationOpHandle *>(pending_op);
+        if (next_op != nullptr && op_order.count(next_op) > 0 &&
+            next_op->GetPlace() == op->GetPlace() &&
+            next_op->GetStreamId() != op->GetStreamId()) {
+          record_event = true;
+        }
+      }
+      if (record_event) {
+        op->SetLockAndRecordEventFree(false);
+      }
+    }
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(stream_assignment_pass,
+              paddle::framework::ir::StreamAssignmentPass)
+    .RequirePassAttr("num_streams");
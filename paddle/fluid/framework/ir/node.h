@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -123,6 +124,11 @@ class Node {
   std::vector<Node*> inputs;
   std::vector<Node*> outputs;
 
+  // Bumped by the helpers relinking the nodes, e.g. IR_NODE_LINK_TO, so that
+  // the analyses cached on the graphs before the relinking are rebuilt.
+  static void BumpLinkEpoch() { ++link_epoch_; }
+  static uint64_t LinkEpoch() { return link_epoch_; }
+
  protected:
   std::string name_;
   std::unique_ptr<VarDesc> var_desc_;
@@ -161,6 +167,8 @@ class Node {
   std::function<void(void)> wrapper_deleter_;
   std::type_index wrapper_type_ = std::type_index(typeid(void));
 
+  static std::atomic<uint64_t> link_epoch_;
+
   DISABLE_COPY_AND_ASSIGN(Node);
 };
 
@@ -39,10 +39,14 @@ Graph* Pass::Apply(Graph* graph) const {
                           "Required atrribute %s for graph is not set.", attr));
   }
   ApplyImpl(graph);
+  if (!preserve_all_analyses_) {
+    graph->InvalidateAnalyses(preserved_analyses_);
+  }
   // TODO(panyx0718): Add more verifications.
-  PADDLE_ENFORCE(!HasCircle(*graph),
-                 "Illegal Pass %s. Generated graph shouldn't have cycle.",
-                 Type());
+  // A preserved topological order means the graph is still acyclic.
+  PADDLE_ENFORCE(
+      graph->HasAnalysis(kTopologySortAnalysis) || !HasCircle(*graph),
+      "Illegal Pass %s. Generated graph shouldn't have cycle.", Type());
   PADDLE_ENFORCE(VarDescIsConsistency(*graph),
                  "The VarDescs of persistable variable are not consistency.");
   applied_ = true;
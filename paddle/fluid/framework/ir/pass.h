@@ -158,11 +158,20 @@ class Pass {
 
   void RegisterType(const std::string &type) { type_ = type; }
 
+  void RegisterPreservedAnalyses(
+      const std::unordered_set<std::string> &analyses, bool preserve_all) {
+    preserved_analyses_.insert(analyses.begin(), analyses.end());
+    preserve_all_analyses_ = preserve_all;
+  }
+
   mutable bool applied_{false};
   std::string type_;
   std::unordered_set<std::string> required_pass_attrs_;
   std::unordered_set<std::string> default_pass_attrs_;
   std::unordered_set<std::string> required_graph_attrs_;
+  // The analyses cached on the graph which are still valid after the pass.
+  std::unordered_set<std::string> preserved_analyses_;
+  bool preserve_all_analyses_{false};
   std::map<std::string, boost::any> attrs_;
   std::map<std::string, std::function<void(void)>> attr_dels_;
 };
@@ -222,6 +231,8 @@ struct PassRegistrar : public Registrar {
           pass->RegisterRequiredGraphAttrs(this->required_graph_attrs_);
           pass->RegisterDefaultPassAttrs(this->default_attr_values_);
           pass->RegisterType(pass_type);
+          pass->RegisterPreservedAnalyses(this->preserved_analyses_,
+                                          this->preserve_all_analyses_);
           return pass;
         });
   }
@@ -257,9 +268,25 @@ struct PassRegistrar : public Registrar {
     return *this;
   }
 
+  // The analyses cached on the graph, see graph_helper.h, are dropped after
+  // the pass unless they are preserved.
+  PassRegistrar<PassType> &PreserveAnalysis(const std::string &analysis) {
+    preserved_analyses_.insert(analysis);
+    return *this;
+  }
+
+  // For the passes which don't change the nodes or the edges of the graph,
+  // e.g. the passes only setting the attributes of the ops.
+  PassRegistrar<PassType> &PreserveAllAnalyses() {
+    preserve_all_analyses_ = true;
+    return *this;
+  }
+
  private:
   std::unordered_set<std::string> required_pass_attrs_;
   std::unordered_set<std::string> required_graph_attrs_;
+  std::unordered_set<std::string> preserved_analyses_;
+  bool preserve_all_analyses_{false};
   std::map<std::string, boost::any> default_attr_values_;
   std::map<std::string, std::function<void(void)>> default_attr_dels_;
 };
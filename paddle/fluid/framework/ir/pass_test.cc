@@ -18,6 +18,7 @@ limitations under the License. */
 #include <utility>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
 
 namespace paddle {
 namespace framework {
@@ -166,10 +167,55 @@ TEST(PassTest, TestPassRegistrarDeconstructor) {
   pass_registrary->~PassRegistrar();
 }
 
+class TestEmptyPass : public Pass {
+ protected:
+  void ApplyImpl(ir::Graph* graph) const {}
+};
+
+constexpr char kNumNodesAnalysis[] = "test_num_nodes";
+
+static size_t CachedNumNodes(const Graph& graph) {
+  return graph.GetOrBuildAnalysis<size_t>(
+      kNumNodesAnalysis, [&graph] { return graph.Nodes().size(); });
+}
+
+TEST(PassTest, TestPreservedAnalyses) {
+  ProgramDesc prog;
+  std::unique_ptr<Graph> graph(new Graph(prog));
+  graph->CreateEmptyNode("op1", Node::Type::kOperation);
+  CachedTopologySortOperations(*graph);
+  CachedNumNodes(*graph);
+
+  auto pass = PassRegistry::Instance().Get("test_preserve_topology_pass");
+  graph.reset(pass->Apply(graph.release()));
+  ASSERT_TRUE(graph->HasAnalysis(kTopologySortAnalysis));
+  ASSERT_FALSE(graph->HasAnalysis(kNumNodesAnalysis));
+
+  CachedNumNodes(*graph);
+  pass = PassRegistry::Instance().Get("test_preserve_all_pass");
+  graph.reset(pass->Apply(graph.release()));
+  ASSERT_TRUE(graph->HasAnalysis(kTopologySortAnalysis));
+  ASSERT_TRUE(graph->HasAnalysis(kNumNodesAnalysis));
+
+  pass = PassRegistry::Instance().Get("test_empty_pass");
+  graph.reset(pass->Apply(graph.release()));
+  ASSERT_FALSE(graph->HasAnalysis(kTopologySortAnalysis));
+  ASSERT_FALSE(graph->HasAnalysis(kNumNodesAnalysis));
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
 
+REGISTER_PASS(test_empty_pass, paddle::framework::ir::TestEmptyPass);
+
+REGISTER_PASS(test_preserve_topology_pass,
+              paddle::framework::ir::TestEmptyPass)
+    .PreserveAnalysis(paddle::framework::ir::kTopologySortAnalysis);
+
+REGISTER_PASS(test_preserve_all_pass, paddle::framework::ir::TestEmptyPass)
+    .PreserveAllAnalyses();
+
 REGISTER_PASS(test_pass, paddle::framework::ir::TestPass)
     .RequirePassAttr("test_pass_attr")
     .RequireGraphAttr("test_graph_attr");
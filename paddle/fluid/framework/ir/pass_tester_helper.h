@@ -192,6 +192,18 @@ struct Layers {
     return binary_op("elementwise_mul", x, y, out);
   }
 
+  VarDesc* elementwise_sub(VarDesc* x, VarDesc* y, VarDesc* out = nullptr) {
+    return binary_op("elementwise_sub", x, y, out);
+  }
+
+  VarDesc* reduce_sum(VarDesc* x, int dim, bool keep_dim = false) {
+    return reduce_op("reduce_sum", x, dim, keep_dim);
+  }
+
+  VarDesc* reduce_mean(VarDesc* x, int dim, bool keep_dim = false) {
+    return reduce_op("reduce_mean", x, dim, keep_dim);
+  }
+
   VarDesc* dropout(VarDesc* x, float dropout_prob,
                    std::string dropout_implementation) {
     VarDesc* out = lod_tensor(unique_name());
@@ -347,6 +359,17 @@ struct Layers {
     return out;
   }
 
+  void fetch(VarDesc* x, int col = 0) {
+    auto* out = program_.MutableBlock(0)->Var("fetch");
+    out->SetType(proto::VarType::FETCH_LIST);
+    out->SetPersistable(true);
+    OpDesc* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType("fetch");
+    op->SetInput("X", {x->Name()});
+    op->SetOutput("Out", {out->Name()});
+    op->SetAttr("col", col);
+  }
+
   void backward(std::vector<VarDesc*> targets) {
     // This function is designed to simulate the structure of training program,
     //  but is constructed differently as the actual program.
@@ -423,6 +446,20 @@ struct Layers {
     return out;
   }
 
+  VarDesc* reduce_op(std::string type, VarDesc* x, int dim, bool keep_dim) {
+    VarDesc* out = lod_tensor(unique_name());
+    OpDesc* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {x->Name()});
+    op->SetOutput("Out", {out->Name()});
+    op->SetAttr("dim", std::vector<int>{dim});
+    op->SetAttr("keep_dim", keep_dim);
+    op->SetAttr("reduce_all", false);
+    op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                static_cast<int>(OpRole::kForward));
+    return out;
+  }
+
   VarDesc* binary_op(std::string type, VarDesc* x, VarDesc* y,
                      VarDesc* out = nullptr,
                      const AttributeMap* attrs = nullptr) {
@@ -331,6 +331,8 @@ static int BuildFusion(Graph* graph, const std::string& name_scope,
     op_desc.SetInput("Bias", bias_names);
     op_desc.SetOutput("ReluOut", relu_names);
     op_desc.SetOutput("Out", {last_out_var->Name()});
+    // the weights are the parameters of the fc ops, packed once by the kernel
+    op_desc.SetAttr("use_packed_weights", true);
 
     auto* op = graph->CreateOpNode(&op_desc);
     IR_NODE_LINK_TO(input_var, op);
@@ -34,4 +34,5 @@ void RuntimeContextCachePass::ApplyImpl(ir::Graph* graph) const {
 }  // namespace paddle
 
 REGISTER_PASS(runtime_context_cache_pass,
-              paddle::framework::ir::RuntimeContextCachePass);
+              paddle::framework::ir::RuntimeContextCachePass)
+    .PreserveAllAnalyses();
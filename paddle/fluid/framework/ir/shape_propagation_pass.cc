@@ -0,0 +1,150 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/shape_propagation_pass.h"
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The batch sizes of the two rounds, small enough for the products of the
+// dims not to overflow.
+constexpr int64_t kFirstBatchSize = 1009;
+constexpr int64_t kSecondBatchSize = 1013;
+
+bool IsLoDTensor(const VarDesc& var) {
+  return var.GetType() == proto::VarType::LOD_TENSOR;
+}
+
+}  // namespace
+
+VarShapeMap ShapePropagationPass::Propagate(const ir::Graph& graph,
+                                            int64_t batch_size) const {
+  auto& sorted_ops = CachedTopologySortOperations(graph);
+  std::unordered_set<std::string> produced;
+  for (auto* op : sorted_ops) {
+    if (!op->Op() || op->Op()->Type() == "feed") continue;
+    for (auto& name : op->Op()->OutputArgumentNames()) {
+      produced.insert(name);
+    }
+  }
+
+  // The compile-time InferShape sets the shapes of the VarDescs in place, so
+  // it runs on the copies of the VarDescs in a scratch block.
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  const VarShapeMap* feed_shapes =
+      Has(kFeedShapes) ? &Get<VarShapeMap>(kFeedShapes) : nullptr;
+  for (auto* n : graph.Nodes()) {
+    if (!n->IsVar() || !n->Var() || block->HasVar(n->Name())) continue;
+    auto* var = block->Var(n->Name());
+    *var->Proto() = *n->Var()->Proto();
+    if (!IsLoDTensor(*var) || produced.count(n->Name())) continue;
+
+    auto dims = var->GetShape();
+    if (feed_shapes && feed_shapes->count(n->Name())) {
+      dims = feed_shapes->at(n->Name());
+    }
+    for (auto& dim : dims) {
+      if (dim < 0) dim = batch_size;
+    }
+    var->SetShape(dims);
+  }
+
+  std::unordered_set<std::string> unknown;
+  for (auto* op : sorted_ops) {
+    auto* op_desc = op->Op();
+    if (!op_desc || op_desc->Type() == "feed" || op_desc->Type() == "fetch") {
+      continue;
+    }
+    bool inferred = true;
+    for (auto& name : op_desc->InputArgumentNames()) {
+      inferred &= !unknown.count(name);
+    }
+    if (inferred) {
+      try {
+        op_desc->InferShape(*block);
+      } catch (std::exception& e) {
+        VLOG(4) << "Can not infer the shapes of " << op_desc->Type() << ": "
+                << e.what();
+        inferred = false;
+      }
+    }
+    for (auto& name : op_desc->OutputArgumentNames()) {
+      if (inferred) {
+        unknown.erase(name);
+      } else {
+        unknown.insert(name);
+      }
+    }
+  }
+
+  VarShapeMap shapes;
+  for (auto* var : block->AllVars()) {
+    if (!IsLoDTensor(*var) || unknown.count(var->Name())) continue;
+    shapes[var->Name()] = var->GetShape();
+  }
+  return shapes;
+}
+
+void ShapePropagationPass::ApplyImpl(ir::Graph* graph) const {
+  auto first = Propagate(*graph, kFirstBatchSize);
+  auto second = Propagate(*graph, kSecondBatchSize);
+
+  auto* var_shapes = new VarShapeMap;
+  for (auto& it : first) {
+    auto second_it = second.find(it.first);
+    if (second_it == second.end() ||
+        second_it->second.size() != it.second.size()) {
+      continue;
+    }
+    std::vector<int64_t> dims;
+    for (size_t i = 0; i < it.second.size(); ++i) {
+      int64_t dim = it.second[i];
+      int64_t second_dim = second_it->second[i];
+      int64_t times = (second_dim - dim) / (kSecondBatchSize - kFirstBatchSize);
+      if (dim >= 0 && dim == second_dim) {
+        dims.push_back(dim);
+      } else if (times > 0 && dim == times * kFirstBatchSize &&
+                 second_dim == times * kSecondBatchSize) {
+        dims.push_back(-times);
+      } else {
+        break;
+      }
+    }
+    if (dims.size() == it.second.size()) {
+      (*var_shapes)[it.first] = std::move(dims);
+    }
+  }
+  VLOG(3) << "The static shapes of " << var_shapes->size() << " of "
+          << first.size() << " variables are propagated.";
+
+  if (graph->Has(kVarShapes)) {
+    graph->Erase(kVarShapes);
+  }
+  graph->Set(kVarShapes, var_shapes);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(shape_propagation_pass,
+              paddle::framework::ir::ShapePropagationPass)
+    .PreserveAllAnalyses();
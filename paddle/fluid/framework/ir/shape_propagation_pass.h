@@ -0,0 +1,56 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The graph attribute holding the shapes of the variables. A dim -k stands
+// for k times the batch size, e.g. {-1, 128} for a batch of 128-d vectors.
+constexpr char kVarShapes[] = "var_shapes";
+// The optional pass attribute holding the shapes of the feed variables, in
+// which -1 stands for the batch size. The dims -1 of the variables not
+// produced by any op are taken as the batch size if it is not set.
+constexpr char kFeedShapes[] = "feed_shapes";
+
+using VarShapeMap = std::unordered_map<std::string, std::vector<int64_t>>;
+
+/*
+ * Propagate the shapes of the LoDTensors from the feed variables through the
+ * graph with the compile-time InferShape of the ops, and store them in the
+ * graph as kVarShapes. The batch size is taken as two different values in two
+ * rounds, so a dim is concrete if it is the same in both rounds, and
+ * symbolic if it is proportional to the batch size. The variables with any
+ * other dim, or produced by an op which fails to infer the shapes, are left
+ * out.
+ */
+class ShapePropagationPass : public Pass {
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+
+ private:
+  // The shapes of the variables, with the batch size taken as `batch_size`.
+  VarShapeMap Propagate(const ir::Graph& graph, int64_t batch_size) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
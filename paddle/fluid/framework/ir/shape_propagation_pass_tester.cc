@@ -0,0 +1,90 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/shape_propagation_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_OP(elementwise_add);
+USE_OP(relu);
+USE_OP(concat);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(ShapePropagationPass, symbolic_batch) {
+  // inputs                           operator            output
+  // ------------------------------------------------------------------
+  // (x, w)                           mul            ->   mul_out
+  // (mul_out, bias)                  elementwise_add ->  add_out
+  // (add_out)                        relu           ->   relu_out
+  // (relu_out, relu_out)             concat         ->   concat_out
+  Layers layers;
+  auto* x = layers.data("x", {-1, 16});
+  auto* w = layers.data("w", {16, 8}, true);
+  auto* bias = layers.data("bias", {8}, true);
+  auto* mul_out = layers.mul(x, w);
+  auto* add_out = layers.elementwise_add(mul_out, bias);
+  auto* relu_out = layers.relu(add_out);
+  auto* concat_out = layers.concat({relu_out, relu_out}, 0);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("shape_propagation_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  auto& shapes = graph->Get<VarShapeMap>(kVarShapes);
+  EXPECT_EQ(shapes.at("w"), std::vector<int64_t>({16, 8}));
+  EXPECT_EQ(shapes.at(mul_out->Name()), std::vector<int64_t>({-1, 8}));
+  EXPECT_EQ(shapes.at(relu_out->Name()), std::vector<int64_t>({-1, 8}));
+  EXPECT_EQ(shapes.at(concat_out->Name()), std::vector<int64_t>({-2, 8}));
+
+  // the feed shapes make the batch size concrete
+  graph.reset(new ir::Graph(layers.main_program()));
+  pass = PassRegistry::Instance().Get("shape_propagation_pass");
+  pass->Set(kFeedShapes, new VarShapeMap({{"x", {4, 16}}}));
+  graph.reset(pass->Apply(graph.release()));
+  auto& feed_shapes = graph->Get<VarShapeMap>(kVarShapes);
+  EXPECT_EQ(feed_shapes.at(add_out->Name()), std::vector<int64_t>({4, 8}));
+  EXPECT_EQ(feed_shapes.at(concat_out->Name()), std::vector<int64_t>({8, 8}));
+}
+
+TEST(ShapePropagationPass, unknown_op) {
+  Layers layers;
+  auto* x = layers.data("x", {-1, 16});
+  auto* y = layers.relu(x);
+  auto* z = layers.relu(y);
+  ProgramDesc program(layers.main_program());
+  program.MutableBlock(0)->AllOps()[0]->SetType("not_registered");
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(program));
+  auto pass = PassRegistry::Instance().Get("shape_propagation_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  // the outputs of the op failing to infer the shapes and their consumers
+  // are left out
+  auto& shapes = graph->Get<VarShapeMap>(kVarShapes);
+  EXPECT_EQ(shapes.at("x"), std::vector<int64_t>({-1, 16}));
+  EXPECT_EQ(shapes.count(y->Name()), 0UL);
+  EXPECT_EQ(shapes.count(z->Name()), 0UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(shape_propagation_pass);
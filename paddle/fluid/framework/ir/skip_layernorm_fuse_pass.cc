@@ -120,6 +120,14 @@ void SkipLayerNormFusePass::ApplyImpl(ir::Graph *graph) const {
       return;
     }
 
+    // the elementwise_add is not broadcasted
+    auto *x_var = subgraph.at(x)->Var();
+    auto *y_var = subgraph.at(y)->Var();
+    if (x_var && y_var && x_var->GetShape() != y_var->GetShape()) {
+      VLOG(4) << "The shapes of the inputs of SkipLayerNorm are different.";
+      return;
+    }
+
     VLOG(4) << "handle SkipLayerNorm fuse";
     GET_IR_NODE_FROM_SUBGRAPH(elementwise, elementwise, fused_pattern);
     GET_IR_NODE_FROM_SUBGRAPH(elementwise_out, elementwise_out, fused_pattern);
@@ -0,0 +1,153 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/softmax_mask_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+namespace patterns {
+
+struct SoftmaxMask : public PatternBase {
+  SoftmaxMask(PDPattern *pattern, const std::string &name_scope)
+      : PatternBase(pattern, name_scope, "softmax_mask") {}
+
+  PDNode *operator()(PDNode *x, PDNode *mask);
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(elementwise);
+  PATTERN_DECL_NODE(softmax);
+  // declare variable node's name
+  PATTERN_DECL_NODE(elementwise_out);
+  PATTERN_DECL_NODE(softmax_out);
+};
+
+PDNode *SoftmaxMask::operator()(PDNode *x, PDNode *mask) {
+  x->assert_is_op_input("elementwise_add", "X");
+  mask->assert_is_op_input("elementwise_add", "Y");
+  auto *elementwise =
+      pattern->NewNode(elementwise_repr())->assert_is_op("elementwise_add");
+  auto *elementwise_out_var = pattern->NewNode(elementwise_out_repr())
+                                  ->AsIntermediate()
+                                  ->assert_is_op_output("elementwise_add")
+                                  ->assert_is_only_input_of_op("softmax");
+  elementwise->LinksFrom({x, mask}).LinksTo({elementwise_out_var});
+
+  auto *softmax = pattern->NewNode(softmax_repr())->assert_is_op("softmax");
+  auto *softmax_out_var = pattern->NewNode(softmax_out_repr())
+                              ->AsOutput()
+                              ->assert_is_op_output("softmax", "Out");
+  softmax->LinksFrom({elementwise_out_var}).LinksTo({softmax_out_var});
+  return softmax_out_var;
+}
+
+}  // namespace patterns
+
+// The scale op producing x, which is only used by the elementwise_add and
+// has no bias or ScaleTensor, or nullptr.
+static Node *FusibleScale(Node *x) {
+  if (x->inputs.size() != 1U || x->outputs.size() != 1U) return nullptr;
+  auto *scale = x->inputs[0];
+  if (!scale->IsOp() || !scale->Op() || scale->Op()->Type() != "scale" ||
+      scale->inputs.size() != 1U) {
+    return nullptr;
+  }
+  auto bias = BOOST_GET_CONST(float, scale->Op()->GetAttr("bias"));
+  return bias == 0.f ? scale : nullptr;
+}
+
+void SoftmaxMaskFusePass::ApplyImpl(ir::Graph *graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::PreconditionNotMet("graph should not be null."));
+  FusePassBase::Init("softmax_mask_fuse", graph);
+  int found_subgraph_count = 0;
+
+  GraphPatternDetector gpd;
+  auto *x = gpd.mutable_pattern()
+                ->NewNode("softmax_mask_fuse/x")
+                ->AsInput()
+                ->assert_is_op_input("elementwise_add", "X")
+                ->assert_var_not_persistable();
+  auto *mask = gpd.mutable_pattern()
+                   ->NewNode("softmax_mask_fuse/mask")
+                   ->AsInput()
+                   ->assert_is_op_input("elementwise_add", "Y");
+  patterns::SoftmaxMask fused_pattern(gpd.mutable_pattern(),
+                                      "softmax_mask_fuse");
+  fused_pattern(x, mask);
+
+  auto handler = [&](const GraphPatternDetector::subgraph_t &subgraph,
+                     Graph *graph) {
+    GET_IR_NODE_FROM_SUBGRAPH(elementwise, elementwise, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(elementwise_out, elementwise_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(softmax, softmax, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(softmax_out, softmax_out, fused_pattern);
+    auto *x_node = subgraph.at(x);
+    auto *mask_node = subgraph.at(mask);
+
+    std::unordered_set<const Node *> del_node_set;
+    float scale = 1.f;
+    auto *input = x_node;
+    auto *scale_op = FusibleScale(x_node);
+    if (scale_op) {
+      scale = BOOST_GET_CONST(float, scale_op->Op()->GetAttr("scale"));
+      input = scale_op->inputs[0];
+      del_node_set.insert(scale_op);
+      del_node_set.insert(x_node);
+    }
+
+    // the mask is not broadcasted, and the softmax is along the last axis
+    if (!input->Var() || !mask_node->Var()) return;
+    auto shape = input->Var()->GetShape();
+    if (shape.empty() || shape != mask_node->Var()->GetShape()) {
+      VLOG(4) << "The shapes of the input and the mask are different.";
+      return;
+    }
+    int axis = BOOST_GET_CONST(int, softmax->Op()->GetAttr("axis"));
+    if (axis != -1 && axis != static_cast<int>(shape.size()) - 1) return;
+
+    VLOG(4) << "handle SoftmaxMask fuse";
+    OpDesc new_desc;
+    new_desc.SetType("fused_softmax_mask");
+    new_desc.SetInput("X", {input->Name()});
+    new_desc.SetInput("Mask", {mask_node->Name()});
+    new_desc.SetOutput("Out", {softmax_out->Name()});
+    new_desc.SetAttr("scale", scale);
+    auto fused_node = graph->CreateOpNode(&new_desc);  // OpDesc will be copied.
+
+    del_node_set.insert(elementwise);
+    del_node_set.insert(elementwise_out);
+    del_node_set.insert(softmax);
+    GraphSafeRemoveNodes(graph, del_node_set);
+
+    IR_NODE_LINK_TO(input, fused_node);
+    IR_NODE_LINK_TO(mask_node, fused_node);
+    IR_NODE_LINK_TO(fused_node, softmax_out);
+    found_subgraph_count++;
+  };
+
+  gpd(graph, handler);
+  AddStatis(found_subgraph_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(softmax_mask_fuse_pass,
+              paddle::framework::ir::SoftmaxMaskFusePass);
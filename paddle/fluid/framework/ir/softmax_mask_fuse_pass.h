@@ -0,0 +1,46 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+//     |                                |
+//   (scale)                        other_op1   mask
+//     |                                 \      /
+// other_op1   mask         fuse       fused_softmax_mask
+//     \        /            ->                |
+//   elementwise_add                       other_op2
+//          |
+//       softmax
+//          |
+//      other_op2
+//
+// The softmax is along the last axis, the mask is in the same shape as the
+// input, and the scale op without bias is fused as well.
+class SoftmaxMaskFusePass : public FusePassBase {
+ public:
+  virtual ~SoftmaxMaskFusePass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
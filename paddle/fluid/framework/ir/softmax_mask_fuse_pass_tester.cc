@@ -0,0 +1,71 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/softmax_mask_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(SoftmaxMaskFusePass, basic) {
+  // inputs                           operator            output
+  // --------------------------------------------------------------------
+  // (x)                          scale              -> scale_out
+  // (scale_out, mask)            elementwise_add    -> elementwise_out
+  // (elementwise_out)            softmax            -> softmax_out
+  // (y, mask)                    elementwise_add    -> elementwise_out
+  // (elementwise_out)            softmax            -> softmax_out
+  Layers layers;
+  auto* x = layers.data("x", {1, 12, 128, 128});
+  auto* y = layers.data("y", {1, 12, 128, 128});
+  auto* mask = layers.data("mask", {1, 12, 128, 128});
+  auto* scale_out = layers.scale(x, 0.125f, 0.f, false);
+  layers.softmax(layers.elementwise_add(scale_out, mask), -1);
+  layers.softmax(layers.elementwise_add(y, mask), 3);
+  // the broadcasted mask is not fused
+  auto* small_mask = layers.data("small_mask", {1, 1, 1, 128});
+  layers.softmax(layers.elementwise_add(y, small_mask), -1);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("softmax_mask_fuse_pass");
+  int num_nodes_before = graph->Nodes().size();
+  VLOG(3) << DebugString(graph);
+
+  graph.reset(pass->Apply(graph.release()));
+  int num_nodes_after = graph->Nodes().size();
+  VLOG(3) << DebugString(graph);
+
+  // scale, 2 elementwise_add, 2 softmax are replaced by 2 fused ops, and
+  // scale_out and 2 elementwise_out are removed
+  EXPECT_EQ(num_nodes_before, num_nodes_after + 6);
+  EXPECT_EQ(GetNumOpNodes(graph, "fused_softmax_mask"), 2);
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "softmax"), 1);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fused_softmax_mask" &&
+        node->Op()->Input("X")[0] == "x") {
+      EXPECT_FLOAT_EQ(BOOST_GET_CONST(float, node->Op()->GetAttr("scale")),
+                      0.125f);
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(softmax_mask_fuse_pass);
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/ir/subgraph_detector.h"
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -382,6 +383,30 @@ std::vector<std::vector<Node *>> SubgraphDetector::ExtractSubGraphs() {
 
 void SubGraphFuser::operator()() { ReplaceNodesWithSubGraphs(); }
 
+size_t CountBoundaryVarsOfSubGraph(const std::vector<Node *> &subgraph) {
+  std::unordered_set<const Node *> ops(subgraph.begin(), subgraph.end());
+  std::unordered_set<const Node *> boundary;
+  for (auto *op : subgraph) {
+    for (auto *in : op->inputs) {
+      if (!in->IsVar() || (in->Var() && in->Var()->Persistable())) continue;
+      bool produced_inside = std::any_of(
+          in->inputs.begin(), in->inputs.end(),
+          [&ops](const Node *producer) { return ops.count(producer) > 0; });
+      if (!produced_inside) boundary.insert(in);
+    }
+    for (auto *out : op->outputs) {
+      if (!out->IsVar()) continue;
+      bool used_outside =
+          out->outputs.empty() ||
+          std::any_of(
+              out->outputs.begin(), out->outputs.end(),
+              [&ops](const Node *consumer) { return !ops.count(consumer); });
+      if (used_outside) boundary.insert(out);
+    }
+  }
+  return boundary.size();
+}
+
 void RemoveIntermediateOutputInSubgraph(const std::vector<Node *> &subgraph,
                                         Graph *graph,
                                         std::vector<Node *> *outputs) {
@@ -411,8 +436,18 @@ void DetachDeletedNodes(framework::ir::Graph *graph) {
 
 void SubGraphFuser::ReplaceNodesWithSubGraphs() {
   auto subgraphs = SubgraphDetector(graph_, node_inside_subgraph_teller_)();
+  rejected_subgraphs_.clear();
   for (auto &subgraph : subgraphs) {
-    if (subgraph.size() <= (size_t)min_subgraph_size_) continue;
+    if (subgraph.size() <= (size_t)min_subgraph_size_) {
+      rejected_subgraphs_.push_back(
+          RejectedSubgraph{subgraph, RejectReason::kMinSubgraphSize});
+      continue;
+    }
+    if (benefit_teller_ && !benefit_teller_(subgraph)) {
+      rejected_subgraphs_.push_back(
+          RejectedSubgraph{subgraph, RejectReason::kNoBenefit});
+      continue;
+    }
     std::unordered_set<Node *> subgraph_uniq(subgraph.begin(), subgraph.end());
     // replace this sub-graph with the first node. Two steps: 1. Create a Block
     // Node that contains this subgraph 2. Mark the nodes inside the sub-graph
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/ir/graph.h"
@@ -63,17 +64,43 @@ class SubgraphDetector {
 class SubGraphFuser {
  public:
   using NodeInsideSubgraphTeller = SubgraphDetector::NodeInsideSubgraphTeller;
+  // Tell whether replacing a sub-graph with one node pays off, e.g., whether
+  // the estimated gain of an engine is larger than the cost of launching it
+  // and copying its inputs and outputs. A sub-graph which doesn't pay off is
+  // left as it is.
+  using SubgraphBenefitTeller =
+      std::function<bool(const std::vector<Node *> &)>;
+
+  // The rule a sub-graph left as it is is rejected by.
+  enum class RejectReason {
+    // no more than min_subgraph_size nodes
+    kMinSubgraphSize,
+    // refused by the benefit teller
+    kNoBenefit,
+  };
+  struct RejectedSubgraph {
+    std::vector<Node *> nodes;
+    RejectReason reason;
+  };
 
   SubGraphFuser(Graph *graph, const NodeInsideSubgraphTeller &teller,
-                int min_subgraph_size, std::string name = "tensorrt_engine")
+                int min_subgraph_size, std::string name = "tensorrt_engine",
+                const SubgraphBenefitTeller &benefit_teller = nullptr)
       : graph_(graph),
         node_inside_subgraph_teller_(teller),
         min_subgraph_size_{min_subgraph_size},
-        name_{name} {}
+        name_{name},
+        benefit_teller_(benefit_teller) {}
 
   // The main method which run all the logic.
   void operator()();
 
+  // The sub-graphs left as they are by the last run, with the rules
+  // rejecting them.
+  const std::vector<RejectedSubgraph> &rejected_subgraphs() const {
+    return rejected_subgraphs_;
+  }
+
  protected:
   // Remove the nodes inside sub-graphs and replace with the SubGraphNode.
   void ReplaceNodesWithSubGraphs();
@@ -83,8 +110,15 @@ class SubGraphFuser {
   NodeInsideSubgraphTeller node_inside_subgraph_teller_;
   int min_subgraph_size_;
   const std::string name_;
+  SubgraphBenefitTeller benefit_teller_;
+  std::vector<RejectedSubgraph> rejected_subgraphs_;
 };
 
+// The number of the variables a sub-graph exchanges with the rest of the
+// graph at runtime, i.e., its non-persistable inputs and the outputs used
+// outside of it or by nobody.
+size_t CountBoundaryVarsOfSubGraph(const std::vector<Node *> &subgraph);
+
 struct NodeWrapper {
   bool deleted{false};
   bool marked{false};
@@ -0,0 +1,133 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/subgraph_detector.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// inputs                           operator            output
+// ------------------------------------------------------------------
+// (x)                              relu           ->   relu_out
+// (relu_out, w)                    mul            ->   mul_out
+// (mul_out)                        sigmoid        ->   sigmoid_out
+// (sigmoid_out)                    relu           ->   out
+// (out)                            fetch
+//
+// The relu and mul ops are inside the sub-graphs, which are cut by sigmoid.
+std::unique_ptr<Graph> BuildCutGraph() {
+  Layers layers;
+  auto* x = layers.data("x", {4, 4});
+  auto* w = layers.data("w", {4, 4}, true);
+  auto* sigmoid_out = layers.sigmoid(layers.mul(layers.relu(x), w));
+  layers.fetch(layers.relu(sigmoid_out));
+  return std::unique_ptr<Graph>(new Graph(layers.main_program()));
+}
+
+bool InsideSubgraph(const Node* node) {
+  return node->IsOp() && node->Op() &&
+         (node->Op()->Type() == "relu" || node->Op()->Type() == "mul");
+}
+
+std::vector<Node*> FusedNodes(const std::unique_ptr<Graph>& graph) {
+  std::vector<Node*> fused;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() && node->Op()->Type() == "engine") {
+      fused.push_back(node);
+    }
+  }
+  return fused;
+}
+
+TEST(SubgraphDetector, boundary_vars) {
+  auto graph = BuildCutGraph();
+  auto subgraphs = SubgraphDetector(graph.get(), InsideSubgraph)();
+  ASSERT_EQ(subgraphs.size(), 2UL);
+  std::sort(subgraphs.begin(), subgraphs.end(),
+            [](const std::vector<Node*>& a, const std::vector<Node*>& b) {
+              return a.size() > b.size();
+            });
+  // x and mul_out, as the persistable w is not exchanged at runtime and
+  // relu_out is only used inside.
+  ASSERT_EQ(subgraphs[0].size(), 2UL);
+  EXPECT_EQ(CountBoundaryVarsOfSubGraph(subgraphs[0]), 2UL);
+  // sigmoid_out and out
+  ASSERT_EQ(subgraphs[1].size(), 1UL);
+  EXPECT_EQ(CountBoundaryVarsOfSubGraph(subgraphs[1]), 2UL);
+}
+
+TEST(SubGraphFuser, fuse_all) {
+  auto graph = BuildCutGraph();
+  SubGraphFuser fuser(graph.get(), InsideSubgraph, 0, "engine");
+  fuser();
+  EXPECT_EQ(FusedNodes(graph).size(), 2UL);
+  EXPECT_TRUE(fuser.rejected_subgraphs().empty());
+}
+
+TEST(SubGraphFuser, reject_unprofitable) {
+  auto graph = BuildCutGraph();
+  std::vector<size_t> asked;
+  auto benefit_teller = [&asked](const std::vector<Node*>& subgraph) {
+    asked.push_back(subgraph.size());
+    return CountBoundaryVarsOfSubGraph(subgraph) < subgraph.size() + 1;
+  };
+  SubGraphFuser fuser(graph.get(), InsideSubgraph, 0, "engine",
+                      benefit_teller);
+  fuser();
+  EXPECT_EQ(asked.size(), 2UL);
+  ASSERT_EQ(fuser.rejected_subgraphs().size(), 1UL);
+  EXPECT_EQ(fuser.rejected_subgraphs()[0].reason,
+            SubGraphFuser::RejectReason::kNoBenefit);
+  EXPECT_EQ(fuser.rejected_subgraphs()[0].nodes.size(), 1UL);
+
+  auto fused = FusedNodes(graph);
+  ASSERT_EQ(fused.size(), 1UL);
+  EXPECT_EQ(Agent(fused[0]).subgraph()->size(), 2UL);
+  // The rejected relu is left as it is.
+  int left = 0;
+  for (auto* node : graph->Nodes()) {
+    if (InsideSubgraph(node) && !Agent(node).deleted()) {
+      ++left;
+      EXPECT_EQ(node->Op()->Type(), "relu");
+    }
+  }
+  EXPECT_EQ(left, 1);
+}
+
+TEST(SubGraphFuser, respect_min_subgraph_size) {
+  auto graph = BuildCutGraph();
+  bool asked = false;
+  auto benefit_teller = [&asked](const std::vector<Node*>&) {
+    asked = true;
+    return true;
+  };
+  SubGraphFuser fuser(graph.get(), InsideSubgraph, 2, "engine",
+                      benefit_teller);
+  fuser();
+  EXPECT_TRUE(FusedNodes(graph).empty());
+  EXPECT_FALSE(asked);
+  ASSERT_EQ(fuser.rejected_subgraphs().size(), 2UL);
+  for (auto& rejected : fuser.rejected_subgraphs()) {
+    EXPECT_EQ(rejected.reason, SubGraphFuser::RejectReason::kMinSubgraphSize);
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
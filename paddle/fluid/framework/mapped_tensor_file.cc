@@ -0,0 +1,162 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/mapped_tensor_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace framework {
+
+#ifdef _WIN32
+MappedTensorFile::MappedTensorFile(const std::string& path) : path_(path) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Mapping the file %s is not supported on Windows.", path));
+}
+
+MappedTensorFile::~MappedTensorFile() {}
+#else
+MappedTensorFile::MappedTensorFile(const std::string& path) : path_(path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(
+      fd, -1,
+      platform::errors::Unavailable("Failed to open the file %s.", path));
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    size_ = static_cast<size_t>(st.st_size);
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  PADDLE_ENFORCE_NE(data, MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Failed to map the file %s, which may be empty.",
+                        path));
+  data_ = data;
+  // start reading ahead, the pages are faulted in by the first access
+  madvise(data_, size_, MADV_WILLNEED);
+}
+
+MappedTensorFile::~MappedTensorFile() {
+  if (data_) munmap(data_, size_);
+}
+#endif
+
+char* MappedTensorFile::Read(size_t bytes) {
+  PADDLE_ENFORCE_LE(bytes, size_ - offset_,
+                    platform::errors::Unavailable(
+                        "The file %s is truncated, please check whether it "
+                        "is complete or damaged.",
+                        path_));
+  char* ptr = static_cast<char*>(data_) + offset_;
+  offset_ += bytes;
+  return ptr;
+}
+
+namespace {
+
+// Keeps the mapped file alive while a tensor references it.
+class MappedTensorAllocation : public memory::Allocation {
+ public:
+  MappedTensorAllocation(void* ptr, size_t size,
+                         std::shared_ptr<MappedTensorFile> file)
+      : Allocation(ptr, size, platform::CPUPlace()), file_(std::move(file)) {}
+
+ private:
+  std::shared_ptr<MappedTensorFile> file_;
+};
+
+}  // namespace
+
+void ReadMappedLoDTensor(const std::shared_ptr<MappedTensorFile>& file,
+                         LoDTensor* tensor) {
+  uint32_t version = file->ReadValue<uint32_t>();
+  PADDLE_ENFORCE_EQ(version, 0U, platform::errors::InvalidArgument(
+                                     "tensor version %u is not supported, "
+                                     "Only version 0 is supported",
+                                     version));
+  uint64_t lod_level = file->ReadValue<uint64_t>();
+  LoD lod(lod_level);
+  for (uint64_t i = 0; i < lod_level; ++i) {
+    uint64_t size = file->ReadValue<uint64_t>();
+    lod[i].resize(size / sizeof(size_t));
+    std::memcpy(lod[i].data(), file->Read(size), size);
+  }
+
+  version = file->ReadValue<uint32_t>();
+  PADDLE_ENFORCE_EQ(version, 0U, platform::errors::InvalidArgument(
+                                     "tensor version %u is not supported, "
+                                     "Only version 0 is supported",
+                                     version));
+  int32_t desc_size = file->ReadValue<int32_t>();
+  PADDLE_ENFORCE_GE(desc_size, 0, platform::errors::InvalidArgument(
+                                      "Cannot parse tensor desc"));
+  proto::VarType::TensorDesc desc;
+  PADDLE_ENFORCE_EQ(
+      desc.ParseFromArray(file->Read(desc_size), desc_size), true,
+      platform::errors::InvalidArgument("Cannot parse tensor desc"));
+
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  tensor->Resize(make_ddim(dims));
+  tensor->set_lod(lod);
+  auto type = desc.data_type();
+  size_t type_size = SizeOfType(type);
+  size_t bytes = tensor->numel() * type_size;
+  char* data = file->Read(bytes);
+  if (reinterpret_cast<uintptr_t>(data) % type_size == 0) {
+    tensor->ResetHolderWithType(
+        std::make_shared<MappedTensorAllocation>(data, bytes, file), type);
+  } else {
+    // the kernels need the data aligned to its type at least
+    std::memcpy(tensor->mutable_data(platform::CPUPlace(), type), data, bytes);
+  }
+}
+
+void ReadMappedLoDTensor(const std::shared_ptr<MappedTensorFile>& file,
+                         const TensorContainerEntry& entry,
+                         LoDTensor* tensor) {
+  const char* payload = file->data() + entry.offset;
+  if (entry.compression != TensorCompression::kNone) {
+    DecodeTensorPayload(entry, payload, tensor);
+    return;
+  }
+  CheckTensorPayload(entry, payload);
+  std::vector<int64_t> dims(entry.desc.dims().begin(),
+                            entry.desc.dims().end());
+  tensor->Resize(make_ddim(dims));
+  tensor->set_lod(entry.lod);
+  auto type = entry.desc.data_type();
+  PADDLE_ENFORCE_EQ(tensor->numel() * SizeOfType(type), entry.raw_size,
+                    platform::errors::InvalidArgument(
+                        "The size of the tensor %s mismatches its shape [%s].",
+                        entry.name, tensor->dims()));
+  // the payloads are 64-byte aligned in the container
+  tensor->ResetHolderWithType(
+      std::make_shared<MappedTensorAllocation>(const_cast<char*>(payload),
+                                               entry.raw_size, file),
+      type);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,76 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_container.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * A file of the LoDTensors serialized by SerializeToStream, e.g. the combined
+ * parameters file saved by save_combine, mapped privately into the memory.
+ * The pages are shared with the page cache, so the processes mapping the same
+ * file share one copy of the weights, and the writes to the tensors
+ * referencing the file, e.g. by the fuse passes, are never written back.
+ */
+class MappedTensorFile {
+ public:
+  explicit MappedTensorFile(const std::string& path);
+  ~MappedTensorFile();
+
+  MappedTensorFile(const MappedTensorFile&) = delete;
+  MappedTensorFile& operator=(const MappedTensorFile&) = delete;
+
+  // Return the next bytes of the file and move the offset forward.
+  char* Read(size_t bytes);
+
+  template <typename T>
+  T ReadValue() {
+    T value;
+    std::memcpy(&value, Read(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  bool eof() const { return offset_ == size_; }
+  const std::string& path() const { return path_; }
+  const char* data() const { return static_cast<const char*>(data_); }
+  size_t size() const { return size_; }
+
+ private:
+  std::string path_;
+  void* data_{nullptr};
+  size_t size_{0};
+  size_t offset_{0};
+};
+
+// Read the next LoDTensor of the file on the CPU. The tensor references the
+// mapped file directly and keeps it mapped, unless its data is not aligned to
+// its type in the file, which is copied then.
+void ReadMappedLoDTensor(const std::shared_ptr<MappedTensorFile>& file,
+                         LoDTensor* tensor);
+
+// Read the tensor of the entry of the mapped tensor container on the CPU, see
+// tensor_container.h. The uncompressed tensor references the mapped file
+// directly, and the compressed one is decompressed.
+void ReadMappedLoDTensor(const std::shared_ptr<MappedTensorFile>& file,
+                         const TensorContainerEntry& entry, LoDTensor* tensor);
+
+}  // namespace framework
+}  // namespace paddle
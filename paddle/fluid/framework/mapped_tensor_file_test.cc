@@ -0,0 +1,111 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/mapped_tensor_file.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(MappedTensorFile, read_lod_tensors) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  LoDTensor x, y;
+  x.Resize({3, 2});
+  x.set_lod({{0, 1, 3}});
+  float* x_data = x.mutable_data<float>(place);
+  for (int i = 0; i < 6; ++i) x_data[i] = i * 0.5f;
+  y.Resize({5});
+  int8_t* y_data = y.mutable_data<int8_t>(place);
+  for (int i = 0; i < 5; ++i) y_data[i] = -i;
+  {
+    std::ofstream fout("mapped_tensor_file_test", std::ios::binary);
+    SerializeToStream(fout, x, ctx);
+    SerializeToStream(fout, y, ctx);
+    SerializeToStream(fout, x, ctx);
+  }
+
+  auto file = std::make_shared<MappedTensorFile>("mapped_tensor_file_test");
+  LoDTensor mapped_x, mapped_y, mapped_x2;
+  ReadMappedLoDTensor(file, &mapped_x);
+  ReadMappedLoDTensor(file, &mapped_y);
+  // the data of the second x may be misaligned after the int8 tensor
+  ReadMappedLoDTensor(file, &mapped_x2);
+  EXPECT_TRUE(file->eof());
+  EXPECT_ANY_THROW(file->Read(1));
+  // the tensors keep the file mapped
+  file.reset();
+
+  EXPECT_EQ(mapped_x.dims(), x.dims());
+  EXPECT_EQ(mapped_x.lod(), x.lod());
+  EXPECT_EQ(mapped_x.type(), proto::VarType::FP32);
+  EXPECT_EQ(mapped_y.type(), proto::VarType::INT8);
+  EXPECT_EQ(mapped_x2.lod(), x.lod());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(mapped_x.data<float>()[i], x_data[i]);
+    EXPECT_EQ(mapped_x2.data<float>()[i], x_data[i]);
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(mapped_y.data<int8_t>()[i], y_data[i]);
+  }
+  // the mapping is private
+  mapped_x.data<float>()[0] = 100.f;
+  LoDTensor reread;
+  ReadMappedLoDTensor(
+      std::make_shared<MappedTensorFile>("mapped_tensor_file_test"), &reread);
+  EXPECT_EQ(reread.data<float>()[0], 0.f);
+}
+
+TEST(MappedTensorFile, read_tensor_container) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  LoDTensor x;
+  x.Resize({4, 3});
+  float* x_data = x.mutable_data<float>(place);
+  for (int i = 0; i < 12; ++i) x_data[i] = i;
+  {
+    std::ofstream fout("mapped_tensor_container_test", std::ios::binary);
+    TensorContainerWriter writer(&fout);
+    writer.Append("x", x, ctx);
+    writer.Append("compressed_x", x, ctx, TensorCompression::kZlib);
+    writer.Finish();
+  }
+
+  auto file =
+      std::make_shared<MappedTensorFile>("mapped_tensor_container_test");
+  ASSERT_TRUE(IsTensorContainer(file->data(), file->size()));
+  auto index = TensorContainerIndex::FromMemory(file->data(), file->size());
+  LoDTensor mapped_x, decoded_x;
+  ReadMappedLoDTensor(file, *index.Find("x"), &mapped_x);
+  ReadMappedLoDTensor(file, *index.Find("compressed_x"), &decoded_x);
+  // referenced without copying
+  EXPECT_EQ(mapped_x.data<float>(),
+            reinterpret_cast<const float*>(file->data() +
+                                           index.Find("x")->offset));
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(mapped_x.data<float>()[i], x_data[i]);
+    EXPECT_EQ(decoded_x.data<float>()[i], x_data[i]);
+  }
+}
+
+TEST(MappedTensorFile, missing_file) {
+  EXPECT_ANY_THROW(MappedTensorFile("mapped_tensor_file_not_found"));
+}
+
+}  // namespace framework
+}  // namespace paddle
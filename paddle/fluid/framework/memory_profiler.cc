@@ -0,0 +1,230 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/memory_profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+#include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+// The tensors of the place in the scope and its ancestors, each allocation
+// shared by the tensors, e.g. in place, is counted once.
+std::vector<LiveTensorInfo> LiveTensors(
+    const Scope& scope, const platform::Place& place,
+    const std::unordered_map<std::string, std::string>* producers) {
+  std::vector<LiveTensorInfo> tensors;
+  std::unordered_set<const void*> holders;
+  std::unordered_set<std::string> names;
+  auto add = [&](const std::string& name, const Tensor& tensor) {
+    if (!tensor.IsInitialized() ||
+        !platform::is_same_place(tensor.place(), place) ||
+        !holders.insert(tensor.Holder().get()).second) {
+      return;
+    }
+    LiveTensorInfo info;
+    info.name = name;
+    info.dims = vectorize(tensor.dims());
+    info.bytes = tensor.Holder()->size();
+    if (producers) {
+      auto it = producers->find(name);
+      if (it != producers->end()) info.producer = it->second;
+    }
+    tensors.push_back(std::move(info));
+  };
+  for (const Scope* s = &scope; s != nullptr; s = s->parent()) {
+    for (auto& name : s->LocalVarNames()) {
+      // the variables shadowed by the kid scopes
+      if (!names.insert(name).second) continue;
+      auto* var = s->FindLocalVar(name);
+      if (var == nullptr) continue;
+      if (var->IsType<LoDTensor>()) {
+        add(name, var->Get<LoDTensor>());
+      } else if (var->IsType<SelectedRows>()) {
+        add(name, var->Get<SelectedRows>().value());
+      } else if (var->IsType<LoDTensorArray>()) {
+        auto& array = var->Get<LoDTensorArray>();
+        for (size_t i = 0; i < array.size(); ++i) {
+          add(name + "[" + std::to_string(i) + "]", array[i]);
+        }
+      }
+    }
+  }
+  std::sort(tensors.begin(), tensors.end(),
+            [](const LiveTensorInfo& a, const LiveTensorInfo& b) {
+              return a.bytes > b.bytes;
+            });
+  return tensors;
+}
+
+std::string FormatBytes(size_t bytes) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(3) << bytes / 1024. / 1024. << "MB";
+  return ss.str();
+}
+
+}  // namespace
+
+std::atomic<bool> MemoryProfiler::enabled_{false};
+
+MemoryProfiler& MemoryProfiler::Instance() {
+  static MemoryProfiler profiler;
+  return profiler;
+}
+
+void MemoryProfiler::Enable() {
+  Reset();
+  enabled_.store(true);
+}
+
+void MemoryProfiler::Disable() { enabled_.store(false); }
+
+void MemoryProfiler::Reset() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  peaks_.clear();
+  op_stats_.clear();
+  producers_.clear();
+}
+
+size_t MemoryProfiler::LiveBytes(const Scope& scope,
+                                 const platform::Place& place) const {
+  memory::allocation::AllocatorStats stats;
+  if (memory::allocation::AllocatorFacade::Instance().GetStats(place,
+                                                               &stats)) {
+    return stats.allocated_bytes;
+  }
+  size_t bytes = 0;
+  for (auto& tensor : LiveTensors(scope, place, nullptr)) {
+    bytes += tensor.bytes;
+  }
+  return bytes;
+}
+
+void MemoryProfiler::RecordOp(const std::string& op_type,
+                              const VariableNameMap& outputs,
+                              const Scope& scope, const platform::Place& place,
+                              size_t bytes_before) {
+  size_t live_bytes = LiveBytes(scope, place);
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& pair : outputs) {
+    for (auto& name : pair.second) producers_[name] = op_type;
+  }
+
+  auto& stat = op_stats_[op_type];
+  stat.op_type = op_type;
+  ++stat.calls;
+  stat.max_live_bytes = std::max(stat.max_live_bytes, live_bytes);
+  stat.max_increase_bytes =
+      std::max(stat.max_increase_bytes, static_cast<int64_t>(live_bytes) -
+                                            static_cast<int64_t>(bytes_before));
+
+  // the tensors are collected at the new peaks only
+  auto& peak = peaks_[place];
+  if (live_bytes > peak.live_bytes) {
+    peak.live_bytes = live_bytes;
+    peak.op_type = op_type;
+    peak.tensors = LiveTensors(scope, place, &producers_);
+    VLOG(4) << "The new peak of " << place << " is " << live_bytes
+            << " bytes after " << op_type;
+  }
+}
+
+std::map<platform::Place, MemoryPeak> MemoryProfiler::Peaks() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return peaks_;
+}
+
+std::vector<OpMemoryStat> MemoryProfiler::OpStats() const {
+  std::vector<OpMemoryStat> stats;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& pair : op_stats_) stats.push_back(pair.second);
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const OpMemoryStat& a, const OpMemoryStat& b) {
+              return a.max_live_bytes > b.max_live_bytes;
+            });
+  return stats;
+}
+
+std::string MemoryProfiler::Report(size_t max_tensors) const {
+  std::stringstream ss;
+  ss << "------------------------->     Memory Profiling Report     "
+        "<-------------------------\n";
+  for (auto& pair : Peaks()) {
+    auto& peak = pair.second;
+    ss << "\nPlace: " << pair.first
+       << "\nPeak: " << FormatBytes(peak.live_bytes) << " after "
+       << peak.op_type << "\n\n";
+    ss << std::left << std::setw(40) << "Tensor" << std::setw(24) << "Shape"
+       << std::setw(24) << "Producer" << "Size\n";
+    for (size_t i = 0; i < peak.tensors.size() && i < max_tensors; ++i) {
+      auto& tensor = peak.tensors[i];
+      std::stringstream dims;
+      dims << "[";
+      for (size_t j = 0; j < tensor.dims.size(); ++j) {
+        dims << (j ? ", " : "") << tensor.dims[j];
+      }
+      dims << "]";
+      ss << std::left << std::setw(40) << tensor.name << std::setw(24)
+         << dims.str() << std::setw(24)
+         << (tensor.producer.empty() ? "-" : tensor.producer)
+         << FormatBytes(tensor.bytes) << "\n";
+    }
+    if (peak.tensors.size() > max_tensors) {
+      ss << "... " << peak.tensors.size() - max_tensors << " more tensors\n";
+    }
+  }
+  ss << "\n" << std::left << std::setw(40) << "Op" << std::setw(12) << "Calls"
+     << std::setw(24) << "Max live" << "Max increase\n";
+  for (auto& stat : OpStats()) {
+    ss << std::left << std::setw(40) << stat.op_type << std::setw(12)
+       << stat.calls << std::setw(24) << FormatBytes(stat.max_live_bytes)
+       << (stat.max_increase_bytes < 0 ? "-" : "")
+       << FormatBytes(std::abs(stat.max_increase_bytes)) << "\n";
+  }
+  return ss.str();
+}
+
+RecordOpMemory::RecordOpMemory(const std::string& op_type,
+                               const VariableNameMap& outputs,
+                               const Scope& scope,
+                               const platform::Place& place)
+    : op_type_(op_type), outputs_(outputs), scope_(scope), place_(place) {
+  if (!MemoryProfiler::IsEnabled()) return;
+  is_enabled_ = true;
+  bytes_before_ = MemoryProfiler::Instance().LiveBytes(scope_, place_);
+}
+
+RecordOpMemory::~RecordOpMemory() {
+  // the op failed
+  if (!is_enabled_ || std::uncaught_exception()) return;
+  MemoryProfiler::Instance().RecordOp(op_type_, outputs_, scope_, place_,
+                                      bytes_before_);
+}
+
+}  // namespace framework
+}  // namespace paddle
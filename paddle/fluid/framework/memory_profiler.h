@@ -0,0 +1,117 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/type_defs.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+struct LiveTensorInfo {
+  std::string name;
+  std::vector<int64_t> dims;
+  // the type of the last op writing the tensor
+  std::string producer;
+  size_t bytes{0};
+};
+
+// The live bytes of a place at its peak, right after the op running.
+struct MemoryPeak {
+  size_t live_bytes{0};
+  std::string op_type;
+  // the tensors in the scopes of the op, in the descending order of bytes
+  std::vector<LiveTensorInfo> tensors;
+};
+
+// The high-water mark of the ops of a type.
+struct OpMemoryStat {
+  std::string op_type;
+  int64_t calls{0};
+  // the max live bytes right after the op
+  size_t max_live_bytes{0};
+  // the max increase of the live bytes by the op
+  int64_t max_increase_bytes{0};
+};
+
+/*
+ * The memory profiling mode, which tracks the live bytes of the place over
+ * the ops run by the executors, the ParallelExecutor and the NaiveExecutor,
+ * and attributes the peak to the ops and the tensors.
+ *
+ * The live bytes are the allocated bytes of the allocator of the place, or
+ * the bytes of the tensors in the scopes of the op if the allocator has no
+ * statistics, e.g. with FLAGS_use_system_allocator.
+ */
+class MemoryProfiler {
+ public:
+  static MemoryProfiler& Instance();
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+  void Enable();
+  void Disable();
+  void Reset();
+
+  size_t LiveBytes(const Scope& scope, const platform::Place& place) const;
+
+  // Called right after an op runs.
+  void RecordOp(const std::string& op_type, const VariableNameMap& outputs,
+                const Scope& scope, const platform::Place& place,
+                size_t bytes_before);
+
+  std::map<platform::Place, MemoryPeak> Peaks() const;
+  // In the descending order of max_live_bytes.
+  std::vector<OpMemoryStat> OpStats() const;
+
+  // The peak of each place with its live tensors, and the table of the ops.
+  std::string Report(size_t max_tensors = 20) const;
+
+ private:
+  MemoryProfiler() = default;
+
+  static std::atomic<bool> enabled_;
+
+  mutable std::mutex mutex_;
+  std::map<platform::Place, MemoryPeak> peaks_;
+  std::unordered_map<std::string, OpMemoryStat> op_stats_;
+  std::unordered_map<std::string, std::string> producers_;
+};
+
+// Record the live bytes around the run of an op, if the memory profiler is
+// enabled.
+class RecordOpMemory {
+ public:
+  RecordOpMemory(const std::string& op_type, const VariableNameMap& outputs,
+                 const Scope& scope, const platform::Place& place);
+  ~RecordOpMemory();
+
+ private:
+  bool is_enabled_{false};
+  const std::string& op_type_;
+  const VariableNameMap& outputs_;
+  const Scope& scope_;
+  const platform::Place& place_;
+  size_t bytes_before_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
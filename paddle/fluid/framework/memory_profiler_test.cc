@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/memory_profiler.h"
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(MemoryProfiler, peak_and_op_stats) {
+  auto& profiler = MemoryProfiler::Instance();
+  profiler.Enable();
+  Scope scope;
+  platform::CPUPlace place;
+  auto run_op = [&](const std::string& type, const std::string& out,
+                    int64_t rows) {
+    VariableNameMap outputs{{"Out", {out}}};
+    RecordOpMemory record(type, outputs, scope, place);
+    scope.Var(out)->GetMutable<LoDTensor>()->mutable_data<float>(
+        make_ddim({rows, 256}), place);
+  };
+  run_op("fill_constant", "a", 1024);
+  run_op("matmul", "b", 4096);
+  scope.EraseVars({"b"});
+  run_op("relu", "c", 1024);
+  profiler.Disable();
+  // not recorded after disabled
+  run_op("scale", "d", 8192);
+
+  auto peaks = profiler.Peaks();
+  ASSERT_EQ(peaks.size(), 1UL);
+  auto& peak = peaks.begin()->second;
+  EXPECT_EQ(peak.op_type, "matmul");
+  ASSERT_EQ(peak.tensors.size(), 2UL);
+  EXPECT_EQ(peak.tensors[0].name, "b");
+  EXPECT_EQ(peak.tensors[0].producer, "matmul");
+  EXPECT_EQ(peak.tensors[0].dims, std::vector<int64_t>({4096, 256}));
+  EXPECT_GE(peak.tensors[0].bytes, 4096UL * 256 * sizeof(float));
+  EXPECT_EQ(peak.tensors[1].name, "a");
+  EXPECT_EQ(peak.tensors[1].producer, "fill_constant");
+
+  auto stats = profiler.OpStats();
+  ASSERT_EQ(stats.size(), 3UL);
+  EXPECT_EQ(stats[0].op_type, "matmul");
+  EXPECT_EQ(stats[0].calls, 1);
+  EXPECT_GE(stats[0].max_increase_bytes,
+            static_cast<int64_t>(4096 * 256 * sizeof(float)));
+  EXPECT_NE(profiler.Report().find("matmul"), std::string::npos);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -54,16 +54,17 @@ class Vector {
         : cpu_(dat), flag_(kDataInCPU) {}
     ~VectorData() {}
 
-    VectorData(const VectorData &o) {
-      o.ImmutableCPU();
-      cpu_ = o.cpu_;
-      flag_ = kDataInCPU;
-    }
+    // The copy shares the data on cuda of o if it is known to be the same
+    // as the data on CPU, so that the copy need not copy it to cuda again.
+    VectorData(const VectorData &o) { *this = o; }
 
     VectorData &operator=(const VectorData &o) {
       o.ImmutableCPU();
       cpu_ = o.cpu_;
       flag_ = kDataInCPU;
+      gpu_ = o.uploaded_ == nullptr ? nullptr : o.gpu_;
+      gpu_memory_size_ = o.gpu_memory_size_;
+      uploaded_ = o.uploaded_;
       return *this;
     }
 
@@ -161,10 +162,25 @@ class Vector {
       return reinterpret_cast<T *>(gpu_->ptr());
     }
 
+    // copy the data to cuda on the stream in advance, if it is not there yet
+    void PrefetchCUDA(platform::Place place, cudaStream_t stream) const {
+      PADDLE_ENFORCE(platform::is_gpu_place(place),
+                     "CUDA Data must on CUDA place");
+      ImmutableCUDA(place, stream);
+    }
+
     // get cuda ptr. mutable
     T *CUDAMutableData(platform::Place place) {
+      // the data on cuda shared with a copy must not be changed
+      if (gpu_ != nullptr && gpu_.use_count() > 1) {
+        ImmutableCPU();
+        gpu_ = nullptr;
+        uploaded_ = nullptr;
+        flag_ = kDirty | kDataInCPU;
+      }
       const T *ptr = CUDAData(place);
       flag_ = kDirty | kDataInCUDA;
+      uploaded_ = nullptr;
       return const_cast<T *>(ptr);
     }
 
@@ -193,11 +209,12 @@ class Vector {
 
     std::mutex &Mutex() const { return mtx_; }
 
+    // The place of the data on cuda, none if the data is not there. The
+    // cached data which is not known to be valid yet is not counted.
     boost::optional<platform::CUDAPlace> CUDAPlace() const {
-      return gpu_ == nullptr
+      return gpu_ == nullptr || !IsInCUDA()
                  ? boost::none
-                 : boost::optional<platform::CUDAPlace>(
-                       BOOST_GET_CONST(platform::CUDAPlace, gpu_->place()));
+                 : boost::optional<platform::CUDAPlace>(GPUPlace());
     }
 
    private:
@@ -215,9 +232,10 @@ class Vector {
       auto stream = dev_ctx->stream();
       void *src = gpu_->ptr();
       void *dst = cpu_.data();
-      paddle::memory::Copy(platform::CPUPlace(), dst, CUDAPlace().get(), src,
+      paddle::memory::Copy(platform::CPUPlace(), dst, GPUPlace(), src,
                            gpu_memory_size_, stream);
       dev_ctx->Wait();
+      uploaded_ = std::make_shared<const std::vector<T>>(cpu_);
     }
 
     void MutableCPU() {
@@ -227,10 +245,13 @@ class Vector {
       flag_ = kDirty | kDataInCPU;
     }
 
-    void ImmutableCUDA(platform::Place place) const {
+    // the data is copied on the stream of the device context if stream is
+    // nullptr
+    void ImmutableCUDA(platform::Place place,
+                       cudaStream_t stream = nullptr) const {
       if (IsDirty()) {
         if (IsInCPU()) {
-          CopyCPUDataToCUDA(place);
+          CopyCPUDataToCUDA(place, stream);
           UnsetFlag(kDirty);
           SetFlag(kDataInCUDA);
         } else if (IsInCUDA() && !(place == gpu_->place())) {
@@ -243,7 +264,7 @@ class Vector {
       } else {
         if (!IsInCUDA()) {
           // Even data is not dirty. However, data is not in CUDA. Copy data.
-          CopyCPUDataToCUDA(place);
+          CopyCPUDataToCUDA(place, stream);
           SetFlag(kDataInCUDA);
         } else if (!(place == gpu_->place())) {
           PADDLE_THROW("This situation should not happen.");
@@ -254,16 +275,31 @@ class Vector {
       }
     }
 
-    void CopyCPUDataToCUDA(const platform::Place &place) const {
+    // The data is not copied if the data on cuda is still the same, e.g.
+    // when the CPU data is only read through a mutable accessor, or this is
+    // a copy of a vector whose data is on cuda.
+    void CopyCPUDataToCUDA(const platform::Place &place,
+                           cudaStream_t stream) const {
+      if (gpu_ != nullptr && uploaded_ != nullptr &&
+          gpu_->place() == place && *uploaded_ == cpu_) {
+        return;
+      }
       void *src = cpu_.data();
       gpu_memory_size_ = cpu_.size() * sizeof(T);
-      gpu_ = memory::Alloc(place, gpu_memory_size_);
+      gpu_ = memory::AllocShared(place, gpu_memory_size_);
       void *dst = gpu_->ptr();
-      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
-          platform::DeviceContextPool::Instance().Get(place));
-      auto stream = dev_ctx->stream();
-      paddle::memory::Copy(CUDAPlace().get(), dst, platform::CPUPlace(), src,
+      if (stream == nullptr) {
+        auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+            platform::DeviceContextPool::Instance().Get(place));
+        stream = dev_ctx->stream();
+      }
+      paddle::memory::Copy(GPUPlace(), dst, platform::CPUPlace(), src,
                            gpu_memory_size_, stream);
+      uploaded_ = std::make_shared<const std::vector<T>>(cpu_);
+    }
+
+    platform::CUDAPlace GPUPlace() const {
+      return BOOST_GET_CONST(platform::CUDAPlace, gpu_->place());
     }
 
     void ImmutableCPU() const {
@@ -285,8 +321,10 @@ class Vector {
     bool IsInCPU() const { return flag_ & kDataInCPU; }
 
     mutable std::vector<T> cpu_;
-    mutable paddle::memory::AllocationPtr gpu_;
+    mutable std::shared_ptr<paddle::memory::Allocation> gpu_;
     mutable size_t gpu_memory_size_{0};
+    // The data of gpu_, nullptr if it is unknown, e.g. being changed on cuda.
+    mutable std::shared_ptr<const std::vector<T>> uploaded_;
     mutable int flag_;
 
     mutable std::mutex mtx_;
@@ -395,6 +433,25 @@ class Vector {
     return CUDAData(place);
   }
 
+  // Copy the data to cuda on the stream in advance, so that CUDAData does not
+  // copy it on the stream of the device context later. The stream must be
+  // synchronized before the data on cuda is used.
+  void PrefetchCUDA(platform::Place place, cudaStream_t stream) const {
+    {
+      auto &mtx = m_.Data().Mutex();
+      std::lock_guard<std::mutex> guard(mtx);
+      auto cuda_place = m_.Data().CUDAPlace();
+      if (cuda_place == boost::none ||
+          cuda_place == BOOST_GET(platform::CUDAPlace, place)) {
+        m_.Data().PrefetchCUDA(place, stream);
+        return;
+      }
+    }
+    // If m_ contains CUDAData in a different place. Detach manually.
+    m_.Detach();
+    PrefetchCUDA(place, stream);
+  }
+
   // get cuda ptr. mutable
   T *CUDAMutableData(platform::Place place) {
     {
@@ -50,6 +50,35 @@ TEST(mixed_vector, GPU_VECTOR) {
   }
 }
 
+TEST(mixed_vector, CachedCUDAData) {
+  vec<int> tmp;
+  for (int i = 0; i < 10; ++i) {
+    tmp.push_back(i);
+  }
+  paddle::platform::CUDAPlace gpu(0);
+  const int* ptr = tmp.CUDAData(gpu);
+
+  // Reading the CPU data through a mutable accessor does not copy again.
+  ASSERT_EQ(tmp[3], 3);
+  ASSERT_EQ(tmp.CUDAData(gpu), ptr);
+
+  // A copy shares the data on cuda, until it is changed on one of them.
+  vec<int> copy = tmp;
+  copy[0] = 0;
+  ASSERT_EQ(copy.CUDAData(gpu), ptr);
+  multiply_10<<<1, 1, 0, GetCUDAStream(gpu)>>>(copy.CUDAMutableData(gpu));
+  ASSERT_NE(copy.CUDAData(gpu), ptr);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(copy[i], i * 10);
+    ASSERT_EQ(tmp[i], i);
+  }
+  ASSERT_EQ(tmp.CUDAData(gpu), ptr);
+
+  // The changed data is copied again.
+  tmp[0] = 100;
+  ASSERT_NE(tmp.CUDAData(gpu), ptr);
+}
+
 TEST(mixed_vector, MultiGPU) {
   if (paddle::platform::GetCUDADeviceCount() < 2) {
     LOG(WARNING) << "Skip mixed_vector.MultiGPU since there are not multiple "
@@ -12,8 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <limits>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -24,6 +28,8 @@
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/string/pretty_log.h"
 
 namespace paddle {
@@ -41,12 +47,255 @@ void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
 }
 
 void NaiveExecutor::Run() {
-  for (auto &op : ops_) {
+  platform::RecordStep step;
+#ifdef PADDLE_WITH_CUDA
+  if (use_cuda_graph_ && op_timings_.empty() &&
+      platform::is_gpu_place(place_)) {
+    RunCUDAGraph();
+    return;
+  }
+#endif
+  RunOps();
+}
+
+void NaiveExecutor::RunOps() {
+  if (op_var_slots_.size() != ops_.size()) {
+    CompileVarSlots();
+  }
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto &op = ops_[i];
     VLOG(4) << std::this_thread::get_id() << " run "
             << op->DebugStringEx(scope_) << " on scope " << scope_;
+    // The previous ops may create or erase variables.
+    if (VarSlotsOutdated()) {
+      BindVarSlots();
+    }
+    // The variables in the context may be replaced by the transformed ones
+    // in the last run, so they are filled from the slots each time.
+    auto &op_slots = op_var_slots_[i];
+    auto slot_iter = op_slots.slots.begin();
+    for (auto *vars : {&op_slots.ctx->inputs, &op_slots.ctx->outputs}) {
+      for (auto &pair : *vars) {
+        for (auto &var : pair.second) {
+          var = var_slots_[*slot_iter++];
+        }
+      }
+    }
     op->SetIsCalledByExecutor(false);
-    op->Run(*scope_, place_);
+    if (op_timings_.empty()) {
+      op->Run(*scope_, place_, op_slots.ctx.get());
+      continue;
+    }
+    auto start = std::chrono::steady_clock::now();
+    op->Run(*scope_, place_, op_slots.ctx.get());
+    if (platform::is_gpu_place(place_)) {
+      platform::DeviceContextPool::Instance().Get(place_)->Wait();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    op_timings_[i].calls.fetch_add(1, std::memory_order_relaxed);
+    op_timings_[i].nanoseconds.fetch_add(elapsed.count(),
+                                         std::memory_order_relaxed);
+  }
+}
+
+void NaiveExecutor::EnableOpTiming(bool enable) {
+  std::vector<OpTiming> timings(enable ? ops_.size() : 0);
+  op_timings_.swap(timings);
+}
+
+std::vector<NaiveExecutor::OpTimingStat> NaiveExecutor::GetOpTimings() const {
+  std::vector<OpTimingStat> stats;
+  stats.reserve(op_timings_.size());
+  for (size_t i = 0; i < op_timings_.size(); ++i) {
+    auto &op = ops_[i];
+    OpTimingStat stat;
+    stat.type = op->Type();
+    for (auto &pair : op->Outputs()) {
+      if (!pair.second.empty()) {
+        stat.output = pair.second.front();
+        break;
+      }
+    }
+    stat.calls = op_timings_[i].calls.load(std::memory_order_relaxed);
+    stat.total_ms =
+        op_timings_[i].nanoseconds.load(std::memory_order_relaxed) / 1e6;
+    stats.push_back(std::move(stat));
+  }
+  return stats;
+}
+
+void NaiveExecutor::ResetOpTimings() {
+  for (auto &timing : op_timings_) {
+    timing.calls.store(0, std::memory_order_relaxed);
+    timing.nanoseconds.store(0, std::memory_order_relaxed);
+  }
+}
+
+void NaiveExecutor::EnableCUDAGraph(bool enable) {
+#ifdef PADDLE_WITH_CUDA
+  if (enable && !platform::CUDAGraph::IsSupported()) {
+    LOG(WARNING) << "CUDA Graph needs CUDA 10.1 or higher, it is disabled.";
+    enable = false;
   }
+  cuda_graph_.reset();
+  captured_tensors_.clear();
+#endif
+  use_cuda_graph_ = enable;
+}
+
+#ifdef PADDLE_WITH_CUDA
+// The address of the tensor which is neither checked nor type dependent.
+static const void *TensorAddress(const Tensor &tensor) {
+  auto &holder = tensor.Holder();
+  if (holder == nullptr) return nullptr;
+  return reinterpret_cast<const uint8_t *>(holder->ptr()) + tensor.offset();
+}
+
+void NaiveExecutor::RunCUDAGraph() {
+  if (cuda_graph_ != nullptr) {
+    if (!CapturedTensorsChanged()) {
+      cuda_graph_->Replay();
+      return;
+    }
+    VLOG(3) << "The tensors are changed since CUDA Graph " << cuda_graph_->ID()
+            << " is captured, capture it again";
+    cuda_graph_.reset();
+    captured_tensors_.clear();
+  }
+
+  // Run the ops as usual before capturing, so that the kernels are chosen,
+  // the tensors are allocated and the outputs of this run are computed,
+  // since the captured kernels are not run.
+  RunOps();
+  if (!CanCaptureCUDAGraph()) {
+    LOG(WARNING) << "Some op has no CUDA kernel, CUDA Graph is disabled.";
+    use_cuda_graph_ = false;
+    return;
+  }
+
+  auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  // Try again in the next run if another graph is being captured.
+  if (!platform::CUDAGraph::BeginCapture(
+          BOOST_GET_CONST(platform::CUDAPlace, place_), dev_ctx->stream())) {
+    return;
+  }
+  try {
+    RunOps();
+    cuda_graph_ = platform::CUDAGraph::EndCapture();
+  } catch (std::exception &ex) {
+    if (platform::CUDAGraph::IsThisThreadCapturing()) {
+      try {
+        platform::CUDAGraph::EndCapture();
+      } catch (std::exception &) {
+      }
+    }
+    LOG(WARNING) << "Failed to capture CUDA Graph, so it is disabled: "
+                 << ex.what();
+    use_cuda_graph_ = false;
+    return;
+  }
+  RecordCapturedTensors();
+  VLOG(3) << "NaiveExecutor captures CUDA Graph " << cuda_graph_->ID()
+          << " with " << ops_.size() << " ops and "
+          << captured_tensors_.size() << " tensors";
+}
+
+bool NaiveExecutor::CanCaptureCUDAGraph() const {
+  for (auto &op : ops_) {
+    if (dynamic_cast<const OperatorWithKernel *>(op.get()) == nullptr ||
+        !platform::is_gpu_place(op->GetExecutionPlace(place_))) {
+      VLOG(3) << "Op " << op->Type() << " cannot be captured by CUDA Graph";
+      return false;
+    }
+  }
+  return true;
+}
+
+void NaiveExecutor::RecordCapturedTensors() {
+  std::unordered_set<const LoDTensor *> recorded;
+  for (auto *var : var_slots_) {
+    if (var == nullptr || !var->IsType<LoDTensor>()) continue;
+    auto &tensor = var->Get<LoDTensor>();
+    if (!recorded.insert(&tensor).second) continue;
+    captured_tensors_.push_back(CapturedTensor{&tensor, TensorAddress(tensor),
+                                               tensor.dims(), tensor.lod()});
+  }
+}
+
+bool NaiveExecutor::CapturedTensorsChanged() const {
+  if (VarSlotsOutdated()) return true;
+  for (auto &captured : captured_tensors_) {
+    auto &tensor = *captured.tensor;
+    if (TensorAddress(tensor) != captured.data ||
+        tensor.dims() != captured.dims || !(tensor.lod() == captured.lod)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+void NaiveExecutor::CompileVarSlots() {
+  std::unordered_map<std::string, size_t> slot_indices;
+  auto get_slot = [&](const std::string &name) {
+    auto iter = slot_indices.find(name);
+    if (iter != slot_indices.end()) return iter->second;
+    slot_indices.emplace(name, slot_names_.size());
+    slot_names_.push_back(name);
+    return slot_names_.size() - 1;
+  };
+
+  slot_names_.clear();
+  op_var_slots_.clear();
+  op_var_slots_.reserve(ops_.size());
+  for (auto &op : ops_) {
+    OpVarSlots op_slots;
+    op_slots.ctx.reset(new RuntimeContext(VariableValueMap(),
+                                          VariableValueMap()));
+    for (auto &pair : op->Inputs()) {
+      op_slots.ctx->inputs[pair.first].resize(pair.second.size());
+      for (auto &name : pair.second) {
+        op_slots.slots.push_back(get_slot(name));
+      }
+    }
+    for (auto &pair : op->Outputs()) {
+      op_slots.ctx->outputs[pair.first].resize(pair.second.size());
+      for (auto &name : pair.second) {
+        op_slots.slots.push_back(get_slot(name));
+      }
+    }
+    op_var_slots_.emplace_back(std::move(op_slots));
+  }
+  VLOG(3) << "NaiveExecutor compiles " << slot_names_.size()
+          << " variable slots for " << ops_.size() << " ops";
+  BindVarSlots();
+}
+
+void NaiveExecutor::BindVarSlots() {
+  PADDLE_ENFORCE_NOT_NULL(
+      scope_, platform::errors::PreconditionNotMet(
+                  "The scope of NaiveExecutor should be prepared before "
+                  "running."));
+  // Take the versions before finding, so that the variables created in the
+  // meantime by other threads make the slots outdated.
+  bound_scopes_.clear();
+  for (const Scope *s = scope_; s != nullptr; s = s->parent()) {
+    bound_scopes_.emplace_back(s, s->version());
+  }
+  var_slots_.resize(slot_names_.size());
+  for (size_t i = 0; i < slot_names_.size(); ++i) {
+    var_slots_[i] = scope_->FindVar(slot_names_[i]);
+  }
+}
+
+bool NaiveExecutor::VarSlotsOutdated() const {
+  if (bound_scopes_.empty() || bound_scopes_[0].first != scope_) return true;
+  for (auto &pair : bound_scopes_) {
+    if (pair.first->version() != pair.second) return true;
+  }
+  return false;
 }
 
 void NaiveExecutor::CreateVariables(const ProgramDesc &desc, int block_id,
@@ -116,6 +365,82 @@ void NaiveExecutor::CleanFeedFetchOps() {
     }
   }
   ops_.swap(ops);
+  op_var_slots_.clear();
+  if (!op_timings_.empty()) EnableOpTiming(true);
+}
+
+void NaiveExecutor::SetStaticMemoryPlan(const StaticMemoryPlan &plan) {
+  SetStaticMemoryPlans({{std::numeric_limits<int>::max(), plan}});
+}
+
+void NaiveExecutor::SetStaticMemoryPlans(
+    const BucketedStaticMemoryPlan &plans) {
+  PADDLE_ENFORCE_NOT_NULL(
+      scope_, platform::errors::PreconditionNotMet(
+                  "The scope of NaiveExecutor should be prepared before "
+                  "setting the static memory plan."));
+  arena_.reset();
+  memory_plans_.clear();
+  bound_memory_plan_ = nullptr;
+  bound_ranges_.clear();
+  size_t arena_size = 0;
+  for (auto &bucket : plans) {
+    auto &plan = bucket.second;
+    for (auto &item : plan.var_ranges) {
+      size_t offset = item.second.first;
+      size_t size = item.second.second;
+      PADDLE_ENFORCE_LE(
+          offset + size, plan.arena_size,
+          platform::errors::InvalidArgument(
+              "The range [%d, %d) of variable %s exceeds the arena size %d.",
+              offset, offset + size, item.first, plan.arena_size));
+    }
+    arena_size = std::max(arena_size, plan.arena_size);
+  }
+  if (arena_size == 0) return;
+
+  memory_plans_ = plans;
+  arena_ = memory::AllocShared(place_, arena_size);
+  BindStaticMemoryPlan(memory_plans_.rbegin()->second);
+}
+
+void NaiveExecutor::SelectStaticMemoryPlan(int size) {
+  if (memory_plans_.size() < 2) return;
+  auto it = memory_plans_.lower_bound(size);
+  if (it == memory_plans_.end()) --it;
+  if (&it->second != bound_memory_plan_) BindStaticMemoryPlan(it->second);
+}
+
+void NaiveExecutor::BindStaticMemoryPlan(const StaticMemoryPlan &plan) {
+  auto arena = arena_;
+  auto *base = reinterpret_cast<uint8_t *>(arena->ptr());
+  size_t num_bound = 0;
+  for (auto &item : plan.var_ranges) {
+    auto *var = scope_->FindVar(item.first);
+    if (var == nullptr || !var->IsType<LoDTensor>()) continue;
+    auto *tensor = var->GetMutable<LoDTensor>();
+    if (tensor->IsInitialized()) {
+      // The variable has been bound to some memory, e.g. by the user.
+      auto it = bound_ranges_.find(item.first);
+      if (it == bound_ranges_.end() || tensor->Holder().get() != it->second) {
+        continue;
+      }
+      tensor->clear();
+    }
+    // The range is a view of the arena, so it holds the arena to keep the
+    // memory alive as long as any tensor refers to it.
+    std::shared_ptr<memory::Allocation> range(
+        new memory::Allocation(base + item.second.first, item.second.second,
+                               place_),
+        [arena](memory::Allocation *range) { delete range; });
+    tensor->ResetHolder(range);
+    bound_ranges_[item.first] = range.get();
+    ++num_bound;
+  }
+  bound_memory_plan_ = &plan;
+  VLOG(3) << "NaiveExecutor binds " << num_bound
+          << " variables to a static memory arena of " << arena->size()
+          << " bytes";
 }
 
 NaiveExecutor::~NaiveExecutor() {
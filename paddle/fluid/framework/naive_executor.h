@@ -14,16 +14,42 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/device_context.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_graph.h"
+#endif
 
 namespace paddle {
 namespace framework {
 
+/*
+ * The static memory plan of the temporary variables. Each planned variable
+ * is assigned a fixed range in one preallocated arena, variables whose
+ * lifetimes do not overlap may share the same range.
+ */
+struct StaticMemoryPlan {
+  size_t arena_size{0};
+  // variable name -> (offset, size) in the arena.
+  std::unordered_map<std::string, std::pair<size_t, size_t>> var_ranges;
+};
+
+/*
+ * The static memory plans of the shape buckets, keyed by the upper bound of
+ * the unknown dimensions of the inputs in each bucket. All the plans plan
+ * the same variables, and share one arena of the largest size.
+ */
+using BucketedStaticMemoryPlan = std::map<int, StaticMemoryPlan>;
+
 /*
  * Simple, intuitive and effective. Only single thread is supported, and
  * currently designed for inference.
@@ -56,15 +82,120 @@ class NaiveExecutor {
 
   void CleanFeedFetchOps();
 
+  // Allocate the arena of the plan and bind the planned variables, which
+  // should have been created in the scope, to their ranges. The operators
+  // then write into the arena directly and no allocator is called in Run
+  // unless a tensor grows larger than its planned size.
+  void SetStaticMemoryPlan(const StaticMemoryPlan& plan);
+
+  // Allocate one arena for the largest plan of the buckets, and bind the
+  // planned variables by the plan of the largest bucket.
+  void SetStaticMemoryPlans(const BucketedStaticMemoryPlan& plans);
+
+  // Bind the planned variables by the plan of the smallest bucket not less
+  // than the size, or the largest bucket, before running a request of the
+  // size. The variables bound to other memory since the last binding, e.g.
+  // reallocated because of a larger size or shared with the user, are left
+  // as they are.
+  void SelectStaticMemoryPlan(int size);
+
+  // Capture the kernels launched by Run onto a CUDA Graph when running on
+  // GPU, and replay the graph in the later Run calls instead of running the
+  // ops. The graph is captured again once any tensor used by the ops is
+  // reallocated, reshaped or given another LoD, so the inputs should be fed
+  // in place with fixed shapes. The ops are run as usual if the graph cannot
+  // be captured, e.g. because some op runs on CPU or synchronizes the stream.
+  void EnableCUDAGraph(bool enable);
+
+  // The accumulated time of an op since the timing is enabled or reset.
+  struct OpTimingStat {
+    std::string type;
+    // the first output of the op, to tell the ops of the same type apart
+    std::string output;
+    uint64_t calls;
+    double total_ms;
+  };
+
+  // Time every op in Run. On GPU the device is synchronized after each op
+  // to time it, and the ops are not run by CUDA Graph, so it is for
+  // profiling a live service rather than for every run.
+  void EnableOpTiming(bool enable);
+
+  // The timings of the ops in the order they are run, which can be called
+  // by another thread while running.
+  std::vector<OpTimingStat> GetOpTimings() const;
+
+  void ResetOpTimings();
+
  protected:
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
  private:
+  // The variables of all ops are resolved to the indices of var_slots_ once,
+  // and the RuntimeContext of each op is filled from the slots, so that Run
+  // does not look up any variable in the scope by name. The slots are only
+  // bound again when any variable of the scope or its ancestors is created,
+  // erased or renamed.
+  void BindStaticMemoryPlan(const StaticMemoryPlan& plan);
+
+  void CompileVarSlots();
+  void BindVarSlots();
+  bool VarSlotsOutdated() const;
+
+  void RunOps();
+
+#ifdef PADDLE_WITH_CUDA
+  void RunCUDAGraph();
+  bool CanCaptureCUDAGraph() const;
+  void RecordCapturedTensors();
+  bool CapturedTensorsChanged() const;
+
+  struct CapturedTensor {
+    const LoDTensor* tensor;
+    const void* data;
+    DDim dims;
+    LoD lod;
+  };
+#endif
+
+  struct OpVarSlots {
+    std::unique_ptr<RuntimeContext> ctx;
+    // The slots of the variables in ctx, in the order of ctx->inputs and
+    // then ctx->outputs.
+    std::vector<size_t> slots;
+  };
+
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+  std::shared_ptr<memory::Allocation> arena_;
+  BucketedStaticMemoryPlan memory_plans_;
+  const StaticMemoryPlan* bound_memory_plan_{nullptr};
+  // The ranges of the arena bound to the planned variables by the last plan.
+  std::unordered_map<std::string, const memory::Allocation*> bound_ranges_;
+
+  struct OpTiming {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> nanoseconds{0};
+  };
+  // Allocated by EnableOpTiming per op of ops_, empty if disabled.
+  std::vector<OpTiming> op_timings_;
+
+  std::vector<OpVarSlots> op_var_slots_;
+  std::vector<std::string> slot_names_;
+  std::vector<Variable*> var_slots_;
+  // The scope and its ancestors, with their versions when binding the slots.
+  std::vector<std::pair<const Scope*, uint64_t>> bound_scopes_;
+
+  bool use_cuda_graph_{false};
+#ifdef PADDLE_WITH_CUDA
+  std::unique_ptr<platform::CUDAGraph> cuda_graph_;
+  // The tensors used by the ops, and their addresses and shapes when the
+  // graph is captured.
+  std::vector<CapturedTensor> captured_tensors_;
+#endif
 };
 
 }  // namespace framework
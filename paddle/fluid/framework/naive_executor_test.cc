@@ -64,6 +64,167 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, RebindVarSlots) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.CreateVariables(program, 0, false, exe.scope());
+
+  auto feed = [&](const std::string& name, float value) {
+    auto* tensor = exe.FindTensor(name);
+    tensor->Resize({1, 4});
+    std::fill_n(tensor->mutable_data<float>(place), 4, value);
+  };
+  feed("a", 1);
+  feed("b", 2);
+  exe.Run();
+  EXPECT_EQ(exe.FindTensor("c")->data<float>()[0], 3);
+
+  // The ops find the new variables after the old ones are erased.
+  exe.scope()->EraseVars({"b", "c"});
+  exe.CreateVariables(program, 0, false, exe.scope());
+  feed("b", 5);
+  exe.Run();
+  EXPECT_EQ(exe.FindTensor("c")->data<float>()[0], 6);
+}
+
+TEST(NaiveExecutor, OpTiming) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  for (auto& name : {"a", "b"}) {
+    auto* tensor = exe.FindTensor(name);
+    tensor->Resize({1, 4});
+    std::fill_n(tensor->mutable_data<float>(place), 4, 1.f);
+  }
+  EXPECT_TRUE(exe.GetOpTimings().empty());
+
+  exe.EnableOpTiming(true);
+  exe.Run();
+  exe.Run();
+  auto timings = exe.GetOpTimings();
+  ASSERT_EQ(timings.size(), 1UL);
+  EXPECT_EQ(timings[0].type, "elementwise_add");
+  EXPECT_EQ(timings[0].output, "c");
+  EXPECT_EQ(timings[0].calls, 2UL);
+  EXPECT_GE(timings[0].total_ms, 0.);
+
+  exe.ResetOpTimings();
+  EXPECT_EQ(exe.GetOpTimings()[0].calls, 0UL);
+  exe.EnableOpTiming(false);
+  exe.Run();
+  EXPECT_TRUE(exe.GetOpTimings().empty());
+}
+
+TEST(NaiveExecutor, StaticMemoryPlan) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.CreateVariables(program, 0, false, exe.scope());
+
+  StaticMemoryPlan plan;
+  plan.arena_size = 512;
+  plan.var_ranges["a"] = std::make_pair(0, 256);
+  plan.var_ranges["b"] = std::make_pair(256, 256);
+  // "c" shares the range of "a".
+  plan.var_ranges["c"] = std::make_pair(0, 256);
+  exe.SetStaticMemoryPlan(plan);
+
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  auto* c_tensor = exe.FindTensor("c");
+  a_tensor->Resize({1, 64});
+  b_tensor->Resize({1, 64});
+  c_tensor->Resize({1, 32});
+  auto* a_data = a_tensor->mutable_data<float>(place);
+  auto* b_data = b_tensor->mutable_data<float>(place);
+  auto* c_data = c_tensor->mutable_data<float>(place);
+  EXPECT_EQ(reinterpret_cast<uint8_t*>(b_data) -
+                reinterpret_cast<uint8_t*>(a_data),
+            256);
+  EXPECT_EQ(a_data, c_data);
+
+  // A tensor larger than its range is allocated by the allocator.
+  b_tensor->Resize({1, 128});
+  auto* new_b_data = b_tensor->mutable_data<float>(place);
+  EXPECT_NE(new_b_data, b_data);
+  EXPECT_EQ(b_tensor->memory_size(), 512UL);
+}
+
+TEST(NaiveExecutor, BucketedStaticMemoryPlan) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.CreateVariables(program, 0, false, exe.scope());
+
+  BucketedStaticMemoryPlan plans;
+  plans[4].arena_size = 128;
+  plans[4].var_ranges["a"] = std::make_pair(0, 64);
+  plans[4].var_ranges["b"] = std::make_pair(64, 64);
+  plans[16].arena_size = 512;
+  plans[16].var_ranges["a"] = std::make_pair(0, 256);
+  plans[16].var_ranges["b"] = std::make_pair(256, 256);
+  exe.SetStaticMemoryPlans(plans);
+
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  auto range_of = [&](LoDTensor* tensor) {
+    return std::make_pair(
+        reinterpret_cast<uint8_t*>(b_tensor->Holder()->ptr()) -
+            reinterpret_cast<uint8_t*>(a_tensor->Holder()->ptr()),
+        tensor->Holder()->size());
+  };
+  // the largest bucket is bound by default
+  EXPECT_EQ(range_of(b_tensor), std::make_pair(256L, 256UL));
+
+  exe.SelectStaticMemoryPlan(3);
+  EXPECT_EQ(range_of(b_tensor), std::make_pair(64L, 64UL));
+  // the sizes beyond the buckets use the largest one
+  exe.SelectStaticMemoryPlan(100);
+  EXPECT_EQ(range_of(b_tensor), std::make_pair(256L, 256UL));
+
+  // a tensor bound to other memory is not bound again
+  b_tensor->Resize({1, 128});
+  auto* b_data = b_tensor->mutable_data<float>(place);
+  exe.SelectStaticMemoryPlan(4);
+  EXPECT_EQ(a_tensor->Holder()->size(), 64UL);
+  EXPECT_EQ(b_tensor->data<float>(), b_data);
+}
+
 }  // namespace framework
 }  // namespace paddle
 
@@ -0,0 +1,174 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_cost_estimator.h"
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+const Tensor* VarTensor(const Variable* var) {
+  if (var == nullptr) return nullptr;
+  const Tensor* tensor = nullptr;
+  if (var->IsType<LoDTensor>()) {
+    tensor = &var->Get<LoDTensor>();
+  } else if (var->IsType<SelectedRows>()) {
+    tensor = &var->Get<SelectedRows>().value();
+  }
+  return tensor && tensor->IsInitialized() ? tensor : nullptr;
+}
+
+double Bytes(const Tensor* tensor) {
+  return tensor ? static_cast<double>(tensor->numel()) *
+                      SizeOfType(tensor->type())
+                : 0.;
+}
+
+template <typename T>
+T AttrOr(const OperatorBase& op, const std::string& name, T value) {
+  return op.HasAttr(name) ? op.Attr<T>(name) : value;
+}
+
+bool MulCost(const OperatorBase& op, const Scope& scope, OpCost* cost) {
+  auto* y = GetOpTensor(op, scope, "Y");
+  auto* out = GetOpTensor(op, scope, "Out", false);
+  if (!y || !out) return false;
+  int y_num_col_dims = AttrOr<int>(op, "y_num_col_dims", 1);
+  auto k = product(slice_ddim(y->dims(), 0, y_num_col_dims));
+  cost->flops = 2. * out->numel() * k;
+  cost->bytes = OpTensorBytes(op, scope);
+  return true;
+}
+
+bool MatmulCost(const OperatorBase& op, const Scope& scope, OpCost* cost) {
+  auto* x = GetOpTensor(op, scope, "X");
+  auto* out = GetOpTensor(op, scope, "Out", false);
+  if (!x || !out || x->dims().size() == 0) return false;
+  bool transpose_x = op.Type() == "matmul"
+                         ? AttrOr<bool>(op, "transpose_X", false)
+                         : AttrOr<bool>(op, "trans_x", false);
+  auto rank = x->dims().size();
+  auto k =
+      (transpose_x && rank > 1) ? x->dims()[rank - 2] : x->dims()[rank - 1];
+  cost->flops = 2. * out->numel() * k;
+  cost->bytes = OpTensorBytes(op, scope);
+  return true;
+}
+
+// Each output element multiplies and adds the filter of a group.
+bool ConvCost(const OperatorBase& op, const Scope& scope, OpCost* cost) {
+  auto* filter = GetOpTensor(op, scope, "Filter");
+  auto* output = GetOpTensor(op, scope, "Output", false);
+  if (!filter || !output || filter->dims().size() < 3) return false;
+  cost->flops = 2. * output->numel() * (filter->numel() / filter->dims()[0]);
+  cost->bytes = OpTensorBytes(op, scope);
+  return true;
+}
+
+bool ElementwiseCost(const OperatorBase& op, const Scope& scope,
+                     OpCost* cost) {
+  auto* out = GetOpTensor(op, scope, "Out", false);
+  if (!out) return false;
+  cost->flops = static_cast<double>(out->numel());
+  cost->bytes = OpTensorBytes(op, scope);
+  return true;
+}
+
+bool ReduceCost(const OperatorBase& op, const Scope& scope, OpCost* cost) {
+  auto* x = GetOpTensor(op, scope, "X");
+  if (!x) return false;
+  cost->flops = static_cast<double>(x->numel());
+  cost->bytes = OpTensorBytes(op, scope);
+  return true;
+}
+
+// Only the rows looked up are read from the table.
+bool LookupTableCost(const OperatorBase& op, const Scope& scope,
+                     OpCost* cost) {
+  auto* ids = GetOpTensor(op, scope, "Ids");
+  auto* out = GetOpTensor(op, scope, "Out", false);
+  if (!ids || !out) return false;
+  cost->flops = 0.;
+  cost->bytes = Bytes(ids) + 2. * Bytes(out);
+  return true;
+}
+
+}  // namespace
+
+const Tensor* GetOpTensor(const OperatorBase& op, const Scope& scope,
+                          const std::string& slot, bool is_input) {
+  auto& names = is_input ? op.Inputs() : op.Outputs();
+  auto it = names.find(slot);
+  if (it == names.end() || it->second.empty()) return nullptr;
+  return VarTensor(scope.FindVar(it->second[0]));
+}
+
+double OpTensorBytes(const OperatorBase& op, const Scope& scope) {
+  double bytes = 0.;
+  std::unordered_set<std::string> counted;
+  for (auto* names : {&op.Inputs(), &op.Outputs()}) {
+    for (auto& pair : *names) {
+      for (auto& name : pair.second) {
+        if (!counted.insert(name).second) continue;
+        bytes += Bytes(VarTensor(scope.FindVar(name)));
+      }
+    }
+  }
+  return bytes;
+}
+
+OpCostRegistry& OpCostRegistry::Instance() {
+  static OpCostRegistry registry;
+  return registry;
+}
+
+OpCostRegistry::OpCostRegistry() {
+  Register("mul", MulCost);
+  for (auto* type : {"matmul", "matmul_v2"}) Register(type, MatmulCost);
+  for (auto* type : {"conv2d", "depthwise_conv2d", "conv3d"}) {
+    Register(type, ConvCost);
+  }
+  for (auto* type : {"elementwise_add", "elementwise_sub", "elementwise_mul",
+                     "elementwise_div", "elementwise_max", "elementwise_min",
+                     "elementwise_pow"}) {
+    Register(type, ElementwiseCost);
+  }
+  for (auto* type : {"reduce_sum", "reduce_mean", "reduce_max", "reduce_min",
+                     "reduce_prod"}) {
+    Register(type, ReduceCost);
+  }
+  for (auto* type : {"lookup_table", "lookup_table_v2"}) {
+    Register(type, LookupTableCost);
+  }
+}
+
+void OpCostRegistry::Register(const std::string& op_type,
+                              OpCostEstimator estimator) {
+  estimators_[op_type] = std::move(estimator);
+}
+
+bool OpCostRegistry::Estimate(const OperatorBase& op, const Scope& scope,
+                              OpCost* cost) const {
+  auto it = estimators_.find(op.Type());
+  return it != estimators_.end() && it->second(op, scope, cost);
+}
+
+}  // namespace framework
+}  // namespace paddle
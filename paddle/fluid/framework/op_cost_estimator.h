@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+
+struct OpCost {
+  double flops{0.};
+  // the bytes read and written
+  double bytes{0.};
+};
+
+// Estimate the cost of a run of the op from the dims of its inputs and
+// outputs in the scope right after the run, and its attributes. Return false
+// if the dims are unknown.
+using OpCostEstimator = std::function<bool(const OperatorBase& op,
+                                           const Scope& scope, OpCost* cost)>;
+
+/*
+ * The cost estimators of the ops for the roofline report of the profiler,
+ * registered for mul, matmul, conv, elementwise, reduce and lookup_table. The
+ * other ops may register theirs.
+ */
+class OpCostRegistry {
+ public:
+  static OpCostRegistry& Instance();
+
+  void Register(const std::string& op_type, OpCostEstimator estimator);
+  bool Has(const std::string& op_type) const {
+    return estimators_.count(op_type) > 0;
+  }
+
+  // Return false if the op has no estimator or the cost is unknown.
+  bool Estimate(const OperatorBase& op, const Scope& scope,
+                OpCost* cost) const;
+
+ private:
+  OpCostRegistry();
+
+  std::unordered_map<std::string, OpCostEstimator> estimators_;
+};
+
+// The first tensor of the input or output slot of the op, nullptr if it is
+// not initialized.
+const Tensor* GetOpTensor(const OperatorBase& op, const Scope& scope,
+                          const std::string& slot, bool is_input = true);
+
+// The bytes of the initialized tensors of all the inputs and outputs.
+double OpTensorBytes(const OperatorBase& op, const Scope& scope);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,91 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_cost_estimator.h"
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+class CostTestOp : public OperatorBase {
+ public:
+  CostTestOp(const std::string& type, const VariableNameMap& inputs,
+             const VariableNameMap& outputs, const AttributeMap& attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+ private:
+  void RunImpl(const Scope& scope,
+               const platform::Place& place) const override {}
+};
+
+static void NewTensor(Scope* scope, const std::string& name,
+                      const std::vector<int64_t>& dims) {
+  scope->Var(name)->GetMutable<LoDTensor>()->mutable_data<float>(
+      make_ddim(dims), platform::CPUPlace());
+}
+
+TEST(OpCostRegistry, estimate) {
+  Scope scope;
+  NewTensor(&scope, "x", {8, 16});
+  NewTensor(&scope, "y", {16, 32});
+  NewTensor(&scope, "out", {8, 32});
+  auto& registry = OpCostRegistry::Instance();
+
+  OpCost cost;
+  CostTestOp mul("mul", {{"X", {"x"}}, {"Y", {"y"}}}, {{"Out", {"out"}}},
+                 {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}});
+  ASSERT_TRUE(registry.Estimate(mul, scope, &cost));
+  EXPECT_EQ(cost.flops, 2. * 8 * 16 * 32);
+  EXPECT_EQ(cost.bytes, (8 * 16 + 16 * 32 + 8 * 32) * sizeof(float));
+
+  CostTestOp matmul("matmul", {{"X", {"x"}}, {"Y", {"y"}}},
+                    {{"Out", {"out"}}}, {{"transpose_X", false}});
+  ASSERT_TRUE(registry.Estimate(matmul, scope, &cost));
+  EXPECT_EQ(cost.flops, 2. * 8 * 16 * 32);
+
+  CostTestOp add("elementwise_add", {{"X", {"out"}}, {"Y", {"out"}}},
+                 {{"Out", {"out"}}}, {});
+  ASSERT_TRUE(registry.Estimate(add, scope, &cost));
+  EXPECT_EQ(cost.flops, 8. * 32);
+  // the tensor is counted once
+  EXPECT_EQ(cost.bytes, 8 * 32 * sizeof(float));
+
+  NewTensor(&scope, "input", {1, 3, 8, 8});
+  NewTensor(&scope, "filter", {4, 3, 3, 3});
+  NewTensor(&scope, "output", {1, 4, 8, 8});
+  CostTestOp conv("conv2d", {{"Input", {"input"}}, {"Filter", {"filter"}}},
+                  {{"Output", {"output"}}}, {});
+  ASSERT_TRUE(registry.Estimate(conv, scope, &cost));
+  EXPECT_EQ(cost.flops, 2. * 4 * 8 * 8 * 3 * 3 * 3);
+
+  // the unknown dims and the ops without the estimators
+  CostTestOp missing("mul", {{"X", {"x"}}, {"Y", {"z"}}}, {{"Out", {"out"}}},
+                     {});
+  EXPECT_FALSE(registry.Estimate(missing, scope, &cost));
+  CostTestOp relu("relu", {{"X", {"x"}}}, {{"Out", {"x"}}}, {});
+  EXPECT_FALSE(registry.Estimate(relu, scope, &cost));
+
+  registry.Register("relu", [](const OperatorBase& op, const Scope& scope,
+                               OpCost* cost) {
+    cost->flops = 1.;
+    return true;
+  });
+  EXPECT_TRUE(registry.Estimate(relu, scope, &cost));
+}
+
+}  // namespace framework
+}  // namespace paddle
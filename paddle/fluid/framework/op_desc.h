@@ -19,6 +19,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/attribute.h"
+#include "paddle/fluid/framework/proto_desc.h"
 #include "paddle/fluid/framework/type_defs.h"
 #include "paddle/fluid/framework/var_desc.h"
 
@@ -46,7 +47,10 @@ class OpDesc {
 
   std::string Type() const { return desc_.type(); }
 
-  void SetType(const std::string &type) { desc_.set_type(type); }
+  void SetType(const std::string &type) {
+    desc_.set_type(type);
+    MarkUpdated();
+  }
 
   const std::vector<std::string> &Input(const std::string &name) const;
 
@@ -118,7 +122,7 @@ class OpDesc {
   const VariableNameMap &Outputs() const { return outputs_; }
 
   AttributeMap *MutableAttrMap() {
-    this->need_update_ = true;
+    MarkUpdated();
     return &this->attrs_;
   }
 
@@ -132,6 +136,10 @@ class OpDesc {
 
   void Flush();
 
+  // Changed by the modifications, see NextDescRevision. The changes through
+  // the mutable Proto() are not counted.
+  uint64_t Revision() const { return revision_; }
+
   BlockDesc *Block() { return this->block_; }
 
   const BlockDesc *Block() const { return this->block_; }
@@ -155,9 +163,16 @@ class OpDesc {
   VariableNameMap outputs_;
   AttributeMap attrs_;
 
+  // Mark the local changes and pass the new revision to the owner block.
+  void MarkUpdated();
+
   // need_update_ indicate there some local changes not be synchronized. If
   // local changes should be synchronized, need_update_ should be set to true.
   bool need_update_{false};
+  uint64_t revision_ = NextDescRevision();
+  DescOwner owner_;
+
+  friend class BlockDesc;
 };
 }  // namespace framework
 }  // namespace paddle
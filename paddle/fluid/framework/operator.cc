@@ -24,7 +24,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/memory_profiler.h"
 #include "paddle/fluid/framework/op_call_stack.h"
+#include "paddle/fluid/framework/op_cost_estimator.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/shape_inference.h"
@@ -41,6 +43,21 @@ DECLARE_bool(benchmark);
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(enable_unused_var_check);
 DEFINE_int32(inner_op_parallelism, 0, "number of threads for inner op");
+DEFINE_bool(cache_runtime_infer_shape, false,
+            "Skip the InferShape of an operator whose runtime context is "
+            "cached, if the dims and LoD of all its inputs are the same as "
+            "the last run, and reuse the output shapes of the last run. The "
+            "operators with integer inputs, e.g. ShapeTensor or SizeTensor, "
+            "whose values may decide the output shapes, always run "
+            "InferShape. The attributes changed at runtime are not noticed, "
+            "so only enable it when they are not, e.g., in inference.");
+DEFINE_bool(cache_transformed_persistable_vars, false,
+            "Cache the data transform results of the persistable inputs of "
+            "an operator, which are reused until the inputs are got mutable. "
+            "The in-place writes through the tensors fetched before, or "
+            "through the fused buffers aliasing the inputs, are not noticed, "
+            "so only enable it when the persistable inputs are not written, "
+            "e.g., in inference.");
 DEFINE_bool(fast_check_nan_inf, false,
             "Fast checking NAN/INF after each operation. It will be a little"
             "bit slow, much faster than check_nan_inf");
@@ -155,6 +172,11 @@ RuntimeContext::RuntimeContext(const VariableNameMap& innames,
 }
 
 void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
+  Run(scope, place, nullptr);
+}
+
+void OperatorBase::Run(const Scope& scope, const platform::Place& place,
+                       RuntimeContext* ctx) {
   try {
     VLOG(4) << place << " " << DebugStringEx(&scope);
     if (platform::is_gpu_place(place)) {
@@ -174,7 +196,19 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
       auto op_name = platform::OpName(outputs_, Type());
       platform::RecordEvent op_name_record_event(
           op_name, platform::EventRole::kUniqueOp);
-      RunImpl(scope, place);
+      RecordOpMemory op_memory_record(Type(), outputs_, scope, place);
+      if (ctx == nullptr) {
+        RunImpl(scope, place);
+      } else {
+        RunImplWithContext(scope, place, ctx);
+      }
+    }
+
+    if (platform::IsProfileEnabled()) {
+      OpCost cost;
+      if (OpCostRegistry::Instance().Estimate(*this, scope, &cost)) {
+        platform::RecordOpCost(Type(), cost.flops, cost.bytes);
+      }
     }
 
     VLOG(3) << GetExecutionPlace(place) << " " << DebugStringEx(&scope);
@@ -737,9 +771,14 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   bool IsRuntime() const override { return true; }
 
+  // Whether the variables are accessed directly, which means that the
+  // InferShape may depend on more than the dims and LoD of the inputs.
+  bool VarPtrsAccessed() const { return var_ptrs_accessed_; }
+
   // TODO(paddle-dev): Can this be template?
   std::vector<InferShapeVarPtr> GetInputVarPtrs(
       const std::string& name) override {
+    var_ptrs_accessed_ = true;
     const std::vector<Variable*>& vars = InputVars(name);
     std::vector<InferShapeVarPtr> res;
     res.reserve(vars.size());
@@ -749,6 +788,7 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   std::vector<InferShapeVarPtr> GetOutputVarPtrs(
       const std::string& name) override {
+    var_ptrs_accessed_ = true;
     const std::vector<Variable*>& vars = OutputVars(name);
     std::vector<InferShapeVarPtr> res;
     res.reserve(vars.size());
@@ -880,6 +920,7 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   const OperatorBase& op_;
   const RuntimeContext& ctx_;
+  bool var_ptrs_accessed_{false};
 };
 
 static void CheckTensorNANOrInf(const std::string& op_type,
@@ -905,6 +946,66 @@ void OperatorWithKernel::RuntimeInferShape(const Scope& scope,
   this->InferShape(&infer_shape_ctx);
 }
 
+bool OperatorWithKernel::CollectVarShapes(const VariableValueMap& vars,
+                                          VarShapes* shapes,
+                                          bool reject_integer_tensors) {
+  shapes->clear();
+  for (auto& pair : vars) {
+    for (auto* var : pair.second) {
+      if (var == nullptr || !var->IsInitialized()) {
+        shapes->emplace_back();
+      } else if (var->IsType<LoDTensor>()) {
+        auto& tensor = var->Get<LoDTensor>();
+        if (reject_integer_tensors && tensor.IsInitialized() &&
+            (tensor.type() == proto::VarType::INT32 ||
+             tensor.type() == proto::VarType::INT64)) {
+          return false;
+        }
+        shapes->emplace_back(std::make_pair(tensor.dims(), tensor.lod()));
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void OperatorWithKernel::RunInferShape(const RuntimeContext& ctx) const {
+  // Only the op whose runtime context is cached runs with the same variables
+  // each time, which is the case of inference mostly.
+  bool use_cache =
+      FLAGS_cache_runtime_infer_shape && enable_cache_runtime_context_;
+  VarShapes input_shapes;
+  // The values of the integer inputs, e.g. ShapeTensor, may decide the output
+  // shapes rather than their dims.
+  if (use_cache && CollectVarShapes(ctx.inputs, &input_shapes, true)) {
+    if (infer_shape_cached_ && input_shapes == cached_input_shapes_) {
+      size_t i = 0;
+      for (auto& pair : ctx.outputs) {
+        for (auto* var : pair.second) {
+          auto& shape = cached_output_shapes_[i++];
+          if (shape) {
+            auto* tensor = var->GetMutable<LoDTensor>();
+            tensor->Resize(shape->first);
+            tensor->set_lod(shape->second);
+          }
+        }
+      }
+      return;
+    }
+  } else {
+    use_cache = false;
+  }
+
+  RuntimeInferShapeContext infer_shape_ctx(*this, ctx);
+  this->InferShape(&infer_shape_ctx);
+  infer_shape_cached_ = use_cache && !infer_shape_ctx.VarPtrsAccessed() &&
+                        CollectVarShapes(ctx.outputs, &cached_output_shapes_);
+  if (infer_shape_cached_) {
+    cached_input_shapes_ = std::move(input_shapes);
+  }
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place) const {
   // To reduce the elapsed time of HasAttr, we use bool variable to record the
@@ -925,20 +1026,34 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
       if (runtime_ctx_.get() == nullptr || pre_scope_ != cur_scope) {
         runtime_ctx_.reset(new RuntimeContext(Inputs(), Outputs(), scope));
         pre_scope_ = cur_scope;
+        infer_shape_cached_ = false;
       }
     }
     RunImpl(scope, place, runtime_ctx_.get());
   }
 }
 
+void OperatorWithKernel::RunImplWithContext(
+    const Scope& scope, const platform::Place& place,
+    RuntimeContext* runtime_ctx) const {
+  if (!all_kernels_must_compute_runtime_shape_ &&
+      HasAttr(kAllKernelsMustComputeRuntimeShape))
+    all_kernels_must_compute_runtime_shape_ = true;
+  RunImpl(scope, place, runtime_ctx);
+  pre_scope_ = &scope;
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place,
                                  RuntimeContext* runtime_ctx) const {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto* dev_ctx = pool.Get(place);
 
-  if (kernel_type_.get() == nullptr || kernel_func_.get() == nullptr) {
-    ChooseKernel(*runtime_ctx, scope, place);
+  // The kernel is used through this snapshot, since the other threads may
+  // choose another one in the meantime.
+  auto kernel = GetChosenKernel();
+  if (kernel == nullptr || KernelInputsChanged(*kernel, *runtime_ctx, place)) {
+    kernel = ChooseKernel(*runtime_ctx, scope, place);
   }
 
   // do data transformScope &transfer_scope;
@@ -948,7 +1063,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
     platform::RecordEvent record_event("prepare_data",
                                        platform::EventRole::kInnerOp);
     if (need_prepare_data_) {
-      transfer_scope = PrepareData(scope, *kernel_type_,
+      transfer_scope = PrepareData(scope, kernel->type,
                                    &transfered_inplace_vars, runtime_ctx);
     }
   }
@@ -956,15 +1071,14 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   const Scope& exec_scope =
       (transfer_scope == nullptr ? scope : *transfer_scope);
 
-  if (!(kernel_type_->place_ == dev_ctx->GetPlace())) {
-    dev_ctx = pool.Get(kernel_type_->place_);
+  if (!(kernel->type.place_ == dev_ctx->GetPlace())) {
+    dev_ctx = pool.Get(kernel->type.place_);
   }
 
   if (!all_kernels_must_compute_runtime_shape_) {
     platform::RecordEvent record_event("infer_shape",
                                        platform::EventRole::kInnerOp);
-    RuntimeInferShapeContext infer_shape_ctx(*this, *runtime_ctx);
-    this->InferShape(&infer_shape_ctx);
+    RunInferShape(*runtime_ctx);
   }
 
   if (FLAGS_enable_unused_var_check) {
@@ -976,8 +1090,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   {
     platform::RecordEvent record_event("compute",
                                        platform::EventRole::kInnerOp);
-    (*kernel_func_)(
-        ExecutionContext(*this, exec_scope, *dev_ctx, *runtime_ctx));
+    kernel->func(ExecutionContext(*this, exec_scope, *dev_ctx, *runtime_ctx));
   }
 
   if (!transfered_inplace_vars.empty()) {
@@ -1029,21 +1142,60 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 }
 
-void OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx,
-                                      const Scope& scope,
-                                      const platform::Place& place) const {
-  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
-  auto* dev_ctx = pool.Get(place);
+// The place packed into an integer: the kind of place and the device.
+static uint64_t PlaceCode(const platform::Place& place) {
+  uint64_t device = 0;
+  if (auto* gpu_place = boost::get<platform::CUDAPlace>(&place)) {
+    device = static_cast<uint64_t>(gpu_place->device) + 1;
+  }
+  return device << 4 | static_cast<uint64_t>(place.which());
+}
 
-  // check if op[type] has kernel registered.
-  auto& all_op_kernels = AllOpKernels();
-  auto kernels_iter = all_op_kernels.find(type_);
-  if (kernels_iter == all_op_kernels.end()) {
-    PADDLE_THROW(
-        "There are no kernels which are registered in the %s operator.", type_);
+// The data type, place and layout of the tensor held by var packed into an
+// integer, which the expected kernel type of an op usually depends on. It is
+// 0 if var holds no initialized tensor.
+static uint64_t InputKernelCode(const Variable* var) {
+  const Tensor* tensor = nullptr;
+  if (var != nullptr) {
+    if (var->IsType<LoDTensor>()) {
+      tensor = &var->Get<LoDTensor>();
+    } else if (var->IsType<Tensor>()) {
+      tensor = &var->Get<Tensor>();
+    } else if (var->IsType<SelectedRows>()) {
+      tensor = &var->Get<SelectedRows>().value();
+    }
+  }
+  if (tensor == nullptr || !tensor->IsInitialized()) {
+    return 0;
+  }
+  return PlaceCode(tensor->place()) << 24 |
+         static_cast<uint64_t>(tensor->type()) << 8 |
+         static_cast<uint64_t>(tensor->layout()) << 1 | 1;
+}
+
+bool OperatorWithKernel::KernelInputsChanged(const ChosenKernel& kernel,
+                                             const RuntimeContext& ctx,
+                                             const platform::Place& place) {
+  auto& codes = kernel.input_codes;
+  if (codes.empty() || codes[0] != PlaceCode(place)) {
+    return true;
   }
+  size_t i = 1;
+  for (auto& pair : ctx.inputs) {
+    for (auto* var : pair.second) {
+      if (i >= codes.size() || codes[i++] != InputKernelCode(var)) {
+        return true;
+      }
+    }
+  }
+  return i != codes.size();
+}
 
-  OpKernelMap& kernels = kernels_iter->second;
+std::shared_ptr<const OperatorWithKernel::ChosenKernel>
+OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
+                                 const platform::Place& place) const {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(place);
 
   auto expected_kernel_key = this->GetExpectedKernelType(
       ExecutionContext(*this, scope, *dev_ctx, ctx));
@@ -1074,27 +1226,64 @@ void OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx,
   }
   VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
 
-  auto kernel_iter = kernels.find(expected_kernel_key);
-#ifdef PADDLE_WITH_MKLDNN
-  // workaround for missing MKLDNN kernel when FLAGS_use_mkldnn env var is set
-  if (kernel_iter == kernels.end() &&
-      expected_kernel_key.library_type_ == LibraryType::kMKLDNN) {
-    VLOG(3) << "missing MKLDNN kernel: fallbacking to PLAIN one";
-    expected_kernel_key.library_type_ = LibraryType::kPlain;
-    expected_kernel_key.data_layout_ = DataLayout::kAnyLayout;
-    kernel_iter = kernels.find(expected_kernel_key);
-  }
-#endif
-  if (kernel_iter == kernels.end()) {
-    PADDLE_THROW("op %s does not have kernel for %s", type_,
-                 KernelTypeToString(expected_kernel_key));
+  std::vector<uint64_t> input_codes{PlaceCode(place)};
+  for (auto& pair : ctx.inputs) {
+    for (auto* var : pair.second) {
+      input_codes.emplace_back(InputKernelCode(var));
+    }
   }
 
   std::lock_guard<std::mutex> lock(cache_update_mutex_);
-  if (kernel_type_.get() == nullptr || kernel_func_.get() == nullptr) {
-    kernel_type_.reset(new OpKernelType(expected_kernel_key));
-    kernel_func_.reset(new OpKernelFunc(kernel_iter->second));
-  }
+  auto cache_iter = kernel_cache_.find(expected_kernel_key);
+  if (cache_iter == kernel_cache_.end()) {
+    // check if op[type] has kernel registered.
+    auto& all_op_kernels = AllOpKernels();
+    auto kernels_iter = all_op_kernels.find(type_);
+    if (kernels_iter == all_op_kernels.end()) {
+      PADDLE_THROW(
+          "There are no kernels which are registered in the %s operator.",
+          type_);
+    }
+
+    OpKernelMap& kernels = kernels_iter->second;
+    OpKernelType registered_kernel_key = expected_kernel_key;
+    auto kernel_iter = kernels.find(registered_kernel_key);
+#ifdef PADDLE_WITH_MKLDNN
+    // workaround for missing MKLDNN kernel when FLAGS_use_mkldnn env var is
+    // set
+    if (kernel_iter == kernels.end() &&
+        registered_kernel_key.library_type_ == LibraryType::kMKLDNN) {
+      VLOG(3) << "missing MKLDNN kernel: fallbacking to PLAIN one";
+      registered_kernel_key.library_type_ = LibraryType::kPlain;
+      registered_kernel_key.data_layout_ = DataLayout::kAnyLayout;
+      kernel_iter = kernels.find(registered_kernel_key);
+    }
+#endif
+    if (kernel_iter == kernels.end()) {
+      PADDLE_THROW("op %s does not have kernel for %s", type_,
+                   KernelTypeToString(registered_kernel_key));
+    }
+    cache_iter =
+        kernel_cache_
+            .emplace(expected_kernel_key,
+                     std::make_pair(registered_kernel_key, kernel_iter->second))
+            .first;
+  }
+
+  // The threads still running with the last kernel keep their snapshots.
+  auto& registered_kernel_key = cache_iter->second.first;
+  auto last_kernel = GetChosenKernel();
+  if (last_kernel != nullptr && last_kernel->type != registered_kernel_key) {
+    VLOG(3) << "The kernel of op " << type_ << " is changed from "
+            << last_kernel->type << " to " << registered_kernel_key;
+    // The inputs may need to be transformed for the new kernel.
+    need_prepare_data_ = true;
+  }
+  std::shared_ptr<const ChosenKernel> kernel(
+      new ChosenKernel{registered_kernel_key, cache_iter->second.second,
+                       std::move(input_codes)});
+  std::atomic_store(&chosen_kernel_, kernel);
+  return kernel;
 }
 
 void OperatorWithKernel::TransferInplaceVarsBack(
@@ -1122,6 +1311,7 @@ Scope* OperatorWithKernel::PrepareData(
     std::vector<std::string>* transfered_inplace_vars,
     RuntimeContext* ctx) const {
   Scope* new_scope = nullptr;
+  bool has_transformed_var = false;
 
   const std::unordered_set<std::string>* no_buffer_ins = nullptr;
   if (info_) {
@@ -1199,14 +1389,34 @@ Scope* OperatorWithKernel::PrepareData(
       }
 
       auto out_var_names = OutputVars(true);
-      if (std::find(out_var_names.begin(), out_var_names.end(), var_name) !=
-          out_var_names.end()) {
+      bool is_inplace_var =
+          std::find(out_var_names.begin(), out_var_names.end(), var_name) !=
+          out_var_names.end();
+      if (is_inplace_var) {
         transfered_inplace_vars->emplace_back(var_name);
       }
 
       VLOG(3) << "Transform Variable " << var_name << " from "
               << kernel_type_for_var << " to " << expected_kernel_key;
 
+      // The persistable variables, e.g., the parameters, are created in the
+      // ancestors of the scope. They are usually not changed between runs, so
+      // the transformed copies are cached instead of transforming them into
+      // a new scope each time.
+      if (FLAGS_cache_transformed_persistable_vars && !is_inplace_var &&
+          scope.FindLocalVar(var_name) == nullptr) {
+        input_vars[i] = TransformPersistableVar(
+            var_name, *var, *tensor_in, kernel_type_for_var,
+            expected_kernel_key);
+        has_transformed_var = true;
+        // The cached runtime context must not keep the transformed copy,
+        // see below.
+        if (enable_cache_runtime_context_) {
+          pre_scope_ = nullptr;
+        }
+        continue;
+      }
+
       // In the inference scenerio, the scopes will be reused across the
       // batches, so the `new_scope` here will result in GPU memroy explosion
       // over the  running of operators.
@@ -1258,13 +1468,46 @@ Scope* OperatorWithKernel::PrepareData(
   // the rest iterations to save the elapsed time.
   // We do not support skipping PrepareData in while block, because the Op's
   // input may be changed by subsequent Ops, which may cause an error.
-  if (pre_scope_ == &scope && new_scope == nullptr) {
+  if (pre_scope_ == &scope && new_scope == nullptr && !has_transformed_var) {
     need_prepare_data_ = false;
   }
 
   return new_scope;
 }
 
+Variable* OperatorWithKernel::TransformPersistableVar(
+    const std::string& var_name, const Variable& var, const Tensor& tensor_in,
+    const OpKernelType& kernel_type_for_var,
+    const OpKernelType& expected_kernel_key) const {
+  auto it = transformed_vars_.find(var_name);
+  if (it != transformed_vars_.end()) {
+    auto& cached = it->second;
+    if (cached.source == &var && cached.source_version == var.Version() &&
+        cached.source_holder.lock() == tensor_in.Holder() &&
+        cached.source_offset == tensor_in.offset() &&
+        cached.source_dims == tensor_in.dims() &&
+        cached.source_kernel_type == kernel_type_for_var &&
+        cached.kernel_type == expected_kernel_key) {
+      VLOG(3) << "Reuse the transformed Variable " << var_name
+              << " in Operator " << type_;
+      return cached.var.get();
+    }
+    transformed_vars_.erase(it);
+  }
+
+  std::unique_ptr<Variable> trans_var(new Variable());
+  Tensor out;
+  TransformData(expected_kernel_key, kernel_type_for_var, tensor_in, &out);
+  SetTensorToVariable(var, out, trans_var.get());
+  auto* trans_var_ptr = trans_var.get();
+  transformed_vars_.emplace(
+      var_name,
+      TransformedVar{&var, tensor_in.Holder(), tensor_in.offset(),
+                     tensor_in.dims(), var.Version(), kernel_type_for_var,
+                     expected_kernel_key, std::move(trans_var)});
+  return trans_var_ptr;
+}
+
 void OperatorWithKernel::ParseInputDataType(
     const ExecutionContext& ctx, const std::string& name,
     proto::VarType::Type* data_type) const {
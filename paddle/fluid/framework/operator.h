@@ -141,6 +141,12 @@ class OperatorBase {
   //  The implementation should be written at RunImpl
   void Run(const Scope& scope, const platform::Place& place);
 
+  /// Run an op with the variables of its inputs and outputs resolved in ctx
+  /// already, e.g. by NaiveExecutor, so that they are not looked up in scope
+  /// by name. The ops without kernels ignore ctx.
+  void Run(const Scope& scope, const platform::Place& place,
+           RuntimeContext* ctx);
+
   // FIXME(typhoonzero): this is only used for recv_op to stop event_loop.
   virtual void Stop() {}
 
@@ -221,6 +227,11 @@ class OperatorBase {
   void CheckAllInputOutputSet() const;
   virtual void RunImpl(const Scope& scope,
                        const platform::Place& place) const = 0;
+  virtual void RunImplWithContext(const Scope& scope,
+                                  const platform::Place& place,
+                                  RuntimeContext* ctx) const {
+    RunImpl(scope, place);
+  }
 };
 
 class ExecutionContext {
@@ -456,8 +467,9 @@ class OperatorWithKernel : public OperatorBase {
   }
 
   bool IsMKLDNNType() const {
-    return ((this->kernel_type_) && (this->kernel_type_->data_layout_ ==
-                                     framework::DataLayout::kMKLDNN));
+    auto kernel = GetChosenKernel();
+    return kernel != nullptr &&
+           kernel->type.data_layout_ == framework::DataLayout::kMKLDNN;
   }
 
   bool SupportGPU() const override {
@@ -486,7 +498,7 @@ class OperatorWithKernel : public OperatorBase {
 
   platform::Place GetExecutionPlace(
       const platform::Place& platform) const override {
-    return kernel_type_->place_;
+    return GetChosenKernel()->type.place_;
   }
 
  private:
@@ -496,6 +508,8 @@ class OperatorWithKernel : public OperatorBase {
   // same.
   proto::VarType::Type IndicateDataType(const ExecutionContext& ctx) const;
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
+  void RunImplWithContext(const Scope& scope, const platform::Place& place,
+                          RuntimeContext* runtime_ctx) const final;
   void RunImpl(const Scope& scope, const platform::Place& place,
                RuntimeContext* runtime_ctx) const;
 
@@ -515,12 +529,76 @@ class OperatorWithKernel : public OperatorBase {
                                const std::vector<std::string>& inplace_vars,
                                const Scope& exec_scope) const;
 
-  void ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
-                    const platform::Place& place) const;
+  // The kernel chosen with the inputs it is chosen for. It is published as
+  // a whole, since ChooseKernel replaces it while the other threads may run
+  // the op with the last one.
+  struct ChosenKernel {
+    OpKernelType type;
+    OpKernelFunc func;
+    // The codes of the place and the type, place and layout of every input,
+    // see KernelInputsChanged.
+    std::vector<uint64_t> input_codes;
+  };
+
+  std::shared_ptr<const ChosenKernel> GetChosenKernel() const {
+    return std::atomic_load(&chosen_kernel_);
+  }
+
+  std::shared_ptr<const ChosenKernel> ChooseKernel(
+      const RuntimeContext& ctx, const Scope& scope,
+      const platform::Place& place) const;
+
+  // Whether the place or the type, place or layout of any input is changed
+  // since the kernel is chosen, so that the expected kernel may be changed.
+  // They are compared as integer codes, so it costs little to check them
+  // before every run.
+  static bool KernelInputsChanged(const ChosenKernel& kernel,
+                                  const RuntimeContext& ctx,
+                                  const platform::Place& place);
+
+  // Run InferShape, or restore the output shapes of the last InferShape if
+  // the shapes of all inputs are not changed since then.
+  void RunInferShape(const RuntimeContext& ctx) const;
+
+  // The dims and LoD of each input or output variable in the order of
+  // RuntimeContext. An empty optional stands for a variable which is not
+  // initialized.
+  using VarShapes = std::vector<boost::optional<std::pair<DDim, LoD>>>;
+
+  // Return false if there is any variable which is not a LoDTensor, or which
+  // holds integers if reject_integer_tensors.
+  static bool CollectVarShapes(const VariableValueMap& vars, VarShapes* shapes,
+                               bool reject_integer_tensors = false);
+
+  // Return the transformed copy of the persistable input `var` cached by the
+  // last run, or transform it again if `var` is modified since then.
+  Variable* TransformPersistableVar(const std::string& var_name,
+                                    const Variable& var,
+                                    const Tensor& tensor_in,
+                                    const OpKernelType& kernel_type_for_var,
+                                    const OpKernelType& expected_kernel_key)
+      const;
+
+  struct TransformedVar {
+    const Variable* source;
+    std::weak_ptr<memory::Allocation> source_holder;
+    size_t source_offset;
+    DDim source_dims;
+    uint64_t source_version;
+    OpKernelType source_kernel_type;
+    OpKernelType kernel_type;
+    std::unique_ptr<Variable> var;
+  };
 
  protected:
-  mutable std::unique_ptr<OpKernelType> kernel_type_;
-  mutable std::unique_ptr<OpKernelFunc> kernel_func_;
+  // Only accessed by std::atomic_load and std::atomic_store.
+  mutable std::shared_ptr<const ChosenKernel> chosen_kernel_;
+  // The kernels chosen before, from the expected kernel type to the type and
+  // the function of the registered kernel.
+  mutable std::unordered_map<OpKernelType,
+                             std::pair<OpKernelType, OpKernelFunc>,
+                             OpKernelType::Hash>
+      kernel_cache_;
   mutable std::unique_ptr<RuntimeContext> runtime_ctx_;
   mutable const Scope* pre_scope_ = nullptr;
   mutable bool need_prepare_data_ = true;
@@ -528,6 +606,14 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
+  // The shapes of the inputs and outputs at the last InferShape, which is
+  // only used when the runtime context is cached.
+  mutable bool infer_shape_cached_ = false;
+  mutable VarShapes cached_input_shapes_;
+  mutable VarShapes cached_output_shapes_;
+  // The transformed copies of the persistable inputs, i.e., the inputs which
+  // are not in the scope the operator runs in, from the variable names.
+  mutable std::unordered_map<std::string, TransformedVar> transformed_vars_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
@@ -15,6 +15,8 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <istream>
+#include <ostream>
 #include <unordered_map>
 #include <vector>
 
@@ -28,18 +30,34 @@ class AlgorithmsCache {
   AlgorithmsCache() : search_times_(0) { hash_.clear(); }
   // Caches the best algorithm for a given
   // combination of tensor dimensions & compute data type.
-  // cudnn_dtype set for different data type
+  // cudnn_dtype set for different data type, data_layout and
+  // workspace_size_limit are in the key too since they change the best
+  // algorithm of the same dimensions.
   TAlgorithm GetAlgorithm(const std::vector<int64_t>& dims1,
                           const std::vector<int64_t>& dims2,
                           const std::vector<int>& strides,
                           const std::vector<int>& paddings,
                           const std::vector<int>& dilations, int algorithmFlags,
-                          int64_t cudnn_dtype,
+                          int64_t cudnn_dtype, int64_t data_layout,
+                          size_t workspace_size_limit,
                           std::function<TAlgorithm()> gen_func);
 
   TAlgorithm GetAlgorithm(int64_t area, int search_times, int algorithmFlags,
                           std::function<TAlgorithm()> gen_func);
 
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return hash_.size();
+  }
+
+  // Write the number of the cached algorithms, then one "key algo" line for
+  // every algorithm.
+  void Save(std::ostream* os);
+
+  // Read the algorithms written by Save. The algorithms already in the cache
+  // are kept. Return false if the stream is broken.
+  bool Load(std::istream* is);
+
  private:
   std::unordered_map<int64_t, TAlgorithm> hash_;
   int search_times_;
@@ -51,6 +69,7 @@ TAlgorithm framework::AlgorithmsCache<TAlgorithm>::GetAlgorithm(
     const std::vector<int64_t>& dims1, const std::vector<int64_t>& dims2,
     const std::vector<int>& strides, const std::vector<int>& paddings,
     const std::vector<int>& dilations, int algorithmFlags, int64_t cudnn_dtype,
+    int64_t data_layout, size_t workspace_size_limit,
     std::function<TAlgorithm()> gen_func) {
   int64_t seed = 0;
   // Hash all of the inputs, use to try and look up a previously
@@ -87,6 +106,11 @@ TAlgorithm framework::AlgorithmsCache<TAlgorithm>::GetAlgorithm(
   seed ^= hashFn(static_cast<int64_t>(cudnn_dtype)) + 0x9e3779b9 + (seed << 6) +
           (seed >> 2) + 6;
 
+  seed ^= hashFn(data_layout) + 0x9e3779b9 + (seed << 6) + (seed >> 2) + 7;
+
+  seed ^= hashFn(static_cast<int64_t>(workspace_size_limit)) + 0x9e3779b9 +
+          (seed << 6) + (seed >> 2) + 8;
+
   VLOG(10) << "seed:" << seed << ", hash_.size:" << hash_.size();
 
   if (seed == 0) return gen_func();
@@ -156,5 +180,27 @@ TAlgorithm AlgorithmsCache<TAlgorithm>::GetAlgorithm(
   return algo;
 }
 
+template <typename TAlgorithm>
+void AlgorithmsCache<TAlgorithm>::Save(std::ostream* os) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  *os << hash_.size() << "\n";
+  for (const auto& m : hash_) {
+    *os << m.first << " " << static_cast<int64_t>(m.second) << "\n";
+  }
+}
+
+template <typename TAlgorithm>
+bool AlgorithmsCache<TAlgorithm>::Load(std::istream* is) {
+  size_t num = 0;
+  if (!(*is >> num)) return false;
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  for (size_t i = 0; i < num; ++i) {
+    int64_t key, algo;
+    if (!(*is >> key >> algo)) return false;
+    hash_.emplace(key, static_cast<TAlgorithm>(algo));
+  }
+  return true;
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -19,6 +19,8 @@ limitations under the License. */
 #include "paddle/fluid/platform/init.h"
 
 DECLARE_bool(enable_unused_var_check);
+DECLARE_bool(cache_transformed_persistable_vars);
+DECLARE_bool(cache_runtime_infer_shape);
 
 namespace paddle {
 namespace framework {
@@ -746,3 +748,330 @@ TEST(OpWithoutUnusedVar, all) {
   ASSERT_NO_THROW(op->Run(scope, cpu_place));
   FLAGS_enable_unused_var_check = false;
 }
+
+namespace paddle {
+namespace framework {
+
+static int infer_shape_num = 0;
+
+class InferShapeCacheTest : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ++infer_shape_num;
+    auto dims = ctx->GetInputDim("X");
+    dims[0] *= 2;
+    ctx->SetOutputDim("Out", dims);
+    ctx->ShareLoD("X", "Out");
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(infer_shape_cache_test,
+                             paddle::framework::InferShapeCacheTest,
+                             paddle::framework::GetSetLoDLevelTestMaker);
+REGISTER_OP_CPU_KERNEL(infer_shape_cache_test,
+                       paddle::framework::EmptyTestKernel<
+                           paddle::platform::CPUDeviceContext, float>);
+
+TEST(InferShapeCache, all) {
+  paddle::framework::InitDevices(false, {});
+  FLAGS_cache_runtime_infer_shape = true;
+  paddle::framework::infer_shape_num = 0;
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("infer_shape_cache_test");
+  BuildVar("X", {"x"}, op_desc.add_inputs());
+  BuildVar("Out", {"out"}, op_desc.add_outputs());
+  auto attr = op_desc.mutable_attrs()->Add();
+  attr->set_name(paddle::framework::kEnableCacheRuntimeContext);
+  attr->set_type(paddle::framework::proto::AttrType::BOOLEAN);
+  attr->set_b(true);
+
+  paddle::platform::CPUPlace place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  auto* out = scope.Var("out")->GetMutable<paddle::framework::LoDTensor>();
+  x->mutable_data<float>(paddle::framework::make_ddim({4, 3}), place);
+  x->set_lod({{0, 1, 4}});
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::infer_shape_num, 1);
+  ASSERT_EQ(out->dims(), paddle::framework::make_ddim({8, 3}));
+
+  // The output shape is restored without InferShape.
+  out->Resize({1});
+  out->set_lod({});
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::infer_shape_num, 1);
+  ASSERT_EQ(out->dims(), paddle::framework::make_ddim({8, 3}));
+  ASSERT_EQ(out->lod(), x->lod());
+
+  // InferShape runs again once the LoD or the dims of the input changes.
+  x->set_lod({{0, 2, 4}});
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::infer_shape_num, 2);
+  ASSERT_EQ(out->lod(), x->lod());
+
+  x->mutable_data<float>(paddle::framework::make_ddim({5, 3}), place);
+  x->set_lod({});
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::infer_shape_num, 3);
+  ASSERT_EQ(out->dims(), paddle::framework::make_ddim({10, 3}));
+  FLAGS_cache_runtime_infer_shape = false;
+}
+
+TEST(InferShapeCache, disabled) {
+  paddle::framework::InitDevices(false, {});
+  paddle::framework::infer_shape_num = 0;
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("infer_shape_cache_test");
+  BuildVar("X", {"x"}, op_desc.add_inputs());
+  BuildVar("Out", {"out"}, op_desc.add_outputs());
+  auto attr = op_desc.mutable_attrs()->Add();
+  attr->set_name(paddle::framework::kEnableCacheRuntimeContext);
+  attr->set_type(paddle::framework::proto::AttrType::BOOLEAN);
+  attr->set_b(true);
+
+  paddle::platform::CPUPlace place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  scope.Var("out")->GetMutable<paddle::framework::LoDTensor>();
+  x->mutable_data<float>(paddle::framework::make_ddim({4, 3}), place);
+
+  // InferShape runs every time by default.
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  op->Run(scope, place);
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::infer_shape_num, 2);
+}
+
+namespace paddle {
+namespace framework {
+
+class ShapeTensorInferShapeTestMaker : public OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("X", "(LoDTensor) Input Variable.");
+    AddInput("ShapeTensor", "(Tensor<int32>) The shape of the output.");
+    AddOutput("Out", "(LoDTensor) Output Variable.");
+    AddComment("This Op is only for the InferShapeCache test.");
+  }
+};
+
+// The output shape is the value of ShapeTensor, which is read by the kernel.
+template <typename DeviceContext, typename T>
+class ShapeTensorTestKernel : public OpKernel<T> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    auto* shape = ctx.Input<Tensor>("ShapeTensor");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    out->Resize(make_ddim(std::vector<int>(
+        shape->data<int>(), shape->data<int>() + shape->numel())));
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    infer_shape_cache_shape_tensor_test, paddle::framework::InferShapeCacheTest,
+    paddle::framework::ShapeTensorInferShapeTestMaker);
+REGISTER_OP_CPU_KERNEL(infer_shape_cache_shape_tensor_test,
+                       paddle::framework::ShapeTensorTestKernel<
+                           paddle::platform::CPUDeviceContext, float>);
+
+TEST(InferShapeCache, shape_tensor) {
+  paddle::framework::InitDevices(false, {});
+  FLAGS_cache_runtime_infer_shape = true;
+  paddle::framework::infer_shape_num = 0;
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("infer_shape_cache_shape_tensor_test");
+  BuildVar("X", {"x"}, op_desc.add_inputs());
+  BuildVar("ShapeTensor", {"shape"}, op_desc.add_inputs());
+  BuildVar("Out", {"out"}, op_desc.add_outputs());
+  auto attr = op_desc.mutable_attrs()->Add();
+  attr->set_name(paddle::framework::kEnableCacheRuntimeContext);
+  attr->set_type(paddle::framework::proto::AttrType::BOOLEAN);
+  attr->set_b(true);
+
+  paddle::platform::CPUPlace place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  auto* shape = scope.Var("shape")->GetMutable<paddle::framework::LoDTensor>();
+  auto* out = scope.Var("out")->GetMutable<paddle::framework::LoDTensor>();
+  x->mutable_data<float>(paddle::framework::make_ddim({4, 3}), place);
+  auto* shape_data =
+      shape->mutable_data<int>(paddle::framework::make_ddim({2}), place);
+  shape_data[0] = 2;
+  shape_data[1] = 3;
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  op->Run(scope, place);
+  ASSERT_EQ(out->dims(), paddle::framework::make_ddim({2, 3}));
+
+  // The dims of all the inputs are the same, but InferShape runs again, since
+  // the integer input may decide the output shape by its value.
+  shape_data[0] = 5;
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::infer_shape_num, 2);
+  ASSERT_EQ(out->dims(), paddle::framework::make_ddim({5, 3}));
+  FLAGS_cache_runtime_infer_shape = false;
+}
+
+namespace paddle {
+namespace framework {
+
+static proto::VarType::Type chosen_kernel_type = proto::VarType::RAW;
+
+template <typename DeviceContext, typename T>
+class RecordTypeTestKernel : public OpKernel<T> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    chosen_kernel_type = DataTypeTrait<T>::DataType();
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    choose_kernel_test, paddle::framework::IndicateLoDTensorDataTypeTest,
+    paddle::framework::IndicateLoDTensorDataTypeTestProtoMaker);
+REGISTER_OP_CPU_KERNEL(choose_kernel_test,
+                       paddle::framework::RecordTypeTestKernel<
+                           paddle::platform::CPUDeviceContext, float>,
+                       paddle::framework::RecordTypeTestKernel<
+                           paddle::platform::CPUDeviceContext, double>);
+
+TEST(ChooseKernel, input_type_changed) {
+  paddle::framework::InitDevices(false, {});
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("choose_kernel_test");
+  BuildVar("LoDTensor", {"x"}, op_desc.add_inputs());
+
+  paddle::platform::CPUPlace place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+
+  x->mutable_data<float>(paddle::framework::make_ddim({2}), place);
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::chosen_kernel_type,
+            paddle::framework::proto::VarType::FP32);
+
+  // The kernel is chosen again once the data type of the input changes.
+  x->mutable_data<double>(place);
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::chosen_kernel_type,
+            paddle::framework::proto::VarType::FP64);
+
+  x->mutable_data<float>(place);
+  op->Run(scope, place);
+  ASSERT_EQ(paddle::framework::chosen_kernel_type,
+            paddle::framework::proto::VarType::FP32);
+}
+
+namespace paddle {
+namespace framework {
+
+class TransformPersistableVarTest : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override {}
+  OpKernelType GetExpectedKernelType(
+      const ExecutionContext& ctx) const override {
+    return OpKernelType(proto::VarType::FP64, ctx.GetPlace());
+  }
+};
+
+static const Tensor* transformed_input = nullptr;
+static double transformed_value = 0.;
+
+template <typename DeviceContext, typename T>
+class RecordInputTestKernel : public OpKernel<T> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    transformed_input = ctx.Input<Tensor>("X");
+    transformed_value = transformed_input->data<double>()[0];
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    transform_persistable_var_test,
+    paddle::framework::TransformPersistableVarTest,
+    paddle::framework::OpUnusedVarTestProtoAndCheckerMaker);
+REGISTER_OP_CPU_KERNEL(transform_persistable_var_test,
+                       paddle::framework::RecordInputTestKernel<
+                           paddle::platform::CPUDeviceContext, double>);
+
+TEST(TransformPersistableVar, all) {
+  paddle::framework::InitDevices(false, {});
+  FLAGS_cache_transformed_persistable_vars = true;
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("transform_persistable_var_test");
+  BuildVar("X", {"x"}, op_desc.add_inputs());
+  BuildVar("Y", {"y"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  x->mutable_data<float>(paddle::framework::make_ddim({2}), place)[0] = 1.0f;
+  auto& local_scope = scope.NewScope();
+  local_scope.Var("y")->GetMutable<paddle::framework::LoDTensor>();
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  op->Run(local_scope, place);
+  auto* first_input = paddle::framework::transformed_input;
+  ASSERT_NE(first_input, x);
+  ASSERT_EQ(first_input->type(), paddle::framework::proto::VarType::FP64);
+  ASSERT_EQ(first_input->data<double>()[0], 1.0);
+
+  // The transformed copy is reused if x is not modified.
+  op->Run(local_scope, place);
+  ASSERT_EQ(paddle::framework::transformed_input, first_input);
+
+  // x is transformed again once it is modified.
+  scope.FindVar("x")
+      ->GetMutable<paddle::framework::LoDTensor>()
+      ->data<float>()[0] = 2.0f;
+  op->Run(local_scope, place);
+  ASSERT_EQ(paddle::framework::transformed_input->data<double>()[0], 2.0);
+  FLAGS_cache_transformed_persistable_vars = false;
+}
+
+TEST(TransformPersistableVar, disabled) {
+  paddle::framework::InitDevices(false, {});
+  ASSERT_FALSE(FLAGS_cache_transformed_persistable_vars);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("transform_persistable_var_test");
+  BuildVar("X", {"x"}, op_desc.add_inputs());
+  BuildVar("Y", {"y"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  float* x_data =
+      x->mutable_data<float>(paddle::framework::make_ddim({2}), place);
+  x_data[0] = 1.0f;
+  auto& local_scope = scope.NewScope();
+  local_scope.Var("y")->GetMutable<paddle::framework::LoDTensor>();
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  op->Run(local_scope, place);
+  ASSERT_EQ(paddle::framework::transformed_value, 1.0);
+
+  // The in-place write through the pointer got before is seen.
+  x_data[0] = 2.0f;
+  op->Run(local_scope, place);
+  ASSERT_EQ(paddle::framework::transformed_value, 2.0);
+}
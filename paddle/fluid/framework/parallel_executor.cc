@@ -30,6 +30,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/memory_optimize_pass/memory_optimization_var_info.h"
 #include "paddle/fluid/framework/ir/memory_optimize_pass/reference_count_pass_helper.h"
+#include "paddle/fluid/framework/ir/multi_devices_graph_pass/multi_devices_graph_pass.h"
 #include "paddle/fluid/framework/ir/multi_devices_graph_pass/set_reader_device_info_utils.h"
 #include "paddle/fluid/platform/event.h"
 #include "paddle/fluid/platform/profiler.h"
@@ -373,8 +374,8 @@ ir::Graph *ParallelExecutorPrivate::ApplyMemoryOptimizePass(ir::Graph *graph) {
     } else {
 #endif
       if (platform::is_cpu_place(place)) {
-        gc.reset(new CPUGarbageCollector(
-            BOOST_GET_CONST(platform::CPUPlace, place), max_memory_size));
+        gc = CreateCPUGarbageCollector(
+            BOOST_GET_CONST(platform::CPUPlace, place), max_memory_size);
         VLOG(10) << "Created GarbageCollector at " << place;
       } else {
         PADDLE_THROW(platform::errors::PreconditionNotMet(
@@ -615,6 +616,11 @@ ParallelExecutor::ParallelExecutor(const std::vector<platform::Place> &places,
 
   graph = member_->ApplyMemoryOptimizePass(graph);
 
+  if (graph->Has(ir::kShardedVarDevices)) {
+    ReleaseShardedVars(
+        graph->Get<ir::ShardedVarDevices>(ir::kShardedVarDevices));
+  }
+
   async_graphs[0] = graph;
 
   // Step 3. Create vars in each scope. Passes may also create new vars.
@@ -737,6 +743,24 @@ ParallelExecutor::ParallelExecutor(const std::vector<platform::Place> &places,
   }
 }
 
+void ParallelExecutor::ReleaseShardedVars(
+    const std::unordered_map<std::string, size_t> &var_devices) const {
+  // The variables of the 0th device are held by the global scope, which are
+  // kept for saving and fetching.
+  size_t released_num = 0;
+  for (auto &pair : var_devices) {
+    for (size_t i = 1; i < member_->local_scopes_.size(); ++i) {
+      if (i == pair.second) continue;
+      auto *local_scope = member_->local_scopes_[i];
+      if (local_scope->FindLocalVar(pair.first) != nullptr) {
+        local_scope->EraseVars({pair.first});
+        ++released_num;
+      }
+    }
+  }
+  VLOG(3) << "Release " << released_num << " sharded variables in local scopes";
+}
+
 void ParallelExecutor::BCastParamsToDevices(
     const std::vector<std::string> &vars, int trainer_id) const {
   VLOG(3) << "BCastParamsToDevices";
@@ -830,6 +854,7 @@ FetchResultType ParallelExecutor::Run(
 #endif
 
   platform::RecordBlock b(0);
+  platform::RecordStep step;
 
   ResetHasFeedGuard reset_has_feed_guard(member_);
 
@@ -1008,7 +1033,7 @@ void ParallelExecutor::FeedAndSplitTensorIntoLocalScopes(
 
 ParallelExecutor::~ParallelExecutor() {
   for (auto &p : member_->places_) {
-    platform::DeviceContextPool::Instance().Get(p)->Wait();
+    platform::DeviceContextPool::Instance().WaitAllStreams(p);
   }
   delete member_;
 }
@@ -87,6 +87,10 @@ class ParallelExecutor {
   // trainer_id the trainer index in nccl distributed training.
   void BCastParamsToDevices(const std::vector<std::string> &vars,
                             int trainer_id = 0) const;
+  // erase the sharded variables from the local scopes of the devices which
+  // do not use them.
+  void ReleaseShardedVars(
+      const std::unordered_map<std::string, size_t> &var_devices) const;
   bool EnableParallelGraphExecution(const ir::Graph &graph,
                                     const ExecutionStrategy &exec_strategy,
                                     const BuildStrategy &build_strategy) const;
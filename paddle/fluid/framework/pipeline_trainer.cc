@@ -13,10 +13,16 @@
 // limitations under the License.
 
 #if defined(PADDLE_WITH_NCCL)
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/framework/trainer.h"
 #include "paddle/fluid/framework/trainer_desc.pb.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/string/printf.h"
 
 namespace paddle {
 namespace framework {
@@ -38,16 +44,84 @@ void PipelineTrainer::Initialize(const TrainerDesc& trainer_desc,
   sync_steps_ = pipeline_config_.sync_steps();
   section_num_ = pipeline_config_.section_config_size();
 
+  device_stride_ = 1;
+  for (int i = 0; i < section_num_; ++i) {
+    int place_id = pipeline_config_.section_config(i).place_id();
+    PADDLE_ENFORCE_GE(place_id, 0, platform::errors::InvalidArgument(
+                                       "The place_id of section %d should be "
+                                       "non-negative, but got %d.",
+                                       i, place_id));
+    device_stride_ = std::max(device_stride_, place_id + 1);
+  }
+  if (device_stride_ > 1 && pipeline_num_ > 1 && sync_steps_ != -1) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "Synchronizing parameters between %d pipelines is not supported when "
+        "the sections of a pipeline are placed on %d devices.",
+        pipeline_num_, device_stride_));
+  }
+
+  if (pipeline_config_.schedule_mode() == SectionWorkerParameter::OneFOneB) {
+    if (section_num_ < 3) {
+      LOG(WARNING) << "The 1F1B schedule is ignored since there is only "
+                   << section_num_ << " section.";
+    } else {
+      schedulers_.resize(pipeline_num_);
+      for (int j = 0; j < pipeline_num_; ++j) {
+        schedulers_[j].reset(new PipelineScheduler(
+            section_num_, pipeline_config_.num_microbatches()));
+      }
+      // At most stage_num micro-batches are in flight, and one more scope is
+      // used by the reader to prepare the next micro-batch. The scopes are
+      // reused with their activations, so more scopes only waste memory.
+      int stage_num = schedulers_[0]->StageNum();
+      if (scope_queue_size_ > stage_num + 1) {
+        scope_queue_size_ = stage_num + 1;
+      } else if (scope_queue_size_ < stage_num) {
+        LOG(WARNING) << "queue_size " << scope_queue_size_
+                     << " is less than the stage number " << stage_num
+                     << ", so that the stages cannot be fully overlapped.";
+      }
+    }
+  }
+
   VLOG(3) << "scope_queue_size: " << scope_queue_size_;
   VLOG(3) << "section num: " << section_num_;
   VLOG(3) << "sync_steps: " << sync_steps_;
+  VLOG(3) << "device stride: " << device_stride_;
 
   workers_.resize(section_num_);
   in_var_names_.resize(section_num_);
   out_var_names_.resize(section_num_);
   worker_count_.resize(section_num_);
   worker_count_mutex_.resize(section_num_);
-  param_need_sync_.reset(new std::vector<std::string>);
+  param_need_sync_.reset(
+      new std::vector<std::string>(pipeline_config_.param_need_sync().begin(),
+                                   pipeline_config_.param_need_sync().end()));
+  VLOG(3) << "param_need_sync_ have: ";
+  for (const std::string& name : *param_need_sync_) {
+    VLOG(3) << name;
+  }
+  std::set<std::string> param_set(param_need_sync_->begin(),
+                                  param_need_sync_->end());
+  for (int i = 0; i < section_num_; ++i) {
+    const auto& section_config = pipeline_config_.section_config(i);
+    if (section_config.place() != SectionConfig::CUDAPlace) {
+      continue;
+    }
+    for (const auto& var : section_config.program_desc().blocks(0).vars()) {
+      if (param_set.count(var.name()) == 0) {
+        continue;
+      }
+      auto iter =
+          param_place_ids_.emplace(var.name(), section_config.place_id()).first;
+      PADDLE_ENFORCE_EQ(iter->second, section_config.place_id(),
+                        platform::errors::InvalidArgument(
+                            "Parameter %s is used by sections on different "
+                            "devices %d and %d.",
+                            var.name(), iter->second,
+                            section_config.place_id()));
+    }
+  }
 
   int reader_index = 0;
   for (int i = 0; i < section_num_; ++i) {
@@ -79,7 +153,8 @@ void PipelineTrainer::Initialize(const TrainerDesc& trainer_desc,
           break;
         case SectionConfig::CUDAPlace:
           // Note that one section has at most one GPU place in one pipeline
-          place = platform::CUDAPlace(j);
+          place = platform::CUDAPlace(section_config.place_id() +
+                                      j * device_stride_);
           break;
         case SectionConfig::CUDAPinnedPlace:
           place = platform::CUDAPinnedPlace();
@@ -110,19 +185,15 @@ void PipelineTrainer::Initialize(const TrainerDesc& trainer_desc,
           this_worker->SetDumpFieldVector(dump_fields_);
           this_worker->SetDumpParamVector(dump_param_);
         }
+        if (!schedulers_.empty()) {
+          this_worker->SetPipelineScheduler(schedulers_[j].get());
+        }
         this_worker->SetPlace(place);
         this_worker->Initialize(trainer_desc);
         this_worker->InitRandomDumpConfig(trainer_desc);
       }
     }
   }
-  param_need_sync_.reset(
-      new std::vector<std::string>(pipeline_config_.param_need_sync().begin(),
-                                   pipeline_config_.param_need_sync().end()));
-  VLOG(3) << "param_need_sync_ have: ";
-  for (const std::string& name : *param_need_sync_) {
-    VLOG(3) << name;
-  }
   // set debug here
   SetDebug(trainer_desc.debug());
 }
@@ -173,7 +244,9 @@ void PipelineTrainer::InitFirstScopeQueue(ScopeQueue* scope_queue,
           LoDTensor* gpu_tensor = pipeline_scopes_[pipeline_id]
                                       ->Var(var->Name())
                                       ->GetMutable<LoDTensor>();
-          platform::Place place = platform::CUDAPlace(pipeline_id);
+          platform::Place place = platform::CUDAPlace(
+              pipeline_config_.section_config(0).place_id() +
+              pipeline_id * device_stride_);
           TensorCopy(*static_cast<const Tensor*>(&root_tensor), place,
                      static_cast<Tensor*>(gpu_tensor));
         }
@@ -191,7 +264,10 @@ void PipelineTrainer::CopyParameters(const Scope& root_scope, int pipeline_id) {
     // pipeline_scope
     LoDTensor* gpu_tensor =
         pipeline_scopes_[pipeline_id]->Var(name)->GetMutable<LoDTensor>();
-    platform::Place place = platform::CUDAPlace(pipeline_id);
+    auto iter = param_place_ids_.find(name);
+    int place_id = iter == param_place_ids_.end() ? 0 : iter->second;
+    platform::Place place =
+        platform::CUDAPlace(place_id + pipeline_id * device_stride_);
     TensorCopy(*static_cast<const Tensor*>(&root_tensor), place,
                static_cast<Tensor*>(gpu_tensor));
   }
@@ -302,10 +378,66 @@ void PipelineTrainer::Run() {
   }
 }
 
+static void CollectActivationMemory(const Scope& scope,
+                                    std::map<std::string, size_t>* sizes) {
+  for (const auto& name : scope.LocalVarNames()) {
+    auto* var = scope.FindLocalVar(name);
+    if (var == nullptr || !var->IsType<LoDTensor>()) {
+      continue;
+    }
+    const auto& tensor = var->Get<LoDTensor>();
+    if (tensor.IsInitialized()) {
+      std::ostringstream place;
+      place << tensor.place();
+      (*sizes)[place.str()] += tensor.memory_size();
+    }
+  }
+  for (auto* kid : scope.kids()) {
+    CollectActivationMemory(*kid, sizes);
+  }
+}
+
+void PipelineTrainer::ReportPipelineStats() {
+  for (int j = 0; j < pipeline_num_; ++j) {
+    if (!schedulers_.empty()) {
+      LOG(INFO) << "pipeline " << j << ": " << schedulers_[j]->Report();
+    }
+    // The micro-batch scopes are the kids of the pipeline scope, and keep the
+    // activations of the micro-batches they have run, so the memory they hold
+    // at the end is the peak activation memory.
+    std::map<std::string, size_t> sizes;
+    for (auto* kid : pipeline_scopes_[j]->kids()) {
+      CollectActivationMemory(*kid, &sizes);
+    }
+    for (auto& pair : sizes) {
+      LOG(INFO) << "pipeline " << j << ": peak activation memory on "
+                << pair.first << " is "
+                << string::HumanReadableSize(pair.second);
+    }
+    std::set<int> devices;
+    for (int i = 0; i < section_num_; ++i) {
+      const auto& section_config = pipeline_config_.section_config(i);
+      if (section_config.place() == SectionConfig::CUDAPlace) {
+        devices.insert(section_config.place_id() + j * device_stride_);
+      }
+    }
+    for (int dev_id : devices) {
+      memory::allocation::AllocatorStats stats;
+      if (memory::allocation::AllocatorFacade::Instance().GetStats(
+              platform::CUDAPlace(dev_id), &stats)) {
+        LOG(INFO) << "pipeline " << j << ": peak allocated memory on "
+                  << "CUDAPlace(" << dev_id << ") is "
+                  << string::HumanReadableSize(stats.peak_allocated_bytes);
+      }
+    }
+  }
+}
+
 void PipelineTrainer::Finalize() {
   for (auto& th : section_threads_) {
     th.join();
   }
+  ReportPipelineStats();
   if (need_dump_field_) {
     FinalizeDumpEnv();
   }
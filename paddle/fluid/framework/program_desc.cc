@@ -21,6 +21,7 @@ namespace paddle {
 namespace framework {
 
 BlockDesc *ProgramDesc::AppendBlock(const BlockDesc &parent) {
+  revision_ = NextDescRevision();
   auto *b = desc_.add_blocks();
   b->set_parent_idx(parent.ID());
   b->set_idx(desc_.blocks_size() - 1);
@@ -47,6 +48,7 @@ int64_t ProgramDesc::Version() const { return desc_.version().version(); }
 
 void ProgramDesc::SetVersion(const int64_t version) {
   desc_.mutable_version()->set_version(version);
+  revision_ = NextDescRevision();
 }
 
 ProgramDesc::ProgramDesc() {
@@ -93,6 +95,7 @@ ProgramDesc::ProgramDesc(const proto::ProgramDesc &desc) {
 }
 
 void ProgramDesc::CopyFrom(const proto::ProgramDesc &desc) {
+  revision_ = NextDescRevision();
   blocks_.clear();
   desc_ = desc;
   InitFromProto();
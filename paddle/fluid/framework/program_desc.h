@@ -63,6 +63,12 @@ class ProgramDesc {
 
   void SetVersion(const int64_t version);
 
+  // The latest revision of the blocks, ops and vars of the program, which is
+  // changed whenever any of them is created or modified, see
+  // NextDescRevision. The caches of the program, e.g. the prepared contexts
+  // of Executor, key on it rather than serializing the program.
+  uint64_t Revision() const { return revision_; }
+
   // The output variable of feed_op is referenced as feed_target.
   // This function is used to collect the output variable's name of all
   // feed_ops.
@@ -86,7 +92,14 @@ class ProgramDesc {
  private:
   void InitFromProto();
 
+  // Called by the blocks with the revisions of their own.
+  void SetRevision(uint64_t revision) { revision_ = revision; }
+
+  friend class BlockDesc;
+
   proto::ProgramDesc desc_;
+  // the latest revision of the program and its blocks, ops and vars
+  uint64_t revision_ = NextDescRevision();
 
   std::vector<std::unique_ptr<BlockDesc>> blocks_;
 };
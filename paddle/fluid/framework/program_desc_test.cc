@@ -174,5 +174,56 @@ TEST(ProgramDescBind, serialize_and_deserialize) {
               op_origin->Proto()->SerializeAsString());
   }
 }
+
+TEST(ProgramDesc, revision) {
+  ProgramDesc program;
+  auto* global_block = program.MutableBlock(0);
+  auto* x = global_block->Var("X");
+  auto* op = global_block->AppendOp();
+  op->SetType("mul");
+  op->SetInput("X", {"X"});
+
+  auto revision = program.Revision();
+  ASSERT_EQ(revision, program.Revision());
+
+  op->SetAttr("x_num_col_dims", 1);
+  ASSERT_GT(program.Revision(), revision);
+  revision = program.Revision();
+
+  x->SetPersistable(true);
+  ASSERT_GT(program.Revision(), revision);
+  revision = program.Revision();
+
+  x->SetLoDLevel(1);
+  ASSERT_GT(program.Revision(), revision);
+  revision = program.Revision();
+
+  auto* reader = global_block->Var("reader");
+  reader->SetType(proto::VarType::READER);
+  revision = program.Revision();
+  reader->SetLoDLevels({0, 1});
+  ASSERT_GT(program.Revision(), revision);
+  revision = program.Revision();
+
+  global_block->AppendOp();
+  ASSERT_GT(program.Revision(), revision);
+  revision = program.Revision();
+
+  global_block->RenameVar("X", "Y")->SetPersistable(false);
+  ASSERT_GT(program.Revision(), revision);
+  ASSERT_EQ(global_block->Revision(), program.Revision());
+  revision = program.Revision();
+
+  // the copies of the descs are not owned by the block
+  VarDesc var_copy(*global_block->Var("Y"));
+  var_copy.SetLoDLevel(2);
+  OpDesc op_copy(*op, global_block);
+  op_copy.SetAttr("x_num_col_dims", 2);
+  ASSERT_EQ(revision, program.Revision());
+
+  ProgramDesc copy(program);
+  ASSERT_NE(copy.Revision(), revision);
+  ASSERT_EQ(revision, program.Revision());
+}
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 namespace paddle {
 namespace framework {
 
@@ -22,5 +25,32 @@ constexpr int kRootBlockIndex = 0;
 // The Parent Index of root Block, this block does not exist.
 constexpr int kNoneBlockIndex = -1;
 
+// The revisions of the program, block, op and var descs are taken from one
+// counter whenever they are created or modified, so that a desc which is
+// modified, or created at the address of a deleted one, never has the
+// revision it had before.
+inline uint64_t NextDescRevision() {
+  static std::atomic<uint64_t> revision{0};
+  return ++revision;
+}
+
+class BlockDesc;
+
+// The block owning an op or var desc, which takes the revisions of the desc
+// so that the revision of the program is kept without walking it. A copy of
+// the desc is not owned by the block, so the owner is not copied.
+class DescOwner {
+ public:
+  DescOwner() = default;
+  DescOwner(const DescOwner &) {}
+  DescOwner &operator=(const DescOwner &) { return *this; }
+
+  BlockDesc *get() const { return block_; }
+  void set(BlockDesc *block) { block_ = block; }
+
+ private:
+  BlockDesc *block_{nullptr};  // not_own
+};
+
 }  // namespace framework
 }  // namespace paddle
@@ -23,6 +23,7 @@
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/platform/place.h"
+#include "paddle/fluid/platform/step_phase.h"
 
 namespace paddle {
 namespace framework {
@@ -171,6 +172,8 @@ class ReaderHolder {
         reader_,
         platform::errors::InvalidArgument(
             "The underlying reader of ReaderHolder should not be null"));
+    platform::RecordStepPhase phase(platform::StepPhase::kDataWait,
+                                    "ReaderHolder::ReadNext");
     reader_->ReadNext(out);
   }
 
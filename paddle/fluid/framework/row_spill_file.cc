@@ -0,0 +1,137 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/row_spill_file.h"
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+static void SeekSlot(FILE* fp, size_t slot, size_t row_bytes,
+                     const std::string& path) {
+#ifdef _WIN32
+  int ret = _fseeki64(fp, static_cast<__int64>(slot * row_bytes), SEEK_SET);
+#else
+  int ret = fseeko(fp, static_cast<off_t>(slot * row_bytes), SEEK_SET);
+#endif
+  PADDLE_ENFORCE_EQ(ret, 0, platform::errors::Unavailable(
+                                "Failed to seek the spill file %s.", path));
+}
+
+RowSpillFile::RowSpillFile(const std::string& path, size_t row_bytes)
+    : path_(path), row_bytes_(row_bytes) {
+  PADDLE_ENFORCE_GT(row_bytes_, 0,
+                    platform::errors::InvalidArgument(
+                        "The row size of the spill file must be larger than "
+                        "0, but received %d.",
+                        row_bytes_));
+  fp_ = fopen(path_.c_str(), "w+b");
+  PADDLE_ENFORCE_NOT_NULL(
+      fp_, platform::errors::Unavailable("Failed to create the spill file %s.",
+                                         path_));
+}
+
+RowSpillFile::~RowSpillFile() {
+  fclose(fp_);
+  remove(path_.c_str());
+}
+
+size_t RowSpillFile::Size() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return key_to_slot_.size();
+}
+
+bool RowSpillFile::Contains(int64_t key) const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return key_to_slot_.count(key) != 0;
+}
+
+void RowSpillFile::Write(int64_t key, const void* data) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  PADDLE_ENFORCE_EQ(key_to_slot_.count(key), 0,
+                    platform::errors::AlreadyExists(
+                        "The row %d is already in the spill file %s.", key,
+                        path_));
+  size_t slot = slot_num_;
+  if (free_slots_.empty()) {
+    ++slot_num_;
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  SeekSlot(fp_, slot, row_bytes_, path_);
+  size_t written = fwrite(data, 1, row_bytes_, fp_);
+  PADDLE_ENFORCE_EQ(written, row_bytes_,
+                    platform::errors::Unavailable(
+                        "Failed to write the spill file %s, the disk may be "
+                        "full.",
+                        path_));
+  key_to_slot_.emplace(key, slot);
+}
+
+bool RowSpillFile::Take(int64_t key, void* data) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = key_to_slot_.find(key);
+  if (it == key_to_slot_.end()) return false;
+  SeekSlot(fp_, it->second, row_bytes_, path_);
+  size_t read = fread(data, 1, row_bytes_, fp_);
+  PADDLE_ENFORCE_EQ(read, row_bytes_,
+                    platform::errors::Unavailable(
+                        "Failed to read the row %d from the spill file %s.",
+                        key, path_));
+  free_slots_.push_back(it->second);
+  key_to_slot_.erase(it);
+  return true;
+}
+
+std::vector<std::pair<size_t, int64_t>> RowSpillFile::SortedSlots() const {
+  std::vector<std::pair<size_t, int64_t>> slots;
+  slots.reserve(key_to_slot_.size());
+  for (auto& pair : key_to_slot_) {
+    slots.emplace_back(pair.second, pair.first);
+  }
+  std::sort(slots.begin(), slots.end());
+  return slots;
+}
+
+std::vector<int64_t> RowSpillFile::Keys() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  std::vector<int64_t> keys;
+  for (auto& slot : SortedSlots()) {
+    keys.push_back(slot.second);
+  }
+  return keys;
+}
+
+void RowSpillFile::ForEach(
+    const std::function<void(int64_t, const void*)>& fn) const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto slots = SortedSlots();
+  std::unique_ptr<char[]> buffer(new char[row_bytes_]);
+  for (auto& slot : slots) {
+    SeekSlot(fp_, slot.first, row_bytes_, path_);
+    size_t read = fread(buffer.get(), 1, row_bytes_, fp_);
+    PADDLE_ENFORCE_EQ(read, row_bytes_,
+                      platform::errors::Unavailable(
+                          "Failed to read the row %d from the spill file %s.",
+                          slot.second, path_));
+    fn(slot.second, buffer.get());
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
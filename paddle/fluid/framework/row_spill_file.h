@@ -0,0 +1,81 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdio.h>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// RowSpillFile is the cold tier of a sparse table. It keeps the rows evicted
+// from memory in a file on local disk, usually on an SSD.
+//
+// All rows have the same size, so the file is an array of fixed-size slots.
+// The slot of a row taken back into memory is reused by the next written row,
+// and the file never grows beyond the largest number of rows spilled at once.
+//
+// All methods are thread-safe. The file is removed when the object is
+// destroyed.
+class RowSpillFile {
+ public:
+  RowSpillFile(const std::string& path, size_t row_bytes);
+
+  ~RowSpillFile();
+
+  const std::string& path() const { return path_; }
+
+  size_t row_bytes() const { return row_bytes_; }
+
+  // The number of rows in the file.
+  size_t Size() const;
+
+  bool Contains(int64_t key) const;
+
+  // Write the row of `key`, which must not be in the file yet.
+  void Write(int64_t key, const void* data);
+
+  // Read the row of `key` into `data`, and remove it from the file.
+  // Return false if the key is not in the file.
+  bool Take(int64_t key, void* data);
+
+  // The keys of the rows in the file, in the order of the slots.
+  std::vector<int64_t> Keys() const;
+
+  // Call fn(key, data) on every row of the file, in the order of the slots.
+  void ForEach(const std::function<void(int64_t, const void*)>& fn) const;
+
+ private:
+  // The (slot, key) pairs sorted by the slot, mtx_ must be held.
+  std::vector<std::pair<size_t, int64_t>> SortedSlots() const;
+
+  std::string path_;
+  size_t row_bytes_;
+  FILE* fp_{nullptr};
+
+  std::unordered_map<int64_t, size_t> key_to_slot_;
+  std::vector<size_t> free_slots_;
+  size_t slot_num_{0};
+
+  mutable std::mutex mtx_;
+};
+
+}  // namespace framework
+}  // namespace paddle
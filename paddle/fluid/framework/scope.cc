@@ -104,6 +104,15 @@ void Scope::DropKids() {
   kids_.clear();
 }
 
+std::vector<std::unique_ptr<Scope>> Scope::DetachKids() {
+  SCOPE_KIDS_WRITER_LOCK
+  std::vector<std::unique_ptr<Scope>> kids;
+  kids.reserve(kids_.size());
+  for (Scope* s : kids_) kids.emplace_back(s);
+  kids_.clear();
+  return kids;
+}
+
 bool Scope::HasKid(const Scope* scope) const {
   SCOPE_KIDS_READER_LOCK
   auto it = std::find(this->kids_.begin(), this->kids_.end(), scope);
@@ -143,6 +152,7 @@ void Scope::EraseVars(const std::vector<std::string>& var_names) {
   for (auto it = vars_.begin(); it != vars_.end();) {
     if (var_set.find(it->first) != var_set.end()) {
       it = vars_.erase(it);
+      ++version_;
     } else {
       ++it;
     }
@@ -167,6 +177,7 @@ Variable* Scope::VarInternal(const std::string& name) {
   if (v != nullptr) return v;
   v = new Variable();
   vars_.emplace(name, std::unique_ptr<Variable>(v));
+  ++version_;
   VLOG(3) << "Create variable " << name;
   return v;
 }
@@ -202,6 +213,7 @@ void Scope::RenameInternal(const std::string& origin_name,
           "The variable with name %s already exists in the scope.", new_name));
   vars_[new_name].reset(origin_it->second.release());
   vars_.erase(origin_it);
+  ++version_;
 }
 
 Variable* Scope::FindVarInternal(const std::string& name) const {
@@ -227,6 +239,22 @@ void Scope::EraseVarsExcept(const std::unordered_set<Variable*>& vars) {
       ++iter;
     } else {
       vars_.erase(iter++);
+      ++version_;
+    }
+  }
+}
+
+void Scope::EraseVarsExcept(
+    const std::unordered_set<Variable*>& vars,
+    std::vector<std::unique_ptr<Variable>>* erased_vars) {
+  SCOPE_VARS_WRITER_LOCK
+  for (auto iter = vars_.begin(); iter != vars_.end();) {
+    if (vars.count(iter->second.get()) != 0) {
+      ++iter;
+    } else {
+      erased_vars->emplace_back(std::move(iter->second));
+      vars_.erase(iter++);
+      ++version_;
     }
   }
 }
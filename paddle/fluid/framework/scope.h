@@ -18,6 +18,8 @@ extern "C" {
 #include <xxhash.h>
 }
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
@@ -70,6 +72,12 @@ class Scope {
   // Erase all variables except the given `vars`
   void EraseVarsExcept(const std::unordered_set<Variable*>& vars);
 
+  // Erase all variables except the given `vars`, and move the erased ones to
+  // `erased_vars` instead of destroying them, so that they can be destroyed
+  // by the caller later, e.g., on another thread.
+  void EraseVarsExcept(const std::unordered_set<Variable*>& vars,
+                       std::vector<std::unique_ptr<Variable>>* erased_vars);
+
   /// Find a variable in the scope or any of its ancestors.  Returns
   /// nullptr if cannot find.
   /// Caller doesn't own the returned Variable.
@@ -93,6 +101,10 @@ class Scope {
   /// Drop all kids scopes belonged to this scope.
   void DropKids();
 
+  /// Remove all kids scopes from this scope without destroying them, and
+  /// transfer their ownership to the caller.
+  std::vector<std::unique_ptr<Scope>> DetachKids();
+
   /// Find if a scope exists in the kid scopes
   bool HasKid(const Scope* scope) const;
 
@@ -108,6 +120,11 @@ class Scope {
   // Rename variable to a new name and return the new name
   std::string Rename(const std::string& origin_name) const;
 
+  // The version is increased whenever a variable is created, erased or
+  // renamed in the current scope, so that the variables found before can be
+  // checked whether they are still valid.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
  protected:
   struct KeyHasher {
     std::size_t operator()(const std::string& key) const {
@@ -144,6 +161,7 @@ class Scope {
   // Scope in `kids_` are owned by this class.
   mutable std::list<Scope*> kids_;
   const Scope* parent_{nullptr};
+  mutable std::atomic<uint64_t> version_{0};
 
   DISABLE_COPY_AND_ASSIGN(Scope);
 
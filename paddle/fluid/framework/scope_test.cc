@@ -71,3 +71,22 @@ TEST(Scope, GetAllNames) {
 
   EXPECT_STREQ("a", str.c_str());
 }
+
+TEST(Scope, Version) {
+  Scope s;
+  auto version = s.version();
+  s.Var("a");
+  EXPECT_GT(s.version(), version);
+
+  // Finding or getting an existing variable does not change the version.
+  version = s.version();
+  s.Var("a");
+  s.FindVar("a");
+  EXPECT_EQ(s.version(), version);
+
+  s.Rename("a", "b");
+  EXPECT_GT(s.version(), version);
+  version = s.version();
+  s.EraseVars({"b"});
+  EXPECT_GT(s.version(), version);
+}
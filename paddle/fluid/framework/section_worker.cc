@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
+#include "paddle/fluid/string/printf.h"
 
 namespace paddle {
 namespace framework {
@@ -94,6 +95,79 @@ void SyncFunctor::Synchronize() {
   nccl_ctx_map_->WaitAll();
 }
 
+PipelineScheduler::PipelineScheduler(int section_num, int num_microbatches)
+    : section_num_(section_num),
+      stage_num_((section_num + 1) / 2),
+      num_microbatches_(num_microbatches) {
+  PADDLE_ENFORCE_EQ(section_num % 2, 1,
+                    platform::errors::InvalidArgument(
+                        "The 1F1B schedule needs an odd number of sections, "
+                        "i.e., 2n-1 sections for n stages, but got %d.",
+                        section_num));
+  PADDLE_ENFORCE_GT(num_microbatches, 0,
+                    platform::errors::InvalidArgument(
+                        "num_microbatches should be larger than 0, but got %d.",
+                        num_microbatches));
+  in_flight_.resize(stage_num_, 0);
+  running_sections_.resize(stage_num_, 0);
+  busy_time_.resize(stage_num_ + 1, 0.0);
+}
+
+void PipelineScheduler::Accumulate() {
+  auto now = std::chrono::steady_clock::now();
+  if (started_) {
+    busy_time_[busy_stages_] +=
+        std::chrono::duration<double>(now - last_event_).count();
+  }
+  started_ = true;
+  last_event_ = now;
+}
+
+void PipelineScheduler::BeforeRun(int section_id) {
+  int stage = StageOf(section_id);
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (IsForward(section_id)) {
+    int max_in_flight = stage_num_ - stage;
+    cv_.wait(lock, [&] {
+      if (in_flight_[stage] >= max_in_flight) return false;
+      // Flush the pipeline at the boundary of mini-batches.
+      return stage != 0 || microbatch_id_ % num_microbatches_ != 0 ||
+             in_flight_[0] == 0;
+    });
+    ++in_flight_[stage];
+    if (stage == 0) ++microbatch_id_;
+  }
+  Accumulate();
+  if (running_sections_[stage]++ == 0) ++busy_stages_;
+}
+
+void PipelineScheduler::AfterRun(int section_id) {
+  int stage = StageOf(section_id);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Accumulate();
+    if (--running_sections_[stage] == 0) --busy_stages_;
+    if (IsBackward(section_id)) --in_flight_[stage];
+  }
+  if (IsBackward(section_id)) cv_.notify_all();
+}
+
+std::string PipelineScheduler::Report() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  double total_time = 0, stage_time = 0;
+  for (size_t i = 0; i < busy_time_.size(); ++i) {
+    total_time += busy_time_[i];
+    stage_time += busy_time_[i] * i;
+  }
+  if (total_time <= 0) return "no micro-batch has run";
+  return string::Sprintf(
+      "%d stages, %d micro-batches, steady-state overlap (all stages busy) "
+      "%.2f%%, average busy stages %.2f, bubble %.2f%%",
+      stage_num_, microbatch_id_, busy_time_[stage_num_] / total_time * 100,
+      stage_time / total_time,
+      (1 - stage_time / total_time / stage_num_) * 100);
+}
+
 std::atomic<int> SectionWorker::cpu_id_(0);
 void SectionWorker::Initialize(const TrainerDesc& desc) {
   dev_ctx_ = platform::DeviceContextPool::Instance().Get(place_);
@@ -103,6 +177,13 @@ void SectionWorker::Initialize(const TrainerDesc& desc) {
   for (auto& op_desc : program->Block(0).AllOps()) {
     ops_.push_back(OpRegistry::CreateOp(*op_desc));
   }
+  fetch_config_ = desc.fetch_config();
+}
+
+bool SectionWorker::ReceiveScope(Scope** scope) {
+  platform::RecordStepPhase phase(platform::StepPhase::kDataWait,
+                                  "SectionWorker::ReceiveScope");
+  return in_scope_queue_->Receive(scope);
 }
 
 void SectionWorker::AutoSetCPUAffinity(bool reuse) {
@@ -150,10 +231,10 @@ void SectionWorker::TrainFiles() {
   if (device_reader_ != nullptr) {
     device_reader_->Start();
   }
-  while (in_scope_queue_->Receive(&scope)) {
+  while (ReceiveScope(&scope)) {
     if (device_reader_ != nullptr) {
       device_reader_->AssignFeedVar(*scope);
-      batch_size = device_reader_->Next();
+      batch_size = ReadNextBatch();
       if (batch_size <= 0) {
         break;
       }
@@ -171,6 +252,10 @@ void SectionWorker::TrainFiles() {
       SEC_LOG << "input batch size: " << batch_size;
     }
 
+    if (scheduler_ != nullptr) {
+      scheduler_->BeforeRun(section_id_);
+    }
+
     Scope* exe_scope = scope;
     if (section_id_ > 0 && platform::is_gpu_place(place_)) {
       SEC_LOG << "CPU2GPU memory copy";
@@ -185,7 +270,7 @@ void SectionWorker::TrainFiles() {
 
       for (const std::string& name : *in_var_names_) {
         const LoDTensor& src_tensor = scope->FindVar(name)->Get<LoDTensor>();
-        if (platform::is_gpu_place(src_tensor.place())) {
+        if (platform::is_same_place(src_tensor.place(), place_)) {
           continue;
         }
         LoDTensor* gpu_tensor = exe_scope->Var(name)->GetMutable<LoDTensor>();
@@ -197,14 +282,21 @@ void SectionWorker::TrainFiles() {
 
     SEC_LOG << "begin running ops";
 
-    for (auto& op : ops_) {
-      op->Run(*exe_scope, place_);
+    {
+      platform::RecordStepPhase compute(platform::StepPhase::kCompute,
+                                        "SectionWorker");
+      for (auto& op : ops_) {
+        op->Run(*exe_scope, place_);
+      }
+      exe_scope->DropKids();
+      // Wait for GPU calc finising, as the cudaMemcpy and GPU calc may be in
+      // different streams
+      // No effect when it is a CPUDeviceContext
+      dev_ctx_->Wait();
+    }
+    if (scheduler_ != nullptr) {
+      scheduler_->AfterRun(section_id_);
     }
-    exe_scope->DropKids();
-    // Wait for GPU calc finising, as the cudaMemcpy and GPU calc may be in
-    // different streams
-    // No effect when it is a CPUDeviceContext
-    dev_ctx_->Wait();
 
 #ifdef PADDLE_WITH_BOX_PS
     auto box_ptr = BoxWrapper::GetInstance();
@@ -248,6 +340,9 @@ void SectionWorker::TrainFiles() {
 
     ++step_cnt;
     accum_num += batch_size;
+    if (pipeline_id_ == 0 && thread_id_ == 0) {
+      PrintStepPhases(step_cnt);
+    }
   }
 
   worker_count_mutex_->lock();
@@ -293,7 +388,7 @@ void SectionWorker::TrainFilesWithProfiler() {
   }
 
   bool started = false;
-  while (in_scope_queue_->Receive(&scope)) {
+  while (ReceiveScope(&scope)) {
     if (UNLIKELY(!started)) {
       outer_timer.Start();
       started = true;
@@ -303,7 +398,7 @@ void SectionWorker::TrainFilesWithProfiler() {
     if (device_reader_ != nullptr) {
       reader_timer.Resume();
       device_reader_->AssignFeedVar(*scope);
-      batch_size = device_reader_->Next();
+      batch_size = ReadNextBatch();
       reader_timer.Pause();
       if (batch_size <= 0) {
         break;
@@ -320,6 +415,10 @@ void SectionWorker::TrainFilesWithProfiler() {
       SEC_LOG << "input batch size: " << batch_size;
     }
 
+    if (scheduler_ != nullptr) {
+      scheduler_->BeforeRun(section_id_);
+    }
+
     Scope* exe_scope = scope;
     if (section_id_ > 0 && platform::is_gpu_place(place_)) {
       SEC_LOG << "CPU2GPU memory copy";
@@ -334,7 +433,7 @@ void SectionWorker::TrainFilesWithProfiler() {
 
       for (const std::string& name : *in_var_names_) {
         const LoDTensor& src_tensor = scope->FindVar(name)->Get<LoDTensor>();
-        if (platform::is_gpu_place(src_tensor.place())) {
+        if (platform::is_same_place(src_tensor.place(), place_)) {
           continue;
         }
         LoDTensor* gpu_tensor = exe_scope->Var(name)->GetMutable<LoDTensor>();
@@ -362,6 +461,9 @@ void SectionWorker::TrainFilesWithProfiler() {
     // No effect when it is a CPUDeviceContext
     dev_ctx_->Wait();
     cal_timer.Pause();
+    if (scheduler_ != nullptr) {
+      scheduler_->AfterRun(section_id_);
+    }
 #ifdef PADDLE_WITH_BOX_PS
     auto box_ptr = BoxWrapper::GetInstance();
     auto& metric_list = box_ptr->GetMetricList();
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/selected_rows.h"
+#include <cstring>
+#include <string>
 
 namespace paddle {
 namespace framework {
@@ -38,53 +40,70 @@ struct ReAllocateVisitor {
   framework::Tensor* tensor_;
 };
 
-struct TensorCopyVisitor {
-  TensorCopyVisitor(framework::Tensor* dst, int64_t dst_offset,
-                    const framework::Tensor src, int64_t src_offset,
-                    int64_t size)
-      : dst_(dst),
-        dst_offset_(dst_offset),
-        src_(src),
-        src_offset_(src_offset),
-        size_(size) {}
-
-  template <typename T>
-  void apply() const {
-    // TODO(Yancey1989): support other place
-    platform::CPUPlace cpu;
-    memory::Copy(cpu, dst_->mutable_data<T>(cpu) + dst_offset_, cpu,
-                 src_.data<T>() + src_offset_, size_ * sizeof(T));
+// A table with spilled rows is written as if all of its rows were in the
+// value tensor: the rows in the value tensor are followed by the rows in the
+// spill file.
+static void SerializeSpilledToStream(std::ostream& os,
+                                     const SelectedRows& selected_rows) {
+  auto& rows = selected_rows.rows();
+  auto& value = selected_rows.value();
+  auto* spill = selected_rows.spill_file();
+  auto spilled_rows = spill->Keys();
+  uint64_t size = rows.size() + spilled_rows.size();
+  {  // the 1st field, uint32_t version
+    constexpr uint32_t version = 0;
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
   }
-
-  framework::Tensor* dst_;
-  int64_t dst_offset_;
-  framework::Tensor src_;
-  int64_t src_offset_;
-  int64_t size_;
-};
-
-struct TensorFillVisitor {
-  TensorFillVisitor(framework::Tensor* dst, int64_t dst_offset, int64_t size,
-                    float value)
-      : dst_(dst), dst_offset_(dst_offset), size_(size) {}
-
-  template <typename T>
-  void apply() const {
-    // TODO(qiao): support other place
-    platform::CPUPlace cpu;
-    auto* tensor_data = dst_->mutable_data<T>(cpu);
-    auto* start = tensor_data + dst_offset_;
-    auto* end = start + size_;
-    std::fill(start, end, static_cast<T>(0.0));
+  {  // the 2st field, rows information
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (uint64_t i = 0; i < rows.size(); ++i) {
+      os.write(reinterpret_cast<const char*>(&rows[i]), sizeof(rows[i]));
+    }
+    os.write(reinterpret_cast<const char*>(spilled_rows.data()),
+             spilled_rows.size() * sizeof(int64_t));
   }
-
-  framework::Tensor* dst_;
-  int64_t dst_offset_;
-  int64_t size_;
-};
+  {  // the 3st field, the height of SelectedRows
+    int64_t height = selected_rows.height();
+    os.write(reinterpret_cast<const char*>(&height), sizeof(height));
+  }
+  // the 4st field, Tensor data, in the format of TensorToStream
+  {
+    constexpr uint32_t version = 0;
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  {
+    proto::VarType::TensorDesc desc;
+    desc.set_data_type(value.type());
+    auto dims = framework::vectorize(value.dims());
+    dims[0] = static_cast<int64_t>(size);
+    auto* pb_dims = desc.mutable_dims();
+    pb_dims->Resize(static_cast<int>(dims.size()), 0);
+    std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    int32_t desc_size = desc.ByteSize();
+    os.write(reinterpret_cast<const char*>(&desc_size), sizeof(desc_size));
+    auto out = desc.SerializeAsString();
+    os.write(out.data(), desc_size);
+  }
+  os.write(static_cast<const char*>(value.data<void>()),
+           rows.size() * spill->row_bytes());
+  size_t written = 0;
+  spill->ForEach([&](int64_t key, const void* data) {
+    os.write(static_cast<const char*>(data), spill->row_bytes());
+    ++written;
+  });
+  PADDLE_ENFORCE_EQ(written, spilled_rows.size(),
+                    platform::errors::PreconditionNotMet(
+                        "The spill file %s is changed while being saved.",
+                        spill->path()));
+}
 
 void SerializeToStream(std::ostream& os, const SelectedRows& selected_rows,
                        const platform::DeviceContext& dev_ctx) {
+  auto* spill = selected_rows.spill_file();
+  if (spill != nullptr && spill->Size() > 0) {
+    SerializeSpilledToStream(os, selected_rows);
+    return;
+  }
   {  // the 1st field, uint32_t version
     constexpr uint32_t version = 0;
     os.write(reinterpret_cast<const char*>(&version), sizeof(version));
@@ -136,67 +155,205 @@ void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
 }
 
 bool SelectedRows::HasKey(int64_t key) const {
+  if (spill_ != nullptr && spill_->Contains(key)) {
+    return true;
+  }
   return std::find(rows_.begin(), rows_.end(), key) == rows_.end() ? false
                                                                    : true;
 }
 
 int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown,
                                      bool is_test) {
+  int64_t index = id_to_index_.Find(key);
   if (is_test) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
+    if (index < 0 && spill_ != nullptr && spill_->Contains(key)) {
+      return AutoGrownIndex(key, false, false);
     }
+    return index;
   }
+  if (index >= 0) {
+    TouchRow(index);
+    return index;
+  }
+
+  AutoWRLock lock(rwlock_.get());
+  if (!auto_grown && !(spill_ != nullptr && spill_->Contains(key))) {
+    PADDLE_THROW("key %d not found", key);
+  }
+  auto map_size = id_to_index_.Size();
+  auto vector_size = rows_.size();
+  PADDLE_ENFORCE_EQ(
+      map_size, vector_size,
+      "id_to_index_ size %d should have the same size with rows_ %d",
+      map_size, vector_size);
+  // another thread may have inserted the key
+  index = id_to_index_.Find(key);
+  if (index >= 0) {
+    TouchRow(index);
+    return index;
+  }
+  index = InsertRow(key);
+  if (index < 0) {
+    PADDLE_THROW("selected rows is full, then length exceed %d", vector_size);
+  }
+  return index;
+}
 
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
+void SelectedRows::GrowIndex(const int64_t* keys, int64_t num,
+                             bool auto_grown, int64_t* indices) {
+  AutoWRLock lock(rwlock_.get());
+  auto map_size = id_to_index_.Size();
+  auto vector_size = rows_.size();
+  PADDLE_ENFORCE_EQ(
+      map_size, vector_size,
+      "id_to_index_ size %d should have the same size with rows_ %d",
+      map_size, vector_size);
+  for (int64_t i = 0; i < num; ++i) {
+    if (indices[i] >= 0) continue;
+    // the key may be inserted by another thread or an earlier duplicate
+    indices[i] = id_to_index_.Find(keys[i]);
+    if (indices[i] >= 0) continue;
     if (!auto_grown) {
-      PADDLE_THROW("key %d not found", key);
+      PADDLE_THROW("key %d not found", keys[i]);
     }
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(
-          "id_to_index_ size %d should have the same size with rows_ %d",
-          map_size, vector_size);
+    indices[i] = InsertRow(keys[i]);
+    if (indices[i] < 0) {
+      PADDLE_THROW("selected rows is full, then length exceed %d",
+                   rows_.size());
     }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
+  }
+}
+
+int64_t SelectedRows::InsertRow(int64_t key) {
+  int64_t row_num = rows_.size();
+  bool full = row_num == value_->dims()[0];
+  if (full && spill_ == nullptr) {
+    return -1;
+  }
+  int64_t index = row_num;
+  if (full) {
+    index = EvictRow();
+    rows_[index] = key;
+  } else {
+    rows_.push_back(key);
+  }
+  id_to_index_.Insert(key, index);
+  MarkUpdated(&key, 1);
+  if (spill_ != nullptr) {
+    // A new row in an unused place keeps the value of the initialization,
+    // as it does without spilling.
+    if (!spill_->Take(key, RowData(index)) && full) {
+      if (spill_initializer_ != nullptr) {
+        spill_initializer_(value_.get(), index);
+      } else {
+        std::memset(RowData(index), 0, spill_->row_bytes());
       }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
-    } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
-      return index;
     }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
+    TouchRow(index);
+  }
+  return index;
+}
+
+int64_t SelectedRows::EvictRow() {
+  int64_t capacity = value_->dims()[0];
+  while (true) {
+    int64_t index = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % capacity;
+    // give the rows used since the last sweep a second chance
+    if (referenced_[index].exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    int64_t key = rows_[index];
+    spill_->Write(key, RowData(index));
+    id_to_index_.Erase(key);
+    VLOG(5) << "evict row " << key << " from index " << index
+            << " to the spill file " << spill_->path();
     return index;
   }
 }
 
+void SelectedRows::EnableSpill(const std::string& path,
+                               RowInitializer initializer) {
+  AutoWRLock lock(rwlock_.get());
+  if (spill_ != nullptr) return;
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(value_->place()), true,
+                    platform::errors::Unimplemented(
+                        "Only the sparse table on CPU can be spilled."));
+  int64_t capacity = value_->dims()[0];
+  PADDLE_ENFORCE_GT(capacity, 0,
+                    platform::errors::InvalidArgument(
+                        "The sparse table to be spilled is empty."));
+  size_t row_bytes =
+      value_->numel() / capacity * SizeOfType(value_->type());
+  spill_ = std::make_shared<RowSpillFile>(path, row_bytes);
+  spill_initializer_ = initializer;
+  referenced_.reset(new std::atomic<bool>[capacity]);
+  for (int64_t i = 0; i < capacity; ++i) {
+    referenced_[i].store(false, std::memory_order_relaxed);
+  }
+  clock_hand_ = 0;
+  VLOG(1) << "spill the sparse table of " << capacity << " rows to " << path;
+}
+
+bool SelectedRows::IsSpillEnabled() const {
+  AutoRDLock lock(rwlock_.get());
+  return spill_ != nullptr;
+}
+
+void SelectedRows::Prefetch(const int64_t* ids, int64_t num,
+                            bool auto_grown) {
+  std::vector<int64_t> missed;
+  {
+    AutoRDLock lock(rwlock_.get());
+    if (spill_ == nullptr) return;
+    for (int64_t i = 0; i < num; ++i) {
+      if (id_to_index_.Find(ids[i]) < 0) {
+        missed.push_back(ids[i]);
+      }
+    }
+  }
+  if (missed.empty()) return;
+  std::sort(missed.begin(), missed.end());
+  missed.erase(std::unique(missed.begin(), missed.end()), missed.end());
+
+  AutoWRLock lock(rwlock_.get());
+  for (auto key : missed) {
+    if (id_to_index_.Find(key) >= 0) continue;
+    if (!auto_grown && !spill_->Contains(key)) continue;
+    InsertRow(key);
+  }
+}
+
+void SelectedRows::EnableUpdateTracking() {
+  AutoWRLock lock(rwlock_.get());
+  if (updated_ == nullptr) {
+    updated_.reset(new UpdatedRows);
+  }
+}
+
+void SelectedRows::MarkUpdated(const int64_t* keys, size_t num) {
+  if (updated_ == nullptr) return;
+  std::lock_guard<std::mutex> guard(updated_->mutex);
+  updated_->keys.insert(keys, keys + num);
+}
+
+std::vector<int64_t> SelectedRows::TakeUpdatedRows() {
+  std::vector<int64_t> keys;
+  if (updated_ == nullptr) return keys;
+  {
+    std::lock_guard<std::mutex> guard(updated_->mutex);
+    keys.assign(updated_->keys.begin(), updated_->keys.end());
+    updated_->keys.clear();
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
 void SelectedRows::SyncIndex() {
   rwlock_->WRLock();
-  id_to_index_.clear();
+  id_to_index_.Clear();
   for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+    id_to_index_.Insert(rows_[i], i);
   }
   rwlock_->UNLock();
 }
@@ -207,25 +364,48 @@ void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
                  "The value tensor should be initialized.");
   if (ids.numel() == 0) {
     VLOG(3) << "keys is empty, please check data!";
+    return;
+  }
+  int64_t value_width = value_->numel() / value_->dims()[0];
+  PADDLE_ENFORCE_EQ(value_width, value->numel() / value->dims()[0],
+                    "output tensor should have the same shape with table "
+                    "except the dims[0].");
+  // TODO(Yancey1989): support other place
+  size_t row_bytes = value_width * SizeOfType(value_->type());
+  const char* table_data = static_cast<const char*>(value_->data<void>());
+  char* out_data = static_cast<char*>(value->data<void>());
+  auto* id_data = ids.data<int64_t>();
+  int64_t num = ids.numel();
+
+  std::vector<int64_t> indices(num);
+  auto copy_row = [&](int64_t i) {
+    if (indices[i] < 0) {
+      VLOG(5) << "id " << id_data[i] << " not in the table, return 0";
+      std::memset(out_data + i * row_bytes, 0, row_bytes);
+    } else {
+      std::memcpy(out_data + i * row_bytes,
+                  table_data + indices[i] * row_bytes, row_bytes);
+    }
+  };
+  if (IsSpillEnabled()) {
+    // The rows may be evicted by the following insertions, so every row is
+    // copied as soon as its index is got.
+    if (auto_grown && !is_test) {
+      Prefetch(id_data, num, auto_grown);
+    }
+    for (int64_t i = 0; i < num; ++i) {
+      indices[i] = AutoGrownIndex(id_data[i], auto_grown, is_test);
+      copy_row(i);
+    }
   } else {
-    int64_t value_width = value_->numel() / value_->dims()[0];
-    PADDLE_ENFORCE_EQ(value_width, value->numel() / value->dims()[0],
-                      "output tensor should have the same shape with table "
-                      "except the dims[0].");
-    for (int i = 0; i < ids.numel(); ++i) {
-      auto id = ids.data<int64_t>()[i];
-      int64_t index = AutoGrownIndex(id, auto_grown, is_test);
-      if (index < 0) {
-        VLOG(5) << "id " << id << " not in the table, return 0";
-        framework::VisitDataType(
-            value_->type(),
-            TensorFillVisitor(value, i * value_width, value_width, 0.0));
-      } else {
-        framework::VisitDataType(
-            value_->type(),
-            TensorCopyVisitor(value, i * value_width, *value_.get(),
-                              index * value_width, value_width));
-      }
+    id_to_index_.FindBatch(id_data, num, indices.data());
+    if (!is_test &&
+        std::any_of(indices.begin(), indices.end(),
+                    [](int64_t index) { return index < 0; })) {
+      GrowIndex(id_data, num, auto_grown, indices.data());
+    }
+    for (int64_t i = 0; i < num; ++i) {
+      copy_row(i);
     }
   }
 }
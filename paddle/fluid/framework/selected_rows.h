@@ -15,14 +15,20 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/row_spill_file.h"
 #include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/framework/sharded_row_index.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
 
@@ -102,14 +108,18 @@ class SelectedRows {
    *
    * @return a list of pair which contains the non-exists key and the index in
    * the value
+   *
+   * Without the spilling, the ids are looked up in a batch and the missing
+   * ones are inserted under a single write lock.
    */
   void Get(const framework::Tensor& ids, framework::Tensor* value,
            bool auto_grown = false, bool is_test = false);
 
   /*
-   * @brief Get the index of the key from id_to_index_ map. If the key not
+   * @brief Get the index of the key from id_to_index_. If the key not
    * exist,
-   * add the key into id_to_index_.
+   * add the key into id_to_index_. The lookup of an existing key does not
+   * take the lock of the table.
    *
    * Note!!! this interface is only used when selected_rows is used as
    * parameters
@@ -122,16 +132,60 @@ class SelectedRows {
   /*
    * @brief Get the index of the key from id_to_index_ map.
    */
-  inline int64_t GetIndexFromId(int64_t key) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
-    }
-  }
+  inline int64_t GetIndexFromId(int64_t key) { return id_to_index_.Find(key); }
 
   void SyncIndex();
+
+  // Initialize the index-th row of the value tensor.
+  using RowInitializer = std::function<void(Tensor* value, int64_t index)>;
+
+  /*
+   * @brief Let the table hold more rows than its value tensor. When the
+   * value tensor is full, a row which is not used recently is evicted to the
+   * spill file at `path`, and a spilled row is read back when it is used
+   * again. The row to evict is chosen by the CLOCK algorithm, an LRU
+   * approximation which only sets a flag when a row is used.
+   *
+   * A new row which takes the place of an evicted row is initialized by
+   * `initializer`, or filled with zeros if it is null.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters for distribute lookup table, and the value tensor must be on
+   * CPU. It does nothing if the spilling has been enabled, and it must not
+   * be called while the table is looked up by other threads.
+   */
+  void EnableSpill(const std::string& path,
+                   RowInitializer initializer = nullptr);
+
+  bool IsSpillEnabled() const;
+
+  // The spill file, nullptr if the spilling is not enabled.
+  RowSpillFile* spill_file() const { return spill_.get(); }
+
+  /*
+   * @brief Make the rows of the ids be in the value tensor, so that the
+   * following AutoGrownIndex of these ids need not read the spill file one
+   * by one. The rows missing from the value tensor are loaded under a single
+   * write lock. It does nothing if the spilling is not enabled.
+   */
+  void Prefetch(const int64_t* ids, int64_t num, bool auto_grown);
+
+  /*
+   * @brief Track the keys of the rows inserted or updated since the last
+   * TakeUpdatedRows, so that a checkpoint of the table can save these rows
+   * only. It does nothing if the tracking has been enabled.
+   */
+  void EnableUpdateTracking();
+
+  bool IsUpdateTrackingEnabled() const { return updated_ != nullptr; }
+
+  // Mark the rows of the keys as updated, e.g. by an optimizer. It does
+  // nothing if the tracking is not enabled.
+  void MarkUpdated(const int64_t* keys, size_t num);
+
+  // Return the keys of the updated rows in ascending order, and clear them.
+  std::vector<int64_t> TakeUpdatedRows();
+
   /*
    * @brief Get complete Dims before
    */
@@ -142,15 +196,55 @@ class SelectedRows {
   }
 
  private:
+  // Put the missing keys into the value tensor under a single write lock,
+  // and set their indices. The spilling must not be enabled.
+  void GrowIndex(const int64_t* keys, int64_t num, bool auto_grown,
+                 int64_t* indices);
+
+  // Put a key which is not in the table into the value tensor, evict a row
+  // if it is full. Return -1 if it is full and the spilling is not enabled.
+  // rwlock_ must be held for writing.
+  int64_t InsertRow(int64_t key);
+
+  // Evict a row to the spill file, and return its index. rwlock_ must be
+  // held for writing.
+  int64_t EvictRow();
+
+  char* RowData(int64_t index) {
+    return static_cast<char*>(value_->data<void>()) +
+           index * spill_->row_bytes();
+  }
+
+  void TouchRow(int64_t index) {
+    if (referenced_ != nullptr) {
+      referenced_[index].store(true, std::memory_order_relaxed);
+    }
+  }
+
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
   Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t>
-      id_to_index_;  // should not be used when rows_ has duplicate member
+  // The index of the rows, it is looked up without rwlock_. It should not be
+  // used when rows_ has duplicate member.
+  ShardedRowIndex id_to_index_;
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;  // height indicates the underline tensor's height
   std::unique_ptr<RWLock> rwlock_{nullptr};
+
+  std::shared_ptr<RowSpillFile> spill_{nullptr};
+  RowInitializer spill_initializer_{nullptr};
+  // The reference flags and the hand of the CLOCK eviction.
+  std::unique_ptr<std::atomic<bool>[]> referenced_{nullptr};
+  int64_t clock_hand_{0};
+
+  // The keys of the updated rows, guarded by their own mutex since they are
+  // marked under the read lock of the table.
+  struct UpdatedRows {
+    std::mutex mutex;
+    std::unordered_set<int64_t> keys;
+  };
+  std::unique_ptr<UpdatedRows> updated_{nullptr};
 };
 
 /*
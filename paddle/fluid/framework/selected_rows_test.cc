@@ -124,6 +124,48 @@ TEST(SelectedRows, SparseTable) {
   }
 }
 
+TEST(SelectedRows, AutoGrownGet) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 10;
+  int64_t embedding_width = 4;
+  auto* data = table.mutable_value()->mutable_data<float>(
+      framework::make_ddim({table_size, embedding_width}), cpu);
+  for (int64_t i = 0; i < table_size * embedding_width; ++i) {
+    data[i] = static_cast<float>(i / embedding_width);
+  }
+  ASSERT_EQ(table.AutoGrownIndex(7, true, false), 0);
+
+  // The new ids, including the duplicated ones, are inserted in order.
+  std::vector<int64_t> keys{5, 7, 3, 5, 9};
+  framework::Tensor ids;
+  auto* ids_data = ids.mutable_data<int64_t>(
+      framework::make_ddim({static_cast<int64_t>(keys.size())}), cpu);
+  std::copy(keys.begin(), keys.end(), ids_data);
+  framework::Tensor get_value;
+  auto* value_data = get_value.mutable_data<float>(
+      framework::make_ddim({static_cast<int64_t>(keys.size()),
+                            embedding_width}),
+      cpu);
+  table.Get(ids, &get_value, true);
+  std::vector<float> expected{1, 0, 2, 1, 3};
+  for (size_t i = 0; i < keys.size(); ++i) {
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      ASSERT_EQ(value_data[i * embedding_width + j], expected[i]);
+    }
+  }
+  ASSERT_EQ(table.rows().size(), 4UL);
+
+  // The unknown ids get zeros in test.
+  ids_data[0] = 100;
+  table.Get(ids, &get_value, true, true);
+  for (int64_t j = 0; j < embedding_width; ++j) {
+    ASSERT_EQ(value_data[j], 0);
+  }
+  ASSERT_EQ(table.rows().size(), 4UL);
+}
+
 void f1(SelectedRows* table, int table_size) {
   for (int i = 1000000; i > 0; --i) {
     auto id = i % table_size;
@@ -198,5 +240,82 @@ TEST(SelectedRows, MultiThreadAutoIndex) {
   t4.join();
 }
 
+TEST(SelectedRows, SpillAutoIndex) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 8;
+  int64_t embedding_width = 4;
+  table.mutable_value()->Resize(
+      framework::make_ddim({table_size, embedding_width}));
+  table.mutable_value()->mutable_data<float>(cpu);
+  table.EnableSpill("./selected_rows_spill_test");
+  ASSERT_TRUE(table.IsSpillEnabled());
+
+  // write the id into its row, so that the rows read back can be checked
+  int64_t id_num = 100;
+  for (int64_t id = 0; id < id_num; ++id) {
+    int64_t index = table.AutoGrownIndex(id, true);
+    ASSERT_GE(index, 0);
+    ASSERT_LT(index, table_size);
+    auto* data = table.mutable_value()->data<float>();
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      // the slot of an evicted row is zero filled for a new id
+      if (id >= table_size) {
+        ASSERT_EQ(data[index * embedding_width + j], 0);
+      }
+      data[index * embedding_width + j] = static_cast<float>(id);
+    }
+  }
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(table_size));
+  ASSERT_EQ(table.spill_file()->Size(),
+            static_cast<size_t>(id_num - table_size));
+  ASSERT_TRUE(table.HasKey(0));
+
+  // the spilled rows are read back, even if auto_grown is false
+  for (int64_t id = 0; id < id_num; id += 7) {
+    int64_t index = table.AutoGrownIndex(id, false);
+    auto* data = table.value().data<float>();
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      ASSERT_EQ(data[index * embedding_width + j], static_cast<float>(id));
+    }
+  }
+  ASSERT_EQ(table.AutoGrownIndex(id_num, false, true), -1);
+
+  // a batched lookup
+  framework::Tensor ids;
+  auto* ids_data = ids.mutable_data<int64_t>(framework::make_ddim({5}), cpu);
+  std::vector<int64_t> id_list{3, 50, 3, 97, 21};
+  std::copy(id_list.begin(), id_list.end(), ids_data);
+  framework::Tensor get_value;
+  auto* value_data = get_value.mutable_data<float>(
+      framework::make_ddim({5, embedding_width}), cpu);
+  table.Get(ids, &get_value, true);
+  for (size_t i = 0; i < id_list.size(); ++i) {
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      ASSERT_EQ(value_data[i * embedding_width + j],
+                static_cast<float>(id_list[i]));
+    }
+  }
+
+  // serialize all rows, including the spilled ones
+  platform::CPUDeviceContext cpu_ctx(cpu);
+  std::ostringstream oss;
+  SerializeToStream(oss, table, cpu_ctx);
+  std::istringstream iss(oss.str());
+  SelectedRows dst_table;
+  DeserializeFromStream(iss, &dst_table, cpu_ctx);
+  ASSERT_EQ(dst_table.rows().size(), static_cast<size_t>(id_num));
+  ASSERT_EQ(dst_table.value().dims(),
+            framework::make_ddim({id_num, embedding_width}));
+  auto* dst_data = dst_table.value().data<float>();
+  for (size_t i = 0; i < dst_table.rows().size(); ++i) {
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      ASSERT_EQ(dst_data[i * embedding_width + j],
+                static_cast<float>(dst_table.rows()[i]));
+    }
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -0,0 +1,176 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/sharded_row_index.h"
+
+namespace paddle {
+namespace framework {
+
+static constexpr size_t kInitialSlotNum = 16;
+
+ShardedRowIndex::ShardedRowIndex(size_t shard_num) {
+  size_t num = 1;
+  while (num < shard_num) num <<= 1;
+  shards_.resize(num);
+  for (auto& shard : shards_) {
+    shard.reset(new Shard);
+    shard->keys.resize(kInitialSlotNum);
+    shard->indices.resize(kInitialSlotNum, -1);
+  }
+}
+
+// The finalizer of MurmurHash3, the ids of a sparse table are often
+// continuous and they must be spread over the shards and the slots.
+uint64_t ShardedRowIndex::Hash(int64_t key) {
+  uint64_t h = static_cast<uint64_t>(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+int64_t ShardedRowIndex::FindSlot(const Shard& shard, int64_t key,
+                                  uint64_t hash) {
+  size_t mask = shard.indices.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    if (shard.indices[i] < 0) return -1;
+    if (shard.keys[i] == key) return static_cast<int64_t>(i);
+  }
+}
+
+void ShardedRowIndex::Grow(Shard* shard) {
+  std::vector<int64_t> keys(shard->keys.size() * 2);
+  std::vector<int64_t> indices(shard->indices.size() * 2, -1);
+  size_t mask = indices.size() - 1;
+  for (size_t s = 0; s < shard->indices.size(); ++s) {
+    if (shard->indices[s] < 0) continue;
+    size_t i = Hash(shard->keys[s]) & mask;
+    while (indices[i] >= 0) i = (i + 1) & mask;
+    keys[i] = shard->keys[s];
+    indices[i] = shard->indices[s];
+  }
+  shard->keys.swap(keys);
+  shard->indices.swap(indices);
+}
+
+int64_t ShardedRowIndex::Find(int64_t key) const {
+  uint64_t hash = Hash(key);
+  const Shard& shard = *shards_[ShardId(hash)];
+  AutoRDLock lock(&shard.lock);
+  int64_t slot = FindSlot(shard, key, hash);
+  return slot < 0 ? -1 : shard.indices[slot];
+}
+
+void ShardedRowIndex::FindBatch(const int64_t* keys, size_t num,
+                                int64_t* indices) const {
+  // Bucket sort the positions of the keys by their shards.
+  std::vector<uint64_t> hashes(num);
+  std::vector<size_t> offsets(shards_.size() + 1, 0);
+  for (size_t i = 0; i < num; ++i) {
+    hashes[i] = Hash(keys[i]);
+    ++offsets[ShardId(hashes[i]) + 1];
+  }
+  for (size_t s = 0; s < shards_.size(); ++s) {
+    offsets[s + 1] += offsets[s];
+  }
+  std::vector<size_t> positions(num);
+  std::vector<size_t> ends(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < num; ++i) {
+    positions[ends[ShardId(hashes[i])]++] = i;
+  }
+
+  for (size_t s = 0; s < shards_.size(); ++s) {
+    if (offsets[s] == offsets[s + 1]) continue;
+    const Shard& shard = *shards_[s];
+    AutoRDLock lock(&shard.lock);
+    for (size_t p = offsets[s]; p < offsets[s + 1]; ++p) {
+      size_t i = positions[p];
+      int64_t slot = FindSlot(shard, keys[i], hashes[i]);
+      indices[i] = slot < 0 ? -1 : shard.indices[slot];
+    }
+  }
+}
+
+int64_t ShardedRowIndex::Insert(int64_t key, int64_t index) {
+  PADDLE_ENFORCE_GE(index, 0, platform::errors::InvalidArgument(
+                                  "The index of key %d should be "
+                                  "non-negative, but received %d.",
+                                  key, index));
+  uint64_t hash = Hash(key);
+  Shard* shard = shards_[ShardId(hash)].get();
+  AutoWRLock lock(&shard->lock);
+  int64_t slot = FindSlot(*shard, key, hash);
+  if (slot >= 0) return shard->indices[slot];
+  // keep the load factor under 1/2
+  if ((shard->size + 1) * 2 > shard->indices.size()) {
+    Grow(shard);
+  }
+  size_t mask = shard->indices.size() - 1;
+  size_t i = hash & mask;
+  while (shard->indices[i] >= 0) i = (i + 1) & mask;
+  shard->keys[i] = key;
+  shard->indices[i] = index;
+  ++shard->size;
+  return index;
+}
+
+bool ShardedRowIndex::Erase(int64_t key) {
+  uint64_t hash = Hash(key);
+  Shard* shard = shards_[ShardId(hash)].get();
+  AutoWRLock lock(&shard->lock);
+  int64_t slot = FindSlot(*shard, key, hash);
+  if (slot < 0) return false;
+  // Shift the following keys of the probe sequence back instead of leaving a
+  // tombstone, so the lookups never probe the erased slots.
+  size_t mask = shard->indices.size() - 1;
+  size_t hole = static_cast<size_t>(slot);
+  shard->indices[hole] = -1;
+  for (size_t i = (hole + 1) & mask; shard->indices[i] >= 0;
+       i = (i + 1) & mask) {
+    size_t home = Hash(shard->keys[i]) & mask;
+    // The key stays if its home slot is cyclically in (hole, i].
+    bool stays = hole < i ? (hole < home && home <= i)
+                          : (hole < home || home <= i);
+    if (stays) continue;
+    shard->keys[hole] = shard->keys[i];
+    shard->indices[hole] = shard->indices[i];
+    shard->indices[i] = -1;
+    hole = i;
+  }
+  --shard->size;
+  return true;
+}
+
+void ShardedRowIndex::Clear() {
+  for (auto& shard : shards_) {
+    AutoWRLock lock(&shard->lock);
+    shard->keys.assign(kInitialSlotNum, 0);
+    shard->indices.assign(kInitialSlotNum, -1);
+    shard->size = 0;
+  }
+}
+
+size_t ShardedRowIndex::Size() const {
+  size_t size = 0;
+  for (auto& shard : shards_) {
+    AutoRDLock lock(&shard->lock);
+    size += shard->size;
+  }
+  return size;
+}
+
+}  // namespace framework
+}  // namespace paddle
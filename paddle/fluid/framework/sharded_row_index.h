@@ -0,0 +1,84 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/framework/rw_lock.h"
+
+namespace paddle {
+namespace framework {
+
+// ShardedRowIndex maps the keys of a sparse table to the indices of their
+// rows. The keys are split into shards by their hashes, and every shard is an
+// open addressing hash table with linear probing guarded by its own lock, so
+// the threads looking up or inserting keys only contend on the same shard.
+//
+// The indices are non-negative. All methods are thread-safe.
+class ShardedRowIndex {
+ public:
+  static constexpr size_t kDefaultShardNum = 64;
+
+  // shard_num is rounded up to a power of 2.
+  explicit ShardedRowIndex(size_t shard_num = kDefaultShardNum);
+
+  // Return the index of key, or -1 if it is not in the index.
+  int64_t Find(int64_t key) const;
+
+  // The indices of keys, or -1 for the missing ones. The keys are grouped by
+  // their shards, so every shard is locked only once for the batch.
+  void FindBatch(const int64_t* keys, size_t num, int64_t* indices) const;
+
+  // Insert key with index if it is not in the index. Return the index of key
+  // after the insertion, which is the old one if key is already there.
+  int64_t Insert(int64_t key, int64_t index);
+
+  // Return false if key is not in the index.
+  bool Erase(int64_t key);
+
+  void Clear();
+
+  size_t Size() const;
+
+ private:
+  struct Shard {
+    mutable RWLock lock;
+    // The slots are empty if their indices are negative.
+    std::vector<int64_t> keys;
+    std::vector<int64_t> indices;
+    size_t size{0};
+  };
+
+  static uint64_t Hash(int64_t key);
+
+  size_t ShardId(uint64_t hash) const {
+    return (hash >> 32) & (shards_.size() - 1);
+  }
+
+  // The slot of key in shard, or -1 if it is missing. The lock of shard
+  // must be held.
+  static int64_t FindSlot(const Shard& shard, int64_t key, uint64_t hash);
+
+  // Double the slots of shard, the lock of shard must be held for writing.
+  static void Grow(Shard* shard);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,86 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/sharded_row_index.h"
+
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(ShardedRowIndex, InsertFindErase) {
+  ShardedRowIndex index(4);
+  std::unordered_map<int64_t, int64_t> expected;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(-500, 500);
+  for (int step = 0; step < 20000; ++step) {
+    int64_t key = dist(rng);
+    if (step % 3 == 2) {
+      ASSERT_EQ(index.Erase(key), expected.erase(key) == 1);
+    } else {
+      auto it = expected.emplace(key, step).first;
+      ASSERT_EQ(index.Insert(key, step), it->second);
+    }
+  }
+  ASSERT_EQ(index.Size(), expected.size());
+  for (int64_t key = -500; key <= 500; ++key) {
+    auto it = expected.find(key);
+    ASSERT_EQ(index.Find(key), it == expected.end() ? -1 : it->second);
+  }
+
+  index.Clear();
+  ASSERT_EQ(index.Size(), 0UL);
+  ASSERT_EQ(index.Find(expected.begin()->first), -1);
+}
+
+TEST(ShardedRowIndex, FindBatch) {
+  ShardedRowIndex index;
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index.Insert(key, key / 2);
+  }
+  std::vector<int64_t> keys;
+  for (int64_t key = 999; key >= 0; --key) keys.push_back(key);
+  std::vector<int64_t> indices(keys.size());
+  index.FindBatch(keys.data(), keys.size(), indices.data());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(indices[i], keys[i] % 2 == 0 ? keys[i] / 2 : -1);
+  }
+}
+
+TEST(ShardedRowIndex, MultiThreadInsert) {
+  ShardedRowIndex index;
+  const int thread_num = 8;
+  const int64_t key_num = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&index, t, key_num] {
+      // All the threads insert the same keys, only the first one wins.
+      for (int64_t key = 0; key < key_num; ++key) {
+        int64_t idx = index.Insert(key, key * thread_num + t);
+        ASSERT_EQ(idx / thread_num, key);
+        ASSERT_EQ(index.Find(key), idx);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  ASSERT_EQ(index.Size(), static_cast<size_t>(key_num));
+}
+
+}  // namespace framework
+}  // namespace paddle
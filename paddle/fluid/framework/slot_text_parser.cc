@@ -0,0 +1,235 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/slot_text_parser.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "paddle/fluid/platform/cpu_info.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(_WIN32)
+#define PADDLE_SLOT_PARSER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace framework {
+
+static inline bool IsDelimiter(char c) {
+  return static_cast<unsigned char>(c) <= ' ';
+}
+
+static inline bool IsDigit(char c) {
+  return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+static size_t DigitRunScalar(const char* p, const char* end) {
+  const char* q = p;
+  while (q < end && IsDigit(*q)) ++q;
+  return q - p;
+}
+
+static size_t SkipTokensScalar(const char* p, const char* end, size_t* num) {
+  const char* q = p;
+  while (*num > 0 && q < end) {
+    while (q < end && IsDelimiter(*q)) ++q;
+    if (q == end) break;
+    while (q < end && !IsDelimiter(*q)) ++q;
+    --(*num);
+  }
+  return q - p;
+}
+
+#ifdef PADDLE_SLOT_PARSER_AVX2
+__attribute__((target("avx2"))) static size_t DigitRunAVX2(const char* p,
+                                                           const char* end) {
+  const __m256i zero = _mm256_set1_epi8('0');
+  const __m256i nine = _mm256_set1_epi8('9');
+  size_t len = 0;
+  while (end - (p + len) >= 32) {
+    __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + len));
+    __m256i is_digit = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(_mm256_max_epu8(c, zero), nine), c);
+    uint32_t non_digit =
+        ~static_cast<uint32_t>(_mm256_movemask_epi8(is_digit));
+    if (non_digit != 0) return len + __builtin_ctz(non_digit);
+    len += 32;
+  }
+  return len + DigitRunScalar(p + len, end);
+}
+
+// Skip the tokens by counting the token starts, i.e., the non-delimiters
+// after delimiters, of 32 bytes at a time.
+__attribute__((target("avx2,popcnt"))) static size_t SkipTokensAVX2(
+    const char* p, const char* end, size_t* num) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  size_t len = 0;
+  // Whether the byte before the window is a delimiter.
+  uint32_t prev_delim = 1;
+  while (*num > 0 && end - (p + len) >= 32) {
+    __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + len));
+    uint32_t delim = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(c, space), c)));
+    uint32_t starts = ~delim & ((delim << 1) | prev_delim);
+    size_t count = __builtin_popcount(starts);
+    if (count >= *num) {
+      // The last token to skip starts in this window.
+      for (size_t i = 1; i < *num; ++i) starts &= starts - 1;
+      *num = 0;
+      const char* q = p + len + __builtin_ctz(starts);
+      while (q < end && !IsDelimiter(*q)) ++q;
+      return q - p;
+    }
+    *num -= count;
+    prev_delim = delim >> 31;
+    len += 32;
+  }
+  if (*num == 0) return len;
+  // The last token may be the one across the window.
+  const char* q = p + len;
+  if (!prev_delim) {
+    while (q < end && !IsDelimiter(*q)) ++q;
+  }
+  return q - p + SkipTokensScalar(q, end, num);
+}
+#endif
+
+bool SlotTextParser::UseAVX2() {
+#ifdef PADDLE_SLOT_PARSER_AVX2
+  static const bool use_avx2 = platform::MayIUse(platform::avx2);
+  return use_avx2;
+#else
+  return false;
+#endif
+}
+
+static inline size_t DigitRun(const char* p, const char* end) {
+#ifdef PADDLE_SLOT_PARSER_AVX2
+  if (end - p >= 32 && SlotTextParser::UseAVX2()) return DigitRunAVX2(p, end);
+#endif
+  return DigitRunScalar(p, end);
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Decode 8 digits without branches, by combining the adjacent 1, 2 and 4
+// digits with multiplications.
+static inline uint64_t Parse8Digits(const char* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  v -= 0x3030303030303030ULL;
+  v = (v & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+  v = (v & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+  return (v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32;
+}
+#endif
+
+// The len must be at most 19, so that the result does not overflow.
+static inline uint64_t ParseDigits(const char* p, size_t len) {
+  uint64_t value = 0;
+  size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for (; i + 8 <= len; i += 8) {
+    value = value * 100000000ULL + Parse8Digits(p + i);
+  }
+#endif
+  for (; i < len; ++i) {
+    value = value * 10 + static_cast<uint64_t>(p[i] - '0');
+  }
+  return value;
+}
+
+void SlotTextParser::SkipSpaces() {
+  while (cursor_ < end_ && IsDelimiter(*cursor_)) ++cursor_;
+}
+
+uint64_t SlotTextParser::NextUint64() {
+  SkipSpaces();
+  // The max uint64 is 18446744073709551615, which has 20 digits.
+  static const uint64_t kMaxUint64Div10 = 1844674407370955161ULL;
+  size_t len = DigitRun(cursor_, end_);
+  if (len > 0 && len <= 20 &&
+      (cursor_ + len == end_ || IsDelimiter(cursor_[len]))) {
+    uint64_t value = ParseDigits(cursor_, std::min<size_t>(len, 19));
+    if (len == 20) {
+      uint64_t digit = static_cast<uint64_t>(cursor_[19] - '0');
+      if (value > kMaxUint64Div10 ||
+          (value == kMaxUint64Div10 && digit > 5)) {
+        // Overflow, let strtoull handle it.
+        len = 0;
+      } else {
+        value = value * 10 + digit;
+      }
+    }
+    if (len > 0) {
+      cursor_ += len;
+      return value;
+    }
+  }
+  char* endptr = nullptr;
+  uint64_t value = strtoull(cursor_, &endptr, 10);
+  cursor_ = endptr;
+  return value;
+}
+
+float SlotTextParser::NextFloat() {
+  // The largest mantissa and power of 10 which are exact in float, so that
+  // one float division gives the correctly rounded result as strtof.
+  static const uint64_t kMaxExactMantissa = 1ULL << 24;
+  static const float kPow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+  SkipSpaces();
+  const char* p = cursor_;
+  bool negative = p < end_ && *p == '-';
+  if (negative) ++p;
+  size_t int_len = DigitRun(p, end_);
+  size_t frac_len = 0;
+  const char* q = p + int_len;
+  if (q < end_ && *q == '.') {
+    frac_len = DigitRun(q + 1, end_);
+    q += frac_len + 1;
+  }
+  if (int_len + frac_len > 0 && int_len + frac_len <= 19 &&
+      frac_len < sizeof(kPow10) / sizeof(kPow10[0]) &&
+      (q == end_ || IsDelimiter(*q))) {
+    const char* frac = p + int_len + 1;
+    uint64_t mantissa = ParseDigits(p, int_len);
+    for (size_t i = 0; i < frac_len; ++i) {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(frac[i] - '0');
+    }
+    if (mantissa <= kMaxExactMantissa) {
+      float value = static_cast<float>(mantissa) / kPow10[frac_len];
+      cursor_ = q;
+      return negative ? -value : value;
+    }
+  }
+  char* endptr = nullptr;
+  float value = strtof(cursor_, &endptr);
+  cursor_ = endptr;
+  return value;
+}
+
+void SlotTextParser::SkipTokens(size_t num) {
+#ifdef PADDLE_SLOT_PARSER_AVX2
+  if (UseAVX2()) {
+    cursor_ += SkipTokensAVX2(cursor_, end_, &num);
+    return;
+  }
+#endif
+  cursor_ += SkipTokensScalar(cursor_, end_, &num);
+}
+
+}  // namespace framework
+}  // namespace paddle
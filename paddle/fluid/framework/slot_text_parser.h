@@ -0,0 +1,61 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace paddle {
+namespace framework {
+
+// SlotTextParser decodes the numbers of a slot text line, i.e.,
+//   [n feasign_0 feasign_1 ... feasign_n]*
+// which is read by the MultiSlot DataFeeds.
+//
+// The plain decimal numbers are decoded 8 digits at a time without
+// branches, and the delimiters are scanned 32 bytes at a time with AVX2 if
+// the CPU supports it. The other numbers, e.g., "1e-3", "+1" or the numbers
+// with too many digits, fall back to strtoull / strtof, so the results are
+// always the same as them.
+//
+// The text must be terminated by '\0' at end.
+class SlotTextParser {
+ public:
+  SlotTextParser(const char* begin, const char* end)
+      : cursor_(begin), end_(end) {}
+
+  // Parse the next unsigned integer, and return 0 if there is no number.
+  uint64_t NextUint64();
+
+  // Parse the next float, and return 0 if there is no number.
+  float NextFloat();
+
+  // Skip the next num tokens separated by spaces.
+  void SkipTokens(size_t num);
+
+  const char* cursor() const { return cursor_; }
+
+  // Whether the delimiters are scanned with AVX2.
+  static bool UseAVX2();
+
+ private:
+  void SkipSpaces();
+
+  const char* cursor_;
+  const char* end_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,120 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/slot_text_parser.h"
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+static void ExpectSameAsStrtoull(const std::string& text, size_t num) {
+  SlotTextParser parser(text.c_str(), text.c_str() + text.size());
+  char* endptr = const_cast<char*>(text.c_str());
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t expected = strtoull(endptr, &endptr, 10);
+    EXPECT_EQ(parser.NextUint64(), expected) << "token " << i << " of "
+                                             << text;
+    EXPECT_EQ(parser.cursor(), endptr);
+  }
+}
+
+static void ExpectSameAsStrtof(const std::string& text, size_t num) {
+  SlotTextParser parser(text.c_str(), text.c_str() + text.size());
+  char* endptr = const_cast<char*>(text.c_str());
+  for (size_t i = 0; i < num; ++i) {
+    float expected = strtof(endptr, &endptr);
+    float actual = parser.NextFloat();
+    EXPECT_EQ(memcmp(&actual, &expected, sizeof(float)), 0)
+        << "token " << i << " of " << text << ": " << actual << " vs "
+        << expected;
+    EXPECT_EQ(parser.cursor(), endptr);
+  }
+}
+
+TEST(SlotTextParser, Uint64) {
+  ExpectSameAsStrtoull("3 0 1 12345678", 4);
+  ExpectSameAsStrtoull("1 18446744073709551615 18446744073709551616", 3);
+  ExpectSameAsStrtoull("2  00000000000000000000123   99999999999999999999", 3);
+  ExpectSameAsStrtoull("4 123456789012345678 9 87654321 10000000000000000000",
+                       5);
+}
+
+TEST(SlotTextParser, Float) {
+  ExpectSameAsStrtof("5 0 1.5 -2.25 0.000001 16777217", 6);
+  ExpectSameAsStrtof("3 1e-3 -4.5E+2 +0.1", 4);
+  ExpectSameAsStrtof("2 3.14159265358979323846 123456789.123456789", 3);
+  ExpectSameAsStrtof("2 .5 -0", 3);
+}
+
+TEST(SlotTextParser, SkipTokens) {
+  std::string text =
+      "3 11111111111111111111 22222222222222222222 33333333333333333333 "
+      "2 0.5 0.25 1 42";
+  SlotTextParser parser(text.c_str(), text.c_str() + text.size());
+  size_t num = parser.NextUint64();
+  EXPECT_EQ(num, 3UL);
+  parser.SkipTokens(num);
+  num = parser.NextUint64();
+  EXPECT_EQ(num, 2UL);
+  parser.SkipTokens(num);
+  EXPECT_EQ(parser.NextUint64(), 1UL);
+  EXPECT_EQ(parser.NextUint64(), 42UL);
+  EXPECT_EQ(parser.NextUint64(), 0UL);
+}
+
+TEST(SlotTextParser, RandomLines) {
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<int> digits(1, 20);
+  std::uniform_real_distribution<float> values(-100.f, 100.f);
+  std::string uint_text, float_text;
+  const size_t kNum = 100000;
+  for (size_t i = 0; i < kNum; ++i) {
+    uint64_t value = rng() >> (64 - 3 * digits(rng));
+    uint_text += std::to_string(value) + " ";
+    float_text += std::to_string(values(rng)) + " ";
+  }
+  ExpectSameAsStrtoull(uint_text, kNum);
+  ExpectSameAsStrtof(float_text, kNum);
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t sum = 0;
+  char* endptr = const_cast<char*>(uint_text.c_str());
+  for (size_t i = 0; i < kNum; ++i) {
+    sum += strtoull(endptr, &endptr, 10);
+  }
+  auto mid = std::chrono::steady_clock::now();
+  SlotTextParser parser(uint_text.c_str(),
+                        uint_text.c_str() + uint_text.size());
+  for (size_t i = 0; i < kNum; ++i) {
+    sum -= parser.NextUint64();
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(sum, 0UL);
+  LOG(INFO) << "strtoull: "
+            << std::chrono::duration<double, std::milli>(mid - start).count()
+            << "ms, SlotTextParser(avx2=" << SlotTextParser::UseAVX2()
+            << "): "
+            << std::chrono::duration<double, std::milli>(end - mid).count()
+            << "ms";
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,276 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sparse_table_delta.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <unordered_map>
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/port.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr char kBase[] = "base";
+constexpr char kDelta[] = "delta";
+
+// The table of each chain saved by this process.
+std::mutex chains_mutex;
+std::unordered_map<std::string, const SelectedRows*> chains;
+
+std::string BaseName(const std::string& path) {
+  auto pos = path.rfind(kSEP);
+  return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+std::string ChainFilePath(const std::string& path, const std::string& name) {
+  auto dir = DirName(path);
+  return dir.empty() ? name : dir + kSEP + name;
+}
+
+void WriteSparseTableManifest(
+    const std::string& path,
+    const std::vector<std::pair<std::string, std::string>>& files) {
+  // write to a temporary file and rename, so that a crash never leaves a
+  // truncated manifest
+  auto manifest = SparseTableManifestPath(path);
+  auto tmp = manifest + ".tmp";
+  {
+    std::ofstream fout(tmp);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Cannot open %s to save the manifest.", tmp));
+    for (auto& file : files) {
+      fout << file.first << " " << file.second << "\n";
+    }
+    fout.close();
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Failed to write the manifest %s.", tmp));
+  }
+  PADDLE_ENFORCE_EQ(std::rename(tmp.c_str(), manifest.c_str()), 0,
+                    platform::errors::Unavailable(
+                        "Failed to rename %s to %s.", tmp, manifest));
+}
+
+// Remove the manifest at path and the deltas it lists, the base is kept.
+void RemoveSparseTableFiles(const std::string& path) {
+  for (auto& file : ReadSparseTableManifest(path)) {
+    if (file.first == kDelta) {
+      std::remove(ChainFilePath(path, file.second).c_str());
+    }
+  }
+  std::remove(SparseTableManifestPath(path).c_str());
+}
+
+}  // namespace
+
+std::string SparseTableManifestPath(const std::string& path) {
+  return path + ".manifest";
+}
+
+std::vector<std::pair<std::string, std::string>> ReadSparseTableManifest(
+    const std::string& path) {
+  std::vector<std::pair<std::string, std::string>> files;
+  std::ifstream fin(SparseTableManifestPath(path));
+  if (!fin.is_open()) return files;
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.empty()) continue;
+    std::istringstream ls(line);
+    std::string kind, name;
+    PADDLE_ENFORCE_EQ(
+        static_cast<bool>(ls >> kind >> name) &&
+            (kind == kBase || kind == kDelta) &&
+            (kind == kBase) == files.empty(),
+        true, platform::errors::InvalidArgument(
+                  "Invalid line of the manifest %s: %s",
+                  SparseTableManifestPath(path), line));
+    files.emplace_back(kind, name);
+  }
+  return files;
+}
+
+void StartSparseTableChain(const std::string& path, SelectedRows* table) {
+  std::lock_guard<std::mutex> guard(chains_mutex);
+  RemoveSparseTableFiles(path);
+  // a table is in one chain at a time, as its updates are taken by the saves
+  for (auto it = chains.begin(); it != chains.end();) {
+    it = it->second == table ? chains.erase(it) : std::next(it);
+  }
+  if (table->IsUpdateTrackingEnabled()) {
+    table->TakeUpdatedRows();
+  } else {
+    table->EnableUpdateTracking();
+  }
+  WriteSparseTableManifest(path, {{kBase, BaseName(path)}});
+  chains[path] = table;
+  VLOG(3) << "start the delta chain of the sparse table at " << path;
+}
+
+void RemoveSparseTableChain(const std::string& path) {
+  std::lock_guard<std::mutex> guard(chains_mutex);
+  chains.erase(path);
+  RemoveSparseTableFiles(path);
+}
+
+bool SaveSparseTableDelta(const std::string& path, SelectedRows* table,
+                          const platform::DeviceContext& dev_ctx) {
+  std::lock_guard<std::mutex> guard(chains_mutex);
+  auto it = chains.find(path);
+  if (it == chains.end() || it->second != table ||
+      !table->IsUpdateTrackingEnabled()) {
+    return false;
+  }
+  auto files = ReadSparseTableManifest(path);
+  if (files.empty()) return false;
+
+  auto keys = table->TakeUpdatedRows();
+  if (keys.empty()) {
+    VLOG(3) << "no rows of the sparse table at " << path
+            << " are updated since the last save";
+    return true;
+  }
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(table->place()), true,
+                    platform::errors::Unimplemented(
+                        "Only the sparse table on CPU can be saved in the "
+                        "delta mode."));
+  int64_t num = static_cast<int64_t>(keys.size());
+  SelectedRows delta(keys, table->height());
+  auto dims = table->value().dims();
+  dims[0] = num;
+  auto* value = delta.mutable_value();
+  value->Resize(dims);
+  value->mutable_data(platform::CPUPlace(), table->value().type());
+  Tensor ids;
+  ids.Resize({num});
+  std::memcpy(ids.mutable_data<int64_t>(platform::CPUPlace()), keys.data(),
+              num * sizeof(int64_t));
+  table->Get(ids, value);
+
+  auto name = BaseName(path) + ".delta." + std::to_string(files.size());
+  auto file_path = ChainFilePath(path, name);
+  std::ofstream fout(file_path, std::ios::binary);
+  if (fout) {
+    SerializeToStream(fout, delta, dev_ctx);
+    fout.close();
+  }
+  if (!fout) {
+    // the rows are saved by the next delta
+    table->MarkUpdated(keys.data(), keys.size());
+    PADDLE_THROW(platform::errors::Unavailable(
+        "Cannot save the delta of the sparse table to %s.", file_path));
+  }
+  files.emplace_back(kDelta, name);
+  WriteSparseTableManifest(path, files);
+  VLOG(3) << "save " << num << " updated rows of the sparse table to "
+          << file_path;
+  return true;
+}
+
+void LoadSparseTableDeltas(const std::string& path, SelectedRows* table,
+                           const platform::DeviceContext& dev_ctx) {
+  auto files = ReadSparseTableManifest(path);
+  if (files.empty()) return;
+  PADDLE_ENFORCE_EQ(files[0].second, BaseName(path),
+                    platform::errors::InvalidArgument(
+                        "The manifest %s is for the base %s, not %s.",
+                        SparseTableManifestPath(path), files[0].second,
+                        BaseName(path)));
+  for (size_t i = 1; i < files.size(); ++i) {
+    auto file_path = ChainFilePath(path, files[i].second);
+    std::ifstream fin(file_path, std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                      platform::errors::Unavailable(
+                          "Cannot open the delta %s of the sparse table.",
+                          file_path));
+    SelectedRows delta;
+    DeserializeFromStream(fin, &delta, dev_ctx);
+    MergeSelectedRows(delta, table);
+    VLOG(3) << "apply " << delta.rows().size() << " rows of the delta "
+            << file_path;
+  }
+}
+
+void MergeSelectedRows(const SelectedRows& delta, SelectedRows* table) {
+  auto* value = table->mutable_value();
+  const auto& delta_value = delta.value();
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(delta_value.place()), true,
+                    platform::errors::Unimplemented(
+                        "Only the sparse table on CPU can be merged."));
+  if (!value->IsInitialized()) {
+    TensorCopySync(delta_value, platform::CPUPlace(), value);
+    table->set_rows(delta.rows());
+    table->set_height(delta.height());
+    table->SyncIndex();
+    return;
+  }
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(value->place()), true,
+                    platform::errors::Unimplemented(
+                        "Only the sparse table on CPU can be merged."));
+  PADDLE_ENFORCE_EQ(value->type(), delta_value.type(),
+                    platform::errors::InvalidArgument(
+                        "The data type of the delta does not match the "
+                        "sparse table."));
+  PADDLE_ENFORCE_EQ(
+      slice_ddim(value->dims(), 1, value->dims().size()),
+      slice_ddim(delta_value.dims(), 1, delta_value.dims().size()),
+      platform::errors::InvalidArgument(
+          "The rows of the delta have the shape %s, the rows of the sparse "
+          "table have %s.",
+          delta_value.dims(), value->dims()));
+
+  table->SyncIndex();
+  size_t row_bytes = product(slice_ddim(value->dims(), 1,
+                                        value->dims().size())) *
+                     SizeOfType(value->type());
+  int64_t capacity = value->dims()[0];
+  int64_t num_rows = table->rows().size();
+  int64_t num_new = 0;
+  for (auto key : delta.rows()) {
+    num_new += table->GetIndexFromId(key) < 0;
+  }
+  if (num_rows + num_new > capacity) {
+    Tensor grown;
+    auto dims = value->dims();
+    dims[0] = num_rows + num_new;
+    grown.Resize(dims);
+    auto* data = grown.mutable_data(platform::CPUPlace(), value->type());
+    std::memcpy(data, value->data<void>(), capacity * row_bytes);
+    value->ShareDataWith(grown);
+  }
+
+  auto* rows = table->mutable_rows();
+  auto* dst = static_cast<char*>(value->data<void>());
+  auto* src = static_cast<const char*>(delta_value.data<void>());
+  for (size_t i = 0; i < delta.rows().size(); ++i) {
+    int64_t key = delta.rows()[i];
+    int64_t index = table->GetIndexFromId(key);
+    if (index < 0) {
+      index = rows->size();
+      rows->push_back(key);
+    }
+    std::memcpy(dst + index * row_bytes, src + i * row_bytes, row_bytes);
+  }
+  table->SyncIndex();
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,73 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * A sparse table can be saved incrementally. A full save of the table to
+ * `path` starts a chain, and each following delta save of the chain writes
+ * only the rows inserted or updated since the previous save to
+ * "<path>.delta.<n>". The manifest "<path>.manifest" lists the files of the
+ * chain in order, one "base <file>" or "delta <file>" line each, with the file
+ * names relative to the directory of the manifest. Loading the table from
+ * `path` applies the deltas of the manifest on the base.
+ *
+ * The chains live in the process which saves the table, a restarted process
+ * starts a new chain with a full save.
+ */
+
+std::string SparseTableManifestPath(const std::string& path);
+
+// The files of the chain at path, in the order of the manifest. Empty if
+// there is no manifest.
+std::vector<std::pair<std::string, std::string>> ReadSparseTableManifest(
+    const std::string& path);
+
+// Start a chain on the table which has just been saved in full to path, and
+// track its updates from now on. The files of the previous chain at path are
+// removed.
+void StartSparseTableChain(const std::string& path, SelectedRows* table);
+
+// Remove the chain at path, after the table is saved in full to path without
+// starting a chain, so that the stale deltas are not loaded.
+void RemoveSparseTableChain(const std::string& path);
+
+// Save the rows updated since the last save of the chain at path. Return
+// false without saving anything if the table has no chain at path, then it
+// should be saved in full and start a chain.
+bool SaveSparseTableDelta(const std::string& path, SelectedRows* table,
+                          const platform::DeviceContext& dev_ctx);
+
+// Apply the deltas of the chain at path on the table loaded from path. It
+// does nothing if there is no manifest.
+void LoadSparseTableDeltas(const std::string& path, SelectedRows* table,
+                           const platform::DeviceContext& dev_ctx);
+
+// Overwrite the rows of the table with the rows of the delta, the rows not in
+// the table are appended, growing its value tensor if it is full. The index
+// of the table is synchronized.
+void MergeSelectedRows(const SelectedRows& delta, SelectedRows* table);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,127 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sparse_table_delta.h"
+#include <fstream>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+static void SetRow(SelectedRows* table, int64_t key, float value) {
+  int64_t index = table->AutoGrownIndex(key, true);
+  float* data = table->mutable_value()->data<float>();
+  data[index * 2] = value;
+  data[index * 2 + 1] = -value;
+  table->MarkUpdated(&key, 1);
+}
+
+static float RowOf(SelectedRows* table, int64_t key) {
+  int64_t index = table->AutoGrownIndex(key, false);
+  return table->value().data<float>()[index * 2];
+}
+
+static void SaveFull(const std::string& path, SelectedRows* table,
+                     const platform::DeviceContext& ctx) {
+  std::ofstream fout(path, std::ios::binary);
+  SerializeToStream(fout, *table, ctx);
+  fout.close();
+  StartSparseTableChain(path, table);
+}
+
+static void Load(const std::string& path, SelectedRows* table,
+                 const platform::DeviceContext& ctx) {
+  std::ifstream fin(path, std::ios::binary);
+  DeserializeFromStream(fin, table, ctx);
+  table->SyncIndex();
+  LoadSparseTableDeltas(path, table, ctx);
+}
+
+TEST(SparseTableDelta, SaveAndLoad) {
+  platform::CPUPlace cpu;
+  platform::CPUDeviceContext ctx(cpu);
+  std::string path = "sparse_table_delta_test.table";
+
+  SelectedRows table({}, 100);
+  table.mutable_value()->Resize({8, 2});
+  table.mutable_value()->mutable_data<float>(cpu);
+  SetRow(&table, 1, 1.f);
+  SetRow(&table, 2, 2.f);
+  EXPECT_FALSE(SaveSparseTableDelta(path, &table, ctx));
+  SaveFull(path, &table, ctx);
+  EXPECT_TRUE(table.IsUpdateTrackingEnabled());
+  EXPECT_TRUE(table.TakeUpdatedRows().empty());
+
+  SetRow(&table, 2, 20.f);
+  SetRow(&table, 3, 3.f);
+  EXPECT_EQ(table.TakeUpdatedRows(), std::vector<int64_t>({2, 3}));
+  SetRow(&table, 2, 20.f);
+  SetRow(&table, 3, 3.f);
+  ASSERT_TRUE(SaveSparseTableDelta(path, &table, ctx));
+  SetRow(&table, 4, 4.f);
+  SetRow(&table, 5, 5.f);
+  SetRow(&table, 3, 30.f);
+  ASSERT_TRUE(SaveSparseTableDelta(path, &table, ctx));
+
+  auto files = ReadSparseTableManifest(path);
+  ASSERT_EQ(files.size(), 3UL);
+  EXPECT_EQ(files[0].first, "base");
+  EXPECT_EQ(files[2].second, path + ".delta.2");
+
+  SelectedRows loaded;
+  Load(path, &loaded, ctx);
+  EXPECT_EQ(loaded.rows().size(), 5UL);
+  EXPECT_EQ(loaded.height(), 100);
+  EXPECT_EQ(RowOf(&loaded, 1), 1.f);
+  EXPECT_EQ(RowOf(&loaded, 2), 20.f);
+  EXPECT_EQ(RowOf(&loaded, 3), 30.f);
+  EXPECT_EQ(RowOf(&loaded, 5), 5.f);
+  int64_t index = loaded.AutoGrownIndex(5, false);
+  EXPECT_EQ(loaded.value().data<float>()[index * 2 + 1], -5.f);
+
+  // the loaded table starts a new chain with a full save
+  EXPECT_FALSE(SaveSparseTableDelta(path, &loaded, ctx));
+  // a full save outside a chain removes the deltas
+  RemoveSparseTableChain(path);
+  EXPECT_TRUE(ReadSparseTableManifest(path).empty());
+  EXPECT_FALSE(SaveSparseTableDelta(path, &table, ctx));
+  SelectedRows base;
+  Load(path, &base, ctx);
+  EXPECT_EQ(base.rows().size(), 2UL);
+  EXPECT_EQ(RowOf(&base, 2), 2.f);
+}
+
+TEST(SparseTableDelta, MergeSelectedRows) {
+  platform::CPUPlace cpu;
+  SelectedRows table({7}, 10);
+  table.mutable_value()->Resize({1, 2});
+  table.mutable_value()->mutable_data<float>(cpu)[0] = 7.f;
+  SelectedRows delta({8, 7}, 10);
+  delta.mutable_value()->Resize({2, 2});
+  float* data = delta.mutable_value()->mutable_data<float>(cpu);
+  data[0] = 8.f;
+  data[2] = 70.f;
+  MergeSelectedRows(delta, &table);
+  EXPECT_EQ(table.value().dims()[0], 2);
+  EXPECT_EQ(RowOf(&table, 7), 70.f);
+  EXPECT_EQ(RowOf(&table, 8), 8.f);
+
+  SelectedRows wider({9}, 10);
+  wider.mutable_value()->Resize({1, 3});
+  wider.mutable_value()->mutable_data<float>(cpu);
+  EXPECT_ANY_THROW(MergeSelectedRows(wider, &table));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,180 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/archive.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// SpillBuckets partitions the records into shuffle buckets on local disk,
+// so that a dataset larger than the host memory still can be shuffled.
+//
+// Each record is appended to a random bucket. The records of a bucket are
+// serialized by BinaryArchive and buffered in memory, and the buffer is
+// appended to the file of the bucket once it exceeds its share of the memory
+// budget. The buckets are read back one by one, in random order, and the
+// records inside a bucket are shuffled after reading.
+//
+// Add() is thread-safe, ReadBucket() can be called after Flush().
+template <typename T>
+class SpillBuckets {
+ public:
+  SpillBuckets(const std::string& dir, size_t bucket_num,
+               size_t memory_budget)
+      : dir_(dir), buckets_(bucket_num) {
+    PADDLE_ENFORCE_GT(bucket_num, 0,
+                      platform::errors::InvalidArgument(
+                          "The number of spill buckets must be larger than "
+                          "0, but received %d.",
+                          bucket_num));
+    buffer_limit_ = std::max<size_t>(memory_budget / bucket_num, 1 << 16);
+    for (size_t i = 0; i < bucket_num; ++i) {
+      buckets_[i].reset(new Bucket);
+      buckets_[i]->path = dir_ + "/bucket-" + std::to_string(i);
+      FILE* fp = fopen(buckets_[i]->path.c_str(), "wb");
+      PADDLE_ENFORCE_NOT_NULL(
+          fp, platform::errors::Unavailable(
+                  "Failed to create the spill file %s.", buckets_[i]->path));
+      fclose(fp);
+    }
+  }
+
+  ~SpillBuckets() {
+    for (auto& bucket : buckets_) {
+      remove(bucket->path.c_str());
+    }
+  }
+
+  size_t BucketNum() const { return buckets_.size(); }
+
+  // The number of records added.
+  size_t Size() const { return size_; }
+
+  // The number of bytes written to disk.
+  size_t SpilledBytes() const { return spilled_bytes_; }
+
+  template <class Engine>
+  void Add(std::vector<T>* records, Engine* engine) {
+    std::vector<BinaryArchive> ars(buckets_.size());
+    for (auto& r : *records) {
+      ars[(*engine)() % buckets_.size()] << r;
+    }
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      if (ars[i].Length() == 0) continue;
+      auto& bucket = *buckets_[i];
+      std::lock_guard<std::mutex> lock(bucket.mtx);
+      bucket.buffer.Write(ars[i].Buffer(), ars[i].Length());
+      if (bucket.buffer.Length() >= buffer_limit_) {
+        SpillBucket(&bucket);
+      }
+    }
+    size_ += records->size();
+    records->clear();
+  }
+
+  // Write all buffered records to disk.
+  void Flush() {
+    for (auto& bucket : buckets_) {
+      std::lock_guard<std::mutex> lock(bucket->mtx);
+      SpillBucket(bucket.get());
+    }
+  }
+
+  // A random permutation of the bucket indices.
+  template <class Engine>
+  std::vector<size_t> ShuffledOrder(Engine* engine) const {
+    std::vector<size_t> order(buckets_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), *engine);
+    return order;
+  }
+
+  // Read all records of the index-th bucket, and shuffle them.
+  template <class Engine>
+  void ReadBucket(size_t index, std::vector<T>* records, Engine* engine) {
+    auto& bucket = *buckets_[index];
+    std::lock_guard<std::mutex> lock(bucket.mtx);
+    records->clear();
+    if (bucket.file_bytes == 0) return;
+    FILE* fp = fopen(bucket.path.c_str(), "rb");
+    PADDLE_ENFORCE_NOT_NULL(
+        fp, platform::errors::Unavailable("Failed to open the spill file %s.",
+                                          bucket.path));
+    std::unique_ptr<char[]> buffer(new char[bucket.file_bytes]);
+    size_t read = fread(buffer.get(), 1, bucket.file_bytes, fp);
+    fclose(fp);
+    PADDLE_ENFORCE_EQ(read, bucket.file_bytes,
+                      platform::errors::Unavailable(
+                          "Failed to read the spill file %s, %d bytes are "
+                          "expected, but only %d bytes are read.",
+                          bucket.path, bucket.file_bytes, read));
+    BinaryArchive ar;
+    ar.SetReadBuffer(buffer.get(), bucket.file_bytes, nullptr);
+    while (ar.Cursor() < ar.Finish()) {
+      records->push_back(ar.Get<T>());
+    }
+    std::shuffle(records->begin(), records->end(), *engine);
+  }
+
+ private:
+  struct Bucket {
+    std::mutex mtx;
+    std::string path;
+    BinaryArchive buffer;
+    size_t file_bytes{0};
+  };
+
+  // Append the buffer of the bucket to its file, bucket->mtx must be held.
+  void SpillBucket(Bucket* bucket) {
+    size_t len = bucket->buffer.Length();
+    if (len == 0) return;
+    FILE* fp = fopen(bucket->path.c_str(), "ab");
+    PADDLE_ENFORCE_NOT_NULL(
+        fp, platform::errors::Unavailable("Failed to open the spill file %s.",
+                                          bucket->path));
+    size_t written = fwrite(bucket->buffer.Buffer(), 1, len, fp);
+    fclose(fp);
+    PADDLE_ENFORCE_EQ(written, len,
+                      platform::errors::Unavailable(
+                          "Failed to write the spill file %s, the disk may be "
+                          "full.",
+                          bucket->path));
+    bucket->file_bytes += len;
+    spilled_bytes_ += len;
+    bucket->buffer.Clear();
+  }
+
+  std::string dir_;
+  std::vector<std::unique_ptr<Bucket>> buckets_;
+  size_t buffer_limit_;
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> spilled_bytes_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/spill_buckets.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(SpillBuckets, AddAndReadBack) {
+  std::string dir = "./spill_buckets_test";
+  mkdir(dir.c_str(), 0755);
+  typedef std::pair<uint64_t, std::string> Item;
+  const size_t kBucketNum = 7;
+  const size_t kThreadNum = 4;
+  const uint64_t kItemNum = 10000;
+  {
+    // a small budget, so that the buffers are spilled many times
+    SpillBuckets<Item> buckets(dir, kBucketNum, 1 << 10);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreadNum; ++t) {
+      threads.emplace_back([&buckets, t]() {
+        std::mt19937_64 engine(t);
+        std::vector<Item> items;
+        for (uint64_t i = t; i < kItemNum; i += kThreadNum) {
+          items.emplace_back(i, std::to_string(i * i));
+          if (items.size() == 100) {
+            buckets.Add(&items, &engine);
+            EXPECT_TRUE(items.empty());
+          }
+        }
+        buckets.Add(&items, &engine);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    buckets.Flush();
+    EXPECT_EQ(buckets.Size(), kItemNum);
+    EXPECT_GT(buckets.SpilledBytes(), kItemNum * sizeof(uint64_t));
+
+    std::mt19937_64 engine(0);
+    auto order = buckets.ShuffledOrder(&engine);
+    ASSERT_EQ(order.size(), kBucketNum);
+    std::vector<bool> seen(kItemNum, false);
+    std::vector<Item> items;
+    size_t non_empty_buckets = 0;
+    for (size_t index : order) {
+      buckets.ReadBucket(index, &items, &engine);
+      non_empty_buckets += items.empty() ? 0 : 1;
+      for (auto& item : items) {
+        ASSERT_LT(item.first, kItemNum);
+        EXPECT_FALSE(seen[item.first]);
+        EXPECT_EQ(item.second, std::to_string(item.first * item.first));
+        seen[item.first] = true;
+      }
+    }
+    EXPECT_EQ(non_empty_buckets, kBucketNum);
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(),
+                            [](bool s) { return s; }));
+
+    // the buckets can be streamed again in the next pass
+    buckets.ReadBucket(order[0], &items, &engine);
+    EXPECT_FALSE(items.empty());
+  }
+  // the spill files are removed with the buckets
+  struct stat st;
+  EXPECT_NE(stat((dir + "/bucket-0").c_str(), &st), 0);
+  rmdir(dir.c_str());
+}
+
+}  // namespace framework
+}  // namespace paddle
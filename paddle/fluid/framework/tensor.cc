@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/tensor.h"
+#include <mutex>  // NOLINT
 #include "paddle/fluid/framework/var_type.h"
 
 namespace paddle {
@@ -55,6 +56,10 @@ void* Tensor::mutable_data(const platform::Place& place,
     holder_.reset();
     holder_ = memory::AllocShared(place, size);
     offset_ = 0;
+    copy_on_write_ = false;
+    borrowed_ = false;
+  } else if (copy_on_write_) {
+    DetachCopyOnWrite();
   }
   return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                                  offset_);
@@ -69,10 +74,81 @@ void* Tensor::mutable_data(const platform::Place& place,
 
 Tensor& Tensor::ShareDataWith(const Tensor& src) {
   src.check_memory_size();
+  DetachBeforeAlias(src);
   *this = src;
   return *this;
 }
 
+Tensor& Tensor::ShareDataCopyOnWrite(const Tensor& src) {
+  src.check_memory_size();
+  *this = src;
+  copy_on_write_ = true;
+  src.copy_on_write_ = true;
+  return *this;
+}
+
+void Tensor::ResetHolderCopyOnWrite(std::shared_ptr<memory::Allocation> holder,
+                                    const proto::VarType::Type type) {
+  ResetHolderWithType(holder, type);
+  copy_on_write_ = true;
+  borrowed_ = true;
+}
+
+// The tensors are detached under the locks striped by their addresses, so a
+// tensor is copied once if several threads modify it at the same time.
+static std::mutex& CopyOnWriteMutex(const Tensor* tensor) {
+  static std::mutex mutexes[64];
+  return mutexes[(reinterpret_cast<uintptr_t>(tensor) / sizeof(Tensor)) % 64];
+}
+
+void Tensor::DetachBeforeAlias(const Tensor& src) {
+  // the borrowed memory must never be written, its aliases stay copy-on-write
+  if (src.copy_on_write_ && !src.borrowed_) {
+    const_cast<Tensor&>(src).DetachCopyOnWrite();
+  }
+}
+
+void Tensor::DetachCopyOnWrite() {
+  std::lock_guard<std::mutex> lock(CopyOnWriteMutex(this));
+  // detached by another thread
+  if (!copy_on_write_) return;
+  if (holder_ == nullptr || (holder_.use_count() == 1 && !borrowed_)) {
+    copy_on_write_ = false;
+    return;
+  }
+
+  auto place = holder_->place();
+  size_t size = memory_size();
+  auto holder = memory::AllocShared(place, size);
+  auto* src_ptr = reinterpret_cast<const void*>(
+      reinterpret_cast<uintptr_t>(holder_->ptr()) + offset_);
+  if (platform::is_cpu_place(place)) {
+    memory::Copy(BOOST_GET_CONST(platform::CPUPlace, place), holder->ptr(),
+                 BOOST_GET_CONST(platform::CPUPlace, place), src_ptr, size);
+  }
+#ifdef PADDLE_WITH_CUDA
+  else if (platform::is_gpu_place(place)) {  // NOLINT
+    auto gpu_place = BOOST_GET_CONST(platform::CUDAPlace, place);
+    auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(place));
+    memory::Copy(gpu_place, holder->ptr(), gpu_place, src_ptr, size,
+                 dev_ctx->stream());
+  } else if (platform::is_cuda_pinned_place(place)) {
+    auto pinned_place = BOOST_GET_CONST(platform::CUDAPinnedPlace, place);
+    memory::Copy(pinned_place, holder->ptr(), pinned_place, src_ptr, size);
+  }
+#endif
+  else {  // NOLINT
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "Copy-on-write is not supported on %s.", place));
+  }
+  holder_ = std::move(holder);
+  offset_ = 0;
+  borrowed_ = false;
+  // cleared at last, so the threads seeing it cleared use the new holder
+  copy_on_write_ = false;
+}
+
 Tensor Tensor::Slice(int64_t begin_idx, int64_t end_idx) const {
   check_memory_size();
   PADDLE_ENFORCE_GE(begin_idx, 0,
@@ -94,6 +170,9 @@ Tensor Tensor::Slice(int64_t begin_idx, int64_t end_idx) const {
     dst_dims[0] = end_idx - begin_idx;
     dst.Resize(dst_dims);
     dst.offset_ = offset_ + begin_idx * base * SizeOfType(type());
+    // the borrowed memory must never be written
+    dst.copy_on_write_ = borrowed_;
+    dst.borrowed_ = borrowed_;
     return dst;
   }
 }
@@ -112,6 +191,8 @@ void Tensor::ResetHolder(std::shared_ptr<memory::Allocation> holder) {
     PADDLE_ENFORCE_EQ(numel() * SizeOfType(type()), holder->size());
   }
   holder_ = holder;
+  copy_on_write_ = false;
+  borrowed_ = false;
 }
 
 void Tensor::ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
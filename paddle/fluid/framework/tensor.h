@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -116,9 +117,35 @@ class Tensor {
   /*! Resize the dimensions of the memory block. */
   Tensor& Resize(const DDim& dims);
 
-  /*! The internal of two tensors share the same memory block. */
+  /**
+   * @brief  The internal of two tensors share the same memory block.
+   *
+   * @note   The writes through either tensor are seen by the other one, so
+   *         a copy-on-write src copies its memory block first if others
+   *         share it, unless the block is borrowed.
+   */
   Tensor& ShareDataWith(const Tensor& src);
 
+  /**
+   * @brief  Share the memory block of src until either of the tensors is
+   *         modified, i.e., mutable_data or the mutable data() is called.
+   *         The modified one copies the memory block before that.
+   *
+   * @note   A slice of a copy-on-write tensor is not copy-on-write, unless
+   *         its memory is borrowed by ResetHolderCopyOnWrite.
+   */
+  Tensor& ShareDataCopyOnWrite(const Tensor& src);
+
+  /**
+   * @brief  Use the memory block owned outside Paddle, e.g. a borrowed numpy
+   *         array, which is never written by the tensor: it is copied before
+   *         the tensor or any tensor sharing it copy-on-write is modified.
+   */
+  void ResetHolderCopyOnWrite(std::shared_ptr<memory::Allocation> holder,
+                              const proto::VarType::Type type);
+
+  bool IsCopyOnWrite() const { return copy_on_write_; }
+
   /**
    * @brief  Return a sub-tensor of the given tensor.
    *
@@ -156,9 +183,12 @@ class Tensor {
   }
 
   void ShareBufferWith(const Tensor& tensor) {
+    DetachBeforeAlias(tensor);
     holder_ = tensor.holder_;
     offset_ = tensor.offset_;
     type_ = tensor.type_;
+    copy_on_write_ = tensor.copy_on_write_;
+    borrowed_ = tensor.borrowed_;
   }
 
   bool IsSharedBufferWith(const Tensor& src) const {
@@ -178,6 +208,31 @@ class Tensor {
                            const proto::VarType::Type type);
 
  private:
+  // A std::atomic<bool> copied with the tensor, since the tensors used by
+  // several threads may be detached concurrently.
+  class CopyOnWriteFlag {
+   public:
+    CopyOnWriteFlag() = default;
+    CopyOnWriteFlag(const CopyOnWriteFlag& other) : value_(other) {}
+    CopyOnWriteFlag& operator=(const CopyOnWriteFlag& other) {
+      return *this = static_cast<bool>(other);
+    }
+    CopyOnWriteFlag& operator=(bool value) {
+      value_.store(value, std::memory_order_release);
+      return *this;
+    }
+    operator bool() const { return value_.load(std::memory_order_acquire); }
+
+   private:
+    std::atomic<bool> value_{false};
+  };
+
+  // Copy the memory block if it is shared by others, and leave the
+  // copy-on-write mode. It is thread safe.
+  void DetachCopyOnWrite();
+  // Make src leave the copy-on-write mode before it is aliased.
+  static void DetachBeforeAlias(const Tensor& src);
+
   /*! holds the memory block if allocated. */
   std::shared_ptr<memory::Allocation> holder_;
   proto::VarType::Type type_;
@@ -212,6 +267,21 @@ class Tensor {
    *          PlaceHolder::ptr_ and where the tensor data really begins.
    */
   size_t offset_;
+
+  /**
+   * @brief   Whether the memory block is shared by ShareDataCopyOnWrite.
+   *
+   * @note    It is mutable since the source of ShareDataCopyOnWrite becomes
+   *          copy-on-write too.
+   */
+  mutable CopyOnWriteFlag copy_on_write_;
+
+  /**
+   * @brief   Whether the memory block is owned outside Paddle and set by
+   *          ResetHolderCopyOnWrite, so it is copied before being modified
+   *          even if no other tensor shares it.
+   */
+  bool borrowed_ = false;
 };
 
 }  // namespace framework
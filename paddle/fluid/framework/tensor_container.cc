@@ -0,0 +1,483 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/tensor_container.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "zlib.h"  // NOLINT
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+uint32_t Crc32(const char* data, size_t size) {
+  uLong crc = crc32(0L, Z_NULL, 0);
+  // crc32 takes the size as uInt
+  while (size > 0) {
+    uInt n = static_cast<uInt>(std::min<size_t>(size, 1UL << 30));
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(data), n);
+    data += n;
+    size -= n;
+  }
+  return static_cast<uint32_t>(crc);
+}
+
+template <typename T>
+void AppendValue(std::string* buf, T value) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Reads the index with the bounds checked.
+class Cursor {
+ public:
+  Cursor(const char* data, size_t size) : data_(data), size_(size) {}
+
+  const char* Read(size_t bytes) {
+    PADDLE_ENFORCE_LE(
+        bytes, size_ - offset_,
+        platform::errors::InvalidArgument(
+            "The index of the tensor container is truncated, please check "
+            "whether the file is complete or damaged."));
+    const char* ptr = data_ + offset_;
+    offset_ += bytes;
+    return ptr;
+  }
+
+  template <typename T>
+  T ReadValue() {
+    T value;
+    std::memcpy(&value, Read(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  bool eof() const { return offset_ == size_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t offset_{0};
+};
+
+size_t ChunkRawSize(const TensorContainerEntry& entry, size_t i) {
+  return std::min<uint64_t>(kTensorContainerChunkSize,
+                            entry.raw_size - i * kTensorContainerChunkSize);
+}
+
+void CheckChunk(const TensorContainerEntry& entry, size_t i,
+                const char* data) {
+  PADDLE_ENFORCE_EQ(
+      Crc32(data, entry.chunks[i].stored_size), entry.chunks[i].crc,
+      platform::errors::InvalidArgument(
+          "The CRC32 of the chunk %d of the tensor %s mismatches, please "
+          "check whether the file is damaged.",
+          i, entry.name));
+}
+
+// Resize the CPU tensor and allocate it by the entry.
+char* PrepareTensor(const TensorContainerEntry& entry, LoDTensor* tensor) {
+  std::vector<int64_t> dims(entry.desc.dims().begin(),
+                            entry.desc.dims().end());
+  tensor->Resize(make_ddim(dims));
+  tensor->set_lod(entry.lod);
+  auto type = entry.desc.data_type();
+  PADDLE_ENFORCE_EQ(
+      tensor->numel() * SizeOfType(type), entry.raw_size,
+      platform::errors::InvalidArgument(
+          "The size of the tensor %s is %d bytes in the index of the tensor "
+          "container, but its shape [%s] takes %d bytes.",
+          entry.name, entry.raw_size, tensor->dims(),
+          tensor->numel() * SizeOfType(type)));
+  return static_cast<char*>(tensor->mutable_data(platform::CPUPlace(), type));
+}
+
+}  // namespace
+
+TensorCompression StringToTensorCompression(const std::string& str) {
+  if (str == "none") return TensorCompression::kNone;
+  if (str == "zlib") return TensorCompression::kZlib;
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "The compression %s of the tensors is not supported, it should be "
+      "\"none\" or \"zlib\".",
+      str));
+}
+
+uint64_t TensorContainerEntry::stored_size() const {
+  uint64_t size = 0;
+  for (auto& chunk : chunks) {
+    size += chunk.stored_size;
+  }
+  return size;
+}
+
+TensorContainerIndex TensorContainerIndex::Parse(const char* tail,
+                                                 size_t tail_size,
+                                                 uint64_t tail_offset) {
+  PADDLE_ENFORCE_GE(
+      tail_size, kTensorContainerFooterSize,
+      platform::errors::InvalidArgument(
+          "The tensor container is truncated, please check whether the file "
+          "is complete or damaged."));
+  Cursor footer(tail + tail_size - kTensorContainerFooterSize,
+                kTensorContainerFooterSize);
+  uint64_t index_offset = footer.ReadValue<uint64_t>();
+  uint32_t index_size = footer.ReadValue<uint32_t>();
+  uint32_t index_crc = footer.ReadValue<uint32_t>();
+  PADDLE_ENFORCE_EQ(
+      std::memcmp(footer.Read(kTensorContainerMagicSize),
+                  kTensorContainerMagic, kTensorContainerMagicSize),
+      0, platform::errors::InvalidArgument(
+             "The footer of the tensor container is damaged."));
+  PADDLE_ENFORCE_EQ(
+      index_size + tail_offset + kTensorContainerFooterSize ==
+              tail_offset + tail_size &&
+          index_offset == tail_offset,
+      true, platform::errors::InvalidArgument(
+                "The index of the tensor container is at %d of %d bytes, "
+                "but %d bytes at %d are given.",
+                index_offset, index_size, tail_size, tail_offset));
+  PADDLE_ENFORCE_EQ(Crc32(tail, index_size), index_crc,
+                    platform::errors::InvalidArgument(
+                        "The CRC32 of the index of the tensor container "
+                        "mismatches, please check whether the file is "
+                        "damaged."));
+
+  TensorContainerIndex index;
+  Cursor cursor(tail, index_size);
+  uint32_t num = cursor.ReadValue<uint32_t>();
+  index.entries_.resize(num);
+  for (uint32_t i = 0; i < num; ++i) {
+    auto& entry = index.entries_[i];
+    uint32_t name_size = cursor.ReadValue<uint32_t>();
+    entry.name.assign(cursor.Read(name_size), name_size);
+    uint64_t lod_level = cursor.ReadValue<uint64_t>();
+    entry.lod.resize(lod_level);
+    for (auto& level : entry.lod) {
+      uint64_t level_size = cursor.ReadValue<uint64_t>();
+      level.resize(level_size);
+      for (uint64_t j = 0; j < level_size; ++j) {
+        level[j] = cursor.ReadValue<uint64_t>();
+      }
+    }
+    uint32_t desc_size = cursor.ReadValue<uint32_t>();
+    PADDLE_ENFORCE_EQ(
+        entry.desc.ParseFromArray(cursor.Read(desc_size), desc_size), true,
+        platform::errors::InvalidArgument("Cannot parse tensor desc"));
+    uint32_t compression = cursor.ReadValue<uint32_t>();
+    PADDLE_ENFORCE_LE(compression,
+                      static_cast<uint32_t>(TensorCompression::kZlib),
+                      platform::errors::InvalidArgument(
+                          "The compression %d of the tensor %s is unknown.",
+                          compression, entry.name));
+    entry.compression = static_cast<TensorCompression>(compression);
+    entry.offset = cursor.ReadValue<uint64_t>();
+    entry.raw_size = cursor.ReadValue<uint64_t>();
+    uint32_t chunk_num = cursor.ReadValue<uint32_t>();
+    PADDLE_ENFORCE_EQ(
+        chunk_num,
+        (entry.raw_size + kTensorContainerChunkSize - 1) /
+            kTensorContainerChunkSize,
+        platform::errors::InvalidArgument(
+            "The tensor %s of %d bytes has %d chunks in the index.",
+            entry.name, entry.raw_size, chunk_num));
+    entry.chunks.resize(chunk_num);
+    for (auto& chunk : entry.chunks) {
+      chunk.stored_size = cursor.ReadValue<uint64_t>();
+      chunk.crc = cursor.ReadValue<uint32_t>();
+    }
+    PADDLE_ENFORCE_LE(entry.offset + entry.stored_size(), tail_offset,
+                      platform::errors::InvalidArgument(
+                          "The payload of the tensor %s is out of the "
+                          "tensor container.",
+                          entry.name));
+    PADDLE_ENFORCE_EQ(index.name_to_entry_.emplace(entry.name, i).second,
+                      true,
+                      platform::errors::InvalidArgument(
+                          "The tensor %s is duplicated in the tensor "
+                          "container.",
+                          entry.name));
+  }
+  PADDLE_ENFORCE_EQ(cursor.eof(), true,
+                    platform::errors::InvalidArgument(
+                        "The index of the tensor container is damaged."));
+  return index;
+}
+
+TensorContainerIndex TensorContainerIndex::Read(std::istream* is) {
+  is->seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(is->tellg());
+  PADDLE_ENFORCE_GE(
+      size, kTensorContainerMagicSize + kTensorContainerFooterSize,
+      platform::errors::InvalidArgument(
+          "The tensor container is truncated, please check whether the file "
+          "is complete or damaged."));
+  char footer[kTensorContainerFooterSize];
+  is->seekg(size - kTensorContainerFooterSize);
+  is->read(footer, kTensorContainerFooterSize);
+  uint64_t index_offset;
+  std::memcpy(&index_offset, footer, sizeof(index_offset));
+  PADDLE_ENFORCE_LE(index_offset, size - kTensorContainerFooterSize,
+                    platform::errors::InvalidArgument(
+                        "The footer of the tensor container is damaged."));
+  std::string tail(size - index_offset, '\0');
+  is->seekg(index_offset);
+  is->read(&tail[0], tail.size());
+  PADDLE_ENFORCE_EQ(static_cast<bool>(*is), true,
+                    platform::errors::Unavailable(
+                        "Failed to read the index of the tensor container."));
+  return Parse(tail.data(), tail.size(), index_offset);
+}
+
+TensorContainerIndex TensorContainerIndex::FromMemory(const char* data,
+                                                      size_t size) {
+  PADDLE_ENFORCE_GE(
+      size, kTensorContainerMagicSize + kTensorContainerFooterSize,
+      platform::errors::InvalidArgument(
+          "The tensor container is truncated, please check whether the file "
+          "is complete or damaged."));
+  uint64_t index_offset;
+  std::memcpy(&index_offset, data + size - kTensorContainerFooterSize,
+              sizeof(index_offset));
+  PADDLE_ENFORCE_LE(index_offset, size - kTensorContainerFooterSize,
+                    platform::errors::InvalidArgument(
+                        "The footer of the tensor container is damaged."));
+  return Parse(data + index_offset, size - index_offset, index_offset);
+}
+
+const TensorContainerEntry* TensorContainerIndex::Find(
+    const std::string& name) const {
+  auto it = name_to_entry_.find(name);
+  return it == name_to_entry_.end() ? nullptr : &entries_[it->second];
+}
+
+bool IsTensorContainer(const char* start, size_t size) {
+  return size >= kTensorContainerMagicSize &&
+         std::memcmp(start, kTensorContainerMagic,
+                     kTensorContainerMagicSize) == 0;
+}
+
+bool IsTensorContainer(std::istream* is) {
+  auto pos = is->tellg();
+  char magic[kTensorContainerMagicSize];
+  is->read(magic, kTensorContainerMagicSize);
+  bool is_container = static_cast<size_t>(is->gcount()) ==
+                          kTensorContainerMagicSize &&
+                      IsTensorContainer(magic, kTensorContainerMagicSize);
+  is->clear();
+  is->seekg(pos);
+  return is_container;
+}
+
+void DecodeTensorPayload(const TensorContainerEntry& entry,
+                         const char* payload, LoDTensor* tensor) {
+  char* dst = PrepareTensor(entry, tensor);
+  for (size_t i = 0; i < entry.chunks.size(); ++i) {
+    CheckChunk(entry, i, payload);
+    size_t raw_size = ChunkRawSize(entry, i);
+    if (entry.compression == TensorCompression::kNone) {
+      std::memcpy(dst, payload, raw_size);
+    } else {
+      uLongf dst_size = raw_size;
+      int ret = uncompress(reinterpret_cast<Bytef*>(dst), &dst_size,
+                           reinterpret_cast<const Bytef*>(payload),
+                           entry.chunks[i].stored_size);
+      PADDLE_ENFORCE_EQ(ret == Z_OK && dst_size == raw_size, true,
+                        platform::errors::InvalidArgument(
+                            "Failed to decompress the chunk %d of the "
+                            "tensor %s, the zlib error is %d.",
+                            i, entry.name, ret));
+    }
+    payload += entry.chunks[i].stored_size;
+    dst += raw_size;
+  }
+}
+
+void CheckTensorPayload(const TensorContainerEntry& entry,
+                        const char* payload) {
+  for (size_t i = 0; i < entry.chunks.size(); ++i) {
+    CheckChunk(entry, i, payload);
+    payload += entry.chunks[i].stored_size;
+  }
+}
+
+TensorContainerWriter::TensorContainerWriter(std::ostream* os) : os_(os) {
+  Write(kTensorContainerMagic, kTensorContainerMagicSize);
+}
+
+void TensorContainerWriter::Write(const char* data, size_t size) {
+  os_->write(data, size);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(*os_), true,
+                    platform::errors::Unavailable(
+                        "Failed to write the tensor container."));
+  offset_ += size;
+}
+
+void TensorContainerWriter::Append(const std::string& name,
+                                   const LoDTensor& tensor,
+                                   const platform::DeviceContext& dev_ctx,
+                                   TensorCompression compression) {
+  PADDLE_ENFORCE_EQ(finished_, false,
+                    platform::errors::PreconditionNotMet(
+                        "The tensor container is finished."));
+  const Tensor* cpu_tensor = &tensor;
+  Tensor copied;
+  if (!platform::is_cpu_place(tensor.place())) {
+    TensorCopySync(tensor, platform::CPUPlace(), &copied);
+    cpu_tensor = &copied;
+  }
+
+  TensorContainerEntry entry;
+  entry.name = name;
+  entry.lod = tensor.lod();
+  entry.desc.set_data_type(tensor.type());
+  auto dims = framework::vectorize(tensor.dims());
+  auto* pb_dims = entry.desc.mutable_dims();
+  pb_dims->Resize(static_cast<int>(dims.size()), 0);
+  std::copy(dims.begin(), dims.end(), pb_dims->begin());
+  entry.raw_size = tensor.numel() * SizeOfType(tensor.type());
+  entry.compression = compression;
+  size_t chunk_num = (entry.raw_size + kTensorContainerChunkSize - 1) /
+                     kTensorContainerChunkSize;
+  entry.chunks.resize(chunk_num);
+  const char* data =
+      entry.raw_size > 0 ? static_cast<const char*>(cpu_tensor->data<void>())
+                         : nullptr;
+
+  std::vector<std::string> compressed;
+  if (compression == TensorCompression::kZlib) {
+    compressed.resize(chunk_num);
+    uint64_t stored_size = 0;
+    for (size_t i = 0; i < chunk_num; ++i) {
+      size_t raw_size = ChunkRawSize(entry, i);
+      uLongf size = compressBound(raw_size);
+      compressed[i].resize(size);
+      int ret = compress(
+          reinterpret_cast<Bytef*>(&compressed[i][0]), &size,
+          reinterpret_cast<const Bytef*>(data + i * kTensorContainerChunkSize),
+          raw_size);
+      PADDLE_ENFORCE_EQ(ret, Z_OK, platform::errors::External(
+                                       "Failed to compress the tensor %s, "
+                                       "the zlib error is %d.",
+                                       name, ret));
+      compressed[i].resize(size);
+      stored_size += size;
+    }
+    if (stored_size >= entry.raw_size) {
+      entry.compression = TensorCompression::kNone;
+    }
+  }
+
+  static const char kPadding[kTensorContainerAlignment] = {0};
+  size_t padding = (kTensorContainerAlignment -
+                    offset_ % kTensorContainerAlignment) %
+                   kTensorContainerAlignment;
+  Write(kPadding, padding);
+  entry.offset = offset_;
+  for (size_t i = 0; i < chunk_num; ++i) {
+    const char* chunk = data + i * kTensorContainerChunkSize;
+    size_t size = ChunkRawSize(entry, i);
+    if (entry.compression == TensorCompression::kZlib) {
+      chunk = compressed[i].data();
+      size = compressed[i].size();
+    }
+    entry.chunks[i].stored_size = size;
+    entry.chunks[i].crc = Crc32(chunk, size);
+    Write(chunk, size);
+  }
+  entries_.emplace_back(std::move(entry));
+}
+
+void TensorContainerWriter::Finish() {
+  PADDLE_ENFORCE_EQ(finished_, false,
+                    platform::errors::PreconditionNotMet(
+                        "The tensor container is finished."));
+  finished_ = true;
+  std::string index;
+  AppendValue(&index, static_cast<uint32_t>(entries_.size()));
+  for (auto& entry : entries_) {
+    AppendValue(&index, static_cast<uint32_t>(entry.name.size()));
+    index.append(entry.name);
+    AppendValue(&index, static_cast<uint64_t>(entry.lod.size()));
+    for (auto& level : entry.lod) {
+      AppendValue(&index, static_cast<uint64_t>(level.size()));
+      for (auto offset : level) {
+        AppendValue(&index, static_cast<uint64_t>(offset));
+      }
+    }
+    std::string desc = entry.desc.SerializeAsString();
+    AppendValue(&index, static_cast<uint32_t>(desc.size()));
+    index.append(desc);
+    AppendValue(&index, static_cast<uint32_t>(entry.compression));
+    AppendValue(&index, entry.offset);
+    AppendValue(&index, entry.raw_size);
+    AppendValue(&index, static_cast<uint32_t>(entry.chunks.size()));
+    for (auto& chunk : entry.chunks) {
+      AppendValue(&index, chunk.stored_size);
+      AppendValue(&index, chunk.crc);
+    }
+  }
+
+  std::string footer;
+  AppendValue(&footer, offset_);
+  AppendValue(&footer, static_cast<uint32_t>(index.size()));
+  AppendValue(&footer, Crc32(index.data(), index.size()));
+  footer.append(kTensorContainerMagic, kTensorContainerMagicSize);
+  Write(index.data(), index.size());
+  Write(footer.data(), footer.size());
+  os_->flush();
+}
+
+TensorContainerReader::TensorContainerReader(std::istream* is)
+    : is_(is), index_(TensorContainerIndex::Read(is)) {}
+
+void TensorContainerReader::Read(const std::string& name, LoDTensor* tensor,
+                                 const platform::DeviceContext& dev_ctx) {
+  auto* entry = index_.Find(name);
+  PADDLE_ENFORCE_NOT_NULL(
+      entry, platform::errors::NotFound(
+                 "The tensor %s is not found in the tensor container.", name));
+  bool on_cpu = platform::is_cpu_place(dev_ctx.GetPlace());
+  LoDTensor cpu_tensor;
+  LoDTensor* dst = on_cpu ? tensor : &cpu_tensor;
+
+  is_->seekg(entry->offset);
+  if (entry->compression == TensorCompression::kNone) {
+    // read into the tensor directly, and check the chunks there
+    char* data = PrepareTensor(*entry, dst);
+    for (size_t i = 0; i < entry->chunks.size(); ++i) {
+      is_->read(data, entry->chunks[i].stored_size);
+      CheckChunk(*entry, i, data);
+      data += entry->chunks[i].stored_size;
+    }
+  } else {
+    std::string payload(entry->stored_size(), '\0');
+    is_->read(&payload[0], payload.size());
+    DecodeTensorPayload(*entry, payload.data(), dst);
+  }
+  PADDLE_ENFORCE_EQ(static_cast<bool>(*is_), true,
+                    platform::errors::Unavailable(
+                        "Failed to read the tensor %s from the tensor "
+                        "container.",
+                        name));
+  if (!on_cpu) {
+    tensor->set_lod(cpu_tensor.lod());
+    TensorCopySync(cpu_tensor, dev_ctx.GetPlace(), tensor);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
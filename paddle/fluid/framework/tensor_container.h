@@ -0,0 +1,165 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The version 2 file of the combined LoDTensors, which can be read by names
+ * in any order, with all the payloads checked:
+ *
+ *   header:  magic "PDTNSRV2"
+ *   payload: the data of each tensor, 64-byte aligned, in chunks of at most
+ *            kTensorContainerChunkSize bytes before compression, each chunk
+ *            compressed independently if the tensor is compressed
+ *   index:   for each tensor, the name, the LoD, the TensorDesc, the
+ *            compression, the offset of the payload and the stored size and
+ *            the CRC32 of each chunk
+ *   footer:  the offset, the size and the CRC32 of the index, and the magic
+ *
+ * The index is at the end, so that the file is written in one pass. The
+ * uncompressed payloads are aligned, so they are referenced directly when the
+ * file is mapped into the memory. The version 1 files, i.e. the tensors
+ * serialized by SerializeToStream one after another, start with the tensor
+ * version 0, so the two formats are told apart by the first bytes.
+ */
+constexpr char kTensorContainerMagic[] = "PDTNSRV2";
+constexpr size_t kTensorContainerMagicSize = 8;
+constexpr size_t kTensorContainerAlignment = 64;
+constexpr size_t kTensorContainerChunkSize = 4 << 20;
+constexpr size_t kTensorContainerFooterSize = 24;
+
+enum class TensorCompression : uint32_t {
+  kNone = 0,
+  kZlib = 1,
+};
+
+// "none" or "zlib".
+TensorCompression StringToTensorCompression(const std::string& str);
+
+struct TensorContainerEntry {
+  struct Chunk {
+    uint64_t stored_size;
+    uint32_t crc;
+  };
+
+  std::string name;
+  LoD lod;
+  proto::VarType::TensorDesc desc;
+  TensorCompression compression{TensorCompression::kNone};
+  // the offset of the payload from the start of the file
+  uint64_t offset{0};
+  uint64_t raw_size{0};
+  std::vector<Chunk> chunks;
+
+  uint64_t stored_size() const;
+};
+
+class TensorContainerIndex {
+ public:
+  // Parse the footer and the index from the last bytes of the file, `tail`
+  // is the index followed by the footer, and `tail_offset` is where it
+  // starts in the file.
+  static TensorContainerIndex Parse(const char* tail, size_t tail_size,
+                                    uint64_t tail_offset);
+
+  // Read the index from the end of a seekable stream.
+  static TensorContainerIndex Read(std::istream* is);
+
+  // Parse the index of the whole file in the memory, e.g. mapped.
+  static TensorContainerIndex FromMemory(const char* data, size_t size);
+
+  const std::vector<TensorContainerEntry>& entries() const {
+    return entries_;
+  }
+
+  // nullptr if the tensor is absent.
+  const TensorContainerEntry* Find(const std::string& name) const;
+
+ private:
+  std::vector<TensorContainerEntry> entries_;
+  std::unordered_map<std::string, size_t> name_to_entry_;
+};
+
+// Whether the bytes, which should be at least kTensorContainerMagicSize, are
+// the start of a container.
+bool IsTensorContainer(const char* start, size_t size);
+// Peek the start of the stream, the position is restored.
+bool IsTensorContainer(std::istream* is);
+
+// Check the CRC32 of the chunks of the payload, and decompress it into the
+// CPU tensor, whose dims, type and LoD are set by the entry.
+void DecodeTensorPayload(const TensorContainerEntry& entry,
+                         const char* payload, LoDTensor* tensor);
+// Only check the CRC32 of the chunks of the payload.
+void CheckTensorPayload(const TensorContainerEntry& entry,
+                        const char* payload);
+
+/*
+ * Writes the tensors to a stream, which needs not to be seekable.
+ */
+class TensorContainerWriter {
+ public:
+  explicit TensorContainerWriter(std::ostream* os);
+
+  // The tensor on the device is copied to the CPU first. If the compressed
+  // payload is not smaller, the tensor is stored uncompressed.
+  void Append(const std::string& name, const LoDTensor& tensor,
+              const platform::DeviceContext& dev_ctx,
+              TensorCompression compression = TensorCompression::kNone);
+
+  // Write the index and the footer.
+  void Finish();
+
+ private:
+  void Write(const char* data, size_t size);
+
+  std::ostream* os_;
+  uint64_t offset_{0};
+  bool finished_{false};
+  std::vector<TensorContainerEntry> entries_;
+};
+
+/*
+ * Reads the tensors by names from a seekable stream.
+ */
+class TensorContainerReader {
+ public:
+  explicit TensorContainerReader(std::istream* is);
+
+  const TensorContainerIndex& index() const { return index_; }
+
+  // The tensor is copied to the place of the device context if it is not
+  // the CPU.
+  void Read(const std::string& name, LoDTensor* tensor,
+            const platform::DeviceContext& dev_ctx);
+
+ private:
+  std::istream* is_;
+  TensorContainerIndex index_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,124 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/tensor_container.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace paddle {
+namespace framework {
+
+static void FillTensor(LoDTensor* tensor, const DDim& dims, float start) {
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    // repeated values to be compressed
+    data[i] = start + i % 16;
+  }
+}
+
+static void ExpectEqual(const LoDTensor& a, const LoDTensor& b) {
+  ASSERT_EQ(a.dims(), b.dims());
+  EXPECT_EQ(a.lod(), b.lod());
+  EXPECT_EQ(a.type(), b.type());
+  for (int64_t i = 0; i < a.numel(); ++i) {
+    EXPECT_EQ(a.data<float>()[i], b.data<float>()[i]);
+  }
+}
+
+TEST(TensorContainer, write_and_read) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  LoDTensor x, y, z;
+  FillTensor(&x, {3, 5}, 0.f);
+  x.set_lod({{0, 1, 3}});
+  // larger than a chunk
+  FillTensor(&y, {static_cast<int64_t>(kTensorContainerChunkSize / 4 + 7)},
+             1.f);
+  FillTensor(&z, {0}, 0.f);
+
+  std::stringstream ss;
+  TensorContainerWriter writer(&ss);
+  writer.Append("x", x, ctx);
+  writer.Append("y", y, ctx, TensorCompression::kZlib);
+  writer.Append("z", z, ctx, TensorCompression::kZlib);
+  writer.Finish();
+  std::string str = ss.str();
+
+  EXPECT_TRUE(IsTensorContainer(&ss));
+  EXPECT_EQ(ss.tellg(), 0);
+  TensorContainerReader reader(&ss);
+  auto& entries = reader.index().entries();
+  ASSERT_EQ(entries.size(), 3UL);
+  EXPECT_EQ(entries[1].chunks.size(), 2UL);
+  EXPECT_EQ(entries[1].compression, TensorCompression::kZlib);
+  EXPECT_LT(entries[1].stored_size(), entries[1].raw_size);
+  for (auto& entry : entries) {
+    EXPECT_EQ(entry.offset % kTensorContainerAlignment, 0UL);
+  }
+  EXPECT_EQ(reader.index().Find("w"), nullptr);
+
+  // in any order
+  LoDTensor out_x, out_y, out_z;
+  reader.Read("y", &out_y, ctx);
+  reader.Read("x", &out_x, ctx);
+  reader.Read("z", &out_z, ctx);
+  ExpectEqual(out_x, x);
+  ExpectEqual(out_y, y);
+  EXPECT_EQ(out_z.numel(), 0);
+  EXPECT_ANY_THROW(reader.Read("w", &out_x, ctx));
+
+  auto index = TensorContainerIndex::FromMemory(str.data(), str.size());
+  LoDTensor decoded_y;
+  DecodeTensorPayload(*index.Find("y"), str.data() + index.Find("y")->offset,
+                      &decoded_y);
+  ExpectEqual(decoded_y, y);
+}
+
+TEST(TensorContainer, damaged) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  LoDTensor x;
+  FillTensor(&x, {4, 4}, 0.f);
+  std::stringstream ss;
+  TensorContainerWriter writer(&ss);
+  writer.Append("x", x, ctx);
+  writer.Finish();
+  std::string str = ss.str();
+
+  // the payload
+  std::string damaged = str;
+  damaged[kTensorContainerAlignment + 3] ^= 1;
+  std::stringstream damaged_ss(damaged);
+  TensorContainerReader reader(&damaged_ss);
+  LoDTensor out;
+  EXPECT_ANY_THROW(reader.Read("x", &out, ctx));
+
+  // the index
+  damaged = str;
+  damaged[damaged.size() - kTensorContainerFooterSize - 1] ^= 1;
+  EXPECT_ANY_THROW(
+      TensorContainerIndex::FromMemory(damaged.data(), damaged.size()));
+  // truncated
+  EXPECT_ANY_THROW(TensorContainerIndex::FromMemory(str.data(), 20));
+
+  // the version 1 format
+  std::stringstream v1;
+  SerializeToStream(v1, x, ctx);
+  EXPECT_FALSE(IsTensorContainer(&v1));
+}
+
+}  // namespace framework
+}  // namespace paddle
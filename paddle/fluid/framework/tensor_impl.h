@@ -46,6 +46,9 @@ inline T* Tensor::data() {
   PADDLE_ENFORCE(
       valid, "Tensor holds the wrong type, it holds %s, but desires to be %s",
       DataTypeToString(type_), DataTypeToString(DataTypeTrait<T>::DataType()));
+  if (copy_on_write_) {
+    DetachCopyOnWrite();
+  }
   return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                               offset_);
 }
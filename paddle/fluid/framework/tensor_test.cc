@@ -15,6 +15,8 @@
 #include "paddle/fluid/framework/tensor.h"
 #include <gtest/gtest.h>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "paddle/fluid/platform/float16.h"
 
 namespace framework = paddle::framework;
@@ -180,6 +182,112 @@ TEST(Tensor, ShareDataWith) {
 #endif
 }
 
+TEST(Tensor, ShareDataCopyOnWrite) {
+  framework::Tensor src_tensor;
+  framework::Tensor dst_tensor;
+  const framework::Tensor& const_src = src_tensor;
+  const framework::Tensor& const_dst = dst_tensor;
+  int* src_ptr = src_tensor.mutable_data<int>(framework::make_ddim({2, 3}),
+                                              platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) src_ptr[i] = i;
+
+  dst_tensor.ShareDataCopyOnWrite(src_tensor);
+  ASSERT_TRUE(src_tensor.IsCopyOnWrite());
+  ASSERT_TRUE(dst_tensor.IsCopyOnWrite());
+  ASSERT_EQ(const_src.data<int>(), const_dst.data<int>());
+
+  // The modified tensor copies the memory block, the other one is intact.
+  int* dst_ptr = dst_tensor.mutable_data<int>(platform::CPUPlace());
+  ASSERT_NE(dst_ptr, src_ptr);
+  ASSERT_FALSE(dst_tensor.IsCopyOnWrite());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(dst_ptr[i], i);
+    dst_ptr[i] = -i;
+  }
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(const_src.data<int>()[i], i);
+
+  // The memory block is not copied if it is not shared any more.
+  ASSERT_TRUE(src_tensor.IsCopyOnWrite());
+  ASSERT_EQ(src_tensor.data<int>(), src_ptr);
+  ASSERT_FALSE(src_tensor.IsCopyOnWrite());
+}
+
+TEST(Tensor, ShareDataWithCopyOnWrite) {
+  framework::Tensor src_tensor;
+  framework::Tensor cow_tensor;
+  int* src_ptr = src_tensor.mutable_data<int>(framework::make_ddim({2, 3}),
+                                              platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) src_ptr[i] = i;
+  cow_tensor.ShareDataCopyOnWrite(src_tensor);
+
+  // The aliases of a copy-on-write tensor see the writes of each other, and
+  // the tensor it is copied on write from is intact.
+  framework::Tensor alias;
+  alias.ShareDataWith(cow_tensor);
+  ASSERT_FALSE(cow_tensor.IsCopyOnWrite());
+  ASSERT_FALSE(alias.IsCopyOnWrite());
+  alias.data<int>()[0] = -1;
+  const framework::Tensor& const_cow = cow_tensor;
+  const framework::Tensor& const_src = src_tensor;
+  EXPECT_EQ(const_cow.data<int>()[0], -1);
+  EXPECT_EQ(const_src.data<int>()[0], 0);
+}
+
+TEST(Tensor, DetachCopyOnWriteConcurrently) {
+  framework::Tensor src_tensor;
+  framework::Tensor dst_tensor;
+  int* src_ptr = src_tensor.mutable_data<int>(framework::make_ddim({1024}),
+                                              platform::CPUPlace());
+  for (int i = 0; i < 1024; ++i) src_ptr[i] = i;
+  dst_tensor.ShareDataCopyOnWrite(src_tensor);
+
+  std::vector<int*> ptrs(8, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < ptrs.size(); ++i) {
+    threads.emplace_back(
+        [&dst_tensor, &ptrs, i] { ptrs[i] = dst_tensor.data<int>(); });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // The memory block is copied once.
+  ASSERT_NE(ptrs[0], src_ptr);
+  for (auto* ptr : ptrs) ASSERT_EQ(ptr, ptrs[0]);
+  for (int i = 0; i < 1024; ++i) EXPECT_EQ(ptrs[0][i], i);
+}
+
+TEST(Tensor, ResetHolderCopyOnWrite) {
+  int buffer[6] = {0, 1, 2, 3, 4, 5};
+  framework::Tensor tensor;
+  tensor.Resize(framework::make_ddim({3, 2}));
+  tensor.ResetHolderCopyOnWrite(
+      std::make_shared<paddle::memory::Allocation>(buffer, sizeof(buffer),
+                                                   platform::CPUPlace()),
+      framework::proto::VarType::INT32);
+  const framework::Tensor& const_tensor = tensor;
+  ASSERT_EQ(const_tensor.data<int>(), buffer);
+
+  // A slice or an inplace output of the borrowed memory never writes it.
+  framework::Tensor slice = tensor.Slice(1, 3);
+  ASSERT_TRUE(slice.IsCopyOnWrite());
+  int* slice_ptr = slice.mutable_data<int>(platform::CPUPlace());
+  ASSERT_NE(slice_ptr, buffer + 2);
+  slice_ptr[0] = -2;
+  framework::Tensor inplace;
+  inplace.ShareBufferWith(tensor);
+  inplace.Resize(tensor.dims());
+  inplace.mutable_data<int>(platform::CPUPlace())[0] = -1;
+  EXPECT_EQ(buffer[0], 0);
+  EXPECT_EQ(buffer[2], 2);
+
+  // The memory is copied even if no other tensor shares it.
+  slice = framework::Tensor();
+  inplace = framework::Tensor();
+  int* ptr = tensor.mutable_data<int>(platform::CPUPlace());
+  ASSERT_NE(ptr, buffer);
+  ASSERT_FALSE(tensor.IsCopyOnWrite());
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(ptr[i], i);
+}
+
 TEST(Tensor, Slice) {
   {
     framework::Tensor src_tensor;
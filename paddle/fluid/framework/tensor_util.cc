@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/tensor_util.h"
+#include <gflags/gflags.h>
 #include <algorithm>
 #include <limits>
 #include <memory>
@@ -21,9 +22,29 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DEFINE_bool(tensor_copy_on_write, false,
+            "Share the memory of the source tensor instead of copying it in "
+            "TensorCopy and TensorCopySync when the source and destination "
+            "are on the same place. The memory is copied when either of them "
+            "is modified.");
+
 namespace paddle {
 namespace framework {
 
+// Share the memory of src with dst instead of copying it, unless dst shares
+// its memory with others, e.g., dst is a slice of a tensor which the copy
+// must be written into.
+static bool TryShareCopyOnWrite(const Tensor& src,
+                                const platform::Place& dst_place, Tensor* dst) {
+  if (!FLAGS_tensor_copy_on_write || !(src.place() == dst_place) ||
+      (dst->IsInitialized() && dst->Holder().use_count() > 1)) {
+    return false;
+  }
+  VLOG(3) << "Share " << src.dims() << " copy-on-write at " << dst_place;
+  dst->ShareDataCopyOnWrite(src);
+  return true;
+}
+
 void TensorCopy(const Tensor& src, const platform::Place& dst_place,
                 const platform::DeviceContext& ctx, Tensor* dst) {
   if (&src == dst) {
@@ -35,6 +56,9 @@ void TensorCopy(const Tensor& src, const platform::Place& dst_place,
   VLOG(3) << "TensorCopy " << src.dims() << " from " << src.place() << " to "
           << dst_place;
   src.check_memory_size();
+  if (TryShareCopyOnWrite(src, dst_place, dst)) {
+    return;
+  }
 
   dst->Resize(src.dims());
   dst->set_layout(src.layout());
@@ -130,6 +154,9 @@ void TensorCopySync(const Tensor& src, const platform::Place& dst_place,
   VLOG(3) << "TensorCopySync " << src.dims() << " from " << src.place()
           << " to " << dst_place;
   src.check_memory_size();
+  if (TryShareCopyOnWrite(src, dst_place, dst)) {
+    return;
+  }
   dst->Resize(src.dims());
   dst->set_layout(src.layout());
   auto src_place = src.place();
@@ -559,40 +586,30 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
   }
 }
 
-// get tensor data point by DLDataType
-void* GetDstPtrByDLDataType(DLDataType type, framework::Tensor* dst,
-                            const platform::Place& dst_place) {
+// get the data type of tensor by DLDataType
+static proto::VarType::Type GetVarTypeByDLDataType(DLDataType type) {
   // vector types not currently supported
   PADDLE_ENFORCE_LE(type.lanes, 1, "vector types not currently supported");
 
   switch (type.bits) {
     case 8:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int8_t>(dst_place));
-      if (type.code == kDLUInt)
-        return static_cast<void*>(dst->mutable_data<uint8_t>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT8;
+      if (type.code == kDLUInt) return proto::VarType::UINT8;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     case 16:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int16_t>(dst_place));
-      if (type.code == kDLFloat)
-        return static_cast<void*>(
-            dst->mutable_data<paddle::platform::float16>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT16;
+      if (type.code == kDLFloat) return proto::VarType::FP16;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     case 32:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int32_t>(dst_place));
-      if (type.code == kDLFloat)
-        return static_cast<void*>(dst->mutable_data<float>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT32;
+      if (type.code == kDLFloat) return proto::VarType::FP32;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     case 64:
-      if (type.code == kDLInt)
-        return static_cast<void*>(dst->mutable_data<int64_t>(dst_place));
-      if (type.code == kDLFloat)
-        return static_cast<void*>(dst->mutable_data<double>(dst_place));
+      if (type.code == kDLInt) return proto::VarType::INT64;
+      if (type.code == kDLFloat) return proto::VarType::FP64;
       PADDLE_THROW("There is no this type.code <%d> when type.bits is <%d>.",
                    type.code, type.bits);
     default:
@@ -600,10 +617,42 @@ void* GetDstPtrByDLDataType(DLDataType type, framework::Tensor* dst,
   }
 }
 
-void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst) {
-  platform::CPUPlace dst_place = platform::CPUPlace();
-  platform::CPUPlace src_place = platform::CPUPlace();
+static platform::Place GetPlaceByDLContext(const ::DLContext& ctx) {
+  if (ctx.device_type == kDLCPU) {
+    return platform::CPUPlace();
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (ctx.device_type == kDLGPU) {
+    return platform::CUDAPlace(ctx.device_id);
+  }
+#endif
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The DLPack tensor on the device type %d is not supported.",
+      ctx.device_type));
+}
+
+// The memory of a DLManagedTensor, which is released by the deleter of its
+// producer when the last tensor sharing it is destroyed.
+class DLPackAllocation : public memory::Allocation {
+ public:
+  DLPackAllocation(::DLManagedTensor* dl_managed_tensor, size_t size,
+                   const platform::Place& place)
+      : Allocation(static_cast<char*>(dl_managed_tensor->dl_tensor.data) +
+                       dl_managed_tensor->dl_tensor.byte_offset,
+                   size, place),
+        dl_managed_tensor_(dl_managed_tensor) {}
+
+  ~DLPackAllocation() {
+    if (dl_managed_tensor_->deleter) {
+      dl_managed_tensor_->deleter(dl_managed_tensor_);
+    }
+  }
+
+ private:
+  ::DLManagedTensor* dl_managed_tensor_;
+};
 
+void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst) {
   std::vector<int64_t> vec;
   std::copy(dl_tensor.shape, dl_tensor.shape + dl_tensor.ndim,
             std::back_inserter(vec));
@@ -612,29 +661,58 @@ void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst) {
 
   dst->Resize(vddim);
   ::DLDataType type = dl_tensor.dtype;
-  void* dst_ptr = GetDstPtrByDLDataType(type, dst, dst_place);
+  auto var_type = GetVarTypeByDLDataType(type);
+  auto place = GetPlaceByDLContext(dl_tensor.ctx);
+  void* dst_ptr = dst->mutable_data(place, var_type);
 
-  auto src_ptr = static_cast<const void*>(dl_tensor.data);
+  auto src_ptr = static_cast<const char*>(dl_tensor.data) +
+                 dl_tensor.byte_offset;
   auto size = paddle::framework::product(vddim) * type.bits / 8;
 
-  if (dl_tensor.ctx.device_type == kDLCPU) {
-    memory::Copy(dst_place, dst_ptr, src_place, src_ptr, size);
+  if (platform::is_cpu_place(place)) {
+    memory::Copy(boost::get<platform::CPUPlace>(place), dst_ptr,
+                 boost::get<platform::CPUPlace>(place), src_ptr, size);
   }
 #ifdef PADDLE_WITH_CUDA
-  if (dl_tensor.ctx.device_type == kDLGPU) {
-    platform::CUDAPlace dst_place =
-        platform::CUDAPlace(dl_tensor.ctx.device_id);
-    platform::CUDAPlace src_place =
-        platform::CUDAPlace(dl_tensor.ctx.device_id);
-    dst_ptr = GetDstPtrByDLDataType(type, dst, dst_place);
-    auto* ctx = platform::DeviceContextPool::Instance().GetByPlace(dst_place);
-    memory::Copy(
-        dst_place, dst_ptr, src_place, src_ptr, size,
-        reinterpret_cast<const platform::CUDADeviceContext&>(*ctx).stream());
+  if (platform::is_gpu_place(place)) {
+    auto gpu_place = boost::get<platform::CUDAPlace>(place);
+    auto* ctx = platform::DeviceContextPool::Instance().GetByPlace(gpu_place);
+    memory::Copy(gpu_place, dst_ptr, gpu_place, src_ptr, size,
+                 reinterpret_cast<const platform::CUDADeviceContext&>(*ctx)
+                     .stream());
   }
 #endif
 }
 
+void TensorFromDLPack(::DLManagedTensor* dl_managed_tensor,
+                      framework::Tensor* dst) {
+  const auto& dl_tensor = dl_managed_tensor->dl_tensor;
+  std::vector<int64_t> vec;
+  std::copy(dl_tensor.shape, dl_tensor.shape + dl_tensor.ndim,
+            std::back_inserter(vec));
+  framework::DDim vddim = framework::make_ddim(vec);
+
+  proto::VarType::Type var_type;
+  platform::Place place;
+  try {
+    var_type = GetVarTypeByDLDataType(dl_tensor.dtype);
+    place = GetPlaceByDLContext(dl_tensor.ctx);
+  } catch (...) {
+    // the tensor is consumed even if it can not be imported
+    if (dl_managed_tensor->deleter) {
+      dl_managed_tensor->deleter(dl_managed_tensor);
+    }
+    throw;
+  }
+  size_t size = framework::product(vddim) * dl_tensor.dtype.bits / 8;
+  auto allocation =
+      std::make_shared<DLPackAllocation>(dl_managed_tensor, size, place);
+
+  dst->clear();
+  dst->Resize(vddim);
+  dst->ResetHolderWithType(allocation, var_type);
+}
+
 template <typename T>
 std::ostream& print_tensor(std::ostream& os, const framework::Tensor& tensor) {
   auto inspect = tensor.data<T>();
@@ -79,6 +79,19 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
 // convert dlpack's DLTensor to tensor
 void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst);
 
+// Share the memory of dlpack's DLManagedTensor with tensor without copying,
+// on CPU and GPU. The tensor takes the ownership of dl_managed_tensor, whose
+// deleter is called when the last tensor sharing the memory is destroyed,
+// or at once if it can not be imported. The data is taken as compact in the
+// row-major order, the strides are ignored as TensorFromDLPack does.
+//
+// DLPack carries no stream, the memory is used on the stream of the device
+// context of Paddle without any synchronization, so the producer must have
+// finished writing it, e.g. by synchronizing its own stream, before handing
+// it over.
+void TensorFromDLPack(::DLManagedTensor* dl_managed_tensor,
+                      framework::Tensor* dst);
+
 //
 // The implementation of template functions.
 //
@@ -308,6 +308,55 @@ TEST(TensorFromDLPack, Tensor) {
 #endif
 }
 
+TEST(TensorFromDLPack, ZeroCopy) {
+  std::vector<int> src_vec = {1, 2, 3, 4, 5, 6};
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext cpu_ctx(cpu_place);
+  paddle::framework::Tensor dst_tensor;
+  const int* src_ptr = nullptr;
+  {
+    paddle::framework::Tensor cpu_tensor;
+    paddle::framework::TensorFromVector<int>(src_vec, cpu_ctx, &cpu_tensor);
+    cpu_tensor.Resize(paddle::framework::make_ddim({2, 3}));
+    src_ptr = cpu_tensor.data<int>();
+    paddle::framework::DLPackTensor dlpack_tensor(cpu_tensor, 1);
+    // the exported tensor keeps the memory alive after cpu_tensor is gone
+    paddle::framework::TensorFromDLPack(
+        dlpack_tensor.ToCudfCompatibleDLManagedTensor(), &dst_tensor);
+  }
+  EXPECT_EQ(dst_tensor.data<int>(), src_ptr);
+  EXPECT_EQ(dst_tensor.dims(), paddle::framework::make_ddim({2, 3}));
+  EXPECT_EQ(dst_tensor.type(), proto::VarType::INT32);
+  for (size_t i = 0; i < 6; ++i) {
+    EXPECT_EQ(dst_tensor.data<int>()[i], src_vec[i]);
+  }
+
+  // the deleter is called when the last tensor sharing the memory is gone
+  static int deleted = 0;
+  std::vector<int64_t> shape = {3};
+  auto* dmt = new DLManagedTensor;
+  dmt->dl_tensor.data = src_vec.data();
+  dmt->dl_tensor.ctx = {kDLCPU, 0};
+  dmt->dl_tensor.ndim = 1;
+  dmt->dl_tensor.dtype = {kDLInt, 32, 1};
+  dmt->dl_tensor.shape = shape.data();
+  dmt->dl_tensor.strides = nullptr;
+  dmt->dl_tensor.byte_offset = 3 * sizeof(int);
+  dmt->manager_ctx = nullptr;
+  dmt->deleter = [](DLManagedTensor* arg) {
+    ++deleted;
+    delete arg;
+  };
+  paddle::framework::Tensor shared_tensor;
+  paddle::framework::TensorFromDLPack(dmt, &dst_tensor);
+  shared_tensor.ShareDataWith(dst_tensor);
+  EXPECT_EQ(shared_tensor.data<int>(), src_vec.data() + 3);
+  dst_tensor.clear();
+  EXPECT_EQ(deleted, 0);
+  shared_tensor.clear();
+  EXPECT_EQ(deleted, 1);
+}
+
 TEST(TensorContainsNAN, CPU) {
   {
     paddle::framework::Tensor src;
@@ -17,6 +17,7 @@
 #include <utility>
 
 #include "gflags/gflags.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/enforce.h"
 
 DEFINE_int32(io_threadpool_size, 100,
@@ -47,11 +48,26 @@ void ThreadPool::Init() {
   }
 }
 
-ThreadPool::ThreadPool(int num_threads) : running_(true) {
+// The pool and the index of the current thread, if it is a thread of a pool.
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local size_t current_queue_index = 0;
+
+ThreadPool::ThreadPool(int num_threads,
+                       std::function<void(size_t)> init_thread)
+    : running_(true) {
+  PADDLE_ENFORCE_GT(num_threads, 0,
+                    platform::errors::InvalidArgument(
+                        "The number of threads of ThreadPool must be larger "
+                        "than 0, but received %d.",
+                        num_threads));
+  queues_.resize(num_threads);
+  for (auto& queue : queues_) {
+    queue.reset(new TaskQueue());
+  }
   threads_.resize(num_threads);
-  for (auto& thread : threads_) {
-    // TODO(Yancey1989): binding the thread on the specify CPU number
-    thread.reset(new std::thread(std::bind(&ThreadPool::TaskLoop, this)));
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i].reset(new std::thread(
+        std::bind(&ThreadPool::TaskLoop, this, i, init_thread)));
   }
 }
 
@@ -69,29 +85,76 @@ ThreadPool::~ThreadPool() {
   }
 }
 
-void ThreadPool::TaskLoop() {
-  while (true) {
-    Task task;
+void ThreadPool::PushTask(Task task) {
+  size_t index = current_pool == this
+                     ? current_queue_index
+                     : next_queue_.fetch_add(1) % queues_.size();
+  {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (!running_) {
+      PADDLE_THROW("enqueue on stopped ThreadPool");
+    }
+    queue.tasks.push_back(std::move(task));
+  }
+  num_pending_tasks_.fetch_add(1);
 
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      scheduled_.wait(
-          lock, [this] { return !this->tasks_.empty() || !this->running_; });
+  // The sleeping threads check num_pending_tasks_ inside mutex_ before they
+  // wait, so that the notification cannot be lost.
+  if (num_idle_threads_ > 0) {
+    { std::lock_guard<std::mutex> guard(mutex_); }
+    scheduled_.notify_one();
+  }
+}
 
-      if (!running_ && tasks_.empty()) {
-        return;
-      }
+bool ThreadPool::PopTask(size_t index, Task* task) {
+  {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (!queue.tasks.empty()) {
+      *task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      num_pending_tasks_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    auto& queue = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (!queue.tasks.empty()) {
+      *task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      num_pending_tasks_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::TaskLoop(size_t index,
+                          std::function<void(size_t)> init_thread) {
+  current_pool = this;
+  current_queue_index = index;
+  if (init_thread) init_thread(index);
+  while (true) {
+    Task task;
+    if (PopTask(index, &task)) {
+      // run the task
+      task();
+      continue;
+    }
 
-      if (tasks_.empty()) {
-        PADDLE_THROW("This thread has no task to Run");
-      }
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++num_idle_threads_;
+    scheduled_.wait(lock, [this] {
+      return this->num_pending_tasks_ > 0 || !this->running_;
+    });
+    --num_idle_threads_;
 
-      // pop a task from the task queue
-      task = std::move(tasks_.front());
-      tasks_.pop();
+    if (!running_ && num_pending_tasks_ == 0) {
+      return;
     }
-    // run the task
-    task();
   }
 }
 
@@ -106,7 +169,9 @@ ThreadPool* ThreadPoolIO::GetInstanceIO() {
 void ThreadPoolIO::InitIO() {
   if (io_threadpool_.get() == nullptr) {
     // TODO(typhoonzero1986): make this configurable
-    io_threadpool_.reset(new ThreadPool(FLAGS_io_threadpool_size));
+    io_threadpool_.reset(new ThreadPool(FLAGS_io_threadpool_size, [](size_t i) {
+      platform::BindThreadToKind(platform::ThreadKind::kIO, i);
+    }));
   }
 }
 
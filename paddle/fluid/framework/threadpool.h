@@ -14,12 +14,13 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <functional>
 #include <future>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
-#include <queue>
 #include <thread>  // NOLINT
 #include <utility>
 #include <vector>
@@ -47,11 +48,20 @@ struct ExceptionHandler {
   }
 };
 
-// ThreadPool maintains a queue of tasks, and runs them using a fixed
-// number of threads.
+// ThreadPool runs tasks using a fixed number of threads. Each thread owns a
+// task queue, so that submitting and running tasks do not contend on a
+// single lock:
+//  - A task submitted by a thread of the pool goes to the queue of that
+//    thread, and other tasks are distributed to the queues round-robin.
+//  - A thread runs the tasks in its own queue in FIFO order, and steals the
+//    newest task from the other queues when its own queue is empty.
+//  - The threads sleep only when there is no pending task in any queue.
 class ThreadPool {
  public:
-  explicit ThreadPool(int num_threads);
+  // init_thread(i), if given, runs on the i-th thread before it runs tasks,
+  // e.g. to bind the thread to CPUs.
+  explicit ThreadPool(int num_threads,
+                      std::function<void(size_t)> init_thread = nullptr);
 
   using Task = std::packaged_task<std::unique_ptr<platform::EnforceNotMet>()>;
 
@@ -88,23 +98,27 @@ class ThreadPool {
       return nullptr;
     });
     std::future<std::unique_ptr<platform::EnforceNotMet>> f = task.get_future();
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      if (!running_) {
-        PADDLE_THROW("enqueue on stopped ThreadPool");
-      }
-      tasks_.push(std::move(task));
-    }
-    scheduled_.notify_one();
+    PushTask(std::move(task));
     return f;
   }
 
  private:
   DISABLE_COPY_AND_ASSIGN(ThreadPool);
 
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void PushTask(Task task);
+
+  // Pop a task from the queue of thread `index`, or steal one from the
+  // other queues. Returns false if all the queues are empty.
+  bool PopTask(size_t index, Task* task);
+
   // The constructor starts threads to run TaskLoop, which retrieves
-  // and runs tasks from the queue.
-  void TaskLoop();
+  // and runs tasks from the queues.
+  void TaskLoop(size_t index, std::function<void(size_t)> init_thread);
 
   // Init is called by GetInstance.
   static void Init();
@@ -114,11 +128,15 @@ class ThreadPool {
   static std::once_flag init_flag_;
 
   std::vector<std::unique_ptr<std::thread>> threads_;
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::atomic<size_t> next_queue_{0};
+  std::atomic<size_t> num_pending_tasks_{0};
+  std::atomic<bool> running_;
 
-  std::queue<Task> tasks_;
+  // Only used to put the idle threads to sleep and wake them up.
   std::mutex mutex_;
-  bool running_;
   std::condition_variable scheduled_;
+  std::atomic<size_t> num_idle_threads_{0};
 };
 
 class ThreadPoolIO : ThreadPool {
@@ -59,3 +59,34 @@ TEST(ThreadPool, ConcurrentRun) {
   }
   EXPECT_EQ(sum, ((n + 1) * n) / 2);
 }
+
+TEST(ThreadPool, NestedRun) {
+  framework::ThreadPool pool(2);
+  std::atomic<int> sum(0);
+  int n = 100;
+  // The sub-tasks are pushed to the queue of the running thread, and they
+  // are stolen by the other thread while the running thread waits.
+  auto future = pool.Run([&pool, &sum, n]() {
+    std::vector<std::future<void>> fs;
+    for (int i = 0; i < n; ++i) {
+      fs.push_back(pool.Run([&sum]() { sum.fetch_add(1); }));
+    }
+    for (auto& f : fs) {
+      f.wait();
+    }
+  });
+  future.wait();
+  EXPECT_EQ(sum, n);
+}
+
+TEST(ThreadPool, RunAllTasksBeforeDestruction) {
+  std::atomic<int> sum(0);
+  int n = 1000;
+  {
+    framework::ThreadPool pool(4);
+    for (int i = 0; i < n; ++i) {
+      pool.Run([&sum]() { sum.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(sum, n);
+}
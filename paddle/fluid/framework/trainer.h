@@ -19,6 +19,7 @@ limitations under the License. */
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/data_feed.h"
@@ -143,6 +144,8 @@ class PipelineTrainer : public TrainerBase {
   int pipeline_num_;
   int scope_queue_size_;
   int sync_steps_;
+  // The number of devices each pipeline occupies, i.e., max place_id + 1
+  int device_stride_;
 
   SectionWorkerParameter pipeline_config_;
 
@@ -171,6 +174,10 @@ class PipelineTrainer : public TrainerBase {
   std::vector<std::string> persistable_vars_;
   std::vector<std::unique_ptr<SyncFunctor>> sync_functors_;
   std::shared_ptr<platform::NCCLContextMap> nccl_ctx_map_;
+  // The place_id of the section which uses the parameter
+  std::unordered_map<std::string, int> param_place_ids_;
+  // The 1F1B schedule of each pipeline, empty in the Async mode
+  std::vector<std::unique_ptr<PipelineScheduler>> schedulers_;
 
   std::vector<DataFeed*> readers_;
 
@@ -179,6 +186,7 @@ class PipelineTrainer : public TrainerBase {
                            const Scope& root_scope);
   void CopyParameters(const Scope& root_scope, int pipeline_id);
   void construct_sync_functor();
+  void ReportPipelineStats();
 };
 #endif
 }  // namespace framework
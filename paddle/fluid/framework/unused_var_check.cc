@@ -54,6 +54,8 @@ const std::unordered_set<std::string> op_has_unsed_vars_white_list = {
     "fusion_seqpool_cvm_concat",       // 2
     "fused_batch_norm_act",            // 2
     "fused_batch_norm_act_grad",       // 2
+    "fused_bn_add_activation",         // 2
+    "fused_bn_add_activation_grad",    // 2
     "data_norm",                       // 0
     "data_norm_grad",                  // 0
 };
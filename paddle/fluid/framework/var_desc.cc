@@ -15,6 +15,7 @@ limitations under the License. */
 #include <google/protobuf/util/message_differencer.h>
 
 #include "paddle/fluid/framework/var_desc.h"
+#include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -22,8 +23,16 @@ namespace framework {
 
 proto::VarType::Type VarDesc::GetType() const { return desc_.type().type(); }
 
+void VarDesc::MarkUpdated() {
+  revision_ = NextDescRevision();
+  if (owner_.get() != nullptr) {
+    owner_.get()->SetRevision(revision_);
+  }
+}
+
 void VarDesc::SetType(proto::VarType::Type type) {
   desc_.mutable_type()->set_type(type);
+  MarkUpdated();
 }
 
 void VarDesc::SetShape(const std::vector<int64_t> &dims) {
@@ -31,6 +40,7 @@ void VarDesc::SetShape(const std::vector<int64_t> &dims) {
 }
 
 void VarDesc::SetTensorDescNum(size_t num) {
+  MarkUpdated();
   switch (desc_.type().type()) {
     case proto::VarType::READER: {
       auto *lod_tensors_ptr =
@@ -125,6 +135,7 @@ std::vector<proto::VarType::Type> VarDesc::GetDataTypes() const {
 }
 
 void VarDesc::SetLoDLevel(int32_t lod_level) {
+  MarkUpdated();
   switch (desc_.type().type()) {
     case proto::VarType::LOD_TENSOR:
       desc_.mutable_type()->mutable_lod_tensor()->set_lod_level(lod_level);
@@ -148,6 +159,7 @@ void VarDesc::SetLoDLevels(const std::vector<int32_t> &multiple_lod_level) {
             << "). The Reader is going to be reinitialized.";
     SetTensorDescNum(multiple_lod_level.size());
   }
+  MarkUpdated();
   switch (desc_.type().type()) {
     case proto::VarType::READER: {
       size_t i = 0;
@@ -229,6 +241,7 @@ std::vector<proto::VarType::TensorDesc> VarDesc::tensor_descs() const {
 }
 
 proto::VarType::TensorDesc *VarDesc::mutable_tensor_desc() {
+  MarkUpdated();
   PADDLE_ENFORCE(desc_.has_type(), "The var type hasn't been set.");
   PADDLE_ENFORCE(desc_.type().has_type(), "The var type hasn't been set.");
   switch (desc_.type().type()) {
@@ -247,6 +260,7 @@ proto::VarType::TensorDesc *VarDesc::mutable_tensor_desc() {
 }
 
 std::vector<proto::VarType::TensorDesc *> VarDesc::mutable_tensor_descs() {
+  MarkUpdated();
   PADDLE_ENFORCE(desc_.has_type(), "The var type hasn't been set.");
   PADDLE_ENFORCE(desc_.type().has_type(), "The var type hasn't been set.");
   std::vector<proto::VarType::TensorDesc *> res;
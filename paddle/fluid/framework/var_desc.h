@@ -19,6 +19,7 @@ limitations under the License. */
 #include <vector>
 #include "glog/logging.h"
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/proto_desc.h"
 
 namespace paddle {
 namespace framework {
@@ -71,7 +72,10 @@ class VarDesc {
 
   std::string Name() const { return desc_.name(); }
 
-  void SetName(std::string name) { desc_.set_name(name); }
+  void SetName(std::string name) {
+    desc_.set_name(name);
+    MarkUpdated();
+  }
 
   void SetTensorDescNum(size_t num);
 
@@ -108,21 +112,36 @@ class VarDesc {
 
   bool Persistable() const { return desc_.persistable(); }
 
-  void SetPersistable(bool persistable) { desc_.set_persistable(persistable); }
+  void SetPersistable(bool persistable) {
+    desc_.set_persistable(persistable);
+    MarkUpdated();
+  }
 
   bool NeedCheckFeed() const { return desc_.need_check_feed(); }
 
   void SetNeedCheckFeed(bool need_check_feed) {
     desc_.set_need_check_feed(need_check_feed);
+    MarkUpdated();
   }
 
+  // Changed by the setters, see NextDescRevision. The changes through the
+  // mutable Proto() are not counted.
+  uint64_t Revision() const { return revision_; }
+
  private:
   const proto::VarType::TensorDesc &tensor_desc() const;
   std::vector<proto::VarType::TensorDesc> tensor_descs() const;
   proto::VarType::TensorDesc *mutable_tensor_desc();
   std::vector<proto::VarType::TensorDesc *> mutable_tensor_descs();
 
+  // Take a new revision and pass it to the owner block.
+  void MarkUpdated();
+
   proto::VarDesc desc_;
+  uint64_t revision_ = NextDescRevision();
+  DescOwner owner_;
+
+  friend class BlockDesc;
 };
 
 bool operator==(const VarDesc &left, const VarDesc &right);
@@ -13,6 +13,8 @@
 // limitations under the License.
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -53,9 +55,15 @@ class Variable {
               "The Variable type must be %s, but the type it holds is %s.",
               ToTypeName(VarTypeTrait<T>::kId), ToTypeName(holder_->Type())));
     }
+    holder_->BumpVersion();
     return static_cast<T*>(holder_->Ptr());
   }
 
+  // The version of the content, which is increased whenever the content may
+  // be modified, i.e., GetMutable is called. It is 0 if the variable is not
+  // initialized.
+  uint64_t Version() const { return holder_ ? holder_->Version() : 0; }
+
   template <typename T>
   bool IsType() const {
     return holder_ && holder_->Type() == VarTypeTrait<T>::kId;
@@ -77,6 +85,13 @@ class Variable {
     inline const void* Ptr() const { return ptr_; }
     inline void* Ptr() { return ptr_; }
 
+    inline uint64_t Version() const {
+      return version_.load(std::memory_order_relaxed);
+    }
+    inline void BumpVersion() {
+      version_.fetch_add(1, std::memory_order_relaxed);
+    }
+
    protected:
     inline void Init(void* p, int type) {
       ptr_ = p;
@@ -85,6 +100,7 @@ class Variable {
 
     void* ptr_;
     int type_;
+    std::atomic<uint64_t> version_{0};
   };
 
   // Placeholder hides type T, so it doesn't appear as a template
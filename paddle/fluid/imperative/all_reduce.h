@@ -31,6 +31,9 @@ namespace imperative {
 void AllReduce(const framework::Variable &src, framework::Variable *dst,
                const ParallelStrategy &strategy);
 
+void AllReduce(const framework::Variable &src, framework::Variable *dst,
+               const ParallelStrategy &strategy, cudaStream_t stream);
+
 }  // namespace imperative
 }  // namespace paddle
 
@@ -26,6 +26,15 @@ struct BackwardStrategy {
    * gradient, another is sum gradient once they are created */
   // TODO(jiabin): add more Strategy when we support
   bool sorted_sum_gradient_{false};
+  /* The number of threads running the independent grad ops, e.g. the
+   * branches of several heads sharing a trunk, concurrently. The ops of a
+   * grad node run in order, and a node runs once all the nodes writing its
+   * inputs are done. 1 runs the ops in the calling thread. */
+  size_t num_threads_{1};
+  /* Release the gradients of the non-leaf variables once all the grad ops
+   * reading them are done, instead of keeping them in the variables until
+   * the variables are deleted. */
+  bool release_intermediate_grads_{false};
 };
 
 }  // namespace detail
@@ -15,6 +15,10 @@
 #include "paddle/fluid/imperative/basic_engine.h"
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 #include <sstream>
@@ -26,6 +30,7 @@
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/op_base.h"
+#include "paddle/fluid/imperative/profiler.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/profiler.h"
@@ -33,7 +38,36 @@
 namespace paddle {
 namespace imperative {
 
+static std::mutex& BackwardBeginHooksMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::map<size_t, std::function<void()>>& BackwardBeginHooks() {
+  static std::map<size_t, std::function<void()>> hooks;
+  return hooks;
+}
+
+size_t BasicEngine::AddBackwardBeginHook(std::function<void()> hook) {
+  static size_t next_id = 0;
+  std::lock_guard<std::mutex> guard(BackwardBeginHooksMutex());
+  BackwardBeginHooks().emplace(next_id, std::move(hook));
+  return next_id++;
+}
+
+void BasicEngine::RemoveBackwardBeginHook(size_t id) {
+  std::lock_guard<std::mutex> guard(BackwardBeginHooksMutex());
+  BackwardBeginHooks().erase(id);
+}
+
 void BasicEngine::Init(VarBase* var, const detail::BackwardStrategy& strategy) {
+  {
+    std::lock_guard<std::mutex> guard(BackwardBeginHooksMutex());
+    for (auto& hook : BackwardBeginHooks()) {
+      hook.second();
+    }
+  }
+
   backward_strategy_ = strategy;
   init_node_ = var->GradVarBase()->GradNode();
   var->GradVarBase()->ClearGradNode();
@@ -119,6 +153,40 @@ void BasicEngine::PrepareGradAccumulators(const OpBase& op) {
   }
 }
 
+void BasicEngine::PrepareGradPendingReads(const OpBase& op) {
+  for (const auto& pair : op.GetInsMap()) {
+    if (!pair.second.IsGrad()) {
+      continue;
+    }
+
+    for (const auto& var : pair.second) {
+      if (var) ++grad_pending_reads_[var.get()];
+    }
+  }
+}
+
+void BasicEngine::ReleaseReadGrads(const OpBase& op) {
+  for (const auto& pair : op.GetInsMap()) {
+    if (!pair.second.IsGrad()) {
+      continue;
+    }
+
+    for (const auto& var : pair.second) {
+      if (!var) continue;
+      auto iter = grad_pending_reads_.find(var.get());
+      if (iter == grad_pending_reads_.end() || --(iter->second) > 0) {
+        continue;
+      }
+      // Only the gradients computed by this backward are released, e.g. not
+      // the gradient of the loss, and the hooked ones are kept for the hooks.
+      if (accumulators_.count(var.get()) && !var->HasGradReadyHooks()) {
+        VLOG(6) << "Release the intermediate gradient " << var->Name();
+        var->MutableVar()->Clear();
+      }
+    }
+  }
+}
+
 void BasicEngine::PrepareDeps() {
   PADDLE_ENFORCE_EQ(
       node_deps_.empty(), true,
@@ -140,6 +208,9 @@ void BasicEngine::PrepareDeps() {
     for (auto& cur_op : *cur_node) {
       cur_op.EnforceHasInOut();
       PrepareGradAccumulators(cur_op);
+      if (backward_strategy_.release_intermediate_grads_) {
+        PrepareGradPendingReads(cur_op);
+      }
     }
 
     const auto& grad_pending_nodes = cur_node->GradPendingNodes();
@@ -156,12 +227,114 @@ void BasicEngine::PrepareDeps() {
   }
 }
 
-void BasicEngine::Execute() {
-  if (init_node_ == nullptr) {
-    return;
+void BasicEngine::RunGradOp(OpBase* op) {
+  auto& cur_op = *op;
+  // CheckBackWardInput
+  CheckBackwardInputs(cur_op);
+
+  // Step 1: Run Backward
+  auto& bwd_ins = cur_op.GetInsMap();
+  auto& bwd_outs = cur_op.GetOutsMap();
+
+  std::vector<std::pair<GradientAccumulator*, std::shared_ptr<VariableWrapper>>>
+      need_accu_var_list;
+  // the gradients with ready hooks written by the op
+  std::vector<VariableWrapper*> hooked_grad_vars;
+
+  NameVarMap<VariableWrapper> tmp_outs(bwd_outs);
+  // 1. construct the output map 2. replace the element in the map
+  // A var may be coresponding to several grad var in one op
+  for (auto& pair : tmp_outs) {
+    if (!pair.second.IsGrad()) {
+      continue;
+    }
+
+    for (auto& var : pair.second) {
+      if (!var) {
+        continue;
+      }
+
+      auto iter = accumulators_.find(var.get());
+      PADDLE_ENFORCE_EQ(
+          iter != accumulators_.end(), true,
+          platform::errors::NotFound("Cannot find gradient of variable %s",
+                                     var->Name()));
+
+      if (var->HasGradReadyHooks()) {
+        hooked_grad_vars.emplace_back(var.get());
+      }
+
+      if (!var->OverridedStopGradient() && iter->second->RefCnt() == 1) {
+        continue;
+      }
+
+      var = std::make_shared<VariableWrapper>(var->Name());
+      need_accu_var_list.emplace_back(iter->second.get(), var);
+    }
   }
 
-  PrepareDeps();
+  {
+    VLOG(3) << "Start to execute grad op " << cur_op.Type();
+    std::unique_lock<std::mutex> gpu_lock(gpu_mutex_, std::defer_lock);
+    if (backward_strategy_.num_threads_ > 1 &&
+        platform::is_gpu_place(cur_op.place())) {
+      gpu_lock.lock();
+    }
+    cur_op.CheckInplaceVersions();
+    std::unique_ptr<OpProfileEvent> profile_event;
+    if (OpProfiler::Instance().IsEnabled()) {
+      profile_event.reset(
+          new OpProfileEvent(cur_op.Type(), cur_op.ProfileScope(), true));
+    }
+    OpBase::Run(cur_op.InnerOp(), bwd_ins, tmp_outs, cur_op.Attrs(),
+                cur_op.place());
+    if (profile_event) {
+      profile_event->Finish(OutputBytes<VariableWrapper>(tmp_outs),
+                            cur_op.place());
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // Step 2: Sum Gradient
+    for (auto& pair : need_accu_var_list) {
+      pair.first->Add(std::move(pair.second), cur_op.id());
+    }
+
+    // Step 3: Call the hooks of the gradients accumulated completely
+    for (auto* var : hooked_grad_vars) {
+      if (++grad_ready_cnts_[var] == accumulators_[var]->RefCnt()) {
+        var->CallGradReadyHooks();
+      }
+    }
+
+    if (backward_strategy_.release_intermediate_grads_) {
+      ReleaseReadGrads(cur_op);
+    }
+  }
+
+  VLOG(3) << "Remove op after op " << cur_op.Type() << " runs";
+  cur_op.ClearBackwardTrace();
+}
+
+void BasicEngine::CollectReadyNodes(
+    const GradOpNode& node, std::queue<std::shared_ptr<GradOpNode>>* ready) {
+  for (auto& grad_pending_node : node.GradPendingNodes()) {
+    PADDLE_ENFORCE_NOT_NULL(grad_pending_node,
+                            platform::errors::NotFound(
+                                "Grad pending node should not be nullptr"));
+    auto iter = node_deps_.find(grad_pending_node.get());
+    if (iter == node_deps_.end()) {
+      continue;
+    }
+
+    if (--(iter->second) == 0) {
+      ready->push(grad_pending_node);
+    }
+  }
+}
+
+size_t BasicEngine::ExecuteSequential() {
   // Start execute Computation graph
   std::queue<std::shared_ptr<GradOpNode>> q;
   q.push(std::move(init_node_));
@@ -174,74 +347,78 @@ void BasicEngine::Execute() {
 
     for (auto& cur_op : *shared_cur_node) {
       ++op_num;
+      RunGradOp(&cur_op);
+    }
 
-      // CheckBackWardInput
-      CheckBackwardInputs(cur_op);
-
-      // Step 1: Run Backward
-      auto& bwd_ins = cur_op.GetInsMap();
-      auto& bwd_outs = cur_op.GetOutsMap();
-
-      NameVarMap<VariableWrapper> tmp_outs(bwd_outs);
-      // 1. construct the output map 2. replace the element in the map
-      // A var may be coresponding to several grad var in one op
-      for (auto& pair : tmp_outs) {
-        if (!pair.second.IsGrad()) {
-          continue;
-        }
+    // Step 4: Collect ready ops
+    CollectReadyNodes(*shared_cur_node, &q);
+  }
+  return op_num;
+}
 
-        for (auto& var : pair.second) {
-          if (!var) {
-            continue;
-          }
+size_t BasicEngine::ExecuteParallel() {
+  if (thread_pool_size_ != backward_strategy_.num_threads_) {
+    thread_pool_.reset(
+        new framework::ThreadPool(backward_strategy_.num_threads_));
+    thread_pool_size_ = backward_strategy_.num_threads_;
+  }
 
-          auto iter = accumulators_.find(var.get());
-          PADDLE_ENFORCE_EQ(
-              iter != accumulators_.end(), true,
-              platform::errors::NotFound("Cannot find gradient of variable %s",
-                                         var->Name()));
+  std::queue<std::shared_ptr<GradOpNode>> ready;
+  ready.push(std::move(init_node_));
 
-          if (!var->OverridedStopGradient() && iter->second->RefCnt() == 1) {
-            continue;
+  size_t op_num = 0;
+  size_t running = 0;
+  std::exception_ptr error;
+  std::condition_variable done;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    while (!ready.empty() && !error) {
+      auto node = std::move(ready.front());
+      ready.pop();
+      ++running;
+      op_num += node->size();
+      thread_pool_->Run([this, node, &ready, &running, &error, &done] {
+        std::exception_ptr node_error;
+        try {
+          for (auto& cur_op : *node) {
+            RunGradOp(&cur_op);
           }
-
-          var = std::make_shared<VariableWrapper>(var->Name());
-          need_accu_var_list_.emplace_back(iter->second.get(), var);
+        } catch (...) {
+          node_error = std::current_exception();
         }
-      }
 
-      {
-        VLOG(3) << "Start to execute grad op " << cur_op.Type();
-        OpBase::Run(cur_op.InnerOp(), bwd_ins, tmp_outs, cur_op.Attrs(),
-                    cur_op.place());
-      }
-
-      // Step 2: Sum Gradient
-      for (auto& pair : need_accu_var_list_) {
-        pair.first->Add(std::move(pair.second), cur_op.id());
-      }
-
-      need_accu_var_list_.clear();
-
-      VLOG(3) << "Remove op after op " << cur_op.Type() << " runs";
-      cur_op.ClearBackwardTrace();
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (node_error) {
+          if (!error) error = node_error;
+        } else {
+          // Step 4: Collect ready ops
+          CollectReadyNodes(*node, &ready);
+        }
+        --running;
+        done.notify_one();
+      });
     }
 
-    // Step 3: Collect ready ops
-    for (auto& grad_pending_node : shared_cur_node->GradPendingNodes()) {
-      PADDLE_ENFORCE_NOT_NULL(grad_pending_node,
-                              platform::errors::NotFound(
-                                  "Grad pending node should not be nullptr"));
-      auto iter = node_deps_.find(grad_pending_node.get());
-      if (iter == node_deps_.end()) {
-        continue;
-      }
+    if (running == 0) break;
+    done.wait(lock);
+  }
+  lock.unlock();
 
-      if (--(iter->second) == 0) {
-        q.push(grad_pending_node);
-      }
-    }
+  if (error) {
+    std::rethrow_exception(error);
   }
+  return op_num;
+}
+
+void BasicEngine::Execute() {
+  if (init_node_ == nullptr) {
+    return;
+  }
+
+  PrepareDeps();
+  size_t op_num = backward_strategy_.num_threads_ > 1 ? ExecuteParallel()
+                                                      : ExecuteSequential();
   Clear();
 
   VLOG(1) << "Backward op number: " << op_num;
@@ -251,7 +428,8 @@ void BasicEngine::Clear() {
   init_node_.reset();
   node_deps_.clear();
   accumulators_.clear();
-  need_accu_var_list_.clear();
+  grad_ready_cnts_.clear();
+  grad_pending_reads_.clear();
 }
 
 }  // namespace imperative
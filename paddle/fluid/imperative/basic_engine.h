@@ -14,10 +14,14 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <queue>
 #include <unordered_map>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/imperative/backward_strategy.h"
 #include "paddle/fluid/imperative/engine.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
@@ -34,6 +38,13 @@ class BasicEngine : public Engine {
 
   void Execute() override;
 
+  // Add a hook called at the beginning of each backward, e.g. to reset the
+  // gradients found ready by Reducer in the last backward. Return the id to
+  // remove it with.
+  static size_t AddBackwardBeginHook(std::function<void()> hook);
+
+  static void RemoveBackwardBeginHook(size_t id);
+
  private:
   void PrepareDeps();
 
@@ -41,6 +52,25 @@ class BasicEngine : public Engine {
 
   void PrepareGradAccumulators(const OpBase& op);
 
+  void PrepareGradPendingReads(const OpBase& op);
+
+  // Release the intermediate gradients read by all their grad ops.
+  void ReleaseReadGrads(const OpBase& op);
+
+  // Run a grad op, and accumulate its outputs into the gradients.
+  void RunGradOp(OpBase* op);
+
+  // Push the pending nodes of the node whose deps are all done.
+  void CollectReadyNodes(const GradOpNode& node,
+                         std::queue<std::shared_ptr<GradOpNode>>* ready);
+
+  // Return the number of the ops run.
+  size_t ExecuteSequential();
+
+  // Run the ready nodes concurrently on the thread pool, see
+  // BackwardStrategy::num_threads_.
+  size_t ExecuteParallel();
+
   void Clear();
 
  private:
@@ -49,8 +79,18 @@ class BasicEngine : public Engine {
   std::unordered_map<GradOpNode*, size_t> node_deps_;
   std::unordered_map<VariableWrapper*, std::unique_ptr<GradientAccumulator>>
       accumulators_;
-  std::vector<std::pair<GradientAccumulator*, std::shared_ptr<VariableWrapper>>>
-      need_accu_var_list_;
+  std::unordered_map<VariableWrapper*, size_t> grad_ready_cnts_;
+  // the number of the grad ops which have not read the gradient yet
+  std::unordered_map<VariableWrapper*, size_t> grad_pending_reads_;
+
+  // Guards the accumulators, the deps and the ready counts when the ops run
+  // in parallel.
+  std::mutex mutex_;
+  // The GPU kernels are launched by one thread at a time, since the device
+  // context of a place, e.g. its cuDNN handle and workspace, is shared.
+  std::mutex gpu_mutex_;
+  std::unique_ptr<framework::ThreadPool> thread_pool_;
+  size_t thread_pool_size_{0};
 };
 
 }  // namespace imperative
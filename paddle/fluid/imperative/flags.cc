@@ -18,6 +18,9 @@
 DEFINE_uint64(dygraph_debug, 0,
               "Debug level of dygraph. This flag is not "
               "open to users");
+DEFINE_bool(dygraph_cache_kernel, false,
+            "Whether to cache the kernels chosen for the dygraph ops, see "
+            "imperative::KernelCache.");
 
 namespace paddle {
 namespace imperative {
@@ -26,5 +29,7 @@ bool IsDebugEnabled() { return FLAGS_dygraph_debug != 0; }
 
 uint64_t GetDebugLevel() { return FLAGS_dygraph_debug; }
 
+bool IsKernelCacheEnabled() { return FLAGS_dygraph_cache_kernel; }
+
 }  // namespace imperative
 }  // namespace paddle
@@ -21,6 +21,7 @@ namespace imperative {
 
 extern bool IsDebugEnabled();
 extern uint64_t GetDebugLevel();
+extern bool IsKernelCacheEnabled();
 
 }  // namespace imperative
 }  // namespace paddle
@@ -172,6 +172,92 @@ void TensorAdd(const framework::Variable& src, framework::Variable* dst) {
       framework::DataTypeToString(data_type), place));
 }
 
+// The sum is done block by block in a local buffer, so dst may share the
+// memory with one of the srcs.
+template <typename T>
+static void CPUTensorsSum(const std::vector<const framework::LoDTensor*>& srcs,
+                          framework::LoDTensor* dst) {
+  constexpr int64_t kBlockSize = 1024;
+  std::vector<const T*> src_data;
+  src_data.reserve(srcs.size());
+  for (auto* src : srcs) {
+    src_data.emplace_back(src->data<T>());
+  }
+  auto* dst_data = dst->mutable_data<T>(platform::CPUPlace());
+  int64_t numel = dst->numel();
+  int64_t num_blocks = (numel + kBlockSize - 1) / kBlockSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t block = 0; block < num_blocks; ++block) {
+    int64_t begin = block * kBlockSize;
+    int64_t size = std::min(kBlockSize, numel - begin);
+    T sum[kBlockSize];
+    std::copy(src_data[0] + begin, src_data[0] + begin + size, sum);
+    for (size_t i = 1; i < src_data.size(); ++i) {
+      const T* src = src_data[i] + begin;
+      for (int64_t j = 0; j < size; ++j) {
+        sum[j] += src[j];
+      }
+    }
+    std::copy(sum, sum + size, dst_data + begin);
+  }
+}
+
+// Sum the dense gradients, each with whether it must be unchanged, into dst.
+// On the CPU, they are summed in one pass instead of reading and writing dst
+// once per gradient, and the sum is written to the memory of the first
+// gradient which can be changed, if any.
+static void TensorsSum(
+    const std::vector<std::pair<framework::Variable*, bool>>& srcs,
+    framework::Variable* dst) {
+  std::vector<const framework::LoDTensor*> tensors;
+  const framework::LoDTensor* buffer = nullptr;
+  for (auto& src : srcs) {
+    auto& tensor = src.first->Get<framework::LoDTensor>();
+    // see the FIXME in TensorAdd
+    if (tensor.numel() == 0) continue;
+    if (!tensors.empty()) {
+      PADDLE_ENFORCE_EQ(tensor.numel(), tensors[0]->numel(),
+                        platform::errors::InvalidArgument(
+                            "The gradients to sum have different numbers of "
+                            "elements, %d vs. %d.",
+                            tensor.numel(), tensors[0]->numel()));
+    }
+    tensors.emplace_back(&tensor);
+    if (!buffer && !src.second) {
+      buffer = &tensor;
+    }
+  }
+
+  auto data_type = srcs[0].first->Get<framework::LoDTensor>().type();
+  if (tensors.size() < 2 || !platform::is_cpu_place(tensors[0]->place()) ||
+      (data_type != framework::proto::VarType::FP32 &&
+       data_type != framework::proto::VarType::FP64)) {
+    MoveOrCopyVar(dst, srcs[0].first, srcs[0].second);
+    for (size_t i = 1; i < srcs.size(); ++i) {
+      TensorAdd(*srcs[i].first, dst);
+    }
+    return;
+  }
+
+  if (!dst->IsType<framework::LoDTensor>()) {
+    dst->Clear();
+  }
+  auto* dst_tensor = dst->GetMutable<framework::LoDTensor>();
+  if (buffer) {
+    dst_tensor->ShareDataWith(*buffer);
+  } else {
+    dst_tensor->Resize(tensors[0]->dims());
+  }
+  dst_tensor->set_lod(tensors[0]->lod());
+  if (data_type == framework::proto::VarType::FP32) {
+    CPUTensorsSum<float>(tensors, dst_tensor);
+  } else {
+    CPUTensorsSum<double>(tensors, dst_tensor);
+  }
+}
+
 void SelectedRowsAddToTensor(const framework::Variable& src,
                              framework::Variable* dst) {
   auto* dst_tensor = dst->GetMutable<framework::LoDTensor>();
@@ -256,16 +342,11 @@ static void SelectedRowsAddTensor(
 //   adding one to another is not equal to merging two selected rows
 //   to one then add it to a empty selected rows, the after is correct
 std::shared_ptr<VariableWrapper> SelectedRowsMerge(
-    const framework::Variable& src1, const framework::Variable& src2) {
-  auto& src_selected_rows1 = src1.Get<framework::SelectedRows>();
-  auto& src_selected_rows2 = src2.Get<framework::SelectedRows>();
-  auto place = src_selected_rows1.value().place();
-  auto data_type = src_selected_rows1.value().type();
+    const std::vector<const framework::SelectedRows*>& src_selected_rows) {
+  auto place = src_selected_rows[0]->value().place();
+  auto data_type = src_selected_rows[0]->value().type();
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
 
-  std::vector<const framework::SelectedRows*> src_selected_rows;
-  src_selected_rows.emplace_back(&src_selected_rows1);
-  src_selected_rows.emplace_back(&src_selected_rows2);
   auto dst_var = std::make_shared<VariableWrapper>("Temp");
   auto* dst_selected_rows =
       dst_var->MutableVar()->GetMutable<framework::SelectedRows>();
@@ -325,7 +406,9 @@ void VariableWrapperAdd(std::shared_ptr<VariableWrapper> var,
         *dst = std::move(*(var->MutableVar()));
       }
     } else if (src.IsType<framework::SelectedRows>()) {
-      auto temp = SelectedRowsMerge(src, *dst);
+      auto temp =
+          SelectedRowsMerge({&src.Get<framework::SelectedRows>(),
+                             &dst->Get<framework::SelectedRows>()});
       *dst = std::move(*(temp->MutableVar()));
     } else {
       PADDLE_THROW(platform::errors::InvalidArgument(
@@ -397,6 +480,40 @@ void EagerGradientAccumulator::Add(std::shared_ptr<VariableWrapper> var,
   }
 }
 
+// The dense gradients are summed first, then the selected rows are added to
+// the sum directly. If all the gradients are selected rows, they are merged
+// at once instead of one by one.
+void SortedGradientAccumulator::SumTmpGradVars(framework::Variable* dst_var) {
+  std::vector<std::pair<framework::Variable*, bool>> dense_vars;
+  std::vector<const framework::Variable*> selected_rows_vars;
+  for (auto& var_info : tmp_grad_vars_) {
+    auto* var = var_info.var->MutableVar();
+    if (var->IsType<framework::SelectedRows>()) {
+      selected_rows_vars.emplace_back(var);
+    } else {
+      PADDLE_ENFORCE_EQ(var->IsType<framework::LoDTensor>(), true,
+                        platform::errors::PermissionDenied(
+                            "Gradient var must be LoDTensor"));
+      dense_vars.emplace_back(var, var_info.unchange_input);
+    }
+  }
+
+  if (dense_vars.empty()) {
+    std::vector<const framework::SelectedRows*> selected_rows;
+    for (auto* var : selected_rows_vars) {
+      selected_rows.emplace_back(&var->Get<framework::SelectedRows>());
+    }
+    auto merged = SelectedRowsMerge(selected_rows);
+    *dst_var = std::move(*(merged->MutableVar()));
+    return;
+  }
+
+  TensorsSum(dense_vars, dst_var);
+  for (auto* var : selected_rows_vars) {
+    SelectedRowsAddToTensor(*var, dst_var);
+  }
+}
+
 void SortedGradientAccumulator::Add(std::shared_ptr<VariableWrapper> var,
                                     size_t trace_id, bool unchange_input) {
   auto* dst_var = var_->MutableVar();
@@ -427,57 +544,7 @@ void SortedGradientAccumulator::Add(std::shared_ptr<VariableWrapper> var,
         }
       }
 
-#ifdef PADDLE_WITH_CUDA
-      if (paddle::platform::is_gpu_place(place)) {
-        bool dst_varbase_is_initialized = false;
-        // accumulate selected rows firstly
-        for (auto& var_info : tmp_grad_vars_) {
-          if (!var_info.var->Var().IsType<framework::SelectedRows>()) {
-            continue;
-          }
-
-          if (!dst_varbase_is_initialized) {
-            dst_varbase_is_initialized = true;
-            MoveOrCopyVar(dst_var, var_info.var->MutableVar(),
-                          var_info.unchange_input);
-          } else {
-            VariableWrapperAdd(var_info.var, var_, var_info.unchange_input);
-          }
-
-          var_info.var = nullptr;
-        }
-
-        for (auto& var_info : tmp_grad_vars_) {
-          if (!var_info.var) {
-            continue;
-          }
-
-          PADDLE_ENFORCE_EQ(var_info.var->Var().IsType<framework::LoDTensor>(),
-                            true, platform::errors::PermissionDenied(
-                                      "Gradient var must be LoDTensor"));
-
-          if (!dst_varbase_is_initialized) {
-            dst_varbase_is_initialized = true;
-            MoveOrCopyVar(dst_var, var_info.var->MutableVar(),
-                          var_info.unchange_input);
-          } else {
-            VariableWrapperAdd(var_info.var, var_, var_info.unchange_input);
-          }
-
-          var_info.var = nullptr;
-        }
-      } else {
-#endif
-        MoveOrCopyVar(dst_var, tmp_grad_vars_[0].var->MutableVar(),
-                      tmp_grad_vars_[0].unchange_input);
-        for (size_t i = 1; i < tmp_grad_vars_.size(); ++i) {
-          VariableWrapperAdd(tmp_grad_vars_[i].var, var_,
-                             tmp_grad_vars_[i].unchange_input);
-          tmp_grad_vars_[i].var = nullptr;
-        }
-#ifdef PADDLE_WITH_CUDA
-      }
-#endif
+      SumTmpGradVars(dst_var);
       tmp_grad_vars_.clear();
     }
   } else {
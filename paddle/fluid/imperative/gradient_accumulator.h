@@ -71,6 +71,8 @@ class SortedGradientAccumulator : public GradientAccumulator {
     bool unchange_input;
   };
 
+  void SumTmpGradVars(framework::Variable* dst_var);
+
   std::vector<SavedVarInfo> tmp_grad_vars_;
 };
 
@@ -0,0 +1,141 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/imperative/jit/traced_program_cache.h"
+#include <sstream>
+#include <utility>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/imperative/tracer.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+TracedProgramCache::TracedProgramCache(const platform::Place &place,
+                                       const std::vector<std::string> &passes)
+    : place_(place), passes_(passes) {}
+
+std::string TracedProgramCache::Signature(
+    const std::vector<std::shared_ptr<VarBase>> &inputs) {
+  std::stringstream ss;
+  for (auto &input : inputs) {
+    auto &tensor = input->Var().Get<framework::LoDTensor>();
+    PADDLE_ENFORCE_EQ(tensor.IsInitialized(), true,
+                      platform::errors::InvalidArgument(
+                          "The input %s of the traced program is not "
+                          "initialized.",
+                          input->Name()));
+    ss << framework::DataTypeToString(tensor.type()) << "[" << tensor.dims()
+       << "]" << tensor.lod().size() << ";";
+  }
+  return ss.str();
+}
+
+std::unique_ptr<framework::ProgramDesc> TracedProgramCache::ApplyPasses(
+    const framework::ProgramDesc &program) const {
+  std::unique_ptr<framework::ProgramDesc> optimized(
+      new framework::ProgramDesc(program));
+  if (passes_.empty()) return optimized;
+
+  std::unique_ptr<framework::ir::Graph> graph(
+      new framework::ir::Graph(program));
+  for (auto &pass_name : passes_) {
+    VLOG(3) << "Applies " << pass_name << " to the traced program.";
+    auto pass = framework::ir::PassRegistry::Instance().Get(pass_name);
+    graph.reset(pass->Apply(graph.release()));
+  }
+  auto to_program =
+      framework::ir::PassRegistry::Instance().Get("graph_to_program_pass");
+  optimized.reset(new framework::ProgramDesc());
+  to_program->SetNotOwned("program", optimized.get());
+  graph.reset(to_program->Apply(graph.release()));
+  return optimized;
+}
+
+void TracedProgramCache::Insert(
+    const std::string &signature, const framework::ProgramDesc &program,
+    const std::vector<std::string> &feed_names,
+    const std::vector<std::string> &fetch_names,
+    const std::vector<std::shared_ptr<VarBase>> &persistable_vars) {
+  std::unique_ptr<TracedProgram> traced(new TracedProgram());
+  traced->program = ApplyPasses(program);
+  traced->feed_names = feed_names;
+  traced->fetch_names = fetch_names;
+  traced->persistable_vars = persistable_vars;
+  traced->scope.reset(new framework::Scope());
+  traced->executor.reset(new framework::NaiveExecutor(place_));
+  traced->executor->CreateVariables(*traced->program, 0, true,
+                                    traced->scope.get());
+  traced->executor->CreateVariables(*traced->program, 0, false,
+                                    traced->scope.get());
+  traced->executor->Prepare(traced->scope.get(), *traced->program, 0, false);
+  VLOG(3) << "Caches the traced program of the inputs " << signature;
+  programs_[signature] = std::move(traced);
+}
+
+std::vector<std::shared_ptr<VarBase>> TracedProgramCache::Run(
+    const std::string &signature,
+    const std::vector<std::shared_ptr<VarBase>> &inputs) {
+  auto it = programs_.find(signature);
+  PADDLE_ENFORCE_NE(it, programs_.end(),
+                    platform::errors::NotFound(
+                        "No traced program of the inputs %s.", signature));
+  auto &traced = *it->second;
+  PADDLE_ENFORCE_EQ(inputs.size(), traced.feed_names.size(),
+                    platform::errors::InvalidArgument(
+                        "The traced program takes %d inputs, but received "
+                        "%d.",
+                        traced.feed_names.size(), inputs.size()));
+
+  // the parameters may have been reallocated by the optimizer
+  for (auto &var : traced.persistable_vars) {
+    auto *tensor = traced.scope->Var(var->Name())
+                       ->GetMutable<framework::LoDTensor>();
+    tensor->ShareDataWith(var->Var().Get<framework::LoDTensor>());
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto &src = inputs[i]->Var().Get<framework::LoDTensor>();
+    auto *tensor = traced.executor->FindTensor(traced.feed_names[i]);
+    tensor->ShareDataWith(src);
+    tensor->set_lod(src.lod());
+  }
+
+  traced.executor->Run();
+
+  // The outputs take the memory of the fetched tensors, which are allocated
+  // again by the next run, so the outputs are not overwritten.
+  std::vector<std::shared_ptr<VarBase>> outputs;
+  outputs.reserve(traced.fetch_names.size());
+  auto &tracer = GetCurrentTracer();
+  for (auto &name : traced.fetch_names) {
+    auto *src = traced.executor->FindTensor(name);
+    auto out = std::make_shared<VarBase>(
+        false, tracer ? tracer->GenerateUniqueName("traced_out") : name);
+    out->SetType(framework::proto::VarType::LOD_TENSOR);
+    out->SetDataType(src->type());
+    auto *dst = out->MutableVar()->GetMutable<framework::LoDTensor>();
+    dst->ShareDataWith(*src);
+    dst->set_lod(src->lod());
+    src->clear();
+    outputs.emplace_back(std::move(out));
+  }
+  return outputs;
+}
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
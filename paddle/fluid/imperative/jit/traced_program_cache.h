@@ -0,0 +1,92 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+/*
+ * The programs traced from the calls of a layer, keyed by the signature of
+ * the inputs, i.e. their dtypes and shapes. A program is optimized by the IR
+ * passes once when it is inserted, and the later calls of the same signature
+ * replay it by a NaiveExecutor, without running the ops one by one through
+ * the tracer.
+ *
+ * The parameters are shared with the VarBases of the layer before every run,
+ * so that the updates of the parameters are seen by the replays. The outputs
+ * are new VarBases without gradient, the traced programs are forward only.
+ */
+class TracedProgramCache {
+  DISABLE_COPY_AND_ASSIGN(TracedProgramCache);
+
+ public:
+  // The passes should not rewrite the parameters, which are shared with the
+  // layer, no parameter scope is given to them.
+  TracedProgramCache(const platform::Place &place,
+                     const std::vector<std::string> &passes);
+
+  static std::string Signature(
+      const std::vector<std::shared_ptr<VarBase>> &inputs);
+
+  bool Has(const std::string &signature) const {
+    return programs_.count(signature) > 0;
+  }
+
+  size_t Size() const { return programs_.size(); }
+
+  void Insert(const std::string &signature,
+              const framework::ProgramDesc &program,
+              const std::vector<std::string> &feed_names,
+              const std::vector<std::string> &fetch_names,
+              const std::vector<std::shared_ptr<VarBase>> &persistable_vars);
+
+  std::vector<std::shared_ptr<VarBase>> Run(
+      const std::string &signature,
+      const std::vector<std::shared_ptr<VarBase>> &inputs);
+
+ private:
+  struct TracedProgram {
+    std::unique_ptr<framework::ProgramDesc> program;
+    std::vector<std::string> feed_names;
+    std::vector<std::string> fetch_names;
+    std::vector<std::shared_ptr<VarBase>> persistable_vars;
+    std::unique_ptr<framework::Scope> scope;
+    std::unique_ptr<framework::NaiveExecutor> executor;
+  };
+
+  std::unique_ptr<framework::ProgramDesc> ApplyPasses(
+      const framework::ProgramDesc &program) const;
+
+  platform::Place place_;
+  std::vector<std::string> passes_;
+  std::unordered_map<std::string, std::unique_ptr<TracedProgram>> programs_;
+};
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
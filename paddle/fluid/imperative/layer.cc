@@ -15,6 +15,7 @@
 #include "paddle/fluid/imperative/layer.h"
 #include <algorithm>
 #include <queue>
+#include <unordered_map>
 #include <utility>
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -267,10 +268,24 @@ std::shared_ptr<VarBase> VarBase::NewVarBase(const platform::Place& dst_place,
   }
 }
 
-void OpBase::SetType(const std::string& type) {
-  op_ = framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+const std::shared_ptr<const framework::OperatorBase>& OpBase::CachedOperator(
+    const std::string& type) {
+  thread_local std::unordered_map<
+      std::string, std::shared_ptr<const framework::OperatorBase>>
+      operators;
+  auto iter = operators.find(type);
+  if (iter == operators.end()) {
+    iter = operators
+               .emplace(type, std::shared_ptr<const framework::OperatorBase>(
+                                  framework::OpRegistry::CreateOp(
+                                      type, {}, {}, {}, false)))
+               .first;
+  }
+  return iter->second;
 }
 
+void OpBase::SetType(const std::string& type) { op_ = CachedOperator(type); }
+
 void OpBase::ClearBackwardTrace() {
   ins_.clear();
   outs_.clear();
@@ -325,6 +340,33 @@ void OpBase::Run(const framework::OperatorBase& op,
   OpBaseRunImpl<VariableWrapper>(op, ins, outs, attrs, place);
 }
 
+void OpBase::SaveInplaceVersions() {
+  saved_versions_.clear();
+  for (auto& pair : ins_) {
+    if (pair.second.IsGrad()) continue;
+    for (auto& var : pair.second) {
+      if (var) {
+        saved_versions_.emplace_back(var, var->InplaceVersion());
+      }
+    }
+  }
+}
+
+void OpBase::CheckInplaceVersions() const {
+  for (auto& pair : saved_versions_) {
+    auto var = pair.first.lock();
+    if (!var) continue;
+    PADDLE_ENFORCE_EQ(
+        var->InplaceVersion(), pair.second,
+        platform::errors::PreconditionNotMet(
+            "The variable %s needed by the gradient of %s has been modified "
+            "by an inplace operation. Its inplace version is %d, but %d is "
+            "expected. Please run the inplace operation on a copy of the "
+            "variable instead.",
+            var->Name(), Type(), var->InplaceVersion(), pair.second));
+  }
+}
+
 static void ClearNoNeedBufferInputs(OpBase* op) {
   auto& inferer = op->Info().NoNeedBufferVarsInferer();
   if (!inferer) return;
@@ -376,6 +418,7 @@ std::shared_ptr<GradOpNode> CreateGradOpNode(
       grad_op.SetId(OpBase::GenerateUniqueId());
       grad_op.SetPlace(place);
       ClearNoNeedBufferInputs(&grad_op);
+      grad_op.SaveInplaceVersions();
     }
     return grad_node;
   } else {
@@ -95,6 +95,12 @@ class OpBase {
     out_vars.SetIsGrad(is_grad);
   }
 
+  // Record the inplace versions of the saved forward variables, which must
+  // not change until the op runs in backward.
+  void SaveInplaceVersions();
+
+  void CheckInplaceVersions() const;
+
   void SetAttrMap(const framework::AttributeMap& attrs) { attrs_ = attrs; }
 
   void SetAttr(const std::string& name, const framework::Attribute& v) {
@@ -131,6 +137,11 @@ class OpBase {
 
   void SetPlace(const platform::Place& place) { place_ = place; }
 
+  // The layers calling the forward op, set when the op profiler is enabled.
+  const std::string& ProfileScope() const { return profile_scope_; }
+
+  void SetProfileScope(const std::string& scope) { profile_scope_ = scope; }
+
   void EnforceHasInOut() const {
     PADDLE_ENFORCE_NE(
         ins_.empty() && outs_.empty(), true,
@@ -150,6 +161,15 @@ class OpBase {
     return unique_id.fetch_add(1);
   }
 
+  // The operator of the type without inputs, outputs and attributes, which
+  // only tells the OpInfo and runs the kernels in dygraph, so it is created
+  // once per thread and shared by all the ops of the type, instead of being
+  // created by name for every traced op and grad op. The kernels it runs are
+  // chosen per call from the inputs and attributes, and cached by the hash of
+  // them in KernelCache if FLAGS_dygraph_cache_kernel is on.
+  static const std::shared_ptr<const framework::OperatorBase>& CachedOperator(
+      const std::string& type);
+
   static void Run(const framework::OperatorBase& op,
                   const NameVarMap<VarBase>& ins,
                   const NameVarMap<VarBase>& outs,
@@ -172,9 +192,12 @@ class OpBase {
   NameVarMap<VariableWrapper> ins_;
   NameVarMap<VariableWrapper> outs_;
   framework::AttributeMap attrs_;
-  std::unique_ptr<framework::OperatorBase> op_;
+  std::shared_ptr<const framework::OperatorBase> op_;
   platform::Place place_;
   size_t id_{-1UL};
+  std::string profile_scope_;
+  std::vector<std::pair<std::weak_ptr<VariableWrapper>, uint32_t>>
+      saved_versions_;
 
   std::vector<std::function<void()>> backward_hooks_;
 };
@@ -865,6 +865,7 @@ void PartialGradTask::RunEachOp(OpBase *op) {
   }
 
   // Run op
+  op->CheckInplaceVersions();
   OpBase::Run(op->InnerOp(), tmp_ins, tmp_outs, op->Attrs(), op->place());
 
   if (create_graph_) {
@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include "paddle/fluid/imperative/prepared_operator.h"
+#include <cstring>
 #include <sstream>
+#include <unordered_set>
 #include "paddle/fluid/imperative/execution_context.h"
+#include "paddle/fluid/imperative/flags.h"
 #include "paddle/fluid/imperative/infer_shape_context.h"
 #include "paddle/fluid/imperative/infer_var_type_context.h"
 
@@ -31,6 +34,178 @@ const framework::Tensor* GetTensorFromVar(const framework::Variable& var) {
   }
 }
 
+// The least recently used entries are dropped beyond it.
+static constexpr size_t kMaxCachedKernels = 10000;
+
+static void HashCombine(uint64_t* key, uint64_t value) {
+  *key ^= value + 0x9e3779b97f4a7c15ULL + (*key << 6) + (*key >> 2);
+}
+
+static uint64_t HashString(const std::string& str) {
+  uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+  for (auto c : str) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+namespace {
+
+struct AttrHasher : public boost::static_visitor<uint64_t> {
+  uint64_t operator()(const boost::blank&) const { return 0; }
+  uint64_t operator()(const std::string& str) const { return HashString(str); }
+  uint64_t operator()(float num) const {
+    uint32_t bits;
+    std::memcpy(&bits, &num, sizeof(bits));
+    return bits;
+  }
+  uint64_t operator()(framework::BlockDesc* block) const {
+    return reinterpret_cast<uintptr_t>(block);
+  }
+  template <typename T>
+  uint64_t operator()(const T& num) const {
+    return static_cast<uint64_t>(num);
+  }
+  template <typename T>
+  uint64_t operator()(const std::vector<T>& values) const {
+    uint64_t hash = values.size();
+    for (const auto& value : values) HashCombine(&hash, (*this)(value));
+    return hash;
+  }
+  uint64_t operator()(const std::vector<bool>& values) const {
+    uint64_t hash = values.size();
+    for (bool value : values) HashCombine(&hash, value);
+    return hash;
+  }
+};
+
+}  // namespace
+
+KernelCache& KernelCache::Instance() {
+  static KernelCache cache;
+  return cache;
+}
+
+uint64_t KernelCache::AttrsVersion(const framework::AttributeMap& attrs) {
+  // summed, since the order of an unordered_map differs for the same items
+  uint64_t version = attrs.size();
+  for (const auto& pair : attrs) {
+    uint64_t hash = HashString(pair.first);
+    HashCombine(&hash, boost::apply_visitor(AttrHasher(), pair.second));
+    HashCombine(&hash, pair.second.which());
+    version += hash;
+  }
+  return version;
+}
+
+bool KernelCache::KeyByDims(const std::string& op_type) {
+  // GetExpectedKernelType of these ops reads more of the dims than the ranks
+  // and whether the inputs are empty, which are always in the key.
+  static const std::unordered_set<std::string> kDimsDependentOps = {
+      "elementwise_add_grad", "multiclass_nms", "multiclass_nms2"};
+  return kDimsDependentOps.count(op_type) > 0;
+}
+
+std::shared_ptr<const KernelCache::Entry> KernelCache::Get(uint64_t key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, iter->second);
+  return iter->second->second;
+}
+
+void KernelCache::Put(uint64_t key, std::shared_ptr<const Entry> entry) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    iter->second->second = std::move(entry);
+    lru_.splice(lru_.begin(), lru_, iter->second);
+    return;
+  }
+  if (entries_.size() >= kMaxCachedKernels) {
+    entries_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(key, std::move(entry));
+  entries_.emplace(key, lru_.begin());
+}
+
+size_t KernelCache::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+void KernelCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  lru_.clear();
+}
+
+static void AppendPlaceKey(const platform::Place& place, uint64_t* key) {
+  HashCombine(key, place.which());
+  if (platform::is_gpu_place(place)) {
+    HashCombine(key, BOOST_GET_CONST(platform::CUDAPlace, place).device);
+  }
+}
+
+template <typename VarType>
+static void AppendVarsKey(const NameVarMap<VarType>& vars, bool by_dims,
+                          uint64_t* key) {
+  for (const auto& pair : vars) {
+    HashCombine(key, HashString(pair.first));
+    HashCombine(key, pair.second.size());
+    for (const auto& var : pair.second) {
+      if (!var) {
+        HashCombine(key, -1);
+        continue;
+      }
+      HashCombine(key, static_cast<int>(var->Type()));
+      const auto* tensor = GetTensorFromVar(var->Var());
+      if (tensor && tensor->IsInitialized()) {
+        HashCombine(key, static_cast<int>(tensor->type()));
+        HashCombine(key, static_cast<int>(tensor->layout()));
+        AppendPlaceKey(tensor->place(), key);
+        const auto& dims = tensor->dims();
+        HashCombine(key, dims.size());
+        HashCombine(key, tensor->numel() > 0);
+        if (by_dims) {
+          for (int i = 0; i < dims.size(); ++i) HashCombine(key, dims[i]);
+        }
+      }
+    }
+  }
+}
+
+template <typename VarType>
+static uint64_t KernelCacheKey(const NameVarMap<VarType>& ins,
+                               const NameVarMap<VarType>& outs,
+                               const framework::OperatorWithKernel& op,
+                               const platform::Place& place,
+                               const framework::AttributeMap& attrs) {
+  uint64_t key = HashString(op.Type());
+  AppendPlaceKey(place, &key);
+  HashCombine(&key, KernelCache::AttrsVersion(attrs));
+  bool by_dims = KernelCache::KeyByDims(op.Type());
+  AppendVarsKey<VarType>(ins, by_dims, &key);
+  AppendVarsKey<VarType>(outs, by_dims, &key);
+  return key;
+}
+
+template <typename VarType>
+static bool NeedTransformPlace(const platform::Place& place,
+                               const NameVarMap<VarType>& ins) {
+  for (const auto& name_pair : ins) {
+    for (const auto& var_base : name_pair.second) {
+      const auto* tensor = GetTensorFromVar(var_base->Var());
+      if (tensor && tensor->IsInitialized() &&
+          !(tensor->place() == place)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 template <typename VarType>
 static void PrepareData(const platform::Place& place,
                         const NameVarMap<VarType>& ins,
@@ -76,6 +251,21 @@ PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
                          platform::Place place,
                          const framework::AttributeMap& attrs) {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  framework::RuntimeContext ctx({}, {});
+
+  uint64_t cache_key = 0;
+  if (IsKernelCacheEnabled()) {
+    cache_key = KernelCacheKey<VarType>(ins, outs, op, place, attrs);
+    auto entry = KernelCache::Instance().Get(cache_key);
+    if (entry) {
+      auto* dev_ctx = pool.Get(entry->kernel_type.place_);
+      if (entry->need_transform) {
+        PrepareData<VarType>(dev_ctx->GetPlace(), ins, op, entry->kernel_type);
+      }
+      return PreparedOp(op, ctx, entry->func, dev_ctx);
+    }
+  }
+
   auto* dev_ctx = pool.Get(place);
 
   // check if op[type] has kernel registered.
@@ -90,7 +280,6 @@ PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
 
   auto& kernels = kernels_iter->second;
 
-  framework::RuntimeContext ctx({}, {});
   auto expected_kernel_key =
       op.GetExpectedKernelType(DygraphExecutionContext<VarType>(
           op, framework::Scope(), *dev_ctx, ctx, ins, outs, attrs));
@@ -108,6 +297,13 @@ PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
     place = dev_ctx->GetPlace();
   }
 
+  if (IsKernelCacheEnabled()) {
+    KernelCache::Instance().Put(
+        cache_key, std::make_shared<KernelCache::Entry>(KernelCache::Entry{
+                       expected_kernel_key, kernel_iter->second,
+                       NeedTransformPlace<VarType>(place, ins)}));
+  }
+
   PrepareData<VarType>(place, ins, op, expected_kernel_key);
   return PreparedOp(op, ctx, kernel_iter->second, dev_ctx);
 }
@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #pragma once
+#include <list>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/data_transform.h"
@@ -28,6 +31,55 @@ namespace imperative {
 
 const framework::Tensor* GetTensorFromVar(const framework::Variable& var);
 
+/*
+ * The kernels chosen by GetExpectedKernelType, so that the kernel selection
+ * runs once for the same op type, place, attribute version, and types, ranks
+ * and places of the inputs and outputs. The key is hashed from them. The
+ * traced ops build their attribute maps anew on every call, so the attribute
+ * version is the hash of the attribute values. The dims are only in the key
+ * of the ops whose kernels depend on more than the ranks, see KeyByDims, so
+ * that the ops of the variable shaped inputs hit as well. The least recently
+ * used kernels are dropped when too many are cached.
+ * Enabled by FLAGS_dygraph_cache_kernel=true.
+ */
+class KernelCache {
+ public:
+  struct Entry {
+    framework::OpKernelType kernel_type;
+    framework::OperatorWithKernel::OpKernelFunc func;
+    // whether any input is on a place other than the kernel's
+    bool need_transform;
+  };
+
+  static KernelCache& Instance();
+
+  // The version of attrs, which is the same for the same attribute values.
+  static uint64_t AttrsVersion(const framework::AttributeMap& attrs);
+
+  // Whether the dims of the inputs and outputs are in the key of the op type.
+  static bool KeyByDims(const std::string& op_type);
+
+  // Return nullptr if the kernel of the key is not cached.
+  std::shared_ptr<const Entry> Get(uint64_t key);
+
+  void Put(uint64_t key, std::shared_ptr<const Entry> entry);
+
+  size_t Size();
+
+  void Clear();
+
+ private:
+  KernelCache() = default;
+
+  using EntryList =
+      std::list<std::pair<uint64_t, std::shared_ptr<const Entry>>>;
+
+  std::mutex mutex_;
+  // the most recently used first
+  EntryList lru_;
+  std::unordered_map<uint64_t, EntryList::iterator> entries_;
+};
+
 class PreparedOp {
  public:
   PreparedOp(const framework::OperatorBase& op,
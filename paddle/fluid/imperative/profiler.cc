@@ -19,8 +19,20 @@
 #endif
 #include <gflags/gflags.h>
 #include <glog/logging.h>
-#include <mutex>   // NOLINT
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>  // NOLINT
+#include <sstream>
 #include <thread>  // NOLINT
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
 
 DEFINE_string(
     tracer_profile_fname, "xxgperf",
@@ -58,5 +70,231 @@ void StopProfile() {
 #endif
 }
 
+static uint64_t NowInNsec() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static std::vector<std::string>& ScopeStack() {
+  static thread_local std::vector<std::string> stack;
+  return stack;
+}
+
+static std::string& CurrentScopeRef() {
+  static thread_local std::string scope;
+  return scope;
+}
+
+OpProfiler& OpProfiler::Instance() {
+  static OpProfiler profiler;
+  return profiler;
+}
+
+void OpProfiler::Start(size_t capacity, bool sync_device) {
+  PADDLE_ENFORCE_GT(capacity, 0UL,
+                    platform::errors::InvalidArgument(
+                        "The capacity of the op profiler must be positive."));
+  std::lock_guard<std::mutex> guard(mutex_);
+  capacity_ = capacity;
+  sync_device_ = sync_device;
+  num_recorded_ = 0;
+  records_.clear();
+  records_.reserve(std::min<size_t>(capacity, 1 << 16));
+  enabled_.store(true);
+}
+
+void OpProfiler::Stop() { enabled_.store(false); }
+
+void OpProfiler::Record(OpProfileRecord record) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (records_.size() < capacity_) {
+    records_.emplace_back(std::move(record));
+  } else {
+    records_[num_recorded_ % capacity_] = std::move(record);
+  }
+  ++num_recorded_;
+}
+
+std::vector<OpProfileRecord> OpProfiler::Records() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<OpProfileRecord> records;
+  records.reserve(records_.size());
+  size_t begin = records_.size() < capacity_ ? 0 : num_recorded_ % capacity_;
+  for (size_t i = 0; i < records_.size(); ++i) {
+    records.emplace_back(records_[(begin + i) % records_.size()]);
+  }
+  return records;
+}
+
+namespace {
+
+struct OpProfileStat {
+  size_t calls{0};
+  uint64_t total_ns{0};
+  uint64_t max_ns{0};
+  size_t output_bytes{0};
+
+  void Add(const OpProfileRecord& record) {
+    uint64_t ns = record.end_ns - record.start_ns;
+    ++calls;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+    output_bytes += record.output_bytes;
+  }
+};
+
+template <typename Key>
+std::vector<std::pair<Key, OpProfileStat>> SortedByTotal(
+    const std::map<Key, OpProfileStat>& stats) {
+  std::vector<std::pair<Key, OpProfileStat>> sorted(stats.begin(),
+                                                    stats.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const std::pair<Key, OpProfileStat>& a,
+                      const std::pair<Key, OpProfileStat>& b) {
+                     return a.second.total_ns > b.second.total_ns;
+                   });
+  return sorted;
+}
+
+std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+const char* PassName(bool is_backward) {
+  return is_backward ? "backward" : "forward";
+}
+
+}  // namespace
+
+std::string OpProfiler::Summary(size_t max_rows) {
+  auto records = Records();
+  std::map<std::tuple<std::string, std::string, bool>, OpProfileStat> op_stats;
+  std::map<std::string, OpProfileStat> layer_stats;
+  uint64_t total_ns = 0;
+  for (auto& record : records) {
+    op_stats[std::make_tuple(record.scope, record.type, record.is_backward)]
+        .Add(record);
+    layer_stats[record.scope].Add(record);
+    total_ns += record.end_ns - record.start_ns;
+  }
+
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "------------------------->  Dygraph Op Profiling Report  "
+        "<-------------------------\n\n";
+  os << "Ops recorded: " << records.size()
+     << "  Time covered (ms): " << total_ns / 1e6
+     << "  Device synchronized: " << (sync_device_ ? "true" : "false")
+     << "\n\n";
+
+  auto print_row = [&os](const std::string& scope, const std::string& name,
+                         const OpProfileStat& stat, uint64_t total_ns) {
+    os << std::setw(36) << std::left << (scope.empty() ? "-" : scope)
+       << std::setw(28) << name << std::setw(8) << stat.calls << std::setw(12)
+       << stat.total_ns / 1e6 << std::setw(10)
+       << stat.total_ns / 1e6 / stat.calls << std::setw(10)
+       << stat.max_ns / 1e6 << std::setw(8)
+       << (total_ns ? 100. * stat.total_ns / total_ns : 0.) << std::setw(12)
+       << stat.output_bytes / 1048576. << "\n";
+  };
+  auto print_header = [&os](const std::string& name) {
+    os << std::setw(36) << std::left << "Layer" << std::setw(28) << name
+       << std::setw(8) << "Calls" << std::setw(12) << "Total(ms)"
+       << std::setw(10) << "Avg(ms)" << std::setw(10) << "Max(ms)"
+       << std::setw(8) << "Ratio" << std::setw(12) << "Output(MB)"
+       << "\n";
+  };
+
+  print_header("Op");
+  size_t rows = 0;
+  for (auto& pair : SortedByTotal(op_stats)) {
+    if (rows++ == max_rows) break;
+    print_row(std::get<0>(pair.first),
+              std::get<1>(pair.first) + " (" +
+                  PassName(std::get<2>(pair.first)) + ")",
+              pair.second, total_ns);
+  }
+
+  os << "\n";
+  print_header("");
+  rows = 0;
+  for (auto& pair : SortedByTotal(layer_stats)) {
+    if (rows++ == max_rows) break;
+    print_row(pair.first, "", pair.second, total_ns);
+  }
+  return os.str();
+}
+
+void OpProfiler::ExportChromeTrace(const std::string& path) {
+  auto records = Records();
+  std::ofstream file(path);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Can not open %s to export the chrome trace.", path));
+  uint64_t begin_ns = records.empty() ? 0 : records[0].start_ns;
+  for (auto& record : records) {
+    begin_ns = std::min(begin_ns, record.start_ns);
+  }
+  std::unordered_map<size_t, size_t> tids;
+  file << "{\"traceEvents\": [";
+  for (size_t i = 0; i < records.size(); ++i) {
+    auto& record = records[i];
+    auto tid = tids.emplace(record.thread_id, tids.size()).first->second;
+    file << (i == 0 ? "\n" : ",\n") << "{\"name\": \""
+         << EscapeJson(record.type) << "\", \"cat\": \""
+         << PassName(record.is_backward) << "\", \"ph\": \"X\", \"pid\": 0, "
+         << "\"tid\": " << tid
+         << ", \"ts\": " << (record.start_ns - begin_ns) / 1000.
+         << ", \"dur\": " << (record.end_ns - record.start_ns) / 1000.
+         << ", \"args\": {\"layer\": \"" << EscapeJson(record.scope)
+         << "\", \"output_bytes\": " << record.output_bytes << "}}";
+  }
+  file << "\n]}\n";
+}
+
+void OpProfiler::PushScope(const std::string& name) {
+  auto& scope = CurrentScopeRef();
+  ScopeStack().emplace_back(scope);
+  if (!scope.empty()) scope += '/';
+  scope += name;
+}
+
+void OpProfiler::PopScope() {
+  auto& stack = ScopeStack();
+  PADDLE_ENFORCE_EQ(stack.empty(), false,
+                    platform::errors::PreconditionNotMet(
+                        "No layer scope of the op profiler to pop."));
+  CurrentScopeRef() = std::move(stack.back());
+  stack.pop_back();
+}
+
+const std::string& OpProfiler::CurrentScope() { return CurrentScopeRef(); }
+
+OpProfileEvent::OpProfileEvent(const std::string& type,
+                               const std::string& scope, bool is_backward) {
+  record_.type = type;
+  record_.scope = scope;
+  record_.is_backward = is_backward;
+  record_.thread_id = std::hash<std::thread::id>()(std::this_thread::get_id());
+  record_.start_ns = NowInNsec();
+}
+
+void OpProfileEvent::Finish(size_t output_bytes,
+                            const platform::Place& place) {
+  auto& profiler = OpProfiler::Instance();
+  if (profiler.SyncDevice()) {
+    platform::DeviceContextPool::Instance().Get(place)->Wait();
+  }
+  record_.end_ns = NowInNsec();
+  record_.output_bytes = output_bytes;
+  profiler.Record(std::move(record_));
+}
+
 }  // namespace imperative
 }  // namespace paddle
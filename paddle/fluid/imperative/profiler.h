@@ -14,6 +14,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/fluid/platform/place.h"
+
 namespace paddle {
 namespace imperative {
 
@@ -21,5 +32,100 @@ extern void StartProfile();
 
 extern void StopProfile();
 
+struct OpProfileRecord {
+  std::string type;
+  // the full names of the layers calling the op, joined by '/'
+  std::string scope;
+  bool is_backward;
+  uint64_t start_ns;
+  uint64_t end_ns;
+  size_t output_bytes;
+  size_t thread_id;
+};
+
+/*
+ * Records the traced ops and their grad ops into a ring buffer, with the host
+ * time of each op, the bytes of its outputs, and the dygraph layers calling
+ * it. The grad ops are attributed to the layers of their forward ops. When
+ * sync_device is set, the device is waited after each op, so that the time
+ * covers its kernels on the device, at the cost of the asynchronous launches.
+ *
+ * When it is disabled, the cost on each op is a relaxed atomic load.
+ */
+class OpProfiler {
+ public:
+  static OpProfiler& Instance();
+
+  void Start(size_t capacity, bool sync_device);
+
+  void Stop();
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  bool SyncDevice() const { return sync_device_; }
+
+  void Record(OpProfileRecord record);
+
+  // The records kept in the ring buffer, in the order they are recorded.
+  std::vector<OpProfileRecord> Records();
+
+  // The tables of the ops grouped by the layer, the type and the pass, and
+  // of the layers, sorted by the total time.
+  std::string Summary(size_t max_rows);
+
+  void ExportChromeTrace(const std::string& path);
+
+  // The stack of the layers being called on the current thread.
+  static void PushScope(const std::string& name);
+  static void PopScope();
+  static const std::string& CurrentScope();
+
+ private:
+  OpProfiler() = default;
+
+  std::atomic<bool> enabled_{false};
+  bool sync_device_{false};
+  std::mutex mutex_;
+  size_t capacity_{0};
+  // the number of the records since Start, the oldest ones are overwritten
+  size_t num_recorded_{0};
+  std::vector<OpProfileRecord> records_;
+};
+
+/*
+ * Times an op from the construction to Finish.
+ */
+class OpProfileEvent {
+ public:
+  OpProfileEvent(const std::string& type, const std::string& scope,
+                 bool is_backward);
+
+  void Finish(size_t output_bytes, const platform::Place& place);
+
+ private:
+  OpProfileRecord record_;
+};
+
+template <typename VarType>
+size_t OutputBytes(const NameVarMap<VarType>& outs) {
+  size_t bytes = 0;
+  for (const auto& pair : outs) {
+    for (const auto& var : pair.second) {
+      if (!var) continue;
+      const auto& inner_var = var->Var();
+      const framework::Tensor* tensor = nullptr;
+      if (inner_var.template IsType<framework::LoDTensor>()) {
+        tensor = &inner_var.template Get<framework::LoDTensor>();
+      } else if (inner_var.template IsType<framework::SelectedRows>()) {
+        tensor = &inner_var.template Get<framework::SelectedRows>().value();
+      }
+      if (tensor && tensor->IsInitialized()) {
+        bytes += tensor->memory_size();
+      }
+    }
+  }
+  return bytes;
+}
+
 }  // namespace imperative
 }  // namespace paddle
@@ -0,0 +1,253 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_NCCL
+
+#include "paddle/fluid/imperative/reducer.h"
+
+#include "paddle/fluid/imperative/all_reduce.h"
+#include "paddle/fluid/imperative/basic_engine.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/nccl_helper.h"
+
+namespace paddle {
+namespace imperative {
+
+Reducer::Reducer(const std::vector<std::shared_ptr<VarBase>>& params,
+                 const std::vector<bool>& is_sparse,
+                 const ParallelStrategy& strategy, size_t bucket_size)
+    : params_(params),
+      param_sparse_(is_sparse),
+      strategy_(strategy),
+      param_buckets_(params.size()),
+      param_ready_(params.size(), false) {
+  PADDLE_ENFORCE_GT(params_.size(), 0,
+                    platform::errors::InvalidArgument(
+                        "The reducer needs at least one parameter."));
+  PADDLE_ENFORCE_EQ(
+      param_sparse_.size(), params_.size(),
+      platform::errors::InvalidArgument(
+          "The reducer is given %d parameters, but %d flags of sparse.",
+          params_.size(), param_sparse_.size()));
+  const auto& place = params_[0]->Var().Get<framework::LoDTensor>().place();
+  PADDLE_ENFORCE_EQ(platform::is_gpu_place(place), true,
+                    platform::errors::Unimplemented(
+                        "The reducer only supports the parameters on GPU."));
+  place_ = BOOST_GET_CONST(platform::CUDAPlace, place);
+
+  for (size_t i = params_.size(); i > 0; --i) {
+    size_t param_idx = i - 1;
+    // the sparse gradients are allreduced one by one after backward
+    if (param_sparse_[param_idx]) continue;
+    const auto& tensor =
+        params_[param_idx]->Var().Get<framework::LoDTensor>();
+    auto dtype = tensor.type();
+    auto size_of_dtype = framework::SizeOfType(dtype);
+    if (buckets_.empty() || buckets_.back().dtype != dtype ||
+        (buckets_.back().offsets.back() > 0 &&
+         (buckets_.back().offsets.back() + tensor.numel()) * size_of_dtype >
+             bucket_size)) {
+      buckets_.emplace_back();
+      buckets_.back().dtype = dtype;
+    }
+    auto& bucket = buckets_.back();
+    bucket.params.emplace_back(param_idx);
+    bucket.offsets.emplace_back(bucket.offsets.back() + tensor.numel());
+    param_buckets_[param_idx] = buckets_.size() - 1;
+
+    params_[param_idx]->MutableGradVarBase()->SharedVar()->AddGradReadyHook(
+        [this, param_idx] { MarkGradReady(param_idx); });
+  }
+
+  for (auto& bucket : buckets_) {
+    bucket.fused.Resize({bucket.offsets.back()});
+    bucket.fused.mutable_data(place_, bucket.dtype);
+  }
+  produced_.Resize({static_cast<int64_t>(params_.size())});
+  produced_.mutable_data<int>(place_);
+  PrepareForBackward();
+  backward_begin_hook_ =
+      BasicEngine::AddBackwardBeginHook([this] { PrepareForBackward(); });
+  VLOG(3) << "The reducer groups " << params_.size() << " parameters into "
+          << buckets_.size() << " buckets.";
+}
+
+Reducer::~Reducer() {
+  BasicEngine::RemoveBackwardBeginHook(backward_begin_hook_);
+  for (auto& param : params_) {
+    if (param->GradVarBase()) {
+      param->GradVarBase()->SharedVar()->ClearGradReadyHooks();
+    }
+  }
+}
+
+void Reducer::PrepareForBackward() {
+  param_ready_.assign(params_.size(), false);
+  for (auto& bucket : buckets_) {
+    bucket.pending = bucket.params.size();
+  }
+  next_bucket_ = 0;
+}
+
+void Reducer::MarkGradReady(size_t param_idx) {
+  if (param_ready_[param_idx]) return;
+  param_ready_[param_idx] = true;
+  if (--buckets_[param_buckets_[param_idx]].pending > 0) return;
+
+  while (next_bucket_ < buckets_.size() &&
+         buckets_[next_bucket_].pending == 0) {
+    LaunchBucket(&buckets_[next_bucket_++]);
+  }
+}
+
+void Reducer::LaunchBucket(Bucket* bucket) {
+  auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  auto calc_stream = dev_ctx->stream();
+  auto* comm = platform::NCCLCommContext::Instance().Get(0, place_);
+  auto size_of_dtype = framework::SizeOfType(bucket->dtype);
+  auto* fused_data = reinterpret_cast<uint8_t*>(
+      bucket->fused.mutable_data(place_, bucket->dtype));
+
+  for (size_t i = 0; i < bucket->params.size(); ++i) {
+    auto param_idx = bucket->params[i];
+    auto numel = bucket->offsets[i + 1] - bucket->offsets[i];
+    auto* dst = fused_data + bucket->offsets[i] * size_of_dtype;
+
+    if (param_ready_[param_idx]) {
+      const auto& grad_var = params_[param_idx]->GradVarBase()->Var();
+      PADDLE_ENFORCE_EQ(grad_var.IsType<framework::LoDTensor>(), true,
+                        platform::errors::InvalidArgument(
+                            "The gradient of %s is not a LoDTensor, so the "
+                            "parameter should be given as sparse to the "
+                            "reducer.",
+                            params_[param_idx]->Name()));
+      const auto& grad = grad_var.Get<framework::LoDTensor>();
+      PADDLE_ENFORCE_EQ(grad.numel(), numel,
+                        platform::errors::InvalidArgument(
+                            "The gradient of %s has %d elements, but the "
+                            "parameter has %d.",
+                            params_[param_idx]->Name(), grad.numel(), numel));
+      memory::Copy(place_, dst, place_, grad.data<void>(),
+                   numel * size_of_dtype, calc_stream);
+    } else {
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaMemsetAsync(dst, 0, numel * size_of_dtype, calc_stream));
+    }
+  }
+
+  comm->WaitCalcStream(calc_stream);
+  PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
+      fused_data, fused_data, bucket->offsets.back(),
+      platform::ToNCCLDataType(bucket->dtype), ncclSum, comm->comm(),
+      comm->stream()));
+  comm->RecordVarEvent(bucket);
+}
+
+bool Reducer::HasSparseGrad(size_t param_idx) const {
+  const auto& grad = params_[param_idx]->GradVarBase();
+  if (!grad || !grad->Var().IsType<framework::SelectedRows>()) return false;
+  return grad->Var().Get<framework::SelectedRows>().value().IsInitialized();
+}
+
+std::vector<int> Reducer::AllReduceProducedGrads() {
+  std::vector<int> produced(params_.size());
+  for (size_t i = 0; i < params_.size(); ++i) {
+    produced[i] = param_sparse_[i] ? HasSparseGrad(i)
+                                   : static_cast<bool>(param_ready_[i]);
+  }
+
+  // The trainers have to agree on the gradients, so this waits for the result
+  // before the gradients are unpacked.
+  auto* comm = platform::NCCLCommContext::Instance().Get(0, place_);
+  auto* data = produced_.mutable_data<int>(place_);
+  auto size = produced.size() * sizeof(int);
+  memory::Copy(place_, data, platform::CPUPlace(), produced.data(), size,
+               comm->stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
+      data, data, produced.size(), ncclInt, ncclSum, comm->comm(),
+      comm->stream()));
+  memory::Copy(platform::CPUPlace(), produced.data(), place_, data, size,
+               comm->stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(comm->stream()));
+  return produced;
+}
+
+void Reducer::FinalizeBackward() {
+  while (next_bucket_ < buckets_.size()) {
+    LaunchBucket(&buckets_[next_bucket_++]);
+  }
+
+  auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  auto calc_stream = dev_ctx->stream();
+  auto* comm = platform::NCCLCommContext::Instance().Get(0, place_);
+  std::vector<const void*> vars;
+  for (auto& bucket : buckets_) {
+    vars.emplace_back(&bucket);
+  }
+
+  comm->WaitCalcStream(calc_stream);
+  auto produced = AllReduceProducedGrads();
+
+  // in the order of the parameters, which is the same on all the trainers
+  for (size_t i = 0; i < params_.size(); ++i) {
+    if (!param_sparse_[i] || produced[i] == 0) continue;
+    auto* grad_var = params_[i]->MutableGradVar();
+    if (!HasSparseGrad(i)) {
+      // an empty gradient, since other trainers produce it
+      const auto& param = params_[i]->Var().Get<framework::LoDTensor>();
+      if (!grad_var->IsType<framework::SelectedRows>()) grad_var->Clear();
+      auto* grad = grad_var->GetMutable<framework::SelectedRows>();
+      grad->set_height(param.dims()[0]);
+      grad->mutable_rows()->clear();
+      auto dims = param.dims();
+      dims[0] = 0;
+      grad->mutable_value()->Resize(dims);
+      grad->mutable_value()->mutable_data(place_, param.type());
+    }
+    AllReduce(*grad_var, grad_var, strategy_, comm->stream());
+    comm->RecordVarEvent(grad_var);
+    vars.emplace_back(grad_var);
+  }
+  comm->CalcStreamWaitVars(vars, calc_stream);
+
+  for (auto& bucket : buckets_) {
+    auto size_of_dtype = framework::SizeOfType(bucket.dtype);
+    const auto* fused_data =
+        reinterpret_cast<const uint8_t*>(bucket.fused.data<void>());
+    for (size_t i = 0; i < bucket.params.size(); ++i) {
+      auto param_idx = bucket.params[i];
+      // Not created, e.g. for the parameters of an unused branch, so that
+      // the optimizers and the weight decay skip them like those of
+      // apply_collective_grads without the reducer.
+      if (produced[param_idx] == 0) continue;
+      // the gradients produced by other trainers only are created as well
+      auto& param = params_[param_idx];
+      auto* grad = param->MutableGradVar()->GetMutable<framework::LoDTensor>();
+      grad->Resize(param->Var().Get<framework::LoDTensor>().dims());
+      auto numel = bucket.offsets[i + 1] - bucket.offsets[i];
+      memory::Copy(place_, grad->mutable_data(place_, bucket.dtype), place_,
+                   fused_data + bucket.offsets[i] * size_of_dtype,
+                   numel * size_of_dtype, calc_stream);
+    }
+  }
+}
+
+}  // namespace imperative
+}  // namespace paddle
+
+#endif
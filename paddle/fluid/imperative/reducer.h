@@ -0,0 +1,97 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#ifdef PADDLE_WITH_NCCL
+
+#include <memory>
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/nccl_context.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+
+/*
+ * Allreduces the dense gradients of the parameters during backward.
+ *
+ * The dense parameters are grouped into the buckets of at most bucket_size
+ * bytes in the reverse order, which is roughly the order their gradients are
+ * ready in backward. When all the gradients of a bucket are accumulated, they
+ * are packed into the fused tensor of the bucket, which is allreduced on the
+ * communication stream while backward goes on. The buckets are launched in
+ * order, so that all the trainers run the same sequence of allreduces.
+ *
+ * Whether a parameter is sparse, i.e. has SelectedRows gradients, is given at
+ * construction, so that all the trainers agree on the buckets.
+ */
+class Reducer {
+ public:
+  Reducer(const std::vector<std::shared_ptr<VarBase>>& params,
+          const std::vector<bool>& is_sparse, const ParallelStrategy& strategy,
+          size_t bucket_size);
+
+  ~Reducer();
+
+  // Called by BasicEngine at the beginning of each backward.
+  void PrepareForBackward();
+
+  // Called after backward. Allreduce the remaining buckets, in which the
+  // gradients not produced by this backward are zeros, the sparse gradients
+  // one by one, and whether each gradient is produced by any trainer. Then
+  // wait for the results and unpack the produced gradients on the
+  // calculation stream. The gradients produced by no trainer are left as
+  // they are, e.g. not created, so that the optimizers skip them as well.
+  void FinalizeBackward();
+
+ private:
+  struct Bucket {
+    std::vector<size_t> params;
+    // the offsets of the gradients in fused, and the total numel at last
+    std::vector<int64_t> offsets{0};
+    framework::proto::VarType::Type dtype;
+    framework::Tensor fused;
+    size_t pending{0};
+  };
+
+  void MarkGradReady(size_t param_idx);
+
+  void LaunchBucket(Bucket* bucket);
+
+  // Whether the sparse gradient of a parameter is produced by this trainer.
+  bool HasSparseGrad(size_t param_idx) const;
+
+  // Allreduce whether the gradient of each parameter is produced by this
+  // trainer, and return the number of the trainers producing it.
+  std::vector<int> AllReduceProducedGrads();
+
+  std::vector<std::shared_ptr<VarBase>> params_;
+  std::vector<bool> param_sparse_;
+  ParallelStrategy strategy_;
+  platform::CUDAPlace place_;
+  std::vector<Bucket> buckets_;
+  std::vector<size_t> param_buckets_;
+  std::vector<bool> param_ready_;
+  size_t next_bucket_{0};
+  framework::Tensor produced_;
+  size_t backward_begin_hook_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
+
+#endif
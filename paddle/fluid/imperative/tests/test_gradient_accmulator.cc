@@ -28,6 +28,9 @@ namespace imperative {
 
 void TensorAdd(const framework::Variable& src, framework::Variable* dst);
 
+void SelectedRowsAddToTensor(const framework::Variable& src,
+                             framework::Variable* dst);
+
 template <typename Place, typename T>
 int TensorddTest(Place place, T t1, T t2) {
   framework::Variable var1;
@@ -311,5 +314,57 @@ TEST(test_gradient_accumulator, test_unchange_input) {
   }
 }
 
+// The rows of the merged selected rows are in no particular order, so the
+// sums are compared as dense tensors.
+static framework::Variable ToDense(const framework::Variable& var,
+                                   const framework::DDim& dim) {
+  if (var.IsType<framework::LoDTensor>()) {
+    framework::Variable ret;
+    CopyVar(var, &ret);
+    return ret;
+  }
+  auto ret = RandomTensor<float>(dim, platform::CPUPlace(), 0, 0);
+  SelectedRowsAddToTensor(var, &ret);
+  return ret;
+}
+
+TEST(test_gradient_accumulator, test_sorted_sum) {
+  framework::DDim dim{10, 20};
+  platform::CPUPlace place;
+  // dense only, dense and selected rows, and selected rows only
+  std::vector<std::vector<bool>> use_tensors_list = {
+      {true, true, true}, {true, false, true, false}, {false, false, false}};
+
+  for (auto& use_tensors : use_tensors_list) {
+    auto sorted_var = std::make_shared<VariableWrapper>("sorted_var");
+    sorted_var->SetOverridedStopGradient(false);
+    auto sorted_accum = CreateAccumulator(sorted_var, true);
+    auto eager_var = std::make_shared<VariableWrapper>("eager_var");
+    eager_var->SetOverridedStopGradient(false);
+    auto eager_accum = CreateAccumulator(eager_var, false);
+    for (size_t i = 0; i < use_tensors.size(); ++i) {
+      sorted_accum->IncreaseRefCnt();
+      eager_accum->IncreaseRefCnt();
+    }
+
+    for (size_t i = 0; i < use_tensors.size(); ++i) {
+      auto var = use_tensors[i] ? RandomTensor<float>(dim, place)
+                                : RandomSelectedRows<float>(dim, place, 5);
+      auto sorted_wrapper = std::make_shared<VariableWrapper>("sorted_tmp");
+      auto eager_wrapper = std::make_shared<VariableWrapper>("eager_tmp");
+      CopyVar(var, sorted_wrapper->MutableVar());
+      CopyVar(var, eager_wrapper->MutableVar());
+      // the first gradient must be unchanged
+      sorted_accum->Add(sorted_wrapper, i, i == 0);
+      eager_accum->Add(eager_wrapper, i, i == 0);
+      if (i == 0) {
+        ASSERT_TRUE(IsEqualVar(sorted_wrapper->Var(), var));
+      }
+    }
+    ASSERT_TRUE(IsEqualVar(ToDense(sorted_var->Var(), dim),
+                           ToDense(eager_var->Var(), dim)));
+  }
+}
+
 }  // namespace imperative
 }  // namespace paddle
@@ -20,11 +20,14 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/imperative/prepared_operator.h"
 #include "paddle/fluid/imperative/type_defs.h"
 
+DECLARE_bool(dygraph_cache_kernel);
+
 namespace imperative = paddle::imperative;
 namespace platform = paddle::platform;
 namespace framework = paddle::framework;
@@ -222,6 +225,105 @@ TEST(test_prepare_op, test_prepare_data_same_place) {
     }
   }
 }
+
+TEST(test_prepare_op, test_kernel_cache) {
+  std::shared_ptr<imperative::VarBase> vin(
+      new imperative::VarBase(false, "vin"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(false, "vout"));
+  platform::CPUPlace cpu_place;
+  auto* vin_tensor = vin->MutableVar()->GetMutable<framework::LoDTensor>();
+  vin_tensor->Resize(framework::make_ddim({2, 5}));
+  vin_tensor->mutable_data<float>(cpu_place);
+
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, vin))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+  framework::AttributeMap attr_map;
+  const std::string op_type = "relu";
+  const auto& info = framework::OpInfoMap::Instance().Get(op_type);
+  if (info.Checker()) info.Checker()->Check(&attr_map);
+  auto op = framework::OpRegistry::CreateOp(
+      op_type, CreateVarNameMap(info, op_type, ins, true),
+      CreateVarNameMap(info, op_type, outs, false), attr_map);
+  auto& op_kernel = dynamic_cast<framework::OperatorWithKernel&>(*op);
+
+  FLAGS_dygraph_cache_kernel = true;
+  auto& cache = KernelCache::Instance();
+  cache.Clear();
+  PreparedOp::Prepare(ins, outs, op_kernel, cpu_place, attr_map);
+  ASSERT_EQ(cache.Size(), 1UL);
+  PreparedOp::Prepare(ins, outs, op_kernel, cpu_place, attr_map);
+  ASSERT_EQ(cache.Size(), 1UL);
+
+  // the dims of the same rank are not in the key of relu
+  ASSERT_FALSE(KernelCache::KeyByDims(op_type));
+  vin_tensor->Resize(framework::make_ddim({5, 2}));
+  vin_tensor->mutable_data<float>(cpu_place);
+  PreparedOp::Prepare(ins, outs, op_kernel, cpu_place, attr_map);
+  ASSERT_EQ(cache.Size(), 1UL);
+  // but the ranks are
+  vin_tensor->Resize(framework::make_ddim({10}));
+  PreparedOp::Prepare(ins, outs, op_kernel, cpu_place, attr_map);
+  ASSERT_EQ(cache.Size(), 2UL);
+
+  // and the attribute version
+  auto other_attrs = attr_map;
+  other_attrs["use_mkldnn"] = !BOOST_GET_CONST(bool, attr_map["use_mkldnn"]);
+  ASSERT_NE(KernelCache::AttrsVersion(other_attrs),
+            KernelCache::AttrsVersion(attr_map));
+  PreparedOp::Prepare(ins, outs, op_kernel, cpu_place, other_attrs);
+  ASSERT_EQ(cache.Size(), 3UL);
+  PreparedOp::Prepare(ins, outs, op_kernel, cpu_place, attr_map);
+  ASSERT_EQ(cache.Size(), 3UL);
+  cache.Clear();
+  FLAGS_dygraph_cache_kernel = false;
+}
+
+TEST(test_prepare_op, test_kernel_cache_disabled) {
+  std::shared_ptr<imperative::VarBase> vin(
+      new imperative::VarBase(false, "vin"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(false, "vout"));
+  platform::CPUPlace cpu_place;
+  auto* vin_tensor = vin->MutableVar()->GetMutable<framework::LoDTensor>();
+  vin_tensor->Resize(framework::make_ddim({2, 5}));
+  vin_tensor->mutable_data<float>(cpu_place);
+
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, vin))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+  framework::AttributeMap attr_map;
+  const std::string op_type = "relu";
+  const auto& info = framework::OpInfoMap::Instance().Get(op_type);
+  if (info.Checker()) info.Checker()->Check(&attr_map);
+  auto op = framework::OpRegistry::CreateOp(
+      op_type, CreateVarNameMap(info, op_type, ins, true),
+      CreateVarNameMap(info, op_type, outs, false), attr_map);
+
+  // off by default
+  ASSERT_FALSE(FLAGS_dygraph_cache_kernel);
+  auto& cache = KernelCache::Instance();
+  cache.Clear();
+  PreparedOp::Prepare(ins, outs,
+                      dynamic_cast<framework::OperatorWithKernel&>(*op),
+                      cpu_place, attr_map);
+  ASSERT_EQ(cache.Size(), 0UL);
+}
+
+TEST(test_prepare_op, test_attrs_version) {
+  framework::AttributeMap attrs = {{"axis", 1}, {"scale", 0.5f}};
+  framework::AttributeMap same_attrs;
+  same_attrs["scale"] = 0.5f;
+  same_attrs["axis"] = 1;
+  ASSERT_EQ(KernelCache::AttrsVersion(attrs),
+            KernelCache::AttrsVersion(same_attrs));
+  same_attrs["axis"] = 0;
+  ASSERT_NE(KernelCache::AttrsVersion(attrs),
+            KernelCache::AttrsVersion(same_attrs));
+  // the same value in another type
+  same_attrs["axis"] = static_cast<int64_t>(1);
+  ASSERT_NE(KernelCache::AttrsVersion(attrs),
+            KernelCache::AttrsVersion(same_attrs));
+}
 }  // namespace imperative
 }  // namespace paddle
 
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/imperative/jit/traced_program_cache.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+static std::shared_ptr<VarBase> NewVarBase(const std::string& name,
+                                           const std::vector<int64_t>& dims,
+                                           float value) {
+  auto var = std::make_shared<VarBase>(false, name);
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  std::fill(data, data + tensor->numel(), value);
+  return var;
+}
+
+static framework::ProgramDesc AddProgram() {
+  framework::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  for (auto* name : {"feed_0", "w", "fetch_0"}) {
+    auto* var = block->Var(name);
+    var->SetType(framework::proto::VarType::LOD_TENSOR);
+    var->SetDataType(framework::proto::VarType::FP32);
+  }
+  block->Var("w")->SetPersistable(true);
+  auto* op = block->AppendOp();
+  op->SetType("elementwise_add");
+  op->SetInput("X", {"feed_0"});
+  op->SetInput("Y", {"w"});
+  op->SetOutput("Out", {"fetch_0"});
+  op->SetAttr("axis", -1);
+  return program;
+}
+
+TEST(TracedProgramCache, replay) {
+  TracedProgramCache cache(platform::CPUPlace(), {});
+  auto x = NewVarBase("x", {2, 3}, 1.f);
+  auto w = NewVarBase("w", {2, 3}, 2.f);
+  std::vector<std::shared_ptr<VarBase>> inputs{x};
+  auto signature = TracedProgramCache::Signature(inputs);
+  EXPECT_FALSE(cache.Has(signature));
+  cache.Insert(signature, AddProgram(), {"feed_0"}, {"fetch_0"}, {w});
+  EXPECT_TRUE(cache.Has(signature));
+  EXPECT_EQ(cache.Size(), 1UL);
+
+  auto outs = cache.Run(signature, inputs);
+  ASSERT_EQ(outs.size(), 1UL);
+  auto& out = outs[0]->Var().Get<framework::LoDTensor>();
+  ASSERT_EQ(out.numel(), 6);
+  EXPECT_EQ(out.data<float>()[5], 3.f);
+
+  // the replays see the parameter updated, and do not overwrite the outputs
+  // of the earlier runs
+  w->MutableVar()->GetMutable<framework::LoDTensor>()->data<float>()[5] = 5.f;
+  auto new_outs = cache.Run(signature, inputs);
+  EXPECT_EQ(new_outs[0]->Var().Get<framework::LoDTensor>().data<float>()[5],
+            6.f);
+  EXPECT_EQ(out.data<float>()[5], 3.f);
+
+  auto other = NewVarBase("x", {4, 3}, 1.f);
+  EXPECT_NE(TracedProgramCache::Signature({other}), signature);
+  EXPECT_FALSE(cache.Has(TracedProgramCache::Signature({other})));
+}
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
+
+USE_OP(elementwise_add);
@@ -17,15 +17,20 @@
 //
 
 #include <paddle/fluid/framework/op_registry.h>
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
 #include <vector>
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/imperative/basic_engine.h"
+#include "paddle/fluid/imperative/prepared_operator.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/memory/memcpy.h"
 
+DECLARE_bool(dygraph_cache_kernel);
+
 namespace imperative = paddle::imperative;
 namespace platform = paddle::platform;
 namespace framework = paddle::framework;
@@ -287,6 +292,230 @@ TEST(test_tracer, test_unique_name_generator) {
   ASSERT_STREQ("fc_1", fc_2.c_str());
 }
 
+TEST(test_tracer, test_cached_operator) {
+  // the traced ops and the grad ops of a type share one operator
+  auto& mul = OpBase::CachedOperator("mul");
+  ASSERT_NE(mul, nullptr);
+  EXPECT_EQ(mul->Type(), "mul");
+  EXPECT_EQ(OpBase::CachedOperator("mul"), mul);
+  EXPECT_NE(OpBase::CachedOperator("elementwise_add"), mul);
+  OpBase grad_op;
+  grad_op.SetType("mul_grad");
+  EXPECT_EQ(&grad_op.InnerOp(), OpBase::CachedOperator("mul_grad").get());
+}
+
+TEST(test_tracer, test_view_op) {
+  imperative::Tracer tracer;
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(true, "x_in"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  std::shared_ptr<imperative::VarBase> xshape(
+      new imperative::VarBase(false, "xshape"));
+  platform::CPUPlace place;
+  auto* x_in_tensor = x_in->MutableVar()->GetMutable<framework::LoDTensor>();
+  x_in_tensor->Resize(framework::make_ddim({2, 5}));
+  x_in_tensor->mutable_data<float>(place);
+
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout)),
+                                     var_pair("XShape", vb_vector(1, xshape))};
+  framework::AttributeMap attrs;
+  attrs["shape"] = std::vector<int>{5, -1};
+  tracer.TraceOp("reshape2", ins, outs, attrs, place, true);
+  const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+  ASSERT_EQ(out_tensor.dims(), framework::make_ddim({5, 2}));
+  ASSERT_EQ(out_tensor.data<float>(), x_in_tensor->data<float>());
+  ASSERT_TRUE(vout->GradNode() != nullptr);
+
+  // the view shares the inplace version of its base
+  x_in->SharedVar()->BumpInplaceVersion();
+  ASSERT_EQ(vout->SharedVar()->InplaceVersion(), 1U);
+}
+
+TEST(test_tracer, test_inplace_version) {
+  imperative::Tracer tracer;
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(true, "x_in"));
+  std::shared_ptr<imperative::VarBase> y_in(
+      new imperative::VarBase(true, "y_in"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  x_in->SetOverridedStopGradient(true);
+  platform::CPUPlace place;
+  std::vector<float> src_data(10, 2.0);
+  auto* x_in_tensor = x_in->MutableVar()->GetMutable<framework::LoDTensor>();
+  auto* y_in_tensor = y_in->MutableVar()->GetMutable<framework::LoDTensor>();
+  x_in_tensor->Resize(framework::make_ddim({2, 5}));
+  paddle::memory::Copy(place, x_in_tensor->mutable_data<float>(place), place,
+                       src_data.data(), sizeof(float) * src_data.size());
+  y_in_tensor->Resize(framework::make_ddim({5, 2}));
+  paddle::memory::Copy(place, y_in_tensor->mutable_data<float>(place), place,
+                       src_data.data(), sizeof(float) * src_data.size());
+
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                    var_pair("Y", vb_vector(1, y_in))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+
+  // scale x_in inplace, which is needed by the gradient of mul
+  imperative::NameVarBaseMap scale_ins = {var_pair("X", vb_vector(1, x_in))};
+  imperative::NameVarBaseMap scale_outs = {
+      var_pair("Out", vb_vector(1, x_in))};
+  framework::AttributeMap scale_attr_map;
+  scale_attr_map["scale"] = 2.0f;
+  tracer.TraceOp("scale", scale_ins, scale_outs, scale_attr_map, place, true);
+  ASSERT_EQ(x_in_tensor->data<float>()[0], 4.0f);
+  ASSERT_EQ(x_in->SharedVar()->InplaceVersion(), 1U);
+
+  detail::BackwardStrategy back_st;
+  imperative::BasicEngine engine;
+  engine.Init(vout.get(), back_st);
+  ASSERT_ANY_THROW(engine.Execute());
+
+  // y_in requires gradient, so it can not be written inplace
+  imperative::NameVarBaseMap y_ins = {var_pair("X", vb_vector(1, y_in))};
+  imperative::NameVarBaseMap y_outs = {var_pair("Out", vb_vector(1, y_in))};
+  ASSERT_ANY_THROW(
+      tracer.TraceOp("scale", y_ins, y_outs, scale_attr_map, place, true));
+}
+
+// out = reduce_sum(scale(x, 2) + scale(x, 3)), the two scales are independent
+static std::shared_ptr<imperative::VarBase> TraceScaleBranches(
+    imperative::Tracer* tracer, std::shared_ptr<imperative::VarBase>* x_in,
+    std::shared_ptr<imperative::VarBase>* sum) {
+  x_in->reset(new imperative::VarBase(true, "x_in"));
+  (*x_in)->SetOverridedStopGradient(false);
+  platform::CPUPlace place;
+  std::vector<float> src_data(10, 2.0);
+  auto* x_in_tensor =
+      (*x_in)->MutableVar()->GetMutable<framework::LoDTensor>();
+  x_in_tensor->Resize(framework::make_ddim({2, 5}));
+  paddle::memory::Copy(place, x_in_tensor->mutable_data<float>(place), place,
+                       src_data.data(), sizeof(float) * src_data.size());
+
+  std::vector<std::shared_ptr<imperative::VarBase>> branches;
+  for (float scale : {2.0f, 3.0f}) {
+    std::shared_ptr<imperative::VarBase> branch(
+        new imperative::VarBase(true, "branch"));
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, *x_in))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, branch))};
+    framework::AttributeMap scale_attr_map;
+    scale_attr_map["scale"] = scale;
+    tracer->TraceOp("scale", ins, outs, scale_attr_map, place, true);
+    branches.emplace_back(branch);
+  }
+
+  sum->reset(new imperative::VarBase(true, "sum"));
+  imperative::NameVarBaseMap add_ins = {
+      var_pair("X", vb_vector(1, branches[0])),
+      var_pair("Y", vb_vector(1, branches[1]))};
+  imperative::NameVarBaseMap add_outs = {var_pair("Out", vb_vector(1, *sum))};
+  framework::AttributeMap add_attr_map;
+  tracer->TraceOp("elementwise_add", add_ins, add_outs, add_attr_map, place,
+                  true);
+
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  imperative::NameVarBaseMap reduce_ins = {var_pair("X", vb_vector(1, *sum))};
+  imperative::NameVarBaseMap reduce_outs = {
+      var_pair("Out", vb_vector(1, vout))};
+  framework::AttributeMap reduce_attr_map;
+  tracer->TraceOp("reduce_sum", reduce_ins, reduce_outs, reduce_attr_map,
+                  place, true);
+
+  return vout;
+}
+
+TEST(test_tracer, test_parallel_backward) {
+  imperative::Tracer tracer;
+  std::shared_ptr<imperative::VarBase> x_in, sum;
+  auto vout = TraceScaleBranches(&tracer, &x_in, &sum);
+
+  detail::BackwardStrategy back_st;
+  back_st.num_threads_ = 4;
+  imperative::BasicEngine engine;
+  engine.Init(vout.get(), back_st);
+  engine.Execute();
+
+  auto& x_grad = x_in->GradVar().Get<framework::LoDTensor>();
+  ASSERT_EQ(x_grad.numel(), 10);
+  for (int i = 0; i < x_grad.numel(); ++i) {
+    ASSERT_EQ(x_grad.data<float>()[i], 5.0f);
+  }
+}
+
+TEST(test_tracer, test_release_intermediate_grads) {
+  imperative::Tracer tracer;
+  std::shared_ptr<imperative::VarBase> x_in, sum;
+  auto vout = TraceScaleBranches(&tracer, &x_in, &sum);
+
+  detail::BackwardStrategy back_st;
+  back_st.release_intermediate_grads_ = true;
+  imperative::BasicEngine engine;
+  engine.Init(vout.get(), back_st);
+  engine.Execute();
+
+  // the gradient of sum is released once the grad of elementwise_add runs
+  ASSERT_FALSE(sum->GradVar().IsInitialized());
+  auto& x_grad = x_in->GradVar().Get<framework::LoDTensor>();
+  for (int i = 0; i < x_grad.numel(); ++i) {
+    ASSERT_EQ(x_grad.data<float>()[i], 5.0f);
+  }
+}
+
+// mul and reduce_sum of x in [rows, 5] and y in [5, 2], and the backward
+static void TraceMulAndBackward(int64_t rows) {
+  imperative::Tracer tracer;
+  platform::CPUPlace place;
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(true, "x_in"));
+  x_in->SetOverridedStopGradient(false);
+  std::shared_ptr<imperative::VarBase> y_in(
+      new imperative::VarBase(true, "y_in"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  std::shared_ptr<imperative::VarBase> reduce_sum_out(
+      new imperative::VarBase(true, "reduce_sum_out"));
+  auto* x_in_tensor = x_in->MutableVar()->GetMutable<framework::LoDTensor>();
+  x_in_tensor->Resize(framework::make_ddim({rows, 5}));
+  std::fill_n(x_in_tensor->mutable_data<float>(place), rows * 5, 2.f);
+  auto* y_in_tensor = y_in->MutableVar()->GetMutable<framework::LoDTensor>();
+  y_in_tensor->Resize(framework::make_ddim({5, 2}));
+  std::fill_n(y_in_tensor->mutable_data<float>(place), 10, 2.f);
+
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  tracer.TraceOp("mul", {{"X", {x_in}}, {"Y", {y_in}}}, {{"Out", {vout}}},
+                 mul_attr_map, place, true);
+  tracer.TraceOp("reduce_sum", {{"X", {vout}}}, {{"Out", {reduce_sum_out}}},
+                 framework::AttributeMap(), place, true);
+  detail::BackwardStrategy back_st;
+  imperative::BasicEngine engine;
+  engine.Init(reduce_sum_out.get(), back_st);
+  engine.Execute();
+  ASSERT_TRUE(x_in->GradVar().Get<framework::LoDTensor>().IsInitialized());
+}
+
+TEST(test_tracer, test_cached_kernels) {
+  // The traced ops and the grad ops share the operators of their types, and
+  // their kernels are chosen once for the inputs of the same ranks.
+  FLAGS_dygraph_cache_kernel = true;
+  auto& cache = KernelCache::Instance();
+  cache.Clear();
+  TraceMulAndBackward(2);
+  auto cached = cache.Size();
+  ASSERT_GT(cached, 0UL);
+  for (int64_t rows = 3; rows < 6; ++rows) {
+    TraceMulAndBackward(rows);
+    ASSERT_EQ(cache.Size(), cached);
+  }
+  cache.Clear();
+  FLAGS_dygraph_cache_kernel = false;
+}
+
 TEST(test_tracer, test_current_tracer) {
   // use current_tracer
   auto tracer = std::make_shared<imperative::Tracer>();
@@ -509,3 +738,5 @@ USE_OP(mul_grad);
 USE_OP(reduce_sum);
 USE_OP(reduce_sum_grad);
 USE_OP(elementwise_add);
+USE_OP(reshape2);
+USE_OP(scale);
@@ -12,11 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/imperative/tracer.h"
+#include <algorithm>
 #include <set>
 #include <unordered_set>
 #include <utility>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/imperative/infer_shape_context.h"
 #include "paddle/fluid/imperative/op_base.h"
+#include "paddle/fluid/imperative/profiler.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/string/string_helper.h"
 
@@ -42,19 +46,187 @@ static void PassStopGradient(const NameVarBaseMap& outs, bool generate_grad) {
   }
 }
 
+// The outputs which are the inputs too, i.e., written inplace. The persistable
+// variables, e.g. the parameters updated by the optimizers and the running
+// statistics of batch_norm, are updated inplace by design and not versioned.
+static std::vector<VarBase*> InplaceOutputs(const NameVarBaseMap& ins,
+                                            const NameVarBaseMap& outs) {
+  std::vector<VarBase*> inplace_outs;
+  for (const auto& out_pair : outs) {
+    for (const auto& out : out_pair.second) {
+      if (!out || out->Persistable()) continue;
+      for (const auto& in_pair : ins) {
+        if (std::find(in_pair.second.begin(), in_pair.second.end(), out) !=
+            in_pair.second.end()) {
+          inplace_outs.emplace_back(out.get());
+          break;
+        }
+      }
+    }
+  }
+  return inplace_outs;
+}
+
+// The ops only changing the shape of X, whose Out is a view sharing the
+// memory of X in dygraph instead of a copy. Tensor has no strides, so
+// transpose and slice still copy.
+static bool IsViewOp(const std::string& type, const NameVarBaseMap& ins,
+                     const NameVarBaseMap& outs, const platform::Place& place) {
+  static const std::unordered_set<std::string> kViewOps = {
+      "reshape2", "squeeze2", "unsqueeze2", "flatten2"};
+  // the shape given by the tensors is only known by the kernels
+  if (ins.size() != 1 || !kViewOps.count(type)) return false;
+  auto x_it = ins.find("X");
+  auto out_it = outs.find("Out");
+  if (x_it == ins.end() || x_it->second.size() != 1 || out_it == outs.end() ||
+      out_it->second.size() != 1 || x_it->second[0] == out_it->second[0]) {
+    return false;
+  }
+  const auto& x = x_it->second[0]->Var();
+  if (!x.IsType<framework::LoDTensor>()) return false;
+  const auto& x_tensor = x.Get<framework::LoDTensor>();
+  return x_tensor.IsInitialized() && x_tensor.place() == place &&
+         x_tensor.layout() != framework::DataLayout::kMKLDNN;
+}
+
+static void RunViewOp(const framework::OperatorBase& op,
+                      const NameVarBaseMap& ins, const NameVarBaseMap& outs,
+                      const framework::AttributeMap& attrs) {
+  for (const auto& pair : outs) {
+    for (const auto& var : pair.second) {
+      if (var) {
+        InitializeVariable(var->MutableVar(), var->Type());
+      }
+    }
+  }
+  DygraphInferShapeContext<VarBase> infer_shape_ctx(&ins, &outs, &attrs);
+  static_cast<const framework::OperatorWithKernel&>(op).InferShape(
+      &infer_shape_ctx);
+
+  const auto& x = ins.at("X")[0];
+  const auto& out = outs.at("Out")[0];
+  auto* out_tensor = out->MutableVar()->GetMutable<framework::LoDTensor>();
+  auto out_dims = out_tensor->dims();
+  out_tensor->ShareDataWith(x->Var().Get<framework::LoDTensor>());
+  out_tensor->Resize(out_dims);
+  out->SharedVar()->ShareInplaceVersionWith(x->SharedVar().get());
+}
+
+static bool IsTensorOfType(const VarBase& var,
+                           framework::proto::VarType::Type dtype) {
+  const auto& v = var.Var();
+  return v.IsType<framework::LoDTensor>() &&
+         v.Get<framework::LoDTensor>().IsInitialized() &&
+         v.Get<framework::LoDTensor>().type() == dtype;
+}
+
+bool Tracer::AutoCastInputs(const std::string& type, const NameVarBaseMap& ins,
+                            const platform::Place& place, bool trace_backward,
+                            NameVarBaseMap* new_ins) {
+  using framework::proto::VarType;
+  if (type == "cast") return false;
+  bool to_fp16 = amp_white_ops_.count(type) > 0;
+  if (!to_fp16 && !amp_black_ops_.count(type)) {
+    bool has_fp16 = false, has_fp32 = false;
+    for (const auto& pair : ins) {
+      for (const auto& var : pair.second) {
+        has_fp16 = has_fp16 || IsTensorOfType(*var, VarType::FP16);
+        has_fp32 = has_fp32 || IsTensorOfType(*var, VarType::FP32);
+      }
+    }
+    if (!has_fp16 || !has_fp32) return false;
+  }
+
+  auto src_type = to_fp16 ? VarType::FP32 : VarType::FP16;
+  auto dst_type = to_fp16 ? VarType::FP16 : VarType::FP32;
+  bool casted = false;
+  for (const auto& pair : ins) {
+    auto& vars = (*new_ins)[pair.first];
+    vars.reserve(pair.second.size());
+    for (const auto& var : pair.second) {
+      if (IsTensorOfType(*var, src_type)) {
+        vars.emplace_back(CastVar(var, dst_type, place, trace_backward));
+        casted = true;
+      } else {
+        vars.emplace_back(var);
+      }
+    }
+  }
+  return casted;
+}
+
+std::shared_ptr<VarBase> Tracer::CastVar(const std::shared_ptr<VarBase>& var,
+                                         framework::proto::VarType::Type dtype,
+                                         const platform::Place& place,
+                                         bool trace_backward) {
+  bool cacheable =
+      var->Persistable() && dtype == framework::proto::VarType::FP16;
+  if (cacheable) {
+    auto it = amp_cast_cache_.find(var.get());
+    if (it != amp_cast_cache_.end() && !it->second.first.expired()) {
+      return it->second.second;
+    }
+  }
+
+  auto out = std::make_shared<VarBase>(true, GenerateUniqueName("amp_cast"));
+  framework::AttributeMap attrs = {
+      {"in_dtype", static_cast<int>(var->DataType())},
+      {"out_dtype", static_cast<int>(dtype)}};
+  TraceOp("cast", {{"X", {var}}}, {{"Out", {out}}}, std::move(attrs), place,
+          trace_backward);
+  if (cacheable) {
+    amp_cast_cache_[var.get()] = std::make_pair(var, out);
+  }
+  return out;
+}
+
 void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
                      const NameVarBaseMap& outs, framework::AttributeMap attrs,
                      const platform::Place& place, bool trace_backward) {
+  if (enable_autocast_ && platform::is_gpu_place(place)) {
+    NameVarBaseMap new_ins;
+    if (AutoCastInputs(type, ins, place, trace_backward, &new_ins)) {
+      TraceOp(type, new_ins, outs, std::move(attrs), place, trace_backward);
+      return;
+    }
+  }
+
   VLOG(1) << "Trace Op: " << type;
-  auto op = framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+  const auto& op = OpBase::CachedOperator(type);
   const auto& op_info = op->Info();
   auto* attr_checker = op_info.Checker();
   if (attr_checker) {
     attr_checker->Check(&attrs, true);
   }
 
+  auto inplace_outs = InplaceOutputs(ins, outs);
+  if (trace_backward && op_info.HasNonEmptyGradOpMaker()) {
+    for (auto* var : inplace_outs) {
+      PADDLE_ENFORCE_EQ(
+          var->OverridedStopGradient(), true,
+          platform::errors::InvalidArgument(
+              "The variable %s requiring gradient can not be written inplace "
+              "by %s. Please set its stop_gradient to True, or run the op "
+              "under no_grad.",
+              var->Name(), type));
+    }
+  }
+
+  bool profiling = OpProfiler::Instance().IsEnabled();
   try {
-    OpBase::Run(*op, ins, outs, attrs, place);
+    std::unique_ptr<OpProfileEvent> profile_event;
+    if (profiling) {
+      profile_event.reset(
+          new OpProfileEvent(type, OpProfiler::CurrentScope(), false));
+    }
+    if (IsViewOp(type, ins, outs, place)) {
+      RunViewOp(*op, ins, outs, attrs);
+    } else {
+      OpBase::Run(*op, ins, outs, attrs, place);
+    }
+    if (profile_event) {
+      profile_event->Finish(OutputBytes<VarBase>(outs), place);
+    }
   } catch (platform::EnforceNotMet& exception) {
     framework::AppendErrorOpHint(type, &exception);
     throw std::move(exception);
@@ -71,13 +243,22 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
         "Operator %s raises an unknown exception.", type));
   }
 
+  for (auto* var : inplace_outs) {
+    var->SharedVar()->BumpInplaceVersion();
+  }
+
   if (enable_program_desc_tracing_) {
     VLOG(5) << "Trace op " << type << " into ProgramDesc";
     program_desc_tracer_->InsertOp(type, ins, outs, attrs);
   }
 
   if (ComputeRequiredGrad(ins, outs, trace_backward)) {
-    CreateGradOpNode(*op, ins, outs, attrs, place);
+    auto grad_node = CreateGradOpNode(*op, ins, outs, attrs, place);
+    if (profiling && grad_node) {
+      for (auto& grad_op : *grad_node) {
+        grad_op.SetProfileScope(OpProfiler::CurrentScope());
+      }
+    }
   } else {
     VLOG(3) << "No Grad to track for Op: " << type;
   }
@@ -19,6 +19,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include "ThreadPool.h"
 #include "paddle/fluid/imperative/basic_engine.h"
@@ -90,6 +92,35 @@ class Tracer {
 
   void SetHasGrad(bool has_grad) { has_grad_ = has_grad; }
 
+  // The automatic mixed precision on GPU, which casts the float inputs of the
+  // white ops to FP16, and of the black ops to FP32. The other ops with both
+  // FP16 and FP32 inputs run in FP32. The FP16 casts of the parameters are
+  // cached until the auto cast is disabled, i.e., for a step.
+  void SetEnableAutoCast(bool enabled) {
+    enable_autocast_ = enabled;
+    if (!enabled) {
+      amp_cast_cache_.clear();
+    }
+  }
+
+  bool IsAutoCastEnabled() const { return enable_autocast_; }
+
+  void SetAmpOpLists(const std::unordered_set<std::string>& white_ops,
+                     const std::unordered_set<std::string>& black_ops) {
+    amp_white_ops_ = white_ops;
+    amp_black_ops_ = black_ops;
+  }
+
+ private:
+  bool AutoCastInputs(const std::string& type, const NameVarBaseMap& ins,
+                      const platform::Place& place, bool trace_backward,
+                      NameVarBaseMap* new_ins);
+
+  std::shared_ptr<VarBase> CastVar(const std::shared_ptr<VarBase>& var,
+                                   framework::proto::VarType::Type dtype,
+                                   const platform::Place& place,
+                                   bool trace_backward);
+
  private:
   std::unique_ptr<BasicEngine> basic_engine_;
   std::unique_ptr<jit::ProgramDescTracer> program_desc_tracer_;
@@ -97,6 +128,13 @@ class Tracer {
   std::unique_ptr<UniqueNameGenerator> generator_;
   platform::Place expected_place_;
   bool has_grad_{true};
+  bool enable_autocast_{false};
+  std::unordered_set<std::string> amp_white_ops_;
+  std::unordered_set<std::string> amp_black_ops_;
+  // the parameters, whether they are alive, and their FP16 casts
+  std::unordered_map<VarBase*, std::pair<std::weak_ptr<VarBase>,
+                                         std::shared_ptr<VarBase>>>
+      amp_cast_cache_;
 };
 
 // To access static variable current_tracer
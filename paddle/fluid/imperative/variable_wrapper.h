@@ -14,8 +14,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include "paddle/fluid/framework/variable.h"
 
 namespace paddle {
@@ -91,6 +93,44 @@ class VariableWrapper {
 
   bool HasGradNode() const { return !grad_node_.expired(); }
 
+  // The hooks are called by BasicEngine once the gradient in this variable
+  // is accumulated completely in backward, e.g. to allreduce it early.
+  void AddGradReadyHook(std::function<void()> hook) {
+    grad_ready_hooks_.emplace_back(std::move(hook));
+  }
+
+  bool HasGradReadyHooks() const { return !grad_ready_hooks_.empty(); }
+
+  void CallGradReadyHooks() const {
+    for (auto& hook : grad_ready_hooks_) {
+      hook();
+    }
+  }
+
+  void ClearGradReadyHooks() { grad_ready_hooks_.clear(); }
+
+  // The number of times the data of the variable, or of a view sharing its
+  // memory, is written by inplace ops. The gradient ops check it to find out
+  // the saved forward variables modified after they are saved.
+  uint32_t InplaceVersion() const {
+    return inplace_version_ ? *inplace_version_ : 0;
+  }
+
+  void BumpInplaceVersion() {
+    if (!inplace_version_) {
+      inplace_version_ = std::make_shared<uint32_t>(0);
+    }
+    ++(*inplace_version_);
+  }
+
+  // The view shares the version counter of its base variable.
+  void ShareInplaceVersionWith(VariableWrapper* base) {
+    if (!base->inplace_version_) {
+      base->inplace_version_ = std::make_shared<uint32_t>(0);
+    }
+    inplace_version_ = base->inplace_version_;
+  }
+
   framework::proto::VarType::Type DataType() const {
     const framework::Tensor* tensor = nullptr;
     if (var_.IsInitialized()) {
@@ -151,6 +191,11 @@ class VariableWrapper {
 
   std::weak_ptr<VariableWrapper> grad_var_;
   std::weak_ptr<GradOpNode> grad_node_;
+
+  // created when the variable is written inplace or viewed for the first time
+  std::shared_ptr<uint32_t> inplace_version_;
+
+  std::vector<std::function<void()>> grad_ready_hooks_;
 };
 
 }  // namespace imperative
@@ -32,6 +32,7 @@
 #include <vector>
 
 #include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_analysis_config.h"
@@ -60,6 +61,7 @@ struct Argument {
   using unique_ptr_t = std::unique_ptr<void, std::function<void(void*)>>;
   using fusion_statis_t = std::unordered_map<std::string, int>;
   using input_shape_t = std::map<std::string, std::vector<int>>;
+  using input_shapes_t = std::vector<input_shape_t>;
 
   bool Has(const std::string& key) const { return valid_fields_.count(key); }
   // If we set the model using config.SetModelBuffer,
@@ -132,6 +134,9 @@ struct Argument {
   DECL_ARGUMENT_FIELD(model_program_path, ModelProgramPath, std::string);
   DECL_ARGUMENT_FIELD(model_params_path, ModelParamsPath, std::string);
   DECL_ARGUMENT_FIELD(model_from_memory, ModelFromMemory, bool);
+  DECL_ARGUMENT_FIELD(params_by_mmap, ParamsByMmap, bool);
+  DECL_ARGUMENT_FIELD(model_cipher_config, ModelCipherConfig, std::string);
+  DECL_ARGUMENT_FIELD(model_cipher_key, ModelCipherKey, std::string);
   DECL_ARGUMENT_FIELD(optim_cache_dir, OptimCacheDir, std::string);
   DECL_ARGUMENT_FIELD(enable_analysis_optim, EnableAnalysisOptim, bool);
 
@@ -155,6 +160,8 @@ struct Argument {
   // Pass a set of op types to enable its mkldnn kernel
   DECL_ARGUMENT_FIELD(mkldnn_enabled_op_types, MKLDNNEnabledOpTypes,
                       std::unordered_set<std::string>);
+  // The cost table to check the MKLDNN and cuDNN placements.
+  DECL_ARGUMENT_FIELD(placement_cost_table, PlacementCostTable, std::string);
   // The cache capacity of different input shapes for mkldnn.
   DECL_ARGUMENT_FIELD(mkldnn_cache_capacity, MkldnnCacheCapacity, int);
 
@@ -183,6 +190,16 @@ struct Argument {
   DECL_ARGUMENT_FIELD(min_input_shape, MinInputShape, input_shape_t);
   DECL_ARGUMENT_FIELD(max_input_shape, MaxInputShape, input_shape_t);
   DECL_ARGUMENT_FIELD(optim_input_shape, OptimInputShape, input_shape_t);
+  // the extra optimization profiles of trt dynamic shape
+  // the id naming the trt engines, which are shared by the predictors with
+  // the same owner
+  DECL_ARGUMENT_FIELD(tensorrt_engine_owner_id, TensorRtEngineOwnerId, int);
+  DECL_ARGUMENT_FIELD(extra_min_input_shapes, ExtraMinInputShapes,
+                      input_shapes_t);
+  DECL_ARGUMENT_FIELD(extra_max_input_shapes, ExtraMaxInputShapes,
+                      input_shapes_t);
+  DECL_ARGUMENT_FIELD(extra_optim_input_shapes, ExtraOptimInputShapes,
+                      input_shapes_t);
   DECL_ARGUMENT_FIELD(disable_trt_plugin_fp16, CloseTrtPluginFp16, bool);
 
   DECL_ARGUMENT_FIELD(use_tensorrt, UseTensorRT, bool);
@@ -194,12 +211,15 @@ struct Argument {
   DECL_ARGUMENT_FIELD(tensorrt_use_static_engine, TensorRtUseStaticEngine,
                       bool);
   DECL_ARGUMENT_FIELD(tensorrt_use_calib_mode, TensorRtUseCalibMode, bool);
+  DECL_ARGUMENT_FIELD(tensorrt_estimate_benefit, TensorRtEstimateBenefit,
+                      bool);
 
   DECL_ARGUMENT_FIELD(lite_passes_filter, LitePassesFilter,
                       std::vector<std::string>);
   DECL_ARGUMENT_FIELD(lite_ops_filter, LiteOpsFilter, std::vector<std::string>);
   DECL_ARGUMENT_FIELD(lite_precision_mode, LitePrecisionMode,
                       AnalysisConfig::Precision);
+  DECL_ARGUMENT_FIELD(lite_zero_copy, LiteZeroCopy, bool);
 
   // Memory optimized related.
   DECL_ARGUMENT_FIELD(enable_memory_optim, EnableMemoryOptim, bool);
@@ -208,6 +228,20 @@ struct Argument {
   // optimization relays on the sort algorithm.
   DECL_ARGUMENT_FIELD(memory_optim_sort_kind, MemoryOptimSortKind, int);
 
+  // The batch size used to estimate the tensor sizes of the static memory
+  // plan, the plan is made only if this field is set.
+  DECL_ARGUMENT_FIELD(static_memory_plan_batch_size, StaticMemoryPlanBatchSize,
+                      int);
+  // The offsets of the temporary tensors in one preallocated arena.
+  DECL_ARGUMENT_FIELD(static_memory_plan, StaticMemoryPlan,
+                      framework::StaticMemoryPlan);
+  // The upper bounds of the unknown dimensions of the shape buckets, a static
+  // memory plan is made for each bucket instead if this field is set.
+  DECL_ARGUMENT_FIELD(static_memory_plan_buckets, StaticMemoryPlanBuckets,
+                      std::vector<int>);
+  DECL_ARGUMENT_FIELD(static_memory_plans, StaticMemoryPlans,
+                      framework::BucketedStaticMemoryPlan);
+
   // The program transformed by IR analysis phase.
   DECL_ARGUMENT_UNIQUE_FIELD(ir_analyzed_program, IrAnalyzedProgram,
                              framework::proto::ProgramDesc);
@@ -66,6 +66,10 @@ void IRPassManager::CreatePasses(Argument *argument,
     } else if (pass_name == "cudnn_placement_pass") {
       pass->Set("cudnn_enabled_op_types",
                 new std::unordered_set<std::string>());
+    } else if (pass_name == "mkldnn_cost_placement_pass" ||
+               pass_name == "cudnn_cost_placement_pass") {
+      pass->Set("cost_table",
+                new std::string(argument->placement_cost_table()));
 #ifdef PADDLE_WITH_MKLDNN
     } else if (pass_name == "cpu_quantize_placement_pass") {
       pass->Set("quantize_enabled_op_types",
@@ -89,10 +93,16 @@ void IRPassManager::CreatePasses(Argument *argument,
       auto precision_mode = argument->tensorrt_precision_mode();
       bool enable_int8 = precision_mode == AnalysisConfig::Precision::kInt8;
 
-      pass->Set("predictor_id", new int(argument->predictor_id()));
+      // the engines are named by the id of their owner
+      pass->Set("predictor_id",
+                new int(argument->Has("tensorrt_engine_owner_id")
+                            ? argument->tensorrt_engine_owner_id()
+                            : argument->predictor_id()));
       bool use_calib_mode = argument->tensorrt_use_calib_mode();
       pass->Set("enable_int8", new bool(enable_int8));
       pass->Set("use_calib_mode", new bool(use_calib_mode));
+      pass->Set("estimate_benefit",
+                new bool(argument->tensorrt_estimate_benefit()));
       pass->Set("precision_mode",
                 new AnalysisConfig::Precision(precision_mode));
 
@@ -130,6 +140,13 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("optim_input_shape",
                 new std::map<std::string, std::vector<int>>(
                     argument->optim_input_shape()));
+      using ShapesType = std::vector<std::map<std::string, std::vector<int>>>;
+      pass->Set("extra_min_input_shapes",
+                new ShapesType(argument->extra_min_input_shapes()));
+      pass->Set("extra_max_input_shapes",
+                new ShapesType(argument->extra_max_input_shapes()));
+      pass->Set("extra_optim_input_shapes",
+                new ShapesType(argument->extra_optim_input_shapes()));
       // Setting the disable_trt_plugin_fp16 to true means that TRT plugin will
       // not
       // run fp16.
@@ -146,6 +163,7 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("predictor_id", new int(argument->predictor_id()));
       pass->Set("enable_int8", new bool(enable_int8));
       pass->Set("use_gpu", new bool(argument->use_gpu()));
+      pass->Set("zero_copy", new bool(argument->lite_zero_copy()));
     }
     disable_logs_ = argument->disable_logs();
     if (pass_name == "fc_fuse_pass") {
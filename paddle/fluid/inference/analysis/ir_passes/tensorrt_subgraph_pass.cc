@@ -15,6 +15,8 @@
 #include <algorithm>
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 #include "paddle/fluid/framework/ir/subgraph_detector.h"
@@ -23,6 +25,8 @@
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #include "paddle/fluid/inference/tensorrt/engine.h"
 #include "paddle/fluid/inference/tensorrt/op_teller.h"
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin_factory.h"
+#include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/string/pretty_log.h"
 
 namespace paddle {
@@ -31,6 +35,126 @@ namespace analysis {
 
 using framework::ir::Node;
 
+namespace {
+
+using ShapeMap = std::map<std::string, std::vector<int>>;
+
+std::string ShapesToString(const ShapeMap &shapes) {
+  std::string str;
+  for (auto &item : shapes) {
+    str += item.first + ":";
+    for (auto dim : item.second) {
+      str += std::to_string(dim) + ",";
+    }
+    str += ";";
+  }
+  return str;
+}
+
+// The versions of the plugins which can be deserialized with an engine.
+std::string DynamicPluginVersions() {
+#if IS_TRT_VERSION_GE(6000)
+  return inference::Singleton<
+             tensorrt::plugin::DynamicPluginFactoryTensorRT>::Global()
+      .Versions();
+#else
+  return "";
+#endif
+}
+
+// A rough estimate of what running a sub-graph in one engine saves over
+// running its ops in Paddle, in the unit of the time of launching an op. Every
+// op fused saves its launch, and the compute bound ops further gain from the
+// kernels and precisions of TensorRT, while the engine costs its own launch
+// and a copy, i.e., a binding, for each variable it exchanges with Paddle.
+constexpr double kFusedOpGain = 1.;
+constexpr double kComputeOpGain = 4.;
+constexpr double kEngineLaunchCost = 2.;
+constexpr double kBoundaryVarCost = 1.;
+
+double EstimateEngineBenefit(const std::vector<Node *> &subgraph) {
+  static const std::set<std::string> compute_ops = {
+      "conv2d", "depthwise_conv2d", "conv2d_transpose", "conv2d_fusion",
+      "mul",    "matmul",           "fc",               "pool2d"};
+  double gain = 0;
+  for (auto *op : subgraph) {
+    gain +=
+        compute_ops.count(op->Op()->Type()) ? kComputeOpGain : kFusedOpGain;
+  }
+  double cost = kEngineLaunchCost +
+                kBoundaryVarCost *
+                    framework::ir::CountBoundaryVarsOfSubGraph(subgraph);
+  return gain - cost;
+}
+
+std::string CountsToString(const std::map<std::string, int> &counts) {
+  std::string str;
+  for (auto &item : counts) {
+    if (!str.empty()) str += ", ";
+    str += item.first + " x" + std::to_string(item.second);
+  }
+  return str;
+}
+
+// Report the ops cutting each TensorRT subgraph, i.e., the unsupported ops
+// around it, and the sub-graphs of supported ops left to Paddle with the rules
+// rejecting them, to tell which ops fragment the model into many engines.
+void ReportSubgraphCuts(framework::ir::Graph *graph,
+                        const framework::ir::SubGraphFuser &fuser,
+                        int min_subgraph_size) {
+  auto is_live_op = [](Node *node) {
+    return node->IsOp() && node->Op() &&
+           !framework::ir::Agent(node).deleted();
+  };
+  std::vector<Node *> engines;
+  for (auto *node : graph->Nodes()) {
+    if (is_live_op(node) && !framework::ir::Agent(node).subgraph()->empty()) {
+      engines.push_back(node);
+    }
+  }
+  std::sort(engines.begin(), engines.end(),
+            [](Node *a, Node *b) { return a->id() < b->id(); });
+
+  string::PrettyLogDetail("---  detect %d TensorRT sub-graphs", engines.size());
+  for (size_t i = 0; i < engines.size(); ++i) {
+    auto *engine = engines[i];
+    std::map<std::string, int> cuts;
+    auto count_cut = [&cuts, &is_live_op](Node *op) {
+      if (!is_live_op(op) || !framework::ir::Agent(op).subgraph()->empty())
+        return;
+      auto &type = op->Op()->Type();
+      if (type != "feed" && type != "fetch") ++cuts[type];
+    };
+    for (auto *var : engine->inputs) {
+      for (auto *op : var->inputs) count_cut(op);
+    }
+    for (auto *var : engine->outputs) {
+      for (auto *op : var->outputs) count_cut(op);
+    }
+    string::PrettyLogDetail(
+        "---    sub-graph %d: %d ops, cut by %s", i,
+        framework::ir::Agent(engine).subgraph()->size(),
+        cuts.empty() ? std::string("the inputs and outputs of the model")
+                     : CountsToString(cuts));
+  }
+
+  using RejectReason = framework::ir::SubGraphFuser::RejectReason;
+  for (auto &rejected : fuser.rejected_subgraphs()) {
+    std::map<std::string, int> ops;
+    for (auto *op : rejected.nodes) ++ops[op->Op()->Type()];
+    std::string rule =
+        rejected.reason == RejectReason::kMinSubgraphSize
+            ? "it has no more than " + std::to_string(min_subgraph_size) +
+                  " ops, the min_subgraph_size"
+            : std::string("its engine is estimated to cost more than it gains");
+    string::PrettyLogDetail(
+        "---    sub-graph of %s left to Paddle, since %s", CountsToString(ops),
+        rule);
+  }
+}
+
+}  // namespace
+
 void analysis::TensorRtSubgraphPass::ApplyImpl(
     framework::ir::Graph *graph) const {
   framework::ir::FusePassBase::Init("tensorrt_subgraph_pass", graph);
@@ -43,10 +167,24 @@ void analysis::TensorRtSubgraphPass::ApplyImpl(
                                              no_calib_int8);
   };
 
+  // Leave the sub-graphs whose engines would cost more than they gain to
+  // Paddle, e.g., a few cheap ops cut by unsupported ops on both sides, if
+  // AnalysisConfig::EnableTensorRtBenefitEstimate is on.
+  framework::ir::SubGraphFuser::SubgraphBenefitTeller benefit_teller;
+  if (Get<bool>("estimate_benefit")) {
+    benefit_teller = [](const std::vector<Node *> &subgraph) {
+      double benefit = EstimateEngineBenefit(subgraph);
+      VLOG(3) << "The benefit of a TensorRT sub-graph of " << subgraph.size()
+              << " ops is estimated to be " << benefit;
+      return benefit > 0;
+    };
+  }
+
   framework::ir::SubGraphFuser fuser(
       graph, teller, Get<int>("min_subgraph_size") /*min subgraph size*/,
-      "tensorrt_engine");
+      "tensorrt_engine", benefit_teller);
   fuser();
+  ReportSubgraphCuts(graph, fuser, Get<int>("min_subgraph_size"));
 
   std::vector<std::string> graph_param_names =
       ExtractParameters(graph->Nodes());
@@ -172,6 +310,10 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
       Get<std::map<std::string, std::vector<int>>>("max_input_shape");
   auto opt_input_shape =
       Get<std::map<std::string, std::vector<int>>>("optim_input_shape");
+  using ShapesType = std::vector<std::map<std::string, std::vector<int>>>;
+  auto extra_min_input_shapes = Get<ShapesType>("extra_min_input_shapes");
+  auto extra_max_input_shapes = Get<ShapesType>("extra_max_input_shapes");
+  auto extra_opt_input_shapes = Get<ShapesType>("extra_optim_input_shapes");
 
   // The following procedure is used to rename all the intermediate
   // variables and the output variables of the subgraph.
@@ -279,6 +421,7 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
     min_input_shape = {};
     max_input_shape = {};
     opt_input_shape = {};
+    extra_min_input_shapes.clear();
   }
 
   if (min_input_shape.size() > 0 && TRT_VERSION > 6000) {
@@ -293,24 +436,57 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
   // When running fp16, the output accuracy of the model will be affected,
   // closing the plugin fp16 may bring some improvement on accuracy.
   bool disable_trt_plugin_fp16 = Get<bool>("disable_trt_plugin_fp16");
-  tensorrt::TensorRTEngine *trt_engine =
-      inference::Singleton<inference::tensorrt::TRTEngineManager>::Global()
-          .Create(engine_key + std::to_string(predictor_id),
-                  Get<int>("max_batch_size"), Get<int>("workspace_size"),
-                  precision_mode, calibrator.get(), Get<int>("gpu_device_id"),
-                  min_input_shape, max_input_shape, opt_input_shape,
-                  disable_trt_plugin_fp16);
+  auto &engine_manager =
+      inference::Singleton<inference::tensorrt::TRTEngineManager>::Global();
+  if (engine_manager.Has(engine_key + std::to_string(predictor_id))) {
+    // the engine is shared with another predictor which has built it
+    LOG(INFO) << "Share the TRT engine " << engine_key << " built before.";
+    return;
+  }
+  tensorrt::TensorRTEngine *trt_engine = engine_manager.Create(
+      engine_key + std::to_string(predictor_id), Get<int>("max_batch_size"),
+      Get<int>("workspace_size"), precision_mode, calibrator.get(),
+      Get<int>("gpu_device_id"), min_input_shape, max_input_shape,
+      opt_input_shape, disable_trt_plugin_fp16);
+  for (size_t i = 0; i < extra_min_input_shapes.size(); ++i) {
+    trt_engine->AddOptimizationProfile(extra_min_input_shapes[i],
+                                       extra_max_input_shapes[i],
+                                       extra_opt_input_shapes[i]);
+  }
 
   bool need_serialize = (use_static_engine && !load_from_memory);
+  // A serialized engine is only valid for the same shape profiles,
+  // precision, plugins, TensorRT version and GPU architecture.
+  std::string serialized_engine_key;
   if (need_serialize) {
+    std::string profiles = ShapesToString(min_input_shape) + "|" +
+                           ShapesToString(max_input_shape) + "|" +
+                           ShapesToString(opt_input_shape);
+    for (size_t i = 0; i < extra_min_input_shapes.size(); ++i) {
+      profiles += "|" + ShapesToString(extra_min_input_shapes[i]) + "|" +
+                  ShapesToString(extra_max_input_shapes[i]) + "|" +
+                  ShapesToString(extra_opt_input_shapes[i]);
+    }
+    std::string key_str =
+        engine_key + profiles + "precision" +
+        std::to_string(static_cast<int>(precision_mode)) + "batch" +
+        std::to_string(Get<int>("max_batch_size")) + "plugin_fp16" +
+        std::to_string(disable_trt_plugin_fp16) + "plugins" +
+        DynamicPluginVersions() + "trt" + std::to_string(TRT_VERSION) + "sm" +
+        std::to_string(
+            platform::GetCUDAComputeCapability(Get<int>("gpu_device_id")));
+    serialized_engine_key =
+        std::to_string(std::hash<std::string>()(key_str));
+
     trt_engine_serialized_data = GetTrtEngineSerializedData(
-        Get<std::string>("model_opt_cache_dir"), engine_key);
+        Get<std::string>("model_opt_cache_dir"), serialized_engine_key);
     // we can load the engine info serialized before from the disk.
     if (!trt_engine_serialized_data.empty()) {
       trt_engine->Deserialize(trt_engine_serialized_data);
       LOG(INFO) << "Load TRT Optimized Info from "
                 << GetTrtEngineSerializedPath(
-                       Get<std::string>("model_opt_cache_dir"), engine_key);
+                       Get<std::string>("model_opt_cache_dir"),
+                       serialized_engine_key);
       return;
     }
   }
@@ -337,7 +513,7 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
                     serialized_engine_data->size());
     SaveTrtEngineSerializedDataToFile(
         GetTrtEngineSerializedPath(Get<std::string>("model_opt_cache_dir"),
-                                   engine_key),
+                                   serialized_engine_key),
         trt_engine_serialized_data);
   }
 }
@@ -43,12 +43,22 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
     auto program =
         LoadModel(argument->model_dir(), argument->scope_ptr(), place);
     argument->SetMainProgram(program.release());
+  } else if (argument->model_program_path_valid() &&
+             argument->model_params_path_valid() &&
+             argument->model_cipher_key_valid()) {
+    framework::Executor exe(place);
+    auto program = LoadEncrypted(
+        &exe, argument->scope_ptr(), argument->model_program_path(),
+        argument->model_params_path(), argument->model_cipher_config(),
+        argument->model_cipher_key());
+    argument->SetMainProgram(program.release());
   } else if (argument->model_program_path_valid() &&
              argument->model_params_path_valid()) {
     auto program = LoadModel(
         argument->model_program_path(), argument->model_params_path(),
         argument->scope_ptr(), place,
-        argument->model_from_memory_valid() && argument->model_from_memory());
+        argument->model_from_memory_valid() && argument->model_from_memory(),
+        argument->params_by_mmap_valid() && argument->params_by_mmap());
     argument->SetMainProgram(program.release());
   } else {
     PADDLE_THROW(
@@ -72,10 +82,10 @@ std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
 std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
     const std::string &program_path, const std::string &params_path,
     framework::Scope *scope, const platform::Place &place,
-    bool model_from_memory) {
+    bool model_from_memory, bool params_by_mmap) {
   framework::Executor exe(place);
   if (!model_from_memory) {
-    return Load(&exe, scope, program_path, params_path);
+    return Load(&exe, scope, program_path, params_path, params_by_mmap);
   } else {
     return LoadFromMemory(&exe, scope, program_path, params_path);
   }
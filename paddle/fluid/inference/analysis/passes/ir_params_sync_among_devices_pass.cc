@@ -16,6 +16,7 @@
 #include "paddle/fluid/framework/data_layout.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -46,6 +47,13 @@ void IrParamsSyncAmongDevicesPass::RunImpl(Argument *argument) {
   auto *scope = argument->scope_ptr();
   std::vector<std::string> all_vars = scope->LocalVarNames();
 
+  // The parameters are copied to the GPU at last in parallel, from the CPU
+  // tensors sharing their data.
+  std::vector<framework::LoDTensor> cpu_tensors;
+  cpu_tensors.reserve(all_vars.size());
+  std::vector<framework::LoDTensor *> gpu_tensors;
+  gpu_tensors.reserve(all_vars.size());
+
   // We get all the vars from local_scope instead of the ProgramDesc.
   // Because there exists the case that new parameter variables are not added to
   // the program in the analysis pass.
@@ -61,20 +69,27 @@ void IrParamsSyncAmongDevicesPass::RunImpl(Argument *argument) {
         var->IsType<framework::Tensor>()) {
       auto *t = var->GetMutable<framework::LoDTensor>();
 
-      platform::CPUPlace cpu_place;
-      framework::LoDTensor temp_tensor;
-      temp_tensor.Resize(t->dims());
-      temp_tensor.mutable_data<float>(cpu_place);
-
-      // Copy the parameter data to a tmp tensor.
-      TensorCopySync(*t, cpu_place, &temp_tensor);
+      cpu_tensors.emplace_back();
+      cpu_tensors.back().ShareDataWith(*t);
+      cpu_tensors.back().set_lod(t->lod());
       // Reallocation the space on GPU
       t->clear();
-
-      // Copy parameter data to newly allocated GPU space.
-      TensorCopySync(temp_tensor, place, t);
+      gpu_tensors.push_back(t);
     }
   }
+
+#ifdef PADDLE_WITH_CUDA
+  std::vector<const framework::LoDTensor *> src;
+  src.reserve(cpu_tensors.size());
+  for (auto &tensor : cpu_tensors) {
+    src.push_back(&tensor);
+  }
+  ParallelCopyToGPU(src, BOOST_GET_CONST(platform::CUDAPlace, place),
+                    gpu_tensors);
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "CUDAPlace is not supported when not compiled with CUDA"));
+#endif
 }
 
 std::string IrParamsSyncAmongDevicesPass::repr() const {
@@ -27,6 +27,7 @@
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 #include "paddle/fluid/framework/ir/graph_to_program_pass.h"
 #include "paddle/fluid/framework/ir/graph_traits.h"
+#include "paddle/fluid/framework/ir/shape_propagation_pass.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/string/pretty_log.h"
@@ -117,8 +118,8 @@ int DataTypeToSpace(framework::proto::VarType_Type type) {
 }
 
 void MemoryOptimizePass::CollectVarMemorySize(
-    space_table_t* space_table) const {
-  const int fake_batch_size = 1;
+    int batch_size, space_table_t* space_table) const {
+  const int fake_batch_size = batch_size;
 
   auto valid_var = [&](framework::ir::Node* node) -> bool {
     std::set<std::string> invalid_op = {"while",
@@ -147,6 +148,13 @@ void MemoryOptimizePass::CollectVarMemorySize(
     }
     return true;
   };
+  // The shapes propagated through the graph, if any, are used instead of the
+  // declared ones, which may leave the dims other than the batch unknown.
+  const framework::ir::VarShapeMap* var_shapes = nullptr;
+  if (graph_->Has(framework::ir::kVarShapes)) {
+    var_shapes =
+        &graph_->Get<framework::ir::VarShapeMap>(framework::ir::kVarShapes);
+  }
   // Collect tensors from graph.
   for (auto* node : graph_->Nodes()) {
     if (node->IsVar() &&
@@ -156,12 +164,21 @@ void MemoryOptimizePass::CollectVarMemorySize(
       // Parameters will not be reused.
       if (node->Var()->Persistable()) continue;
       auto shape = node->Var()->GetShape();
-      for (auto& v : shape) {
-        if (v < 0) v = fake_batch_size;
+      auto it = var_shapes ? var_shapes->find(node->Name())
+                           : framework::ir::VarShapeMap::const_iterator();
+      if (var_shapes && it != var_shapes->end()) {
+        shape = it->second;
+        for (auto& v : shape) {
+          if (v < 0) v = -v * fake_batch_size;
+        }
+      } else {
+        for (auto& v : shape) {
+          if (v < 0) v = fake_batch_size;
+        }
       }
 
-      int size = std::accumulate(shape.begin(), shape.end(), 1,
-                                 std::multiplies<int>());
+      int64_t size = std::accumulate(shape.begin(), shape.end(), int64_t(1),
+                                     std::multiplies<int64_t>());
       (*space_table)[node->Var()->Name()] =
           size * DataTypeToSpace(node->Var()->GetDataType());
     }
@@ -293,6 +310,131 @@ void UpdateOpDescsByReuse(
   }
 }
 
+// Assign each cluster a fixed offset in one arena. Clusters whose lifetimes
+// overlap must not overlap in the arena. The clusters are placed from the
+// largest to the smallest, each in the smallest gap between the placed
+// clusters alive at the same time that fits, or above all of them, which is
+// known to be close to the optimum for inference graphs.
+void MemoryOptimizePass::MakeStaticMemoryPlan(
+    const std::unordered_map<std::string, lifecycle_t>& lifecycles,
+    const std::unordered_map<std::string, std::string>& node2cluster,
+    const std::unordered_map<std::string, int>& cluster_size,
+    framework::StaticMemoryPlan* plan) const {
+  // Large enough for the alignment requirement of all the devices.
+  const size_t kAlignment = 256;
+
+  // The outputs of the graph are read after the last operator, so they are
+  // kept alive until the end.
+  std::unordered_set<std::string> graph_outputs;
+  for (auto* node : graph_->Nodes()) {
+    if (!node->IsVar()) continue;
+    bool read_by_op = std::any_of(
+        node->outputs.begin(), node->outputs.end(),
+        [](Node* op) { return op->IsOp() && op->Name() != "fetch"; });
+    if (!read_by_op) graph_outputs.insert(node->Name());
+  }
+
+  struct Block {
+    std::string name;
+    size_t size;
+    lifecycle_t lifetime;
+    size_t offset;
+  };
+  std::unordered_map<std::string, Block> blocks;
+  for (auto& item : node2cluster) {
+    auto& lifetime = lifecycles.at(item.first);
+    auto it = blocks.find(item.second);
+    if (it == blocks.end()) {
+      size_t size = cluster_size.at(item.second);
+      size = (size + kAlignment - 1) / kAlignment * kAlignment;
+      it = blocks.emplace(item.second, Block{item.second, size, lifetime, 0})
+               .first;
+    } else {
+      it->second.lifetime.first =
+          std::min(it->second.lifetime.first, lifetime.first);
+      it->second.lifetime.second =
+          std::max(it->second.lifetime.second, lifetime.second);
+    }
+    if (graph_outputs.count(item.first)) {
+      it->second.lifetime.second = std::numeric_limits<int>::max();
+    }
+  }
+
+  std::vector<Block*> sorted;
+  for (auto& item : blocks) {
+    if (item.second.size > 0) sorted.push_back(&item.second);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](Block* a, Block* b) {
+    return a->size != b->size ? a->size > b->size : a->name < b->name;
+  });
+
+  plan->arena_size = 0;
+  plan->var_ranges.clear();
+  std::vector<Block*> placed;
+  for (auto* block : sorted) {
+    // The ranges occupied by the placed blocks alive at the same time.
+    std::vector<std::pair<size_t, size_t>> occupied;
+    for (auto* other : placed) {
+      if (block->lifetime.second >= other->lifetime.first &&
+          other->lifetime.second >= block->lifetime.first) {
+        occupied.emplace_back(other->offset, other->offset + other->size);
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+    size_t top = 0;
+    size_t offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    for (auto& range : occupied) {
+      if (range.first >= top + block->size && range.first - top < best_gap) {
+        best_gap = range.first - top;
+        offset = top;
+      }
+      top = std::max(top, range.second);
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) offset = top;
+    block->offset = offset;
+    placed.push_back(block);
+    plan->var_ranges[block->name] = std::make_pair(offset, block->size);
+    plan->arena_size = std::max(plan->arena_size, offset + block->size);
+  }
+  LOG(INFO) << "Static memory plan: " << plan->var_ranges.size()
+            << " tensors in an arena of " << plan->arena_size << " bytes";
+}
+
+// Plan the offsets for each bucket, with the size of each cluster estimated
+// by the bucket. The feed variables are written by the user before the bucket
+// of a request is known, so they are left to the allocator.
+void MemoryOptimizePass::MakeBucketedStaticMemoryPlan(
+    const std::unordered_map<std::string, lifecycle_t>& lifecycles,
+    const std::unordered_map<std::string, std::string>& node2cluster,
+    const std::vector<int>& buckets,
+    framework::BucketedStaticMemoryPlan* plans) const {
+  std::unordered_set<std::string> feeds;
+  for (auto* node : graph_->Nodes()) {
+    if (!node->IsOp() || node->Name() != "feed") continue;
+    for (auto* out : node->outputs) {
+      feeds.insert(out->Name());
+    }
+  }
+  std::unordered_map<std::string, std::string> planned;
+  for (auto& item : node2cluster) {
+    if (!feeds.count(item.first)) planned.insert(item);
+  }
+
+  plans->clear();
+  for (int bucket : buckets) {
+    space_table_t space_table;
+    CollectVarMemorySize(bucket, &space_table);
+    std::unordered_map<std::string, int> cluster_size;
+    for (auto& item : planned) {
+      int size = space_table.count(item.first) ? space_table.at(item.first) : 0;
+      auto& max_size = cluster_size[item.second];
+      max_size = std::max(max_size, size);
+    }
+    MakeStaticMemoryPlan(lifecycles, planned, cluster_size, &(*plans)[bucket]);
+  }
+}
+
 std::string MemoryOptimizePass::repr() const { return "memory optimize pass"; }
 
 void MemoryOptimizePass::RunImpl(Argument* argument) {
@@ -308,6 +450,18 @@ void MemoryOptimizePass::RunImpl(Argument* argument) {
   // mapping table.
   if (!argument->enable_memory_optim()) return;
   graph_ = argument->main_graph_ptr();
+  bool static_memory_plan = argument->static_memory_plan_batch_size_valid();
+  int batch_size = 1;
+  if (static_memory_plan) {
+    batch_size = argument->static_memory_plan_batch_size();
+  }
+  std::vector<int> buckets;
+  if (argument->static_memory_plan_buckets_valid()) {
+    buckets = argument->static_memory_plan_buckets();
+    std::sort(buckets.begin(), buckets.end());
+  }
+  // the reuse plan is made by the largest bucket
+  if (!buckets.empty()) batch_size = buckets.back();
 
   int sort_kind = 0;
   std::unordered_map<std::string, lifecycle_t> lifecycles;
@@ -316,10 +470,49 @@ void MemoryOptimizePass::RunImpl(Argument* argument) {
   std::unordered_map<std::string, int> cluster_size;
 
   CollectLifeCycle(&lifecycles, sort_kind);
-  CollectVarMemorySize(&space_table);
+  CollectVarMemorySize(batch_size, &space_table);
   MakeSimpleReusePlan(lifecycles, space_table, &node2cluster, &cluster_size);
-  UpdateOpDescsByReuse(graph_, node2cluster, sort_kind);
-  return;
+
+  size_t no_reuse_size = 0;
+  for (auto& item : node2cluster) {
+    no_reuse_size += space_table.at(item.first);
+  }
+  size_t reuse_size = 0;
+  for (auto& item : cluster_size) {
+    reuse_size += item.second;
+  }
+  LOG(INFO) << "Memory optimization: " << node2cluster.size()
+            << " tensors take " << no_reuse_size << " bytes, "
+            << cluster_size.size() << " reused tensors take " << reuse_size
+            << " bytes";
+
+  if (!static_memory_plan && buckets.empty()) {
+    UpdateOpDescsByReuse(graph_, node2cluster, sort_kind);
+    return;
+  }
+  // With the static memory plan, each variable keeps its own name and is
+  // planned by its own size and lifetime, instead of taking the whole slot
+  // of the largest variable in its cluster.
+  std::unordered_map<std::string, std::string> identity;
+  std::unordered_map<std::string, int> var_size;
+  for (auto& item : node2cluster) {
+    identity[item.first] = item.first;
+    var_size[item.first] = space_table.at(item.first);
+  }
+  if (!buckets.empty()) {
+    framework::BucketedStaticMemoryPlan plans;
+    MakeBucketedStaticMemoryPlan(lifecycles, identity, buckets, &plans);
+    LOG(INFO) << "Memory optimization: the static memory plan takes "
+              << plans.rbegin()->second.arena_size << " bytes for the bucket "
+              << plans.rbegin()->first;
+    argument->SetStaticMemoryPlans(plans);
+  } else {
+    framework::StaticMemoryPlan plan;
+    MakeStaticMemoryPlan(lifecycles, identity, var_size, &plan);
+    LOG(INFO) << "Memory optimization: the static memory plan takes "
+              << plan.arena_size << " bytes";
+    argument->SetStaticMemoryPlan(plan);
+  }
 }
 
 }  // namespace analysis
@@ -35,6 +35,11 @@ namespace analysis {
 * name of var and the value in the table represents the current name of var.
 * 3. Perform reuse plan: Replace all var's name in the model according to the
 * mapping table.
+* 4. Optionally, make a static memory plan instead of renaming: assign each
+* var a fixed offset in one arena by its own size and lifetime, so that the
+* executor need not call the allocator when running the model, and a small
+* var does not take a whole slot of a large one. With the shape buckets, the
+* offsets are planned for each bucket over the same lifetimes.
 */
 class MemoryOptimizePass : public AnalysisPass {
  public:
@@ -51,7 +56,19 @@ class MemoryOptimizePass : public AnalysisPass {
       std::unordered_map<std::string, lifecycle_t> *lifecycles,
       int sort_kind) const;
 
-  void CollectVarMemorySize(space_table_t *space_table) const;
+  void CollectVarMemorySize(int batch_size, space_table_t *space_table) const;
+
+  void MakeStaticMemoryPlan(
+      const std::unordered_map<std::string, lifecycle_t> &lifecycles,
+      const std::unordered_map<std::string, std::string> &node2cluster,
+      const std::unordered_map<std::string, int> &cluster_size,
+      framework::StaticMemoryPlan *plan) const;
+
+  void MakeBucketedStaticMemoryPlan(
+      const std::unordered_map<std::string, lifecycle_t> &lifecycles,
+      const std::unordered_map<std::string, std::string> &node2cluster,
+      const std::vector<int> &buckets,
+      framework::BucketedStaticMemoryPlan *plans) const;
 
  public:
   std::string repr() const override;
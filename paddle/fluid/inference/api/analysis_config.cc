@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_analysis_config.h"
@@ -95,8 +96,13 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(model_dir_);
   CP_MEMBER(model_from_memory_);  // the memory model reuses prog_file_ and
                                   // params_file_ fields.
+  CP_MEMBER(params_mmap_);
+  CP_MEMBER(model_cipher_key_);
+  CP_MEMBER(model_cipher_config_);
 
   CP_MEMBER(opt_cache_dir_);
+  CP_MEMBER(optim_model_cache_dir_);
+  CP_MEMBER(share_program_);
   prog_file_ = std::move(other.prog_file_);
   params_file_ = std::move(other.params_file_);
 
@@ -108,6 +114,11 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(memory_pool_init_size_mb_);
 
   CP_MEMBER(enable_memory_optim_);
+  CP_MEMBER(enable_static_memory_plan_);
+  CP_MEMBER(static_memory_plan_batch_size_);
+  CP_MEMBER(static_memory_plan_buckets_);
+  CP_MEMBER(use_cuda_graph_);
+  CP_MEMBER(run_stats_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -116,22 +127,29 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(tensorrt_precision_mode_);
   CP_MEMBER(trt_use_static_engine_);
   CP_MEMBER(trt_use_calib_mode_);
+  CP_MEMBER(trt_share_engine_);
+  CP_MEMBER(trt_estimate_benefit_);
   // MKLDNN related.
   CP_MEMBER(use_mkldnn_);
   CP_MEMBER(mkldnn_enabled_op_types_);
   CP_MEMBER(mkldnn_cache_capacity_);
+  CP_MEMBER(placement_cost_table_);
   // Quantization related.
   CP_MEMBER(use_mkldnn_quantizer_);
   CP_MEMBER(mkldnn_quantizer_config_);
   CP_MEMBER(min_input_shape_);
   CP_MEMBER(max_input_shape_);
   CP_MEMBER(optim_input_shape_);
+  CP_MEMBER(extra_min_input_shapes_);
+  CP_MEMBER(extra_max_input_shapes_);
+  CP_MEMBER(extra_optim_input_shapes_);
   CP_MEMBER(disable_trt_plugin_fp16_);
 
   CP_MEMBER(use_lite_);
   CP_MEMBER(lite_precision_mode_);
   CP_MEMBER(lite_passes_filter_);
   CP_MEMBER(lite_ops_filter_);
+  CP_MEMBER(lite_zero_copy_);
 
   // profile related.
   CP_MEMBER(with_profile_);
@@ -146,6 +164,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(cpu_affinity_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -186,6 +205,12 @@ void AnalysisConfig::EnableMKLDNN() {
   Update();
 }
 
+void AnalysisConfig::SetPlacementCostTable(const std::string &path) {
+  placement_cost_table_ = path;
+
+  Update();
+}
+
 void AnalysisConfig::SetMkldnnCacheCapacity(int capacity) {
 #ifdef PADDLE_WITH_MKLDNN
   mkldnn_cache_capacity_ = capacity;
@@ -239,6 +264,16 @@ void AnalysisConfig::EnableTensorRtEngine(
 #endif
 }
 
+void AnalysisConfig::EnableTensorRtEngineSharing(bool x) {
+  trt_share_engine_ = x;
+  Update();
+}
+
+void AnalysisConfig::EnableTensorRtBenefitEstimate(bool x) {
+  trt_estimate_benefit_ = x;
+  Update();
+}
+
 void AnalysisConfig::SetTRTDynamicShapeInfo(
     std::map<std::string, std::vector<int>> min_input_shape,
     std::map<std::string, std::vector<int>> max_input_shape,
@@ -250,6 +285,19 @@ void AnalysisConfig::SetTRTDynamicShapeInfo(
   disable_trt_plugin_fp16_ = disable_trt_plugin_fp16;
 }
 
+void AnalysisConfig::AddTRTDynamicShapeProfile(
+    std::map<std::string, std::vector<int>> min_input_shape,
+    std::map<std::string, std::vector<int>> max_input_shape,
+    std::map<std::string, std::vector<int>> optim_input_shape) {
+  PADDLE_ENFORCE_EQ(min_input_shape_.empty(), false,
+                    platform::errors::PreconditionNotMet(
+                        "Please call SetTRTDynamicShapeInfo to set the first "
+                        "optimization profile before adding another one."));
+  extra_min_input_shapes_.push_back(std::move(min_input_shape));
+  extra_max_input_shapes_.push_back(std::move(max_input_shape));
+  extra_optim_input_shapes_.push_back(std::move(optim_input_shape));
+}
+
 // TODO(Superjomn) refactor this, buggy.
 void AnalysisConfig::Update() {
   auto info = SerializeInfoCache();
@@ -313,6 +361,22 @@ void AnalysisConfig::Update() {
 #endif
   }
 
+  // Check the placements by the cost table right after them.
+  if (!placement_cost_table_.empty() && enable_ir_optim_) {
+    for (auto &library : {"mkldnn", "cudnn"}) {
+      std::string placement = std::string(library) + "_placement_pass";
+      std::string cost_placement =
+          std::string(library) + "_cost_placement_pass";
+      auto &passes = pass_builder()->AllPasses();
+      auto it = std::find(passes.begin(), passes.end(), placement);
+      if (it != passes.end() &&
+          std::find(passes.begin(), passes.end(), cost_placement) ==
+              passes.end()) {
+        pass_builder()->InsertPass(it - passes.begin() + 1, cost_placement);
+      }
+    }
+  }
+
   // Quantization passes must come after all other optimization passes
   if (use_mkldnn_quantizer_) {
     if (!enable_ir_optim_) {
@@ -367,16 +431,28 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << tensorrt_workspace_size_;
   ss << tensorrt_max_batchsize_;
   ss << tensorrt_min_subgraph_size_;
+  ss << trt_share_engine_;
+  ss << trt_estimate_benefit_;
+  ss << share_program_;
 
   ss << enable_memory_optim_;
+  ss << enable_static_memory_plan_;
+  ss << static_memory_plan_batch_size_;
+  for (auto bucket : static_memory_plan_buckets_) ss << bucket << ",";
+  ss << use_cuda_graph_;
+  ss << run_stats_;
 
   ss << use_mkldnn_;
   ss << mkldnn_cache_capacity_;
+  ss << placement_cost_table_;
   for (auto &item : mkldnn_enabled_op_types_) ss << item;
   ss << ";";
 
   ss << use_mkldnn_quantizer_;
   ss << model_from_memory_;
+  ss << params_mmap_;
+  // the key is not a part of the config info
+  ss << model_cipher_config_ << !model_cipher_key_.empty();
 
   ss << with_profile_;
 
@@ -388,8 +464,10 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  for (auto cpu : cpu_affinity_) ss << cpu << ";";
 
   ss << use_lite_;
+  ss << lite_zero_copy_;
 
   ss << thread_local_stream_;
 
@@ -403,6 +481,12 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::SetCpuAffinity(const std::vector<int> &cpus) {
+  cpu_affinity_ = cpus;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #ifdef PADDLE_WITH_CUDA
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -424,6 +508,50 @@ void AnalysisConfig::EnableMemoryOptim() {
   Update();
 }
 
+void AnalysisConfig::EnableStaticMemoryPlan(int batch_size) {
+  PADDLE_ENFORCE_GT(batch_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The batch size of the static memory plan should be "
+                        "greater than 0, but received %d.",
+                        batch_size));
+  enable_memory_optim_ = true;
+  enable_static_memory_plan_ = true;
+  static_memory_plan_batch_size_ = batch_size;
+  static_memory_plan_buckets_.clear();
+  Update();
+}
+
+void AnalysisConfig::EnableStaticMemoryPlan(const std::vector<int> &buckets) {
+  PADDLE_ENFORCE_EQ(buckets.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The buckets of the static memory plan should not be "
+                        "empty."));
+  for (auto bucket : buckets) {
+    PADDLE_ENFORCE_GT(bucket, 0,
+                      platform::errors::InvalidArgument(
+                          "The buckets of the static memory plan should be "
+                          "greater than 0, but received %d.",
+                          bucket));
+  }
+  enable_memory_optim_ = true;
+  enable_static_memory_plan_ = true;
+  static_memory_plan_buckets_ = buckets;
+  std::sort(static_memory_plan_buckets_.begin(),
+            static_memory_plan_buckets_.end());
+  static_memory_plan_batch_size_ = static_memory_plan_buckets_.back();
+  Update();
+}
+
+void AnalysisConfig::EnableCUDAGraph() {
+  use_cuda_graph_ = true;
+  Update();
+}
+
+void AnalysisConfig::EnableRunStats(bool x) {
+  run_stats_ = x;
+  Update();
+}
+
 bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
@@ -469,11 +597,12 @@ void AnalysisConfig::DisableGlogInfo() {
 void AnalysisConfig::EnableLiteEngine(
     AnalysisConfig::Precision precision_mode,
     const std::vector<std::string> &passes_filter,
-    const std::vector<std::string> &ops_filter) {
+    const std::vector<std::string> &ops_filter, bool zero_copy) {
   use_lite_ = true;
   lite_precision_mode_ = precision_mode;
   lite_passes_filter_ = passes_filter;
   lite_ops_filter_ = ops_filter;
+  lite_zero_copy_ = zero_copy;
   Update();
 }
 
@@ -14,11 +14,19 @@
 
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
+#include <sys/stat.h>
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <random>
 #include <set>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/feed_fetch_method.h"
@@ -27,6 +35,7 @@
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/inference/analysis/helper.h"
@@ -74,6 +83,52 @@ bool IsPersistable(const framework::VarDesc *var) {
   }
   return false;
 }
+
+// Identify a model file by its path, size and modification time, instead of
+// hashing its content.
+void StampFile(const std::string &path, std::ostream *os) {
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0) {
+    *os << path << ":" << st.st_size << ":" << st.st_mtime << ";";
+  }
+}
+
+// The TensorRT engines shared by the predictors, see
+// AnalysisConfig::EnableTensorRtEngineSharing.
+struct SharedTrtEngines {
+  std::mutex mtx;
+  // the key of the model, config and device -> the id of the owner
+  std::unordered_map<std::string, int> owners;
+  // the predictors sharing the engines build them one by one
+  std::mutex build_mtx;
+};
+
+SharedTrtEngines &GetSharedTrtEngines() {
+  static SharedTrtEngines engines;
+  return engines;
+}
+
+// The programs and the scopes shared by the predictors, see
+// AnalysisConfig::EnableProgramSharing. They are held by the predictors, an
+// entry is reused while any of its predictors lives.
+struct SharedPrograms {
+  struct Entry {
+    std::weak_ptr<framework::Scope> scope;
+    std::weak_ptr<framework::ProgramDesc> program;
+    std::shared_ptr<framework::StaticMemoryPlan> static_memory_plan;
+    std::shared_ptr<framework::BucketedStaticMemoryPlan> static_memory_plans;
+    // the predictors of the same key are set up one by one
+    std::mutex build_mtx;
+  };
+
+  std::mutex mtx;
+  std::unordered_map<std::string, Entry> entries;
+};
+
+SharedPrograms &GetSharedPrograms() {
+  static SharedPrograms programs;
+  return programs;
+}
 }  // namespace
 
 bool PaddleTensorToLoDTensor(const PaddleTensor &pt, framework::LoDTensor *t,
@@ -142,17 +197,51 @@ bool AnalysisPredictor::Init(
   }
 
   // no matter with or without MKLDNN
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  if (!config_.cpu_affinity().empty()) {
+    PrepareCpuWorker();
+  } else {
+    paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  }
 
-  if (!PrepareScope(parent_scope)) {
+  auto scope = parent_scope;
+  auto shared_program = program;
+  SharedPrograms::Entry *shared = nullptr;
+  std::unique_lock<std::mutex> share_lock;
+  if (!parent_scope && ProgramShared()) {
+    auto key = ProgramShareKey();
+    {
+      auto &programs = GetSharedPrograms();
+      std::lock_guard<std::mutex> lock(programs.mtx);
+      shared = &programs.entries[key];
+    }
+    share_lock = std::unique_lock<std::mutex>(shared->build_mtx);
+    scope = shared->scope.lock();
+    shared_program = shared->program.lock();
+    if (scope && shared_program) {
+      VLOG(3) << "share the program of the predictors of the key " << key;
+      static_memory_plan_ = shared->static_memory_plan;
+      static_memory_plans_ = shared->static_memory_plans;
+    } else {
+      scope.reset();
+      shared_program.reset();
+    }
+  }
+
+  if (!PrepareScope(scope)) {
     return false;
   }
   if (!CreateExecutor()) {
     return false;
   }
-  if (!PrepareProgram(program)) {
+  if (!PrepareProgram(shared_program)) {
     return false;
   }
+  if (shared && !status_is_cloned_) {
+    shared->scope = scope_;
+    shared->program = inference_program_;
+    shared->static_memory_plan = static_memory_plan_;
+    shared->static_memory_plans = static_memory_plans_;
+  }
 
   // Prepare executor, create local variables.
   if (!PrepareExecutor()) {
@@ -199,10 +288,29 @@ bool AnalysisPredictor::PrepareProgram(
     }
     executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
 
+    std::string cache_path;
+    if (OptimModelCacheEnabled()) {
+      cache_path =
+          config_.optim_model_cache_dir() + "/" + OptimModelCacheKey() + "/";
+    }
     // if enable_ir_optim_ is false,
     // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc) will
     // not be executed.
-    OptimizeInferenceProgram();
+    std::unique_lock<std::mutex> build_lock;
+    if (TensorRtEngineShared()) {
+      build_lock =
+          std::unique_lock<std::mutex>(GetSharedTrtEngines().build_mtx);
+    }
+    if (cache_path.empty() || !LoadOptimModelCache(cache_path)) {
+      if (!cache_path.empty()) {
+        // the TensorRT engines are serialized into the cache by the analysis
+        MKDIR(config_.optim_model_cache_dir().c_str());
+        MKDIR(cache_path.c_str());
+        optim_model_cache_path_ = cache_path;
+      }
+      OptimizeInferenceProgram();
+      if (!cache_path.empty()) SaveOptimModelCache(cache_path);
+    }
   } else {
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
@@ -232,12 +340,159 @@ bool AnalysisPredictor::CreateExecutor() {
   executor_.reset(new paddle::framework::NaiveExecutor(place_));
   return true;
 }
+int AnalysisPredictor::UnknownInputDim(const std::string &name,
+                                       const framework::DDim &dims) const {
+  auto *var = inference_program_->Block(0).FindVar(name);
+  if (var == nullptr) return 0;
+  auto shape = var->GetShape();
+  int64_t size = 0;
+  for (int i = 0; i < dims.size() && i < static_cast<int>(shape.size()); ++i) {
+    if (shape[i] < 0) size = std::max(size, dims[i]);
+  }
+  return static_cast<int>(size);
+}
+void AnalysisPredictor::CopyToExternalOutputs() {
+  for (auto &pair : external_outputs_) {
+    auto *var = executor_->scope()->FindVar(pair.first);
+    PADDLE_ENFORCE_NOT_NULL(
+        var, platform::errors::NotFound("The output %s is not found.",
+                                        pair.first));
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    auto &buffer = pair.second;
+    if (!tensor->IsInitialized() || tensor->data<void>() == buffer->ptr()) {
+      continue;
+    }
+    size_t size = tensor->numel() * framework::SizeOfType(tensor->type());
+    PADDLE_ENFORCE_LE(size, buffer->size(),
+                      platform::errors::OutOfRange(
+                          "The output %s needs %d bytes, but its external "
+                          "buffer has only %d bytes.",
+                          pair.first, size, buffer->size()));
+    framework::Tensor dst;
+    dst.Resize(tensor->dims());
+    dst.ResetHolderWithType(
+        std::make_shared<memory::Allocation>(buffer->ptr(), size,
+                                             buffer->place()),
+        tensor->type());
+    framework::TensorCopySync(*tensor, buffer->place(), &dst);
+    // the output is written to the buffer directly in the next run if it
+    // has the same place and fits
+    if (platform::is_same_place(tensor->place(), buffer->place())) {
+      tensor->ShareDataWith(dst);
+    }
+  }
+}
+void AnalysisPredictor::PrepareCpuWorker() {
+  cpu_worker_.reset(new framework::ThreadPool(1));
+  auto cpus = config_.cpu_affinity();
+  int num_threads = config_.cpu_math_library_num_threads();
+  cpu_worker_
+      ->Run([this, cpus, num_threads] {
+        cpu_worker_id_ = std::this_thread::get_id();
+        if (!platform::BindThreadToCPUs(cpus)) {
+          LOG(WARNING) << "Failed to bind the predictor to the CPUs, it runs "
+                          "on all the CPUs.";
+        }
+        platform::SetThreadLocalNumThreads(num_threads);
+      })
+      .get();
+}
+
+bool AnalysisPredictor::RunOnCpuWorker(const std::function<bool()> &fn) {
+  bool ret = false;
+  cpu_worker_->Run([&] { ret = fn(); }).get();
+  return ret;
+}
+
+void AnalysisPredictor::RecordRunStats(double run_ms, double feed_ms,
+                                       double execution_ms, double fetch_ms) {
+  std::lock_guard<std::mutex> lock(run_stats_mutex_);
+  run_latency_.Add(run_ms);
+  if (feed_ms >= 0) feed_latency_.Add(feed_ms);
+  execution_latency_.Add(execution_ms);
+  fetch_latency_.Add(fetch_ms);
+}
+
+bool AnalysisPredictor::GetRunStats(PaddleRunStats *stats, int top_n) {
+  PADDLE_ENFORCE_NOT_NULL(stats, platform::errors::InvalidArgument(
+                                     "The output stats should not be null."));
+  if (!config_.run_stats_enabled()) return false;
+  {
+    std::lock_guard<std::mutex> lock(run_stats_mutex_);
+    run_latency_.GetStats(&stats->run);
+    feed_latency_.GetStats(&stats->feed);
+    execution_latency_.GetStats(&stats->execution);
+    fetch_latency_.GetStats(&stats->fetch);
+  }
+
+  stats->top_ops.clear();
+  stats->engine_ms.clear();
+  const std::string engine_suffix = "_engine";
+  for (auto &timing : executor_->GetOpTimings()) {
+    auto &type = timing.type;
+    if (type.size() > engine_suffix.size() &&
+        type.compare(type.size() - engine_suffix.size(), engine_suffix.size(),
+                     engine_suffix) == 0) {
+      stats->engine_ms[type] += timing.total_ms;
+    }
+    PaddleOpStats op;
+    op.type = type;
+    op.output = timing.output;
+    op.calls = timing.calls;
+    op.total_ms = timing.total_ms;
+    stats->top_ops.push_back(std::move(op));
+  }
+  auto top = std::min(stats->top_ops.size(),
+                      static_cast<size_t>(std::max(top_n, 0)));
+  std::partial_sort(stats->top_ops.begin(), stats->top_ops.begin() + top,
+                    stats->top_ops.end(),
+                    [](const PaddleOpStats &a, const PaddleOpStats &b) {
+                      return a.total_ms > b.total_ms;
+                    });
+  stats->top_ops.resize(top);
+  return true;
+}
+
+void AnalysisPredictor::ResetRunStats() {
+  {
+    std::lock_guard<std::mutex> lock(run_stats_mutex_);
+    run_latency_.Reset();
+    feed_latency_.Reset();
+    execution_latency_.Reset();
+    fetch_latency_.Reset();
+  }
+  executor_->ResetOpTimings();
+}
+
+void AnalysisPredictor::BindThreadStream() {
+#ifdef PADDLE_WITH_CUDA
+  if (status_use_gpu_ && config_.thread_local_stream_enabled()) {
+    auto *ctx = static_cast<platform::CUDADeviceContext *>(
+        platform::DeviceContextPool::Instance().Get(place_));
+    if (!ctx->HasThreadContext()) {
+      ctx->ResetThreadContext(platform::stream::Priority::kNormal);
+    }
+  }
+#endif
+}
 bool AnalysisPredictor::PrepareExecutor() {
   executor_->Prepare(sub_scope_, *inference_program_, 0,
                      config_.use_feed_fetch_ops_);
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_);
 
+  if (static_memory_plans_) {
+    executor_->SetStaticMemoryPlans(*static_memory_plans_);
+  } else if (static_memory_plan_) {
+    executor_->SetStaticMemoryPlan(*static_memory_plan_);
+  }
+  if (config_.cuda_graph_enabled() && config_.use_gpu()) {
+    executor_->EnableCUDAGraph(true);
+  }
+  if (config_.run_stats_enabled()) {
+    executor_->EnableOpTiming(true);
+  }
+
   return true;
 }
 
@@ -289,32 +544,58 @@ void AnalysisPredictor::MkldnnPostReset() {
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  if (cpu_worker_ && std::this_thread::get_id() != cpu_worker_id_) {
+    return RunOnCpuWorker([&] { return Run(inputs, output_data, batch_size); });
+  }
+  if (!cpu_worker_) {
+    paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  }
+  BindThreadStream();
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
 #endif
   VLOG(3) << "Predictor::predict";
-  inference::Timer timer;
+  inference::Timer timer, stage_timer;
   timer.tic();
   // set feed variable
   framework::Scope *scope = sub_scope_ ? sub_scope_ : scope_.get();
   PADDLE_ENFORCE_NOT_NULL(scope, "The scope should not be nullptr.");
+  stage_timer.tic();
   if (!SetFeed(inputs, scope)) {
     LOG(ERROR) << "fail to set feed";
     return false;
   }
+  double feed_ms = stage_timer.toc();
+  if (static_memory_plans_) {
+    int size = 0;
+    for (size_t i = 0; i < inputs.size() && i < feeds_.size(); ++i) {
+      auto &name = config_.specify_input_name_ ? inputs[i].name
+                                               : feeds_[i]->Output("Out")[0];
+      size = std::max(
+          size, UnknownInputDim(name, framework::make_ddim(inputs[i].shape)));
+    }
+    executor_->SelectStaticMemoryPlan(size);
+  }
 
   // Run the inference program
   // if share variables, we need not create variables
+  stage_timer.tic();
   executor_->Run();
+  double execution_ms = stage_timer.toc();
 
   // get fetch variable
+  stage_timer.tic();
   if (!GetFetch(output_data, scope)) {
     LOG(ERROR) << "fail to get fetches";
     return false;
   }
+  double fetch_ms = stage_timer.toc();
 
-  VLOG(3) << "predict cost: " << timer.toc() << "ms";
+  double run_ms = timer.toc();
+  VLOG(3) << "predict cost: " << run_ms << "ms";
+  if (config_.run_stats_enabled()) {
+    RecordRunStats(run_ms, feed_ms, execution_ms, fetch_ms);
+  }
 
   // All the containers in the scope will be hold in inference, but the
   // operators assume that the container will be reset after each batch.
@@ -328,7 +609,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
 
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
-  paddle::platform::SetNumThreads(1);
+  if (!cpu_worker_) paddle::platform::SetNumThreads(1);
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
@@ -429,10 +710,24 @@ void AnalysisPredictor::PrepareArgument() {
   argument_.SetGPUDeviceId(config_.gpu_device_id());
   argument_.SetEnableAnalysisOptim(config_.enable_ir_optim_);
   argument_.SetEnableMemoryOptim(config_.enable_memory_optim());
+  if (config_.static_memory_plan_enabled()) {
+    argument_.SetStaticMemoryPlanBatchSize(
+        config_.static_memory_plan_batch_size_);
+    if (!config_.static_memory_plan_buckets_.empty()) {
+      argument_.SetStaticMemoryPlanBuckets(config_.static_memory_plan_buckets_);
+    }
+  }
   argument_.SetModelFromMemory(config_.model_from_memory_);
+#ifndef _WIN32
+  argument_.SetParamsByMmap(config_.params_mmap());
+#endif
   // Analyze inference_program
   argument_.SetPredictorID(predictor_id_);
   argument_.SetOptimCacheDir(config_.opt_cache_dir_);
+  if (!optim_model_cache_path_.empty() && config_.opt_cache_dir_.empty()) {
+    // the engines are cached with the optimized model
+    argument_.SetOptimCacheDir(optim_model_cache_path_);
+  }
   if (!config_.model_dir().empty()) {
     argument_.SetModelDir(config_.model_dir());
   } else {
@@ -444,6 +739,10 @@ void AnalysisPredictor::PrepareArgument() {
 
     argument_.SetModelProgramPath(config_.prog_file());
     argument_.SetModelParamsPath(config_.params_file());
+    if (config_.model_cipher_enabled()) {
+      argument_.SetModelCipherConfig(config_.model_cipher_config());
+      argument_.SetModelCipherKey(config_.model_cipher_key());
+    }
   }
 
   if (config_.use_gpu() && config_.tensorrt_engine_enabled()) {
@@ -453,11 +752,17 @@ void AnalysisPredictor::PrepareArgument() {
     argument_.SetTensorRtMaxBatchSize(config_.tensorrt_max_batchsize_);
     argument_.SetTensorRtMinSubgraphSize(config_.tensorrt_min_subgraph_size_);
     argument_.SetTensorRtPrecisionMode(config_.tensorrt_precision_mode_);
-    argument_.SetTensorRtUseStaticEngine(config_.trt_use_static_engine_);
+    argument_.SetTensorRtUseStaticEngine(config_.trt_use_static_engine_ ||
+                                         !optim_model_cache_path_.empty());
     argument_.SetTensorRtUseCalibMode(config_.trt_use_calib_mode_);
+    argument_.SetTensorRtEstimateBenefit(config_.trt_estimate_benefit_);
     argument_.SetMinInputShape(config_.min_input_shape_);
     argument_.SetMaxInputShape(config_.max_input_shape_);
     argument_.SetOptimInputShape(config_.optim_input_shape_);
+    argument_.SetExtraMinInputShapes(config_.extra_min_input_shapes_);
+    argument_.SetExtraMaxInputShapes(config_.extra_max_input_shapes_);
+    argument_.SetExtraOptimInputShapes(config_.extra_optim_input_shapes_);
+    argument_.SetTensorRtEngineOwnerId(TensorRtEngineOwnerId());
     argument_.SetCloseTrtPluginFp16(config_.disable_trt_plugin_fp16_);
   }
 
@@ -465,6 +770,7 @@ void AnalysisPredictor::PrepareArgument() {
     argument_.SetLitePrecisionMode(config_.lite_precision_mode_);
     argument_.SetLitePassesFilter(config_.lite_passes_filter_);
     argument_.SetLiteOpsFilter(config_.lite_ops_filter_);
+    argument_.SetLiteZeroCopy(config_.lite_zero_copy_);
     LOG(INFO) << "Lite subgraph engine is enabled";
   }
 
@@ -472,6 +778,9 @@ void AnalysisPredictor::PrepareArgument() {
     LOG(INFO) << "MKLDNN is enabled";
     argument_.SetMKLDNNEnabledOpTypes(config_.mkldnn_enabled_op_types_);
   }
+  if (!config_.placement_cost_table_.empty()) {
+    argument_.SetPlacementCostTable(config_.placement_cost_table_);
+  }
 
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.mkldnn_quantizer_enabled()) {
@@ -504,6 +813,14 @@ void AnalysisPredictor::OptimizeInferenceProgram() {
   ARGUMENT_CHECK_FIELD((&argument_), ir_analyzed_program);
   inference_program_.reset(
       new framework::ProgramDesc(argument_.ir_analyzed_program()));
+  if (argument_.static_memory_plan_valid()) {
+    static_memory_plan_.reset(
+        new framework::StaticMemoryPlan(argument_.static_memory_plan()));
+  }
+  if (argument_.static_memory_plans_valid()) {
+    static_memory_plans_.reset(new framework::BucketedStaticMemoryPlan(
+        argument_.static_memory_plans()));
+  }
   // The config and argument take a lot of storage,
   // when the predictor settings are complete, we release these stores.
   argument_.PartiallyRelease();
@@ -678,6 +995,7 @@ std::vector<std::string> AnalysisPredictor::GetOutputNames() {
 std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
     const std::string &name) {
   PADDLE_ENFORCE(executor_->scope()->FindVar(name), "no name called %s", name);
+  BindThreadStream();
   std::unique_ptr<ZeroCopyTensor> res(
       new ZeroCopyTensor(static_cast<void *>(executor_->scope())));
   res->input_or_output_ = true;
@@ -695,9 +1013,11 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
 std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
     const std::string &name) {
   PADDLE_ENFORCE(executor_->scope()->FindVar(name), "no name called %s", name);
+  BindThreadStream();
   std::unique_ptr<ZeroCopyTensor> res(
       new ZeroCopyTensor(static_cast<void *>(executor_->scope())));
   res->input_or_output_ = false;
+  res->external_outputs_ = &external_outputs_;
   res->SetName(name);
   if (platform::is_cpu_place(place_)) {
     res->SetPlace(PaddlePlace::kCPU);
@@ -709,15 +1029,42 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  if (cpu_worker_ && std::this_thread::get_id() != cpu_worker_id_) {
+    return RunOnCpuWorker([this] { return ZeroCopyRun(); });
+  }
+  inference::Timer timer, stage_timer;
+  timer.tic();
+  if (!cpu_worker_) {
+    paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  }
+  BindThreadStream();
+  if (static_memory_plans_) {
+    int size = 0;
+    for (auto *feed : feeds_) {
+      auto &name = feed->Output("Out")[0];
+      auto *var = executor_->scope()->FindVar(name);
+      if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+      size = std::max(
+          size, UnknownInputDim(name, var->Get<framework::LoDTensor>().dims()));
+    }
+    executor_->SelectStaticMemoryPlan(size);
+  }
+  stage_timer.tic();
   executor_->Run();
+  double execution_ms = stage_timer.toc();
+  stage_timer.tic();
+  CopyToExternalOutputs();
+  if (config_.run_stats_enabled()) {
+    double fetch_ms = stage_timer.toc();
+    RecordRunStats(timer.toc(), -1, execution_ms, fetch_ms);
+  }
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
   tensor_array_batch_cleaner_.ResetTensorArray();
 
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
-  paddle::platform::SetNumThreads(1);
+  if (!cpu_worker_) paddle::platform::SetNumThreads(1);
 #if defined(PADDLE_WITH_MKLML)
   // Frees unused memory allocated by the Intel® MKL Memory Allocator to
   // avoid memory leak. See:
@@ -751,7 +1098,13 @@ bool AnalysisPredictor::LoadProgramDesc() {
 
   // Create ProgramDesc
   framework::proto::ProgramDesc proto;
-  if (!config_.model_from_memory()) {
+  if (config_.model_cipher_enabled()) {
+    auto fin = inference::OpenEncryptedFile(
+        filename, config_.model_cipher_config(), config_.model_cipher_key());
+    std::string pb_content{std::istreambuf_iterator<char>(*fin),
+                           std::istreambuf_iterator<char>()};
+    proto.ParseFromString(pb_content);
+  } else if (!config_.model_from_memory()) {
     std::string pb_content;
     // Read binary
     std::ifstream fin(filename, std::ios::in | std::ios::binary);
@@ -811,6 +1164,25 @@ bool AnalysisPredictor::LoadParameters() {
   if (!config_.params_file().empty()) {
     // sort paramlist to have consistent ordering
     std::sort(params.begin(), params.end());
+    if (config_.model_cipher_enabled()) {
+      auto fin = inference::OpenEncryptedFile(config_.params_file(),
+                                              config_.model_cipher_config(),
+                                              config_.model_cipher_key());
+      inference::LoadCombinedParamsFromStream(fin.get(), params, scope_.get(),
+                                              place_);
+      VLOG(3) << "get " << scope_->LocalVarNames().size()
+              << " vars after load";
+      return true;
+    }
+#ifndef _WIN32
+    if (config_.params_mmap() && !config_.model_from_memory()) {
+      inference::LoadCombinedParamsByMmap(config_.params_file(), params,
+                                          scope_.get(), place_);
+      VLOG(3) << "get " << scope_->LocalVarNames().size()
+              << " vars after load";
+      return true;
+    }
+#endif
     // append just the load_combine op
     framework::OpDesc *op = load_block->AppendOp();
     op->SetType("load_combine");
@@ -828,6 +1200,283 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+bool AnalysisPredictor::OptimModelCacheEnabled() const {
+  // the encrypted parameters are not cached in plaintext
+  if (config_.optim_model_cache_dir().empty() || !config_.ir_optim() ||
+      config_.model_from_memory() || config_.lite_engine_enabled() ||
+      config_.static_memory_plan_enabled() || config_.model_cipher_enabled()) {
+    return false;
+  }
+#ifdef PADDLE_WITH_MKLDNN
+  if (config_.mkldnn_quantizer_enabled()) return false;
+#endif
+  // the calibration runs on the unoptimized engines
+  if (config_.use_gpu() && config_.tensorrt_engine_enabled() &&
+      config_.tensorrt_precision_mode_ == AnalysisConfig::Precision::kInt8 &&
+      config_.trt_use_calib_mode_) {
+    return false;
+  }
+  return true;
+}
+
+std::string AnalysisPredictor::OptimModelCacheKey() {
+  std::stringstream ss;
+  ss << get_version() << ";";
+  ss << inference_program_->Proto()->SerializeAsString();
+  if (!config_.params_file().empty()) {
+    StampFile(config_.prog_file(), &ss);
+    StampFile(config_.params_file(), &ss);
+  } else {
+    StampFile(config_.model_dir() + "/__model__", &ss);
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) {
+        StampFile(config_.model_dir() + "/" + var->Name(), &ss);
+      }
+    }
+  }
+
+  ss << config_.SerializeInfoCache();
+  for (auto &pass : config_.pass_builder()->AllPasses()) ss << pass << ";";
+  if (config_.use_gpu() && config_.tensorrt_engine_enabled()) {
+    ss << static_cast<int>(config_.tensorrt_precision_mode_);
+    ss << config_.disable_trt_plugin_fp16_;
+    for (auto *shapes : {&config_.min_input_shape_, &config_.max_input_shape_,
+                         &config_.optim_input_shape_}) {
+      for (auto &pair : *shapes) {
+        ss << pair.first << ":";
+        for (auto dim : pair.second) ss << dim << ",";
+      }
+      ss << ";";
+    }
+    for (auto *profiles :
+         {&config_.extra_min_input_shapes_, &config_.extra_max_input_shapes_,
+          &config_.extra_optim_input_shapes_}) {
+      for (auto &shapes : *profiles) {
+        for (auto &pair : shapes) {
+          ss << pair.first << ":";
+          for (auto dim : pair.second) ss << dim << ",";
+        }
+        ss << ";";
+      }
+    }
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (config_.use_gpu()) {
+    ss << platform::GetCUDAComputeCapability(config_.gpu_device_id());
+  }
+#endif
+  return std::to_string(std::hash<std::string>()(ss.str()));
+}
+
+bool AnalysisPredictor::TensorRtEngineShared() const {
+  bool calib_int8 =
+      config_.tensorrt_precision_mode_ == AnalysisConfig::Precision::kInt8 &&
+      config_.trt_use_calib_mode_;
+  return config_.use_gpu() && config_.tensorrt_engine_enabled() &&
+         config_.tensorrt_engine_sharing_enabled() && !calib_int8;
+}
+
+bool AnalysisPredictor::ProgramShared() const {
+  if (!config_.program_sharing_enabled()) return false;
+#ifdef PADDLE_WITH_MKLDNN
+  // the quantizer modifies the program and the parameters
+  if (config_.mkldnn_quantizer_enabled()) return false;
+#endif
+  return true;
+}
+
+std::string AnalysisPredictor::ProgramShareKey() {
+  std::stringstream ss;
+  ss << get_version() << ";";
+  if (!config_.model_from_memory()) {
+    if (!config_.params_file().empty()) {
+      StampFile(config_.prog_file(), &ss);
+      StampFile(config_.params_file(), &ss);
+    } else {
+      // the parameter files are not known before the program is loaded, the
+      // directory is stamped for them
+      StampFile(config_.model_dir(), &ss);
+      StampFile(config_.model_dir() + "/__model__", &ss);
+    }
+  }
+  // it holds the memory model, but not the key of the cipher
+  ss << config_.SerializeInfoCache();
+  ss << std::hash<std::string>()(config_.model_cipher_key()) << ";";
+  for (auto &pass : config_.pass_builder()->AllPasses()) ss << pass << ";";
+  return std::to_string(std::hash<std::string>()(ss.str()));
+}
+
+int AnalysisPredictor::TensorRtEngineOwnerId() {
+  if (trt_engine_owner_id_ >= 0) return trt_engine_owner_id_;
+  trt_engine_owner_id_ = predictor_id_;
+  if (TensorRtEngineShared()) {
+    std::string key =
+        OptimModelCacheKey() + std::to_string(config_.gpu_device_id());
+    if (config_.model_from_memory()) {
+      // the model files can not be stamped
+      key += std::to_string(std::hash<std::string>()(config_.params_file()));
+    }
+    auto &shared = GetSharedTrtEngines();
+    std::lock_guard<std::mutex> lock(shared.mtx);
+    trt_engine_owner_id_ =
+        shared.owners.emplace(key, predictor_id_).first->second;
+  }
+  return trt_engine_owner_id_;
+}
+
+bool AnalysisPredictor::LoadOptimModelCache(const std::string &dir) {
+  std::string model_path = dir + "__model__";
+  if (!inference::analysis::FileExists(model_path)) return false;
+  auto program = std::make_shared<framework::ProgramDesc>(
+      inference::analysis::LoadProgramDesc(model_path));
+
+#if PADDLE_WITH_TENSORRT
+  // the engines were serialized into the cache, or the given optim cache dir
+  std::string engine_dir =
+      config_.opt_cache_dir_.empty() ? dir : config_.opt_cache_dir_;
+  for (auto *op : program->MutableBlock(0)->AllOps()) {
+    if (op->Type() != "tensorrt_engine") continue;
+    auto engine_key = BOOST_GET_CONST(std::string, op->GetAttr("engine_key"));
+    // the engine is found by the predictor which loads it
+    int engine_owner_id = TensorRtEngineOwnerId();
+    op->SetAttr("predictor_id", engine_owner_id);
+    op->Flush();
+    auto &engine_manager =
+        Singleton<inference::tensorrt::TRTEngineManager>::Global();
+    if (engine_manager.Has(engine_key + std::to_string(engine_owner_id))) {
+      // loaded by another predictor sharing it
+      continue;
+    }
+    std::string engine_data =
+        inference::analysis::GetTrtEngineSerializedData(engine_dir, engine_key);
+    if (engine_data.empty()) {
+      LOG(WARNING) << "The TensorRT engine " << engine_key
+                   << " is not found in the optimized model cache " << dir
+                   << ", the model will be optimized again.";
+      return false;
+    }
+    auto *engine = engine_manager.Create(
+        engine_key + std::to_string(engine_owner_id),
+        config_.tensorrt_max_batchsize_, config_.tensorrt_workspace_size_,
+        config_.tensorrt_precision_mode_, nullptr, config_.gpu_device_id(),
+        config_.min_input_shape_, config_.max_input_shape_,
+        config_.optim_input_shape_, config_.disable_trt_plugin_fp16_);
+    for (size_t i = 0; i < config_.extra_min_input_shapes_.size(); ++i) {
+      engine->AddOptimizationProfile(config_.extra_min_input_shapes_[i],
+                                     config_.extra_max_input_shapes_[i],
+                                     config_.extra_optim_input_shapes_[i]);
+    }
+    engine->Deserialize(engine_data);
+  }
+#endif
+
+  framework::ProgramDesc load_program;
+  framework::BlockDesc *load_block = load_program.MutableBlock(0);
+  std::vector<std::string> params;
+  for (auto *var : program->Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      framework::VarDesc *new_var = load_block->Var(var->Name());
+      new_var->SetShape(var->GetShape());
+      new_var->SetDataType(var->GetDataType());
+      new_var->SetType(var->GetType());
+      new_var->SetLoDLevel(var->GetLoDLevel());
+      new_var->SetPersistable(true);
+      params.push_back(var->Name());
+    }
+  }
+  if (!params.empty()) {
+    std::sort(params.begin(), params.end());
+    std::string params_path = dir + "params";
+#ifndef _WIN32
+    if (config_.params_mmap()) {
+      inference::LoadCombinedParamsByMmap(params_path, params, scope_.get(),
+                                          place_);
+    } else  // NOLINT
+#endif
+    {
+      framework::OpDesc *op = load_block->AppendOp();
+      op->SetType("load_combine");
+      op->SetOutput("Out", params);
+      op->SetAttr("file_path", {params_path});
+      op->CheckAttrs();
+      framework::NaiveExecutor e(place_);
+      e.Prepare(scope_.get(), load_program, 0, false);
+      e.Run();
+    }
+  }
+
+  inference_program_ = program;
+  LOG(INFO) << "Load the optimized model from the cache " << dir;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimModelCache(const std::string &dir) {
+  // The persistable variables absent from the scope, e.g. the weights
+  // converted into the TensorRT engines, are not saved and become
+  // non-persistable in the cached program.
+  framework::ProgramDesc save_program;
+  auto *save_block = save_program.MutableBlock(0);
+  std::vector<std::string> params;
+  std::unordered_set<std::string> absent_params;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (!IsPersistable(var)) continue;
+    auto *scope_var = scope_->FindVar(var->Name());
+    if (scope_var == nullptr || !scope_var->IsType<framework::LoDTensor>() ||
+        !scope_var->Get<framework::LoDTensor>().IsInitialized()) {
+      absent_params.insert(var->Name());
+      continue;
+    }
+    framework::VarDesc *new_var = save_block->Var(var->Name());
+    new_var->SetShape(var->GetShape());
+    new_var->SetDataType(var->GetDataType());
+    new_var->SetType(var->GetType());
+    new_var->SetLoDLevel(var->GetLoDLevel());
+    new_var->SetPersistable(true);
+    params.push_back(var->Name());
+  }
+  std::sort(params.begin(), params.end());
+  auto program = *inference_program_->Proto();
+  for (auto &var : *program.mutable_blocks(0)->mutable_vars()) {
+    if (absent_params.count(var.name())) var.set_persistable(false);
+  }
+
+  // Write to the temporary files and then rename them, so that the
+  // predictors creating the same cache concurrently do not corrupt it.
+  std::string suffix = ".tmp" + std::to_string(std::random_device()());
+  try {
+    if (!params.empty()) {
+      auto *op = save_block->AppendOp();
+      op->SetType("save_combine");
+      op->SetInput("X", params);
+      op->SetAttr("file_path", dir + "params" + suffix);
+      op->CheckAttrs();
+      platform::CPUPlace place;
+      framework::Executor exe(place);
+      exe.Run(save_program, scope(), 0, true, true);
+      PADDLE_ENFORCE_EQ(
+          std::rename((dir + "params" + suffix).c_str(),
+                      (dir + "params").c_str()),
+          0, platform::errors::Unavailable("Failed to save the parameters."));
+    }
+    std::ofstream fout(dir + "__model__" + suffix,
+                       std::ios::out | std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Failed to open the program file."));
+    fout << program.SerializeAsString();
+    fout.close();
+    PADDLE_ENFORCE_EQ(
+        std::rename((dir + "__model__" + suffix).c_str(),
+                    (dir + "__model__").c_str()),
+        0, platform::errors::Unavailable("Failed to save the program."));
+    LOG(INFO) << "Save the optimized model into the cache " << dir;
+  } catch (const std::exception &e) {
+    // the predictor works without the cache
+    LOG(WARNING) << "Failed to save the optimized model into the cache "
+                 << dir << ": " << e.what();
+  }
+}
+
 #if PADDLE_WITH_TENSORRT
 bool AnalysisPredictor::SaveTrtCalibToDisk() {
   PADDLE_ENFORCE(config_.tensorrt_engine_enabled(),
@@ -908,6 +1557,8 @@ AnalysisPredictor::~AnalysisPredictor() {
 std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone() {
   std::lock_guard<std::mutex> lk(clone_mutex_);
   auto *x = new AnalysisPredictor(config_);
+  x->static_memory_plan_ = static_memory_plan_;
+  x->static_memory_plans_ = static_memory_plans_;
   x->Init(scope_, inference_program_);
   return std::unique_ptr<PaddlePredictor>(x);
 }
@@ -962,7 +1613,7 @@ void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
   framework::ProgramDesc save_program;
   auto *save_block = save_program.MutableBlock(0);
 
-  const framework::ProgramDesc &main_program = program();
+  const framework::ProgramDesc &main_program = *inference_program_;
   const framework::BlockDesc &global_block = main_program.Block(0);
   std::vector<std::string> save_var_list;
   for (framework::VarDesc *var : global_block.AllVars()) {
@@ -996,6 +1647,36 @@ std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<AnalysisConfig>(
       config);
 }
 
+PredictorPool::PredictorPool(const AnalysisConfig &config, size_t size) {
+  PADDLE_ENFORCE_GE(size, 1UL,
+                    platform::errors::InvalidArgument(
+                        "The size of the predictor pool should be at least "
+                        "1, but received %d.",
+                        size));
+  AnalysisConfig pool_config(config);
+  if (pool_config.use_gpu()) {
+    pool_config.EnableGpuMultiStream();
+  }
+  preds_.reserve(size);
+  preds_.emplace_back(CreatePaddlePredictor(pool_config));
+  PADDLE_ENFORCE_NOT_NULL(preds_.front(),
+                          platform::errors::PreconditionNotMet(
+                              "Failed to create the first predictor of the "
+                              "predictor pool."));
+  for (size_t i = 1; i < size; ++i) {
+    preds_.emplace_back(preds_.front()->Clone());
+  }
+}
+
+PaddlePredictor *PredictorPool::Retrieve(size_t idx) {
+  PADDLE_ENFORCE_LT(idx, preds_.size(),
+                    platform::errors::OutOfRange(
+                        "The index %d is out of the predictor pool of size "
+                        "%d.",
+                        idx, preds_.size()));
+  return preds_[idx].get();
+}
+
 }  // namespace paddle
 
 #if PADDLE_WITH_TENSORRT
@@ -14,14 +14,18 @@
 
 #pragma once
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/op_compatible_info.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
+#include "paddle/fluid/inference/api/details/external_outputs.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
@@ -164,6 +168,19 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   bool ZeroCopyRun() override;
 
+  ///
+  /// \brief Get the statistics of the runs, if AnalysisConfig::EnableRunStats
+  ///
+  /// \param[out] stats the statistics
+  /// \param[in] top_n the number of the operators in stats->top_ops
+  /// \return Whether the statistics are recorded
+  ///
+  bool GetRunStats(PaddleRunStats *stats, int top_n = 10) override;
+  ///
+  /// \brief Reset the statistics of the runs
+  ///
+  void ResetRunStats() override;
+
   ///
   /// \brief Create feed fetch variables
   ///
@@ -210,7 +227,14 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   /// \return the inference program
   ///
-  framework::ProgramDesc &program() { return *inference_program_; }
+  framework::ProgramDesc &program() {
+    // the program shared with the clones is copied before it is modified
+    if (inference_program_.use_count() > 1) {
+      inference_program_ =
+          std::make_shared<framework::ProgramDesc>(*inference_program_);
+    }
+    return *inference_program_;
+  }
 
   ///
   /// \brief Get the serialized program
@@ -256,6 +280,51 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   bool CreateExecutor();
   ///
+  /// \brief With the thread local stream enabled, bind a CUDA stream to the
+  /// calling thread if it has none, so that a predictor created in one
+  /// thread and run in another does not share the stream of the creator.
+  ///
+  void BindThreadStream();
+  ///
+  /// \brief Record the latencies of a run for GetRunStats.
+  ///
+  /// \param[in] run_ms the time of the whole run
+  /// \param[in] feed_ms the time of setting the inputs, negative if not
+  /// recorded
+  /// \param[in] execution_ms the time of running the operators
+  /// \param[in] fetch_ms the time of getting the outputs
+  ///
+  void RecordRunStats(double run_ms, double feed_ms, double execution_ms,
+                      double fetch_ms);
+  ///
+  /// \brief Start the worker thread of the predictor, which is bound to the
+  /// CPUs of AnalysisConfig::SetCpuAffinity and uses its own number of math
+  /// library threads.
+  ///
+  void PrepareCpuWorker();
+  ///
+  /// \brief Run fn on the worker thread and wait for it.
+  ///
+  /// \param[in] fn the function to run
+  /// \return the result of fn
+  ///
+  bool RunOnCpuWorker(const std::function<bool()> &fn);
+  ///
+  /// \brief Copy the outputs which are not written to their external
+  /// buffers directly, see ZeroCopyTensor::ShareExternalData.
+  ///
+  void CopyToExternalOutputs();
+  ///
+  /// \brief The largest dimension of the input which is unknown in the
+  /// program, which selects the bucket of the static memory plan.
+  ///
+  /// \param[in] name the name of the input
+  /// \param[in] dims the dims of the input of a request
+  /// \return the largest unknown dimension, or 0 if there is none
+  ///
+  int UnknownInputDim(const std::string &name,
+                      const framework::DDim &dims) const;
+  ///
   /// \brief According to the model's program, the executor creates ops
   ///
   /// \return Whether the function executed successfully
@@ -274,6 +343,51 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool LoadParameters();
+  ///
+  /// \brief Whether the optimized model can be cached for the config, see
+  /// AnalysisConfig::EnableOptimModelCache.
+  ///
+  bool OptimModelCacheEnabled() const;
+  ///
+  /// \brief The key of the optimized model in the cache, derived from the
+  /// model files, the config, the device and the version of Paddle.
+  ///
+  std::string OptimModelCacheKey();
+  ///
+  /// \brief Whether the TensorRT engines are shared with the other
+  /// predictors, see AnalysisConfig::EnableTensorRtEngineSharing.
+  ///
+  bool TensorRtEngineShared() const;
+  ///
+  /// \brief The id of the predictor whose id names the TensorRT engines, it
+  /// is the first of the predictors sharing the engines.
+  ///
+  int TensorRtEngineOwnerId();
+  ///
+  /// \brief Whether the program and the parameters are shared with the other
+  /// predictors, see AnalysisConfig::EnableProgramSharing.
+  ///
+  bool ProgramShared() const;
+  ///
+  /// \brief The key of the shared program, derived from the model files, the
+  /// config and the version of Paddle. It is known before the model is loaded.
+  ///
+  std::string ProgramShareKey();
+  ///
+  /// \brief Load the optimized program and parameters from the cache, and
+  /// deserialize the TensorRT engines of the program.
+  ///
+  /// \param[in] dir the directory of the optimized model in the cache
+  /// \return Whether the model is found in the cache and loaded
+  ///
+  bool LoadOptimModelCache(const std::string &dir);
+  ///
+  /// \brief Save the optimized program and parameters into the cache, the
+  /// program is written at last so that a partial model is never loaded.
+  ///
+  /// \param[in] dir the directory of the optimized model in the cache
+  ///
+  void SaveOptimModelCache(const std::string &dir);
 
   ///
   /// \brief Prepare input data, only used in Run()
@@ -360,6 +474,19 @@ class AnalysisPredictor : public PaddlePredictor {
   std::shared_ptr<framework::Scope> scope_;
   framework::Scope *sub_scope_{nullptr};
   std::shared_ptr<framework::ProgramDesc> inference_program_;
+  // Shared by the clones, each of which allocates its own arena.
+  std::shared_ptr<framework::StaticMemoryPlan> static_memory_plan_;
+  std::shared_ptr<framework::BucketedStaticMemoryPlan> static_memory_plans_;
+  // The worker thread bound to the CPUs of the config, all the runs are
+  // dispatched to it if exists.
+  std::unique_ptr<framework::ThreadPool> cpu_worker_;
+  std::thread::id cpu_worker_id_;
+  // The latencies of the runs if the run stats are enabled.
+  std::mutex run_stats_mutex_;
+  inference::LatencyHistogram run_latency_;
+  inference::LatencyHistogram feed_latency_;
+  inference::LatencyHistogram execution_latency_;
+  inference::LatencyHistogram fetch_latency_;
   framework::OpCompatibleMap op_compatible_map_;
   std::vector<framework::OpDesc *> feeds_;
   std::map<std::string, size_t> feed_names_;
@@ -382,6 +509,10 @@ class AnalysisPredictor : public PaddlePredictor {
   // concurrency problems, wrong results and memory leak, so cache them.
   std::vector<framework::LoDTensor> feed_tensors_;
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
+  details::ExternalOutputs external_outputs_;
+  // The directory of the optimized model in the cache, with the trailing
+  // separator, if the model is being optimized into the cache.
+  std::string optim_model_cache_path_;
   // A mutex help to make Clone thread safe.
   std::mutex clone_mutex_;
 
@@ -390,6 +521,7 @@ class AnalysisPredictor : public PaddlePredictor {
   int need_collect_var_shapes_{-1};  // -1 for default, 0 for false, 1 for true.
   std::vector<std::map<std::string, std::vector<int>>> batch_var_shapes_;
   int predictor_id_;
+  int trt_engine_owner_id_{-1};
 
  private:
   // Some status here that help to determine the status inside the predictor.
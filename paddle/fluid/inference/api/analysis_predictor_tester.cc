@@ -15,6 +15,10 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <numeric>
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -99,6 +103,105 @@ TEST(AnalysisPredictor, analysis_on) {
   inference::CompareTensor(outputs.front(), naive_outputs.front());
 }
 
+TEST(AnalysisPredictor, ParamsMmap) {
+  // combine the parameters of the model into one file
+  framework::Scope scope;
+  platform::CPUPlace place;
+  framework::Executor executor(place);
+  auto program = inference::Load(&executor, &scope, FLAGS_dirname);
+  std::vector<std::string> params;
+  for (auto* var : program->Block(0).AllVars()) {
+    if (var->Persistable() &&
+        var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+      params.push_back(var->Name());
+    }
+  }
+  std::sort(params.begin(), params.end());
+  inference::SaveVars(scope, params, ".");
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+
+  for (bool ir_optim : {false, true}) {
+    AnalysisConfig mmap_config;
+    mmap_config.SetModel(FLAGS_dirname + "/__model__", "./param");
+    mmap_config.SwitchIrOptim(ir_optim);
+    mmap_config.SwitchParamsMmap();
+    auto mmap_predictor = CreatePaddlePredictor<AnalysisConfig>(mmap_config);
+    std::vector<PaddleTensor> mmap_outputs;
+    ASSERT_TRUE(mmap_predictor->Run(inputs, &mmap_outputs));
+    ASSERT_EQ(mmap_outputs.size(), 1UL);
+    inference::CompareTensor(outputs.front(), mmap_outputs.front());
+  }
+}
+
+TEST(AnalysisPredictor, OptimModelCache) {
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // the first predictor optimizes the model into the cache, and the second
+  // one loads it
+  std::vector<PaddleTensor> outputs[2];
+  for (int i = 0; i < 2; ++i) {
+    AnalysisConfig config;
+    config.SetModel(FLAGS_dirname);
+    config.EnableOptimModelCache("./optim_model_cache");
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    ASSERT_TRUE(predictor->Run(inputs, &outputs[i]));
+    ASSERT_EQ(outputs[i].size(), 1UL);
+  }
+  inference::CompareTensor(outputs[0].front(), outputs[1].front());
+}
+
+TEST(AnalysisPredictor, ProgramSharing) {
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableProgramSharing();
+  auto first = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto second = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* first_predictor = static_cast<AnalysisPredictor*>(first.get());
+  auto* second_predictor = static_cast<AnalysisPredictor*>(second.get());
+  // the second predictor is set up as a clone of the first one
+  ASSERT_EQ(first_predictor->scope(), second_predictor->scope());
+
+  std::vector<PaddleTensor> outputs[2];
+  ASSERT_TRUE(first->Run(inputs, &outputs[0]));
+  ASSERT_TRUE(second->Run(inputs, &outputs[1]));
+  inference::CompareTensor(outputs[0].front(), outputs[1].front());
+
+  // the program is copied before it is modified
+  auto program = first_predictor->GetSerializedProgram();
+  second_predictor->program().MutableBlock(0)->Var("program_sharing_test");
+  ASSERT_EQ(first_predictor->GetSerializedProgram(), program);
+
+  AnalysisConfig unshared;
+  unshared.SetModel(FLAGS_dirname);
+  auto third = CreatePaddlePredictor<AnalysisConfig>(unshared);
+  ASSERT_NE(static_cast<AnalysisPredictor*>(third.get())->scope(),
+            first_predictor->scope());
+}
+
 TEST(AnalysisPredictor, ZeroCopy) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -137,6 +240,122 @@ TEST(AnalysisPredictor, ZeroCopy) {
   LOG(INFO) << "output_data: " << out_data;
 }
 
+TEST(AnalysisPredictor, CpuAffinity) {
+  auto run = [](const AnalysisConfig& config) {
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    std::vector<float> result;
+    // run in another thread than the creator
+    std::thread([&predictor, &result] {
+      for (auto& name : predictor->GetInputNames()) {
+        auto input = predictor->GetInputTensor(name);
+        input->Reshape({4, 1});
+        auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+        for (int i = 0; i < 4; i++) data[i] = i;
+      }
+      ASSERT_TRUE(predictor->ZeroCopyRun());
+      auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+      PaddlePlace place;
+      int size = 0;
+      auto* out_data = out->data<float>(&place, &size);
+      result.assign(out_data, out_data + size);
+    }).join();
+    return result;
+  };
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  auto expected = run(config);
+  config.SetCpuAffinity({0});
+  config.SetCpuMathLibraryNumThreads(1);
+  EXPECT_EQ(config.cpu_affinity(), std::vector<int>({0}));
+  EXPECT_EQ(run(config), expected);
+}
+
+TEST(AnalysisPredictor, RunStats) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  config.EnableRunStats();
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  for (auto& name : predictor->GetInputNames()) {
+    auto input = predictor->GetInputTensor(name);
+    input->Reshape({4, 1});
+    auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+    for (int i = 0; i < 4; i++) data[i] = i;
+  }
+  const int repeat = 3;
+  for (int i = 0; i < repeat; ++i) {
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+  }
+
+  PaddleRunStats stats;
+  ASSERT_TRUE(predictor->GetRunStats(&stats, 2));
+  EXPECT_EQ(stats.run.count, static_cast<uint64_t>(repeat));
+  EXPECT_EQ(stats.execution.count, static_cast<uint64_t>(repeat));
+  EXPECT_EQ(stats.feed.count, 0UL);
+  EXPECT_EQ(std::accumulate(stats.run.counts.begin(), stats.run.counts.end(),
+                            uint64_t(0)),
+            static_cast<uint64_t>(repeat));
+  EXPECT_LE(stats.execution.total_ms, stats.run.total_ms);
+  EXPECT_LE(stats.run.p50_ms, stats.run.p99_ms);
+  EXPECT_LE(stats.run.p99_ms, stats.run.max_ms);
+  ASSERT_EQ(stats.top_ops.size(), 2UL);
+  EXPECT_GE(stats.top_ops[0].total_ms, stats.top_ops[1].total_ms);
+  EXPECT_EQ(stats.top_ops[0].calls, static_cast<uint64_t>(repeat));
+
+  predictor->ResetRunStats();
+  ASSERT_TRUE(predictor->GetRunStats(&stats));
+  EXPECT_EQ(stats.run.count, 0UL);
+  EXPECT_TRUE(stats.run.counts.empty());
+  for (auto& op : stats.top_ops) {
+    EXPECT_EQ(op.calls, 0UL);
+  }
+
+  // not recorded by default
+  config.EnableRunStats(false);
+  auto other = CreatePaddlePredictor<AnalysisConfig>(config);
+  EXPECT_FALSE(other->GetRunStats(&stats));
+}
+
+TEST(AnalysisPredictor, ShareExternalData) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  std::vector<int64_t> words{0, 1, 2, 3};
+  const std::vector<std::string> input_names{"firstw", "secondw", "thirdw",
+                                             "forthw"};
+  for (auto& name : input_names) {
+    auto input = predictor->GetInputTensor(name);
+    input->Reshape({4, 1});
+    input->copy_from_cpu(words.data());
+  }
+  ASSERT_TRUE(predictor->ZeroCopyRun());
+  auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+  auto shape = out->shape();
+  std::vector<float> expected(std::accumulate(
+      shape.begin(), shape.end(), 1, std::multiplies<int>()));
+  out->copy_to_cpu(expected.data());
+
+  // bind the buffers of the caller, and run twice to cover both copying the
+  // output to the buffer, and writing the output to the buffer directly
+  for (auto& name : input_names) {
+    predictor->GetInputTensor(name)->ShareExternalData(
+        words.data(), {4, 1}, PaddlePlace::kCPU);
+  }
+  std::vector<float> out_data(expected.size());
+  out->ShareExternalData(out_data.data(), shape, PaddlePlace::kCPU);
+  for (int i = 0; i < 2; ++i) {
+    std::fill(out_data.begin(), out_data.end(), 0.f);
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+    for (size_t j = 0; j < expected.size(); ++j) {
+      EXPECT_FLOAT_EQ(out_data[j], expected[j]);
+    }
+  }
+}
+
 TEST(AnalysisPredictor, Clone) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -193,6 +412,56 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, PredictorPool) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  config.SwitchIrOptim(true);
+
+  const size_t pool_size = 3;
+  PredictorPool pool(config, pool_size);
+  ASSERT_EQ(pool.size(), pool_size);
+  // the predictors share the weights of the first one
+  auto* root_scope = static_cast<AnalysisPredictor*>(pool.Retrieve(0))->scope();
+  for (size_t i = 1; i < pool_size; i++) {
+    ASSERT_EQ(static_cast<AnalysisPredictor*>(pool.Retrieve(i))->scope(),
+              root_scope);
+  }
+  ASSERT_EQ(root_scope->kids().size(), pool_size);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  std::vector<PaddleTensor> expected;
+  ASSERT_TRUE(pool.Retrieve(0)->Run(inputs, &expected));
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < pool_size; i++) {
+    threads.emplace_back([&pool, &inputs, &expected, i] {
+      std::vector<PaddleTensor> outputs;
+      for (int j = 0; j < 10; j++) {
+        ASSERT_TRUE(pool.Retrieve(i)->Run(inputs, &outputs));
+      }
+      ASSERT_EQ(outputs.size(), expected.size());
+      for (size_t k = 0; k < outputs.size(); k++) {
+        ASSERT_EQ(outputs[k].data.length(), expected[k].data.length());
+        auto* out = static_cast<float*>(outputs[k].data.data());
+        auto* ref = static_cast<float*>(expected[k].data.data());
+        for (size_t n = 0; n < outputs[k].data.length() / sizeof(float); n++) {
+          EXPECT_NEAR(out[n], ref[n], 1e-5);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_ANY_THROW(pool.Retrieve(pool_size));
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
@@ -483,6 +752,37 @@ TEST_F(MkldnnQuantizerTest, kl_scaling_factor_unsigned) {
   ASSERT_EQ(lod_tensor.numel(), 1);
   ASSERT_NEAR(lod_tensor.data<double>()[0], 1.0 / 0.0252845321362, abs_error);
 }
+
+TEST(MkldnnQuantizer, save_and_load_scales) {
+  AnalysisConfig config(FLAGS_dirname);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor_p = static_cast<AnalysisPredictor*>(predictor.get());
+  MkldnnQuantizerConfig qconfig;
+  qconfig.SetScalesFile("./mkldnn_quantizer_scales.txt");
+  std::remove(qconfig.scales_file().c_str());
+
+  AnalysisPredictor::MkldnnQuantizer saver(*predictor_p, &qconfig);
+  ASSERT_FALSE(saver.LoadScales());
+  framework::LoDTensor scale;
+  scale.Resize({2});
+  auto* scale_data = scale.mutable_data<double>(platform::CPUPlace());
+  scale_data[0] = 1.0 / 3;
+  scale_data[1] = 127.5;
+  saver.scales_["conv_out"] = {true, scale};
+  saver.scales_["fc_in"] = {false, scale};
+  saver.SaveScales();
+
+  AnalysisPredictor::MkldnnQuantizer loader(*predictor_p, &qconfig);
+  ASSERT_TRUE(loader.LoadScales());
+  ASSERT_EQ(loader.scales_.size(), 2UL);
+  EXPECT_TRUE(loader.scales_["conv_out"].first);
+  EXPECT_FALSE(loader.scales_["fc_in"].first);
+  auto& loaded = loader.scales_["fc_in"].second;
+  ASSERT_EQ(loaded.numel(), 2);
+  EXPECT_EQ(loaded.data<double>()[0], scale_data[0]);
+  EXPECT_EQ(loaded.data<double>()[1], scale_data[1]);
+  std::remove(qconfig.scales_file().c_str());
+}
 #endif
 
 }  // namespace paddle
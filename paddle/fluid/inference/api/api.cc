@@ -19,6 +19,7 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_pass_builder.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -112,6 +113,40 @@ void PaddleBuf::Free() {
   }
 }
 
+bool GetMemoryStats(int device_id, PaddleMemoryStats *stats) {
+  PADDLE_ENFORCE_NOT_NULL(stats, platform::errors::InvalidArgument(
+                                     "The output stats should not be null."));
+  platform::Place place;
+  if (device_id < 0) {
+    place = platform::CPUPlace();
+  } else {
+    place = platform::CUDAPlace(device_id);
+  }
+  memory::allocation::AllocatorStats allocator_stats;
+  if (!memory::allocation::AllocatorFacade::Instance().GetStats(
+          place, &allocator_stats)) {
+    return false;
+  }
+  stats->allocated_bytes = allocator_stats.allocated_bytes;
+  stats->peak_allocated_bytes = allocator_stats.peak_allocated_bytes;
+  stats->reserved_bytes = allocator_stats.reserved_bytes;
+  stats->largest_free_chunk_bytes = allocator_stats.largest_free_chunk_bytes;
+  stats->fragmentation_ratio = allocator_stats.FragmentationRatio();
+  stats->alloc_counts.assign(allocator_stats.alloc_counts.begin(),
+                             allocator_stats.alloc_counts.end());
+  return true;
+}
+
+size_t ReleaseMemory(int device_id) {
+  platform::Place place;
+  if (device_id < 0) {
+    place = platform::CPUPlace();
+  } else {
+    place = platform::CUDAPlace(device_id);
+  }
+  return memory::allocation::AllocatorFacade::Instance().Release(place);
+}
+
 std::string get_version() {
   std::stringstream ss;
   ss << "version: " << framework::paddle_version() << "\n";
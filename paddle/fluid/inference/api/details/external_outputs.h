@@ -0,0 +1,33 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace details {
+
+// The external buffers bound to the outputs of a predictor by
+// ZeroCopyTensor::ShareExternalData, from the output names to the whole
+// buffers. The predictor copies an output into its buffer after running if
+// the output is not written to the buffer directly.
+using ExternalOutputs =
+    std::unordered_map<std::string, std::shared_ptr<memory::Allocation>>;
+
+}  // namespace details
+}  // namespace paddle
@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/inference/api/details/external_outputs.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -145,6 +147,49 @@ void ZeroCopyTensor::copy_to_cpu(T *data) {
 #endif
   }
 }
+template <typename T>
+void ZeroCopyTensor::ShareExternalData(T *data, const std::vector<int> &shape,
+                                       PaddlePlace place) {
+  EAGER_GET_TENSOR;
+  PADDLE_ENFORCE_NOT_NULL(
+      data, platform::errors::InvalidArgument(
+                "The external data of the tensor %s is nullptr.", name_));
+  platform::Place data_place;
+  if (place == PaddlePlace::kCPU) {
+    data_place = platform::CPUPlace();
+  } else if (place == PaddlePlace::kGPU) {
+#ifdef PADDLE_WITH_CUDA
+    data_place = platform::CUDAPlace(device_);
+#else
+    PADDLE_THROW(platform::errors::Unavailable(
+        "Not compiled with CUDA, the external data of the tensor %s can not "
+        "be on GPU.",
+        name_));
+#endif
+  } else {
+    PADDLE_THROW(platform::errors::InvalidArgument(
+        "Unsupported place %d of the external data of the tensor %s.",
+        static_cast<int>(place), name_));
+  }
+
+  auto dims = framework::make_ddim(shape);
+  size_t size = framework::product(dims) * sizeof(T);
+  // the allocation does not own the data, i.e., it only deletes itself
+  auto holder = std::make_shared<memory::Allocation>(
+      static_cast<void *>(data), size, data_place);
+  tensor->clear();
+  tensor->Resize(dims);
+  tensor->ResetHolderWithType(holder, framework::DataTypeTrait<T>::DataType());
+  if (!input_or_output_) {
+    PADDLE_ENFORCE_NOT_NULL(
+        external_outputs_,
+        platform::errors::PreconditionNotMet(
+            "The output tensor %s does not belong to a predictor.", name_));
+    (*static_cast<details::ExternalOutputs *>(external_outputs_))[name_] =
+        holder;
+  }
+}
+
 template PD_INFER_DECL void ZeroCopyTensor::copy_from_cpu<float>(
     const float *data);
 template PD_INFER_DECL void ZeroCopyTensor::copy_from_cpu<int64_t>(
@@ -158,6 +203,15 @@ template PD_INFER_DECL void ZeroCopyTensor::copy_to_cpu<int64_t>(int64_t *data);
 template PD_INFER_DECL void ZeroCopyTensor::copy_to_cpu<int32_t>(int32_t *data);
 template PD_INFER_DECL void ZeroCopyTensor::copy_to_cpu<uint8_t>(uint8_t *data);
 
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<float>(
+    float *data, const std::vector<int> &shape, PaddlePlace place);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<int64_t>(
+    int64_t *data, const std::vector<int> &shape, PaddlePlace place);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<int32_t>(
+    int32_t *data, const std::vector<int> &shape, PaddlePlace place);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<uint8_t>(
+    uint8_t *data, const std::vector<int> &shape, PaddlePlace place);
+
 template PD_INFER_DECL float *ZeroCopyTensor::data<float>(PaddlePlace *place,
                                                           int *size) const;
 template PD_INFER_DECL int64_t *ZeroCopyTensor::data<int64_t>(
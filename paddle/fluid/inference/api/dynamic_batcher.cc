@@ -0,0 +1,329 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_dynamic_batcher.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+
+namespace {
+
+size_t NumRows(const PaddleTensor &tensor) {
+  PADDLE_ENFORCE_GT(tensor.shape.size(), 0UL,
+                    platform::errors::InvalidArgument(
+                        "The tensor %s is a scalar, which can not be batched.",
+                        tensor.name));
+  return static_cast<size_t>(tensor.shape[0]);
+}
+
+size_t RowBytes(const PaddleTensor &tensor) {
+  size_t numel = 1;
+  for (size_t i = 1; i < tensor.shape.size(); ++i) {
+    numel *= static_cast<size_t>(tensor.shape[i]);
+  }
+  return numel * PaddleDtypeSize(tensor.dtype);
+}
+
+// The number of instances, i.e., the top level sequences if the tensor has
+// LoD, or the rows otherwise.
+size_t NumInstances(const PaddleTensor &tensor) {
+  if (tensor.lod.empty()) return NumRows(tensor);
+  PADDLE_ENFORCE_GT(tensor.lod[0].size(), 0UL,
+                    platform::errors::InvalidArgument(
+                        "The LoD of %s is empty.", tensor.name));
+  return tensor.lod[0].size() - 1;
+}
+
+void CheckInput(const PaddleTensor &tensor) {
+  size_t rows = NumRows(tensor);
+  PADDLE_ENFORCE_EQ(
+      tensor.data.length(), rows * RowBytes(tensor),
+      platform::errors::InvalidArgument(
+          "The input %s holds %d bytes, but its shape needs %d bytes.",
+          tensor.name, tensor.data.length(), rows * RowBytes(tensor)));
+  for (auto &level : tensor.lod) {
+    PADDLE_ENFORCE_EQ(level.empty(), false,
+                      platform::errors::InvalidArgument(
+                          "The LoD of the input %s has an empty level.",
+                          tensor.name));
+  }
+  if (!tensor.lod.empty()) {
+    PADDLE_ENFORCE_EQ(tensor.lod.back().back() - tensor.lod.back().front(),
+                      rows, platform::errors::InvalidArgument(
+                                "The LoD of the input %s does not match its "
+                                "%d rows.",
+                                tensor.name, rows));
+  }
+}
+
+bool Batchable(const std::vector<PaddleTensor> &a,
+               const std::vector<PaddleTensor> &b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].name != b[i].name || a[i].dtype != b[i].dtype ||
+        a[i].lod.size() != b[i].lod.size() ||
+        a[i].shape.size() != b[i].shape.size() ||
+        !std::equal(a[i].shape.begin() + 1, a[i].shape.end(),
+                    b[i].shape.begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Concatenate the parts along the first dimension and merge their LoDs.
+PaddleTensor Concat(const std::vector<const PaddleTensor *> &parts) {
+  auto &first = *parts.front();
+  PaddleTensor out;
+  out.name = first.name;
+  out.dtype = first.dtype;
+  out.shape = first.shape;
+  size_t rows = 0;
+  for (auto *part : parts) {
+    rows += NumRows(*part);
+  }
+  out.shape[0] = static_cast<int>(rows);
+
+  size_t row_bytes = RowBytes(first);
+  out.data.Resize(rows * row_bytes);
+  char *dst = static_cast<char *>(out.data.data());
+  for (auto *part : parts) {
+    size_t bytes = NumRows(*part) * row_bytes;
+    if (bytes > 0) std::memcpy(dst, part->data.data(), bytes);
+    dst += bytes;
+  }
+
+  out.lod.resize(first.lod.size());
+  for (size_t level = 0; level < out.lod.size(); ++level) {
+    auto &merged = out.lod[level];
+    merged.push_back(0);
+    for (auto *part : parts) {
+      auto &offsets = part->lod[level];
+      size_t base = merged.back() - offsets.front();
+      for (size_t k = 1; k < offsets.size(); ++k) {
+        merged.push_back(base + offsets[k]);
+      }
+    }
+  }
+  return out;
+}
+
+// Split the output of a batch by the instances of the requests.
+std::vector<PaddleTensor> Split(const PaddleTensor &out,
+                                const std::vector<size_t> &instances) {
+  size_t total = 0;
+  for (auto n : instances) total += n;
+  size_t rows = NumRows(out);
+  if (out.lod.empty()) {
+    PADDLE_ENFORCE_EQ(rows, total,
+                      platform::errors::InvalidArgument(
+                          "The output %s has %d rows, which can not be split "
+                          "into %d instances.",
+                          out.name, rows, total));
+  } else {
+    PADDLE_ENFORCE_EQ(out.lod[0].size(), total + 1,
+                      platform::errors::InvalidArgument(
+                          "The output %s has %d sequences, which can not be "
+                          "split into %d instances.",
+                          out.name, out.lod[0].size() - 1, total));
+  }
+
+  size_t row_bytes = RowBytes(out);
+  std::vector<PaddleTensor> parts(instances.size());
+  size_t begin = 0;
+  for (size_t i = 0; i < instances.size(); ++i) {
+    auto &part = parts[i];
+    part.name = out.name;
+    part.dtype = out.dtype;
+    part.shape = out.shape;
+    // the range of the instances, and then the range of every next level
+    size_t row_begin = begin, row_end = begin + instances[i];
+    part.lod.resize(out.lod.size());
+    for (size_t level = 0; level < out.lod.size(); ++level) {
+      auto &offsets = out.lod[level];
+      part.lod[level].reserve(row_end - row_begin + 1);
+      for (size_t k = row_begin; k <= row_end; ++k) {
+        part.lod[level].push_back(offsets[k] - offsets[row_begin]);
+      }
+      row_begin = offsets[row_begin];
+      row_end = offsets[row_end];
+    }
+    part.shape[0] = static_cast<int>(row_end - row_begin);
+    size_t bytes = (row_end - row_begin) * row_bytes;
+    part.data.Resize(bytes);
+    if (bytes > 0) {
+      std::memcpy(part.data.data(),
+                  static_cast<const char *>(out.data.data()) +
+                      row_begin * row_bytes,
+                  bytes);
+    }
+    begin += instances[i];
+  }
+  return parts;
+}
+
+}  // namespace
+
+DynamicBatcher::DynamicBatcher(const std::vector<PaddlePredictor *> &predictors,
+                               const DynamicBatcherConfig &config)
+    : config_(config) {
+  PADDLE_ENFORCE_GT(predictors.size(), 0UL,
+                    platform::errors::InvalidArgument(
+                        "DynamicBatcher needs at least one predictor."));
+  PADDLE_ENFORCE_GT(config_.max_batch_size, 0UL,
+                    platform::errors::InvalidArgument(
+                        "The max batch size of DynamicBatcher should be "
+                        "larger than 0."));
+  for (auto *predictor : predictors) {
+    PADDLE_ENFORCE_NOT_NULL(
+        predictor, platform::errors::InvalidArgument(
+                       "The predictor of DynamicBatcher is nullptr."));
+    workers_.emplace_back(&DynamicBatcher::WorkerLoop, this, predictor);
+  }
+}
+
+DynamicBatcher::~DynamicBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<std::vector<PaddleTensor>> DynamicBatcher::Submit(
+    std::vector<PaddleTensor> inputs) {
+  std::unique_ptr<Request> request(new Request);
+  auto future = request->outputs.get_future();
+  try {
+    PADDLE_ENFORCE_EQ(inputs.empty(), false,
+                      platform::errors::InvalidArgument(
+                          "A request of DynamicBatcher has no input."));
+    for (auto &input : inputs) {
+      CheckInput(input);
+    }
+    request->batch_size = NumInstances(inputs.front());
+  } catch (...) {
+    request->outputs.set_exception(std::current_exception());
+    return future;
+  }
+  request->inputs = std::move(inputs);
+  request->arrival = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    queued_instances_ += request->batch_size;
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_all();
+  return future;
+}
+
+void DynamicBatcher::WorkerLoop(PaddlePredictor *predictor) {
+  auto max_delay = std::chrono::microseconds(config_.max_delay_us);
+  while (true) {
+    std::vector<std::unique_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      // wait until the batch is full or its first request times out, the
+      // pending requests are run at once when stopping
+      while (!stop_ && !queue_.empty() &&
+             queued_instances_ < config_.max_batch_size) {
+        auto deadline = queue_.front()->arrival + max_delay;
+        if (cv_.wait_until(lock, deadline) == std::cv_status::timeout) break;
+      }
+      // the requests may be taken by another worker
+      if (queue_.empty()) continue;
+      PopBatch(&batch);
+    }
+    RunBatch(predictor, &batch);
+  }
+}
+
+void DynamicBatcher::PopBatch(std::vector<std::unique_ptr<Request>> *batch) {
+  size_t instances = 0;
+  while (!queue_.empty()) {
+    auto &request = queue_.front();
+    if (!batch->empty() &&
+        (instances + request->batch_size > config_.max_batch_size ||
+         !Batchable(batch->front()->inputs, request->inputs))) {
+      break;
+    }
+    instances += request->batch_size;
+    queued_instances_ -= request->batch_size;
+    batch->push_back(std::move(request));
+    queue_.pop_front();
+  }
+}
+
+void DynamicBatcher::RunBatch(PaddlePredictor *predictor,
+                              std::vector<std::unique_ptr<Request>> *batch) {
+  std::vector<std::vector<PaddleTensor>> results(batch->size());
+  try {
+    std::vector<PaddleTensor> inputs;
+    if (batch->size() == 1) {
+      inputs = std::move(batch->front()->inputs);
+    } else {
+      for (size_t i = 0; i < batch->front()->inputs.size(); ++i) {
+        std::vector<const PaddleTensor *> parts;
+        parts.reserve(batch->size());
+        for (auto &request : *batch) {
+          parts.push_back(&request->inputs[i]);
+        }
+        inputs.push_back(Concat(parts));
+      }
+    }
+
+    std::vector<PaddleTensor> outputs;
+    PADDLE_ENFORCE_EQ(predictor->Run(inputs, &outputs), true,
+                      platform::errors::Fatal(
+                          "Failed to run a batch of %d requests.",
+                          batch->size()));
+
+    if (batch->size() == 1) {
+      results[0] = std::move(outputs);
+    } else {
+      std::vector<size_t> instances;
+      instances.reserve(batch->size());
+      for (auto &request : *batch) {
+        instances.push_back(request->batch_size);
+      }
+      for (auto &output : outputs) {
+        auto parts = Split(output, instances);
+        for (size_t i = 0; i < parts.size(); ++i) {
+          results[i].push_back(std::move(parts[i]));
+        }
+      }
+    }
+  } catch (...) {
+    auto error = std::current_exception();
+    for (auto &request : *batch) {
+      request->outputs.set_exception(error);
+    }
+    return;
+  }
+  for (size_t i = 0; i < batch->size(); ++i) {
+    (*batch)[i]->outputs.set_value(std::move(results[i]));
+  }
+}
+
+}  // namespace paddle
@@ -0,0 +1,166 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_dynamic_batcher.h"
+
+namespace paddle {
+
+// Doubles the dense input "x" to "y", and adds 1 to the LoD input "ids" to
+// "ids_out" with the same LoD.
+class FakePredictor : public PaddlePredictor {
+ public:
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *output_data,
+           int batch_size = 0) override {
+    max_batch_size = std::max(max_batch_size.load(), inputs[0].shape[0]);
+    ++run_times;
+    output_data->clear();
+    for (auto &input : inputs) {
+      PaddleTensor out = input;
+      if (input.dtype == PaddleDType::FLOAT32) {
+        out.name = "y";
+        auto *data = static_cast<float *>(out.data.data());
+        for (size_t i = 0; i < out.data.length() / sizeof(float); ++i) {
+          data[i] *= 2;
+        }
+      } else {
+        out.name = "ids_out";
+        auto *data = static_cast<int64_t *>(out.data.data());
+        for (size_t i = 0; i < out.data.length() / sizeof(int64_t); ++i) {
+          data[i] += 1;
+        }
+      }
+      output_data->push_back(std::move(out));
+    }
+    return true;
+  }
+
+  std::unique_ptr<PaddlePredictor> Clone() override { return nullptr; }
+
+  std::atomic<int> max_batch_size{0};
+  std::atomic<int> run_times{0};
+};
+
+static PaddleTensor DenseInput(int rows, int cols, float value) {
+  PaddleTensor tensor;
+  tensor.name = "x";
+  tensor.shape = {rows, cols};
+  tensor.dtype = PaddleDType::FLOAT32;
+  tensor.data.Resize(rows * cols * sizeof(float));
+  auto *data = static_cast<float *>(tensor.data.data());
+  for (int i = 0; i < rows * cols; ++i) {
+    data[i] = value + i;
+  }
+  return tensor;
+}
+
+// A sequence of length i + 1 for the i-th instance.
+static PaddleTensor LoDInput(int instances, int64_t value) {
+  PaddleTensor tensor;
+  tensor.name = "ids";
+  tensor.dtype = PaddleDType::INT64;
+  tensor.lod.resize(1);
+  tensor.lod[0].push_back(0);
+  for (int i = 0; i < instances; ++i) {
+    tensor.lod[0].push_back(tensor.lod[0].back() + i + 1);
+  }
+  int rows = static_cast<int>(tensor.lod[0].back());
+  tensor.shape = {rows, 1};
+  tensor.data.Resize(rows * sizeof(int64_t));
+  auto *data = static_cast<int64_t *>(tensor.data.data());
+  for (int i = 0; i < rows; ++i) {
+    data[i] = value + i;
+  }
+  return tensor;
+}
+
+TEST(DynamicBatcher, batch_and_scatter) {
+  FakePredictor predictor;
+  DynamicBatcherConfig config;
+  config.max_batch_size = 8;
+  config.max_delay_us = 100000;
+  DynamicBatcher batcher({&predictor}, config);
+
+  const int request_num = 32;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < request_num; ++t) {
+    threads.emplace_back([&batcher, t] {
+      int instances = t % 3 + 1;
+      std::vector<PaddleTensor> inputs{DenseInput(instances, 2, t * 10),
+                                       LoDInput(instances, t * 100)};
+      auto outputs = batcher.Submit(std::move(inputs)).get();
+      ASSERT_EQ(outputs.size(), 2UL);
+
+      auto &y = outputs[0];
+      EXPECT_EQ(y.name, "y");
+      ASSERT_EQ(y.shape, std::vector<int>({instances, 2}));
+      auto *y_data = static_cast<float *>(y.data.data());
+      for (int i = 0; i < instances * 2; ++i) {
+        EXPECT_EQ(y_data[i], (t * 10 + i) * 2);
+      }
+
+      auto &ids = outputs[1];
+      auto expected_ids = LoDInput(instances, t * 100 + 1);
+      EXPECT_EQ(ids.name, "ids_out");
+      EXPECT_EQ(ids.lod, expected_ids.lod);
+      ASSERT_EQ(ids.shape, expected_ids.shape);
+      auto *ids_data = static_cast<int64_t *>(ids.data.data());
+      auto *expected_data = static_cast<int64_t *>(expected_ids.data.data());
+      for (int i = 0; i < ids.shape[0]; ++i) {
+        EXPECT_EQ(ids_data[i], expected_data[i]);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  EXPECT_LE(predictor.max_batch_size, config.max_batch_size);
+  EXPECT_LT(predictor.run_times, request_num);
+}
+
+TEST(DynamicBatcher, invalid_request) {
+  FakePredictor predictor;
+  DynamicBatcher batcher({&predictor}, DynamicBatcherConfig());
+  auto tensor = DenseInput(2, 2, 0);
+  tensor.shape = {3, 2};
+  auto outputs = batcher.Submit({tensor});
+  EXPECT_ANY_THROW(outputs.get());
+
+  // the requests are still served after an invalid one
+  outputs = batcher.Submit({DenseInput(2, 2, 0)});
+  EXPECT_EQ(outputs.get().size(), 1UL);
+}
+
+TEST(DynamicBatcher, incompatible_requests) {
+  FakePredictor predictors[2];
+  DynamicBatcherConfig config;
+  config.max_delay_us = 10000;
+  DynamicBatcher batcher({&predictors[0], &predictors[1]}, config);
+  std::vector<std::future<std::vector<PaddleTensor>>> futures;
+  for (int i = 0; i < 8; ++i) {
+    futures.push_back(batcher.Submit({DenseInput(1, i % 2 + 1, i)}));
+  }
+  for (int i = 0; i < 8; ++i) {
+    auto outputs = futures[i].get();
+    ASSERT_EQ(outputs.size(), 1UL);
+    EXPECT_EQ(outputs[0].shape, std::vector<int>({1, i % 2 + 1}));
+    EXPECT_EQ(static_cast<float *>(outputs[0].data.data())[0], i * 2);
+  }
+}
+
+}  // namespace paddle
@@ -21,6 +21,7 @@
 #endif
 #include <algorithm>
 #include <chrono>  // NOLINT
+#include <cmath>
 #include <functional>
 #include <iterator>
 #include <numeric>
@@ -59,6 +60,64 @@ constexpr PaddleDType PaddleTensorGetDType<float>() {
 
 using paddle::framework::DataTypeToString;
 
+// A latency histogram with the buckets of powers of 2 from 0.01 ms, see
+// PaddleLatencyStats. It is not thread safe.
+class LatencyHistogram {
+ public:
+  LatencyHistogram() { Reset(); }
+
+  void Add(double ms) {
+    int bucket = 0;
+    for (double bound = kFirstBoundMs; ms >= bound && bucket < kBuckets - 1;
+         bound *= 2) {
+      ++bucket;
+    }
+    ++counts_[bucket];
+    ++count_;
+    total_ms_ += ms;
+    max_ms_ = std::max(max_ms_, ms);
+  }
+
+  void GetStats(PaddleLatencyStats *stats) const {
+    stats->count = count_;
+    stats->total_ms = total_ms_;
+    stats->max_ms = max_ms_;
+    stats->counts.assign(counts_, counts_ + kBuckets);
+    while (!stats->counts.empty() && stats->counts.back() == 0) {
+      stats->counts.pop_back();
+    }
+    stats->p50_ms = Percentile(0.5);
+    stats->p90_ms = Percentile(0.9);
+    stats->p99_ms = Percentile(0.99);
+  }
+
+  void Reset() {
+    std::fill(counts_, counts_ + kBuckets, 0);
+    count_ = 0;
+    total_ms_ = 0;
+    max_ms_ = 0;
+  }
+
+ private:
+  double Percentile(double p) const {
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p * count_));
+    uint64_t seen = 0;
+    double bound = kFirstBoundMs;
+    for (int i = 0; i < kBuckets; ++i, bound *= 2) {
+      seen += counts_[i];
+      if (seen >= rank && seen > 0) return std::min(bound, max_ms_);
+    }
+    return max_ms_;
+  }
+
+  static constexpr int kBuckets = 32;
+  static constexpr double kFirstBoundMs = 0.01;
+  uint64_t counts_[kBuckets];
+  uint64_t count_;
+  double total_ms_;
+  double max_ms_;
+};
+
 // Timer for timer
 class Timer {
  public:
@@ -14,9 +14,13 @@
 
 #include "paddle/fluid/inference/api/mkldnn_quantizer.h"
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
 #include <limits>
 #include <map>
 #include <numeric>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include "paddle/fluid/framework/eigen.h"
@@ -424,8 +428,11 @@ void AnalysisPredictor::MkldnnQuantizer::PrepareArgument() const {
 }
 
 bool AnalysisPredictor::MkldnnQuantizer::Quantize() {
-  if (!RunWarmup()) return false;
-  if (!CalculateScales()) return false;
+  if (!LoadScales()) {
+    if (!RunWarmup()) return false;
+    if (!CalculateScales()) return false;
+    SaveScales();
+  }
   ClearDeviceContext();
   predictor_.PrepareScope(predictor_.scope_);
   predictor_.CreateExecutor();
@@ -435,6 +442,96 @@ bool AnalysisPredictor::MkldnnQuantizer::Quantize() {
   return true;
 }
 
+// The scales file holds a line per variable:
+//   var_name is_unsigned channels scale_0 ... scale_{channels-1}
+bool AnalysisPredictor::MkldnnQuantizer::LoadScales() {
+  const auto& path = qconfig_->scales_file();
+  if (path.empty()) return false;
+  std::ifstream fin(path);
+  if (!fin.is_open()) return false;
+
+  VarQuantScale scales;
+  std::string var_name;
+  bool is_unsigned;
+  int64_t channels;
+  while (fin >> var_name >> is_unsigned >> channels) {
+    if (channels <= 0) break;
+    auto scale_tensor = CreateScaleTensor(channels);
+    auto* data = scale_tensor.data<double>();
+    for (int64_t i = 0; i < channels && fin; ++i) fin >> data[i];
+    if (!fin) break;
+    scales[var_name] = {is_unsigned, scale_tensor};
+  }
+  if (!fin.eof()) {
+    LOG(WARNING) << "The scales file " << path
+                 << " is corrupted, the scales are recalculated.";
+    return false;
+  }
+
+  // the model may be changed since the scales are saved
+  for (const auto* op : predictor_.inference_program_->Block(0).AllOps()) {
+    if (!op->HasAttr("use_quantizer") ||
+        !BOOST_GET_CONST(bool, op->GetAttr("use_quantizer"))) {
+      continue;
+    }
+    for (const auto* connections : {&op->Inputs(), &op->Outputs()}) {
+      for (const auto& conn : *connections) {
+        if (qconfig_->scale_algo(op->Type(), conn.first) == ScaleAlgo::NONE)
+          continue;
+        for (const auto& name : conn.second) {
+          if (scales.count(name) == 0) {
+            LOG(WARNING) << "The scales file " << path
+                         << " misses the scale of " << name
+                         << ", the scales are recalculated.";
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  PrettyLogH1("--- Loaded the scales for quantization from %s", path);
+  scales_ = std::move(scales);
+  return true;
+}
+
+void AnalysisPredictor::MkldnnQuantizer::SaveScales() const {
+  const auto& path = qconfig_->scales_file();
+  if (path.empty()) return;
+  // write to a temporary file first, so that a concurrent predictor never
+  // reads a partial file
+  std::string tmp_path =
+      path + ".tmp" +
+      std::to_string(
+          std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream fout(tmp_path);
+    if (!fout.is_open()) {
+      LOG(WARNING) << "Failed to open " << tmp_path
+                   << " to save the quantization scales.";
+      return;
+    }
+    fout.precision(std::numeric_limits<double>::max_digits10);
+    for (const auto& item : scales_) {
+      const auto& tensor = item.second.second;
+      fout << item.first << " " << item.second.first << " " << tensor.numel();
+      for (int64_t i = 0; i < tensor.numel(); ++i) {
+        fout << " " << tensor.data<double>()[i];
+      }
+      fout << "\n";
+    }
+    if (!fout.good()) {
+      LOG(WARNING) << "Failed to save the quantization scales to " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to save the quantization scales to " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
 bool AnalysisPredictor::MkldnnQuantizer::RunQuantizePasses() const {
   predictor_.executor_->CreateVariables(*predictor_.inference_program_, 0, true,
                                         predictor_.sub_scope_);
@@ -54,6 +54,7 @@ class AnalysisPredictor::MkldnnQuantizer {
 
 #if PADDLE_WITH_TESTING
   friend class MkldnnQuantizerTest;
+  FRIEND_TEST(MkldnnQuantizer, save_and_load_scales);
 #endif
 
  private:
@@ -67,6 +68,11 @@ class AnalysisPredictor::MkldnnQuantizer {
                             const std::string& var_name,
                             const framework::LoDTensor& var_tensor,
                             bool is_unsigned);
+  // Load the scales from the scales file, return false if the file does not
+  // exist or misses the scale of any variable to be quantized.
+  bool LoadScales();
+  // Save the calculated scales to the scales file.
+  void SaveScales() const;
   void PrepareArgument() const;
   void ClearDeviceContext() const;
   bool RunQuantizePasses() const;
@@ -49,6 +49,11 @@ MkldnnQuantizerConfig::MkldnnQuantizerConfig() {
   rules_["matmul"]["Y"] = ScaleAlgo::KL;
   rules_["matmul"]["Out"] = ScaleAlgo::KL;
 
+  // The inputs of elementwise_add are quantized with the scale of the output.
+  rules_["elementwise_add"]["X"] = ScaleAlgo::NONE;
+  rules_["elementwise_add"]["Y"] = ScaleAlgo::NONE;
+  rules_["elementwise_add"]["Out"] = ScaleAlgo::KL;
+
   // Reshape2 does not perform calculation on the data and shapes are not
   // changed. Scale is calculated on input data and assign to Quantize and
   // Dequantize scale.
@@ -130,6 +130,48 @@ struct PD_INFER_DECL AnalysisConfig {
     opt_cache_dir_ = opt_cache_dir;
   }
   ///
+  /// \brief Cache the optimized model, i.e., the program and parameters
+  /// after the IR passes and the serialized TensorRT engines, under the
+  /// directory. The cache is keyed by the model files, the config, the
+  /// device and the version of Paddle, so that a later predictor of the same
+  /// key skips the analysis and the engine building.
+  /// It is ignored if the model is loaded from memory, the IR optimization is
+  /// off, or the Lite engine, the MKLDNN quantizer, the static memory plan or
+  /// the TensorRT int8 calibration is used.
+  ///
+  /// \param cache_dir the directory of the optimized models.
+  ///
+  void EnableOptimModelCache(const std::string& cache_dir) {
+    optim_model_cache_dir_ = cache_dir;
+  }
+  ///
+  /// \brief Get the directory of the optimized model cache.
+  ///
+  /// \return const std::string& The directory, empty if the cache is off.
+  ///
+  const std::string& optim_model_cache_dir() const {
+    return optim_model_cache_dir_;
+  }
+  ///
+  /// \brief Share the program and the parameters with the other predictors of
+  /// the same model, config and device in the process.
+  ///
+  /// The first of the predictors loads and optimizes the model, and the
+  /// others are set up as its clones, instead of parsing and optimizing the
+  /// model again and holding their own copies of the program and the
+  /// parameters. The shared program is read-only, it is copied by the
+  /// predictor which modifies it through AnalysisPredictor::program().
+  ///
+  /// \param x Whether to share the program.
+  ///
+  void EnableProgramSharing(bool x = true) { share_program_ = x; }
+  ///
+  /// \brief A boolean state telling whether the program is shared.
+  ///
+  /// \return bool Whether the program is shared.
+  ///
+  bool program_sharing_enabled() const { return share_program_; }
+  ///
   /// \brief Get the model directory path.
   ///
   /// \return const std::string& The model directory path.
@@ -282,6 +324,8 @@ struct PD_INFER_DECL AnalysisConfig {
   /// engine.
   /// \param precision The precision used in TensorRT.
   /// \param use_static Serialize optimization information to disk for reusing.
+  /// The serialized engines, with static or dynamic shape, are keyed by the
+  /// shape ranges, precision, plugin versions, TensorRT version and GPU SM.
   /// \param use_calib_mode Use TRT int8 calibration(post training
   /// quantization).
   ///
@@ -298,6 +342,46 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool tensorrt_engine_enabled() const { return use_tensorrt_; }
   ///
+  /// \brief Share the TensorRT engines with the other predictors of the same
+  /// model, config and device.
+  ///
+  /// The engines are built or deserialized by the first of the predictors,
+  /// and the others reuse them instead of holding their own copies on the
+  /// device. Each thread running an engine has its own execution context,
+  /// whose device memory is allocated by Paddle. The clones of a predictor
+  /// always share its engines. It does not apply to the int8 calibration
+  /// mode.
+  ///
+  /// \param x Whether to share the TensorRT engines.
+  ///
+  void EnableTensorRtEngineSharing(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the TensorRT engines are shared.
+  ///
+  /// \return bool Whether the TensorRT engines are shared.
+  ///
+  bool tensorrt_engine_sharing_enabled() const { return trt_share_engine_; }
+  ///
+  /// \brief Turn on the benefit estimate of the TensorRT sub-graphs.
+  ///
+  /// A sub-graph larger than the min subgraph size is still left to Paddle
+  /// if its engine is estimated to cost more than it gains, e.g., a few cheap
+  /// ops exchanging many variables with Paddle. The estimate is a rough
+  /// heuristic, so it is off by default.
+  ///
+  /// \param x Whether to estimate the benefit of the TensorRT sub-graphs.
+  ///
+  void EnableTensorRtBenefitEstimate(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the benefit of the TensorRT
+  /// sub-graphs is estimated.
+  ///
+  /// \return bool Whether the benefit of the TensorRT sub-graphs is estimated.
+  ///
+  bool tensorrt_benefit_estimate_enabled() const {
+    return trt_estimate_benefit_;
+  }
+  ///
   /// \brief Set min, max, opt shape for TensorRT Dynamic shape mode.
   /// \param min_input_shape The min input shape of the subgraph input.
   /// \param max_input_shape The max input shape of the subgraph input.
@@ -311,16 +395,35 @@ struct PD_INFER_DECL AnalysisConfig {
       std::map<std::string, std::vector<int>> optim_input_shape,
       bool disable_trt_plugin_fp16 = false);
   ///
+  /// \brief Add another optimization profile for TensorRT dynamic shape mode.
+  ///
+  /// The shapes set by SetTRTDynamicShapeInfo are the first profile, and all
+  /// the profiles are built into one engine. At runtime, an engine runs with
+  /// the first profile, in the order they are added, whose min and max shapes
+  /// cover the shapes of its inputs. e.g., a profile per range of sequence
+  /// lengths lets the short sequences run the kernels tuned for them.
+  ///
+  /// \param min_input_shape The min input shape of the subgraph input.
+  /// \param max_input_shape The max input shape of the subgraph input.
+  /// \param opt_input_shape The opt input shape of the subgraph input.
+  ///
+  void AddTRTDynamicShapeProfile(
+      std::map<std::string, std::vector<int>> min_input_shape,
+      std::map<std::string, std::vector<int>> max_input_shape,
+      std::map<std::string, std::vector<int>> optim_input_shape);
+  ///
   /// \brief Turn on the usage of Lite sub-graph engine.
   ///
   /// \param precision_mode Precion used in Lite sub-graph engine.
   /// \param passes_filter Set the passes used in Lite sub-graph engine.
   /// \param ops_filter Operators not supported by Lite.
+  /// \param zero_copy Whether the Lite sub-graph engine shares the memory of
+  /// its inputs and outputs with Paddle, instead of copying them.
   ///
   void EnableLiteEngine(
       AnalysisConfig::Precision precision_mode = Precision::kFloat32,
       const std::vector<std::string>& passes_filter = {},
-      const std::vector<std::string>& ops_filter = {});
+      const std::vector<std::string>& ops_filter = {}, bool zero_copy = false);
 
   ///
   /// \brief A boolean state indicating whether the Lite sub-graph engine is
@@ -376,6 +479,24 @@ struct PD_INFER_DECL AnalysisConfig {
   int cpu_math_library_num_threads() const {
     return cpu_math_library_num_threads_;
   }
+  ///
+  /// \brief Run the predictor on its own worker thread bound to the CPUs.
+  /// The math library threads of the worker, whose number is set by
+  /// SetCpuMathLibraryNumThreads, are bound to the CPUs too, and do not
+  /// change the setting of the other predictors. So the predictors in one
+  /// process can run on disjoint CPUs without interfering with each other.
+  /// Only supported on Linux, otherwise the worker runs on all the CPUs.
+  ///
+  /// \param cpus The ids of the CPUs.
+  ///
+  void SetCpuAffinity(const std::vector<int>& cpus);
+  ///
+  /// \brief The CPUs which the predictor is bound to.
+  ///
+  /// \return const std::vector<int>& The ids of the CPUs, empty if the
+  /// predictor is not bound.
+  ///
+  const std::vector<int>& cpu_affinity() const { return cpu_affinity_; }
 
   ///
   /// \brief Transform the AnalysisConfig to NativeConfig.
@@ -391,6 +512,24 @@ struct PD_INFER_DECL AnalysisConfig {
   void SetMKLDNNOp(std::unordered_set<std::string> op_list) {
     mkldnn_enabled_op_types_ = op_list;
   }
+  ///
+  /// \brief Set the cost table of the ops and the layout conversions measured
+  /// on the target hardware. A group of the connected ops placed on MKLDNN or
+  /// cuDNN is moved back to the native kernels if it is not faster than them,
+  /// including the conversions of the variables on the edges of the group.
+  /// See PlacementCostTable for the format of the table.
+  ///
+  /// \param path The path of the cost table.
+  ///
+  void SetPlacementCostTable(const std::string& path);
+  ///
+  /// \brief The path of the placement cost table.
+  ///
+  /// \return const std::string& The path, empty if not set.
+  ///
+  const std::string& placement_cost_table() const {
+    return placement_cost_table_;
+  }
 
   ///
   /// \brief Turn on MKLDNN quantization.
@@ -439,6 +578,56 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool model_from_memory() const { return model_from_memory_; }
 
+  ///
+  /// \brief Control whether to load the combined parameters file by mmap.
+  /// The CPU parameters reference the mapped file directly instead of being
+  /// read into new tensors, and the GPU parameters are uploaded from it by
+  /// several threads and streams. It is ignored if the parameters are
+  /// separate files or loaded from memory, or on Windows.
+  ///
+  /// \param x Whether to load the parameters by mmap.
+  ///
+  void SwitchParamsMmap(bool x = true) { params_mmap_ = x; }
+  ///
+  /// \brief A boolean state telling whether the combined parameters file is
+  /// loaded by mmap.
+  ///
+  /// \return bool Whether the parameters are loaded by mmap.
+  ///
+  bool params_mmap() const { return params_mmap_; }
+
+  ///
+  /// \brief Load the combined program and parameters files encrypted by the
+  /// cipher, e.g. by `paddle.fluid.core.CipherFactory`. The parameters are
+  /// decrypted chunk by chunk while being deserialized, instead of being
+  /// decrypted into memory as a whole, if the cipher is AES_CTR_NoPadding or
+  /// AES_GCM_NoPadding. It is ignored if the model is set from memory or by
+  /// the model directory, and disables the mmap of the parameters and the
+  /// cache of the optimized model.
+  ///
+  /// \param key The key of the cipher.
+  /// \param cipher_config The config file of the cipher, the default cipher
+  /// AES_CTR_NoPadding is used if it is empty.
+  ///
+  void SetModelCipher(const std::string& key,
+                      const std::string& cipher_config = "") {
+    model_cipher_key_ = key;
+    model_cipher_config_ = cipher_config;
+  }
+  ///
+  /// \brief A boolean state telling whether the model files are encrypted.
+  ///
+  /// \return bool Whether the model files are encrypted.
+  ///
+  bool model_cipher_enabled() const {
+    return !model_cipher_key_.empty() && !model_from_memory_ &&
+           model_dir_.empty() && !prog_file_.empty() && !params_file_.empty();
+  }
+  const std::string& model_cipher_key() const { return model_cipher_key_; }
+  const std::string& model_cipher_config() const {
+    return model_cipher_config_;
+  }
+
   ///
   /// \brief Turn on memory optimize
   /// NOTE still in development.
@@ -451,6 +640,69 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \return bool Whether the memory optimization is activated.
   ///
   bool enable_memory_optim() const;
+  ///
+  /// \brief Turn on the static memory plan, which implies the memory optimize.
+  /// All the temporary tensors are assigned fixed offsets in one arena
+  /// preallocated by the predictor, so no allocator is called when running
+  /// the model. A tensor larger than its planned size, e.g. because of a
+  /// larger batch, is allocated by the allocator as usual.
+  ///
+  /// \param batch_size The batch size used to estimate the tensor sizes.
+  ///
+  void EnableStaticMemoryPlan(int batch_size = 1);
+  ///
+  /// \brief Turn on the static memory plan with the shape buckets, for the
+  /// inputs of variable shapes. The offsets of the temporary tensors are
+  /// planned for each bucket, and the predictor binds the plan of the
+  /// smallest bucket not less than the unknown dimensions of the inputs of a
+  /// request. All the plans share one arena of the largest bucket. The input
+  /// tensors are allocated as usual.
+  ///
+  /// \param buckets The upper bounds of the unknown dimensions, e.g. the
+  /// batch sizes or the numbers of tokens, of the buckets.
+  ///
+  void EnableStaticMemoryPlan(const std::vector<int>& buckets);
+  ///
+  /// \brief A boolean state telling whether the static memory plan is
+  /// activated.
+  ///
+  /// \return bool Whether the static memory plan is activated.
+  ///
+  bool static_memory_plan_enabled() const {
+    return enable_static_memory_plan_;
+  }
+  ///
+  /// \brief Turn on CUDA Graph when running on GPU. The kernels launched by
+  /// the first runs are captured onto a CUDA Graph, which is replayed in the
+  /// later runs instead of running the operators, so the overhead of
+  /// launching the kernels is removed. It needs CUDA 10.1 or higher and the
+  /// zero copy tensors, i.e. SwitchUseFeedFetchOps(false). The inputs should
+  /// have fixed shapes, otherwise the graph is captured again whenever they
+  /// change. No other thread should use the device while capturing.
+  ///
+  void EnableCUDAGraph();
+  ///
+  /// \brief A boolean state telling whether CUDA Graph is activated.
+  ///
+  /// \return bool Whether CUDA Graph is activated.
+  ///
+  bool cuda_graph_enabled() const { return use_cuda_graph_; }
+  ///
+  /// \brief Record the latencies of the runs and the time of every operator,
+  /// which are got by PaddlePredictor::GetRunStats without the global
+  /// profiler. The overhead is a few clock reads per operator on CPU. On GPU
+  /// the device is synchronized after every operator to time it, and CUDA
+  /// Graph is not used.
+  ///
+  /// \param x Whether to record the statistics.
+  ///
+  void EnableRunStats(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the run statistics are recorded.
+  ///
+  /// \return bool Whether the run statistics are recorded.
+  ///
+  bool run_stats_enabled() const { return run_stats_; }
 
   ///
   /// \brief Turn on profiling report.
@@ -545,18 +797,36 @@ struct PD_INFER_DECL AnalysisConfig {
   Precision tensorrt_precision_mode_{Precision::kFloat32};
   bool trt_use_static_engine_{false};
   bool trt_use_calib_mode_{true};
+  bool trt_share_engine_{false};
+  bool trt_estimate_benefit_{false};
   std::map<std::string, std::vector<int>> min_input_shape_{};
   std::map<std::string, std::vector<int>> max_input_shape_{};
   std::map<std::string, std::vector<int>> optim_input_shape_{};
+  // the optimization profiles besides the one above
+  std::vector<std::map<std::string, std::vector<int>>>
+      extra_min_input_shapes_{};
+  std::vector<std::map<std::string, std::vector<int>>>
+      extra_max_input_shapes_{};
+  std::vector<std::map<std::string, std::vector<int>>>
+      extra_optim_input_shapes_{};
   bool disable_trt_plugin_fp16_{false};
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  bool enable_static_memory_plan_{false};
+  int static_memory_plan_batch_size_{1};
+  std::vector<int> static_memory_plan_buckets_;
+  bool use_cuda_graph_{false};
+  bool run_stats_{false};
 
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
+  std::string placement_cost_table_;
 
   bool model_from_memory_{false};
+  bool params_mmap_{false};
+  std::string model_cipher_key_;
+  std::string model_cipher_config_;
 
   bool enable_ir_optim_{true};
   bool use_feed_fetch_ops_{true};
@@ -565,6 +835,7 @@ struct PD_INFER_DECL AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  std::vector<int> cpu_affinity_;
 
   bool with_profile_{false};
 
@@ -579,6 +850,7 @@ struct PD_INFER_DECL AnalysisConfig {
   std::vector<std::string> lite_passes_filter_;
   std::vector<std::string> lite_ops_filter_;
   Precision lite_precision_mode_;
+  bool lite_zero_copy_{false};
 
   bool thread_local_stream_{false};
 
@@ -593,6 +865,8 @@ struct PD_INFER_DECL AnalysisConfig {
   // So we release the memory when the predictor is set up.
   mutable bool is_valid_{true};
   std::string opt_cache_dir_;
+  std::string optim_model_cache_dir_;
+  bool share_program_{false};
 };
 
 }  // namespace paddle
@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -206,6 +207,22 @@ class PD_INFER_DECL ZeroCopyTensor {
   template <typename T>
   void copy_to_cpu(T* data);
 
+  /// \brief Use the memory owned by the caller as the buffer of the tensor,
+  /// instead of copying from or to it.
+  /// The predictor reads the buffer of an input tensor directly. It writes
+  /// an output tensor to the buffer directly if the buffer is large enough
+  /// and on the place of the output, or copies the output to the buffer at
+  /// the end of ZeroCopyRun otherwise.
+  /// The buffer must stay valid while the predictor runs with it.
+  /// \param data The pointer of the buffer in the host or the device memory.
+  /// \param shape The shape of the data. For an output tensor, it decides
+  /// the capacity of the buffer.
+  /// \param place The place of the buffer. The device of kGPU is the device
+  /// of the predictor.
+  template <typename T>
+  void ShareExternalData(T* data, const std::vector<int>& shape,
+                         PaddlePlace place);
+
   /// \brief Return the shape of the Tensor.
   std::vector<int> shape() const;
 
@@ -244,6 +261,48 @@ class PD_INFER_DECL ZeroCopyTensor {
   PaddlePlace place_;
   PaddleDType dtype_;
   int device_;
+  // The external buffers of the outputs of the predictor, i.e.,
+  // details::ExternalOutputs, if the tensor is an output.
+  void* external_outputs_{nullptr};
+};
+
+/// \brief The latency statistics of a stage of the runs of a predictor.
+struct PD_INFER_DECL PaddleLatencyStats {
+  uint64_t count{0};    ///< The number of runs.
+  double total_ms{0.};  ///< The total time of the runs.
+  double max_ms{0.};    ///< The time of the slowest run.
+  /// The percentiles, i.e., the upper bounds of the histogram buckets they
+  /// fall in, so they are overestimated by up to 2 times.
+  double p50_ms{0.};
+  double p90_ms{0.};
+  double p99_ms{0.};
+  /// The histogram, counts[0] is the number of runs taking less than 0.01
+  /// ms, and counts[i] of [0.01 * 2^(i-1), 0.01 * 2^i) ms.
+  std::vector<uint64_t> counts;
+};
+
+/// \brief The accumulated time of an operator of a predictor.
+struct PD_INFER_DECL PaddleOpStats {
+  std::string type;    ///< The operator type.
+  std::string output;  ///< The first output, to tell the operators apart.
+  uint64_t calls{0};
+  double total_ms{0.};
+};
+
+/// \brief The statistics of the runs of a predictor since it is created or
+/// the statistics are reset, see AnalysisConfig::EnableRunStats.
+struct PD_INFER_DECL PaddleRunStats {
+  PaddleLatencyStats run;        ///< The whole Run or ZeroCopyRun.
+  PaddleLatencyStats feed;       ///< Setting the inputs in Run.
+  PaddleLatencyStats execution;  ///< Running the operators.
+  /// Getting the outputs in Run, or copying the outputs to the external
+  /// buffers in ZeroCopyRun.
+  PaddleLatencyStats fetch;
+  /// The operators taking the most time, in descending order.
+  std::vector<PaddleOpStats> top_ops;
+  /// The total time of the subgraph engine operators by the operator type,
+  /// e.g., tensorrt_engine and lite_engine.
+  std::map<std::string, double> engine_ms;
 };
 
 /// \brief A Predictor for executing inference on a model.
@@ -319,6 +378,19 @@ class PD_INFER_DECL PaddlePredictor {
   /// \return unique_ptr which contains the pointer of predictor
   virtual std::unique_ptr<PaddlePredictor> Clone() = 0;
 
+  /// \brief Get the statistics of the runs, thread safe.
+  /// Be inherited by AnalysisPredictor, only if the statistics are enabled
+  /// by AnalysisConfig::EnableRunStats.
+  /// \param[out] stats The statistics.
+  /// \param[in] top_n The number of the operators in stats->top_ops.
+  /// \return Whether the statistics are recorded.
+  virtual bool GetRunStats(PaddleRunStats* stats, int top_n = 10) {
+    return false;
+  }
+
+  /// \brief Reset the statistics of the runs, thread safe.
+  virtual void ResetRunStats() {}
+
   /// \brief Destroy the Predictor.
   virtual ~PaddlePredictor() = default;
 
@@ -427,6 +499,33 @@ PD_INFER_DECL std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<
 
 PD_INFER_DECL int PaddleDtypeSize(PaddleDType dtype);
 
+/// \brief Memory statistics of the allocator of a device.
+///
+/// It helps to decide the memory settings, e.g.,
+/// FLAGS_fraction_of_gpu_memory_to_use, of a model without trial and error.
+struct PD_INFER_DECL PaddleMemoryStats {
+  size_t allocated_bytes{0};       ///< Bytes held by the living tensors.
+  size_t peak_allocated_bytes{0};  ///< The peak of allocated_bytes.
+  size_t reserved_bytes{0};  ///< Bytes held by the allocator, incl. cached.
+  size_t largest_free_chunk_bytes{0};  ///< The largest cached chunk.
+  double fragmentation_ratio{0.};  ///< 1 - largest_free_chunk / cached bytes.
+  /// alloc_counts[i] is the number of allocations of [2^i, 2^(i+1)) bytes.
+  std::vector<uint64_t> alloc_counts;
+};
+
+/// \brief Get the memory statistics of a device.
+/// \param[in] device_id The GPU id, or -1 for CPU.
+/// \param[out] stats The memory statistics.
+/// \return Whether the allocator of the device records statistics.
+PD_INFER_DECL bool GetMemoryStats(int device_id, PaddleMemoryStats* stats);
+
+/// \brief Release the cached memory of a device back to the system, e.g.,
+/// to reclaim the memory lost to fragmentation in a long running service.
+/// It synchronizes the device, so it should not be called frequently.
+/// \param[in] device_id The GPU id, or -1 for CPU.
+/// \return The released bytes.
+PD_INFER_DECL size_t ReleaseMemory(int device_id);
+
 PD_INFER_DECL std::string get_version();
 
 #if defined(_WIN32) && defined(PADDLE_ON_INFERENCE)
@@ -0,0 +1,109 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle_api.h"  // NOLINT
+
+namespace paddle {
+
+///
+/// \brief The config of DynamicBatcher.
+///
+struct PD_INFER_DECL DynamicBatcherConfig {
+  /// The max number of instances of a batch. A request larger than it is run
+  /// as a batch alone.
+  size_t max_batch_size{32};
+  /// How long a batch waits for more requests after its first request
+  /// arrives, in microseconds.
+  int64_t max_delay_us{2000};
+};
+
+///
+/// \brief DynamicBatcher coalesces the requests submitted concurrently into
+/// batches, runs a batch by one PaddlePredictor::Run, and scatters the
+/// outputs back to the requests.
+///
+/// A request is the inputs of one Run. The number of instances of a request
+/// is the number of sequences of its first input if the input has LoD, or
+/// its first dimension otherwise. The inputs of the requests in a batch are
+/// concatenated along the first dimension, and their LoDs are merged. Only
+/// the requests with the same input names, data types, LoD levels and the
+/// same dimensions except the first one are batched together.
+///
+/// Every output of the model must have one sequence per instance if it has
+/// LoD, or one row per instance otherwise, so that it can be split back.
+///
+/// Each predictor is run by its own worker thread, e.g., the predictors of
+/// a PredictorPool.
+///
+class PD_INFER_DECL DynamicBatcher {
+ public:
+  DynamicBatcher(const std::vector<PaddlePredictor*>& predictors,
+                 const DynamicBatcherConfig& config);
+
+  DynamicBatcher(const DynamicBatcher&) = delete;
+  DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+  /// \brief Run the pending requests and stop the worker threads.
+  ~DynamicBatcher();
+
+  ///
+  /// \brief Submit a request, thread safe.
+  ///
+  /// \param[in] inputs The inputs of the request.
+  /// \return The future of the outputs of the request. It holds an exception
+  /// if the request is invalid or the batch fails to run.
+  ///
+  std::future<std::vector<PaddleTensor>> Submit(
+      std::vector<PaddleTensor> inputs);
+
+ private:
+  struct Request {
+    std::vector<PaddleTensor> inputs;
+    size_t batch_size;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<std::vector<PaddleTensor>> outputs;
+  };
+
+  void WorkerLoop(PaddlePredictor* predictor);
+
+  // Pop the requests of the next batch from queue_, mtx_ must be held.
+  void PopBatch(std::vector<std::unique_ptr<Request>>* batch);
+
+  void RunBatch(PaddlePredictor* predictor,
+                std::vector<std::unique_ptr<Request>>* batch);
+
+  DynamicBatcherConfig config_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<Request>> queue_;
+  // instances of the requests in queue_
+  size_t queued_instances_{0};
+  bool stop_{false};
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace paddle
@@ -28,3 +28,50 @@ limitations under the License. */
 
 #include "paddle_analysis_config.h"  // NOLINT
 #include "paddle_api.h"              // NOLINT
+
+namespace paddle {
+
+///
+/// \brief A pool of predictors of one model, which share the weights.
+///
+/// The first predictor is created by the config, and the others are cloned
+/// from it, so that every predictor has its own intermediate scope. For a
+/// GPU config, the pool turns on AnalysisConfig::EnableGpuMultiStream(),
+/// i.e., a predictor runs on the CUDA stream, the cuDNN workspace and the
+/// allocator of the thread running it. Therefore, the predictors run in
+/// different threads overlap on one GPU.
+///
+/// A predictor should be used by one thread at a time.
+///
+class PD_INFER_DECL PredictorPool {
+ public:
+  PredictorPool() = delete;
+  PredictorPool(const PredictorPool&) = delete;
+  PredictorPool& operator=(const PredictorPool&) = delete;
+
+  ///
+  /// \brief Construct a new predictor pool.
+  ///
+  /// \param[in] config The config of the model.
+  /// \param[in] size The number of predictors.
+  ///
+  explicit PredictorPool(const AnalysisConfig& config, size_t size = 1);
+
+  ///
+  /// \brief Get the idx-th predictor, which is owned by the pool.
+  ///
+  /// \param[in] idx The index of the predictor.
+  /// \return The predictor.
+  ///
+  PaddlePredictor* Retrieve(size_t idx);
+
+  ///
+  /// \return The number of predictors.
+  ///
+  size_t size() const { return preds_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<PaddlePredictor>> preds_;
+};
+
+}  // namespace paddle
@@ -187,6 +187,24 @@ struct PD_INFER_DECL MkldnnQuantizerConfig {
   ///
   ScaleAlgo default_scale_algo() const { return default_scale_algo_; }
 
+  ///
+  /// \brief Set the calibration scales file
+  ///
+  /// If the file exists and holds the scales of all the variables to be
+  /// quantized, the scales are loaded from it and the warm-up iteration is
+  /// skipped. Otherwise the scales are calculated and saved to it.
+  ///
+  /// \param[in] path the path of the scales file.
+  ///
+  void SetScalesFile(const std::string& path) { scales_file_ = path; }
+
+  ///
+  /// \brief Get the calibration scales file
+  ///
+  /// \return the path of the scales file, empty if not set
+  ///
+  const std::string& scales_file() const { return scales_file_; }
+
  protected:
   std::map<std::string, std::map<std::string, ScaleAlgo>> rules_;
   std::unordered_set<std::string> enabled_op_types_;
@@ -194,6 +212,7 @@ struct PD_INFER_DECL MkldnnQuantizerConfig {
   std::shared_ptr<std::vector<PaddleTensor>> warmup_data_;
   int warmup_bs_{1};
   ScaleAlgo default_scale_algo_{ScaleAlgo::MAX};
+  std::string scales_file_;
 };
 
 }  // namespace paddle
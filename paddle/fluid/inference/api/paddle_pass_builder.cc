@@ -78,6 +78,9 @@ const std::vector<std::string> kTRTSubgraphPasses({
       "delete_quant_dequant_op_pass",              //
       // "fc_fuse_pass",                                 //
       "simplify_with_basic_ops_pass",           //
+      "constant_folding_pass",                  //
+      "common_subexpression_elimination_pass",  //
+      "dead_code_elimination_pass",             //
       "embedding_eltwise_layernorm_fuse_pass",  //
       "multihead_matmul_fuse_pass_v2",          //
       "skip_layernorm_fuse_pass",               //
@@ -105,6 +108,9 @@ GpuPassStrategy::GpuPassStrategy() : PassStrategy({}) {
     //   "identity_scale_op_clean_pass",             //
     "is_test_pass",                                  //
         "simplify_with_basic_ops_pass",              //
+        "constant_folding_pass",                     //
+        "common_subexpression_elimination_pass",     //
+        "dead_code_elimination_pass",                //
         "conv_affine_channel_fuse_pass",             //
         "conv_eltwiseadd_affine_channel_fuse_pass",  //
         "conv_bn_fuse_pass",                         //
@@ -146,9 +152,12 @@ void GpuPassStrategy::EnableMkldnnQuantizer() {
 CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // NOTE the large fusions should be located in the front, so that they will
   // not be damaged by smaller ones.
-  passes_.assign({"simplify_with_basic_ops_pass",   //
-                  "attention_lstm_fuse_pass",       //
-                  "seqconv_eltadd_relu_fuse_pass",  //
+  passes_.assign({"simplify_with_basic_ops_pass",           //
+                  "constant_folding_pass",                  //
+                  "common_subexpression_elimination_pass",  //
+                  "dead_code_elimination_pass",             //
+                  "attention_lstm_fuse_pass",               //
+                  "seqconv_eltadd_relu_fuse_pass",          //
                   // "seqpool_concat_fuse_pass",    //
                   "seqpool_cvm_concat_fuse_pass",  //
                   // "embedding_fc_lstm_fuse_pass", //
@@ -157,6 +166,9 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
                   "fc_gru_fuse_pass",                        //
                   "mul_gru_fuse_pass",                       //
                   "seq_concat_fc_fuse_pass",                 //
+                  "multihead_matmul_fuse_pass_v2",           //
+                  "skip_layernorm_fuse_pass",                //
+                  "softmax_mask_fuse_pass",                  //
                   "fc_fuse_pass",                            //
                   "repeated_fc_relu_fuse_pass",              //
                   "squared_mat_sub_fuse_pass",               //
@@ -283,7 +283,60 @@ PADDLE_CAPI_EXPORT extern void PD_SetZeroCopyInput(
 PADDLE_CAPI_EXPORT extern void PD_GetZeroCopyOutput(PD_Predictor* predictor,
                                                     PD_ZeroCopyTensor* tensor);
 
-PADDLE_CAPI_EXPORT extern void PD_ZeroCopyRun(PD_Predictor* predictor);
+PADDLE_CAPI_EXPORT extern bool PD_ZeroCopyRun(PD_Predictor* predictor);
+
+// The handles of the input and output tensors of a predictor, which are got
+// once and then read or write the memory of the predictor directly, without
+// the copies of PD_SetZeroCopyInput and PD_GetZeroCopyOutput. The inputs are
+// written through the handles before PD_ZeroCopyRun, and the outputs are
+// read after it.
+typedef struct PD_TensorHandle PD_TensorHandle;
+
+enum PD_Place { PD_PLACE_CPU, PD_PLACE_GPU };
+
+typedef enum PD_Place PD_Place;
+
+PADDLE_CAPI_EXPORT extern PD_TensorHandle* PD_GetInputHandle(
+    PD_Predictor* predictor, const char* name);
+
+PADDLE_CAPI_EXPORT extern PD_TensorHandle* PD_GetOutputHandle(
+    PD_Predictor* predictor, const char* name);
+
+PADDLE_CAPI_EXPORT extern void PD_DeleteTensorHandle(PD_TensorHandle* handle);
+
+PADDLE_CAPI_EXPORT extern void PD_TensorHandleReshape(PD_TensorHandle* handle,
+                                                      const int* shape,
+                                                      int shape_size);
+
+// The shape of the tensor, valid until the next call on the handle.
+PADDLE_CAPI_EXPORT extern const int* PD_TensorHandleShape(
+    PD_TensorHandle* handle, int* shape_size);
+
+// Set the offsets of the one level LoD of an input.
+PADDLE_CAPI_EXPORT extern void PD_TensorHandleSetLoD(PD_TensorHandle* handle,
+                                                     const size_t* offsets,
+                                                     int offsets_size);
+
+PADDLE_CAPI_EXPORT extern PD_DataType PD_TensorHandleDType(
+    PD_TensorHandle* handle);
+
+// The buffer of an input in the memory of the predictor, to be written with
+// the data of the shape set by PD_TensorHandleReshape.
+PADDLE_CAPI_EXPORT extern void* PD_TensorHandleMutableData(
+    PD_TensorHandle* handle, PD_DataType dtype, PD_Place place);
+
+// The data of an output in the memory of the predictor, valid until the next
+// run. The place and the number of the elements are returned if not null.
+PADDLE_CAPI_EXPORT extern const void* PD_TensorHandleData(
+    PD_TensorHandle* handle, PD_Place* place, int* numel);
+
+// Use the buffer of the caller as the tensor, so that an input is read from
+// it and an output is written to it directly, see
+// ZeroCopyTensor::ShareExternalData. The buffer must stay valid while the
+// predictor runs with it.
+PADDLE_CAPI_EXPORT extern void PD_TensorHandleShareExternalData(
+    PD_TensorHandle* handle, void* data, PD_DataType dtype, const int* shape,
+    int shape_size, PD_Place place);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -75,6 +75,11 @@ struct PD_ZeroCopyFunctor {
   }
 };
 
+paddle::PaddlePlace ConvertToPaddlePlace(PD_Place place) {
+  return place == PD_PLACE_GPU ? paddle::PaddlePlace::kGPU
+                               : paddle::PaddlePlace::kCPU;
+}
+
 }  // namespace
 
 extern "C" {
@@ -299,7 +304,122 @@ void PD_GetZeroCopyOutput(PD_Predictor* predictor, PD_ZeroCopyTensor* tensor) {
   }
 }
 
-void PD_ZeroCopyRun(PD_Predictor* predictor) {
-  predictor->predictor->ZeroCopyRun();
+bool PD_ZeroCopyRun(PD_Predictor* predictor) {
+  return predictor->predictor->ZeroCopyRun();
+}
+
+PD_TensorHandle* PD_GetInputHandle(PD_Predictor* predictor, const char* name) {
+  PADDLE_ENFORCE_NOT_NULL(predictor, paddle::platform::errors::InvalidArgument(
+                                         "The predictor is nullptr."));
+  PD_TensorHandle* handle = new PD_TensorHandle;
+  handle->tensor = predictor->predictor->GetInputTensor(name);
+  return handle;
+}
+
+PD_TensorHandle* PD_GetOutputHandle(PD_Predictor* predictor, const char* name) {
+  PADDLE_ENFORCE_NOT_NULL(predictor, paddle::platform::errors::InvalidArgument(
+                                         "The predictor is nullptr."));
+  PD_TensorHandle* handle = new PD_TensorHandle;
+  handle->tensor = predictor->predictor->GetOutputTensor(name);
+  return handle;
+}
+
+void PD_DeleteTensorHandle(PD_TensorHandle* handle) { delete handle; }
+
+void PD_TensorHandleReshape(PD_TensorHandle* handle, const int* shape,
+                            int shape_size) {
+  handle->tensor->Reshape(std::vector<int>(shape, shape + shape_size));
+}
+
+const int* PD_TensorHandleShape(PD_TensorHandle* handle, int* shape_size) {
+  handle->shape = handle->tensor->shape();
+  *shape_size = static_cast<int>(handle->shape.size());
+  return handle->shape.data();
+}
+
+void PD_TensorHandleSetLoD(PD_TensorHandle* handle, const size_t* offsets,
+                           int offsets_size) {
+  handle->tensor->SetLoD(
+      {std::vector<size_t>(offsets, offsets + offsets_size)});
+}
+
+PD_DataType PD_TensorHandleDType(PD_TensorHandle* handle) {
+  return ConvertToPDDataType(handle->tensor->type());
+}
+
+void* PD_TensorHandleMutableData(PD_TensorHandle* handle, PD_DataType dtype,
+                                 PD_Place place) {
+  auto paddle_place = ConvertToPaddlePlace(place);
+  switch (dtype) {
+    case PD_FLOAT32:
+      return handle->tensor->mutable_data<float>(paddle_place);
+    case PD_INT32:
+      return handle->tensor->mutable_data<int32_t>(paddle_place);
+    case PD_INT64:
+      return handle->tensor->mutable_data<int64_t>(paddle_place);
+    case PD_UINT8:
+      return handle->tensor->mutable_data<uint8_t>(paddle_place);
+    default:
+      PADDLE_THROW(
+          paddle::platform::errors::InvalidArgument("Unsupported data type."));
+  }
+}
+
+const void* PD_TensorHandleData(PD_TensorHandle* handle, PD_Place* place,
+                                int* numel) {
+  paddle::PaddlePlace paddle_place;
+  int size = 0;
+  const void* data = nullptr;
+  switch (handle->tensor->type()) {
+    case paddle::PaddleDType::FLOAT32:
+      data = handle->tensor->data<float>(&paddle_place, &size);
+      break;
+    case paddle::PaddleDType::INT32:
+      data = handle->tensor->data<int32_t>(&paddle_place, &size);
+      break;
+    case paddle::PaddleDType::INT64:
+      data = handle->tensor->data<int64_t>(&paddle_place, &size);
+      break;
+    case paddle::PaddleDType::UINT8:
+      data = handle->tensor->data<uint8_t>(&paddle_place, &size);
+      break;
+    default:
+      PADDLE_THROW(
+          paddle::platform::errors::InvalidArgument("Unsupported data type."));
+  }
+  if (place) {
+    *place =
+        paddle_place == paddle::PaddlePlace::kGPU ? PD_PLACE_GPU : PD_PLACE_CPU;
+  }
+  if (numel) *numel = size;
+  return data;
+}
+
+void PD_TensorHandleShareExternalData(PD_TensorHandle* handle, void* data,
+                                      PD_DataType dtype, const int* shape,
+                                      int shape_size, PD_Place place) {
+  std::vector<int> dims(shape, shape + shape_size);
+  auto paddle_place = ConvertToPaddlePlace(place);
+  switch (dtype) {
+    case PD_FLOAT32:
+      handle->tensor->ShareExternalData(static_cast<float*>(data), dims,
+                                        paddle_place);
+      break;
+    case PD_INT32:
+      handle->tensor->ShareExternalData(static_cast<int32_t*>(data), dims,
+                                        paddle_place);
+      break;
+    case PD_INT64:
+      handle->tensor->ShareExternalData(static_cast<int64_t*>(data), dims,
+                                        paddle_place);
+      break;
+    case PD_UINT8:
+      handle->tensor->ShareExternalData(static_cast<uint8_t*>(data), dims,
+                                        paddle_place);
+      break;
+    default:
+      PADDLE_THROW(
+          paddle::platform::errors::InvalidArgument("Unsupported data type."));
+  }
 }
 }  // extern "C"
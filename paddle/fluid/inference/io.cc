@@ -15,14 +15,27 @@ limitations under the License. */
 #include "paddle/fluid/inference/io.h"
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
+#include <iterator>
+#include <thread>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/mapped_tensor_file.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_container.h"
 #include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/pybind/pybind.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#endif
+#ifdef PADDLE_WITH_CRYPTO
+#include "paddle/fluid/framework/io/crypto/cipher.h"
+#endif
 
 DEFINE_string(devices, "", "The devices to be used which is joined by comma.");
 DEFINE_bool(init_p2p, false, "Whether to init p2p.");
@@ -70,7 +83,7 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
-                      bool model_from_memory = false) {
+                      bool model_from_memory, bool params_by_mmap) {
   const framework::BlockDesc& global_block = main_program.Block(0);
 
   framework::ProgramDesc* load_program = new framework::ProgramDesc();
@@ -116,6 +129,12 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
     op->SetAttr("file_path", {param_filename});
     op->SetAttr("model_from_memory", {model_from_memory});
     op->CheckAttrs();
+    if (params_by_mmap && !model_from_memory) {
+      LoadCombinedParamsByMmap(param_filename, paramlist, scope,
+                               executor->GetPlace());
+      delete load_program;
+      return;
+    }
   }
 
   executor->Run(*load_program, scope, 0, true, true);
@@ -145,7 +164,8 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
 
 std::unique_ptr<framework::ProgramDesc> Load(
     framework::Executor* executor, framework::Scope* scope,
-    const std::string& prog_filename, const std::string& param_filename) {
+    const std::string& prog_filename, const std::string& param_filename,
+    bool params_by_mmap) {
   std::string program_desc_str;
   ReadBinaryFile(prog_filename, &program_desc_str);
 
@@ -156,7 +176,35 @@ std::unique_ptr<framework::ProgramDesc> Load(
                  main_program->Version());
 
   LoadPersistables(executor, scope, *main_program, "", param_filename,
-                   false /* model_from_memory */);
+                   false /* model_from_memory */, params_by_mmap);
+  return main_program;
+}
+
+std::unique_ptr<framework::ProgramDesc> LoadEncrypted(
+    framework::Executor* executor, framework::Scope* scope,
+    const std::string& prog_filename, const std::string& param_filename,
+    const std::string& cipher_config, const std::string& key) {
+  auto prog_stream = OpenEncryptedFile(prog_filename, cipher_config, key);
+  std::string program_desc_str{std::istreambuf_iterator<char>(*prog_stream),
+                               std::istreambuf_iterator<char>()};
+
+  std::unique_ptr<framework::ProgramDesc> main_program(
+      new framework::ProgramDesc(program_desc_str));
+  PADDLE_ENFORCE(framework::IsProgramVersionSupported(main_program->Version()),
+                 "model version %ld is not supported.",
+                 main_program->Version());
+
+  std::vector<std::string> params;
+  for (auto* var : main_program->Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      params.push_back(var->Name());
+    }
+  }
+  // sort params to have the ordering of the combined file
+  std::sort(params.begin(), params.end());
+  auto params_stream = OpenEncryptedFile(param_filename, cipher_config, key);
+  LoadCombinedParamsFromStream(params_stream.get(), params, scope,
+                               executor->GetPlace());
   return main_program;
 }
 
@@ -174,6 +222,153 @@ std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
   return main_program;
 }
 
+void LoadCombinedParamsByMmap(const std::string& param_filename,
+                              const std::vector<std::string>& params,
+                              framework::Scope* scope,
+                              const platform::Place& place) {
+#ifdef _WIN32
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Loading the parameters by mmap is not supported on Windows."));
+#else
+  VLOG(3) << "loading parameters from " << param_filename << " by mmap";
+  auto file = std::make_shared<framework::MappedTensorFile>(param_filename);
+  bool on_cpu = platform::is_cpu_place(place);
+  std::vector<framework::LoDTensor> cpu_tensors(on_cpu ? 0 : params.size());
+  std::vector<framework::LoDTensor*> tensors;
+  tensors.reserve(params.size());
+  bool is_container = framework::IsTensorContainer(file->data(), file->size());
+  framework::TensorContainerIndex index;
+  if (is_container) {
+    index = framework::TensorContainerIndex::FromMemory(file->data(),
+                                                        file->size());
+  }
+  for (size_t i = 0; i < params.size(); ++i) {
+    auto* tensor = scope->Var(params[i])->GetMutable<framework::LoDTensor>();
+    tensors.push_back(tensor);
+    auto* dst = on_cpu ? tensor : &cpu_tensors[i];
+    if (is_container) {
+      auto* entry = index.Find(params[i]);
+      PADDLE_ENFORCE_NOT_NULL(
+          entry, platform::errors::NotFound(
+                     "The parameter %s is not found in the file %s.",
+                     params[i], param_filename));
+      framework::ReadMappedLoDTensor(file, *entry, dst);
+    } else {
+      framework::ReadMappedLoDTensor(file, dst);
+    }
+  }
+  PADDLE_ENFORCE_EQ(is_container || file->eof(), true,
+                    platform::errors::Unavailable(
+                        "Not allowed to load partial data of the parameters "
+                        "file %s.",
+                        param_filename));
+  if (on_cpu) return;
+
+#ifdef PADDLE_WITH_CUDA
+  std::vector<const framework::LoDTensor*> src;
+  src.reserve(cpu_tensors.size());
+  for (auto& tensor : cpu_tensors) {
+    src.push_back(&tensor);
+  }
+  ParallelCopyToGPU(src, BOOST_GET_CONST(platform::CUDAPlace, place), tensors);
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "CUDAPlace is not supported when not compiled with CUDA"));
+#endif
+#endif
+}
+
+std::unique_ptr<std::istream> OpenEncryptedFile(
+    const std::string& filename, const std::string& cipher_config,
+    const std::string& key) {
+#ifdef PADDLE_WITH_CRYPTO
+  auto cipher = framework::CipherFactory::CreateCipher(cipher_config);
+  return cipher->DecryptStreamFromFile(key, filename);
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Loading the encrypted file %s is not supported when not compiled with "
+      "crypto.",
+      filename));
+#endif
+}
+
+void LoadCombinedParamsFromStream(std::istream* is,
+                                  const std::vector<std::string>& params,
+                                  framework::Scope* scope,
+                                  const platform::Place& place) {
+  auto& dev_ctx = *platform::DeviceContextPool::Instance().Get(place);
+  std::unique_ptr<framework::TensorContainerReader> container;
+  if (framework::IsTensorContainer(is)) {
+    container.reset(new framework::TensorContainerReader(is));
+  }
+  for (auto& param : params) {
+    auto* tensor = scope->Var(param)->GetMutable<framework::LoDTensor>();
+    if (container) {
+      container->Read(param, tensor, dev_ctx);
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(static_cast<bool>(*is), true,
+                      platform::errors::Unavailable(
+                          "An error occurred while loading the parameter %s. "
+                          "Please check whether the parameters file is "
+                          "complete or damaged.",
+                          param));
+    framework::DeserializeFromStream(*is, tensor, dev_ctx);
+  }
+  if (container) return;
+  is->peek();
+  PADDLE_ENFORCE_EQ(is->eof(), true,
+                    platform::errors::Unavailable(
+                        "Not allowed to load partial data of the parameters "
+                        "file."));
+}
+
+#ifdef PADDLE_WITH_CUDA
+void ParallelCopyToGPU(const std::vector<const framework::LoDTensor*>& src,
+                       const platform::CUDAPlace& place,
+                       const std::vector<framework::LoDTensor*>& dst) {
+  PADDLE_ENFORCE_EQ(src.size(), dst.size(),
+                    platform::errors::InvalidArgument(
+                        "The number of the source tensors %d should be equal "
+                        "to the number of the destinations %d.",
+                        src.size(), dst.size()));
+  constexpr size_t kMaxThreadNum = 4;
+  size_t thread_num = std::min(kMaxThreadNum, src.size());
+  // the tensors are taken one by one, so that the large ones are balanced
+  std::atomic<size_t> next{0};
+  std::vector<std::exception_ptr> errors(thread_num);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t] {
+      try {
+        platform::CUDADeviceGuard guard(place.device);
+        cudaStream_t stream;
+        PADDLE_ENFORCE_CUDA_SUCCESS(
+            cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+        for (size_t i = next++; i < src.size(); i = next++) {
+          dst[i]->Resize(src[i]->dims());
+          dst[i]->set_lod(src[i]->lod());
+          auto type = src[i]->type();
+          void* out = dst[i]->mutable_data(place, type);
+          memory::Copy(place, out, platform::CPUPlace(), src[i]->data<void>(),
+                       src[i]->numel() * framework::SizeOfType(type), stream);
+        }
+        PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+        PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamDestroy(stream));
+      } catch (...) {
+        errors[t] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+#endif
+
 void SaveVars(const framework::Scope& scope,
               const std::vector<std::string>& vars, const std::string& dirname,
               bool predicate) {
@@ -14,10 +14,12 @@ limitations under the License. */
 
 #pragma once
 
+#include <istream>
 #include <memory>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/init.h"
@@ -31,7 +33,38 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
-                      bool model_from_memory);
+                      bool model_from_memory, bool params_by_mmap = false);
+
+// Load the parameters, sorted by names, from the combined parameters file by
+// mmap instead of the load_combine op. The CPU tensors reference the mapped
+// file directly, which is unmapped after all of them are released. The GPU
+// tensors are uploaded from the mapped file in parallel.
+void LoadCombinedParamsByMmap(const std::string& param_filename,
+                              const std::vector<std::string>& params,
+                              framework::Scope* scope,
+                              const platform::Place& place);
+
+// Open a file encrypted by the cipher of the config file, which is decrypted
+// while being read. It is not supported if Paddle is compiled without crypto.
+std::unique_ptr<std::istream> OpenEncryptedFile(
+    const std::string& filename, const std::string& cipher_config,
+    const std::string& key);
+
+// Load the parameters, sorted by names, from the stream of a combined
+// parameters file, e.g. the decrypting stream of an encrypted file.
+void LoadCombinedParamsFromStream(std::istream* is,
+                                  const std::vector<std::string>& params,
+                                  framework::Scope* scope,
+                                  const platform::Place& place);
+
+#ifdef PADDLE_WITH_CUDA
+// Copy the CPU tensors to the GPU by several threads, each with its own
+// CUDA stream, so that the copies overlap with each other and with reading
+// the pages of the sources.
+void ParallelCopyToGPU(const std::vector<const framework::LoDTensor*>& src,
+                       const platform::CUDAPlace& place,
+                       const std::vector<framework::LoDTensor*>& dst);
+#endif
 
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
@@ -40,7 +73,16 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& prog_filename,
-                                             const std::string& param_filename);
+                                             const std::string& param_filename,
+                                             bool params_by_mmap = false);
+
+// Load the program and the combined parameters files encrypted by the cipher
+// of the config file. The parameters are decrypted chunk by chunk into the
+// tensors instead of being decrypted into memory as a whole.
+std::unique_ptr<framework::ProgramDesc> LoadEncrypted(
+    framework::Executor* executor, framework::Scope* scope,
+    const std::string& prog_filename, const std::string& param_filename,
+    const std::string& cipher_config, const std::string& key);
 
 std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
     framework::Executor* executor, framework::Scope* scope,
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/inference/lite/tensor_utils.h"
 #include <map>
+#include <memory>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/inference/lite/engine.h"
 
@@ -191,6 +192,36 @@ void TensorCopyAsync(framework::LoDTensor* dst, const paddle::lite::Tensor& src,
   VLOG(3) << "[Lite memory size] Bytes = " << src.memory_size();
 }
 
+template <>
+void TensorDataShare(paddle::lite::Tensor* dst, framework::LoDTensor* src) {
+  const size_t bytes =
+      static_cast<size_t>(src->numel()) * framework::SizeOfType(src->type());
+  auto buf = std::make_shared<paddle::lite::Buffer>(
+      src->data<void>(), GetLiteTargetType(src->place()), src->memory_size());
+  dst->Resize(framework::vectorize(src->dims()));
+  dst->set_precision(GetLitePrecisionType(src->type()));
+  SetLoD(dst->mutable_lod(), src->lod());
+  dst->ResetBuffer(buf, bytes);
+  VLOG(3) << "[Share fluid -> lite] Bytes = " << bytes << ", src = " << src
+          << ", dst = " << dst << ", src_type = " << src->type();
+}
+
+template <>
+void TensorDataShare(framework::LoDTensor* dst, paddle::lite::Tensor* src) {
+  // When Lite is ready, the source type needs to be modified here.
+  constexpr framework::proto::VarType::Type dtype =
+      framework::proto::VarType_Type_FP32;
+  // the holder does not free the memory of the Lite tensor
+  std::shared_ptr<memory::allocation::Allocation> holder(
+      new memory::allocation::Allocation(src->raw_data(), src->memory_size(),
+                                         GetNativePlace(src->target())));
+  dst->Resize(paddle::framework::make_ddim(src->dims().Vectorize()));
+  SetLoD(dst->mutable_lod(), src->lod());
+  dst->ResetHolderWithType(holder, dtype);
+  VLOG(3) << "[Share lite -> fluid] Bytes = " << src->memory_size()
+          << ", src = " << src << ", dst = " << dst;
+}
+
 }  // namespace utils
 }  // namespace lite
 }  // namespace inference
@@ -26,6 +26,12 @@ template <typename DstTensor, typename SrcTensor>
 void TensorCopyAsync(DstTensor* dst, const SrcTensor& src,
                      const platform::DeviceContext& ctx);
 
+// Make dst share the memory of src without copying, the memory is still
+// owned by src. The Lite target must agree with the place of the Paddle
+// tensor.
+template <typename DstTensor, typename SrcTensor>
+void TensorDataShare(DstTensor* dst, SrcTensor* src);
+
 }  // namespace utils
 }  // namespace lite
 }  // namespace inference
@@ -161,6 +161,24 @@ void TensorRTEngine::FreezeNetwork() {
           Vec2TRT_Dims(optim_input_shape_[input.first], input.first, true));
     }
     infer_builder_config_->addOptimizationProfile(optim_profile_.get());
+    for (auto &profile : extra_profiles_) {
+      // the profiles are owned by the builder
+      auto *optim_profile = infer_builder_->createOptimizationProfile();
+      for (auto &input : profile.min_input_shape) {
+        optim_profile->setDimensions(
+            input.first.c_str(), nvinfer1::OptProfileSelector::kMIN,
+            Vec2TRT_Dims(input.second, input.first, true));
+        optim_profile->setDimensions(
+            input.first.c_str(), nvinfer1::OptProfileSelector::kMAX,
+            Vec2TRT_Dims(profile.max_input_shape[input.first], input.first,
+                         true));
+        optim_profile->setDimensions(
+            input.first.c_str(), nvinfer1::OptProfileSelector::kOPT,
+            Vec2TRT_Dims(profile.optim_input_shape[input.first], input.first,
+                         true));
+      }
+      infer_builder_config_->addOptimizationProfile(optim_profile);
+    }
     if (WithFp16()) {
       infer_builder_config_->setFlag(nvinfer1::BuilderFlag::kFP16);
       if (disable_trt_plugin_fp16()) {
@@ -225,6 +243,88 @@ nvinfer1::ITensor *TensorRTEngine::GetITensor(const std::string &name) {
   return itensor_map_[name];
 }
 
+void TensorRTEngine::AddOptimizationProfile(
+    const ShapeMapType &min_input_shape, const ShapeMapType &max_input_shape,
+    const ShapeMapType &optim_input_shape) {
+  if (!with_dynamic_shape_) {
+    LOG(WARNING) << "The optimization profile is ignored, since the TensorRT "
+                    "engine does not run in the dynamic shape mode.";
+    return;
+  }
+  for (auto &input : min_input_shape_) {
+    PADDLE_ENFORCE_EQ(
+        min_input_shape.count(input.first) &&
+            max_input_shape.count(input.first) &&
+            optim_input_shape.count(input.first),
+        true, platform::errors::InvalidArgument(
+                  "The optimization profile %d misses the shapes of the "
+                  "input %s.",
+                  optimization_profile_num(), input.first));
+  }
+  extra_profiles_.push_back({min_input_shape, max_input_shape,
+                             optim_input_shape});
+}
+
+int TensorRTEngine::SelectOptimizationProfile(
+    const std::map<std::string, std::vector<int64_t>> &input_shapes) const {
+  auto covers = [&input_shapes](const ShapeMapType &min_shapes,
+                                const ShapeMapType &max_shapes) {
+    for (auto &input : input_shapes) {
+      auto min_it = min_shapes.find(input.first);
+      auto max_it = max_shapes.find(input.first);
+      if (min_it == min_shapes.end() || max_it == max_shapes.end()) continue;
+      auto &shape = input.second;
+      if (shape.size() != min_it->second.size() ||
+          shape.size() != max_it->second.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] < min_it->second[i] || shape[i] > max_it->second[i]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  if (covers(min_input_shape_, max_input_shape_)) return 0;
+  for (size_t i = 0; i < extra_profiles_.size(); ++i) {
+    if (covers(extra_profiles_[i].min_input_shape,
+               extra_profiles_[i].max_input_shape)) {
+      return static_cast<int>(i) + 1;
+    }
+  }
+  // no profile fits, let TensorRT report the invalid shapes with profile 0
+  return 0;
+}
+
+int TensorRTEngine::SetOptimizationProfile(int profile) {
+#if IS_TRT_VERSION_GE(6000)
+  int profile_num = infer_engine_->getNbOptimizationProfiles();
+  PADDLE_ENFORCE_LT(profile, profile_num,
+                    platform::errors::InvalidArgument(
+                        "The optimization profile %d is out of the %d "
+                        "profiles of the TensorRT engine.",
+                        profile, profile_num));
+  auto *infer_context = context();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto &current = infer_context_profile_[std::this_thread::get_id()];
+    if (current != profile) {
+      PADDLE_ENFORCE_EQ(infer_context->setOptimizationProfile(profile), true,
+                        platform::errors::Fatal(
+                            "Failed to set the optimization profile %d of "
+                            "the TensorRT engine.",
+                            profile));
+      current = profile;
+    }
+  }
+  return profile * (infer_engine_->getNbBindings() / profile_num);
+#else
+  return 0;
+#endif
+}
+
 void TensorRTEngine::SetRuntimeBatch(size_t batch_size) {
   runtime_batch_ = batch_size;
 }
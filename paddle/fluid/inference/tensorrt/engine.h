@@ -32,6 +32,7 @@ limitations under the License. */
 #include "paddle/fluid/inference/tensorrt/plugin/trt_plugin_factory.h"
 #include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
 #include "paddle/fluid/inference/utils/singleton.h"
+#include "paddle/fluid/memory/malloc.h"
 
 namespace paddle {
 namespace inference {
@@ -185,7 +186,19 @@ class TensorRTEngine {
           infer_engine_,
           platform::errors::InvalidArgument(
               "You should build engine first and then set the context."));
+#if IS_TRT_VERSION_GE(6000)
+      // allocate the device memory of the context from the allocator of
+      // paddle, so that it is not held by every context of a shared engine
+      // beside the memory pool
+      infer_context_[tid].reset(
+          infer_engine_->createExecutionContextWithoutDeviceMemory());
+      auto& context_memory = infer_context_memory_[tid];
+      context_memory = memory::Alloc(platform::CUDAPlace(device_id_),
+                                     infer_engine_->getDeviceMemorySize());
+      infer_context_[tid]->setDeviceMemory(context_memory->ptr());
+#else
       infer_context_[tid].reset(infer_engine_->createExecutionContext());
+#endif
     }
     return infer_context_[tid].get();
   }
@@ -199,6 +212,11 @@ class TensorRTEngine {
 
   void Deserialize(const std::string& engine_serialized_data) {
     freshDeviceId();
+#if IS_TRT_VERSION_GE(6000)
+    // the dynamic shape plugins are created by the plugin registry
+    inference::Singleton<plugin::DynamicPluginFactoryTensorRT>::Global()
+        .RegisterCreators();
+#endif
     infer_ptr<nvinfer1::IRuntime> runtime(createInferRuntime(&logger_));
     infer_engine_.reset(runtime->deserializeCudaEngine(
         engine_serialized_data.c_str(), engine_serialized_data.size(),
@@ -273,6 +291,23 @@ class TensorRTEngine {
   ShapeMapType min_input_shape() { return min_input_shape_; }
   ShapeMapType max_input_shape() { return max_input_shape_; }
   ShapeMapType optim_input_shape() { return optim_input_shape_; }
+
+  // Add an optimization profile besides the one of min_input_shape_,
+  // max_input_shape_ and optim_input_shape_, which is the profile 0. It should
+  // be called before FreezeNetwork or Deserialize.
+  void AddOptimizationProfile(const ShapeMapType& min_input_shape,
+                              const ShapeMapType& max_input_shape,
+                              const ShapeMapType& optim_input_shape);
+  int optimization_profile_num() const {
+    return 1 + static_cast<int>(extra_profiles_.size());
+  }
+  // Select the first profile whose min and max shapes cover the shapes of
+  // the inputs.
+  int SelectOptimizationProfile(
+      const std::map<std::string, std::vector<int64_t>>& input_shapes) const;
+  // Make the execution context of the current thread run with the profile,
+  // and return the offset of the binding indices of the profile.
+  int SetOptimizationProfile(int profile);
   bool disable_trt_plugin_fp16() { return disable_trt_plugin_fp16_; }
   bool with_dynamic_shape() { return with_dynamic_shape_; }
 
@@ -307,6 +342,12 @@ class TensorRTEngine {
   ShapeMapType min_input_shape_;
   ShapeMapType max_input_shape_;
   ShapeMapType optim_input_shape_;
+  struct ShapeProfile {
+    ShapeMapType min_input_shape;
+    ShapeMapType max_input_shape;
+    ShapeMapType optim_input_shape;
+  };
+  std::vector<ShapeProfile> extra_profiles_;
   bool disable_trt_plugin_fp16_{false};
   nvinfer1::ILogger& logger_;
 
@@ -330,8 +371,13 @@ class TensorRTEngine {
   infer_ptr<nvinfer1::IBuilder> infer_builder_;
   infer_ptr<nvinfer1::INetworkDefinition> infer_network_;
   infer_ptr<nvinfer1::ICudaEngine> infer_engine_;
+  // released after the contexts using it
+  std::unordered_map<std::thread::id, memory::AllocationPtr>
+      infer_context_memory_;
   std::unordered_map<std::thread::id, infer_ptr<nvinfer1::IExecutionContext>>
       infer_context_;
+  // the optimization profile of the execution context of each thread
+  std::unordered_map<std::thread::id, int> infer_context_profile_;
   infer_ptr<nvinfer1::IHostMemory> ihost_memory_;
   std::unordered_map<nvinfer1::ITensor*, float> quant_dynamic_range_;
 
@@ -359,15 +405,22 @@ class TensorRTEngine {
 #define TRT_ENGINE_ADD_LAYER(engine__, layer__, ...) \
   engine__->network()->add##layer__(__VA_ARGS__);
 
+// The engines are shared by the predictors naming them with the same id, so
+// the manager is thread safe.
 class TRTEngineManager {
  public:
-  bool Empty() const { return engines_.size() == 0; }
+  bool Empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return engines_.size() == 0;
+  }
   bool Has(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (engines_.count(name) == 0) return false;
     return engines_.at(name).get() != nullptr;
   }
 
   TensorRTEngine* Get(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return engines_.at(name).get();
   }
 
@@ -384,17 +437,20 @@ class TRTEngineManager {
         new TensorRTEngine(max_batch, max_workspace, precision, calibrator,
                            device_id, min_input_shape, max_input_shape,
                            optim_input_shape, disable_trt_plugin_fp16, logger);
+    std::lock_guard<std::mutex> lock(mutex_);
     engines_[name].reset(p);
     return p;
   }
 
   void DeleteAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
     for (auto& item : engines_) {
       item.second.reset(nullptr);
     }
   }
 
  private:
+  mutable std::mutex mutex_;
   std::unordered_map<std::string, std::unique_ptr<TensorRTEngine>> engines_;
 };
 
@@ -74,11 +74,30 @@ int EmbEltwiseLayernormPluginDynamic<T>::initialize() {
 
 template <typename T>
 size_t EmbEltwiseLayernormPluginDynamic<T>::getSerializationSize() const {
-  return 0;
+  size_t size = SerializedSize(true) + SerializedSize(emb_sizes_);
+  for (auto emb_size : emb_sizes_) {
+    size += emb_size * sizeof(float);
+  }
+  return size + SerializedSize(bias_size_) + SerializedSize(scale_size_) +
+         (bias_size_ + scale_size_) * sizeof(float) +
+         SerializedSize(hidden_size_) + SerializedSize(eps_);
 }
 
 template <typename T>
-void EmbEltwiseLayernormPluginDynamic<T>::serialize(void *buffer) const {}
+void EmbEltwiseLayernormPluginDynamic<T>::serialize(void *buffer) const {
+  // the fp32 and fp16 plugins share the plugin type
+  SerializeValue(&buffer, sizeof(T) != sizeof(float));
+  SerializeValue(&buffer, emb_sizes_);
+  for (size_t i = 0; i < embs_.size(); ++i) {
+    SerializeArray(&buffer, embs_[i], emb_sizes_[i]);
+  }
+  SerializeValue(&buffer, bias_size_);
+  SerializeValue(&buffer, scale_size_);
+  SerializeArray(&buffer, bias_, bias_size_);
+  SerializeArray(&buffer, scale_, scale_size_);
+  SerializeValue(&buffer, hidden_size_);
+  SerializeValue(&buffer, eps_);
+}
 
 template <typename T>
 nvinfer1::DimsExprs EmbEltwiseLayernormPluginDynamic<T>::getOutputDimensions(
@@ -223,6 +242,25 @@ template class EmbEltwiseLayernormPluginDynamic<float>;
 template class EmbEltwiseLayernormPluginDynamic<half>;
 #endif  // SUPPORTS_CUDA_FP16
 
+static nvinfer1::IPluginV2 *DeserializeEmbEltwiseLayernormPluginDynamic(
+    const void *serial_data, size_t serial_length) {
+  const void *data = serial_data;
+  size_t length = serial_length;
+  bool with_fp16;
+  DeserializeValue(&data, &length, &with_fp16);
+#ifdef SUPPORTS_CUDA_FP16
+  if (with_fp16) {
+    return new EmbEltwiseLayernormPluginDynamic<half>(serial_data,
+                                                      serial_length);
+  }
+#endif  // SUPPORTS_CUDA_FP16
+  return new EmbEltwiseLayernormPluginDynamic<float>(serial_data,
+                                                     serial_length);
+}
+
+REGISTER_TRT_DYNAMIC_PLUGIN("fused_embedding_eltwise_layernorm_plugin", "1",
+                            DeserializeEmbEltwiseLayernormPluginDynamic);
+
 #endif
 
 }  // namespace plugin
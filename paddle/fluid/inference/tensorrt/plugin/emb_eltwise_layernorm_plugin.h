@@ -45,7 +45,25 @@ class EmbEltwiseLayernormPluginDynamic : public DynamicPluginTensorRT {
         eps_(eps) {}
 
   EmbEltwiseLayernormPluginDynamic(void const* serialData,
-                                   size_t serialLength) {}
+                                   size_t serialLength) {
+    bool with_fp16;
+    DeserializeValue(&serialData, &serialLength, &with_fp16);
+    DeserializeValue(&serialData, &serialLength, &emb_sizes_);
+    embs_data_.resize(emb_sizes_.size());
+    for (size_t i = 0; i < emb_sizes_.size(); ++i) {
+      DeserializeArray(&serialData, &serialLength, emb_sizes_[i],
+                       &embs_data_[i]);
+      embs_.push_back(embs_data_[i].data());
+    }
+    DeserializeValue(&serialData, &serialLength, &bias_size_);
+    DeserializeValue(&serialData, &serialLength, &scale_size_);
+    DeserializeArray(&serialData, &serialLength, bias_size_, &bias_data_);
+    DeserializeArray(&serialData, &serialLength, scale_size_, &scale_data_);
+    DeserializeValue(&serialData, &serialLength, &hidden_size_);
+    DeserializeValue(&serialData, &serialLength, &eps_);
+    bias_ = bias_data_.data();
+    scale_ = scale_data_.data();
+  }
   nvinfer1::IPluginV2DynamicExt* clone() const override {
     return new EmbEltwiseLayernormPluginDynamic(
         embs_, bias_, scale_, emb_sizes_, bias_size_, scale_size_, hidden_size_,
@@ -95,6 +113,10 @@ class EmbEltwiseLayernormPluginDynamic : public DynamicPluginTensorRT {
   std::vector<float*> embs_;
   float* bias_;
   float* scale_;
+  // the weights of the plugin deserialized from an engine
+  std::vector<std::vector<float>> embs_data_;
+  std::vector<float> bias_data_;
+  std::vector<float> scale_data_;
 
   // data on devices
   float* bias_gpu_;
@@ -136,6 +136,9 @@ size_t GeluPluginDynamic::getSerializationSize() const { return 0; }
 
 void GeluPluginDynamic::serialize(void* buffer) const {}
 
+REGISTER_TRT_DYNAMIC_PLUGIN("gelu_plugin", "1",
+                            DeserializeDynamicPlugin<GeluPluginDynamic>);
+
 nvinfer1::DimsExprs GeluPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs* inputs, int nb_inputs,
     nvinfer1::IExprBuilder& expr_builder) {
@@ -75,9 +75,25 @@ int PoolPlugin::enqueue(int batchSize, const void *const *inputs,
 // Dynamic Plugin below.
 #if IS_TRT_VERSION_GE(6000)
 
-size_t PoolPluginDynamic::getSerializationSize() const { return 0; }
+size_t PoolPluginDynamic::getSerializationSize() const {
+  return SerializedSize(ceil_mode_) + SerializedSize(pool_type_.c_str()) +
+         SerializedSize(adaptive_) + SerializedSize(ksize_) +
+         SerializedSize(strides_) + SerializedSize(paddings_) +
+         SerializedSize(is_global_);
+}
+
+void PoolPluginDynamic::serialize(void *buffer) const {
+  SerializeValue(&buffer, ceil_mode_);
+  SerializeValue(&buffer, pool_type_.c_str());
+  SerializeValue(&buffer, adaptive_);
+  SerializeValue(&buffer, ksize_);
+  SerializeValue(&buffer, strides_);
+  SerializeValue(&buffer, paddings_);
+  SerializeValue(&buffer, is_global_);
+}
 
-void PoolPluginDynamic::serialize(void *buffer) const {}
+REGISTER_TRT_DYNAMIC_PLUGIN("pool_plugin", "1",
+                            DeserializeDynamicPlugin<PoolPluginDynamic>);
 
 nvinfer1::DimsExprs PoolPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs *inputs, int nb_inputs,
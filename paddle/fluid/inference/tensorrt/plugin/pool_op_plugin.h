@@ -159,7 +159,6 @@ class PoolPluginDynamic : public DynamicPluginTensorRT {
         is_global_(is_global) {}
 
   PoolPluginDynamic(void const* serialData, size_t serialLength) {
-    deserializeBase(serialData, serialLength);
     DeserializeValue(&serialData, &serialLength, &ceil_mode_);
     const char* pool_type;
     DeserializeValue(&serialData, &serialLength, &pool_type);
@@ -85,9 +85,17 @@ int PReluPluginDynamic::initialize() {
              cudaMemcpyHostToDevice);
   return 0;
 }
-size_t PReluPluginDynamic::getSerializationSize() const { return 0; }
+size_t PReluPluginDynamic::getSerializationSize() const {
+  return SerializedSize(weight_) + SerializedSize(mode_.c_str());
+}
+
+void PReluPluginDynamic::serialize(void *buffer) const {
+  SerializeValue(&buffer, weight_);
+  SerializeValue(&buffer, mode_.c_str());
+}
 
-void PReluPluginDynamic::serialize(void *buffer) const {}
+REGISTER_TRT_DYNAMIC_PLUGIN("prelu_plugin", "1",
+                            DeserializeDynamicPlugin<PReluPluginDynamic>);
 
 nvinfer1::DimsExprs PReluPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs *inputs, int nb_inputs,
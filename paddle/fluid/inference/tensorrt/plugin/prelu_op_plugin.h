@@ -94,7 +94,6 @@ class PReluPluginDynamic : public DynamicPluginTensorRT {
   // It was used for tensorrt deserialization.
   // It should not be called by users.
   PReluPluginDynamic(void const* serialData, size_t serialLength) {
-    deserializeBase(serialData, serialLength);
     DeserializeValue(&serialData, &serialLength, &weight_);
     const char* prelu_mode;
     DeserializeValue(&serialData, &serialLength, &prelu_mode);
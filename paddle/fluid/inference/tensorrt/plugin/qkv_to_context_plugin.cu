@@ -141,9 +141,23 @@ inline void TransposeQKV(const int batch, const int seq_len,
 
 int QkvToContextPluginDynamic::initialize() { return 0; }
 
-size_t QkvToContextPluginDynamic::getSerializationSize() const { return 0; }
+size_t QkvToContextPluginDynamic::getSerializationSize() const {
+  return SerializedSize(hidden_) + SerializedSize(head_number_) +
+         SerializedSize(head_size_) + SerializedSize(scale_) +
+         SerializedSize(ban_fp16_);
+}
+
+void QkvToContextPluginDynamic::serialize(void *buffer) const {
+  SerializeValue(&buffer, hidden_);
+  SerializeValue(&buffer, head_number_);
+  SerializeValue(&buffer, head_size_);
+  SerializeValue(&buffer, scale_);
+  SerializeValue(&buffer, ban_fp16_);
+}
 
-void QkvToContextPluginDynamic::serialize(void *buffer) const {}
+REGISTER_TRT_DYNAMIC_PLUGIN(
+    "qkv_to_context_plugin", "1",
+    DeserializeDynamicPlugin<QkvToContextPluginDynamic>);
 
 nvinfer1::DimsExprs QkvToContextPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs *inputs, int nb_inputs,
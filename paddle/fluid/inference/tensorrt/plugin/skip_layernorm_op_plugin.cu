@@ -40,9 +40,24 @@ int SkipLayerNormPluginDynamic::initialize() {
   return 0;
 }
 
-size_t SkipLayerNormPluginDynamic::getSerializationSize() const { return 0; }
+size_t SkipLayerNormPluginDynamic::getSerializationSize() const {
+  return SerializedSize(bias_size_) + SerializedSize(scale_size_) +
+         (bias_size_ + scale_size_) * sizeof(float) + SerializedSize(eps_) +
+         SerializedSize(ban_fp16_);
+}
+
+void SkipLayerNormPluginDynamic::serialize(void *buffer) const {
+  SerializeValue(&buffer, bias_size_);
+  SerializeValue(&buffer, scale_size_);
+  SerializeArray(&buffer, bias_, bias_size_);
+  SerializeArray(&buffer, scale_, scale_size_);
+  SerializeValue(&buffer, eps_);
+  SerializeValue(&buffer, ban_fp16_);
+}
 
-void SkipLayerNormPluginDynamic::serialize(void *buffer) const {}
+REGISTER_TRT_DYNAMIC_PLUGIN(
+    "skip_layernorm_plugin", "1",
+    DeserializeDynamicPlugin<SkipLayerNormPluginDynamic>);
 
 nvinfer1::DimsExprs SkipLayerNormPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs *inputs, int nb_inputs,
@@ -38,7 +38,16 @@ class SkipLayerNormPluginDynamic : public DynamicPluginTensorRT {
         scale_size_(scale_size),
         eps_(eps),
         ban_fp16_(ban_fp16) {}
-  SkipLayerNormPluginDynamic(void const* serialData, size_t serialLength) {}
+  SkipLayerNormPluginDynamic(void const* serialData, size_t serialLength) {
+    DeserializeValue(&serialData, &serialLength, &bias_size_);
+    DeserializeValue(&serialData, &serialLength, &scale_size_);
+    DeserializeArray(&serialData, &serialLength, bias_size_, &bias_data_);
+    DeserializeArray(&serialData, &serialLength, scale_size_, &scale_data_);
+    DeserializeValue(&serialData, &serialLength, &eps_);
+    DeserializeValue(&serialData, &serialLength, &ban_fp16_);
+    bias_ = bias_data_.data();
+    scale_ = scale_data_.data();
+  }
   nvinfer1::IPluginV2DynamicExt* clone() const override {
     return new SkipLayerNormPluginDynamic(bias_, scale_, bias_size_,
                                           scale_size_, eps_, ban_fp16_);
@@ -84,6 +93,9 @@ class SkipLayerNormPluginDynamic : public DynamicPluginTensorRT {
  private:
   float* bias_;
   float* scale_;
+  // the weights of the plugin deserialized from an engine
+  std::vector<float> bias_data_;
+  std::vector<float> scale_data_;
 
   float* bias_gpu_;
   float* scale_gpu_;
@@ -32,7 +32,12 @@ class SlicePluginDynamic : public DynamicPluginTensorRT {
   explicit SlicePluginDynamic(std::vector<int> starts, std::vector<int> ends,
                               std::vector<int> axes, bool ban_fp16)
       : starts_(starts), ends_(ends), axes_(axes), ban_fp16_(ban_fp16) {}
-  SlicePluginDynamic(void const* serialData, size_t serialLength) {}
+  SlicePluginDynamic(void const* serialData, size_t serialLength) {
+    DeserializeValue(&serialData, &serialLength, &starts_);
+    DeserializeValue(&serialData, &serialLength, &ends_);
+    DeserializeValue(&serialData, &serialLength, &axes_);
+    DeserializeValue(&serialData, &serialLength, &ban_fp16_);
+  }
   nvinfer1::IPluginV2DynamicExt* clone() const override {
     return new SlicePluginDynamic(starts_, ends_, axes_, ban_fp16_);
   }
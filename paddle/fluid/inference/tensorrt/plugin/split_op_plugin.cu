@@ -145,9 +145,17 @@ int SplitPlugin::enqueue(int batchSize, const void* const* inputs,
 #if IS_TRT_VERSION_GE(6000)
 int SplitPluginDynamic::initialize() { return 0; }
 
-size_t SplitPluginDynamic::getSerializationSize() const { return 0; }
+size_t SplitPluginDynamic::getSerializationSize() const {
+  return SerializedSize(axis_) + SerializedSize(output_length_);
+}
+
+void SplitPluginDynamic::serialize(void *buffer) const {
+  SerializeValue(&buffer, axis_);
+  SerializeValue(&buffer, output_length_);
+}
 
-void SplitPluginDynamic::serialize(void* buffer) const {}
+REGISTER_TRT_DYNAMIC_PLUGIN("split_plugin", "1",
+                            DeserializeDynamicPlugin<SplitPluginDynamic>);
 
 nvinfer1::DimsExprs SplitPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs* inputs, int nb_inputs,
@@ -80,7 +80,10 @@ class SplitPluginDynamic : public DynamicPluginTensorRT {
   SplitPluginDynamic(int axis, std::vector<int> const& output_lengths)
       : axis_(axis), output_length_(output_lengths) {}
 
-  SplitPluginDynamic(void const* serial_data, size_t serial_length) {}
+  SplitPluginDynamic(void const* serial_data, size_t serial_length) {
+    DeserializeValue(&serial_data, &serial_length, &axis_);
+    DeserializeValue(&serial_data, &serial_length, &output_length_);
+  }
 
   nvinfer1::IPluginV2DynamicExt* clone() const override {
     return new SplitPluginDynamic(axis_, output_length_);
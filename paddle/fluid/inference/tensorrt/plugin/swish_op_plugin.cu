@@ -91,15 +91,18 @@ int SwishPlugin::enqueue(int batch_size, const void *const *inputs,
 // Dynamic Plugin below.
 #if IS_TRT_VERSION_GE(6000)
 
-int SwishPluginDynamic::initialize() {
-  setPluginNamespace("swish");
-  getPluginNamespace();
-  return 0;
+int SwishPluginDynamic::initialize() { return 0; }
+
+size_t SwishPluginDynamic::getSerializationSize() const {
+  return SerializedSize(beta_);
 }
 
-size_t SwishPluginDynamic::getSerializationSize() const { return 0; }
+void SwishPluginDynamic::serialize(void *buffer) const {
+  SerializeValue(&buffer, beta_);
+}
 
-void SwishPluginDynamic::serialize(void *buffer) const {}
+REGISTER_TRT_DYNAMIC_PLUGIN("swish_plugin", "1",
+                            DeserializeDynamicPlugin<SwishPluginDynamic>);
 
 nvinfer1::DimsExprs SwishPluginDynamic::getOutputDimensions(
     int output_index, const nvinfer1::DimsExprs *inputs, int nb_inputs,
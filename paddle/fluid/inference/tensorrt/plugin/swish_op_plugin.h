@@ -70,7 +70,9 @@ class SwishPlugin : public PluginTensorRT {
 class SwishPluginDynamic : public DynamicPluginTensorRT {
  public:
   explicit SwishPluginDynamic(const float beta) : beta_(beta) {}
-  SwishPluginDynamic(void const* serialData, size_t serialLength) {}
+  SwishPluginDynamic(void const* serialData, size_t serialLength) {
+    DeserializeValue(&serialData, &serialLength, &beta_);
+  }
   nvinfer1::IPluginV2DynamicExt* clone() const override {
     return new SwishPluginDynamic(beta_);
   }
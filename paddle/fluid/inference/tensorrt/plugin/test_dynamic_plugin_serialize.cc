@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/inference/tensorrt/plugin/skip_layernorm_op_plugin.h"
+#include "paddle/fluid/inference/tensorrt/plugin/slice_op_plugin.h"
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin_factory.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+#if IS_TRT_VERSION_GE(6000)
+static std::string Serialize(const nvinfer1::IPluginV2DynamicExt& plugin) {
+  std::string buffer(plugin.getSerializationSize(), '\0');
+  plugin.serialize(&buffer[0]);
+  return buffer;
+}
+
+// Serialize the plugin, deserialize it, and serialize the deserialized one.
+template <typename T>
+void CheckSerialization(const T& plugin) {
+  auto data = Serialize(plugin);
+  auto* deserialized = static_cast<nvinfer1::IPluginV2DynamicExt*>(
+      DeserializeDynamicPlugin<T>(data.data(), data.size()));
+  EXPECT_STREQ(deserialized->getPluginType(), plugin.getPluginType());
+  EXPECT_EQ(Serialize(*deserialized), data);
+  deserialized->destroy();
+}
+
+TEST(DynamicPluginTensorRT, slice_serialization) {
+  SlicePluginDynamic plugin({1, 0}, {3, 2}, {1, 2}, true);
+  CheckSerialization(plugin);
+}
+
+TEST(DynamicPluginTensorRT, skip_layernorm_serialization) {
+  std::vector<float> bias{0.1f, 0.2f, 0.3f};
+  std::vector<float> scale{1.f, 2.f, 3.f};
+  SkipLayerNormPluginDynamic plugin(bias.data(), scale.data(), bias.size(),
+                                    scale.size(), 1e-5f, false);
+  CheckSerialization(plugin);
+}
+
+TEST(DynamicPluginTensorRT, versions) {
+  auto versions =
+      inference::Singleton<DynamicPluginFactoryTensorRT>::Global().Versions();
+  EXPECT_NE(versions.find("slice_plugin:1;"), std::string::npos);
+  EXPECT_NE(versions.find("skip_layernorm_plugin:1;"), std::string::npos);
+}
+#endif
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/tensorrt/plugin/trt_plugin_factory.h"
+#include <algorithm>
+#include "paddle/fluid/platform/dynload/tensorrt.h"
 
 namespace paddle {
 namespace inference {
@@ -42,6 +44,44 @@ bool PluginFactoryTensorRT::RegisterPlugin(
 
 void PluginFactoryTensorRT::DestroyPlugins() { owned_plugins_.clear(); }
 
+#if IS_TRT_VERSION_GE(6000)
+bool DynamicPluginFactoryTensorRT::RegisterPlugin(
+    const std::string& name, const std::string& version,
+    DynamicPluginDeserializeFunc deserialize_func) {
+  for (auto& creator : creators_) {
+    if (name == creator->getPluginName()) return false;
+  }
+  creators_.emplace_back(
+      new DynamicPluginCreator(name, version, deserialize_func));
+  return true;
+}
+
+void DynamicPluginFactoryTensorRT::RegisterCreators() {
+  std::call_once(register_flag_, [this] {
+    auto* registry = platform::dynload::getPluginRegistry();
+    for (auto& creator : creators_) {
+      // the namespace of the plugins is set in DynamicPluginTensorRT
+      creator->setPluginNamespace("paddle_trt");
+      registry->registerCreator(*creator, "paddle_trt");
+    }
+  });
+}
+
+std::string DynamicPluginFactoryTensorRT::Versions() const {
+  std::vector<std::string> versions;
+  for (auto& creator : creators_) {
+    versions.push_back(std::string(creator->getPluginName()) + ":" +
+                       creator->getPluginVersion());
+  }
+  std::sort(versions.begin(), versions.end());
+  std::string res;
+  for (auto& version : versions) {
+    res += version + ";";
+  }
+  return res;
+}
+#endif
+
 }  // namespace plugin
 }  // namespace tensorrt
 }  // namespace inference
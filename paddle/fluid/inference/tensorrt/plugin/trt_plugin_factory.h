@@ -18,6 +18,7 @@
 #include <cstring>
 #include <list>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -63,6 +64,90 @@ class TrtPluginRegistrar {
   }
 };
 
+#if IS_TRT_VERSION_GE(6000)
+typedef nvinfer1::IPluginV2* (*DynamicPluginDeserializeFunc)(const void*,
+                                                             size_t);
+
+template <typename T>
+nvinfer1::IPluginV2* DeserializeDynamicPlugin(const void* serial_data,
+                                              size_t serial_length) {
+  return new T(serial_data, serial_length);
+}
+
+// Creates the dynamic shape plugins when TensorRT deserializes an engine.
+class DynamicPluginCreator : public nvinfer1::IPluginCreator {
+ public:
+  DynamicPluginCreator(const std::string& name, const std::string& version,
+                       DynamicPluginDeserializeFunc deserialize_func)
+      : name_(name), version_(version), deserialize_func_(deserialize_func) {}
+
+  const char* getPluginName() const override { return name_.c_str(); }
+  const char* getPluginVersion() const override { return version_.c_str(); }
+  const nvinfer1::PluginFieldCollection* getFieldNames() override {
+    return &field_collection_;
+  }
+  // The plugins are only created by the op converters.
+  nvinfer1::IPluginV2* createPlugin(
+      const char* name, const nvinfer1::PluginFieldCollection* fc) override {
+    return nullptr;
+  }
+  nvinfer1::IPluginV2* deserializePlugin(const char* name,
+                                         const void* serial_data,
+                                         size_t serial_length) override {
+    return deserialize_func_(serial_data, serial_length);
+  }
+  void setPluginNamespace(const char* plugin_namespace) override {
+    namespace_ = plugin_namespace;
+  }
+  const char* getPluginNamespace() const override {
+    return namespace_.c_str();
+  }
+
+ private:
+  std::string name_;
+  std::string version_;
+  std::string namespace_;
+  DynamicPluginDeserializeFunc deserialize_func_;
+  nvinfer1::PluginFieldCollection field_collection_{0, nullptr};
+};
+
+// The creators of the dynamic shape plugins, which are registered to the
+// plugin registry of TensorRT before an engine is deserialized.
+class DynamicPluginFactoryTensorRT {
+ public:
+  bool RegisterPlugin(const std::string& name, const std::string& version,
+                      DynamicPluginDeserializeFunc deserialize_func);
+  // Register all the creators to TensorRT, only once.
+  void RegisterCreators();
+  // The "name:version" of all the plugins, sorted by the name.
+  std::string Versions() const;
+
+ private:
+  std::list<std::unique_ptr<DynamicPluginCreator>> creators_;
+  std::once_flag register_flag_;
+};
+
+class TrtDynamicPluginRegistrar {
+ public:
+  TrtDynamicPluginRegistrar(const std::string& name,
+                            const std::string& version,
+                            DynamicPluginDeserializeFunc deserialize_func) {
+    inference::Singleton<DynamicPluginFactoryTensorRT>::Global().RegisterPlugin(
+        name, version, deserialize_func);
+  }
+};
+
+#define REGISTER_TRT_DYNAMIC_PLUGIN(name, version, deserialize_func) \
+  REGISTER_TRT_DYNAMIC_PLUGIN_UNIQ(__COUNTER__, name, version, deserialize_func)
+
+#define REGISTER_TRT_DYNAMIC_PLUGIN_UNIQ(ctr, name, version,            \
+                                         deserialize_func)              \
+  static paddle::inference::tensorrt::plugin::TrtDynamicPluginRegistrar \
+      trt_dynamic_plugin_registrar##ctr UNUSED =                        \
+          paddle::inference::tensorrt::plugin::TrtDynamicPluginRegistrar( \
+              name, version, deserialize_func)
+#endif
+
 #define REGISTER_TRT_PLUGIN(name, deserialize_func) \
   REGISTER_TRT_PLUGIN_UNIQ(__COUNTER__, name, deserialize_func)
 
@@ -128,6 +128,28 @@ inline void DeserializeValue(void const** buffer, size_t* buffer_size,
   return details::Serializer<T>::Deserialize(buffer, buffer_size, value);
 }
 
+// Serialize the elements of a weight without the size, which is serialized
+// by the plugin itself, so that the weight is not copied to a vector.
+template <typename T>
+inline void SerializeArray(void** buffer, const T* data, size_t num) {
+  size_t nbyte = num * sizeof(T);
+  std::memcpy(*buffer, data, nbyte);
+  reinterpret_cast<char*&>(*buffer) += nbyte;
+}
+
+template <typename T>
+inline void DeserializeArray(void const** buffer, size_t* buffer_size,
+                             size_t num, std::vector<T>* value) {
+  size_t nbyte = num * sizeof(T);
+  PADDLE_ENFORCE_GE(*buffer_size, nbyte,
+                    platform::errors::InvalidArgument(
+                        "The serialized data of the plugin is too short."));
+  value->resize(num);
+  std::memcpy(value->data(), *buffer, nbyte);
+  reinterpret_cast<char const*&>(*buffer) += nbyte;
+  *buffer_size -= nbyte;
+}
+
 }  // namespace plugin
 }  // namespace tensorrt
 }  // namespace inference
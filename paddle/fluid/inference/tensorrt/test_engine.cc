@@ -227,6 +227,29 @@ TEST_F(TensorRTEngineTest, test_pool2d) {
   ASSERT_EQ(y_cpu[1], 5.0);
 }
 
+#if IS_TRT_VERSION_GE(6000)
+TEST(TensorRTEngine, select_optimization_profile) {
+  using ShapeMapType = std::map<std::string, std::vector<int>>;
+  TensorRTEngine engine(1, 1 << 10, AnalysisConfig::Precision::kFloat32,
+                        nullptr, 0, ShapeMapType{{"x", {1, 1}}},
+                        ShapeMapType{{"x", {8, 32}}},
+                        ShapeMapType{{"x", {4, 32}}});
+  engine.AddOptimizationProfile(ShapeMapType{{"x", {1, 33}}},
+                                ShapeMapType{{"x", {8, 128}}},
+                                ShapeMapType{{"x", {4, 128}}});
+  engine.AddOptimizationProfile(ShapeMapType{{"x", {1, 1}}},
+                                ShapeMapType{{"x", {8, 512}}},
+                                ShapeMapType{{"x", {4, 512}}});
+  ASSERT_EQ(engine.optimization_profile_num(), 3);
+  EXPECT_EQ(engine.SelectOptimizationProfile({{"x", {2, 16}}}), 0);
+  EXPECT_EQ(engine.SelectOptimizationProfile({{"x", {8, 32}}}), 0);
+  EXPECT_EQ(engine.SelectOptimizationProfile({{"x", {2, 100}}}), 1);
+  EXPECT_EQ(engine.SelectOptimizationProfile({{"x", {2, 300}}}), 2);
+  // no profile covers it
+  EXPECT_EQ(engine.SelectOptimizationProfile({{"x", {16, 300}}}), 0);
+}
+#endif
+
 }  // namespace tensorrt
 }  // namespace inference
 }  // namespace paddle
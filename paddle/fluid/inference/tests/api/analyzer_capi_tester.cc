@@ -15,6 +15,7 @@ limitations under the License. */
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "paddle/fluid/inference/capi/paddle_c_api.h"
@@ -71,6 +72,64 @@ void zero_copy_run() {
 
 TEST(PD_PredictorZeroCopyRun, zero_copy_run) { zero_copy_run(); }
 
+TEST(PD_TensorHandle, zero_copy_run) {
+  std::string model_dir = FLAGS_infer_model;
+  std::string prog_file = model_dir + "/model";
+  std::string params_file = model_dir + "/params";
+  PD_AnalysisConfig *config = PD_NewAnalysisConfig();
+  PD_DisableGpu(config);
+  PD_SwitchUseFeedFetchOps(config, false);
+  PD_SwitchSpecifyInputNames(config, true);
+  PD_SetModel(config, prog_file.c_str(), params_file.c_str());
+  PD_Predictor *predictor = PD_NewPredictor(config);
+
+  int shape[4] = {1, 3, 318, 318};
+  PD_TensorHandle *input = PD_GetInputHandle(predictor, "data");
+  PD_TensorHandle *output =
+      PD_GetOutputHandle(predictor, PD_GetOutputName(predictor, 0));
+  std::vector<float> first_output;
+  for (int run = 0; run < 2; ++run) {
+    // the handles are got once and reused by the runs
+    PD_TensorHandleReshape(input, shape, 4);
+    float *data = static_cast<float *>(
+        PD_TensorHandleMutableData(input, PD_FLOAT32, PD_PLACE_CPU));
+    std::fill_n(data, 3 * 318 * 318, 1.f);
+    int shape_size = 0;
+    const int *input_shape = PD_TensorHandleShape(input, &shape_size);
+    ASSERT_EQ(shape_size, 4);
+    EXPECT_EQ(input_shape[2], 318);
+
+    ASSERT_TRUE(PD_ZeroCopyRun(predictor));
+    EXPECT_EQ(PD_TensorHandleDType(output), PD_FLOAT32);
+    PD_Place place;
+    int numel = 0;
+    auto *out = static_cast<const float *>(
+        PD_TensorHandleData(output, &place, &numel));
+    EXPECT_EQ(place, PD_PLACE_CPU);
+    ASSERT_GT(numel, 0);
+    if (run == 0) {
+      first_output.assign(out, out + numel);
+    } else {
+      EXPECT_EQ(std::vector<float>(out, out + numel), first_output);
+    }
+  }
+
+  // the output is written into the buffer of the caller
+  int out_shape_size = 0;
+  const int *out_shape_ptr = PD_TensorHandleShape(output, &out_shape_size);
+  std::vector<int> out_shape(out_shape_ptr, out_shape_ptr + out_shape_size);
+  std::vector<float> external(first_output.size());
+  PD_TensorHandleShareExternalData(output, external.data(), PD_FLOAT32,
+                                   out_shape.data(), out_shape_size,
+                                   PD_PLACE_CPU);
+  ASSERT_TRUE(PD_ZeroCopyRun(predictor));
+  EXPECT_EQ(external, first_output);
+  PD_DeleteTensorHandle(input);
+  PD_DeleteTensorHandle(output);
+  PD_DeletePredictor(predictor);
+  PD_DeleteAnalysisConfig(config);
+}
+
 #ifdef PADDLE_WITH_MKLDNN
 TEST(PD_AnalysisConfig, profile_mkldnn) {
   std::string model_dir = FLAGS_infer_model;
@@ -28,6 +28,26 @@ TEST(TensorRT_mobilenet, compare) {
   // profile(model_dir, /* use_analysis */ true, FLAGS_use_tensorrt);
 }
 
+TEST(TensorRT_mobilenet, share_engine) {
+  std::string model_dir = FLAGS_infer_model + "/mobilenet";
+  AnalysisConfig config;
+  SetConfig<AnalysisConfig>(&config, model_dir, true /* use_gpu */,
+                            true /* use_tensorrt */, 1 /* batch_size */);
+  config.EnableTensorRtEngineSharing();
+  auto predictor = CreatePaddlePredictor(config);
+  auto shared_predictor = CreatePaddlePredictor(config);
+  // the second predictor runs the engines built by the first one
+
+  std::vector<std::vector<PaddleTensor>> inputs_all;
+  SetFakeImageInput(&inputs_all, model_dir, false, "__model__", "");
+  std::vector<PaddleTensor> outputs, shared_outputs;
+  for (auto& input : inputs_all) {
+    ASSERT_TRUE(predictor->Run(input, &outputs));
+    ASSERT_TRUE(shared_predictor->Run(input, &shared_outputs));
+    CompareResult(outputs, shared_outputs);
+  }
+}
+
 TEST(AnalysisPredictor, use_gpu) {
   std::string model_dir = FLAGS_infer_model + "/" + "mobilenet";
   AnalysisConfig config;
@@ -0,0 +1,323 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/config_tuner.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include "paddle/fluid/inference/api/helper.h"
+#include "paddle/fluid/inference/api/paddle_pass_builder.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/string/printf.h"
+
+namespace paddle {
+namespace inference {
+
+void TuningCandidate::ApplyTo(AnalysisConfig *config) const {
+  config->SwitchIrOptim(ir_optim);
+  for (auto &pass : deleted_passes) {
+    config->pass_builder()->DeletePass(pass);
+  }
+  if (use_mkldnn) {
+    config->EnableMKLDNN();
+  }
+  if (use_tensorrt) {
+    // int8 is only for the quantized models, the calibration is not tuned
+    config->EnableTensorRtEngine(trt_workspace_size, trt_max_batch_size,
+                                 trt_min_subgraph_size, trt_precision, false,
+                                 false);
+  }
+}
+
+std::string TuningCandidate::SerializeToString() const {
+  std::stringstream ss;
+  ss << "name " << name << "\n";
+  ss << "ir_optim " << ir_optim << "\n";
+  for (auto &pass : deleted_passes) {
+    ss << "deleted_pass " << pass << "\n";
+  }
+  ss << "use_mkldnn " << use_mkldnn << "\n";
+  ss << "use_tensorrt " << use_tensorrt << "\n";
+  ss << "trt_precision " << static_cast<int>(trt_precision) << "\n";
+  ss << "trt_workspace_size " << trt_workspace_size << "\n";
+  ss << "trt_max_batch_size " << trt_max_batch_size << "\n";
+  ss << "trt_min_subgraph_size " << trt_min_subgraph_size << "\n";
+  return ss.str();
+}
+
+TuningCandidate TuningCandidate::DeserializeFromString(
+    const std::string &str) {
+  TuningCandidate candidate;
+  std::istringstream is(str);
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ls(line);
+    std::string key;
+    if (!(ls >> key)) continue;
+    bool ok = true;
+    if (key == "name") {
+      ok = static_cast<bool>(ls >> candidate.name);
+    } else if (key == "ir_optim") {
+      ok = static_cast<bool>(ls >> candidate.ir_optim);
+    } else if (key == "deleted_pass") {
+      candidate.deleted_passes.emplace_back();
+      ok = static_cast<bool>(ls >> candidate.deleted_passes.back());
+    } else if (key == "use_mkldnn") {
+      ok = static_cast<bool>(ls >> candidate.use_mkldnn);
+    } else if (key == "use_tensorrt") {
+      ok = static_cast<bool>(ls >> candidate.use_tensorrt);
+    } else if (key == "trt_precision") {
+      int precision;
+      ok = static_cast<bool>(ls >> precision);
+      candidate.trt_precision =
+          static_cast<AnalysisConfig::Precision>(precision);
+    } else if (key == "trt_workspace_size") {
+      ok = static_cast<bool>(ls >> candidate.trt_workspace_size);
+    } else if (key == "trt_max_batch_size") {
+      ok = static_cast<bool>(ls >> candidate.trt_max_batch_size);
+    } else if (key == "trt_min_subgraph_size") {
+      ok = static_cast<bool>(ls >> candidate.trt_min_subgraph_size);
+    } else {
+      PADDLE_THROW(platform::errors::InvalidArgument(
+          "Unknown option %s of the tuned config.", key));
+    }
+    PADDLE_ENFORCE_EQ(ok, true,
+                      platform::errors::InvalidArgument(
+                          "Invalid line of the tuned config: %s", line));
+  }
+  return candidate;
+}
+
+void SaveTunedConfig(const std::string &path,
+                     const TuningCandidate &candidate) {
+  std::ofstream file(path);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Can not open %s to save the tuned config.", path));
+  file << candidate.SerializeToString();
+  file.close();
+}
+
+void LoadTunedConfig(const std::string &path, AnalysisConfig *config) {
+  std::ifstream file(path);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Can not open %s to load the tuned config.", path));
+  std::stringstream ss;
+  ss << file.rdbuf();
+  TuningCandidate::DeserializeFromString(ss.str()).ApplyTo(config);
+}
+
+ConfigTuner::ConfigTuner(const AnalysisConfig &config,
+                         const std::vector<std::vector<PaddleTensor>> &samples)
+    : config_(config), samples_(samples) {
+  PADDLE_ENFORCE_GT(samples_.size(), 0UL,
+                    platform::errors::InvalidArgument(
+                        "ConfigTuner needs at least one sample."));
+}
+
+void ConfigTuner::SetRepeat(int warmup, int repeat) {
+  PADDLE_ENFORCE_GT(repeat, 0, platform::errors::InvalidArgument(
+                                   "The repeat of ConfigTuner should be "
+                                   "larger than 0, but got %d.",
+                                   repeat));
+  warmup_ = warmup;
+  repeat_ = repeat;
+}
+
+void ConfigTuner::AddCandidate(const TuningCandidate &candidate) {
+  candidates_.push_back(candidate);
+}
+
+void ConfigTuner::AddDefaultCandidates() {
+  TuningCandidate ir_optim;
+  ir_optim.name = "ir_optim";
+  AddCandidate(ir_optim);
+#ifdef PADDLE_WITH_MKLDNN
+  if (!config_.use_gpu()) {
+    TuningCandidate mkldnn;
+    mkldnn.name = "mkldnn";
+    mkldnn.use_mkldnn = true;
+    AddCandidate(mkldnn);
+  }
+#endif
+#if PADDLE_WITH_TENSORRT
+  if (config_.use_gpu()) {
+    int max_batch_size = 1;
+    for (auto &sample : samples_) {
+      if (!sample.empty() && !sample[0].shape.empty()) {
+        max_batch_size = std::max(max_batch_size, sample[0].shape[0]);
+      }
+    }
+    for (auto precision : {AnalysisConfig::Precision::kFloat32,
+                           AnalysisConfig::Precision::kHalf}) {
+      for (int min_subgraph_size : {3, 5, 10}) {
+        TuningCandidate trt;
+        trt.use_tensorrt = true;
+        trt.trt_precision = precision;
+        trt.trt_max_batch_size = max_batch_size;
+        trt.trt_min_subgraph_size = min_subgraph_size;
+        trt.name = string::Sprintf(
+            "trt_%s_%d",
+            precision == AnalysisConfig::Precision::kHalf ? "fp16" : "fp32",
+            min_subgraph_size);
+        AddCandidate(trt);
+      }
+    }
+  }
+#endif
+}
+
+float ConfigTuner::MaxDiff(const std::vector<PaddleTensor> &outputs,
+                           const std::vector<PaddleTensor> &baseline,
+                           float tolerance, bool *passed) {
+  *passed = outputs.size() == baseline.size();
+  float max_diff = 0.f;
+  for (size_t i = 0; *passed && i < outputs.size(); ++i) {
+    auto &out = outputs[i];
+    auto &ref = baseline[i];
+    if (out.dtype != ref.dtype || out.shape != ref.shape ||
+        out.data.length() != ref.data.length()) {
+      *passed = false;
+      break;
+    }
+    size_t numel = ref.data.length() / PaddleDtypeSize(ref.dtype);
+    for (size_t j = 0; j < numel; ++j) {
+      float a, b;
+      switch (ref.dtype) {
+        case PaddleDType::FLOAT32:
+          a = static_cast<const float *>(out.data.data())[j];
+          b = static_cast<const float *>(ref.data.data())[j];
+          break;
+        case PaddleDType::INT64:
+          a = static_cast<const int64_t *>(out.data.data())[j];
+          b = static_cast<const int64_t *>(ref.data.data())[j];
+          break;
+        case PaddleDType::INT32:
+          a = static_cast<const int32_t *>(out.data.data())[j];
+          b = static_cast<const int32_t *>(ref.data.data())[j];
+          break;
+        case PaddleDType::UINT8:
+          a = static_cast<const uint8_t *>(out.data.data())[j];
+          b = static_cast<const uint8_t *>(ref.data.data())[j];
+          break;
+        default:
+          PADDLE_THROW(platform::errors::Unimplemented(
+              "Unsupported data type of the output %s.", ref.name));
+      }
+      float diff = std::fabs(a - b);
+      // NaN never passes
+      if (!(diff <= tolerance * std::max(1.f, std::fabs(b)))) {
+        *passed = false;
+      }
+      max_diff = std::max(max_diff, diff);
+    }
+  }
+  return max_diff;
+}
+
+float ConfigTuner::Run(const TuningCandidate &candidate,
+                       std::vector<std::vector<PaddleTensor>> *outputs) const {
+  AnalysisConfig config(config_);
+  candidate.ApplyTo(&config);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  PADDLE_ENFORCE_NOT_NULL(predictor,
+                          platform::errors::Unavailable(
+                              "Failed to create the predictor of %s.",
+                              candidate.name));
+  outputs->assign(samples_.size(), std::vector<PaddleTensor>());
+  for (int i = 0; i < warmup_; ++i) {
+    PADDLE_ENFORCE_EQ(predictor->Run(samples_[0], &(*outputs)[0]), true,
+                      platform::errors::Fatal("Failed to run %s.",
+                                              candidate.name));
+  }
+  Timer timer;
+  timer.tic();
+  for (int i = 0; i < repeat_; ++i) {
+    for (size_t j = 0; j < samples_.size(); ++j) {
+      PADDLE_ENFORCE_EQ(predictor->Run(samples_[j], &(*outputs)[j]), true,
+                        platform::errors::Fatal("Failed to run %s.",
+                                                candidate.name));
+    }
+  }
+  return timer.toc() / (repeat_ * samples_.size());
+}
+
+const TuningCandidate &ConfigTuner::Tune() {
+  results_.clear();
+  auto record = [this](const TuningCandidate &candidate) {
+    results_.emplace_back();
+    auto &result = results_.back();
+    result.candidate = candidate;
+    result.benchmark.SetName(candidate.name);
+    if (!samples_[0].empty() && !samples_[0][0].shape.empty()) {
+      result.benchmark.SetBatchSize(samples_[0][0].shape[0]);
+    }
+    result.benchmark.SetNumThreads(config_.cpu_math_library_num_threads());
+    if (config_.use_gpu()) result.benchmark.SetUseGpu();
+    return &result;
+  };
+
+  TuningCandidate baseline;
+  baseline.name = "baseline";
+  baseline.ir_optim = false;
+  std::vector<std::vector<PaddleTensor>> baseline_outputs;
+  auto *result = record(baseline);
+  result->benchmark.SetLatency(Run(baseline, &baseline_outputs));
+  result->passed = true;
+  LOG(INFO) << "ConfigTuner:\n" << result->benchmark.SerializeToString();
+
+  for (auto &candidate : candidates_) {
+    result = record(candidate);
+    std::vector<std::vector<PaddleTensor>> outputs;
+    try {
+      result->benchmark.SetLatency(Run(candidate, &outputs));
+      result->passed = true;
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        bool passed;
+        result->max_diff =
+            std::max(result->max_diff, MaxDiff(outputs[i], baseline_outputs[i],
+                                               tolerance_, &passed));
+        result->passed &= passed;
+      }
+    } catch (const std::exception &e) {
+      result->passed = false;
+      result->error = e.what();
+    }
+    if (result->passed) {
+      LOG(INFO) << "ConfigTuner:\n" << result->benchmark.SerializeToString();
+    } else {
+      LOG(WARNING) << "ConfigTuner: " << candidate.name
+                   << " fails, max diff: " << result->max_diff << " "
+                   << result->error;
+    }
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i < results_.size(); ++i) {
+    if (results_[i].passed &&
+        results_[i].benchmark.latency() < results_[best].benchmark.latency()) {
+      best = i;
+    }
+  }
+  LOG(INFO) << "ConfigTuner: the fastest config is "
+            << results_[best].candidate.name;
+  return results_[best].candidate;
+}
+
+}  // namespace inference
+}  // namespace paddle
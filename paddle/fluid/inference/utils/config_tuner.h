@@ -0,0 +1,108 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_analysis_config.h"
+#include "paddle/fluid/inference/api/paddle_api.h"
+#include "paddle/fluid/inference/utils/benchmark.h"
+
+namespace paddle {
+namespace inference {
+
+/*
+ * The options tuned on top of the AnalysisConfig of a model.
+ */
+struct TuningCandidate {
+  std::string name;
+  bool ir_optim{true};
+  std::vector<std::string> deleted_passes;
+  bool use_mkldnn{false};
+  bool use_tensorrt{false};
+  AnalysisConfig::Precision trt_precision{AnalysisConfig::Precision::kFloat32};
+  int trt_workspace_size{1 << 30};
+  int trt_max_batch_size{1};
+  int trt_min_subgraph_size{3};
+
+  // Apply the options to the config, which holds the model and the device.
+  void ApplyTo(AnalysisConfig* config) const;
+
+  // One "key value" line per option.
+  std::string SerializeToString() const;
+  static TuningCandidate DeserializeFromString(const std::string& str);
+};
+
+// Save the tuned options to a file, and apply them to a config loading the
+// same model.
+void SaveTunedConfig(const std::string& path,
+                     const TuningCandidate& candidate);
+void LoadTunedConfig(const std::string& path, AnalysisConfig* config);
+
+struct TuningResult {
+  TuningCandidate candidate;
+  Benchmark benchmark;
+  // whether the predictor is created, run, and its outputs are within the
+  // tolerance of the baseline
+  bool passed{false};
+  float max_diff{0.f};
+  std::string error;
+};
+
+/*
+ * Benchmark the candidate options of a model against the sample inputs, and
+ * find the fastest one whose outputs match the baseline, i.e., the outputs
+ * without IR optimization and engines.
+ */
+class ConfigTuner {
+ public:
+  ConfigTuner(const AnalysisConfig& config,
+              const std::vector<std::vector<PaddleTensor>>& samples);
+
+  // The max abs diff allowed is tolerance * max(1, |baseline|).
+  void SetTolerance(float tolerance) { tolerance_ = tolerance; }
+  void SetRepeat(int warmup, int repeat);
+
+  void AddCandidate(const TuningCandidate& candidate);
+  // The IR optimization, MKLDNN on the CPU and the TensorRT precisions and
+  // min subgraph sizes on the GPU, according to the build.
+  void AddDefaultCandidates();
+
+  // Return the fastest candidate which passes, the baseline is a candidate
+  // too.
+  const TuningCandidate& Tune();
+
+  const std::vector<TuningResult>& results() const { return results_; }
+
+  static float MaxDiff(const std::vector<PaddleTensor>& outputs,
+                       const std::vector<PaddleTensor>& baseline,
+                       float tolerance, bool* passed);
+
+ private:
+  // Run all the samples, return the latency per sample in ms.
+  float Run(const TuningCandidate& candidate,
+            std::vector<std::vector<PaddleTensor>>* outputs) const;
+
+  AnalysisConfig config_;
+  std::vector<std::vector<PaddleTensor>> samples_;
+  float tolerance_{1e-3f};
+  int warmup_{2};
+  int repeat_{10};
+  std::vector<TuningCandidate> candidates_;
+  std::vector<TuningResult> results_;
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,88 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/config_tuner.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "paddle/fluid/inference/api/paddle_pass_builder.h"
+
+namespace paddle {
+namespace inference {
+
+TEST(ConfigTuner, save_and_load_tuned_config) {
+  TuningCandidate candidate;
+  candidate.name = "trt_fp16_5";
+  candidate.deleted_passes = {"fc_fuse_pass", "conv_bn_fuse_pass"};
+  candidate.use_tensorrt = true;
+  candidate.trt_precision = AnalysisConfig::Precision::kHalf;
+  candidate.trt_max_batch_size = 8;
+  candidate.trt_min_subgraph_size = 5;
+  SaveTunedConfig("tuned_config.txt", candidate);
+
+  std::ifstream file("tuned_config.txt");
+  std::stringstream ss;
+  ss << file.rdbuf();
+  auto loaded = TuningCandidate::DeserializeFromString(ss.str());
+  EXPECT_EQ(loaded.SerializeToString(), candidate.SerializeToString());
+  EXPECT_EQ(loaded.deleted_passes, candidate.deleted_passes);
+  EXPECT_EQ(loaded.trt_precision, AnalysisConfig::Precision::kHalf);
+  EXPECT_EQ(loaded.trt_min_subgraph_size, 5);
+
+  AnalysisConfig config;
+  candidate.use_tensorrt = false;
+  candidate.ir_optim = false;
+  SaveTunedConfig("tuned_config.txt", candidate);
+  LoadTunedConfig("tuned_config.txt", &config);
+  EXPECT_FALSE(config.ir_optim());
+  auto& passes = config.pass_builder()->AllPasses();
+  EXPECT_EQ(std::count(passes.begin(), passes.end(), "fc_fuse_pass"), 0);
+  EXPECT_EQ(std::count(passes.begin(), passes.end(), "conv_bn_fuse_pass"), 0);
+
+  EXPECT_ANY_THROW(TuningCandidate::DeserializeFromString("unknown 1\n"));
+  EXPECT_ANY_THROW(TuningCandidate::DeserializeFromString("ir_optim\n"));
+}
+
+static PaddleTensor FloatTensor(const std::vector<float>& values) {
+  PaddleTensor tensor;
+  tensor.name = "out";
+  tensor.shape = {static_cast<int>(values.size())};
+  tensor.dtype = PaddleDType::FLOAT32;
+  tensor.data.Resize(values.size() * sizeof(float));
+  std::copy(values.begin(), values.end(),
+            static_cast<float*>(tensor.data.data()));
+  return tensor;
+}
+
+TEST(ConfigTuner, max_diff) {
+  bool passed;
+  std::vector<PaddleTensor> baseline{FloatTensor({1.f, 100.f, -2.f})};
+  float diff = ConfigTuner::MaxDiff({FloatTensor({1.0005f, 100.05f, -2.f})},
+                                    baseline, 1e-3f, &passed);
+  EXPECT_TRUE(passed);
+  EXPECT_NEAR(diff, 0.05f, 1e-4f);
+
+  ConfigTuner::MaxDiff({FloatTensor({1.01f, 100.f, -2.f})}, baseline, 1e-3f,
+                       &passed);
+  EXPECT_FALSE(passed);
+  // the shapes must match
+  ConfigTuner::MaxDiff({FloatTensor({1.f, 100.f})}, baseline, 1e-3f, &passed);
+  EXPECT_FALSE(passed);
+  ConfigTuner::MaxDiff({}, baseline, 1e-3f, &passed);
+  EXPECT_FALSE(passed);
+}
+
+}  // namespace inference
+}  // namespace paddle
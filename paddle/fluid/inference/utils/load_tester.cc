@@ -0,0 +1,220 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/inference/utils/load_tester.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <numeric>
+#include <sstream>
+#include <thread>  // NOLINT
+#include "paddle/fluid/inference/utils/io_utils.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace inference {
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double ElapsedMs(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+std::string LoadTestReport::SerializeToString() const {
+  std::stringstream ss;
+  ss << "{\"name\": \"" << name << "\", \"num_threads\": " << num_threads
+     << ", \"target_qps\": " << target_qps << ", \"queries\": " << queries
+     << ", \"errors\": " << errors << ", \"duration_s\": " << duration_s
+     << ", \"qps\": " << qps << ", \"latency_ms\": {\"mean\": " << mean
+     << ", \"p50\": " << p50 << ", \"p90\": " << p90 << ", \"p95\": " << p95
+     << ", \"p99\": " << p99 << ", \"p999\": " << p999 << ", \"max\": " << max
+     << "}}";
+  return ss.str();
+}
+
+void LoadTestReport::PersistToFile(const std::string &path) const {
+  std::ofstream file(path, std::ios::app);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Can not open %s to add the load test report.", path));
+  file << SerializeToString() << "\n";
+}
+
+LoadTester::LoadTester(PaddlePredictor *predictor,
+                       const std::vector<std::vector<PaddleTensor>> &samples,
+                       const LoadTestOptions &options)
+    : predictor_(predictor), samples_(samples), options_(options) {
+  PADDLE_ENFORCE_NOT_NULL(predictor_,
+                          platform::errors::InvalidArgument(
+                              "The predictor of the load test is null."));
+  PADDLE_ENFORCE_EQ(samples_.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The samples of the load test are empty."));
+  PADDLE_ENFORCE_GT(options_.num_threads, 0,
+                    platform::errors::InvalidArgument(
+                        "The num_threads of the load test should be positive, "
+                        "but got %d.",
+                        options_.num_threads));
+  PADDLE_ENFORCE_GE(options_.target_qps, 0.,
+                    platform::errors::InvalidArgument(
+                        "The target_qps of the load test should not be "
+                        "negative, but got %f.",
+                        options_.target_qps));
+}
+
+double LoadTester::Percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) return 0.;
+  auto rank = static_cast<int64_t>(std::ceil(p / 100. * sorted.size()));
+  rank = std::min<int64_t>(std::max<int64_t>(rank, 1), sorted.size());
+  return sorted[rank - 1];
+}
+
+std::vector<std::vector<PaddleTensor>> LoadTester::LoadSamples(
+    const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Can not open the samples of the load test %s.", path));
+  std::vector<std::vector<PaddleTensor>> samples;
+  while (file.peek() != EOF) {
+    samples.emplace_back();
+    DeserializePDTensorsToStream(file, &samples.back());
+  }
+  PADDLE_ENFORCE_EQ(samples.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "There are no samples in %s.", path));
+  return samples;
+}
+
+LoadTestReport LoadTester::Run(const std::string &name) {
+  const int num_threads = options_.num_threads;
+  // the clones share the parameters, and are created before the threads
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors;
+  for (int t = 0; t < num_threads; ++t) {
+    predictors.emplace_back(predictor_->Clone());
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  int warmed_up = 0;
+  Clock::time_point start;
+  std::atomic<int64_t> next_query{0};
+  std::atomic<int64_t> errors{0};
+  std::vector<std::vector<double>> latencies(num_threads);
+  std::vector<Clock::time_point> ends(num_threads);
+
+  auto run_query = [&](PaddlePredictor *predictor, int64_t query,
+                       std::vector<PaddleTensor> *outputs) {
+    try {
+      return predictor->Run(samples_[query % samples_.size()], outputs);
+    } catch (const std::exception &e) {
+      LOG(WARNING) << "The query " << query << " failed: " << e.what();
+      return false;
+    }
+  };
+
+  auto worker = [&](int t) {
+    auto *predictor = predictors[t].get();
+    std::vector<PaddleTensor> outputs;
+    for (int i = 0; i < options_.warmup; ++i) {
+      run_query(predictor, i, &outputs);
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (++warmed_up == num_threads) {
+        start = Clock::now();
+        cv.notify_all();
+      } else {
+        cv.wait(lock, [&] { return warmed_up == num_threads; });
+      }
+    }
+
+    auto &thread_latencies = latencies[t];
+    if (options_.target_qps > 0.) {
+      // the schedule of the open loop, each thread issues every num_threads-th
+      // query
+      for (int64_t query = t; query < options_.num_queries;
+           query += num_threads) {
+        auto scheduled =
+            start + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(query /
+                                                      options_.target_qps));
+        std::this_thread::sleep_until(scheduled);
+        if (run_query(predictor, query, &outputs)) {
+          thread_latencies.push_back(ElapsedMs(scheduled, Clock::now()));
+        } else {
+          ++errors;
+        }
+      }
+    } else {
+      for (int64_t query = next_query++; query < options_.num_queries;
+           query = next_query++) {
+        auto issued = Clock::now();
+        if (run_query(predictor, query, &outputs)) {
+          thread_latencies.push_back(ElapsedMs(issued, Clock::now()));
+        } else {
+          ++errors;
+        }
+      }
+    }
+    ends[t] = Clock::now();
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back(worker, t);
+  }
+  for (auto &thread : threads) thread.join();
+
+  std::vector<double> all;
+  for (auto &thread_latencies : latencies) {
+    all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  LoadTestReport report;
+  report.name = name;
+  report.num_threads = num_threads;
+  report.target_qps = options_.target_qps;
+  report.queries = all.size();
+  report.errors = errors;
+  report.duration_s =
+      ElapsedMs(start, *std::max_element(ends.begin(), ends.end())) / 1000.;
+  if (report.duration_s > 0.) report.qps = all.size() / report.duration_s;
+  if (!all.empty()) {
+    report.mean = std::accumulate(all.begin(), all.end(), 0.) / all.size();
+    report.max = all.back();
+  }
+  report.p50 = Percentile(all, 50.);
+  report.p90 = Percentile(all, 90.);
+  report.p95 = Percentile(all, 95.);
+  report.p99 = Percentile(all, 99.);
+  report.p999 = Percentile(all, 99.9);
+  VLOG(3) << "The load test " << name << ": " << report.SerializeToString();
+  return report;
+}
+
+}  // namespace inference
+}  // namespace paddle
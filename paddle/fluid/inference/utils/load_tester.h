@@ -0,0 +1,91 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_api.h"
+
+namespace paddle {
+namespace inference {
+
+struct LoadTestOptions {
+  // The threads issuing the queries, each with a clone of the predictor.
+  int num_threads{1};
+  // The target queries per second of all the threads. The queries are issued
+  // at the scheduled times regardless of the previous ones, i.e. in the open
+  // loop, and the latency includes the time waiting behind them. Zero for the
+  // closed loop, where each thread issues the next query once the previous
+  // one finishes.
+  double target_qps{0.};
+  // The queries per thread before the measurement.
+  int warmup{10};
+  // The queries of all the threads measured.
+  int num_queries{1000};
+};
+
+struct LoadTestReport {
+  std::string name;
+  int num_threads{0};
+  double target_qps{0.};
+  int64_t queries{0};
+  int64_t errors{0};
+  double duration_s{0.};
+  double qps{0.};
+  // the latency in ms
+  double mean{0.};
+  double p50{0.};
+  double p90{0.};
+  double p95{0.};
+  double p99{0.};
+  double p999{0.};
+  double max{0.};
+
+  // A JSON object in one line.
+  std::string SerializeToString() const;
+  // Append the line to the file.
+  void PersistToFile(const std::string& path) const;
+};
+
+/*
+ * The load test of a predictor with the concurrent threads, to size the
+ * capacity of a model and to compare the options of AnalysisConfig.
+ */
+class LoadTester {
+ public:
+  LoadTester(PaddlePredictor* predictor,
+             const std::vector<std::vector<PaddleTensor>>& samples,
+             const LoadTestOptions& options);
+
+  LoadTestReport Run(const std::string& name = "");
+
+  // The percentile, in [0, 100], of the sorted latencies, by the nearest
+  // rank.
+  static double Percentile(const std::vector<double>& sorted, double p);
+
+  // The samples serialized by SerializePDTensorsToStream one after another.
+  static std::vector<std::vector<PaddleTensor>> LoadSamples(
+      const std::string& path);
+
+ private:
+  PaddlePredictor* predictor_;
+  std::vector<std::vector<PaddleTensor>> samples_;
+  LoadTestOptions options_;
+};
+
+}  // namespace inference
+}  // namespace paddle
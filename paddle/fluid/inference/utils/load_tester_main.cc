@@ -0,0 +1,80 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// The load test of an inference model, e.g.
+//
+//   infer_load_tester --model_dir=./mobilenet --infer_data=./samples.bin \
+//       --num_threads=4 --qps=200 --num_queries=10000 --report=report.json
+//
+// which appends the report to report.json in one line. The samples are
+// serialized by SerializePDTensorsToStream one after another, and the options
+// tuned by ConfigTuner are applied by --tuned_config.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <iostream>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/utils/config_tuner.h"
+#include "paddle/fluid/inference/utils/load_tester.h"
+
+DEFINE_string(model_dir, "", "The directory of the model.");
+DEFINE_string(prog_file, "", "The program of the combined model.");
+DEFINE_string(params_file, "", "The parameters of the combined model.");
+DEFINE_string(infer_data, "", "The file of the samples.");
+DEFINE_string(tuned_config, "", "The options saved by SaveTunedConfig.");
+DEFINE_bool(use_gpu, false, "Whether to run on the GPU.");
+DEFINE_int32(gpu_id, 0, "The GPU to run on.");
+DEFINE_bool(use_mkldnn, false, "Whether to use MKLDNN.");
+DEFINE_int32(cpu_math_threads, 1, "The math library threads per predictor.");
+DEFINE_int32(num_threads, 1, "The threads issuing the queries.");
+DEFINE_double(qps, 0., "The target QPS of the open loop, 0 for closed loop.");
+DEFINE_int32(warmup, 10, "The queries per thread before the measurement.");
+DEFINE_int32(num_queries, 1000, "The queries measured.");
+DEFINE_string(name, "", "The name of the test in the report.");
+DEFINE_string(report, "", "The file to append the report to.");
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  paddle::AnalysisConfig config;
+  if (!FLAGS_model_dir.empty()) {
+    config.SetModel(FLAGS_model_dir);
+  } else {
+    config.SetModel(FLAGS_prog_file, FLAGS_params_file);
+  }
+  if (FLAGS_use_gpu) {
+    config.EnableUseGpu(100, FLAGS_gpu_id);
+  } else {
+    config.DisableGpu();
+    config.SetCpuMathLibraryNumThreads(FLAGS_cpu_math_threads);
+    if (FLAGS_use_mkldnn) config.EnableMKLDNN();
+  }
+  if (!FLAGS_tuned_config.empty()) {
+    paddle::inference::LoadTunedConfig(FLAGS_tuned_config, &config);
+  }
+  auto predictor = paddle::CreatePaddlePredictor(config);
+
+  paddle::inference::LoadTestOptions options;
+  options.num_threads = FLAGS_num_threads;
+  options.target_qps = FLAGS_qps;
+  options.warmup = FLAGS_warmup;
+  options.num_queries = FLAGS_num_queries;
+  paddle::inference::LoadTester tester(
+      predictor.get(),
+      paddle::inference::LoadTester::LoadSamples(FLAGS_infer_data), options);
+  auto report = tester.Run(FLAGS_name);
+  std::cout << report.SerializeToString() << std::endl;
+  if (!FLAGS_report.empty()) report.PersistToFile(FLAGS_report);
+  return 0;
+}
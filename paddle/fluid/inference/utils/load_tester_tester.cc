@@ -0,0 +1,102 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/inference/utils/load_tester.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace inference {
+
+// Sleeps 1ms per query, and fails the queries of the sample marked by a
+// negative batch size.
+class FakePredictor : public PaddlePredictor {
+ public:
+  explicit FakePredictor(std::atomic<int>* runs) : runs_(runs) {}
+
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* output_data,
+           int batch_size = -1) override {
+    ++(*runs_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return inputs.empty() || inputs[0].shape[0] > 0;
+  }
+
+  std::unique_ptr<PaddlePredictor> Clone() override {
+    return std::unique_ptr<PaddlePredictor>(new FakePredictor(runs_));
+  }
+
+ private:
+  std::atomic<int>* runs_;
+};
+
+static std::vector<PaddleTensor> Sample(int batch_size) {
+  PaddleTensor tensor;
+  tensor.shape = {batch_size};
+  return {tensor};
+}
+
+TEST(LoadTester, percentile) {
+  std::vector<double> sorted{1., 2., 3., 4., 5., 6., 7., 8., 9., 10.};
+  EXPECT_EQ(LoadTester::Percentile(sorted, 50.), 5.);
+  EXPECT_EQ(LoadTester::Percentile(sorted, 90.), 9.);
+  EXPECT_EQ(LoadTester::Percentile(sorted, 99.), 10.);
+  EXPECT_EQ(LoadTester::Percentile(sorted, 0.), 1.);
+  EXPECT_EQ(LoadTester::Percentile({}, 50.), 0.);
+}
+
+TEST(LoadTester, closed_loop) {
+  std::atomic<int> runs{0};
+  FakePredictor predictor(&runs);
+  LoadTestOptions options;
+  options.num_threads = 4;
+  options.warmup = 2;
+  options.num_queries = 40;
+  LoadTester tester(&predictor, {Sample(1), Sample(-1)}, options);
+  auto report = tester.Run("fake");
+  EXPECT_EQ(runs, 48);
+  EXPECT_EQ(report.queries, 20);
+  EXPECT_EQ(report.errors, 20);
+  EXPECT_GE(report.p50, 1.);
+  EXPECT_LE(report.p50, report.p99);
+  EXPECT_LE(report.p99, report.max);
+  EXPECT_GT(report.qps, 0.);
+  EXPECT_NE(report.SerializeToString().find("\"name\": \"fake\""),
+            std::string::npos);
+}
+
+TEST(LoadTester, open_loop) {
+  std::atomic<int> runs{0};
+  FakePredictor predictor(&runs);
+  LoadTestOptions options;
+  options.num_threads = 2;
+  options.target_qps = 200.;
+  options.warmup = 0;
+  options.num_queries = 20;
+  LoadTester tester(&predictor, {Sample(1)}, options);
+  auto report = tester.Run();
+  EXPECT_EQ(report.queries, 20);
+  EXPECT_EQ(report.errors, 0);
+  // the last query is scheduled at 95ms
+  EXPECT_GE(report.duration_s, 0.095);
+  EXPECT_LE(report.qps, 220.);
+}
+
+}  // namespace inference
+}  // namespace paddle
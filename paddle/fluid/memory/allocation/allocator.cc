@@ -20,6 +20,10 @@ namespace allocation {
 
 bool Allocator::IsAllocThreadSafe() const { return false; }
 
+bool Allocator::GetStats(AllocatorStats* stats) { return false; }
+
+size_t Allocator::Release() { return 0; }
+
 void Allocator::FreeImpl(Allocation* allocation) {
   Allocator* allocator = allocation->TopDecoratedAllocator();
   allocator->Free(allocation);
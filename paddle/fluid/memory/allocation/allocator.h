@@ -19,6 +19,7 @@
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/inlined_vector.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
 
@@ -180,6 +181,16 @@ class Allocator {
   // True if the `Allocate` is thread safe.
   virtual bool IsAllocThreadSafe() const;
 
+  // Get the statistics of this allocator. Returns false if the allocator
+  // does not record any statistics. The decorated allocators should forward
+  // it to the underlying allocator.
+  virtual bool GetStats(AllocatorStats* stats);
+
+  // Release the cached memory of this allocator back to the underlying
+  // allocator or system, and returns the released bytes. The decorated
+  // allocators should forward it to the underlying allocator.
+  virtual size_t Release();
+
  protected:
   virtual Allocation* AllocateImpl(size_t size) = 0;
   virtual void FreeImpl(Allocation* allocation);
@@ -14,7 +14,9 @@
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include <gflags/gflags.h>
+#include <algorithm>
 #include <map>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -25,7 +27,11 @@
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include "paddle/fluid/memory/allocation/locked_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
+#include "paddle/fluid/memory/allocation/registered_memory_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
@@ -34,7 +40,11 @@
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
 #include "paddle/fluid/memory/allocation/thread_local_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/cuda_graph.h"
 #include "paddle/fluid/platform/gpu_info.h"
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include "paddle/fluid/memory/allocation/cuda_virtual_mem_allocator.h"
+#endif
 #endif
 
 DEFINE_int64(
@@ -46,10 +56,23 @@ DEFINE_bool(use_system_allocator, false,
             "Whether to use system allocator to allocate CPU and GPU memory. "
             "Only used for unittests.");
 
+DECLARE_bool(use_virtual_memory_auto_growth);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
 
+#ifdef PADDLE_WITH_CUDA
+// The non-default stream which the allocations of the calling thread on
+// CUDAPlace(device) are used on, set by AllocatorFacade::SetThreadStream.
+struct ThreadStream {
+  int device{-1};
+  cudaStream_t stream{nullptr};
+};
+
+static thread_local ThreadStream thread_stream;
+#endif
+
 class AllocatorFacadePrivate {
  public:
   using AllocatorMap = std::map<platform::Place, std::shared_ptr<Allocator>>;
@@ -58,7 +81,7 @@ class AllocatorFacadePrivate {
     auto strategy = GetAllocatorStrategy();
     switch (strategy) {
       case AllocatorStrategy::kNaiveBestFit: {
-        InitNaiveBestFitCPUAllocator();
+        InitCPUAllocator();
 #ifdef PADDLE_WITH_CUDA
         for (int dev_id = 0; dev_id < platform::GetCUDADeviceCount();
              ++dev_id) {
@@ -70,7 +93,7 @@ class AllocatorFacadePrivate {
       }
 
       case AllocatorStrategy::kAutoGrowth: {
-        InitNaiveBestFitCPUAllocator();
+        InitCPUAllocator();
 #ifdef PADDLE_WITH_CUDA
         for (int dev_id = 0; dev_id < platform::GetCUDADeviceCount();
              ++dev_id) {
@@ -82,7 +105,7 @@ class AllocatorFacadePrivate {
       }
 
       case AllocatorStrategy::kThreadLocal: {
-        InitNaiveBestFitCPUAllocator();
+        InitCPUAllocator();
 #ifdef PADDLE_WITH_CUDA
         for (int dev_id = 0; dev_id < platform::GetCUDADeviceCount();
              ++dev_id) {
@@ -110,6 +133,19 @@ class AllocatorFacadePrivate {
 
   inline const std::shared_ptr<Allocator>& GetAllocator(
       const platform::Place& place, size_t size) {
+#ifdef PADDLE_WITH_CUDA
+    if (UNLIKELY(platform::CUDAGraph::IsThisThreadCapturing()) && size > 0 &&
+        !FLAGS_use_system_allocator && platform::is_gpu_place(place)) {
+      return GetCUDAGraphAllocator(BOOST_GET_CONST(platform::CUDAPlace, place));
+    }
+    if (UNLIKELY(thread_stream.stream != nullptr) && size > 0 &&
+        !FLAGS_use_system_allocator && platform::is_gpu_place(place) &&
+        BOOST_GET_CONST(platform::CUDAPlace, place).device ==
+            thread_stream.device) {
+      return GetStreamAllocator(BOOST_GET_CONST(platform::CUDAPlace, place),
+                                thread_stream.stream);
+    }
+#endif
     const auto& allocators =
         (size > 0 ? (UNLIKELY(FLAGS_use_system_allocator) ? system_allocators_
                                                           : allocators_)
@@ -120,6 +156,88 @@ class AllocatorFacadePrivate {
     return iter->second;
   }
 
+#ifdef PADDLE_WITH_CUDA
+  // Returns the allocator of the non-default `stream` on `place`. It is
+  // created lazily since the streams are only known at runtime.
+  const std::shared_ptr<Allocator>& GetStreamAllocator(
+      const platform::CUDAPlace& place, cudaStream_t stream) {
+    auto iter = auto_growth_cuda_allocators_.find(place);
+    PADDLE_ENFORCE_EQ(
+        iter != auto_growth_cuda_allocators_.end(), true,
+        platform::errors::Unimplemented(
+            "Allocating memory on the non-default stream is only supported "
+            "when FLAGS_allocator_strategy=auto_growth, no such allocator "
+            "for CUDAPlace(%d)",
+            place.device));
+
+    std::lock_guard<std::mutex> guard(stream_allocators_mtx_);
+    auto& allocator = stream_allocators_[std::make_pair(place.device, stream)];
+    if (allocator == nullptr) {
+      allocator = std::make_shared<AutoGrowthBestFitStreamAllocator>(
+          iter->second, stream);
+      if (FLAGS_gpu_allocator_retry_time > 0) {
+        allocator = std::make_shared<RetryAllocator>(
+            allocator, FLAGS_gpu_allocator_retry_time);
+      }
+    }
+    return allocator;
+  }
+
+  // Returns the memory pool of the CUDA Graph being captured by the current
+  // thread. The memory freed while capturing is only reused by the graph,
+  // and the pool is released after the graph is reset and all of its
+  // allocations are freed.
+  const std::shared_ptr<Allocator>& GetCUDAGraphAllocator(
+      const platform::CUDAPlace& place) {
+    PADDLE_ENFORCE_EQ(
+        platform::CUDAGraph::CapturingPlace().device, place.device,
+        platform::errors::Unimplemented(
+            "Allocating memory on CUDAPlace(%d) while capturing a CUDA Graph "
+            "on CUDAPlace(%d) is not supported.",
+            place.device, platform::CUDAGraph::CapturingPlace().device));
+    auto id = platform::CUDAGraph::CapturingID();
+    std::lock_guard<std::mutex> guard(cuda_graph_allocators_mtx_);
+    auto& allocator = cuda_graph_allocators_[id];
+    if (allocator == nullptr) {
+      // No synchronization is allowed while capturing, so the pool never
+      // compacts itself.
+      allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+          std::make_shared<CUDAAllocator>(place), platform::GpuMinChunkSize());
+      platform::CUDAGraph::AddResetCallbackDuringCapturing(
+          [this, id] { RemoveCUDAGraphAllocator(id); });
+      VLOG(3) << "Create the memory pool of CUDA Graph " << id;
+    }
+    return allocator;
+  }
+
+  void RemoveCUDAGraphAllocator(int64_t id) {
+    std::lock_guard<std::mutex> guard(cuda_graph_allocators_mtx_);
+    auto iter = cuda_graph_allocators_.find(id);
+    if (iter == cuda_graph_allocators_.end()) return;
+    // The allocations which are still alive, e.g. held by the tensors in the
+    // scope, refer to the allocator, so it is kept until they are freed.
+    retired_cuda_graph_allocators_.emplace_back(std::move(iter->second));
+    cuda_graph_allocators_.erase(iter);
+    auto unused = [](const std::shared_ptr<Allocator>& allocator) {
+      AllocatorStats stats;
+      return allocator->GetStats(&stats) && stats.allocated_bytes == 0;
+    };
+    retired_cuda_graph_allocators_.erase(
+        std::remove_if(retired_cuda_graph_allocators_.begin(),
+                       retired_cuda_graph_allocators_.end(), unused),
+        retired_cuda_graph_allocators_.end());
+  }
+
+  void RecordStream(Allocation* allocation, cudaStream_t stream) {
+    if (!platform::is_gpu_place(allocation->place())) return;
+    auto iter = auto_growth_cuda_allocators_.find(
+        BOOST_GET_CONST(platform::CUDAPlace, allocation->place()));
+    if (iter != auto_growth_cuda_allocators_.end()) {
+      iter->second->RecordStream(allocation, stream);
+    }
+  }
+#endif
+
  private:
   void InitSystemAllocators() {
     system_allocators_[platform::CPUPlace()] = std::make_shared<CPUAllocator>();
@@ -134,11 +252,56 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  void InitCPUAllocator() {
+    switch (GetCPUAllocatorStrategy()) {
+      case CPUAllocatorStrategy::kNaiveBestFit: {
+        InitNaiveBestFitCPUAllocator();
+        break;
+      }
+      case CPUAllocatorStrategy::kSlab: {
+        InitSlabCPUAllocator();
+        break;
+      }
+      case CPUAllocatorStrategy::kNuma: {
+        InitNumaCPUAllocator();
+        break;
+      }
+      case CPUAllocatorStrategy::kRegistered: {
+        InitRegisteredCPUAllocator();
+        break;
+      }
+    }
+  }
+
   void InitNaiveBestFitCPUAllocator() {
     allocators_[platform::CPUPlace()] =
         std::make_shared<NaiveBestFitAllocator>(platform::CPUPlace());
   }
 
+  void InitSlabCPUAllocator() {
+    allocators_[platform::CPUPlace()] = std::make_shared<SlabAllocator>(
+        std::make_shared<CPUAllocator>(), platform::CPUPlace());
+  }
+
+  void InitNumaCPUAllocator() {
+    std::vector<std::shared_ptr<Allocator>> node_allocators;
+    for (int node = 0; node < platform::GetNumaNodeCount(); ++node) {
+      node_allocators.emplace_back(
+          std::make_shared<AutoGrowthBestFitAllocator>(
+              std::make_shared<CPUAllocator>(node), CPUAllocator::kAlignment));
+    }
+    allocators_[platform::CPUPlace()] =
+        std::make_shared<NumaAllocator>(std::move(node_allocators));
+  }
+
+  void InitRegisteredCPUAllocator() {
+    allocators_[platform::CPUPlace()] =
+        std::make_shared<AutoGrowthBestFitAllocator>(
+            std::make_shared<RegisteredMemoryAllocator>(
+                std::make_shared<CPUAllocator>()),
+            CPUAllocator::kAlignment, RegisteredMemoryAllocator::kChunkSize);
+  }
+
 #ifdef PADDLE_WITH_CUDA
   void InitNaiveBestFitCUDAPinnedAllocator() {
     allocators_[platform::CUDAPinnedPlace()] =
@@ -154,9 +317,34 @@ class AllocatorFacadePrivate {
   }
 
   void InitAutoGrowthCUDAAllocator(platform::CUDAPlace p) {
-    auto cuda_allocator = std::make_shared<CUDAAllocator>(p);
-    allocators_[p] = std::make_shared<AutoGrowthBestFitAllocator>(
-        cuda_allocator, platform::GpuMinChunkSize());
+    auto synchronize = [p] {
+      platform::CUDADeviceGuard guard(p.device);
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaDeviceSynchronize());
+    };
+    std::shared_ptr<AutoGrowthBestFitAllocator> allocator;
+#if !defined(_WIN32) && !defined(__APPLE__)
+    if (FLAGS_use_virtual_memory_auto_growth) {
+      if (CUDAVirtualMemAllocator::IsSupported(p)) {
+        auto vmm_allocator = std::make_shared<CUDAVirtualMemAllocator>(p);
+        allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+            vmm_allocator, platform::GpuMinChunkSize(),
+            vmm_allocator->granularity(), synchronize,
+            /*grow_in_place=*/true);
+      } else {
+        LOG(WARNING) << "CUDAPlace(" << p.device << ") does not support "
+                     << "virtual memory management, "
+                     << "FLAGS_use_virtual_memory_auto_growth is ignored.";
+      }
+    }
+#endif
+    if (allocator == nullptr) {
+      auto cuda_allocator = std::make_shared<CUDAAllocator>(p);
+      allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+          cuda_allocator, platform::GpuMinChunkSize(), /*chunk_size=*/0,
+          synchronize);
+    }
+    auto_growth_cuda_allocators_[p] = allocator;
+    allocators_[p] = allocator;
   }
 #endif
 
@@ -220,6 +408,17 @@ class AllocatorFacadePrivate {
   AllocatorMap allocators_;
   AllocatorMap zero_size_allocators_;
   AllocatorMap system_allocators_;
+
+#ifdef PADDLE_WITH_CUDA
+  std::map<platform::CUDAPlace, std::shared_ptr<AutoGrowthBestFitAllocator>>
+      auto_growth_cuda_allocators_;
+  std::map<std::pair<int, cudaStream_t>, std::shared_ptr<Allocator>>
+      stream_allocators_;
+  std::mutex stream_allocators_mtx_;
+  std::map<int64_t, std::shared_ptr<Allocator>> cuda_graph_allocators_;
+  std::vector<std::shared_ptr<Allocator>> retired_cuda_graph_allocators_;
+  std::mutex cuda_graph_allocators_mtx_;
+#endif
 };
 
 // Pimpl. Make interface clean.
@@ -243,6 +442,38 @@ AllocationPtr AllocatorFacade::Alloc(const platform::Place& place,
   return m_->GetAllocator(place, size)->Allocate(size);
 }
 
+bool AllocatorFacade::GetStats(const platform::Place& place,
+                               AllocatorStats* stats) {
+  if (UNLIKELY(FLAGS_use_system_allocator)) return false;
+  return m_->GetAllocator(place, /*size=*/1)->GetStats(stats);
+}
+
+size_t AllocatorFacade::Release(const platform::Place& place) {
+  if (UNLIKELY(FLAGS_use_system_allocator)) return 0;
+  return m_->GetAllocator(place, /*size=*/1)->Release();
+}
+
+#ifdef PADDLE_WITH_CUDA
+AllocationPtr AllocatorFacade::Alloc(const platform::CUDAPlace& place,
+                                     size_t size, cudaStream_t stream) {
+  if (size == 0 || UNLIKELY(FLAGS_use_system_allocator)) {
+    return Alloc(place, size);
+  }
+  return m_->GetStreamAllocator(place, stream)->Allocate(size);
+}
+
+void AllocatorFacade::RecordStream(Allocation* allocation,
+                                   cudaStream_t stream) {
+  m_->RecordStream(allocation, stream);
+}
+
+void AllocatorFacade::SetThreadStream(const platform::CUDAPlace& place,
+                                      cudaStream_t stream) {
+  thread_stream.device = place.device;
+  thread_stream.stream = stream;
+}
+#endif
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #pragma once
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
 #include <memory>
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/platform/place.h"
@@ -44,6 +47,35 @@ class AllocatorFacade {
   // Allocate a unique allocation.
   AllocationPtr Alloc(const platform::Place& place, size_t size);
 
+  // Get the statistics of the allocator of `place`. Returns false if the
+  // allocator of `place` does not record statistics, i.e., when
+  // FLAGS_use_system_allocator=true.
+  bool GetStats(const platform::Place& place, AllocatorStats* stats);
+
+  // Release the cached memory of the allocator of `place`, and returns the
+  // released bytes. Only the allocators which cache memory in chunks, i.e.,
+  // FLAGS_allocator_strategy=auto_growth, release any memory.
+  size_t Release(const platform::Place& place);
+
+#ifdef PADDLE_WITH_CUDA
+  // Allocate a unique allocation used on the non-default `stream`. The freed
+  // memory would only be reused on the same `stream`, so that no
+  // synchronization is needed. Only works when
+  // FLAGS_allocator_strategy=auto_growth.
+  AllocationPtr Alloc(const platform::CUDAPlace& place, size_t size,
+                      cudaStream_t stream);
+
+  // Record that `allocation` is used on `stream`, so that its memory would be
+  // reused on `stream` after it is freed. nullptr means the default stream.
+  void RecordStream(Allocation* allocation, cudaStream_t stream);
+
+  // Let the allocations of the calling thread on `place` be used on the
+  // non-default `stream`, as if they are allocated by Alloc(place, size,
+  // stream), until it is reset by nullptr. Only works when
+  // FLAGS_allocator_strategy=auto_growth.
+  void SetThreadStream(const platform::CUDAPlace& place, cudaStream_t stream);
+#endif
+
   // TODO(yy): Allocate a Copy-On-Write allocation?
  private:
   AllocatorFacade();
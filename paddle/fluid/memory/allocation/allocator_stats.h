@@ -0,0 +1,81 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * AllocatorStats is the statistics of an allocator.
+ *
+ * - allocated_bytes: the bytes held by the living allocations.
+ * - peak_allocated_bytes: the maximum of allocated_bytes in history.
+ * - reserved_bytes: the bytes the allocator holds from the underlying
+ *   allocator or system, including both allocated and cached memory.
+ * - largest_free_chunk_bytes: the largest cached chunk which can be used
+ *   without allocating from the underlying allocator or system.
+ * - alloc_counts[i]: the number of allocation requests whose size is in
+ *   [2^i, 2^(i+1)) bytes.
+ */
+struct AllocatorStats {
+  static constexpr size_t kNumSizeBuckets = sizeof(size_t) * 8;
+
+  size_t allocated_bytes{0};
+  size_t peak_allocated_bytes{0};
+  size_t reserved_bytes{0};
+  size_t largest_free_chunk_bytes{0};
+  std::array<uint64_t, kNumSizeBuckets> alloc_counts{};
+
+  // The fraction of the cached memory which cannot be used by the largest
+  // allocation request, i.e., 1 - largest_free_chunk / cached_bytes.
+  // 0 means no fragmentation.
+  double FragmentationRatio() const {
+    size_t cached_bytes =
+        reserved_bytes > allocated_bytes ? reserved_bytes - allocated_bytes : 0;
+    if (cached_bytes == 0) return 0.0;
+    return 1.0 - static_cast<double>(std::min(largest_free_chunk_bytes,
+                                              cached_bytes)) /
+                     static_cast<double>(cached_bytes);
+  }
+
+  static size_t SizeBucketIndex(size_t size) {
+    size_t index = 0;
+    while (size > 1) {
+      size >>= 1;
+      ++index;
+    }
+    return index;
+  }
+
+  // The following methods are not thread-safe. They should be called inside
+  // the lock of the allocator.
+  void RecordAllocate(size_t size) {
+    allocated_bytes += size;
+    peak_allocated_bytes = std::max(peak_allocated_bytes, allocated_bytes);
+    ++alloc_counts[SizeBucketIndex(size)];
+  }
+
+  void RecordFree(size_t size) { allocated_bytes -= size; }
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -18,6 +18,7 @@
 #include "paddle/fluid/platform/enforce.h"
 
 DECLARE_string(allocator_strategy);
+DECLARE_string(cpu_allocator_strategy);
 
 namespace paddle {
 namespace memory {
@@ -44,6 +45,40 @@ AllocatorStrategy GetAllocatorStrategy() {
   return strategy;
 }
 
+static CPUAllocatorStrategy GetCPUStrategyFromFlag() {
+  if (FLAGS_cpu_allocator_strategy == "naive_best_fit") {
+    return CPUAllocatorStrategy::kNaiveBestFit;
+  }
+
+  if (FLAGS_cpu_allocator_strategy == "slab") {
+    return CPUAllocatorStrategy::kSlab;
+  }
+
+  if (FLAGS_cpu_allocator_strategy == "numa") {
+    return CPUAllocatorStrategy::kNuma;
+  }
+
+  if (FLAGS_cpu_allocator_strategy == "registered") {
+#ifdef PADDLE_WITH_BRPC_RDMA
+    return CPUAllocatorStrategy::kRegistered;
+#else
+    // Only the RDMA transport of bRPC registers the chunks as memory
+    // regions, gRPC and the plain bRPC transport have no such hook.
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "CPU allocator strategy registered is only supported when "
+        "compiled with WITH_BRPC_RDMA=ON."));
+#endif
+  }
+
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "Unsupported CPU allocator strategy: %s", FLAGS_cpu_allocator_strategy));
+}
+
+CPUAllocatorStrategy GetCPUAllocatorStrategy() {
+  static CPUAllocatorStrategy strategy = GetCPUStrategyFromFlag();
+  return strategy;
+}
+
 void UseAllocatorStrategyGFlag() {}
 }  // namespace allocation
 }  // namespace memory
@@ -22,6 +22,10 @@ enum class AllocatorStrategy { kNaiveBestFit, kAutoGrowth, kThreadLocal };
 
 extern AllocatorStrategy GetAllocatorStrategy();
 
+enum class CPUAllocatorStrategy { kNaiveBestFit, kSlab, kNuma, kRegistered };
+
+extern CPUAllocatorStrategy GetCPUAllocatorStrategy();
+
 // Do nothing, just make sure linker do not prune this file.
 extern void UseAllocatorStrategyGFlag();
 
@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
 
 DEFINE_bool(free_idle_chunk, false,
@@ -33,86 +34,150 @@ DEFINE_bool(free_when_no_cache_hit, false,
             "chunk would be freed when out of memory occurs. This flag "
             "only works when FLAGS_allocator_strategy=auto_growth.");
 
+DEFINE_bool(compact_when_oom, false,
+            "Whether to compact the allocator when out of memory occurs. If "
+            "true, all the streams would be synchronized, and the adjacent "
+            "free blocks would be merged and the idle chunks would be freed "
+            "before retrying the allocation. This flag only works when "
+            "FLAGS_allocator_strategy=auto_growth.");
+
 namespace paddle {
 namespace memory {
 namespace allocation {
 
 AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator(
     const std::shared_ptr<Allocator> &underlying_allocator, size_t alignment,
-    size_t chunk_size)
+    size_t chunk_size, std::function<void()> synchronize, bool grow_in_place)
     : underlying_allocator_(
-          std::make_shared<AlignedAllocator>(underlying_allocator, alignment)),
+          grow_in_place ? underlying_allocator
+                        : std::make_shared<AlignedAllocator>(
+                              underlying_allocator, alignment)),
       alignment_(alignment),
-      chunk_size_(std::max(AlignedSize(chunk_size, alignment), alignment)) {}
+      chunk_size_(std::max(AlignedSize(chunk_size, alignment), alignment)),
+      synchronize_(std::move(synchronize)),
+      grow_in_place_(grow_in_place) {}
 
 Allocation *AutoGrowthBestFitAllocator::AllocateImpl(size_t size) {
+  return AllocateImpl(size, nullptr);
+}
+
+Allocation *AutoGrowthBestFitAllocator::AllocateImpl(size_t size,
+                                                     Stream stream) {
   size = AlignedSize(size, alignment_);
 
   std::lock_guard<std::mutex> guard(mtx_);
-  auto iter = free_blocks_.lower_bound(std::make_pair(size, nullptr));
-  BlockIt block_it;
-  if (iter != free_blocks_.end()) {
-    block_it = iter->second;
-    free_blocks_.erase(iter);
-    auto *chunk = block_it->chunk_;
-    size_t remaining_size = block_it->size_ - size;
-    if (remaining_size == 0) {
-      block_it->is_free_ = false;
-    } else {
-      auto remaining_free_block = chunk->blocks_.insert(
-          block_it, Block(block_it->ptr_, remaining_size, true, chunk));
-      free_blocks_.emplace(std::make_pair(remaining_size, block_it->ptr_),
-                           remaining_free_block);
-      block_it->ptr_ =
-          reinterpret_cast<uint8_t *>(block_it->ptr_) + remaining_size;
-      block_it->size_ = size;
-      block_it->is_free_ = false;
-    }
-  } else {
+  auto &free_blocks = free_blocks_[stream];
+  auto iter = free_blocks.lower_bound(std::make_pair(size, nullptr));
+  if (iter == free_blocks.end()) {
     if (FLAGS_free_when_no_cache_hit) {
       FreeIdleChunks();
     }
     size_t realloc_size = std::max(size, chunk_size_);
 
     try {
-      chunks_.emplace_back(underlying_allocator_->Allocate(realloc_size));
+      iter = AllocateChunk(realloc_size, stream);
     } catch (BadAlloc &ex) {
-      if (FLAGS_free_when_no_cache_hit) throw ex;
-      FreeIdleChunks();
-      chunks_.emplace_back(underlying_allocator_->Allocate(realloc_size));
+      if (FLAGS_compact_when_oom) {
+        size_t released_size = Compact(stream);
+        VLOG(1) << "Out of memory when allocating " << realloc_size
+                << " bytes, compact and release " << released_size
+                << " bytes";
+        iter = free_blocks.lower_bound(std::make_pair(size, nullptr));
+      } else {
+        if (FLAGS_free_when_no_cache_hit) throw ex;
+        FreeIdleChunks();
+      }
+      if (iter == free_blocks.end()) {
+        iter = AllocateChunk(realloc_size, stream);
+      }
     }
+  }
+  auto block_it = SplitFreeBlock(iter, size, stream);
+  stats_.RecordAllocate(size);
+  return new BlockAllocation(block_it);
+}
+
+AutoGrowthBestFitAllocator::FreeBlocks::iterator
+AutoGrowthBestFitAllocator::AllocateChunk(size_t size, Stream stream) {
+  auto allocation = underlying_allocator_->Allocate(size);
+  size = allocation->size();
+  auto *p = allocation->ptr();
+  stats_.reserved_bytes += size;
+  auto &free_blocks = free_blocks_[stream];
 
-    auto *chunk = &(*chunks_.rbegin());
-    realloc_size = chunk->allocation_->size();
-    uint8_t *p = reinterpret_cast<uint8_t *>(chunk->allocation_->ptr());
-    auto &blocks = chunk->blocks_;
+  Chunk *chunk = nullptr;
+  if (grow_in_place_) {
+    PADDLE_ENFORCE_EQ(AlignedPtrOffset(p, alignment_), 0,
+                      platform::errors::InvalidArgument(
+                          "The underlying allocator must return aligned "
+                          "memory when growing chunks in place."));
+    auto chunk_it = std::find_if(chunks_.begin(), chunks_.end(),
+                                 [p](const Chunk &c) { return c.end() == p; });
+    if (chunk_it != chunks_.end()) chunk = &(*chunk_it);
+  }
 
-    size_t remaining_size = realloc_size - size;
-    if (remaining_size > 0) {
-      blocks.emplace_back(p, remaining_size, true, chunk);
-      free_blocks_.emplace(std::make_pair(remaining_size, p), --(blocks.end()));
+  if (chunk == nullptr) {
+    VLOG(2) << "Not found and reallocate " << size;
+    chunks_.emplace_back(std::move(allocation));
+    chunk = &(*chunks_.rbegin());
+  } else {
+    VLOG(2) << "Not found and grow the chunk in place by " << size;
+    chunk->allocations_.emplace_back(std::move(allocation));
+    chunk->size_ += size;
+    auto last_it = --(chunk->blocks_.end());
+    if (last_it->is_free_ && last_it->stream_ == stream) {
+      free_blocks.erase(std::make_pair(last_it->size_, last_it->ptr_));
+      last_it->size_ += size;
+      return free_blocks
+          .emplace(std::make_pair(last_it->size_, last_it->ptr_), last_it)
+          .first;
     }
-    blocks.emplace_back(p + remaining_size, size, false, chunk);
-    block_it = --(blocks.end());
-    VLOG(2) << "Not found and reallocate " << realloc_size << ", and remaining "
-            << remaining_size;
   }
-  return new BlockAllocation(block_it);
+
+  auto &blocks = chunk->blocks_;
+  blocks.emplace_back(p, size, true, chunk, stream);
+  return free_blocks.emplace(std::make_pair(size, p), --(blocks.end())).first;
+}
+
+// The block is allocated from the end of the free block, and the remaining
+// part is kept in the free list.
+AutoGrowthBestFitAllocator::BlockIt AutoGrowthBestFitAllocator::SplitFreeBlock(
+    FreeBlocks::iterator iter, size_t size, Stream stream) {
+  auto &free_blocks = free_blocks_[stream];
+  auto block_it = iter->second;
+  free_blocks.erase(iter);
+  auto *chunk = block_it->chunk_;
+  size_t remaining_size = block_it->size_ - size;
+  if (remaining_size > 0) {
+    auto remaining_free_block = chunk->blocks_.insert(
+        block_it, Block(block_it->ptr_, remaining_size, true, chunk, stream));
+    free_blocks.emplace(std::make_pair(remaining_size, block_it->ptr_),
+                        remaining_free_block);
+    block_it->ptr_ =
+        reinterpret_cast<uint8_t *>(block_it->ptr_) + remaining_size;
+    block_it->size_ = size;
+  }
+  block_it->is_free_ = false;
+  return block_it;
 }
 
 void AutoGrowthBestFitAllocator::FreeImpl(Allocation *allocation) {
   std::lock_guard<std::mutex> guard(mtx_);
   auto block_it = static_cast<BlockAllocation *>(allocation)->block_it_;
   auto &blocks = block_it->chunk_->blocks_;
+  auto &free_blocks = free_blocks_[block_it->stream_];
 
   block_it->is_free_ = true;
+  stats_.RecordFree(block_it->size_);
 
+  // Only merge with the neighbour blocks freed on the same stream, otherwise
+  // the merged block may be reused before the other stream finishes.
   if (block_it != blocks.begin()) {
     auto prev_it = block_it;
     --prev_it;
 
-    if (prev_it->is_free_) {
-      free_blocks_.erase(std::make_pair(prev_it->size_, prev_it->ptr_));
+    if (prev_it->is_free_ && prev_it->stream_ == block_it->stream_) {
+      free_blocks.erase(std::make_pair(prev_it->size_, prev_it->ptr_));
       prev_it->size_ += block_it->size_;
       blocks.erase(block_it);
       block_it = prev_it;
@@ -122,14 +187,15 @@ void AutoGrowthBestFitAllocator::FreeImpl(Allocation *allocation) {
   auto next_it = block_it;
   ++next_it;
 
-  if (next_it != blocks.end() && next_it->is_free_) {
-    free_blocks_.erase(std::make_pair(next_it->size_, next_it->ptr_));
+  if (next_it != blocks.end() && next_it->is_free_ &&
+      next_it->stream_ == block_it->stream_) {
+    free_blocks.erase(std::make_pair(next_it->size_, next_it->ptr_));
     block_it->size_ += next_it->size_;
     blocks.erase(next_it);
   }
 
-  free_blocks_.emplace(std::make_pair(block_it->size_, block_it->ptr_),
-                       block_it);
+  free_blocks.emplace(std::make_pair(block_it->size_, block_it->ptr_),
+                      block_it);
 
   delete allocation;
 
@@ -138,13 +204,85 @@ void AutoGrowthBestFitAllocator::FreeImpl(Allocation *allocation) {
   }
 }
 
+void AutoGrowthBestFitAllocator::RecordStream(Allocation *allocation,
+                                              Stream stream) {
+  auto *block_allocation = dynamic_cast<BlockAllocation *>(allocation);
+  if (block_allocation == nullptr) return;
+  std::lock_guard<std::mutex> guard(mtx_);
+  block_allocation->block_it_->stream_ = stream;
+}
+
+bool AutoGrowthBestFitAllocator::GetStats(AllocatorStats *stats) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  *stats = stats_;
+  stats->largest_free_chunk_bytes = 0;
+  for (auto &pair : free_blocks_) {
+    if (!pair.second.empty()) {
+      stats->largest_free_chunk_bytes = std::max(
+          stats->largest_free_chunk_bytes, pair.second.rbegin()->first.first);
+    }
+  }
+  return true;
+}
+
+size_t AutoGrowthBestFitAllocator::Release() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return Compact(nullptr);
+}
+
+size_t AutoGrowthBestFitAllocator::Compact(Stream stream) {
+  if (synchronize_) {
+    synchronize_();
+  }
+
+  // All the streams have finished, so that the free blocks of different
+  // streams can be merged and reused on `stream`.
+  auto &free_blocks = free_blocks_[stream];
+  for (auto &chunk : chunks_) {
+    auto &blocks = chunk.blocks_;
+    for (auto block_it = blocks.begin(); block_it != blocks.end();) {
+      if (!block_it->is_free_) {
+        ++block_it;
+        continue;
+      }
+      free_blocks_[block_it->stream_].erase(
+          std::make_pair(block_it->size_, block_it->ptr_));
+      auto next_it = block_it;
+      ++next_it;
+      while (next_it != blocks.end() && next_it->is_free_) {
+        free_blocks_[next_it->stream_].erase(
+            std::make_pair(next_it->size_, next_it->ptr_));
+        block_it->size_ += next_it->size_;
+        next_it = blocks.erase(next_it);
+      }
+      block_it->stream_ = stream;
+      free_blocks.emplace(std::make_pair(block_it->size_, block_it->ptr_),
+                          block_it);
+      block_it = next_it;
+    }
+  }
+
+  size_t reserved_size = stats_.reserved_bytes;
+  FreeIdleChunks();
+  return reserved_size - stats_.reserved_bytes;
+}
+
+// NOTE: An idle chunk may contain free blocks of different streams. Freeing
+// it to the underlying allocator is safe for CUDA, because cudaFree would
+// synchronize the device implicitly.
 void AutoGrowthBestFitAllocator::FreeIdleChunks() {
   for (auto chunk_it = chunks_.begin(); chunk_it != chunks_.end();) {
     auto &blocks = chunk_it->blocks_;
-    if (blocks.size() == 1 && blocks.begin()->is_free_) {
-      auto &block = *blocks.begin();
-      VLOG(2) << "Free chunk with size " << block.size_;
-      free_blocks_.erase(std::make_pair(block.size_, block.ptr_));
+    bool is_idle =
+        std::all_of(blocks.begin(), blocks.end(),
+                    [](const Block &block) { return block.is_free_; });
+    if (is_idle) {
+      VLOG(2) << "Free chunk with size " << chunk_it->size_;
+      stats_.reserved_bytes -= chunk_it->size_;
+      for (auto &block : blocks) {
+        free_blocks_[block.stream_].erase(
+            std::make_pair(block.size_, block.ptr_));
+      }
       chunk_it = chunks_.erase(chunk_it);
     } else {
       ++chunk_it;
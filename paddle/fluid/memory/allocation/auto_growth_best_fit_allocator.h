@@ -14,31 +14,73 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "paddle/fluid/memory/allocation/allocator.h"
 
 namespace paddle {
 namespace memory {
 namespace allocation {
 
+/**
+ * AutoGrowthBestFitAllocator keeps a free list for each stream. Each block
+ * records the stream it was last used on, and it would be freed back to the
+ * free list of that stream. Therefore, reusing a freed block on the same
+ * stream needs no synchronization, since the stream executes in order.
+ *
+ * The stream is an opaque handle (i.e., cudaStream_t for CUDA allocations),
+ * and the default stream is represented by nullptr. Allocations on the
+ * non-default streams are served by AutoGrowthBestFitStreamAllocator.
+ *
+ * When the underlying allocator runs out of memory, or Release() is called,
+ * the allocator compacts itself: it waits for all the streams by calling
+ * `synchronize`, merges all the adjacent free blocks no matter which stream
+ * they are freed on, and frees the idle chunks to the underlying allocator.
+ * `synchronize` can be empty if the allocations are only used on the default
+ * stream.
+ *
+ * If `grow_in_place` is true, the underlying allocator must return aligned
+ * memory, and a new chunk which starts right at the end of an existing chunk
+ * is merged into it, i.e., the existing chunk grows in place. It works with
+ * the underlying allocators which map memory into a contiguous virtual
+ * address range, e.g., CUDAVirtualMemAllocator.
+ */
 class AutoGrowthBestFitAllocator : public Allocator {
  public:
+  using Stream = const void *;
+
   AutoGrowthBestFitAllocator(
       const std::shared_ptr<Allocator> &underlying_allocator, size_t alignment,
-      size_t chunk_size = 0);
+      size_t chunk_size = 0, std::function<void()> synchronize = nullptr,
+      bool grow_in_place = false);
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  // Record that `allocation` is used on `stream` after it is allocated.
+  // When `allocation` is freed, its block would go back to the free list of
+  // `stream`. The caller must make sure that the work on the previous stream
+  // is visible to `stream`, i.e., by waiting for an event.
+  // Allocations which are not allocated by this allocator are ignored.
+  void RecordStream(Allocation *allocation, Stream stream);
+
+  bool GetStats(AllocatorStats *stats) override;
+
+  size_t Release() override;
+
  protected:
   Allocation *AllocateImpl(size_t size) override;
 
   void FreeImpl(Allocation *allocation) override;
 
  private:
+  Allocation *AllocateImpl(size_t size, Stream stream);
+
   void FreeIdleChunks();
 
   template <typename T>
@@ -47,26 +89,41 @@ class AutoGrowthBestFitAllocator : public Allocator {
   struct Chunk;
 
   struct Block {
-    Block(void *ptr, size_t size, bool is_free, Chunk *chunk)
-        : ptr_(ptr), size_(size), is_free_(is_free), chunk_(chunk) {}
+    Block(void *ptr, size_t size, bool is_free, Chunk *chunk, Stream stream)
+        : ptr_(ptr),
+          size_(size),
+          is_free_(is_free),
+          chunk_(chunk),
+          stream_(stream) {}
 
     void *ptr_;
     size_t size_;
     bool is_free_;
-    Chunk *chunk_;  // which chunk it is from
+    Chunk *chunk_;   // which chunk it is from
+    Stream stream_;  // which stream it is last used on
   };
 
   struct Chunk {
-    explicit Chunk(AllocationPtr allocation)
-        : allocation_(std::move(allocation)) {}
+    explicit Chunk(AllocationPtr allocation) : size_(allocation->size()) {
+      allocations_.emplace_back(std::move(allocation));
+    }
+
+    const platform::Place &place() const { return allocations_[0]->place(); }
 
-    AllocationPtr allocation_;
+    void *end() const {
+      return reinterpret_cast<uint8_t *>(allocations_[0]->ptr()) + size_;
+    }
+
+    // The contiguous allocations of the underlying allocator. There is only
+    // one allocation unless the chunk grows in place.
+    std::vector<AllocationPtr> allocations_;
+    size_t size_;
     List<Block> blocks_;
   };
 
   struct BlockAllocation : public Allocation {
     explicit BlockAllocation(const List<Block>::iterator &it)
-        : Allocation(it->ptr_, it->size_, it->chunk_->allocation_->place()),
+        : Allocation(it->ptr_, it->size_, it->chunk_->place()),
           block_it_(it) {}
 
     List<Block>::iterator block_it_;
@@ -74,13 +131,59 @@ class AutoGrowthBestFitAllocator : public Allocator {
 
   using BlockIt = List<Block>::iterator;
 
+  using FreeBlocks = std::map<std::pair<size_t, void *>, BlockIt>;
+
+  // The following methods must be called inside the lock.
+  FreeBlocks::iterator AllocateChunk(size_t size, Stream stream);
+
+  BlockIt SplitFreeBlock(FreeBlocks::iterator iter, size_t size,
+                         Stream stream);
+
+  // Merge all the adjacent free blocks into the free list of `stream`, and
+  // free the idle chunks. Returns the bytes freed to the underlying allocator.
+  size_t Compact(Stream stream);
+
   std::shared_ptr<Allocator> underlying_allocator_;
-  std::map<std::pair<size_t, void *>, BlockIt> free_blocks_;
+  std::unordered_map<Stream, FreeBlocks> free_blocks_;
   std::list<Chunk> chunks_;
   size_t alignment_;
   size_t chunk_size_;
+  std::function<void()> synchronize_;
+  bool grow_in_place_;
+  AllocatorStats stats_;
 
   mutable std::mutex mtx_;
+
+  friend class AutoGrowthBestFitStreamAllocator;
+};
+
+/**
+ * AutoGrowthBestFitStreamAllocator serves the allocations used on a
+ * non-default stream. It shares the chunks with the AutoGrowthBestFitAllocator
+ * it is created from, but only reuses the blocks freed on its own stream.
+ */
+class AutoGrowthBestFitStreamAllocator : public Allocator {
+ public:
+  using Stream = AutoGrowthBestFitAllocator::Stream;
+
+  AutoGrowthBestFitStreamAllocator(
+      std::shared_ptr<AutoGrowthBestFitAllocator> allocator, Stream stream)
+      : allocator_(std::move(allocator)), stream_(stream) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    return allocator_->AllocateImpl(size, stream_);
+  }
+
+  void FreeImpl(Allocation *allocation) override {
+    allocator_->FreeImpl(allocation);
+  }
+
+ private:
+  std::shared_ptr<AutoGrowthBestFitAllocator> allocator_;
+  Stream stream_;
 };
 
 }  // namespace allocation
@@ -19,6 +19,7 @@
 
 DECLARE_bool(free_idle_chunk);
 DECLARE_bool(free_when_no_cache_hit);
+DECLARE_bool(compact_when_oom);
 
 namespace paddle {
 namespace memory {
@@ -93,6 +94,41 @@ class LimitedResourceAllocator : public Allocator {
   const size_t capacity_;
 };
 
+// Allocates the memory one after another from a contiguous buffer, like
+// CUDAVirtualMemAllocator does.
+class ContiguousAllocator : public Allocator {
+ public:
+  ContiguousAllocator(size_t capacity, size_t alignment)
+      : buffer_(capacity + alignment), capacity_(capacity) {
+    base_ = buffer_.data() + AlignedPtrOffset(buffer_.data(), alignment);
+  }
+
+  size_t AllocatedSize() const { return allocated_size_; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    if (offset_ + size > capacity_) {
+      throw BadAlloc("", __FILE__, __LINE__);
+    }
+    auto *ptr = base_ + offset_;
+    offset_ += size;
+    allocated_size_ += size;
+    return new Allocation(ptr, size, platform::CPUPlace());
+  }
+
+  void FreeImpl(Allocation *allocation) {
+    allocated_size_ -= allocation->size();
+    delete allocation;
+  }
+
+ private:
+  std::vector<uint8_t> buffer_;
+  uint8_t *base_;
+  size_t offset_{0};
+  size_t allocated_size_{0};
+  const size_t capacity_;
+};
+
 static void TestFreeWhenNoCacheHit(bool free_when_no_cache_hit) {
   FLAGS_free_idle_chunk = false;
   FLAGS_free_when_no_cache_hit = free_when_no_cache_hit;
@@ -150,6 +186,176 @@ static void TestFreeWhenNoCacheHit(bool free_when_no_cache_hit) {
             allocate_size[2] + alignment);
 }
 
+static void TestStreamFreeList() {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  auto recorded_allocator = std::make_shared<RecordedAllocator>();
+  size_t alignment = 4096;
+  size_t memory_size = 8192;
+  size_t chunk_size = memory_size + alignment;
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      recorded_allocator, alignment);
+
+  // Fake stream handles, the allocator never dereferences them.
+  int stream_holder[2];
+  auto stream_allocator1 = std::make_shared<AutoGrowthBestFitStreamAllocator>(
+      ag_allocator, &stream_holder[0]);
+  auto stream_allocator2 = std::make_shared<AutoGrowthBestFitStreamAllocator>(
+      ag_allocator, &stream_holder[1]);
+
+  // The block freed on stream1 can be reused on stream1.
+  stream_allocator1->Allocate(memory_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), chunk_size);
+  stream_allocator1->Allocate(memory_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), chunk_size);
+
+  // But it cannot be reused on stream2 or the default stream.
+  stream_allocator2->Allocate(memory_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 2 * chunk_size);
+  ag_allocator->Allocate(memory_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 3 * chunk_size);
+
+  // The blocks of stream1 stay in its free list after they are split.
+  {
+    auto allocation1 = stream_allocator1->Allocate(memory_size / 2);
+    auto allocation2 = stream_allocator1->Allocate(memory_size / 2);
+    ASSERT_EQ(recorded_allocator->AllocatedSize(), 3 * chunk_size);
+  }
+  stream_allocator1->Allocate(memory_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 3 * chunk_size);
+
+  // The block recorded on stream2 goes back to the free list of stream2.
+  {
+    auto allocation = stream_allocator1->Allocate(memory_size);
+    ag_allocator->RecordStream(allocation.get(), &stream_holder[1]);
+  }
+  auto allocation1 = stream_allocator2->Allocate(memory_size);
+  auto allocation2 = stream_allocator2->Allocate(memory_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 3 * chunk_size);
+}
+
+static void TestStats() {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  auto recorded_allocator = std::make_shared<RecordedAllocator>();
+  size_t alignment = 4096;
+  size_t memory_size = 8192;
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      recorded_allocator, alignment);
+
+  AllocatorStats stats;
+  {
+    auto allocation1 = ag_allocator->Allocate(memory_size);
+    auto allocation2 = ag_allocator->Allocate(memory_size);
+    ASSERT_TRUE(ag_allocator->GetStats(&stats));
+    ASSERT_EQ(stats.allocated_bytes, 2 * memory_size);
+    // The chunks are aligned, so that a few bytes are not usable.
+    ASSERT_LE(stats.reserved_bytes, recorded_allocator->AllocatedSize());
+    ASSERT_GE(stats.reserved_bytes, 2 * memory_size);
+  }
+  ASSERT_TRUE(ag_allocator->GetStats(&stats));
+  ASSERT_EQ(stats.allocated_bytes, 0UL);
+  ASSERT_EQ(stats.peak_allocated_bytes, 2 * memory_size);
+  ASSERT_EQ(stats.alloc_counts[AllocatorStats::SizeBucketIndex(memory_size)],
+            2UL);
+  ASSERT_GE(stats.largest_free_chunk_bytes, memory_size);
+  ASSERT_LT(stats.FragmentationRatio(), 1.0);
+}
+
+static void TestCompactWhenOOM(bool compact_when_oom) {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  FLAGS_compact_when_oom = compact_when_oom;
+  size_t alignment = 4096;
+  size_t memory_size = 8192;
+  size_t chunk_size = 2 * memory_size;
+  auto underlying_allocator =
+      std::make_shared<LimitedResourceAllocator>(chunk_size + alignment);
+  size_t synchronize_times = 0;
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      underlying_allocator, alignment, chunk_size,
+      [&synchronize_times] { ++synchronize_times; });
+
+  int stream_holder[2];
+  auto stream_allocator1 = std::make_shared<AutoGrowthBestFitStreamAllocator>(
+      ag_allocator, &stream_holder[0]);
+  auto stream_allocator2 = std::make_shared<AutoGrowthBestFitStreamAllocator>(
+      ag_allocator, &stream_holder[1]);
+
+  // The only chunk is split on stream1, and half of it is free.
+  auto allocation1 = stream_allocator1->Allocate(memory_size);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), chunk_size + alignment);
+
+  if (!compact_when_oom) {
+    ASSERT_THROW(stream_allocator2->Allocate(memory_size), BadAlloc);
+    ASSERT_EQ(synchronize_times, 0UL);
+    return;
+  }
+
+  // The free block of stream1 is moved to stream2 after synchronization.
+  auto allocation2 = stream_allocator2->Allocate(memory_size);
+  ASSERT_EQ(synchronize_times, 1UL);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), chunk_size + alignment);
+
+  // The free blocks of stream1 and stream2 are merged, so that the chunk is
+  // released and allocated again.
+  allocation1.reset();
+  allocation2.reset();
+  auto allocation3 = ag_allocator->Allocate(chunk_size);
+  ASSERT_EQ(synchronize_times, 2UL);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), chunk_size + alignment);
+
+  ASSERT_EQ(ag_allocator->Release(), 0UL);
+  allocation3.reset();
+  ASSERT_GE(ag_allocator->Release(), chunk_size);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 0UL);
+
+  AllocatorStats stats;
+  ASSERT_TRUE(ag_allocator->GetStats(&stats));
+  ASSERT_EQ(stats.reserved_bytes, 0UL);
+  FLAGS_compact_when_oom = false;
+}
+
+static void TestGrowInPlace() {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  size_t alignment = 4096;
+  size_t memory_size = 8192;
+  auto underlying_allocator =
+      std::make_shared<ContiguousAllocator>(8 * memory_size, alignment);
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      underlying_allocator, alignment, /*chunk_size=*/0,
+      /*synchronize=*/nullptr, /*grow_in_place=*/true);
+
+  // The memory is allocated without any alignment padding.
+  auto allocation1 = ag_allocator->Allocate(memory_size);
+  auto allocation2 = ag_allocator->Allocate(memory_size);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 2 * memory_size);
+  ASSERT_EQ(reinterpret_cast<uint8_t *>(allocation1->ptr()) + memory_size,
+            allocation2->ptr());
+
+  // The two allocations are in the same chunk, so that they are merged,
+  // and the merged block can serve a larger request.
+  allocation1.reset();
+  allocation2.reset();
+  auto allocation3 = ag_allocator->Allocate(2 * memory_size);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 2 * memory_size);
+
+  // The free block at the end of the chunk grows with the chunk.
+  ag_allocator->Allocate(memory_size / 2);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 5 * memory_size / 2);
+  auto allocation4 = ag_allocator->Allocate(memory_size);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 7 * memory_size / 2);
+  auto allocation5 = ag_allocator->Allocate(memory_size / 2);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 7 * memory_size / 2);
+
+  allocation3.reset();
+  allocation4.reset();
+  allocation5.reset();
+  ASSERT_EQ(ag_allocator->Release(), 7 * memory_size / 2);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 0UL);
+}
+
 TEST(test_auto_growth_allocator, test_free_idle_chunk) {
   for (auto free_idle_chunk : {false, true}) {
     for (auto free_when_no_cache_hit : {false, true}) {
@@ -163,6 +369,21 @@ TEST(test_auto_growth_allocator, test_free_when_no_cache_hit) {
   TestFreeWhenNoCacheHit(true);
 }
 
+TEST(test_auto_growth_allocator, test_stats) { TestStats(); }
+
+TEST(test_auto_growth_allocator, test_stream_free_list) {
+  TestStreamFreeList();
+}
+
+TEST(test_auto_growth_allocator, test_grow_in_place) { TestGrowInPlace(); }
+
+TEST(test_auto_growth_allocator, test_compact_when_oom) {
+  // off by default
+  ASSERT_FALSE(FLAGS_compact_when_oom);
+  TestCompactWhenOOM(false);
+  TestCompactWhenOOM(true);
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
@@ -43,6 +43,7 @@ BestFitAllocator::BestFitAllocator(Allocation* allocation)
   chunks_.emplace_back(chunk);
   free_chunks_[HighestBitPos(chunk.size_)].insert(
       {chunk.size_, chunks_.begin()});
+  stats_.reserved_bytes = chunk.size_;
 }
 
 size_t BestFitAllocator::FreeSize() const {
@@ -116,6 +117,7 @@ void BestFitAllocator::FreeImpl(Allocation* allocation) {
   auto chunk_it = bf_allocation->ChunkIterator();
   PADDLE_ENFORCE(!chunk_it->is_free);
   chunk_it->is_free = true;
+  stats_.RecordFree(chunk_it->size_);
   if (chunk_it != chunks_.begin()) {
     auto prev_it = chunk_it;
     --prev_it;
@@ -154,9 +156,22 @@ Allocation* BestFitAllocator::AllocateImpl(size_t size) {
                            FreeSize());
   }
   auto chunk_it = SplitChunk(size, highest_set_bit, map_it);
+  stats_.RecordAllocate(size);
   return new BestFitAllocation(this, chunk_it);
 }
 
+bool BestFitAllocator::GetStats(AllocatorStats* stats) {
+  *stats = stats_;
+  stats->largest_free_chunk_bytes = 0;
+  for (auto it = free_chunks_.rbegin(); it != free_chunks_.rend(); ++it) {
+    if (!it->empty()) {
+      stats->largest_free_chunk_bytes = it->rbegin()->first;
+      break;
+    }
+  }
+  return true;
+}
+
 BestFitAllocation::BestFitAllocation(
     paddle::memory::allocation::BestFitAllocator* allocator,
     typename details::ChunkList::iterator chunk_it)
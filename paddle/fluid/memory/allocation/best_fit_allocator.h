@@ -108,6 +108,8 @@ class BestFitAllocator : public Allocator {
 
   size_t NumFreeChunks() const;
 
+  bool GetStats(AllocatorStats* stats) override;
+
  private:
   size_t FreeSize() const;
   using MapIt = typename details::FreeChunkBin::value_type::iterator;
@@ -126,6 +128,7 @@ class BestFitAllocator : public Allocator {
   Allocation* allocation_;  // not owned
   details::ChunkList chunks_;
   details::FreeChunkBin free_chunks_;
+  AllocatorStats stats_;
 };
 }  // namespace allocation
 }  // namespace memory
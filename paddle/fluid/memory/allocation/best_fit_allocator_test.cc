@@ -91,6 +91,28 @@ TEST(BestFitAllocator, test_allocation) {
   }
 }
 
+TEST(BestFitAllocator, test_stats) {
+  StubAllocation stub(4096);
+  BestFitAllocator allocator(&stub);
+  AllocatorStats stats;
+  ASSERT_TRUE(allocator.GetStats(&stats));
+  ASSERT_EQ(stats.reserved_bytes, 4096UL);
+  ASSERT_EQ(stats.largest_free_chunk_bytes, 4096UL);
+  ASSERT_EQ(stats.FragmentationRatio(), 0.0);
+
+  auto allocation1 = allocator.Allocate(1024);
+  auto allocation2 = allocator.Allocate(1024);
+  auto allocation3 = allocator.Allocate(1024);
+  allocation2.reset();
+  ASSERT_TRUE(allocator.GetStats(&stats));
+  ASSERT_EQ(stats.allocated_bytes, 2048UL);
+  ASSERT_EQ(stats.peak_allocated_bytes, 3072UL);
+  ASSERT_EQ(stats.largest_free_chunk_bytes, 1024UL);
+  ASSERT_EQ(stats.alloc_counts[AllocatorStats::SizeBucketIndex(1024)], 3UL);
+  // Two free chunks of 1024 bytes, but only one can be used together.
+  ASSERT_DOUBLE_EQ(stats.FragmentationRatio(), 0.5);
+}
+
 TEST(BestFitAllocator, test_concurrent_cpu_allocation) {
   CPUAllocator allocator;
   auto global_allocation = allocator.Allocate(256UL * 1024 * 1024);
@@ -15,15 +15,50 @@
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include <stdlib.h>
 #include <string>
+#include "paddle/fluid/memory/detail/system_allocator.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace paddle {
 namespace memory {
 namespace allocation {
 
+#if defined(__linux__) && defined(SYS_mbind)
+// Prefer the pages in [p, p + size) to be placed on the NUMA node. The policy
+// takes effect on the pages which have not been touched.
+static void BindToNumaNode(void *p, size_t size, int node) {
+  constexpr int kMPolPreferred = 1;  // MPOL_PREFERRED in <numaif.h>
+  constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;  // NOLINT
+  unsigned long mask[4] = {0};  // NOLINT
+  if (node < 0 || static_cast<size_t>(node) >= sizeof(mask) * 8) return;
+  mask[node / kBitsPerMask] |= 1UL << (node % kBitsPerMask);
+  if (syscall(SYS_mbind, p, size, kMPolPreferred, mask, sizeof(mask) * 8,
+              0) != 0) {
+    VLOG(10) << "Failed to bind " << size << " bytes to NUMA node " << node;
+  }
+}
+#endif
+
+namespace {
+// The allocation mapped by detail::HugePageAlloc.
+class HugePageAllocation : public Allocation {
+ public:
+  using Allocation::Allocation;
+};
+}  // namespace
+
 bool CPUAllocator::IsAllocThreadSafe() const { return true; }
 
 void CPUAllocator::FreeImpl(Allocation *allocation) {
   void *p = allocation->ptr();
+  if (dynamic_cast<HugePageAllocation *>(allocation) != nullptr) {
+    detail::HugePageFree(p, allocation->size());
+    delete allocation;
+    return;
+  }
 #ifdef _WIN32
   _aligned_free(p);
 #else
@@ -34,11 +69,25 @@ void CPUAllocator::FreeImpl(Allocation *allocation) {
 
 Allocation *CPUAllocator::AllocateImpl(size_t size) {
   void *p;
+  if (detail::UseHugePage(size) &&
+      (p = detail::HugePageAlloc(size)) != nullptr) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (numa_node_ >= 0) {
+      BindToNumaNode(p, size, numa_node_);
+    }
+#endif
+    return new HugePageAllocation(p, size, platform::CPUPlace());
+  }
 #ifdef _WIN32
   p = _aligned_malloc(size, kAlignment);
 #else
   PADDLE_ENFORCE_EQ(posix_memalign(&p, kAlignment, size), 0, "Alloc %ld error!",
                     size);
+#endif
+#if defined(__linux__) && defined(SYS_mbind)
+  if (numa_node_ >= 0 && size > 0) {
+    BindToNumaNode(p, size, numa_node_);
+  }
 #endif
   return new Allocation(p, size, platform::CPUPlace());
 }
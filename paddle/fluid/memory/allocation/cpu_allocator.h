@@ -31,14 +31,23 @@ namespace allocation {
 //
 // NOTE(yy): It is no need to use `BestFitAllocator` in CPU. We can import
 // an open-sourced allocator into Paddle.
+//
+// If numa_node >= 0, the pages of the allocations are bound to the NUMA
+// node preferentially, no matter which thread touches them first.
 class CPUAllocator : public Allocator {
  public:
   constexpr static size_t kAlignment = 4096UL;
+
+  explicit CPUAllocator(int numa_node = -1) : numa_node_(numa_node) {}
+
   bool IsAllocThreadSafe() const override;
 
  protected:
   void FreeImpl(Allocation* allocation) override;
   Allocation* AllocateImpl(size_t size) override;
+
+ private:
+  int numa_node_;
 };
 }  // namespace allocation
 }  // namespace memory
@@ -0,0 +1,243 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/cuda_virtual_mem_allocator.h"
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/dynload/cuda_driver.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/gpu_info.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+#if CUDA_VERSION >= 10020
+
+static std::string CUDADriverErrorString(CUresult result) {
+  const char *error = nullptr;
+  platform::dynload::cuGetErrorString(result, &error);
+  return error == nullptr ? std::to_string(result) : std::string(error);
+}
+
+#define PADDLE_ENFORCE_CUDA_DRIVER_SUCCESS(__call)                      \
+  do {                                                                  \
+    CUresult __result = (__call);                                       \
+    PADDLE_ENFORCE_EQ(__result, CUDA_SUCCESS,                           \
+                      platform::errors::External(                       \
+                          "CUDA driver API %s failed: %s", #__call,     \
+                          CUDADriverErrorString(__result)));            \
+  } while (0)
+
+static CUmemAllocationProp GetAllocationProp(int device) {
+  CUmemAllocationProp prop = {};
+  prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+  prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  prop.location.id = device;
+  return prop;
+}
+
+bool CUDAVirtualMemAllocator::IsSupported(const platform::CUDAPlace &place) {
+  if (!platform::dynload::HasCUDADriver()) return false;
+  int driver_version = 0;
+  if (platform::dynload::cuDriverGetVersion(&driver_version) !=
+          CUDA_SUCCESS ||
+      driver_version < 10020) {
+    return false;
+  }
+  int supported = 0;
+  auto result = platform::dynload::cuDeviceGetAttribute(
+      &supported, CU_DEVICE_ATTRIBUTE_VIRTUAL_ADDRESS_MANAGEMENT_SUPPORTED,
+      place.device);
+  return result == CUDA_SUCCESS && supported != 0;
+}
+
+CUDAVirtualMemAllocator::CUDAVirtualMemAllocator(
+    const platform::CUDAPlace &place)
+    : place_(place) {
+  PADDLE_ENFORCE_EQ(
+      IsSupported(place_), true,
+      platform::errors::Unavailable(
+          "CUDAPlace(%d) does not support virtual memory management.",
+          place_.device));
+
+  platform::CUDADeviceGuard guard(place_.device);
+  // Make sure that the primary context of the device is created.
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaFree(nullptr));
+
+  auto prop = GetAllocationProp(place_.device);
+  PADDLE_ENFORCE_CUDA_DRIVER_SUCCESS(
+      platform::dynload::cuMemGetAllocationGranularity(
+          &granularity_, &prop, CU_MEM_ALLOC_GRANULARITY_MINIMUM));
+
+  // The virtual address range is twice as large as the device memory, so
+  // that an allocation can hardly fail because of the holes in the range.
+  size_t available = 0, total = 0;
+  platform::GpuMemoryUsage(&available, &total);
+  virtual_mem_size_ = AlignedSize(total * 2, granularity_);
+  PADDLE_ENFORCE_CUDA_DRIVER_SUCCESS(platform::dynload::cuMemAddressReserve(
+      &virtual_mem_base_, virtual_mem_size_, granularity_, 0, 0));
+  free_ranges_.emplace(virtual_mem_base_, virtual_mem_size_);
+  VLOG(2) << "Reserve " << virtual_mem_size_ << " bytes of virtual memory on "
+          << "CUDAPlace(" << place_.device << ")";
+}
+
+CUDAVirtualMemAllocator::~CUDAVirtualMemAllocator() {
+  platform::CUDADeviceGuard guard(place_.device);
+  for (auto &pair : handles_) {
+    platform::dynload::cuMemRelease(pair.second);
+  }
+  platform::dynload::cuMemAddressFree(virtual_mem_base_, virtual_mem_size_);
+}
+
+Allocation *CUDAVirtualMemAllocator::AllocateImpl(size_t size) {
+  size = AlignedSize(size, granularity_);
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = std::find_if(
+      free_ranges_.begin(), free_ranges_.end(),
+      [size](const std::pair<const CUdeviceptr, size_t> &range) {
+        return range.second >= size;
+      });
+  if (iter == free_ranges_.end()) {
+    PADDLE_THROW_BAD_ALLOC(platform::errors::ResourceExhausted(
+        "\n\nOut of virtual memory error on GPU %d. Cannot allocate %s "
+        "memory on GPU %d, because no free range of the reserved virtual "
+        "address range is large enough.\n\n",
+        place_.device, string::HumanReadableSize(size), place_.device));
+  }
+  CUdeviceptr ptr = iter->first;
+
+  platform::CUDADeviceGuard guard(place_.device);
+  auto prop = GetAllocationProp(place_.device);
+  CUmemGenericAllocationHandle handle;
+  auto result = platform::dynload::cuMemCreate(&handle, size, &prop, 0);
+  if (result == CUDA_SUCCESS) {
+    result = platform::dynload::cuMemMap(ptr, size, 0, handle, 0);
+    if (result == CUDA_SUCCESS) {
+      CUmemAccessDesc access_desc = {};
+      access_desc.location = prop.location;
+      access_desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+      result = platform::dynload::cuMemSetAccess(ptr, size, &access_desc, 1);
+      if (result != CUDA_SUCCESS) {
+        platform::dynload::cuMemUnmap(ptr, size);
+      }
+    }
+    if (result != CUDA_SUCCESS) {
+      platform::dynload::cuMemRelease(handle);
+    }
+  }
+
+  if (result != CUDA_SUCCESS) {
+    size_t avail = 0, total = 0;
+    platform::GpuMemoryUsage(&avail, &total);
+    PADDLE_THROW_BAD_ALLOC(platform::errors::ResourceExhausted(
+        "\n\nOut of memory error on GPU %d. Cannot allocate %s memory on "
+        "GPU %d, available memory is only %s. The error of the CUDA driver "
+        "is: %s.\n\n",
+        place_.device, string::HumanReadableSize(size), place_.device,
+        string::HumanReadableSize(avail), CUDADriverErrorString(result)));
+  }
+
+  size_t remaining_size = iter->second - size;
+  free_ranges_.erase(iter);
+  if (remaining_size > 0) {
+    free_ranges_.emplace(ptr + size, remaining_size);
+  }
+  handles_.emplace(ptr, handle);
+  return new Allocation(reinterpret_cast<void *>(ptr), size,
+                        platform::Place(place_));
+}
+
+void CUDAVirtualMemAllocator::FreeImpl(Allocation *allocation) {
+  PADDLE_ENFORCE_EQ(
+      BOOST_GET_CONST(platform::CUDAPlace, allocation->place()), place_,
+      platform::errors::PermissionDenied(
+          "GPU memory is freed in incorrect device. This may be a bug"));
+  auto ptr = reinterpret_cast<CUdeviceptr>(allocation->ptr());
+  size_t size = allocation->size();
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto handle_it = handles_.find(ptr);
+  PADDLE_ENFORCE_EQ(handle_it != handles_.end(), true,
+                    platform::errors::InvalidArgument(
+                        "The freed memory is not allocated by the "
+                        "CUDAVirtualMemAllocator of CUDAPlace(%d).",
+                        place_.device));
+
+  // Unlike cudaFree, unmapping does not wait for the kernels which may still
+  // use the memory.
+  platform::CUDADeviceGuard guard(place_.device);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaDeviceSynchronize());
+  PADDLE_ENFORCE_CUDA_DRIVER_SUCCESS(platform::dynload::cuMemUnmap(ptr, size));
+  PADDLE_ENFORCE_CUDA_DRIVER_SUCCESS(
+      platform::dynload::cuMemRelease(handle_it->second));
+  handles_.erase(handle_it);
+
+  // Merge the range with its free neighbours.
+  auto next_it = free_ranges_.lower_bound(ptr);
+  if (next_it != free_ranges_.end() && ptr + size == next_it->first) {
+    size += next_it->second;
+    next_it = free_ranges_.erase(next_it);
+  }
+  if (next_it != free_ranges_.begin()) {
+    auto prev_it = next_it;
+    --prev_it;
+    if (prev_it->first + prev_it->second == ptr) {
+      prev_it->second += size;
+      delete allocation;
+      return;
+    }
+  }
+  free_ranges_.emplace(ptr, size);
+  delete allocation;
+}
+
+#undef PADDLE_ENFORCE_CUDA_DRIVER_SUCCESS
+
+#else
+
+bool CUDAVirtualMemAllocator::IsSupported(const platform::CUDAPlace &place) {
+  return false;
+}
+
+CUDAVirtualMemAllocator::CUDAVirtualMemAllocator(
+    const platform::CUDAPlace &place)
+    : place_(place) {
+  PADDLE_THROW(platform::errors::Unavailable(
+      "Virtual memory management needs CUDA 10.2 or higher, but Paddle is "
+      "compiled with CUDA %d.",
+      CUDA_VERSION));
+}
+
+CUDAVirtualMemAllocator::~CUDAVirtualMemAllocator() {}
+
+Allocation *CUDAVirtualMemAllocator::AllocateImpl(size_t size) {
+  PADDLE_THROW(platform::errors::Unavailable(
+      "Virtual memory management needs CUDA 10.2 or higher."));
+}
+
+void CUDAVirtualMemAllocator::FreeImpl(Allocation *allocation) {
+  PADDLE_THROW(platform::errors::Unavailable(
+      "Virtual memory management needs CUDA 10.2 or higher."));
+}
+
+#endif
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
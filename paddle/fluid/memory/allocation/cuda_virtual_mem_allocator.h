@@ -0,0 +1,77 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda.h>
+#include <map>
+#include <mutex>  // NOLINT
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * CUDAVirtualMemAllocator reserves a virtual address range twice as large as
+ * the device memory when it is created, and maps the physical memory into the
+ * range on demand with the CUDA virtual memory management APIs (CUDA 10.2+).
+ *
+ * Each allocation is placed at the lowest free address of the range which
+ * fits. Therefore, the memory allocated one after another is contiguous, and
+ * an AutoGrowthBestFitAllocator created with grow_in_place=true extends its
+ * last chunk instead of holding a new discontiguous one.
+ *
+ * The allocation size is rounded up to the allocation granularity of the
+ * device, which is 2MB usually.
+ */
+class CUDAVirtualMemAllocator : public Allocator {
+ public:
+  explicit CUDAVirtualMemAllocator(const platform::CUDAPlace& place);
+
+  ~CUDAVirtualMemAllocator();
+
+  // Whether the driver and the device of `place` support the virtual memory
+  // management APIs.
+  static bool IsSupported(const platform::CUDAPlace& place);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t granularity() const { return granularity_; }
+
+ protected:
+  Allocation* AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation* allocation) override;
+
+ private:
+  platform::CUDAPlace place_;
+
+  CUdeviceptr virtual_mem_base_{0};
+  size_t virtual_mem_size_{0};
+  size_t granularity_{0};
+
+  // The free virtual address ranges, from the start address to the size.
+  std::map<CUdeviceptr, size_t> free_ranges_;
+  // The physical memory handles, i.e., CUmemGenericAllocationHandle, of the
+  // mapped ranges.
+  std::map<CUdeviceptr, unsigned long long> handles_;  // NOLINT
+
+  std::mutex mtx_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -37,6 +37,16 @@ void LockedAllocator::FreeImpl(Allocation *allocation) {
   underlying_allocator_->Free(allocation);
 }
 
+bool LockedAllocator::GetStats(AllocatorStats *stats) {
+  platform::LockGuardPtr<std::mutex> guard(mtx_);
+  return underlying_allocator_->GetStats(stats);
+}
+
+size_t LockedAllocator::Release() {
+  platform::LockGuardPtr<std::mutex> guard(mtx_);
+  return underlying_allocator_->Release();
+}
+
 Allocation *LockedAllocator::AllocateImpl(size_t size) {
   platform::LockGuardPtr<std::mutex> guard(mtx_);
   return underlying_allocator_->Allocate(size).release();
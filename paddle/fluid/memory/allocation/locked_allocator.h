@@ -27,6 +27,10 @@ class LockedAllocator : public Allocator {
   explicit LockedAllocator(std::shared_ptr<Allocator> underlying_allocator);
   bool IsAllocThreadSafe() const override;
 
+  bool GetStats(AllocatorStats *stats) override;
+
+  size_t Release() override;
+
  protected:
   void FreeImpl(Allocation *allocation) override;
   Allocation *AllocateImpl(size_t size) override;
@@ -23,15 +23,53 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <random>
 #include <string>
 #include <utility>
 
+#include "gflags/gflags.h"
+
+DECLARE_bool(use_shm_cache);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
 
+namespace {
+
+// The header of the blocks cached by MemoryMapAllocationPool.
+struct MemoryMapBlockHeader {
+  // The block is being used by the reader.
+  static constexpr uint32_t kInUse = 1;
+  // The writer has exited, so the reader should unlink the block.
+  static constexpr uint32_t kOrphan = 2;
+
+  std::atomic<uint32_t> state;
+};
+
+static_assert(sizeof(MemoryMapBlockHeader) <= kMemoryMapBlockHeaderSize,
+              "The header of the shared memory block is too large");
+
+inline MemoryMapBlockHeader *GetBlockHeader(void *base) {
+  return reinterpret_cast<MemoryMapBlockHeader *>(base);
+}
+
+inline void *GetBlockData(void *base) {
+  return reinterpret_cast<uint8_t *>(base) + kMemoryMapBlockHeaderSize;
+}
+
+}  // namespace
+
 MemoryMapWriterAllocation::~MemoryMapWriterAllocation() {
+  // The mapping of the cached block is owned by MemoryMapAllocationPool.
+  if (mapped_size_ > 0) {
+    // No reader would release the block which is never sent.
+    if (!shared_) {
+      MemoryMapAllocationPool::Instance().Release(ipc_name_, mapped_size_);
+    }
+    return;
+  }
   PADDLE_ENFORCE_NE(
       munmap(this->ptr(), this->size()), -1,
       platform::errors::Unavailable("could not unmap the shared memory file %s",
@@ -39,6 +77,23 @@ MemoryMapWriterAllocation::~MemoryMapWriterAllocation() {
 }
 
 MemoryMapReaderAllocation::~MemoryMapReaderAllocation() {
+  if (mapped_size_ > 0) {
+    // Return the cached block to the writer instead of unlinking it.
+    void *base =
+        reinterpret_cast<uint8_t *>(this->ptr()) - kMemoryMapBlockHeaderSize;
+    uint32_t prev_state = GetBlockHeader(base)->state.fetch_and(
+        ~MemoryMapBlockHeader::kInUse, std::memory_order_acq_rel);
+    PADDLE_ENFORCE_NE(munmap(base, mapped_size_), -1,
+                      platform::errors::Unavailable(
+                          "could not unmap the shared memory file %s",
+                          this->ipc_name()));
+    if (prev_state & MemoryMapBlockHeader::kOrphan) {
+      shm_unlink(this->ipc_name().c_str());
+      MemoryMapFdSet::Instance().Remove(this->ipc_name());
+    }
+    VLOG(3) << "~MemoryMapReaderAllocation: release " << this->ipc_name();
+    return;
+  }
   PADDLE_ENFORCE_NE(
       munmap(this->ptr(), this->size()), -1,
       platform::errors::Unavailable("could not unmap the shared memory file %s",
@@ -64,9 +119,7 @@ std::string GetIPCName() {
   return std::move(handle);
 }
 
-std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
-    size_t size) {
-  const std::string &ipc_name = GetIPCName();
+static void *CreateSharedMemory(const std::string &ipc_name, size_t size) {
   int flags = O_RDWR | O_CREAT;
 
   int fd = shm_open(ipc_name.c_str(), flags, 0644);
@@ -82,12 +135,38 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
                     platform::errors::Unavailable(
                         "Memory map failed when create shared memory."));
   close(fd);
+  return ptr;
+}
+
+std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
+    size_t size) {
+  if (FLAGS_use_shm_cache) {
+    return MemoryMapAllocationPool::Instance().Allocate(size);
+  }
 
+  const std::string &ipc_name = GetIPCName();
+  void *ptr = CreateSharedMemory(ipc_name, size);
   return std::make_shared<MemoryMapWriterAllocation>(ptr, size, ipc_name);
 }
 
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
-    const std::string &ipc_name, size_t size) {
+    const std::string &ipc_name, size_t size, size_t mapped_size) {
+  if (mapped_size > 0) {
+    // The reader writes the header of the cached block when releasing it.
+    int fd = shm_open(ipc_name.c_str(), O_RDWR, 0644);
+    PADDLE_ENFORCE_NE(
+        fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
+                                              ipc_name.c_str()));
+    void *base =
+        mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    PADDLE_ENFORCE_NE(base, MAP_FAILED,
+                      platform::errors::Unavailable(
+                          "Memory map failed when rebuild shared memory."));
+    close(fd);
+    return std::make_shared<MemoryMapReaderAllocation>(
+        GetBlockData(base), size, ipc_name, mapped_size);
+  }
+
   int fd = shm_open(ipc_name.c_str(), O_RDONLY, 0644);
   PADDLE_ENFORCE_NE(
       fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
@@ -135,6 +214,80 @@ void MemoryMapFdSet::Clear() {
 
 MemoryMapFdSet::~MemoryMapFdSet() { Clear(); }
 
+MemoryMapAllocationPool &MemoryMapAllocationPool::Instance() {  // NOLINT
+  static MemoryMapAllocationPool pool;
+  return pool;
+}
+
+std::shared_ptr<MemoryMapWriterAllocation> MemoryMapAllocationPool::Allocate(
+    size_t size) {
+  size_t mapped_size = kMemoryMapBlockHeaderSize + size;
+  size_t rounded_size = 4096;
+  while (rounded_size < mapped_size) rounded_size <<= 1;
+  mapped_size = rounded_size;
+
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto &blocks = blocks_[mapped_size];
+  for (auto &block : blocks) {
+    uint32_t expected = 0;
+    if (GetBlockHeader(block.base)->state.compare_exchange_strong(
+            expected, MemoryMapBlockHeader::kInUse,
+            std::memory_order_acq_rel)) {
+      VLOG(4) << "MemoryMapAllocationPool: reuse " << block.ipc_name;
+      return std::make_shared<MemoryMapWriterAllocation>(
+          GetBlockData(block.base), size, block.ipc_name, mapped_size);
+    }
+  }
+
+  const std::string &ipc_name = GetIPCName();
+  void *base = CreateSharedMemory(ipc_name, mapped_size);
+  new (base) MemoryMapBlockHeader();
+  GetBlockHeader(base)->state.store(MemoryMapBlockHeader::kInUse,
+                                    std::memory_order_release);
+  blocks.push_back(Block{ipc_name, base});
+  VLOG(3) << "MemoryMapAllocationPool: create " << ipc_name << " of "
+          << mapped_size << " bytes";
+  return std::make_shared<MemoryMapWriterAllocation>(
+      GetBlockData(base), size, ipc_name, mapped_size);
+}
+
+void MemoryMapAllocationPool::Release(const std::string &ipc_name,
+                                      size_t mapped_size) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto it = blocks_.find(mapped_size);
+  if (it != blocks_.end()) {
+    for (auto &block : it->second) {
+      if (block.ipc_name == ipc_name) {
+        GetBlockHeader(block.base)->state.fetch_and(
+            ~MemoryMapBlockHeader::kInUse, std::memory_order_acq_rel);
+        VLOG(4) << "MemoryMapAllocationPool: release " << ipc_name;
+        return;
+      }
+    }
+  }
+  // The block in use is left to its owner after the pool is cleared.
+  shm_unlink(ipc_name.c_str());
+  MemoryMapFdSet::Instance().Remove(ipc_name);
+  VLOG(3) << "MemoryMapAllocationPool: unlink " << ipc_name;
+}
+
+void MemoryMapAllocationPool::Clear() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  for (auto &item : blocks_) {
+    for (auto &block : item.second) {
+      uint32_t prev_state = GetBlockHeader(block.base)->state.fetch_or(
+          MemoryMapBlockHeader::kOrphan, std::memory_order_acq_rel);
+      if (!(prev_state & MemoryMapBlockHeader::kInUse)) {
+        shm_unlink(block.ipc_name.c_str());
+      }
+      munmap(block.base, item.first);
+    }
+  }
+  blocks_.clear();
+}
+
+MemoryMapAllocationPool::~MemoryMapAllocationPool() { Clear(); }
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
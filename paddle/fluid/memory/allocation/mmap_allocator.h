@@ -19,8 +19,10 @@
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 
@@ -28,6 +30,11 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+// The size of the header of the shared memory blocks cached by
+// MemoryMapAllocationPool, which records whether the block is in use by the
+// reader process.
+constexpr size_t kMemoryMapBlockHeaderSize = 64;
+
 class MemoryMapWriterAllocation : public Allocation {
  public:
   explicit MemoryMapWriterAllocation(void *ptr, size_t size,
@@ -35,20 +42,40 @@ class MemoryMapWriterAllocation : public Allocation {
       : Allocation(ptr, size, platform::CPUPlace()),
         ipc_name_(std::move(ipc_name)) {}
 
+  // The allocation of a block cached by MemoryMapAllocationPool, whose
+  // mapping is owned by the pool.
+  MemoryMapWriterAllocation(void *ptr, size_t size, std::string ipc_name,
+                            size_t mapped_size)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        ipc_name_(std::move(ipc_name)),
+        mapped_size_(mapped_size) {}
+
   inline const std::string &ipc_name() const { return ipc_name_; }
 
+  // The size of the whole cached block including its header, or 0 if the
+  // allocation is not cached.
+  inline size_t mapped_size() const { return mapped_size_; }
+
+  // Called when the allocation is sent to the reader, then the cached block
+  // is released by the reader. Otherwise, it's released by the writer.
+  inline void MarkShared() { shared_ = true; }
+
   ~MemoryMapWriterAllocation() override;
 
  private:
   std::string ipc_name_;
+  size_t mapped_size_{0};
+  bool shared_{false};
 };
 
 class MemoryMapReaderAllocation : public Allocation {
  public:
   explicit MemoryMapReaderAllocation(void *ptr, size_t size,
-                                     std::string ipc_name)
+                                     std::string ipc_name,
+                                     size_t mapped_size = 0)
       : Allocation(ptr, size, platform::CPUPlace()),
-        ipc_name_(std::move(ipc_name)) {}
+        ipc_name_(std::move(ipc_name)),
+        mapped_size_(mapped_size) {}
 
   inline const std::string &ipc_name() const { return ipc_name_; }
 
@@ -56,13 +83,60 @@ class MemoryMapReaderAllocation : public Allocation {
 
  private:
   std::string ipc_name_;
+  size_t mapped_size_{0};
 };
 
+// If FLAGS_use_shm_cache is true, the allocation is served from the blocks
+// cached by MemoryMapAllocationPool.
 std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
     size_t size);
 
+// `mapped_size` should be the mapped_size() of the writer allocation, which
+// is not 0 if the writer allocation is a cached block.
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
-    const std::string &ipc_name, size_t size);
+    const std::string &ipc_name, size_t size, size_t mapped_size = 0);
+
+/**
+ * MemoryMapAllocationPool caches the shared memory blocks created by the
+ * writer process, e.g., the DataLoader worker, so that the blocks are reused
+ * by the following batches instead of creating a new shared memory file for
+ * each tensor.
+ *
+ * The handshake between the writer and the reader is the state in the header
+ * of each block. The writer marks the block in use when allocating it, and
+ * the reader marks it free when the reader allocation is released, then the
+ * writer can reuse it. A block which is never sent to the reader, see
+ * MemoryMapWriterAllocation::MarkShared, is marked free by the writer
+ * allocation. When the writer exits, the free blocks are unlinked by the
+ * writer, and the blocks still in use are unlinked by their owners when they
+ * are released.
+ */
+class MemoryMapAllocationPool {
+ public:
+  static MemoryMapAllocationPool &Instance();  // NOLINT
+
+  std::shared_ptr<MemoryMapWriterAllocation> Allocate(size_t size);
+
+  // Return the block of a writer allocation which is not shared.
+  void Release(const std::string &ipc_name, size_t mapped_size);
+
+  // Unmap all the cached blocks, see the class comment for unlinking.
+  void Clear();
+
+  ~MemoryMapAllocationPool();
+
+ private:
+  MemoryMapAllocationPool() = default;
+
+  struct Block {
+    std::string ipc_name;
+    void *base;
+  };
+
+  // mapped size -> blocks, the mapped size is rounded up to power of 2.
+  std::unordered_map<size_t, std::vector<Block>> blocks_;
+  std::mutex mtx_;
+};
 
 class MemoryMapFdSet {
  public:
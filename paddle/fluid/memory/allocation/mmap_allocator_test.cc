@@ -16,14 +16,78 @@
 
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 
+#include <string>
+
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 
+DECLARE_bool(use_shm_cache);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
 
+TEST(MemoryMapAllocation, test_shm_cache) {
+  FLAGS_use_shm_cache = true;
+  size_t data_size = 4UL * 1024;
+  auto writer_holder = AllocateMemoryMapWriterAllocation(data_size);
+  std::string ipc_name = writer_holder->ipc_name();
+  size_t mapped_size = writer_holder->mapped_size();
+  ASSERT_GE(mapped_size, data_size + kMemoryMapBlockHeaderSize);
+  auto* writer_ptr = static_cast<int32_t*>(writer_holder->ptr());
+  for (int32_t i = 0; i < 1024; ++i) {
+    writer_ptr[i] = i;
+  }
+  writer_holder->MarkShared();
+  writer_holder.reset();
+
+  auto reader_holder =
+      RebuildMemoryMapReaderAllocation(ipc_name, data_size, mapped_size);
+  auto* reader_ptr = static_cast<int32_t*>(reader_holder->ptr());
+  for (int32_t i = 0; i < 1024; ++i) {
+    ASSERT_EQ(reader_ptr[i], i);
+  }
+
+  // The block is still in use by the reader, so a new one is created.
+  auto other_holder = AllocateMemoryMapWriterAllocation(data_size);
+  std::string other_ipc_name = other_holder->ipc_name();
+  ASSERT_NE(other_ipc_name, ipc_name);
+
+  // The block released by the reader is reused.
+  reader_holder.reset();
+  auto reused_holder = AllocateMemoryMapWriterAllocation(data_size);
+  ASSERT_EQ(reused_holder->ipc_name(), ipc_name);
+
+  // The block never sent is released by the writer and then reused.
+  other_holder.reset();
+  other_holder = AllocateMemoryMapWriterAllocation(data_size);
+  ASSERT_EQ(other_holder->ipc_name(), other_ipc_name);
+  other_holder.reset();
+
+  // The blocks in use are unlinked by the reader after the pool is cleared.
+  reused_holder->MarkShared();
+  reader_holder =
+      RebuildMemoryMapReaderAllocation(ipc_name, data_size, mapped_size);
+  reused_holder.reset();
+  MemoryMapAllocationPool::Instance().Clear();
+  reader_holder.reset();
+  ASSERT_EQ(shm_open(ipc_name.c_str(), O_RDONLY, 0644), -1);
+  // The free block is unlinked by the pool.
+  ASSERT_EQ(shm_open(other_ipc_name.c_str(), O_RDONLY, 0644), -1);
+
+  // The block never sent is unlinked by the writer after the pool is cleared.
+  auto orphan_holder = AllocateMemoryMapWriterAllocation(data_size);
+  std::string orphan_ipc_name = orphan_holder->ipc_name();
+  MemoryMapAllocationPool::Instance().Clear();
+  orphan_holder.reset();
+  ASSERT_EQ(shm_open(orphan_ipc_name.c_str(), O_RDONLY, 0644), -1);
+  FLAGS_use_shm_cache = false;
+}
+
 TEST(MemoryMapAllocation, test_allocation_base) {
   size_t data_size = 4UL * 1024;
   // 1. allocate writer holader
@@ -52,6 +52,9 @@ void Free(const Place &place, void *p, size_t size);
 template <typename Place>
 size_t Used(const Place &place);
 
+template <typename Place>
+void GetStats(const Place &place, allocation::AllocatorStats *stats);
+
 struct Usage : public boost::static_visitor<size_t> {
   size_t operator()(const platform::CPUPlace &cpu) const;
   size_t operator()(const platform::CUDAPlace &gpu) const;
@@ -100,6 +103,12 @@ size_t Used<platform::CPUPlace>(const platform::CPUPlace &place) {
   return GetCPUBuddyAllocator()->Used();
 }
 
+template <>
+void GetStats<platform::CPUPlace>(const platform::CPUPlace &place,
+                                  allocation::AllocatorStats *stats) {
+  GetCPUBuddyAllocator()->GetStats(stats);
+}
+
 #ifdef PADDLE_WITH_CUDA
 class GPUBuddyAllocatorList {
  private:
@@ -209,6 +218,16 @@ void Free<platform::CUDAPlace>(const platform::CUDAPlace &place, void *p,
 #endif
 }
 
+template <>
+void GetStats<platform::CUDAPlace>(const platform::CUDAPlace &place,
+                                   allocation::AllocatorStats *stats) {
+#ifdef PADDLE_WITH_CUDA
+  GetGPUBuddyAllocator(place.device)->GetStats(stats);
+#else
+  PADDLE_THROW("'CUDAPlace' is not supported in CPU only device.");
+#endif
+}
+
 #ifdef PADDLE_WITH_CUDA
 BuddyAllocator *GetCUDAPinnedBuddyAllocator() {
   static std::once_flag init_flag;
@@ -264,6 +283,16 @@ void Free<platform::CUDAPinnedPlace>(const platform::CUDAPinnedPlace &place,
 #endif
 }
 
+template <>
+void GetStats<platform::CUDAPinnedPlace>(
+    const platform::CUDAPinnedPlace &place, allocation::AllocatorStats *stats) {
+#ifdef PADDLE_WITH_CUDA
+  GetCUDAPinnedBuddyAllocator()->GetStats(stats);
+#else
+  PADDLE_THROW("'CUDAPinnedPlace' is not supported in CPU only device.");
+#endif
+}
+
 struct AllocVisitor : public boost::static_visitor<void *> {
   inline explicit AllocVisitor(size_t size) : size_(size) {}
 
@@ -276,6 +305,19 @@ struct AllocVisitor : public boost::static_visitor<void *> {
   size_t size_;
 };
 
+struct StatsVisitor : public boost::static_visitor<void> {
+  inline explicit StatsVisitor(allocation::AllocatorStats *stats)
+      : stats_(stats) {}
+
+  template <typename Place>
+  inline void operator()(const Place &place) const {
+    GetStats<Place>(place, stats_);
+  }
+
+ private:
+  allocation::AllocatorStats *stats_;
+};
+
 struct FreeVisitor : public boost::static_visitor<void> {
   inline explicit FreeVisitor(void *ptr, size_t size)
       : ptr_(ptr), size_(size) {}
@@ -321,6 +363,11 @@ Allocation *NaiveBestFitAllocator::AllocateImpl(size_t size) {
   return tmp_alloc;
 }
 
+bool NaiveBestFitAllocator::GetStats(AllocatorStats *stats) {
+  boost::apply_visitor(legacy::StatsVisitor(stats), place_);
+  return true;
+}
+
 void NaiveBestFitAllocator::FreeImpl(Allocation *allocation) {
   boost::apply_visitor(
       legacy::FreeVisitor(allocation->ptr(), allocation->size()),
@@ -30,6 +30,8 @@ class NaiveBestFitAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  bool GetStats(AllocatorStats *stats) override;
+
  protected:
   Allocation *AllocateImpl(size_t size) override;
   void FreeImpl(Allocation *allocation) override;
@@ -0,0 +1,58 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
+#include <utility>
+#include "paddle/fluid/platform/cpu_helper.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+NumaAllocator::NumaAllocator(
+    std::vector<std::shared_ptr<Allocator>> node_allocators)
+    : node_allocators_(std::move(node_allocators)) {
+  PADDLE_ENFORCE_GT(node_allocators_.size(), 0,
+                    platform::errors::InvalidArgument(
+                        "NumaAllocator needs at least one node allocator."));
+  for (auto &allocator : node_allocators_) {
+    PADDLE_ENFORCE_NOT_NULL(
+        allocator, platform::errors::InvalidArgument(
+                       "The node allocator of NumaAllocator cannot be null."));
+    PADDLE_ENFORCE_EQ(
+        allocator->IsAllocThreadSafe(), true,
+        platform::errors::InvalidArgument(
+            "The node allocator of NumaAllocator must be thread safe."));
+  }
+}
+
+Allocation *NumaAllocator::AllocateImpl(size_t size) {
+  size_t node = static_cast<size_t>(platform::GetCurrentNumaNode());
+  if (node >= node_allocators_.size()) node %= node_allocators_.size();
+  // The underlying allocator is registered in the allocation, and the
+  // default FreeImpl returns the allocation to it.
+  return node_allocators_[node]->Allocate(size).release();
+}
+
+size_t NumaAllocator::Release() {
+  size_t released_size = 0;
+  for (auto &allocator : node_allocators_) {
+    released_size += allocator->Release();
+  }
+  return released_size;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
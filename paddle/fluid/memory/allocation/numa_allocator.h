@@ -0,0 +1,52 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * NumaAllocator holds one underlying allocator per NUMA node, whose memory is
+ * bound to the node. Each allocation request is served by the allocator of
+ * the node which the calling thread is running on, so a thread bound to a
+ * node (see platform::BindThreadToNumaNode) only touches its local memory.
+ *
+ * The allocation is freed by the allocator which allocates it, no matter
+ * which thread frees it.
+ */
+class NumaAllocator : public Allocator {
+ public:
+  explicit NumaAllocator(
+      std::vector<std::shared_ptr<Allocator>> node_allocators);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t Release() override;
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+ private:
+  std::vector<std::shared_ptr<Allocator>> node_allocators_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
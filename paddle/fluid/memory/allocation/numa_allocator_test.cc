@@ -0,0 +1,56 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/numa_allocator.h"
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(NumaAllocator, alloc_on_local_node) {
+  int num_nodes = platform::GetNumaNodeCount();
+  std::vector<std::shared_ptr<Allocator>> node_allocators;
+  for (int node = 0; node < num_nodes; ++node) {
+    node_allocators.emplace_back(std::make_shared<CPUAllocator>(node));
+  }
+  auto allocator = std::make_shared<NumaAllocator>(node_allocators);
+
+  std::vector<std::thread> threads;
+  for (int node = 0; node < num_nodes; ++node) {
+    threads.emplace_back([=] {
+      platform::BindThreadToNumaNode(node);
+      for (size_t size : {1UL, 4096UL, 1UL << 20}) {
+        auto allocation = allocator->Allocate(size);
+        ASSERT_NE(allocation->ptr(), nullptr);
+        ASSERT_EQ(allocation->size(), size);
+        std::memset(allocation->ptr(), 0, size);
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+
+  // The allocation can be freed by any thread.
+  auto allocation = allocator->Allocate(1024);
+  std::thread([&] { allocation.reset(); }).join();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
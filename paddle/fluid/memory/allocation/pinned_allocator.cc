@@ -15,17 +15,39 @@
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
 #include <cuda.h>
 #include <cuda_runtime.h>
+#include "paddle/fluid/memory/detail/system_allocator.h"
 
 namespace paddle {
 namespace memory {
 namespace allocation {
+namespace {
+// The allocation mapped by detail::HugePageAlloc and registered to CUDA.
+class HugePageAllocation : public Allocation {
+ public:
+  using Allocation::Allocation;
+};
+}  // namespace
+
 bool CPUPinnedAllocator::IsAllocThreadSafe() const { return true; }
 void CPUPinnedAllocator::FreeImpl(Allocation *allocation) {
-  PADDLE_ENFORCE(cudaFreeHost(allocation->ptr()));
+  if (dynamic_cast<HugePageAllocation *>(allocation) != nullptr) {
+    PADDLE_ENFORCE(cudaHostUnregister(allocation->ptr()));
+    detail::HugePageFree(allocation->ptr(), allocation->size());
+  } else {
+    PADDLE_ENFORCE(cudaFreeHost(allocation->ptr()));
+  }
   delete allocation;
 }
 Allocation *CPUPinnedAllocator::AllocateImpl(size_t size) {
   void *ptr;
+  if (detail::UseHugePage(size) &&
+      (ptr = detail::HugePageAlloc(size)) != nullptr) {
+    if (cudaHostRegister(ptr, size, cudaHostRegisterPortable) ==
+        cudaSuccess) {
+      return new HugePageAllocation(ptr, size, platform::CUDAPinnedPlace());
+    }
+    detail::HugePageFree(ptr, size);
+  }
   PADDLE_ENFORCE(cudaHostAlloc(&ptr, size, cudaHostAllocPortable));
   return new Allocation(ptr, size, platform::CUDAPinnedPlace());
 }
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/pinned_staging_pool.h"
+#include <cstring>
+#include <utility>
+#include "gflags/gflags.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/gpu_info.h"
+
+DEFINE_uint64(gpu_pinned_staging_min_bytes, 1 << 20,
+              "The host to device copies on a stream of at least this many "
+              "bytes are staged in pinned memory, so that they do not wait "
+              "for the kernels in the stream. The smaller ones are copied "
+              "from the pageable memory directly.");
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+PinnedStagingPool &PinnedStagingPool::Instance() {
+  static PinnedStagingPool pool;
+  return pool;
+}
+
+bool PinnedStagingPool::Staged(size_t num) {
+  return num >= FLAGS_gpu_pinned_staging_min_bytes;
+}
+
+const platform::StreamCallbackManager &PinnedStagingPool::CallbackManager(
+    cudaStream_t stream) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto &manager = callback_managers_[stream];
+  if (manager == nullptr) {
+    manager.reset(new platform::StreamCallbackManager(stream));
+  }
+  return *manager;
+}
+
+void PinnedStagingPool::CopyToDevice(void *dst, const void *src, size_t num,
+                                     cudaStream_t stream) {
+  AllocationPtr buffer;
+  try {
+    buffer =
+        AllocatorFacade::Instance().Alloc(platform::CUDAPinnedPlace(), num);
+  } catch (BadAlloc &) {
+    VLOG(3) << "Failed to allocate " << num << " bytes of pinned memory for "
+            << "staging, copy from pageable memory directly.";
+    platform::GpuMemcpyAsync(dst, src, num, cudaMemcpyHostToDevice, stream);
+    return;
+  }
+  std::memcpy(buffer->ptr(), src, num);
+  platform::GpuMemcpyAsync(dst, buffer->ptr(), num, cudaMemcpyHostToDevice,
+                           stream);
+  // freed on the thread of the callbacks, which may call the CUDA API
+  auto *released = buffer.release();
+  CallbackManager(stream).AddCallback(
+      [released] { AllocationDeleter()(released); });
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,73 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/fluid/platform/stream_callback_manager.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * PinnedStagingPool copies pageable host memory to device asynchronously.
+ *
+ * cudaMemcpyAsync from pageable memory synchronizes the stream before the
+ * copy, so it cannot overlap with the kernels. Instead, the data is copied
+ * into a pinned buffer allocated from the caching CUDAPinnedPlace allocator
+ * first, then the pinned buffer is copied to device asynchronously. The
+ * pinned buffer is returned to the allocator by a callback of the stream
+ * after the copy completes.
+ *
+ * Staging costs a host copy and a callback, so only the copies of at least
+ * FLAGS_gpu_pinned_staging_min_bytes bytes are staged, see Staged.
+ *
+ * The source memory can be reused as soon as CopyToDevice returns, which is
+ * the same as cudaMemcpyAsync from pageable memory.
+ */
+class PinnedStagingPool {
+ public:
+  static PinnedStagingPool &Instance();
+
+  // Whether a copy of num bytes is worth staging.
+  static bool Staged(size_t num);
+
+  void CopyToDevice(void *dst, const void *src, size_t num,
+                    cudaStream_t stream);
+
+ private:
+  PinnedStagingPool() = default;
+
+  // The callbacks of a stream run in order on a thread of their own, where
+  // the buffers can be freed.
+  const platform::StreamCallbackManager &CallbackManager(cudaStream_t stream);
+
+  // Only guards callback_managers_, the copies are issued without it.
+  std::mutex mtx_;
+  std::unordered_map<cudaStream_t,
+                     std::unique_ptr<platform::StreamCallbackManager>>
+      callback_managers_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
+#endif
@@ -0,0 +1,115 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/registered_memory_allocator.h"
+#include <map>
+#include <mutex>  // NOLINT
+#include <utility>
+#include "glog/logging.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+// The registered memory ranges and the hooks of the transports, which are
+// shared by all the RegisteredMemoryAllocators.
+class MemoryRegistry {
+ public:
+  using RegisterFunc = RegisteredMemoryAllocator::RegisterFunc;
+
+  static MemoryRegistry &Instance() {
+    static MemoryRegistry *registry = new MemoryRegistry;
+    return *registry;
+  }
+
+  void AddHook(const std::string &name, RegisterFunc register_func,
+               RegisterFunc deregister_func) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    if (hooks_.count(name) > 0) return;
+    for (auto &range : ranges_) {
+      register_func(reinterpret_cast<void *>(range.first), range.second);
+    }
+    hooks_.emplace(name, std::make_pair(std::move(register_func),
+                                        std::move(deregister_func)));
+    VLOG(1) << "Add memory register hook " << name << ", " << ranges_.size()
+            << " allocated ranges are registered";
+  }
+
+  void Register(void *ptr, size_t size) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    for (auto &hook : hooks_) {
+      hook.second.first(ptr, size);
+    }
+    ranges_.emplace(reinterpret_cast<uintptr_t>(ptr), size);
+  }
+
+  void Deregister(void *ptr) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto iter = ranges_.find(reinterpret_cast<uintptr_t>(ptr));
+    if (iter == ranges_.end()) return;
+    for (auto &hook : hooks_) {
+      hook.second.second(ptr, iter->second);
+    }
+    ranges_.erase(iter);
+  }
+
+  bool IsRegistered(const std::string &name, const void *ptr, size_t size) {
+    auto addr = reinterpret_cast<uintptr_t>(ptr);
+    std::lock_guard<std::mutex> guard(mtx_);
+    if (hooks_.count(name) == 0) return false;
+    auto iter = ranges_.upper_bound(addr);
+    if (iter == ranges_.begin()) return false;
+    --iter;
+    return addr + size <= iter->first + iter->second;
+  }
+
+ private:
+  std::mutex mtx_;
+  // the start address to the size
+  std::map<uintptr_t, size_t> ranges_;
+  std::map<std::string, std::pair<RegisterFunc, RegisterFunc>> hooks_;
+};
+
+}  // namespace
+
+constexpr size_t RegisteredMemoryAllocator::kChunkSize;
+
+void RegisteredMemoryAllocator::AddHook(const std::string &name,
+                                        RegisterFunc register_func,
+                                        RegisterFunc deregister_func) {
+  MemoryRegistry::Instance().AddHook(name, std::move(register_func),
+                                     std::move(deregister_func));
+}
+
+bool RegisteredMemoryAllocator::IsRegistered(const std::string &name,
+                                             const void *ptr, size_t size) {
+  return MemoryRegistry::Instance().IsRegistered(name, ptr, size);
+}
+
+Allocation *RegisteredMemoryAllocator::AllocateImpl(size_t size) {
+  auto allocation = underlying_allocator_->Allocate(size);
+  MemoryRegistry::Instance().Register(allocation->ptr(), allocation->size());
+  return allocation.release();
+}
+
+void RegisteredMemoryAllocator::FreeImpl(Allocation *allocation) {
+  MemoryRegistry::Instance().Deregister(allocation->ptr());
+  underlying_allocator_->Free(allocation);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
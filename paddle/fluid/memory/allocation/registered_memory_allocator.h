@@ -0,0 +1,71 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * RegisteredMemoryAllocator registers every allocation of the underlying
+ * allocator to the transports, e.g., as the memory regions of RDMA, so that
+ * the tensors allocated from it are sent by the transports directly without
+ * being copied into the transport buffers.
+ *
+ * Registering memory is expensive, so it is used as the underlying allocator
+ * of an AutoGrowthBestFitAllocator with a large chunk size, i.e., each chunk
+ * is registered once and reused by many tensors.
+ *
+ * A transport adds its hook by AddHook(). The memory allocated before the
+ * hook is added is registered to it at once.
+ */
+class RegisteredMemoryAllocator : public Allocator {
+ public:
+  using RegisterFunc = std::function<void(void *ptr, size_t size)>;
+
+  static constexpr size_t kChunkSize = 64UL << 20;
+
+  explicit RegisteredMemoryAllocator(
+      std::shared_ptr<Allocator> underlying_allocator)
+      : underlying_allocator_(std::move(underlying_allocator)) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Add the hooks of a transport, which are called when memory is allocated
+  // and freed. Adding the hooks of the same name again is a no-op.
+  static void AddHook(const std::string &name, RegisterFunc register_func,
+                      RegisterFunc deregister_func);
+
+  // Whether [ptr, ptr + size) is registered to the hooks of name.
+  static bool IsRegistered(const std::string &name, const void *ptr,
+                           size_t size);
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,78 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/registered_memory_allocator.h"
+#include <map>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(RegisteredMemoryAllocator, register_chunks) {
+  size_t alignment = CPUAllocator::kAlignment;
+  auto allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      std::make_shared<RegisteredMemoryAllocator>(
+          std::make_shared<CPUAllocator>()),
+      alignment, 1 << 20);
+
+  // the memory allocated before the hook is added
+  auto early = allocator->Allocate(1024);
+  EXPECT_FALSE(RegisteredMemoryAllocator::IsRegistered("test", early->ptr(),
+                                                       early->size()));
+
+  std::map<void *, size_t> registered;
+  int deregister_times = 0;
+  RegisteredMemoryAllocator::AddHook(
+      "test", [&](void *ptr, size_t size) { registered[ptr] = size; },
+      [&](void *ptr, size_t size) {
+        EXPECT_EQ(registered.at(ptr), size);
+        registered.erase(ptr);
+        ++deregister_times;
+      });
+  // adding the same hook again is a no-op
+  RegisteredMemoryAllocator::AddHook(
+      "test", [](void *, size_t) { FAIL(); }, [](void *, size_t) { FAIL(); });
+  EXPECT_EQ(registered.size(), 1UL);
+  EXPECT_TRUE(RegisteredMemoryAllocator::IsRegistered("test", early->ptr(),
+                                                      early->size()));
+  EXPECT_FALSE(RegisteredMemoryAllocator::IsRegistered("other", early->ptr(),
+                                                       early->size()));
+
+  // small allocations share the registered chunk
+  auto small = allocator->Allocate(4096);
+  EXPECT_EQ(registered.size(), 1UL);
+  EXPECT_TRUE(RegisteredMemoryAllocator::IsRegistered("test", small->ptr(),
+                                                      small->size()));
+
+  auto large = allocator->Allocate(4 << 20);
+  EXPECT_EQ(registered.size(), 2UL);
+  EXPECT_TRUE(RegisteredMemoryAllocator::IsRegistered("test", large->ptr(),
+                                                      large->size()));
+  EXPECT_FALSE(RegisteredMemoryAllocator::IsRegistered("test", large->ptr(),
+                                                       64 << 20));
+
+  early.reset();
+  small.reset();
+  large.reset();
+  allocator->Release();
+  EXPECT_EQ(deregister_times, 2);
+  EXPECT_TRUE(registered.empty());
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -40,6 +40,12 @@ class RetryAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  bool GetStats(AllocatorStats* stats) override {
+    return underlying_allocator_->GetStats(stats);
+  }
+
+  size_t Release() override { return underlying_allocator_->Release(); }
+
  protected:
   void FreeImpl(Allocation* allocation) override;
   Allocation* AllocateImpl(size_t size) override;
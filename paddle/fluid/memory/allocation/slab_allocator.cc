@@ -0,0 +1,195 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+constexpr size_t SlabAllocator::kMinSizeClassShift;
+constexpr size_t SlabAllocator::kMaxSizeClassShift;
+constexpr size_t SlabAllocator::kNumSizeClasses;
+constexpr size_t SlabAllocator::kMaxSlabObjectSize;
+constexpr size_t SlabAllocatorImpl::kTransferBatchSize;
+constexpr size_t SlabAllocatorImpl::kMaxThreadCacheBytes;
+constexpr size_t SlabAllocatorImpl::kMinSlabSize;
+
+namespace {
+
+// The free lists of one SlabAllocator cached by the current thread.
+class ThreadCache {
+ public:
+  explicit ThreadCache(std::shared_ptr<SlabAllocatorImpl> impl)
+      : impl_(std::move(impl)) {}
+
+  ~ThreadCache() {
+    for (size_t i = 0; i < free_objs_.size(); ++i) {
+      if (!free_objs_[i].empty()) {
+        impl_->ReleaseObjects(i, free_objs_[i].size(), &free_objs_[i]);
+      }
+    }
+  }
+
+  std::vector<void *> &FreeObjects(size_t index) { return free_objs_[index]; }
+
+ private:
+  std::shared_ptr<SlabAllocatorImpl> impl_;
+  std::array<std::vector<void *>, SlabAllocator::kNumSizeClasses> free_objs_;
+};
+
+class ThreadCacheMap {
+ public:
+  static ThreadCacheMap &Instance() {
+    static thread_local ThreadCacheMap map;
+    return map;
+  }
+
+  ThreadCache *Get(const std::shared_ptr<SlabAllocatorImpl> &impl) {
+    if (LIKELY(last_id_ == impl->id())) {
+      return last_cache_;
+    }
+    auto &cache = caches_[impl->id()];
+    if (cache == nullptr) {
+      cache.reset(new ThreadCache(impl));
+    }
+    last_id_ = impl->id();
+    last_cache_ = cache.get();
+    return last_cache_;
+  }
+
+ private:
+  ThreadCacheMap() = default;
+
+  std::unordered_map<uint64_t, std::unique_ptr<ThreadCache>> caches_;
+  uint64_t last_id_{0};
+  ThreadCache *last_cache_{nullptr};
+};
+
+static uint64_t NextSlabAllocatorId() {
+  static std::atomic<uint64_t> id{0};
+  return ++id;
+}
+
+}  // namespace
+
+void SlabAllocatorImpl::FetchObjects(size_t index, size_t num,
+                                     std::vector<void *> *objs) {
+  auto &size_class = size_classes_[index];
+  std::lock_guard<std::mutex> guard(size_class.mtx);
+  if (size_class.free_objs.empty()) {
+    AllocateSlab(index);
+  }
+  auto &free_objs = size_class.free_objs;
+  num = std::min(num, free_objs.size());
+  objs->insert(objs->end(), free_objs.end() - num, free_objs.end());
+  free_objs.resize(free_objs.size() - num);
+}
+
+void SlabAllocatorImpl::ReleaseObjects(size_t index, size_t num,
+                                       std::vector<void *> *objs) {
+  auto &size_class = size_classes_[index];
+  std::lock_guard<std::mutex> guard(size_class.mtx);
+  size_class.free_objs.insert(size_class.free_objs.end(), objs->end() - num,
+                              objs->end());
+  objs->resize(objs->size() - num);
+}
+
+// NOTE: It is called when the mutex of the size class is held.
+void SlabAllocatorImpl::AllocateSlab(size_t index) {
+  size_t obj_size = SlabAllocator::SizeClassSize(index);
+  size_t slab_size = std::max(kMinSlabSize, obj_size * kTransferBatchSize);
+  auto slab = underlying_allocator_->Allocate(slab_size);
+  auto *ptr = reinterpret_cast<uint8_t *>(slab->ptr());
+  size_t obj_num = slab->size() / obj_size;
+  VLOG(10) << "Allocate slab of " << slab->size() << " bytes for size class "
+           << obj_size;
+
+  auto &free_objs = size_classes_[index].free_objs;
+  free_objs.reserve(free_objs.size() + obj_num);
+  for (size_t i = obj_num; i > 0; --i) {
+    free_objs.emplace_back(ptr + (i - 1) * obj_size);
+  }
+
+  std::lock_guard<std::mutex> guard(slabs_mtx_);
+  slabs_.emplace_back(std::move(slab));
+}
+
+SlabAllocator::SlabAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                             const platform::Place &place)
+    : underlying_allocator_(std::move(underlying_allocator)),
+      impl_(std::make_shared<SlabAllocatorImpl>(underlying_allocator_,
+                                                NextSlabAllocatorId())),
+      place_(place) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator must not be null"));
+  PADDLE_ENFORCE_EQ(
+      underlying_allocator_->IsAllocThreadSafe(), true,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator must be thread-safe"));
+}
+
+size_t SlabAllocator::SizeClassIndex(size_t size) {
+  size_t index = 0;
+  while (SizeClassSize(index) < size) {
+    ++index;
+  }
+  return index;
+}
+
+Allocation *SlabAllocator::AllocateImpl(size_t size) {
+  if (size > kMaxSlabObjectSize) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+
+  size_t index = SizeClassIndex(size);
+  auto &free_objs = ThreadCacheMap::Instance().Get(impl_)->FreeObjects(index);
+  if (free_objs.empty()) {
+    impl_->FetchObjects(index, SlabAllocatorImpl::kTransferBatchSize,
+                        &free_objs);
+  }
+  void *ptr = free_objs.back();
+  free_objs.pop_back();
+  return new Allocation(ptr, SizeClassSize(index), place_);
+}
+
+void SlabAllocator::FreeImpl(Allocation *allocation) {
+  if (allocation->size() > kMaxSlabObjectSize) {
+    underlying_allocator_->Free(allocation);
+    return;
+  }
+
+  size_t index = SizeClassIndex(allocation->size());
+  auto &free_objs = ThreadCacheMap::Instance().Get(impl_)->FreeObjects(index);
+  free_objs.emplace_back(allocation->ptr());
+  delete allocation;
+
+  size_t max_cached_num =
+      SlabAllocatorImpl::kMaxThreadCacheBytes / SizeClassSize(index);
+  if (free_objs.size() > max_cached_num) {
+    impl_->ReleaseObjects(index, SlabAllocatorImpl::kTransferBatchSize,
+                          &free_objs);
+  }
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
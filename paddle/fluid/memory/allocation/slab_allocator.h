@@ -0,0 +1,121 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class SlabAllocatorImpl;
+
+/**
+ * SlabAllocator serves small allocations from power-of-two size classes.
+ *
+ * Each size class is carved from slabs allocated by the underlying allocator.
+ * Freed objects are cached in a thread local free list first, so that most
+ * allocation and free requests do not need any lock. When the thread local
+ * free list is empty or too long, a batch of objects is moved from or to the
+ * central free list of the size class, which is protected by a mutex.
+ *
+ * Allocations larger than kMaxSlabObjectSize are forwarded to the underlying
+ * allocator directly. Slabs are never returned to the underlying allocator
+ * until the SlabAllocator and all thread local caches are destroyed.
+ */
+class SlabAllocator : public Allocator {
+ public:
+  static constexpr size_t kMinSizeClassShift = 6;   // 64 bytes
+  static constexpr size_t kMaxSizeClassShift = 12;  // 4096 bytes
+  static constexpr size_t kNumSizeClasses =
+      kMaxSizeClassShift - kMinSizeClassShift + 1;
+  static constexpr size_t kMaxSlabObjectSize = 1UL << kMaxSizeClassShift;
+
+  SlabAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                const platform::Place &place);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Returns the size class of `size`, where size must not be larger than
+  // kMaxSlabObjectSize.
+  static size_t SizeClassIndex(size_t size);
+
+  static size_t SizeClassSize(size_t index) {
+    return 1UL << (index + kMinSizeClassShift);
+  }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::shared_ptr<SlabAllocatorImpl> impl_;
+  platform::Place place_;
+};
+
+/**
+ * SlabAllocatorImpl holds the slabs and the central free lists. It is shared
+ * by the SlabAllocator and the thread local caches, so that the cached
+ * objects can be returned to it safely when a thread exits.
+ */
+class SlabAllocatorImpl {
+ public:
+  // The number of objects moved between thread local and central free lists.
+  static constexpr size_t kTransferBatchSize = 32;
+  // The maximum number of bytes cached in each thread local free list.
+  static constexpr size_t kMaxThreadCacheBytes = 256UL << 10;
+  // The minimum size of each slab.
+  static constexpr size_t kMinSlabSize = 64UL << 10;
+
+  SlabAllocatorImpl(std::shared_ptr<Allocator> underlying_allocator,
+                    uint64_t id)
+      : underlying_allocator_(std::move(underlying_allocator)), id_(id) {}
+
+  uint64_t id() const { return id_; }
+
+  // Append at most `num` free objects of size class `index` to `objs`.
+  void FetchObjects(size_t index, size_t num, std::vector<void *> *objs);
+
+  // Move `num` free objects from the back of `objs` to the central free list.
+  void ReleaseObjects(size_t index, size_t num, std::vector<void *> *objs);
+
+ private:
+  void AllocateSlab(size_t index);
+
+  struct SizeClass {
+    std::mutex mtx;
+    std::vector<void *> free_objs;
+  };
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  uint64_t id_;
+
+  std::array<SizeClass, SlabAllocator::kNumSizeClasses> size_classes_;
+
+  std::mutex slabs_mtx_;
+  std::vector<AllocationPtr> slabs_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
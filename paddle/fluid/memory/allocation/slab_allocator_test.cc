@@ -0,0 +1,130 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+#include <atomic>
+#include <cstdlib>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountedAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t AllocatedSize() const { return allocated_size_; }
+
+  size_t AllocatedNum() const { return allocated_num_; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    allocated_size_ += size;
+    ++allocated_num_;
+    return new Allocation(malloc(size), size, platform::CPUPlace());
+  }
+
+  void FreeImpl(Allocation *allocation) override {
+    allocated_size_ -= allocation->size();
+    --allocated_num_;
+    free(allocation->ptr());
+    delete allocation;
+  }
+
+ private:
+  std::atomic<size_t> allocated_size_{0};
+  std::atomic<size_t> allocated_num_{0};
+};
+
+TEST(SlabAllocator, size_class) {
+  ASSERT_EQ(SlabAllocator::SizeClassIndex(1), 0UL);
+  ASSERT_EQ(SlabAllocator::SizeClassIndex(64), 0UL);
+  ASSERT_EQ(SlabAllocator::SizeClassIndex(65), 1UL);
+  ASSERT_EQ(SlabAllocator::SizeClassIndex(300), 3UL);
+  ASSERT_EQ(SlabAllocator::SizeClassIndex(SlabAllocator::kMaxSlabObjectSize),
+            SlabAllocator::kNumSizeClasses - 1);
+  for (size_t i = 0; i < SlabAllocator::kNumSizeClasses; ++i) {
+    ASSERT_EQ(SlabAllocator::SizeClassIndex(SlabAllocator::SizeClassSize(i)),
+              i);
+  }
+}
+
+TEST(SlabAllocator, reuse_in_thread) {
+  auto underlying_allocator = std::make_shared<CountedAllocator>();
+  auto slab_allocator = std::make_shared<SlabAllocator>(underlying_allocator,
+                                                        platform::CPUPlace());
+
+  void *ptr = nullptr;
+  {
+    auto allocation = slab_allocator->Allocate(300);
+    ASSERT_EQ(allocation->size(), 512UL);
+    ASSERT_TRUE(platform::is_cpu_place(allocation->place()));
+    ptr = allocation->ptr();
+  }
+  ASSERT_EQ(underlying_allocator->AllocatedNum(), 1UL);
+
+  // The object freed by this thread is reused first.
+  auto allocation = slab_allocator->Allocate(400);
+  ASSERT_EQ(allocation->ptr(), ptr);
+  ASSERT_EQ(underlying_allocator->AllocatedNum(), 1UL);
+
+  // Large allocations are forwarded to the underlying allocator.
+  size_t large_size = SlabAllocator::kMaxSlabObjectSize + 1;
+  size_t allocated_size = underlying_allocator->AllocatedSize();
+  {
+    auto large_allocation = slab_allocator->Allocate(large_size);
+    ASSERT_EQ(large_allocation->size(), large_size);
+    ASSERT_EQ(underlying_allocator->AllocatedSize(),
+              allocated_size + large_size);
+  }
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), allocated_size);
+}
+
+TEST(SlabAllocator, multi_thread) {
+  auto underlying_allocator = std::make_shared<CountedAllocator>();
+  {
+    auto slab_allocator = std::make_shared<SlabAllocator>(
+        underlying_allocator, platform::CPUPlace());
+
+    const size_t kThreadNum = 8;
+    const size_t kAllocNum = 1000;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kThreadNum; ++i) {
+      threads.emplace_back([&slab_allocator, i, kAllocNum] {
+        std::vector<AllocationPtr> allocations;
+        for (size_t j = 0; j < kAllocNum; ++j) {
+          size_t size = (i * kAllocNum + j) % 2048 + 1;
+          allocations.emplace_back(slab_allocator->Allocate(size));
+          auto *p = reinterpret_cast<uint8_t *>(allocations.back()->ptr());
+          p[0] = p[size - 1] = static_cast<uint8_t>(j);
+        }
+        allocations.clear();
+      });
+    }
+    for (auto &th : threads) {
+      th.join();
+    }
+  }
+  // All slabs are returned after the allocator and thread caches are
+  // destroyed. The cache of the main thread is still alive, but it holds
+  // nothing of this allocator.
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 0UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
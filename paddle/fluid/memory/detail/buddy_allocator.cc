@@ -68,7 +68,9 @@ void* BuddyAllocator::Alloc(size_t unaligned_size) {
   // if the allocation is huge, send directly to the system allocator
   if (size > max_chunk_size_) {
     VLOG(10) << "Allocate from system allocator.";
-    return SystemAlloc(size);
+    void* p = SystemAlloc(size);
+    if (p != nullptr) stats_.RecordAllocate(size);
+    return p;
   }
 
   // query and allocate from the existing chunk
@@ -89,6 +91,7 @@ void* BuddyAllocator::Alloc(size_t unaligned_size) {
 
   total_used_ += size;
   total_free_ -= size;
+  stats_.RecordAllocate(size);
 
   // split the allocation and return data for use
   return reinterpret_cast<MemoryBlock*>(SplitToAlloc(it, size))->Data();
@@ -106,6 +109,7 @@ void BuddyAllocator::Free(void* p) {
   auto* desc = cache_.LoadDesc(block);
   if (desc->get_type() == MemoryBlock::HUGE_CHUNK) {
     VLOG(10) << "Free directly from system allocator";
+    stats_.RecordFree(desc->get_total_size());
     system_allocator_->Free(block, desc->get_total_size(), desc->get_index());
 
     // Invalidate GPU allocation from cache
@@ -118,6 +122,7 @@ void BuddyAllocator::Free(void* p) {
 
   total_used_ -= desc->get_total_size();
   total_free_ += desc->get_total_size();
+  stats_.RecordFree(desc->get_total_size());
 
   // Trying to merge the right buddy
   MemoryBlock* right_buddy = block->GetRightBuddy(&cache_);
@@ -167,6 +172,18 @@ size_t BuddyAllocator::Used() { return total_used_; }
 size_t BuddyAllocator::GetMinChunkSize() { return min_chunk_size_; }
 size_t BuddyAllocator::GetMaxChunkSize() { return max_chunk_size_; }
 
+void BuddyAllocator::GetStats(allocation::AllocatorStats* stats) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *stats = stats_;
+  // The huge chunks are freed to system directly, so only the pool caches.
+  stats->reserved_bytes = stats_.allocated_bytes + total_free_;
+  stats->largest_free_chunk_bytes = 0;
+  for (auto& item : pool_) {
+    stats->largest_free_chunk_bytes =
+        std::max(stats->largest_free_chunk_bytes, std::get<1>(item));
+  }
+}
+
 void* BuddyAllocator::SystemAlloc(size_t size) {
   size_t index = 0;
   void* p = system_allocator_->Alloc(&index, size);
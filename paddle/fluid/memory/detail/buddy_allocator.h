@@ -21,6 +21,7 @@ limitations under the License. */
 #include <unordered_map>
 #include <vector>
 
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/memory/detail/memory_block.h"
 #include "paddle/fluid/memory/detail/system_allocator.h"
 #include "paddle/fluid/platform/cpu_info.h"
@@ -43,6 +44,7 @@ class BuddyAllocator {
   size_t Used();
   size_t GetMinChunkSize();
   size_t GetMaxChunkSize();
+  void GetStats(allocation::AllocatorStats* stats);
 
  public:
   // Disable copy and assignment
@@ -84,6 +86,8 @@ class BuddyAllocator {
 
   size_t realloc_size_ = 0;  // the size of re-allocated chunk
 
+  allocation::AllocatorStats stats_;  // including the huge chunks
+
  private:
   /**
    * \brief A list of free allocation
@@ -310,6 +310,38 @@ TEST(BuddyAllocator, SpeedAna) {
 
 #endif
 
+TEST(BuddyAllocator, CpuStats) {
+  const size_t kMinChunkSize = 1 << 12;
+  const size_t kMaxChunkSize = 1 << 20;
+  BuddyAllocator buddy_allocator(
+      std::unique_ptr<SystemAllocator>(new CPUAllocator), kMinChunkSize,
+      kMaxChunkSize);
+
+  // The huge chunk is allocated from system directly, and its size is aligned
+  // to kMinChunkSize with the block metadata.
+  size_t huge_chunk_size = 2 * kMaxChunkSize + kMinChunkSize;
+
+  allocation::AllocatorStats stats;
+  void* p1 = buddy_allocator.Alloc(1000);
+  void* p2 = buddy_allocator.Alloc(2 * kMaxChunkSize);
+  buddy_allocator.GetStats(&stats);
+  EXPECT_EQ(stats.allocated_bytes, buddy_allocator.Used() + huge_chunk_size);
+  EXPECT_EQ(stats.reserved_bytes, stats.allocated_bytes + kMaxChunkSize -
+                                      buddy_allocator.Used());
+  EXPECT_EQ(stats.largest_free_chunk_bytes,
+            kMaxChunkSize - buddy_allocator.Used());
+
+  buddy_allocator.Free(p1);
+  buddy_allocator.Free(p2);
+  size_t peak_allocated_bytes = stats.peak_allocated_bytes;
+  buddy_allocator.GetStats(&stats);
+  EXPECT_EQ(stats.allocated_bytes, 0UL);
+  EXPECT_EQ(stats.peak_allocated_bytes, peak_allocated_bytes);
+  EXPECT_EQ(stats.reserved_bytes, kMaxChunkSize);
+  EXPECT_EQ(stats.largest_free_chunk_bytes, kMaxChunkSize);
+  EXPECT_DOUBLE_EQ(stats.FragmentationRatio(), 0.0);
+}
+
 }  // namespace detail
 }  // namespace memory
 }  // namespace paddle
@@ -23,6 +23,7 @@ limitations under the License. */
 #endif
 #include <stdlib.h>   // for malloc and free
 #include <algorithm>  // for std::max
+#include <fstream>
 #include <string>
 #include <utility>
 
@@ -36,6 +37,7 @@ limitations under the License. */
 #endif
 
 DECLARE_bool(use_pinned_memory);
+DECLARE_uint64(huge_page_threshold_mb);
 DECLARE_double(fraction_of_gpu_memory_to_use);
 DECLARE_uint64(initial_gpu_memory_in_mb);
 DECLARE_uint64(reallocate_gpu_memory_in_mb);
@@ -44,6 +46,96 @@ namespace paddle {
 namespace memory {
 namespace detail {
 
+// The index bits of the memory allocated by the CPU and CUDA pinned
+// allocators.
+static constexpr size_t kLockedMemory = 1;
+static constexpr size_t kHugePageMemory = 2;
+
+bool UseHugePage(size_t size) {
+#ifdef __linux__
+  return FLAGS_huge_page_threshold_mb > 0 &&
+         size >= (FLAGS_huge_page_threshold_mb << 20);
+#else
+  return false;
+#endif
+}
+
+#ifdef __linux__
+// The default size of hugetlbfs pages, which is also the alignment of the
+// mappings returned by HugePageAlloc.
+static size_t HugePageSize() {
+  static size_t huge_page_size = [] {
+    size_t size = 2UL << 20;
+    std::ifstream fin("/proc/meminfo");
+    std::string key;
+    size_t value;
+    while (fin >> key) {
+      if (key == "Hugepagesize:" && (fin >> value) && value > 0) {
+        size = value << 10;
+        break;
+      }
+    }
+    return size;
+  }();
+  return huge_page_size;
+}
+
+static size_t AlignToHugePage(size_t size) {
+  size_t huge_page_size = HugePageSize();
+  return (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+#endif
+
+void* HugePageAlloc(size_t size) {
+#ifdef __linux__
+  size_t aligned_size = AlignToHugePage(size);
+  void* p = mmap(nullptr, aligned_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (p != MAP_FAILED) return p;
+
+  // No hugetlbfs page is reserved, so map more memory than needed and trim
+  // it to be huge page aligned, then the kernel can back it with
+  // transparent huge pages.
+  size_t huge_page_size = HugePageSize();
+  size_t map_size = aligned_size + huge_page_size;
+  p = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    LOG(WARNING) << "Failed to map " << size << " bytes of huge pages.";
+    return nullptr;
+  }
+  auto begin = reinterpret_cast<uintptr_t>(p);
+  auto aligned_begin =
+      (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+  if (aligned_begin > begin) {
+    munmap(p, aligned_begin - begin);
+  }
+  size_t tail = begin + map_size - (aligned_begin + aligned_size);
+  if (tail > 0) {
+    munmap(reinterpret_cast<void*>(aligned_begin + aligned_size), tail);
+  }
+  p = reinterpret_cast<void*>(aligned_begin);
+#ifdef MADV_HUGEPAGE
+  if (madvise(p, aligned_size, MADV_HUGEPAGE) != 0) {
+    VLOG(3) << "Transparent huge pages are not available.";
+  }
+#endif
+  return p;
+#else
+  return nullptr;
+#endif
+}
+
+void HugePageFree(void* p, size_t size) {
+#ifdef __linux__
+  if (p != nullptr) {
+    PADDLE_ENFORCE_EQ(munmap(p, AlignToHugePage(size)), 0,
+                      platform::errors::Fatal(
+                          "Failed to unmap %d bytes of huge pages.", size));
+  }
+#endif
+}
+
 void* AlignedMalloc(size_t size) {
   void* p = nullptr;
   size_t alignment = 32ul;
@@ -70,11 +162,18 @@ void* CPUAllocator::Alloc(size_t* index, size_t size) {
 
   *index = 0;  // unlock memory
 
-  void* p = AlignedMalloc(size);
+  void* p = nullptr;
+  if (UseHugePage(size)) {
+    p = HugePageAlloc(size);
+    if (p != nullptr) *index |= kHugePageMemory;
+  }
+  if (p == nullptr) {
+    p = AlignedMalloc(size);
+  }
 
   if (p != nullptr) {
     if (FLAGS_use_pinned_memory) {
-      *index = 1;
+      *index |= kLockedMemory;
 #ifdef _WIN32
       VirtualLock(p, size);
 #else
@@ -87,13 +186,17 @@ void* CPUAllocator::Alloc(size_t* index, size_t size) {
 }
 
 void CPUAllocator::Free(void* p, size_t size, size_t index) {
-  if (p != nullptr && index == 1) {
+  if (p != nullptr && (index & kLockedMemory)) {
 #ifdef _WIN32
     VirtualUnlock(p, size);
 #else
     munlock(p, size);
 #endif
   }
+  if (index & kHugePageMemory) {
+    HugePageFree(p, size);
+    return;
+  }
 #ifdef _WIN32
   _aligned_free(p);
 #else
@@ -179,12 +282,26 @@ void* CUDAPinnedAllocator::Alloc(size_t* index, size_t size) {
     return nullptr;
   }
 
-  void* p;
-  // PINNED memory is visible to all CUDA contexts.
-  cudaError_t result = cudaHostAlloc(&p, size, cudaHostAllocPortable);
+  void* p = nullptr;
+  *index = kLockedMemory;  // PINNED memory
+  cudaError_t result = cudaErrorMemoryAllocation;
+  if (UseHugePage(size)) {
+    p = HugePageAlloc(size);
+    if (p != nullptr) {
+      result = cudaHostRegister(p, size, cudaHostRegisterPortable);
+      if (result == cudaSuccess) {
+        *index |= kHugePageMemory;
+      } else {
+        HugePageFree(p, size);
+      }
+    }
+  }
+  if (result != cudaSuccess) {
+    // PINNED memory is visible to all CUDA contexts.
+    result = cudaHostAlloc(&p, size, cudaHostAllocPortable);
+  }
 
   if (result == cudaSuccess) {
-    *index = 1;  // PINNED memory
     cuda_pinnd_alloc_size_ += size;
     return p;
   } else {
@@ -197,11 +314,16 @@ void* CUDAPinnedAllocator::Alloc(size_t* index, size_t size) {
 
 void CUDAPinnedAllocator::Free(void* p, size_t size, size_t index) {
   cudaError_t err;
-  PADDLE_ENFORCE_EQ(index, 1);
+  PADDLE_ENFORCE_EQ(index & kLockedMemory, kLockedMemory);
 
   PADDLE_ENFORCE_GE(cuda_pinnd_alloc_size_, size);
   cuda_pinnd_alloc_size_ -= size;
-  err = cudaFreeHost(p);
+  if (index & kHugePageMemory) {
+    err = cudaHostUnregister(p);
+    HugePageFree(p, size);
+  } else {
+    err = cudaFreeHost(p);
+  }
 
   // Purposefully allow cudaErrorCudartUnloading, because
   // that is returned if you ever call cudaFreeHost after the
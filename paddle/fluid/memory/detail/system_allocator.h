@@ -20,6 +20,17 @@ namespace paddle {
 namespace memory {
 namespace detail {
 
+// True if the allocation of `size` bytes should be backed by huge pages,
+// see FLAGS_huge_page_threshold_mb.
+bool UseHugePage(size_t size);
+
+// Map `size` bytes backed by hugetlbfs pages, or by transparent huge pages if
+// no hugetlbfs page is available. Returns nullptr if failed.
+void* HugePageAlloc(size_t size);
+
+// Unmap the memory returned by HugePageAlloc(size).
+void HugePageFree(void* p, size_t size);
+
 /**
  * \brief SystemAllocator is the parent class of CPUAllocator,
  *        CUDAPinnedAllocator and GPUAllocator. A BuddyAllocator
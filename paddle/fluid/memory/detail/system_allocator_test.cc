@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/detail/system_allocator.h"
 
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -22,6 +23,7 @@ limitations under the License. */
 #include "paddle/fluid/memory/allocation/allocator.h"
 
 DECLARE_bool(use_pinned_memory);
+DECLARE_uint64(huge_page_threshold_mb);
 
 void TestAllocator(paddle::memory::detail::SystemAllocator* a, size_t size) {
   bool freed = false;
@@ -57,6 +59,24 @@ TEST(CPUAllocator, LockMem) {
   TestAllocator(&a, 0);
 }
 
+TEST(CPUAllocator, HugePage) {
+  FLAGS_use_pinned_memory = false;
+  FLAGS_huge_page_threshold_mb = 1;
+  paddle::memory::detail::CPUAllocator a;
+  TestAllocator(&a, 2048);
+  TestAllocator(&a, 1 << 20);
+  TestAllocator(&a, (3 << 20) + 1);
+
+  size_t index;
+  size_t size = 4 << 20;
+  void* p = a.Alloc(&index, size);
+  ASSERT_NE(p, nullptr);
+  // The whole range should be writable.
+  memset(p, 1, size);
+  a.Free(p, size, index);
+  FLAGS_huge_page_threshold_mb = 0;
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(GPUAllocator, Alloc) {
   paddle::memory::detail::GPUAllocator a(0);
@@ -36,5 +36,14 @@ extern AllocationPtr Alloc(const platform::Place& place, size_t size);
 
 extern AllocationPtr Alloc(const platform::DeviceContext& dev_ctx, size_t size);
 
+// Release the cached memory of `place`, and returns the released bytes.
+extern size_t Release(const platform::Place& place);
+
+// Record that `allocation` is used on the stream of `dev_ctx`, so that the
+// memory would be reused on that stream without synchronization after it is
+// freed. It only takes effect when FLAGS_allocator_strategy=auto_growth.
+extern void RecordStream(Allocation* allocation,
+                         const platform::DeviceContext& dev_ctx);
+
 }  // namespace memory
 }  // namespace paddle
@@ -16,6 +16,9 @@ limitations under the License. */
 
 #include <cstring>  // for memcpy
 #include "paddle/fluid/platform/enforce.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/pinned_staging_pool.h"
+#endif
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -81,7 +84,13 @@ void Copy<platform::CUDAPlace, platform::CPUPlace>(
   platform::SetDeviceId(dst_place.device);
   VLOG(4) << "memory::Copy " << num << " Bytes from " << src_place << " to "
           << dst_place << " by thream(" << stream << ")";
-  if (stream) {
+  if (stream && allocation::PinnedStagingPool::Staged(num)) {
+    platform::RecordEvent record_event("GpuMemcpyAsync:CPU->GPU");
+    // Stage the pageable memory in pinned memory, otherwise the copy would
+    // wait for all the kernels in the stream.
+    allocation::PinnedStagingPool::Instance().CopyToDevice(dst, src, num,
+                                                           stream);
+  } else if (stream) {
     platform::RecordEvent record_event("GpuMemcpyAsync:CPU->GPU");
     platform::GpuMemcpyAsync(dst, src, num, cudaMemcpyHostToDevice, stream);
   } else {
@@ -949,7 +949,19 @@ REGISTER_OPERATOR(
     ops::ActivationOpDoubleGrad2<ops::ReluGradFunctor<float>::FwdDeps()>,
     ops::ActivationDoubleGradOpInplaceInferer);
 
-REGISTER_ACTIVATION_CPU_KERNEL(relu, Relu, ReluFunctor, ReluGradFunctor);
+REGISTER_OP_CPU_KERNEL(
+    relu,
+    ops::ActivationKernel<plat::CPUDeviceContext, ops::ReluFunctor<float>>,
+    ops::ActivationKernel<plat::CPUDeviceContext, ops::ReluFunctor<double>>,
+    ops::ActivationKernel<plat::CPUDeviceContext,
+                          ops::ReluFunctor<plat::bfloat16>>);
+REGISTER_OP_CPU_KERNEL(
+    relu_grad, ops::ActivationGradKernel<plat::CPUDeviceContext,
+                                         ops::ReluGradFunctor<float>>,
+    ops::ActivationGradKernel<plat::CPUDeviceContext,
+                              ops::ReluGradFunctor<double>>,
+    ops::ActivationGradKernel<plat::CPUDeviceContext,
+                              ops::ReluGradFunctor<plat::bfloat16>>);
 
 REGISTER_OP_CPU_KERNEL(
     relu_grad_grad,
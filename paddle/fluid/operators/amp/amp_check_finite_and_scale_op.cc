@@ -76,10 +76,13 @@ Check if input X contains all finite data, if yes, scale it by input Scale.
 $$Out = X * scale$$
 
 If any tensor in X contains Inf or Nan, the Out will generate a indicator.
-FoundInfinite will be 1 (True), and Out will not be scaled. In this case, the data of 
-Out should not be used, and its data may not be deterministic. 
+FoundInfinite will be 1 (True), and all the tensors of Out will be zeros,
+so that the step running on them does not change the parameters.
 Otherwise, FoundInfinite will be 0 (False).
 
+On GPU, all the tensors of X are checked and scaled by a fixed number of
+kernel launches, whatever the number of tensors is.
+
 )DOC");
   }
 };
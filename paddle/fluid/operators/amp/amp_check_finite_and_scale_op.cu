@@ -13,22 +13,66 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <cuda.h>
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/amp/amp_check_finite_and_scale_op.h"
 #include "paddle/fluid/platform/float16.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename T>
-__global__ void AmpCheckFiniteAndScale(const T* in, const T* scale, int num,
-                                       int* found_inf, T* out) {
-  const int idx = threadIdx.x + blockIdx.x * blockDim.x;
+// The tensors of X are checked and scaled by one launch each, whatever the
+// number of tensors is. starts[i] is the offset of the i-th tensor in the
+// elements of all the tensors, and starts[n] is the total number. Return the
+// index of the tensor holding the element idx, searching from the tensor lo.
+__device__ __forceinline__ int TensorIndex(const int64_t* starts, int lo,
+                                           int n, int64_t idx) {
+  int hi = n - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (starts[mid] <= idx) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
 
-  if (idx < num) {
-    if (!isfinite(in[idx])) {
-      *found_inf = 1;
+template <typename T>
+__global__ void AmpCheckFiniteMultiTensor(const T* const* xs,
+                                          const int64_t* starts, int n,
+                                          bool* found_inf) {
+  int64_t idx = threadIdx.x + static_cast<int64_t>(blockIdx.x) * blockDim.x;
+  int64_t stride = static_cast<int64_t>(blockDim.x) * gridDim.x;
+  int64_t total = starts[n];
+  if (idx >= total) return;
+  int t = TensorIndex(starts, 0, n, idx);
+  for (; idx < total; idx += stride) {
+    // A stride may cross many small tensors, so search instead of stepping.
+    if (idx >= starts[t + 1]) t = TensorIndex(starts, t + 1, n, idx);
+    if (!isfinite(xs[t][idx - starts[t]])) {
+      *found_inf = true;
     }
-    out[idx] = *found_inf ? in[idx] : in[idx] * scale[0];
+  }
+}
+
+template <typename T>
+__global__ void AmpScaleMultiTensor(const T* const* xs, T* const* outs,
+                                    const int64_t* starts, int n,
+                                    const T* scale, const bool* found_inf) {
+  int64_t idx = threadIdx.x + static_cast<int64_t>(blockIdx.x) * blockDim.x;
+  int64_t stride = static_cast<int64_t>(blockDim.x) * gridDim.x;
+  int64_t total = starts[n];
+  if (idx >= total) return;
+  const bool zero = *found_inf;
+  int t = TensorIndex(starts, 0, n, idx);
+  for (; idx < total; idx += stride) {
+    if (idx >= starts[t + 1]) t = TensorIndex(starts, t + 1, n, idx);
+    int64_t offset = idx - starts[t];
+    outs[t][offset] = zero ? static_cast<T>(0) : xs[t][offset] * scale[0];
   }
 }
 
@@ -44,23 +88,44 @@ class AmpCheckFiniteAndScaleKernel<platform::CUDADeviceContext, T>
     auto* found_inf = ctx.Output<framework::Tensor>("FoundInfinite");
 
     const T* scale_data = scale->data<T>();
-    int* found_inf_data = found_inf->mutable_data<int>(dev_ctx.GetPlace());
-    cudaMemset(found_inf_data, false, found_inf->numel() * sizeof(bool));
+    bool* found_inf_data = found_inf->mutable_data<bool>(dev_ctx.GetPlace());
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemsetAsync(
+        found_inf_data, 0, found_inf->numel() * sizeof(bool),
+        dev_ctx.stream()));
 
-    for (size_t i = 0; i < xs.size(); ++i) {
-      const auto* x = xs[i];
-      auto* out = outs[i];
-      const T* x_data = x->data<T>();
-      T* out_data = out->mutable_data<T>(dev_ctx.GetPlace());
-
-      int num = x->numel();
-      int block = 512;
-      int grid = (num + block - 1) / block;
-      VLOG(3) << "launch kernel";
-      AmpCheckFiniteAndScale<T><<<grid, block, 0, dev_ctx.stream()>>>(
-          x_data, scale_data, num, found_inf_data, out_data);
-      VLOG(3) << "finish kernel";
+    // The pointers of X and Out and the starts are copied to the device in
+    // one buffer, laid out as [xs | outs | starts].
+    int n = static_cast<int>(xs.size());
+    std::vector<int64_t> host_buf(3 * n + 1);
+    int64_t total = 0;
+    for (int i = 0; i < n; ++i) {
+      host_buf[i] = reinterpret_cast<int64_t>(xs[i]->data<T>());
+      host_buf[n + i] = reinterpret_cast<int64_t>(
+          outs[i]->mutable_data<T>(dev_ctx.GetPlace()));
+      host_buf[2 * n + i] = total;
+      total += xs[i]->numel();
     }
+    host_buf[3 * n] = total;
+    if (total == 0) return;
+
+    size_t buf_size = host_buf.size() * sizeof(int64_t);
+    auto dev_buf = memory::Alloc(dev_ctx, buf_size);
+    memory::Copy(BOOST_GET_CONST(platform::CUDAPlace, dev_ctx.GetPlace()),
+                 dev_buf->ptr(), platform::CPUPlace(), host_buf.data(),
+                 buf_size, dev_ctx.stream());
+    auto* dev_data = reinterpret_cast<int64_t*>(dev_buf->ptr());
+    auto* xs_data = reinterpret_cast<const T* const*>(dev_data);
+    auto* outs_data = reinterpret_cast<T* const*>(dev_data + n);
+    const int64_t* starts_data = dev_data + 2 * n;
+
+    int block = 512;
+    int max_grid = std::max(dev_ctx.GetMaxPhysicalThreadCount() / block, 1);
+    int grid = static_cast<int>(
+        std::min<int64_t>((total + block - 1) / block, max_grid));
+    AmpCheckFiniteMultiTensor<T><<<grid, block, 0, dev_ctx.stream()>>>(
+        xs_data, starts_data, n, found_inf_data);
+    AmpScaleMultiTensor<T><<<grid, block, 0, dev_ctx.stream()>>>(
+        xs_data, outs_data, starts_data, n, scale_data, found_inf_data);
   }
 };
 }  // namespace operators
@@ -41,24 +41,26 @@ class AmpCheckFiniteAndScaleKernel : public framework::OpKernel<T> {
         ctx.AllocateTmpTensor<bool, DeviceContext>({1}, dev_ctx);
     bool* is_finite_data = is_finite.template data<bool>();
 
+    for (size_t i = 0; i < xs.size(); ++i) {
+      framework::TensorIsfinite(*xs[i], &is_finite);
+      if (!(*is_finite_data)) {
+        *found_inf_data = true;
+        break;
+      }
+    }
+
     auto& dev = *ctx.template device_context<DeviceContext>().eigen_device();
     for (size_t i = 0; i < xs.size(); ++i) {
-      const auto* x = xs[i];
       auto* out = outs[i];
       out->mutable_data<T>(dev_ctx.GetPlace());
-      if (!(*found_inf_data)) {
-        framework::TensorIsfinite(*x, &is_finite);
-        if (*is_finite_data) {
-          auto eigen_out = framework::EigenVector<T>::Flatten(*out);
-          auto eigen_in = framework::EigenVector<T>::Flatten(*x);
-          eigen_out.device(dev) = (*scale_data) * eigen_in;
-        } else {
-          *found_inf_data = true;
-          break;
-        }
+      auto eigen_out = framework::EigenVector<T>::Flatten(*out);
+      auto eigen_in = framework::EigenVector<T>::Flatten(*xs[i]);
+      if (*found_inf_data) {
+        eigen_out.device(dev) = eigen_out.constant(static_cast<T>(0));
+      } else {
+        eigen_out.device(dev) = (*scale_data) * eigen_in;
       }
     }
-    return;
   }
 };
 
@@ -238,9 +238,8 @@ class BatchNormKernel<platform::CUDADeviceContext, T>
           size_t workspace_size = 0;
           size_t reserve_space_size = 0;
           void *reserve_space_ptr = nullptr;
-          void *workspace_ptr = nullptr;
-          Tensor workspace_tensor;
-          // Create reserve space and workspace for batch norm.
+          // Create reserve space for batch norm, the workspace is the one
+          // shared by the cudnn calls on the stream.
           // Create tensor for each batchnorm op, it will be used in the
           // backward. Thus this tensor shouldn't be temp.
           auto *reserve_space = ctx.Output<Tensor>("ReserveSpace");
@@ -276,27 +275,30 @@ class BatchNormKernel<platform::CUDADeviceContext, T>
 
           reserve_space_ptr = reserve_space->mutable_data(
               ctx.GetPlace(), transformed_x.type(), reserve_space_size);
-          workspace_ptr = workspace_tensor.mutable_data(
-              ctx.GetPlace(), transformed_x.type(), workspace_size);
-          PADDLE_ENFORCE_CUDA_SUCCESS(
-              platform::dynload::cudnnBatchNormalizationForwardTrainingEx(
-                  handle, mode_, CUDNN_BATCHNORM_OPS_BN,
-                  CudnnDataType<T>::kOne(), CudnnDataType<T>::kZero(),
-                  data_desc_, transformed_x.template data<T>(), nullptr,
-                  nullptr, data_desc_, transformed_y.template data<T>(),
-                  bn_param_desc_, scale->template data<BatchNormParamType<T>>(),
-                  bias->template data<BatchNormParamType<T>>(), this_factor,
-                  mean_out->template mutable_data<BatchNormParamType<T>>(
-                      ctx.GetPlace()),
-                  variance_out->template mutable_data<BatchNormParamType<T>>(
-                      ctx.GetPlace()),
-                  epsilon,
-                  saved_mean->template mutable_data<BatchNormParamType<T>>(
-                      ctx.GetPlace()),
-                  saved_variance->template mutable_data<BatchNormParamType<T>>(
-                      ctx.GetPlace()),
-                  nullptr, workspace_ptr, workspace_size, reserve_space_ptr,
-                  reserve_space_size));
+          auto cudnn_func = [&](void *workspace_ptr) {
+            PADDLE_ENFORCE_CUDA_SUCCESS(
+                platform::dynload::cudnnBatchNormalizationForwardTrainingEx(
+                    handle, mode_, CUDNN_BATCHNORM_OPS_BN,
+                    CudnnDataType<T>::kOne(), CudnnDataType<T>::kZero(),
+                    data_desc_, transformed_x.template data<T>(), nullptr,
+                    nullptr, data_desc_, transformed_y.template data<T>(),
+                    bn_param_desc_,
+                    scale->template data<BatchNormParamType<T>>(),
+                    bias->template data<BatchNormParamType<T>>(), this_factor,
+                    mean_out->template mutable_data<BatchNormParamType<T>>(
+                        ctx.GetPlace()),
+                    variance_out->template mutable_data<BatchNormParamType<T>>(
+                        ctx.GetPlace()),
+                    epsilon,
+                    saved_mean->template mutable_data<BatchNormParamType<T>>(
+                        ctx.GetPlace()),
+                    saved_variance
+                        ->template mutable_data<BatchNormParamType<T>>(
+                            ctx.GetPlace()),
+                    nullptr, workspace_ptr, workspace_size, reserve_space_ptr,
+                    reserve_space_size));
+          };
+          dev_ctx.cudnn_workspace_handle().RunFunc(cudnn_func, workspace_size);
         }
 #endif
         if (!called) {
@@ -677,8 +679,6 @@ class BatchNormGradKernel<platform::CUDADeviceContext, T>
         if (compute_format == DataLayout::kNHWC) {
           called = true;
           size_t workspace_size = 0;
-          void *workspace_ptr = nullptr;
-          Tensor workspace_tensor;
           auto reserve_space_size = reserve_space->memory_size();
           // --------------- cudnn batchnorm workspace ---------------
           PADDLE_ENFORCE_CUDA_SUCCESS(
@@ -696,47 +696,48 @@ class BatchNormGradKernel<platform::CUDADeviceContext, T>
                       /*activationDesc=*/nullptr,
                       /*sizeInBytes=*/&workspace_size));
 
-          workspace_ptr = workspace_tensor.mutable_data(
-              ctx.GetPlace(), transformed_x.type(), workspace_size);
-
-          PADDLE_ENFORCE_CUDA_SUCCESS(
-              platform::dynload::cudnnBatchNormalizationBackwardEx(
-                  /*handle=*/dev_ctx.cudnn_handle(),
-                  /*mode=*/mode_,
-                  /*bnOps=*/CUDNN_BATCHNORM_OPS_BN,
-                  /*alphaDataDiff=*/CudnnDataType<T>::kOne(),
-                  /*betaDataDiff=*/CudnnDataType<T>::kZero(),
-                  /*alphaParamDiff=*/CudnnDataType<T>::kOne(),
-                  /*betaParamDiff=*/CudnnDataType<T>::kZero(),
-                  /*xDesc=*/data_desc_,
-                  /*xData=*/transformed_x.template data<T>(),
-                  /*yDesc=*/nullptr,
-                  /*yData=*/nullptr,
-                  /*dyDesc=*/data_desc_,
-                  /*dyData=*/transformed_d_y.template data<T>(),
-                  /*dzDesc=*/nullptr,
-                  /*dzData=*/nullptr,
-                  /*dxDesc=*/data_desc_,
-                  /*dxData=*/transformed_d_x.template mutable_data<T>(
-                      ctx.GetPlace()),
-                  /*dBnScaleBiasDesc=*/bn_param_desc_,
-                  /*bnScaleData=*/scale->template data<BatchNormParamType<T>>(),
-                  /*bnBiasData=*/nullptr,
-                  /*dBnScaleData=*/d_scale
-                      ->template mutable_data<BatchNormParamType<T>>(
-                          ctx.GetPlace()),
-                  /*dBnBiasData=*/d_bias
-                      ->template mutable_data<BatchNormParamType<T>>(
-                          ctx.GetPlace()),
-                  /*epsilon=*/epsilon,
-                  /*savedMean=*/saved_mean_data,
-                  /*savedInvVariance=*/saved_var_data,
-                  /*activationDesc=*/nullptr,
-                  /*workspace=*/workspace_ptr,
-                  /*workSpaceSizeInBytes=*/workspace_size,
-                  /*reserveSpace=*/const_cast<T *>(
-                      reserve_space->template data<T>()),
-                  /*reserveSpaceSizeInBytes=*/reserve_space_size));
+          auto cudnn_func = [&](void *workspace_ptr) {
+            PADDLE_ENFORCE_CUDA_SUCCESS(
+                platform::dynload::cudnnBatchNormalizationBackwardEx(
+                    /*handle=*/dev_ctx.cudnn_handle(),
+                    /*mode=*/mode_,
+                    /*bnOps=*/CUDNN_BATCHNORM_OPS_BN,
+                    /*alphaDataDiff=*/CudnnDataType<T>::kOne(),
+                    /*betaDataDiff=*/CudnnDataType<T>::kZero(),
+                    /*alphaParamDiff=*/CudnnDataType<T>::kOne(),
+                    /*betaParamDiff=*/CudnnDataType<T>::kZero(),
+                    /*xDesc=*/data_desc_,
+                    /*xData=*/transformed_x.template data<T>(),
+                    /*yDesc=*/nullptr,
+                    /*yData=*/nullptr,
+                    /*dyDesc=*/data_desc_,
+                    /*dyData=*/transformed_d_y.template data<T>(),
+                    /*dzDesc=*/nullptr,
+                    /*dzData=*/nullptr,
+                    /*dxDesc=*/data_desc_,
+                    /*dxData=*/transformed_d_x.template mutable_data<T>(
+                        ctx.GetPlace()),
+                    /*dBnScaleBiasDesc=*/bn_param_desc_,
+                    /*bnScaleData=*/scale
+                        ->template data<BatchNormParamType<T>>(),
+                    /*bnBiasData=*/nullptr,
+                    /*dBnScaleData=*/d_scale
+                        ->template mutable_data<BatchNormParamType<T>>(
+                            ctx.GetPlace()),
+                    /*dBnBiasData=*/d_bias
+                        ->template mutable_data<BatchNormParamType<T>>(
+                            ctx.GetPlace()),
+                    /*epsilon=*/epsilon,
+                    /*savedMean=*/saved_mean_data,
+                    /*savedInvVariance=*/saved_var_data,
+                    /*activationDesc=*/nullptr,
+                    /*workspace=*/workspace_ptr,
+                    /*workSpaceSizeInBytes=*/workspace_size,
+                    /*reserveSpace=*/const_cast<T *>(
+                        reserve_space->template data<T>()),
+                    /*reserveSpaceSizeInBytes=*/reserve_space_size));
+          };
+          dev_ctx.cudnn_workspace_handle().RunFunc(cudnn_func, workspace_size);
         }
 #endif
         if (!called) {
@@ -63,6 +63,13 @@ class BeamSearchOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<bool>("is_accumulated",
                   "Whether the Input(scores) is accumulated scores.")
         .SetDefault(true);
+    AddAttr<bool>("is_logits",
+                  "Whether the Input(scores) is the logits over all the ids, "
+                  "the scores of the candidates are then Input(pre_scores) "
+                  "+ log_softmax(Input(scores)), and Input(ids) should not be "
+                  "set. It fuses the softmax, log and add of a decoding step "
+                  "into this operator, and is_accumulated is ignored.")
+        .SetDefault(false);
 
     AddComment(R"DOC(
 This operator does the search in beams for one time step.
@@ -100,12 +107,9 @@ class BeamSearchOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
-    auto *scores = ctx.Input<framework::LoDTensor>("scores");
-    size_t level = ctx.Attr<int>("level");
-    size_t batch_size = scores->lod()[level].size() - 1;
-    // The current CUDA kernel only support cases with batch_size < 4.
-    // Compute on CPU for cases with batch_size > 4.
-    if (batch_size <= 4) {
+    // The CUDA kernels support any batch size and width, but only the beams
+    // within the shared memory, compute on CPU for the larger beams.
+    if (ctx.Attr<int>("beam_size") <= math::kBeamSearchMaxBeamSizeOnGPU) {
       return framework::OpKernelType(
           OperatorWithKernel::IndicateVarDataType(ctx, "pre_ids"),
           ctx.GetPlace());
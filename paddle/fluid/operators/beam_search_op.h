@@ -43,6 +43,12 @@ class BeamSearchOpKernel : public framework::OpKernel<T> {
     size_t beam_size = context.Attr<int>("beam_size");
     int end_id = context.Attr<int>("end_id");
     bool is_accumulated = context.Attr<bool>("is_accumulated");
+    bool is_logits = context.Attr<bool>("is_logits");
+    PADDLE_ENFORCE_EQ(
+        is_logits && ids != nullptr, false,
+        platform::errors::InvalidArgument(
+            "Input(ids) of BeamSearchOp should not be set if is_logits is "
+            "true, the scores are the logits over all the ids."));
 
     auto selected_ids = context.Output<framework::LoDTensor>("selected_ids");
     auto selected_scores =
@@ -60,7 +66,7 @@ class BeamSearchOpKernel : public framework::OpKernel<T> {
     math::BeamSearchFunctor<DeviceContext, T> alg;
     alg(context.template device_context<DeviceContext>(), pre_ids, pre_scores,
         ids, scores, selected_ids, selected_scores, parent_idx, level,
-        beam_size, end_id, is_accumulated);
+        beam_size, end_id, is_accumulated, is_logits);
   }
 };
 
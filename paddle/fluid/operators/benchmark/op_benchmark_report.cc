@@ -0,0 +1,125 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_benchmark_report.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+static double Percentile(const std::vector<double>& sorted, double percent) {
+  size_t index = static_cast<size_t>(
+      std::ceil(percent / 100. * sorted.size()));
+  index = std::min(std::max<size_t>(index, 1), sorted.size());
+  return sorted[index - 1];
+}
+
+void ComputeLatencyStats(std::vector<double>* latencies_ms,
+                         OpBenchmarkResult* result) {
+  PADDLE_ENFORCE_EQ(latencies_ms->empty(), false,
+                    platform::errors::InvalidArgument(
+                        "No latency of %s is recorded.", result->key));
+  std::sort(latencies_ms->begin(), latencies_ms->end());
+  result->repeat = static_cast<int>(latencies_ms->size());
+  result->mean_ms =
+      std::accumulate(latencies_ms->begin(), latencies_ms->end(), 0.) /
+      latencies_ms->size();
+  result->median_ms = Percentile(*latencies_ms, 50);
+  result->p90_ms = Percentile(*latencies_ms, 90);
+  result->p99_ms = Percentile(*latencies_ms, 99);
+}
+
+static const char kKeyField[] = "\"key\": \"";
+static const char kMedianField[] = "\"median_ms\": ";
+
+void WriteJsonReport(const std::string& path,
+                     const std::vector<OpBenchmarkResult>& results) {
+  std::ofstream fout(path);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Cannot open file %s to write the report.", path));
+  fout << std::setprecision(6) << "[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto& result = results[i];
+    fout << "{" << kKeyField << result.key << "\", "
+         << "\"repeat\": " << result.repeat << ", "
+         << "\"mean_ms\": " << result.mean_ms << ", " << kMedianField
+         << result.median_ms << ", "
+         << "\"p90_ms\": " << result.p90_ms << ", "
+         << "\"p99_ms\": " << result.p99_ms << ", "
+         << "\"gflops\": " << result.gflops << ", "
+         << "\"gbps\": " << result.gbps << "}"
+         << (i + 1 == results.size() ? "\n" : ",\n");
+  }
+  fout << "]\n";
+}
+
+std::unordered_map<std::string, double> LoadBaseline(const std::string& path) {
+  std::ifstream fin(path);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                    platform::errors::Unavailable(
+                        "Cannot open the baseline file %s.", path));
+  std::unordered_map<std::string, double> baseline;
+  std::string line;
+  while (std::getline(fin, line)) {
+    auto key_pos = line.find(kKeyField);
+    auto median_pos = line.find(kMedianField);
+    if (key_pos == std::string::npos || median_pos == std::string::npos) {
+      continue;
+    }
+    key_pos += sizeof(kKeyField) - 1;
+    auto key_end = line.find('"', key_pos);
+    PADDLE_ENFORCE_NE(key_end, std::string::npos,
+                      platform::errors::InvalidArgument(
+                          "Invalid line of the baseline: %s", line));
+    std::istringstream is(
+        line.substr(median_pos + sizeof(kMedianField) - 1));
+    double median_ms = 0.;
+    is >> median_ms;
+    baseline[line.substr(key_pos, key_end - key_pos)] = median_ms;
+  }
+  return baseline;
+}
+
+std::vector<std::string> CompareWithBaseline(
+    const std::vector<OpBenchmarkResult>& results,
+    const std::unordered_map<std::string, double>& baseline,
+    double threshold) {
+  std::vector<std::string> regressions;
+  for (auto& result : results) {
+    auto iter = baseline.find(result.key);
+    if (iter == baseline.end()) {
+      LOG(WARNING) << "No baseline of " << result.key;
+      continue;
+    }
+    if (result.median_ms > iter->second * (1. + threshold)) {
+      std::ostringstream os;
+      os << result.key << ": median " << result.median_ms
+         << " ms, baseline " << iter->second << " ms";
+      regressions.push_back(os.str());
+    }
+  }
+  return regressions;
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,59 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+struct OpBenchmarkResult {
+  std::string key;
+  int repeat{0};
+  double mean_ms{0.0};
+  double median_ms{0.0};
+  double p90_ms{0.0};
+  double p99_ms{0.0};
+  // zero if the flops of the op are unknown
+  double gflops{0.0};
+  // the bytes of the inputs and outputs accessed per second
+  double gbps{0.0};
+};
+
+// The latencies are sorted in place.
+void ComputeLatencyStats(std::vector<double>* latencies_ms,
+                         OpBenchmarkResult* result);
+
+// One result per line, so that the baselines are diffable.
+void WriteJsonReport(const std::string& path,
+                     const std::vector<OpBenchmarkResult>& results);
+
+// The median latencies of a report written by WriteJsonReport, by the keys.
+std::unordered_map<std::string, double> LoadBaseline(const std::string& path);
+
+// Return the messages of the results slower than their baselines by more
+// than the threshold, e.g. 0.1 for 10%. The results without baselines are
+// not compared.
+std::vector<std::string> CompareWithBaseline(
+    const std::vector<OpBenchmarkResult>& results,
+    const std::unordered_map<std::string, double>& baseline,
+    double threshold);
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
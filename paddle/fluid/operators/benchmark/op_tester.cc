@@ -16,6 +16,7 @@ limitations under the License. */
 #include <fstream>
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_cost_estimator.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
@@ -30,6 +31,13 @@ namespace benchmark {
 
 DEFINE_string(op_config_list, "", "Path of op config file.");
 DEFINE_int32(specified_config_id, -1, "Test the specified op config.");
+DEFINE_string(op_benchmark_json, "",
+              "Path to write the benchmark results in JSON.");
+DEFINE_string(op_benchmark_baseline, "",
+              "Path of the JSON results to compare with, the test fails if "
+              "any op regresses.");
+DEFINE_double(op_benchmark_threshold, 0.1,
+              "The ratio of the median latency over the baseline allowed.");
 
 void OpTester::Init(const std::string &filename) {
   Init(OpTesterConfig(filename));
@@ -69,10 +77,23 @@ void OpTester::Run() {
     LOG(INFO) << DebugString();
   }
 
-  // Warm up
-  RunImpl();
+  for (int i = 0; i < config_.warmup; ++i) {
+    RunImpl();
+  }
+
+  std::vector<double> latencies;
+  latencies.reserve(config_.repeat);
+  auto run_repeat = [this, &latencies] {
+    platform::Timer timer;
+    for (int i = config_.repeat; i > 0; --i) {
+      timer.Reset();
+      timer.Start();
+      RunImpl();
+      timer.Pause();
+      latencies.push_back(timer.ElapsedMS());
+    }
+  };
 
-  platform::Timer timer;
   if (config_.profile) {
     if (platform::is_cpu_place(place_)) {
       platform::EnableProfiler(platform::ProfilerState::kCPU);
@@ -85,23 +106,52 @@ void OpTester::Run() {
 #endif
     }
 
-    timer.Start();
-    for (int i = config_.repeat; i > 0; --i) {
-      RunImpl();
-    }
-    timer.Pause();
+    run_repeat();
     platform::DisableProfiler(platform::EventSortingKey::kDefault,
                               "op_tester_profiler");
   } else {
-    timer.Start();
-    for (int i = config_.repeat; i > 0; --i) {
-      RunImpl();
-    }
-    timer.Pause();
+    run_repeat();
   }
-  config_.runtime = timer.ElapsedMS() / config_.repeat;
-  LOG(INFO) << "=== Run " << config_.repeat
-            << " times, latency: " << config_.runtime << " ms ===";
+
+  result_.key = config_.Key();
+  ComputeLatencyStats(&latencies, &result_);
+  config_.runtime = result_.mean_ms;
+  // the outputs of the last run are kept in the scope
+  double flops = EstimateFlops();
+  double bytes = AccessedBytes();
+  result_.gflops = flops / result_.median_ms / 1e6;
+  result_.gbps = bytes / result_.median_ms / 1e6;
+  LOG(INFO) << "=== " << result_.key << ": run " << config_.repeat
+            << " times, mean " << result_.mean_ms << " ms, median "
+            << result_.median_ms << " ms, p90 " << result_.p90_ms
+            << " ms, p99 " << result_.p99_ms << " ms, "
+            << (flops > 0 ? std::to_string(result_.gflops) + " GFLOP/s, "
+                          : std::string())
+            << result_.gbps << " GB/s ===";
+}
+
+static const framework::LoDTensor *FindTensor(const framework::Scope &scope,
+                                              const std::string &name) {
+  auto *var = scope.FindVar(name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) return nullptr;
+  auto &tensor = var->Get<framework::LoDTensor>();
+  return tensor.IsInitialized() ? &tensor : nullptr;
+}
+
+double OpTester::EstimateFlops() {
+  framework::OpCost cost;
+  return framework::OpCostRegistry::Instance().Estimate(*op_, *scope_, &cost)
+             ? cost.flops
+             : 0.;
+}
+
+double OpTester::AccessedBytes() {
+  double bytes = 0.;
+  for (auto &item : vars_) {
+    auto *tensor = FindTensor(*scope_, item.first);
+    if (tensor) bytes += tensor->memory_size();
+  }
+  return bytes;
 }
 
 void OpTester::RunImpl() {
@@ -492,21 +542,39 @@ TEST(op_tester, base) {
       OpTesterConfig config;
       bool result = config.Init(fin);
       if (result) {
-        op_configs.push_back(config);
+        for (auto &expanded : config.Expand()) {
+          op_configs.push_back(expanded);
+        }
       }
     }
+    std::vector<OpBenchmarkResult> results;
     if (FLAGS_specified_config_id >= 0 &&
         FLAGS_specified_config_id < static_cast<int>(op_configs.size())) {
       OpTester tester;
       tester.Init(op_configs[FLAGS_specified_config_id]);
       tester.Run();
+      results.push_back(tester.Result());
     } else {
       for (size_t i = 0; i < op_configs.size(); ++i) {
         OpTester tester;
         tester.Init(op_configs[i]);
         tester.Run();
+        results.push_back(tester.Result());
       }
     }
+
+    if (!FLAGS_op_benchmark_json.empty()) {
+      WriteJsonReport(FLAGS_op_benchmark_json, results);
+    }
+    if (!FLAGS_op_benchmark_baseline.empty()) {
+      auto baseline = LoadBaseline(FLAGS_op_benchmark_baseline);
+      auto regressions = CompareWithBaseline(results, baseline,
+                                             FLAGS_op_benchmark_threshold);
+      for (auto &regression : regressions) {
+        LOG(ERROR) << "Regression of " << regression;
+      }
+      EXPECT_TRUE(regressions.empty());
+    }
   } else {
     OpTester tester;
     OpTesterConfig config;
@@ -521,6 +589,40 @@ TEST(op_tester, base) {
   }
 }
 
+TEST(op_tester, sweep_and_report) {
+  std::istringstream is(
+      "{ op_type elementwise_add "
+      "input { name X; dims 8x16|16x16; } "
+      "input { name Y; dims 16; } "
+      "attrs { axis: -1|1; } }");
+  OpTesterConfig config;
+  ASSERT_TRUE(config.Init(is));
+  auto configs = config.Expand();
+  ASSERT_EQ(configs.size(), 4UL);
+  EXPECT_EQ(configs[0].Key(), "elementwise_add X:fp32:8x16 Y:fp32:16 axis=-1");
+  EXPECT_EQ(configs[3].Key(), "elementwise_add X:fp32:16x16 Y:fp32:16 axis=1");
+
+  std::vector<double> latencies;
+  for (int i = 100; i > 0; --i) {
+    latencies.push_back(i);
+  }
+  OpBenchmarkResult result;
+  result.key = configs[0].Key();
+  ComputeLatencyStats(&latencies, &result);
+  EXPECT_EQ(result.median_ms, 50.);
+  EXPECT_EQ(result.p90_ms, 90.);
+  EXPECT_EQ(result.p99_ms, 99.);
+  EXPECT_EQ(result.mean_ms, 50.5);
+
+  WriteJsonReport("op_benchmark_baseline.json", {result});
+  auto baseline = LoadBaseline("op_benchmark_baseline.json");
+  ASSERT_EQ(baseline.size(), 1UL);
+  EXPECT_EQ(baseline[result.key], 50.);
+  EXPECT_TRUE(CompareWithBaseline({result}, baseline, 0.1).empty());
+  result.median_ms = 56.;
+  EXPECT_EQ(CompareWithBaseline({result}, baseline, 0.1).size(), 1UL);
+}
+
 }  // namespace benchmark
 }  // namespace operators
 }  // namespace paddle
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/op_desc.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/operators/benchmark/op_benchmark_report.h"
 #include "paddle/fluid/operators/benchmark/op_tester_config.h"
 
 namespace paddle {
@@ -38,6 +39,8 @@ class OpTester {
 
   std::string DebugString();
 
+  const OpBenchmarkResult &Result() const { return result_; }
+
  private:
   std::vector<std::string> GetOpProtoInputNames();
   std::vector<std::string> GetOpProtoOutputNames();
@@ -59,6 +62,11 @@ class OpTester {
 
   void RunImpl();
 
+  // The flops by the OpCostRegistry, zero for the ops without the estimators.
+  double EstimateFlops();
+  // The bytes of the inputs and the outputs.
+  double AccessedBytes();
+
  private:
   OpTesterConfig config_;
   std::string type_;
@@ -68,6 +76,7 @@ class OpTester {
   std::unique_ptr<framework::OperatorBase> op_;
   platform::Place place_;
   std::unique_ptr<framework::Scope> scope_;
+  OpBenchmarkResult result_;
 };
 
 }  // namespace benchmark
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/benchmark/op_tester_config.h"
 #include <fstream>
+#include <map>
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -102,12 +103,20 @@ void OpInputConfig::ParseDims(std::istream& is) {
   std::string dims_str;
   is >> dims_str;
 
-  dims.clear();
-  std::string token;
-  std::istringstream token_stream(dims_str);
-  while (std::getline(token_stream, token, 'x')) {
-    dims.push_back(std::stoi(token));
+  EraseEndSep(&dims_str);
+
+  dims_sweep.clear();
+  for (auto& alternative : Split(dims_str, '|')) {
+    std::vector<int64_t> alternative_dims;
+    for (auto& token : Split(alternative, 'x')) {
+      alternative_dims.push_back(std::stoll(token));
+    }
+    dims_sweep.push_back(alternative_dims);
   }
+  PADDLE_ENFORCE_EQ(dims_sweep.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The dims of input %s are empty.", name));
+  dims = dims_sweep[0];
 }
 
 void OpInputConfig::ParseLoD(std::istream& is) {
@@ -169,6 +178,8 @@ bool OpTesterConfig::Init(std::istream& is) {
         is >> op_type;
       } else if (sep == "device_id" || sep == "device_id:") {
         is >> device_id;
+      } else if (sep == "warmup" || sep == "warmup:") {
+        is >> warmup;
       } else if (sep == "repeat" || sep == "repeat:") {
         is >> repeat;
       } else if (sep == "profile" || sep == "profile:") {
@@ -224,6 +235,59 @@ const OpInputConfig* OpTesterConfig::GetInput(const std::string& name) {
   return nullptr;
 }
 
+std::vector<OpTesterConfig> OpTesterConfig::Expand() const {
+  std::vector<OpTesterConfig> configs{*this};
+  for (auto& config : configs) {
+    for (auto& input : config.inputs) {
+      input.dims_sweep.clear();
+    }
+  }
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].dims_sweep.size() <= 1) continue;
+    std::vector<OpTesterConfig> expanded;
+    for (auto& config : configs) {
+      for (auto& dims : inputs[i].dims_sweep) {
+        expanded.push_back(config);
+        expanded.back().inputs[i].dims = dims;
+      }
+    }
+    configs.swap(expanded);
+  }
+
+  // sorted for the same order of the configs on every run
+  std::map<std::string, std::string> sorted_attrs(attrs.begin(), attrs.end());
+  for (auto& attr : sorted_attrs) {
+    auto values = Split(attr.second, '|');
+    if (values.size() <= 1) continue;
+    std::vector<OpTesterConfig> expanded;
+    for (auto& config : configs) {
+      for (auto& value : values) {
+        expanded.push_back(config);
+        expanded.back().attrs[attr.first] = value;
+      }
+    }
+    configs.swap(expanded);
+  }
+  return configs;
+}
+
+std::string OpTesterConfig::Key() const {
+  std::ostringstream os;
+  os << op_type;
+  for (auto& input : inputs) {
+    os << " " << input.name << ":" << input.dtype << ":";
+    for (size_t i = 0; i < input.dims.size(); ++i) {
+      os << (i == 0 ? "" : "x") << input.dims[i];
+    }
+  }
+  std::map<std::string, std::string> sorted_attrs(attrs.begin(), attrs.end());
+  for (auto& attr : sorted_attrs) {
+    os << " " << attr.first << "=" << attr.second;
+  }
+  return os.str();
+}
+
 }  // namespace benchmark
 }  // namespace operators
 }  // namespace paddle
@@ -38,6 +38,9 @@ struct OpInputConfig {
   std::string initializer{"random"};  // random, natural, zeros, file
   std::string filename{""};
   std::vector<int64_t> dims;
+  // The alternatives of the dims separated by '|', e.g. 16x64|32x64, swept
+  // by OpTesterConfig::Expand.
+  std::vector<std::vector<int64_t>> dims_sweep;
   std::vector<std::vector<size_t>> lod;
 };
 
@@ -51,10 +54,19 @@ struct OpTesterConfig {
 
   const OpInputConfig* GetInput(const std::string& name);
 
+  // The configs of all the combinations of the swept dims and attributes,
+  // the alternatives of an attribute are separated by '|', e.g. axis: 0|1.
+  std::vector<OpTesterConfig> Expand() const;
+
+  // The op type, the dtypes and dims of the inputs and the attributes,
+  // identifying a config in the benchmark reports.
+  std::string Key() const;
+
   std::string op_type;
   std::vector<OpInputConfig> inputs;
   std::unordered_map<std::string, std::string> attrs;
   int device_id{-1};  // CPU: -1
+  int warmup{1};
   int repeat{1};
   int profile{0};
   int print_debug_string{0};
@@ -70,6 +82,16 @@ static bool Has(const std::vector<std::string>& vec, const std::string& item) {
   return false;
 }
 
+static std::vector<std::string> Split(const std::string& str, char sep) {
+  std::vector<std::string> items;
+  std::string item;
+  std::istringstream is(str);
+  while (std::getline(is, item, sep)) {
+    items.push_back(item);
+  }
+  return items;
+}
+
 template <typename T>
 T StringTo(const std::string& str) {
   std::istringstream is(str);
@@ -0,0 +1,187 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/chunked_softmax_with_cross_entropy_op.h"
+#include <memory>
+
+namespace paddle {
+namespace operators {
+
+class ChunkedSoftmaxWithCrossEntropyOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Logits",
+             "(Tensor, default: Tensor<float>), The input tensor of unscaled "
+             "log probabilities, whose last dimension is the classes.");
+    AddInput("Label",
+             "(Tensor<int64>) The hard labels, in the same shape with "
+             "Input(Logits) except the last dimension as the number of true "
+             "labels T, each of them takes a probability of 1 / T.");
+    AddOutput("Loss",
+              "(Tensor, default: Tensor<float>), The cross entropy loss, in "
+              "the same shape with Input(Logits) except the last dimension "
+              "as 1.");
+    AddOutput("LogSumExp",
+              "(Tensor, default: Tensor<float>), The log of the "
+              "normalization of the softmax, in the same shape with "
+              "Output(Loss), which will be used in backward calculation.")
+        .AsIntermediate();
+    AddAttr<int>("ignore_index",
+                 "(int, default -100), Specifies a target value that is "
+                 "ignored and does not contribute to the loss and the input "
+                 "gradient.")
+        .SetDefault(-100);
+    AddAttr<int>("chunk_size",
+                 "(int, default 4096), The number of classes normalized at a "
+                 "time by the CPU kernel.")
+        .SetDefault(4096);
+    AddComment(R"DOC(
+Chunked Softmax With Cross Entropy Operator.
+
+Computes the same hard label loss as softmax_with_cross_entropy on the last
+axis, without storing the softmax of the logits. The log-sum-exp of every row
+is computed over the chunks of the classes with an online max, and the
+gradient recomputes the softmax from Input(Logits) and Output(LogSumExp).
+This saves the memory of a [batch, classes] activation for a large number of
+classes.
+
+Label can hold T true labels per row, e.g., the SampledLabels of
+sample_logits, each of them takes a probability of 1 / T:
+
+$$Loss_j = \frac{1}{T}\sum_{t=1}^{T}\left(-\text{Logit}_{Label_t} +
+\log\left(\sum_{i=0}^{K}\exp(\text{Logit}_i)\right)\right)$$
+
+)DOC");
+  }
+};
+
+class ChunkedSoftmaxWithCrossEntropyOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    OP_INOUT_CHECK(ctx->HasInput("Logits"), "Input", "Logits",
+                   "ChunkedSoftmaxWithCrossEntropy");
+    OP_INOUT_CHECK(ctx->HasInput("Label"), "Input", "Label",
+                   "ChunkedSoftmaxWithCrossEntropy");
+    OP_INOUT_CHECK(ctx->HasOutput("Loss"), "Output", "Loss",
+                   "ChunkedSoftmaxWithCrossEntropy");
+    OP_INOUT_CHECK(ctx->HasOutput("LogSumExp"), "Output", "LogSumExp",
+                   "ChunkedSoftmaxWithCrossEntropy");
+
+    auto logits_dims = ctx->GetInputDim("Logits");
+    auto labels_dims = ctx->GetInputDim("Label");
+    auto rank = logits_dims.size();
+    PADDLE_ENFORCE_EQ(rank, labels_dims.size(),
+                      platform::errors::InvalidArgument(
+                          "Input(Logits) and Input(Label) should have the "
+                          "same rank, but received %d and %d.",
+                          rank, labels_dims.size()));
+    for (int i = 0; i < rank - 1; i++) {
+      if (ctx->IsRuntime() || (logits_dims[i] > 0 && labels_dims[i] > 0)) {
+        PADDLE_ENFORCE_EQ(logits_dims[i], labels_dims[i],
+                          platform::errors::InvalidArgument(
+                              "Input(Logits) and Input(Label) should in "
+                              "same shape in dimensions except the last."));
+      }
+    }
+    PADDLE_ENFORCE_GT(ctx->Attrs().Get<int>("chunk_size"), 0,
+                      platform::errors::InvalidArgument(
+                          "Attr(chunk_size) should be greater than 0."));
+
+    logits_dims[rank - 1] = 1;
+    ctx->SetOutputDim("Loss", logits_dims);
+    ctx->SetOutputDim("LogSumExp", logits_dims);
+    ctx->ShareLoD("Logits", /*->*/ "Loss");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Logits"),
+        ctx.device_context());
+  }
+};
+
+class ChunkedSoftmaxWithCrossEntropyOpGrad
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    OP_INOUT_CHECK(ctx->HasInput("Logits"), "Input", "Logits",
+                   "ChunkedSoftmaxWithCrossEntropyGrad");
+    OP_INOUT_CHECK(ctx->HasInput("Label"), "Input", "Label",
+                   "ChunkedSoftmaxWithCrossEntropyGrad");
+    OP_INOUT_CHECK(ctx->HasInput("LogSumExp"), "Input", "LogSumExp",
+                   "ChunkedSoftmaxWithCrossEntropyGrad");
+    OP_INOUT_CHECK(ctx->HasInput(framework::GradVarName("Loss")), "Input",
+                   "Loss@GRAD", "ChunkedSoftmaxWithCrossEntropyGrad");
+    OP_INOUT_CHECK(ctx->HasOutput(framework::GradVarName("Logits")), "Output",
+                   "Logits@GRAD", "ChunkedSoftmaxWithCrossEntropyGrad");
+
+    ctx->SetOutputDim(framework::GradVarName("Logits"),
+                      ctx->GetInputDim("Logits"));
+    ctx->ShareLoD("Logits", framework::GradVarName("Logits"));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(OperatorWithKernel::IndicateVarDataType(
+                                       ctx, framework::GradVarName("Loss")),
+                                   ctx.device_context());
+  }
+};
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyGradMaker
+    : public framework::SingleGradOpMaker<T> {
+ public:
+  using framework::SingleGradOpMaker<T>::SingleGradOpMaker;
+
+ protected:
+  void Apply(GradOpPtr<T> grad_op) const override {
+    grad_op->SetType("chunked_softmax_with_cross_entropy_grad");
+    grad_op->SetInput("Logits", this->Input("Logits"));
+    grad_op->SetInput("Label", this->Input("Label"));
+    grad_op->SetInput("LogSumExp", this->Output("LogSumExp"));
+    grad_op->SetInput(framework::GradVarName("Loss"), this->OutputGrad("Loss"));
+    grad_op->SetOutput(framework::GradVarName("Logits"),
+                       this->InputGrad("Logits"));
+    grad_op->SetAttrMap(this->Attrs());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(
+    chunked_softmax_with_cross_entropy,
+    ops::ChunkedSoftmaxWithCrossEntropyOp,
+    ops::ChunkedSoftmaxWithCrossEntropyOpMaker,
+    ops::ChunkedSoftmaxWithCrossEntropyGradMaker<paddle::framework::OpDesc>,
+    ops::ChunkedSoftmaxWithCrossEntropyGradMaker<paddle::imperative::OpBase>);
+REGISTER_OPERATOR(chunked_softmax_with_cross_entropy_grad,
+                  ops::ChunkedSoftmaxWithCrossEntropyOpGrad);
+REGISTER_OP_CPU_KERNEL(chunked_softmax_with_cross_entropy,
+                       ops::ChunkedSoftmaxWithCrossEntropyKernel<float>,
+                       ops::ChunkedSoftmaxWithCrossEntropyKernel<double>);
+REGISTER_OP_CPU_KERNEL(chunked_softmax_with_cross_entropy_grad,
+                       ops::ChunkedSoftmaxWithCrossEntropyGradKernel<float>,
+                       ops::ChunkedSoftmaxWithCrossEntropyGradKernel<double>);
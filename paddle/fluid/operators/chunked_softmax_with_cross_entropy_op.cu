@@ -0,0 +1,192 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/chunked_softmax_with_cross_entropy_op.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+// Merge the (max, sum of exp relative to the max) of two parts of a row.
+template <typename T>
+__device__ __forceinline__ void MergeLogSumExp(T* max_val, T* sum, T other_max,
+                                               T other_sum) {
+  if (other_max > *max_val) {
+    T tmp_max = *max_val;
+    *max_val = other_max;
+    other_max = tmp_max;
+    T tmp_sum = *sum;
+    *sum = other_sum;
+    other_sum = tmp_sum;
+  }
+  if (other_max > -INFINITY) {
+    *sum += other_sum * exp(other_max - *max_val);
+  }
+}
+
+// One block per row, every thread normalizes the classes strided by the
+// block size online, so the logits are read once.
+template <typename T, int BlockDim>
+__global__ void ChunkedSoftmaxWithCrossEntropyKernel(
+    const T* logits, const int64_t* labels, T* loss, T* log_sum_exp,
+    int64_t num_classes, int num_labels, int ignore_index) {
+  __shared__ T max_vals[BlockDim];
+  __shared__ T sums[BlockDim];
+  const T* x = logits + blockIdx.x * num_classes;
+
+  T max_val = -INFINITY;
+  T sum = 0;
+  for (int64_t j = threadIdx.x; j < num_classes; j += BlockDim) {
+    T val = x[j];
+    if (val > max_val) {
+      sum = sum * exp(max_val - val) + static_cast<T>(1);
+      max_val = val;
+    } else {
+      sum += exp(val - max_val);
+    }
+  }
+  max_vals[threadIdx.x] = max_val;
+  sums[threadIdx.x] = sum;
+  __syncthreads();
+
+  for (int stride = BlockDim / 2; stride > 0; stride >>= 1) {
+    if (threadIdx.x < stride) {
+      MergeLogSumExp(&max_vals[threadIdx.x], &sums[threadIdx.x],
+                     max_vals[threadIdx.x + stride],
+                     sums[threadIdx.x + stride]);
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    T lse = max_vals[0] + log(sums[0]);
+    T row_loss = 0;
+    const int64_t* label = labels + blockIdx.x * num_labels;
+    for (int t = 0; t < num_labels; ++t) {
+      if (label[t] != ignore_index) row_loss += lse - x[label[t]];
+    }
+    log_sum_exp[blockIdx.x] = lse;
+    loss[blockIdx.x] = row_loss / num_labels;
+  }
+}
+
+template <typename T>
+__global__ void ChunkedSoftmaxWithCrossEntropyGradKernel(
+    const T* logits, const int64_t* labels, const T* log_sum_exp,
+    const T* loss_grad, T* logits_grad, int64_t num, int64_t num_classes,
+    int num_labels, int ignore_index) {
+  for (int64_t idx = blockIdx.x * blockDim.x + threadIdx.x; idx < num;
+       idx += blockDim.x * gridDim.x) {
+    int64_t i = idx / num_classes;
+    int64_t j = idx - i * num_classes;
+    const int64_t* label = labels + i * num_labels;
+    int num_valid = 0;
+    int num_hits = 0;
+    for (int t = 0; t < num_labels; ++t) {
+      num_valid += label[t] != ignore_index;
+      num_hits += label[t] == j;
+    }
+    T label_grad = loss_grad[i] / num_labels;
+    logits_grad[idx] =
+        label_grad * (num_valid * exp(logits[idx] - log_sum_exp[i]) -
+                      static_cast<T>(num_hits));
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    Tensor* loss = context.Output<Tensor>("Loss");
+    Tensor* log_sum_exp = context.Output<Tensor>("LogSumExp");
+    const int ignore_index = context.Attr<int>("ignore_index");
+
+    const int rank = logits->dims().size();
+    const int64_t num_classes = logits->dims()[rank - 1];
+    const int64_t n = logits->numel() / num_classes;
+    const int num_labels = labels->numel() / n;
+
+    const T* logits_data = logits->data<T>();
+    const int64_t* labels_data = labels->data<int64_t>();
+    T* loss_data = loss->mutable_data<T>(context.GetPlace());
+    T* lse_data = log_sum_exp->mutable_data<T>(context.GetPlace());
+    if (n == 0) return;
+
+    auto stream = context.cuda_device_context().stream();
+    if (num_classes > 1024) {
+      ChunkedSoftmaxWithCrossEntropyKernel<T, 512><<<n, 512, 0, stream>>>(
+          logits_data, labels_data, loss_data, lse_data, num_classes,
+          num_labels, ignore_index);
+    } else {
+      ChunkedSoftmaxWithCrossEntropyKernel<T, 128><<<n, 128, 0, stream>>>(
+          logits_data, labels_data, loss_data, lse_data, num_classes,
+          num_labels, ignore_index);
+    }
+  }
+};
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyGradCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    const Tensor* log_sum_exp = context.Input<Tensor>("LogSumExp");
+    const Tensor* loss_grad =
+        context.Input<Tensor>(framework::GradVarName("Loss"));
+    Tensor* logits_grad =
+        context.Output<Tensor>(framework::GradVarName("Logits"));
+    const int ignore_index = context.Attr<int>("ignore_index");
+
+    const int rank = logits->dims().size();
+    const int64_t num_classes = logits->dims()[rank - 1];
+    const int64_t num = logits->numel();
+    const int64_t n = num / num_classes;
+    T* grad_data = logits_grad->mutable_data<T>(context.GetPlace());
+    if (num == 0) return;
+    const int num_labels = labels->numel() / n;
+
+    auto& dev_ctx = context.cuda_device_context();
+    int block = 512;
+    int64_t grid = std::min<int64_t>((num + block - 1) / block,
+                                     dev_ctx.GetMaxPhysicalThreadCount() /
+                                         block);
+    ChunkedSoftmaxWithCrossEntropyGradKernel<T><<<grid, block, 0,
+                                                  dev_ctx.stream()>>>(
+        logits->data<T>(), labels->data<int64_t>(), log_sum_exp->data<T>(),
+        loss_grad->data<T>(), grad_data, num, num_classes, num_labels,
+        ignore_index);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(
+    chunked_softmax_with_cross_entropy,
+    ops::ChunkedSoftmaxWithCrossEntropyCUDAKernel<float>,
+    ops::ChunkedSoftmaxWithCrossEntropyCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(
+    chunked_softmax_with_cross_entropy_grad,
+    ops::ChunkedSoftmaxWithCrossEntropyGradCUDAKernel<float>,
+    ops::ChunkedSoftmaxWithCrossEntropyGradCUDAKernel<double>);
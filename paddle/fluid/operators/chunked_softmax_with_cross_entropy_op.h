@@ -0,0 +1,150 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+/*
+ * The log-sum-exp of a row of logits, computed chunk by chunk with an online
+ * max, so that every chunk is read from the memory once and stays in the
+ * cache while its max and sum of exp are computed.
+ */
+template <typename T>
+T ChunkedLogSumExp(const T* x, int64_t num_classes, int64_t chunk_size) {
+  T max_val = -std::numeric_limits<T>::infinity();
+  T sum = 0;
+  for (int64_t begin = 0; begin < num_classes; begin += chunk_size) {
+    int64_t end = std::min(begin + chunk_size, num_classes);
+    T chunk_max = *std::max_element(x + begin, x + end);
+    if (chunk_max > max_val) {
+      sum *= std::exp(max_val - chunk_max);
+      max_val = chunk_max;
+    }
+    T chunk_sum = 0;
+    for (int64_t j = begin; j < end; ++j) {
+      chunk_sum += std::exp(x[j] - max_val);
+    }
+    sum += chunk_sum;
+  }
+  return max_val + std::log(sum);
+}
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE_EQ(
+        platform::is_cpu_place(context.GetPlace()), true,
+        platform::errors::Unimplemented("This kernel only runs on CPU."));
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    Tensor* loss = context.Output<Tensor>("Loss");
+    Tensor* log_sum_exp = context.Output<Tensor>("LogSumExp");
+    const int ignore_index = context.Attr<int>("ignore_index");
+    const int64_t chunk_size = context.Attr<int>("chunk_size");
+
+    const int rank = logits->dims().size();
+    const int64_t num_classes = logits->dims()[rank - 1];
+    const int64_t n = logits->numel() / num_classes;
+    const int64_t num_labels = labels->numel() / n;
+
+    const T* logits_data = logits->data<T>();
+    const int64_t* labels_data = labels->data<int64_t>();
+    T* loss_data = loss->mutable_data<T>(context.GetPlace());
+    T* lse_data = log_sum_exp->mutable_data<T>(context.GetPlace());
+    for (int64_t i = 0; i < labels->numel(); ++i) {
+      int64_t label = labels_data[i];
+      PADDLE_ENFORCE_EQ(
+          label == ignore_index || (label >= 0 && label < num_classes), true,
+          platform::errors::InvalidArgument(
+              "The label %d should be in [0, %d).", label, num_classes));
+    }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < n; ++i) {
+      const T* x = logits_data + i * num_classes;
+      T lse = ChunkedLogSumExp<T>(x, num_classes, chunk_size);
+      T row_loss = 0;
+      for (int64_t t = 0; t < num_labels; ++t) {
+        int64_t label = labels_data[i * num_labels + t];
+        if (label != ignore_index) row_loss += lse - x[label];
+      }
+      lse_data[i] = lse;
+      loss_data[i] = row_loss / num_labels;
+    }
+  }
+};
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyGradKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    const Tensor* log_sum_exp = context.Input<Tensor>("LogSumExp");
+    const Tensor* loss_grad =
+        context.Input<Tensor>(framework::GradVarName("Loss"));
+    Tensor* logits_grad =
+        context.Output<Tensor>(framework::GradVarName("Logits"));
+    const int ignore_index = context.Attr<int>("ignore_index");
+
+    const int rank = logits->dims().size();
+    const int64_t num_classes = logits->dims()[rank - 1];
+    const int64_t n = logits->numel() / num_classes;
+    const int64_t num_labels = labels->numel() / n;
+
+    const T* logits_data = logits->data<T>();
+    const int64_t* labels_data = labels->data<int64_t>();
+    const T* lse_data = log_sum_exp->data<T>();
+    const T* loss_grad_data = loss_grad->data<T>();
+    T* grad_data = logits_grad->mutable_data<T>(context.GetPlace());
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < n; ++i) {
+      const int64_t* label = labels_data + i * num_labels;
+      // every label not ignored takes a weight of 1 / num_labels
+      T label_grad = loss_grad_data[i] / num_labels;
+      int64_t num_valid = 0;
+      for (int64_t t = 0; t < num_labels; ++t) {
+        num_valid += label[t] != ignore_index;
+      }
+      const T* x = logits_data + i * num_classes;
+      T* dx = grad_data + i * num_classes;
+      T softmax_grad = label_grad * num_valid;
+      T lse = lse_data[i];
+      for (int64_t j = 0; j < num_classes; ++j) {
+        dx[j] = softmax_grad * std::exp(x[j] - lse);
+      }
+      for (int64_t t = 0; t < num_labels; ++t) {
+        if (label[t] != ignore_index) dx[label[t]] -= label_grad;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
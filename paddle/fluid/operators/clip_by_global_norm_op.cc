@@ -0,0 +1,89 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/clip_by_global_norm_op.h"
+
+namespace paddle {
+namespace operators {
+
+void ClipByGlobalNormOp::InferShape(framework::InferShapeContext* ctx) const {
+  OP_INOUT_CHECK(ctx->HasInputs("X"), "Input", "X", "ClipByGlobalNorm");
+  OP_INOUT_CHECK(ctx->HasOutputs("Out"), "Output", "Out", "ClipByGlobalNorm");
+  auto max_global_norm = ctx->Attrs().Get<float>("max_global_norm");
+  PADDLE_ENFORCE_GT(max_global_norm, 0,
+                    platform::errors::InvalidArgument(
+                        "max_global_norm of ClipByGlobalNormOp should be "
+                        "greater than 0, but received %f.",
+                        max_global_norm));
+
+  auto x_dims = ctx->GetInputsDim("X");
+  PADDLE_ENFORCE_EQ(
+      ctx->Outputs("Out").size(), x_dims.size(),
+      platform::errors::InvalidArgument(
+          "The size of Output(Out) of ClipByGlobalNormOp should be equal to "
+          "the size of Input(X) %d, but received %d.",
+          x_dims.size(), ctx->Outputs("Out").size()));
+  ctx->SetOutputsDim("Out", x_dims);
+  if (ctx->HasOutput("GlobalNorm")) {
+    ctx->SetOutputDim("GlobalNorm", framework::make_ddim({1}));
+  }
+}
+
+class ClipByGlobalNormOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(vector<Tensor>) The gradients to be clipped.")
+        .AsDuplicable();
+    AddOutput("Out",
+              "(vector<Tensor>) The clipped gradients, they can share memory "
+              "with Input(X).")
+        .AsDuplicable();
+    AddOutput("GlobalNorm",
+              "(Tensor) The global norm of Input(X) before clipping.")
+        .AsDispensable();
+    AddAttr<float>("max_global_norm",
+                   "(float) The maximum global norm of the gradients.");
+    AddComment(R"DOC(
+ClipByGlobalNorm Operator.
+
+Clip a list of tensors by the L2 norm of all of them:
+
+$$
+global\\_norm = \\sqrt{\\sum_{i} \\sum X_{i}^{2}}
+$$
+
+$$
+Out_{i} = X_{i} \\frac{max\\_global\\_norm}{\\max(global\\_norm,
+max\\_global\\_norm)}
+$$
+
+It is the fused version of the ops GradientClipByGlobalNorm builds for every
+gradient. On GPU, the squared norms of all the tensors are reduced by one
+kernel launch and the tensors are scaled by another one, and the global norm
+is never copied to CPU.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(clip_by_global_norm, ops::ClipByGlobalNormOp,
+                             ops::ClipByGlobalNormOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    clip_by_global_norm,
+    ops::ClipByGlobalNormKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::ClipByGlobalNormKernel<paddle::platform::CPUDeviceContext, double>);
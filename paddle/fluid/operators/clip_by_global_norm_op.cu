@@ -0,0 +1,151 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "cub/cub.cuh"
+#include "paddle/fluid/operators/clip_by_global_norm_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// Every block sums the squares of one chunk of the tensors.
+template <typename T, int BlockDim>
+__global__ void MultiTensorSquaredSumKernel(const T* const* xs,
+                                            const int* chunk_tensors,
+                                            const int64_t* chunk_starts,
+                                            const int64_t* numels,
+                                            int chunk_size, T* partial_sums) {
+  typedef cub::BlockReduce<T, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+
+  int t = chunk_tensors[blockIdx.x];
+  const T* x = xs[t];
+  int64_t end = min(chunk_starts[blockIdx.x] + chunk_size, numels[t]);
+  T sum = 0;
+  for (int64_t i = chunk_starts[blockIdx.x] + threadIdx.x; i < end;
+       i += BlockDim) {
+    sum += x[i] * x[i];
+  }
+  sum = BlockReduce(temp_storage).Reduce(sum, cub::Sum());
+  if (threadIdx.x == 0) {
+    partial_sums[blockIdx.x] = sum;
+  }
+}
+
+// Sum the partial sums of the chunks in one block, and compute the scale.
+template <typename T, int BlockDim>
+__global__ void GlobalNormScaleKernel(const T* partial_sums, int num_chunks,
+                                      T max_global_norm, T* global_norm,
+                                      T* scale) {
+  typedef cub::BlockReduce<T, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+
+  T sum = 0;
+  for (int i = threadIdx.x; i < num_chunks; i += BlockDim) {
+    sum += partial_sums[i];
+  }
+  sum = BlockReduce(temp_storage).Reduce(sum, cub::Sum());
+  if (threadIdx.x == 0) {
+    T norm = sqrt(sum);
+    *scale = max_global_norm / max(norm, max_global_norm);
+    if (global_norm != nullptr) {
+      *global_norm = norm;
+    }
+  }
+}
+
+template <typename T>
+struct MultiTensorScaleFunctor {
+  const T* scale;
+  const T* const* xs;
+  T* const* outs;
+
+  __device__ __forceinline__ void operator()(int t, int64_t i) const {
+    outs[t][i] = xs[t][i] * *scale;
+  }
+};
+
+template <typename T>
+class ClipByGlobalNormCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T max_global_norm = static_cast<T>(ctx.Attr<float>("max_global_norm"));
+    auto xs = ctx.MultiInput<framework::Tensor>("X");
+    auto outs = ctx.MultiOutput<framework::Tensor>("Out");
+    auto* global_norm = ctx.HasOutput("GlobalNorm")
+                            ? ctx.Output<framework::Tensor>("GlobalNorm")
+                            : nullptr;
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+
+    size_t n = xs.size();
+    std::vector<int64_t> numels(n);
+    std::vector<const T*> x_ptrs(n);
+    std::vector<T*> out_ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+      numels[i] = xs[i]->numel();
+      x_ptrs[i] = xs[i]->data<T>();
+      out_ptrs[i] = outs[i]->mutable_data<T>(ctx.GetPlace());
+    }
+    std::vector<int> chunk_tensors;
+    std::vector<int64_t> chunk_starts;
+    MultiTensorChunks(numels, kMultiTensorChunkSize, &chunk_tensors,
+                      &chunk_starts);
+    int num_chunks = static_cast<int>(chunk_tensors.size());
+
+    // The partial sums of the chunks, then the scale.
+    auto buffer = memory::Alloc(dev_ctx, (num_chunks + 1) * sizeof(T));
+    T* partial_sums = reinterpret_cast<T*>(buffer->ptr());
+    T* scale = partial_sums + num_chunks;
+
+    MultiTensorArgs args;
+    size_t xs_offset = args.Append(x_ptrs);
+    size_t outs_offset = args.Append(out_ptrs);
+    size_t tensors_offset = args.Append(chunk_tensors);
+    size_t starts_offset = args.Append(chunk_starts);
+    size_t numels_offset = args.Append(numels);
+    args.CopyToDevice(dev_ctx);
+
+    constexpr int kBlockDim = 512;
+    if (num_chunks > 0) {
+      MultiTensorSquaredSumKernel<
+          T, kBlockDim><<<num_chunks, kBlockDim, 0, dev_ctx.stream()>>>(
+          args.Get<const T*>(xs_offset), args.Get<int>(tensors_offset),
+          args.Get<int64_t>(starts_offset), args.Get<int64_t>(numels_offset),
+          kMultiTensorChunkSize, partial_sums);
+    }
+    GlobalNormScaleKernel<T, kBlockDim><<<1, kBlockDim, 0, dev_ctx.stream()>>>(
+        partial_sums, num_chunks, max_global_norm,
+        global_norm == nullptr ? nullptr
+                               : global_norm->mutable_data<T>(ctx.GetPlace()),
+        scale);
+
+    MultiTensorArgs scale_args;
+    MultiTensorApply(dev_ctx, numels, &scale_args,
+                     [&](const MultiTensorArgs& dev_args) {
+                       MultiTensorScaleFunctor<T> functor;
+                       functor.scale = scale;
+                       functor.xs = args.Get<const T*>(xs_offset);
+                       functor.outs = args.Get<T*>(outs_offset);
+                       return functor;
+                     });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(clip_by_global_norm,
+                        ops::ClipByGlobalNormCUDAKernel<float>,
+                        ops::ClipByGlobalNormCUDAKernel<double>);
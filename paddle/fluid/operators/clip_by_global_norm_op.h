@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+class ClipByGlobalNormOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override;
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto input_data_type = OperatorWithKernel::IndicateVarDataType(ctx, "X");
+    return framework::OpKernelType(input_data_type, ctx.GetPlace());
+  }
+};
+
+template <typename DeviceContext, typename T>
+class ClipByGlobalNormKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T max_global_norm = static_cast<T>(ctx.Attr<float>("max_global_norm"));
+    auto xs = ctx.MultiInput<framework::Tensor>("X");
+    auto outs = ctx.MultiOutput<framework::Tensor>("Out");
+
+    T sum = 0;
+    for (auto* x : xs) {
+      const T* x_data = x->data<T>();
+      for (int64_t i = 0; i < x->numel(); ++i) {
+        sum += x_data[i] * x_data[i];
+      }
+    }
+    T global_norm = sqrt(sum);
+    T scale = max_global_norm / std::max(global_norm, max_global_norm);
+    for (size_t t = 0; t < xs.size(); ++t) {
+      const T* x_data = xs[t]->data<T>();
+      T* out_data = outs[t]->mutable_data<T>(ctx.GetPlace());
+      for (int64_t i = 0; i < xs[t]->numel(); ++i) {
+        out_data[i] = x_data[i] * scale;
+      }
+    }
+    if (ctx.HasOutput("GlobalNorm")) {
+      ctx.Output<framework::Tensor>("GlobalNorm")
+          ->mutable_data<T>(ctx.GetPlace())[0] = global_norm;
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
 #include "paddle/fluid/platform/transform.h"
 
 namespace paddle {
@@ -74,9 +75,16 @@ class ClipByNormKernel : public framework::OpKernel<T> {
 
     auto x = EigenVector<T>::Flatten(*input);
     auto out = EigenVector<T>::Flatten(*output);
-    auto x_norm = x.square().sum().sqrt();
     auto& place =
         *context.template device_context<DeviceContext>().eigen_device();
+    if (platform::is_cpu_place(context.GetPlace())) {
+      T norm;
+      CPUReduce<CPUNormReducer>(input->data<T>(), &norm, 1, input->numel(), 1);
+      T scale = norm > max_norm ? max_norm / norm : static_cast<T>(1);
+      out.device(place) = x * scale;
+      return;
+    }
+    auto x_norm = x.square().sum().sqrt();
 
     auto temp = (x_norm <= max_norm).template cast<T>();
     auto scaling = temp + (static_cast<T>(1) - temp) * max_norm / x_norm;
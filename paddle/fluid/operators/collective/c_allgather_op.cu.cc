@@ -18,6 +18,7 @@ limitations under the License. */
 
 #if defined(PADDLE_WITH_NCCL)
 #include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/comm_stats.h"
 #include "paddle/fluid/platform/nccl_helper.h"
 #endif
 
@@ -55,9 +56,17 @@ class CAllGatherOpCUDAKernel : public framework::OpKernel<T> {
       stream = comm->stream();
     }
 
+    platform::RecordComm record_comm(
+        ctx.Type(), "allgather",
+        ctx.InputName("X") + "@ring_" + std::to_string(rid),
+        comm->nranks(), out->numel() * sizeof(T), [stream] {
+          PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+        });
+    record_comm.BeginTransfer();
     PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllGather(
         send_buff, recv_buff, send_numel, static_cast<ncclDataType_t>(dtype),
         comm->comm(), stream));
+    record_comm.EndTransfer();
 #else
     PADDLE_THROW("PaddlePaddle should compile with GPU.");
 #endif
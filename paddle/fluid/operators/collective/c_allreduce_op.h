@@ -22,6 +22,7 @@ limitations under the License. */
 
 #if defined(PADDLE_WITH_NCCL)
 #include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/comm_stats.h"
 #include "paddle/fluid/platform/nccl_helper.h"
 #endif
 
@@ -73,10 +74,16 @@ class CAllReduceOpCUDAKernel : public framework::OpKernel<T> {
     auto comm = platform::NCCLCommContext::Instance().Get(rid, place);
 
     cudaStream_t stream = nullptr;
-    if (ctx.Attr<bool>("use_calc_stream")) {
+    bool use_calc_stream = ctx.Attr<bool>("use_calc_stream");
+    if (use_calc_stream) {
       auto dev_ctx = platform::DeviceContextPool::Instance().Get(place);
       stream = static_cast<platform::CUDADeviceContext*>(dev_ctx)->stream();
     } else {
+      // wait only for the calculation enqueued before, the consumers of Out
+      // wait for the completion event in c_sync_comm_stream
+      auto dev_ctx = platform::DeviceContextPool::Instance().Get(place);
+      comm->WaitCalcStream(
+          static_cast<platform::CUDADeviceContext*>(dev_ctx)->stream());
       stream = comm->stream();
     }
 
@@ -102,8 +109,19 @@ class CAllReduceOpCUDAKernel : public framework::OpKernel<T> {
         PADDLE_THROW("Invalid reduce type: %d", red_type);
     }
 
+    platform::RecordComm record_comm(
+        ctx.Type(), "allreduce",
+        ctx.InputName("X") + "@ring_" + std::to_string(rid),
+        comm->nranks(), numel * framework::SizeOfType(in->type()), [stream] {
+          PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+        });
+    record_comm.BeginTransfer();
     PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
         sendbuff, recvbuff, numel, dtype, nccl_red_type, comm->comm(), stream));
+    record_comm.EndTransfer();
+    if (!use_calc_stream) {
+      comm->RecordVarEvent(ctx.OutputVar("Out"));
+    }
 #else
     PADDLE_THROW("PaddlePaddle should compile with GPU.");
 #endif
@@ -127,6 +145,11 @@ CAllReduce %s Operator
 Call collective AllReduce with reduce type %s. If input and output are
 the same variable, in-place allreduce will be used.
 Reference: https://docs.nvidia.com/deeplearning/sdk/nccl-developer-guide/docs/usage/operations.html#allreduce
+
+Unless use_calc_stream is set, the communication stream waits for the
+calculation enqueued before this op by a CUDA event, and the calculation
+stream waits for the completion of this op in c_sync_comm_stream, so that
+no c_sync_calc_stream is needed before it.
 )DOC",
                                GetName(), GetName()));
   }
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #if defined(PADDLE_WITH_NCCL)
 #include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/comm_stats.h"
 #include "paddle/fluid/platform/nccl_helper.h"
 #endif
 
@@ -45,10 +46,18 @@ class CBroadcastOpCUDAKernel : public framework::OpKernel<T> {
     }
 
     int root = ctx.Attr<int>("root");
+    platform::RecordComm record_comm(
+        ctx.Type(), "broadcast",
+        ctx.InputName("X") + "@ring_" + std::to_string(rid),
+        comm->nranks(), numel * sizeof(T), [stream] {
+          PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+        });
+    record_comm.BeginTransfer();
     if (root == comm->rank()) {
       PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclBcast(
           reinterpret_cast<void*>(const_cast<T*>(x->data<T>())), numel, dtype,
           root, comm->comm(), stream));
+      record_comm.EndTransfer();
       VLOG(3) << "rank " << comm->rank() << " invoke Bcast. sent "
               << x->numel();
 
@@ -62,6 +71,7 @@ class CBroadcastOpCUDAKernel : public framework::OpKernel<T> {
       PADDLE_ENFORCE_CUDA_SUCCESS(
           platform::dynload::ncclBcast(out->mutable_data<T>(place), numel,
                                        dtype, root, comm->comm(), stream));
+      record_comm.EndTransfer();
       VLOG(3) << "rank " << comm->rank() << " invoke Bcast. recieved "
               << framework::product(out->dims());
     }
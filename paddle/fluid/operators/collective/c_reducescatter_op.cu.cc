@@ -16,6 +16,7 @@ limitations under the License. */
 
 #if defined(PADDLE_WITH_NCCL)
 #include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/comm_stats.h"
 #include "paddle/fluid/platform/nccl_helper.h"
 #endif
 
@@ -57,9 +58,17 @@ class CReduceScatterOpCUDAKernel : public framework::OpKernel<T> {
       stream = comm->stream();
     }
 
+    platform::RecordComm record_comm(
+        ctx.Type(), "reducescatter",
+        ctx.InputName("X") + "@ring_" + std::to_string(rid),
+        comm->nranks(), in->numel() * sizeof(T), [stream] {
+          PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+        });
+    record_comm.BeginTransfer();
     PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclReduceScatter(
         send_buff, recv_buff, recv_numel, static_cast<ncclDataType_t>(dtype),
         ncclSum, comm->comm(), stream));
+    record_comm.EndTransfer();
 #else
     PADDLE_THROW("PaddlePaddle should compile with GPU.");
 #endif
@@ -17,6 +17,7 @@ limitations under the License. */
 #endif
 
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -43,9 +44,18 @@ class CSyncCommStreamOp : public framework::OperatorBase {
 
 #if defined(PADDLE_WITH_NCCL)
     int ring_id = Attr<int>("ring_id");
-    auto stream =
-        platform::NCCLCommContext::Instance().Get(ring_id, place)->stream();
-    PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+    auto comm = platform::NCCLCommContext::Instance().Get(ring_id, place);
+    std::vector<const void*> vars;
+    if (Attr<bool>("wait_vars_only")) {
+      for (auto& name : Inputs("X")) {
+        vars.push_back(scope.FindVar(name));
+      }
+    }
+    // the calculation stream waits for the communication by CUDA events,
+    // the host is not blocked
+    auto dev_ctx = static_cast<platform::CUDADeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(place));
+    comm->CalcStreamWaitVars(vars, dev_ctx->stream());
 #else
     PADDLE_THROW("PaddlePaddle should compile with GPU.");
 #endif
@@ -55,13 +65,23 @@ class CSyncCommStreamOp : public framework::OperatorBase {
 class CSyncCommStreamOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() {
-    AddInput("X", "(Tensor) Dependency of the variable need to sync");
-    AddOutput("Out", "(Tensor) Dependency of the variable need to sync");
+    AddInput("X", "(Tensor) Dependency of the variable need to sync")
+        .AsDuplicable();
+    AddOutput("Out", "(Tensor) Dependency of the variable need to sync")
+        .AsDuplicable();
     AddAttr<int>("ring_id", "(int default 0) ring id.").SetDefault(0);
+    AddAttr<bool>("wait_vars_only",
+                  "(bool default false) wait only for the collective ops "
+                  "which write X, instead of all the work of the "
+                  "communication stream.")
+        .SetDefault(false);
     AddComment(R"DOC(
 CSyncCommStream Operator
 
-Call communication stream synchronization.
+Make the calculation stream wait for the communication stream of ring_id
+by a CUDA event, without blocking the host. If wait_vars_only is set, only
+the collective ops which write X are waited for, unless none of X is
+written by the collective ops of ring_id.
 )DOC");
   }
 };
@@ -0,0 +1,83 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/device_context.h"
+
+USE_OP(c_allreduce_sum);
+USE_NO_KERNEL_OP(c_sync_comm_stream);
+
+namespace paddle {
+namespace operators {
+
+static void RunAllReduceStep(const framework::Scope& scope,
+                             const platform::CUDAPlace& place,
+                             const std::vector<std::string>& grads) {
+  // like Executor.run, which creates the grads in a fresh local scope
+  auto& local_scope = scope.NewScope();
+  for (auto& name : grads) {
+    auto* tensor = local_scope.Var(name)->GetMutable<framework::LoDTensor>();
+    tensor->mutable_data<float>(framework::make_ddim({16}), place);
+    auto allreduce = framework::OpRegistry::CreateOp(
+        "c_allreduce_sum", {{"X", {name}}}, {{"Out", {name}}},
+        {{"ring_id", 0}, {"use_calc_stream", false}});
+    allreduce->Run(local_scope, place);
+  }
+  auto sync = framework::OpRegistry::CreateOp(
+      "c_sync_comm_stream", {{"X", grads}}, {{"Out", grads}},
+      {{"ring_id", 0}, {"wait_vars_only", true}});
+  sync->Run(local_scope, place);
+  platform::DeviceContextPool::Instance().Get(place)->Wait();
+  scope.DeleteScope(&local_scope);
+}
+
+TEST(c_sync_comm_stream, consume_var_events_of_local_scopes) {
+  platform::CUDAPlace place(0);
+  auto& comm_ctx = platform::NCCLCommContext::Instance();
+  comm_ctx.CreateAllNCCLComms({place.device}, 0);
+  auto* comm = comm_ctx.Get(0, place);
+
+  framework::Scope scope;
+  std::vector<std::string> grads = {"w0@GRAD", "w1@GRAD", "w2@GRAD"};
+  for (int step = 0; step < 10; ++step) {
+    RunAllReduceStep(scope, place, grads);
+    EXPECT_EQ(comm->NumVarEvents(), 0UL);
+  }
+
+  // Waiting for the grad recorded last covers those recorded before it.
+  auto& local_scope = scope.NewScope();
+  for (auto& name : grads) {
+    auto* tensor = local_scope.Var(name)->GetMutable<framework::LoDTensor>();
+    tensor->mutable_data<float>(framework::make_ddim({16}), place);
+    auto allreduce = framework::OpRegistry::CreateOp(
+        "c_allreduce_sum", {{"X", {name}}}, {{"Out", {name}}},
+        {{"ring_id", 0}, {"use_calc_stream", false}});
+    allreduce->Run(local_scope, place);
+  }
+  EXPECT_EQ(comm->NumVarEvents(), grads.size());
+  auto sync = framework::OpRegistry::CreateOp(
+      "c_sync_comm_stream", {{"X", {grads.back()}}}, {{"Out", {grads.back()}}},
+      {{"ring_id", 0}, {"wait_vars_only", true}});
+  sync->Run(local_scope, place);
+  EXPECT_EQ(comm->NumVarEvents(), 0UL);
+  scope.DeleteScope(&local_scope);
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -106,6 +106,8 @@ struct ConvArgs {
   std::vector<int> p;
   // dilations
   std::vector<int> d;
+  // the layout of the descriptors, a key of the searched algorithms
+  DataLayout data_layout{DataLayout::kNCHW};
 
   ConvArgs(const framework::Tensor* x, const framework::Tensor* w,
            const framework::Tensor* o, const std::vector<int> s,
@@ -114,6 +116,24 @@ struct ConvArgs {
       : x(x), w(w), o(o), s(s), p(p), d(d), cudnn_dtype(dtype) {}
 };
 
+// The index of the fastest algorithm in the results of
+// cudnnGetConvolution*Algorithm_v7, which are sorted by the estimated time,
+// whose workspace fits in workspace_size_limit, so that a faster algorithm
+// than the one of the legacy cudnnGetConvolution*Algorithm is used when the
+// fastest one needs too much workspace. Returns 0 if none fits, then the
+// callers fall back to the legacy ones.
+template <typename perf_t>
+static int FastestAlgoInLimit(const perf_t* perf_results, int perf_count,
+                              size_t workspace_size_limit) {
+  for (int i = 0; i < perf_count; ++i) {
+    if (perf_results[i].status == CUDNN_STATUS_SUCCESS &&
+        perf_results[i].memory <= workspace_size_limit) {
+      return i;
+    }
+  }
+  return 0;
+}
+
 template <typename perf_t>
 struct SearchAlgorithm {};
 
@@ -158,6 +178,8 @@ struct SearchAlgorithm<cudnnConvolutionFwdAlgoPerf_t> {
               args.handle, args.idesc.desc(), args.wdesc.desc(),
               args.cdesc.desc(), args.odesc.desc(), kNUM_CUDNN_FWD_ALGS,
               &perf_count, perf_results.get()));
+      best_algo_idx = FastestAlgoInLimit(perf_results.get(), perf_count,
+                                         workspace_size_limit);
       algo = (perf_results.get())[best_algo_idx].algo;
       workspace_size = GetWorkspaceSize(args, algo);
 
@@ -205,7 +227,8 @@ struct SearchAlgorithm<cudnnConvolutionFwdAlgoPerf_t> {
 
       algo = algo_cache.GetAlgorithm(
           x_dims, w_dims, args.s, args.p, args.d, 0,
-          static_cast<int64_t>(args.cudnn_dtype), [&]() {
+          static_cast<int64_t>(args.cudnn_dtype),
+          static_cast<int64_t>(args.data_layout), workspace_size_limit, [&]() {
             int returned_algo_count;
             std::array<perf_t, kNUM_CUDNN_FWD_ALGS> perf_stat;
 
@@ -286,6 +309,8 @@ struct SearchAlgorithm<cudnnConvolutionBwdDataAlgoPerf_t> {
               args.handle, args.wdesc.desc(), args.odesc.desc(),
               args.cdesc.desc(), args.idesc.desc(), kNUM_CUDNN_BWD_DATA_ALGS,
               &perf_count, perf_results.get()));
+      best_algo_idx = FastestAlgoInLimit(perf_results.get(), perf_count,
+                                         workspace_size_limit);
       algo = (perf_results.get())[best_algo_idx].algo;
 
 #if CUDNN_VERSION < 7500
@@ -344,7 +369,8 @@ struct SearchAlgorithm<cudnnConvolutionBwdDataAlgoPerf_t> {
 
       algo = algo_cache.GetAlgorithm(
           x_dims, w_dims, args.s, args.p, args.d, 0,
-          static_cast<int64_t>(args.cudnn_dtype), [&]() {
+          static_cast<int64_t>(args.cudnn_dtype),
+          static_cast<int64_t>(args.data_layout), workspace_size_limit, [&]() {
             int returned_algo_count;
             std::array<perf_t, kNUM_CUDNN_FWD_ALGS> perf_stat;
 
@@ -429,6 +455,8 @@ struct SearchAlgorithm<cudnnConvolutionBwdFilterAlgoPerf_t> {
               args.handle, args.idesc.desc(), args.odesc.desc(),
               args.cdesc.desc(), args.wdesc.desc(), kNUM_CUDNN_BWD_FILTER_ALGS,
               &perf_count, perf_results.get()));
+      best_algo_idx = FastestAlgoInLimit(perf_results.get(), perf_count,
+                                         workspace_size_limit);
       algo = (perf_results.get())[best_algo_idx].algo;
       workspace_size = GetWorkspaceSize(args, algo);
       if (workspace_size > workspace_size_limit) {
@@ -472,7 +500,8 @@ struct SearchAlgorithm<cudnnConvolutionBwdFilterAlgoPerf_t> {
 
       algo = algo_cache.GetAlgorithm(
           x_dims, w_dims, args.s, args.p, args.d, 0,
-          static_cast<int64_t>(args.cudnn_dtype), [&]() {
+          static_cast<int64_t>(args.cudnn_dtype),
+          static_cast<int64_t>(args.data_layout), workspace_size_limit, [&]() {
             int returned_algo_count;
             std::array<perf_t, kNUM_CUDNN_FWD_ALGS> perf_stat;
             auto cudnn_find_func = [&](void* cudnn_workspace_ptr) {
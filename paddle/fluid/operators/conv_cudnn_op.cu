@@ -246,6 +246,7 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
                                                          groups));
     groups = 1;
 #endif
+    args.data_layout = layout;
     args.idesc.set(transformed_input, layout_format);
     args.wdesc.set(transformed_filter_channel, layout_format, groups);
     args.odesc.set(transformed_output, layout_format);
@@ -579,6 +580,7 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
       input_grad_data = input_grad->data<T>();
       transformed_input_grad_data = transformed_input_grad.data<T>();
       args1.handle = handle;
+      args1.data_layout = layout;
       args1.idesc.set(transformed_input_grad, layout_tensor);
       args1.wdesc.set(transformed_filter_channel, layout_tensor, iwo_groups);
       args1.odesc.set(transformed_output_grad_channel, layout_tensor);
@@ -595,6 +597,7 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
       // ------------------- cudnn descriptors ---------------------
       filter_grad_data = transformed_filter_grad_channel.data<T>();
       args2.handle = handle;
+      args2.data_layout = layout;
       args2.idesc.set(transformed_input, layout_tensor);
       args2.wdesc.set(transformed_filter_grad_channel, layout_tensor,
                       iwo_groups);
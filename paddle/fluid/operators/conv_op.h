@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/vol2col.h"
+#include "paddle/fluid/operators/math/winograd_conv.h"
 
 namespace paddle {
 namespace operators {
@@ -372,6 +373,32 @@ class GemmConvKernel : public framework::OpKernel<T> {
     std::vector<int64_t> output_shape_vec(
         framework::vectorize(transformed_output.dims()));
 
+    // the 3x3 convs of stride 1 run by Winograd on the CPU, without im2col
+    if (platform::is_cpu_place(context.GetPlace()) &&
+        math::CanUseWinogradConv3x3(filter_shape_vec, strides, dilations,
+                                    groups)) {
+      math::WinogradConv3x3Functor<DeviceContext, T> winograd;
+      Tensor transformed_filter;
+      winograd.TransformFilter(dev_ctx, filter, &transformed_filter);
+      framework::DDim in_image_shape = framework::slice_ddim(
+          transformed_input.dims(), 1, transformed_input.dims().size());
+      framework::DDim out_image_shape = framework::slice_ddim(
+          transformed_output.dims(), 1, transformed_output.dims().size());
+      for (int i = 0; i < batch_size; i++) {
+        Tensor in_batch =
+            transformed_input.Slice(i, i + 1).Resize(in_image_shape);
+        Tensor out_batch =
+            transformed_output.Slice(i, i + 1).Resize(out_image_shape);
+        winograd(dev_ctx, in_batch, transformed_filter,
+                 {paddings[0], paddings[2]}, &out_batch);
+      }
+      if (channel_last) {
+        TransToChannelLast<DeviceContext, T>(context, &transformed_output,
+                                             output);
+      }
+      return;
+    }
+
     // use col_shape in the im2col calculation
     // col_shape_vec:
     // {i_c/g, k_h, k_w, o_h, o_w} or {i_c/g, k_d, k_h, k_w,
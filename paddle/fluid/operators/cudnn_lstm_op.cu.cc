@@ -89,29 +89,35 @@ class CudnnLSTMGPUKernel : public framework::OpKernel<T> {
 
     auto run_seq_len = x->dims()[0];
 
-    if (is_test) {
-      // for inference
-      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNForwardInference(
-          handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
-          cudnn_rnn_cache->x_desc_, x_data, cudnn_rnn_cache->hx_desc_,
-          init_h_data, cudnn_rnn_cache->cx_desc_, init_c_data,
-          cudnn_rnn_cache->w_desc_, w_data, cudnn_rnn_cache->y_desc_, out_data,
-          cudnn_rnn_cache->hy_desc_, last_h_data, cudnn_rnn_cache->cy_desc_,
-          last_c_data, cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
-          cudnn_rnn_cache->workspace_size_));
-    } else {
-      // for train
-      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNForwardTraining(
-          handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
-          cudnn_rnn_cache->x_desc_, x_data, cudnn_rnn_cache->hx_desc_,
-          init_h_data, cudnn_rnn_cache->cx_desc_, init_c_data,
-          cudnn_rnn_cache->w_desc_, w_data, cudnn_rnn_cache->y_desc_, out_data,
-          cudnn_rnn_cache->hy_desc_, last_h_data, cudnn_rnn_cache->cy_desc_,
-          last_c_data, cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
-          cudnn_rnn_cache->workspace_size_,
-          cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
-          cudnn_rnn_cache->reserve_size_));
-    }
+    // The workspace is the one shared by the cudnn calls on the stream,
+    // only the reserve space is kept in the cache for the backward.
+    auto cudnn_func = [&](void *workspace_ptr) {
+      if (is_test) {
+        // for inference
+        PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNForwardInference(
+            handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
+            cudnn_rnn_cache->x_desc_, x_data, cudnn_rnn_cache->hx_desc_,
+            init_h_data, cudnn_rnn_cache->cx_desc_, init_c_data,
+            cudnn_rnn_cache->w_desc_, w_data, cudnn_rnn_cache->y_desc_,
+            out_data, cudnn_rnn_cache->hy_desc_, last_h_data,
+            cudnn_rnn_cache->cy_desc_, last_c_data, workspace_ptr,
+            cudnn_rnn_cache->workspace_size_));
+      } else {
+        // for train
+        PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNForwardTraining(
+            handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
+            cudnn_rnn_cache->x_desc_, x_data, cudnn_rnn_cache->hx_desc_,
+            init_h_data, cudnn_rnn_cache->cx_desc_, init_c_data,
+            cudnn_rnn_cache->w_desc_, w_data, cudnn_rnn_cache->y_desc_,
+            out_data, cudnn_rnn_cache->hy_desc_, last_h_data,
+            cudnn_rnn_cache->cy_desc_, last_c_data, workspace_ptr,
+            cudnn_rnn_cache->workspace_size_,
+            cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
+            cudnn_rnn_cache->reserve_size_));
+      }
+    };
+    dev_ctx.cudnn_workspace_handle().RunFunc(cudnn_func,
+                                             cudnn_rnn_cache->workspace_size_);
   }
 };
 
@@ -224,32 +230,36 @@ class CudnnLSTMGPUGradKernel : public framework::OpKernel<T> {
     auto init_c_data = init_c->data<T>();
     auto in_grad_data = in_grad->data<T>();
 
-    auto work_data = cudnn_rnn_cache->workspace_data_.data<uint8_t>();
     auto reserve_data = cudnn_rnn_cache->reserve_data_.data<uint8_t>();
 
     auto run_seq_len = input_dims[0];
     PADDLE_ENFORCE_LE((size_t)run_seq_len, cudnn_rnn_cache->max_length_,
                       "cudnn running seq_len CAN not greater max_lengh");
-    PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNBackwardData(
-        handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
-        cudnn_rnn_cache->y_desc_, out_data, cudnn_rnn_cache->dy_desc_,
-        out_grad_data, cudnn_rnn_cache->dhy_desc_, last_h_grad_data,
-        cudnn_rnn_cache->dcy_desc_, last_c_grad_data, cudnn_rnn_cache->w_desc_,
-        weight_data, cudnn_rnn_cache->hx_desc_, init_h_data,
-        cudnn_rnn_cache->cx_desc_, init_c_data, cudnn_rnn_cache->dx_desc_,
-        in_grad_data, cudnn_rnn_cache->dhx_desc_, init_h_grad_data,
-        cudnn_rnn_cache->dcx_desc_, init_c_grad_data, work_data,
-        cudnn_rnn_cache->workspace_size_, reserve_data,
-        cudnn_rnn_cache->reserve_size_));
-
-    PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNBackwardWeights(
-        handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
-        cudnn_rnn_cache->x_desc_, input->data<T>(), cudnn_rnn_cache->hx_desc_,
-        init_h->data<T>(), cudnn_rnn_cache->y_desc_, out->data<T>(),
-        cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
-        cudnn_rnn_cache->workspace_size_, cudnn_rnn_cache->dw_desc_,
-        weight_grad->data<T>(), cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
-        cudnn_rnn_cache->reserve_size_));
+    auto cudnn_func = [&](void *work_data) {
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNBackwardData(
+          handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
+          cudnn_rnn_cache->y_desc_, out_data, cudnn_rnn_cache->dy_desc_,
+          out_grad_data, cudnn_rnn_cache->dhy_desc_, last_h_grad_data,
+          cudnn_rnn_cache->dcy_desc_, last_c_grad_data,
+          cudnn_rnn_cache->w_desc_, weight_data, cudnn_rnn_cache->hx_desc_,
+          init_h_data, cudnn_rnn_cache->cx_desc_, init_c_data,
+          cudnn_rnn_cache->dx_desc_, in_grad_data, cudnn_rnn_cache->dhx_desc_,
+          init_h_grad_data, cudnn_rnn_cache->dcx_desc_, init_c_grad_data,
+          work_data, cudnn_rnn_cache->workspace_size_, reserve_data,
+          cudnn_rnn_cache->reserve_size_));
+
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnRNNBackwardWeights(
+          handle, cudnn_rnn_cache->rnn_desc_, run_seq_len,
+          cudnn_rnn_cache->x_desc_, input->data<T>(),
+          cudnn_rnn_cache->hx_desc_, init_h->data<T>(),
+          cudnn_rnn_cache->y_desc_, out->data<T>(), work_data,
+          cudnn_rnn_cache->workspace_size_, cudnn_rnn_cache->dw_desc_,
+          weight_grad->data<T>(),
+          cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
+          cudnn_rnn_cache->reserve_size_));
+    };
+    dev_ctx.cudnn_workspace_handle().RunFunc(cudnn_func,
+                                             cudnn_rnn_cache->workspace_size_);
   }
 };
 
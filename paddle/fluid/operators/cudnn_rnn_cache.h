@@ -57,7 +57,6 @@ struct CudnnRNNCache {
   size_t workspace_size_;
   size_t reserve_size_;
   framework::Tensor reserve_data_;
-  framework::Tensor workspace_data_;
 
   framework::Tensor dropout_state_;
 
@@ -223,9 +222,6 @@ struct CudnnRNNCache {
 
     reserve_data_.Resize({static_cast<int64_t>(reserve_size_)});
     reserve_data_.mutable_data<uint8_t>(place);
-
-    workspace_data_.Resize({static_cast<int64_t>(workspace_size_)});
-    workspace_data_.mutable_data<uint8_t>(place);
   }
 
   void release() {
@@ -95,9 +95,18 @@ class MultiClassNMSOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
+    // The CUDA kernel supports the batched boxes of [xmin, ymin, xmax, ymax]
+    // and the fixed nms_threshold, the others run on the CPU.
+    auto place = ctx.GetPlace();
+    auto score_dims = ctx.Input<framework::LoDTensor>("Scores")->dims();
+    auto box_dims = ctx.Input<framework::LoDTensor>("BBoxes")->dims();
+    if (!platform::is_gpu_place(place) || score_dims.size() != 3 ||
+        box_dims.size() != 3 || box_dims[2] != 4 ||
+        ctx.Attr<float>("nms_eta") < 1.f) {
+      place = platform::CPUPlace();
+    }
     return framework::OpKernelType(
-        OperatorWithKernel::IndicateVarDataType(ctx, "Scores"),
-        platform::CPUPlace());
+        OperatorWithKernel::IndicateVarDataType(ctx, "Scores"), place);
   }
 };
 
@@ -0,0 +1,464 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <limits>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/mixed_vector.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/operators/detection/nms_util.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+#define DIVUP(m, n) ((m) / (n) + ((m) % (n) > 0))
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kThreadsPerBlock = sizeof(uint64_t) * 8;
+int const kNumCUDAThreads = 512;
+int const kNumMaximumNumBlocks = 4096;
+// The suppression masks of the (image, class) pairs are computed in chunks
+// of at most this size.
+int64_t const kMaxMaskBytes = 256 << 20;
+
+inline int NumBlocks(const int n) {
+  return std::min(DIVUP(n, kNumCUDAThreads), kNumMaximumNumBlocks);
+}
+
+__global__ void SegmentIotaKernel(const int n, const int segment_size,
+                                  int* out) {
+  CUDA_1D_KERNEL_LOOP(i, n) { out[i] = i % segment_size; }
+}
+
+__global__ void SegmentOffsetsKernel(const int num_segments,
+                                     const int segment_size, int* offsets) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments + 1) { offsets[i] = i * segment_size; }
+}
+
+// The scores of each (image, class) pair larger than score_threshold, at
+// most max_candidates of them, are the candidates of the NMS.
+template <typename T>
+__global__ void NumCandidatesKernel(const T* sorted_scores, const int num_pairs,
+                                    const int class_num, const int num_boxes,
+                                    const int background_label,
+                                    const T score_threshold,
+                                    const int max_candidates,
+                                    int* num_candidates) {
+  CUDA_1D_KERNEL_LOOP(i, num_pairs) {
+    int num = 0;
+    if (i % class_num != background_label) {
+      const T* scores = sorted_scores + static_cast<int64_t>(i) * num_boxes;
+      int low = 0, high = num_boxes;
+      while (low < high) {
+        int mid = (low + high) / 2;
+        if (scores[mid] > score_threshold) {
+          low = mid + 1;
+        } else {
+          high = mid;
+        }
+      }
+      num = min(low, max_candidates);
+    }
+    num_candidates[i] = num;
+  }
+}
+
+// The NMSKernel of generate_proposals over a chunk of the (image, class)
+// pairs, blockIdx.z is the pair in the chunk. Only the masks of the later
+// candidates are computed, since the earlier ones are never used.
+template <typename T>
+__global__ void BatchedNMSKernel(const T* bboxes, const int* sorted_indices,
+                                 const int* num_candidates,
+                                 const int pair_start, const int class_num,
+                                 const int num_boxes, const int max_candidates,
+                                 const T nms_threshold, const bool normalized,
+                                 uint64_t* masks) {
+  const int pair = pair_start + blockIdx.z;
+  const int n_boxes = num_candidates[pair];
+  const int row_start = blockIdx.y;
+  const int col_start = blockIdx.x;
+  if (col_start < row_start || col_start * kThreadsPerBlock >= n_boxes) {
+    return;
+  }
+
+  const int row_size =
+      min(n_boxes - row_start * kThreadsPerBlock, kThreadsPerBlock);
+  const int col_size =
+      min(n_boxes - col_start * kThreadsPerBlock, kThreadsPerBlock);
+  const T* boxes =
+      bboxes + static_cast<int64_t>(pair / class_num) * num_boxes * 4;
+  const int* indices = sorted_indices + static_cast<int64_t>(pair) * num_boxes;
+
+  __shared__ T block_boxes[kThreadsPerBlock * 4];
+  if (threadIdx.x < col_size) {
+    const T* box =
+        boxes + indices[kThreadsPerBlock * col_start + threadIdx.x] * 4;
+    block_boxes[threadIdx.x * 4 + 0] = box[0];
+    block_boxes[threadIdx.x * 4 + 1] = box[1];
+    block_boxes[threadIdx.x * 4 + 2] = box[2];
+    block_boxes[threadIdx.x * 4 + 3] = box[3];
+  }
+  __syncthreads();
+
+  if (threadIdx.x < row_size) {
+    const int cur_box_idx = kThreadsPerBlock * row_start + threadIdx.x;
+    const T* cur_box = boxes + indices[cur_box_idx] * 4;
+    uint64_t t = 0;
+    int start = 0;
+    if (row_start == col_start) {
+      start = threadIdx.x + 1;
+    }
+    for (int i = start; i < col_size; i++) {
+      if (JaccardOverlap<T>(cur_box, block_boxes + i * 4, normalized) >
+          nms_threshold) {
+        t |= 1ULL << i;
+      }
+    }
+    const int col_blocks = DIVUP(max_candidates, kThreadsPerBlock);
+    masks[(static_cast<int64_t>(blockIdx.z) * max_candidates + cur_box_idx) *
+              col_blocks +
+          col_start] = t;
+  }
+}
+
+// The greedy pass over the masks on the device, one block per pair. The
+// candidate i never suppresses itself, so the bit read of i is not changed by
+// the updates of the same iteration.
+__global__ void NMSKeepKernel(const uint64_t* masks, const int* num_candidates,
+                              const int pair_start, const int max_candidates,
+                              int* keep) {
+  extern __shared__ uint64_t remv[];
+  const int pair = pair_start + blockIdx.x;
+  const int n_boxes = num_candidates[pair];
+  const int col_blocks = DIVUP(max_candidates, kThreadsPerBlock);
+  const int used_blocks = DIVUP(n_boxes, kThreadsPerBlock);
+  const uint64_t* mask =
+      masks + static_cast<int64_t>(blockIdx.x) * max_candidates * col_blocks;
+  int* pair_keep = keep + static_cast<int64_t>(pair) * max_candidates;
+
+  for (int j = threadIdx.x; j < used_blocks; j += blockDim.x) {
+    remv[j] = 0;
+  }
+  __syncthreads();
+  for (int i = 0; i < n_boxes; ++i) {
+    const int nblock = i / kThreadsPerBlock;
+    const int inblock = i % kThreadsPerBlock;
+    const bool kept = !(remv[nblock] & (1ULL << inblock));
+    if (threadIdx.x == 0) {
+      pair_keep[i] = kept;
+    }
+    if (kept) {
+      const uint64_t* p = mask + static_cast<int64_t>(i) * col_blocks;
+      for (int j = nblock + threadIdx.x; j < used_blocks; j += blockDim.x) {
+        remv[j] |= p[j];
+      }
+    }
+    __syncthreads();
+  }
+  for (int i = n_boxes + threadIdx.x; i < max_candidates; i += blockDim.x) {
+    pair_keep[i] = 0;
+  }
+}
+
+// The kept candidates of the images, whose scores are the keys of keep_top_k.
+template <typename T>
+__global__ void KeptScoresKernel(const T* sorted_scores, const int* keep,
+                                 const int num_slots, const int num_boxes,
+                                 const int max_candidates, T* kept_scores) {
+  CUDA_1D_KERNEL_LOOP(i, num_slots) {
+    int pair = i / max_candidates;
+    int k = i % max_candidates;
+    kept_scores[i] =
+        keep[i] ? sorted_scores[static_cast<int64_t>(pair) * num_boxes + k]
+                : std::numeric_limits<T>::lowest();
+  }
+}
+
+// The slots are sorted in the descending scores of each image, and the
+// stable sort keeps the order of the classes and the candidates on the ties.
+__global__ void KeepTopKKernel(const int* sorted_slots, const int* keep,
+                               const int num_slots, const int image_slots,
+                               const int keep_top_k, int* selected) {
+  CUDA_1D_KERNEL_LOOP(i, num_slots) {
+    int slot = i / image_slots * image_slots + sorted_slots[i];
+    selected[slot] = keep[slot] && (i % image_slots) < keep_top_k;
+  }
+}
+
+__global__ void BatchStartsKernel(const int* offsets, const int* selected,
+                                  const int batch_size, const int image_slots,
+                                  size_t* batch_starts) {
+  CUDA_1D_KERNEL_LOOP(i, batch_size + 1) {
+    if (i < batch_size) {
+      batch_starts[i] = offsets[i * image_slots];
+    } else {
+      int last = batch_size * image_slots - 1;
+      batch_starts[i] = offsets[last] + selected[last];
+    }
+  }
+}
+
+template <typename T>
+__global__ void NMSOutputKernel(const T* bboxes, const T* sorted_scores,
+                                const int* sorted_indices, const int* selected,
+                                const int* offsets, const int num_slots,
+                                const int class_num, const int num_boxes,
+                                const int max_candidates, T* out, int* index) {
+  CUDA_1D_KERNEL_LOOP(i, num_slots) {
+    if (!selected[i]) continue;
+    int pair = i / max_candidates;
+    int64_t sorted_idx =
+        static_cast<int64_t>(pair) * num_boxes + i % max_candidates;
+    int64_t box_idx = static_cast<int64_t>(pair / class_num) * num_boxes +
+                      sorted_indices[sorted_idx];
+    T* row = out + static_cast<int64_t>(offsets[i]) * 6;
+    row[0] = static_cast<T>(pair % class_num);  // label
+    row[1] = sorted_scores[sorted_idx];        // score
+    for (int k = 0; k < 4; ++k) {
+      row[2 + k] = bboxes[box_idx * 4 + k];
+    }
+    if (index) {
+      index[offsets[i]] = static_cast<int>(box_idx);
+    }
+  }
+}
+
+}  // namespace
+
+/*
+ * The multiclass NMS of all the images and the classes on the GPU:
+ *   1. the scores of each (image, class) pair are sorted in a segmented sort;
+ *   2. the suppression masks of the candidates of all the pairs are computed
+ *      in a batch, followed by a greedy pass of each pair on the device;
+ *   3. the kept boxes of each image over keep_top_k are dropped by another
+ *      segmented sort of the kept scores;
+ *   4. the offsets of the outputs and the LoD come from a scan of the
+ *      selected boxes.
+ * Only the LoD is copied to the host, for the shape of the outputs.
+ */
+template <typename T>
+class MultiClassNMSCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* boxes = ctx.Input<LoDTensor>("BBoxes");
+    auto* scores = ctx.Input<LoDTensor>("Scores");
+    auto* outs = ctx.Output<LoDTensor>("Out");
+    bool return_index = ctx.HasOutput("Index") ? true : false;
+    auto index = ctx.Output<LoDTensor>("Index");
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto place = BOOST_GET_CONST(platform::CUDAPlace, dev_ctx.GetPlace());
+    auto stream = dev_ctx.stream();
+
+    auto score_dims = scores->dims();
+    PADDLE_ENFORCE_EQ(score_dims.size(), 3,
+                      platform::errors::Unimplemented(
+                          "The CUDA kernel of multiclass_nms only supports "
+                          "the Input(Scores) of rank 3, but received rank %d.",
+                          score_dims.size()));
+    PADDLE_ENFORCE_EQ(boxes->dims()[2], 4,
+                      platform::errors::Unimplemented(
+                          "The CUDA kernel of multiclass_nms only supports "
+                          "the boxes of [xmin, ymin, xmax, ymax], but the "
+                          "last dimension of Input(BBoxes) is %d.",
+                          boxes->dims()[2]));
+    int background_label = ctx.Attr<int>("background_label");
+    int nms_top_k = ctx.Attr<int>("nms_top_k");
+    int keep_top_k = ctx.Attr<int>("keep_top_k");
+    bool normalized = ctx.Attr<bool>("normalized");
+    T nms_threshold = static_cast<T>(ctx.Attr<float>("nms_threshold"));
+    T score_threshold = static_cast<T>(ctx.Attr<float>("score_threshold"));
+    PADDLE_ENFORCE_GE(ctx.Attr<float>("nms_eta"), 1.f,
+                      platform::errors::Unimplemented(
+                          "The CUDA kernel of multiclass_nms does not support "
+                          "the adaptive NMS of nms_eta < 1."));
+
+    const int batch_size = static_cast<int>(score_dims[0]);
+    const int class_num = static_cast<int>(score_dims[1]);
+    const int num_boxes = static_cast<int>(score_dims[2]);
+    const int num_pairs = batch_size * class_num;
+    const int max_candidates =
+        nms_top_k > -1 ? std::min(nms_top_k, num_boxes) : num_boxes;
+    const int image_slots = class_num * max_candidates;
+    const int num_slots = batch_size * image_slots;
+    const int64_t out_dim = 6;
+
+    framework::Vector<size_t> batch_starts(batch_size + 1, 0);
+    Tensor selected_t, offsets_t;
+    Tensor sorted_scores_t, sorted_indices_t;
+    if (num_slots > 0) {
+      const T* bboxes = boxes->data<T>();
+
+      // 1. sort the scores of each pair
+      int num_scores = num_pairs * num_boxes;
+      Tensor indices_t, pair_offsets_t;
+      int* indices = indices_t.mutable_data<int>({num_scores}, place);
+      int* pair_offsets =
+          pair_offsets_t.mutable_data<int>({num_pairs + 1}, place);
+      T* sorted_scores =
+          sorted_scores_t.mutable_data<T>({num_scores}, place);
+      int* sorted_indices =
+          sorted_indices_t.mutable_data<int>({num_scores}, place);
+      SegmentIotaKernel<<<NumBlocks(num_scores), kNumCUDAThreads, 0,
+                          stream>>>(num_scores, num_boxes, indices);
+      SegmentOffsetsKernel<<<NumBlocks(num_pairs + 1), kNumCUDAThreads, 0,
+                             stream>>>(num_pairs, num_boxes, pair_offsets);
+      SegmentedSortDescending(dev_ctx, scores->data<T>(), sorted_scores,
+                              indices, sorted_indices, num_scores, num_pairs,
+                              pair_offsets);
+
+      Tensor num_candidates_t;
+      int* num_candidates =
+          num_candidates_t.mutable_data<int>({num_pairs}, place);
+      NumCandidatesKernel<T><<<NumBlocks(num_pairs), kNumCUDAThreads, 0,
+                               stream>>>(
+          sorted_scores, num_pairs, class_num, num_boxes, background_label,
+          score_threshold, max_candidates, num_candidates);
+
+      // 2. the NMS of each pair in the chunks of the pairs
+      Tensor keep_t;
+      int* keep = keep_t.mutable_data<int>({num_slots}, place);
+      const int col_blocks = DIVUP(max_candidates, kThreadsPerBlock);
+      int64_t pair_mask_bytes = static_cast<int64_t>(max_candidates) *
+                                col_blocks * sizeof(uint64_t);
+      int chunk_size = static_cast<int>(std::max<int64_t>(
+          1, std::min<int64_t>({kMaxMaskBytes / pair_mask_bytes, num_pairs,
+                                65535})));
+      auto masks = memory::Alloc(place, chunk_size * pair_mask_bytes);
+      for (int pair_start = 0; pair_start < num_pairs;
+           pair_start += chunk_size) {
+        int pairs = std::min(chunk_size, num_pairs - pair_start);
+        dim3 blocks(col_blocks, col_blocks, pairs);
+        BatchedNMSKernel<T><<<blocks, kThreadsPerBlock, 0, stream>>>(
+            bboxes, sorted_indices, num_candidates, pair_start, class_num,
+            num_boxes, max_candidates, nms_threshold, normalized,
+            reinterpret_cast<uint64_t*>(masks->ptr()));
+        NMSKeepKernel<<<pairs, kThreadsPerBlock,
+                        col_blocks * sizeof(uint64_t), stream>>>(
+            reinterpret_cast<const uint64_t*>(masks->ptr()), num_candidates,
+            pair_start, max_candidates, keep);
+      }
+
+      // 3. keep the top keep_top_k boxes of each image
+      int* selected = selected_t.mutable_data<int>({num_slots}, place);
+      if (keep_top_k > -1 && keep_top_k < image_slots) {
+        Tensor kept_scores_t, sorted_kept_scores_t, slots_t, sorted_slots_t;
+        Tensor image_offsets_t;
+        T* kept_scores = kept_scores_t.mutable_data<T>({num_slots}, place);
+        T* sorted_kept_scores =
+            sorted_kept_scores_t.mutable_data<T>({num_slots}, place);
+        int* slots = slots_t.mutable_data<int>({num_slots}, place);
+        int* sorted_slots =
+            sorted_slots_t.mutable_data<int>({num_slots}, place);
+        int* image_offsets =
+            image_offsets_t.mutable_data<int>({batch_size + 1}, place);
+        KeptScoresKernel<T><<<NumBlocks(num_slots), kNumCUDAThreads, 0,
+                              stream>>>(sorted_scores, keep, num_slots,
+                                        num_boxes, max_candidates, kept_scores);
+        SegmentIotaKernel<<<NumBlocks(num_slots), kNumCUDAThreads, 0,
+                            stream>>>(num_slots, image_slots, slots);
+        SegmentOffsetsKernel<<<NumBlocks(batch_size + 1), kNumCUDAThreads, 0,
+                               stream>>>(batch_size, image_slots,
+                                         image_offsets);
+        SegmentedSortDescending(dev_ctx, kept_scores, sorted_kept_scores, slots,
+                                sorted_slots, num_slots, batch_size,
+                                image_offsets);
+        KeepTopKKernel<<<NumBlocks(num_slots), kNumCUDAThreads, 0, stream>>>(
+            sorted_slots, keep, num_slots, image_slots, keep_top_k, selected);
+      } else {
+        memory::Copy(place, selected, place, keep, num_slots * sizeof(int),
+                     stream);
+      }
+
+      // 4. the offsets of the selected boxes in the outputs
+      int* offsets = offsets_t.mutable_data<int>({num_slots}, place);
+      size_t temp_storage_bytes = 0;
+      cub::DeviceScan::ExclusiveSum(nullptr, temp_storage_bytes, selected,
+                                    offsets, num_slots, stream);
+      auto d_temp_storage = memory::Alloc(place, temp_storage_bytes);
+      cub::DeviceScan::ExclusiveSum(d_temp_storage->ptr(), temp_storage_bytes,
+                                    selected, offsets, num_slots, stream);
+      BatchStartsKernel<<<NumBlocks(batch_size + 1), kNumCUDAThreads, 0,
+                          stream>>>(offsets, selected, batch_size, image_slots,
+                                    batch_starts.CUDAMutableData(place));
+    }
+
+    // copies the LoD to the host
+    int num_kept = static_cast<int>(batch_starts.back());
+    if (num_kept == 0) {
+      if (return_index) {
+        outs->mutable_data<T>({0, out_dim}, ctx.GetPlace());
+        index->mutable_data<int>({0, 1}, ctx.GetPlace());
+      } else {
+        outs->mutable_data<T>({1, 1}, ctx.GetPlace());
+        math::SetConstant<platform::CUDADeviceContext, T> set_constant;
+        set_constant(dev_ctx, outs, static_cast<T>(-1));
+        batch_starts = {0, 1};
+      }
+    } else {
+      T* out = outs->mutable_data<T>({num_kept, out_dim}, ctx.GetPlace());
+      int* index_data =
+          return_index ? index->mutable_data<int>({num_kept, 1}, ctx.GetPlace())
+                       : nullptr;
+      NMSOutputKernel<T><<<NumBlocks(num_slots), kNumCUDAThreads, 0, stream>>>(
+          boxes->data<T>(), sorted_scores_t.data<T>(),
+          sorted_indices_t.data<int>(), selected_t.data<int>(),
+          offsets_t.data<int>(), num_slots, class_num, num_boxes,
+          max_candidates, out, index_data);
+    }
+
+    framework::LoD lod;
+    lod.emplace_back(batch_starts);
+    if (return_index) {
+      index->set_lod(lod);
+    }
+    outs->set_lod(lod);
+  }
+
+ private:
+  template <typename KeyT>
+  static void SegmentedSortDescending(
+      const platform::CUDADeviceContext& ctx, const KeyT* keys_in,
+      KeyT* keys_out, const int* values_in, int* values_out, int num_items,
+      int num_segments, const int* offsets) {
+    auto place = BOOST_GET_CONST(platform::CUDAPlace, ctx.GetPlace());
+    size_t temp_storage_bytes = 0;
+    cub::DeviceSegmentedRadixSort::SortPairsDescending<KeyT, int>(
+        nullptr, temp_storage_bytes, keys_in, keys_out, values_in, values_out,
+        num_items, num_segments, offsets, offsets + 1, 0, sizeof(KeyT) * 8,
+        ctx.stream());
+    auto d_temp_storage = memory::Alloc(place, temp_storage_bytes);
+    cub::DeviceSegmentedRadixSort::SortPairsDescending<KeyT, int>(
+        d_temp_storage->ptr(), temp_storage_bytes, keys_in, keys_out,
+        values_in, values_out, num_items, num_segments, offsets, offsets + 1,
+        0, sizeof(KeyT) * 8, ctx.stream());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(multiclass_nms, ops::MultiClassNMSCUDAKernel<float>,
+                        ops::MultiClassNMSCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(multiclass_nms2, ops::MultiClassNMSCUDAKernel<float>,
+                        ops::MultiClassNMSCUDAKernel<double>);
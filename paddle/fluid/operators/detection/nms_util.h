@@ -17,6 +17,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "paddle/fluid/operators/detection/poly_util.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -46,7 +47,7 @@ static inline void GetMaxScoreIndex(
 }
 
 template <class T>
-static inline T BBoxArea(const T* box, const bool normalized) {
+static inline HOSTDEVICE T BBoxArea(const T* box, const bool normalized) {
   if (box[2] < box[0] || box[3] < box[1]) {
     // If coordinate values are is invalid
     // (e.g. xmax < xmin or ymax < ymin), return 0.
@@ -63,17 +64,18 @@ static inline T BBoxArea(const T* box, const bool normalized) {
   }
 }
 
+// Also used by the CUDA kernel of multiclass_nms.
 template <class T>
-static inline T JaccardOverlap(const T* box1, const T* box2,
-                               const bool normalized) {
+static inline HOSTDEVICE T JaccardOverlap(const T* box1, const T* box2,
+                                          const bool normalized) {
   if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
       box2[3] < box1[1]) {
     return static_cast<T>(0.);
   } else {
-    const T inter_xmin = std::max(box1[0], box2[0]);
-    const T inter_ymin = std::max(box1[1], box2[1]);
-    const T inter_xmax = std::min(box1[2], box2[2]);
-    const T inter_ymax = std::min(box1[3], box2[3]);
+    const T inter_xmin = box1[0] > box2[0] ? box1[0] : box2[0];
+    const T inter_ymin = box1[1] > box2[1] ? box1[1] : box2[1];
+    const T inter_xmax = box1[2] < box2[2] ? box1[2] : box2[2];
+    const T inter_ymax = box1[3] < box2[3] ? box1[3] : box2[3];
     T norm = normalized ? static_cast<T>(0.) : static_cast<T>(1.);
     T inter_w = inter_xmax - inter_xmin + norm;
     T inter_h = inter_ymax - inter_ymin + norm;
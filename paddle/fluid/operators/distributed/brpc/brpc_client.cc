@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/operators/distributed/brpc/brpc_client.h"
 #include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/brpc/brpc_rdma_pool.h"
 #include "paddle/fluid/operators/distributed/brpc/brpc_sendrecvop_utils.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -357,6 +358,8 @@ ChannelQueuePtr BRPCClient::GetChannel(const std::string& ep) {
   brpc::ChannelOptions options;
 #ifdef PADDLE_WITH_BRPC_RDMA
   options.use_rdma = true;
+  // register the memory of the registered CPU allocator
+  RdmaMemPool::Instance();
 #endif
   options.protocol = "baidu_std";
   // don't use pooled type. the server can't afford that.
@@ -447,9 +450,10 @@ VarHandlePtr BRPCClient::AsyncSendMessage(const std::string& ep,
 
 VarHandlePtr BRPCClient::AsyncCheckpointNotify(const std::string& ep,
                                                const std::string& dir,
-                                               int64_t time_out) {
+                                               int mode, int64_t time_out) {
   sendrecv::VariableMessage req;
-  req.set_varname(CHECKPOINT_SAVE_MESSAGE);
+  req.set_varname(mode == 1 ? CHECKPOINT_SAVE_DELTA_MESSAGE
+                            : CHECKPOINT_SAVE_MESSAGE);
   req.set_out_varname(dir);
 
   return AsyncSendVarMessage(ep, "CheckPointNotifyRPC", req, time_out);
@@ -17,14 +17,36 @@
 #include "paddle/fluid/operators/distributed/brpc/brpc_rdma_pool.h"
 #include "brpc/channel.h"
 #include "brpc/rdma/rdma_helper.h"
+#include "paddle/fluid/memory/allocation/registered_memory_allocator.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
 namespace operators {
 namespace distributed {
 
+static const char kRdmaHookName[] = "brpc_rdma";
+
+static void AddRdmaRegisterHook() {
+  // Used when FLAGS_cpu_allocator_strategy=registered, the chunks of the CPU
+  // allocator are registered, instead of the tensors one by one.
+  memory::allocation::RegisteredMemoryAllocator::AddHook(
+      kRdmaHookName,
+      [](void* ptr, size_t size) {
+        if (brpc::rdma::RegisterMemoryForRdma(ptr, size)) {
+          PADDLE_THROW(platform::errors::Unavailable(
+              "Register memory for RDMA failed. Register data: %p data size "
+              "%d error.",
+              ptr, size));
+        }
+      },
+      [](void* ptr, size_t size) { brpc::rdma::DeregisterMemoryForRdma(ptr); });
+}
+
 RdmaMemPool& RdmaMemPool::Instance() {
-  static RdmaMemPool* g_rdma_mem_pool = new RdmaMemPool();
+  static RdmaMemPool* g_rdma_mem_pool = [] {
+    AddRdmaRegisterHook();
+    return new RdmaMemPool();
+  }();
   return *g_rdma_mem_pool;
 }
 
@@ -50,6 +72,13 @@ void* RdmaMemPool::Find(const std::string& varname, int64_t size) {
 
 void RdmaMemPool::Register(const std::string& varname, void* data,
                            int64_t data_size) {
+  if (memory::allocation::RegisteredMemoryAllocator::IsRegistered(
+          kRdmaHookName, data, data_size)) {
+    VLOG(7) << "registered by the allocator:" << varname << " data:" << data
+            << " data_size:" << data_size;
+    return;
+  }
+
   void* old = Find(varname, data_size);
   if (old != nullptr) {
     if (data != old) {
@@ -118,6 +118,7 @@ void SerializeToIOBuf(const std::string& name, framework::Variable* var,
                       bool var_is_not_stable, int trainer_id,
                       const std::string& table_name) {
   std::unique_ptr<TensorPayload> payload;
+  std::unique_ptr<RowsPayload> rows_payload;
 
   request->set_varname(name);
   request->set_trainer_id(trainer_id);
@@ -144,6 +145,7 @@ void SerializeToIOBuf(const std::string& name, framework::Variable* var,
   } else if (var->IsType<framework::SelectedRows>()) {
     request->set_type(::sendrecv::SELECTED_ROWS);
     payload.reset(new TensorPayload(GetSelectedRowsPayload(var, ctx, request)));
+    rows_payload.reset(GetRowsPayload(var, request));
 #ifdef PADDLE_WITH_NCCL
   } else if (var->IsType<ncclUniqueId>()) {
     request->set_type(::sendrecv::NCCL_ID);
@@ -187,12 +189,11 @@ void SerializeToIOBuf(const std::string& name, framework::Variable* var,
   if (var->IsType<framework::SelectedRows>()) {
     auto* slr = var->GetMutable<framework::SelectedRows>();
     PADDLE_ENFORCE(VectorElemName(slr->rows()) == typeid(int64_t).name());
-    size_t rows_memory_size = slr->rows().size() * sizeof(int64_t);
 
-    IOBufWriter::Append(name, iobuf,
-                        ::sendrecv::VariableMessage::kRowsFieldNumber,
-                        reinterpret_cast<const char*>(slr->rows().data()),
-                        static_cast<int64_t>(rows_memory_size));
+    IOBufWriter::Append(
+        name, iobuf, ::sendrecv::VariableMessage::kRowsFieldNumber,
+        static_cast<const char*>(rows_payload->ptr()),
+        static_cast<int64_t>(rows_payload->memory_size()));
   }
 }
 
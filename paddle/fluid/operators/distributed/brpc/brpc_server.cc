@@ -16,6 +16,7 @@
 #include <memory>
 #include <unordered_map>
 #include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/brpc/brpc_rdma_pool.h"
 #include "paddle/fluid/operators/distributed/brpc/brpc_sendrecvop_utils.h"
 #include "paddle/fluid/operators/distributed/brpc/brpc_variable_response.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
@@ -100,9 +101,10 @@ class BRPCServiceImpl : public SendRecvService {
             << ", trainer_id:" << request->trainer_id()
             << ", from:" << cntl->remote_side();
 
-    distributed::BRPCVariableResponse resp(request_send_h_->scope(),
-                                           request_send_h_->dev_ctx(),
-                                           request_send_h_->distributed_mode());
+    distributed::BRPCVariableResponse resp(
+        request_send_h_->scope(), request_send_h_->dev_ctx(),
+        request_send_h_->distributed_mode() ||
+            FLAGS_rpc_backup_trainer_num > 0);
     PADDLE_ENFORCE(resp.Parse(cntl->request_attachment(), *request) == 0,
                    "parse iobuf to tensor error!");
 
@@ -372,6 +374,8 @@ void AsyncBRPCServer::StartServer() {
   brpc::ServerOptions options;
 #ifdef PADDLE_WITH_BRPC_RDMA
   options.use_rdma = true;
+  // register the memory of the registered CPU allocator
+  RdmaMemPool::Instance();
 #endif
   options.idle_timeout_sec = idle_timeout_s_;
   options.max_concurrency = max_concurrency_;
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <paddle/fluid/framework/program_desc.h>
 #include <chrono>  // NOLINT
 #include <map>
+#include <mutex>  // NOLINT
 #include <thread>  // NOLINT
 #include <unordered_set>
 #include "paddle/fluid/framework/eigen.h"
@@ -27,6 +28,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/distributed.h"
 #include "paddle/fluid/operators/distributed/parameter_recv.h"
 #include "paddle/fluid/operators/distributed/parameter_send.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/string/printf.h"
 #include "paddle/fluid/string/split.h"
 
@@ -79,6 +81,9 @@ void AsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
               send_queue_size_);
     }
     send_threadpool_.reset(new ::ThreadPool(thread_pool_size_));
+    if (merge_thread_num_ > 1) {
+      merge_threadpool_.reset(new ::ThreadPool(merge_thread_num_));
+    }
   }
 
   if (recv_varname_to_ctx.size() == 0) {
@@ -147,16 +152,20 @@ AsyncCommunicator::~AsyncCommunicator() {
 
 void AsyncCommunicator::SendThread() {
   VLOG(3) << "SendThread start!";
+  platform::BindThreadToKind(platform::ThreadKind::kComm, 0);
   while (running_) {
     std::vector<std::future<void>> task_futures;
     task_futures.reserve(send_varname_to_ctx_.size());
+    std::map<std::string, std::vector<const RpcContext *>> batched_ctxs;
+    std::mutex batched_mutex;
     VLOG(4) << "run send graph";
     auto before_run_send_graph = GetCurrentUS();
     for (auto &iter : send_varname_to_queue_) {
       auto &var_name = iter.first;
       auto &var_queue = iter.second;
       if (var_queue->Size() > 0) {
-        auto send_task = [this, &var_name, &var_queue] {
+        auto send_task = [this, &var_name, &var_queue, &batched_ctxs,
+                          &batched_mutex] {
           VLOG(4) << var_name << " merge and send";
           std::vector<std::shared_ptr<Variable>> vars;
           int merged_var_num = 0;
@@ -184,14 +193,21 @@ void AsyncCommunicator::SendThread() {
           auto before_merge = GetCurrentUS();
           auto &ctx = send_varname_to_ctx_.at(var_name);
           if (ctx.use_send_handler) {
-            MergeVars<float>(var_name, vars, send_scope_.get(), ctx.merge_add);
+            MergeVars<float>(var_name, vars, send_scope_.get(), ctx.merge_add,
+                             merge_threadpool_.get(), merge_thread_num_);
           } else {
             MergeVars<int64_t>(var_name, vars, send_scope_.get(),
-                               ctx.merge_add);
+                               ctx.merge_add, merge_threadpool_.get(),
+                               merge_thread_num_);
           }
           auto after_merge = GetCurrentUS();
           VLOG(4) << "merge " << merged_var_num << " " << var_name
                   << " use time " << after_merge - before_merge;
+          if (IsBatched(ctx, *send_scope_)) {
+            std::lock_guard<std::mutex> lock(batched_mutex);
+            batched_ctxs[ctx.epmap[0]].push_back(&ctx);
+            return;
+          }
           auto send_functor = distributed::ParameterSend<float>();
           send_functor(ctx, *send_scope_, true, 1);
           auto after_send = GetCurrentUS();
@@ -207,6 +223,7 @@ void AsyncCommunicator::SendThread() {
     for (auto &task_f : task_futures) {
       task_f.wait();
     }
+    SendBatched(batched_ctxs);
     auto after_run_send_graph = GetCurrentUS();
 
     VLOG(4) << "run send graph use time "
@@ -218,6 +235,7 @@ void AsyncCommunicator::SendThread() {
 
 void AsyncCommunicator::RecvThread() {
   VLOG(3) << "RecvThread start!";
+  platform::BindThreadToKind(platform::ThreadKind::kComm, 1);
   while (running_) {
     int grad_num = grad_num_.load();
     if (grad_num > min_send_grad_num_before_recv_) {
@@ -250,7 +268,12 @@ void AsyncCommunicator::RecvAll() {
   auto before_send = GetCurrentUS();
   std::vector<std::future<void>> task_futures;
   task_futures.reserve(recv_varname_to_ctx_.size());
+  std::map<std::string, std::vector<const RpcContext *>> batched_ctxs;
   for (auto &iter : recv_varname_to_ctx_) {
+    if (IsBatched(iter.second, *recv_scope_)) {
+      batched_ctxs[iter.second.epmap[0]].push_back(&iter.second);
+      continue;
+    }
     auto recv_task = [this, &iter] {
       auto &var_name = iter.first;
       VLOG(4) << "recv var " << var_name;
@@ -259,6 +282,7 @@ void AsyncCommunicator::RecvAll() {
     };
     task_futures.emplace_back(recv_threadpool_->enqueue(std::move(recv_task)));
   }
+  RecvBatched(batched_ctxs);
   for (auto &task : task_futures) {
     task.wait();
   }
@@ -266,6 +290,99 @@ void AsyncCommunicator::RecvAll() {
   VLOG(3) << "run recv graph use time " << after_recv - before_send;
 }
 
+bool AsyncCommunicator::IsBatched(const RpcContext &ctx,
+                                  const Scope &scope) const {
+  if (batch_var_max_bytes_ <= 0 || !ctx.use_send_handler ||
+      ctx.splited_var_names.size() != 1) {
+    return false;
+  }
+  auto *var = scope.FindVar(ctx.var_name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+    return false;
+  }
+  auto &tensor = var->Get<framework::LoDTensor>();
+  return tensor.IsInitialized() &&
+         tensor.type() == framework::proto::VarType::FP32 &&
+         platform::is_cpu_place(tensor.place()) && tensor.lod().empty() &&
+         tensor.numel() * static_cast<int64_t>(sizeof(float)) <=
+             batch_var_max_bytes_;
+}
+
+void AsyncCommunicator::SendBatched(
+    const std::map<std::string, std::vector<const RpcContext *>> &ep_ctxs) {
+  if (ep_ctxs.empty()) return;
+  auto &cpu_ctx =
+      *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+  auto local_scope = send_scope_->NewTmpScope();
+  std::vector<distributed::VarHandlePtr> rets;
+  for (auto &iter : ep_ctxs) {
+    std::vector<std::string> var_names;
+    for (auto *ctx : iter.second) {
+      auto &send_tensor =
+          send_scope_->FindVar(ctx->var_name)->Get<framework::LoDTensor>();
+      auto &send_var_name = ctx->splited_var_names[0];
+      local_scope->Var(send_var_name)
+          ->GetMutable<framework::LoDTensor>()
+          ->ShareDataWith(send_tensor);
+      var_names.push_back(send_var_name);
+    }
+    VLOG(4) << "send " << var_names.size() << " vars to " << iter.first
+            << " in one request";
+    auto *rpc_client = distributed::RPCClient::GetInstance<RPCCLIENT_T>(
+        iter.second[0]->trainer_id);
+    auto handles =
+        rpc_client->AsyncSendVars(iter.first, cpu_ctx, *local_scope, var_names);
+    rets.insert(rets.end(), handles.begin(), handles.end());
+  }
+  for (size_t i = 0; i < rets.size(); i++) {
+    PADDLE_ENFORCE_NE(rets[i]->Wait(), 0U, platform::errors::External(
+                                               "internal error in RPCClient"));
+  }
+}
+
+void AsyncCommunicator::RecvBatched(
+    const std::map<std::string, std::vector<const RpcContext *>> &ep_ctxs) {
+  if (ep_ctxs.empty()) return;
+  auto &cpu_ctx =
+      *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+  auto local_scope = recv_scope_->NewTmpScope();
+  std::vector<distributed::VarHandlePtr> rets;
+  for (auto &iter : ep_ctxs) {
+    std::vector<std::string> var_names;
+    for (auto *ctx : iter.second) {
+      local_scope->Var(ctx->splited_var_names[0]);
+      var_names.push_back(ctx->splited_var_names[0]);
+    }
+    VLOG(4) << "recv " << var_names.size() << " vars from " << iter.first
+            << " in one request";
+    auto *rpc_client = distributed::RPCClient::GetInstance<RPCCLIENT_T>(
+        iter.second[0]->trainer_id);
+    auto handles =
+        rpc_client->AsyncGetVars(iter.first, cpu_ctx, *local_scope, var_names);
+    rets.insert(rets.end(), handles.begin(), handles.end());
+  }
+  for (size_t i = 0; i < rets.size(); i++) {
+    PADDLE_ENFORCE_NE(rets[i]->Wait(), 0U, platform::errors::External(
+                                               "internal error in RPCClient"));
+  }
+
+  for (auto &iter : ep_ctxs) {
+    for (auto *ctx : iter.second) {
+      auto &recv_name = ctx->splited_var_names[0];
+      auto &in = local_scope->FindVar(recv_name)->Get<framework::LoDTensor>();
+      auto *out = recv_scope_->FindVar(ctx->var_name)
+                      ->GetMutable<framework::LoDTensor>();
+      PADDLE_ENFORCE_EQ(
+          in.numel(), out->numel(),
+          platform::errors::InvalidArgument(
+              "The number of the received elements of %s is %d, but %d is "
+              "expected.",
+              recv_name, in.numel(), out->numel()));
+      memcpy(out->data<float>(), in.data<float>(), in.numel() * sizeof(float));
+    }
+  }
+}
+
 void AsyncCommunicator::Start() {
   VLOG(1) << "Communicator start";
   if (!communicator_) {
@@ -368,6 +485,10 @@ void GeoSgdCommunicator::InitImpl(const paddle::framework::ProgramDesc &program,
     for (int64_t section : vars_sections_int) {
       vars_first_dimension_[var_name] += section;
     }
+    if (is_sparse) {
+      dirty_rows_[var_name].reset(
+          new DirtyRows(vars_first_dimension_[var_name]));
+    }
     send_var_nums_ += split_varnames.size();
   }
 
@@ -377,8 +498,7 @@ void GeoSgdCommunicator::InitImpl(const paddle::framework::ProgramDesc &program,
 
   send_threadpool_.reset(new ::ThreadPool(thread_pool_size_));
   need_push_queue_ =
-      std::make_shared<BlockingQueue<std::shared_ptr<SparseIdsMap>>>(
-          geo_need_push_nums_);
+      std::make_shared<BlockingQueue<int>>(geo_need_push_nums_);
   delta_scope_.reset(new Scope());
   old_scope_.reset(new Scope());
   pserver_scope_.reset(new Scope());
@@ -432,38 +552,40 @@ void GeoSgdCommunicator::Send(const std::vector<std::string> &sparse_var_names,
     return;
   }
 
-  std::shared_ptr<SparseIdsMap> ids_table = std::make_shared<SparseIdsMap>();
   auto before_run_send = GetCurrentUS();
   for (size_t i = 0; i < sparse_var_tables.size(); i++) {
-    if (ids_table->find(sparse_var_tables[i]) == ids_table->end()) {
-      // create empty set for new sparse var
-      auto splited_var_nums =
-          recv_varname_to_ctx_[sparse_var_tables[i]].splited_var_names.size();
-      ids_table->insert(
-          std::pair<std::string, std::vector<std::unordered_set<int64_t>>>(
-              sparse_var_tables[i],
-              std::vector<std::unordered_set<int64_t>>{splited_var_nums}));
-    }
-    auto *var = scope.FindVar(sparse_var_names[i]);
-    auto var_tensor = var->Get<framework::LoDTensor>();
-    int element_number = var_tensor.numel();
-    int *var_mutable_data = var_tensor.mutable_data<int>(var_tensor.place());
-    // insert ids which has not been record
-    for (int j = 0; j < element_number; j++) {
-      auto ep_idx = GetSectionIndex(var_mutable_data[j],
-                                    absolute_section_[sparse_var_tables[i]]);
-      ids_table->at(sparse_var_tables[i])[ep_idx].insert(var_mutable_data[j]);
-      VLOG(4) << "Sparse var " << sparse_var_tables[i] << " insert "
-              << var_mutable_data[j];
+    auto dirty_it = dirty_rows_.find(sparse_var_tables[i]);
+    PADDLE_ENFORCE_EQ(dirty_it != dirty_rows_.end(), true,
+                      platform::errors::NotFound(
+                          "%s is not a sparse var of GeoSgdCommunicator.",
+                          sparse_var_tables[i]));
+    auto *dirty_rows = dirty_it->second.get();
+    auto &ids_tensor = scope.FindVar(sparse_var_names[i])
+                           ->Get<framework::LoDTensor>();
+    int64_t element_number = ids_tensor.numel();
+    // mark the ids, the rows of all the batches are merged by the bitmap
+    if (ids_tensor.type() == framework::proto::VarType::INT64) {
+      auto *ids = ids_tensor.data<int64_t>();
+      for (int64_t j = 0; j < element_number; j++) {
+        dirty_rows->Set(ids[j]);
+      }
+    } else {
+      auto *ids = ids_tensor.data<int>();
+      for (int64_t j = 0; j < element_number; j++) {
+        dirty_rows->Set(ids[j]);
+      }
     }
+    VLOG(4) << "Sparse var " << sparse_var_tables[i] << " marks "
+            << element_number << " ids";
   }
-  need_push_queue_->Push(ids_table);
+  need_push_queue_->Push(1);
   auto after_run_send = GetCurrentUS();
   VLOG(4) << "run send_op use time " << after_run_send - before_run_send;
 }
 
 void GeoSgdCommunicator::SendThread() {
   VLOG(1) << "SendThread start!";
+  platform::BindThreadToKind(platform::ThreadKind::kComm, 0);
   auto before_run_training = GetCurrentUS();
 
   while (running_) {
@@ -471,12 +593,11 @@ void GeoSgdCommunicator::SendThread() {
     task_futures.reserve(send_var_nums_);
 
     int wait_times = 0;
-    while (ids_send_vec_.size() < static_cast<size_t>(geo_need_push_nums_)) {
-      VLOG(4) << "ids_send_vec_ Size: " << ids_send_vec_.size();
+    while (need_push_batch_num_ < geo_need_push_nums_) {
+      VLOG(4) << "need push batch num: " << need_push_batch_num_;
       if (need_push_queue_->Size() > 0) {
         wait_times = 0;
-        ids_send_vec_.push_back(*(need_push_queue_->Pop()));
-        VLOG(4) << "ids_send_vec_ pushed";
+        need_push_batch_num_ += need_push_queue_->Pop();
       } else if (need_push_queue_->Size() == 0) {
         VLOG(4) << "wait_times -> " << wait_times;
         if (wait_times >= send_wait_times_) {
@@ -488,7 +609,7 @@ void GeoSgdCommunicator::SendThread() {
       }
     }
 
-    if (ids_send_vec_.size() >= static_cast<size_t>(geo_need_push_nums_)) {
+    if (need_push_batch_num_ >= geo_need_push_nums_) {
       auto after_run_training = GetCurrentUS();
       VLOG(4) << "run Training use time "
               << after_run_training - before_run_training;
@@ -502,10 +623,14 @@ void GeoSgdCommunicator::SendThread() {
           for (auto &splited_var_name : iter.second.splited_var_names) {
             auto send_task = [this, &var_name, &splited_var_name] {
               auto before_run_geo = GetCurrentUS();
-              VLOG(4) << "ids_send_vec_ size: " << ids_send_vec_.size();
-              auto ids_set =
-                  SparseIdsMerge(ids_send_vec_, var_name, splited_var_name);
-              SendUpdateSparseVars(var_name, splited_var_name, ids_set);
+              auto origin_var_name = DeltaVarToVar(var_name);
+              auto index = GetSplitedVarIndex(var_name, splited_var_name);
+              int64_t begin = absolute_section_[origin_var_name][index];
+              int64_t end =
+                  begin + send_varname_to_ctx_[var_name].height_sections[index];
+              std::vector<int64_t> rows;
+              dirty_rows_.at(origin_var_name)->Take(begin, end, &rows);
+              SendUpdateSparseVars(var_name, splited_var_name, rows);
               RecvUpdateSparseVars(var_name, splited_var_name);
               auto after_run_geo = GetCurrentUS();
               VLOG(3) << "run GEO-SGD var " << splited_var_name << " use time "
@@ -532,33 +657,11 @@ void GeoSgdCommunicator::SendThread() {
       for (auto &task_f : task_futures) {
         task_f.wait();
       }
-      ids_send_vec_.clear();
+      need_push_batch_num_ = 0;
     }
   }
 }
 
-std::unordered_set<int64_t> GeoSgdCommunicator::SparseIdsMerge(
-    const std::vector<SparseIdsMap> &ids_send_vec, const std::string &var_name,
-    const std::string &splited_var_name) {
-  // every batch has some sparse id, merge them into one unoredered_set
-  VLOG(4) << "Sparse Ids merge var: " << var_name
-          << " split var: " << splited_var_name;
-  auto before_run_ids_merge_ = GetCurrentUS();
-  auto origin_var_name = DeltaVarToVar(var_name);
-  auto splited_var_index = GetSplitedVarIndex(var_name, splited_var_name);
-  std::unordered_set<int64_t> ids_set;
-  for (auto ids_map : ids_send_vec) {
-    for (auto id : ids_map[origin_var_name][splited_var_index]) {
-      ids_set.insert(id);
-    }
-  }
-  auto after_run_ids_merge_ = GetCurrentUS();
-  VLOG(4) << "run SparseIdsMerge " << splited_var_name << " has nums "
-          << ids_set.size() << " use time "
-          << after_run_ids_merge_ - before_run_ids_merge_;
-  return ids_set;
-}
-
 void GeoSgdCommunicator::SendUpdateDenseVars(
     const std::string &var_name, const std::string &splited_var_name) {
   // calc var_delata = (var_training - var_old)/trainer_nums
@@ -648,14 +751,14 @@ void GeoSgdCommunicator::SendUpdateDenseVars(
 
 void GeoSgdCommunicator::SendUpdateSparseVars(
     const std::string &var_name, const std::string &splited_var_name,
-    const std::unordered_set<int64_t> &ids_table) {
+    const std::vector<int64_t> &rows) {
   // calc var_delata = (var_training - var_old)/trainer_nums
   // calc var_old += var_delta
   // var_name: param.delta, splited_var_name: param.block0.delta
   // origin_var_name: param
   auto before_run_send_sparse = GetCurrentUS();
 
-  auto ids_num = ids_table.size();
+  auto ids_num = rows.size();
   VLOG(4) << "Sparse Ids nums is : " << ids_num;
   auto origin_var_name = DeltaVarToVar(var_name);
 
@@ -677,24 +780,18 @@ void GeoSgdCommunicator::SendUpdateSparseVars(
   var_z_value->Resize({static_cast<int64_t>(ids_num), row_numel});
   auto *z_value = var_z_value->mutable_data<float>(var_x_tensor.place());
 
-  std::vector<int64_t> new_rows;
-  new_rows.insert(new_rows.begin(), ids_table.begin(), ids_table.end());
-
-  auto cpu_ctx = paddle::platform::CPUDeviceContext();
-  auto blas = math::GetBlas<paddle::platform::CPUDeviceContext, float>(cpu_ctx);
   float avg = 1 / static_cast<float>(trainer_nums_);
-  for (size_t y = 0; y < new_rows.size(); y++) {
-    auto ids = new_rows[y];
-
-    float *x_val = x_value + ids * row_numel;
-    float *y_val = y_value + ids * row_numel;
-    float *z_val = z_value + y * row_numel;
-
-    std::vector<float> row_delta(row_numel, 0);
-    blas.VSUB(row_numel, x_val, y_val, row_delta.data());
-    blas.SCAL(row_numel, avg, row_delta.data());
-    blas.VADD(row_numel, row_delta.data(), y_val, y_val);
-    blas.VCOPY(row_numel, row_delta.data(), z_val);
+  for (size_t y = 0; y < rows.size(); y++) {
+    // z = (x - y) / trainer_nums, y += z in one pass over the row, the rows
+    // are ascending so the training and the old params are read in order
+    const float *__restrict__ x_val = x_value + rows[y] * row_numel;
+    float *__restrict__ y_val = y_value + rows[y] * row_numel;
+    float *__restrict__ z_val = z_value + y * row_numel;
+    for (int64_t k = 0; k < row_numel; k++) {
+      float delta = (x_val[k] - y_val[k]) * avg;
+      y_val[k] += delta;
+      z_val[k] = delta;
+    }
   }
 
   auto after_run_send_sparse = GetCurrentUS();
@@ -703,8 +800,8 @@ void GeoSgdCommunicator::SendUpdateSparseVars(
 
   auto splited_var_index = GetSplitedVarIndex(var_name, splited_var_name);
   std::vector<int64_t> send_rows;
-  send_rows.reserve(new_rows.size());
-  for (auto idx : new_rows) {
+  send_rows.reserve(rows.size());
+  for (auto idx : rows) {
     send_rows.push_back(idx -
                         absolute_section_[origin_var_name][splited_var_index]);
   }
@@ -715,7 +812,7 @@ void GeoSgdCommunicator::SendUpdateSparseVars(
   auto before_send_sparse = GetCurrentUS();
   RpcSend(var_name, splited_var_name, splited_var_index);
   auto after_send_sparse = GetCurrentUS();
-  VLOG(4) << "send " << splited_var_name << " has nums " << new_rows.size()
+  VLOG(4) << "send " << splited_var_name << " has nums " << rows.size()
           << " use time " << after_send_sparse - before_send_sparse;
 }
 
@@ -964,6 +1061,9 @@ void HalfAsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
     }
 
     consume_threadpool_.reset(new ::ThreadPool(thread_pool_size_));
+    if (merge_thread_num_ > 1) {
+      merge_threadpool_.reset(new ::ThreadPool(merge_thread_num_));
+    }
   }
 
   if (recv_varname_to_ctx.size() == 0) {
@@ -1039,6 +1139,7 @@ void HalfAsyncCommunicator::Clean() {
 
 void HalfAsyncCommunicator::ConsumeThread() {
   VLOG(3) << "ConsumeThread start!";
+  platform::BindThreadToKind(platform::ThreadKind::kComm, 0);
   while (running_) {
     while (running_) {
       if (barrier_counter_.load() >= barrier_trigger_.load() &&
@@ -1079,7 +1180,8 @@ void HalfAsyncCommunicator::ConsumeThread() {
           }
           auto before_merge = GetCurrentUS();
 
-          MergeVars<float>(var_name, vars, send_scope_.get(), false);
+          MergeVars<float>(var_name, vars, send_scope_.get(), false,
+                           merge_threadpool_.get(), merge_thread_num_);
 
           auto after_merge = GetCurrentUS();
           VLOG(3) << "merge " << merged_var_num << " " << var_name
@@ -15,8 +15,10 @@ limitations under the License. */
 #pragma once
 
 #include <ThreadPool.h>
+#include <algorithm>
 #include <atomic>
 #include <deque>
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
 #include <string>
@@ -108,11 +110,179 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenVector = framework::EigenVector<T, MajorType, IndexType>;
 
+// Run fn(shard_id) for every shard on the pool, and wait for all of them.
+template <typename Func>
+inline void RunMergeShards(::ThreadPool* pool, int shard_num, Func&& fn) {
+  std::vector<std::future<void>> fs;
+  fs.reserve(shard_num);
+  for (int i = 0; i < shard_num; ++i) {
+    fs.push_back(pool->enqueue([&fn, i] { fn(i); }));
+  }
+  for (auto& f : fs) {
+    f.get();
+  }
+}
+
+// Sum (or average) the dense inputs into out[begin, end). The output is
+// accumulated tile by tile, so that it stays in the cache while all the
+// inputs are added to it, and the inner loop is a plain loop over restrict
+// pointers which the compiler vectorizes.
+template <typename T>
+inline void MergeDenseRange(const std::vector<const T*>& ins, T* out,
+                            int64_t begin, int64_t end, bool merge_add) {
+  constexpr int64_t kTileSize = 2048;
+  for (int64_t tile = begin; tile < end; tile += kTileSize) {
+    int64_t len = std::min(kTileSize, end - tile);
+    T* __restrict__ dst = out + tile;
+    std::copy(ins[0] + tile, ins[0] + tile + len, dst);
+    for (size_t k = 1; k < ins.size(); ++k) {
+      const T* __restrict__ src = ins[k] + tile;
+      for (int64_t i = 0; i < len; ++i) {
+        dst[i] += src[i];
+      }
+    }
+    if (!merge_add) {
+      T count = static_cast<T>(ins.size());
+      for (int64_t i = 0; i < len; ++i) {
+        dst[i] /= count;
+      }
+    }
+  }
+}
+
+template <typename T>
+inline void ParallelMergeDense(const std::vector<const T*>& ins, T* out,
+                               int64_t numel, bool merge_add,
+                               ::ThreadPool* pool, int shard_num) {
+  constexpr int64_t kMinShardSize = 1 << 14;
+  shard_num = static_cast<int>(std::min<int64_t>(
+      shard_num, (numel + kMinShardSize - 1) / kMinShardSize));
+  if (shard_num <= 1) {
+    MergeDenseRange(ins, out, 0, numel, merge_add);
+    return;
+  }
+  int64_t shard_size = (numel + shard_num - 1) / shard_num;
+  RunMergeShards(pool, shard_num, [&](int shard_id) {
+    int64_t begin = shard_id * shard_size;
+    int64_t end = std::min(numel, begin + shard_size);
+    if (begin < end) {
+      MergeDenseRange(ins, out, begin, end, merge_add);
+    }
+  });
+}
+
+// The same as math::scatter::MergeAdd and MergeAverage on CPU, i.e., the
+// output rows are sorted and unique, but the rows are merged by the shards
+// of the pool. The ids of the output rows are looked up by binary search,
+// and each shard accumulates the input rows falling into its own range of
+// the output rows, so that no two shards write the same output row.
+template <typename T>
+inline void ParallelMergeSelectedRows(
+    const std::vector<const framework::SelectedRows*>& inputs,
+    framework::SelectedRows* out, bool merge_add, ::ThreadPool* pool,
+    int shard_num) {
+  std::vector<const framework::SelectedRows*> valid_inputs;
+  for (auto* in : inputs) {
+    if (!in->rows().empty()) {
+      valid_inputs.push_back(in);
+    }
+  }
+  if (valid_inputs.empty()) {
+    VLOG(3) << "no input has value! just return";
+    return;
+  }
+  int64_t width = valid_inputs[0]->value().dims()[1];
+  int64_t height = valid_inputs[0]->height();
+  size_t row_num = 0;
+  for (auto* in : valid_inputs) {
+    PADDLE_ENFORCE_EQ(width, in->value().dims()[1],
+                      platform::errors::InvalidArgument(
+                          "All inputs should have the same dimension except "
+                          "for the first one, but received %d and %d.",
+                          width, in->value().dims()[1]));
+    PADDLE_ENFORCE_EQ(height, in->height(),
+                      platform::errors::InvalidArgument(
+                          "All inputs should have the same height, but "
+                          "received %d and %d.",
+                          height, in->height()));
+    row_num += in->rows().size();
+  }
+
+  std::vector<int64_t> merged_rows;
+  merged_rows.reserve(row_num);
+  for (auto* in : valid_inputs) {
+    merged_rows.insert(merged_rows.end(), in->rows().begin(),
+                       in->rows().end());
+  }
+  std::sort(merged_rows.begin(), merged_rows.end());
+  merged_rows.erase(std::unique(merged_rows.begin(), merged_rows.end()),
+                    merged_rows.end());
+  int64_t out_row_num = static_cast<int64_t>(merged_rows.size());
+
+  out->set_height(height);
+  T* out_data = out->mutable_value()->mutable_data<T>(
+      framework::make_ddim({out_row_num, width}), platform::CPUPlace());
+
+  // the output row id of every input row
+  std::vector<std::vector<int64_t>> out_ids(valid_inputs.size());
+  RunMergeShards(pool, shard_num, [&](int shard_id) {
+    for (size_t k = shard_id; k < valid_inputs.size(); k += shard_num) {
+      auto& rows = valid_inputs[k]->rows();
+      out_ids[k].resize(rows.size());
+      for (size_t i = 0; i < rows.size(); ++i) {
+        out_ids[k][i] = std::lower_bound(merged_rows.begin(),
+                                         merged_rows.end(), rows[i]) -
+                        merged_rows.begin();
+      }
+    }
+  });
+
+  std::vector<int64_t> merge_count;
+  if (!merge_add) {
+    merge_count.resize(out_row_num, 0);
+  }
+  int64_t shard_size = (out_row_num + shard_num - 1) / shard_num;
+  RunMergeShards(pool, shard_num, [&](int shard_id) {
+    int64_t begin = shard_id * shard_size;
+    int64_t end = std::min(out_row_num, begin + shard_size);
+    if (begin >= end) return;
+    std::fill(out_data + begin * width, out_data + end * width,
+              static_cast<T>(0));
+    for (size_t k = 0; k < valid_inputs.size(); ++k) {
+      const T* in_data = valid_inputs[k]->value().data<T>();
+      auto& ids = out_ids[k];
+      for (size_t i = 0; i < ids.size(); ++i) {
+        int64_t id = ids[i];
+        if (id < begin || id >= end) continue;
+        T* __restrict__ dst = out_data + id * width;
+        const T* __restrict__ src = in_data + i * width;
+        for (int64_t j = 0; j < width; ++j) {
+          dst[j] += src[j];
+        }
+      }
+    }
+    if (!merge_add) {
+      // MergeAverage divides by the number of inputs, including the empty
+      // ones.
+      T count = static_cast<T>(inputs.size());
+      for (int64_t j = begin * width; j < end * width; ++j) {
+        out_data[j] /= count;
+      }
+    }
+  });
+  out->set_rows(merged_rows);
+}
+
+// Merge the vars into the var_name of scope. If pool is given and
+// shard_num > 1, the merge is split into shard_num shards which run on the
+// pool, the pool must not be the one calling MergeVars.
 template <typename T>
 inline void MergeVars(const std::string& var_name,
                       const std::vector<std::shared_ptr<Variable>>& vars,
-                      Scope* scope, bool merge_add = true) {
+                      Scope* scope, bool merge_add = true,
+                      ::ThreadPool* pool = nullptr, int shard_num = 1) {
   PADDLE_ENFORCE(!vars.empty(), "should have value to merge!");
+  bool parallel = pool != nullptr && shard_num > 1;
   auto cpu_place = platform::CPUPlace();
   auto& var0 = vars[0];
   auto* out_var = scope->Var(var_name);
@@ -129,6 +299,17 @@ inline void MergeVars(const std::string& var_name,
       PADDLE_ENFORCE_EQ(var_t.dims(), dims, "should have the same dims");
     }
 
+    if (parallel) {
+      std::vector<const T*> ins;
+      ins.reserve(vars.size());
+      for (auto& var : vars) {
+        ins.push_back(var->Get<framework::LoDTensor>().data<T>());
+      }
+      ParallelMergeDense(ins, out_t->data<T>(), out_t->numel(), merge_add,
+                         pool, shard_num);
+      return;
+    }
+
     // set output tensor to 0.
     auto cpu_ctx = paddle::platform::CPUDeviceContext();
     math::SetConstant<paddle::platform::CPUDeviceContext, T> constant_functor;
@@ -155,7 +336,10 @@ inline void MergeVars(const std::string& var_name,
       inputs.push_back(&var->Get<framework::SelectedRows>());
     }
     auto dev_ctx = paddle::platform::CPUDeviceContext();
-    if (merge_add) {
+    if (parallel) {
+      ParallelMergeSelectedRows<T>(inputs, out_slr, merge_add, pool,
+                                   shard_num);
+    } else if (merge_add) {
       math::scatter::MergeAdd<paddle::platform::CPUDeviceContext, T> merge_add;
       merge_add(dev_ctx, inputs, out_slr);
     } else {
@@ -231,8 +415,63 @@ class Communicator {
   std::unordered_map<std::string, std::string> envs;
 };
 
-using SparseIdsMap =
-    std::unordered_map<std::string, std::vector<std::unordered_set<int64_t>>>;
+// DirtyRows records which rows of a sparse parameter are updated since they
+// were taken last time, one bit per row. Set() is lock-free, so that all the
+// training threads can mark their ids concurrently, and Take() clears the
+// bits of a row range and returns the marked rows in ascending order.
+class DirtyRows {
+ public:
+  explicit DirtyRows(int64_t height)
+      : height_(height),
+        word_num_((height + kWordBits - 1) / kWordBits),
+        words_(new std::atomic<uint64_t>[word_num_]) {
+    for (int64_t i = 0; i < word_num_; ++i) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  int64_t height() const { return height_; }
+
+  void Set(int64_t row) {
+    PADDLE_ENFORCE_EQ(row >= 0 && row < height_, true,
+                      platform::errors::OutOfRange(
+                          "The sparse id %d is out of the range [0, %d).", row,
+                          height_));
+    words_[row / kWordBits].fetch_or(uint64_t(1) << (row % kWordBits),
+                                     std::memory_order_relaxed);
+  }
+
+  // Clear the rows in [begin, end) and append the ones which are set to rows.
+  void Take(int64_t begin, int64_t end, std::vector<int64_t>* rows) {
+    end = std::min(end, height_);
+    for (int64_t w = begin / kWordBits; begin < end; ++w) {
+      int64_t word_end = std::min(end, (w + 1) * kWordBits);
+      uint64_t mask = WordMask(begin % kWordBits, word_end - w * kWordBits);
+      begin = word_end;
+      // most words are clean, skip them without the atomic write
+      if ((words_[w].load(std::memory_order_relaxed) & mask) == 0) continue;
+      uint64_t bits =
+          words_[w].fetch_and(~mask, std::memory_order_relaxed) & mask;
+      while (bits != 0) {
+        rows->push_back(w * kWordBits + __builtin_ctzll(bits));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+ private:
+  static constexpr int64_t kWordBits = 64;
+
+  // The bits [from, to) of a word, 0 <= from < to <= 64.
+  static uint64_t WordMask(int64_t from, int64_t to) {
+    uint64_t high = to == kWordBits ? ~uint64_t(0) : (uint64_t(1) << to) - 1;
+    return high & ~((uint64_t(1) << from) - 1);
+  }
+
+  int64_t height_;
+  int64_t word_num_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
 
 class AsyncCommunicator : public Communicator {
  public:
@@ -249,6 +488,13 @@ class AsyncCommunicator : public Communicator {
     send_queue_size_ = std::stoi(envs.at("communicator_send_queue_size"));
     is_sgd_optimizer_ =
         static_cast<bool>(std::stoi(envs.at("communicator_is_sgd_optimizer")));
+    if (envs.count("communicator_merge_thread_num") > 0) {
+      merge_thread_num_ = std::stoi(envs.at("communicator_merge_thread_num"));
+    }
+    if (envs.count("communicator_batch_var_max_bytes") > 0) {
+      batch_var_max_bytes_ =
+          std::stoll(envs.at("communicator_batch_var_max_bytes"));
+    }
     VLOG(0) << "AsyncCommunicator Initialized";
   }
   ~AsyncCommunicator();
@@ -272,6 +518,19 @@ class AsyncCommunicator : public Communicator {
             const std::vector<std::string>& var_tables,
             const framework::Scope& scope) override;
 
+ private:
+  // Whether var of ctx is a dense FP32 var which is not split and not larger
+  // than batch_var_max_bytes_, which is sent or received together with the
+  // other such vars of the same endpoint in one request.
+  bool IsBatched(const RpcContext& ctx, const Scope& scope) const;
+
+  // Send the merged vars of send_scope_, from the endpoint to their contexts.
+  void SendBatched(
+      const std::map<std::string, std::vector<const RpcContext*>>& ep_ctxs);
+
+  void RecvBatched(
+      const std::map<std::string, std::vector<const RpcContext*>>& ep_ctxs);
+
  private:
   int min_send_grad_num_before_recv_;
   int thread_pool_size_;
@@ -280,6 +539,11 @@ class AsyncCommunicator : public Communicator {
   int send_queue_size_;
   bool independent_recv_thread_;
   bool is_sgd_optimizer_;
+  // the number of threads merging one var, 0 means merging on the send
+  // thread itself
+  int merge_thread_num_{0};
+  // the max bytes of the vars to be batched, 0 means no batching
+  int64_t batch_var_max_bytes_{0};
 
  private:
   std::unordered_map<std::string,
@@ -293,6 +557,7 @@ class AsyncCommunicator : public Communicator {
   std::unique_ptr<Scope> send_scope_;  // an independent scope
   std::unique_ptr<::ThreadPool> send_threadpool_{nullptr};
   std::unique_ptr<::ThreadPool> recv_threadpool_{nullptr};
+  std::unique_ptr<::ThreadPool> merge_threadpool_{nullptr};
   std::atomic_uint grad_num_{0};  // the num of gradient sent since last recv
 };
 
@@ -305,6 +570,9 @@ class HalfAsyncCommunicator : public Communicator {
     send_wait_times_ = std::stoi(envs.at("communicator_send_wait_times"));
     thread_pool_size_ = std::stoi(envs.at("communicator_thread_pool_size"));
     send_queue_size_ = std::stoi(envs.at("communicator_send_queue_size"));
+    if (envs.count("communicator_merge_thread_num") > 0) {
+      merge_thread_num_ = std::stoi(envs.at("communicator_merge_thread_num"));
+    }
     VLOG(0) << "HalfAsyncCommunicator Initialized";
   }
   ~HalfAsyncCommunicator();
@@ -341,6 +609,7 @@ class HalfAsyncCommunicator : public Communicator {
   int send_wait_times_;
   int thread_pool_size_;
   int send_queue_size_;
+  int merge_thread_num_{0};
   int trainer_id_ = 0;
 
  protected:
@@ -354,6 +623,7 @@ class HalfAsyncCommunicator : public Communicator {
   std::unique_ptr<Scope> send_scope_;  // an independent scope
   std::unique_ptr<::ThreadPool> consume_threadpool_{nullptr};
   std::unique_ptr<::ThreadPool> recv_threadpool_{nullptr};
+  std::unique_ptr<::ThreadPool> merge_threadpool_{nullptr};
 
   // mutex for Wait for barrier
   std::mutex barrier_mutex_;
@@ -408,16 +678,13 @@ class GeoSgdCommunicator : public Communicator {
 
  private:
   void SendThread();
-  std::unordered_set<int64_t> SparseIdsMerge(
-      const std::vector<SparseIdsMap>& ids_send_vec,
-      const std::string& var_name, const std::string& splited_var_name);
 
   void SendUpdateDenseVars(const std::string& var_name,
                            const std::string& splited_var_name);
 
   void SendUpdateSparseVars(const std::string& var_name,
                             const std::string& splited_var_name,
-                            const std::unordered_set<int64_t>& ids_table);
+                            const std::vector<int64_t>& rows);
 
   void RecvUpdateDenseVars(const std::string& var_name,
                            const std::string& splited_var_name);
@@ -494,9 +761,11 @@ class GeoSgdCommunicator : public Communicator {
   // if var is sparse, using selected rows, bool=true
   std::unordered_map<std::string, bool> var_list_;
 
-  std::shared_ptr<BlockingQueue<std::shared_ptr<SparseIdsMap>>>
-      need_push_queue_;
-  std::vector<SparseIdsMap> ids_send_vec_;
+  // the rows of each sparse var updated since its last push
+  std::unordered_map<std::string, std::unique_ptr<DirtyRows>> dirty_rows_;
+  // every Send pushes one batch, the ids are recorded in dirty_rows_
+  std::shared_ptr<BlockingQueue<int>> need_push_queue_;
+  int need_push_batch_num_ = 0;
 
   std::unordered_map<std::string, std::vector<int64_t>> absolute_section_;
   std::unordered_map<std::string, int64_t> vars_first_dimension_;
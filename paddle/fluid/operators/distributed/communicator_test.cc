@@ -16,6 +16,8 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <memory>
+#include <random>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "paddle/fluid/operators/distributed/communicator.h"
@@ -105,6 +107,114 @@ TEST(communicator, merge_selected_rows) {
   }
 }
 
+TEST(communicator, parallel_merge_vars) {
+  auto cpu_place = platform::CPUPlace();
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<float> value_dist(-1.0, 1.0);
+  std::uniform_int_distribution<int64_t> row_dist(0, 999);
+  const int64_t width = 16;
+  std::vector<std::shared_ptr<framework::Variable>> dense_vars;
+  std::vector<std::shared_ptr<framework::Variable>> sparse_vars;
+  for (auto i = 0; i < 8; ++i) {
+    auto var = std::make_shared<Variable>();
+    dense_vars.emplace_back(var);
+    auto *tensor = var->GetMutable<LoDTensor>();
+    auto *data = tensor->mutable_data<float>(
+        framework::make_ddim({1000, 100}), cpu_place);
+    for (auto j = 0; j < tensor->numel(); ++j) {
+      data[j] = value_dist(engine);
+    }
+
+    // duplicated rows, and an empty input
+    std::vector<int64_t> rows;
+    for (auto k = 0; k < i * 50; ++k) {
+      rows.push_back(row_dist(engine));
+    }
+    var = std::make_shared<Variable>();
+    sparse_vars.emplace_back(var);
+    auto *slr = var->GetMutable<SelectedRows>();
+    slr->set_height(1000);
+    slr->set_rows(rows);
+    data = slr->mutable_value()->mutable_data<float>(
+        framework::make_ddim({static_cast<int64_t>(rows.size()), width}),
+        cpu_place);
+    for (size_t j = 0; j < rows.size() * width; ++j) {
+      data[j] = value_dist(engine);
+    }
+  }
+
+  ::ThreadPool pool(4);
+  framework::Scope scope;
+  for (bool merge_add : {true, false}) {
+    MergeVars<float>("dense", dense_vars, &scope, merge_add);
+    MergeVars<float>("dense_parallel", dense_vars, &scope, merge_add, &pool,
+                     4);
+    auto &dense = scope.FindVar("dense")->Get<LoDTensor>();
+    auto &dense_parallel = scope.FindVar("dense_parallel")->Get<LoDTensor>();
+    ASSERT_EQ(dense_parallel.dims(), dense.dims());
+    for (auto i = 0; i < dense.numel(); ++i) {
+      ASSERT_NEAR(dense_parallel.data<float>()[i], dense.data<float>()[i],
+                  1e-5);
+    }
+
+    MergeVars<float>("sparse", sparse_vars, &scope, merge_add);
+    MergeVars<float>("sparse_parallel", sparse_vars, &scope, merge_add, &pool,
+                     4);
+    auto &sparse = scope.FindVar("sparse")->Get<SelectedRows>();
+    auto &sparse_parallel =
+        scope.FindVar("sparse_parallel")->Get<SelectedRows>();
+    ASSERT_EQ(sparse_parallel.height(), sparse.height());
+    ASSERT_EQ(sparse_parallel.rows(), sparse.rows());
+    ASSERT_EQ(sparse_parallel.value().dims(), sparse.value().dims());
+    for (auto i = 0; i < sparse.value().numel(); ++i) {
+      ASSERT_NEAR(sparse_parallel.value().data<float>()[i],
+                  sparse.value().data<float>()[i], 1e-5);
+    }
+  }
+}
+
+TEST(communicator, dirty_rows) {
+  const int64_t height = 1000;
+  DirtyRows dirty_rows(height);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&dirty_rows, t]() {
+      for (int64_t row = t; row < height; row += 7) {
+        dirty_rows.Set(row);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  // the rows are taken section by section, and a word is split by 130
+  std::vector<int64_t> expected;
+  for (int64_t row = 0; row < height; ++row) {
+    if (row % 7 < 4) {
+      expected.push_back(row);
+    }
+  }
+  std::vector<int64_t> rows;
+  dirty_rows.Take(0, 130, &rows);
+  dirty_rows.Take(130, height, &rows);
+  EXPECT_EQ(rows, expected);
+
+  // the taken rows are cleared
+  rows.clear();
+  dirty_rows.Take(0, height, &rows);
+  EXPECT_TRUE(rows.empty());
+  dirty_rows.Set(63);
+  dirty_rows.Set(64);
+  dirty_rows.Set(999);
+  dirty_rows.Take(64, 1000, &rows);
+  EXPECT_EQ(rows, std::vector<int64_t>({64, 999}));
+  rows.clear();
+  dirty_rows.Take(0, 64, &rows);
+  EXPECT_EQ(rows, std::vector<int64_t>({63}));
+  EXPECT_THROW(dirty_rows.Set(height), platform::EnforceNotMet);
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -29,6 +29,23 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+void BaseProcessor::EndTrace() {
+  ServerRPCPhases server;
+  auto& metadata = context_->GetServerTrailingMetadata();
+  auto it = metadata.find(kRPCTraceMetadataKey);
+  // the pserver may not trace, then its phases are counted into the network
+  if (it != metadata.end()) {
+    std::string value(it->second.data(), it->second.size());
+    if (!ServerRPCPhases::Decode(value, &server) ||
+        server.request_id != trace_.request_id) {
+      server = ServerRPCPhases();
+    }
+  }
+  RPCTraceStats::Instance().Record(var_h_->method(), var_h_->name(),
+                                   trace_.request_id,
+                                   trace_.Phases(RPCTraceNowUs(), server));
+}
+
 void GRPCClient::InitImpl() {
   // start the client process thread
   // TODO(wuyi): can make this in a threadpool
@@ -46,6 +63,9 @@ void GRPCClient::SendComplete() {
     }
     PADDLE_ENFORCE(this->Wait(), "internal grpc error");
     completed_ = true;
+    if (FLAGS_rpc_trace) {
+      LOG(INFO) << "\n" << RPCTraceStats::Instance().Report();
+    }
   }
 }
 
@@ -86,7 +106,10 @@ VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
       auto* var = p_scope->FindVar(var_name_val);
 
       ::grpc::ByteBuffer req;
-      SerializeToByteBuffer(var_name_val, var, *p_ctx, &req, "", trainer_id_);
+      uint64_t request_id = s->BeginTrace(trainer_id_);
+      SerializeToByteBuffer(var_name_val, var, *p_ctx, &req, "", trainer_id_,
+                            "", request_id);
+      s->TraceSerialized();
 
       VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
 
@@ -122,6 +145,71 @@ VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
   }
 }
 
+std::vector<VarHandlePtr> GRPCClient::AsyncSendVars(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::vector<std::string>& var_names,
+    int64_t time_out) {
+  const platform::DeviceContext* p_ctx = &ctx;
+  const std::string ep_val = ep;
+  const std::vector<std::string> var_names_val = var_names;
+  const framework::Scope* p_scope = &scope;
+  const auto ch = GetChannel(ep_val);
+  const std::string method = kSendRPC;
+
+  int retry_times_ = 0;
+
+  while (true) {
+    SendProcessor* s = new SendProcessor(ch);
+    VarHandlePtr h(
+        new VarHandle(ep, method, BATCHED_VARS_MESSAGE, p_ctx, p_scope));
+    s->Prepare(h, time_out);
+
+    framework::AsyncIO([var_names_val, p_scope, s, method, h, this] {
+      std::vector<framework::Variable*> vars;
+      for (auto& var_name : var_names_val) {
+        vars.push_back(p_scope->FindVar(var_name));
+      }
+
+      ::grpc::ByteBuffer req;
+      uint64_t request_id = s->BeginTrace(trainer_id_);
+      SerializeBatchToByteBuffer(BATCHED_VARS_MESSAGE, var_names_val, vars,
+                                 &req, trainer_id_, request_id);
+      s->TraceSerialized();
+
+      VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
+
+      // stub context
+      s->response_call_back_ = nullptr;
+
+      platform::RecordRPCEvent record_event(method);
+
+      auto call = s->stub_g_.PrepareUnaryCall(
+          s->context_.get(), "/sendrecv.SendRecvService/SendVariable", req,
+          &cq_);
+      call->StartCall();
+      call->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
+
+      if (UNLIKELY(platform::IsProfileEnabled())) {
+        h->Wait();
+      }
+    });
+    req_count_++;
+
+    if (FLAGS_rpc_retry_times > 0 && retry_times_ < FLAGS_rpc_retry_times) {
+      h->Wait();
+      if (h->should_retry) {
+        VLOG(3) << "rpc call failed, retry times " << retry_times_;
+        retry_times_++;
+        std::random_device rd;
+        std::this_thread::sleep_for(std::chrono::milliseconds(rd() % 5));
+        continue;
+      }
+    }
+
+    return {h};
+  }
+}
+
 void ProcGetResponse(const VarHandle& var_h,
                      const ::grpc::ByteBuffer& ret_msg) {
   VLOG(4) << "ProcGetResponse";
@@ -152,6 +240,16 @@ VarHandlePtr GRPCClient::AsyncGetVar(const std::string& ep,
                       time_out);
 }
 
+std::vector<VarHandlePtr> GRPCClient::AsyncGetVars(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::vector<std::string>& var_names,
+    int64_t time_out) {
+  return {_AsyncGetVar(ep, ctx, scope, kGetRPC, BATCHED_VARS_MESSAGE,
+                       BATCHED_VARS_MESSAGE,
+                       "/sendrecv.SendRecvService/GetVariable", "", time_out,
+                       var_names)};
+}
+
 VarHandlePtr GRPCClient::AsyncGetVarNoBarrier(
     const std::string& ep, const platform::DeviceContext& ctx,
     const framework::Scope& scope, const std::string& var_name,
@@ -178,7 +276,7 @@ VarHandlePtr GRPCClient::_AsyncGetVar(
     const framework::Scope& scope, const std::string& method,
     const std::string& var_name, const std::string& out_varname,
     const std::string& rpc_path, const std::string& table_name,
-    int64_t time_out) {
+    int64_t time_out, const std::vector<std::string>& batched_var_names) {
   const platform::DeviceContext* p_ctx = &ctx;
   const std::string ep_val = ep;
   const std::string var_name_val = var_name;
@@ -195,16 +293,22 @@ VarHandlePtr GRPCClient::_AsyncGetVar(
     VarHandlePtr h(new VarHandle(ep, method, out_varname_val, p_ctx, p_scope));
     s->Prepare(h, time_out);
 
-    framework::AsyncIO([var_name_val, out_varname_val, table_name_val, s,
-                        method, p_ctx, h, rpc_path, this] {
+    framework::AsyncIO([var_name_val, out_varname_val, table_name_val,
+                        batched_var_names, s, method, p_ctx, h, rpc_path,
+                        this] {
       // prepare input
       sendrecv::VariableMessage req;
       req.set_varname(var_name_val);
       req.set_out_varname(out_varname_val);
       req.set_trainer_id(trainer_id_);
       req.set_table_name(table_name_val);
+      req.set_request_id(s->BeginTrace(trainer_id_));
+      for (auto& batched_var_name : batched_var_names) {
+        req.add_batched_vars()->set_varname(batched_var_name);
+      }
       ::grpc::ByteBuffer buf;
       RequestToByteBuffer<sendrecv::VariableMessage>(req, &buf);
+      s->TraceSerialized();
 
       VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
 
@@ -267,8 +371,10 @@ VarHandlePtr GRPCClient::AsyncPrefetchVar(const std::string& ep,
       auto* var = p_scope->FindVar(in_var_name_val);
 
       ::grpc::ByteBuffer req;
+      uint64_t request_id = s->BeginTrace(trainer_id_);
       SerializeToByteBuffer(in_var_name_val, var, *p_ctx, &req,
-                            out_var_name_val, 0, table_name_val);
+                            out_var_name_val, 0, table_name_val, request_id);
+      s->TraceSerialized();
 
       VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
 
@@ -410,19 +516,20 @@ VarHandlePtr GRPCClient::AsyncSendComplete(const std::string& ep,
 
 VarHandlePtr GRPCClient::AsyncCheckpointNotify(const std::string& ep,
                                                const std::string& dir,
-                                               int64_t time_out) {
+                                               int mode, int64_t time_out) {
   const auto ch = GetChannel(ep);
 
   CheckpointNotifyProcessor* s = new CheckpointNotifyProcessor(ch);
 
   const std::string method = kCheckPointNotifyRPC;
 
-  VarHandlePtr h(
-      new VarHandle(ep, method, CHECKPOINT_SAVE_MESSAGE, nullptr, nullptr));
+  const std::string message =
+      mode == 1 ? CHECKPOINT_SAVE_DELTA_MESSAGE : CHECKPOINT_SAVE_MESSAGE;
+  VarHandlePtr h(new VarHandle(ep, method, message, nullptr, nullptr));
   s->Prepare(h, time_out);
 
   sendrecv::VariableMessage req;
-  req.set_varname(CHECKPOINT_SAVE_MESSAGE);
+  req.set_varname(message);
   req.set_out_varname(dir);
 
   platform::RecordRPCEvent record_event(method);
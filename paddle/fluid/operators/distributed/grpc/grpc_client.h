@@ -44,6 +44,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/distributed_pb.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
+#include "paddle/fluid/operators/distributed/rpc_trace.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 #include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
 
@@ -73,10 +74,24 @@ class BaseProcessor {
   }
 
   void Process() {
+    if (trace_.request_id != 0) trace_.responded_us = RPCTraceNowUs();
     ProcessImpl();
+    if (trace_.request_id != 0) EndTrace();
     var_h_->Finish(true);
   }
 
+  // Called before serializing the request, return the id to send with it,
+  // zero if FLAGS_rpc_trace is off.
+  uint64_t BeginTrace(int trainer_id) {
+    if (!FLAGS_rpc_trace) return 0;
+    trace_.request_id = NewRPCRequestId(trainer_id);
+    trace_.start_us = RPCTraceNowUs();
+    return trace_.request_id;
+  }
+  void TraceSerialized() {
+    if (trace_.request_id != 0) trace_.serialized_us = RPCTraceNowUs();
+  }
+
   VarHandlePtr GetVarHandlePtr() { return var_h_; }
   bool Wait() { return var_h_->Wait(); }
   void Finish(bool ok) { return var_h_->Finish(ok); }
@@ -86,7 +101,12 @@ class BaseProcessor {
   grpc::Status status_;
 
  protected:
+  // Merge the phases of the pserver from the trailing metadata, and record
+  // the request into RPCTraceStats.
+  void EndTrace();
+
   VarHandlePtr var_h_;
+  RPCTrace trace_;
 };
 
 typedef std::function<void(const VarHandle&, const ::grpc::ByteBuffer&)>
@@ -192,6 +212,16 @@ class GRPCClient : public RPCClient {
                            const std::string& table_name = "",
                            int64_t time_out = FLAGS_rpc_deadline) override;
 
+  std::vector<VarHandlePtr> AsyncSendVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
+  std::vector<VarHandlePtr> AsyncGetVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
   VarHandlePtr AsyncGetVarNoBarrier(
       const std::string& ep, const platform::DeviceContext& ctx,
       const framework::Scope& scope, const std::string& var_name,
@@ -222,7 +252,7 @@ class GRPCClient : public RPCClient {
       int64_t time_out = FLAGS_rpc_deadline) override;
 
   VarHandlePtr AsyncCheckpointNotify(
-      const std::string& ep, const std::string& dir,
+      const std::string& ep, const std::string& dir, int mode = 0,
       int64_t time_out = FLAGS_rpc_deadline) override;
 
   VarHandlePtr AsyncDistributeNotify(
@@ -248,7 +278,8 @@ class GRPCClient : public RPCClient {
       const framework::Scope& scope, const std::string& method,
       const std::string& var_name, const std::string& out_varname,
       const std::string& rpc_path, const std::string& table_name = "",
-      int64_t time_out = FLAGS_rpc_deadline);
+      int64_t time_out = FLAGS_rpc_deadline,
+      const std::vector<std::string>& batched_var_names = {});
 
  private:
   grpc::CompletionQueue cq_;
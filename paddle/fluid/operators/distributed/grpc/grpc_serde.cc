@@ -17,7 +17,9 @@ limitations under the License. */
 #endif
 #include <limits>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/io/zero_copy_stream.h"
@@ -34,28 +36,35 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+static void SetProfileState(VarMsg* request) {
+  // Note: normally the profiler is enabled in 1 trainer, hence only
+  // 1 trainer returns true for ShouldSendProfileState(). It tells PS
+  // servers the trainer's profiling state so that PS can follow the
+  // trainer.
+  if (platform::ShouldSendProfileState()) {
+    if (platform::IsProfileEnabled()) {
+      request->set_profile(platform::kEnableProfiler);
+    } else {
+      request->set_profile(platform::kDisableProfiler);
+    }
+  }
+}
+
 void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            const platform::DeviceContext& ctx,
                            ::grpc::ByteBuffer* msg, const std::string& out_name,
                            const int trainer_id,
-                           const std::string& table_name) {
+                           const std::string& table_name,
+                           const uint64_t request_id) {
   platform::RecordRPCEvent record_event("serial");
   VarMsg request;
   TensorPayload* payload = nullptr;
+  RowsPayload* rows_payload = nullptr;
 
   request.set_varname(name);
   request.set_trainer_id(trainer_id);
-  // Note: normally the profiler is enabled in 1 trainer, hence only
-  // 1 trainer returns true for ShouldSendProfileState(). It tells PS
-  // servers the trainer's profiling state so that PS can follow the
-  // trainer.
-  if (platform::ShouldSendProfileState()) {
-    if (platform::IsProfileEnabled()) {
-      request.set_profile(platform::kEnableProfiler);
-    } else {
-      request.set_profile(platform::kDisableProfiler);
-    }
-  }
+  request.set_request_id(request_id);
+  SetProfileState(&request);
   if (!out_name.empty()) {
     request.set_out_varname(out_name);
   }
@@ -68,6 +77,7 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
   } else if (var->IsType<framework::SelectedRows>()) {
     request.set_type(::sendrecv::SELECTED_ROWS);
     payload = new TensorPayload(GetSelectedRowsPayload(var, ctx, &request));
+    rows_payload = GetRowsPayload(var, &request);
 #ifdef PADDLE_WITH_NCCL
   } else if (var->IsType<ncclUniqueId>()) {
     request.set_type(::sendrecv::NCCL_ID);
@@ -124,19 +134,17 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
     ProtoEncodeHelper e2(static_cast<char*>(buf), 128);
 
     PADDLE_ENFORCE(VectorElemName(slr->rows()) == typeid(int64_t).name());
-    size_t rows_memory_size = slr->rows().size() * sizeof(int64_t);
+    size_t rows_memory_size = rows_payload->memory_size();
 
     e2.WriteVarlengthBeginning(VarMsg::kRowsFieldNumber, rows_memory_size);
     slices[2] = ::grpc::Slice(e2.size());
     memcpy(const_cast<uint8_t*>(slices[2].begin()), e2.data(), e2.size());
 
+    // the rows are referenced by the payload until the slice is released
     slices[3] = ::grpc::Slice(
         grpc_slice_new_with_user_data(
-            const_cast<void*>(
-                reinterpret_cast<const void*>(slr->rows().data())),
-            rows_memory_size, [](void* backing) {},
-            const_cast<char*>(
-                reinterpret_cast<const char*>(slr->rows().data()))),
+            const_cast<void*>(rows_payload->ptr()), rows_memory_size,
+            RowsDestroyCallback, rows_payload),
         ::grpc::Slice::STEAL_REF);
     num_slices = 4;
   }
@@ -145,6 +153,49 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
   msg->Swap(&tmp);
 }
 
+void SerializeBatchToByteBuffer(const std::string& name,
+                                const std::vector<std::string>& var_names,
+                                const std::vector<framework::Variable*>& vars,
+                                ::grpc::ByteBuffer* msg, const int trainer_id,
+                                const uint64_t request_id) {
+  platform::RecordRPCEvent record_event("serial");
+  VarMsg request;
+  request.set_varname(name);
+  request.set_trainer_id(trainer_id);
+  request.set_request_id(request_id);
+  request.set_type(::sendrecv::LOD_TENSOR);
+  SetProfileState(&request);
+  auto* payload =
+      new TensorPayload(GetBatchedTensorPayload(var_names, vars, &request));
+  if (payload->memory_size() >= std::numeric_limits<int>::max()) {
+    delete payload;
+    PADDLE_THROW(platform::errors::InvalidArgument(
+        "The batched variables of %s are too large, the length should be "
+        "less than %d.",
+        name, std::numeric_limits<int>::max()));
+  }
+
+  // The header grows with the number of the batched variables.
+  std::string header;
+  request.AppendToString(&header);
+  size_t buf_size = header.size() + 16;
+  auto buffer = std::unique_ptr<char[]>(new char[buf_size]);
+  ProtoEncodeHelper e(buffer.get(), buf_size);
+  e.WriteRawBytes(header);
+  e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
+                            payload->memory_size());
+
+  ::grpc::Slice slices[2];  // metadata, tensor
+  slices[0] = ::grpc::Slice(e.size());
+  memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
+  slices[1] = ::grpc::Slice(
+      grpc_slice_new_with_user_data(payload->ptr(), payload->memory_size(),
+                                    SerializeDestroyCallback, payload),
+      ::grpc::Slice::STEAL_REF);
+  ::grpc::ByteBuffer tmp(&slices[0], 2);
+  msg->Swap(&tmp);
+}
+
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
                                const framework::Scope* scope,
@@ -40,7 +40,17 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            ::grpc::ByteBuffer* msg,
                            const std::string& out_varname = std::string(),
                            const int trainer_id = 0,
-                           const std::string& table_name = std::string());
+                           const std::string& table_name = std::string(),
+                           const uint64_t request_id = 0);
+
+// Serialize the dense FP32 LoDTensor vars into one message named name, see
+// GetBatchedTensorPayload.
+void SerializeBatchToByteBuffer(const std::string& name,
+                                const std::vector<std::string>& var_names,
+                                const std::vector<framework::Variable*>& vars,
+                                ::grpc::ByteBuffer* msg,
+                                const int trainer_id = 0,
+                                const uint64_t request_id = 0);
 
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
@@ -15,7 +15,9 @@ limitations under the License. */
 #include <unistd.h>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
+#include "gflags/gflags.h"
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -29,6 +31,9 @@ limitations under the License. */
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/string/printf.h"
 
+DECLARE_string(rpc_send_encoding);
+DECLARE_bool(rpc_compress_rows);
+
 namespace framework = paddle::framework;
 namespace platform = paddle::platform;
 namespace operators = paddle::operators;
@@ -222,3 +227,121 @@ TEST(SelectedRows, Run) {
   RunSerdeTestSelectedRows(gpu);
 #endif
 }
+
+TEST(SelectedRows, ReuseRecvBuffer) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+
+  framework::Variable var;
+  auto* slr = var.GetMutable<framework::SelectedRows>();
+  slr->set_height(1000);
+  auto* tensor = slr->mutable_value();
+  tensor->Resize(framework::make_ddim({100, 16}));
+  tensor->mutable_data<float>(place);
+  math::set_constant(ctx, tensor, 1.0);
+  for (int i = 0; i < 100; ++i) slr->mutable_rows()->push_back(i * 2);
+
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("reused_var", &var, ctx, &msg);
+  // the rows in flight are not affected by the modification of the var
+  (*slr->mutable_rows())[0] = -1;
+
+  framework::Scope scope;
+  const void* tensor_ptr = nullptr;
+  const void* rows_ptr = nullptr;
+  for (int step = 0; step < 3; ++step) {
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx, true);
+    EXPECT_EQ(resp.Parse(msg), 0);
+    auto& slr2 = resp.GetVar()->Get<framework::SelectedRows>();
+    EXPECT_EQ(slr2.rows().size(), 100UL);
+    EXPECT_EQ(slr2.rows()[0], 0);
+    EXPECT_EQ(slr2.rows()[99], 198);
+    EXPECT_FLOAT_EQ(slr2.value().data<float>()[0], 1.0);
+    if (step == 0) {
+      tensor_ptr = slr2.value().data<float>();
+      rows_ptr = slr2.rows().data();
+    } else {
+      // received into the buffers of the last step
+      EXPECT_EQ(slr2.value().data<float>(), tensor_ptr);
+      EXPECT_EQ(slr2.rows().data(), rows_ptr);
+    }
+  }
+}
+
+TEST(SelectedRows, Encoding) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+
+  framework::Variable var;
+  auto* slr = var.GetMutable<framework::SelectedRows>();
+  slr->set_height(100000);
+  auto* tensor = slr->mutable_value();
+  tensor->Resize(framework::make_ddim({300, 10}));
+  auto* data = tensor->mutable_data<float>(place);
+  for (int i = 0; i < 3000; ++i) data[i] = (i % 200 - 100) / 10.0f;
+  for (int i = 0; i < 300; ++i) slr->mutable_rows()->push_back(i * 300 % 997);
+
+  FLAGS_rpc_compress_rows = true;
+  for (auto& encoding : {"fp16", "encoded_var:int8,raw"}) {
+    FLAGS_rpc_send_encoding = encoding;
+    ::grpc::ByteBuffer msg;
+    operators::distributed::SerializeToByteBuffer("encoded_var", &var, ctx,
+                                                  &msg);
+    EXPECT_LT(msg.Length(), 3000 * sizeof(float));
+
+    framework::Scope scope;
+    scope.Var("encoded_var");
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(msg), 0);
+    auto& slr2 = resp.GetVar()->Get<framework::SelectedRows>();
+    EXPECT_EQ(slr2.height(), 100000);
+    ASSERT_EQ(slr2.rows().size(), 300UL);
+    for (int i = 0; i < 300; ++i) {
+      EXPECT_EQ(slr2.rows()[i], i * 300 % 997);
+    }
+    ASSERT_EQ(slr2.value().numel(), 3000);
+    const float* data2 = slr2.value().data<float>();
+    for (int i = 0; i < 3000; ++i) {
+      EXPECT_NEAR(data2[i], data[i], 0.05);
+    }
+  }
+  FLAGS_rpc_send_encoding = "";
+  FLAGS_rpc_compress_rows = false;
+}
+
+TEST(LodTensor, Batched) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+
+  std::vector<std::string> names = {"batched_a", "batched_b"};
+  std::vector<framework::DDim> dims = {framework::make_ddim({2, 3}),
+                                       framework::make_ddim({5})};
+  std::vector<framework::Variable> vars(names.size());
+  std::vector<framework::Variable*> var_ptrs;
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto* tensor = vars[i].GetMutable<framework::LoDTensor>();
+    tensor->Resize(dims[i]);
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t j = 0; j < tensor->numel(); ++j) data[j] = i * 10 + j;
+    var_ptrs.push_back(&vars[i]);
+  }
+
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeBatchToByteBuffer("batch", names, var_ptrs,
+                                                     &msg);
+
+  framework::Scope scope;
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx, true);
+  EXPECT_EQ(resp.Parse(msg), 0);
+  EXPECT_EQ(resp.BatchedVarnames(), names);
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto* var = resp.GetLocalScope().FindVar(names[i]);
+    ASSERT_NE(var, nullptr);
+    auto& tensor = var->Get<framework::LoDTensor>();
+    EXPECT_EQ(tensor.dims(), dims[i]);
+    const float* data = tensor.data<float>();
+    for (int64_t j = 0; j < tensor.numel(); ++j) {
+      EXPECT_FLOAT_EQ(data[j], i * 10 + j);
+    }
+  }
+}
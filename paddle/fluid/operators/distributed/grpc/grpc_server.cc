@@ -16,9 +16,11 @@ limitations under the License. */
 #include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/operators/distributed/grpc/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/grpc/grpc_server.h"
+#include "paddle/fluid/operators/distributed/rpc_trace.h"
 
 using ::grpc::ServerAsyncResponseWriter;
 
@@ -69,11 +71,44 @@ class RequestBase {
   void Finish(const T& reply, ServerAsyncResponseWriter<T>* responder) {
     std::lock_guard<std::mutex> l(status_mu_);
     status_ = FINISH;
+    if (FLAGS_rpc_trace && GetRequestId() != 0) EndTrace();
     responder->Finish(reply, ::grpc::Status::OK,
                       reinterpret_cast<void*>(static_cast<intptr_t>(req_id_)));
   }
   virtual std::string GetReqName() = 0;
 
+  void BeginProcess(const std::string& rpc_name) {
+    rpc_name_ = rpc_name;
+    process_begin_us_ = RPCTraceNowUs();
+  }
+  // The id of the request traced by the trainer, zero if not traced.
+  virtual uint64_t GetRequestId() { return 0; }
+  // The requests which are not parsed by GRPCVariableResponse are taken as
+  // parsed right before their processing.
+  virtual int64_t ParseBeginUs() { return process_begin_us_; }
+  virtual int64_t ParseEndUs() { return process_begin_us_; }
+
+ private:
+  // Send the phases back to the trainer in the trailing metadata, which must
+  // be added before the response.
+  void EndTrace() {
+    int64_t end_us = RPCTraceNowUs();
+    ServerRPCPhases server;
+    server.request_id = GetRequestId();
+    server.deserialize = ParseEndUs() - ParseBeginUs();
+    server.queue = process_begin_us_ - ParseEndUs();
+    server.handle = end_us - process_begin_us_;
+    ctx_.AddTrailingMetadata(kRPCTraceMetadataKey, server.Encode());
+
+    RPCPhases phases;
+    phases.deserialize = server.deserialize;
+    phases.queue = server.queue;
+    phases.handle = server.handle;
+    phases.total = end_us - ParseBeginUs();
+    RPCTraceStats::Instance().Record(rpc_name_, GetReqName(),
+                                     server.request_id, phases);
+  }
+
  protected:
   mutable std::mutex status_mu_;
   ::grpc::ServerContext ctx_;
@@ -82,6 +117,8 @@ class RequestBase {
   CallStatus status_;
   RequestHandler* request_handler_;
   int req_id_;
+  std::string rpc_name_;
+  int64_t process_begin_us_{0};
 };
 
 class RequestSend final : public RequestBase {
@@ -90,9 +127,12 @@ class RequestSend final : public RequestBase {
                        ::grpc::ServerCompletionQueue* cq,
                        RequestHandler* request_handler, int req_id)
       : RequestBase(service, cq, request_handler, req_id), responder_(&ctx_) {
+    // In sync mode, the vars are received into the server scope directly,
+    // unless some of them may be late.
     request_.reset(new GRPCVariableResponse(
         request_handler->scope(), request_handler->dev_ctx(),
-        request_handler->distributed_mode()));
+        request_handler->distributed_mode() ||
+            FLAGS_rpc_backup_trainer_num > 0));
     int method_id = static_cast<int>(distributed::GrpcMethod::kSendVariable);
     service_->RequestAsyncUnary(
         method_id, &ctx_, request_.get(), &responder_, cq_, cq_,
@@ -100,6 +140,9 @@ class RequestSend final : public RequestBase {
   }
   virtual ~RequestSend() {}
   std::string GetReqName() override { return request_->Varname(); }
+  uint64_t GetRequestId() override { return request_->GetRequestId(); }
+  int64_t ParseBeginUs() override { return request_->ParseBeginUs(); }
+  int64_t ParseEndUs() override { return request_->ParseEndUs(); }
 
   void Process() override {
     std::string varname = GetReqName();
@@ -109,7 +152,17 @@ class RequestSend final : public RequestBase {
     auto invar = request_->GetVar();
     int trainer_id = request_->GetTrainerId();
     framework::Variable* outvar = nullptr;
-    request_handler_->Handle(varname, scope, invar, &outvar, trainer_id);
+    auto batched_varnames = request_->BatchedVarnames();
+    if (batched_varnames.empty()) {
+      request_handler_->Handle(varname, scope, invar, &outvar, trainer_id);
+    } else {
+      // The batched vars are handled as if they were sent one by one.
+      auto* var_scope = scope != nullptr ? scope : request_handler_->scope();
+      for (auto& name : batched_varnames) {
+        request_handler_->Handle(name, scope, var_scope->FindVar(name),
+                                 &outvar, trainer_id);
+      }
+    }
     Finish(reply_, &responder_);
   }
 
@@ -134,6 +187,7 @@ class RequestGet final : public RequestBase {
   virtual ~RequestGet() {}
 
   std::string GetReqName() override { return request_.varname(); }
+  uint64_t GetRequestId() override { return request_.request_id(); }
 
   void Process() override {
     // proc request.
@@ -149,6 +203,19 @@ class RequestGet final : public RequestBase {
     framework::Variable* outvar = nullptr;
 
     tmp_scope_ = std::move(scope->NewTmpScope());
+    if (request_.batched_vars_size() > 0) {
+      std::vector<std::string> names;
+      std::vector<framework::Variable*> outvars;
+      for (auto& batched_var : request_.batched_vars()) {
+        names.push_back(batched_var.varname());
+        outvars.push_back(nullptr);
+        request_handler_->Handle(names.back(), tmp_scope_.get(), invar,
+                                 &outvars.back(), trainer_id, names.back());
+      }
+      SerializeBatchToByteBuffer(varname, names, outvars, &reply_);
+      Finish(reply_, &responder_);
+      return;
+    }
     request_handler_->Handle(varname, tmp_scope_.get(), invar, &outvar,
                              trainer_id, out_varname, table_name);
 
@@ -184,6 +251,7 @@ class RequestGetNoBarrier final : public RequestBase {
   virtual ~RequestGetNoBarrier() {}
 
   std::string GetReqName() override { return request_.varname(); }
+  uint64_t GetRequestId() override { return request_.request_id(); }
 
   void Process() override {
     // proc request.
@@ -325,6 +393,9 @@ class RequestPrefetch final : public RequestBase {
   virtual ~RequestPrefetch() {}
 
   std::string GetReqName() override { return request_->Varname(); }
+  uint64_t GetRequestId() override { return request_->GetRequestId(); }
+  int64_t ParseBeginUs() override { return request_->ParseBeginUs(); }
+  int64_t ParseEndUs() override { return request_->ParseEndUs(); }
 
   void Process() override {
     // prefetch process...
@@ -543,6 +614,9 @@ void AsyncGRPCServer::ShutDownImpl() {
   std::unique_lock<std::mutex> lock(cq_mutex_);
   is_shut_down_ = true;
   ShutdownQueue();
+  if (FLAGS_rpc_trace) {
+    LOG(INFO) << "\n" << RPCTraceStats::Instance().Report();
+  }
 
   VLOG(4) << "server_ shutdown!";
   server_->Shutdown();
@@ -633,6 +707,7 @@ void AsyncGRPCServer::HandleRequest(
 
     switch (base->Status()) {
       case PROCESS: {
+        base->BeginProcess(rpc_name);
         base->Process();
         break;
       }
@@ -20,6 +20,7 @@
 #endif
 
 #include "paddle/fluid/operators/distributed/grpc/grpc_variable_response.h"
+#include "paddle/fluid/operators/distributed/rpc_trace.h"
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -49,11 +50,14 @@ bool ReadVarintSizeAsInt(::google::protobuf::io::CodedInputStream* input,
 }
 
 int GRPCVariableResponse::Parse(const ::grpc::ByteBuffer& byte_buffer) {
+  parse_begin_us_ = RPCTraceNowUs();
   GrpcByteBufferSource source;
   source.Init(byte_buffer);
   GrpcByteBufferSourceWrapper r(&source);
 
-  return Parse(&r);
+  int ret = Parse(&r);
+  parse_end_us_ = RPCTraceNowUs();
+  return ret;
 }
 
 bool ParseLodData(::google::protobuf::io::CodedInputStream* input,
@@ -301,6 +305,14 @@ int GRPCVariableResponse::Parse(Source* source) {
         meta_.set_trainer_id(trainer_id);
         break;
       }
+      case sendrecv::VariableMessage::kRequestIdFieldNumber: {
+        uint64_t request_id = 0;
+        if (!input.ReadVarint64(&request_id)) {
+          return tag;
+        }
+        meta_.set_request_id(request_id);
+        break;
+      }
       case sendrecv::VariableMessage::kTableNameFieldNumber: {
         uint32_t length;
         if ((wt != WIRETYPE_LENGTH_DELIMITED) || !input.ReadVarint32(&length)) {
@@ -315,6 +327,37 @@ int GRPCVariableResponse::Parse(Source* source) {
         meta_.set_table_name(temp);
         break;
       }
+      case sendrecv::VariableMessage::kEncodingFieldNumber: {
+        uint32_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) {
+          return tag;
+        }
+        meta_.set_encoding(
+            static_cast<::sendrecv::VariableMessage_Encoding>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kRowsEncodingFieldNumber: {
+        uint32_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) {
+          return tag;
+        }
+        meta_.set_rows_encoding(
+            static_cast<::sendrecv::VariableMessage_RowsEncoding>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kBatchedVarsFieldNumber: {
+        uint32_t length;
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) || !input.ReadVarint32(&length)) {
+          return tag;
+        }
+
+        std::string temp;
+        if (!input.ReadString(&temp, length) ||
+            !meta_.add_batched_vars()->ParseFromString(temp)) {
+          return tag;
+        }
+        break;
+      }
       default: {
         // Unknown tag, return unknown error.
         return -1;
@@ -14,10 +14,12 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
@@ -82,26 +84,46 @@ static void SplitIdsIntoMultipleVarsBySection(
 
 typedef std::vector<std::pair<std::string, std::string>> TableAndEndpoints;
 
-void prefetch_core(
-    const std::vector<int64_t>& ids, const TableAndEndpoints& tables,
-    const std::vector<int64_t>& height_sections,
-    const framework::ExecutionContext& context, const framework::Scope& scope,
-    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+// The prefetch RPCs in flight, and everything needed to write the received
+// embeddings into the out vars.
+struct PendingPrefetch {
+  std::unique_ptr<framework::Scope> local_scope;
+  std::vector<std::string> out_var_names;
+  std::vector<int64_t> height_sections;
+  std::vector<std::vector<int64_t>> splited_ids;
+  std::vector<distributed::VarHandlePtr> rets;
+
+  std::vector<std::vector<int64_t>> ids_group;
+  std::vector<framework::LoD> ids_lods;
+  std::vector<std::string> target_var_names;
+  int64_t vec_dim_1{0};
+  int64_t padding_idx{distributed::kNoPadding};
+  platform::Place place;
+};
+
+static void prefetch_send(const std::vector<int64_t>& ids,
+                          const TableAndEndpoints& tables,
+                          const std::vector<int64_t>& height_sections,
+                          const framework::ExecutionContext& context,
+                          const framework::Scope& scope,
+                          PendingPrefetch* pending) {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto& actual_ctx = *pool.Get(context.GetPlace());
 
-  std::unique_ptr<framework::Scope> local_scope = scope.NewTmpScope();
+  pending->local_scope = scope.NewTmpScope();
+  auto* local_scope = pending->local_scope.get();
 
   std::vector<std::string> in_var_names;
-  std::vector<std::string> out_var_names;
+  auto& out_var_names = pending->out_var_names;
   for (size_t i = 0; i < tables.size(); ++i) {
     in_var_names.push_back("prefetch_send@" + tables[i].second);
     out_var_names.push_back("prefetch_recv@" + tables[i].second);
   }
 
-  auto splited_ids = SplitIds(ids, height_sections);
-  SplitIdsIntoMultipleVarsBySection(in_var_names, height_sections, splited_ids,
-                                    local_scope.get());
+  pending->height_sections = height_sections;
+  pending->splited_ids = SplitIds(ids, height_sections);
+  SplitIdsIntoMultipleVarsBySection(in_var_names, height_sections,
+                                    pending->splited_ids, local_scope);
 
   // create output var in local scope
   for (auto& name : out_var_names) {
@@ -112,23 +134,30 @@ void prefetch_core(
       distributed::RPCClient::GetInstance<RPCCLIENT_T>(
           context.Attr<int>("trainer_id"));
 
-  std::vector<distributed::VarHandlePtr> rets;
   for (size_t i = 0; i < in_var_names.size(); i++) {
-    if (NeedSend(*local_scope.get(), in_var_names[i])) {
+    if (NeedSend(*local_scope, in_var_names[i])) {
       VLOG(3) << "sending " << in_var_names[i] << " to " << tables[i].second
               << " to get " << out_var_names[i] << " back";
-      rets.push_back(rpc_client->AsyncPrefetchVar(
-          tables[i].second, actual_ctx, *local_scope.get(), in_var_names[i],
+      pending->rets.push_back(rpc_client->AsyncPrefetchVar(
+          tables[i].second, actual_ctx, *local_scope, in_var_names[i],
           out_var_names[i], tables[i].first));
     } else {
       VLOG(3) << "don't send no-initialied variable: " << out_var_names[i];
     }
   }
+}
 
+static void prefetch_recv(
+    PendingPrefetch* pending,
+    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+  auto& rets = pending->rets;
   for (size_t i = 0; i < rets.size(); i++) {
     PADDLE_ENFORCE(rets[i]->Wait(), "internal error in RPCClient");
   }
 
+  auto& out_var_names = pending->out_var_names;
+  auto& height_sections = pending->height_sections;
+  auto& splited_ids = pending->splited_ids;
   PADDLE_ENFORCE_EQ(out_var_names.size(), height_sections.size(), "");
 
   auto abs_sections = ToAbsoluteSection(height_sections);
@@ -136,8 +165,9 @@ void prefetch_core(
        ++section_idx) {
     auto& ids_in_this_section = splited_ids[section_idx];
     if (!ids_in_this_section.empty()) {
-      auto& prefetch_out_var = local_scope->Var(out_var_names[section_idx])
-                                   ->Get<framework::LoDTensor>();
+      auto& prefetch_out_var =
+          pending->local_scope->Var(out_var_names[section_idx])
+              ->Get<framework::LoDTensor>();
       const auto* out_var_data = prefetch_out_var.data<float>();
       auto& dims = prefetch_out_var.dims();
 
@@ -159,6 +189,16 @@ void prefetch_core(
   }
 }
 
+void prefetch_core(
+    const std::vector<int64_t>& ids, const TableAndEndpoints& tables,
+    const std::vector<int64_t>& height_sections,
+    const framework::ExecutionContext& context, const framework::Scope& scope,
+    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+  PendingPrefetch pending;
+  prefetch_send(ids, tables, height_sections, context, scope, &pending);
+  prefetch_recv(&pending, recved_vec_map);
+}
+
 void prefetch(const std::string& id_name, const std::string& out_name,
               const std::string& persistable_var_name, const bool backfill,
               const std::vector<std::string>& table_names,
@@ -170,42 +210,86 @@ void prefetch(const std::string& id_name, const std::string& out_name,
             endpoints, height_sections, context, scope);
 }
 
-void prefetchs(const std::vector<std::string>& id_var_names,
-               const std::vector<std::string>& out_var_names,
-               const std::string& persistable_var_name, const bool backfill,
-               const std::vector<std::string>& table_names,
-               const std::vector<std::string>& endpoints,
-               const std::vector<int64_t>& height_sections,
-               const framework::ExecutionContext& context,
-               const framework::Scope& scope) {
+// The prefetches issued by AsyncPrefetchs, by the variable of the first out
+// var, which is unique for the scope and the lookup.
+class PendingPrefetchs {
+ public:
+  static PendingPrefetchs& Instance() {
+    static PendingPrefetchs instance;
+    return instance;
+  }
+
+  void Put(const framework::Variable* key,
+           std::unique_ptr<PendingPrefetch> pending) {
+    std::unique_ptr<PendingPrefetch> stale;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto& slot = pending_[key];
+      stale = std::move(slot);
+      slot = std::move(pending);
+    }
+    if (stale != nullptr) {
+      // the RPCs still refer to the local scope, wait them before it is
+      // released.
+      LOG(WARNING) << "the last prefetch of " << stale->target_var_names[0]
+                   << " is not waited";
+      for (auto& ret : stale->rets) {
+        ret->Wait();
+      }
+    }
+  }
+
+  std::unique_ptr<PendingPrefetch> Take(const framework::Variable* key) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = pending_.find(key);
+    if (it == pending_.end()) return nullptr;
+    auto pending = std::move(it->second);
+    pending_.erase(it);
+    return pending;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::unordered_map<const framework::Variable*,
+                     std::unique_ptr<PendingPrefetch>>
+      pending_;
+};
+
+static std::unique_ptr<PendingPrefetch> StartPrefetchs(
+    const std::vector<std::string>& id_var_names,
+    const std::vector<std::string>& out_var_names,
+    const std::string& persistable_var_name,
+    const std::vector<std::string>& table_names,
+    const std::vector<std::string>& endpoints,
+    const std::vector<int64_t>& height_sections,
+    const framework::ExecutionContext& context,
+    const framework::Scope& scope) {
   PADDLE_ENFORCE_GT(id_var_names.size(), 0, "");
   PADDLE_ENFORCE_EQ(id_var_names.size(), out_var_names.size(), "");
   PADDLE_ENFORCE_EQ(table_names.size(), endpoints.size(), "");
   PADDLE_ENFORCE_EQ(table_names.size(), height_sections.size(), "");
 
-  auto vec_dim_1 = 0;
+  std::unique_ptr<PendingPrefetch> pending(new PendingPrefetch);
   framework::Variable* var = scope.FindVar(persistable_var_name);
 
   PADDLE_ENFORCE_EQ(var->IsType<framework::LoDTensor>(), true,
                     platform::errors::InvalidArgument(
                         "prefetch can only support LodTensor only"));
 
-  vec_dim_1 = var->Get<framework::LoDTensor>().dims()[1];
+  pending->vec_dim_1 = var->Get<framework::LoDTensor>().dims()[1];
 
-  PADDLE_ENFORCE_GT(vec_dim_1, 0,
+  PADDLE_ENFORCE_GT(pending->vec_dim_1, 0,
                     platform::errors::InvalidArgument(
                         "lookup table var's dim must gather than 0"));
 
-  const auto place =
+  pending->place =
       scope.FindVar(id_var_names[0])->Get<framework::LoDTensor>().place();
 
-  if (!platform::is_cpu_place(place)) {
+  if (!platform::is_cpu_place(pending->place)) {
     PADDLE_THROW("multi prefetch only support CPU currently");
   }
 
-  std::vector<std::vector<int64_t>> ids_group;
   std::vector<int64_t> ids_union;
-  std::vector<framework::LoD> ids_lods;
   TableAndEndpoints tables;
 
   for (auto& id_name : id_var_names) {
@@ -217,8 +301,8 @@ void prefetchs(const std::vector<std::string>& id_var_names,
       ids.push_back(id_data[i]);
       ids_union.push_back(id_data[i]);
     }
-    ids_group.push_back(ids);
-    ids_lods.push_back(id_tensor.lod());
+    pending->ids_group.push_back(ids);
+    pending->ids_lods.push_back(id_tensor.lod());
   }
 
   std::unordered_set<int64_t> s(ids_union.begin(), ids_union.end());
@@ -228,26 +312,35 @@ void prefetchs(const std::vector<std::string>& id_var_names,
     tables.push_back(std::make_pair(table_names[i], endpoints[i]));
   }
 
-  std::unordered_map<int64_t, std::vector<float>> recved_vec_map;
-  prefetch_core(ids_union, tables, height_sections, context, scope,
-                &recved_vec_map);
-
-  auto padding_idx = distributed::kNoPadding;
-
   if (context.HasAttr("padding_idx")) {
-    padding_idx = context.Attr<int64_t>("padding_idx");
+    pending->padding_idx = context.Attr<int64_t>("padding_idx");
   }
+  pending->target_var_names = out_var_names;
+
+  prefetch_send(ids_union, tables, height_sections, context, scope,
+                pending.get());
+  return pending;
+}
+
+static void FinishPrefetchs(PendingPrefetch* pending,
+                            const framework::Scope& scope) {
+  std::unordered_map<int64_t, std::vector<float>> recved_vec_map;
+  prefetch_recv(pending, &recved_vec_map);
+
+  auto vec_dim_1 = pending->vec_dim_1;
+  auto padding_idx = pending->padding_idx;
+  auto& out_var_names = pending->target_var_names;
 
   // copy vectors to out vars
   for (size_t i = 0; i < out_var_names.size(); i++) {
-    auto& ids = ids_group[i];
+    auto& ids = pending->ids_group[i];
     auto* out_t =
         scope.FindVar(out_var_names[i])->GetMutable<framework::LoDTensor>();
     out_t->Resize(
         framework::make_ddim({static_cast<int64_t>(ids.size()), vec_dim_1}));
-    out_t->set_lod(ids_lods[i]);
+    out_t->set_lod(pending->ids_lods[i]);
 
-    auto* out_d = out_t->mutable_data<float>(place);
+    auto* out_d = out_t->mutable_data<float>(pending->place);
 
     for (size_t idx = 0; idx < ids.size(); idx++) {
       const auto& id = ids[idx];
@@ -262,6 +355,50 @@ void prefetchs(const std::vector<std::string>& id_var_names,
   }
 }
 
+void prefetchs(const std::vector<std::string>& id_var_names,
+               const std::vector<std::string>& out_var_names,
+               const std::string& persistable_var_name, const bool backfill,
+               const std::vector<std::string>& table_names,
+               const std::vector<std::string>& endpoints,
+               const std::vector<int64_t>& height_sections,
+               const framework::ExecutionContext& context,
+               const framework::Scope& scope) {
+  auto pending =
+      StartPrefetchs(id_var_names, out_var_names, persistable_var_name,
+                     table_names, endpoints, height_sections, context, scope);
+  FinishPrefetchs(pending.get(), scope);
+}
+
+void AsyncPrefetchs(const std::vector<std::string>& id_var_names,
+                    const std::vector<std::string>& out_var_names,
+                    const std::string& persistable_var_name,
+                    const std::vector<std::string>& table_names,
+                    const std::vector<std::string>& endpoints,
+                    const std::vector<int64_t>& height_sections,
+                    const framework::ExecutionContext& context,
+                    const framework::Scope& scope) {
+  auto pending =
+      StartPrefetchs(id_var_names, out_var_names, persistable_var_name,
+                     table_names, endpoints, height_sections, context, scope);
+  auto* key = scope.FindVar(out_var_names[0]);
+  PendingPrefetchs::Instance().Put(key, std::move(pending));
+}
+
+void WaitPrefetchs(const std::vector<std::string>& out_var_names,
+                   const framework::Scope& scope) {
+  PADDLE_ENFORCE_GT(out_var_names.size(), 0,
+                    platform::errors::InvalidArgument(
+                        "The out vars of the prefetch to wait are empty."));
+  auto* key = scope.FindVar(out_var_names[0]);
+  auto pending = PendingPrefetchs::Instance().Take(key);
+  PADDLE_ENFORCE_NOT_NULL(
+      pending, platform::errors::PreconditionNotMet(
+                   "No prefetch of %s is issued, the async "
+                   "distributed_lookup_table must run before waiting it.",
+                   out_var_names[0]));
+  FinishPrefetchs(pending.get(), scope);
+}
+
 };  // namespace distributed
 };  // namespace operators
 };  // namespace paddle
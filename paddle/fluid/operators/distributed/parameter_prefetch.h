@@ -35,6 +35,23 @@ void prefetchs(const std::vector<std::string>& id_var_names,
                const framework::ExecutionContext& context,
                const framework::Scope& scope);
 
+// Issue the prefetch RPCs like prefetchs, but return without waiting them.
+// The embeddings are written into the out vars by WaitPrefetchs, so that the
+// ops between the two calls run while the RPCs are in flight.
+void AsyncPrefetchs(const std::vector<std::string>& id_var_names,
+                    const std::vector<std::string>& out_var_names,
+                    const std::string& persistable_var_name,
+                    const std::vector<std::string>& table_names,
+                    const std::vector<std::string>& endpoints,
+                    const std::vector<int64_t>& height_sections,
+                    const framework::ExecutionContext& context,
+                    const framework::Scope& scope);
+
+// Wait the prefetch issued by AsyncPrefetchs with the same out vars in the
+// same scope, and write the embeddings into the out vars.
+void WaitPrefetchs(const std::vector<std::string>& out_var_names,
+                   const framework::Scope& scope);
+
 void prefetch(const std::string& id_name, const std::string& out_name,
               const std::string& persistable_var_name, const bool backfill,
               const std::vector<std::string>& table_names,
@@ -37,6 +37,28 @@ namespace distributed {
 // define LOOKUP_TABLE_PATH for checkpoint notify to save lookup table variables
 // to directory specified.
 constexpr char LOOKUP_TABLE_PATH[] = "kLookupTablePath";
+constexpr char LOOKUP_TABLE_SAVE_MODE[] = "kLookupTableSaveMode";
+
+// Let dst share the data of the received src without a copy.
+static void ShareReceivedVar(const framework::Variable& src,
+                             framework::Variable* dst) {
+  if (src.IsType<framework::LoDTensor>()) {
+    auto& tensor = src.Get<framework::LoDTensor>();
+    auto* out = dst->GetMutable<framework::LoDTensor>();
+    out->ShareDataWith(tensor);
+    out->set_lod(tensor.lod());
+  } else if (src.IsType<framework::SelectedRows>()) {
+    auto& slr = src.Get<framework::SelectedRows>();
+    auto* out = dst->GetMutable<framework::SelectedRows>();
+    out->set_height(slr.height());
+    out->set_rows(slr.rows());
+    out->mutable_value()->ShareDataWith(slr.value());
+  } else {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The received var of type %s is not supported.",
+        framework::ToTypeName(src.Type())));
+  }
+}
 
 bool RequestSendHandler::Handle(const std::string& varname,
                                 framework::Scope* scope,
@@ -50,7 +72,7 @@ bool RequestSendHandler::Handle(const std::string& varname,
   // Sync
   if (varname == BATCH_BARRIER_MESSAGE) {
     VLOG(3) << "sync: recv BATCH_BARRIER_MESSAGE";
-    rpc_server_->IncreaseBatchBarrier(kRequestSend);
+    rpc_server_->IncreaseBatchBarrier(kRequestSend, trainer_id);
   } else if (varname == COMPLETE_MESSAGE) {
     VLOG(3) << "sync: recv complete message";
 
@@ -58,7 +80,7 @@ bool RequestSendHandler::Handle(const std::string& varname,
       HeartBeatMonitor::GetInstance()->Update(trainer_id, "", COMPLETED);
     }
 
-    rpc_server_->Complete();
+    rpc_server_->Complete(trainer_id);
   } else {
     // Async
     if (distributed_mode_ != DistributedMode::kSync) {
@@ -96,9 +118,23 @@ bool RequestSendHandler::Handle(const std::string& varname,
     } else {  // sync
       rpc_server_->WaitCond(kRequestSend);
       VLOG(3) << "sync: processing received var: " << varname;
+      if (rpc_server_->IsLateTrainer(kRequestSend, trainer_id)) {
+        VLOG(3) << "sync: drop the late var " << varname << " of trainer "
+                << trainer_id;
+        return true;
+      }
       PADDLE_ENFORCE_NOT_NULL(
           invar, platform::errors::NotFound(
                      "sync: Can not find server side var %s.", varname));
+      if (scope != nullptr) {
+        // With the backup trainers, the var is received into the scope of
+        // the request, so that the late vars never touch the server vars.
+        auto* server_var = scope_->FindVar(varname);
+        PADDLE_ENFORCE_NOT_NULL(
+            server_var, platform::errors::NotFound(
+                            "sync: Can not find server side var %s.", varname));
+        ShareReceivedVar(*invar, server_var);
+      }
     }
   }
   return true;
@@ -118,7 +154,7 @@ bool RequestGetHandler::Handle(const std::string& varname,
   if (distributed_mode_ == DistributedMode::kSync) {
     if (varname == FETCH_BARRIER_MESSAGE) {
       VLOG(3) << "sync: recv fetch barrier message";
-      rpc_server_->IncreaseBatchBarrier(kRequestGet);
+      rpc_server_->IncreaseBatchBarrier(kRequestGet, trainer_id);
     } else {
       rpc_server_->WaitCond(kRequestGet);
       *outvar = scope_->FindVar(varname);
@@ -253,6 +289,9 @@ bool RequestCheckpointHandler::Handle(const std::string& varname,
   lt_var->append(out_var_name);
   VLOG(4) << "RequestCheckpointHandler update var kLookupTablePath to: "
           << out_var_name;
+  // the save op of the checkpoint block saves the table in this mode
+  *scope_->Var(LOOKUP_TABLE_SAVE_MODE)->GetMutable<int>() =
+      varname == CHECKPOINT_SAVE_DELTA_MESSAGE ? 1 : 0;
   executor_->RunPreparedContext(checkpoint_prepared_ctx_.get(), scope_);
   return true;
 }
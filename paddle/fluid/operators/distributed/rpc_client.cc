@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/distributed/rpc_client.h"
+#include <string>
+#include <vector>
 #include "gflags/gflags.h"
 
 // default to 3min to avoid temprary network failures.
@@ -27,6 +29,29 @@ std::once_flag RPCClient::init_flag_;
 std::unique_ptr<RPCClient> RPCClient::rpc_client_(nullptr);
 int RPCClient::trainer_id_ = 0;
 
+std::vector<VarHandlePtr> RPCClient::AsyncSendVars(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::vector<std::string>& var_names,
+    int64_t time_out) {
+  std::vector<VarHandlePtr> rets;
+  for (auto& var_name : var_names) {
+    rets.push_back(AsyncSendVar(ep, ctx, scope, var_name, time_out));
+  }
+  return rets;
+}
+
+std::vector<VarHandlePtr> RPCClient::AsyncGetVars(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::vector<std::string>& var_names,
+    int64_t time_out) {
+  std::vector<VarHandlePtr> rets;
+  for (auto& var_name : var_names) {
+    rets.push_back(
+        AsyncGetVar(ep, ctx, scope, var_name, var_name, "", time_out));
+  }
+  return rets;
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -17,6 +17,7 @@
 #include <condition_variable>  // NOLINT
 #include <memory>
 #include <string>
+#include <vector>
 #include "gflags/gflags.h"
 
 #include "paddle/fluid/framework/data_type.h"
@@ -49,6 +50,21 @@ class RPCClient {
                                    const std::string& table_name = "",
                                    int64_t time_out = FLAGS_rpc_deadline) = 0;
 
+  // Send the dense FP32 LoDTensors var_names of scope to ep in one request.
+  // The default implementation sends them one by one.
+  virtual std::vector<VarHandlePtr> AsyncSendVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline);
+
+  // Get the dense FP32 LoDTensors var_names from ep in one request, into the
+  // variables of the same names in scope, which must exist. The default
+  // implementation gets them one by one.
+  virtual std::vector<VarHandlePtr> AsyncGetVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline);
+
   virtual VarHandlePtr AsyncGetVarNoBarrier(
       const std::string& ep, const platform::DeviceContext& ctx,
       const framework::Scope& scope, const std::string& var_name,
@@ -76,8 +92,10 @@ class RPCClient {
       const std::string& ep, const std::string& var_name,
       int64_t time_out = FLAGS_rpc_deadline) = 0;
 
+  // Notify the pserver to save the lookup table to dir, in full if mode is
+  // 0, or the rows updated since the last save if mode is 1.
   virtual VarHandlePtr AsyncCheckpointNotify(
-      const std::string& ep, const std::string& dir,
+      const std::string& ep, const std::string& dir, int mode = 0,
       int64_t time_out = FLAGS_rpc_deadline) = 0;
 
   virtual VarHandlePtr AsyncDistributeNotify(
@@ -14,12 +14,20 @@
 
 #include "paddle/fluid/operators/distributed/rpc_server.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <string>
 #include "paddle/fluid/platform/profiler.h"
 
+DEFINE_int32(rpc_backup_trainer_num, 0,
+             "The number of the backup trainers in sync mode, i.e., a barrier "
+             "of the pserver completes once all the trainers but this number "
+             "of them have reached it, so that the slowest trainers do not "
+             "stall the job. The gradients of the trainers which missed the "
+             "barrier are dropped. 0 means waiting for all the trainers.");
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -46,35 +54,77 @@ void RPCServer::WaitBarrier(const std::string& rpc_name) {
   VLOG(3) << "WaitBarrier in: " << rpc_name;
   std::unique_lock<std::mutex> lock(this->mutex_);
   barrier_cond_.wait(lock, [this, &rpc_name] {
-    return ((barrier_counter_[rpc_name] == client_num_ && client_num_ != 0) ||
+    return ((barrier_counter_[rpc_name] >= BarrierNum() && client_num_ != 0) ||
             exit_flag_.load());
   });
 
+  if (FLAGS_rpc_backup_trainer_num > 0) {
+    // Hold the requests of the trainers which missed the barrier until they
+    // are dropped in the next round.
+    cur_cond_ = -1;
+    auto& reached = barrier_trainers_[rpc_name];
+    auto& late = late_trainers_[rpc_name];
+    for (int i = 0; i < trainer_num_; ++i) {
+      if (reached.count(i) == 0 && completed_trainers_.count(i) == 0) {
+        late.insert(i);
+      }
+    }
+    reached.clear();
+    if (!late.empty()) {
+      VLOG(2) << late.size() << " trainers missed the barrier " << rpc_name;
+    }
+  }
+
   VLOG(3) << "WaitBarrier out: " << rpc_name
           << " counter: " << barrier_counter_[rpc_name];
 }
 
-void RPCServer::IncreaseBatchBarrier(const std::string rpc_name) {
+void RPCServer::IncreaseBatchBarrier(const std::string rpc_name,
+                                     int trainer_id) {
   VLOG(3) << "RPCServer begin IncreaseBatchBarrier " << rpc_name;
   // barrier msg should make sure that it's in the right cond(send|recv)
   WaitCond(rpc_name);
   int b = 0;
   std::unique_lock<std::mutex> lock(mutex_);
+  if (FLAGS_rpc_backup_trainer_num > 0) {
+    // the barrier of the last round
+    if (late_trainers_[rpc_name].erase(trainer_id) > 0) {
+      VLOG(3) << "drop the late barrier " << rpc_name << " of trainer "
+              << trainer_id;
+      return;
+    }
+    barrier_trainers_[rpc_name].insert(trainer_id);
+  }
   b = ++barrier_counter_[rpc_name];
   VLOG(3) << rpc_name << " barrier_counter: " << b;
-  if (b >= client_num_) {
+  if (b >= BarrierNum()) {
     lock.unlock();
-    VLOG(3) << "BatchBarrier counter reach " << client_num_ << " for "
+    VLOG(3) << "BatchBarrier counter reach " << BarrierNum() << " for "
             << rpc_name;
     barrier_cond_.notify_all();
     lock.lock();
   }
 }
 
-void RPCServer::Complete() {
+bool RPCServer::IsLateTrainer(const std::string& rpc_name, int trainer_id) {
+  if (FLAGS_rpc_backup_trainer_num <= 0) return false;
+  std::unique_lock<std::mutex> lock(mutex_);
+  return late_trainers_[rpc_name].count(trainer_id) > 0;
+}
+
+int RPCServer::BarrierNum() const {
+  if (FLAGS_rpc_backup_trainer_num <= 0) return client_num_;
+  return std::max(client_num_ - FLAGS_rpc_backup_trainer_num, 1);
+}
+
+void RPCServer::Complete(int trainer_id) {
   {
     std::unique_lock<std::mutex> lock(mutex_);
     client_num_--;
+    completed_trainers_.insert(trainer_id);
+    for (auto& late : late_trainers_) {
+      late.second.erase(trainer_id);
+    }
     need_reset_all_vars_ = true;
 
     VLOG(3) << "decrease client_num to: " << client_num_;
@@ -87,7 +137,9 @@ void RPCServer::Complete() {
 
 bool RPCServer::NeedResetAllVars() {
   std::unique_lock<std::mutex> lock(mutex_);
-  return need_reset_all_vars_;
+  // The received vars of the trainers which missed the barrier should not be
+  // applied again in the next round.
+  return need_reset_all_vars_ || FLAGS_rpc_backup_trainer_num > 0;
 }
 
 int RPCServer::GetClientNum() {
@@ -18,13 +18,18 @@
 #include <set>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
 #include "paddle/fluid/platform/device_context.h"
 
+DECLARE_int32(rpc_backup_trainer_num);
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -53,6 +58,7 @@ class RPCServer {
         exit_flag_(false),
         selected_port_(0),
         client_num_(client_num),
+        trainer_num_(client_num),
         need_reset_all_vars_(false) {}
 
   virtual ~RPCServer() {}
@@ -87,7 +93,14 @@ class RPCServer {
 
   void SetCond(const std::string& rpc_name);
   void WaitCond(const std::string& rpc_name);
-  void IncreaseBatchBarrier(const std::string rpc_name);
+  // trainer_id is used to find the trainers which missed the barrier if
+  // FLAGS_rpc_backup_trainer_num > 0.
+  void IncreaseBatchBarrier(const std::string rpc_name, int trainer_id = -1);
+
+  // Whether trainer_id missed the last barrier of rpc_name, the requests of
+  // it before it reaches the barrier belong to the last round, and are
+  // dropped.
+  bool IsLateTrainer(const std::string& rpc_name, int trainer_id);
 
   void RegisterVar(const std::string& var_name, const std::string& rpc_name,
                    framework::Scope* scope, platform::DeviceContext* dev_ctx);
@@ -99,7 +112,7 @@ class RPCServer {
   void ClearVar(const std::string& var_name);
   MonomerHandle GetMonomer(const std::string& var_name);
 
-  void Complete();
+  void Complete(int trainer_id = -1);
 
   void ResetBarrierCounter();
 
@@ -110,8 +123,17 @@ class RPCServer {
 
  private:
   std::mutex mutex_;
+  // The number of the trainers a barrier waits for.
+  int BarrierNum() const;
+
   std::unordered_map<std::string, int> barrier_counter_;
   std::condition_variable barrier_cond_;
+  // Only used if FLAGS_rpc_backup_trainer_num > 0. The trainers which have
+  // reached the current barrier, and the trainers which missed the last one,
+  // of each rpc, and the trainers which are completed.
+  std::unordered_map<std::string, std::unordered_set<int>> barrier_trainers_;
+  std::unordered_map<std::string, std::unordered_set<int>> late_trainers_;
+  std::unordered_set<int> completed_trainers_;
 
   std::unordered_map<std::string, int> rpc_cond_map_;
   std::atomic<int> cur_cond_;
@@ -122,6 +144,8 @@ class RPCServer {
   std::atomic<int> exit_flag_;
   int selected_port_;
   int client_num_;
+  // The number of the trainers at the beginning.
+  int trainer_num_;
   bool need_reset_all_vars_;
 
   std::unordered_map<std::string, RequestHandler*> rpc_call_map_;
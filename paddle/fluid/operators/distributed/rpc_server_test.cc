@@ -194,3 +194,41 @@ TEST(COMPLETE, CPU) {
   g_rpc_service.reset(nullptr);
   g_req_handler.reset(nullptr);
 }
+
+// Only the barriers of the server are tested.
+class BarrierTestServer : public distributed::RPCServer {
+ public:
+  explicit BarrierTestServer(int client_num)
+      : distributed::RPCServer("127.0.0.1:0", client_num) {}
+  void StartServer() override {}
+  void WaitServerReady() override {}
+
+ protected:
+  void ShutDownImpl() override {}
+};
+
+TEST(BACKUP_TRAINERS, CPU) {
+  FLAGS_rpc_backup_trainer_num = 1;
+  BarrierTestServer server(3);
+  server.RegisterRPC(distributed::kRequestSend, nullptr);
+
+  server.SetCond(distributed::kRequestSend);
+  server.IncreaseBatchBarrier(distributed::kRequestSend, 0);
+  server.IncreaseBatchBarrier(distributed::kRequestSend, 2);
+  // completes without trainer 1
+  server.WaitBarrier(distributed::kRequestSend);
+  EXPECT_TRUE(server.IsLateTrainer(distributed::kRequestSend, 1));
+  EXPECT_FALSE(server.IsLateTrainer(distributed::kRequestSend, 0));
+  server.ResetBarrierCounter();
+  EXPECT_TRUE(server.NeedResetAllVars());
+
+  server.SetCond(distributed::kRequestSend);
+  // the late barrier of the last round is not counted
+  server.IncreaseBatchBarrier(distributed::kRequestSend, 1);
+  EXPECT_FALSE(server.IsLateTrainer(distributed::kRequestSend, 1));
+  server.IncreaseBatchBarrier(distributed::kRequestSend, 0);
+  server.IncreaseBatchBarrier(distributed::kRequestSend, 1);
+  server.WaitBarrier(distributed::kRequestSend);
+  EXPECT_TRUE(server.IsLateTrainer(distributed::kRequestSend, 2));
+  FLAGS_rpc_backup_trainer_num = 0;
+}
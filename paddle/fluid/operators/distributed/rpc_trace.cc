@@ -0,0 +1,150 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/rpc_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <sstream>
+
+#include "glog/logging.h"
+
+DEFINE_bool(rpc_trace, false,
+            "Trace the phases of the rpc requests on the trainers and the "
+            "pservers, and aggregate the latency of each variable.");
+DEFINE_int32(rpc_trace_slow_ms, 100,
+             "Log the phases of the traced rpc requests slower than this.");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+int64_t RPCTraceNowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t NewRPCRequestId(int trainer_id) {
+  static std::atomic<uint64_t> counter{0};
+  return (static_cast<uint64_t>(trainer_id) << 48) |
+         (++counter & ((1ULL << 48) - 1));
+}
+
+std::string ServerRPCPhases::Encode() const {
+  std::stringstream ss;
+  ss << request_id << "," << deserialize << "," << queue << "," << handle;
+  return ss.str();
+}
+
+bool ServerRPCPhases::Decode(const std::string& str,
+                             ServerRPCPhases* phases) {
+  std::stringstream ss(str);
+  char c1, c2, c3;
+  ss >> phases->request_id >> c1 >> phases->deserialize >> c2 >>
+      phases->queue >> c3 >> phases->handle;
+  return !ss.fail() && c1 == ',' && c2 == ',' && c3 == ',';
+}
+
+RPCPhases RPCTrace::Phases(int64_t end_us,
+                           const ServerRPCPhases& server) const {
+  RPCPhases phases;
+  phases.total = end_us - start_us;
+  phases.serialize = serialized_us - start_us;
+  phases.queue = server.queue;
+  phases.handle = server.handle;
+  phases.deserialize = server.deserialize + (end_us - responded_us);
+  phases.network = std::max<int64_t>(
+      0, responded_us - serialized_us - server.deserialize - server.queue -
+             server.handle);
+  return phases;
+}
+
+RPCTraceStats& RPCTraceStats::Instance() {
+  static RPCTraceStats stats;
+  return stats;
+}
+
+void RPCTraceStats::Record(const std::string& method,
+                           const std::string& varname, uint64_t request_id,
+                           const RPCPhases& phases) {
+  if (phases.total >= FLAGS_rpc_trace_slow_ms * 1000LL) {
+    LOG(WARNING) << "Slow rpc " << method << " of " << varname
+                 << ", request id " << request_id << ": total "
+                 << phases.total << "us, serialize " << phases.serialize
+                 << "us, network " << phases.network << "us, queue "
+                 << phases.queue << "us, deserialize " << phases.deserialize
+                 << "us, handle " << phases.handle << "us.";
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& stat = stats_[std::make_pair(method, varname)];
+  stat.method = method;
+  stat.varname = varname;
+  ++stat.calls;
+  stat.sum.serialize += phases.serialize;
+  stat.sum.network += phases.network;
+  stat.sum.queue += phases.queue;
+  stat.sum.deserialize += phases.deserialize;
+  stat.sum.handle += phases.handle;
+  stat.sum.total += phases.total;
+  stat.max_total = std::max(stat.max_total, phases.total);
+}
+
+std::vector<RPCVarStat> RPCTraceStats::Stats() const {
+  std::vector<RPCVarStat> stats;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& pair : stats_) stats.push_back(pair.second);
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const RPCVarStat& a, const RPCVarStat& b) {
+              return a.sum.total > b.sum.total;
+            });
+  return stats;
+}
+
+std::string RPCTraceStats::Report() const {
+  std::stringstream ss;
+  ss << "------------------------->     RPC Trace Report     "
+        "<-------------------------\n"
+     << "The mean time of each phase in ms.\n\n";
+  ss << std::left << std::setw(20) << "Method" << std::setw(40) << "Var"
+     << std::setw(10) << "Calls" << std::setw(12) << "Serialize"
+     << std::setw(12) << "Network" << std::setw(12) << "Queue"
+     << std::setw(14) << "Deserialize" << std::setw(12) << "Handle"
+     << std::setw(12) << "Total"
+     << "Max\n";
+  for (auto& stat : Stats()) {
+    double n = stat.calls * 1000.;
+    ss << std::left << std::setw(20) << stat.method << std::setw(40)
+       << stat.varname << std::setw(10) << stat.calls << std::setw(12)
+       << stat.sum.serialize / n << std::setw(12) << stat.sum.network / n
+       << std::setw(12) << stat.sum.queue / n << std::setw(14)
+       << stat.sum.deserialize / n << std::setw(12) << stat.sum.handle / n
+       << std::setw(12) << stat.sum.total / n << stat.max_total / 1000.
+       << "\n";
+  }
+  return ss.str();
+}
+
+void RPCTraceStats::Reset() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  stats_.clear();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
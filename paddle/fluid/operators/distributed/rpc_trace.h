@@ -0,0 +1,115 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <gflags/gflags.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+DECLARE_bool(rpc_trace);
+DECLARE_int32(rpc_trace_slow_ms);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The key of the server phases in the trailing metadata of the responses.
+constexpr char kRPCTraceMetadataKey[] = "paddle-rpc-trace";
+
+// In microseconds of the steady clock.
+int64_t RPCTraceNowUs();
+
+// The id of a request, unique among the trainers, which is logged on both the
+// trainer and the pserver to correlate them.
+uint64_t NewRPCRequestId(int trainer_id);
+
+// The phases of a request in microseconds, the clocks of the trainer and the
+// pserver are not compared, so the network time is the round trip time
+// minus the other phases.
+struct RPCPhases {
+  // the request on the trainer
+  int64_t serialize{0};
+  int64_t network{0};
+  // from the request parsed to its handling on the pserver
+  int64_t queue{0};
+  // the request on the pserver and the response on the trainer
+  int64_t deserialize{0};
+  // the handling on the pserver, including serializing the response
+  int64_t handle{0};
+  int64_t total{0};
+};
+
+// The phases measured by the pserver, sent back in the trailing metadata.
+struct ServerRPCPhases {
+  uint64_t request_id{0};
+  int64_t deserialize{0};
+  int64_t queue{0};
+  int64_t handle{0};
+
+  std::string Encode() const;
+  static bool Decode(const std::string& str, ServerRPCPhases* phases);
+};
+
+// The client side timestamps of a request.
+struct RPCTrace {
+  uint64_t request_id{0};
+  int64_t start_us{0};
+  int64_t serialized_us{0};
+  int64_t responded_us{0};
+
+  // Merge with the server phases into the phases of the request.
+  RPCPhases Phases(int64_t end_us, const ServerRPCPhases& server) const;
+};
+
+// The aggregated phases of the requests of a variable.
+struct RPCVarStat {
+  std::string method;
+  std::string varname;
+  int64_t calls{0};
+  RPCPhases sum;
+  int64_t max_total{0};
+};
+
+/*
+ * The latency of the requests by method and variable, which is recorded by
+ * both the trainers and the pservers when FLAGS_rpc_trace is on. The requests
+ * slower than FLAGS_rpc_trace_slow_ms are logged with their ids and phases.
+ */
+class RPCTraceStats {
+ public:
+  static RPCTraceStats& Instance();
+
+  void Record(const std::string& method, const std::string& varname,
+              uint64_t request_id, const RPCPhases& phases);
+  // In the descending order of the total time.
+  std::vector<RPCVarStat> Stats() const;
+  std::string Report() const;
+  void Reset();
+
+ private:
+  RPCTraceStats() = default;
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<std::string, std::string>, RPCVarStat> stats_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,97 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/rpc_trace.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(RPCTrace, EncodeDecode) {
+  ServerRPCPhases server;
+  server.request_id = NewRPCRequestId(3);
+  server.deserialize = 10;
+  server.queue = 20;
+  server.handle = 30;
+
+  ServerRPCPhases decoded;
+  EXPECT_TRUE(ServerRPCPhases::Decode(server.Encode(), &decoded));
+  EXPECT_EQ(decoded.request_id, server.request_id);
+  EXPECT_EQ(decoded.request_id >> 48, 3UL);
+  EXPECT_EQ(decoded.deserialize, 10);
+  EXPECT_EQ(decoded.queue, 20);
+  EXPECT_EQ(decoded.handle, 30);
+
+  EXPECT_FALSE(ServerRPCPhases::Decode("1,2,3", &decoded));
+  EXPECT_FALSE(ServerRPCPhases::Decode("invalid", &decoded));
+  EXPECT_NE(NewRPCRequestId(3), NewRPCRequestId(3));
+}
+
+TEST(RPCTrace, Phases) {
+  RPCTrace trace;
+  trace.request_id = 1;
+  trace.start_us = 1000;
+  trace.serialized_us = 1100;
+  trace.responded_us = 2000;
+  ServerRPCPhases server;
+  server.deserialize = 50;
+  server.queue = 200;
+  server.handle = 300;
+
+  auto phases = trace.Phases(2010, server);
+  EXPECT_EQ(phases.total, 1010);
+  EXPECT_EQ(phases.serialize, 100);
+  EXPECT_EQ(phases.network, 350);
+  EXPECT_EQ(phases.queue, 200);
+  EXPECT_EQ(phases.deserialize, 60);
+  EXPECT_EQ(phases.handle, 300);
+
+  // without the server phases, all the time on the wire is the network's
+  phases = trace.Phases(2000, ServerRPCPhases());
+  EXPECT_EQ(phases.network, 900);
+}
+
+TEST(RPCTrace, Stats) {
+  auto& stats = RPCTraceStats::Instance();
+  stats.Reset();
+  RPCPhases fast, slow;
+  fast.total = 100;
+  fast.network = 60;
+  slow.total = 1000;
+  slow.queue = 900;
+  stats.Record("SendVariable", "w", 1, fast);
+  stats.Record("SendVariable", "w", 2, fast);
+  stats.Record("GetVariable", "b", 3, slow);
+
+  auto all = stats.Stats();
+  ASSERT_EQ(all.size(), 2UL);
+  EXPECT_EQ(all[0].varname, "b");
+  EXPECT_EQ(all[0].sum.queue, 900);
+  EXPECT_EQ(all[1].method, "SendVariable");
+  EXPECT_EQ(all[1].calls, 2);
+  EXPECT_EQ(all[1].sum.network, 120);
+  EXPECT_EQ(all[1].max_total, 100);
+  EXPECT_NE(stats.Report().find("GetVariable"), std::string::npos);
+
+  stats.Reset();
+  EXPECT_TRUE(stats.Stats().empty());
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -15,17 +15,33 @@ limitations under the License. */
 #ifdef PADDLE_WITH_NCCL
 #include <nccl.h>
 #endif
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
+#include "paddle/fluid/platform/float16.h"
 #include "paddle/fluid/platform/port.h"
+#include "paddle/fluid/string/split.h"
 
 DEFINE_bool(rpc_disable_reuse_port, false, "Disable SO_REUSEPORT or not.");
 DEFINE_int32(rpc_retry_bind_port, 3,
              "Retry to bind the address if address is already used.");
+DEFINE_string(rpc_send_encoding, "",
+              "The transport encoding of the FP32 tensors sent, which is a "
+              "comma separated list of [var_name_prefix:]encoding, where "
+              "encoding is raw, fp16 or int8, e.g., "
+              "\"emb@GRAD:int8,fp16\". The longest matched prefix is used, "
+              "and the entry without prefix matches all the variables. "
+              "Empty means raw.");
+DEFINE_bool(rpc_compress_rows, false,
+            "Whether to send the rows of SelectedRows as delta varints.");
 
 namespace paddle {
 namespace operators {
@@ -56,6 +72,24 @@ static TensorPayload GetCommunicationAllocationFromTensor(
     return TensorPayload(tensor);
   }
 }
+// Encode the FP32 payload of tensor if an encoding is configured for the
+// variable of request.
+static TensorPayload EncodeTensorPayload(const framework::Tensor& tensor,
+                                         TensorPayload payload,
+                                         VarMsg* request) {
+  if (tensor.type() != framework::proto::VarType::FP32) return payload;
+  auto encoding = GetSendEncoding(request->varname());
+  if (encoding == VarMsg::ENCODING_RAW) return payload;
+  int64_t numel = tensor.numel();
+  auto allocation =
+      memory::AllocShared(platform::CPUPlace(), EncodedSize(encoding, numel));
+  // The payload is on CPU or CUDA pinned memory.
+  EncodeTensorData(encoding, static_cast<const float*>(payload.ptr()), numel,
+                   static_cast<char*>(allocation->ptr()));
+  request->set_encoding(encoding);
+  return TensorPayload(allocation);
+}
+
 TensorPayload GetTensorPayload(framework::Variable* var,
                                const platform::DeviceContext& ctx,
                                VarMsg* request) {
@@ -76,7 +110,8 @@ TensorPayload GetTensorPayload(framework::Variable* var,
       }
     }
   }
-  return GetCommunicationAllocationFromTensor(ctx, tensor);
+  return EncodeTensorPayload(
+      tensor, GetCommunicationAllocationFromTensor(ctx, tensor), request);
 }
 
 TensorPayload GetSelectedRowsPayload(framework::Variable* var,
@@ -92,7 +127,194 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
   }
 
   auto* tensor = slr->mutable_value();
-  return GetCommunicationAllocationFromTensor(ctx, *tensor);
+  return EncodeTensorPayload(
+      *tensor, GetCommunicationAllocationFromTensor(ctx, *tensor), request);
+}
+
+TensorPayload GetBatchedTensorPayload(
+    const std::vector<std::string>& var_names,
+    const std::vector<framework::Variable*>& vars, VarMsg* request) {
+  PADDLE_ENFORCE_EQ(var_names.size(), vars.size(),
+                    platform::errors::InvalidArgument(
+                        "The number of the batched variables %d does not "
+                        "match the number of their names %d.",
+                        vars.size(), var_names.size()));
+  int64_t numel = 0;
+  for (size_t i = 0; i < vars.size(); ++i) {
+    PADDLE_ENFORCE_NOT_NULL(
+        vars[i], platform::errors::NotFound(
+                     "The batched variable %s is not found.", var_names[i]));
+    auto& tensor = vars[i]->Get<framework::LoDTensor>();
+    PADDLE_ENFORCE_EQ(
+        tensor.type() == framework::proto::VarType::FP32 &&
+            platform::is_cpu_place(tensor.place()) && tensor.lod().empty(),
+        true, platform::errors::InvalidArgument(
+                  "Only the FP32 LoDTensors without LoD on CPU can be "
+                  "batched, but the variable %s is not.",
+                  var_names[i]));
+    numel += tensor.numel();
+  }
+
+  framework::Tensor batched;
+  auto* data = batched.mutable_data<float>(framework::make_ddim({numel}),
+                                           platform::CPUPlace());
+  for (size_t i = 0; i < vars.size(); ++i) {
+    auto& tensor = vars[i]->Get<framework::LoDTensor>();
+    memcpy(data, tensor.data<float>(), tensor.numel() * sizeof(float));
+    data += tensor.numel();
+    auto* batched_var = request->add_batched_vars();
+    batched_var->set_varname(var_names[i]);
+    for (auto& dim : framework::vectorize(tensor.dims())) {
+      batched_var->add_dims(dim);
+    }
+  }
+  request->set_data_type(VarMsg::FP32);
+  request->add_dims(numel);
+  return EncodeTensorPayload(batched, TensorPayload(batched), request);
+}
+
+RowsPayload* GetRowsPayload(framework::Variable* var, VarMsg* request) {
+  auto& rows = var->Get<framework::SelectedRows>().rows();
+  if (!FLAGS_rpc_compress_rows) {
+    return new RowsPayload(rows);
+  }
+  std::string encoded_rows;
+  EncodeRows(rows.data(), rows.size(), &encoded_rows);
+  request->set_rows_encoding(VarMsg::ROWS_DELTA_VARINT);
+  return new RowsPayload(std::move(encoded_rows));
+}
+
+VarMsg::Encoding GetSendEncoding(const std::string& varname) {
+  if (FLAGS_rpc_send_encoding.empty()) return VarMsg::ENCODING_RAW;
+  bool matched = false;
+  size_t matched_prefix_len = 0;
+  std::string matched_encoding;
+  for (auto& item : string::Split(FLAGS_rpc_send_encoding, ',')) {
+    auto pos = item.rfind(':');
+    std::string prefix = pos == std::string::npos ? "" : item.substr(0, pos);
+    if (varname.compare(0, prefix.size(), prefix) != 0 ||
+        (matched && prefix.size() < matched_prefix_len)) {
+      continue;
+    }
+    matched = true;
+    matched_prefix_len = prefix.size();
+    matched_encoding =
+        pos == std::string::npos ? item : item.substr(pos + 1);
+  }
+  if (!matched || matched_encoding == "raw") {
+    return VarMsg::ENCODING_RAW;
+  } else if (matched_encoding == "fp16") {
+    return VarMsg::ENCODING_FP16;
+  } else if (matched_encoding == "int8") {
+    return VarMsg::ENCODING_INT8_BLOCK;
+  }
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "Unknown transport encoding %s in FLAGS_rpc_send_encoding, it should be "
+      "raw, fp16 or int8.",
+      matched_encoding));
+}
+
+size_t EncodedSize(VarMsg::Encoding encoding, int64_t numel) {
+  switch (encoding) {
+    case VarMsg::ENCODING_FP16:
+      return numel * sizeof(platform::float16);
+    case VarMsg::ENCODING_INT8_BLOCK: {
+      int64_t block_num =
+          (numel + kInt8EncodingBlockSize - 1) / kInt8EncodingBlockSize;
+      return block_num * sizeof(float) + numel * sizeof(int8_t);
+    }
+    default:
+      return numel * sizeof(float);
+  }
+}
+
+void EncodeTensorData(VarMsg::Encoding encoding, const float* src,
+                      int64_t numel, char* dst) {
+  if (encoding == VarMsg::ENCODING_FP16) {
+    auto* out = reinterpret_cast<platform::float16*>(dst);
+    for (int64_t i = 0; i < numel; ++i) {
+      out[i] = static_cast<platform::float16>(src[i]);
+    }
+  } else if (encoding == VarMsg::ENCODING_INT8_BLOCK) {
+    int64_t block_num =
+        (numel + kInt8EncodingBlockSize - 1) / kInt8EncodingBlockSize;
+    auto* scales = reinterpret_cast<float*>(dst);
+    auto* out = reinterpret_cast<int8_t*>(dst + block_num * sizeof(float));
+    for (int64_t b = 0; b < block_num; ++b) {
+      int64_t begin = b * kInt8EncodingBlockSize;
+      int64_t end = std::min(numel, begin + kInt8EncodingBlockSize);
+      float max_abs = 0;
+      for (int64_t i = begin; i < end; ++i) {
+        max_abs = std::max(max_abs, std::fabs(src[i]));
+      }
+      float scale = max_abs / 127.0f;
+      scales[b] = scale;
+      float inv_scale = scale > 0 ? 1.0f / scale : 0.0f;
+      for (int64_t i = begin; i < end; ++i) {
+        float q = std::round(src[i] * inv_scale);
+        out[i] = static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, q)));
+      }
+    }
+  } else {
+    memcpy(dst, src, numel * sizeof(float));
+  }
+}
+
+void DecodeTensorData(VarMsg::Encoding encoding, const char* src,
+                      int64_t numel, float* dst) {
+  if (encoding == VarMsg::ENCODING_FP16) {
+    auto* in = reinterpret_cast<const platform::float16*>(src);
+    for (int64_t i = 0; i < numel; ++i) {
+      dst[i] = static_cast<float>(in[i]);
+    }
+  } else if (encoding == VarMsg::ENCODING_INT8_BLOCK) {
+    int64_t block_num =
+        (numel + kInt8EncodingBlockSize - 1) / kInt8EncodingBlockSize;
+    auto* scales = reinterpret_cast<const float*>(src);
+    auto* in =
+        reinterpret_cast<const int8_t*>(src + block_num * sizeof(float));
+    for (int64_t i = 0; i < numel; ++i) {
+      dst[i] = in[i] * scales[i / kInt8EncodingBlockSize];
+    }
+  } else {
+    memcpy(dst, src, numel * sizeof(float));
+  }
+}
+
+void EncodeRows(const int64_t* rows, size_t num, std::string* dst) {
+  dst->clear();
+  dst->reserve(num * 2);
+  int64_t prev = 0;
+  for (size_t i = 0; i < num; ++i) {
+    int64_t delta = rows[i] - prev;
+    prev = rows[i];
+    // zigzag, so that small negative deltas are short too
+    uint64_t v = (static_cast<uint64_t>(delta) << 1) ^
+                 static_cast<uint64_t>(delta >> 63);
+    while (v >= 0x80) {
+      dst->push_back(static_cast<char>(v | 0x80));
+      v >>= 7;
+    }
+    dst->push_back(static_cast<char>(v));
+  }
+}
+
+bool DecodeRows(const char* src, size_t length, size_t num, int64_t* rows) {
+  size_t pos = 0;
+  int64_t prev = 0;
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t v = 0;
+    for (int shift = 0;; shift += 7) {
+      if (pos >= length || shift > 63) return false;
+      uint8_t byte = static_cast<uint8_t>(src[pos++]);
+      v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    int64_t delta = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    prev += delta;
+    rows[i] = prev;
+  }
+  return pos == length;
 }
 
 TensorPayload::TensorPayload(std::shared_ptr<memory::Allocation> allocation)
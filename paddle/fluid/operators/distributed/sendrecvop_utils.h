@@ -50,6 +50,37 @@ class TensorPayload final {
   size_t memory_size_;
 };
 
+// RowsPayload keeps the rows of a SelectedRows alive until they are sent,
+// so that the rows are sent without a copy. framework::Vector is
+// copy-on-write, so the payload shares the memory of the rows, and it is not
+// affected if the variable is modified during sending.
+// If the rows are encoded, the payload holds the encoded rows instead.
+class RowsPayload final {
+ public:
+  explicit RowsPayload(const framework::Vector<int64_t>& rows)
+      : rows_(rows) {}
+  explicit RowsPayload(std::string&& encoded_rows)
+      : encoded_rows_(std::move(encoded_rows)), is_encoded_(true) {}
+
+  const void* ptr() const {
+    return is_encoded_ ? static_cast<const void*>(encoded_rows_.data())
+                       : static_cast<const void*>(rows_.data());
+  }
+  size_t memory_size() const {
+    return is_encoded_ ? encoded_rows_.size()
+                       : rows_.size() * sizeof(int64_t);
+  }
+
+ private:
+  framework::Vector<int64_t> rows_;
+  std::string encoded_rows_;
+  bool is_encoded_{false};
+};
+
+inline void RowsDestroyCallback(void* payload) {
+  delete reinterpret_cast<RowsPayload*>(payload);
+}
+
 inline void SerializeDestroyCallback(void* payload) {
   if (payload != nullptr) {
     auto* shared_payload = reinterpret_cast<TensorPayload*>(payload);
@@ -65,6 +96,38 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
                                      const platform::DeviceContext& ctx,
                                      VarMsg* request);
 
+// Concatenate the FP32 data of the dense LoDTensor vars, which are on CPU,
+// into the payload, and record the names and the dims of them in
+// request->batched_vars.
+TensorPayload GetBatchedTensorPayload(
+    const std::vector<std::string>& var_names,
+    const std::vector<framework::Variable*>& vars, VarMsg* request);
+
+// The rows of the SelectedRows var, encoded if FLAGS_rpc_compress_rows is
+// set. The caller takes the ownership of the returned payload.
+RowsPayload* GetRowsPayload(framework::Variable* var, VarMsg* request);
+
+// The number of elements sharing a scale in ENCODING_INT8_BLOCK.
+constexpr int64_t kInt8EncodingBlockSize = 256;
+
+// The transport encoding of the FP32 tensor data of varname, configured by
+// FLAGS_rpc_send_encoding.
+VarMsg::Encoding GetSendEncoding(const std::string& varname);
+
+// The number of bytes of numel FP32 elements in encoding.
+size_t EncodedSize(VarMsg::Encoding encoding, int64_t numel);
+
+void EncodeTensorData(VarMsg::Encoding encoding, const float* src,
+                      int64_t numel, char* dst);
+
+void DecodeTensorData(VarMsg::Encoding encoding, const char* src,
+                      int64_t numel, float* dst);
+
+void EncodeRows(const int64_t* rows, size_t num, std::string* dst);
+
+// Return false if src is not num encoded rows.
+bool DecodeRows(const char* src, size_t length, size_t num, int64_t* rows);
+
 inline framework::proto::VarType::Type ToVarType(
     sendrecv::VariableMessage::Type type) {
   switch (type) {
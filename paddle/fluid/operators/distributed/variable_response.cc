@@ -18,11 +18,64 @@
 
 DEFINE_string(rpc_server_profile_path, "./profile_ps",
               "the profile log file path");
+DEFINE_int32(rpc_recv_buffer_num, 2,
+             "the max number of received buffers kept for reuse for each "
+             "variable, 0 means the received buffers are not reused.");
 
 namespace paddle {
 namespace operators {
 namespace distributed {
 
+void RecvBufferPool::Get(const std::string& varname, framework::Tensor* value,
+                         framework::Vector<int64_t>* rows) {
+  if (FLAGS_rpc_recv_buffer_num <= 0) return;
+  Buffer buffer;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = buffers_.find(varname);
+    if (iter == buffers_.end() || iter->second.empty()) return;
+    buffer = std::move(iter->second.back());
+    iter->second.pop_back();
+  }
+  if (buffer.value != nullptr && value->Holder() == nullptr) {
+    value->ResetHolder(std::move(buffer.value));
+  }
+  if (rows != nullptr && rows->empty()) {
+    *rows = buffer.rows;
+  }
+}
+
+void RecvBufferPool::Put(const std::string& varname,
+                         const framework::Variable& var) {
+  if (FLAGS_rpc_recv_buffer_num <= 0) return;
+  const framework::Tensor* value = nullptr;
+  Buffer buffer;
+  if (var.IsType<framework::LoDTensor>()) {
+    value = &var.Get<framework::LoDTensor>();
+  } else if (var.IsType<framework::SelectedRows>()) {
+    auto& slr = var.Get<framework::SelectedRows>();
+    value = &slr.value();
+    // framework::Vector is copy-on-write, it is safe to share the rows.
+    buffer.rows = slr.rows();
+  } else {
+    return;
+  }
+  if (value->IsInitialized() && platform::is_cpu_place(value->place())) {
+    buffer.value = value->Holder();
+    // the memory may be still used by others after the request
+    if (buffer.value.use_count() != 2) {
+      buffer.value.reset();
+    }
+  }
+  if (buffer.value == nullptr && buffer.rows.empty()) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& buffers = buffers_[varname];
+  if (buffers.size() < static_cast<size_t>(FLAGS_rpc_recv_buffer_num)) {
+    buffers.push_back(std::move(buffer));
+  }
+}
+
 bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
                                const platform::DeviceContext& dev_ctx,
                                platform::Place place, void* dest,
@@ -91,6 +144,47 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
   return true;
 }
 
+bool VariableResponse::ReadEncodedTensorData(
+    ::google::protobuf::io::CodedInputStream* input,
+    const platform::DeviceContext& ctx, framework::Tensor* tensor,
+    int64_t length) {
+  PADDLE_ENFORCE_EQ(
+      tensor->type(), framework::proto::VarType::FP32,
+      platform::errors::InvalidArgument(
+          "Only FP32 tensors can be encoded, but %s is %s.", meta_.varname(),
+          framework::DataTypeToString(tensor->type())));
+  auto encoding = meta_.encoding();
+  PADDLE_ENFORCE_EQ(
+      static_cast<size_t>(length), EncodedSize(encoding, tensor->numel()),
+      platform::errors::InvalidArgument(
+          "The encoded data of %s has %d bytes, but %d bytes are expected for "
+          "%d elements.",
+          meta_.varname(), length, EncodedSize(encoding, tensor->numel()),
+          tensor->numel()));
+  platform::CPUPlace cpu;
+  std::vector<char> encoded(length);
+  if (!ReadRaw(input, ctx, cpu, encoded.data(), length)) {
+    return false;
+  }
+  if (platform::is_cpu_place(tensor->place())) {
+    DecodeTensorData(encoding, encoded.data(), tensor->numel(),
+                     tensor->data<float>());
+    return true;
+  }
+#ifdef PADDLE_WITH_CUDA
+  std::vector<float> decoded(tensor->numel());
+  DecodeTensorData(encoding, encoded.data(), tensor->numel(), decoded.data());
+  auto& gpu_dev_ctx = static_cast<const platform::CUDADeviceContext&>(ctx);
+  memory::Copy(BOOST_GET_CONST(platform::CUDAPlace, tensor->place()),
+               tensor->data<float>(), cpu, decoded.data(),
+               decoded.size() * sizeof(float), gpu_dev_ctx.stream());
+  gpu_dev_ctx.Wait();
+  return true;
+#else
+  PADDLE_THROW("Unexpected branch");
+#endif
+}
+
 bool VariableResponse::CopyLodTensorData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, const framework::DDim& dims,
@@ -102,6 +196,9 @@ bool VariableResponse::CopyLodTensorData(
     return false;
   }
   auto* tensor = GetVar()->GetMutable<framework::LoDTensor>();
+  if (create_scope_) {
+    RecvBufferPool::Instance().Get(meta_.varname(), tensor, nullptr);
+  }
   tensor->Resize(dims);
   framework::LoD lod;
   for (int i = 0; i < meta_.lod_level(); ++i) {
@@ -120,9 +217,54 @@ bool VariableResponse::CopyLodTensorData(
           << ", Buffer Size = " << length << ", dims:" << dims
           << ", numel:" << tensor->numel();
   PADDLE_ENFORCE_GE(tensor->memory_size(), static_cast<unsigned int>(length));
+  if (meta_.encoding() != sendrecv::VariableMessage::ENCODING_RAW) {
+    return ReadEncodedTensorData(input, ctx, tensor, length);
+  }
   return ReadRaw(input, ctx, tensor->place(), tensor_data, length);
 }
 
+bool VariableResponse::CopyBatchedTensorData(
+    ::google::protobuf::io::CodedInputStream* input,
+    const platform::DeviceContext& ctx, const framework::DDim& dims,
+    int length) {
+  batched_tensor_.Resize(dims);
+  void* tensor_data = batched_tensor_.mutable_data(
+      ctx.GetPlace(), ToVarType(meta_.data_type()));
+  PADDLE_ENFORCE_GE(batched_tensor_.memory_size(),
+                    static_cast<unsigned int>(length));
+  bool ok = meta_.encoding() != sendrecv::VariableMessage::ENCODING_RAW
+                ? ReadEncodedTensorData(input, ctx, &batched_tensor_, length)
+                : ReadRaw(input, ctx, batched_tensor_.place(), tensor_data,
+                          length);
+  if (!ok) return false;
+
+  int64_t offset = 0;
+  for (auto& batched_var : meta_.batched_vars()) {
+    auto* var = create_scope_ ? local_scope_->Var(batched_var.varname())
+                              : scope_->FindVar(batched_var.varname());
+    if (var == nullptr) {
+      LOG(ERROR) << "recved var should not on current server: "
+                 << batched_var.varname();
+      return false;
+    }
+    std::vector<int64_t> var_dims(batched_var.dims().begin(),
+                                  batched_var.dims().end());
+    auto ddim = framework::make_ddim(var_dims);
+    int64_t numel = framework::product(ddim);
+    if (offset + numel > batched_tensor_.numel()) {
+      LOG(ERROR) << "the batched data of " << meta_.varname()
+                 << " is shorter than the batched vars";
+      return false;
+    }
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    tensor->ShareDataWith(batched_tensor_.Slice(offset, offset + numel));
+    tensor->Resize(ddim);
+    tensor->set_lod(framework::LoD());
+    offset += numel;
+  }
+  return offset == batched_tensor_.numel();
+}
+
 inline framework::DDim GetDims(
     const ::google::protobuf::RepeatedField<::google::protobuf::int64>& dims) {
   std::vector<int> vecdims;
@@ -139,14 +281,21 @@ bool VariableResponse::CopySelectRowsTensorData(
   auto* slr = GetVar()->GetMutable<framework::SelectedRows>();
   slr->set_height(meta_.slr_height());
   auto* tensor = slr->mutable_value();
+  if (create_scope_) {
+    RecvBufferPool::Instance().Get(meta_.varname(), tensor,
+                                   slr->mutable_rows());
+  }
   tensor->Resize(dims);
+  void* tensor_data = tensor->mutable_data(
+      ctx.GetPlace(),
+      paddle::operators::distributed::ToVarType(meta_.data_type()));
+  if (meta_.encoding() != sendrecv::VariableMessage::ENCODING_RAW) {
+    return ReadEncodedTensorData(input, ctx, tensor, length);
+  }
   PADDLE_ENFORCE_EQ(
       static_cast<size_t>(tensor->numel()),
       length / framework::SizeOfType(paddle::operators::distributed::ToVarType(
                    meta_.data_type())));
-  void* tensor_data = tensor->mutable_data(
-      ctx.GetPlace(),
-      paddle::operators::distributed::ToVarType(meta_.data_type()));
 
   if (!ReadRaw(input, ctx, tensor->place(), tensor_data, length)) {
     return false;
@@ -159,12 +308,29 @@ bool VariableResponse::CopySelectRowsData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, int length) {
   auto* slr = GetVar()->GetMutable<framework::SelectedRows>();
-  slr->mutable_rows()->clear();
+  platform::CPUPlace cpu;
+  if (meta_.rows_encoding() == sendrecv::VariableMessage::ROWS_DELTA_VARINT) {
+    // the number of rows is the first dim of the value
+    PADDLE_ENFORCE_GT(meta_.dims_size(), 0,
+                      platform::errors::InvalidArgument(
+                          "The dims of %s should be got before the encoded "
+                          "rows.",
+                          meta_.varname()));
+    std::vector<char> encoded(length);
+    if (!ReadRaw(input, ctx, cpu, encoded.data(), length)) {
+      return false;
+    }
+    slr->mutable_rows()->resize(meta_.dims(0));
+    return DecodeRows(encoded.data(), length, meta_.dims(0),
+                      slr->mutable_rows()->data());
+  }
+
+  // all the rows are overwritten, keep the memory of the rows received in
+  // the last step.
   slr->mutable_rows()->resize(length / sizeof(int64_t));  // int64
   int64_t* rows_data = slr->mutable_rows()->data();
 
   // copy rows CPU data, GPU data will be copied lazily.
-  platform::CPUPlace cpu;
   if (!ReadRaw(input, ctx, cpu, rows_data, length)) {
     return false;
   }
@@ -203,6 +369,9 @@ bool VariableResponse::ProcSerializedField(
   framework::DDim dims = GetDims(meta_.dims());
   if (meta_.type() == sendrecv::LOD_TENSOR) {
     PADDLE_ENFORCE(meta_.lod_size() >= 0, "lod info should be got first!");
+    if (meta_.batched_vars_size() > 0) {
+      return CopyBatchedTensorData(input, *dev_ctx_, dims, num_bytes);
+    }
     if (!CopyLodTensorData(input, *dev_ctx_, dims, num_bytes)) {
       return false;
     }
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -28,6 +32,7 @@
 #include "paddle/fluid/operators/distributed/distributed_pb.h"
 
 DECLARE_string(rpc_server_profile_path);
+DECLARE_int32(rpc_recv_buffer_num);
 
 namespace paddle {
 namespace operators {
@@ -53,6 +58,38 @@ class Source {
   virtual ::google::protobuf::io::ZeroCopyInputStream* contents() = 0;
 };
 
+// RecvBufferPool keeps the memory of the variables received into the
+// temporary scopes of the requests, so that the next request of the same
+// variable is received into it instead of the freshly allocated memory.
+// At most FLAGS_rpc_recv_buffer_num buffers are kept for each variable.
+class RecvBufferPool {
+ public:
+  static RecvBufferPool& Instance() {
+    static RecvBufferPool pool;
+    return pool;
+  }
+
+  // Give the memory kept for varname to value and rows, if they are not
+  // allocated yet. rows can be nullptr for LoDTensor.
+  void Get(const std::string& varname, framework::Tensor* value,
+           framework::Vector<int64_t>* rows);
+
+  // Take back the memory of var which is going to be destroyed. The
+  // memory is kept only if var is the only owner of it.
+  void Put(const std::string& varname, const framework::Variable& var);
+
+ private:
+  RecvBufferPool() = default;
+
+  struct Buffer {
+    std::shared_ptr<memory::Allocation> value;
+    framework::Vector<int64_t> rows;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<Buffer>> buffers_;
+};
+
 class VariableResponse {
  public:
   VariableResponse(const framework::Scope* scope,
@@ -66,6 +103,10 @@ class VariableResponse {
 
   virtual ~VariableResponse() {
     if (local_scope_) {
+      auto* var = local_scope_->FindLocalVar(meta_.varname());
+      if (var != nullptr) {
+        RecvBufferPool::Instance().Put(meta_.varname(), *var);
+      }
       delete local_scope_;
       local_scope_ = nullptr;
     }
@@ -97,12 +138,32 @@ class VariableResponse {
   }
 
   int GetTrainerId() { return static_cast<int>(meta_.trainer_id()); }
+  uint64_t GetRequestId() const { return meta_.request_id(); }
+
+  // The time parsing the request began and ended at, in us, see rpc_trace.h.
+  int64_t ParseBeginUs() const { return parse_begin_us_; }
+  int64_t ParseEndUs() const { return parse_end_us_; }
+
+  // The names of the variables of a batched request, which are received into
+  // the scope instead of GetVar(). Empty if the request is not batched.
+  std::vector<std::string> BatchedVarnames() const {
+    std::vector<std::string> names;
+    for (auto& batched_var : meta_.batched_vars()) {
+      names.push_back(batched_var.varname());
+    }
+    return names;
+  }
 
  protected:
   bool ReadRaw(::google::protobuf::io::CodedInputStream* input,
                const platform::DeviceContext& dev_ctx, platform::Place place,
                void* dest, int64_t size);
 
+  // Decode the encoded FP32 data into tensor, which has been allocated.
+  bool ReadEncodedTensorData(::google::protobuf::io::CodedInputStream* input,
+                             const platform::DeviceContext& ctx,
+                             framework::Tensor* tensor, int64_t length);
+
   bool CopySelectRowsTensorData(::google::protobuf::io::CodedInputStream* input,
                                 const platform::DeviceContext& ctx,
                                 const framework::DDim& dims, int length);
@@ -114,6 +175,12 @@ class VariableResponse {
                          const platform::DeviceContext& ctx,
                          const framework::DDim& dims, int length);
 
+  // Receive the concatenated data of the batched variables, and share it
+  // with them.
+  bool CopyBatchedTensorData(::google::protobuf::io::CodedInputStream* input,
+                             const platform::DeviceContext& ctx,
+                             const framework::DDim& dims, int length);
+
   bool ProcSerializedField(int tag,
                            ::google::protobuf::io::CodedInputStream* input,
                            int64_t num_bytes);
@@ -125,6 +192,11 @@ class VariableResponse {
   framework::Scope* local_scope_ = nullptr;
 
   sendrecv::VariableMessage meta_;
+  // The data of the batched variables.
+  framework::Tensor batched_tensor_;
+
+  int64_t parse_begin_us_ = 0;
+  int64_t parse_end_us_ = 0;
 };
 
 };  // namespace distributed
@@ -94,9 +94,15 @@ class DistributedLookupTableKernel : public framework::OpKernel<T> {
         context.Attr<std::vector<int64_t>>("height_sections");
     auto endpoints = context.Attr<std::vector<std::string>>("endpoints");
 
-    operators::distributed::prefetchs(
-        id_names, out_names, embedding_name, false, lookup_tables, endpoints,
-        height_sections, context, context.scope());
+    if (context.Attr<bool>("async_prefetch")) {
+      operators::distributed::AsyncPrefetchs(
+          id_names, out_names, embedding_name, lookup_tables, endpoints,
+          height_sections, context, context.scope());
+    } else {
+      operators::distributed::prefetchs(
+          id_names, out_names, embedding_name, false, lookup_tables,
+          endpoints, height_sections, context, context.scope());
+    }
   }
 };
 
@@ -144,6 +150,13 @@ class DistributedLookupTableOpMaker : public framework::OpProtoAndCheckerMaker {
                  "(int, default 5 (FP32)) "
                  "Output data type")
         .SetDefault(framework::proto::VarType::FP32);
+    AddAttr<bool>("async_prefetch",
+                  "(bool, default false) "
+                  "If true, the operator only sends the lookup requests, and "
+                  "the Outputs are filled by distributed_lookup_table_wait, "
+                  "so that the ops in between run while the requests are in "
+                  "flight.")
+        .SetDefault(false);
 
     AddComment(R"DOC(
 Lookup Tablel Prefetch Operator.
@@ -0,0 +1,78 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/distributed/parameter_prefetch.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace operators {
+
+class DistributedLookupTableWaitOp : public framework::OperatorBase {
+ public:
+  DistributedLookupTableWaitOp(const std::string& type,
+                               const framework::VariableNameMap& inputs,
+                               const framework::VariableNameMap& outputs,
+                               const framework::AttributeMap& attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& place) const override {
+    platform::RecordEvent record_event("distributed_lookup_table_wait");
+    distributed::WaitPrefetchs(Outputs("Out"), scope);
+  }
+};
+
+class DistributedLookupTableWaitOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("X",
+             "(LoDTensor) The Outputs of the distributed_lookup_table with "
+             "async_prefetch, in the same order.")
+        .AsDuplicable();
+    AddOutput("Out",
+              "(LoDTensor) The lookup results, the same variables as X.")
+        .AsDuplicable();
+    AddComment(R"DOC(
+Distributed Lookup Table Wait Operator.
+
+This operator waits the lookup requests sent by the distributed_lookup_table
+operator whose attribute async_prefetch is true, and writes the embeddings
+into its Outputs. It should be placed right before the first operator reading
+the embeddings.
+)DOC");
+  }
+};
+
+class DistributedLookupTableWaitOpShapeInference
+    : public framework::InferShapeBase {
+ public:
+  void operator()(framework::InferShapeContext* ctx) const override {}
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(
+    distributed_lookup_table_wait, ops::DistributedLookupTableWaitOp,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>,
+    ops::DistributedLookupTableWaitOpMaker,
+    ops::DistributedLookupTableWaitOpShapeInference);
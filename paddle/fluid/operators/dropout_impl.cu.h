@@ -0,0 +1,34 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <curand_kernel.h>
+
+namespace paddle {
+namespace operators {
+
+// Whether the idx-th element is kept by the dropout with seed. The random
+// number of an element is drawn from its own subsequence of the
+// counter-based Philox stream, so it does not depend on the launch and the
+// mask can be regenerated anywhere from the seed, e.g. by the backward of
+// dropout with recompute_mask, or inside a fused elementwise kernel.
+__device__ __forceinline__ bool DropoutKeep(int seed, int64_t idx,
+                                            float dropout_prob) {
+  curandStatePhilox4_32_10_t state;
+  curand_init(seed, idx, 0, &state);
+  return curand_uniform(&state) >= dropout_prob;
+}
+
+}  // namespace operators
+}  // namespace paddle
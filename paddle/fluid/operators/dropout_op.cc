@@ -31,7 +31,13 @@ class DropoutOp : public framework::OperatorWithKernel {
     auto x_dims = ctx->GetInputDim("X");
     ctx->SetOutputDim("Out", x_dims);
     if (ctx->Attrs().Get<bool>("is_test") == false) {
-      ctx->SetOutputDim("Mask", x_dims);
+      if (ctx->Attrs().Get<bool>("recompute_mask")) {
+        OP_INOUT_CHECK(ctx->HasOutput("SeedOut"), "Output", "SeedOut",
+                       "Dropout");
+        ctx->SetOutputDim("SeedOut", framework::make_ddim({1}));
+      } else {
+        ctx->SetOutputDim("Mask", x_dims);
+      }
     }
     ctx->ShareLoD("X", /*->*/ "Out");
   }
@@ -54,6 +60,11 @@ class DropoutOpMaker : public framework::OpProtoAndCheckerMaker {
         .AsDispensable();
     AddOutput("Out", "The output of dropout op.");
     AddOutput("Mask", "The random sampled dropout mask.").AsIntermediate();
+    AddOutput("SeedOut",
+              "The seed the mask is sampled with, it is saved instead of the "
+              "mask when recompute_mask is true.")
+        .AsIntermediate()
+        .AsDispensable();
 
     AddAttr<float>("dropout_prob", "Probability of setting units to zero.")
         .SetDefault(.5f)
@@ -74,6 +85,12 @@ class DropoutOpMaker : public framework::OpProtoAndCheckerMaker {
                   "will be dropped.")
         .SetDefault(false);
     AddAttr<int>("seed", "Dropout random seed.").SetDefault(0);
+    AddAttr<bool>("recompute_mask",
+                  "(bool, default false) Set to true to save only the seed "
+                  "in SeedOut instead of the mask, and the backward draws "
+                  "the mask again from the seed. It saves the memory of a "
+                  "mask as large as the input.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "dropout_implementation",
         "[\"downgrade_in_infer\"|\"upscale_in_train\"]"
@@ -121,7 +138,12 @@ class DropoutOpGrad : public framework::OperatorWithKernel {
                       platform::errors::InvalidArgument(
                           "GradOp is only callable when is_test is false"));
 
-    OP_INOUT_CHECK(ctx->HasInput("Mask"), "Input", "Mask", "DropoutGrad");
+    if (ctx->Attrs().Get<bool>("recompute_mask")) {
+      OP_INOUT_CHECK(ctx->HasInput("SeedOut"), "Input", "SeedOut",
+                     "DropoutGrad");
+    } else {
+      OP_INOUT_CHECK(ctx->HasInput("Mask"), "Input", "Mask", "DropoutGrad");
+    }
     OP_INOUT_CHECK(ctx->HasInput(framework::GradVarName("Out")), "Input",
                    framework::GradVarName("Out"), "DropoutGrad");
 
@@ -139,6 +161,19 @@ class DropoutOpGrad : public framework::OperatorWithKernel {
                                        ctx, framework::GradVarName("Out")),
                                    ctx.GetPlace());
   }
+
+  // The seed stays where the forward put it, the CUDA kernel reads it on
+  // either place.
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const Tensor& tensor,
+      const framework::OpKernelType& expected_kernel_type) const override {
+    if (var_name == "SeedOut") {
+      return framework::OpKernelType(expected_kernel_type.data_type_,
+                                     tensor.place(), tensor.layout());
+    }
+    return framework::OperatorWithKernel::GetKernelTypeForVar(
+        var_name, tensor, expected_kernel_type);
+  }
 };
 
 template <typename T>
@@ -150,7 +185,11 @@ class DropoutGradOpMaker : public framework::SingleGradOpMaker<T> {
   void Apply(GradOpPtr<T> op) const override {
     op->SetType("dropout_grad");
     op->SetInput(framework::GradVarName("Out"), this->OutputGrad("Out"));
-    op->SetInput("Mask", this->Output("Mask"));
+    if (BOOST_GET_CONST(bool, this->GetAttr("recompute_mask"))) {
+      op->SetInput("SeedOut", this->Output("SeedOut"));
+    } else {
+      op->SetInput("Mask", this->Output("Mask"));
+    }
     op->SetOutput(framework::GradVarName("X"), this->InputGrad("X"));
     op->SetAttrMap(this->Attrs());
   }
@@ -19,6 +19,7 @@ limitations under the License. */
 #include <thrust/transform.h>
 #include <string>
 #include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/dropout_impl.cu.h"
 #include "paddle/fluid/operators/dropout_op.h"
 #include "paddle/fluid/platform/dynload/curand.h"
 #include "paddle/fluid/platform/float16.h"
@@ -96,6 +97,24 @@ __global__ void RandomGeneratorWithSeed(const size_t n, const int* seed,
   }
 }
 
+// The dropout with recompute_mask, which writes no mask. The backward runs it
+// on the gradient of Out with the same seed. The seed is read on the device
+// if seed_ptr is not nullptr.
+template <typename T>
+__global__ void DropoutWithoutMask(const size_t n, const int* seed_ptr,
+                                   int seed, const float dropout_prob,
+                                   const T* src, T* dst,
+                                   bool is_upscale_in_train) {
+  if (seed_ptr != nullptr) seed = *seed_ptr;
+  T factor = is_upscale_in_train ? static_cast<T>(1.0f / (1.0f - dropout_prob))
+                                 : static_cast<T>(1.0f);
+  for (int64_t idx = blockDim.x * blockIdx.x + threadIdx.x; idx < n;
+       idx += blockDim.x * gridDim.x) {
+    dst[idx] = DropoutKeep(seed, idx, dropout_prob) ? src[idx] * factor
+                                                    : static_cast<T>(0);
+  }
+}
+
 // It seems that Eigen::Tensor::setRandom in GPU will SEGFAULT.
 // Use std::random and thrust::random(thrust is a std library in CUDA) to
 // implement uniform random.
@@ -119,11 +138,44 @@ class GPUDropoutKernel : public framework::OpKernel<T> {
       int64_t x_numel = x->numel();
       auto stream = context.cuda_device_context().stream();
 
+      auto* x_data = x->data<T>();
+      auto* y_data = y->mutable_data<T>(context.GetPlace());
+      int threads = 512;
+      int grid = (x_numel + threads - 1) / threads;
+      if (context.Attr<bool>("recompute_mask")) {
+        // Only the seed is saved, the backward draws the mask again.
+        auto* seed_out = context.Output<Tensor>("SeedOut");
+        const int* seed_ptr = nullptr;
+        int seed_data = 0;
+        std::random_device rnd;
+        if (seed && platform::is_gpu_place(seed->place())) {
+          seed_out->ShareDataWith(*seed);
+          seed_ptr = seed->data<int>();
+        } else {
+          if (seed) {
+            seed_data = *(seed->data<int>());
+          } else {
+            seed_data = context.Attr<bool>("fix_seed")
+                            ? context.Attr<int>("seed")
+                            : rnd();
+          }
+          seed_out->mutable_data<int>(framework::make_ddim({1}),
+                                      platform::CPUPlace())[0] = seed_data;
+        }
+        if (dropout_prob == 1.0f) {
+          PADDLE_ENFORCE_CUDA_SUCCESS(
+              cudaMemsetAsync(y_data, 0, x_numel * sizeof(T), stream));
+          return;
+        }
+        DropoutWithoutMask<T><<<grid, threads, 0, stream>>>(
+            x_numel, seed_ptr, seed_data, dropout_prob, x_data, y_data,
+            upscale_in_train);
+        return;
+      }
+
       auto* mask = context.Output<Tensor>("Mask");
       auto* mask_data = mask->mutable_data<uint8_t>(context.GetPlace());
       size_t size = framework::product(mask->dims());
-      auto* x_data = x->data<T>();
-      auto* y_data = y->mutable_data<T>(context.GetPlace());
       if (dropout_prob == 1.0f) {
         PADDLE_ENFORCE_CUDA_SUCCESS(
             cudaMemsetAsync(y_data, 0, x_numel * sizeof(T), stream));
@@ -132,8 +184,6 @@ class GPUDropoutKernel : public framework::OpKernel<T> {
         return;
       }
 
-      int threads = 512;
-      int grid = (x_numel + threads - 1) / threads;
       if (seed && platform::is_gpu_place(seed->place())) {
         auto seed_gpu_data = seed->data<int>();
         RandomGeneratorWithSeed<T, uint8_t><<<grid, threads, 0, stream>>>(
@@ -165,6 +215,47 @@ class GPUDropoutKernel : public framework::OpKernel<T> {
   }
 };
 
+template <typename Place, typename T>
+class GPUDropoutGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    if (!context.Attr<bool>("recompute_mask")) {
+      DropoutGradKernel<Place, T>().Compute(context);
+      return;
+    }
+    PADDLE_ENFORCE_EQ(!context.Attr<bool>("is_test"), true,
+                      platform::errors::PreconditionNotMet(
+                          "GradOp is only callable when is_test is false"));
+    auto* grad_x = context.Output<Tensor>(framework::GradVarName("X"));
+    auto* grad_y = context.Input<Tensor>(framework::GradVarName("Out"));
+    auto* seed = context.Input<Tensor>("SeedOut");
+    auto* dx_data = grad_x->mutable_data<T>(context.GetPlace());
+    float dropout_prob = context.Attr<float>("dropout_prob");
+    bool upscale_in_train = context.Attr<std::string>(
+                                "dropout_implementation") == "upscale_in_train";
+    auto stream = context.cuda_device_context().stream();
+    int64_t numel = grad_y->numel();
+    if (dropout_prob == 1.0f) {
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaMemsetAsync(dx_data, 0, numel * sizeof(T), stream));
+      return;
+    }
+
+    const int* seed_ptr = nullptr;
+    int seed_data = 0;
+    if (platform::is_gpu_place(seed->place())) {
+      seed_ptr = seed->data<int>();
+    } else {
+      seed_data = seed->data<int>()[0];
+    }
+    int threads = 512;
+    int grid = (numel + threads - 1) / threads;
+    DropoutWithoutMask<T><<<grid, threads, 0, stream>>>(
+        numel, seed_ptr, seed_data, dropout_prob, grad_y->data<T>(), dx_data,
+        upscale_in_train);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -175,6 +266,6 @@ REGISTER_OP_CUDA_KERNEL(
     ops::GPUDropoutKernel<plat::CUDADeviceContext, plat::float16>,
     ops::GPUDropoutKernel<plat::CUDADeviceContext, double>);
 REGISTER_OP_CUDA_KERNEL(
-    dropout_grad, ops::DropoutGradKernel<plat::CUDADeviceContext, float>,
-    ops::DropoutGradKernel<plat::CUDADeviceContext, plat::float16>,
-    ops::DropoutGradKernel<plat::CUDADeviceContext, double>);
+    dropout_grad, ops::GPUDropoutGradKernel<plat::CUDADeviceContext, float>,
+    ops::GPUDropoutGradKernel<plat::CUDADeviceContext, plat::float16>,
+    ops::GPUDropoutGradKernel<plat::CUDADeviceContext, double>);
@@ -28,6 +28,18 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// Draw the mask of the dropout on CPU with the random stream of seed. The
+// backward of dropout with recompute_mask draws it again from the same seed.
+inline void CPUDropoutMask(int seed, float dropout_prob, size_t size,
+                           uint8_t* mask_data) {
+  std::minstd_rand engine;
+  engine.seed(seed);
+  std::uniform_real_distribution<float> dist(0, 1);
+  for (size_t i = 0; i < size; ++i) {
+    mask_data[i] = dist(engine) < dropout_prob ? 0 : 1;
+  }
+}
+
 template <typename DeviceContext, typename T>
 class CPUDropoutKernel : public framework::OpKernel<T> {
  public:
@@ -44,21 +56,18 @@ class CPUDropoutKernel : public framework::OpKernel<T> {
         context.Attr<std::string>("dropout_implementation");
     bool upscale_in_train = (dropout_implementation == "upscale_in_train");
     if (!context.Attr<bool>("is_test")) {
-      auto* mask = context.Output<Tensor>("Mask");
-      auto* mask_data = mask->mutable_data<uint8_t>(context.GetPlace());
-      size_t size = framework::product(mask->dims());
-
-      // Special case when dropout_prob is 1.0
-      if (dropout_prob == 1.0f) {
-        std::memset(y_data, 0, size * sizeof(*y_data));        // NOLINT
-        std::memset(mask_data, 0, size * sizeof(*mask_data));  // NOLINT
-        return;
-      }
+      size_t size = framework::product(x->dims());
+      // With recompute_mask, only the seed is saved for the backward and the
+      // mask is dropped after the output is computed.
+      bool recompute_mask = context.Attr<bool>("recompute_mask");
+      Tensor tmp_mask;
+      auto* mask = recompute_mask ? &tmp_mask : context.Output<Tensor>("Mask");
+      auto* mask_data =
+          mask->mutable_data<uint8_t>(x->dims(), platform::CPUPlace());
 
       // NOTE: fixed seed should only be used in unittest or for debug.
       // Guarantee to use random seed in training.
       std::random_device rnd;
-      std::minstd_rand engine;
       int seed_data;
       if (seed) {
         seed_data = *(seed->data<int>());
@@ -66,21 +75,27 @@ class CPUDropoutKernel : public framework::OpKernel<T> {
         seed_data =
             context.Attr<bool>("fix_seed") ? context.Attr<int>("seed") : rnd();
       }
-      engine.seed(seed_data);
+      if (recompute_mask) {
+        auto* seed_out = context.Output<Tensor>("SeedOut");
+        seed_out->mutable_data<int>(framework::make_ddim({1}),
+                                    platform::CPUPlace())[0] = seed_data;
+      }
 
-      std::uniform_real_distribution<float> dist(0, 1);
+      // Special case when dropout_prob is 1.0
+      if (dropout_prob == 1.0f) {
+        std::memset(y_data, 0, size * sizeof(*y_data));        // NOLINT
+        std::memset(mask_data, 0, size * sizeof(*mask_data));  // NOLINT
+        return;
+      }
 
+      CPUDropoutMask(seed_data, dropout_prob, size, mask_data);
       for (size_t i = 0; i < size; ++i) {
-        if (dist(engine) < dropout_prob) {
-          mask_data[i] = 0;
+        if (mask_data[i] == 0) {
           y_data[i] = 0;
+        } else if (upscale_in_train) {
+          y_data[i] = x_data[i] / static_cast<T>(1.0f - dropout_prob);
         } else {
-          mask_data[i] = 1;
-          if (upscale_in_train) {
-            y_data[i] = x_data[i] / static_cast<T>(1.0f - dropout_prob);
-          } else {
-            y_data[i] = x_data[i];
-          }
+          y_data[i] = x_data[i];
         }
       }
     } else {
@@ -114,8 +129,26 @@ class DropoutGradKernel : public framework::OpKernel<T> {
 
     auto* grad_x = context.Output<Tensor>(framework::GradVarName("X"));
     auto* grad_y = context.Input<Tensor>(framework::GradVarName("Out"));
-    auto* mask = context.Input<Tensor>("Mask");
     grad_x->mutable_data<T>(context.GetPlace());
+    float dropout_prob = context.Attr<float>("dropout_prob");
+
+    const Tensor* mask = nullptr;
+    Tensor regenerated_mask;
+    if (context.Attr<bool>("recompute_mask")) {
+      // The CUDA kernel regenerates the mask by itself in GPUDropoutGradKernel.
+      PADDLE_ENFORCE_EQ(platform::is_cpu_place(context.GetPlace()), true,
+                        platform::errors::Unimplemented(
+                            "The mask of dropout can only be regenerated on "
+                            "CPU by DropoutGradKernel."));
+      auto* seed = context.Input<Tensor>("SeedOut");
+      auto* mask_data = regenerated_mask.mutable_data<uint8_t>(
+          grad_y->dims(), platform::CPUPlace());
+      CPUDropoutMask(seed->data<int>()[0], dropout_prob, grad_y->numel(),
+                     mask_data);
+      mask = &regenerated_mask;
+    } else {
+      mask = context.Input<Tensor>("Mask");
+    }
 
     auto M = EigenMatrix<uint8_t>::Reshape(*mask, 1);
     auto dX = EigenMatrix<T>::Reshape(*grad_x, 1);
@@ -127,7 +160,6 @@ class DropoutGradKernel : public framework::OpKernel<T> {
     auto& dropout_implementation =
         context.Attr<std::string>("dropout_implementation");
     if (dropout_implementation == "upscale_in_train") {
-      float dropout_prob = context.Attr<float>("dropout_prob");
       if (dropout_prob == 1.0f) {
         dX.device(place) = static_cast<T>(0) * dY;
       } else {
@@ -27,11 +27,10 @@ struct SameDimsElemwiseDiv<platform::CUDADeviceContext, T> {
   void operator()(const framework::ExecutionContext& ctx,
                   const framework::Tensor* x, const framework::Tensor* y,
                   framework::Tensor* z) {
-    DivRangeFunctor<T> functor(x->data<T>(), y->data<T>(), z->data<T>());
     auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
-    platform::ForRange<platform::CUDADeviceContext> for_range(dev_ctx,
-                                                              x->numel());
-    for_range(functor);
+    LaunchSameDimsElemwiseCUDAKernel(dev_ctx.stream(), x->data<T>(),
+                                     y->data<T>(), z->data<T>(), x->numel(),
+                                     DivFunctor<T>());
   }
 };
 
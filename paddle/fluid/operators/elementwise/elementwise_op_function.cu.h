@@ -15,6 +15,8 @@ limitations under the License. */
 #pragma once
 
 #include <glog/logging.h>
+#include <algorithm>
+#include <cstdint>
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/float16.h"
 #include "paddle/fluid/platform/hostdevice.h"
@@ -24,6 +26,10 @@ limitations under the License. */
 #include <cuda.h>
 #endif  // PADDLE_WITH_CUDA
 
+#ifdef __NVCC__
+#include "paddle/fluid/platform/cuda_primitives.h"
+#endif
+
 #ifdef PADDLE_CUDA_FP16
 #include <cuda_fp16.h>
 #endif
@@ -68,37 +74,6 @@ struct DivFunctor<T,
   }
 };
 
-#define DEFINE_SIMPLE_CUDA_BINARY_FUNCTOR(Func, expr)                         \
-  template <typename T, class Enable = void>                                  \
-  struct Func##RangeFunctor {                                                 \
-    Func##RangeFunctor(const T* x, const T* y, T* z) : x_(x), y_(y), z_(z) {} \
-    inline HOSTDEVICE void operator()(size_t id) const {                      \
-      z_[id] = x_[id] expr y_[id];                                            \
-    }                                                                         \
-    const T* x_;                                                              \
-    const T* y_;                                                              \
-    T* z_;                                                                    \
-  };
-DEFINE_SIMPLE_CUDA_BINARY_FUNCTOR(Add, +)
-DEFINE_SIMPLE_CUDA_BINARY_FUNCTOR(Sub, -)
-DEFINE_SIMPLE_CUDA_BINARY_FUNCTOR(Mul, *)
-DEFINE_SIMPLE_CUDA_BINARY_FUNCTOR(Div, /)
-#undef DEFINE_SIMPLE_CUDA_BINARY_FUNCTOR
-
-// special div functor for int32/int64. check divison has a zero
-template <typename T>
-struct DivRangeFunctor<
-    T, typename std::enable_if<std::is_integral<T>::value>::type> {
-  DivRangeFunctor(const T* x, const T* y, T* z) : x_(x), y_(y), z_(z) {}
-  inline HOSTDEVICE void operator()(size_t id) const {
-    PADDLE_ENFORCE(y_[id] != 0, DIV_ERROR_INFO);
-    z_[id] = x_[id] / y_[id];
-  }
-  const T* x_;
-  const T* y_;
-  T* z_;
-};
-
 #ifdef PADDLE_CUDA_FP16
 inline DEVICE half2 half2_add(const half2& a, const half2& b) {
 #if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 530
@@ -191,5 +166,70 @@ DEFINE_SIMPLE_CUDA_BINARY_KERNEL(Div, /, half2_div)
 
 #endif  // PADDLE_CUDA_FP16
 
+#ifdef __NVCC__
+// Each thread computes z = func(x, y) of VecSize elements at once, the
+// pointers must be aligned to the size of the vector.
+template <typename Functor, typename T, typename OutType, int VecSize>
+__global__ void VectorizedElemwiseCUDAKernel(const T* x, const T* y,
+                                             OutType* z, int64_t size,
+                                             Functor func) {
+  using InVec = platform::AlignedVector<T, VecSize>;
+  using OutVec = platform::AlignedVector<OutType, VecSize>;
+  int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  int64_t stride = static_cast<int64_t>(blockDim.x) * gridDim.x;
+  int64_t num_vec = size / VecSize;
+  const InVec* x_vec = reinterpret_cast<const InVec*>(x);
+  const InVec* y_vec = reinterpret_cast<const InVec*>(y);
+  OutVec* z_vec = reinterpret_cast<OutVec*>(z);
+  for (int64_t i = idx; i < num_vec; i += stride) {
+    InVec x_val = x_vec[i];
+    InVec y_val = y_vec[i];
+    OutVec z_val;
+#pragma unroll
+    for (int j = 0; j < VecSize; ++j) {
+      z_val.val[j] = func(x_val.val[j], y_val.val[j]);
+    }
+    z_vec[i] = z_val;
+  }
+  for (int64_t i = num_vec * VecSize + idx; i < size; i += stride) {
+    z[i] = func(x[i], y[i]);
+  }
+}
+
+template <int VecSize>
+inline bool IsAlignedTo(const void* ptr, int elem_size) {
+  return reinterpret_cast<uintptr_t>(ptr) % (elem_size * VecSize) == 0;
+}
+
+// z = func(x, y) of the inputs of the same dims, with the 16 bytes loads,
+// i.e., float4 of float and 8 halfs of float16, if all the pointers are
+// aligned, otherwise one element per load.
+template <typename Functor, typename T, typename OutType = T>
+void LaunchSameDimsElemwiseCUDAKernel(cudaStream_t stream, const T* x,
+                                      const T* y, OutType* z, int64_t size,
+                                      Functor func) {
+  if (size == 0) return;
+  constexpr int kVecSize =
+      sizeof(T) >= 16 || sizeof(OutType) >= 16 ? 1 : 16 / sizeof(T);
+  bool aligned = IsAlignedTo<kVecSize>(x, sizeof(T)) &&
+                 IsAlignedTo<kVecSize>(y, sizeof(T)) &&
+                 IsAlignedTo<kVecSize>(z, sizeof(OutType));
+  int vec_size = aligned ? kVecSize : 1;
+  int64_t threads = (size + vec_size - 1) / vec_size;
+  int block_size = PADDLE_CUDA_THREAD_SIZE;
+  int grid_size = static_cast<int>(
+      std::min<int64_t>((threads + block_size - 1) / block_size, 1 << 30));
+  if (aligned) {
+    VectorizedElemwiseCUDAKernel<
+        Functor, T, OutType, kVecSize><<<grid_size, block_size, 0, stream>>>(
+        x, y, z, size, func);
+  } else {
+    VectorizedElemwiseCUDAKernel<Functor, T, OutType,
+                                 1><<<grid_size, block_size, 0, stream>>>(
+        x, y, z, size, func);
+  }
+}
+#endif  // __NVCC__
+
 }  // namespace operators
 }  // namespace paddle
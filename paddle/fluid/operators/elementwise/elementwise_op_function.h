@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/operators/elementwise/elementwise_op_function.cu.h"
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/transform.h"
 
@@ -194,11 +195,21 @@ void CommonForwardBroadcastCPU(const framework::Tensor *x,
 }
 
 #ifdef __NVCC__
+// The strides of the broadcast inputs, passed to the kernel by value instead
+// of the copies to the device memory of every launch.
+struct BroadcastStridesArray {
+  int x_strides[framework::DDim::kMaxRank];
+  int y_strides[framework::DDim::kMaxRank];
+  int out_dims[framework::DDim::kMaxRank];
+};
+
 template <typename Functor, typename T>
 __global__ void CommonForwardBroadcastCUDAKernel(
-    const int *x_strides_array, const int *y_strides_array,
-    const int *out_dims_array, const T *x, const T *y, T *out, int out_size,
-    int max_dim, Functor func, const bool is_xsize_larger) {
+    BroadcastStridesArray strides, const T *x, const T *y, T *out,
+    int out_size, int max_dim, Functor func, const bool is_xsize_larger) {
+  const int *x_strides_array = strides.x_strides;
+  const int *y_strides_array = strides.y_strides;
+  const int *out_dims_array = strides.out_dims;
   for (int out_index = blockIdx.x * blockDim.x + threadIdx.x;
        out_index < out_size; out_index += blockDim.x * gridDim.x) {
     int x_index = 0;
@@ -226,41 +237,26 @@ void CommonForwardBroadcastCUDA(
     framework::Tensor *z, int *x_dims_array, int *y_dims_array,
     int *out_dims_array, int max_dim, const platform::CUDADeviceContext &ctx,
     Functor func, const bool is_xsize_larger = true) {
-  const auto gplace = BOOST_GET_CONST(platform::CUDAPlace, ctx.GetPlace());
-  auto cplace = platform::CPUPlace();
   const T *x_data = x->data<T>();
   const T *y_data = y->data<T>();
   T *out_data = z->mutable_data<T>(ctx.GetPlace());
 
-  std::vector<int> x_strides_array(max_dim);
-  std::vector<int> y_strides_array(max_dim);
+  PADDLE_ENFORCE_LE(max_dim, framework::DDim::kMaxRank,
+                    platform::errors::InvalidArgument(
+                        "The rank of the broadcast should be at most %d, but "
+                        "received %d.",
+                        framework::DDim::kMaxRank, max_dim));
+  BroadcastStridesArray strides;
   int x_stride = 1;
   int y_stride = 1;
   for (int i = max_dim - 1; i >= 0; i--) {
-    x_strides_array[i] = x_dims_array[i] == 1 ? 0 : x_stride;
-    y_strides_array[i] = y_dims_array[i] == 1 ? 0 : y_stride;
+    strides.x_strides[i] = x_dims_array[i] == 1 ? 0 : x_stride;
+    strides.y_strides[i] = y_dims_array[i] == 1 ? 0 : y_stride;
+    strides.out_dims[i] = out_dims_array[i];
     x_stride *= x_dims_array[i];
     y_stride *= y_dims_array[i];
   }
 
-  int bytes = max_dim * sizeof(int);
-  auto x_strides_array_tmp = memory::Alloc(ctx, bytes);
-  int *x_strides_array_gpu =
-      reinterpret_cast<int *>(x_strides_array_tmp->ptr());
-  memory::Copy(gplace, x_strides_array_gpu, cplace, x_strides_array.data(),
-               bytes, ctx.stream());
-
-  auto y_strides_array_tmp = memory::Alloc(ctx, bytes);
-  int *y_strides_array_gpu =
-      reinterpret_cast<int *>(y_strides_array_tmp->ptr());
-  memory::Copy(gplace, y_strides_array_gpu, cplace, y_strides_array.data(),
-               bytes, ctx.stream());
-
-  auto out_dims_array_tmp = memory::Alloc(ctx, bytes);
-  int *out_dims_array_gpu = reinterpret_cast<int *>(out_dims_array_tmp->ptr());
-  memory::Copy(gplace, out_dims_array_gpu, cplace, out_dims_array, bytes,
-               ctx.stream());
-
   const int out_size = std::accumulate(out_dims_array, out_dims_array + max_dim,
                                        1, std::multiplies<int>());
   dim3 gird_size = dim3(
@@ -269,8 +265,8 @@ void CommonForwardBroadcastCUDA(
 
   CommonForwardBroadcastCUDAKernel<
       Functor, T><<<gird_size, block_size, 0, ctx.stream()>>>(
-      x_strides_array_gpu, y_strides_array_gpu, out_dims_array_gpu, x_data,
-      y_data, out_data, out_size, max_dim, func, is_xsize_larger);
+      strides, x_data, y_data, out_data, out_size, max_dim, func,
+      is_xsize_larger);
 }
 
 #endif  // __NVCC__
@@ -1345,6 +1341,27 @@ class MidWiseTransformIterator<T, platform::CUDADeviceContext>
 };
 #endif
 
+template <typename DeviceContext, typename Functor, typename T,
+          typename OutType>
+struct SameDimsElemwiseTransform {
+  void operator()(const DeviceContext &ctx, const T *x, const T *y,
+                  OutType *z, int64_t size, Functor func) const {
+    platform::Transform<DeviceContext> trans;
+    trans(ctx, x, x + size, y, z, func);
+  }
+};
+
+#ifdef __NVCC__
+template <typename Functor, typename T, typename OutType>
+struct SameDimsElemwiseTransform<platform::CUDADeviceContext, Functor, T,
+                                 OutType> {
+  void operator()(const platform::CUDADeviceContext &ctx, const T *x,
+                  const T *y, OutType *z, int64_t size, Functor func) const {
+    LaunchSameDimsElemwiseCUDAKernel(ctx.stream(), x, y, z, size, func);
+  }
+};
+#endif
+
 template <typename Functor, typename T, typename DeviceContext,
           typename OutType = T>
 class TransformFunctor {
@@ -1365,8 +1382,8 @@ class TransformFunctor {
   }
 
   inline void Run() const {
-    platform::Transform<DeviceContext> trans;
-    trans(ctx_, x_, x_ + nx_, y_, z_, func_);
+    SameDimsElemwiseTransform<DeviceContext, Functor, T, OutType>()(
+        ctx_, x_, y_, z_, nx_, func_);
   }
 
   inline void RunRowWise(int n, int pre) const {
@@ -1401,6 +1418,151 @@ class TransformFunctor {
   bool is_xsize_larger_;
 };
 
+// The CPU loops below run in parallel if the output is larger than this.
+constexpr int64_t kElemwiseParallelNumel = 1 << 16;
+
+/*
+ * The jit kernels computing func(big, small) of the float functors on the
+ * CPU, where big is the larger input and small the broadcast one. The rows
+ * run a XYZN kernel, and the contiguous post dims of the mid broadcast run
+ * a AXYN kernel with the broadcast element as the scalar.
+ */
+template <typename RowTuple, bool kSwapRow, typename MidTuple,
+          bool kNegativeMid, bool kHasMid = true>
+struct ElemwiseJitKernelImpl {
+  static constexpr bool kValid = true;
+  static constexpr bool kMidWise = kHasMid;
+
+  // the rows of big share the same small, pass 0 as the small_stride to
+  // broadcast it, or n for the inputs of the same dims
+  static void RowWise(const float *big, const float *small, float *z,
+                      int64_t pre, int n, int small_stride) {
+    auto func = jit::KernelFuncs<RowTuple, platform::CPUPlace>::Cache().At(n);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (pre * n > kElemwiseParallelNumel)
+#endif
+    for (int64_t i = 0; i < pre; ++i) {
+      const float *row = big + i * n;
+      const float *bcast = small + i * small_stride;
+      if (kSwapRow) {
+        func(bcast, row, z + i * n, n);
+      } else {
+        func(row, bcast, z + i * n, n);
+      }
+    }
+  }
+
+  static void MidWise(const float *big, const float *small, float *z,
+                      int64_t pre, int n, int post) {
+    auto func =
+        jit::KernelFuncs<MidTuple, platform::CPUPlace>::Cache().At(post);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (pre * n * post > kElemwiseParallelNumel)
+#endif
+    for (int64_t i = 0; i < pre * n; ++i) {
+      float scalar = kNegativeMid ? -small[i % n] : small[i % n];
+      func(&scalar, big + i * post, z + i * post, post);
+    }
+  }
+};
+
+template <typename Functor>
+struct ElemwiseJitKernel {
+  static constexpr bool kValid = false;
+};
+
+template <>
+struct ElemwiseJitKernel<AddFunctor<float>>
+    : public ElemwiseJitKernelImpl<jit::VAddTuple<float>, false,
+                                   jit::VAddBiasTuple<float>, false> {};
+
+template <>
+struct ElemwiseJitKernel<InverseAddFunctor<float>>
+    : public ElemwiseJitKernelImpl<jit::VAddTuple<float>, false,
+                                   jit::VAddBiasTuple<float>, false> {};
+
+template <>
+struct ElemwiseJitKernel<MulFunctor<float>>
+    : public ElemwiseJitKernelImpl<jit::VMulTuple<float>, false,
+                                   jit::VScalTuple<float>, false> {};
+
+template <>
+struct ElemwiseJitKernel<InverseMulFunctor<float>>
+    : public ElemwiseJitKernelImpl<jit::VMulTuple<float>, false,
+                                   jit::VScalTuple<float>, false> {};
+
+// big - small = big + (-small)
+template <>
+struct ElemwiseJitKernel<SubFunctor<float>>
+    : public ElemwiseJitKernelImpl<jit::VSubTuple<float>, false,
+                                   jit::VAddBiasTuple<float>, true> {};
+
+// small - big has no AXYN kernel, only the rows run the jit kernel
+template <>
+struct ElemwiseJitKernel<InverseSubFunctor<float>>
+    : public ElemwiseJitKernelImpl<jit::VSubTuple<float>, true,
+                                   jit::VAddBiasTuple<float>, false, false> {
+};
+
+// Return false if the functor has no jit kernel, to fall back to the
+// transform iterators.
+template <typename Functor, typename DeviceContext, typename T,
+          typename OutType, bool kValid = ElemwiseJitKernel<Functor>::kValid>
+struct ElemwiseJitCompute {
+  static bool SameDims(const framework::Tensor *x, const framework::Tensor *y,
+                       framework::Tensor *z) {
+    return false;
+  }
+  static bool Broadcast(const framework::Tensor *x, const framework::Tensor *y,
+                        framework::Tensor *z, int pre, int n, int post,
+                        bool is_xsize_larger) {
+    return false;
+  }
+};
+
+template <typename Functor>
+struct ElemwiseJitCompute<Functor, platform::CPUDeviceContext, float, float,
+                          true> {
+  using Kernel = ElemwiseJitKernel<Functor>;
+  // the inputs are split into the rows of this size to run in parallel
+  static constexpr int kBlockSize = 4096;
+
+  static bool SameDims(const framework::Tensor *x, const framework::Tensor *y,
+                       framework::Tensor *z) {
+    int64_t numel = x->numel();
+    const float *x_data = x->data<float>();
+    const float *y_data = y->data<float>();
+    float *z_data = z->mutable_data<float>(platform::CPUPlace());
+    int64_t pre = numel / kBlockSize;
+    int remain = numel % kBlockSize;
+    if (pre > 0) {
+      Kernel::RowWise(x_data, y_data, z_data, pre, kBlockSize, kBlockSize);
+    }
+    if (remain > 0) {
+      int64_t offset = pre * kBlockSize;
+      Kernel::RowWise(x_data + offset, y_data + offset, z_data + offset, 1,
+                      remain, 0);
+    }
+    return true;
+  }
+
+  static bool Broadcast(const framework::Tensor *x, const framework::Tensor *y,
+                        framework::Tensor *z, int pre, int n, int post,
+                        bool is_xsize_larger) {
+    if (static_cast<int64_t>(pre) * n * post == 0) return false;
+    if (post != 1 && !Kernel::kMidWise) return false;
+    const float *big = is_xsize_larger ? x->data<float>() : y->data<float>();
+    const float *small = is_xsize_larger ? y->data<float>() : x->data<float>();
+    float *z_data = z->mutable_data<float>(platform::CPUPlace());
+    if (post == 1) {
+      Kernel::RowWise(big, small, z_data, pre, n, 0);
+    } else {
+      Kernel::MidWise(big, small, z_data, pre, n, post);
+    }
+    return true;
+  }
+};
+
 template <typename T, typename DX_OP, typename DY_OP>
 struct ElemwiseGradNoBroadcast {
   const T *x_;
@@ -1423,43 +1585,55 @@ struct ElemwiseGradNoBroadcast {
   T *dy_;
 };
 
+// Each thread reduces the dy (or dx) of a block of columns, keeping the same
+// order of the sum as the serial loop.
 template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast1CPU(const T *x, const T *y, const T *out,
                                       const T *dout, int h, int w,
                                       bool is_xsize_larger, DX_OP dx_op,
                                       DY_OP dy_op, T *dx, T *dy) {
-  if (is_xsize_larger) {
-    for (int i = 0; i < h; ++i) {
-      for (int j = 0; j < w; ++j) {
-        int x_offset = i * w + j;
-        if (dx != nullptr) {
-          dx[x_offset] =
-              dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        }
-        if (dy != nullptr) {
-          T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-          if (i == 0) {
-            dy[j] = tmp;
-          } else {
-            dy[j] += tmp;
+  constexpr int kBlockSize = 64;
+  int num_blocks = (w + kBlockSize - 1) / kBlockSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (static_cast<int64_t>(h) * w > \
+                             kElemwiseParallelNumel)
+#endif
+  for (int b = 0; b < num_blocks; ++b) {
+    int begin = b * kBlockSize;
+    int end = std::min(begin + kBlockSize, w);
+    if (is_xsize_larger) {
+      for (int i = 0; i < h; ++i) {
+        for (int j = begin; j < end; ++j) {
+          int x_offset = i * w + j;
+          if (dx != nullptr) {
+            dx[x_offset] =
+                dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+          }
+          if (dy != nullptr) {
+            T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+            if (i == 0) {
+              dy[j] = tmp;
+            } else {
+              dy[j] += tmp;
+            }
           }
         }
       }
-    }
-  } else {  // x.dims < y.dims, broadcast for x.
-    for (int i = 0; i < h; ++i) {
-      for (int j = 0; j < w; ++j) {
-        int y_offset = i * w + j;
-        if (dy != nullptr) {
-          dy[y_offset] =
-              dy_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
-        }
-        if (dx != nullptr) {
-          T tmp = dx_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
-          if (i == 0) {
-            dx[j] = tmp;
-          } else {
-            dx[j] += tmp;
+    } else {  // x.dims < y.dims, broadcast for x.
+      for (int i = 0; i < h; ++i) {
+        for (int j = begin; j < end; ++j) {
+          int y_offset = i * w + j;
+          if (dy != nullptr) {
+            dy[y_offset] =
+                dy_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
+          }
+          if (dx != nullptr) {
+            T tmp = dx_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
+            if (i == 0) {
+              dx[j] = tmp;
+            } else {
+              dx[j] += tmp;
+            }
           }
         }
       }
@@ -1492,14 +1666,20 @@ static void ElemwiseGradBroadcast1CUDA(cudaStream_t stream, const T *x,
 
 #endif
 
+// Each thread reduces the dy (or dx) of a part of the n broadcast elements,
+// keeping the same order of the sum as the serial loop.
 template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast2CPU(const T *x, const T *y, const T *out,
                                       const T *dout, int pre, int n, int post,
                                       bool is_xsize_larger, DX_OP dx_op,
                                       DY_OP dy_op, T *dx, T *dy) {
-  if (is_xsize_larger) {
-    for (int i = 0; i < pre; ++i) {
-      for (int j = 0; j < n; ++j) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (static_cast<int64_t>(pre) * n * post > \
+                             kElemwiseParallelNumel)
+#endif
+  for (int j = 0; j < n; ++j) {
+    if (is_xsize_larger) {
+      for (int i = 0; i < pre; ++i) {
         for (int k = 0; k < post; ++k) {
           int x_offset = i * n * post + j * post + k;
           if (dx != nullptr) {
@@ -1516,10 +1696,8 @@ static void ElemwiseGradBroadcast2CPU(const T *x, const T *y, const T *out,
           }
         }
       }
-    }
-  } else {  // x.dims < y.dims, broadcast for x.
-    for (int i = 0; i < pre; ++i) {
-      for (int j = 0; j < n; ++j) {
+    } else {  // x.dims < y.dims, broadcast for x.
+      for (int i = 0; i < pre; ++i) {
         for (int k = 0; k < post; ++k) {
           int y_offset = i * n * post + j * post + k;
           if (dy != nullptr) {
@@ -1869,8 +2047,11 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
   TransformFunctor<Functor, T, DeviceContext, OutType> functor(
       x, y, z, ctx.template device_context<DeviceContext>(), func,
       is_xsize_larger);
+  using JitCompute = ElemwiseJitCompute<Functor, DeviceContext, T, OutType>;
   if (x_dims == y_dims) {
-    functor.Run();
+    if (!JitCompute::SameDims(x, y, z)) {
+      functor.Run();
+    }
     return;
   }
 
@@ -1905,6 +2086,9 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
         ctx, x, y, z, x_dims, y_dims, func, axis, is_xsize_larger);
     return;
   }
+  if (JitCompute::Broadcast(x, y, z, pre, n, post, is_xsize_larger)) {
+    return;
+  }
   if (post == 1) {
     functor.RunRowWise(n, pre);
     return;
@@ -106,8 +106,12 @@ class EltwiseAddMKLDNNGradKernel : public ElemwiseGradKernel<T> {
 
 namespace ops = paddle::operators;
 
+// The int8 inputs and output share one scale, see
+// CPUQuantizePass::QuantizeElementwiseAdd.
 REGISTER_OP_KERNEL(elementwise_add, MKLDNN, ::paddle::platform::CPUPlace,
-                   ops::EltwiseAddMKLDNNKernel<float>)
+                   ops::EltwiseAddMKLDNNKernel<float>,
+                   ops::EltwiseAddMKLDNNKernel<int8_t>,
+                   ops::EltwiseAddMKLDNNKernel<uint8_t>)
 
 REGISTER_OP_KERNEL(elementwise_add_grad, MKLDNN, ::paddle::platform::CPUPlace,
                    ops::EltwiseAddMKLDNNGradKernel<float>)
@@ -0,0 +1,204 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/mixed_vector.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * The gradient of the embedding is computed by sorting the ids and reducing
+ * the rows of each unique id in one pass, instead of an atomic add per
+ * element. The hot ids do not contend on the atomics, the result does not
+ * depend on the order of the atomics, and the sparse gradient has no
+ * duplicated rows.
+ */
+template <typename T, bool kDense, int BlockDimX, int BlockDimY>
+__global__ void SegmentedEmbeddingGrad(T *out, const T *d_output,
+                                       const int64_t *sorted_pos,
+                                       const int64_t *unique_ids,
+                                       const int64_t *offsets,
+                                       const int64_t *counts,
+                                       const int64_t *num_unique,
+                                       const int64_t N, const int64_t D) {
+  int idx = threadIdx.x;
+  int64_t idy = blockIdx.x * BlockDimY + threadIdx.y;
+  int64_t num = *num_unique;
+
+  while (idy < num) {
+    int64_t id = unique_ids[idy];
+    PADDLE_ENFORCE(
+        id >= 0,
+        "Variable value (input) of OP(fluid.layers.embedding) "
+        "expected >= 0 and < %ld, but got %ld. Please check input value.",
+        N, id);
+    PADDLE_ENFORCE(
+        id < N,
+        "Variable value (input) of OP(fluid.layers.embedding) "
+        "expected >= 0 and < %ld, but got %ld. Please check input value.",
+        N, id);
+    const int64_t *pos = sorted_pos + offsets[idy];
+    int64_t count = counts[idy];
+    T *row = out + (kDense ? id : idy) * D;
+    for (int i = idx; i < D; i += BlockDimX) {
+      T sum = static_cast<T>(0);
+      for (int64_t j = 0; j < count; ++j) {
+        sum += d_output[pos[j] * D + i];
+      }
+      row[i] = sum;
+    }
+    idy += BlockDimY * gridDim.x;
+  }
+}
+
+template <typename IndexT>
+__global__ void EmbeddingIdsIota(IndexT *pos, const IndexT K) {
+  IndexT i = blockIdx.x * static_cast<IndexT>(blockDim.x) + threadIdx.x;
+  if (i < K) pos[i] = i;
+}
+
+// The ids sorted with their positions, and the segments of the unique ids.
+class SortedEmbeddingIds {
+ public:
+  SortedEmbeddingIds(const platform::CUDADeviceContext &dev_ctx,
+                     const int64_t *ids, int64_t K, int64_t N)
+      : dev_ctx_(dev_ctx), K_(K) {
+    auto place = dev_ctx.GetPlace();
+    auto stream = dev_ctx.stream();
+    framework::Tensor pos_t, sorted_ids_t;
+    int64_t *pos = pos_t.mutable_data<int64_t>({K}, place);
+    int64_t *sorted_ids = sorted_ids_t.mutable_data<int64_t>({K}, place);
+    sorted_pos_ = sorted_pos_t_.mutable_data<int64_t>({K}, place);
+    unique_ids_ = unique_ids_t_.mutable_data<int64_t>({K}, place);
+    counts_ = counts_t_.mutable_data<int64_t>({K}, place);
+    offsets_ = offsets_t_.mutable_data<int64_t>({K}, place);
+    num_unique_ = num_unique_t_.mutable_data<int64_t>({1}, place);
+
+    EmbeddingIdsIota<<<(K + 511) / 512, 512, 0, stream>>>(pos, K);
+    // only the bits of the valid ids are sorted, the ids out of range are
+    // caught by SegmentedEmbeddingGrad
+    int end_bit = 1;
+    while (end_bit < 63 && (static_cast<int64_t>(1) << end_bit) < N) {
+      ++end_bit;
+    }
+    size_t sort_bytes = 0, encode_bytes = 0, scan_bytes = 0;
+    cub::DeviceRadixSort::SortPairs(nullptr, sort_bytes, ids, sorted_ids,
+                                    pos, sorted_pos_, K, 0, end_bit, stream);
+    cub::DeviceRunLengthEncode::Encode(nullptr, encode_bytes, sorted_ids,
+                                       unique_ids_, counts_, num_unique_, K,
+                                       stream);
+    cub::DeviceScan::ExclusiveSum(nullptr, scan_bytes, counts_, offsets_, K,
+                                  stream);
+    auto temp = memory::Alloc(
+        dev_ctx, std::max(sort_bytes, std::max(encode_bytes, scan_bytes)));
+    cub::DeviceRadixSort::SortPairs(temp->ptr(), sort_bytes, ids, sorted_ids,
+                                    pos, sorted_pos_, K, 0, end_bit, stream);
+    cub::DeviceRunLengthEncode::Encode(temp->ptr(), encode_bytes, sorted_ids,
+                                       unique_ids_, counts_, num_unique_, K,
+                                       stream);
+    cub::DeviceScan::ExclusiveSum(temp->ptr(), scan_bytes, counts_, offsets_,
+                                  K, stream);
+  }
+
+  const int64_t *unique_ids() const { return unique_ids_; }
+
+  // Copies the number of the unique ids to the host, and waits for the
+  // stream.
+  int64_t NumUnique() const {
+    int64_t num = 0;
+    memory::Copy(platform::CPUPlace(), &num,
+                 BOOST_GET_CONST(platform::CUDAPlace, dev_ctx_.GetPlace()),
+                 num_unique_, sizeof(int64_t), dev_ctx_.stream());
+    dev_ctx_.Wait();
+    return num;
+  }
+
+  // Row id of out is the id if kDense, or the index of the unique id.
+  template <typename T, bool kDense>
+  void Reduce(const T *d_output, int64_t N, int64_t D, T *out) const {
+    constexpr int kBlockDimX = 128;
+    constexpr int kBlockDimY = 8;
+    constexpr int64_t kMaxGridDimX = 4096;
+    dim3 threads(kBlockDimX, kBlockDimY);
+    dim3 grids(std::max<int64_t>(
+        1, std::min((K_ + kBlockDimY - 1) / kBlockDimY, kMaxGridDimX)));
+    auto stream = dev_ctx_.stream();
+    SegmentedEmbeddingGrad<T, kDense, kBlockDimX,
+                           kBlockDimY><<<grids, threads, 0, stream>>>(
+        out, d_output, sorted_pos_, unique_ids_, offsets_, counts_,
+        num_unique_, N, D);
+  }
+
+ private:
+  const platform::CUDADeviceContext &dev_ctx_;
+  int64_t K_;
+  framework::Tensor sorted_pos_t_, unique_ids_t_, counts_t_, offsets_t_,
+      num_unique_t_;
+  int64_t *sorted_pos_;
+  int64_t *unique_ids_;
+  int64_t *counts_;
+  int64_t *offsets_;
+  int64_t *num_unique_;
+};
+
+// d_table of [N, D] is overwritten, the rows of the ids not in ids are zero.
+template <typename T>
+void EmbeddingDenseGrad(const platform::CUDADeviceContext &dev_ctx,
+                        const int64_t *ids, int64_t K, const T *d_output,
+                        int64_t N, int64_t D, T *d_table) {
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaMemsetAsync(d_table, 0, N * D * sizeof(T), dev_ctx.stream()));
+  if (K == 0) return;
+  SortedEmbeddingIds sorted(dev_ctx, ids, K, N);
+  sorted.Reduce<T, true>(d_output, N, D, d_table);
+}
+
+// d_table gets one row per unique id, in the ascending order of the ids.
+template <typename T>
+void EmbeddingSparseGrad(const platform::CUDADeviceContext &dev_ctx,
+                         const int64_t *ids, int64_t K, const T *d_output,
+                         int64_t N, int64_t D,
+                         framework::SelectedRows *d_table) {
+  auto place = dev_ctx.GetPlace();
+  auto gpu_place = BOOST_GET_CONST(platform::CUDAPlace, place);
+  auto *d_table_value = d_table->mutable_value();
+  if (K == 0) {
+    d_table->set_rows(framework::Vector<int64_t>());
+    d_table_value->mutable_data<T>({0, D}, place);
+    return;
+  }
+  SortedEmbeddingIds sorted(dev_ctx, ids, K, N);
+  int64_t num_unique = sorted.NumUnique();
+
+  framework::Vector<int64_t> new_rows;
+  new_rows.resize(num_unique);
+  memory::Copy(gpu_place, new_rows.CUDAMutableData(place), gpu_place,
+               sorted.unique_ids(), num_unique * sizeof(int64_t),
+               dev_ctx.stream());
+  d_table->set_rows(new_rows);
+  T *value = d_table_value->mutable_data<T>({num_unique, D}, place);
+  sorted.Reduce<T, false>(d_output, N, D, value);
+}
+
+}  // namespace operators
+}  // namespace paddle
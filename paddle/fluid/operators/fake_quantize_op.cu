@@ -292,6 +292,39 @@ struct FindRangeAbsMaxFunctor<platform::CUDADeviceContext, T> {
 
 template struct FindRangeAbsMaxFunctor<platform::CUDADeviceContext, float>;
 
+// Reduces the abs max of the n block maxs and updates the moving average
+// scale state with it, in one block. The state may be updated in place.
+template <typename T>
+__global__ void MovingAverageAbsMaxKernel(const T* block_maxs, const int n,
+                                          const T* in_accum,
+                                          const T* in_state, const float rate,
+                                          T* out_state, T* out_accum,
+                                          T* out_scale) {
+  int tid = threadIdx.x;
+  extern __shared__ T shared_max_data[];
+  shared_max_data[tid] = T(0);
+  for (int i = tid; i < n; i += blockDim.x) {
+    T tmp = fabs(block_maxs[i]);
+    if (tmp > shared_max_data[tid]) {
+      shared_max_data[tid] = tmp;
+    }
+  }
+  __syncthreads();
+  for (int i = blockDim.x / 2; i > 0; i >>= 1) {
+    if (tid < i && (shared_max_data[tid] < shared_max_data[tid + i])) {
+      shared_max_data[tid] = shared_max_data[tid + i];
+    }
+    __syncthreads();
+  }
+  if (tid == 0) {
+    T state = rate * in_state[0] + 1;
+    T accum = rate * in_accum[0] + shared_max_data[0];
+    out_state[0] = state;
+    out_accum[0] = accum;
+    out_scale[0] = accum / state;
+  }
+}
+
 template <typename T>
 struct FindMovingAverageAbsMaxFunctor<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext& ctx,
@@ -299,35 +332,45 @@ struct FindMovingAverageAbsMaxFunctor<platform::CUDADeviceContext, T> {
                   const framework::Tensor& in_state, const T* cur_scale,
                   const float rate, framework::Tensor* out_state,
                   framework::Tensor* out_accum, framework::Tensor* out_scale) {
-    const auto gpu_place = BOOST_GET_CONST(platform::CUDAPlace, ctx.GetPlace());
-
-    T accum;
-    T state;
-    T scale;
-    memory::Copy(platform::CPUPlace(), &accum, gpu_place, in_accum.data<T>(),
-                 sizeof(T), ctx.stream());
-    memory::Copy(platform::CPUPlace(), &state, gpu_place, in_state.data<T>(),
-                 sizeof(T), ctx.stream());
-    memory::Copy(platform::CPUPlace(), &scale, gpu_place, cur_scale, sizeof(T),
-                 ctx.stream());
-    ctx.Wait();
-    state = rate * state + 1;
-    accum = rate * accum + scale;
-    scale = accum / state;
-
-    memory::Copy(gpu_place, out_accum->mutable_data<T>(gpu_place),
-                 platform::CPUPlace(), &accum, sizeof(T), ctx.stream());
-    memory::Copy(gpu_place, out_state->mutable_data<T>(gpu_place),
-                 platform::CPUPlace(), &state, sizeof(T), ctx.stream());
-    memory::Copy(gpu_place, out_scale->mutable_data<T>(gpu_place),
-                 platform::CPUPlace(), &scale, sizeof(T), ctx.stream());
-    ctx.Wait();
+    int block = 32;
+    MovingAverageAbsMaxKernel<T><<<1, block, block * sizeof(T), ctx.stream()>>>(
+        cur_scale, 1, in_accum.data<T>(), in_state.data<T>(), rate,
+        out_state->mutable_data<T>(ctx.GetPlace()),
+        out_accum->mutable_data<T>(ctx.GetPlace()),
+        out_scale->mutable_data<T>(ctx.GetPlace()));
   }
 };
 
 template struct FindMovingAverageAbsMaxFunctor<platform::CUDADeviceContext,
                                                float>;
 
+// The abs max takes two stages of reduction and the scale state is updated
+// in the second one, with no copy to the host.
+template <typename T>
+struct FindAbsMaxAndMovingAverageFunctor<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& ctx, const T* in,
+                  const int num, const framework::Tensor& in_accum,
+                  const framework::Tensor& in_state, const float rate,
+                  framework::Tensor* out_state, framework::Tensor* out_accum,
+                  framework::Tensor* out_scale) {
+    int block = 1024;
+    int grid = (block - 1 + num) / block;
+    grid = (grid > block) ? block : grid;
+    grid = (grid > 0) ? grid : 1;
+
+    framework::Tensor max;
+    T* max_data =
+        max.mutable_data<T>(framework::make_ddim({grid}), ctx.GetPlace());
+    FindAbsMaxKernel<T><<<grid, block, 1024 * sizeof(T), ctx.stream()>>>(
+        in, num, max_data);
+    MovingAverageAbsMaxKernel<T><<<1, block, 1024 * sizeof(T), ctx.stream()>>>(
+        max_data, grid, in_accum.data<T>(), in_state.data<T>(), rate,
+        out_state->mutable_data<T>(ctx.GetPlace()),
+        out_accum->mutable_data<T>(ctx.GetPlace()),
+        out_scale->mutable_data<T>(ctx.GetPlace()));
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -347,3 +390,5 @@ REGISTER_OP_CUDA_KERNEL(moving_average_abs_max_scale,
 REGISTER_OP_CUDA_KERNEL(
     fake_quantize_dequantize_moving_average_abs_max,
     ops::FakeQuantizeDequantizeMovingAverageAbsMaxKernel<CUDA, float>);
+REGISTER_OP_CUDA_KERNEL(fake_quantize_dequantize_grad,
+                        ops::FakeQuantDequantGradKernel<CUDA, float>);
@@ -74,10 +74,28 @@ struct ChannelClipAndFakeQuantFunctor {
 template <typename DeviceContext, typename T>
 struct FindMovingAverageAbsMaxFunctor {
   void operator()(const DeviceContext& ctx, const framework::Tensor& in_accum,
-                  const framework::Tensor& in_state,
-                  const framework::Tensor& cur_scale,
+                  const framework::Tensor& in_state, const T* cur_scale,
+                  const float rate, framework::Tensor* out_state,
+                  framework::Tensor* out_accum, framework::Tensor* out_scale);
+};
+
+// Finds the abs max of in and updates the moving average scale state with
+// it. The CUDA specialization does the update in the last stage of the
+// reduction, so the state never leaves the device.
+template <typename DeviceContext, typename T>
+struct FindAbsMaxAndMovingAverageFunctor {
+  void operator()(const DeviceContext& ctx, const T* in, const int num,
+                  const framework::Tensor& in_accum,
+                  const framework::Tensor& in_state, const float rate,
                   framework::Tensor* out_state, framework::Tensor* out_accum,
-                  framework::Tensor* out_scale);
+                  framework::Tensor* out_scale) {
+    auto cur_scale = memory::Alloc(ctx, sizeof(T));
+    T* cur_scale_data = static_cast<T*>(cur_scale->ptr());
+    FindAbsMaxFunctor<DeviceContext, T>()(ctx, in, num, cur_scale_data);
+    FindMovingAverageAbsMaxFunctor<DeviceContext, T>()(
+        ctx, in_accum, in_state, cur_scale_data, rate, out_state, out_accum,
+        out_scale);
+  }
 };
 
 template <typename DeviceContext, typename T>
@@ -192,12 +210,6 @@ class FakeMovingAverageAbsMaxKernelBase : public framework::OpKernel<T> {
     // training
     auto* in_accum = context.Input<framework::Tensor>("InAccum");
     auto* in_state = context.Input<framework::Tensor>("InState");
-    auto cur_scale = memory::Alloc(dev_ctx, sizeof(T));
-    T* cur_scale_data = static_cast<T*>(cur_scale->ptr());
-
-    FindAbsMaxFunctor<DeviceContext, T>()(dev_ctx, in->data<T>(), in->numel(),
-                                          cur_scale_data);
-
     auto* out_state = context.Output<framework::Tensor>("OutState");
     auto* out_accum = context.Output<framework::Tensor>("OutAccum");
     auto* out_scale = context.Output<framework::Tensor>("OutScale");
@@ -206,9 +218,9 @@ class FakeMovingAverageAbsMaxKernelBase : public framework::OpKernel<T> {
     out_scale->mutable_data<T>(context.GetPlace());
     float moving_rate = context.Attr<float>("moving_rate");
 
-    FindMovingAverageAbsMaxFunctor<DeviceContext, T>()(
-        dev_ctx, *in_accum, *in_state, cur_scale_data, moving_rate, out_state,
-        out_accum, out_scale);
+    FindAbsMaxAndMovingAverageFunctor<DeviceContext, T>()(
+        dev_ctx, in->data<T>(), in->numel(), *in_accum, *in_state, moving_rate,
+        out_state, out_accum, out_scale);
 
     RunClipFunctor(dev_ctx, *in, *out_scale, bin_cnt, out);
   }
@@ -238,6 +250,21 @@ class FakeQuantizeDequantizeMovingAverageAbsMaxKernel
   }
 };
 
+// The gradient of the fake quantize-dequantize ops is estimated as straight
+// through, i.e. the rounding is ignored in the backward.
+template <typename DeviceContext, typename T>
+class FakeQuantDequantGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* d_out =
+        context.Input<framework::Tensor>(framework::GradVarName("Out"));
+    auto* d_x = context.Output<framework::Tensor>(framework::GradVarName("X"));
+    d_x->mutable_data<T>(context.GetPlace());
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    framework::TensorCopy(*d_out, context.GetPlace(), dev_ctx, d_x);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class MovingAverageAbsMaxScaleKernel : public framework::OpKernel<T> {
  public:
@@ -257,12 +284,6 @@ class MovingAverageAbsMaxScaleKernel : public framework::OpKernel<T> {
     // training
     auto* in_accum = context.Input<framework::Tensor>("InAccum");
     auto* in_state = context.Input<framework::Tensor>("InState");
-    auto cur_scale = memory::Alloc(dev_ctx, sizeof(T));
-    T* cur_scale_data = static_cast<T*>(cur_scale->ptr());
-
-    FindAbsMaxFunctor<DeviceContext, T>()(dev_ctx, in->data<T>(), in->numel(),
-                                          cur_scale_data);
-
     auto* out_state = context.Output<framework::Tensor>("OutState");
     auto* out_accum = context.Output<framework::Tensor>("OutAccum");
     auto* out_scale = context.Output<framework::Tensor>("OutScale");
@@ -271,9 +292,9 @@ class MovingAverageAbsMaxScaleKernel : public framework::OpKernel<T> {
     out_scale->mutable_data<T>(context.GetPlace());
     float moving_rate = context.Attr<float>("moving_rate");
 
-    FindMovingAverageAbsMaxFunctor<DeviceContext, T>()(
-        dev_ctx, *in_accum, *in_state, cur_scale_data, moving_rate, out_state,
-        out_accum, out_scale);
+    FindAbsMaxAndMovingAverageFunctor<DeviceContext, T>()(
+        dev_ctx, in->data<T>(), in->numel(), *in_accum, *in_state, moving_rate,
+        out_state, out_accum, out_scale);
   }
 };
 
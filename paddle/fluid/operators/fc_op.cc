@@ -139,6 +139,12 @@ class FCOpMaker : public framework::OpProtoAndCheckerMaker {
         "(bool, default false) When padding weights in the fc fuse pass, "
         "the 'padding_weights' attribute is set as true.")
         .SetDefault(false);
+    AddAttr<bool>(
+        "use_packed_weights",
+        "(bool, default false) Whether to pack the weights by MKL once and "
+        "reuse them for all the runs, only used on CPU. It is set in the fc "
+        "fuse pass, where the weights are persistable.")
+        .SetDefault(false);
     AddAttr<bool>(framework::kAllKernelsMustComputeRuntimeShape,
                   "Skip calling InferShape() function in the runtime.")
         .SetDefault(true);
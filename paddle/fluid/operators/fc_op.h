@@ -18,6 +18,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/packed_weights_cache.h"
 
 namespace paddle {
 namespace operators {
@@ -75,10 +76,18 @@ class FCOpKernel : public framework::OpKernel<T> {
     const T* w_data = w->data<T>();
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
 
+    // the persistable weights are packed once by MKL for all the runs
+    const T* packed_w_data = nullptr;
+    if (platform::is_cpu_place(ctx.GetPlace()) && !padding_weights &&
+        ctx.Attr<bool>("use_packed_weights")) {
+      packed_w_data = math::PackedWeightsCache<T>::Instance().Get(*w);
+    }
+
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     math::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims1, w_dims0, input_data, w_data, output_data,
-       bias ? bias->data<T>() : NULL, with_relu, padding_weights);
+       bias ? bias->data<T>() : NULL, with_relu, padding_weights,
+       packed_w_data);
   }
 };
 
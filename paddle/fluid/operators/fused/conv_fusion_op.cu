@@ -247,8 +247,9 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
                                        search_func);
       } else {
         auto dtype = platform::CudnnDataType<T>::type;
-        algo = algo_cache.GetAlgorithm(x_dims, f_dims, strides, paddings,
-                                       dilations, 0, dtype, search_func);
+        algo = algo_cache.GetAlgorithm(
+            x_dims, f_dims, strides, paddings, dilations, 0, dtype,
+            static_cast<int64_t>(layout), workspace_size_limit, search_func);
       }
       VLOG(3) << "choose algo " << algo;
     }
@@ -207,174 +207,171 @@ static void RunUnaryCompoundGradFunctors(
   }
 }
 
+// Z = Unary(Binary(X, Y)) or Z = Binary(X, Unary(Y)), according to the order
+// of the functor list.
+template <typename DeviceContext, typename T, typename BinaryFunctor,
+          typename UnaryFunctor>
+static void RunCompoundFunctors(const framework::ExecutionContext &ctx,
+                                const BinaryFunctor &binary_functor,
+                                const UnaryFunctor &unary_functor,
+                                const framework::Tensor &in_x,
+                                const framework::Tensor &in_y,
+                                std::vector<framework::Tensor *> *outputs) {
+  if (IsUnaryCompound(ctx.Attr<std::vector<std::string>>("functor_list"))) {
+    RunUnaryCompoundFunctors<DeviceContext, T, UnaryFunctor, BinaryFunctor>(
+        ctx, unary_functor, binary_functor, in_x, in_y, outputs);
+  } else {
+    RunBinaryCompoundFunctor<DeviceContext, T, BinaryFunctor, UnaryFunctor>(
+        ctx, binary_functor, unary_functor, in_x, in_y, outputs);
+  }
+}
+
+template <typename DeviceContext, typename T, typename BinaryFunctor>
+static void RunCompoundFunctorsWithBinary(
+    const framework::ExecutionContext &ctx, const std::string &unary,
+    const BinaryFunctor &binary_functor, const framework::Tensor &in_x,
+    const framework::Tensor &in_y, std::vector<framework::Tensor *> *outputs) {
+  if (unary == "scale") {
+    T scale = static_cast<T>(ctx.Attr<float>("scale"));
+    RunCompoundFunctors<DeviceContext, T>(
+        ctx, binary_functor, paddle::operators::math::ScaleFunctor<T>(scale),
+        in_x, in_y, outputs);
+  } else if (unary == "relu") {
+    RunCompoundFunctors<DeviceContext, T>(
+        ctx, binary_functor, paddle::operators::math::ReluFunctor<T>(), in_x,
+        in_y, outputs);
+  } else if (unary == "tanh") {
+    RunCompoundFunctors<DeviceContext, T>(
+        ctx, binary_functor, paddle::operators::math::TanhFunctor<T>(), in_x,
+        in_y, outputs);
+  } else if (unary == "sigmoid") {
+    RunCompoundFunctors<DeviceContext, T>(
+        ctx, binary_functor, paddle::operators::math::SigmoidFunctor<T>(), in_x,
+        in_y, outputs);
+  } else {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The unary functor %s has not been implemented.", unary));
+  }
+}
+
 template <typename DeviceContext, typename T>
 static void RunFunctors(const framework::ExecutionContext &ctx,
                         const framework::Tensor &in_x,
                         const framework::Tensor &in_y,
                         std::vector<framework::Tensor *> *outputs) {
   auto &functors = ctx.Attr<std::vector<std::string>>("functor_list");
-
-  // TODO(zcd): The following code can be refined.
-  auto funcs_str = functors[0] + "," + functors[1];
-  if (funcs_str == "elementwise_add,scale") {
-    // Z = Binary(X, Unary(Y))
-    T scale = static_cast<T>(ctx.Attr<float>("scale"));
-    RunBinaryCompoundFunctor<DeviceContext, T,
-                             paddle::operators::math::AddFunctor<T>,
-                             paddle::operators::math::ScaleFunctor<T>>(
-        ctx, paddle::operators::math::AddFunctor<T>(),
-        paddle::operators::math::ScaleFunctor<T>(scale), in_x, in_y, outputs);
-  } else if (funcs_str == "scale,elementwise_add") {
-    // Z = Unary(Binary(X, Y))
-    T scale = static_cast<T>(ctx.Attr<float>("scale"));
-    RunUnaryCompoundFunctors<DeviceContext, T,
-                             paddle::operators::math::ScaleFunctor<T>,
-                             paddle::operators::math::AddFunctor<T>>(
-        ctx, paddle::operators::math::ScaleFunctor<T>(scale),
-        paddle::operators::math::AddFunctor<T>(), in_x, in_y, outputs);
-  } else if (funcs_str == "elementwise_add,relu") {
-    // Z = Binary(X, Unary(Y))
-    RunBinaryCompoundFunctor<DeviceContext, T,
-                             paddle::operators::math::AddFunctor<T>,
-                             paddle::operators::math::ReluFunctor<T>>(
-        ctx, paddle::operators::math::AddFunctor<T>(),
-        paddle::operators::math::ReluFunctor<T>(), in_x, in_y, outputs);
-  } else if (funcs_str == "relu,elementwise_add") {
-    // Z = Unary(Binary(X, Y))
-    RunUnaryCompoundFunctors<DeviceContext, T,
-                             paddle::operators::math::ReluFunctor<T>,
-                             paddle::operators::math::AddFunctor<T>>(
-        ctx, paddle::operators::math::ReluFunctor<T>(),
-        paddle::operators::math::AddFunctor<T>(), in_x, in_y, outputs);
-  } else if (funcs_str == "elementwise_mul,scale") {
-    // Z = Binary(X, Unary(Y))
-    T scale = static_cast<T>(ctx.Attr<float>("scale"));
-    RunBinaryCompoundFunctor<DeviceContext, T,
-                             paddle::operators::math::MulFunctor<T>,
-                             paddle::operators::math::ScaleFunctor<T>>(
-        ctx, paddle::operators::math::MulFunctor<T>(),
-        paddle::operators::math::ScaleFunctor<T>(scale), in_x, in_y, outputs);
-  } else if (funcs_str == "tanh,elementwise_add") {
-    // Z = Unary(Binary(X, Y))
-    RunUnaryCompoundFunctors<DeviceContext, T,
-                             paddle::operators::math::TanhFunctor<T>,
-                             paddle::operators::math::AddFunctor<T>>(
-        ctx, paddle::operators::math::TanhFunctor<T>(),
-        paddle::operators::math::AddFunctor<T>(), in_x, in_y, outputs);
-  } else if (funcs_str == "elementwise_mul,tanh") {
-    // Z = Binary(X, Unary(Y))
-    RunBinaryCompoundFunctor<DeviceContext, T,
-                             paddle::operators::math::MulFunctor<T>,
-                             paddle::operators::math::TanhFunctor<T>>(
-        ctx, paddle::operators::math::MulFunctor<T>(),
-        paddle::operators::math::TanhFunctor<T>(), in_x, in_y, outputs);
-  } else if (funcs_str == "elementwise_mul,sigmoid") {
-    // Z = Binary(X, Unary(Y))
-    RunBinaryCompoundFunctor<DeviceContext, T,
-                             paddle::operators::math::MulFunctor<T>,
-                             paddle::operators::math::SigmoidFunctor<T>>(
-        ctx, paddle::operators::math::MulFunctor<T>(),
-        paddle::operators::math::SigmoidFunctor<T>(), in_x, in_y, outputs);
+  bool is_unary_compound = IsUnaryCompound(functors);
+  auto &binary = functors[is_unary_compound ? 1 : 0];
+  auto &unary = functors[is_unary_compound ? 0 : 1];
+
+  if (binary == "elementwise_add") {
+    RunCompoundFunctorsWithBinary<DeviceContext, T>(
+        ctx, unary, paddle::operators::math::AddFunctor<T>(), in_x, in_y,
+        outputs);
+  } else if (binary == "elementwise_mul") {
+    RunCompoundFunctorsWithBinary<DeviceContext, T>(
+        ctx, unary, paddle::operators::math::MulFunctor<T>(), in_x, in_y,
+        outputs);
   } else {
-    PADDLE_THROW("%s has not been implemented.", funcs_str);
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The binary functor %s has not been implemented.", binary));
   }
 }
 
-template <typename DeviceContext, typename T, bool InPlace>
-static void RunGradFunctors(
-    const framework::ExecutionContext &ctx, const framework::Tensor *in_x,
+// The backward of Z = Unary(Binary(X, Y)) or Z = Binary(X, Unary(Y)).
+template <typename DeviceContext, typename T, bool InPlace,
+          typename BinaryFunctor, typename BinaryGradFunctor,
+          typename UnaryFunctor, typename UnaryGradFunctor>
+static void RunCompoundGradFunctors(
+    const framework::ExecutionContext &ctx, const BinaryFunctor &binary_functor,
+    const BinaryGradFunctor &binary_grad_functor,
+    const UnaryFunctor &unary_functor,
+    const UnaryGradFunctor &unary_grad_functor, const framework::Tensor *in_x,
     const framework::Tensor *in_y, const framework::Tensor *in_out,
     const framework::Tensor *in_intermediate_out,
     const framework::Tensor *in_out_grad, framework::Tensor *x_grad,
     framework::Tensor *y_grad, framework::Tensor *d_intermediate_out) {
-  auto &functors = ctx.Attr<std::vector<std::string>>("functor_list");
-  auto funcs_str = functors[0] + "," + functors[1];
+  if (IsUnaryCompound(ctx.Attr<std::vector<std::string>>("functor_list"))) {
+    RunUnaryCompoundGradFunctors<DeviceContext, T, UnaryGradFunctor,
+                                 BinaryFunctor, BinaryGradFunctor, InPlace>(
+        ctx, unary_grad_functor, binary_functor, binary_grad_functor, in_x,
+        in_y, in_out, in_intermediate_out, in_out_grad, x_grad, y_grad,
+        d_intermediate_out);
+  } else {
+    RunBinaryCompoundGradFunctors<DeviceContext, T, BinaryGradFunctor,
+                                  UnaryFunctor, UnaryGradFunctor, InPlace>(
+        ctx, binary_grad_functor, unary_functor, unary_grad_functor, in_x,
+        in_y, in_out, in_intermediate_out, in_out_grad, x_grad, y_grad,
+        d_intermediate_out);
+  }
+}
 
-  if (funcs_str == "elementwise_add_grad,scale_grad") {
-    // The backward of Z = Binary(X, Unary(Y))
+template <typename DeviceContext, typename T, bool InPlace,
+          typename BinaryFunctor, typename BinaryGradFunctor>
+static void RunCompoundGradFunctorsWithBinary(
+    const framework::ExecutionContext &ctx, const std::string &unary_grad,
+    const BinaryFunctor &binary_functor,
+    const BinaryGradFunctor &binary_grad_functor, const framework::Tensor *in_x,
+    const framework::Tensor *in_y, const framework::Tensor *in_out,
+    const framework::Tensor *in_intermediate_out,
+    const framework::Tensor *in_out_grad, framework::Tensor *x_grad,
+    framework::Tensor *y_grad, framework::Tensor *d_intermediate_out) {
+  if (unary_grad == "scale_grad") {
     T scale = static_cast<T>(ctx.Attr<float>("scale"));
-    RunBinaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::AddGradFunctor<T>,
-        paddle::operators::math::ScaleFunctor<T>,
-        paddle::operators::math::ScaleGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::AddGradFunctor<T>(),
+    RunCompoundGradFunctors<DeviceContext, T, InPlace>(
+        ctx, binary_functor, binary_grad_functor,
         paddle::operators::math::ScaleFunctor<T>(scale),
         paddle::operators::math::ScaleGradFunctor<T>(scale), in_x, in_y, in_out,
         in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "scale_grad,elementwise_add_grad") {
-    // The backward of Z = Unary(Binary(X, Y))
-    T scale = static_cast<T>(ctx.Attr<float>("scale"));
-    RunUnaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::ScaleGradFunctor<T>,
-        paddle::operators::math::AddFunctor<T>,
-        paddle::operators::math::AddGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::ScaleGradFunctor<T>(scale),
-        paddle::operators::math::AddFunctor<T>(),
-        paddle::operators::math::AddGradFunctor<T>(), in_x, in_y, in_out,
-        in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "elementwise_add_grad,relu_grad") {
-    // The backward of Z = Binary(X, Unary(Y))
-    RunBinaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::AddGradFunctor<T>,
-        paddle::operators::math::ReluFunctor<T>,
-        paddle::operators::math::ReluGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::AddGradFunctor<T>(),
+  } else if (unary_grad == "relu_grad") {
+    RunCompoundGradFunctors<DeviceContext, T, InPlace>(
+        ctx, binary_functor, binary_grad_functor,
         paddle::operators::math::ReluFunctor<T>(),
         paddle::operators::math::ReluGradFunctor<T>(), in_x, in_y, in_out,
         in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "relu_grad,elementwise_add_grad") {
-    // The backward of Z = Unary(Binary(X, Y))
-    RunUnaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::ReluGradFunctor<T>,
-        paddle::operators::math::AddFunctor<T>,
-        paddle::operators::math::AddGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::ReluGradFunctor<T>(),
-        paddle::operators::math::AddFunctor<T>(),
-        paddle::operators::math::AddGradFunctor<T>(), in_x, in_y, in_out,
-        in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "elementwise_mul_grad,scale_grad") {
-    // The backward of Z = Binary(X, Unary(Y))
-    T scale = static_cast<T>(ctx.Attr<float>("scale"));
-    RunBinaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::MulGradFunctor<T>,
-        paddle::operators::math::ScaleFunctor<T>,
-        paddle::operators::math::ScaleGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::MulGradFunctor<T>(),
-        paddle::operators::math::ScaleFunctor<T>(scale),
-        paddle::operators::math::ScaleGradFunctor<T>(scale), in_x, in_y, in_out,
-        in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "tanh_grad,elementwise_add_grad") {
-    // The backward of Z = Unary(Binary(X, Y))
-    RunUnaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::TanhGradFunctor<T>,
-        paddle::operators::math::AddFunctor<T>,
-        paddle::operators::math::AddGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::TanhGradFunctor<T>(),
-        paddle::operators::math::AddFunctor<T>(),
-        paddle::operators::math::AddGradFunctor<T>(), in_x, in_y, in_out,
-        in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "elementwise_mul_grad,tanh_grad") {
-    // The backward of Z = Binary(X, Unary(Y))
-    RunBinaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::MulGradFunctor<T>,
-        paddle::operators::math::TanhFunctor<T>,
-        paddle::operators::math::TanhGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::MulGradFunctor<T>(),
+  } else if (unary_grad == "tanh_grad") {
+    RunCompoundGradFunctors<DeviceContext, T, InPlace>(
+        ctx, binary_functor, binary_grad_functor,
         paddle::operators::math::TanhFunctor<T>(),
         paddle::operators::math::TanhGradFunctor<T>(), in_x, in_y, in_out,
         in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
-  } else if (funcs_str == "elementwise_mul_grad,sigmoid_grad") {
-    // The backward of Z = Binary(X, Unary(Y))
-    RunBinaryCompoundGradFunctors<
-        DeviceContext, T, paddle::operators::math::MulGradFunctor<T>,
-        paddle::operators::math::SigmoidFunctor<T>,
-        paddle::operators::math::SigmoidGradFunctor<T>, InPlace>(
-        ctx, paddle::operators::math::MulGradFunctor<T>(),
+  } else if (unary_grad == "sigmoid_grad") {
+    RunCompoundGradFunctors<DeviceContext, T, InPlace>(
+        ctx, binary_functor, binary_grad_functor,
         paddle::operators::math::SigmoidFunctor<T>(),
         paddle::operators::math::SigmoidGradFunctor<T>(), in_x, in_y, in_out,
         in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
   } else {
-    PADDLE_THROW("%s has not been implemented.", funcs_str);
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The unary grad functor %s has not been implemented.", unary_grad));
+  }
+}
+
+template <typename DeviceContext, typename T, bool InPlace>
+static void RunGradFunctors(
+    const framework::ExecutionContext &ctx, const framework::Tensor *in_x,
+    const framework::Tensor *in_y, const framework::Tensor *in_out,
+    const framework::Tensor *in_intermediate_out,
+    const framework::Tensor *in_out_grad, framework::Tensor *x_grad,
+    framework::Tensor *y_grad, framework::Tensor *d_intermediate_out) {
+  auto &functors = ctx.Attr<std::vector<std::string>>("functor_list");
+  bool is_unary_compound = IsUnaryCompound(functors);
+  auto &binary_grad = functors[is_unary_compound ? 1 : 0];
+  auto &unary_grad = functors[is_unary_compound ? 0 : 1];
+
+  if (binary_grad == "elementwise_add_grad") {
+    RunCompoundGradFunctorsWithBinary<DeviceContext, T, InPlace>(
+        ctx, unary_grad, paddle::operators::math::AddFunctor<T>(),
+        paddle::operators::math::AddGradFunctor<T>(), in_x, in_y, in_out,
+        in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
+  } else if (binary_grad == "elementwise_mul_grad") {
+    RunCompoundGradFunctorsWithBinary<DeviceContext, T, InPlace>(
+        ctx, unary_grad, paddle::operators::math::MulFunctor<T>(),
+        paddle::operators::math::MulGradFunctor<T>(), in_x, in_y, in_out,
+        in_intermediate_out, in_out_grad, x_grad, y_grad, d_intermediate_out);
+  } else {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The binary grad functor %s has not been implemented.", binary_grad));
   }
 }
 
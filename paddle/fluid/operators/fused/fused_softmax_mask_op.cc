@@ -0,0 +1,100 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedSoftmaxMaskOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext *context) const override {
+    OP_INOUT_CHECK(context->HasInput("X"), "Input", "X", "FusedSoftmaxMask");
+    OP_INOUT_CHECK(context->HasInput("Mask"), "Input", "Mask",
+                   "FusedSoftmaxMask");
+    OP_INOUT_CHECK(context->HasOutput("Out"), "Output", "Out",
+                   "FusedSoftmaxMask");
+
+    auto dim_x = context->GetInputDim("X");
+    auto dim_mask = context->GetInputDim("Mask");
+    PADDLE_ENFORCE_EQ(
+        dim_x, dim_mask,
+        platform::errors::InvalidArgument(
+            "The shapes of Input(X) and Input(Mask) of FusedSoftmaxMask "
+            "should be the same, but received X's shape [%s], Mask's shape "
+            "[%s].",
+            dim_x, dim_mask));
+    context->SetOutputDim("Out", dim_x);
+    context->ShareLoD("X", /*->*/ "Out");
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
+};
+
+class FusedSoftmaxMaskOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "The input of the softmax, e.g., the attention scores.");
+    AddInput("Mask", "The mask added to the scaled X, in the same shape as X.");
+    AddOutput("Out", "The softmax of the last axis, in the same shape as X.");
+    AddAttr<float>("scale", "The scale of X before adding the mask.")
+        .SetDefault(1.0f);
+    AddComment(R"DOC(
+FusedSoftmaxMask Operator.
+
+Out = softmax(X * scale + Mask) along the last axis, which is the masked
+softmax of the attentions. Every row is scaled, masked and normalized while it
+is still in the cache, it is fused by the softmax_mask_fuse_pass.
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedSoftmaxMaskCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *x = context.Input<framework::Tensor>("X");
+    auto *mask = context.Input<framework::Tensor>("Mask");
+    auto *out = context.Output<framework::Tensor>("Out");
+    float scale = context.Attr<float>("scale");
+
+    auto dims = x->dims();
+    int n = static_cast<int>(dims[dims.size() - 1]);
+    int bs = static_cast<int>(x->numel() / n);
+    auto compute = jit::KernelFuncs<jit::MaskedSoftmaxTuple<T>,
+                                    platform::CPUPlace>::Cache()
+                       .At(n);
+    compute(x->data<T>(), mask->data<T>(),
+            out->mutable_data<T>(context.GetPlace()), scale, n, bs);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_softmax_mask, ops::FusedSoftmaxMaskOp,
+                             ops::FusedSoftmaxMaskOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_softmax_mask,
+                       ops::FusedSoftmaxMaskCPUKernel<float>,
+                       ops::FusedSoftmaxMaskCPUKernel<double>);
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fused/fusion_group_op.h"
+#include <algorithm>
 
 namespace paddle {
 namespace operators {
@@ -35,9 +36,11 @@ class FusionGroupOp : public framework::OperatorWithKernel {
             "Expected the number of outputs >= 1. Recived %d.", num_outs));
 
     int type = ctx->Attrs().Get<int>("type");
-    PADDLE_ENFORCE_EQ(type, 0UL,
+    PADDLE_ENFORCE_EQ(type == 0 || type == 1, true,
                       platform::errors::InvalidArgument(
-                          "Only support fusion of elementwise operations."));
+                          "Only support fusion of elementwise and rowwise "
+                          "operations. Received type %d.",
+                          type));
 
     std::vector<framework::DDim> x_dims = ctx->GetInputsDim("Inputs");
     if (type == 0) {
@@ -51,6 +54,33 @@ class FusionGroupOp : public framework::OperatorWithKernel {
         out_dims.push_back(x_dims[0]);
       }
       ctx->SetOutputsDim("Outs", out_dims);
+    } else if (type == 1) {
+      auto inputs_layout =
+          ctx->Attrs().Get<std::vector<int>>("inputs_layout");
+      auto outs_layout = ctx->Attrs().Get<std::vector<int>>("outs_layout");
+      PADDLE_ENFORCE_EQ(
+          inputs_layout.size() == num_ins && outs_layout.size() == num_outs,
+          true, platform::errors::InvalidArgument(
+                    "The layouts should be set for all the inputs and "
+                    "outputs of the rowwise fusion_group op."));
+      auto iter = std::find(inputs_layout.begin(), inputs_layout.end(), 0);
+      PADDLE_ENFORCE_NE(
+          iter, inputs_layout.end(),
+          platform::errors::InvalidArgument(
+              "Expected an input of the full layout in the rowwise "
+              "fusion_group op."));
+      auto full_dims = x_dims[iter - inputs_layout.begin()];
+      std::vector<framework::DDim> out_dims;
+      for (size_t j = 0; j < num_outs; ++j) {
+        auto dims = framework::vectorize(full_dims);
+        if (outs_layout[j] == 1) {
+          dims.back() = 1;
+        } else if (outs_layout[j] == 2) {
+          dims.pop_back();
+        }
+        out_dims.push_back(framework::make_ddim(dims));
+      }
+      ctx->SetOutputsDim("Outs", out_dims);
     }
 
     // Only lod of Inputs[0] would be shared with Outs.
@@ -63,7 +93,7 @@ class FusionGroupOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(framework::proto::VarType::FP32,
-                                   platform::CUDAPlace(0));
+                                   ctx.GetPlace());
   };
 };
 
@@ -83,15 +113,28 @@ class FusionGroupOpMaker : public framework::OpProtoAndCheckerMaker {
         "inputs_data_type", "The data type of Inputs in fusion_group op.")
         .SetDefault({});
     AddAttr<int>("type", "Fusion type.").SetDefault(0);
+    AddAttr<std::vector<int>>(
+        "inputs_layout",
+        "The layouts of Inputs in the rowwise fusion_group op, 0 for the "
+        "full vars, 1 and 2 for the vars broadcast along the rows with or "
+        "without the last axis, 3 for the vars broadcast along the columns.")
+        .SetDefault({});
+    AddAttr<std::vector<int>>(
+        "outs_layout", "The layouts of Outputs in the rowwise fusion_group op.")
+        .SetDefault({});
     AddAttr<std::string>("func_name", "Name of the generated functions.")
         .SetDefault("");
     AddComment(R"DOC(
 fusion_group Operator.
 
 It is used to execute a generated CUDA kernel which fuse the computation of
-multiple operators into one. It supports several types:
+multiple operators into one, or a generated C++ kernel on CPU, which supports
+the type 0 only. It supports several types:
 0, fused computation of elementwise operations in which all the dims of inputs
     and outputs should be exactly the same.
+1, fused computation of elementwise operations and reductions over the last
+    axis, in which the inputs may be broadcast along the last axis or the
+    other axes. The static size of the last axis is compiled in the kernel.
 )DOC");
   }
 };
@@ -101,3 +144,7 @@ multiple operators into one. It supports several types:
 
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(fusion_group, ops::FusionGroupOp, ops::FusionGroupOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fusion_group,
+    ops::FusionGroupKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusionGroupKernel<paddle::platform::CPUDeviceContext, double>);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
@@ -58,8 +59,18 @@ class FusionGroupKernel : public framework::OpKernel<T> {
         platform::DeviceCodePool::Instance().Get(place, func_name);
     VLOG(3) << "func_name: " << func_name;
 
-    if (type == 0) {
+    if (type == 0 || type == 1) {
       size_t n = ins[0]->numel();
+      if (type == 1) {
+        // The kernel computes on the rows of the inputs of the full layout.
+        auto inputs_layout = ctx.Attr<std::vector<int>>("inputs_layout");
+        auto iter = std::find(inputs_layout.begin(), inputs_layout.end(), 0);
+        PADDLE_ENFORCE_NE(iter, inputs_layout.end(),
+                          platform::errors::InvalidArgument(
+                              "Expected an input of the full layout in the "
+                              "rowwise fusion_group op."));
+        n = ins[iter - inputs_layout.begin()]->numel();
+      }
       std::vector<void*> args;
       args.push_back(&n);
       std::vector<const void*> ptrs(num_ins + num_outs);
@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 #include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/packed_weights_cache.h"
 
 namespace paddle {
 namespace operators {
@@ -95,6 +96,11 @@ void FusionRepeatedFCReluOpMaker::Make() {
       .AsDuplicable()
       .AsIntermediate();
   AddOutput("Out", "(LoDTensor) Output tensor of this operator.");
+  AddAttr<bool>("use_packed_weights",
+                "(bool, default false) Whether to pack the weights by MKL "
+                "once and reuse them for all the runs. The weights must be "
+                "persistable.")
+      .SetDefault(false);
   AddComment(R"DOC(
   Fusion Repeated FC with Relu Operator.
 )DOC");
@@ -102,14 +108,20 @@ void FusionRepeatedFCReluOpMaker::Make() {
 
 template <typename T>
 static void fc_relu(const T* x, const T* w, const T* b, T* y,
-                    const jit::matmul_attr_t& attr) {
-  auto matmul =
-      jit::KernelFuncs<jit::MatMulTuple<T>, platform::CPUPlace>::Cache().At(
-          attr);
+                    const jit::matmul_attr_t& attr,
+                    const T* packed_w = nullptr) {
   auto addbias_relu =
       jit::KernelFuncs<jit::VAddReluTuple<T>, platform::CPUPlace>::Cache().At(
           attr.n);
-  matmul(x, w, y, &attr);
+  if (packed_w) {
+    math::PackedWeightsCache<T>::Instance().Compute(attr.m, attr.n, attr.k, x,
+                                                    packed_w, y);
+  } else {
+    auto matmul =
+        jit::KernelFuncs<jit::MatMulTuple<T>, platform::CPUPlace>::Cache().At(
+            attr);
+    matmul(x, w, y, &attr);
+  }
   T* dst = y;
   for (int i = 0; i < attr.m; ++i) {
     addbias_relu(b, dst, dst, attr.n);
@@ -128,6 +140,13 @@ class FusionRepeatedFCReluKernel : public framework::OpKernel<T> {
     auto* out = ctx.Output<Tensor>("Out");
     auto place = ctx.GetPlace();
     int weight_sz = static_cast<int>(weights.size());
+    bool use_packed_weights = ctx.Attr<bool>("use_packed_weights");
+    // nullptr if the packed GEMM is not supported by the build
+    auto packed = [&](int i) -> const T* {
+      return use_packed_weights
+                 ? math::PackedWeightsCache<T>::Instance().Get(*weights[i])
+                 : nullptr;
+    };
 
     auto i_dims = in->dims();
     auto w_dims = weights[0]->dims();
@@ -137,7 +156,7 @@ class FusionRepeatedFCReluKernel : public framework::OpKernel<T> {
     attr.k = w_dims[0];
     relus[0]->Resize({attr.m, attr.n});
     fc_relu(in->data<T>(), weights[0]->data<T>(), biases[0]->data<T>(),
-            relus[0]->mutable_data<T>(place), attr);
+            relus[0]->mutable_data<T>(place), attr, packed(0));
 
     for (int i = 1; i < weight_sz - 1; ++i) {
       auto i_dims = relus[i - 1]->dims();
@@ -147,7 +166,8 @@ class FusionRepeatedFCReluKernel : public framework::OpKernel<T> {
       attr.k = w_dims[0];
       relus[i]->Resize({attr.m, attr.n});
       fc_relu(relus[i - 1]->data<T>(), weights[i]->data<T>(),
-              biases[i]->data<T>(), relus[i]->mutable_data<T>(place), attr);
+              biases[i]->data<T>(), relus[i]->mutable_data<T>(place), attr,
+              packed(i));
     }
 
     auto i_dims_last = relus[weight_sz - 2]->dims();
@@ -157,7 +177,7 @@ class FusionRepeatedFCReluKernel : public framework::OpKernel<T> {
     attr.k = w_dims_last[0];
     fc_relu(relus[weight_sz - 2]->data<T>(), weights[weight_sz - 1]->data<T>(),
             biases[weight_sz - 1]->data<T>(), out->mutable_data<T>(place),
-            attr);
+            attr, packed(weight_sz - 1));
   }
 };
 
@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -111,9 +113,108 @@ Example of matrix multiplication with head_number of B
   }
 };
 
+// The QKV of all the heads are computed by one GEMM, then each head reads its
+// Q, K and V in place from the strided QKV, and writes its output in place
+// into the [batch, seq_len, head_number * size_per_head] output, so that no
+// transpose is materialized.
+template <typename T>
+class MultiHeadMatMulV2CPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *input = context.Input<framework::Tensor>("Input");
+    auto *w = context.Input<framework::Tensor>("W");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto *bias_qk = context.Input<framework::Tensor>("BiasQK");
+    auto *out = context.Output<framework::Tensor>("Out");
+    T scale = static_cast<T>(context.Attr<float>("alpha"));
+    int head_number = context.Attr<int>("head_number");
+
+    auto input_dims = input->dims();
+    auto w_dims = w->dims();
+    int batch = input_dims[0];
+    int seq_len = input_dims[1];
+    int hidden = input_dims[2];
+    int all_head_size = w_dims[2];
+    int head_size = all_head_size / head_number;
+    int qkv_size = 3 * all_head_size;
+    PADDLE_ENFORCE_EQ(w_dims[0], hidden,
+                      platform::errors::InvalidArgument(
+                          "The first dim of W(%d) should be equal to the "
+                          "hidden size of Input(%d).",
+                          w_dims[0], hidden));
+    PADDLE_ENFORCE_EQ(bias->numel(), qkv_size,
+                      platform::errors::InvalidArgument(
+                          "The size of Bias(%d) should be 3 * %d.",
+                          bias->numel(), all_head_size));
+    PADDLE_ENFORCE_EQ(
+        bias_qk->numel(), batch * head_number * seq_len * seq_len,
+        platform::errors::InvalidArgument(
+            "The size of BiasQK(%d) should be equal to batch(%d) * "
+            "head_number(%d) * seq_len(%d) * seq_len(%d).",
+            bias_qk->numel(), batch, head_number, seq_len, seq_len));
+
+    auto &dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+    const T *input_data = input->data<T>();
+    const T *w_data = w->data<T>();
+    const T *bias_data = bias->data<T>();
+    const T *bias_qk_data = bias_qk->data<T>();
+    T *out_data = out->mutable_data<T>(context.GetPlace());
+
+    // qkv: [batch * seq_len, 3, head_number, size_per_head]
+    framework::Tensor qkv;
+    T *qkv_data = qkv.mutable_data<T>(
+        framework::make_ddim({batch * seq_len, qkv_size}), context.GetPlace());
+    blas.GEMM(false, false, batch * seq_len, qkv_size, hidden,
+              static_cast<T>(1), input_data, hidden, w_data, qkv_size,
+              static_cast<T>(0), qkv_data, qkv_size);
+    auto vadd =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+            qkv_size);
+    for (int i = 0; i < batch * seq_len; ++i) {
+      T *row = qkv_data + i * qkv_size;
+      vadd(row, bias_data, row, qkv_size);
+    }
+
+    framework::Tensor qk;
+    T *qk_data = qk.mutable_data<T>(framework::make_ddim({seq_len, seq_len}),
+                                    context.GetPlace());
+    int qk_size = seq_len * seq_len;
+    auto vadd_qk =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+            qk_size);
+    auto softmax =
+        jit::KernelFuncs<jit::SoftmaxTuple<T>, platform::CPUPlace>::Cache().At(
+            seq_len);
+    for (int b = 0; b < batch; ++b) {
+      const T *qkv_batch = qkv_data + b * seq_len * qkv_size;
+      T *out_batch = out_data + b * seq_len * all_head_size;
+      for (int n = 0; n < head_number; ++n) {
+        const T *q = qkv_batch + n * head_size;
+        const T *k = q + all_head_size;
+        const T *v = k + all_head_size;
+        // qk = scale * q * k^T + bias_qk, softmax on each row
+        blas.GEMM(false, true, seq_len, seq_len, head_size, scale, q, qkv_size,
+                  k, qkv_size, static_cast<T>(0), qk_data, seq_len);
+        vadd_qk(qk_data, bias_qk_data + (b * head_number + n) * qk_size,
+                qk_data, qk_size);
+        softmax(qk_data, qk_data, seq_len, seq_len, 1);
+        // out[b, :, n, :] = qk * v
+        blas.GEMM(false, false, seq_len, head_size, seq_len, static_cast<T>(1),
+                  qk_data, seq_len, v, qkv_size, static_cast<T>(0),
+                  out_batch + n * head_size, all_head_size);
+      }
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(multihead_matmul, ops::MultiHeadMatMulV2Op,
                              ops::MultiHeadMatMulV2OpMaker);
+REGISTER_OP_CPU_KERNEL(multihead_matmul,
+                       ops::MultiHeadMatMulV2CPUKernel<float>,
+                       ops::MultiHeadMatMulV2CPUKernel<double>);
@@ -0,0 +1,137 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace operators {
+
+class SkipLayerNormOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext *context) const override {
+    OP_INOUT_CHECK(context->HasInput("X"), "Input", "X", "SkipLayerNorm");
+    OP_INOUT_CHECK(context->HasInput("Y"), "Input", "Y", "SkipLayerNorm");
+    OP_INOUT_CHECK(context->HasInput("Scale"), "Input", "Scale",
+                   "SkipLayerNorm");
+    OP_INOUT_CHECK(context->HasInput("Bias"), "Input", "Bias",
+                   "SkipLayerNorm");
+    OP_INOUT_CHECK(context->HasOutput("Out"), "Output", "Out",
+                   "SkipLayerNorm");
+
+    auto dim_x = context->GetInputDim("X");
+    auto dim_y = context->GetInputDim("Y");
+    PADDLE_ENFORCE_EQ(
+        dim_x, dim_y,
+        platform::errors::InvalidArgument(
+            "The shapes of Input(X) and Input(Y) of SkipLayerNorm should be "
+            "the same, but received X's shape [%s], Y's shape [%s].",
+            dim_x, dim_y));
+    auto begin_norm_axis = context->Attrs().Get<int>("begin_norm_axis");
+    PADDLE_ENFORCE_EQ(
+        begin_norm_axis > 0 && begin_norm_axis < dim_x.size(), true,
+        platform::errors::InvalidArgument(
+            "The begin_norm_axis of SkipLayerNorm should be in (0, %d), but "
+            "received %d.",
+            dim_x.size(), begin_norm_axis));
+    if (context->IsRuntime()) {
+      auto right =
+          framework::product(framework::slice_ddim(dim_x, begin_norm_axis,
+                                                   dim_x.size()));
+      PADDLE_ENFORCE_EQ(
+          framework::product(context->GetInputDim("Scale")), right,
+          platform::errors::InvalidArgument(
+              "The size of Input(Scale) of SkipLayerNorm should be %d, but "
+              "received %d.",
+              right, framework::product(context->GetInputDim("Scale"))));
+      PADDLE_ENFORCE_EQ(
+          framework::product(context->GetInputDim("Bias")), right,
+          platform::errors::InvalidArgument(
+              "The size of Input(Bias) of SkipLayerNorm should be %d, but "
+              "received %d.",
+              right, framework::product(context->GetInputDim("Bias"))));
+    }
+    context->SetOutputDim("Out", dim_x);
+    context->ShareLoD("X", /*->*/ "Out");
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
+};
+
+class SkipLayerNormOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "The first input of the elementwise add.");
+    AddInput("Y", "The second input of the elementwise add, in the same "
+                  "shape as X.");
+    AddInput("Scale", "The scale of the layer norm.");
+    AddInput("Bias", "The bias of the layer norm.");
+    AddOutput("Out", "The output of the layer norm, in the same shape as X.");
+    AddAttr<float>("epsilon",
+                   "Constant for numerical stability [default 1e-5].")
+        .SetDefault(1e-5);
+    AddAttr<int>("begin_norm_axis",
+                 "The axis where the normalized dimensions begin.")
+        .SetDefault(1);
+    AddComment(R"DOC(
+SkipLayerNorm Operator.
+
+This op is used for optimize the residual connections of the transformers,
+Out = layer_norm(X + Y), the sum of every row is normalized while it is still
+in the cache, it is fused by the skip_layernorm_fuse_pass.
+)DOC");
+  }
+};
+
+template <typename T>
+class SkipLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *x = context.Input<framework::Tensor>("X");
+    auto *y = context.Input<framework::Tensor>("Y");
+    auto *scale = context.Input<framework::Tensor>("Scale");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto *out = context.Output<framework::Tensor>("Out");
+    float epsilon = context.Attr<float>("epsilon");
+    int begin_norm_axis = context.Attr<int>("begin_norm_axis");
+
+    auto matrix_dim = framework::flatten_to_2d(x->dims(), begin_norm_axis);
+    int left = static_cast<int>(matrix_dim[0]);
+    int right = static_cast<int>(matrix_dim[1]);
+
+    auto compute = jit::KernelFuncs<jit::SkipLayerNormTuple<T>,
+                                    platform::CPUPlace>::Cache()
+                       .At(right);
+    compute(x->data<T>(), y->data<T>(),
+            out->mutable_data<T>(context.GetPlace()), scale->data<T>(),
+            bias->data<T>(), left, epsilon, right);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(skip_layernorm, ops::SkipLayerNormOp,
+                             ops::SkipLayerNormOpMaker);
+REGISTER_OP_CPU_KERNEL(skip_layernorm, ops::SkipLayerNormCPUKernel<float>,
+                       ops::SkipLayerNormCPUKernel<double>);
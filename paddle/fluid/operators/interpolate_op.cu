@@ -10,7 +10,9 @@
    limitations under the License. */
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
+#include "paddle/fluid/memory/memory.h"
 #include "paddle/fluid/operators/interpolate_op.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 #include "paddle/fluid/platform/gpu_launch_config.h"
@@ -819,6 +821,253 @@ __global__ void KeBicubicInterpBw(
   }
 }
 
+// The source pixels of an output row or column of the 2D nearest and
+// bilinear interpolation, which are the same for all the images and the
+// channels.
+template <typename T>
+struct InterpCoord {
+  int idx;   // the first source pixel
+  int id;    // the offset of the second source pixel, 0 or 1
+  T lambda;  // the weight of the second source pixel
+};
+
+template <typename T>
+__global__ void KeInterpCoords(InterpCoord<T>* coords, const int out_size,
+                               const int in_size, const float ratio,
+                               const bool align_corners, const int align_mode,
+                               const bool is_nearest) {
+  int tid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  bool align_flag = (align_mode == 0 && !align_corners);
+  for (; tid < out_size; tid += stride) {
+    InterpCoord<T> coord;
+    if (is_nearest) {
+      coord.idx = (align_corners) ? static_cast<int>(ratio * tid + 0.5)
+                                  : static_cast<int>(ratio * tid);
+      coord.id = 0;
+      coord.lambda = 0;
+    } else {
+      int idx = align_flag ? static_cast<int>(ratio * (tid + 0.5) - 0.5)
+                           : static_cast<int>(ratio * tid);
+      idx = (idx > 0) ? idx : 0;
+      T src = ratio * (tid + 0.5) - 0.5;
+      src = (src > 0) ? src : 0;
+      coord.idx = idx;
+      coord.id = (idx < in_size - 1) ? 1 : 0;
+      coord.lambda = align_flag ? src - idx : ratio * tid - idx;
+    }
+    coords[tid] = coord;
+  }
+}
+
+// The source pixels of the outputs are not decreasing, so every source pixel
+// gets the gradients from the contiguous outputs [starts, ends).
+template <typename T>
+__global__ void KeInterpCoordRanges(const InterpCoord<T>* coords,
+                                    const int out_size, const int in_size,
+                                    const bool is_nearest, int* starts,
+                                    int* ends) {
+  int tid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (; tid < in_size; tid += stride) {
+    int first = is_nearest ? tid : tid - 1;
+    int low = 0, high = out_size;
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (coords[mid].idx < first) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    starts[tid] = low;
+    high = out_size;
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (coords[mid].idx <= tid) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    ends[tid] = low;
+  }
+}
+
+template <typename T>
+__device__ __forceinline__ T InterpCoordWeight(const InterpCoord<T>& coord,
+                                               const int in_idx) {
+  T weight = 0;
+  if (coord.idx == in_idx) weight += 1.f - coord.lambda;
+  if (coord.idx + coord.id == in_idx) weight += coord.lambda;
+  return weight;
+}
+
+// Each thread loads VecSize channels of the source pixels at once.
+template <typename T, int VecSize, bool IsNearest>
+__global__ void KeInterpNHWCFw(const T* in, const size_t in_img_h,
+                               const size_t in_img_w, T* out,
+                               const size_t out_img_h, const size_t out_img_w,
+                               const size_t num_pixels,
+                               const size_t num_channels,
+                               const InterpCoord<T>* coords_h,
+                               const InterpCoord<T>* coords_w) {
+  using Vec = platform::AlignedVector<T, VecSize>;
+  int num_vecs = num_channels / VecSize;
+  int nthreads = num_pixels * num_vecs;
+  int tid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (; tid < nthreads; tid += stride) {
+    int vec_id = tid % num_vecs;
+    int out_pixel = tid / num_vecs;
+    int out_img_idx = out_pixel % out_img_w;
+    int out_img_idy = (out_pixel / out_img_w) % out_img_h;
+    int batch_id = out_pixel / (out_img_w * out_img_h);
+    const InterpCoord<T> coord_h = coords_h[out_img_idy];
+    const InterpCoord<T> coord_w = coords_w[out_img_idx];
+
+    const T* in_pos =
+        in + ((batch_id * in_img_h + coord_h.idx) * in_img_w + coord_w.idx) *
+                 num_channels +
+        vec_id * VecSize;
+    Vec* out_vec = reinterpret_cast<Vec*>(out + out_pixel * num_channels +
+                                          vec_id * VecSize);
+    if (IsNearest) {
+      *out_vec = *reinterpret_cast<const Vec*>(in_pos);
+      continue;
+    }
+
+    int h_offset = coord_h.id * in_img_w * num_channels;
+    int w_offset = coord_w.id * num_channels;
+    Vec v00 = *reinterpret_cast<const Vec*>(in_pos);
+    Vec v01 = *reinterpret_cast<const Vec*>(in_pos + w_offset);
+    Vec v10 = *reinterpret_cast<const Vec*>(in_pos + h_offset);
+    Vec v11 = *reinterpret_cast<const Vec*>(in_pos + h_offset + w_offset);
+    T h1lambda = coord_h.lambda;
+    T h2lambda = 1.f - h1lambda;
+    T w1lambda = coord_w.lambda;
+    T w2lambda = 1.f - w1lambda;
+    Vec result;
+#pragma unroll
+    for (int i = 0; i < VecSize; ++i) {
+      result.val[i] =
+          h2lambda * (w2lambda * v00.val[i] + w1lambda * v01.val[i]) +
+          h1lambda * (w2lambda * v10.val[i] + w1lambda * v11.val[i]);
+    }
+    *out_vec = result;
+  }
+}
+
+// Each thread sums up the gradients of one source pixel from the outputs
+// using it, instead of the atomic adds from every output.
+template <typename T>
+__global__ void KeInterpBwGather(
+    T* in, const size_t in_img_h, const size_t in_img_w, const T* out,
+    const size_t out_img_h, const size_t out_img_w, const size_t num_images,
+    const size_t num_channels, const InterpCoord<T>* coords_h,
+    const InterpCoord<T>* coords_w, const int* starts_h, const int* ends_h,
+    const int* starts_w, const int* ends_w, const DataLayout data_layout) {
+  int nthreads = num_images * num_channels * in_img_h * in_img_w;
+  int tid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (; tid < nthreads; tid += stride) {
+    int in_img_idy, in_img_idx;
+    // the output of (in_img_idy, in_img_idx) is out_pos[(y * out_img_w + x) *
+    // pixel_stride]
+    const T* out_pos;
+    int pixel_stride;
+    if (data_layout == DataLayout::kNCHW) {
+      in_img_idx = tid % in_img_w;
+      in_img_idy = (tid / in_img_w) % in_img_h;
+      out_pos = out + tid / (in_img_w * in_img_h) * out_img_h * out_img_w;
+      pixel_stride = 1;
+    } else {
+      int channel_id = tid % num_channels;
+      in_img_idx = (tid / num_channels) % in_img_w;
+      in_img_idy = (tid / (num_channels * in_img_w)) % in_img_h;
+      int batch_id = tid / (num_channels * in_img_w * in_img_h);
+      out_pos = out + batch_id * out_img_h * out_img_w * num_channels +
+                channel_id;
+      pixel_stride = num_channels;
+    }
+
+    T grad = 0;
+    for (int y = starts_h[in_img_idy]; y < ends_h[in_img_idy]; ++y) {
+      T h_weight = InterpCoordWeight(coords_h[y], in_img_idy);
+      if (h_weight == 0) continue;
+      T row_grad = 0;
+      for (int x = starts_w[in_img_idx]; x < ends_w[in_img_idx]; ++x) {
+        row_grad += InterpCoordWeight(coords_w[x], in_img_idx) *
+                    out_pos[(y * out_img_w + x) * pixel_stride];
+      }
+      grad += h_weight * row_grad;
+    }
+    in[tid] = grad;
+  }
+}
+
+// The coordinates of the rows (or the columns) of the 2D nearest and bilinear
+// interpolation, computed on the device in the same way as the generic
+// kernels.
+template <typename T>
+static void ComputeInterpCoords(const framework::ExecutionContext& ctx,
+                                InterpCoord<T>* coords, const int out_size,
+                                const int in_size, const float ratio,
+                                const bool align_corners, const int align_mode,
+                                const bool is_nearest) {
+  platform::GpuLaunchConfig config =
+      platform::getGpuLaunchConfig(out_size, ctx);
+  KeInterpCoords<T><<<config.blocks, config.threads, 0,
+                      ctx.cuda_device_context().stream()>>>(
+      coords, out_size, in_size, ratio, align_corners, align_mode, is_nearest);
+}
+
+// The largest vector of at most 16 bytes which divides the channels, and
+// which both the input and the output are aligned to.
+template <typename T>
+static int GetInterpVecSize(const int num_channels, const T* in,
+                            const T* out) {
+  int vec_size = std::max(1, static_cast<int>(16 / sizeof(T)));
+  while (vec_size > 1 &&
+         (num_channels % vec_size != 0 ||
+          reinterpret_cast<uintptr_t>(in) % (vec_size * sizeof(T)) != 0 ||
+          reinterpret_cast<uintptr_t>(out) % (vec_size * sizeof(T)) != 0)) {
+    vec_size /= 2;
+  }
+  return vec_size;
+}
+
+template <typename T, bool IsNearest>
+static void InterpolateNHWCCUDAFwd(const framework::ExecutionContext& ctx,
+                                   const T* input_data, const int in_h,
+                                   const int in_w, T* output_data,
+                                   const int out_h, const int out_w,
+                                   const int n, const int c,
+                                   const InterpCoord<T>* coords_h,
+                                   const InterpCoord<T>* coords_w) {
+  auto stream = ctx.cuda_device_context().stream();
+  int vec_size = GetInterpVecSize<T>(c, input_data, output_data);
+  int num_pixels = n * out_h * out_w;
+  platform::GpuLaunchConfig config =
+      platform::getGpuLaunchConfig(num_pixels * (c / vec_size), ctx);
+  if (vec_size == 4) {
+    KeInterpNHWCFw<T, 4, IsNearest><<<config.blocks, config.threads, 0,
+                                      stream>>>(
+        input_data, in_h, in_w, output_data, out_h, out_w, num_pixels, c,
+        coords_h, coords_w);
+  } else if (vec_size == 2) {
+    KeInterpNHWCFw<T, 2, IsNearest><<<config.blocks, config.threads, 0,
+                                      stream>>>(
+        input_data, in_h, in_w, output_data, out_h, out_w, num_pixels, c,
+        coords_h, coords_w);
+  } else {
+    KeInterpNHWCFw<T, 1, IsNearest><<<config.blocks, config.threads, 0,
+                                      stream>>>(
+        input_data, in_h, in_w, output_data, out_h, out_w, num_pixels, c,
+        coords_h, coords_w);
+  }
+}
+
 template <typename T>
 static void Interpolate1DCUDAFwd(const framework::ExecutionContext& ctx,
                                  const Tensor& input, Tensor* output) {
@@ -983,6 +1232,28 @@ static void Interpolate2DCUDAFwd(const framework::ExecutionContext& ctx,
   platform::GpuLaunchConfig config =
       platform::getGpuLaunchConfig(pixelNum, ctx);
 
+  bool is_nearest = "nearest" == interp_method;
+  if (data_layout == DataLayout::kNHWC &&
+      (is_nearest || "bilinear" == interp_method)) {
+    auto coords = memory::Alloc(ctx.cuda_device_context(),
+                                (out_h + out_w) * sizeof(InterpCoord<T>));
+    auto* coords_h = reinterpret_cast<InterpCoord<T>*>(coords->ptr());
+    auto* coords_w = coords_h + out_h;
+    ComputeInterpCoords<T>(ctx, coords_h, out_h, in_h, ratio_h, align_corners,
+                           align_mode, is_nearest);
+    ComputeInterpCoords<T>(ctx, coords_w, out_w, in_w, ratio_w, align_corners,
+                           align_mode, is_nearest);
+    if (is_nearest) {
+      InterpolateNHWCCUDAFwd<T, true>(ctx, input_data, in_h, in_w, output_data,
+                                      out_h, out_w, n, c, coords_h, coords_w);
+    } else {
+      InterpolateNHWCCUDAFwd<T, false>(ctx, input_data, in_h, in_w,
+                                       output_data, out_h, out_w, n, c,
+                                       coords_h, coords_w);
+    }
+    return;
+  }
+
   if ("nearest" == interp_method) {
     KeNearestNeighborInterpFw<T><<<config.blocks, config.threads, 0,
                                    ctx.cuda_device_context().stream()>>>(
@@ -1240,14 +1511,22 @@ static void Interpolate2DCUDABwd(const framework::ExecutionContext& ctx,
   input_grad->mutable_data<T>(dim_grad, ctx.GetPlace());
   auto* input_grad_data = input_grad->mutable_data<T>(dim_grad, ctx.GetPlace());
   auto& device_ctx = ctx.template device_context<platform::CUDADeviceContext>();
-  math::SetConstant<platform::CUDADeviceContext, T> zero;
-  zero(device_ctx, input_grad, static_cast<T>(0.0));
 
   if (in_h == out_h && in_w == out_w) {
     framework::TensorCopy(output_grad, ctx.GetPlace(), input_grad);
     return;
   }
 
+  // The upsampling gathers the gradients of every source pixel, all of
+  // which are written, from the outputs using it.
+  bool is_nearest = "nearest" == interp_method;
+  bool gather_grad = (is_nearest || "bilinear" == interp_method) &&
+                     out_h >= in_h && out_w >= in_w;
+  if (!gather_grad) {
+    math::SetConstant<platform::CUDADeviceContext, T> zero;
+    zero(device_ctx, input_grad, static_cast<T>(0.0));
+  }
+
   float ratio_h = 0.f;
   float ratio_w = 0.f;
   if (out_h > 1) {
@@ -1269,7 +1548,36 @@ static void Interpolate2DCUDABwd(const framework::ExecutionContext& ctx,
   platform::GpuLaunchConfig config =
       platform::getGpuLaunchConfig(pixelNum, ctx);
 
-  if ("nearest" == interp_method) {
+  if (gather_grad) {
+    auto coords = memory::Alloc(device_ctx,
+                                (out_h + out_w) * sizeof(InterpCoord<T>) +
+                                    2 * (in_h + in_w) * sizeof(int));
+    auto* coords_h = reinterpret_cast<InterpCoord<T>*>(coords->ptr());
+    auto* coords_w = coords_h + out_h;
+    int* starts_h = reinterpret_cast<int*>(coords_w + out_w);
+    int* ends_h = starts_h + in_h;
+    int* starts_w = ends_h + in_h;
+    int* ends_w = starts_w + in_w;
+    ComputeInterpCoords<T>(ctx, coords_h, out_h, in_h, ratio_h, align_corners,
+                           align_mode, is_nearest);
+    ComputeInterpCoords<T>(ctx, coords_w, out_w, in_w, ratio_w, align_corners,
+                           align_mode, is_nearest);
+    auto stream = device_ctx.stream();
+    platform::GpuLaunchConfig range_config =
+        platform::getGpuLaunchConfig(std::max(in_h, in_w), ctx);
+    KeInterpCoordRanges<T><<<range_config.blocks, range_config.threads, 0,
+                             stream>>>(coords_h, out_h, in_h, is_nearest,
+                                       starts_h, ends_h);
+    KeInterpCoordRanges<T><<<range_config.blocks, range_config.threads, 0,
+                             stream>>>(coords_w, out_w, in_w, is_nearest,
+                                       starts_w, ends_w);
+    platform::GpuLaunchConfig grad_config =
+        platform::getGpuLaunchConfig(n * in_chw, ctx);
+    KeInterpBwGather<T><<<grad_config.blocks, grad_config.threads, 0,
+                          stream>>>(
+        input_grad_data, in_h, in_w, output_grad_data, out_h, out_w, n, c,
+        coords_h, coords_w, starts_h, ends_h, starts_w, ends_w, data_layout);
+  } else if ("nearest" == interp_method) {
     KeNearestNeighborInterpBw<T><<<config.blocks, config.threads, 0,
                                    ctx.cuda_device_context().stream()>>>(
         input_grad_data, in_h, in_w, n, in_chw, output_grad_data, out_h, out_w,
@@ -12,14 +12,19 @@
  * See the License for the specific language governing permissions and
  * limitations under the License. */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <random>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
@@ -30,6 +35,19 @@ DEFINE_int32(burning, 10, "Burning times.");
 DEFINE_int32(repeat, 3000, "Repeat times.");
 DEFINE_int32(max_size, 1000, "The Max size would be tested.");
 DEFINE_string(filter, "", "The Benchmark name would be run.");
+DEFINE_string(sizes, "",
+              "The comma separated sizes would be tested, instead of all the "
+              "sizes from 1 to max_size.");
+DEFINE_string(report, "", "Write the results in JSON to this file.");
+DEFINE_string(baseline_dir, "",
+              "Compare the results with the baseline <baseline_dir>/"
+              "<cpu_family>.json written by --report on the same CPU family, "
+              "and fail if any implementation regresses.");
+DEFINE_double(threshold, 0.2,
+              "The max slowdown over the baseline allowed, 0.2 means 20%.");
+DEFINE_double(min_time_us, 0.1,
+              "The results faster than this in the baseline are too noisy to "
+              "be compared.");
 
 class BenchJITKernel {
  public:
@@ -83,12 +101,155 @@ void RandomVec(const int n, T* a, const T lower = static_cast<T>(-20.f),
 
 std::vector<int> TestSizes() {
   std::vector<int> s;
+  if (!FLAGS_sizes.empty()) {
+    std::istringstream is(FLAGS_sizes);
+    std::string size;
+    while (std::getline(is, size, ',')) {
+      s.push_back(std::stoi(size));
+    }
+    return s;
+  }
   for (int i = 1; i <= FLAGS_max_size; ++i) {
     s.push_back(i);
   }
   return s;
 }
 
+struct BenchResult {
+  std::string kernel;
+  std::string attr;
+  std::string impl;
+  double time_us;
+  // the time of the Refer implementation over this one
+  double speedup;
+};
+
+static std::vector<BenchResult> g_all_results;
+
+// The widest ISA the CPU supports, the baselines are kept per family.
+std::string CPUFamily() {
+  namespace platform = paddle::platform;
+  if (platform::MayIUse(platform::avx512_core_vnni)) return "avx512_core_vnni";
+  if (platform::MayIUse(platform::avx512_core)) return "avx512_core";
+  if (platform::MayIUse(platform::avx512f)) return "avx512f";
+  if (platform::MayIUse(platform::avx2)) return "avx2";
+  if (platform::MayIUse(platform::avx)) return "avx";
+  if (platform::MayIUse(platform::sse42)) return "sse42";
+  return "any";
+}
+
+std::string JSONEscape(const std::string& str) {
+  std::string res;
+  for (char c : str) {
+    if (c == '"' || c == '\\') res += '\\';
+    res += c;
+  }
+  return res;
+}
+
+// The key of a result, the repeated benchmarks of the same attr, e.g., the
+// inplace ones, are numbered in order.
+std::vector<std::string> ResultKeys(const std::vector<BenchResult>& results) {
+  std::map<std::string, int> counts;
+  std::vector<std::string> keys;
+  for (auto& r : results) {
+    std::string key = r.kernel + "|" + r.attr + "|" + r.impl;
+    keys.push_back(key + "|" + std::to_string(counts[key]++));
+  }
+  return keys;
+}
+
+void WriteReport(const std::string& path) {
+  std::ofstream file(path);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    paddle::platform::errors::Unavailable(
+                        "Can not open the report file %s.", path));
+  // one result per line, as read by ReadBaseline
+  file << "{\n  \"cpu_family\": \"" << CPUFamily() << "\",\n"
+       << "  \"repeat\": " << FLAGS_repeat << ",\n  \"results\": [\n";
+  for (size_t i = 0; i < g_all_results.size(); ++i) {
+    auto& r = g_all_results[i];
+    file << "    {\"kernel\": \"" << r.kernel << "\", \"attr\": \""
+         << JSONEscape(r.attr) << "\", \"impl\": \"" << r.impl
+         << "\", \"time_us\": " << r.time_us << ", \"speedup\": "
+         << r.speedup << "}" << (i + 1 < g_all_results.size() ? "," : "")
+         << "\n";
+  }
+  file << "  ]\n}\n";
+  LOG(INFO) << "Write " << g_all_results.size() << " results to " << path;
+}
+
+// The string or number value of the key in a line of the report.
+std::string JSONField(const std::string& line, const std::string& key) {
+  auto pos = line.find("\"" + key + "\": ");
+  if (pos == std::string::npos) return "";
+  pos += key.size() + 4;
+  if (line[pos] == '"') {
+    std::string value;
+    for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+      if (line[pos] == '\\') ++pos;
+      value += line[pos];
+    }
+    return value;
+  }
+  auto end = line.find_first_of(",}", pos);
+  return line.substr(pos, end - pos);
+}
+
+std::vector<BenchResult> ReadBaseline(const std::string& path) {
+  std::ifstream file(path);
+  PADDLE_ENFORCE_EQ(file.is_open(), true,
+                    paddle::platform::errors::NotFound(
+                        "Can not open the baseline %s, which can be written "
+                        "by --report on a CPU of the same family.",
+                        path));
+  std::vector<BenchResult> results;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.find("\"kernel\": ") == std::string::npos) continue;
+    BenchResult r;
+    r.kernel = JSONField(line, "kernel");
+    r.attr = JSONField(line, "attr");
+    r.impl = JSONField(line, "impl");
+    r.time_us = std::stod(JSONField(line, "time_us"));
+    r.speedup = std::stod(JSONField(line, "speedup"));
+    results.push_back(r);
+  }
+  return results;
+}
+
+// Return the number of the regressions.
+int CompareWithBaseline(const std::string& path) {
+  auto baseline = ReadBaseline(path);
+  std::map<std::string, double> baseline_times;
+  auto baseline_keys = ResultKeys(baseline);
+  for (size_t i = 0; i < baseline.size(); ++i) {
+    baseline_times[baseline_keys[i]] = baseline[i].time_us;
+  }
+
+  int compared = 0, regressions = 0;
+  auto keys = ResultKeys(g_all_results);
+  for (size_t i = 0; i < g_all_results.size(); ++i) {
+    auto it = baseline_times.find(keys[i]);
+    if (it == baseline_times.end() || it->second < FLAGS_min_time_us) {
+      continue;
+    }
+    ++compared;
+    auto& r = g_all_results[i];
+    double slowdown = r.time_us / it->second - 1.;
+    if (slowdown > FLAGS_threshold) {
+      ++regressions;
+      LOG(ERROR) << "Regression of " << r.kernel << " " << r.attr << " "
+                 << r.impl << ": " << r.time_us << " us, the baseline is "
+                 << it->second << " us, " << slowdown * 100 << "% slower.";
+    }
+  }
+  LOG(INFO) << "Compare " << compared << " results with the baseline " << path
+            << ", " << regressions << " regressions over "
+            << FLAGS_threshold * 100 << "%.";
+  return regressions;
+}
+
 template <typename KernelTuple, typename... Args>
 struct BenchFunc {
   // return this function avg time
@@ -125,12 +286,28 @@ void BenchAllImpls(const typename KernelTuple::attr_type& attr, Args... args) {
   }
   infos.push_back(std::make_pair("Target", benchmark(tgt, args...)));
 
+  double refer_time = 0.;
+  for (auto& pair : infos) {
+    if (pair.first == "Refer") refer_time = pair.second;
+  }
+  std::ostringstream attr_str;
+  attr_str << attr;
+
   // print
   std::ostringstream loginfos;
   loginfos << "Kernel Type " << jit::to_string(KernelTuple::kernel_type) << ": "
            << attr << ": ";
   for (auto pair : infos) {
-    loginfos << pair.first << " takes " << pair.second << " us; ";
+    BenchResult result;
+    result.kernel = jit::to_string(KernelTuple::kernel_type);
+    result.attr = attr_str.str();
+    result.impl = pair.first;
+    result.time_us = pair.second;
+    result.speedup = pair.second > 0. ? refer_time / pair.second : 0.;
+    g_all_results.push_back(result);
+    loginfos << pair.first << " takes " << pair.second << " us";
+    if (refer_time > 0.) loginfos << " (x" << result.speedup << ")";
+    loginfos << "; ";
   }
   LOG(INFO) << loginfos.str();
 }
@@ -393,6 +570,26 @@ void BenchKernelSoftmax() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelMaskedSoftmax() {
+  using T = typename KernelTuple::data_type;
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      Tensor x, mask, y;
+      x.Resize({bs, n});
+      mask.Resize({bs, n});
+      y.Resize({bs, n});
+      RandomVec<T>(bs * n, x.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      RandomVec<T>(bs * n, mask.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      const T* x_data = x.data<T>();
+      const T* mask_data = mask.data<T>();
+      T* y_data = y.mutable_data<T>(PlaceType());
+      BenchAllImpls<KernelTuple, PlaceType>(n, x_data, mask_data, y_data,
+                                            0.125f, n, bs);
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelLayerNorm() {
   using T = typename KernelTuple::data_type;
@@ -432,6 +629,35 @@ void BenchKernelLayerNorm() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelSkipLayerNorm() {
+  using T = typename KernelTuple::data_type;
+  const T epsilon = 9.99999975e-06;
+  for (int left : {1, 9, 17, 50}) {
+    for (int right : TestSizes()) {
+      int sz = left * right;
+      Tensor x, y, scale, bias, out;
+      x.Resize({left, right});
+      y.Resize({left, right});
+      out.Resize({left, right});
+      scale.Resize({right});
+      bias.Resize({right});
+      RandomVec<T>(sz, x.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      RandomVec<T>(sz, y.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      RandomVec<T>(right, scale.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      RandomVec<T>(right, bias.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      const T* x_data = x.data<T>();
+      const T* y_data = y.data<T>();
+      const T* scale_data = scale.data<T>();
+      const T* bias_data = bias.data<T>();
+      T* out_data = out.mutable_data<T>(PlaceType());
+      BenchAllImpls<KernelTuple, PlaceType>(right, x_data, y_data, out_data,
+                                            scale_data, bias_data, left,
+                                            epsilon, right);
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelCRFDecoding() {
   using T = typename KernelTuple::data_type;
@@ -544,12 +770,14 @@ BENCH_FP32_CPU(GRUHtPart1);
 BENCH_FP32_CPU(GRUHtPart2);
 
 BENCH_FP32_CPU(LayerNorm);
+BENCH_FP32_CPU(SkipLayerNorm);
 BENCH_FP32_CPU(CRFDecoding);
 
 BENCH_FP32_CPU(SeqPool);
 BENCH_FP32_CPU(EmbSeqPool);
 BENCH_FP32_CPU(MatMul);
 BENCH_FP32_CPU(Softmax);
+BENCH_FP32_CPU(MaskedSoftmax);
 BENCH_FP32_CPU(Sgd);
 BENCH_FP32_CPU(VBroadcast);
 
@@ -559,12 +787,26 @@ BENCH_FP32_CPU(VBroadcast);
 //     --burning: the burning time before count
 //     --repeat: the repeat times
 //     --max_size: the max size would be tested
+//     --sizes: the comma separated sizes would be tested instead of max_size
 //     --filter: the bench name would be run
+//     --report: write the results and the speedups over refer in JSON
+//     --baseline_dir: fail on the regressions over the baseline of the CPU
+//                     family, e.g., avx512_core.json written by --report
+//     --threshold: the max slowdown allowed
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging(argv[0]);
   LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
-            << " times.";
+            << " times, on the CPU family " << CPUFamily() << ".";
 
   RUN_ALL_BENCHMARK();
+  if (!FLAGS_report.empty()) {
+    WriteReport(FLAGS_report);
+  }
+  if (!FLAGS_baseline_dir.empty() &&
+      CompareWithBaseline(FLAGS_baseline_dir + "/" + CPUFamily() + ".json") >
+          0) {
+    return 1;
+  }
+  return 0;
 }
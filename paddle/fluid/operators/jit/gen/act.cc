@@ -46,13 +46,35 @@ int ALIGN32_BEG g_tmp_mem[16] ALIGN32_END = {0};
 
 void VActJitCode::genCode() {
   int offset = 0;
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
+  int rest = num_;
+  // The exp based activations use the ymm constants and the vector compare
+  // masks, so only the simple ones are computed with zmm.
+  bool use_zmm = platform::MayIUse(platform::avx512f) &&
+                 (type_ == operand_type::RELU ||
+                  type_ == operand_type::SQUARE ||
+                  type_ == operand_type::IDENTITY);
+  if (use_zmm) {
+    for (int i = 0; i < num_ / ZMM_FLOAT_BLOCK; ++i) {
+      vmovups(zmm_src, ptr[param1 + offset]);
+      if (type_ == operand_type::RELU) {
+        relu_jmm<zmm_t>(zmm_dst, zmm_src, 15);
+      } else if (type_ == operand_type::SQUARE) {
+        square_jmm<zmm_t>(zmm_dst, zmm_src);
+      } else {
+        identity_jmm<zmm_t>(zmm_dst, zmm_src, 15);
+      }
+      vmovups(ptr[param2 + offset], zmm_dst);
+      offset += sizeof(float) * ZMM_FLOAT_BLOCK;
+    }
+    rest = num_ % ZMM_FLOAT_BLOCK;
+  }
+  for (int i = 0; i < rest / YMM_FLOAT_BLOCK; ++i) {
     vmovups(ymm_src, ptr[param1 + offset]);
     act<ymm_t>(ymm_dst, ymm_src, type_);
     vmovups(ptr[param2 + offset], ymm_dst);
     offset += sizeof(float) * YMM_FLOAT_BLOCK;
   }
-  int rest = num_ % YMM_FLOAT_BLOCK;
+  rest = rest % YMM_FLOAT_BLOCK;
   while (rest > 0) {
     int block = XMM_FLOAT_BLOCK;
     if (rest >= 4) {
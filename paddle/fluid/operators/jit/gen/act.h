@@ -71,7 +71,10 @@ class VActFunc : public JitCode {
   template <typename JMM>
   void relu_jmm(JMM& dst, JMM& src, int zero_idx = 15) {  // NOLINT
     JMM zero = JMM(zero_idx);
-    vxorps(zero, zero, zero);
+    // the VEX encoded xmm clears the upper bits of the ymm and zmm too, and
+    // vxorps of zmm needs avx512dq
+    xmm_t xmm_zero = xmm_t(zero_idx);
+    vxorps(xmm_zero, xmm_zero, xmm_zero);
     vmaxps(dst, src, zero);
   }
 
@@ -221,7 +224,8 @@ class VActFunc : public JitCode {
   template <typename JMM>
   void identity_jmm(JMM& dst, JMM& src, int zero_idx) {  // NOLINT
     JMM zero = JMM(zero_idx);
-    vxorps(zero, zero, zero);
+    xmm_t xmm_zero = xmm_t(zero_idx);
+    vxorps(xmm_zero, xmm_zero, xmm_zero);
     vaddps(dst, src, zero);
     // TODO(TJ): use below
     // dst.setIdx(src.getIdx());
@@ -307,9 +311,11 @@ class VActJitCode : public VActFunc {
 
   xmm_t xmm_src = xmm_t(0);
   ymm_t ymm_src = ymm_t(0);
+  zmm_t zmm_src = zmm_t(0);
 
   xmm_t xmm_dst = xmm_t(1);
   ymm_t ymm_dst = ymm_t(1);
+  zmm_t zmm_dst = zmm_t(1);
 };
 
 #define DECLARE_ACT_JITCODE(name, op_type)                                    \
@@ -25,35 +25,38 @@ namespace gen {
 void VXXJitCode::genCode() {
   // do not need push stack, and do not need save avx512reg if do not use avx512
   int offset = 0;
+  int rest = num_;
+  bool use_zmm = platform::MayIUse(platform::avx512f);
   if (with_relu_) {
+    // also clears the upper bits of zmm_zero
     vxorps(ymm_zero, ymm_zero, ymm_zero);
   }
+  // the lower lanes of the broadcasted zmm are the broadcasted ymm and xmm
   if (scalar_index_ == 1) {
-    vbroadcastss(ymm_src1, ptr[param1]);
-  } else if (scalar_index_ == 2) {
-    vbroadcastss(ymm_src2, ptr[param2]);
-  }
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
-    if (scalar_index_ != 1) {
-      vmovups(ymm_src1, ptr[param1 + offset]);
-    }
-    if (scalar_index_ != 2) {
-      vmovups(ymm_src2, ptr[param2 + offset]);
+    if (use_zmm) {
+      vbroadcastss(zmm_src1, ptr[param1]);
+    } else {
+      vbroadcastss(ymm_src1, ptr[param1]);
     }
-    if (type_ == operand_type::MUL) {
-      vmulps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::ADD) {
-      vaddps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::SUB) {
-      vsubps(ymm_dst, ymm_src1, ymm_src2);
+  } else if (scalar_index_ == 2) {
+    if (use_zmm) {
+      vbroadcastss(zmm_src2, ptr[param2]);
+    } else {
+      vbroadcastss(ymm_src2, ptr[param2]);
     }
-    if (with_relu_) {
-      vmaxps(ymm_dst, ymm_zero, ymm_dst);
+  }
+  if (use_zmm) {
+    for (int i = 0; i < num_ / ZMM_FLOAT_BLOCK; ++i) {
+      genBlock<zmm_t>(zmm_src1, zmm_src2, zmm_dst, zmm_zero, offset);
+      offset += sizeof(float) * ZMM_FLOAT_BLOCK;
     }
-    vmovups(ptr[param3 + offset], ymm_dst);
+    rest = num_ % ZMM_FLOAT_BLOCK;
+  }
+  for (int i = 0; i < rest / YMM_FLOAT_BLOCK; ++i) {
+    genBlock<ymm_t>(ymm_src1, ymm_src2, ymm_dst, ymm_zero, offset);
     offset += sizeof(float) * YMM_FLOAT_BLOCK;
   }
-  int rest = num_ % YMM_FLOAT_BLOCK;
+  rest = rest % YMM_FLOAT_BLOCK;
   while (rest > 0) {
     int block = XMM_FLOAT_BLOCK;
     if (rest >= 4) {
@@ -69,6 +69,29 @@ class VXXJitCode : public JitCode {
   void genCode() override;
 
  private:
+  // compute one block of ymm or zmm, the scalar is broadcasted before
+  template <typename JMM>
+  void genBlock(const JMM& src1, const JMM& src2, const JMM& dst,
+                const JMM& zero, int offset) {
+    if (scalar_index_ != 1) {
+      vmovups(src1, ptr[param1 + offset]);
+    }
+    if (scalar_index_ != 2) {
+      vmovups(src2, ptr[param2 + offset]);
+    }
+    if (type_ == operand_type::MUL) {
+      vmulps(dst, src1, src2);
+    } else if (type_ == operand_type::ADD) {
+      vaddps(dst, src1, src2);
+    } else if (type_ == operand_type::SUB) {
+      vsubps(dst, src1, src2);
+    }
+    if (with_relu_) {
+      vmaxps(dst, zero, dst);
+    }
+    vmovups(ptr[param3 + offset], dst);
+  }
+
   int num_;
   operand_type type_;
   int scalar_index_;
@@ -86,6 +109,11 @@ class VXXJitCode : public JitCode {
   ymm_t ymm_src2 = ymm_t(1);
   ymm_t ymm_dst = ymm_t(2);
   ymm_t ymm_zero = ymm_t(3);
+
+  zmm_t zmm_src1 = zmm_t(0);
+  zmm_t zmm_src2 = zmm_t(1);
+  zmm_t zmm_dst = zmm_t(2);
+  zmm_t zmm_zero = zmm_t(3);
 };
 
 #define DECLARE_BLAS_JITCODE(name, op_type, scalar_idx, with_relu)             \
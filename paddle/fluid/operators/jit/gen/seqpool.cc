@@ -24,11 +24,7 @@ namespace jit {
 namespace gen {
 
 void SeqPoolJitCode::genCode() {
-  constexpr int block = YMM_FLOAT_BLOCK;
   constexpr int max_num_regs = 8;
-  const int num_block = w_ / block;
-  const int num_groups = num_block / max_num_regs;
-  int rest_num_regs = num_block % max_num_regs;
   mov(reg32_int_h, dword[param_attr]);
   if (type_ == SeqPoolType::kAvg || type_ == SeqPoolType::kSqrt) {
     mov(reg_tmp, reinterpret_cast<size_t>(exp_float_consts));
@@ -43,16 +39,18 @@ void SeqPoolJitCode::genCode() {
     vdivps(xmm_t(1), xmm_t(1), xmm_t(0));
     vmovss(ptr[reg_tmp], xmm_t(1));
   }
-  const int group_len = max_num_regs * block * sizeof(float);
-  for (int g = 0; g < num_groups; ++g) {
-    pool_height<ymm_t>(g * group_len, block, max_num_regs);
-  }
-  if (rest_num_regs > 0) {
-    pool_height<ymm_t>(num_groups * group_len, block, rest_num_regs);
+  int w_offset = 0;
+  int rest = w_;
+  if (platform::MayIUse(platform::avx512f)) {
+    w_offset = pool_blocks<zmm_t>(w_offset, ZMM_FLOAT_BLOCK,
+                                  rest / ZMM_FLOAT_BLOCK, max_num_regs);
+    rest %= ZMM_FLOAT_BLOCK;
   }
+  w_offset = pool_blocks<ymm_t>(w_offset, YMM_FLOAT_BLOCK,
+                                rest / YMM_FLOAT_BLOCK, max_num_regs);
+  rest %= YMM_FLOAT_BLOCK;
   // part of rest_w * height
-  const int rest = w_ % block;
-  pool_height_of_rest_width(rest, (w_ - rest) * sizeof(float), max_num_regs);
+  pool_height_of_rest_width(rest, w_offset, max_num_regs);
   ret();
 }
 
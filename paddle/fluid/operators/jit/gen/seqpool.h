@@ -54,6 +54,23 @@ class SeqPoolJitCode : public JitCode {
   void genCode() override;
 
  protected:
+  // pool num_block blocks of the width from w_offset, and return the offset
+  // after them
+  template <typename JMM>
+  int pool_blocks(int w_offset, int block, int num_block, int max_num_regs) {
+    const int num_groups = num_block / max_num_regs;
+    const int rest_num_regs = num_block % max_num_regs;
+    const int group_len = max_num_regs * block * sizeof(float);
+    for (int g = 0; g < num_groups; ++g) {
+      pool_height<JMM>(w_offset + g * group_len, block, max_num_regs);
+    }
+    if (rest_num_regs > 0) {
+      pool_height<JMM>(w_offset + num_groups * group_len, block,
+                       rest_num_regs);
+    }
+    return w_offset + num_block * block * sizeof(float);
+  }
+
   template <typename JMM>
   void pool_height(int w_offset, int block, int max_num_regs) {
     int offset = w_offset;
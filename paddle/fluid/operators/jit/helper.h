@@ -25,12 +25,16 @@
 #include "paddle/fluid/operators/jit/kernel_base.h"
 #include "paddle/fluid/operators/jit/kernel_key.h"
 #include "paddle/fluid/operators/jit/kernel_pool.h"
+#include "paddle/fluid/operators/jit/tuner.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
 namespace operators {
 namespace jit {
 
+const char* to_string(KernelType kt);
+const char* to_string(SeqPoolType kt);
+
 template <typename KernelTuple, typename PlaceType>
 inline typename std::enable_if<
     std::is_same<typename KernelTuple::data_type, float>::value &&
@@ -177,6 +181,51 @@ typename KernelTuple::func_type GetDefaultBestFunc(
   return funcs[0];
 }
 
+// Time all the candidates of this attr and return the fastest one, which is
+// cached in the TunedKernelTable. The kernels which can not be timed return
+// the default best one.
+template <typename KernelTuple, typename PlaceType = platform::CPUPlace>
+typename KernelTuple::func_type GetTunedBestFunc(
+    const typename KernelTuple::attr_type& attr) {
+  using Func = typename KernelTuple::func_type;
+  using Attr = typename KernelTuple::attr_type;
+  using T = typename KernelTuple::data_type;
+  auto funcs = GetAllCandidateFuncsWithTypes<KernelTuple, PlaceType>(attr);
+  PADDLE_ENFORCE_GE(funcs.size(), 1UL);
+  if (!TuneRunner<Func, Attr>::kTunable || funcs.size() == 1UL) {
+    return funcs[0].second;
+  }
+
+  std::string key = std::string(to_string(KernelTuple::kernel_type)) + "_" +
+                    std::to_string(sizeof(T) * 8) + "_" +
+                    std::to_string(JitCodeKey<Attr>(attr));
+  auto& table = TunedKernelTable::Instance();
+  std::string impl_type;
+  if (table.Get(key, &impl_type)) {
+    for (auto& func : funcs) {
+      if (func.first == impl_type) {
+        return func.second;
+      }
+    }
+    // the tuned implementation can not be used on this machine
+  }
+
+  TuneRunner<Func, Attr> runner(attr);
+  size_t best = 0;
+  double best_time = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    double time = TimeKernel<Func, Attr>(funcs[i].second, &runner);
+    VLOG(4) << key << ": " << funcs[i].first << " takes " << time << " us";
+    if (time < best_time) {
+      best_time = time;
+      best = i;
+    }
+  }
+  VLOG(3) << "Tunes jit kernel " << key << " to " << funcs[best].first;
+  table.Set(key, funcs[best].first);
+  return funcs[best].second;
+}
+
 extern std::map<size_t, std::shared_ptr<void>>& GetFuncCacheMap();
 
 template <typename KernelTuple, typename PlaceType>
@@ -205,8 +254,11 @@ class KernelFuncs {
     if (Has(key)) {
       return funcs_.at(key);
     }
-    // If do not have this attr in cache then get the default best
-    auto func = GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
+    // If do not have this attr in cache then get the default best, or the
+    // fastest one by timing when auto tuned
+    auto func = FLAGS_jit_kernel_auto_tune
+                    ? GetTunedBestFunc<KernelTuple, PlaceType>(attr)
+                    : GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
     Insert(key, func);
     return func;
   }
@@ -227,9 +279,6 @@ class KernelFuncs {
   DISABLE_COPY_AND_ASSIGN(KernelFuncs);
 };
 
-const char* to_string(KernelType kt);
-const char* to_string(SeqPoolType kt);
-
 KernelType to_kerneltype(const std::string& act);
 
 inline std::ostream& operator<<(std::ostream& os, const lstm_attr_t& attr) {
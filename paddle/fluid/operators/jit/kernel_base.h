@@ -34,9 +34,11 @@ typedef enum {
   kLSTMCtHt,
   kLSTMC1H1,
   kLayerNorm,
+  kMaskedSoftmax,
   kMatMul,
   kNCHW16CMulNC,
   kSeqPool,
+  kSkipLayerNorm,
   kSoftmax,
   kStrideASum,
   kStrideScal,
@@ -310,6 +312,25 @@ struct SoftmaxTuple {
   typedef void (*func_type)(const T*, T*, int, int, int);
 };
 
+// out = layer_norm(x + y)
+template <typename T>
+struct SkipLayerNormTuple {
+  static constexpr KernelType kernel_type = kSkipLayerNorm;
+  typedef T data_type;
+  typedef int attr_type;
+  typedef void (*func_type)(const T*, const T*, T*, const T*, const T*, int,
+                            const float, int);
+};
+
+// y = softmax(x * scale + mask)
+template <typename T>
+struct MaskedSoftmaxTuple {
+  static constexpr KernelType kernel_type = kMaskedSoftmax;
+  typedef T data_type;
+  typedef int attr_type;
+  typedef void (*func_type)(const T*, const T*, T*, const float, int, int);
+};
+
 // nChw16c = nChw16c .* NC
 template <typename T>
 struct NCHW16CMulNCTuple {
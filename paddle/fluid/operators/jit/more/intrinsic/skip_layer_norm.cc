@@ -0,0 +1,119 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/intrinsic/skip_layer_norm.h"
+#include <cmath>
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+static inline float HorizontalSum(__m256 v) {
+  __m128 sum =
+      _mm_add_ps(_mm256_extractf128_ps(v, 0), _mm256_extractf128_ps(v, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+
+// Every row of x + y is added, normalized, scaled and shifted in three
+// passes over the row, which stays in the cache between the passes.
+void SkipLayerNorm(const float* x, const float* y, float* out,
+                   const float* scale, const float* bias, int height,
+                   const float epsilon, int right) {
+  const int block = YMM_FLOAT_BLOCK;
+  const int end = right - right % block;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < height; ++i) {
+    const float* x_row = x + i * right;
+    const float* y_row = y + i * right;
+    float* out_row = out + i * right;
+    __m256 tmp;
+    int j;
+
+    /* add and get mean */
+    __m256 sum = _mm256_setzero_ps();
+    for (j = 0; j < end; j += block) {
+      tmp = _mm256_add_ps(_mm256_loadu_ps(x_row + j),
+                          _mm256_loadu_ps(y_row + j));
+      _mm256_storeu_ps(out_row + j, tmp);
+      sum = _mm256_add_ps(sum, tmp);
+    }
+    float mean = HorizontalSum(sum);
+    for (; j < right; ++j) {
+      out_row[j] = x_row[j] + y_row[j];
+      mean += out_row[j];
+    }
+    mean /= right;
+
+    /* get variance */
+    __m256 mean_vec = _mm256_set1_ps(mean);
+    sum = _mm256_setzero_ps();
+    for (j = 0; j < end; j += block) {
+      tmp = _mm256_sub_ps(_mm256_loadu_ps(out_row + j), mean_vec);
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(tmp, tmp));
+    }
+    float var = HorizontalSum(sum);
+    for (; j < right; ++j) {
+      var += (out_row[j] - mean) * (out_row[j] - mean);
+    }
+    var /= right;
+
+    /* normalize and calculate output */
+    float sqrt_var = std::sqrt(var + epsilon);
+    __m256 sqrt_var_vec = _mm256_set1_ps(sqrt_var);
+    for (j = 0; j < end; j += block) {
+      tmp = _mm256_div_ps(
+          _mm256_sub_ps(_mm256_loadu_ps(out_row + j), mean_vec), sqrt_var_vec);
+      if (scale) {
+        tmp = _mm256_mul_ps(tmp, _mm256_loadu_ps(scale + j));
+      }
+      if (bias) {
+        tmp = _mm256_add_ps(tmp, _mm256_loadu_ps(bias + j));
+      }
+      _mm256_storeu_ps(out_row + j, tmp);
+    }
+    for (; j < right; ++j) {
+      float res = (out_row[j] - mean) / sqrt_var;
+      if (scale) {
+        res *= scale[j];
+      }
+      if (bias) {
+        res += bias[j];
+      }
+      out_row[j] = res;
+    }
+  }
+}
+
+bool SkipLayerNormKernel::CanBeUsed(const int& d) const {
+  return platform::MayIUse(platform::avx) && d >= YMM_FLOAT_BLOCK;
+}
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace intrinsic = paddle::operators::jit::more::intrinsic;
+
+REGISTER_JITKERNEL_MORE(kSkipLayerNorm, intrinsic,
+                        intrinsic::SkipLayerNormKernel);
@@ -85,6 +85,36 @@ void Softmax(const T* x, T* y, int n, int bs, int remain) {
   }
 }
 
+// all the steps of a row run before the next row, while the row is still in
+// the cache
+void MaskedSoftmax(const T* x, const T* mask, T* y, const float scale, int n,
+                   int bs) {
+  auto compute_hmax = KernelFuncs<HMaxTuple<T>, CPUPlace>::Cache().At(n);
+  auto compute_hsum = KernelFuncs<HSumTuple<T>, CPUPlace>::Cache().At(n);
+  auto compute_vscal = KernelFuncs<VScalTuple<T>, CPUPlace>::Cache().At(n);
+  auto compute_vadd = KernelFuncs<VAddTuple<T>, CPUPlace>::Cache().At(n);
+  auto compute_vaddbias =
+      KernelFuncs<VAddBiasTuple<T>, CPUPlace>::Cache().At(n);
+  auto compute_vexp = KernelFuncs<VExpTuple<T>, CPUPlace>::Cache().At(n);
+
+  T alpha = static_cast<T>(scale);
+  for (int i = 0; i < bs; ++i) {
+    T scalar;
+    compute_vscal(&alpha, x, y, n);
+    compute_vadd(y, mask, y, n);  // x * scale + mask
+    compute_hmax(y, &scalar, n);
+    scalar = static_cast<T>(0) - scalar;
+    compute_vaddbias(&scalar, y, y, n);  // - max
+    compute_vexp(y, y, n);
+    compute_hsum(y, &scalar, n);
+    scalar = static_cast<T>(1) / scalar;
+    compute_vscal(&scalar, y, y, n);
+    x += n;
+    mask += n;
+    y += n;
+  }
+}
+
 void (*getActFunc(KernelType type, int d))(const T*, T*, int) {  // NOLINT
   if (type == kVSigmoid) {
     return KernelFuncs<VSigmoidTuple<T>, CPUPlace>::Cache().At(d);
@@ -223,6 +253,8 @@ bool VTanhKernel::CanBeUsed(const int& d) const { return true; }
 
 bool SoftmaxKernel::CanBeUsed(const int& d) const { return true; }
 
+bool MaskedSoftmaxKernel::CanBeUsed(const int& d) const { return true; }
+
 bool LSTMCtHtKernel::CanBeUsed(const lstm_attr_t& attr) const { return true; }
 
 bool LSTMC1H1Kernel::CanBeUsed(const lstm_attr_t& attr) const { return true; }
@@ -247,6 +279,7 @@ namespace mix = paddle::operators::jit::more::mix;
 REGISTER_MORE_KERNEL(VSigmoid);
 REGISTER_MORE_KERNEL(VTanh);
 REGISTER_MORE_KERNEL(Softmax);
+REGISTER_MORE_KERNEL(MaskedSoftmax);
 REGISTER_MORE_KERNEL(LSTMCtHt);
 REGISTER_MORE_KERNEL(LSTMC1H1);
 REGISTER_MORE_KERNEL(GRUH1);
@@ -27,6 +27,8 @@ using T = float;
 void VSigmoid(const T* x, T* y, int n);
 void VTanh(const T* x, T* y, int n);
 void Softmax(const T* x, T* y, int n, int bs, int remain);
+void MaskedSoftmax(const T* x, const T* mask, T* y, const float scale, int n,
+                   int bs);
 
 void LSTMCtHt(lstm_t* step, const lstm_attr_t* attr);
 void LSTMC1H1(lstm_t* step, const lstm_attr_t* attr);
@@ -48,6 +50,7 @@ DECLARE_MORE_KERNEL(VTanh);
 
 // XRN
 DECLARE_MORE_KERNEL(Softmax);
+DECLARE_MORE_KERNEL(MaskedSoftmax);
 
 DECLARE_MORE_KERNEL(LSTMCtHt);
 DECLARE_MORE_KERNEL(LSTMC1H1);
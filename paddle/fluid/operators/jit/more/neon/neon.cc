@@ -0,0 +1,352 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/neon/neon.h"
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include "paddle/fluid/operators/jit/macro.h"
+#include "paddle/fluid/operators/jit/registry.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace neon {
+
+namespace {
+
+constexpr int kBlock = 4;
+
+// The cephes polynomial approximation of exp, the same as the jitcode one.
+inline float32x4_t Exp(float32x4_t x) {
+  x = vminq_f32(x, vdupq_n_f32(88.3762626647949f));
+  x = vmaxq_f32(x, vdupq_n_f32(-88.3762626647949f));
+  // exp(x) = 2^n * exp(g), n = floor(x / ln2 + 0.5)
+  float32x4_t fx =
+      vfmaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(1.44269504088896341f));
+  fx = vrndmq_f32(fx);
+  x = vfmsq_f32(x, fx, vdupq_n_f32(0.693359375f));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(-2.12194440e-4f));
+  float32x4_t z = vmulq_f32(x, x);
+  float32x4_t y = vdupq_n_f32(1.9875691500E-4f);
+  y = vfmaq_f32(vdupq_n_f32(1.3981999507E-3f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(8.3334519073E-3f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(4.1665795894E-2f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(1.6666665459E-1f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(5.0000001201E-1f), y, x);
+  y = vfmaq_f32(vaddq_f32(x, vdupq_n_f32(1.f)), y, z);
+  // build 2^n from the exponent bits
+  int32x4_t n = vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(127));
+  float32x4_t pow2n = vreinterpretq_f32_s32(vshlq_n_s32(n, 23));
+  return vmulq_f32(y, pow2n);
+}
+
+inline float32x4_t Sigmoid(float32x4_t x) {
+  x = vminq_f32(x, vdupq_n_f32(SIGMOID_THRESHOLD_MAX));
+  x = vmaxq_f32(x, vdupq_n_f32(SIGMOID_THRESHOLD_MIN));
+  float32x4_t one = vdupq_n_f32(1.f);
+  return vdivq_f32(one, vaddq_f32(one, Exp(vnegq_f32(x))));
+}
+
+inline float ScalarSigmoid(float x) {
+  const float min = SIGMOID_THRESHOLD_MIN;
+  const float max = SIGMOID_THRESHOLD_MAX;
+  float tmp = x < min ? min : (x > max ? max : x);
+  return 1.f / (1.f + std::exp(-tmp));
+}
+
+}  // namespace
+
+void VMul(const T* x, const T* y, T* z, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(z + i, vmulq_f32(vld1q_f32(x + i), vld1q_f32(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] * y[i];
+  }
+}
+
+void VAdd(const T* x, const T* y, T* z, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(z + i, vaddq_f32(vld1q_f32(x + i), vld1q_f32(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] + y[i];
+  }
+}
+
+void VAddRelu(const T* x, const T* y, T* z, int n) {
+  float32x4_t zero = vdupq_n_f32(0.f);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    float32x4_t sum = vaddq_f32(vld1q_f32(x + i), vld1q_f32(y + i));
+    vst1q_f32(z + i, vmaxq_f32(sum, zero));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] + y[i];
+    z[i] = z[i] > 0 ? z[i] : 0;
+  }
+}
+
+void VSub(const T* x, const T* y, T* z, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(z + i, vsubq_f32(vld1q_f32(x + i), vld1q_f32(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] - y[i];
+  }
+}
+
+void VScal(const T* a, const T* x, T* y, int n) {
+  float32x4_t alpha = vdupq_n_f32(a[0]);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, vmulq_f32(alpha, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = a[0] * x[i];
+  }
+}
+
+void VAddBias(const T* a, const T* x, T* y, int n) {
+  float32x4_t bias = vdupq_n_f32(a[0]);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, vaddq_f32(bias, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = a[0] + x[i];
+  }
+}
+
+void VRelu(const T* x, T* y, int n) {
+  float32x4_t zero = vdupq_n_f32(0.f);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, vmaxq_f32(vld1q_f32(x + i), zero));
+  }
+  for (; i < n; ++i) {
+    y[i] = x[i] > 0 ? x[i] : 0;
+  }
+}
+
+void VSquare(const T* x, T* y, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    float32x4_t tmp = vld1q_f32(x + i);
+    vst1q_f32(y + i, vmulq_f32(tmp, tmp));
+  }
+  for (; i < n; ++i) {
+    y[i] = x[i] * x[i];
+  }
+}
+
+void VExp(const T* x, T* y, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, Exp(vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = std::exp(x[i]);
+  }
+}
+
+void VSigmoid(const T* x, T* y, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, Sigmoid(vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = ScalarSigmoid(x[i]);
+  }
+}
+
+void VTanh(const T* x, T* y, int n) {
+  // y = 2 * sigmoid(2x) - 1
+  float32x4_t one = vdupq_n_f32(1.f);
+  float32x4_t two = vdupq_n_f32(2.f);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    float32x4_t tmp = Sigmoid(vmulq_f32(two, vld1q_f32(x + i)));
+    vst1q_f32(y + i, vfmsq_f32(vnegq_f32(one), vnegq_f32(two), tmp));
+  }
+  for (; i < n; ++i) {
+    y[i] = 2.f * ScalarSigmoid(2.f * x[i]) - 1.f;
+  }
+}
+
+void HMax(const T* x, T* res, int n) {
+  int i = 0;
+  float max = x[0];
+  if (n >= kBlock) {
+    float32x4_t tmp = vld1q_f32(x);
+    for (i = kBlock; i + kBlock <= n; i += kBlock) {
+      tmp = vmaxq_f32(tmp, vld1q_f32(x + i));
+    }
+    max = vmaxvq_f32(tmp);
+  }
+  for (; i < n; ++i) {
+    max = max < x[i] ? x[i] : max;
+  }
+  res[0] = max;
+}
+
+void HSum(const T* x, T* res, int n) {
+  float32x4_t tmp = vdupq_n_f32(0.f);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    tmp = vaddq_f32(tmp, vld1q_f32(x + i));
+  }
+  float sum = vaddvq_f32(tmp);
+  for (; i < n; ++i) {
+    sum += x[i];
+  }
+  res[0] = sum;
+}
+
+void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr) {
+  int w = attr->w;
+  // sum the rows block by block of the width, keeping y in the registers
+  int j = 0;
+  for (; j + kBlock <= w; j += kBlock) {
+    float32x4_t sum = vdupq_n_f32(0.f);
+    const T* src = x + j;
+    for (int h = 0; h < attr->h; ++h) {
+      sum = vaddq_f32(sum, vld1q_f32(src));
+      src += w;
+    }
+    vst1q_f32(y + j, sum);
+  }
+  for (; j < w; ++j) {
+    const T* src = x + j;
+    T sum = 0.f;
+    for (int h = 0; h < attr->h; ++h) {
+      sum += *src;
+      src += w;
+    }
+    y[j] = sum;
+  }
+  if (attr->type == SeqPoolType::kAvg || attr->type == SeqPoolType::kSqrt) {
+    T scalar = attr->type == SeqPoolType::kAvg
+                   ? 1.f / static_cast<T>(attr->h)
+                   : 1.f / std::sqrt(static_cast<T>(attr->h));
+    VScal(&scalar, y, y, w);
+  }
+}
+
+void LayerNorm(T* x, T* out, T* mean, T* var, const T* scale, const T* bias,
+               int height, const float epsilon, int right) {
+  for (int i = 0; i < height; ++i) {
+    const T* src = x + i * right;
+    T* dst = out + i * right;
+    float32x4_t sum = vdupq_n_f32(0.f);
+    float32x4_t sq_sum = vdupq_n_f32(0.f);
+    int j = 0;
+    for (; j + kBlock <= right; j += kBlock) {
+      float32x4_t tmp = vld1q_f32(src + j);
+      sum = vaddq_f32(sum, tmp);
+      sq_sum = vfmaq_f32(sq_sum, tmp, tmp);
+    }
+    T mean_value = vaddvq_f32(sum);
+    T sq_value = vaddvq_f32(sq_sum);
+    for (; j < right; ++j) {
+      mean_value += src[j];
+      sq_value += src[j] * src[j];
+    }
+    mean_value /= right;
+    // var = E(x^2) - E(x)^2, clamped against the rounding errors
+    T var_value = std::max(sq_value / right - mean_value * mean_value, 0.f);
+    mean[i] = mean_value;
+    var[i] = var_value;
+
+    T rstd = 1.f / std::sqrt(var_value + epsilon);
+    float32x4_t vmean = vdupq_n_f32(mean_value);
+    float32x4_t vrstd = vdupq_n_f32(rstd);
+    for (j = 0; j + kBlock <= right; j += kBlock) {
+      float32x4_t tmp =
+          vmulq_f32(vsubq_f32(vld1q_f32(src + j), vmean), vrstd);
+      if (scale) tmp = vmulq_f32(tmp, vld1q_f32(scale + j));
+      if (bias) tmp = vaddq_f32(tmp, vld1q_f32(bias + j));
+      vst1q_f32(dst + j, tmp);
+    }
+    for (; j < right; ++j) {
+      T tmp = (src[j] - mean_value) * rstd;
+      if (scale) tmp *= scale[j];
+      if (bias) tmp += bias[j];
+      dst[j] = tmp;
+    }
+  }
+}
+
+void Softmax(const T* x, T* y, int n, int bs, int remain) {
+  for (int i = 0; i < bs; ++i) {
+    T scalar;
+    HMax(x, &scalar, n);
+    scalar = -scalar;
+    VAddBias(&scalar, x, y, n);  // x - max
+    VExp(y, y, n);
+    if (remain == 1) {
+      HSum(y, &scalar, n);
+      scalar = 1.f / scalar;
+      VScal(&scalar, y, y, n);
+    } else {
+      for (int j = 0; j < remain; ++j) {
+        T sum = 0.f;
+        for (int k = j; k < n; k += remain) {
+          sum += y[k];
+        }
+        sum = 1.f / sum;
+        for (int k = j; k < n; k += remain) {
+          y[k] *= sum;
+        }
+      }
+    }
+    x += n;
+    y += n;
+  }
+}
+
+}  // namespace neon
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace neon = paddle::operators::jit::more::neon;
+
+#define REGISTER_NEON_KERNEL(func) \
+  REGISTER_JITKERNEL_MORE(k##func, neon, neon::func##Kernel)
+
+REGISTER_NEON_KERNEL(VMul);
+REGISTER_NEON_KERNEL(VAdd);
+REGISTER_NEON_KERNEL(VAddRelu);
+REGISTER_NEON_KERNEL(VSub);
+REGISTER_NEON_KERNEL(VScal);
+REGISTER_NEON_KERNEL(VAddBias);
+REGISTER_NEON_KERNEL(VRelu);
+REGISTER_NEON_KERNEL(VSquare);
+REGISTER_NEON_KERNEL(VExp);
+REGISTER_NEON_KERNEL(VSigmoid);
+REGISTER_NEON_KERNEL(VTanh);
+REGISTER_NEON_KERNEL(HMax);
+REGISTER_NEON_KERNEL(HSum);
+REGISTER_NEON_KERNEL(SeqPool);
+REGISTER_NEON_KERNEL(LayerNorm);
+REGISTER_NEON_KERNEL(Softmax);
+
+#undef REGISTER_NEON_KERNEL
@@ -0,0 +1,91 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <type_traits>
+#include "paddle/fluid/operators/jit/kernel_base.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace neon {
+using T = float;
+
+void VMul(const T* x, const T* y, T* z, int n);
+void VAdd(const T* x, const T* y, T* z, int n);
+void VAddRelu(const T* x, const T* y, T* z, int n);
+void VSub(const T* x, const T* y, T* z, int n);
+
+void VScal(const T* a, const T* x, T* y, int n);
+void VAddBias(const T* a, const T* x, T* y, int n);
+
+void VRelu(const T* x, T* y, int n);
+void VSquare(const T* x, T* y, int n);
+void VExp(const T* x, T* y, int n);
+void VSigmoid(const T* x, T* y, int n);
+void VTanh(const T* x, T* y, int n);
+
+void HMax(const T* x, T* res, int n);
+void HSum(const T* x, T* res, int n);
+
+void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr);
+void LayerNorm(T* x, T* out, T* mean, T* var, const T* scale, const T* bias,
+               int height, const float epsilon, int right);
+void Softmax(const T* x, T* y, int n, int bs, int remain);
+
+#define DECLARE_NEON_KERNEL(name)                                             \
+  class name##Kernel : public KernelMore<name##Tuple<T>> {                    \
+   public:                                                                    \
+    name##Kernel() { this->func = name; }                                     \
+    bool CanBeUsed(const typename name##Tuple<T>::attr_type&) const override { \
+      return true;                                                            \
+    }                                                                         \
+    const char* ImplType() const override { return "NEON"; }                  \
+  }
+
+// XYZN
+DECLARE_NEON_KERNEL(VMul);
+DECLARE_NEON_KERNEL(VAdd);
+DECLARE_NEON_KERNEL(VAddRelu);
+DECLARE_NEON_KERNEL(VSub);
+
+// AXYN
+DECLARE_NEON_KERNEL(VScal);
+DECLARE_NEON_KERNEL(VAddBias);
+
+// XYN
+DECLARE_NEON_KERNEL(VRelu);
+DECLARE_NEON_KERNEL(VSquare);
+DECLARE_NEON_KERNEL(VExp);
+DECLARE_NEON_KERNEL(VSigmoid);
+DECLARE_NEON_KERNEL(VTanh);
+
+// XRN
+DECLARE_NEON_KERNEL(HMax);
+DECLARE_NEON_KERNEL(HSum);
+DECLARE_NEON_KERNEL(Softmax);
+
+// others
+DECLARE_NEON_KERNEL(SeqPool);
+DECLARE_NEON_KERNEL(LayerNorm);
+
+#undef DECLARE_NEON_KERNEL
+
+}  // namespace neon
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -47,6 +47,7 @@ REGISTER_REFER_KERNEL(GRUHtPart2);
 
 REGISTER_REFER_KERNEL(CRFDecoding);
 REGISTER_REFER_KERNEL(LayerNorm);
+REGISTER_REFER_KERNEL(SkipLayerNorm);
 REGISTER_REFER_KERNEL(NCHW16CMulNC);
 REGISTER_REFER_KERNEL(SeqPool);
 REGISTER_REFER_KERNEL(MatMul);
@@ -54,6 +55,7 @@ REGISTER_REFER_KERNEL(HMax);
 REGISTER_REFER_KERNEL(HSum);
 REGISTER_REFER_KERNEL(StrideASum);
 REGISTER_REFER_KERNEL(Softmax);
+REGISTER_REFER_KERNEL(MaskedSoftmax);
 REGISTER_REFER_KERNEL(EmbSeqPool);
 REGISTER_REFER_KERNEL(Sgd);
 REGISTER_REFER_KERNEL(VBroadcast);
@@ -341,6 +341,40 @@ void LayerNorm(T* x, T* out, T* mean, T* var, const T* scale, const T* bias,
   }
 }
 
+// out = layer_norm(x + y), each row is normalized right after the add, while
+// it is still in the cache
+template <typename T>
+void SkipLayerNorm(const T* x, const T* y, T* out, const T* scale,
+                   const T* bias, int height, const float epsilon, int right) {
+  for (int i = 0; i < height; i++) {
+    int offset = i * right;
+    T mean = 0.0;
+    for (int j = 0; j < right; j++) {
+      out[offset + j] = x[offset + j] + y[offset + j];
+      mean += out[offset + j];
+    }
+    mean /= right;
+
+    T var = 0.0;
+    for (int j = 0; j < right; j++) {
+      var += (out[offset + j] - mean) * (out[offset + j] - mean);
+    }
+    var /= right;
+
+    T sqrt_var = std::sqrt(var + (T)epsilon);
+    for (int j = 0; j < right; j++) {
+      T res = (out[offset + j] - mean) / sqrt_var;
+      if (scale) {
+        res *= scale[j];
+      }
+      if (bias) {
+        res += bias[j];
+      }
+      out[offset + j] = res;
+    }
+  }
+}
+
 template <typename T>
 void NCHW16CMulNC(const T* x, const T* y, T* z, int height, int width) {
   int offset = 0;
@@ -457,6 +491,21 @@ void Softmax(const T* x, T* y, int n, int bs = 1, int remain = 1) {
   }
 }
 
+// y = softmax(x * scale + mask) of the bs rows of length n
+template <typename T>
+void MaskedSoftmax(const T* x, const T* mask, T* y, const float scale, int n,
+                   int bs) {
+  T alpha = static_cast<T>(scale);
+  for (int i = 0; i < bs; ++i) {
+    VScal(&alpha, x, y, n);
+    VAdd(y, mask, y, n);
+    Softmax(y, y, n);
+    x += n;
+    mask += n;
+    y += n;
+  }
+}
+
 // embedding seq pool
 // table is a matrix with (tbl_h, tbl_w)
 // idx is a matrix with (idx_h, idx_w)
@@ -564,10 +613,12 @@ DECLARE_REFER_KERNEL(StrideASum);
 // others
 DECLARE_REFER_KERNEL(CRFDecoding);
 DECLARE_REFER_KERNEL(LayerNorm);
+DECLARE_REFER_KERNEL(SkipLayerNorm);
 DECLARE_REFER_KERNEL(NCHW16CMulNC);
 DECLARE_REFER_KERNEL(SeqPool);
 DECLARE_REFER_KERNEL(MatMul);
 DECLARE_REFER_KERNEL(Softmax);
+DECLARE_REFER_KERNEL(MaskedSoftmax);
 DECLARE_REFER_KERNEL(EmbSeqPool);
 DECLARE_REFER_KERNEL(Sgd);
 DECLARE_REFER_KERNEL(VBroadcast);
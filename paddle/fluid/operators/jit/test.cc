@@ -529,6 +529,61 @@ void TestKernelLayerNorm() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void TestKernelSkipLayerNorm() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  const T epsilon = 9.99999975e-06;
+  for (int left : {1, 9, 17, 50}) {
+    for (int right : TestSizes()) {
+      auto ref = jit::GetReferFunc<KernelTuple>();
+      EXPECT_TRUE(ref != nullptr);
+      int sz = left * right;
+      std::vector<T> x(sz), y(sz), scale(right), bias(right), outref(sz);
+      RandomVec<T>(sz, x.data());
+      RandomVec<T>(sz, y.data());
+      RandomVec<T>(right, scale.data());
+      RandomVec<T>(right, bias.data());
+      ref(x.data(), y.data(), outref.data(), scale.data(), bias.data(), left,
+          epsilon, right);
+
+      // the same as the add followed by the layer norm
+      auto layer_norm = jit::GetReferFunc<jit::LayerNormTuple<T>>();
+      std::vector<T> sum(sz), mean(left), var(left), outtgt(sz);
+      for (int i = 0; i < sz; ++i) {
+        sum[i] = x[i] + y[i];
+      }
+      layer_norm(sum.data(), outtgt.data(), mean.data(), var.data(),
+                 scale.data(), bias.data(), left, epsilon, right);
+      ExpectEQ<T>(outtgt.data(), outref.data(), sz);
+
+      auto verifier = [](const typename KernelTuple::func_type tgt,
+                         const std::vector<T>& x, const std::vector<T>& y,
+                         const std::vector<T>& scale,
+                         const std::vector<T>& bias,
+                         const std::vector<T>& outref, int left,
+                         const float epsilon, int right) {
+        EXPECT_TRUE(tgt != nullptr);
+        EXPECT_EQ(x.size(), static_cast<size_t>(left * right));
+        std::vector<T> outtgt(outref.size());
+        tgt(x.data(), y.data(), outtgt.data(), scale.data(), bias.data(), left,
+            epsilon, right);
+        ExpectEQ<T>(outtgt.data(), outref.data(), left * right);
+        // without scale and bias
+        std::vector<T> outnone(outref.size());
+        auto ref = jit::GetReferFunc<KernelTuple>();
+        ref(x.data(), y.data(), outnone.data(), nullptr, nullptr, left,
+            epsilon, right);
+        tgt(x.data(), y.data(), outtgt.data(), nullptr, nullptr, left, epsilon,
+            right);
+        ExpectEQ<T>(outtgt.data(), outnone.data(), left * right);
+      };
+      TestAllImpls<KernelTuple, PlaceType>(right, verifier, x, y, scale, bias,
+                                           outref, left, epsilon, right);
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void TestKernelCRFDecoding() {
   using T = typename KernelTuple::data_type;
@@ -765,6 +820,50 @@ void TestKernelSoftmax() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void TestKernelMaskedSoftmax() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  const float scale = 0.125f;
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      auto ref = jit::GetReferFunc<KernelTuple>();
+      EXPECT_TRUE(ref != nullptr);
+      std::vector<T> x(bs * n), mask(bs * n), y(bs * n);
+      RandomVec<T>(bs * n, x.data());
+      RandomVec<T>(bs * n, mask.data());
+      ref(x.data(), mask.data(), y.data(), scale, n, bs);
+
+      // the same as the scale and the add followed by the softmax
+      auto softmax = jit::GetReferFunc<jit::SoftmaxTuple<T>>();
+      std::vector<T> xinp(bs * n);
+      for (int i = 0; i < bs * n; ++i) {
+        xinp[i] = x[i] * static_cast<T>(scale) + mask[i];
+      }
+      softmax(xinp.data(), xinp.data(), n, bs, 1);
+      ExpectEQ<T>(xinp.data(), y.data(), bs * n);
+
+      auto verifier = [](const typename KernelTuple::func_type tgt,
+                         const std::vector<T>& x, const std::vector<T>& mask,
+                         const std::vector<T>& yref, const float scale, int n,
+                         int bs) {
+        EXPECT_TRUE(tgt != nullptr);
+        EXPECT_EQ(x.size(), static_cast<size_t>(n * bs));
+        std::vector<T> ytgt(n * bs);
+        // test normal
+        tgt(x.data(), mask.data(), ytgt.data(), scale, n, bs);
+        ExpectEQ<T>(ytgt.data(), yref.data(), n * bs);
+        // test inplace x
+        std::copy(x.begin(), x.end(), ytgt.begin());
+        tgt(ytgt.data(), mask.data(), ytgt.data(), scale, n, bs);
+        ExpectEQ<T>(ytgt.data(), yref.data(), n * bs);
+      };
+      TestAllImpls<KernelTuple, PlaceType>(n, verifier, x, mask, y, scale, n,
+                                           bs);
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void TestKernelStrideASum() {
   using T = typename KernelTuple::data_type;
@@ -1088,6 +1187,40 @@ TEST(JITKernel_helper, GetAllCandidateFuncs) {
   }
 }
 
+TEST(JITKernel_helper, GetTunedBestFunc) {
+  std::vector<float> x(100), y(100), tgt(100), ref(100);
+  RandomVec<float>(100, x.data());
+  RandomVec<float>(100, y.data());
+  auto ref_add = jit::GetReferFunc<jit::VAddTuple<float>>();
+  ref_add(x.data(), y.data(), ref.data(), 100);
+
+  auto funcs = jit::GetAllCandidateFuncsWithTypes<jit::VAddTuple<float>,
+                                                  CPUPlace>(100);
+  auto tuned = jit::GetTunedBestFunc<jit::VAddTuple<float>, CPUPlace>(100);
+  tuned(x.data(), y.data(), tgt.data(), 100);
+  ExpectEQ<float>(tgt.data(), ref.data(), 100);
+  // the winner is cached
+  std::string impl_type;
+  EXPECT_EQ(jit::TunedKernelTable::Instance().Get("kVAdd_32_100", &impl_type),
+            funcs.size() > 1UL);
+  EXPECT_TRUE(tuned ==
+              (jit::GetTunedBestFunc<jit::VAddTuple<float>, CPUPlace>(100)));
+
+  // the kernels without the runners keep the default best one
+  jit::seq_pool_attr_t attr(10, jit::SeqPoolType::kSum);
+  attr.h = 3;
+  EXPECT_TRUE(
+      (jit::GetTunedBestFunc<jit::SeqPoolTuple<float>, CPUPlace>(attr)) ==
+      (jit::GetDefaultBestFunc<jit::SeqPoolTuple<float>, CPUPlace>(attr)));
+
+  // all the runners work
+  jit::GetTunedBestFunc<jit::VExpTuple<double>, CPUPlace>(10);
+  jit::GetTunedBestFunc<jit::SoftmaxTuple<float>, CPUPlace>(10);
+  jit::GetTunedBestFunc<jit::LayerNormTuple<float>, CPUPlace>(10);
+  jit::GetTunedBestFunc<jit::MatMulTuple<float>, CPUPlace>(
+      jit::matmul_attr_t(3, 4, 5));
+}
+
 TEST(JITKernel_helper, pack_weights) {
   const int N = 8 * 60, K = 2;
   float src[K][N], yref[K][N], y[K * N];
@@ -1131,8 +1264,9 @@ TEST(JITKernel_helper, attr) {
       << jit::to_string(jit::kGRUHtPart1) << jit::to_string(jit::kGRUHtPart2)
       << jit::to_string(jit::kHSum) << jit::to_string(jit::kHMax)
       << jit::to_string(jit::kLSTMCtHt) << jit::to_string(jit::kLSTMC1H1)
-      << jit::to_string(jit::kLayerNorm) << jit::to_string(jit::kMatMul)
-      << jit::to_string(jit::kNCHW16CMulNC) << jit::to_string(jit::kSeqPool)
+      << jit::to_string(jit::kLayerNorm) << jit::to_string(jit::kMaskedSoftmax)
+      << jit::to_string(jit::kMatMul) << jit::to_string(jit::kNCHW16CMulNC)
+      << jit::to_string(jit::kSeqPool) << jit::to_string(jit::kSkipLayerNorm)
       << jit::to_string(jit::kSoftmax) << jit::to_string(jit::kVAdd)
       << jit::to_string(jit::kVAddBias) << jit::to_string(jit::kVAddRelu)
       << jit::to_string(jit::kVBroadcast) << jit::to_string(jit::kVCopy)
@@ -1141,7 +1275,7 @@ TEST(JITKernel_helper, attr) {
       << jit::to_string(jit::kVScal) << jit::to_string(jit::kSgd)
       << jit::to_string(jit::kVSigmoid) << jit::to_string(jit::kVSquare)
       << jit::to_string(jit::kVSub) << jit::to_string(jit::kVTanh);
-  EXPECT_EQ(out.str().size(), 234UL);
+  EXPECT_EQ(out.str().size(), 262UL);
 
   // SeqPoolTypes
   out.str("");
@@ -1369,12 +1503,14 @@ TEST_CPU_KERNEL(GRUHtPart2);
 
 TEST_CPU_KERNEL(NCHW16CMulNC);
 TEST_CPU_KERNEL(LayerNorm);
+TEST_CPU_KERNEL(SkipLayerNorm);
 TEST_CPU_KERNEL(CRFDecoding);
 
 TEST_CPU_KERNEL(SeqPool);
 TEST_CPU_KERNEL(EmbSeqPool);
 TEST_CPU_KERNEL(MatMul);
 TEST_CPU_KERNEL(Softmax);
+TEST_CPU_KERNEL(MaskedSoftmax);
 TEST_CPU_KERNEL(Sgd);
 TEST_CPU_KERNEL(VBroadcast);
 
@@ -0,0 +1,71 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/tuner.h"
+#include <fstream>
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_bool(jit_kernel_auto_tune, false,
+            "Whether to choose the implementations of the jit kernels by "
+            "timing all the candidates on the first use of every attr, "
+            "instead of the offline tuned order.");
+DEFINE_string(jit_kernel_tune_file, "",
+              "The file to load and save the auto tuned jit kernels, so that "
+              "the kernels are only timed once on a machine.");
+
+namespace paddle {
+namespace operators {
+namespace jit {
+
+TunedKernelTable& TunedKernelTable::Instance() {
+  static TunedKernelTable table;
+  return table;
+}
+
+TunedKernelTable::TunedKernelTable() {
+  if (FLAGS_jit_kernel_tune_file.empty()) return;
+  std::ifstream file(FLAGS_jit_kernel_tune_file);
+  std::string key, impl_type;
+  while (file >> key >> impl_type) {
+    table_[key] = impl_type;
+  }
+  VLOG(3) << "Loads " << table_.size() << " tuned jit kernels from "
+          << FLAGS_jit_kernel_tune_file;
+}
+
+bool TunedKernelTable::Get(const std::string& key, std::string* impl_type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = table_.find(key);
+  if (it == table_.end()) return false;
+  *impl_type = it->second;
+  return true;
+}
+
+void TunedKernelTable::Set(const std::string& key,
+                           const std::string& impl_type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  table_[key] = impl_type;
+  if (FLAGS_jit_kernel_tune_file.empty()) return;
+  std::ofstream file(FLAGS_jit_kernel_tune_file, std::ios::app);
+  if (!file.is_open()) {
+    LOG(WARNING) << "Can not save the tuned jit kernels to "
+                 << FLAGS_jit_kernel_tune_file;
+    return;
+  }
+  file << key << " " << impl_type << "\n";
+}
+
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
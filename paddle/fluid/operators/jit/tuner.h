@@ -0,0 +1,163 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <chrono>  // NOLINT
+#include <limits>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernel_base.h"
+
+DECLARE_bool(jit_kernel_auto_tune);
+DECLARE_string(jit_kernel_tune_file);
+
+namespace paddle {
+namespace operators {
+namespace jit {
+
+// The implementation types, e.g., JitCode, MKL or Refer, which are the
+// fastest for the kernels, shared by all the threads of the process. The key
+// is made of the kernel type, the data type and the attr. When
+// FLAGS_jit_kernel_tune_file is set, the table is loaded from the file and
+// every new winner is appended to it, one "key impl_type" per line.
+class TunedKernelTable {
+ public:
+  static TunedKernelTable& Instance();
+
+  bool Get(const std::string& key, std::string* impl_type);
+  void Set(const std::string& key, const std::string& impl_type);
+
+ private:
+  TunedKernelTable();
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::string> table_;
+};
+
+// Time a kernel on the synthetic inputs created from its attr. Only the
+// kernels of the signatures specialized below can be tuned, the others keep
+// the default best implementation.
+template <typename Func, typename Attr>
+struct TuneRunner {
+  static constexpr bool kTunable = false;
+  explicit TuneRunner(const Attr& attr) {}
+  void Run(Func func) {}
+};
+
+// the average time of a run in microseconds
+template <typename Func, typename Attr>
+double TimeKernel(Func func, TuneRunner<Func, Attr>* runner) {
+  constexpr int kWarmup = 3;
+  constexpr int kRepeat = 50;
+  for (int i = 0; i < kWarmup; ++i) {
+    runner->Run(func);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) {
+    runner->Run(func);
+  }
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kRepeat;
+}
+
+template <typename T>
+std::vector<T> TuneInput(size_t size) {
+  std::vector<T> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<T>(static_cast<int>(i % 17) - 8) / 16;
+  }
+  return data;
+}
+
+// XYZN and AXYN, e.g., VAdd and VScal
+template <typename T>
+struct TuneRunner<void (*)(const T*, const T*, T*, int), int> {
+  static constexpr bool kTunable = true;
+  explicit TuneRunner(const int& d)
+      : n(d), x(TuneInput<T>(d)), y(TuneInput<T>(d)), z(d) {}
+  void Run(void (*func)(const T*, const T*, T*, int)) {
+    func(x.data(), y.data(), z.data(), n);
+  }
+  int n;
+  std::vector<T> x, y, z;
+};
+
+// XYN and XRN, e.g., VExp and HMax
+template <typename T>
+struct TuneRunner<void (*)(const T*, T*, int), int> {
+  static constexpr bool kTunable = true;
+  explicit TuneRunner(const int& d) : n(d), x(TuneInput<T>(d)), y(d) {}
+  void Run(void (*func)(const T*, T*, int)) { func(x.data(), y.data(), n); }
+  int n;
+  std::vector<T> x, y;
+};
+
+// Softmax of one row
+template <typename T>
+struct TuneRunner<void (*)(const T*, T*, int, int, int), int> {
+  static constexpr bool kTunable = true;
+  explicit TuneRunner(const int& d) : n(d), x(TuneInput<T>(d)), y(d) {}
+  void Run(void (*func)(const T*, T*, int, int, int)) {
+    func(x.data(), y.data(), n, 1, 1);
+  }
+  int n;
+  std::vector<T> x, y;
+};
+
+// LayerNorm of one row
+template <typename T>
+struct TuneRunner<void (*)(T*, T*, T*, T*, const T*, const T*, int,
+                           const float, int),
+                  int> {
+  static constexpr bool kTunable = true;
+  explicit TuneRunner(const int& d)
+      : n(d),
+        x(TuneInput<T>(d)),
+        out(d),
+        scale(TuneInput<T>(d)),
+        bias(TuneInput<T>(d)) {}
+  void Run(void (*func)(T*, T*, T*, T*, const T*, const T*, int, const float,
+                        int)) {
+    T mean, var;
+    func(x.data(), out.data(), &mean, &var, scale.data(), bias.data(), 1, 1e-5f,
+         n);
+  }
+  int n;
+  std::vector<T> x, out, scale, bias;
+};
+
+template <typename T>
+struct TuneRunner<void (*)(const T*, const T*, T*, const matmul_attr_t*),
+                  matmul_attr_t> {
+  static constexpr bool kTunable = true;
+  explicit TuneRunner(const matmul_attr_t& attr)
+      : attr(attr),
+        a(TuneInput<T>(attr.m * attr.k)),
+        b(TuneInput<T>(attr.k * attr.n)),
+        c(attr.m * attr.n) {}
+  void Run(void (*func)(const T*, const T*, T*, const matmul_attr_t*)) {
+    func(a.data(), b.data(), c.data(), &attr);
+  }
+  matmul_attr_t attr;
+  std::vector<T> a, b, c;
+};
+
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -42,6 +42,7 @@ class LiteEngineOp : public framework::OperatorBase {
   paddle::lite::Predictor *engine_;
   framework::proto::VarType::Type precision_;
   bool use_gpu_;
+  bool zero_copy_;
 
  public:
   LiteEngineOp(const std::string &type,
@@ -60,6 +61,7 @@ class LiteEngineOp : public framework::OperatorBase {
       precision_ = framework::proto::VarType_Type_FP32;
     }
     use_gpu_ = Attr<bool>("use_gpu");
+    zero_copy_ = HasAttr("zero_copy") && Attr<bool>("zero_copy");
   }
 
  protected:
@@ -73,13 +75,19 @@ class LiteEngineOp : public framework::OperatorBase {
     const platform::DeviceContext *ctx =
         platform::DeviceContextPool::Instance().Get(dev_place);
     for (size_t i = 0; i < in_names_.size(); i++) {
-      const framework::LoDTensor &src_t =
+      framework::LoDTensor &src_t =
           inference::analysis::GetFromScope<framework::LoDTensor>(scope,
                                                                   in_names_[i]);
       paddle::lite::Tensor *dst_t = engine_->GetInput(i);
-      VLOG(3) << "[Copy] fluid -> lite (" << in_names_[i] << " -> "
-              << engine_->GetInputNames()[i] << ")";
-      inference::lite::utils::TensorCopyAsync(dst_t, src_t, *ctx);
+      if (zero_copy_) {
+        VLOG(3) << "[Share] fluid -> lite (" << in_names_[i] << " -> "
+                << engine_->GetInputNames()[i] << ")";
+        inference::lite::utils::TensorDataShare(dst_t, &src_t);
+      } else {
+        VLOG(3) << "[Copy] fluid -> lite (" << in_names_[i] << " -> "
+                << engine_->GetInputNames()[i] << ")";
+        inference::lite::utils::TensorCopyAsync(dst_t, src_t, *ctx);
+      }
     }
 #ifdef PADDLE_WITH_CUDA
     if (platform::is_gpu_place(dev_place)) {
@@ -91,13 +99,20 @@ class LiteEngineOp : public framework::OperatorBase {
     engine_->Run();
     VLOG(3) << "lite engine run done";
     for (size_t i = 0; i < out_names_.size(); i++) {
-      const paddle::lite::Tensor &src_t = *(engine_->GetOutput(i));
+      // the outputs are written by the engine
+      auto &src_t = const_cast<paddle::lite::Tensor &>(*engine_->GetOutput(i));
       framework::LoDTensor *dst_t =
           &inference::analysis::GetFromScope<framework::LoDTensor>(
               scope, out_names_[i]);
-      VLOG(3) << "[Copy] lite -> fluid (" << out_names_[i] << " -> "
-              << engine_->GetOutputNames()[i] << ")";
-      inference::lite::utils::TensorCopyAsync(dst_t, src_t, *ctx);
+      if (zero_copy_) {
+        VLOG(3) << "[Share] lite -> fluid (" << out_names_[i] << " -> "
+                << engine_->GetOutputNames()[i] << ")";
+        inference::lite::utils::TensorDataShare(dst_t, &src_t);
+      } else {
+        VLOG(3) << "[Copy] lite -> fluid (" << out_names_[i] << " -> "
+                << engine_->GetOutputNames()[i] << ")";
+        inference::lite::utils::TensorCopyAsync(dst_t, src_t, *ctx);
+      }
     }
 #ifdef PADDLE_WITH_CUDA
     if (platform::is_gpu_place(dev_place)) {
@@ -59,6 +59,14 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                   "If true, file_path is in memory, and LoDTensors will be "
                   "loaded directly from memory")
         .SetDefault(false);
+    AddAttr<bool>("use_mmap",
+                  "(boolean, default false)"
+                  "If true, the file is mapped into the memory, the CPU "
+                  "LoDTensors reference the mapped file without copying, so "
+                  "the processes loading the same file share the pages. The "
+                  "mapping is private, the writes to the LoDTensors are "
+                  "never written back to the file. Not supported on Windows.")
+        .SetDefault(false);
     AddComment(R"DOC(
 LoadCombine Operator.
 
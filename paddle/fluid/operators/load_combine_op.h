@@ -15,12 +15,16 @@ limitations under the License. */
 #pragma once
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/mapped_tensor_file.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
@@ -33,6 +37,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto load_as_fp16 = ctx.Attr<bool>("load_as_fp16");
     auto model_from_memory = ctx.Attr<bool>("model_from_memory");
+    auto use_mmap = ctx.Attr<bool>("use_mmap");
     auto out_var_names = ctx.OutputNames("Out");
 
     PADDLE_ENFORCE_GT(out_var_names.size(), 0UL,
@@ -41,6 +46,13 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "it to be greater than 0.",
                           out_var_names.size()));
     if (!model_from_memory) {
+      // the file may be being saved asynchronously
+      framework::AsyncCheckpointWriter::Instance().Wait(filename);
+      if (use_mmap) {
+        LoadParamsFromMappedFile(ctx, place, filename, load_as_fp16,
+                                 out_var_names);
+        return;
+      }
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin), true,
@@ -68,6 +80,11 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
     auto out_vars = context.MultiOutputVar("Out");
+    // the container is read by names, and can be loaded partially
+    std::unique_ptr<framework::TensorContainerReader> container;
+    if (framework::IsTensorContainer(buffer)) {
+      container.reset(new framework::TensorContainerReader(buffer));
+    }
 
     for (size_t i = 0; i < out_var_names.size(); i++) {
       PADDLE_ENFORCE_NOT_NULL(
@@ -76,6 +93,11 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                            out_var_names[i]));
 
       auto *tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
+      if (container) {
+        container->Read(out_var_names[i], tensor, dev_ctx);
+        if (load_as_fp16) TransToFP16(place, out_vars[i]);
+        continue;
+      }
 
       // Error checking
       PADDLE_ENFORCE_EQ(
@@ -87,33 +109,90 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
       // Get data from fin to tensor
       DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-      auto in_dtype = tensor->type();
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_vars[i]->Clear();
-        tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
-      }
+      if (load_as_fp16) TransToFP16(place, out_vars[i]);
     }
+    if (container) return;
     buffer->peek();
     PADDLE_ENFORCE_EQ(buffer->eof(), true,
                       platform::errors::Unavailable(
                           "Not allowed to load partial data via "
                           "load_combine_op, please use load_op instead."));
   }
+
+  // The CPU tensors reference the mapped file without copying, and the GPU
+  // tensors are copied from it asynchronously on the stream of the place.
+  void LoadParamsFromMappedFile(
+      const framework::ExecutionContext &context, const platform::Place &place,
+      const std::string &filename, bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
+    auto &dev_ctx = *pool.Get(place);
+    auto out_vars = context.MultiOutputVar("Out");
+    bool on_cpu = platform::is_cpu_place(place);
+    auto file = std::make_shared<framework::MappedTensorFile>(filename);
+    std::vector<framework::LoDTensor> cpu_tensors(on_cpu ? 0
+                                                         : out_vars.size());
+    bool is_container =
+        framework::IsTensorContainer(file->data(), file->size());
+    framework::TensorContainerIndex index;
+    if (is_container) {
+      index = framework::TensorContainerIndex::FromMemory(file->data(),
+                                                          file->size());
+    }
+
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i], platform::errors::InvalidArgument(
+                           "The variable %s to be loaded cannot be found.",
+                           out_var_names[i]));
+      auto *tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
+      auto *dst = on_cpu ? tensor : &cpu_tensors[i];
+      if (is_container) {
+        auto *entry = index.Find(out_var_names[i]);
+        PADDLE_ENFORCE_NOT_NULL(
+            entry, platform::errors::NotFound(
+                       "The variable %s is not found in the file %s.",
+                       out_var_names[i], filename));
+        framework::ReadMappedLoDTensor(file, *entry, dst);
+      } else {
+        framework::ReadMappedLoDTensor(file, dst);
+      }
+      if (!on_cpu) {
+        tensor->set_lod(cpu_tensors[i].lod());
+        framework::TensorCopy(cpu_tensors[i], place, dev_ctx, tensor);
+      }
+      if (load_as_fp16) TransToFP16(place, out_vars[i]);
+    }
+    PADDLE_ENFORCE_EQ(is_container || file->eof(), true,
+                      platform::errors::Unavailable(
+                          "Not allowed to load partial data via "
+                          "load_combine_op, please use load_op instead."));
+    // the sources of the copies are released with the mapping
+    if (!on_cpu) dev_ctx.Wait();
+  }
+
+  void TransToFP16(const platform::Place &place,
+                   framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = tensor->type();
+    auto out_dtype = framework::proto::VarType::FP16;
+    if (in_dtype == out_dtype) return;
+
+    // convert to float16 tensor
+    auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+    auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+    framework::LoDTensor fp16_tensor;
+    // copy LoD info to the new tensor
+    fp16_tensor.set_lod(tensor->lod());
+    framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                             &fp16_tensor);
+
+    // reset output tensor
+    out_var->Clear();
+    tensor = out_var->GetMutable<framework::LoDTensor>();
+    tensor->set_lod(fp16_tensor.lod());
+    tensor->ShareDataWith(fp16_tensor);
+  }
 };
 
 }  // namespace operators
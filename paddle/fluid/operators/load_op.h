@@ -18,8 +18,10 @@ limitations under the License. */
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/sparse_table_delta.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -33,6 +35,8 @@ class LoadOpKernel : public framework::OpKernel<T> {
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
     auto filename = ctx.Attr<std::string>("file_path");
+    // the file may be being saved asynchronously
+    framework::AsyncCheckpointWriter::Instance().Wait(filename);
     std::ifstream fin(filename, std::ios::binary);
     PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
                       platform::errors::Unavailable(
@@ -51,7 +55,7 @@ class LoadOpKernel : public framework::OpKernel<T> {
     if (out_var->IsType<framework::LoDTensor>()) {
       LoadLodTensor(fin, place, out_var, ctx);
     } else if (out_var->IsType<framework::SelectedRows>()) {
-      LoadSelectedRows(fin, place, out_var);
+      LoadSelectedRows(fin, filename, place, out_var);
     } else {
       PADDLE_THROW(platform::errors::InvalidArgument(
           "Load operator only supports loading LoDTensor and SelectedRows "
@@ -102,7 +106,8 @@ class LoadOpKernel : public framework::OpKernel<T> {
     }
   }
 
-  void LoadSelectedRows(std::istream &fin, const platform::Place &place,
+  void LoadSelectedRows(std::istream &fin, const std::string &filename,
+                        const platform::Place &place,
                         framework::Variable *var) const {
     auto *selectedRows = var->GetMutable<framework::SelectedRows>();
     // get device context from pool
@@ -110,6 +115,8 @@ class LoadOpKernel : public framework::OpKernel<T> {
     auto &dev_ctx = *pool.Get(place);
     framework::DeserializeFromStream(fin, selectedRows, dev_ctx);
     selectedRows->SyncIndex();
+    // the table may be saved as a base and the deltas on top of it
+    framework::LoadSparseTableDeltas(filename, selectedRows, dev_ctx);
   }
 };
 
@@ -13,11 +13,20 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <string>
 
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
+DEFINE_string(sparse_table_spill_dir, "",
+              "The directory on local disk, usually on an SSD, where the "
+              "sparse tables of lookup_sparse_table spill the rows which do "
+              "not fit into memory. The rows not used recently are evicted to "
+              "the disk when a table is full, and are read back on use. A "
+              "table fails when it is full if it is empty.");
+
 namespace paddle {
 namespace operators {
 
@@ -68,6 +77,10 @@ class LookupSparseTableOp : public framework::OperatorBase {
     PADDLE_ENFORCE_EQ(w_t->value().type(), framework::proto::VarType::FP32,
                       platform::errors::InvalidArgument(
                           "The sparse table only support FP32"));
+    if (!FLAGS_sparse_table_spill_dir.empty() && !w_t->IsSpillEnabled()) {
+      w_t->EnableSpill(FLAGS_sparse_table_spill_dir + "/" + Input("W") +
+                       ".spill");
+    }
     w_t->Get(ids_t, out_t, true, is_test);
     out_t->set_lod(ids_t.lod());
   }
@@ -110,6 +123,10 @@ the ids to be looked up in W;
 if the Id is not in the sparse table, this operator will return a
 random value and set the value into the table for the next looking up.
 
+If FLAGS_sparse_table_spill_dir is set, the table holds more rows than it
+is created with: the rows not used recently are evicted to a file in that
+directory when the table is full, and are read back when they are looked up.
+
 )DOC");
   }
 };
@@ -60,14 +60,10 @@ class LookupTableDequantOp : public framework::OperatorWithKernel {
 
     auto output_dims =
         framework::vectorize(framework::slice_ddim(ids_dims, 0, ids_rank - 1));
-    PADDLE_ENFORCE_GE(table_dims[1], 2,
-                      platform::errors::InvalidArgument(
-                          "the second dim of table_dims should be "
-                          "greater or equal to 2, but the actual shape "
-                          "is [%s]",
-                          table_dims));
-
-    output_dims.push_back((table_dims[1] - 2) * 4);
+    auto quant_type = math::GetEmbeddingQuantType(
+        ctx->Attrs().Get<std::string>("quant_type"));
+    output_dims.push_back(
+        math::DequantizedRowWidth(quant_type, table_dims[1]));
     ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
 
     if (ctx->GetOutputsVarType("Out")[0] ==
@@ -88,8 +84,9 @@ class LookupTableDequantOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() override {
     AddInput("W",
-             "(Tensor) The input represents embedding tensors, "
-             "This tensor is a quantized tensor");
+             "(Tensor or SelectedRows) The input represents embedding "
+             "tensors, This tensor is a quantized tensor, whose rows are "
+             "stored in the format of quant_type.");
     AddInput("Ids",
              "An input with type int64 "
              "contains the ids to be looked up in W. "
@@ -101,12 +98,19 @@ class LookupTableDequantOpMaker : public framework::OpProtoAndCheckerMaker {
                      "Otherwise the given value indicates padding the output "
                      "with zeros whenever lookup encounters it in Ids.")
         .SetDefault(kNoPadding);
+    AddAttr<std::string>("quant_type",
+                         "(string, default uint8) The storage format of W: "
+                         "uint8 (min, max and uint8 values per row), fp16, "
+                         "int8 (a scale and int8 values per row) or int4 (a "
+                         "scale and int4 values per row).")
+        .SetDefault("uint8");
     AddComment(R"DOC(
 Lookup Table Dequant Operator.
 
 The `W` input is a quantized parameter for the sake of saving memories.
 This operator first index embeddings with `Ids`,
-then dequantizes them and contact them as output (`Out`). 
+then dequantizes them and contact them as output (`Out`). The table can
+be quantized from a float table by the lookup_table_quant operator.
 
 The input Ids can carry the LoD (Level of Details) information,
 or not. And the output only shares the LoD information with input Ids.
@@ -0,0 +1,115 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/lookup_table_dequant_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename Quant, typename T, int BlockDimX, int BlockDimY,
+          int GridDimX, bool PaddingFlag>
+__global__ void LookupTableDequant(T *output, const float *table,
+                                   const int64_t *ids, const int64_t N,
+                                   const int64_t K, const int64_t row_floats,
+                                   const int64_t padding_idx) {
+  int idx = threadIdx.x;
+  int idy = blockIdx.x + threadIdx.y * GridDimX;
+  int64_t D = (row_floats - Quant::kHeadFloats) * Quant::kValuesPerFloat;
+
+  while (idy < K) {
+    int64_t id = ids[idy];
+    PADDLE_ENFORCE(
+        id >= 0,
+        "Variable value (input) of OP(fluid.layers.embedding) "
+        "expected >= 0 and < %ld, but got %ld. Please check input value.",
+        N, id);
+    PADDLE_ENFORCE(
+        id < N,
+        "Variable value (input) of OP(fluid.layers.embedding) "
+        "expected >= 0 and < %ld, but got %ld. Please check input value.",
+        N, id);
+    T *out = output + idy * D;
+    const float *row = table + id * row_floats;
+    for (int i = idx; i < D; i += BlockDimX) {
+      if (PaddingFlag && id == padding_idx) {
+        out[i] = static_cast<T>(0);
+      } else {
+        out[i] = static_cast<T>(Quant::Dequant(row, i));
+      }
+    }
+    idy += BlockDimY * GridDimX;
+  }
+}
+
+template <typename Quant, typename T>
+void LaunchLookupTableDequant(const platform::CUDADeviceContext &dev_ctx,
+                              T *output, const float *table,
+                              const int64_t *ids, int64_t N, int64_t K,
+                              int64_t row_floats, int64_t padding_idx) {
+  dim3 threads(128, 8);
+  dim3 grids(8, 1);
+  if (padding_idx == kNoPadding) {
+    LookupTableDequant<Quant, T, 128, 8, 8,
+                       false><<<grids, threads, 0, dev_ctx.stream()>>>(
+        output, table, ids, N, K, row_floats, padding_idx);
+  } else {
+    LookupTableDequant<Quant, T, 128, 8, 8,
+                       true><<<grids, threads, 0, dev_ctx.stream()>>>(
+        output, table, ids, N, K, row_floats, padding_idx);
+  }
+}
+
+template <typename T>
+class LookupTableDequantCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *table_t = context.Input<LoDTensor>("W");
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *output_t = context.Output<LoDTensor>("Out");
+    int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+    auto quant_type =
+        math::GetEmbeddingQuantType(context.Attr<std::string>("quant_type"));
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+
+    int64_t N = table_t->dims()[0];
+    int64_t row_floats = table_t->dims()[1];
+    int64_t K = ids_t->numel();
+    auto *ids = ids_t->data<int64_t>();
+    auto *table = table_t->data<float>();
+    auto *output = output_t->mutable_data<T>(context.GetPlace());
+
+    switch (quant_type) {
+#define LOOKUP_DEQUANT_CASE(kType)                                   \
+  case kType:                                                        \
+    LaunchLookupTableDequant<math::EmbeddingQuant<kType>>(           \
+        dev_ctx, output, table, ids, N, K, row_floats, padding_idx); \
+    break
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kUInt8);
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kFP16);
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kInt8);
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kInt4);
+#undef LOOKUP_DEQUANT_CASE
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(lookup_table_dequant,
+                        ops::LookupTableDequantCUDAKernel<float>);
@@ -23,6 +23,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/embedding_quant.h"
 
 #ifdef PADDLE_WITH_DISTRIBUTE
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
@@ -36,18 +37,50 @@ using LoDTensor = framework::LoDTensor;
 using SelectedRows = framework::SelectedRows;
 using DDim = framework::DDim;
 
-template <typename T>
-void dequant(const unsigned char *in, T *out, float min, float max,
-             int emb_size, int pow_2_bits) {
-  float scale = (max - min) / pow_2_bits;
-  for (int i = 0; i < emb_size; ++i) {
-    T x = scale * static_cast<int>(in[i]) + min;
-    out[i] = x;
+constexpr int64_t kNoPadding = -1;
+
+template <typename Quant, typename T>
+void LookupDequant(const float *table, int64_t row_number, int64_t row_floats,
+                   const int64_t *ids, int64_t ids_numel, int64_t padding_idx,
+                   const SelectedRows *rows, T *output) {
+  int64_t row_width =
+      (row_floats - Quant::kHeadFloats) * Quant::kValuesPerFloat;
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    T *out = output + i * row_width;
+    if (padding_idx != kNoPadding && ids[i] == padding_idx) {
+      memset(out, 0, row_width * sizeof(T));
+      continue;
+    }
+    PADDLE_ENFORCE_GE(
+        ids[i], 0,
+        platform::errors::InvalidArgument(
+            "Variable value (input) of OP(fluid.layers.embedding) "
+            "expected >= 0 and < %ld, but got %ld. Please check input "
+            "value.",
+            row_number, ids[i]));
+    int64_t index = ids[i];
+    if (rows != nullptr) {
+      index = rows->Index(ids[i]);
+      PADDLE_ENFORCE_GE(index, 0, platform::errors::InvalidArgument(
+                                      "the input key should be exists. But "
+                                      "received %d.",
+                                      index));
+    } else {
+      PADDLE_ENFORCE_LT(
+          ids[i], row_number,
+          platform::errors::InvalidArgument(
+              "Variable value (input) of OP(fluid.layers.embedding) "
+              "expected >= 0 and < %ld, but got %ld. Please check input "
+              "value.",
+              row_number, ids[i]));
+    }
+    const float *row = table + index * row_floats;
+    for (int64_t j = 0; j < row_width; ++j) {
+      out[j] = static_cast<T>(Quant::Dequant(row, j));
+    }
   }
 }
 
-constexpr int64_t kNoPadding = -1;
-
 template <typename T>
 class LookupTableDequantKernel : public framework::OpKernel<T> {
  public:
@@ -56,51 +89,42 @@ class LookupTableDequantKernel : public framework::OpKernel<T> {
     auto *output_t = context.Output<LoDTensor>("Out");  // float tensor
     auto *table_var = context.InputVar("W");
 
-    auto id_name = context.InputNames("Ids").front();
-    auto embedding_name = context.InputNames("W").front();
-    auto out_name = context.OutputNames("Out").front();
-
     int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+    auto quant_type =
+        math::GetEmbeddingQuantType(context.Attr<std::string>("quant_type"));
     auto *ids = ids_t->data<int64_t>();
     int64_t ids_numel = ids_t->numel();
 
-    PADDLE_ENFORCE_GE(
-        table_var->Type(), framework::VarTypeTrait<LoDTensor>::kId,
-        platform::errors::InvalidArgument("lookup table must be LodTensor"));
-    auto *table_t = context.Input<LoDTensor>("W");
+    const Tensor *table_t = nullptr;
+    const SelectedRows *rows = nullptr;
+    if (table_var->IsType<LoDTensor>()) {
+      table_t = &table_var->Get<LoDTensor>();
+    } else if (table_var->IsType<SelectedRows>()) {
+      rows = &table_var->Get<SelectedRows>();
+      table_t = &rows->value();
+    } else {
+      PADDLE_THROW(platform::errors::InvalidArgument(
+          "The lookup table of lookup_table_dequant must be LoDTensor or "
+          "SelectedRows, but received %s.",
+          framework::ToTypeName(table_var->Type())));
+    }
     int64_t row_number = table_t->dims()[0];
-    int64_t quant_number = table_t->dims()[1];
-    int64_t row_width = (quant_number - 2) * 4;
-
+    int64_t row_floats = table_t->dims()[1];
     auto *table = table_t->data<float>();
     auto *output = output_t->mutable_data<T>(context.GetPlace());
-    int pow_2_bits = static_cast<int>(pow(2, 8));
-    for (int64_t i = 0; i < ids_numel; ++i) {
-      if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-        memset(output + i * row_width, 0, row_width * sizeof(T));
-      } else {
-        PADDLE_ENFORCE_LT(
-            ids[i], row_number,
-            platform::errors::InvalidArgument(
-                "Variable value (input) of OP(fluid.layers.embedding) "
-                "expected >= 0 and < %ld, but got %ld. Please check input "
-                "value.",
-                row_number, ids[i]));
-        PADDLE_ENFORCE_GE(
-            ids[i], 0,
-            platform::errors::InvalidArgument(
-                "Variable value (input) of OP(fluid.layers.embedding) "
-                "expected >= 0 and < %ld, but got %ld. Please check input "
-                "value.",
-                row_number, ids[i]));
-        float min = *(table + ids[i] * quant_number);
-        float max = *(table + ids[i] * quant_number + 1);
-        int offset = ids[i] * quant_number + 2;
-        const unsigned char *tensor_buf =
-            reinterpret_cast<const unsigned char *>(table + offset);
-        dequant(tensor_buf, output + i * row_width, min, max, row_width,
-                pow_2_bits);
-      }
+
+    switch (quant_type) {
+#define LOOKUP_DEQUANT_CASE(kType)                                         \
+  case kType:                                                              \
+    LookupDequant<math::EmbeddingQuant<kType>>(table, row_number,          \
+                                               row_floats, ids, ids_numel, \
+                                               padding_idx, rows, output); \
+    break
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kUInt8);
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kFP16);
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kInt8);
+      LOOKUP_DEQUANT_CASE(math::EmbeddingQuantType::kInt4);
+#undef LOOKUP_DEQUANT_CASE
     }
   }
 };
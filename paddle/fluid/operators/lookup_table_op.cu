@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/embedding_grad.cu.h"
 #include "paddle/fluid/operators/lookup_table_op.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 #include "paddle/fluid/platform/float16.h"
@@ -57,34 +58,6 @@ __global__ void LookupTable(T *output, const T *table, const int64_t *ids,
   }
 }
 
-template <typename T, int BlockDimX, int BlockDimY, int GridDimX>
-__global__ void LookupTableGrad(T *table, const T *output, const int64_t *ids,
-                                const int64_t N, const int64_t K,
-                                const int64_t D) {
-  int idx = threadIdx.x;
-  int idy = blockIdx.x + threadIdx.y * GridDimX;
-
-  while (idy < K) {
-    int64_t id = ids[idy];
-    PADDLE_ENFORCE(
-        id >= 0,
-        "Variable value (input) of OP(fluid.layers.embedding) "
-        "expected >= 0 and < %ld, but got %ld. Please check input value.",
-        N, id);
-    PADDLE_ENFORCE(
-        id < N,
-        "Variable value (input) of OP(fluid.layers.embedding) "
-        "expected >= 0 and < %ld, but got %ld. Please check input value.",
-        N, id);
-    const T *out = output + idy * D;
-    T *tab = table + id * D;
-    for (int i = idx; i < D; i += BlockDimX) {
-      paddle::platform::CudaAtomicAdd(&tab[i], out[i]);
-    }
-    idy += BlockDimY * GridDimX;
-  }
-}
-
 template <typename T>
 class LookupTableCUDAKernel : public framework::OpKernel<T> {
  public:
@@ -137,57 +110,34 @@ class LookupTableGradCUDAKernel : public framework::OpKernel<T> {
       auto *d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
       auto *d_table = context.Output<SelectedRows>(framework::GradVarName("W"));
 
-      auto *ids_data = ids->data<int64_t>();
+      int64_t N = table->dims()[0];
+      int64_t D = table->dims()[1];
       int64_t ids_num = ids->numel();
-
-      auto stream = dev_ctx.stream();
-      // copy GPU memory to CPU pinned memory
-      framework::Vector<int64_t> new_rows;
-      new_rows.resize(ids_num);
-      auto gpu_place = BOOST_GET_CONST(platform::CUDAPlace, context.GetPlace());
-
-      // TODO(yuyang18): Strange code here.
-      memory::Copy(gpu_place, new_rows.CUDAMutableData(context.GetPlace()),
-                   gpu_place, ids_data, ids_num * sizeof(int64_t), stream);
-      d_table->set_rows(new_rows);
-
-      auto *d_table_value = d_table->mutable_value();
-      d_table_value->Resize({ids_num, table->dims()[1]});
-      d_table_value->mutable_data<T>(context.GetPlace());
-
-      auto *d_table_data = d_table_value->data<T>();
-      auto *d_output_data = d_output->data<T>();
       auto d_output_dims = d_output->dims();
       auto d_output_dims_2d =
           framework::flatten_to_2d(d_output_dims, d_output_dims.size() - 1);
-      PADDLE_ENFORCE_EQ(d_table_value->dims(), d_output_dims_2d,
+      PADDLE_ENFORCE_EQ(framework::make_ddim({ids_num, D}), d_output_dims_2d,
                         "ShapeError: The shape of lookup_table@Grad and "
                         "output@Grad should be same. "
                         "But received lookup_table@Grad's shape = [%s], "
                         "output@Grad's shape = [%s].",
-                        d_table_value->dims(), d_output_dims_2d);
-      memory::Copy(gpu_place, d_table_data, gpu_place, d_output_data,
-                   d_output->numel() * sizeof(T), stream);
-
+                        framework::make_ddim({ids_num, D}), d_output_dims_2d);
+      d_table->set_height(N);
+      EmbeddingSparseGrad<T>(dev_ctx, ids->data<int64_t>(), ids_num,
+                             d_output->data<T>(), N, D, d_table);
     } else {
       auto ids_t = context.Input<LoDTensor>("Ids");
       auto d_output_t = context.Input<LoDTensor>(framework::GradVarName("Out"));
       auto d_table_t = context.Output<LoDTensor>(framework::GradVarName("W"));
 
-      int N = d_table_t->dims()[0];
-      int D = d_table_t->dims()[1];
-      int K = ids_t->numel();
+      int64_t N = d_table_t->dims()[0];
+      int64_t D = d_table_t->dims()[1];
+      int64_t K = ids_t->numel();
       const int64_t *ids = ids_t->data<int64_t>();
       const T *d_output = d_output_t->data<T>();
       T *d_table = d_table_t->mutable_data<T>(context.GetPlace());
 
-      auto t = framework::EigenVector<T>::Flatten(*d_table_t);
-      t.device(*dev_ctx.eigen_device()) = t.constant(static_cast<T>(0));
-
-      dim3 threads(128, 8);
-      dim3 grids(8, 1);
-      LookupTableGrad<T, 128, 8, 8><<<grids, threads, 0, dev_ctx.stream()>>>(
-          d_table, d_output, ids, N, K, D);
+      EmbeddingDenseGrad<T>(dev_ctx, ids, K, d_output, N, D, d_table);
     }
   }
 };
@@ -0,0 +1,103 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/lookup_table_quant_op.h"
+
+#include <string>
+
+#include "paddle/fluid/framework/var_type_inference.h"
+
+namespace paddle {
+namespace operators {
+
+class LookupTableQuantOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    OP_INOUT_CHECK(ctx->HasInput("W"), "Input", "W", "LookupTableQuant");
+    OP_INOUT_CHECK(ctx->HasOutput("Out"), "Output", "Out", "LookupTableQuant");
+
+    auto table_dims = ctx->GetInputDim("W");
+    PADDLE_ENFORCE_EQ(
+        table_dims.size(), 2,
+        platform::errors::InvalidArgument(
+            "ShapeError: The dimensions of the 'lookup table' must be 2. "
+            "But received lookup table's dimensions = %d, "
+            "lookup table's shape = [%s].",
+            table_dims.size(), table_dims));
+    auto quant_type = math::GetEmbeddingQuantType(
+        ctx->Attrs().Get<std::string>("quant_type"));
+    ctx->SetOutputDim(
+        "Out", framework::make_ddim(
+                   {table_dims[0],
+                    math::QuantizedRowFloats(quant_type, table_dims[1])}));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = OperatorWithKernel::IndicateVarDataType(ctx, "W");
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class LookupTableQuantOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("W",
+             "(Tensor or SelectedRows) The float embedding table of "
+             "[rows, width].");
+    AddOutput("Out",
+              "(Tensor or SelectedRows) The quantized table of the same "
+              "variable type as W, one row of floats per row of W.");
+    AddAttr<std::string>("quant_type",
+                         "(string, default int8) The storage format of Out: "
+                         "uint8, fp16, int8 or int4, see "
+                         "lookup_table_dequant.")
+        .SetDefault("int8");
+    AddComment(R"DOC(
+Lookup Table Quant Operator.
+
+Quantizes every row of the float embedding table `W`, so that the table
+takes 1/2 (fp16), 1/4 (int8, uint8) or 1/8 (int4) of the memory, and is
+looked up by the lookup_table_dequant operator with the same quant_type.
+The width of W must be a multiple of 2 for fp16, 4 for uint8 and int8, and
+8 for int4.
+
+For training, the float table stays the master weights updated by the
+optimizer, and is quantized again after the updates that the quantized
+table should see.
+
+)DOC");
+  }
+};
+
+class LookupTableQuantInferVarType : public framework::VarTypeInference {
+ public:
+  void operator()(framework::InferVarTypeContext* ctx) const override {
+    ctx->SyncTypeAndDataType("W", "Out");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(
+    lookup_table_quant, ops::LookupTableQuantOp, ops::LookupTableQuantOpMaker,
+    ops::LookupTableQuantInferVarType,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(lookup_table_quant, ops::LookupTableQuantKernel<float>);
@@ -0,0 +1,90 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/embedding_quant.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename Quant>
+void QuantizeTable(const float *table, int64_t row_number, int64_t row_width,
+                   int64_t row_floats, float *out) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < row_number; ++i) {
+    Quant::Quantize(table + i * row_width, row_width, out + i * row_floats);
+  }
+}
+
+template <typename T>
+class LookupTableQuantKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *table_var = context.InputVar("W");
+    auto *out_var = context.OutputVar("Out");
+    auto quant_type =
+        math::GetEmbeddingQuantType(context.Attr<std::string>("quant_type"));
+
+    const framework::Tensor *table_t = nullptr;
+    framework::Tensor *out_t = nullptr;
+    if (table_var->IsType<framework::LoDTensor>()) {
+      table_t = &table_var->Get<framework::LoDTensor>();
+      out_t = out_var->GetMutable<framework::LoDTensor>();
+    } else if (table_var->IsType<framework::SelectedRows>()) {
+      auto &rows = table_var->Get<framework::SelectedRows>();
+      auto *out_rows = out_var->GetMutable<framework::SelectedRows>();
+      out_rows->set_height(rows.height());
+      out_rows->set_rows(rows.rows());
+      table_t = &rows.value();
+      out_t = out_rows->mutable_value();
+    } else {
+      PADDLE_THROW(platform::errors::InvalidArgument(
+          "The table of lookup_table_quant must be LoDTensor or "
+          "SelectedRows, but received %s.",
+          framework::ToTypeName(table_var->Type())));
+    }
+
+    int64_t row_number = table_t->dims()[0];
+    int64_t row_width = table_t->numel() / std::max<int64_t>(row_number, 1);
+    int64_t row_floats = math::QuantizedRowFloats(quant_type, row_width);
+    auto *table = table_t->data<T>();
+    auto *out = out_t->mutable_data<T>({row_number, row_floats},
+                                       context.GetPlace());
+
+    switch (quant_type) {
+#define LOOKUP_QUANT_CASE(kType)                                            \
+  case kType:                                                               \
+    QuantizeTable<math::EmbeddingQuant<kType>>(table, row_number,           \
+                                               row_width, row_floats, out); \
+    break
+      LOOKUP_QUANT_CASE(math::EmbeddingQuantType::kUInt8);
+      LOOKUP_QUANT_CASE(math::EmbeddingQuantType::kFP16);
+      LOOKUP_QUANT_CASE(math::EmbeddingQuantType::kInt8);
+      LOOKUP_QUANT_CASE(math::EmbeddingQuantType::kInt4);
+#undef LOOKUP_QUANT_CASE
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -31,12 +31,13 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
                   framework::LoDTensor *selected_ids,
                   framework::LoDTensor *selected_scores,
                   framework::Tensor *parent_idx, size_t level, size_t beam_size,
-                  int end_id, bool is_accumulated) {
+                  int end_id, bool is_accumulated, bool is_logits = false) {
     auto abs_lod = framework::ToAbsOffset(scores->lod());
     auto &high_level = abs_lod[level];
 
-    auto items = SelectTopBeamSizeItems(pre_ids, pre_scores, ids, scores, level,
-                                        beam_size, end_id, is_accumulated);
+    auto items =
+        SelectTopBeamSizeItems(pre_ids, pre_scores, ids, scores, level,
+                               beam_size, end_id, is_accumulated, is_logits);
     auto selected_items = ToMap(items, high_level.back());
     if (FLAGS_v == 3) {
       VLOG(3) << "selected_items:";
@@ -215,7 +216,7 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
       const framework::LoDTensor *pre_ids,
       const framework::LoDTensor *pre_scores, const framework::LoDTensor *ids,
       const framework::LoDTensor *scores, size_t lod_level, size_t beam_size,
-      int end_id, bool is_accumulated) {
+      int end_id, bool is_accumulated, bool is_logits) {
     std::vector<std::vector<Item>> result;
 
     // find the current candidates
@@ -251,11 +252,27 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
           Insert(&top_beam, item, beam_size);
         } else {
           size_t index = offset * seq_width;
+          // score = pre_score + logit - log(sum(exp(logits)))
+          float log_sum_exp = 0.f;
+          if (is_logits) {
+            const float *logits = scores_data + index;
+            float max_logit = *std::max_element(logits, logits + seq_width);
+            float sum = 0.f;
+            for (size_t d = 0; d < seq_width; d++) {
+              sum += std::exp(logits[d] - max_logit);
+            }
+            log_sum_exp = max_logit + std::log(sum);
+          }
           for (size_t d = 0; d < seq_width; d++, index++) {
             int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
-            float score = is_accumulated
-                              ? scores_data[index]
-                              : pre_score + std::log(scores_data[index]);
+            float score;
+            if (is_logits) {
+              score = pre_score + scores_data[index] - log_sum_exp;
+            } else if (is_accumulated) {
+              score = scores_data[index];
+            } else {
+              score = pre_score + std::log(scores_data[index]);
+            }
             Item item(offset, id, score);
             Insert(&top_beam, item, beam_size);
           }
@@ -12,6 +12,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/operators/math/beam_search.h"
 #include "paddle/fluid/platform/cuda_device_function.h"
 
@@ -293,6 +296,129 @@ __global__ void BeamSearchKernelSingle(
       beam_size, end_id, is_accumulated, num_used_threads);
 }
 
+// log(sum(exp(x))) of each row of x, for the scores of the logits.
+template <int BlockSize>
+__global__ void RowLogSumExpKernel(const float* x, const int width,
+                                   float* log_sum_exp) {
+  typedef cub::BlockReduce<float, BlockSize> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ float row_max;
+  const float* row = x + static_cast<int64_t>(blockIdx.x) * width;
+
+  float max_val = -INFINITY;
+  for (int i = threadIdx.x; i < width; i += BlockSize) {
+    max_val = fmaxf(max_val, row[i]);
+  }
+  max_val = BlockReduce(temp_storage).Reduce(max_val, cub::Max());
+  if (threadIdx.x == 0) row_max = max_val;
+  __syncthreads();
+
+  float sum = 0.f;
+  for (int i = threadIdx.x; i < width; i += BlockSize) {
+    sum += __expf(row[i] - row_max);
+  }
+  sum = BlockReduce(temp_storage).Sum(sum);
+  if (threadIdx.x == 0) log_sum_exp[blockIdx.x] = row_max + __logf(sum);
+}
+
+/*
+ * The general kernels for any number of source sentences and any width.
+ * Each block selects the top beam of one source: every thread keeps its own
+ * top beam in the shared memory over a strided part of the candidates of all
+ * the prefixes, and the top beams of the threads are merged pairwise. The
+ * selected items of the sources are written back in another kernel, which
+ * knows the number of items selected before each source.
+ */
+template <bool IsAccumulated, bool IsLogits>
+__global__ void BeamSearchTopKernel(
+    Triple* top, int* top_nums, const int64_t* pre_ids,
+    const float* pre_scores, const int64_t* ids, const float* scores,
+    const float* log_sum_exp, const size_t* seq_offsets, const int seq_width,
+    int beam_size, int end_id) {
+  extern __shared__ Triple top_beams[];
+  const int tid = threadIdx.x;
+  const int seq_id = blockIdx.x;
+  const int seq_offset_start = static_cast<int>(seq_offsets[seq_id]);
+  const int seq_offset_end = static_cast<int>(seq_offsets[seq_id + 1]);
+
+  Triple* top_beam_local = top_beams + tid * beam_size;
+  for (int i = 0; i < beam_size; ++i) {
+    top_beam_local[i].set(-1, -1, -INFINITY);
+  }
+
+  int64_t num_candidates =
+      static_cast<int64_t>(seq_offset_end - seq_offset_start) * seq_width;
+  for (int64_t k = tid; k < num_candidates; k += blockDim.x) {
+    int offset = seq_offset_start + static_cast<int>(k / seq_width);
+    int d = static_cast<int>(k % seq_width);
+    if (static_cast<int>(pre_ids[offset]) == end_id) {
+      if (d == 0) {
+        Insert(top_beam_local, Triple(offset, end_id, pre_scores[offset]),
+               beam_size);
+      }
+      continue;
+    }
+    int64_t index = static_cast<int64_t>(offset) * seq_width + d;
+    float score;
+    if (IsLogits) {
+      score = pre_scores[offset] + scores[index] - log_sum_exp[offset];
+    } else if (IsAccumulated) {
+      score = scores[index];
+    } else {
+      score = pre_scores[offset] + __logf(scores[index]);
+    }
+    int id = ids ? static_cast<int>(ids[index]) : d;
+    Insert(top_beam_local, Triple(offset, id, score), beam_size);
+  }
+
+  // blockDim.x is a power of two
+  for (int stride = blockDim.x >> 1; stride > 0; stride >>= 1) {
+    __syncthreads();
+    if (tid < stride) {
+      const Triple* other = top_beams + (tid + stride) * beam_size;
+      for (int i = 0; i < beam_size && other[i].score > -INFINITY; ++i) {
+        Insert(top_beam_local, other[i], beam_size);
+      }
+    }
+  }
+
+  if (tid == 0) {
+    int num_items = 0;
+    for (int i = 0; i < beam_size; ++i) {
+      num_items =
+          (top_beam_local[i].score > -INFINITY) ? num_items + 1 : num_items;
+    }
+    bool finish_flag =
+        PruneEndBeams(top_beam_local, pre_ids, end_id, num_items);
+    top_nums[seq_id] = finish_flag ? 0 : num_items;
+    for (int i = 0; i < beam_size; ++i) {
+      top[seq_id * beam_size + i] = top_beam_local[i];
+    }
+  }
+}
+
+template <bool ReturnParentIdx>
+__global__ void BeamSearchWriteBackKernel(
+    int64_t* selected_ids, float* selected_scores, int* parent_idx,
+    size_t* selected_offsets, Triple* top, const int* top_nums,
+    const size_t* seq_offsets, const int num_seqs, int beam_size) {
+  for (int seq_id = blockIdx.x * blockDim.x + threadIdx.x; seq_id < num_seqs;
+       seq_id += blockDim.x * gridDim.x) {
+    int selected_seq_start = 0;
+    for (int s = 0; s < seq_id; ++s) {
+      selected_seq_start += top_nums[s];
+    }
+    if (seq_id == 0) {
+      selected_offsets[0] = 0;
+    }
+    WriteBack<ReturnParentIdx>(
+        selected_ids, selected_scores, parent_idx, selected_offsets,
+        top + seq_id * beam_size, static_cast<int>(seq_offsets[seq_id]),
+        static_cast<int>(seq_offsets[seq_id + 1]), selected_seq_start,
+        top_nums[seq_id]);
+  }
+}
+
 static inline int GetNumUsedThreads(const int max_threads_per_seq,
                                     const int seq_width, int beam_size) {
   int num_used_threads = (seq_width + beam_size - 1) / beam_size;
@@ -325,7 +451,7 @@ class BeamSearchFunctor<platform::CUDADeviceContext, T> {
                   framework::LoDTensor* selected_ids,
                   framework::LoDTensor* selected_scores,
                   framework::Tensor* parent_idx, size_t level, size_t beam_size,
-                  int end_id, bool is_accumulated) {
+                  int end_id, bool is_accumulated, bool is_logits = false) {
     auto abs_lod = framework::ToAbsOffset(scores->lod());
 
     const int64_t* pre_ids_data = pre_ids->data<int64_t>();
@@ -359,7 +485,7 @@ class BeamSearchFunctor<platform::CUDADeviceContext, T> {
     size_t* selected_offsets =
         selected_lod[1].CUDAMutableData(context.GetPlace());
 
-    if (num_seqs == 1) {
+    if (num_seqs == 1 && beam_size * seq_width <= 1024 && !is_logits) {
       const int seq_length = static_cast<int>(abs_lod[level][1]);
       const int kMaxThreadsPerSeq = 1024;
       int num_used_threads =
@@ -375,7 +501,8 @@ class BeamSearchFunctor<platform::CUDADeviceContext, T> {
                 static_cast<int>(beam_size), static_cast<int>(end_id),
                 is_accumulated, num_used_threads));
       }
-    } else if (num_seqs <= 4) {
+    } else if (num_seqs <= 4 && beam_size * num_seqs * 32 <= 1024 &&
+               !is_logits) {
       const size_t* seq_offsets = abs_lod[level].CUDAData(context.GetPlace());
       // Use only 1 block
       const int kMaxThreadsPerSeq = 32;
@@ -394,8 +521,80 @@ class BeamSearchFunctor<platform::CUDADeviceContext, T> {
                 end_id, is_accumulated, num_used_threads));
       }
     } else {
-      PADDLE_THROW(platform::errors::Unimplemented(
-          "Not implemented other number of sequences yet."));
+      PADDLE_ENFORCE_LE(
+          static_cast<int>(beam_size), kBeamSearchMaxBeamSizeOnGPU,
+          platform::errors::Unimplemented(
+              "The beam size of beam_search on GPU should be at most %d, "
+              "but received %d.",
+              kBeamSearchMaxBeamSizeOnGPU, beam_size));
+      const size_t* seq_offsets = abs_lod[level].CUDAData(context.GetPlace());
+      auto stream = context.stream();
+
+      framework::Tensor log_sum_exp;
+      const float* log_sum_exp_data = nullptr;
+      if (is_logits) {
+        constexpr int kBlockSize = 256;
+        int num_rows = static_cast<int>(scores->dims()[0]);
+        float* data = log_sum_exp.mutable_data<float>(
+            framework::make_ddim({std::max(num_rows, 1)}), context.GetPlace());
+        if (num_rows > 0) {
+          RowLogSumExpKernel<kBlockSize><<<num_rows, kBlockSize, 0, stream>>>(
+              scores_data, static_cast<int>(seq_width), data);
+        }
+        log_sum_exp_data = data;
+      }
+
+      // The top beams of all the threads of a block are in the shared memory
+      constexpr int kMaxThreads = 256;
+      constexpr size_t kMaxSharedMemory = 48 * 1024;
+      int num_threads = kMaxThreads;
+      while (num_threads > 32 &&
+             num_threads * beam_size * sizeof(Triple) > kMaxSharedMemory) {
+        num_threads >>= 1;
+      }
+      size_t shared_memory = num_threads * beam_size * sizeof(Triple);
+
+      framework::Tensor top_t, top_nums_t;
+      auto* top = reinterpret_cast<Triple*>(top_t.mutable_data<int8_t>(
+          framework::make_ddim(
+              {static_cast<int64_t>(num_seqs * beam_size * sizeof(Triple))}),
+          context.GetPlace()));
+      int* top_nums = top_nums_t.mutable_data<int>(
+          framework::make_ddim({static_cast<int64_t>(num_seqs)}),
+          context.GetPlace());
+
+#define BEAM_SEARCH_TOP_KERNEL(kIsAccumulated, kIsLogits)                  \
+  BeamSearchTopKernel<kIsAccumulated,                                      \
+                      kIsLogits><<<num_seqs, num_threads, shared_memory,   \
+                                   stream>>>(                              \
+      top, top_nums, pre_ids_data, pre_scores_data, ids_data, scores_data, \
+      log_sum_exp_data, seq_offsets, static_cast<int>(seq_width),          \
+      static_cast<int>(beam_size), end_id)
+      if (is_logits) {
+        BEAM_SEARCH_TOP_KERNEL(false, true);
+      } else if (is_accumulated) {
+        BEAM_SEARCH_TOP_KERNEL(true, false);
+      } else {
+        BEAM_SEARCH_TOP_KERNEL(false, false);
+      }
+#undef BEAM_SEARCH_TOP_KERNEL
+
+      constexpr int kWriteBackThreads = 256;
+      int write_back_blocks =
+          (num_seqs + kWriteBackThreads - 1) / kWriteBackThreads;
+      if (parent_idx) {
+        BeamSearchWriteBackKernel<
+            true><<<write_back_blocks, kWriteBackThreads, 0, stream>>>(
+            selected_ids_data, selected_scores_data, parent_idx_data,
+            selected_offsets, top, top_nums, seq_offsets,
+            static_cast<int>(num_seqs), static_cast<int>(beam_size));
+      } else {
+        BeamSearchWriteBackKernel<
+            false><<<write_back_blocks, kWriteBackThreads, 0, stream>>>(
+            selected_ids_data, selected_scores_data, parent_idx_data,
+            selected_offsets, top, top_nums, seq_offsets,
+            static_cast<int>(num_seqs), static_cast<int>(beam_size));
+      }
     }
 
     context.Wait();
@@ -101,6 +101,10 @@ class BeamSearchFunctor {
    * selected_ids.
    *   It stores the corresponding scores of candidate ids in selected_ids.
    *
+   *  @is_logits: the scores are the logits over all the ids of each prefix,
+   *   and the score of a candidate is pre_score + log_softmax(logits), so
+   *   that the softmax, log and add of the step are done in the search.
+   *
    * Return false if all the input tensor is empty, in machine translation task
    * that means no candidates is provided, and the task will stop running.
    */
@@ -109,9 +113,14 @@ class BeamSearchFunctor {
       const framework::LoDTensor* pre_scores, const framework::LoDTensor* ids,
       const framework::LoDTensor* scores, framework::LoDTensor* selected_ids,
       framework::LoDTensor* selected_scores, framework::Tensor* parent_idx,
-      size_t level, size_t beam_size, int end_id, bool is_accumulated);
+      size_t level, size_t beam_size, int end_id, bool is_accumulated,
+      bool is_logits = false);
 };
 
+// The max beam size of the CUDA kernels, the larger beams are searched on
+// the CPU.
+constexpr int kBeamSearchMaxBeamSizeOnGPU = 128;
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
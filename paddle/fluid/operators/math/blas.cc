@@ -14,10 +14,27 @@
 
 #include "paddle/fluid/operators/math/blas.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT
 #include <utility>
+#include "paddle/fluid/framework/threadpool.h"
+
 namespace paddle {
 namespace operators {
 namespace math {
+
+#ifndef PADDLE_WITH_MKLML
+framework::ThreadPool *BatchedGEMMThreadPool(int *num_threads) {
+  static const int threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  // Never destroyed, the ops may still run on other threads at exit.
+  static framework::ThreadPool *pool =
+      threads > 1 ? new framework::ThreadPool(threads - 1) : nullptr;
+  *num_threads = threads;
+  return pool;
+}
+#endif
+
 MatDescriptor CreateMatrixDescriptor(const framework::DDim &tensor_dim,
                                      int num_flatten_cols, bool trans) {
   PADDLE_ENFORCE_GT(tensor_dim.size(), 1);
@@ -29,10 +29,23 @@
 #include <cblas.h>
 #endif
 
+namespace paddle {
+namespace framework {
+class ThreadPool;
+}  // namespace framework
+}  // namespace paddle
+
 namespace paddle {
 namespace operators {
 namespace math {
 
+#ifndef PADDLE_WITH_MKLML
+// The pool which runs the batches of the small matrices of BatchedGEMM in
+// parallel on the CPU, when the math library has no batched GEMM. It is
+// nullptr if there is only one core.
+framework::ThreadPool* BatchedGEMMThreadPool(int* num_threads);
+#endif
+
 /**
  * Matrix Descriptor of a memory buffer.
  *
@@ -15,6 +15,11 @@
 #include <cmath>
 #include <limits>
 #include <vector>
+#ifndef PADDLE_WITH_MKLML
+#include <algorithm>
+#include <future>  // NOLINT
+#include "paddle/fluid/framework/threadpool.h"
+#endif
 #include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
@@ -646,11 +651,42 @@ void Blas<platform::CPUDeviceContext>::BatchedGEMM(
                        a_array.data(), &lda, b_array.data(), &ldb, &beta,
                        c_array.data(), &ldc, 1 /* group_count */, &batchCount);
 #else
-  for (int k = 0; k < batchCount; ++k) {
-    auto *Ak = &A[k * strideA];
-    auto *Bk = &B[k * strideB];
-    auto *Ck = &C[k * M * N];
-    this->template GEMM<T>(transA, transB, M, N, K, alpha, Ak, Bk, beta, Ck);
+  auto run_batches = [&](int begin, int end) {
+    for (int k = begin; k < end; ++k) {
+      auto *Ak = &A[k * strideA];
+      auto *Bk = &B[k * strideB];
+      auto *Ck = &C[k * M * N];
+      this->template GEMM<T>(transA, transB, M, N, K, alpha, Ak, Bk, beta, Ck);
+    }
+  };
+  // The BLAS libraries run a GEMM below about 64 * 64 * 64 multiply-adds on
+  // one thread, so the small matrices, e.g. the heads of attention, are the
+  // ones worth running in parallel over the batch.
+  constexpr int64_t kMaxParallelMNK = 1 << 18;
+  constexpr int64_t kMinTaskMNK = 1 << 16;
+  int64_t mnk = static_cast<int64_t>(M) * N * K;
+  int num_threads = 1;
+  auto *pool = batchCount > 1 && mnk <= kMaxParallelMNK
+                   ? BatchedGEMMThreadPool(&num_threads)
+                   : nullptr;
+  int64_t num_tasks = std::min<int64_t>(
+      std::min<int64_t>(num_threads, batchCount),
+      std::max<int64_t>(1, mnk * batchCount / kMinTaskMNK));
+  if (pool == nullptr || num_tasks <= 1) {
+    run_batches(0, batchCount);
+    return;
+  }
+  int per_task = (batchCount + num_tasks - 1) / num_tasks;
+  std::vector<std::future<void>> futures;
+  for (int begin = per_task; begin < batchCount; begin += per_task) {
+    int end = std::min(begin + per_task, batchCount);
+    futures.emplace_back(
+        pool->Run([&run_batches, begin, end] { run_batches(begin, end); }));
+  }
+  // the calling thread runs the first batches itself
+  run_batches(0, std::min(per_task, batchCount));
+  for (auto &f : futures) {
+    f.get();
   }
 #endif
 }
@@ -665,9 +701,12 @@ void Blas<platform::CPUDeviceContext>::BatchedGEMMWithHead(
     bool split_b_vertical) const {
   int lda = (transA == CblasNoTrans) ? W1 : H1;
   int ldb = (transB == CblasNoTrans) ? W2 : H2;
-  auto a_array = std::vector<const T *>(batchCount);
-  auto b_array = std::vector<const T *>(batchCount);
-  auto c_array = std::vector<T *>(batchCount);
+  // All the heads have the same dims, so the heads of all the batches go to
+  // one group of a single GEMM_BATCH call.
+  int total_count = batchCount * head_number;
+  auto a_array = std::vector<const T *>(total_count);
+  auto b_array = std::vector<const T *>(total_count);
+  auto c_array = std::vector<T *>(total_count);
 
   if (split_b_vertical) {
     int ldc = W2;
@@ -682,17 +721,16 @@ void Blas<platform::CPUDeviceContext>::BatchedGEMMWithHead(
                                 : i * (W2 / head_number) * H2;
       int sub_matC_offset = i * W2 / head_number;
       for (int k = 0; k < batchCount; ++k) {
-        a_array[k] = &A[k * strideA] + sub_matA_offset;
-        b_array[k] = &B[k * strideB] + sub_matB_offset;
-        c_array[k] = &C[k * H1 * W2] + sub_matC_offset;
+        a_array[i * batchCount + k] = &A[k * strideA] + sub_matA_offset;
+        b_array[i * batchCount + k] = &B[k * strideB] + sub_matB_offset;
+        c_array[i * batchCount + k] = &C[k * H1 * W2] + sub_matC_offset;
       }
-
-      CBlas<T>::GEMM_BATCH(CblasRowMajor, &transA, &transB, &H1, &sub_width,
-                           &H2, &alpha, a_array.data(), &lda, b_array.data(),
-                           &ldb, &beta, c_array.data(), &ldc,
-                           1 /* group_count */, &batchCount);
     }
 
+    CBlas<T>::GEMM_BATCH(CblasRowMajor, &transA, &transB, &H1, &sub_width,
+                         &H2, &alpha, a_array.data(), &lda, b_array.data(),
+                         &ldb, &beta, c_array.data(), &ldc,
+                         1 /* group_count */, &total_count);
   } else {
     PADDLE_ENFORCE_EQ(W1, H2);
     int ldc = W2 * head_number;
@@ -707,16 +745,17 @@ void Blas<platform::CPUDeviceContext>::BatchedGEMMWithHead(
                                 : i * (W1 / head_number);
       int sub_matC_offset = i * W2;
       for (int k = 0; k < batchCount; ++k) {
-        a_array[k] = &A[k * strideA] + sub_matA_offset;
-        b_array[k] = &B[k * strideB] + sub_matB_offset;
-        c_array[k] = &C[k * H1 * head_number * W2] + sub_matC_offset;
+        a_array[i * batchCount + k] = &A[k * strideA] + sub_matA_offset;
+        b_array[i * batchCount + k] = &B[k * strideB] + sub_matB_offset;
+        c_array[i * batchCount + k] =
+            &C[k * H1 * head_number * W2] + sub_matC_offset;
       }
-
-      CBlas<T>::GEMM_BATCH(CblasRowMajor, &transA, &transB, &H1, &W2,
-                           &sub_width, &alpha, a_array.data(), &lda,
-                           b_array.data(), &ldb, &beta, c_array.data(), &ldc,
-                           1 /* group_count */, &batchCount);
     }
+
+    CBlas<T>::GEMM_BATCH(CblasRowMajor, &transA, &transB, &H1, &W2,
+                         &sub_width, &alpha, a_array.data(), &lda,
+                         b_array.data(), &ldb, &beta, c_array.data(), &ldc,
+                         1 /* group_count */, &total_count);
   }
 }
 #endif
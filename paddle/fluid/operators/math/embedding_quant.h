@@ -0,0 +1,199 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The storage formats of the quantized embedding tables. A quantized table
+ * is still a float tensor of [rows, row_floats], so that it is saved,
+ * loaded, sliced into SelectedRows and sent like any float parameter, and
+ * every row is reinterpreted as a head of floats followed by the packed
+ * values:
+ *
+ *   kUInt8: min, max, then uint8 q, value = (max - min) / 256 * q + min
+ *   kFP16:  float16 values
+ *   kInt8:  scale, then int8 q, value = scale * q
+ *   kInt4:  scale, then int4 q + 8 two per byte, the lower half first,
+ *           value = scale * q
+ */
+enum class EmbeddingQuantType { kUInt8 = 0, kFP16 = 1, kInt8 = 2, kInt4 = 3 };
+
+inline EmbeddingQuantType GetEmbeddingQuantType(const std::string& name) {
+  if (name == "uint8") return EmbeddingQuantType::kUInt8;
+  if (name == "fp16") return EmbeddingQuantType::kFP16;
+  if (name == "int8") return EmbeddingQuantType::kInt8;
+  if (name == "int4") return EmbeddingQuantType::kInt4;
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "The quant_type of the embedding should be uint8, fp16, int8 or int4, "
+      "but received %s.",
+      name));
+}
+
+template <EmbeddingQuantType kType>
+struct EmbeddingQuant;
+
+template <>
+struct EmbeddingQuant<EmbeddingQuantType::kUInt8> {
+  static constexpr int64_t kHeadFloats = 2;
+  static constexpr int64_t kValuesPerFloat = 4;
+
+  HOSTDEVICE static inline float Dequant(const float* row, int64_t i) {
+    const uint8_t* q = reinterpret_cast<const uint8_t*>(row + kHeadFloats);
+    return (row[1] - row[0]) / 256.f * q[i] + row[0];
+  }
+
+  static void Quantize(const float* in, int64_t width, float* row) {
+    auto minmax = std::minmax_element(in, in + width);
+    float min = *minmax.first, max = *minmax.second;
+    float scale = (max - min) / 256.f;
+    float inv_scale = scale > 0.f ? 1.f / scale : 0.f;
+    uint8_t* q = reinterpret_cast<uint8_t*>(row + kHeadFloats);
+    for (int64_t i = 0; i < width; ++i) {
+      float v = std::round((in[i] - min) * inv_scale);
+      q[i] = static_cast<uint8_t>(std::min(v, 255.f));
+    }
+    row[0] = min;
+    row[1] = max;
+  }
+};
+
+template <>
+struct EmbeddingQuant<EmbeddingQuantType::kFP16> {
+  static constexpr int64_t kHeadFloats = 0;
+  static constexpr int64_t kValuesPerFloat = 2;
+
+  HOSTDEVICE static inline float Dequant(const float* row, int64_t i) {
+    return static_cast<float>(
+        reinterpret_cast<const platform::float16*>(row)[i]);
+  }
+
+  static void Quantize(const float* in, int64_t width, float* row) {
+    platform::float16* q = reinterpret_cast<platform::float16*>(row);
+    for (int64_t i = 0; i < width; ++i) {
+      q[i] = static_cast<platform::float16>(in[i]);
+    }
+  }
+};
+
+template <>
+struct EmbeddingQuant<EmbeddingQuantType::kInt8> {
+  static constexpr int64_t kHeadFloats = 1;
+  static constexpr int64_t kValuesPerFloat = 4;
+
+  HOSTDEVICE static inline float Dequant(const float* row, int64_t i) {
+    return row[0] * reinterpret_cast<const int8_t*>(row + kHeadFloats)[i];
+  }
+
+  static void Quantize(const float* in, int64_t width, float* row) {
+    float max_abs = 0.f;
+    for (int64_t i = 0; i < width; ++i) {
+      max_abs = std::max(max_abs, std::abs(in[i]));
+    }
+    float scale = max_abs / 127.f;
+    float inv_scale = scale > 0.f ? 1.f / scale : 0.f;
+    int8_t* q = reinterpret_cast<int8_t*>(row + kHeadFloats);
+    for (int64_t i = 0; i < width; ++i) {
+      q[i] = static_cast<int8_t>(std::round(in[i] * inv_scale));
+    }
+    row[0] = scale;
+  }
+};
+
+template <>
+struct EmbeddingQuant<EmbeddingQuantType::kInt4> {
+  static constexpr int64_t kHeadFloats = 1;
+  static constexpr int64_t kValuesPerFloat = 8;
+
+  HOSTDEVICE static inline float Dequant(const float* row, int64_t i) {
+    uint8_t b = reinterpret_cast<const uint8_t*>(row + kHeadFloats)[i >> 1];
+    int q = ((b >> ((i & 1) << 2)) & 0xF) - 8;
+    return row[0] * q;
+  }
+
+  static void Quantize(const float* in, int64_t width, float* row) {
+    float max_abs = 0.f;
+    for (int64_t i = 0; i < width; ++i) {
+      max_abs = std::max(max_abs, std::abs(in[i]));
+    }
+    float scale = max_abs / 7.f;
+    float inv_scale = scale > 0.f ? 1.f / scale : 0.f;
+    uint8_t* q = reinterpret_cast<uint8_t*>(row + kHeadFloats);
+    for (int64_t i = 0; i < width; i += 2) {
+      int lo = static_cast<int>(std::round(in[i] * inv_scale)) + 8;
+      int hi = static_cast<int>(std::round(in[i + 1] * inv_scale)) + 8;
+      q[i >> 1] = static_cast<uint8_t>(lo | (hi << 4));
+    }
+    row[0] = scale;
+  }
+};
+
+// The floats of the head and the values packed in a float of the rows.
+inline void GetEmbeddingQuantLayout(EmbeddingQuantType type,
+                                    int64_t* head_floats,
+                                    int64_t* values_per_float) {
+  switch (type) {
+#define EMBEDDING_QUANT_LAYOUT_CASE(kType)                      \
+  case kType:                                                   \
+    *head_floats = EmbeddingQuant<kType>::kHeadFloats;          \
+    *values_per_float = EmbeddingQuant<kType>::kValuesPerFloat; \
+    return
+    EMBEDDING_QUANT_LAYOUT_CASE(EmbeddingQuantType::kUInt8);
+    EMBEDDING_QUANT_LAYOUT_CASE(EmbeddingQuantType::kFP16);
+    EMBEDDING_QUANT_LAYOUT_CASE(EmbeddingQuantType::kInt8);
+    EMBEDDING_QUANT_LAYOUT_CASE(EmbeddingQuantType::kInt4);
+#undef EMBEDDING_QUANT_LAYOUT_CASE
+  }
+}
+
+// The floats of a quantized row of width values, the width must be a
+// multiple of the values packed in a float.
+inline int64_t QuantizedRowFloats(EmbeddingQuantType type, int64_t width) {
+  int64_t head_floats, values_per_float;
+  GetEmbeddingQuantLayout(type, &head_floats, &values_per_float);
+  PADDLE_ENFORCE_EQ(width % values_per_float, 0,
+                    platform::errors::InvalidArgument(
+                        "The width of the quantized embedding should be a "
+                        "multiple of %d, but received %d.",
+                        values_per_float, width));
+  return head_floats + width / values_per_float;
+}
+
+// The width of a quantized row of row_floats floats.
+inline int64_t DequantizedRowWidth(EmbeddingQuantType type,
+                                   int64_t row_floats) {
+  int64_t head_floats, values_per_float;
+  GetEmbeddingQuantLayout(type, &head_floats, &values_per_float);
+  PADDLE_ENFORCE_GT(row_floats, head_floats,
+                    platform::errors::InvalidArgument(
+                        "The quantized embedding row should have more than "
+                        "%d floats, but received %d.",
+                        head_floats, row_floats));
+  return (row_floats - head_floats) * values_per_float;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
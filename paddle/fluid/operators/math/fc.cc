@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/fc.h"
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/packed_weights_cache.h"
 
 namespace paddle {
 namespace operators {
@@ -26,7 +27,8 @@ class FCFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context, const int M,
                   const int N, const int K, const T* X, const T* W, T* Y,
                   const T* B = nullptr, bool relu = false,
-                  bool padding_weights = false) {
+                  bool padding_weights = false,
+                  const T* packed_W = nullptr) {
     auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
     framework::Tensor Y1;
     T* Y1_data = nullptr;
@@ -44,6 +46,8 @@ class FCFunctor<platform::CPUDeviceContext, T> {
       }
       blas.GEMM(false, false, M, N, K, static_cast<T>(1.0), X1_data, KK, W, NN,
                 static_cast<T>(0.0), Y1_data, NN);
+    } else if (packed_W) {
+      PackedWeightsCache<T>::Instance().Compute(M, N, K, X, packed_W, Y);
     } else {
       blas.MatMul(M, N, K, X, W, Y);
     }
@@ -21,13 +21,14 @@ namespace paddle {
 namespace operators {
 namespace math {
 
+// The packed_W is the W packed by PackedWeightsCache, only used on CPU.
 template <typename DeviceContext, typename T>
 class FCFunctor {
  public:
   void operator()(const DeviceContext& context, const int M, const int N,
                   const int K, const T* X, const T* W, T* Y,
                   const T* B = nullptr, bool relu = false,
-                  bool weight_pass = false);
+                  bool weight_pass = false, const T* packed_W = nullptr);
 };
 
 }  // namespace math
@@ -282,3 +282,47 @@ TEST(math_function, gemm_warp) {
   GemmWarpTest<double>(8, 5, 6, 1.0, 0.0);
   GemmWarpTest<double>(8, 5, 6, 2.0, 1.0);
 }
+
+template <typename T>
+void BatchedGemmTest(int batch, int m, int n, int k, T alpha, T beta) {
+  paddle::framework::Tensor mat_a;
+  paddle::framework::Tensor mat_b;
+  paddle::framework::Tensor mat_c_ref;
+  paddle::framework::Tensor mat_c;
+  paddle::platform::CPUPlace cpu_place;
+
+  T* A = mat_a.mutable_data<T>({batch, m, k}, cpu_place);
+  T* B = mat_b.mutable_data<T>({batch, k, n}, cpu_place);
+  T* CREF = mat_c_ref.mutable_data<T>({batch, m, n}, cpu_place);
+  T* C = mat_c.mutable_data<T>({batch, m, n}, cpu_place);
+  for (int i = 0; i < mat_a.numel(); ++i) {
+    A[i] = static_cast<T>(i % 7);
+  }
+  for (int i = 0; i < mat_b.numel(); ++i) {
+    B[i] = static_cast<T>(i % 5 + 1);
+  }
+  for (int i = 0; i < mat_c.numel(); ++i) {
+    CREF[i] = static_cast<T>(i % 3);
+    C[i] = CREF[i];
+  }
+
+  paddle::platform::CPUDeviceContext context(cpu_place);
+  auto blas = GetBlas<T>(context);
+  blas.BatchedGEMM(CblasNoTrans, CblasNoTrans, m, n, k, alpha, A, B, beta, C,
+                   batch, m * k, k * n);
+  for (int i = 0; i < batch; ++i) {
+    blas.GEMM(CblasNoTrans, CblasNoTrans, m, n, k, alpha, A + i * m * k,
+              B + i * k * n, beta, CREF + i * m * n);
+  }
+
+  for (int i = 0; i < mat_c.numel(); ++i) {
+    EXPECT_FLOAT_EQ(CREF[i], C[i]);
+  }
+}
+
+TEST(math_function, batched_gemm) {
+  BatchedGemmTest<float>(1, 3, 2, 5, 1.f, 0.f);
+  BatchedGemmTest<float>(7, 8, 5, 6, 2.f, 1.f);
+  BatchedGemmTest<float>(96, 16, 16, 32, 1.f, 0.f);
+  BatchedGemmTest<double>(96, 16, 16, 32, 2.0, 1.0);
+}
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/matrix_bit_code.h"
+#include <algorithm>
 #include <iostream>
 #include <map>
 
@@ -124,162 +125,142 @@ void MatrixBitCodeFunctor<T>::Sum(const framework::Tensor &tmat,
   code_table_.apply_visitor(func);
 }
 
-template <typename T>
-struct MatrixBitCodeFunctorMul : public boost::static_visitor<void> {
-  framework::Tensor *tmat_;
-  const framework::Tensor &weight_;
-  const framework::Tensor &input_;
+struct MatrixBitCodeNodePlanBuilder : public boost::static_visitor<void> {
+  MatrixBitCodeNodePlan *plan_;
 
-  MatrixBitCodeFunctorMul(framework::Tensor *tmat,
-                          const framework::Tensor &weight,
-                          const framework::Tensor &input)
-      : tmat_(tmat), weight_(weight), input_(input) {}
+  explicit MatrixBitCodeNodePlanBuilder(MatrixBitCodeNodePlan *plan)
+      : plan_(plan) {}
 
   template <typename CodeTable>
   void operator()(const CodeTable &code_table) {
-    auto blas =
-        GetBlas<platform::CPUDeviceContext, T>(platform::CPUDeviceContext());
-    size_t num_samples = tmat_->dims()[0];
-    size_t tmat_width = tmat_->dims()[1];
-    size_t input_width = input_.dims()[1];
-    size_t weight_width = weight_.dims()[1];
-    auto tmat_value = tmat_->data<T>();
-    auto weight_value = weight_.data<T>();
-    auto input_value = input_.data<T>();
-    for (size_t i = 0; i < num_samples; ++i) {
+    std::vector<std::pair<int64_t, size_t>> pairs;
+    pairs.reserve(plan_->num_samples * plan_->width);
+    for (size_t i = 0; i < plan_->num_samples; ++i) {
       auto code = code_table.get_code(i);
       int code_length = code.get_length();
-      const T *input_row = input_value + input_width * i;
       for (int j = 0; j < code_length; ++j) {
-        size_t index = code.calc_index(j);
-        const T *weight_row = weight_value + weight_width * index;
-        T sum = blas.DOT(input_width, weight_row, input_row);
-        tmat_value[i * tmat_width + j] += sum;
+        pairs.emplace_back(code.calc_index(j), i * plan_->width + j);
       }
     }
+    std::sort(pairs.begin(), pairs.end());
+
+    plan_->nodes.clear();
+    plan_->offsets.clear();
+    plan_->positions.resize(pairs.size());
+    for (size_t p = 0; p < pairs.size(); ++p) {
+      if (p == 0 || pairs[p].first != pairs[p - 1].first) {
+        plan_->nodes.push_back(pairs[p].first);
+        plan_->offsets.push_back(p);
+      }
+      plan_->positions[p] = pairs[p].second;
+    }
+    plan_->offsets.push_back(pairs.size());
   }
 };
 
 template <typename T>
-void MatrixBitCodeFunctor<T>::Mul(framework::Tensor *tmat,
-                                  const framework::Tensor &weight,
-                                  const framework::Tensor &input) {
-  MatrixBitCodeFunctorMul<T> func(tmat, weight, input);
-  code_table_.apply_visitor(func);
+const MatrixBitCodeNodePlan &MatrixBitCodeFunctor<T>::GetNodePlan(
+    const framework::Tensor &tmat) {
+  size_t num_samples = tmat.dims()[0];
+  size_t width = tmat.dims()[1];
+  if (node_plan_.offsets.empty() || node_plan_.num_samples != num_samples ||
+      node_plan_.width != width) {
+    node_plan_.num_samples = num_samples;
+    node_plan_.width = width;
+    MatrixBitCodeNodePlanBuilder builder(&node_plan_);
+    code_table_.apply_visitor(builder);
+  }
+  return node_plan_;
 }
 
-template <typename T, size_t N>
-class ReservedVector : public std::vector<T> {
- public:
-  ReservedVector() { this->reserve(N); }
-};
-
 template <typename T>
-struct MatrixBitCodeFunctorMulGradWeight : public boost::static_visitor<void> {
-  const framework::Tensor &tmat_;
-  framework::Tensor *weight_;
-  const framework::Tensor &input_;
-  MatrixBitCodeFunctorMulGradWeight(const framework::Tensor &tmat,
-                                    framework::Tensor *weight,
-                                    const framework::Tensor &input)
-      : tmat_(tmat), weight_(weight), input_(input) {}
-  template <typename CodeTable>
-  void operator()(const CodeTable &code_table) {
-    auto blas =
-        GetBlas<platform::CPUDeviceContext, T>(platform::CPUDeviceContext());
-    size_t num_samples = tmat_.dims()[0];
-    size_t input_width = input_.dims()[1];
-    size_t tmat_width = tmat_.dims()[1];
-    size_t weight_width = weight_->dims()[1];
-    auto tmat_value = tmat_.data<T>();
-    auto weight_value = weight_->data<T>();
-    auto input_value = input_.data<T>();
-
-    std::map<int, ReservedVector<std::pair<T, const T *>, 8u>> ops;
-    for (size_t i = 0; i < num_samples; ++i) {
-      auto code = code_table.get_code(i);
-      int code_length = code.get_length();
-      const T *input_value_row = input_value + input_width * i;
-      const T *tmat_row = tmat_value + i * tmat_width;
-      for (int j = 0; j < code_length; ++j) {
-        ops[code.calc_index(j)].emplace_back(tmat_row[j], input_value_row);
-      }
-    }
-    for (auto &op : ops) {
-      auto &op_in_row = op.second;
-      for (auto &pair : op_in_row) {
-        auto &scale = pair.first;
-        auto *input_row = pair.second;
-        T *weight_row = weight_value + op.first * weight_width;
-        blas.AXPY(input_width, scale, input_row, weight_row);
-      }
+void MatrixBitCodeFunctor<T>::Mul(framework::Tensor *tmat,
+                                  const framework::Tensor &weight,
+                                  const framework::Tensor &input) {
+  platform::CPUDeviceContext dev_ctx;
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+  auto &plan = GetNodePlan(*tmat);
+  size_t tmat_width = tmat->dims()[1];
+  size_t input_width = input.dims()[1];
+  size_t weight_width = weight.dims()[1];
+  auto tmat_value = tmat->data<T>();
+  auto weight_value = weight.data<T>();
+  auto input_value = input.data<T>();
+  int64_t num_nodes = plan.nodes.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t k = 0; k < num_nodes; ++k) {
+    const T *weight_row = weight_value + weight_width * plan.nodes[k];
+    for (size_t p = plan.offsets[k]; p < plan.offsets[k + 1]; ++p) {
+      size_t pos = plan.positions[p];
+      const T *input_row = input_value + input_width * (pos / tmat_width);
+      tmat_value[pos] += blas.DOT(input_width, weight_row, input_row);
     }
   }
-};
+}
 
 template <typename T>
 void MatrixBitCodeFunctor<T>::MulGradWeight(const framework::Tensor &tmat,
                                             framework::Tensor *weight,
                                             const framework::Tensor &input) {
-  MatrixBitCodeFunctorMulGradWeight<T> func(tmat, weight, input);
-  code_table_.apply_visitor(func);
-}
-
-template <typename T>
-struct MatrixBitCodeFunctorMulGradWeightSR
-    : public boost::static_visitor<void> {
-  const framework::Tensor &tmat_;
-  framework::SelectedRows *weight_;
-  const framework::Tensor &input_;
-
-  MatrixBitCodeFunctorMulGradWeightSR(const framework::Tensor &tmat,
-                                      framework::SelectedRows *weight,
-                                      const framework::Tensor &input)
-      : tmat_(tmat), weight_(weight), input_(input) {}
-
-  template <typename CodeTable>
-  void operator()(const CodeTable &code_table) {
-    auto blas =
-        GetBlas<platform::CPUDeviceContext, T>(platform::CPUDeviceContext());
-    size_t num_samples = tmat_.dims()[0];
-    size_t input_width = input_.dims()[1];
-    size_t tmat_width = tmat_.dims()[1];
-    size_t weight_width = weight_->value().dims()[1];
-    auto tmat_value = tmat_.data<T>();
-    auto weight_value = weight_->mutable_value()->data<T>();
-    auto input_value = input_.data<T>();
-
-    std::unordered_map<int, std::vector<std::pair<T, const T *>>> ops;
-    ops.reserve(weight_->rows().size());
-
-    for (size_t i = 0; i < num_samples; ++i) {
-      auto code = code_table.get_code(i);
-      int code_length = code.get_length();
-      const T *input_value_row = input_value + input_width * i;
-      const T *tmat_row = tmat_value + i * tmat_width;
-      for (int j = 0; j < code_length; ++j) {
-        ops[code.calc_index(j)].emplace_back(tmat_row[j], input_value_row);
-      }
-    }
-
-    for (auto &row : weight_->rows()) {
-      auto &op_in_row = ops[row];
-      for (auto &pair : op_in_row) {
-        auto &scale = pair.first;
-        auto *input_row = pair.second;
-        blas.AXPY(input_width, scale, input_row, weight_value);
-      }
-      weight_value += weight_width;
+  platform::CPUDeviceContext dev_ctx;
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+  auto &plan = GetNodePlan(tmat);
+  size_t tmat_width = tmat.dims()[1];
+  size_t input_width = input.dims()[1];
+  size_t weight_width = weight->dims()[1];
+  auto tmat_value = tmat.data<T>();
+  auto weight_value = weight->data<T>();
+  auto input_value = input.data<T>();
+  int64_t num_nodes = plan.nodes.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t k = 0; k < num_nodes; ++k) {
+    T *weight_row = weight_value + weight_width * plan.nodes[k];
+    for (size_t p = plan.offsets[k]; p < plan.offsets[k + 1]; ++p) {
+      size_t pos = plan.positions[p];
+      const T *input_row = input_value + input_width * (pos / tmat_width);
+      blas.AXPY(input_width, tmat_value[pos], input_row, weight_row);
     }
   }
-};
+}
 
 template <typename T>
 void MatrixBitCodeFunctor<T>::MulGradWeight(const framework::Tensor &tmat,
                                             framework::SelectedRows *weight,
                                             const framework::Tensor &input) {
-  MatrixBitCodeFunctorMulGradWeightSR<T> func(tmat, weight, input);
-  code_table_.apply_visitor(func);
+  platform::CPUDeviceContext dev_ctx;
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+  auto &plan = GetNodePlan(tmat);
+  size_t tmat_width = tmat.dims()[1];
+  size_t input_width = input.dims()[1];
+  size_t weight_width = weight->value().dims()[1];
+  auto tmat_value = tmat.data<T>();
+  auto weight_value = weight->mutable_value()->data<T>();
+  auto input_value = input.data<T>();
+
+  auto &rows = weight->rows();
+  std::unordered_map<int64_t, size_t> row_index;
+  row_index.reserve(rows.size());
+  for (size_t r = 0; r < rows.size(); ++r) {
+    row_index.emplace(rows[r], r);
+  }
+  int64_t num_nodes = plan.nodes.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t k = 0; k < num_nodes; ++k) {
+    auto it = row_index.find(plan.nodes[k]);
+    if (it == row_index.end()) continue;
+    T *weight_row = weight_value + weight_width * it->second;
+    for (size_t p = plan.offsets[k]; p < plan.offsets[k + 1]; ++p) {
+      size_t pos = plan.positions[p];
+      const T *input_row = input_value + input_width * (pos / tmat_width);
+      blas.AXPY(input_width, tmat_value[pos], input_row, weight_row);
+    }
+  }
 }
 
 template <typename T>
@@ -294,7 +275,9 @@ struct MatrixBitCodeFunctorMulGradError : public boost::static_visitor<void> {
       : tmat_(tmat), weight_(weight), input_(input) {}
   template <typename CodeTable>
   void operator()(const CodeTable &code_table) {
-    size_t num_samples = tmat_.dims()[0];
+    platform::CPUDeviceContext dev_ctx;
+    auto blas = GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+    int64_t num_samples = tmat_.dims()[0];
     size_t tmat_width = tmat_.dims()[1];
     size_t input_width = input_->dims()[1];
     size_t weight_width = weight_.dims()[1];
@@ -302,17 +285,18 @@ struct MatrixBitCodeFunctorMulGradError : public boost::static_visitor<void> {
     auto weight_value = weight_.data<T>();
     auto input_value = input_->data<T>();
 
-    for (size_t i = 0; i < num_samples; ++i) {
+    // every sample accumulates its own row of the input gradient
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < num_samples; ++i) {
       auto code = code_table.get_code(i);
       int code_length = code.get_length();
+      T *input_row = input_value + input_width * i;
       for (int j = 0; j < code_length; ++j) {
-        size_t index = code.calc_index(j);
-
-        for (size_t k = 0; k < input_width; ++k) {
-          input_value[input_width * i + k] +=
-              tmat_value[i * tmat_width + j] *
-              weight_value[weight_width * index + k];
-        }
+        const T *weight_row = weight_value + weight_width * code.calc_index(j);
+        blas.AXPY(input_width, tmat_value[i * tmat_width + j], weight_row,
+                  input_row);
       }
     }
   }
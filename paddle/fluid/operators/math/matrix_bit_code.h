@@ -203,6 +203,21 @@ class CustomCodeTable {
 
 using CodeTable = boost::variant<SimpleCodeTable, CustomCodeTable<int64_t>>;
 
+/**
+ * The (sample, bit) pairs of a batch grouped by the node of the tree, i.e.,
+ * the row of the weight. The pairs of nodes[k] are the positions
+ * positions[offsets[k]] .. positions[offsets[k + 1] - 1] in the tmat of
+ * [num_samples, width], so that the nodes can be computed in parallel, and
+ * the weight row of a node is loaded once for all its samples.
+ */
+struct MatrixBitCodeNodePlan {
+  size_t num_samples{0};
+  size_t width{0};
+  std::vector<int64_t> nodes;
+  std::vector<size_t> offsets;
+  std::vector<size_t> positions;
+};
+
 template <typename T>
 class MatrixBitCodeFunctor {
  public:
@@ -258,9 +273,13 @@ class MatrixBitCodeFunctor {
   void MulGradError(const framework::Tensor& tmat,
                     const framework::Tensor& weight, framework::Tensor* input);
 
+  // Built on the first use, the codes of a functor are fixed.
+  const MatrixBitCodeNodePlan& GetNodePlan(const framework::Tensor& tmat);
+
   size_t num_classes_;
   const int64_t* ids_;
   CodeTable code_table_;
+  MatrixBitCodeNodePlan node_plan_;
 };
 }  // namespace math
 }  // namespace operators
@@ -0,0 +1,111 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_weights_cache.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+PackedWeightsCache<T>& PackedWeightsCache<T>::Instance() {
+  static PackedWeightsCache<T> cache;
+  return cache;
+}
+
+template <typename T>
+PackedWeightsCache<T>::~PackedWeightsCache() {
+  for (auto& it : entries_) {
+    Free(&it.second);
+  }
+}
+
+template <typename T>
+void PackedWeightsCache<T>::Free(Entry* entry) const {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx_);
+  blas.GEMM_FREE(entry->packed);
+#endif
+  entry->packed = nullptr;
+}
+
+template <typename T>
+const T* PackedWeightsCache<T>::Get(const framework::Tensor& w) {
+#ifdef PADDLE_WITH_MKLML
+  PADDLE_ENFORCE_EQ(
+      w.dims().size(), 2,
+      platform::errors::InvalidArgument(
+          "The packed weights must be 2-D, but received %d-D weights.",
+          w.dims().size()));
+  const T* data = w.data<T>();
+  int64_t k = w.dims()[0];
+  int64_t n = w.dims()[1];
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(data);
+  if (it != entries_.end()) {
+    auto& entry = it->second;
+    if (entry.holder.lock() == w.Holder() && entry.k == k && entry.n == n) {
+      return entry.packed;
+    }
+    Free(&entry);
+    entries_.erase(it);
+  }
+  // drop the weights which have been freed before packing the new ones
+  for (auto iter = entries_.begin(); iter != entries_.end();) {
+    if (iter->second.holder.expired()) {
+      Free(&iter->second);
+      iter = entries_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx_);
+  // the packed B matrix does not depend on the height of A
+  T* packed = blas.GEMM_ALLOC(CblasBMatrix, 1, n, k);
+  PADDLE_ENFORCE_NOT_NULL(
+      packed, platform::errors::ResourceExhausted(
+                  "Failed to allocate the packed weights of shape (%d, %d).",
+                  k, n));
+  blas.GEMM_PACK(CblasBMatrix, CblasNoTrans, 1, n, k, static_cast<T>(1), data,
+                 n, packed);
+  VLOG(4) << "Packs the weights of shape (" << k << ", " << n << ").";
+  entries_[data] = Entry{w.Holder(), k, n, packed};
+  return packed;
+#else
+  return nullptr;
+#endif
+}
+
+template <typename T>
+void PackedWeightsCache<T>::Compute(int M, int N, int K, const T* X,
+                                    const T* packed_W, T* Y) const {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx_);
+  blas.GEMM_COMPUTE(CblasNoTrans, CblasPacked, M, N, K, X, K, packed_W, N,
+                    static_cast<T>(0), Y, N);
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The packed GEMM is only supported with MKLML."));
+#endif
+}
+
+template class PackedWeightsCache<float>;
+template class PackedWeightsCache<double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
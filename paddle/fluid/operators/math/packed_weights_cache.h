@@ -0,0 +1,69 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The weights of the GEMMs packed by MKL once, and reused by all the later
+ * runs, which saves the packing done inside every cblas_sgemm call on the
+ * small batches. Only the weights which do not change once loaded, i.e., the
+ * persistable parameters of the inference, should be packed.
+ *
+ * The packed weights are keyed by the data of the weights, and packed again
+ * if the memory of the weights is freed and reused by other tensors.
+ */
+template <typename T>
+class PackedWeightsCache {
+ public:
+  static PackedWeightsCache& Instance();
+
+  ~PackedWeightsCache();
+
+  // Return the weights of shape (K, N) packed as the B matrix of the
+  // GEMM_COMPUTE, or nullptr if the packed GEMM is not supported by the build.
+  const T* Get(const framework::Tensor& w);
+
+  // Compute Y = X * W with the packed weights, where X is (M, K).
+  void Compute(int M, int N, int K, const T* X, const T* packed_W, T* Y) const;
+
+ private:
+  PackedWeightsCache() : ctx_(platform::CPUPlace()) {}
+
+  struct Entry {
+    std::weak_ptr<memory::Allocation> holder;
+    int64_t k;
+    int64_t n;
+    T* packed;
+  };
+
+  void Free(Entry* entry) const;
+
+  platform::CPUDeviceContext ctx_;
+  std::mutex mutex_;
+  std::unordered_map<const T*, Entry> entries_;
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
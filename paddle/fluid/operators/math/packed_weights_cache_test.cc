@@ -0,0 +1,69 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_weights_cache.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/operators/math/fc.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static void RandomInit(framework::Tensor* t, int64_t rows, int64_t cols) {
+  float* data = t->mutable_data<float>({rows, cols}, platform::CPUPlace());
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    data[i] = static_cast<float>(i % 7) * 0.25f - 0.5f;
+  }
+}
+
+TEST(PackedWeightsCache, fc) {
+  const int M = 3, N = 20, K = 17;
+  framework::Tensor x, w, bias, ref, out;
+  RandomInit(&x, M, K);
+  RandomInit(&w, K, N);
+  RandomInit(&bias, 1, N);
+  float* ref_data = ref.mutable_data<float>({M, N}, platform::CPUPlace());
+  float* out_data = out.mutable_data<float>({M, N}, platform::CPUPlace());
+
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  FCFunctor<platform::CPUDeviceContext, float> fc;
+  fc(ctx, M, N, K, x.data<float>(), w.data<float>(), ref_data,
+     bias.data<float>(), true);
+
+  auto& cache = PackedWeightsCache<float>::Instance();
+  const float* packed = cache.Get(w);
+#ifdef PADDLE_WITH_MKLML
+  ASSERT_NE(packed, nullptr);
+  // packed only once
+  EXPECT_EQ(cache.Get(w), packed);
+  fc(ctx, M, N, K, x.data<float>(), w.data<float>(), out_data,
+     bias.data<float>(), true, false, packed);
+  for (int i = 0; i < M * N; ++i) {
+    EXPECT_NEAR(out_data[i], ref_data[i], 1e-5);
+  }
+
+  // the weights of another shape are packed again
+  w.Resize({N, K});
+  const float* repacked = cache.Get(w);
+  ASSERT_NE(repacked, nullptr);
+  EXPECT_EQ(cache.Get(w), repacked);
+#else
+  EXPECT_EQ(packed, nullptr);
+#endif
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
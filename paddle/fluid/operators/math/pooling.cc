@@ -21,6 +21,164 @@ namespace paddle {
 namespace operators {
 namespace math {
 
+/*
+ * Accumulates an input row into the pooling windows of an output row, which
+ * are fully inside the input. The loop over the output width is vectorized by
+ * the compiler, where the 2x2 and 3x3 windows are unrolled.
+ */
+template <int KsizeWidth, typename PoolProcess, typename T>
+static inline void Pool2dRowInterior(const T* input_row, T* output_row,
+                                     const int pw_begin, const int pw_end,
+                                     const int ksize_width,
+                                     const int stride_width,
+                                     const int padding_width,
+                                     PoolProcess pool_process) {
+  const T* x = input_row - padding_width;
+  if (KsizeWidth > 0) {
+    for (int pw = pw_begin; pw < pw_end; ++pw) {
+      for (int kw = 0; kw < KsizeWidth; ++kw) {
+        pool_process.compute(x[pw * stride_width + kw], output_row + pw);
+      }
+    }
+  } else {
+    for (int kw = 0; kw < ksize_width; ++kw) {
+      for (int pw = pw_begin; pw < pw_end; ++pw) {
+        pool_process.compute(x[pw * stride_width + kw], output_row + pw);
+      }
+    }
+  }
+}
+
+/*
+ * Pools one feature map of NCHW. Every output element is computed over the
+ * same inputs in the same order as the plain loops, so the results are the
+ * same, except for the global pooling, which reduces the feature map with
+ * several partial results.
+ */
+template <typename PoolProcess, typename T>
+static void Pool2dPlane(const T* input_data, T* output_data,
+                        const int input_height, const int input_width,
+                        const int output_height, const int output_width,
+                        const int ksize_height, const int ksize_width,
+                        const int stride_height, const int stride_width,
+                        const int padding_height, const int padding_width,
+                        PoolProcess pool_process, bool exclusive,
+                        bool adaptive) {
+  if (output_height == 1 && output_width == 1 &&
+      (adaptive || (padding_height == 0 && padding_width == 0 &&
+                    ksize_height >= input_height &&
+                    ksize_width >= input_width))) {
+    constexpr int kNumPartials = 8;
+    const int input_size = input_height * input_width;
+    T partials[kNumPartials];
+    for (int j = 0; j < kNumPartials; ++j) {
+      partials[j] = pool_process.initial();
+    }
+    int i = 0;
+    for (; i + kNumPartials <= input_size; i += kNumPartials) {
+      for (int j = 0; j < kNumPartials; ++j) {
+        pool_process.compute(input_data[i + j], &partials[j]);
+      }
+    }
+    T ele = pool_process.initial();
+    for (; i < input_size; ++i) {
+      pool_process.compute(input_data[i], &ele);
+    }
+    for (int j = 0; j < kNumPartials; ++j) {
+      pool_process.compute(partials[j], &ele);
+    }
+    int pool_size = (exclusive || adaptive) ? input_size
+                                            : ksize_height * ksize_width;
+    pool_process.finalize(static_cast<T>(pool_size), &ele);
+    output_data[0] = ele;
+    return;
+  }
+
+  int hstart, hend;
+  int wstart, wend;
+  if (adaptive) {
+    for (int ph = 0; ph < output_height; ++ph) {
+      hstart = AdaptStartIndex(ph, input_height, output_height);
+      hend = AdaptEndIndex(ph, input_height, output_height);
+      for (int pw = 0; pw < output_width; ++pw) {
+        wstart = AdaptStartIndex(pw, input_width, output_width);
+        wend = AdaptEndIndex(pw, input_width, output_width);
+        T ele = pool_process.initial();
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            pool_process.compute(input_data[h * input_width + w], &ele);
+          }
+        }
+        int pool_size = (hend - hstart) * (wend - wstart);
+        pool_process.finalize(static_cast<T>(pool_size), &ele);
+        output_data[ph * output_width + pw] = ele;
+      }
+    }
+    return;
+  }
+
+  // the windows of [pw_begin, pw_end) are fully inside the input width
+  int pw_begin =
+      std::min(output_width, (padding_width + stride_width - 1) / stride_width);
+  int pw_end = input_width + padding_width >= ksize_width
+                   ? std::min(output_width,
+                              (input_width + padding_width - ksize_width) /
+                                      stride_width +
+                                  1)
+                   : 0;
+  pw_end = std::max(pw_end, pw_begin);
+  auto pool_border = [&](const T* input_row, T* output_row, int pw) {
+    wstart = pw * stride_width - padding_width;
+    wend = std::min(wstart + ksize_width, input_width);
+    wstart = std::max(wstart, 0);
+    for (int w = wstart; w < wend; ++w) {
+      pool_process.compute(input_row[w], output_row + pw);
+    }
+  };
+
+  for (int ph = 0; ph < output_height; ++ph) {
+    hstart = ph * stride_height - padding_height;
+    hend = std::min(hstart + ksize_height, input_height);
+    hstart = std::max(hstart, 0);
+    T* output_row = output_data + ph * output_width;
+    for (int pw = 0; pw < output_width; ++pw) {
+      output_row[pw] = pool_process.initial();
+    }
+    for (int h = hstart; h < hend; ++h) {
+      const T* input_row = input_data + h * input_width;
+      for (int pw = 0; pw < pw_begin; ++pw) {
+        pool_border(input_row, output_row, pw);
+      }
+      if (ksize_width == 2) {
+        Pool2dRowInterior<2>(input_row, output_row, pw_begin, pw_end,
+                             ksize_width, stride_width, padding_width,
+                             pool_process);
+      } else if (ksize_width == 3) {
+        Pool2dRowInterior<3>(input_row, output_row, pw_begin, pw_end,
+                             ksize_width, stride_width, padding_width,
+                             pool_process);
+      } else {
+        Pool2dRowInterior<0>(input_row, output_row, pw_begin, pw_end,
+                             ksize_width, stride_width, padding_width,
+                             pool_process);
+      }
+      for (int pw = pw_end; pw < output_width; ++pw) {
+        pool_border(input_row, output_row, pw);
+      }
+    }
+    for (int pw = 0; pw < output_width; ++pw) {
+      int pool_size = ksize_height * ksize_width;
+      if (exclusive) {
+        wstart = pw * stride_width - padding_width;
+        wend = std::min(wstart + ksize_width, input_width);
+        wstart = std::max(wstart, 0);
+        pool_size = (hend - hstart) * (wend - wstart);
+      }
+      pool_process.finalize(static_cast<T>(pool_size), output_row + pw);
+    }
+  }
+}
+
 /*
 * Tensors are in NCHW or NHWC format.
 * Ksize, strides are two elements. These two elements represent height
@@ -55,45 +213,15 @@ class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
     const T* input_data = input.data<T>();
     T* output_data = output->mutable_data<T>(context.GetPlace());
 
-    int hstart, hend;
-    int wstart, wend;
-    for (int i = 0; i < batch_size; i++) {
-      for (int c = 0; c < output_channels; ++c) {
-        for (int ph = 0; ph < output_height; ++ph) {
-          if (adaptive) {
-            hstart = AdaptStartIndex(ph, input_height, output_height);
-            hend = AdaptEndIndex(ph, input_height, output_height);
-          } else {
-            hstart = ph * stride_height - padding_height;
-            hend = std::min(hstart + ksize_height, input_height);
-            hstart = std::max(hstart, 0);
-          }
-          for (int pw = 0; pw < output_width; ++pw) {
-            if (adaptive) {
-              wstart = AdaptStartIndex(pw, input_width, output_width);
-              wend = AdaptEndIndex(pw, input_width, output_width);
-            } else {
-              wstart = pw * stride_width - padding_width;
-              wend = std::min(wstart + ksize_width, input_width);
-              wstart = std::max(wstart, 0);
-            }
-
-            T ele = pool_process.initial();
-            for (int h = hstart; h < hend; ++h) {
-              for (int w = wstart; w < wend; ++w) {
-                pool_process.compute(input_data[h * input_width + w], &ele);
-              }
-            }
-            int pool_size = (exclusive || adaptive)
-                                ? (hend - hstart) * (wend - wstart)
-                                : ksize_height * ksize_width;
-            pool_process.finalize(static_cast<T>(pool_size), &ele);
-            output_data[ph * output_width + pw] = ele;
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-      }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < batch_size * output_channels; ++i) {
+      Pool2dPlane(input_data + i * input_stride, output_data + i * output_stride,
+                  input_height, input_width, output_height, output_width,
+                  ksize_height, ksize_width, stride_height, stride_width,
+                  padding_height, padding_width, pool_process, exclusive,
+                  adaptive);
     }
   }
 
@@ -134,43 +262,15 @@ class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
     if (!channel_last) {
       const int input_stride = input_height * input_width;
       const int output_stride = output_height * output_width;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            if (adaptive) {
-              hstart = AdaptStartIndex(ph, input_height, output_height);
-              hend = AdaptEndIndex(ph, input_height, output_height);
-            } else {
-              hstart = ph * stride_height - padding_height;
-              hend = std::min(hstart + ksize_height, input_height);
-              hstart = std::max(hstart, 0);
-            }
-            for (int pw = 0; pw < output_width; ++pw) {
-              if (adaptive) {
-                wstart = AdaptStartIndex(pw, input_width, output_width);
-                wend = AdaptEndIndex(pw, input_width, output_width);
-              } else {
-                wstart = pw * stride_width - padding_width;
-                wend = std::min(wstart + ksize_width, input_width);
-                wstart = std::max(wstart, 0);
-              }
-
-              T ele = pool_process.initial();
-              for (int h = hstart; h < hend; ++h) {
-                for (int w = wstart; w < wend; ++w) {
-                  pool_process.compute(input_data[h * input_width + w], &ele);
-                }
-              }
-              int pool_size = (exclusive || adaptive)
-                                  ? (hend - hstart) * (wend - wstart)
-                                  : ksize_height * ksize_width;
-              pool_process.finalize(static_cast<T>(pool_size), &ele);
-              output_data[ph * output_width + pw] = ele;
-            }
-          }
-          input_data += input_stride;
-          output_data += output_stride;
-        }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < batch_size * output_channels; ++i) {
+        Pool2dPlane(input_data + i * input_stride,
+                    output_data + i * output_stride, input_height, input_width,
+                    output_height, output_width, ksize_height, ksize_width,
+                    stride_height, stride_width, padding_height, padding_width,
+                    pool_process, exclusive, adaptive);
       }
     } else {
       const int input_stride = input_height * input_width * input_channels;
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <cstring>
 #include <set>
 #include <unordered_map>
 
@@ -295,8 +296,9 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
-    size_t row_num = 0;
+    // All the rows of the inputs, and where their values are.
+    std::vector<int64_t> all_rows;
+    std::vector<const T*> row_data;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
@@ -306,27 +308,44 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
                         "dimension except for the first one");
       PADDLE_ENFORCE_EQ(input_height, input->height(),
                         "all input should have same height");
-      row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
+      auto* input_data = input->value().data<T>();
+      all_rows.insert(all_rows.end(), input->rows().begin(),
+                      input->rows().end());
+      for (size_t i = 0; i < input->rows().size(); ++i) {
+        row_data.emplace_back(input_data + i * input_width);
+      }
     }
+    size_t row_num = all_rows.size();
+
+    // Sort the rows, the duplicated ones are then in one segment and are
+    // added in the order of the inputs.
+    std::vector<size_t> order(row_num);
+    for (size_t i = 0; i < row_num; ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return all_rows[a] < all_rows[b];
+    });
+    std::vector<int64_t> merge_rows;
+    std::vector<size_t> segment_starts;
+    for (size_t i = 0; i < row_num; ++i) {
+      if (i == 0 || all_rows[order[i]] != all_rows[order[i - 1]]) {
+        merge_rows.emplace_back(all_rows[order[i]]);
+        segment_starts.emplace_back(i);
+      }
+    }
+    segment_starts.emplace_back(row_num);
 
     out.set_height(input_height);
     out.mutable_value()->mutable_data<T>(
         framework::make_ddim(
-            {static_cast<int64_t>(merged_row_set.size()), input_width}),
+            {static_cast<int64_t>(merge_rows.size()), input_width}),
         context.GetPlace());
     auto* out_data = out.mutable_value()->data<T>();
 
-    if (merged_row_set.size() == row_num && !sorted_result) {
+    if (merge_rows.size() == row_num && !sorted_result) {
       // no duplicated ids, just concat the result together
-      std::vector<int64_t> merge_rows;
-      merge_rows.reserve(row_num);
-      // concat rows
-      for (auto* in : inputs) {
-        merge_rows.insert(merge_rows.end(), in->rows().begin(),
-                          in->rows().end());
-      }
-      out.set_rows(merge_rows);
+      out.set_rows(all_rows);
       auto in_place = inputs[0]->place();
       auto out_place = out.place();
       int64_t copied_numel = 0;
@@ -340,36 +359,23 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
         copied_numel += in_numel;
       }
     } else {
-      std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                      merged_row_set.end());
-
-      if (sorted_result) {
-        std::sort(merge_rows.begin(), merge_rows.end());
-      }
-
       out.set_rows(merge_rows);
 
-      math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
-      constant_functor(context, out.mutable_value(), 0.0);
-
-      std::unordered_map<int64_t, size_t> rows_to_id;
-      for (size_t i = 0; i < merge_rows.size(); ++i) {
-        rows_to_id[merge_rows[i]] = i;
-      }
-
+      // The segments are independent, so they are reduced in parallel.
       auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-      for (auto* input : inputs) {
-        if (input->rows().size() == 0) {
-          continue;
-        }
-        auto* input_data = input->value().data<T>();
-        auto& input_rows = input->rows();
-
-        for (size_t i = 0; i < input_rows.size(); i++) {
-          size_t out_i = rows_to_id[input_rows[i]];
+      int64_t num_segments = static_cast<int64_t>(merge_rows.size());
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int64_t s = 0; s < num_segments; ++s) {
+        T* out_row = out_data + s * input_width;
+        std::memcpy(out_row, row_data[order[segment_starts[s]]],
+                    input_width * sizeof(T));
+        for (size_t i = segment_starts[s] + 1; i < segment_starts[s + 1];
+             ++i) {
           elementwise_add_to<platform::CPUDeviceContext, T>(
               context, &blas, static_cast<size_t>(input_width),
-              &input_data[i * input_width], &out_data[out_i * input_width]);
+              row_data[order[i]], out_row);
         }
       }
     }
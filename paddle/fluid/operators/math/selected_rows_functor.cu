@@ -12,9 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <set>
+#include <algorithm>
 #include <vector>
 
+#include "cub/cub.cuh"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
@@ -238,28 +239,23 @@ template struct SelectedRowsAddToTensor<platform::CUDADeviceContext,
 
 namespace scatter {
 
+// Every block reduces one segment of the sorted rows into one output row,
+// so no atomic add is needed and the sums are deterministic.
 template <typename T, int block_size>
-__global__ void MergeAddKernel(const T* input, const int64_t* input_rows,
-                               T* out, const int64_t* out_rows,
-                               size_t out_rows_size, int64_t row_numel) {
-  const int ty = blockIdx.x;
-  int tid = threadIdx.x;
-  __shared__ size_t out_idx;
-
-  if (tid == 0) {
-    for (size_t i = 0; i < out_rows_size; i++) {
-      if (input_rows[ty] == out_rows[i]) {
-        out_idx = i;
-      }
+__global__ void MergeAddKernel(const T* const* row_data,
+                               const int64_t* sorted_ids,
+                               const int* segment_starts,
+                               const int* segment_lengths, T* out,
+                               int64_t row_numel) {
+  int begin = segment_starts[blockIdx.x];
+  int end = begin + segment_lengths[blockIdx.x];
+  out += blockIdx.x * row_numel;
+  for (int64_t index = threadIdx.x; index < row_numel; index += block_size) {
+    T sum = row_data[sorted_ids[begin]][index];
+    for (int i = begin + 1; i < end; ++i) {
+      sum += row_data[sorted_ids[i]][index];
     }
-  }
-
-  __syncthreads();
-
-  input += ty * row_numel;
-  out += out_idx * row_numel;
-  for (int index = tid; index < row_numel; index += block_size) {
-    paddle::platform::CudaAtomicAdd(out + index, input[index]);
+    out[index] = sum;
   }
 }
 
@@ -277,41 +273,13 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
                   const framework::SelectedRows& input,
                   framework::SelectedRows* output,
                   const bool sorted_result = false) {
-    framework::Vector<int64_t> input_rows(input.rows());
-    if (input_rows.size() == 0) {
-      return;
-    }
-
-    framework::SelectedRows& out = *output;
-    std::set<int64_t> row_set(input_rows.begin(), input_rows.end());
-    std::vector<int64_t> merge_rows_cpu(row_set.begin(), row_set.end());
-    framework::Vector<int64_t> merge_rows(merge_rows_cpu);
-
-    auto input_width = input.value().dims()[1];
-
-    out.set_rows(merge_rows);
-    out.set_height(input.height());
-    out.mutable_value()->mutable_data<T>(
-        framework::make_ddim(
-            {static_cast<int64_t>(merge_rows.size()), input_width}),
-        context.GetPlace());
-
-    math::SetConstant<platform::CUDADeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), static_cast<T>(0));
-
-    auto* out_data = out.mutable_value()->data<T>();
-    auto* input_data = input.value().data<T>();
-
-    const int block_size = 256;
-    dim3 threads(block_size, 1);
-    dim3 grid1(input_rows.size(), 1);
-
-    MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
-        input_data, input_rows.CUDAData(context.GetPlace()), out_data,
-        out.mutable_rows()->CUDAMutableData(context.GetPlace()),
-        out.rows().size(), input_width);
+    std::vector<const framework::SelectedRows*> inputs;
+    inputs.push_back(&input);
+    (*this)(context, inputs, output, sorted_result);
   }
 
+  // The rows of the result are always sorted: the rows are radix sorted and
+  // the duplicated ones are encoded as runs, then every run is reduced.
   void operator()(const platform::CUDADeviceContext& context,
                   const std::vector<const framework::SelectedRows*>& inputs,
                   framework::SelectedRows* output,
@@ -334,7 +302,8 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
+    std::vector<int64_t> all_rows;
+    std::vector<const T*> row_data;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
@@ -344,40 +313,85 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
                         "dimension except for the first one");
       PADDLE_ENFORCE_EQ(input_height, input->height(),
                         "all input should have same height");
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
+      auto* input_data = input->value().data<T>();
+      all_rows.insert(all_rows.end(), input->rows().begin(),
+                      input->rows().end());
+      for (size_t i = 0; i < input->rows().size(); ++i) {
+        row_data.emplace_back(input_data + i * input_width);
+      }
+    }
+    int row_num = static_cast<int>(all_rows.size());
+    std::vector<int64_t> ids(row_num);
+    for (int i = 0; i < row_num; ++i) {
+      ids[i] = i;
     }
-    std::vector<int64_t> merge_rows_cpu(merged_row_set.begin(),
-                                        merged_row_set.end());
-    framework::Vector<int64_t> merge_rows(merge_rows_cpu);
 
+    auto place = BOOST_GET_CONST(platform::CUDAPlace, context.GetPlace());
+    auto stream = context.stream();
+    // [rows | ids | sorted rows | sorted ids | unique rows]
+    auto rows_buf = memory::Alloc(context, 5 * row_num * sizeof(int64_t));
+    int64_t* rows_ptr = static_cast<int64_t*>(rows_buf->ptr());
+    int64_t* ids_ptr = rows_ptr + row_num;
+    int64_t* sorted_rows_ptr = ids_ptr + row_num;
+    int64_t* sorted_ids_ptr = sorted_rows_ptr + row_num;
+    int64_t* unique_rows_ptr = sorted_ids_ptr + row_num;
+    // [segment starts | segment lengths | number of segments]
+    auto segments_buf = memory::Alloc(context, (2 * row_num + 1) * sizeof(int));
+    int* starts_ptr = static_cast<int*>(segments_buf->ptr());
+    int* lengths_ptr = starts_ptr + row_num;
+    int* num_segments_ptr = lengths_ptr + row_num;
+    auto row_data_buf = memory::Alloc(context, row_num * sizeof(const T*));
+    const T** row_data_ptr = static_cast<const T**>(row_data_buf->ptr());
+    memory::Copy(place, rows_ptr, platform::CPUPlace(), all_rows.data(),
+                 row_num * sizeof(int64_t), stream);
+    memory::Copy(place, ids_ptr, platform::CPUPlace(), ids.data(),
+                 row_num * sizeof(int64_t), stream);
+    memory::Copy(place, row_data_ptr, platform::CPUPlace(), row_data.data(),
+                 row_num * sizeof(const T*), stream);
+
+    // The temporary storage is shared by the three cub calls.
+    size_t sort_bytes = 0, encode_bytes = 0, scan_bytes = 0;
+    PADDLE_ENFORCE_CUDA_SUCCESS(cub::DeviceRadixSort::SortPairs(
+        nullptr, sort_bytes, rows_ptr, sorted_rows_ptr, ids_ptr,
+        sorted_ids_ptr, row_num, 0, sizeof(int64_t) * 8, stream));
+    PADDLE_ENFORCE_CUDA_SUCCESS(cub::DeviceRunLengthEncode::Encode(
+        nullptr, encode_bytes, sorted_rows_ptr, unique_rows_ptr, lengths_ptr,
+        num_segments_ptr, row_num, stream));
+    PADDLE_ENFORCE_CUDA_SUCCESS(cub::DeviceScan::ExclusiveSum(
+        nullptr, scan_bytes, lengths_ptr, starts_ptr, row_num, stream));
+    size_t temp_bytes =
+        std::max(sort_bytes, std::max(encode_bytes, scan_bytes));
+    auto temp_buf = memory::Alloc(context, temp_bytes);
+    void* temp_ptr = temp_buf->ptr();
+
+    PADDLE_ENFORCE_CUDA_SUCCESS(cub::DeviceRadixSort::SortPairs(
+        temp_ptr, sort_bytes, rows_ptr, sorted_rows_ptr, ids_ptr,
+        sorted_ids_ptr, row_num, 0, sizeof(int64_t) * 8, stream));
+    PADDLE_ENFORCE_CUDA_SUCCESS(cub::DeviceRunLengthEncode::Encode(
+        temp_ptr, encode_bytes, sorted_rows_ptr, unique_rows_ptr, lengths_ptr,
+        num_segments_ptr, row_num, stream));
+    int num_segments = 0;
+    memory::Copy(platform::CPUPlace(), &num_segments, place, num_segments_ptr,
+                 sizeof(int), stream);
+    context.Wait();
+    PADDLE_ENFORCE_CUDA_SUCCESS(cub::DeviceScan::ExclusiveSum(
+        temp_ptr, scan_bytes, lengths_ptr, starts_ptr, num_segments, stream));
+
+    std::vector<int64_t> merge_rows_cpu(num_segments);
+    memory::Copy(platform::CPUPlace(), merge_rows_cpu.data(), place,
+                 unique_rows_ptr, num_segments * sizeof(int64_t), stream);
+    context.Wait();
+    framework::Vector<int64_t> merge_rows(merge_rows_cpu);
     out.set_rows(merge_rows);
     out.set_height(input_height);
-    out.mutable_value()->mutable_data<T>(
-        framework::make_ddim(
-            {static_cast<int64_t>(merge_rows.size()), input_width}),
+    auto* out_data = out.mutable_value()->mutable_data<T>(
+        framework::make_ddim({static_cast<int64_t>(num_segments), input_width}),
         context.GetPlace());
 
-    math::SetConstant<platform::CUDADeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), static_cast<T>(0));
-
-    auto* out_data = out.mutable_value()->data<T>();
-
     const int block_size = 256;
-    dim3 threads(block_size, 1);
-
-    for (auto* input : inputs) {
-      if (input->rows().size() == 0) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-      dim3 grid1(input_rows.size(), 1);
-
-      MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
-          input_data, input_rows.CUDAData(context.GetPlace()), out_data,
-          out.mutable_rows()->CUDAMutableData(context.GetPlace()),
-          out.rows().size(), input_width);
-    }
+    MergeAddKernel<T, block_size><<<num_segments, block_size, 0, stream>>>(
+        row_data_ptr, sorted_ids_ptr, starts_ptr, lengths_ptr, out_data,
+        input_width);
   }
 };
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
+#include <map>
 #include <memory>
 #include <vector>
 #include "gtest/gtest.h"
@@ -403,6 +404,52 @@ TEST(selected_rows_functor, cpu_merge_add_multi) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_add_distinct_values) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+
+  int64_t height = 1000;
+  int64_t row_numel = 3;
+  // Many duplicated rows, the i-th row has the value i.
+  std::vector<int64_t> rows;
+  for (int64_t i = 0; i < 500; ++i) {
+    rows.push_back((i * 7) % 37);
+  }
+  std::unique_ptr<paddle::framework::SelectedRows> selected_rows{
+      new paddle::framework::SelectedRows(rows, height)};
+  auto* in_value = selected_rows->mutable_value();
+  auto* in_data = in_value->mutable_data<double>(
+      paddle::framework::make_ddim(
+          {static_cast<int64_t>(rows.size()), row_numel}),
+      cpu_place);
+  std::map<int64_t, double> expected;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      in_data[i * row_numel + j] = static_cast<double>(i);
+    }
+    expected[rows[i]] += static_cast<double>(i);
+  }
+
+  std::unique_ptr<paddle::framework::SelectedRows> output{
+      new paddle::framework::SelectedRows()};
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             double>
+      merge_add_functor;
+  merge_add_functor(ctx, *selected_rows, output.get());
+
+  EXPECT_EQ(output->height(), height);
+  ASSERT_EQ(output->rows().size(), expected.size());
+  auto* out_data = output->value().data<double>();
+  size_t i = 0;
+  for (auto& row_sum : expected) {
+    EXPECT_EQ(output->rows()[i], row_sum.first);
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j], row_sum.second);
+    }
+    ++i;
+  }
+}
+
 TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   paddle::platform::CPUPlace cpu_place;
   paddle::platform::CPUDeviceContext ctx(cpu_place);
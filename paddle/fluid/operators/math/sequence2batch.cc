@@ -13,11 +13,170 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence2batch.h"
+#include <list>
+#include <utility>
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+namespace {
+
+// Calculate the length of each sequence and
+// sort sequence index by the length.
+// example:  sequences = {s0, s1, s2}
+//           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+//           seq_info[3] = {(4, 5, 1), (0, 4, 0), (9, 3, 2)}
+//
+struct SeqInfo {
+  SeqInfo(size_t start, size_t length, size_t seq_idx)
+      : start(start), length(length), seq_idx(seq_idx) {}
+  size_t start;
+  size_t length;
+  size_t seq_idx;
+};
+
+framework::LoD ComputeSequence2BatchLoD(const framework::Vector<size_t>& lod,
+                                        size_t rows, bool is_reverse) {
+  std::vector<SeqInfo> seq_info;
+  for (size_t seq_id = 0; seq_id < lod.size() - 1; ++seq_id) {
+    size_t length = lod[seq_id + 1] - lod[seq_id];
+    seq_info.emplace_back(lod[seq_id], length, seq_id);
+  }
+
+  std::sort(seq_info.begin(), seq_info.end(),
+            [](SeqInfo a, SeqInfo b) { return a.length > b.length; });
+
+  // Calculate the start position of each batch.
+  // example:  sequences = {s0, s1, s2}
+  //           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+  //           max_seqlen = 5,
+  //           batchIndex = {b0, b1, b2, b3, b4}
+  //           b0: 1 0 2, b1: 1 0 2, b2: 1 0 2, b3: 1 0, b4: 1
+  //           batch_start_positions[6] = {0, 3, 6, 9, 11, 12}
+  //              batch_start_positions[0] = len(b0)
+  //              batch_start_positions[1] = len(b0) + len(b1)
+  //              batch_start_positions[2] = len(b0) + len(b1) + len(b2)
+  //              ...
+  //           seq2batch_idx[12] = {4, 0, 9,
+  //                                5, 1, 10,
+  //                                6, 2, 11,
+  //                                7, 3,
+  //                                8}
+  //           seq_order = {1, 0, 2}, the sort order.
+  //               where 1 is the second sequence,
+  //                     0 is the first sequence,
+  //                     2 is the third sequence.
+  // The max_seqlen represents batch size after rearranging the
+  // input LodTensor. It is also the maximum length of input sequence.
+
+  paddle::framework::LoD batch_lods;
+  batch_lods.emplace_back(std::vector<size_t>{0});
+  batch_lods.emplace_back(std::vector<size_t>{0});
+  batch_lods.emplace_back(std::vector<size_t>{0});
+
+  // batch_lods[0] is the start positions for batch LoDTensor
+  size_t max_seqlen = seq_info[0].length;
+  batch_lods[0].resize(max_seqlen + 1);
+  // batch_lods[1] is the raw index in the input LoDTensor
+  batch_lods[1].resize(rows);
+  // batch_lods[2] is the sort order for the input LoDTensor.
+  batch_lods[2].resize(seq_info.size());
+
+  size_t* batch_starts = batch_lods[0].data();
+  size_t* seq2batch_idx = batch_lods[1].data();
+  batch_starts[0] = 0;
+  for (size_t n = 0; n < max_seqlen; n++) {
+    size_t batch_id = batch_starts[n];
+    for (size_t i = 0; i < seq_info.size(); ++i) {
+      size_t seq_len = seq_info[i].length;
+      size_t start = seq_info[i].start;
+      if (n < seq_len) {
+        seq2batch_idx[batch_id] =
+            is_reverse ? start + seq_len - 1 - n : start + n;
+        batch_id++;
+      } else {
+        break;
+      }
+    }
+    batch_starts[n + 1] = batch_id;
+  }
+  size_t* seq_order = batch_lods[2].data();
+  for (size_t i = 0; i < seq_info.size(); ++i) {
+    seq_order[i] = seq_info[i].seq_idx;
+  }
+  return batch_lods;
+}
+
+// The batch LoD of the other direction, whose batch starts and sort order are
+// shared with batch_lods, only the raw index is computed again.
+framework::LoD ReverseSequence2BatchLoD(const framework::Vector<size_t>& lod,
+                                        const framework::LoD& batch_lods,
+                                        bool is_reverse) {
+  framework::LoD reversed_lods = batch_lods;
+  const auto& batch_starts = batch_lods[0];
+  const auto& seq_order = batch_lods[2];
+  std::vector<size_t> seq2batch_idx(batch_lods[1].size());
+  for (size_t n = 0; n + 1 < batch_starts.size(); ++n) {
+    for (size_t batch_id = batch_starts[n]; batch_id < batch_starts[n + 1];
+         ++batch_id) {
+      size_t seq_idx = seq_order[batch_id - batch_starts[n]];
+      size_t start = lod[seq_idx];
+      size_t seq_len = lod[seq_idx + 1] - start;
+      seq2batch_idx[batch_id] =
+          is_reverse ? start + seq_len - 1 - n : start + n;
+    }
+  }
+  reversed_lods[1] = framework::Vector<size_t>(seq2batch_idx);
+  return reversed_lods;
+}
+
+// Both directions of a LoD, the bidirectional RNNs use both of them.
+struct Sequence2BatchCacheEntry {
+  std::vector<size_t> lod;
+  size_t rows;
+  framework::LoD batch_lods[2];
+};
+
+// A few batches are enough for the forward and backward RNNs of a batch.
+constexpr size_t kSequence2BatchCacheSize = 4;
+
+}  // namespace
+
+framework::LoD GetSequence2BatchLoD(const framework::Vector<size_t>& lod,
+                                    size_t rows, bool is_reverse) {
+  // The most recently used entry is at the front.
+  thread_local std::list<Sequence2BatchCacheEntry> cache;
+  auto it = cache.begin();
+  for (; it != cache.end(); ++it) {
+    if (it->rows == rows && it->lod.size() == lod.size() &&
+        std::equal(it->lod.begin(), it->lod.end(), lod.begin())) {
+      break;
+    }
+  }
+  if (it != cache.end()) {
+    cache.splice(cache.begin(), cache, it);
+  } else {
+    Sequence2BatchCacheEntry entry;
+    entry.lod.assign(lod.begin(), lod.end());
+    entry.rows = rows;
+    cache.emplace_front(std::move(entry));
+    if (cache.size() > kSequence2BatchCacheSize) {
+      cache.pop_back();
+    }
+  }
+
+  auto& entry = cache.front();
+  auto& batch_lods = entry.batch_lods[is_reverse];
+  if (batch_lods.empty()) {
+    const auto& other = entry.batch_lods[!is_reverse];
+    batch_lods = other.empty()
+                     ? ComputeSequence2BatchLoD(lod, rows, is_reverse)
+                     : ReverseSequence2BatchLoD(lod, other, is_reverse);
+  }
+  return batch_lods;
+}
+
 template <typename T>
 class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
  public:
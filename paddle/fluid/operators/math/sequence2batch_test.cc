@@ -0,0 +1,56 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sequence2batch.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(Sequence2Batch, batch_lod) {
+  // s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+  paddle::framework::Vector<size_t> lod({0, 4, 9, 12});
+  auto batch_lods =
+      paddle::operators::math::GetSequence2BatchLoD(lod, 12, false);
+  ASSERT_EQ(batch_lods.size(), 3UL);
+  EXPECT_EQ(std::vector<size_t>(batch_lods[0]),
+            std::vector<size_t>({0, 3, 6, 9, 11, 12}));
+  EXPECT_EQ(std::vector<size_t>(batch_lods[1]),
+            std::vector<size_t>({4, 0, 9, 5, 1, 10, 6, 2, 11, 7, 3, 8}));
+  EXPECT_EQ(std::vector<size_t>(batch_lods[2]),
+            std::vector<size_t>({1, 0, 2}));
+
+  auto reversed = paddle::operators::math::GetSequence2BatchLoD(lod, 12, true);
+  EXPECT_EQ(std::vector<size_t>(reversed[1]),
+            std::vector<size_t>({8, 3, 11, 7, 2, 10, 6, 1, 9, 5, 0, 4}));
+
+  // the cached results are the same as the computed ones
+  auto cached = paddle::operators::math::GetSequence2BatchLoD(lod, 12, false);
+  EXPECT_EQ(cached, batch_lods);
+  paddle::framework::Vector<size_t> other({0, 2, 5});
+  auto other_lods =
+      paddle::operators::math::GetSequence2BatchLoD(other, 5, false);
+  EXPECT_EQ(std::vector<size_t>(other_lods[1]),
+            std::vector<size_t>({2, 0, 3, 1, 4}));
+
+  // the two directions share the batch starts and the sequence order
+  const auto& starts = batch_lods[0];
+  const auto& reversed_starts = reversed[0];
+  EXPECT_EQ(reversed_starts.data(), starts.data());
+  EXPECT_EQ(std::vector<size_t>(reversed[2]), std::vector<size_t>({1, 0, 2}));
+  auto other_reversed =
+      paddle::operators::math::GetSequence2BatchLoD(other, 5, true);
+  EXPECT_EQ(std::vector<size_t>(other_reversed[0]),
+            std::vector<size_t>({0, 2, 4, 5}));
+  EXPECT_EQ(std::vector<size_t>(other_reversed[1]),
+            std::vector<size_t>({4, 1, 3, 0, 2}));
+}
@@ -0,0 +1,198 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd_conv.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+namespace {
+
+// The number of the elements of a transformed tile.
+constexpr int kTileElems = 16;
+
+}  // namespace
+
+bool CanUseWinogradConv3x3(const std::vector<int64_t>& filter_shape,
+                           const std::vector<int>& strides,
+                           const std::vector<int>& dilations, int groups) {
+  return filter_shape.size() == 4U && filter_shape[2] == 3 &&
+         filter_shape[3] == 3 && strides.size() == 2U && strides[0] == 1 &&
+         strides[1] == 1 && dilations.size() == 2U && dilations[0] == 1 &&
+         dilations[1] == 1 && groups == 1;
+}
+
+/*
+ * U = G * g * G^T, where
+ * G = [[1, 0, 0], [1/2, 1/2, 1/2], [1/2, -1/2, 1/2], [0, 0, 1]]
+ */
+template <typename T>
+void WinogradConv3x3Functor<platform::CPUDeviceContext, T>::TransformFilter(
+    const platform::CPUDeviceContext& context, const framework::Tensor& filter,
+    framework::Tensor* transformed_filter) {
+  PADDLE_ENFORCE_EQ(filter.dims().size(), 4,
+                    platform::errors::InvalidArgument(
+                        "The filter of the Winograd conv should be 4-D, but "
+                        "received %d-D.",
+                        filter.dims().size()));
+  const int out_channels = filter.dims()[0];
+  const int in_channels = filter.dims()[1];
+  const int filter_stride = out_channels * in_channels;
+  const T* g_data = filter.data<T>();
+  T* u_data = transformed_filter->mutable_data<T>(
+      {kTileElems, out_channels, in_channels}, context.GetPlace());
+  const T half = static_cast<T>(0.5);
+  for (int kc = 0; kc < filter_stride; ++kc) {
+    const T* g = g_data + kc * 9;
+    T tmp[4][3];
+    for (int j = 0; j < 3; ++j) {
+      tmp[0][j] = g[j];
+      tmp[1][j] = half * (g[j] + g[3 + j] + g[6 + j]);
+      tmp[2][j] = half * (g[j] - g[3 + j] + g[6 + j]);
+      tmp[3][j] = g[6 + j];
+    }
+    T* u = u_data + kc;
+    for (int i = 0; i < 4; ++i) {
+      u[(i * 4 + 0) * filter_stride] = tmp[i][0];
+      u[(i * 4 + 1) * filter_stride] =
+          half * (tmp[i][0] + tmp[i][1] + tmp[i][2]);
+      u[(i * 4 + 2) * filter_stride] =
+          half * (tmp[i][0] - tmp[i][1] + tmp[i][2]);
+      u[(i * 4 + 3) * filter_stride] = tmp[i][2];
+    }
+  }
+}
+
+/*
+ * V = B^T * d * B and Y = A^T * (U @ V) * A, where
+ * B^T = [[1, 0, -1, 0], [0, 1, 1, 0], [0, -1, 1, 0], [0, 1, 0, -1]]
+ * A^T = [[1, 1, 1, 0], [0, 1, -1, -1]]
+ */
+template <typename T>
+void WinogradConv3x3Functor<platform::CPUDeviceContext, T>::operator()(
+    const platform::CPUDeviceContext& context, const framework::Tensor& input,
+    const framework::Tensor& transformed_filter,
+    const std::vector<int>& paddings, framework::Tensor* output) {
+  const int in_channels = input.dims()[0];
+  const int in_height = input.dims()[1];
+  const int in_width = input.dims()[2];
+  const int out_channels = output->dims()[0];
+  const int out_height = output->dims()[1];
+  const int out_width = output->dims()[2];
+  PADDLE_ENFORCE_EQ(
+      transformed_filter.dims()[2], in_channels,
+      platform::errors::InvalidArgument(
+          "The input channels of the transformed filter (%d) and the input "
+          "(%d) should be the same.",
+          transformed_filter.dims()[2], in_channels));
+  const int pad_up = paddings[0];
+  const int pad_left = paddings[1];
+  const int tiles_h = (out_height + 1) / 2;
+  const int tiles_w = (out_width + 1) / 2;
+  const int tiles = tiles_h * tiles_w;
+
+  framework::Tensor v_tensor, m_tensor;
+  T* v_data = v_tensor.mutable_data<T>({kTileElems, in_channels, tiles},
+                                       platform::CPUPlace());
+  T* m_data = m_tensor.mutable_data<T>({kTileElems, out_channels, tiles},
+                                       platform::CPUPlace());
+  const T* in_data = input.data<T>();
+  const int v_stride = in_channels * tiles;
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int c = 0; c < in_channels; ++c) {
+    const T* im = in_data + c * in_height * in_width;
+    for (int th = 0; th < tiles_h; ++th) {
+      for (int tw = 0; tw < tiles_w; ++tw) {
+        T d[4][4];
+        int h0 = th * 2 - pad_up;
+        int w0 = tw * 2 - pad_left;
+        for (int i = 0; i < 4; ++i) {
+          int h = h0 + i;
+          for (int j = 0; j < 4; ++j) {
+            int w = w0 + j;
+            d[i][j] = (h >= 0 && h < in_height && w >= 0 && w < in_width)
+                          ? im[h * in_width + w]
+                          : static_cast<T>(0);
+          }
+        }
+        T tmp[4][4];
+        for (int j = 0; j < 4; ++j) {
+          tmp[0][j] = d[0][j] - d[2][j];
+          tmp[1][j] = d[1][j] + d[2][j];
+          tmp[2][j] = d[2][j] - d[1][j];
+          tmp[3][j] = d[1][j] - d[3][j];
+        }
+        T* v = v_data + c * tiles + th * tiles_w + tw;
+        for (int i = 0; i < 4; ++i) {
+          v[(i * 4 + 0) * v_stride] = tmp[i][0] - tmp[i][2];
+          v[(i * 4 + 1) * v_stride] = tmp[i][1] + tmp[i][2];
+          v[(i * 4 + 2) * v_stride] = tmp[i][2] - tmp[i][1];
+          v[(i * 4 + 3) * v_stride] = tmp[i][1] - tmp[i][3];
+        }
+      }
+    }
+  }
+
+  // M[e] = U[e] * V[e], [out_channels, in_channels] * [in_channels, tiles]
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  blas.BatchedGEMM(CblasNoTrans, CblasNoTrans, out_channels, tiles,
+                   in_channels, static_cast<T>(1), transformed_filter.data<T>(),
+                   v_data, static_cast<T>(0), m_data, kTileElems,
+                   static_cast<int64_t>(out_channels) * in_channels,
+                   static_cast<int64_t>(in_channels) * tiles);
+
+  T* out_data = output->data<T>();
+  const int m_stride = out_channels * tiles;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int k = 0; k < out_channels; ++k) {
+    T* out = out_data + k * out_height * out_width;
+    for (int th = 0; th < tiles_h; ++th) {
+      for (int tw = 0; tw < tiles_w; ++tw) {
+        const T* m = m_data + k * tiles + th * tiles_w + tw;
+        T tmp[2][4];
+        for (int j = 0; j < 4; ++j) {
+          T m0 = m[j * m_stride];
+          T m1 = m[(4 + j) * m_stride];
+          T m2 = m[(8 + j) * m_stride];
+          T m3 = m[(12 + j) * m_stride];
+          tmp[0][j] = m0 + m1 + m2;
+          tmp[1][j] = m1 - m2 - m3;
+        }
+        for (int i = 0; i < 2; ++i) {
+          int h = th * 2 + i;
+          if (h >= out_height) break;
+          T y0 = tmp[i][0] + tmp[i][1] + tmp[i][2];
+          T y1 = tmp[i][1] - tmp[i][2] - tmp[i][3];
+          int w = tw * 2;
+          out[h * out_width + w] = y0;
+          if (w + 1 < out_width) out[h * out_width + w + 1] = y1;
+        }
+      }
+    }
+  }
+}
+
+template class WinogradConv3x3Functor<platform::CPUDeviceContext, float>;
+template class WinogradConv3x3Functor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,79 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Whether the conv can run by Winograd F(2x2, 3x3), i.e., a 2D conv of the
+// 3x3 filters with stride 1, dilation 1 and one group.
+bool CanUseWinogradConv3x3(const std::vector<int64_t>& filter_shape,
+                           const std::vector<int>& strides,
+                           const std::vector<int>& dilations, int groups);
+
+/*
+ * The conv by Winograd F(2x2, 3x3), which computes each 2x2 tile of the
+ * output from a 4x4 tile of the input with 16 multiplications instead of 36,
+ * as 16 GEMMs of the transformed filters and input tiles. It also needs much
+ * less memory than im2col, 16 / 4 instead of 9 floats per input channel and
+ * output element.
+ *
+ * The filter [output_channels, input_channels, 3, 3] is transformed once to
+ * [16, output_channels, input_channels]. Each call computes one image, the
+ * input is [input_channels, input_height, input_width] and the output is
+ * [output_channels, output_height, output_width], where the paddings are
+ * {up_pad, left_pad}, the down and right paddings follow from the output
+ * size.
+ */
+template <typename DeviceContext, typename T>
+class WinogradConv3x3Functor {
+ public:
+  void TransformFilter(const DeviceContext& context,
+                       const framework::Tensor& filter,
+                       framework::Tensor* transformed_filter) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The Winograd conv is only implemented on the CPU."));
+  }
+
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& transformed_filter,
+                  const std::vector<int>& paddings, framework::Tensor* output) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The Winograd conv is only implemented on the CPU."));
+  }
+};
+
+template <typename T>
+class WinogradConv3x3Functor<platform::CPUDeviceContext, T> {
+ public:
+  void TransformFilter(const platform::CPUDeviceContext& context,
+                       const framework::Tensor& filter,
+                       framework::Tensor* transformed_filter);
+
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& transformed_filter,
+                  const std::vector<int>& paddings, framework::Tensor* output);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
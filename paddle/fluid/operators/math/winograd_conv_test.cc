@@ -0,0 +1,84 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd_conv.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+template <typename T>
+void TestWinogradConv3x3(int in_channels, int out_channels, int in_height,
+                         int in_width, int pad_up, int pad_down, int pad_left,
+                         int pad_right) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  int out_height = in_height + pad_up + pad_down - 2;
+  int out_width = in_width + pad_left + pad_right - 2;
+
+  paddle::framework::Tensor input, filter, transformed_filter, output;
+  T* in_data =
+      input.mutable_data<T>({in_channels, in_height, in_width}, place);
+  T* filter_data =
+      filter.mutable_data<T>({out_channels, in_channels, 3, 3}, place);
+  T* out_data =
+      output.mutable_data<T>({out_channels, out_height, out_width}, place);
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<T> dist(-1, 1);
+  for (int i = 0; i < input.numel(); ++i) in_data[i] = dist(rng);
+  for (int i = 0; i < filter.numel(); ++i) filter_data[i] = dist(rng);
+
+  paddle::operators::math::WinogradConv3x3Functor<
+      paddle::platform::CPUDeviceContext, T>
+      conv;
+  conv.TransformFilter(context, filter, &transformed_filter);
+  conv(context, input, transformed_filter, {pad_up, pad_left}, &output);
+
+  for (int k = 0; k < out_channels; ++k) {
+    for (int h = 0; h < out_height; ++h) {
+      for (int w = 0; w < out_width; ++w) {
+        T ref = 0;
+        for (int c = 0; c < in_channels; ++c) {
+          for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+              int ih = h + i - pad_up;
+              int iw = w + j - pad_left;
+              if (ih < 0 || ih >= in_height || iw < 0 || iw >= in_width) {
+                continue;
+              }
+              ref += in_data[(c * in_height + ih) * in_width + iw] *
+                     filter_data[((k * in_channels + c) * 3 + i) * 3 + j];
+            }
+          }
+        }
+        EXPECT_NEAR(out_data[(k * out_height + h) * out_width + w], ref,
+                    1e-4);
+      }
+    }
+  }
+}
+
+TEST(math, winograd_conv3x3) {
+  EXPECT_TRUE(paddle::operators::math::CanUseWinogradConv3x3(
+      {8, 4, 3, 3}, {1, 1}, {1, 1}, 1));
+  EXPECT_FALSE(paddle::operators::math::CanUseWinogradConv3x3(
+      {8, 4, 3, 3}, {2, 2}, {1, 1}, 1));
+  EXPECT_FALSE(paddle::operators::math::CanUseWinogradConv3x3(
+      {8, 4, 1, 1}, {1, 1}, {1, 1}, 1));
+
+  TestWinogradConv3x3<float>(3, 5, 8, 8, 1, 1, 1, 1);
+  // the odd output sizes
+  TestWinogradConv3x3<float>(4, 2, 7, 9, 0, 0, 0, 0);
+  // the asymmetric paddings
+  TestWinogradConv3x3<double>(2, 3, 6, 5, 1, 0, 0, 1);
+}
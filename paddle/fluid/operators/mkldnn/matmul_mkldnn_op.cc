@@ -338,13 +338,16 @@ static std::shared_ptr<MatMulFactory<XT, YT, OT>> GetPrimitiveFactory(
 }
 
 // Choose appropriate primitive factory implementation based on inferred
-// output type (uint8, int8 or float).
+// output type (uint8, int8, bfloat16 or float).
 template <typename XT, typename YT>
 static void ExecuteMatMul(const ExecutionContext& ctx) {
   constexpr bool is_int8 = IsInt8<XT>();
+  constexpr bool is_bfloat16 = std::is_same<XT, platform::bfloat16>::value;
   const bool force_fp32_output = ctx.Attr<bool>("force_fp32_output");
   constexpr bool fuse_relu = false;  // TODO(intel): Enable eltwise fuses
-  if (!is_int8 || force_fp32_output) {
+  if (is_bfloat16 && !force_fp32_output) {
+    GetPrimitiveFactory<XT, YT, platform::bfloat16>(ctx)->CreateAndExecute(ctx);
+  } else if (!is_int8 || force_fp32_output) {
     GetPrimitiveFactory<XT, YT, float>(ctx)->CreateAndExecute(ctx);
   } else if (fuse_relu) {
     GetPrimitiveFactory<XT, YT, uint8_t>(ctx)->CreateAndExecute(ctx);
@@ -371,4 +374,5 @@ namespace ops = paddle::operators;
 
 REGISTER_OP_KERNEL(matmul, MKLDNN, ::paddle::platform::CPUPlace,
                    ops::DNNLMatMulKernel<float>, ops::DNNLMatMulKernel<int8_t>,
-                   ops::DNNLMatMulKernel<uint8_t>);
+                   ops::DNNLMatMulKernel<uint8_t>,
+                   ops::DNNLMatMulKernel<paddle::platform::bfloat16>);
@@ -149,6 +149,18 @@ class LambOpMaker : public framework::OpProtoAndCheckerMaker {
                    "(float, default 1.0e-6) "
                    "Constant for numerical stability.")
         .SetDefault(1.0e-6f);
+    AddAttr<std::vector<int64_t>>(
+        "fused_param_numels",
+        "(vector<int64_t>, default empty) The numbers of elements of the "
+        "parameters fused into Param by coalesce_tensor. If it is not empty, "
+        "the trust ratio is computed for each of the parameters.")
+        .SetDefault({});
+    AddAttr<std::vector<float>>(
+        "fused_weight_decays",
+        "(vector<float>, default empty) The weight decay rates of the fused "
+        "parameters, used instead of weight_decay if fused_param_numels is "
+        "not empty.")
+        .SetDefault({});
 
     AddComment(R"DOC(
 LAMB (Layer-wise Adaptive Moments optimizer for Batching training) Optimizer.
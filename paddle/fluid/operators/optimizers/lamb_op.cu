@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/optimizers/lamb_op.h"
+#include "paddle/fluid/operators/optimizers/segmented_norm.cu.h"
 
 namespace ops = paddle::operators;
 REGISTER_OP_CUDA_KERNEL(
@@ -17,8 +17,10 @@ limitations under the License. */
 #include <Eigen/Dense>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/operators/math/algorithm.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/operators/optimizers/segmented_norm.h"
 #include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
@@ -172,6 +174,96 @@ struct LambParamUpateFunctor {
   }
 };
 
+template <typename T>
+struct LambFusedMomentUpdateFunctor {
+  T beta1_;
+  T beta2_;
+  T epsilon_;
+  const T* weight_decays_;
+  const int64_t* starts_;
+  int64_t num_segments_;
+
+  const T* moment1_;
+  T* moment1_out_;
+  const T* moment2_;
+  T* moment2_out_;
+  const T* grad_;
+  const T* param_;
+  T* trust_ratio_div_;
+
+  LambFusedMomentUpdateFunctor(T beta1, T beta2, T epsilon,
+                               const T* weight_decays, const int64_t* starts,
+                               int64_t num_segments, const T* mom1,
+                               T* mom1_out, const T* mom2, T* mom2_out,
+                               const T* grad, const T* param,
+                               T* trust_ratio_div)
+      : beta1_(beta1),
+        beta2_(beta2),
+        epsilon_(epsilon),
+        weight_decays_(weight_decays),
+        starts_(starts),
+        num_segments_(num_segments),
+        moment1_(mom1),
+        moment1_out_(mom1_out),
+        moment2_(mom2),
+        moment2_out_(mom2_out),
+        grad_(grad),
+        param_(param),
+        trust_ratio_div_(trust_ratio_div) {}
+
+  inline HOSTDEVICE void operator()(size_t i) const {
+    T weight_decay = weight_decays_[FindSegment(starts_, num_segments_, i)];
+    T g = grad_[i];
+    T mom1 = moment1_[i];
+    T mom2 = moment2_[i];
+    T p = param_[i];
+
+    mom1 = beta1_ * mom1 + (1 - beta1_) * g;
+    mom2 = beta2_ * mom2 + (1 - beta2_) * g * g;
+
+    moment1_out_[i] = mom1;
+    moment2_out_[i] = mom2;
+    trust_ratio_div_[i] = mom1 / (sqrt(mom2) + epsilon_) + weight_decay * p;
+  }
+};
+
+template <typename T>
+struct LambFusedParamUpdateFunctor {
+  const T* lr_;
+  const T* param_;
+  const T* param_norms_;
+  const T* trust_ratio_div_;
+  const T* trust_ratio_div_norms_;
+  const int64_t* starts_;
+  int64_t num_segments_;
+  T* param_out_;
+
+  LambFusedParamUpdateFunctor(const T* lr, const T* param,
+                              const T* param_norms, const T* trust_ratio_div,
+                              const T* trust_ratio_div_norms,
+                              const int64_t* starts, int64_t num_segments,
+                              T* param_out)
+      : lr_(lr),
+        param_(param),
+        param_norms_(param_norms),
+        trust_ratio_div_(trust_ratio_div),
+        trust_ratio_div_norms_(trust_ratio_div_norms),
+        starts_(starts),
+        num_segments_(num_segments),
+        param_out_(param_out) {}
+
+  inline HOSTDEVICE void operator()(size_t i) const {
+    int64_t segment = FindSegment(starts_, num_segments_, i);
+    T lr = *lr_;
+    T p = param_norms_[segment];
+    T t = trust_ratio_div_norms_[segment];
+
+    T r = (p > 0 && t > 0) ? p / t : 1.0;
+    lr *= r;
+    param_out_[i] = param_[i] - lr * trust_ratio_div_[i];
+  }
+};
+
 template <typename DeviceContext, typename T>
 class LambOpKernel : public framework::OpKernel<T> {
  public:
@@ -217,6 +309,71 @@ class LambOpKernel : public framework::OpKernel<T> {
     framework::Tensor trust_ratio_div =
         ctx.AllocateTmpTensor<T, DeviceContext>(param.dims(), dev_ctx);
 
+    auto fused_numels = ctx.Attr<std::vector<int64_t>>("fused_param_numels");
+    if (!fused_numels.empty()) {
+      PADDLE_ENFORCE_EQ(grad_var->IsType<framework::LoDTensor>(), true,
+                        platform::errors::InvalidArgument(
+                            "The gradient of the fused lamb op should be "
+                            "LoDTensor, but received %s.",
+                            framework::ToTypeName(grad_var->Type())));
+      auto fused_weight_decays =
+          ctx.Attr<std::vector<float>>("fused_weight_decays");
+      PADDLE_ENFORCE_EQ(fused_weight_decays.size(), fused_numels.size(),
+                        platform::errors::InvalidArgument(
+                            "The numbers of fused_weight_decays (%d) and "
+                            "fused_param_numels (%d) should be the same.",
+                            fused_weight_decays.size(), fused_numels.size()));
+      // The offsets of the parameters in the fused buffer, as coalesce_tensor
+      // aligns them.
+      int64_t num_segments = static_cast<int64_t>(fused_numels.size());
+      std::vector<int64_t> starts =
+          FusedSegmentStarts<T>(fused_numels, ctx.GetPlace());
+      PADDLE_ENFORCE_LE(starts.back(), param.numel(),
+                        platform::errors::InvalidArgument(
+                            "The fused parameters need %d elements, but the "
+                            "fused Param only has %d.",
+                            starts.back(), param.numel()));
+      std::vector<T> weight_decays(fused_weight_decays.begin(),
+                                   fused_weight_decays.end());
+      framework::Tensor starts_t, numels_t, weight_decays_t;
+      framework::TensorFromVector(starts, dev_ctx, &starts_t);
+      framework::TensorFromVector(fused_numels, dev_ctx, &numels_t);
+      framework::TensorFromVector(weight_decays, dev_ctx, &weight_decays_t);
+
+      auto& grad = *ctx.Input<LoDTensor>("Grad");
+      LambFusedMomentUpdateFunctor<T> moment_update_functor(
+          beta1, beta2, epsilon, weight_decays_t.template data<T>(),
+          starts_t.template data<int64_t>(), num_segments,
+          mom1.template data<T>(),
+          mom1_out.template mutable_data<T>(ctx.GetPlace()),
+          mom2.template data<T>(),
+          mom2_out.template mutable_data<T>(ctx.GetPlace()),
+          grad.template data<T>(), param.template data<T>(),
+          trust_ratio_div.template data<T>());
+      for_range(moment_update_functor);
+
+      // The norms of all the parameters are computed in one pass.
+      framework::Tensor p_norms_t =
+          ctx.AllocateTmpTensor<T, DeviceContext>({num_segments}, dev_ctx);
+      framework::Tensor trust_ratio_div_norms_t =
+          ctx.AllocateTmpTensor<T, DeviceContext>({num_segments}, dev_ctx);
+      SegmentedNormFunctor<DeviceContext, T>()(
+          dev_ctx, param.template data<T>(),
+          trust_ratio_div.template data<T>(),
+          starts_t.template data<int64_t>(), numels_t.template data<int64_t>(),
+          num_segments, p_norms_t.template data<T>(),
+          trust_ratio_div_norms_t.template data<T>());
+
+      LambFusedParamUpdateFunctor<T> param_update_functor(
+          lr.template data<T>(), param.template data<T>(),
+          p_norms_t.template data<T>(), trust_ratio_div.template data<T>(),
+          trust_ratio_div_norms_t.template data<T>(),
+          starts_t.template data<int64_t>(), num_segments,
+          param_out.template mutable_data<T>(ctx.GetPlace()));
+      for_range(param_update_functor);
+      return;
+    }
+
     // Update moments
     if (grad_var->IsType<framework::LoDTensor>()) {
       auto& grad = *ctx.Input<LoDTensor>("Grad");
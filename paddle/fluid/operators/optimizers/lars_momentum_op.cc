@@ -48,6 +48,12 @@ class LarsMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<float>("lars_weight_decay",
                    "(float, default 0.0005) LARS weight decay")
         .SetDefault(0.0005);
+    AddAttr<std::vector<int64_t>>(
+        "fused_param_numels",
+        "(vector<int64_t>, default empty) The numbers of elements of the "
+        "parameters fused into Param by coalesce_tensor. If it is not empty, "
+        "the local learning rate is computed for each of the parameters.")
+        .SetDefault({});
 
     AddComment(R"DOC(
 Lars Momentum Optimizer.
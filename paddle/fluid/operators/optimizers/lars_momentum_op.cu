@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/optimizers/lars_momentum_op.h"
+#include "paddle/fluid/operators/optimizers/segmented_norm.cu.h"
 
 namespace paddle {
 namespace operators {
@@ -42,6 +43,11 @@ template <typename DeviceContext, typename T>
 class LarsMomentumOpCUDAKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
+    if (!ctx.Attr<std::vector<int64_t>>("fused_param_numels").empty()) {
+      LarsFusedMomentum<DeviceContext, T>(ctx);
+      return;
+    }
+
     auto param_out = ctx.Output<framework::LoDTensor>("ParamOut");
     auto velocity_out = ctx.Output<framework::LoDTensor>("VelocityOut");
     auto param = ctx.Input<framework::LoDTensor>("Param");
@@ -13,12 +13,118 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/optimizers/segmented_norm.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
 
+// The lars momentum update of the parameters fused by coalesce_tensor, each
+// of them has its own local learning rate.
+template <typename T>
+struct LarsFusedMomentumFunctor {
+  const T* param_;
+  const T* grad_;
+  const T* velocity_;
+  const T* lr_;
+  T mu_;
+  T lars_coeff_;
+  T lars_weight_decay_;
+  const T* param_norms_;
+  const T* grad_norms_;
+  const int64_t* starts_;
+  int64_t num_segments_;
+  T* param_out_;
+  T* velocity_out_;
+
+  LarsFusedMomentumFunctor(const T* param, const T* grad, const T* velocity,
+                           const T* lr, T mu, T lars_coeff,
+                           T lars_weight_decay, const T* param_norms,
+                           const T* grad_norms, const int64_t* starts,
+                           int64_t num_segments, T* param_out,
+                           T* velocity_out)
+      : param_(param),
+        grad_(grad),
+        velocity_(velocity),
+        lr_(lr),
+        mu_(mu),
+        lars_coeff_(lars_coeff),
+        lars_weight_decay_(lars_weight_decay),
+        param_norms_(param_norms),
+        grad_norms_(grad_norms),
+        starts_(starts),
+        num_segments_(num_segments),
+        param_out_(param_out),
+        velocity_out_(velocity_out) {}
+
+  inline HOSTDEVICE void operator()(size_t i) const {
+    int64_t segment = FindSegment(starts_, num_segments_, i);
+    T p_norm = param_norms_[segment];
+    T g_norm = grad_norms_[segment];
+    T local_lr = *lr_;
+    if (p_norm > 0 && g_norm > 0) {
+      local_lr = local_lr * lars_coeff_ * p_norm /
+                 (g_norm + lars_weight_decay_ * p_norm);
+    }
+    T v_new = velocity_[i] * mu_ +
+              local_lr * (grad_[i] + lars_weight_decay_ * param_[i]);
+    velocity_out_[i] = v_new;
+    param_out_[i] = param_[i] - v_new;
+  }
+};
+
+// The norms of all the fused parameters and gradients are computed in one
+// pass, then all the parameters are updated in another one.
+template <typename DeviceContext, typename T>
+void LarsFusedMomentum(const framework::ExecutionContext& ctx) {
+  auto param_out = ctx.Output<framework::LoDTensor>("ParamOut");
+  auto velocity_out = ctx.Output<framework::LoDTensor>("VelocityOut");
+  auto param = ctx.Input<framework::LoDTensor>("Param");
+  auto velocity = ctx.Input<framework::LoDTensor>("Velocity");
+  auto grad = ctx.Input<framework::LoDTensor>("Grad");
+  auto learning_rate = ctx.Input<framework::LoDTensor>("LearningRate");
+
+  T mu = static_cast<T>(ctx.Attr<float>("mu"));
+  T lars_coeff = ctx.Attr<float>("lars_coeff");
+  T lars_weight_decay = ctx.Attr<float>("lars_weight_decay");
+  auto fused_numels = ctx.Attr<std::vector<int64_t>>("fused_param_numels");
+
+  int64_t num_segments = static_cast<int64_t>(fused_numels.size());
+  std::vector<int64_t> starts =
+      FusedSegmentStarts<T>(fused_numels, ctx.GetPlace());
+  PADDLE_ENFORCE_LE(starts.back(), param->numel(),
+                    platform::errors::InvalidArgument(
+                        "The fused parameters need %d elements, but the "
+                        "fused Param only has %d.",
+                        starts.back(), param->numel()));
+
+  auto& dev_ctx = ctx.template device_context<DeviceContext>();
+  framework::Tensor starts_t, numels_t;
+  framework::TensorFromVector(starts, dev_ctx, &starts_t);
+  framework::TensorFromVector(fused_numels, dev_ctx, &numels_t);
+  framework::Tensor p_norms_t =
+      ctx.AllocateTmpTensor<T, DeviceContext>({num_segments}, dev_ctx);
+  framework::Tensor g_norms_t =
+      ctx.AllocateTmpTensor<T, DeviceContext>({num_segments}, dev_ctx);
+  SegmentedNormFunctor<DeviceContext, T>()(
+      dev_ctx, param->data<T>(), grad->data<T>(), starts_t.data<int64_t>(),
+      numels_t.data<int64_t>(), num_segments, p_norms_t.data<T>(),
+      g_norms_t.data<T>());
+
+  LarsFusedMomentumFunctor<T> functor(
+      param->data<T>(), grad->data<T>(), velocity->data<T>(),
+      learning_rate->data<T>(), mu, lars_coeff, lars_weight_decay,
+      p_norms_t.data<T>(), g_norms_t.data<T>(), starts_t.data<int64_t>(),
+      num_segments, param_out->mutable_data<T>(ctx.GetPlace()),
+      velocity_out->mutable_data<T>(ctx.GetPlace()));
+  platform::ForRange<DeviceContext> for_range(dev_ctx, param->numel());
+  for_range(functor);
+}
+
 template <typename T>
 class LarsMomentumOpKernel : public framework::OpKernel<T> {
  public:
@@ -31,6 +137,10 @@ class LarsMomentumOpKernel : public framework::OpKernel<T> {
     auto* grad_var = ctx.InputVar("Grad");
     // only support dense for now.
     PADDLE_ENFORCE_EQ(grad_var->IsType<framework::LoDTensor>(), true);
+    if (!ctx.Attr<std::vector<int64_t>>("fused_param_numels").empty()) {
+      LarsFusedMomentum<platform::CPUDeviceContext, T>(ctx);
+      return;
+    }
     auto grad = ctx.Input<framework::LoDTensor>("Grad");
 
     param_out->mutable_data<T>(ctx.GetPlace());
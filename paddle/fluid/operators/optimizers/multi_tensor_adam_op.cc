@@ -0,0 +1,159 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/multi_tensor_adam_op.h"
+
+namespace paddle {
+namespace operators {
+
+void MultiTensorAdamOp::InferShape(framework::InferShapeContext *ctx) const {
+  OP_INOUT_CHECK(ctx->HasInputs("Param"), "Input", "Param", "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasInputs("Grad"), "Input", "Grad", "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasInputs("Moment1"), "Input", "Moment1",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasInputs("Moment2"), "Input", "Moment2",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasInputs("Beta1Pow"), "Input", "Beta1Pow",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasInputs("Beta2Pow"), "Input", "Beta2Pow",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasInput("LearningRate"), "Input", "LearningRate",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasOutputs("ParamOut"), "Output", "ParamOut",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasOutputs("Moment1Out"), "Output", "Moment1Out",
+                 "MultiTensorAdam");
+  OP_INOUT_CHECK(ctx->HasOutputs("Moment2Out"), "Output", "Moment2Out",
+                 "MultiTensorAdam");
+
+  auto lr_dims = ctx->GetInputDim("LearningRate");
+  PADDLE_ENFORCE_EQ(
+      framework::product(lr_dims), 1,
+      platform::errors::InvalidArgument(
+          "Learning rate should have 1 dimension, but received %d",
+          framework::product(lr_dims)));
+
+  auto param_dims = ctx->GetInputsDim("Param");
+  for (auto &name : {"Grad", "Moment1", "Moment2", "Beta1Pow", "Beta2Pow"}) {
+    PADDLE_ENFORCE_EQ(
+        ctx->Inputs(name).size(), param_dims.size(),
+        platform::errors::InvalidArgument(
+            "The size of Input(%s) should be equal to the size of "
+            "Input(Param) %d, but received %d.",
+            name, param_dims.size(), ctx->Inputs(name).size()));
+  }
+  for (auto &name : {"Grad", "Moment1", "Moment2"}) {
+    auto dims = ctx->GetInputsDim(name);
+    for (size_t i = 0; i < param_dims.size(); ++i) {
+      PADDLE_ENFORCE_EQ(
+          param_dims[i], dims[i],
+          platform::errors::InvalidArgument(
+              "The %d-th Param and %s input of MultiTensorAdamOp should have "
+              "same dimension. But received Param dims: [%s], %s dims: [%s].",
+              i, name, param_dims[i], name, dims[i]));
+    }
+  }
+
+  ctx->SetOutputsDim("ParamOut", param_dims);
+  ctx->SetOutputsDim("Moment1Out", param_dims);
+  ctx->SetOutputsDim("Moment2Out", param_dims);
+  if (ctx->HasOutputs("Beta1PowOut")) {
+    ctx->SetOutputsDim("Beta1PowOut", ctx->GetInputsDim("Beta1Pow"));
+  }
+  if (ctx->HasOutputs("Beta2PowOut")) {
+    ctx->SetOutputsDim("Beta2PowOut", ctx->GetInputsDim("Beta2Pow"));
+  }
+}
+
+framework::OpKernelType MultiTensorAdamOp::GetExpectedKernelType(
+    const framework::ExecutionContext &ctx) const {
+  auto input_data_type = OperatorWithKernel::IndicateVarDataType(ctx, "Param");
+  return framework::OpKernelType(input_data_type, ctx.GetPlace());
+}
+
+framework::OpKernelType MultiTensorAdamOp::GetKernelTypeForVar(
+    const std::string &var_name, const framework::Tensor &tensor,
+    const framework::OpKernelType &expected_kernel_type) const {
+  if (var_name == "Beta1Pow" || var_name == "Beta2Pow") {
+    return expected_kernel_type;
+  } else {
+    return framework::OpKernelType(expected_kernel_type.data_type_,
+                                   tensor.place(), tensor.layout());
+  }
+}
+
+class MultiTensorAdamOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(vector<Tensor>) Input parameters").AsDuplicable();
+    AddInput("Grad", "(vector<Tensor>) Input gradients").AsDuplicable();
+    AddInput("LearningRate", "(Tensor) Learning rate");
+    AddInput("Moment1", "(vector<Tensor>) Input first moments")
+        .AsDuplicable();
+    AddInput("Moment2", "(vector<Tensor>) Input second moments")
+        .AsDuplicable();
+    AddInput("Beta1Pow", "(vector<Tensor>) Input beta1 power accumulators")
+        .AsDuplicable();
+    AddInput("Beta2Pow", "(vector<Tensor>) Input beta2 power accumulators")
+        .AsDuplicable();
+
+    AddOutput("ParamOut", "(vector<Tensor>) Output parameters")
+        .AsDuplicable();
+    AddOutput("Moment1Out", "(vector<Tensor>) Output first moments")
+        .AsDuplicable();
+    AddOutput("Moment2Out", "(vector<Tensor>) Output second moments")
+        .AsDuplicable();
+    AddOutput("Beta1PowOut",
+              "(vector<Tensor>) Output beta1 power accumulators")
+        .AsDuplicable();
+    AddOutput("Beta2PowOut",
+              "(vector<Tensor>) Output beta2 power accumulators")
+        .AsDuplicable();
+
+    AddAttr<float>("beta1",
+                   "(float, default 0.9) "
+                   "Exponential decay rate for the "
+                   "first moment estimates.")
+        .SetDefault(0.9f);
+    AddAttr<float>("beta2",
+                   "(float, default 0.999) "
+                   "exponential decay rate for the "
+                   "second moment estimates.")
+        .SetDefault(0.999f);
+    AddAttr<float>("epsilon",
+                   "(float, default 1.0e-8) "
+                   "Constant for numerical stability")
+        .SetDefault(1.0e-8f);
+
+    AddComment(R"DOC(
+MultiTensorAdam Optimizer.
+
+The adam update of a list of parameters with dense gradients, which are
+not coalesced into a continuous space. On GPU, the parameters are updated
+by one kernel launch. The update of each parameter is the same as the one
+of the adam operator.
+
+)DOC");
+  }
+};
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(multi_tensor_adam, ops::MultiTensorAdamOp,
+                             ops::MultiTensorAdamOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    multi_tensor_adam,
+    ops::MultiTensorAdamOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::MultiTensorAdamOpKernel<paddle::platform::CPUDeviceContext, double>);
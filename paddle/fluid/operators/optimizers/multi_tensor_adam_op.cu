@@ -0,0 +1,198 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/multi_tensor_adam_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct MultiTensorAdamFunctor {
+  T beta1;
+  T beta2;
+  T epsilon;
+  const T* lr;
+  const T* const* params;
+  const T* const* grads;
+  const T* const* mom1s;
+  const T* const* mom2s;
+  T* const* param_outs;
+  T* const* mom1_outs;
+  T* const* mom2_outs;
+  // The learning rate corrections of the tensors computed on the host, when
+  // the beta pows are on CPU. Otherwise they are computed from beta pows.
+  const T* corrections;
+  const T* const* beta1_pows;
+  const T* const* beta2_pows;
+
+  __device__ __forceinline__ void operator()(int t, int64_t i) const {
+    T correction =
+        corrections != nullptr
+            ? corrections[t]
+            : sqrt(static_cast<T>(1.0) - *beta2_pows[t]) /
+                  (static_cast<T>(1.0) - *beta1_pows[t]);
+    T g = grads[t][i];
+    T mom1 = beta1 * mom1s[t][i] + (static_cast<T>(1.0) - beta1) * g;
+    T mom2 = beta2 * mom2s[t][i] + (static_cast<T>(1.0) - beta2) * g * g;
+    mom1_outs[t][i] = mom1;
+    mom2_outs[t][i] = mom2;
+    param_outs[t][i] =
+        params[t][i] - *lr * correction * (mom1 / (sqrt(mom2) + epsilon));
+  }
+};
+
+template <typename T>
+__global__ void MultiTensorUpdateBetaPow(T beta1, T beta2,
+                                         const T* const* beta1_pows,
+                                         const T* const* beta2_pows,
+                                         T* const* beta1_pow_outs,
+                                         T* const* beta2_pow_outs, int n) {
+  int t = threadIdx.x + blockIdx.x * blockDim.x;
+  if (t < n) {
+    *beta1_pow_outs[t] = beta1 * *beta1_pows[t];
+    *beta2_pow_outs[t] = beta2 * *beta2_pows[t];
+  }
+}
+
+template <typename T>
+class MultiTensorAdamOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using paddle::framework::LoDTensor;
+
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto* lr = ctx.Input<LoDTensor>("LearningRate");
+
+    auto params = ctx.MultiInput<LoDTensor>("Param");
+    auto grads = ctx.MultiInput<LoDTensor>("Grad");
+    auto mom1s = ctx.MultiInput<LoDTensor>("Moment1");
+    auto mom2s = ctx.MultiInput<LoDTensor>("Moment2");
+    auto beta1_pows = ctx.MultiInput<LoDTensor>("Beta1Pow");
+    auto beta2_pows = ctx.MultiInput<LoDTensor>("Beta2Pow");
+
+    auto param_outs = ctx.MultiOutput<LoDTensor>("ParamOut");
+    auto mom1_outs = ctx.MultiOutput<LoDTensor>("Moment1Out");
+    auto mom2_outs = ctx.MultiOutput<LoDTensor>("Moment2Out");
+    auto beta1_pow_outs = ctx.MultiOutput<LoDTensor>("Beta1PowOut");
+    auto beta2_pow_outs = ctx.MultiOutput<LoDTensor>("Beta2PowOut");
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    size_t n = params.size();
+    if (n == 0) return;
+    bool beta_pow_on_cpu = platform::is_cpu_place(beta1_pows[0]->place());
+    for (size_t i = 0; i < n; ++i) {
+      PADDLE_ENFORCE_EQ(
+          platform::is_cpu_place(beta1_pows[i]->place()) &&
+              platform::is_cpu_place(beta2_pows[i]->place()),
+          beta_pow_on_cpu,
+          platform::errors::InvalidArgument(
+              "The beta pows of MultiTensorAdamOp should be all on CPU or "
+              "all on GPU, but the %d-th ones are not on the place of the "
+              "first ones.",
+              i));
+    }
+
+    std::vector<int64_t> numels(n);
+    std::vector<const T*> param_ptrs(n), grad_ptrs(n), mom1_ptrs(n),
+        mom2_ptrs(n), beta1_pow_ptrs(n), beta2_pow_ptrs(n);
+    std::vector<T*> param_out_ptrs(n), mom1_out_ptrs(n), mom2_out_ptrs(n),
+        beta1_pow_out_ptrs(n), beta2_pow_out_ptrs(n);
+    std::vector<T> corrections;
+    for (size_t i = 0; i < n; ++i) {
+      numels[i] = params[i]->numel();
+      param_ptrs[i] = params[i]->data<T>();
+      grad_ptrs[i] = grads[i]->data<T>();
+      mom1_ptrs[i] = mom1s[i]->data<T>();
+      mom2_ptrs[i] = mom2s[i]->data<T>();
+      param_out_ptrs[i] = param_outs[i]->mutable_data<T>(ctx.GetPlace());
+      mom1_out_ptrs[i] = mom1_outs[i]->mutable_data<T>(ctx.GetPlace());
+      mom2_out_ptrs[i] = mom2_outs[i]->mutable_data<T>(ctx.GetPlace());
+      if (beta_pow_on_cpu) {
+        T beta1_pow = beta1_pows[i]->data<T>()[0];
+        T beta2_pow = beta2_pows[i]->data<T>()[0];
+        corrections.emplace_back(sqrt(static_cast<T>(1.0) - beta2_pow) /
+                                 (static_cast<T>(1.0) - beta1_pow));
+        beta1_pow_outs[i]->mutable_data<T>(platform::CPUPlace())[0] =
+            beta1 * beta1_pow;
+        beta2_pow_outs[i]->mutable_data<T>(platform::CPUPlace())[0] =
+            beta2 * beta2_pow;
+      } else {
+        beta1_pow_ptrs[i] = beta1_pows[i]->data<T>();
+        beta2_pow_ptrs[i] = beta2_pows[i]->data<T>();
+        beta1_pow_out_ptrs[i] =
+            beta1_pow_outs[i]->mutable_data<T>(ctx.GetPlace());
+        beta2_pow_out_ptrs[i] =
+            beta2_pow_outs[i]->mutable_data<T>(ctx.GetPlace());
+      }
+    }
+
+    MultiTensorArgs args;
+    size_t params_offset = args.Append(param_ptrs);
+    size_t grads_offset = args.Append(grad_ptrs);
+    size_t mom1s_offset = args.Append(mom1_ptrs);
+    size_t mom2s_offset = args.Append(mom2_ptrs);
+    size_t param_outs_offset = args.Append(param_out_ptrs);
+    size_t mom1_outs_offset = args.Append(mom1_out_ptrs);
+    size_t mom2_outs_offset = args.Append(mom2_out_ptrs);
+    size_t corrections_offset = args.Append(corrections);
+    size_t beta1_pows_offset = args.Append(beta1_pow_ptrs);
+    size_t beta2_pows_offset = args.Append(beta2_pow_ptrs);
+    size_t beta1_pow_outs_offset = args.Append(beta1_pow_out_ptrs);
+    size_t beta2_pow_outs_offset = args.Append(beta2_pow_out_ptrs);
+
+    MultiTensorApply(
+        dev_ctx, numels, &args, [&](const MultiTensorArgs& dev_args) {
+          MultiTensorAdamFunctor<T> functor;
+          functor.beta1 = beta1;
+          functor.beta2 = beta2;
+          functor.epsilon = epsilon;
+          functor.lr = lr->data<T>();
+          functor.params = dev_args.Get<const T*>(params_offset);
+          functor.grads = dev_args.Get<const T*>(grads_offset);
+          functor.mom1s = dev_args.Get<const T*>(mom1s_offset);
+          functor.mom2s = dev_args.Get<const T*>(mom2s_offset);
+          functor.param_outs = dev_args.Get<T*>(param_outs_offset);
+          functor.mom1_outs = dev_args.Get<T*>(mom1_outs_offset);
+          functor.mom2_outs = dev_args.Get<T*>(mom2_outs_offset);
+          functor.corrections =
+              beta_pow_on_cpu ? dev_args.Get<T>(corrections_offset) : nullptr;
+          functor.beta1_pows = dev_args.Get<const T*>(beta1_pows_offset);
+          functor.beta2_pows = dev_args.Get<const T*>(beta2_pows_offset);
+          return functor;
+        });
+
+    // The beta pows on GPU are updated after the parameters read them, the
+    // kernels run in order on the stream.
+    if (!beta_pow_on_cpu) {
+      int threads = 512;
+      int blocks = (n + threads - 1) / threads;
+      MultiTensorUpdateBetaPow<T><<<blocks, threads, 0, dev_ctx.stream()>>>(
+          beta1, beta2, args.Get<const T*>(beta1_pows_offset),
+          args.Get<const T*>(beta2_pows_offset),
+          args.Get<T*>(beta1_pow_outs_offset),
+          args.Get<T*>(beta2_pow_outs_offset), n);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(multi_tensor_adam,
+                        ops::MultiTensorAdamOpCUDAKernel<float>,
+                        ops::MultiTensorAdamOpCUDAKernel<double>);
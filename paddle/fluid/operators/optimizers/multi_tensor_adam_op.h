@@ -0,0 +1,78 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/optimizers/adam_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MultiTensorAdamOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override;
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override;
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string &var_name, const framework::Tensor &tensor,
+      const framework::OpKernelType &expected_kernel_type) const override;
+};
+
+template <typename DeviceContext, typename T>
+class MultiTensorAdamOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    using paddle::framework::LoDTensor;
+
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto *lr = ctx.Input<LoDTensor>("LearningRate");
+
+    auto params = ctx.MultiInput<LoDTensor>("Param");
+    auto grads = ctx.MultiInput<LoDTensor>("Grad");
+    auto mom1s = ctx.MultiInput<LoDTensor>("Moment1");
+    auto mom2s = ctx.MultiInput<LoDTensor>("Moment2");
+    auto beta1_pows = ctx.MultiInput<LoDTensor>("Beta1Pow");
+    auto beta2_pows = ctx.MultiInput<LoDTensor>("Beta2Pow");
+
+    auto param_outs = ctx.MultiOutput<LoDTensor>("ParamOut");
+    auto mom1_outs = ctx.MultiOutput<LoDTensor>("Moment1Out");
+    auto mom2_outs = ctx.MultiOutput<LoDTensor>("Moment2Out");
+    auto beta1_pow_outs = ctx.MultiOutput<LoDTensor>("Beta1PowOut");
+    auto beta2_pow_outs = ctx.MultiOutput<LoDTensor>("Beta2PowOut");
+
+    for (size_t i = 0; i < params.size(); ++i) {
+      AdamFunctor<T, CPUAdam> functor(
+          beta1, beta2, epsilon, beta1_pows[i]->data<T>(),
+          beta2_pows[i]->data<T>(), mom1s[i]->data<T>(),
+          mom1_outs[i]->mutable_data<T>(ctx.GetPlace()), mom2s[i]->data<T>(),
+          mom2_outs[i]->mutable_data<T>(ctx.GetPlace()), lr->data<T>(),
+          grads[i]->data<T>(), params[i]->data<T>(),
+          param_outs[i]->mutable_data<T>(ctx.GetPlace()));
+      functor(params[i]->numel());
+      beta1_pow_outs[i]->mutable_data<T>(ctx.GetPlace())[0] =
+          beta1 * beta1_pows[i]->data<T>()[0];
+      beta2_pow_outs[i]->mutable_data<T>(ctx.GetPlace())[0] =
+          beta2 * beta2_pows[i]->data<T>()[0];
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
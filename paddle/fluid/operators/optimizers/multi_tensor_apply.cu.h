@@ -0,0 +1,121 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+
+// Multi-tensor apply runs an elementwise functor over the elements of a list
+// of tensors with one kernel launch. The elements are cut into chunks which
+// never cross the tensors and every thread block handles one chunk, so the
+// tensors need not be coalesced into a continuous space.
+constexpr int kMultiTensorChunkSize = 4096;
+constexpr int kMultiTensorBlockSize = 512;
+
+// The host arrays read by the functors on the device, e.g. the pointers of
+// the tensors, are packed into one buffer and copied to the device at once.
+class MultiTensorArgs {
+ public:
+  template <typename T>
+  size_t Append(const std::vector<T>& values) {
+    size_t offset = (buf_.size() + kAlignment - 1) / kAlignment * kAlignment;
+    buf_.resize(offset + values.size() * sizeof(T));
+    if (!values.empty()) {
+      std::memcpy(buf_.data() + offset, values.data(),
+                  values.size() * sizeof(T));
+    }
+    return offset;
+  }
+
+  void CopyToDevice(const platform::CUDADeviceContext& dev_ctx) {
+    dev_buf_ = memory::Alloc(dev_ctx, buf_.size());
+    memory::Copy(BOOST_GET_CONST(platform::CUDAPlace, dev_ctx.GetPlace()),
+                 dev_buf_->ptr(), platform::CPUPlace(), buf_.data(),
+                 buf_.size(), dev_ctx.stream());
+  }
+
+  // Only valid after CopyToDevice.
+  template <typename T>
+  T* Get(size_t offset) const {
+    return reinterpret_cast<T*>(static_cast<char*>(dev_buf_->ptr()) + offset);
+  }
+
+ private:
+  static constexpr size_t kAlignment = 8;
+
+  std::vector<char> buf_;
+  memory::AllocationPtr dev_buf_;
+};
+
+// Cut the tensors whose sizes are numels into chunks. The c-th chunk is in the
+// chunk_tensors[c]-th tensor and begins at chunk_starts[c].
+inline void MultiTensorChunks(const std::vector<int64_t>& numels,
+                              int chunk_size, std::vector<int>* chunk_tensors,
+                              std::vector<int64_t>* chunk_starts) {
+  for (size_t t = 0; t < numels.size(); ++t) {
+    for (int64_t start = 0; start < numels[t]; start += chunk_size) {
+      chunk_tensors->emplace_back(static_cast<int>(t));
+      chunk_starts->emplace_back(start);
+    }
+  }
+}
+
+template <typename Functor>
+__global__ void MultiTensorApplyKernel(const int* chunk_tensors,
+                                       const int64_t* chunk_starts,
+                                       const int64_t* numels, int chunk_size,
+                                       Functor functor) {
+  int t = chunk_tensors[blockIdx.x];
+  int64_t end = min(chunk_starts[blockIdx.x] + chunk_size, numels[t]);
+  for (int64_t i = chunk_starts[blockIdx.x] + threadIdx.x; i < end;
+       i += blockDim.x) {
+    functor(t, i);
+  }
+}
+
+// Calls functor(t, i) for every element i of every tensor t, whose sizes are
+// numels, in one launch. args holds the device arrays the functor reads, it
+// is copied to the device with the chunk table and then the functor is made
+// by make_functor(*args).
+template <typename MakeFunctor>
+void MultiTensorApply(const platform::CUDADeviceContext& dev_ctx,
+                      const std::vector<int64_t>& numels, MultiTensorArgs* args,
+                      MakeFunctor make_functor,
+                      int chunk_size = kMultiTensorChunkSize) {
+  std::vector<int> chunk_tensors;
+  std::vector<int64_t> chunk_starts;
+  MultiTensorChunks(numels, chunk_size, &chunk_tensors, &chunk_starts);
+  size_t tensors_offset = args->Append(chunk_tensors);
+  size_t starts_offset = args->Append(chunk_starts);
+  size_t numels_offset = args->Append(numels);
+  args->CopyToDevice(dev_ctx);
+  if (chunk_tensors.empty()) return;
+
+  auto functor = make_functor(*args);
+  int grid = static_cast<int>(chunk_tensors.size());
+  MultiTensorApplyKernel<<<grid, kMultiTensorBlockSize, 0, dev_ctx.stream()>>>(
+      args->Get<int>(tensors_offset), args->Get<int64_t>(starts_offset),
+      args->Get<int64_t>(numels_offset), chunk_size, functor);
+}
+
+}  // namespace operators
+}  // namespace paddle
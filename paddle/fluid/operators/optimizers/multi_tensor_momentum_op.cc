@@ -0,0 +1,109 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/multi_tensor_momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+void MultiTensorMomentumOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  OP_INOUT_CHECK(ctx->HasInputs("Param"), "Input", "Param",
+                 "MultiTensorMomentum");
+  OP_INOUT_CHECK(ctx->HasInputs("Grad"), "Input", "Grad",
+                 "MultiTensorMomentum");
+  OP_INOUT_CHECK(ctx->HasInputs("Velocity"), "Input", "Velocity",
+                 "MultiTensorMomentum");
+  OP_INOUT_CHECK(ctx->HasInput("LearningRate"), "Input", "LearningRate",
+                 "MultiTensorMomentum");
+  OP_INOUT_CHECK(ctx->HasOutputs("ParamOut"), "Output", "ParamOut",
+                 "MultiTensorMomentum");
+  OP_INOUT_CHECK(ctx->HasOutputs("VelocityOut"), "Output", "VelocityOut",
+                 "MultiTensorMomentum");
+
+  auto lr_dims = ctx->GetInputDim("LearningRate");
+  PADDLE_ENFORCE_EQ(framework::product(lr_dims), 1,
+                    platform::errors::InvalidArgument(
+                        "Learning_rate should be a scalar, but received %d",
+                        framework::product(lr_dims)));
+
+  auto param_dims = ctx->GetInputsDim("Param");
+  for (auto& name : {"Grad", "Velocity"}) {
+    auto dims = ctx->GetInputsDim(name);
+    PADDLE_ENFORCE_EQ(
+        dims.size(), param_dims.size(),
+        platform::errors::InvalidArgument(
+            "The size of Input(%s) should be equal to the size of "
+            "Input(Param) %d, but received %d.",
+            name, param_dims.size(), dims.size()));
+    for (size_t i = 0; i < param_dims.size(); ++i) {
+      PADDLE_ENFORCE_EQ(
+          param_dims[i], dims[i],
+          platform::errors::InvalidArgument(
+              "The %d-th Param and %s of MultiTensorMomentumOp should have "
+              "the same dimension. But received Param dims: [%s], %s dims: "
+              "[%s].",
+              i, name, param_dims[i], name, dims[i]));
+    }
+  }
+
+  ctx->SetOutputsDim("ParamOut", param_dims);
+  ctx->SetOutputsDim("VelocityOut", param_dims);
+}
+
+class MultiTensorMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(vector<Tensor>) Input parameters").AsDuplicable();
+    AddInput("Grad", "(vector<Tensor>) Input gradients").AsDuplicable();
+    AddInput("Velocity", "(vector<Tensor>) Input velocities").AsDuplicable();
+    AddInput("LearningRate", "(Tensor) Input learning rate");
+    AddOutput("ParamOut",
+              "(vector<Tensor>) The updated parameters. "
+              "They share memory with Input(Param).")
+        .AsDuplicable();
+    AddOutput("VelocityOut",
+              "(vector<Tensor>) The updated velocities. "
+              "They share memory with Input(Velocity).")
+        .AsDuplicable();
+
+    AddAttr<float>("mu", "(float) Momentum coefficient");
+    AddAttr<bool>("use_nesterov",
+                  "(bool, default false) "
+                  "Use Nesterov Momentum")
+        .SetDefault(false);
+    AddComment(R"DOC(
+MultiTensorMomentum Optimizer.
+
+The momentum update of a list of parameters with dense gradients, which
+are not coalesced into a continuous space. On GPU, the parameters are
+updated by one kernel launch. The update of each parameter is the same as
+the one of the momentum operator.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(multi_tensor_momentum, ops::MultiTensorMomentumOp,
+                             ops::MultiTensorMomentumOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    multi_tensor_momentum,
+    ops::MultiTensorMomentumOpKernel<paddle::platform::CPUDeviceContext,
+                                     float>,
+    ops::MultiTensorMomentumOpKernel<paddle::platform::CPUDeviceContext,
+                                     double>);
@@ -0,0 +1,124 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T, bool kUseNesterov>
+struct MultiTensorMomentumFunctor {
+  T mu;
+  const T* lr;
+  const T* const* params;
+  const T* const* grads;
+  const T* const* velocities;
+  T* const* param_outs;
+  T* const* velocity_outs;
+
+  __device__ __forceinline__ void operator()(int t, int64_t i) const {
+    const T g = grads[t][i];
+    T v_out = velocities[t][i] * mu + g;
+    velocity_outs[t][i] = v_out;
+    if (kUseNesterov) {
+      param_outs[t][i] = params[t][i] - (g + v_out * mu) * lr[0];
+    } else {
+      param_outs[t][i] = params[t][i] - lr[0] * v_out;
+    }
+  }
+};
+
+template <typename T>
+class MultiTensorMomentumOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+    auto* learning_rate = ctx.Input<framework::Tensor>("LearningRate");
+
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto velocities = ctx.MultiInput<framework::Tensor>("Velocity");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto velocity_outs = ctx.MultiOutput<framework::Tensor>("VelocityOut");
+
+    size_t n = params.size();
+    std::vector<int64_t> numels(n);
+    std::vector<const T*> param_ptrs(n), grad_ptrs(n), velocity_ptrs(n);
+    std::vector<T*> param_out_ptrs(n), velocity_out_ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+      numels[i] = params[i]->numel();
+      param_ptrs[i] = params[i]->data<T>();
+      grad_ptrs[i] = grads[i]->data<T>();
+      velocity_ptrs[i] = velocities[i]->data<T>();
+      param_out_ptrs[i] = param_outs[i]->mutable_data<T>(ctx.GetPlace());
+      velocity_out_ptrs[i] = velocity_outs[i]->mutable_data<T>(ctx.GetPlace());
+    }
+
+    MultiTensorArgs args;
+    Offsets offsets;
+    offsets.params = args.Append(param_ptrs);
+    offsets.grads = args.Append(grad_ptrs);
+    offsets.velocities = args.Append(velocity_ptrs);
+    offsets.param_outs = args.Append(param_out_ptrs);
+    offsets.velocity_outs = args.Append(velocity_out_ptrs);
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    const T* lr = learning_rate->data<T>();
+    if (use_nesterov) {
+      MultiTensorApply(dev_ctx, numels, &args,
+                       [&](const MultiTensorArgs& dev_args) {
+                         return MakeFunctor<true>(dev_args, offsets, mu, lr);
+                       });
+    } else {
+      MultiTensorApply(dev_ctx, numels, &args,
+                       [&](const MultiTensorArgs& dev_args) {
+                         return MakeFunctor<false>(dev_args, offsets, mu, lr);
+                       });
+    }
+  }
+
+ private:
+  struct Offsets {
+    size_t params;
+    size_t grads;
+    size_t velocities;
+    size_t param_outs;
+    size_t velocity_outs;
+  };
+
+  template <bool kUseNesterov>
+  static MultiTensorMomentumFunctor<T, kUseNesterov> MakeFunctor(
+      const MultiTensorArgs& dev_args, const Offsets& offsets, T mu,
+      const T* lr) {
+    MultiTensorMomentumFunctor<T, kUseNesterov> functor;
+    functor.mu = mu;
+    functor.lr = lr;
+    functor.params = dev_args.Get<const T*>(offsets.params);
+    functor.grads = dev_args.Get<const T*>(offsets.grads);
+    functor.velocities = dev_args.Get<const T*>(offsets.velocities);
+    functor.param_outs = dev_args.Get<T*>(offsets.param_outs);
+    functor.velocity_outs = dev_args.Get<T*>(offsets.velocity_outs);
+    return functor;
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(multi_tensor_momentum,
+                        ops::MultiTensorMomentumOpCUDAKernel<float>,
+                        ops::MultiTensorMomentumOpCUDAKernel<double>);
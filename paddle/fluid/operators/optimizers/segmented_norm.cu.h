@@ -0,0 +1,62 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include "cub/cub.cuh"
+#include "paddle/fluid/operators/optimizers/segmented_norm.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T, int BlockDim>
+__global__ void SegmentedNormKernel(const T* x, const T* y,
+                                    const int64_t* starts,
+                                    const int64_t* numels, T* x_norms,
+                                    T* y_norms) {
+  typedef cub::BlockReduce<T, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage x_storage;
+  __shared__ typename BlockReduce::TempStorage y_storage;
+
+  int64_t begin = starts[blockIdx.x];
+  int64_t end = begin + numels[blockIdx.x];
+  T x_sum = 0, y_sum = 0;
+  for (int64_t i = begin + threadIdx.x; i < end; i += BlockDim) {
+    x_sum += x[i] * x[i];
+    y_sum += y[i] * y[i];
+  }
+  x_sum = BlockReduce(x_storage).Reduce(x_sum, cub::Sum());
+  y_sum = BlockReduce(y_storage).Reduce(y_sum, cub::Sum());
+  if (threadIdx.x == 0) {
+    x_norms[blockIdx.x] = sqrt(x_sum);
+    y_norms[blockIdx.x] = sqrt(y_sum);
+  }
+}
+
+// One block per segment, so the norms of all the fused parameters take a
+// single launch.
+template <typename T>
+struct SegmentedNormFunctor<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& dev_ctx, const T* x,
+                  const T* y, const int64_t* starts, const int64_t* numels,
+                  int64_t num_segments, T* x_norms, T* y_norms) const {
+    if (num_segments == 0) return;
+    constexpr int kBlockDim = 512;
+    SegmentedNormKernel<T, kBlockDim><<<num_segments, kBlockDim, 0,
+                                        dev_ctx.stream()>>>(
+        x, y, starts, numels, x_norms, y_norms);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,87 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <math.h>  // for sqrt in CPU and CUDA
+#include <vector>
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/device_memory_aligment.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+// The layer-wise optimizers, e.g. LAMB and LARS, fused over the parameters
+// coalesced by coalesce_tensor need the norms of every parameter. The
+// parameters are the segments of one buffer.
+
+// The offsets of the segments whose sizes are numels, as coalesce_tensor
+// aligns them on place. The last one is the number of elements they need.
+template <typename T>
+std::vector<int64_t> FusedSegmentStarts(const std::vector<int64_t>& numels,
+                                        const platform::Place& place) {
+  std::vector<int64_t> starts(numels.size() + 1);
+  int64_t offset = 0;
+  for (size_t s = 0; s < numels.size(); ++s) {
+    starts[s] = offset;
+    offset += platform::Alignment(numels[s] * sizeof(T), place) / sizeof(T);
+  }
+  starts[numels.size()] = offset;
+  return starts;
+}
+
+// Return the segment holding the i-th element, in the segments starting at
+// the ascending offsets `starts`. The padding after a segment belongs to it.
+inline HOSTDEVICE int64_t FindSegment(const int64_t* starts,
+                                      int64_t num_segments, int64_t i) {
+  int64_t lo = 0, hi = num_segments - 1;
+  while (lo < hi) {
+    int64_t mid = (lo + hi + 1) / 2;
+    if (starts[mid] <= i) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+// The L2 norms of the segments of x and y, all the pointers are on the
+// device. The CUDA specialization is in segmented_norm.cu.h.
+template <typename DeviceContext, typename T>
+struct SegmentedNormFunctor {
+  void operator()(const DeviceContext& dev_ctx, const T* x, const T* y,
+                  const int64_t* starts, const int64_t* numels,
+                  int64_t num_segments, T* x_norms, T* y_norms) const;
+};
+
+template <typename T>
+struct SegmentedNormFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& dev_ctx, const T* x,
+                  const T* y, const int64_t* starts, const int64_t* numels,
+                  int64_t num_segments, T* x_norms, T* y_norms) const {
+    for (int64_t s = 0; s < num_segments; ++s) {
+      T x_sum = 0, y_sum = 0;
+      for (int64_t i = starts[s]; i < starts[s] + numels[s]; ++i) {
+        x_sum += x[i] * x[i];
+        y_sum += y[i] * y[i];
+      }
+      x_norms[s] = sqrt(x_sum);
+      y_norms[s] = sqrt(y_sum);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -131,6 +131,7 @@ class SGDOpKernel<platform::CPUDeviceContext, T>
               lr[0] * grad_data[i * grad_row_width + j];
         }
       }
+      param_out->MarkUpdated(grad.rows().data(), grad.rows().size());
     } else {
       PADDLE_THROW("Unsupported Variable Type of Parameter");
     }
@@ -13,15 +13,30 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/buffered_reader.h"
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DEFINE_int32(reader_max_buffer_size, 0,
+             "If larger than the buffer size of a double buffer reader, the "
+             "number of the batches it reads ahead adapts between the buffer "
+             "size and this, according to the time the consumer waits and "
+             "the memory available on its place.");
+
 namespace paddle {
 namespace operators {
 namespace reader {
+
+// the consumer is taken as starved if it waits longer than this for a batch
+static constexpr int64_t kStarvedWaitUs = 100;
+// the consumer not starved for this many batches in a row frees a slot
+static constexpr size_t kShrinkSteps = 100;
+
 BufferedReader::~BufferedReader() {
   VLOG(1) << "~BufferedReader";
   reader_->Shutdown();
@@ -40,7 +55,11 @@ BufferedReader::BufferedReader(
     : framework::DecoratedReader(reader),
       thread_pool_(1),
       place_(place),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      max_buffer_size_(std::max(
+          buffer_size, static_cast<size_t>(std::max(
+                           FLAGS_reader_max_buffer_size, 0)))),
+      depth_(buffer_size) {
   VLOG(1) << "BufferedReader";
 #ifdef PADDLE_WITH_CUDA
   if (platform::is_gpu_place(place_)) {
@@ -49,20 +68,28 @@ BufferedReader::BufferedReader(
         ((platform::CUDADeviceContext *)(platform::DeviceContextPool::Instance()
                                              .Get(place_)))
             ->stream();
-    events_.resize(buffer_size);
+    events_.resize(max_buffer_size_);
     for (auto &event : events_) {
       event = platform::CudaEventResourcePool::Instance().New(dev_idx);
     }
+    copy_events_.resize(max_buffer_size_);
+    for (auto &event : copy_events_) {
+      event = platform::CudaEventResourcePool::Instance().New(dev_idx);
+    }
     stream_ = platform::CudaStreamResourcePool::Instance().New(dev_idx);
   }
 #endif
-  cpu_buffer_.resize(buffer_size);
-  gpu_buffer_.resize(buffer_size);
+  cpu_buffer_.resize(max_buffer_size_);
+  gpu_buffer_.resize(max_buffer_size_);
   ReadTillBufferFullAsync();
 }
 
 void BufferedReader::ReadTillBufferFullAsync() {
-  for (size_t i = 0; i < buffer_size_; ++i) {
+  free_slots_.clear();
+  for (size_t i = max_buffer_size_; i > depth_; --i) {
+    free_slots_.push_back(i - 1);
+  }
+  for (size_t i = 0; i < depth_; ++i) {
     ReadAsync(i);
   }
 }
@@ -126,27 +153,64 @@ void BufferedReader::ReadAsync(size_t i) {
                        BOOST_GET_CONST(platform::CUDAPlace, cpu_place), cpu_ptr,
                        size, stream_.get());
         } else {
-          platform::CUDAPinnedPlace cuda_pinned_place;
-          framework::LoDTensor cuda_pinned_tensor;
-          cuda_pinned_tensor.Resize(cpu[i].dims());
-          auto cuda_pinned_ptr =
-              cuda_pinned_tensor.mutable_data(cuda_pinned_place, cpu[i].type());
-          memory::Copy(cuda_pinned_place, cuda_pinned_ptr,
-                       BOOST_GET_CONST(platform::CPUPlace, cpu_place), cpu_ptr,
-                       size);
+          // The pageable memory is staged in the cached pinned memory, so
+          // the copies of all the tensors are asynchronous.
           memory::Copy(BOOST_GET_CONST(platform::CUDAPlace, place_), gpu_ptr,
-                       cuda_pinned_place, cuda_pinned_ptr, size, stream_.get());
-          PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream_.get()));
+                       BOOST_GET_CONST(platform::CPUPlace, cpu_place), cpu_ptr,
+                       size, stream_.get());
         }
         gpu[i].set_lod(cpu[i].lod());
+        // The LoD is copied on the same stream, instead of on the compute
+        // stream when the first op uses it.
+        for (auto &level : gpu[i].lod()) {
+          if (!level.empty()) level.PrefetchCUDA(place_, stream_.get());
+        }
       }
-      PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream_.get()));
+      // The consumer waits for the copies, so this thread reads the next
+      // batch meanwhile. The slot is read again after it is consumed, when
+      // the copies from its CPU buffer are done.
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaEventRecord(copy_events_[i].get(), stream_.get()));
     }
 #endif
     return i;
   }));
 }
 
+bool BufferedReader::HasMemoryFor(size_t batch_bytes) const {
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place_)) {
+    platform::SetDeviceId(BOOST_GET_CONST(platform::CUDAPlace, place_).device);
+    // leave the room for the computation
+    return platform::GpuAvailableMemToAlloc() > 2 * batch_bytes;
+  }
+#endif
+  return true;
+}
+
+void BufferedReader::AdaptDepth(int64_t wait_us, size_t batch_bytes) {
+  if (max_buffer_size_ == buffer_size_) return;
+  if (wait_us >= kStarvedWaitUs) {
+    steps_without_wait_ = 0;
+    if (!free_slots_.empty() && HasMemoryFor(batch_bytes)) {
+      ++depth_;
+      VLOG(3) << "The consumer waits " << wait_us << "us, read "
+              << depth_ << " batches ahead on " << place_;
+      ReadAsync(free_slots_.back());
+      free_slots_.pop_back();
+    }
+    return;
+  }
+  if (++steps_without_wait_ >= kShrinkSteps && depth_ > buffer_size_ &&
+      prev_pos_ != -1UL) {
+    steps_without_wait_ = 0;
+    --depth_;
+    VLOG(3) << "Read " << depth_ << " batches ahead on " << place_;
+    free_slots_.push_back(prev_pos_);
+    prev_pos_ = -1UL;
+  }
+}
+
 void BufferedReader::ShutdownImpl() {
   VLOG(1) << "ShutdownImpl";
   reader_->Shutdown();
@@ -166,6 +230,7 @@ void BufferedReader::ReadNextImpl(std::vector<framework::LoDTensor> *out) {
     out->clear();
     return;
   }
+  auto start = std::chrono::steady_clock::now();
   size_t i = position_.front().get();
   position_.pop();
 
@@ -174,9 +239,24 @@ void BufferedReader::ReadNextImpl(std::vector<framework::LoDTensor> *out) {
     return;
   }
 
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place_)) {
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventSynchronize(copy_events_[i].get()));
+  }
+#endif
+  auto wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
   *out = std::move(platform::is_gpu_place(place_) ? gpu_buffer_[i]
                                                   : cpu_buffer_[i]);
 
+  size_t batch_bytes = 0;
+  for (auto &tensor : *out) {
+    batch_bytes += tensor.numel() * framework::SizeOfType(tensor.type());
+  }
+  AdaptDepth(wait_us, batch_bytes);
+
   // Do not push current position into ReadAsync. Push the previous position
   // Since all computation in fluid are async, change the data of
   // current position may cause data error.
@@ -29,6 +29,17 @@ namespace paddle {
 namespace operators {
 namespace reader {
 
+/*
+ * Reads the batches of the underlying reader ahead in another thread, and
+ * copies them to the place on a dedicated stream, so the copies overlap with
+ * the computation and with reading the next batch.
+ *
+ * If FLAGS_reader_max_buffer_size is larger than buffer_size, the number of
+ * the batches read ahead adapts between buffer_size and it: it grows by one
+ * when the consumer waits for a batch and there is memory on the place for
+ * one more, and shrinks by one after the consumer has not waited for a
+ * number of batches in a row.
+ */
 class BufferedReader : public framework::DecoratedReader {
   using TensorVec = std::vector<framework::LoDTensor>;
   using VecFuture = std::future<TensorVec>;
@@ -39,11 +50,19 @@ class BufferedReader : public framework::DecoratedReader {
 
   ~BufferedReader() override;
 
+  size_t Depth() const { return depth_; }
+
  private:
   void ReadTillBufferFullAsync();
 
   void ReadAsync(size_t i);
 
+  // Adjust the depth after the consumer waited wait_us for a batch of
+  // batch_bytes, and read the freed or new slots ahead.
+  void AdaptDepth(int64_t wait_us, size_t batch_bytes);
+
+  bool HasMemoryFor(size_t batch_bytes) const;
+
  protected:
   void ShutdownImpl() override;
   void StartImpl() override;
@@ -53,6 +72,13 @@ class BufferedReader : public framework::DecoratedReader {
   ThreadPool thread_pool_;
   platform::Place place_;
   const size_t buffer_size_;
+  const size_t max_buffer_size_;
+
+  // The number of the slots of the buffers in use, i.e., being read ahead,
+  // ready or just consumed.
+  size_t depth_;
+  std::vector<size_t> free_slots_;
+  size_t steps_without_wait_{0};
 
   std::queue<std::future<size_t>> position_;
 
@@ -68,6 +94,8 @@ class BufferedReader : public framework::DecoratedReader {
   cudaStream_t compute_stream_;
   std::shared_ptr<platform::CudaStreamObject> stream_;
   std::vector<std::shared_ptr<platform::CudaEventObject>> events_;
+  // recorded after the copies of each slot
+  std::vector<std::shared_ptr<platform::CudaEventObject>> copy_events_;
 #endif
 };
 
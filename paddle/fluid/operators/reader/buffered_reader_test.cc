@@ -0,0 +1,84 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/buffered_reader.h"
+#include <gflags/gflags.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+DECLARE_int32(reader_max_buffer_size);
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+class DelayedReader : public framework::ReaderBase {
+ public:
+  DelayedReader()
+      : framework::ReaderBase({framework::make_ddim({1})},
+                              {framework::proto::VarType::INT64}, {false}) {}
+
+  std::atomic<int> delay_ms{0};
+
+ protected:
+  void ReadNextImpl(std::vector<framework::LoDTensor> *out) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms.load()));
+    out->resize(1);
+    (*out)[0].Resize(framework::make_ddim({1}));
+    *(*out)[0].mutable_data<int64_t>(platform::CPUPlace()) = next_++;
+  }
+
+ private:
+  int64_t next_{0};
+};
+
+TEST(BufferedReader, AdaptiveDepth) {
+  FLAGS_reader_max_buffer_size = 4;
+  auto underlying = std::make_shared<DelayedReader>();
+  underlying->delay_ms = 5;
+  auto decorated =
+      framework::MakeDecoratedReader<BufferedReader>(underlying,
+                                                     platform::CPUPlace(), 2);
+  auto *reader = static_cast<BufferedReader *>(decorated.get());
+  EXPECT_EQ(reader->Depth(), 2UL);
+
+  // the consumer waiting for the slow reader reads more batches ahead
+  int64_t expected = 0;
+  std::vector<framework::LoDTensor> out;
+  for (int i = 0; i < 5; ++i) {
+    reader->ReadNext(&out);
+    ASSERT_EQ(out.size(), 1UL);
+    EXPECT_EQ(out[0].data<int64_t>()[0], expected++);
+  }
+  EXPECT_EQ(reader->Depth(), 4UL);
+
+  // and reads fewer of them once it is not waiting any more
+  underlying->delay_ms = 0;
+  for (int i = 0; i < 400; ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+    reader->ReadNext(&out);
+    ASSERT_EQ(out.size(), 1UL);
+    EXPECT_EQ(out[0].data<int64_t>()[0], expected++);
+  }
+  EXPECT_EQ(reader->Depth(), 2UL);
+  FLAGS_reader_max_buffer_size = 0;
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <utility>
 #include <vector>
@@ -22,6 +24,7 @@
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/operators/reader/blocking_queue.h"
 #include "paddle/fluid/platform/place.h"
+#include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
 namespace operators {
@@ -35,20 +38,32 @@ class LoDTensorBlockingQueue {
   ~LoDTensorBlockingQueue() { VLOG(10) << "Destruct LoDTensorBlockingQueue"; }
 
   bool Push(const std::vector<framework::LoDTensor>& lod_tensor_vec) {
+    WaitTimer timer("LoDTensorBlockingQueue::Push", &push_wait_ns_);
     return queue_.Send(lod_tensor_vec);
   }
 
   bool Push(std::vector<framework::LoDTensor>&& lod_tensor_vec) {
+    WaitTimer timer("LoDTensorBlockingQueue::Push", &push_wait_ns_);
     return queue_.Send(std::move(lod_tensor_vec));
   }
 
   std::vector<framework::LoDTensor> Pop(bool* ok = nullptr) {
     std::vector<framework::LoDTensor> lod_tensor_vec;
-    bool success = queue_.Receive(&lod_tensor_vec);
+    bool success;
+    {
+      WaitTimer timer("LoDTensorBlockingQueue::Pop", &pop_wait_ns_);
+      success = queue_.Receive(&lod_tensor_vec);
+    }
     if (ok != nullptr) *ok = success;
     return lod_tensor_vec;
   }
 
+  // The total time the producers are blocked by a full queue, which means the
+  // consumers are the bottleneck, and the time the consumers are blocked by
+  // an empty queue, which means the producers are.
+  double PushWaitMs() const { return push_wait_ns_.load() / 1e6; }
+  double PopWaitMs() const { return pop_wait_ns_.load() / 1e6; }
+
   inline size_t Cap() const { return queue_.Cap(); }
 
   inline size_t Size() const { return queue_.Size(); }
@@ -67,7 +82,27 @@ class LoDTensorBlockingQueue {
   inline bool WaitForInited(size_t) { return true; }
 
  private:
+  class WaitTimer {
+   public:
+    WaitTimer(const char* name, std::atomic<uint64_t>* total_ns)
+        : event_(name),
+          total_ns_(total_ns),
+          start_(std::chrono::steady_clock::now()) {}
+    ~WaitTimer() {
+      *total_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_)
+                        .count();
+    }
+
+   private:
+    platform::RecordEvent event_;
+    std::atomic<uint64_t>* total_ns_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
   BlockingQueue<std::vector<framework::LoDTensor>> queue_;
+  std::atomic<uint64_t> push_wait_ns_{0};
+  std::atomic<uint64_t> pop_wait_ns_{0};
 };
 
 class OrderedMultiDeviceLoDTensorBlockingQueue {
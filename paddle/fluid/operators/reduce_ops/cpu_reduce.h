@@ -0,0 +1,242 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * The reducers of the CPU reduction, out = Finalize(sum(Transform(x)), n)
+ * where n is the number of the reduced elements.
+ */
+struct CPUSumReducer {
+  template <typename T>
+  static T Transform(T x) {
+    return x;
+  }
+  template <typename T>
+  static T Finalize(T sum, int64_t n) {
+    return sum;
+  }
+};
+
+struct CPUMeanReducer {
+  template <typename T>
+  static T Transform(T x) {
+    return x;
+  }
+  template <typename T>
+  static T Finalize(T sum, int64_t n) {
+    return sum / static_cast<T>(n);
+  }
+};
+
+// The L2 norm, i.e., the frobenius norm of all the reduced elements.
+struct CPUNormReducer {
+  template <typename T>
+  static T Transform(T x) {
+    return x * x;
+  }
+  template <typename T>
+  static T Finalize(T sum, int64_t n) {
+    return std::sqrt(sum);
+  }
+};
+
+// The CPU reducer of a reduce op functor, void if there is none.
+template <typename Functor>
+struct CPUReducerOf {
+  using type = void;
+};
+
+namespace detail {
+
+// The number of the partial sums of a contiguous reduction, kept in the
+// registers and vectorized by the compiler.
+constexpr int kReduceLanes = 8;
+// The reduced elements are split into the chunks of about this size, whose
+// partial sums are combined in order. The chunks do not depend on the number
+// of the threads, so the results are deterministic.
+constexpr int64_t kReduceChunkSize = 1 << 14;
+// The inner dims are split into the blocks of this size.
+constexpr int64_t kReduceInnerBlock = 256;
+
+template <typename Reducer, typename T>
+T ContiguousSum(const T* x, int64_t n) {
+  T lanes[kReduceLanes] = {0};
+  int64_t i = 0;
+  for (; i + kReduceLanes <= n; i += kReduceLanes) {
+    for (int j = 0; j < kReduceLanes; ++j) {
+      lanes[j] += Reducer::Transform(x[i + j]);
+    }
+  }
+  for (int j = 0; i < n; ++i, ++j) {
+    lanes[j] += Reducer::Transform(x[i]);
+  }
+  T sum = 0;
+  for (int j = 0; j < kReduceLanes; ++j) {
+    sum += lanes[j];
+  }
+  return sum;
+}
+
+}  // namespace detail
+
+/*
+ * Merge the adjacent reduced and kept dims of x, and return false if the
+ * reduced dims are not contiguous after merging. Otherwise x is viewed as
+ * [outer, reduce, inner], where outer and inner are kept.
+ */
+inline bool GetReduceShape(const framework::DDim& x_dims,
+                           const std::vector<int>& dims, bool reduce_all,
+                           int64_t* outer, int64_t* reduce, int64_t* inner) {
+  int rank = x_dims.size();
+  std::vector<bool> reduced(rank, reduce_all);
+  for (int d : dims) {
+    if (d < 0) d += rank;
+    if (d < 0 || d >= rank) return false;
+    reduced[d] = true;
+  }
+  int first = rank, last = -1;
+  for (int i = 0; i < rank; ++i) {
+    if (reduced[i] && x_dims[i] != 1) {
+      first = std::min(first, i);
+      last = i;
+    }
+  }
+  *outer = 1;
+  *reduce = 1;
+  *inner = 1;
+  for (int i = 0; i < rank; ++i) {
+    if (i < first) {
+      *outer *= x_dims[i];
+    } else if (i > last) {
+      *inner *= x_dims[i];
+    } else if (reduced[i] || x_dims[i] == 1) {
+      *reduce *= x_dims[i];
+    } else {
+      // a kept dim between the reduced ones
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * out[o][i] = Finalize(sum_r Transform(x[o][r][i])) with OpenMP threads over
+ * the outer dim, the chunks of the reduced dim and the blocks of the inner
+ * dim. The partial sums of the chunks are combined in a fixed order.
+ */
+template <typename Reducer, typename T>
+void CPUReduce(const T* x, T* out, int64_t outer, int64_t reduce,
+               int64_t inner) {
+  if (reduce == 0) {
+    std::fill(out, out + outer * inner, Reducer::Finalize(T(0), reduce));
+    return;
+  }
+  // the number of the rows of the reduced dim in a chunk
+  int64_t chunk_rows = std::max<int64_t>(
+      1, detail::kReduceChunkSize / std::max<int64_t>(inner, 1));
+  int64_t chunks = (reduce + chunk_rows - 1) / chunk_rows;
+  int64_t blocks =
+      (inner + detail::kReduceInnerBlock - 1) / detail::kReduceInnerBlock;
+  std::vector<T> partials;
+  T* partial = out;
+  if (chunks > 1) {
+    partials.resize(outer * chunks * inner);
+    partial = partials.data();
+  }
+  int64_t tasks = outer * chunks * blocks;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (outer * reduce * inner > \
+                             detail::kReduceChunkSize)
+#endif
+  for (int64_t t = 0; t < tasks; ++t) {
+    int64_t o = t / (chunks * blocks);
+    int64_t c = t / blocks % chunks;
+    int64_t b = t % blocks;
+    int64_t r_begin = c * chunk_rows;
+    int64_t r_end = std::min(r_begin + chunk_rows, reduce);
+    T* dst = partial + (o * chunks + c) * inner;
+    if (inner == 1) {
+      dst[0] = detail::ContiguousSum<Reducer>(x + o * reduce + r_begin,
+                                              r_end - r_begin);
+      continue;
+    }
+    int64_t i_begin = b * detail::kReduceInnerBlock;
+    int64_t i_end = std::min(i_begin + detail::kReduceInnerBlock, inner);
+    std::fill(dst + i_begin, dst + i_end, T(0));
+    for (int64_t r = r_begin; r < r_end; ++r) {
+      const T* src = x + (o * reduce + r) * inner;
+      for (int64_t i = i_begin; i < i_end; ++i) {
+        dst[i] += Reducer::Transform(src[i]);
+      }
+    }
+  }
+  for (int64_t o = 0; o < outer; ++o) {
+    T* dst = out + o * inner;
+    const T* src = partial + o * chunks * inner;
+    for (int64_t i = 0; i < inner; ++i) {
+      T sum = src[i];
+      for (int64_t c = 1; c < chunks; ++c) {
+        sum += src[c * inner + i];
+      }
+      dst[i] = Reducer::Finalize(sum, reduce);
+    }
+  }
+}
+
+template <typename T>
+struct IsCPUReduceType {
+  static constexpr bool value =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+};
+
+// Return false if the reduction is not supported, i.e., not a float or double
+// reduction of a supported functor over the contiguous dims.
+template <typename Functor, typename T,
+          typename Reducer = typename CPUReducerOf<Functor>::type>
+typename std::enable_if<std::is_void<Reducer>::value ||
+                            !IsCPUReduceType<T>::value,
+                        bool>::type
+CPUReduceTensor(const framework::Tensor& x, const std::vector<int>& dims,
+                bool reduce_all, framework::Tensor* out) {
+  return false;
+}
+
+template <typename Functor, typename T,
+          typename Reducer = typename CPUReducerOf<Functor>::type>
+typename std::enable_if<!std::is_void<Reducer>::value &&
+                            IsCPUReduceType<T>::value,
+                        bool>::type
+CPUReduceTensor(const framework::Tensor& x, const std::vector<int>& dims,
+                bool reduce_all, framework::Tensor* out) {
+  int64_t outer, reduce, inner;
+  if (!GetReduceShape(x.dims(), dims, reduce_all, &outer, &reduce, &inner)) {
+    return false;
+  }
+  CPUReduce<Reducer>(x.data<T>(), out->data<T>(), outer, reduce, inner);
+  return true;
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,88 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+
+TEST(CPUReduce, reduce_shape) {
+  int64_t outer, reduce, inner;
+  auto dims = framework::make_ddim({2, 3, 4, 5});
+  EXPECT_TRUE(GetReduceShape(dims, {1, 2}, false, &outer, &reduce, &inner));
+  EXPECT_EQ(outer, 2);
+  EXPECT_EQ(reduce, 12);
+  EXPECT_EQ(inner, 5);
+  EXPECT_TRUE(GetReduceShape(dims, {-1}, false, &outer, &reduce, &inner));
+  EXPECT_EQ(outer, 24);
+  EXPECT_EQ(reduce, 5);
+  EXPECT_EQ(inner, 1);
+  EXPECT_TRUE(GetReduceShape(dims, {}, true, &outer, &reduce, &inner));
+  EXPECT_EQ(outer * inner, 1);
+  EXPECT_EQ(reduce, 120);
+  // a kept dim between the reduced ones
+  EXPECT_FALSE(GetReduceShape(dims, {0, 2}, false, &outer, &reduce, &inner));
+  // unless the dim is 1
+  dims = framework::make_ddim({2, 1, 4, 5});
+  EXPECT_TRUE(GetReduceShape(dims, {0, 2}, false, &outer, &reduce, &inner));
+  EXPECT_EQ(outer, 1);
+  EXPECT_EQ(reduce, 8);
+  EXPECT_EQ(inner, 5);
+}
+
+template <typename Reducer>
+void TestCPUReduce(int64_t outer, int64_t reduce, int64_t inner) {
+  std::vector<double> x(outer * reduce * inner);
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> dist(-1., 1.);
+  for (auto& v : x) v = dist(rng);
+
+  std::vector<double> out(outer * inner);
+  CPUReduce<Reducer>(x.data(), out.data(), outer, reduce, inner);
+  for (int64_t o = 0; o < outer; ++o) {
+    for (int64_t i = 0; i < inner; ++i) {
+      double sum = 0.;
+      for (int64_t r = 0; r < reduce; ++r) {
+        sum += Reducer::Transform(x[(o * reduce + r) * inner + i]);
+      }
+      EXPECT_NEAR(out[o * inner + i], Reducer::Finalize(sum, reduce), 1e-9)
+          << outer << " " << reduce << " " << inner;
+    }
+  }
+
+  // the same results of every run
+  std::vector<double> again(outer * inner);
+  CPUReduce<Reducer>(x.data(), again.data(), outer, reduce, inner);
+  EXPECT_EQ(out, again);
+}
+
+TEST(CPUReduce, sum_mean_norm) {
+  for (auto shape : std::vector<std::vector<int64_t>>{{1, 1, 1},
+                                                      {3, 17, 1},
+                                                      {1, 70000, 1},
+                                                      {5, 9, 300},
+                                                      {2, 40000, 3},
+                                                      {4, 1, 7}}) {
+    TestCPUReduce<CPUSumReducer>(shape[0], shape[1], shape[2]);
+    TestCPUReduce<CPUMeanReducer>(shape[0], shape[1], shape[2]);
+    TestCPUReduce<CPUNormReducer>(shape[0], shape[1], shape[2]);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
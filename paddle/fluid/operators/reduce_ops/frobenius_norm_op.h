@@ -39,6 +39,11 @@ struct FrobeniusNormFunctor {
   }
 };
 
+template <>
+struct CPUReducerOf<FrobeniusNormFunctor> {
+  using type = CPUNormReducer;
+};
+
 struct FrobeniusNormGradFunctor {
   template <typename DeviceContext, typename X, typename Y, typename DX,
             typename DY, typename Dim>
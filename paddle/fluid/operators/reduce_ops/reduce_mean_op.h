@@ -26,6 +26,11 @@ struct MeanFunctor {
   }
 };
 
+template <>
+struct CPUReducerOf<MeanFunctor> {
+  using type = CPUMeanReducer;
+};
+
 struct MeanGradFunctor {
   template <typename DeviceContext, typename X, typename Y, typename DX,
             typename DY, typename Dim>
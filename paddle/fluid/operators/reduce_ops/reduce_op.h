@@ -20,6 +20,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/operators/cast_op.h"
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
 #include "paddle/fluid/operators/reduce_ops/reduce_op_function.h"
 
 namespace paddle {
@@ -56,6 +57,10 @@ struct ReduceKernelFunctor {
   template <typename OutT>
   void apply() const {
     output->mutable_data<OutT>(context.GetPlace());
+    if (platform::is_cpu_place(context.GetPlace()) &&
+        CPUReduceTensor<Functor, OutT>(*input, dims, reduce_all, output)) {
+      return;
+    }
     if (reduce_all) {
       // Flatten and reduce 1-D tensor
       auto x = EigenVector<OutT>::Flatten(*input);
@@ -86,7 +86,9 @@ REGISTER_OP_CPU_KERNEL(
                       ops::SumFunctor>,
     ops::ReduceKernel<paddle::platform::CPUDeviceContext, int, ops::SumFunctor>,
     ops::ReduceKernel<paddle::platform::CPUDeviceContext, int64_t,
-                      ops::SumFunctor>);
+                      ops::SumFunctor>,
+    ops::ReduceKernel<paddle::platform::CPUDeviceContext,
+                      paddle::platform::bfloat16, ops::SumFunctor>);
 
 template <typename T>
 using CPUReduceSumGradKernel =
@@ -96,4 +98,5 @@ using CPUReduceSumGradKernel =
 REGISTER_OP_CPU_KERNEL(reduce_sum_grad, CPUReduceSumGradKernel<float>,
                        CPUReduceSumGradKernel<double>,
                        CPUReduceSumGradKernel<int>,
-                       CPUReduceSumGradKernel<int64_t>);
+                       CPUReduceSumGradKernel<int64_t>,
+                       CPUReduceSumGradKernel<paddle::platform::bfloat16>);
@@ -106,6 +106,11 @@ struct SumFunctor {
   }
 };
 
+template <>
+struct CPUReducerOf<SumFunctor> {
+  using type = CPUSumReducer;
+};
+
 struct SumGradFunctor {
   template <typename DeviceContext, typename X, typename Y, typename DX,
             typename DY, typename Dim>
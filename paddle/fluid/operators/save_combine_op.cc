@@ -75,6 +75,18 @@ to a file on disk.
                   "(boolean, default false)"
                   "If true, the variables will be saved to binary strings.")
         .SetDefault(false);
+    AddAttr<int>("format_version",
+                 "(int, default 1)"
+                 "1 to save the LoDTensors one after another, or 2 to save "
+                 "them in the tensor container with an index, the aligned "
+                 "payloads and the CRC32 of the chunks, which can be loaded "
+                 "by names in any order. Both are loaded by load_combine.")
+        .SetDefault(1);
+    AddAttr<std::string>("compression",
+                         "(string, default \"none\")"
+                         "\"none\" or \"zlib\", the compression of each "
+                         "tensor. Only valid if format_version is 2.")
+        .SetDefault("none");
     AddOutput("Y",
               "(RAW, default empty)."
               "This output is used when saving variables to binary strings.")
@@ -16,18 +16,24 @@ limitations under the License. */
 
 #include <stdint.h>
 #include <fstream>
+#include <memory>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_container.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/port.h"
 
+DECLARE_bool(async_checkpoint);
+
 namespace paddle {
 namespace operators {
 template <typename DeviceContext, typename T>
@@ -39,9 +45,18 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     auto overwrite = ctx.Attr<bool>("overwrite");
     auto save_as_fp16 = ctx.Attr<bool>("save_as_fp16");
     auto save_to_memory = ctx.Attr<bool>("save_to_memory");
+    auto format_version = ctx.Attr<int>("format_version");
+    auto compression = framework::StringToTensorCompression(
+        ctx.Attr<std::string>("compression"));
+    PADDLE_ENFORCE_EQ(format_version == 1 || format_version == 2, true,
+                      platform::errors::InvalidArgument(
+                          "The format_version of save_combine should be 1 or "
+                          "2, but received %d.",
+                          format_version));
     auto output = ctx.Output<std::string>("Y");
 
-    bool is_present = FileExists(filename);
+    auto &writer = framework::AsyncCheckpointWriter::Instance();
+    bool is_present = FileExists(filename) || writer.IsPending(filename);
     if (is_present && !overwrite) {
       PADDLE_THROW(platform::errors::PreconditionNotMet(
           "%s exists! Cannot save_combine to it when overwrite is set to "
@@ -62,6 +77,25 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    // Take the snapshots of all the variables in the host memory, and write
+    // them in the background.
+    bool async = FLAGS_async_checkpoint && !save_to_memory;
+    auto snapshots = std::make_shared<std::vector<framework::LoDTensor>>();
+    if (async) snapshots->resize(inp_var_names.size());
+    std::unique_ptr<framework::TensorContainerWriter> container;
+    if (!async && format_version == 2) {
+      container.reset(new framework::TensorContainerWriter(&ss));
+    }
+    auto serialize = [&](size_t i, const framework::LoDTensor &tensor) {
+      if (async) {
+        framework::SnapshotTensor(tensor, &snapshots->at(i));
+      } else if (container) {
+        container->Append(inp_var_names[i], tensor, dev_ctx, compression);
+      } else {
+        framework::SerializeToStream(ss, tensor, dev_ctx);
+      }
+    };
+
     for (size_t i = 0; i < inp_var_names.size(); i++) {
       PADDLE_ENFORCE_NOT_NULL(
           inp_vars[i],
@@ -88,12 +122,33 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
         // copy LoD info to the new tensor
         out.set_lod(tensor.lod());
         framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
-        framework::SerializeToStream(ss, out, dev_ctx);
+        serialize(i, out);
       } else {
-        framework::SerializeToStream(ss, tensor, dev_ctx);
+        serialize(i, tensor);
       }
+      if (async) snapshots->at(i).set_lod(tensor.lod());
     }
-    if (save_to_memory) {
+    if (container) container->Finish();
+
+    if (async) {
+      writer.Write(filename, [snapshots, inp_var_names, format_version,
+                              compression](std::ostream *os) {
+        auto &cpu_ctx = *platform::DeviceContextPool::Instance().Get(
+            platform::CPUPlace());
+        if (format_version == 2) {
+          framework::TensorContainerWriter container(os);
+          for (size_t i = 0; i < snapshots->size(); ++i) {
+            container.Append(inp_var_names[i], snapshots->at(i), cpu_ctx,
+                             compression);
+          }
+          container.Finish();
+          return;
+        }
+        for (auto &snapshot : *snapshots) {
+          framework::SerializeToStream(*os, snapshot, cpu_ctx);
+        }
+      });
+    } else if (save_to_memory) {
       PADDLE_ENFORCE_NE(output, nullptr,
                         platform::errors::InvalidArgument(
                             "Cannot find variable Y for save_combine_op"));
@@ -55,6 +55,14 @@ This operator will serialize and write LoDTensor / SelectedRows variable to file
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<int>("mode",
+                 "(int, default 0)"
+                 "The mode of saving a SelectedRows. 0 saves the whole table, "
+                 "1 saves the rows updated since the last save of the table "
+                 "as a delta, the first save in mode 1 saves the whole table "
+                 "as the base of the deltas. LoDTensor is always saved in "
+                 "full.")
+        .SetDefault(0);
     AddAttr<std::string>("file_path",
                          "(string)"
                          "The \"file_path\" where the variable will be saved.")
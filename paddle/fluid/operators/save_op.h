@@ -18,21 +18,29 @@ limitations under the License. */
 #include <fstream>
 #include <numeric>
 #include <string>
+#include <memory>
 #include <vector>
 
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/sparse_table_delta.h"
 #include "paddle/fluid/framework/variable.h"
 
+DECLARE_bool(async_checkpoint);
+
 namespace paddle {
 namespace operators {
 // define LOOKUP_TABLE_PATH for checkpoint notify to save lookup table variables
 // to directory specified.
 constexpr char LOOKUP_TABLE_PATH[] = "kLookupTablePath";
+// define LOOKUP_TABLE_SAVE_MODE for checkpoint notify to override the mode of
+// saving the lookup table variables.
+constexpr char LOOKUP_TABLE_SAVE_MODE[] = "kLookupTableSaveMode";
 template <typename DeviceContext, typename T>
 class SaveOpKernel : public framework::OpKernel<T> {
  public:
@@ -63,20 +71,47 @@ class SaveOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto overwrite = ctx.Attr<bool>("overwrite");
 
+    auto &writer = framework::AsyncCheckpointWriter::Instance();
     PADDLE_ENFORCE_EQ(
-        FileExists(filename) && !overwrite, false,
+        (FileExists(filename) || writer.IsPending(filename)) && !overwrite,
+        false,
         platform::errors::PreconditionNotMet(
             "%s exists!, cannot save to it when overwrite is set to false.",
             filename, overwrite));
 
-    MkDirRecursively(DirName(filename).c_str());
-
     auto &tensor = var->Get<framework::LoDTensor>();
 
     // get device context from pool
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    auto save_as_fp16 = ctx.Attr<bool>("save_as_fp16");
+    auto in_dtype = tensor.type();
+    auto out_dtype = save_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
+
+    if (FLAGS_async_checkpoint) {
+      // Take a snapshot in the host memory, and write it in the background.
+      auto snapshot = std::make_shared<framework::LoDTensor>();
+      if (in_dtype != out_dtype) {
+        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+        framework::LoDTensor out;
+        framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
+        framework::SnapshotTensor(out, snapshot.get());
+      } else {
+        framework::SnapshotTensor(tensor, snapshot.get());
+      }
+      snapshot->set_lod(tensor.lod());
+      writer.Write(filename, [snapshot](std::ostream *os) {
+        auto &cpu_ctx = *platform::DeviceContextPool::Instance().Get(
+            platform::CPUPlace());
+        framework::SerializeToStream(*os, *snapshot, cpu_ctx);
+      });
+      return;
+    }
+
+    MkDirRecursively(DirName(filename).c_str());
+
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
     std::ofstream fout(filename, std::ios::binary);
@@ -84,10 +119,6 @@ class SaveOpKernel : public framework::OpKernel<T> {
                       platform::errors::Unavailable(
                           "Cannot open %s to save variables.", filename));
 
-    auto save_as_fp16 = ctx.Attr<bool>("save_as_fp16");
-    auto in_dtype = tensor.type();
-    auto out_dtype = save_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
     if (in_dtype != out_dtype) {
       auto in_kernel_type = framework::OpKernelType(in_dtype, place);
       auto out_kernel_type = framework::OpKernelType(out_dtype, place);
@@ -120,21 +151,60 @@ class SaveOpKernel : public framework::OpKernel<T> {
       }
     }
 
+    auto mode = ctx.Attr<int>("mode");
+    framework::Variable *mode_var = ctx.scope().FindVar(LOOKUP_TABLE_SAVE_MODE);
+    if (mode_var != nullptr && mode_var->IsType<int>()) {
+      mode = mode_var->Get<int>();
+    }
+    PADDLE_ENFORCE_EQ(mode == 0 || mode == 1, true,
+                      platform::errors::InvalidArgument(
+                          "The mode of saving a SelectedRows should be 0 "
+                          "(full) or 1 (delta), but received %d.",
+                          mode));
+
+    auto &selectedRows = var->Get<framework::SelectedRows>();
+    // the updated rows are taken from the table by a delta save
+    auto *table = const_cast<framework::SelectedRows *>(&selectedRows);
+
+    // get device context from pool
+    platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
+    auto &dev_ctx = *pool.Get(place);
+
+    if (mode == 1) {
+      if (framework::SaveSparseTableDelta(filename, table, dev_ctx)) {
+        return;
+      }
+      VLOG(3) << "SaveSelectedRows starts a delta chain at " << filename;
+    }
+
+    auto &writer = framework::AsyncCheckpointWriter::Instance();
     PADDLE_ENFORCE_EQ(
-        FileExists(filename) && !overwrite, false,
+        (FileExists(filename) || writer.IsPending(filename)) && !overwrite,
+        false,
         platform::errors::PreconditionNotMet(
             "%s exists!, cannot save to it when overwrite is set to false.",
             filename, overwrite));
 
     VLOG(4) << "SaveSelectedRows get File name: " << filename;
 
-    MkDirRecursively(DirName(filename).c_str());
-
-    auto &selectedRows = var->Get<framework::SelectedRows>();
+    // the spilled rows and the base of a delta chain are saved synchronously
+    auto *spill = selectedRows.spill_file();
+    if (FLAGS_async_checkpoint && mode == 0 &&
+        (spill == nullptr || spill->Size() == 0)) {
+      framework::RemoveSparseTableChain(filename);
+      auto snapshot = std::make_shared<framework::SelectedRows>(
+          selectedRows.rows(), selectedRows.height());
+      framework::SnapshotTensor(selectedRows.value(),
+                                snapshot->mutable_value());
+      writer.Write(filename, [snapshot](std::ostream *os) {
+        auto &cpu_ctx = *platform::DeviceContextPool::Instance().Get(
+            platform::CPUPlace());
+        framework::SerializeToStream(*os, *snapshot, cpu_ctx);
+      });
+      return;
+    }
 
-    // get device context from pool
-    platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
-    auto &dev_ctx = *pool.Get(place);
+    MkDirRecursively(DirName(filename).c_str());
 
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
@@ -144,6 +214,11 @@ class SaveOpKernel : public framework::OpKernel<T> {
                           "Cannot open %s to save variables.", filename));
     framework::SerializeToStream(fout, selectedRows, dev_ctx);
     fout.close();
+    if (mode == 1) {
+      framework::StartSparseTableChain(filename, table);
+    } else {
+      framework::RemoveSparseTableChain(filename);
+    }
   }
 };
 
@@ -16,6 +16,7 @@
 
 #ifdef PADDLE_WITH_CUDA
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -220,7 +221,21 @@ class TensorRTEngineOp : public framework::OperatorBase {
       if (param_names_.count(x)) continue;
       num_inputs += 1;
     }
-    const int num_bindings = num_inputs + Outputs("Ys").size();
+    int num_bindings = num_inputs + Outputs("Ys").size();
+    // the bindings of the profile k follow the bindings of the profile k-1
+    int binding_offset = 0;
+    if (engine->with_dynamic_shape()) {
+      std::map<std::string, std::vector<int64_t>> input_shapes;
+      for (const auto &x : Inputs("Xs")) {
+        if (param_names_.count(x)) continue;
+        auto &t =
+            inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
+        input_shapes[x] = framework::vectorize<int64_t>(t.dims());
+      }
+      binding_offset = engine->SetOptimizationProfile(
+          engine->SelectOptimizationProfile(input_shapes));
+      num_bindings += binding_offset;
+    }
     std::vector<void *> buffers(num_bindings);
 
     // Bind input tensor to TRT.
@@ -231,7 +246,8 @@ class TensorRTEngineOp : public framework::OperatorBase {
           inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
       auto t_shape = framework::vectorize<int64_t>(t.dims());
       runtime_batch = t_shape[0];
-      const int bind_index = engine->engine()->getBindingIndex(x.c_str());
+      const int bind_index =
+          engine->engine()->getBindingIndex(x.c_str()) + binding_offset;
       PADDLE_ENFORCE_LT(
           bind_index, num_bindings,
           platform::errors::InvalidArgument(
@@ -274,7 +290,8 @@ class TensorRTEngineOp : public framework::OperatorBase {
     VLOG(4) << "TensorRT Engine Op Outputs:";
     for (const auto &y : Outputs("Ys")) {
       const int bind_index =
-          engine->engine()->getBindingIndex(output_maps[output_index].c_str());
+          engine->engine()->getBindingIndex(output_maps[output_index].c_str()) +
+          binding_offset;
       std::vector<int> ddim;
 
       if (!engine->with_dynamic_shape()) {
@@ -0,0 +1,134 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/bfloat16.h"
+#include <sstream>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(bfloat16, conversion_cpu) {
+  // Conversion from float
+  EXPECT_EQ(bfloat16(1.0f).x, 0x3f80);
+  EXPECT_EQ(bfloat16(0.5f).x, 0x3f00);
+  EXPECT_EQ(bfloat16(0.0f).x, 0x0000);
+  EXPECT_EQ(bfloat16(-0.0f).x, 0x8000);
+  EXPECT_EQ(bfloat16(-2.0f).x, 0xc000);
+  EXPECT_EQ(bfloat16(std::numeric_limits<float>::infinity()).x, 0x7f80);
+  EXPECT_EQ(bfloat16(std::numeric_limits<float>::max()).x, 0x7f80);
+
+  // Rounding to the nearest even
+  EXPECT_EQ(bfloat16(1.00390625f).x, 0x3f80);  // 1 + 2^-8
+  EXPECT_EQ(bfloat16(1.01171875f).x, 0x3f82);  // 1 + 3 * 2^-8
+  EXPECT_EQ(bfloat16(1.0050000f).x, 0x3f81);
+
+  // The NaN stays a NaN
+  EXPECT_TRUE(isnan(bfloat16(std::numeric_limits<float>::quiet_NaN())));
+
+  // Conversion from double, int and bool
+  EXPECT_EQ(bfloat16(0.5).x, 0x3f00);
+  EXPECT_EQ(bfloat16(-1).x, 0xbf80);
+  EXPECT_EQ(bfloat16(3).x, 0x4040);
+  EXPECT_EQ(bfloat16(true).x, 0x3f80);
+  EXPECT_EQ(bfloat16(false).x, 0x0000);
+
+  // Assignment operator
+  bfloat16 v_assign;
+  v_assign = bfloat16(0);
+  EXPECT_EQ(v_assign.x, 0x0000);
+  v_assign = 0.5f;
+  EXPECT_EQ(v_assign.x, 0x3f00);
+  v_assign = -1;
+  EXPECT_EQ(v_assign.x, 0xbf80);
+  v_assign = true;
+  EXPECT_EQ(v_assign.x, 0x3f80);
+
+  // Conversion operator
+  EXPECT_EQ(static_cast<float>(bfloat16(0.5f)), 0.5f);
+  EXPECT_NEAR(static_cast<double>(bfloat16(0.33333)), 0.33333, 0.002);
+  EXPECT_EQ(static_cast<int>(bfloat16(-1)), -1);
+  EXPECT_EQ(static_cast<bool>(bfloat16(true)), true);
+  EXPECT_EQ(static_cast<bool>(bfloat16(-0.0f)), false);
+}
+
+TEST(bfloat16, arithmetic_cpu) {
+  EXPECT_EQ(static_cast<float>(bfloat16(1) + bfloat16(1)), 2);
+  EXPECT_EQ(static_cast<float>(bfloat16(5) + bfloat16(-5)), 0);
+  EXPECT_EQ(static_cast<float>(bfloat16(0.5f) - bfloat16(1.5f)), -1);
+  EXPECT_EQ(static_cast<float>(bfloat16(2) * bfloat16(-3)), -6);
+  EXPECT_EQ(static_cast<float>(bfloat16(3) / bfloat16(2)), 1.5f);
+  EXPECT_EQ(static_cast<float>(-bfloat16(512)), -512);
+
+  bfloat16 v(1.5f);
+  v += bfloat16(0.5f);
+  v *= bfloat16(3);
+  v -= bfloat16(2);
+  v /= bfloat16(4);
+  EXPECT_EQ(static_cast<float>(v), 1);
+}
+
+TEST(bfloat16, comparison_cpu) {
+  EXPECT_TRUE(bfloat16(1.0f) == bfloat16(1.0f));
+  EXPECT_FALSE(bfloat16(-1.0f) == bfloat16(-0.5f));
+  EXPECT_TRUE(bfloat16(1.0f) != bfloat16(0.5f));
+  EXPECT_TRUE(bfloat16(-1.0f) < bfloat16(-0.5f));
+  EXPECT_TRUE(bfloat16(1.0f) <= bfloat16(1.0f));
+  EXPECT_TRUE(bfloat16(2.0f) > bfloat16(1.0f));
+  EXPECT_TRUE(bfloat16(2.0f) >= bfloat16(2.0f));
+  EXPECT_TRUE(bfloat16(0.0f) == bfloat16(-0.0f));
+}
+
+TEST(bfloat16, isinf_isnan) {
+  auto inf = std::numeric_limits<bfloat16>::infinity();
+  auto nan = std::numeric_limits<bfloat16>::quiet_NaN();
+  EXPECT_TRUE(std::isinf(inf));
+  EXPECT_TRUE(std::isinf(-inf));
+  EXPECT_FALSE(std::isinf(nan));
+  EXPECT_TRUE(std::isnan(nan));
+  EXPECT_FALSE(std::isnan(inf));
+  EXPECT_TRUE(isfinite(std::numeric_limits<bfloat16>::max()));
+  EXPECT_EQ(static_cast<float>(std::numeric_limits<bfloat16>::epsilon()),
+            1.0f / 128);
+}
+
+TEST(bfloat16, lod_tensor_eigen_cpu) {
+  framework::LoDTensor lod_tensor;
+  std::vector<bfloat16> input_data = {bfloat16(1.0f), bfloat16(0.5f),
+                                      bfloat16(0.25f), bfloat16(2.0f)};
+  bfloat16* data = lod_tensor.mutable_data<bfloat16>(
+      framework::make_ddim({2, 2}), CPUPlace());
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    data[i] = input_data[i];
+  }
+  EXPECT_EQ(lod_tensor.type(), framework::proto::VarType::BF16);
+
+  auto x = framework::EigenVector<bfloat16>::Flatten(lod_tensor);
+  framework::Tensor sum;
+  sum.mutable_data<bfloat16>(framework::make_ddim({1}), CPUPlace());
+  auto y = framework::EigenScalar<bfloat16>::From(sum);
+  y = x.sum();
+  EXPECT_EQ(static_cast<float>(sum.data<bfloat16>()[0]), 3.75f);
+}
+
+TEST(bfloat16, print) {
+  std::stringstream ss;
+  ss << bfloat16(-1.5f);
+  EXPECT_EQ(ss.str(), "-1.5");
+}
+
+}  // namespace platform
+}  // namespace paddle
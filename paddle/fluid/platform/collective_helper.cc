@@ -15,9 +15,12 @@
 #if defined(PADDLE_WITH_NCCL)
 #include "paddle/fluid/platform/collective_helper.h"
 
+#include <algorithm>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 
+#include "paddle/fluid/platform/cuda_device_guard.h"
 #include "paddle/fluid/platform/dynload/nccl.h"
 
 namespace paddle {
@@ -47,12 +50,110 @@ class NCCLCommImpl : public NCCLComm {
     dev_ctx_ = std::move(dev_ctx);
   }
 
+  void WaitCalcStream(cudaStream_t calc_stream) override {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (calc_event_ == nullptr) calc_event_ = CreateEvent();
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(calc_event_, calc_stream));
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaStreamWaitEvent(stream(), calc_event_, 0));
+  }
+
+  void RecordVarEvent(const void* var) override {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& var_event = var_events_[var];
+    if (var_event.event == nullptr) var_event.event = AcquireEvent();
+    var_event.seq = ++record_seq_;
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(var_event.event, stream()));
+  }
+
+  void CalcStreamWaitVars(const std::vector<const void*>& vars,
+                          cudaStream_t calc_stream) override {
+    std::lock_guard<std::mutex> lock(mtx_);
+    uint64_t waited_seq = 0;
+    for (auto* var : vars) {
+      auto it = var_events_.find(var);
+      if (it == var_events_.end()) continue;
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaStreamWaitEvent(calc_stream, it->second.event, 0));
+      waited_seq = std::max(waited_seq, it->second.seq);
+    }
+    if (waited_seq == 0) {
+      if (comm_event_ == nullptr) comm_event_ = CreateEvent();
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(comm_event_, stream()));
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaStreamWaitEvent(calc_stream, comm_event_, 0));
+      waited_seq = record_seq_;
+    }
+    // The events are consumed. The work recorded before the last waited event
+    // on the communication stream is waited for as well, so its events are
+    // dropped too. Otherwise the events of the vars in the per step scopes
+    // pile up, and a var allocated at a freed address later would wait for a
+    // stale event instead of the whole stream.
+    for (auto it = var_events_.begin(); it != var_events_.end();) {
+      if (it->second.seq <= waited_seq) {
+        free_events_.push_back(it->second.event);
+        it = var_events_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  size_t NumVarEvents() const override {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return var_events_.size();
+  }
+
+  ~NCCLCommImpl() {
+    if (dev_ctx_ == nullptr) return;
+    CUDADeviceGuard guard(device_id());
+    for (auto& pair : var_events_) {
+      cudaEventDestroy(pair.second.event);
+    }
+    for (auto event : free_events_) {
+      cudaEventDestroy(event);
+    }
+    if (calc_event_ != nullptr) cudaEventDestroy(calc_event_);
+    if (comm_event_ != nullptr) cudaEventDestroy(comm_event_);
+  }
+
  private:
+  cudaEvent_t CreateEvent() {
+    CUDADeviceGuard guard(device_id());
+    cudaEvent_t event;
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    return event;
+  }
+
+  cudaEvent_t AcquireEvent() {
+    if (free_events_.empty()) return CreateEvent();
+    auto event = free_events_.back();
+    free_events_.pop_back();
+    return event;
+  }
+
+  struct VarEvent {
+    cudaEvent_t event{nullptr};
+    // the order of the record on the communication stream
+    uint64_t seq{0};
+  };
+
   int ring_id_;
   int nranks_;
   int rank_;
   ncclComm_t comm_;
   std::unique_ptr<CUDADeviceContext> dev_ctx_;
+
+  mutable std::mutex mtx_;
+  cudaEvent_t calc_event_{nullptr};
+  cudaEvent_t comm_event_{nullptr};
+  // the completion events of the collective ops not waited for yet, by the
+  // written var
+  std::unordered_map<const void*, VarEvent> var_events_;
+  uint64_t record_seq_{0};
+  // the consumed events, to be recorded again
+  std::vector<cudaEvent_t> free_events_;
 };
 
 NCCLComm* NCCLCommContext::CreateNCCLComm(ncclUniqueId* nccl_id, int nranks,
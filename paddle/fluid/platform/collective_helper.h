@@ -55,6 +55,24 @@ class NCCLComm {
   virtual int device_id() const = 0;
   virtual ncclComm_t comm() const = 0;
   virtual cudaStream_t stream() const = 0;
+
+  // The collective ops running on the communication stream are ordered with
+  // the calculation stream by CUDA events instead of stream synchronization,
+  // so that the communication overlaps the calculation.
+  //
+  // Make the communication stream wait for the work enqueued to calc_stream
+  // so far, which includes the producers of the inputs of the next op.
+  virtual void WaitCalcStream(cudaStream_t calc_stream) = 0;
+  // Record the completion event of the op enqueued last, which writes var.
+  virtual void RecordVarEvent(const void* var) = 0;
+  // Make calc_stream wait for the completion events of vars. If none of vars
+  // is written by this communicator, wait for all the enqueued work. The
+  // events waited for are consumed, a var has to be recorded again.
+  virtual void CalcStreamWaitVars(const std::vector<const void*>& vars,
+                                  cudaStream_t calc_stream) = 0;
+  // The number of the recorded var events not waited for yet.
+  virtual size_t NumVarEvents() const = 0;
+
   virtual ~NCCLComm() = default;
 };
 
@@ -0,0 +1,193 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/comm_stats.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <sstream>
+#include "glog/logging.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+// the steps kept by the CommStats
+constexpr size_t kMaxSteps = 1000;
+
+uint64_t NowInNsec() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Accumulate(const CommStat& from, CommStat* to) {
+  ++to->calls;
+  to->nranks = from.nranks;
+  to->bytes += from.bytes;
+  to->wait_ms += from.wait_ms;
+  to->transfer_ms += from.transfer_ms;
+  to->max_transfer_ms = std::max(to->max_transfer_ms, from.transfer_ms);
+}
+
+}  // namespace
+
+double CommStat::AlgorithmBandwidth() const {
+  return transfer_ms > 0. ? bytes / transfer_ms / 1e6 : 0.;
+}
+
+double CommStat::BusBandwidth() const {
+  double n = nranks;
+  double factor = 1.;
+  if (kind == "allreduce") {
+    factor = n > 1 ? 2. * (n - 1) / n : 1.;
+  } else if (kind == "allgather" || kind == "reducescatter") {
+    factor = n > 1 ? (n - 1) / n : 1.;
+  }
+  return AlgorithmBandwidth() * factor;
+}
+
+std::atomic<bool> CommStats::enabled_{false};
+
+CommStats& CommStats::Instance() {
+  static CommStats stats;
+  return stats;
+}
+
+void CommStats::Enable() {
+  Reset();
+  enabled_.store(true);
+}
+
+void CommStats::Reset() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  buckets_.clear();
+  steps_.clear();
+  step_ = 0;
+  current_step_ = CommStat();
+}
+
+void CommStats::Record(const std::string& kind, const std::string& bucket,
+                       int nranks, size_t bytes, double wait_ms,
+                       double transfer_ms) {
+  CommStat record;
+  record.kind = kind;
+  record.nranks = nranks;
+  record.bytes = bytes;
+  record.wait_ms = wait_ms;
+  record.transfer_ms = transfer_ms;
+  VLOG(10) << kind << " of " << bucket << ": " << bytes << " bytes, wait "
+           << wait_ms << "ms, transfer " << transfer_ms << "ms";
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& stat = buckets_[std::make_pair(kind, bucket)];
+  stat.kind = kind;
+  stat.bucket = bucket;
+  Accumulate(record, &stat);
+  Accumulate(record, &current_step_);
+}
+
+void CommStats::EndStep() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++step_;
+  if (current_step_.calls == 0) return;
+  current_step_.kind = "step";
+  current_step_.bucket = std::to_string(step_);
+  steps_.push_back(current_step_);
+  if (steps_.size() > kMaxSteps) steps_.pop_front();
+  current_step_ = CommStat();
+}
+
+std::vector<CommStat> CommStats::BucketStats() const {
+  std::vector<CommStat> stats;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& pair : buckets_) stats.push_back(pair.second);
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const CommStat& a, const CommStat& b) {
+              return a.transfer_ms > b.transfer_ms;
+            });
+  return stats;
+}
+
+std::vector<CommStat> CommStats::StepStats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return std::vector<CommStat>(steps_.begin(), steps_.end());
+}
+
+std::string CommStats::Report() const {
+  auto stats = BucketStats();
+  std::stringstream ss;
+  ss << "------------------------->     Communication Report     "
+        "<-------------------------\n\n";
+  ss << std::left << std::setw(16) << "Collective" << std::setw(40) << "Bucket"
+     << std::setw(8) << "Ranks" << std::setw(10) << "Calls" << std::setw(14)
+     << "MB/call" << std::setw(14) << "Wait(ms)" << std::setw(14)
+     << "Transfer(ms)" << std::setw(14) << "Max(ms)" << std::setw(14)
+     << "AlgBW(GB/s)"
+     << "BusBW(GB/s)\n";
+  for (auto& stat : stats) {
+    ss << std::left << std::setw(16) << stat.kind << std::setw(40)
+       << stat.bucket << std::setw(8) << stat.nranks << std::setw(10)
+       << stat.calls << std::setw(14)
+       << stat.bytes / 1024. / 1024. / stat.calls << std::setw(14)
+       << stat.wait_ms << std::setw(14) << stat.transfer_ms << std::setw(14)
+       << stat.max_transfer_ms << std::setw(14) << stat.AlgorithmBandwidth()
+       << stat.BusBandwidth() << "\n";
+  }
+  return ss.str();
+}
+
+RecordComm::RecordComm(const std::string& name, const std::string& kind,
+                       const std::string& bucket, int nranks, size_t bytes,
+                       std::function<void()> sync) {
+  if (!CommStats::IsEnabled()) return;
+  is_enabled_ = true;
+  name_ = name;
+  kind_ = kind;
+  bucket_ = bucket;
+  nranks_ = nranks;
+  bytes_ = bytes;
+  sync_ = std::move(sync);
+  start_ns_ = NowInNsec();
+  event_.reset(new RecordEvent(name_ + "/comm_wait", EventRole::kInnerOp));
+}
+
+void RecordComm::BeginTransfer() {
+  if (!is_enabled_) return;
+  // the inputs are ready on the streams after the sync
+  if (sync_) sync_();
+  event_.reset();
+  transfer_ns_ = NowInNsec();
+  event_.reset(
+      new RecordEvent(name_ + "/comm_transfer", EventRole::kInnerOp));
+}
+
+RecordComm::~RecordComm() {}
+
+void RecordComm::EndTransfer() {
+  if (!is_enabled_ || transfer_ns_ == 0) return;
+  if (sync_) sync_();
+  event_.reset();
+  uint64_t end_ns = NowInNsec();
+  CommStats::Instance().Record(kind_, bucket_, nranks_, bytes_,
+                               (transfer_ns_ - start_ns_) / 1e6,
+                               (end_ns - transfer_ns_) / 1e6);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,124 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+class RecordEvent;
+
+// The aggregated calls of a collective of a bucket, or of a step.
+struct CommStat {
+  std::string kind;
+  // the variables communicated, or the step
+  std::string bucket;
+  int nranks{1};
+  int64_t calls{0};
+  size_t bytes{0};
+  // the time waiting for the inputs before the transfers
+  double wait_ms{0.};
+  double transfer_ms{0.};
+  double max_transfer_ms{0.};
+
+  // bytes / transfer time
+  double AlgorithmBandwidth() const;
+  // The algorithm bandwidth scaled by the data each rank transfers in the
+  // ring algorithm, comparable to the peak bandwidth of the links, e.g.
+  // 2(n-1)/n for allreduce.
+  double BusBandwidth() const;
+};
+
+/*
+ * The metrics of the collective communication of the all reduce op handles
+ * and the collective ops, aggregated by bucket and by step.
+ *
+ * The streams are synchronized before and after each collective while it is
+ * enabled, so that the waiting and the transferring time are separated. It
+ * serializes the communication with the computation, so the step time is
+ * longer than that without the metrics.
+ */
+class CommStats {
+ public:
+  static CommStats& Instance();
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+  void Enable();
+  void Disable() { enabled_.store(false); }
+  void Reset();
+
+  void Record(const std::string& kind, const std::string& bucket,
+              int nranks, size_t bytes, double wait_ms, double transfer_ms);
+  // Close the totals of the current step, called by RecordStep.
+  void EndStep();
+
+  // In the descending order of the transfer time.
+  std::vector<CommStat> BucketStats() const;
+  // The totals of the latest steps, the kind is "step".
+  std::vector<CommStat> StepStats() const;
+
+  std::string Report() const;
+
+ private:
+  CommStats() = default;
+
+  static std::atomic<bool> enabled_;
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<std::string, std::string>, CommStat> buckets_;
+  int64_t step_{0};
+  CommStat current_step_;
+  std::deque<CommStat> steps_;
+};
+
+// Record a collective, with the sync which synchronizes the streams of the
+// collective, if the CommStats is enabled. The time waiting ends at
+// BeginTransfer, and the transfer at EndTransfer, a collective failed in
+// between is not recorded.
+class RecordComm {
+ public:
+  RecordComm(const std::string& name, const std::string& kind,
+             const std::string& bucket, int nranks, size_t bytes,
+             std::function<void()> sync);
+  ~RecordComm();
+
+  void BeginTransfer();
+  void EndTransfer();
+
+ private:
+  bool is_enabled_{false};
+  std::string name_;
+  std::string kind_;
+  std::string bucket_;
+  int nranks_;
+  size_t bytes_;
+  std::function<void()> sync_;
+  uint64_t start_ns_{0};
+  uint64_t transfer_ns_{0};
+  std::unique_ptr<RecordEvent> event_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,107 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/comm_stats.h"
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(CommStats, aggregate_buckets_and_steps) {
+  auto& stats = CommStats::Instance();
+  stats.Enable();
+  stats.Record("allreduce", "fc_0.w_0@GRAD", 4, 1 << 20, 0.5, 1.);
+  stats.Record("allreduce", "fc_0.w_0@GRAD", 4, 1 << 20, 0.5, 3.);
+  stats.Record("allgather", "fc_0.b_0", 4, 1 << 10, 0., 0.1);
+  stats.EndStep();
+  // the steps without collectives are not kept
+  stats.EndStep();
+  stats.Record("allreduce", "fc_0.w_0@GRAD", 4, 1 << 20, 0.5, 2.);
+  stats.EndStep();
+
+  auto buckets = stats.BucketStats();
+  ASSERT_EQ(buckets.size(), 2UL);
+  EXPECT_EQ(buckets[0].kind, "allreduce");
+  EXPECT_EQ(buckets[0].calls, 3);
+  EXPECT_EQ(buckets[0].bytes, 3UL << 20);
+  EXPECT_DOUBLE_EQ(buckets[0].wait_ms, 1.5);
+  EXPECT_DOUBLE_EQ(buckets[0].transfer_ms, 6.);
+  EXPECT_DOUBLE_EQ(buckets[0].max_transfer_ms, 3.);
+
+  auto steps = stats.StepStats();
+  ASSERT_EQ(steps.size(), 2UL);
+  EXPECT_EQ(steps[0].kind, "step");
+  EXPECT_EQ(steps[0].bucket, "1");
+  EXPECT_EQ(steps[0].calls, 3);
+  EXPECT_EQ(steps[1].bucket, "3");
+  EXPECT_DOUBLE_EQ(steps[1].transfer_ms, 2.);
+
+  EXPECT_NE(stats.Report().find("fc_0.w_0@GRAD"), std::string::npos);
+  stats.Disable();
+}
+
+TEST(CommStats, bus_bandwidth) {
+  CommStat stat;
+  stat.nranks = 4;
+  stat.bytes = 1000000000;
+  stat.transfer_ms = 1000.;
+  EXPECT_DOUBLE_EQ(stat.AlgorithmBandwidth(), 1.);
+  stat.kind = "allreduce";
+  EXPECT_DOUBLE_EQ(stat.BusBandwidth(), 1.5);
+  stat.kind = "allgather";
+  EXPECT_DOUBLE_EQ(stat.BusBandwidth(), 0.75);
+  stat.kind = "broadcast";
+  EXPECT_DOUBLE_EQ(stat.BusBandwidth(), 1.);
+  stat.nranks = 1;
+  stat.kind = "allreduce";
+  EXPECT_DOUBLE_EQ(stat.BusBandwidth(), 1.);
+}
+
+TEST(CommStats, record_comm) {
+  auto& stats = CommStats::Instance();
+  int syncs = 0;
+  {
+    // not recorded when disabled
+    RecordComm record("all_reduce", "allreduce", "x", 2, 64,
+                      [&syncs] { ++syncs; });
+    record.BeginTransfer();
+    record.EndTransfer();
+  }
+  EXPECT_EQ(syncs, 0);
+
+  stats.Enable();
+  {
+    RecordComm record("all_reduce", "allreduce", "x", 2, 64,
+                      [&syncs] { ++syncs; });
+    record.BeginTransfer();
+    record.EndTransfer();
+  }
+  {
+    // failed before the transfer
+    RecordComm record("all_reduce", "allreduce", "x", 2, 64,
+                      [&syncs] { ++syncs; });
+  }
+  EXPECT_EQ(syncs, 2);
+  auto buckets = stats.BucketStats();
+  ASSERT_EQ(buckets.size(), 1UL);
+  EXPECT_EQ(buckets[0].bucket, "x");
+  EXPECT_EQ(buckets[0].calls, 1);
+  EXPECT_EQ(buckets[0].bytes, 64UL);
+  stats.Disable();
+}
+
+}  // namespace platform
+}  // namespace paddle
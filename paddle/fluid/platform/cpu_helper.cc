@@ -13,8 +13,21 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/cpu_helper.h"
+#include <algorithm>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
 #include "paddle/fluid/platform/enforce.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#endif
+
 #ifdef PADDLE_WITH_MKLML
 #include <omp.h>
 #include "paddle/fluid/platform/dynload/mklml.h"
@@ -24,6 +37,10 @@ limitations under the License. */
 #include <cblas.h>
 #endif
 
+DECLARE_string(compute_thread_cpus);
+DECLARE_string(io_thread_cpus);
+DECLARE_string(comm_thread_cpus);
+
 namespace paddle {
 namespace platform {
 
@@ -47,5 +64,196 @@ void SetNumThreads(int num_threads) {
 #endif
 }
 
+void SetThreadLocalNumThreads(int num_threads) {
+#ifdef PADDLE_WITH_MKLML
+  int real_num_threads = num_threads > 1 ? num_threads : 1;
+  platform::dynload::MKL_Set_Num_Threads_Local(real_num_threads);
+  // the nthreads-var of OpenMP is per thread
+  omp_set_num_threads(real_num_threads);
+#else
+  SetNumThreads(num_threads);
+#endif
+}
+
+#if defined(__linux__)
+static const char kNumaNodePath[] = "/sys/devices/system/node/node";
+
+// Parse the cpu list like "0-3,8,10-11" in sysfs.
+static std::vector<int> ParseCPUList(const std::string &list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos) end = list.size();
+    std::string range = list.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last =
+          dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    } catch (...) {
+      // Skip the malformed range, e.g. the trailing newline.
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+#endif
+
+int GetNumaNodeCount() {
+#if defined(__linux__)
+  static int num_nodes = [] {
+    int n = 0;
+    while (std::ifstream(kNumaNodePath + std::to_string(n) + "/cpulist")) {
+      ++n;
+    }
+    return n > 0 ? n : 1;
+  }();
+  return num_nodes;
+#else
+  return 1;
+#endif
+}
+
+int GetCurrentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif
+  return 0;
+}
+
+bool BindThreadToNumaNode(int node) {
+#if defined(__linux__)
+  std::ifstream fin(kNumaNodePath + std::to_string(node) + "/cpulist");
+  std::string list;
+  if (!fin || !std::getline(fin, list)) {
+    VLOG(1) << "Failed to read the CPUs of NUMA node " << node;
+    return false;
+  }
+  if (!BindThreadToCPUs(ParseCPUList(list))) {
+    VLOG(1) << "Failed to bind the thread to NUMA node " << node;
+    return false;
+  }
+  VLOG(3) << "Bind the thread to NUMA node " << node << " with CPUs " << list;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool BindThreadToCPUs(const std::vector<int> &cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) return false;
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &mask);
+  }
+  if (-1 == sched_setaffinity(0, sizeof(mask), &mask)) {
+    VLOG(1) << "Failed to bind the thread to " << cpus.size() << " CPUs";
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+static constexpr int kNumThreadKinds = 3;
+
+static std::mutex &ThreadKindMutex() {
+  static std::mutex mtx;
+  return mtx;
+}
+
+// The CPUs set by SetThreadKindCPUs, which override the flags.
+static std::vector<std::pair<bool, std::string>> &ThreadKindCPUs() {
+  static std::vector<std::pair<bool, std::string>> cpus(kNumThreadKinds);
+  return cpus;
+}
+
+static std::string GetThreadKindCPUs(ThreadKind kind) {
+  auto &cpus = ThreadKindCPUs()[static_cast<int>(kind)];
+  if (cpus.first) return cpus.second;
+  switch (kind) {
+    case ThreadKind::kCompute:
+      return FLAGS_compute_thread_cpus;
+    case ThreadKind::kIO:
+      return FLAGS_io_thread_cpus;
+    default:
+      return FLAGS_comm_thread_cpus;
+  }
+}
+
+void SetThreadKindCPUs(ThreadKind kind, const std::string &cpus) {
+  std::lock_guard<std::mutex> guard(ThreadKindMutex());
+#if defined(__linux__)
+  auto new_cpus = ParseCPUList(cpus);
+  for (int other = 0; other < kNumThreadKinds; ++other) {
+    if (other == static_cast<int>(kind)) continue;
+    auto other_cpus =
+        ParseCPUList(GetThreadKindCPUs(static_cast<ThreadKind>(other)));
+    for (int cpu : new_cpus) {
+      PADDLE_ENFORCE_EQ(
+          std::find(other_cpus.begin(), other_cpus.end(), cpu) ==
+              other_cpus.end(),
+          true, platform::errors::InvalidArgument(
+                    "The CPUs of the kinds of threads must be disjoint, but "
+                    "CPU %d of %s is already used by the other threads.",
+                    cpu, cpus));
+    }
+  }
+#endif
+  ThreadKindCPUs()[static_cast<int>(kind)] = std::make_pair(true, cpus);
+}
+
+bool BindThreadToKind(ThreadKind kind, int index) {
+#if defined(__linux__)
+  std::string list;
+  {
+    std::lock_guard<std::mutex> guard(ThreadKindMutex());
+    list = GetThreadKindCPUs(kind);
+  }
+  auto cpus = ParseCPUList(list);
+  if (cpus.empty()) return false;
+
+  // The NUMA node of every CPU.
+  static std::map<int, int> cpu_nodes = [] {
+    std::map<int, int> nodes;
+    for (int node = 0; node < GetNumaNodeCount(); ++node) {
+      std::ifstream fin(kNumaNodePath + std::to_string(node) + "/cpulist");
+      std::string node_list;
+      if (!fin || !std::getline(fin, node_list)) continue;
+      for (int cpu : ParseCPUList(node_list)) nodes[cpu] = node;
+    }
+    return nodes;
+  }();
+  std::map<int, std::vector<int>> node_cpus;
+  for (int cpu : cpus) {
+    auto it = cpu_nodes.find(cpu);
+    node_cpus[it == cpu_nodes.end() ? 0 : it->second].push_back(cpu);
+  }
+
+  auto it = node_cpus.begin();
+  std::advance(it, index % node_cpus.size());
+  std::vector<int> bound_cpus = it->second;
+  if (kind == ThreadKind::kCompute) {
+    int cpu = bound_cpus[(index / node_cpus.size()) % bound_cpus.size()];
+    bound_cpus = {cpu};
+  }
+  if (!BindThreadToCPUs(bound_cpus)) return false;
+  VLOG(3) << "Bind thread " << index << " of kind " << static_cast<int>(kind)
+          << " to " << bound_cpus.size() << " CPUs on NUMA node "
+          << it->first;
+  return true;
+#else
+  return false;
+#endif
+}
+
 }  // namespace platform
 }  // namespace paddle
@@ -15,6 +15,8 @@ limitations under the License. */
 #pragma once
 
 #include <stddef.h>
+#include <string>
+#include <vector>
 
 namespace paddle {
 namespace platform {
@@ -22,5 +24,41 @@ namespace platform {
 //! Set the number of threads in use.
 void SetNumThreads(int num_threads);
 
+// Set the number of threads of the math library for the calling thread only,
+// so that the threads with different settings do not interfere. It is the
+// same as SetNumThreads if the library has no thread local setting.
+void SetThreadLocalNumThreads(int num_threads);
+
+// The number of NUMA nodes of the host, 1 if NUMA is not supported.
+int GetNumaNodeCount();
+
+// The NUMA node of the CPU which the calling thread is running on.
+int GetCurrentNumaNode();
+
+// Bind the calling thread to the CPUs of the NUMA node, so that the memory
+// the thread touches first is placed on the node. Returns false if failed.
+bool BindThreadToNumaNode(int node);
+
+// Bind the calling thread to the CPUs. The threads it creates later, e.g.
+// the OpenMP threads of its parallel regions, inherit the CPUs. Returns false
+// if failed.
+bool BindThreadToCPUs(const std::vector<int> &cpus);
+
+// The kinds of the threads which run on the disjoint sets of CPUs, set by
+// FLAGS_compute_thread_cpus, FLAGS_io_thread_cpus and FLAGS_comm_thread_cpus
+// or SetThreadKindCPUs, so that they do not migrate and disturb each other.
+enum class ThreadKind { kCompute = 0, kIO = 1, kComm = 2 };
+
+// Set the CPUs of a kind of threads in the format of "0-3,8,10-11", which
+// overrides the flag of the kind. Empty means the threads are not bound.
+void SetThreadKindCPUs(ThreadKind kind, const std::string &cpus);
+
+// Bind the calling thread, the index-th thread of the kind, to the CPUs of
+// the kind. The threads take the NUMA nodes of the CPUs in turn. A compute
+// thread is bound to one CPU on its node, an IO or a communication thread to
+// all the CPUs of the kind on its node since there are usually more of them
+// than the CPUs. Returns false if the kind has no CPUs or failed.
+bool BindThreadToKind(ThreadKind kind, int index);
+
 }  // namespace platform
 }  // namespace paddle
@@ -13,6 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/cpu_helper.h"
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#include <string>
+#include <thread>  // NOLINT
 
 #include "gtest/gtest.h"
 
@@ -20,3 +25,53 @@ TEST(CpuHelper, SetNumThread) {
   paddle::platform::SetNumThreads(1);
   paddle::platform::SetNumThreads(4);
 }
+
+TEST(CpuHelper, NumaNode) {
+  int num_nodes = paddle::platform::GetNumaNodeCount();
+  EXPECT_GE(num_nodes, 1);
+  int node = paddle::platform::GetCurrentNumaNode();
+  EXPECT_GE(node, 0);
+  EXPECT_LT(node, num_nodes);
+  paddle::platform::BindThreadToNumaNode(node);
+  EXPECT_EQ(paddle::platform::GetCurrentNumaNode(), node);
+}
+
+#if defined(__linux__)
+TEST(CpuHelper, BindThreadToCPUs) {
+  std::thread t([] {
+    paddle::platform::SetThreadLocalNumThreads(2);
+    int cpu = sched_getcpu();
+    ASSERT_GE(cpu, 0);
+    EXPECT_TRUE(paddle::platform::BindThreadToCPUs({cpu}));
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    EXPECT_EQ(CPU_COUNT(&mask), 1);
+    EXPECT_TRUE(CPU_ISSET(cpu, &mask));
+  });
+  t.join();
+  EXPECT_FALSE(paddle::platform::BindThreadToCPUs({}));
+}
+
+TEST(CpuHelper, BindThreadToKind) {
+  using paddle::platform::ThreadKind;
+  std::thread t([] {
+    EXPECT_FALSE(paddle::platform::BindThreadToKind(ThreadKind::kIO, 0));
+    int cpu = sched_getcpu();
+    ASSERT_GE(cpu, 0);
+    paddle::platform::SetThreadKindCPUs(ThreadKind::kCompute,
+                                        std::to_string(cpu));
+    // The CPUs of the kinds must be disjoint.
+    EXPECT_ANY_THROW(paddle::platform::SetThreadKindCPUs(
+        ThreadKind::kIO, std::to_string(cpu)));
+    EXPECT_TRUE(paddle::platform::BindThreadToKind(ThreadKind::kCompute, 3));
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    EXPECT_EQ(CPU_COUNT(&mask), 1);
+    EXPECT_TRUE(CPU_ISSET(cpu, &mask));
+    paddle::platform::SetThreadKindCPUs(ThreadKind::kCompute, "");
+  });
+  t.join();
+}
+#endif
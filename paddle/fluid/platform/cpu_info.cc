@@ -43,6 +43,14 @@ DECLARE_double(fraction_of_cuda_pinned_memory_to_use);
 // should set false to use_pinned_memory.
 DEFINE_bool(use_pinned_memory, true, "If set, allocate cpu pinned memory.");
 
+// If huge_page_threshold_mb > 0, the CPU and CUDA pinned allocations which
+// are not smaller than it are backed by huge pages, which reduces the TLB
+// misses when accessing large buffers randomly, e.g., the embedding tables.
+// hugetlbfs pages are used if reserved, otherwise transparent huge pages.
+DEFINE_uint64(huge_page_threshold_mb, 0,
+              "The CPU allocations not smaller than it (in MB) are backed by "
+              "huge pages. 0 means no allocation uses huge pages.");
+
 namespace paddle {
 namespace platform {
 
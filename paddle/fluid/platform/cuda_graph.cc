@@ -0,0 +1,152 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/cuda_graph.h"
+#include <utility>
+#include "glog/logging.h"
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+std::mutex CUDAGraph::capturing_mutex_;
+std::unique_ptr<CUDAGraph> CUDAGraph::capturing_graph_;
+std::atomic<bool> CUDAGraph::capturing_{false};
+std::thread::id CUDAGraph::capturing_thread_id_;
+
+static std::atomic<int64_t> cuda_graph_id{0};
+
+bool CUDAGraph::IsSupported() {
+#if CUDA_VERSION >= 10010
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CUDAGraph::BeginCapture(const CUDAPlace& place, cudaStream_t stream) {
+#if CUDA_VERSION >= 10010
+  std::lock_guard<std::mutex> guard(capturing_mutex_);
+  if (capturing_graph_ != nullptr) return false;
+
+  std::unique_ptr<CUDAGraph> graph(new CUDAGraph());
+  graph->place_ = place;
+  graph->stream_ = stream;
+  graph->id_ = ++cuda_graph_id;
+
+  CUDADeviceGuard device_guard(place.device);
+  // The relaxed mode allows cudaMalloc, which is called when the memory pool
+  // of the graph grows.
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaStreamBeginCapture(stream, cudaStreamCaptureModeRelaxed));
+  capturing_graph_ = std::move(graph);
+  capturing_thread_id_ = std::this_thread::get_id();
+  capturing_.store(true, std::memory_order_release);
+  VLOG(3) << "Begin capturing CUDA Graph " << capturing_graph_->id_
+          << " on CUDAPlace(" << place.device << ")";
+  return true;
+#else
+  PADDLE_THROW(platform::errors::Unavailable(
+      "CUDA Graph needs CUDA 10.1 or higher, but Paddle is compiled with "
+      "CUDA %d.",
+      CUDA_VERSION));
+#endif
+}
+
+std::unique_ptr<CUDAGraph> CUDAGraph::EndCapture() {
+  std::unique_ptr<CUDAGraph> graph;
+  {
+    std::lock_guard<std::mutex> guard(capturing_mutex_);
+    PADDLE_ENFORCE_EQ(IsThisThreadCapturing(), true,
+                      platform::errors::PreconditionNotMet(
+                          "No CUDA Graph is being captured by this thread."));
+    graph = std::move(capturing_graph_);
+    capturing_.store(false, std::memory_order_release);
+  }
+
+#if CUDA_VERSION >= 10010
+  CUDADeviceGuard device_guard(graph->place_.device);
+  auto result = cudaStreamEndCapture(graph->stream_, &graph->graph_);
+  if (result == cudaSuccess) {
+    result = cudaGraphInstantiate(&graph->exec_graph_, graph->graph_, nullptr,
+                                  nullptr, 0);
+  }
+  if (result != cudaSuccess) {
+    // Clear the error so that it is not caught by the following calls.
+    cudaGetLastError();
+    graph->Reset();
+    PADDLE_ENFORCE_CUDA_SUCCESS(result);
+  }
+  VLOG(3) << "End capturing CUDA Graph " << graph->id_;
+#endif
+  return graph;
+}
+
+int64_t CUDAGraph::CapturingID() {
+  PADDLE_ENFORCE_EQ(IsCapturing(), true,
+                    platform::errors::PreconditionNotMet(
+                        "No CUDA Graph is being captured."));
+  return capturing_graph_->id_;
+}
+
+CUDAPlace CUDAGraph::CapturingPlace() {
+  PADDLE_ENFORCE_EQ(IsCapturing(), true,
+                    platform::errors::PreconditionNotMet(
+                        "No CUDA Graph is being captured."));
+  return capturing_graph_->place_;
+}
+
+void CUDAGraph::AddResetCallbackDuringCapturing(
+    std::function<void()> callback) {
+  PADDLE_ENFORCE_EQ(IsThisThreadCapturing(), true,
+                    platform::errors::PreconditionNotMet(
+                        "No CUDA Graph is being captured by this thread."));
+  capturing_graph_->reset_callbacks_.emplace_back(std::move(callback));
+}
+
+void CUDAGraph::Replay() {
+#if CUDA_VERSION >= 10010
+  PADDLE_ENFORCE_EQ(is_reset_, false,
+                    platform::errors::PreconditionNotMet(
+                        "The CUDA Graph %d has been reset.", id_));
+  CUDADeviceGuard device_guard(place_.device);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaGraphLaunch(exec_graph_, stream_));
+#endif
+}
+
+void CUDAGraph::Reset() {
+  if (is_reset_) return;
+#if CUDA_VERSION >= 10010
+  CUDADeviceGuard device_guard(place_.device);
+  // Wait for the replayed kernels, which may still use the memory pool.
+  if (exec_graph_ != nullptr) {
+    cudaStreamSynchronize(stream_);
+    cudaGraphExecDestroy(exec_graph_);
+    exec_graph_ = nullptr;
+  }
+  if (graph_ != nullptr) {
+    cudaGraphDestroy(graph_);
+    graph_ = nullptr;
+  }
+#endif
+  for (auto& callback : reset_callbacks_) {
+    callback();
+  }
+  reset_callbacks_.clear();
+  is_reset_ = true;
+}
+
+}  // namespace platform
+}  // namespace paddle
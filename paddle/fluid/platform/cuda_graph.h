@@ -0,0 +1,109 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace platform {
+
+/**
+ * CUDAGraph records the kernels and memory copies launched on a stream by
+ * one thread between BeginCapture and EndCapture, without running them, and
+ * launches all of them at once by Replay. The replayed kernels access the
+ * same addresses as captured, so:
+ *
+ * - The memory allocated by the capturing thread while capturing comes from
+ *   a memory pool of the graph in AllocatorFacade, which is not used by
+ *   anyone else until the graph is reset.
+ * - The caller should keep the other tensors used by the graph, e.g. the
+ *   inputs and outputs, at the same addresses.
+ *
+ * Only one graph can be captured at a time in the process. It needs CUDA 10.1
+ * or higher.
+ */
+class CUDAGraph {
+ public:
+  ~CUDAGraph() { Reset(); }
+
+  static bool IsSupported();
+
+  // Start capturing the work launched on `stream` of `place` by the current
+  // thread. Returns false if another graph is being captured.
+  static bool BeginCapture(const CUDAPlace& place, cudaStream_t stream);
+
+  // Finish capturing and instantiate the graph. If capturing fails, e.g.
+  // because an operation which is not allowed while capturing, like
+  // synchronizing the stream, is called, the graph is reset and an
+  // exception is thrown.
+  static std::unique_ptr<CUDAGraph> EndCapture();
+
+  static bool IsCapturing() {
+    return capturing_.load(std::memory_order_acquire);
+  }
+
+  // Whether the current thread is capturing a graph, which is checked on
+  // every allocation, so it should be fast.
+  static bool IsThisThreadCapturing() {
+    return IsCapturing() && capturing_thread_id_ == std::this_thread::get_id();
+  }
+
+  // The ID and the place of the graph being captured.
+  static int64_t CapturingID();
+  static CUDAPlace CapturingPlace();
+
+  // Add a callback called when the graph being captured is reset, e.g. to
+  // release the memory pool of the graph.
+  static void AddResetCallbackDuringCapturing(std::function<void()> callback);
+
+  void Replay();
+
+  // Destroy the graph and call the reset callbacks. The graph cannot be
+  // replayed after being reset.
+  void Reset();
+
+  int64_t ID() const { return id_; }
+
+ private:
+  CUDAGraph() = default;
+
+ private:
+  cudaGraph_t graph_{nullptr};
+  cudaGraphExec_t exec_graph_{nullptr};
+  cudaStream_t stream_{nullptr};
+  CUDAPlace place_;
+  int64_t id_{0};
+  bool is_reset_{false};
+  std::vector<std::function<void()>> reset_callbacks_;
+
+  static std::mutex capturing_mutex_;
+  static std::unique_ptr<CUDAGraph> capturing_graph_;
+  static std::atomic<bool> capturing_;
+  static std::thread::id capturing_thread_id_;
+
+  DISABLE_COPY_AND_ASSIGN(CUDAGraph);
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/cuda_graph.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+__global__ void IncreaseKernel(int* data) { ++(*data); }
+
+TEST(CUDAGraph, CaptureAndReplay) {
+  if (!CUDAGraph::IsSupported()) return;
+  CUDAPlace place(0);
+  cudaStream_t stream;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  int* data = nullptr;
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaMalloc(&data, sizeof(int)));
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemsetAsync(data, 0, sizeof(int), stream));
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+
+  bool reset = false;
+  ASSERT_TRUE(CUDAGraph::BeginCapture(place, stream));
+  EXPECT_TRUE(CUDAGraph::IsThisThreadCapturing());
+  // Only one graph can be captured at a time.
+  EXPECT_FALSE(CUDAGraph::BeginCapture(place, stream));
+  CUDAGraph::AddResetCallbackDuringCapturing([&reset] { reset = true; });
+  IncreaseKernel<<<1, 1, 0, stream>>>(data);
+  IncreaseKernel<<<1, 1, 0, stream>>>(data);
+  auto graph = CUDAGraph::EndCapture();
+  EXPECT_FALSE(CUDAGraph::IsCapturing());
+
+  // The captured kernels are not run until the graph is replayed.
+  int result = -1;
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemcpy(&result, data, sizeof(int),
+                                         cudaMemcpyDeviceToHost));
+  EXPECT_EQ(result, 0);
+
+  for (int i = 0; i < 3; ++i) {
+    graph->Replay();
+  }
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamSynchronize(stream));
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemcpy(&result, data, sizeof(int),
+                                         cudaMemcpyDeviceToHost));
+  EXPECT_EQ(result, 6);
+
+  graph.reset();
+  EXPECT_TRUE(reset);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaFree(data));
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamDestroy(stream));
+}
+
+TEST(CUDAGraph, CaptureFailure) {
+  if (!CUDAGraph::IsSupported()) return;
+  CUDAPlace place(0);
+  cudaStream_t stream;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  ASSERT_TRUE(CUDAGraph::BeginCapture(place, stream));
+  // Synchronizing the capturing stream invalidates the capture.
+  cudaStreamSynchronize(stream);
+  EXPECT_THROW(CUDAGraph::EndCapture(), EnforceNotMet);
+  EXPECT_FALSE(CUDAGraph::IsCapturing());
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamDestroy(stream));
+}
+
+}  // namespace platform
+}  // namespace paddle
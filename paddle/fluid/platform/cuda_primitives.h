@@ -128,5 +128,13 @@ CUDA_ATOMIC_WRAPPER(Add, float16) {
 }
 
 #endif
+
+// The vector of the elements loaded and stored by one instruction, e.g.
+// AlignedVector<float, 4> is loaded as float4.
+template <typename T, int Size>
+struct alignas(sizeof(T) * Size) AlignedVector {
+  T val[Size];
+};
+
 }  // namespace platform
 }  // namespace paddle
@@ -13,13 +13,31 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/device_code.h"
+#include <dlfcn.h>
+#include <stdlib.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
 #include <set>
+#include <sstream>
 #include <utility>
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
 
 DECLARE_string(cuda_dir);
+DEFINE_string(device_code_cache_dir, "",
+              "Specify the directory to cache the PTX of the runtime compiled "
+              "CUDA kernels, which are shared by the processes on the same "
+              "machine. If default, the kernels are compiled in every "
+              "process.");
+DEFINE_string(cpu_jit_compiler, "c++",
+              "Specify the path or the name of the host compiler to compile "
+              "the C++ code of the runtime compiled CPU kernels.");
 
 namespace paddle {
 namespace platform {
@@ -64,12 +82,23 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
       places.size(), 0,
       errors::InvalidArgument(
           "Expected the number of places >= 1. Expected %d.", places.size()));
+  AddPlaces(places);
+
+#ifdef PADDLE_WITH_CUDA
+  CUDADeviceCode::CheckAvailableStatus();
+#endif
+}
+
+void DeviceCodePool::AddPlaces(const std::vector<platform::Place>& places) {
   // Remove the duplicated places
   std::set<Place> set;
   for (auto& p : places) {
     set.insert(p);
   }
   for (auto& p : set) {
+    if (device_codes_.find(p) != device_codes_.end()) {
+      continue;
+    }
     if (is_gpu_place(p)) {
 #ifdef PADDLE_WITH_CUDA
       device_codes_.emplace(p, DeviceCodeMap());
@@ -77,12 +106,184 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
       PADDLE_THROW(platform::errors::PreconditionNotMet(
           "CUDAPlace is not supported, please re-compile with WITH_GPU=ON."));
 #endif
+    } else if (is_cpu_place(p)) {
+      device_codes_.emplace(p, DeviceCodeMap());
     }
   }
+}
 
-#ifdef PADDLE_WITH_CUDA
-  CUDADeviceCode::CheckAvailableStatus();
-#endif
+static constexpr char kCPUCompileOptions[] =
+    "-std=c++11 -O3 -march=native -fPIC -shared -fopenmp";
+
+// The features of the host CPU, which the libraries compiled with
+// -march=native depend on, so that the libraries in a cache directory shared
+// by the machines of different CPUs are not mixed up.
+static const std::string& HostCPUFeatures() {
+  static std::string features = []() {
+    std::string str;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    bool has_model = false, has_flags = false;
+    while ((!has_model || !has_flags) && std::getline(cpuinfo, line)) {
+      if (!has_model && line.compare(0, 10, "model name") == 0) {
+        str += line + "\n";
+        has_model = true;
+      } else if (!has_flags && (line.compare(0, 5, "flags") == 0 ||
+                                line.compare(0, 8, "Features") == 0)) {
+        str += line + "\n";
+        has_flags = true;
+      }
+    }
+    for (auto isa : {sse42, avx, avx2, avx512f, avx512_core,
+                     avx512_core_vnni, avx512_mic, avx512_mic_4ops}) {
+      str += MayIUse(isa) ? '1' : '0';
+    }
+    return str;
+  }();
+  return features;
+}
+
+// Quote str as one word of the shell.
+static std::string ShellQuote(const std::string& str) {
+  std::string quoted = "'";
+  for (auto c : str) {
+    if (c == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted += c;
+    }
+  }
+  return quoted + "'";
+}
+
+// The kernels are compiled in a private directory of the process, if the
+// cache directory is not specified.
+static std::string GetCPUCodeDir() {
+  if (!FLAGS_device_code_cache_dir.empty()) {
+    return FLAGS_device_code_cache_dir;
+  }
+  static std::string tmp_dir = []() -> std::string {
+    char dir[] = "/tmp/paddle_device_code_XXXXXX";
+    return mkdtemp(dir) ? std::string(dir) : std::string();
+  }();
+  return tmp_dir;
+}
+
+CPUDeviceCode::CPUDeviceCode(const Place& place, const std::string& name,
+                             const std::string& kernel) {
+  if (!is_cpu_place(place)) {
+    PADDLE_THROW(platform::errors::PermissionDenied(
+        "CPUDeviceCode can only launch on CPU place."));
+  }
+
+  place_ = place;
+  name_ = name;
+  kernel_ = kernel;
+}
+
+CPUDeviceCode::~CPUDeviceCode() {
+  if (handle_) {
+    dlclose(handle_);
+  }
+}
+
+bool CPUDeviceCode::Compile(bool include_path) {
+  is_compiled_ = false;
+  std::string dir = GetCPUCodeDir();
+  if (dir.empty()) {
+    LOG_FIRST_N(WARNING, 1) << "Cannot create the directory to compile the "
+                               "C++ code of the CPU kernels.";
+    return false;
+  }
+
+  // The library depends on the code, the compiler, the options and the CPU.
+  std::ostringstream key;
+  key << kernel_ << FLAGS_cpu_jit_compiler << kCPUCompileOptions
+      << HostCPUFeatures();
+  std::ostringstream prefix;
+  prefix << dir << "/" << name_ << "_" << std::hex
+         << std::hash<std::string>()(key.str());
+  std::string lib_path = prefix.str() + ".so";
+
+  struct stat st;
+  if (stat(lib_path.c_str(), &st) == 0) {
+    VLOG(3) << "Load the library of " << name_ << " from " << lib_path;
+  } else {
+    // The source and the library are written to the files of unique names
+    // first, so that the processes compiling the same kernel never read or
+    // load the partial files of the others.
+    std::string src_template = prefix.str() + "_XXXXXX.cc";
+    std::vector<char> src_name(src_template.begin(), src_template.end());
+    src_name.push_back('\0');
+    int src_fd = mkstemps(src_name.data(), 3);
+    if (src_fd < 0) {
+      LOG_FIRST_N(WARNING, 1) << "Cannot create the source file "
+                              << src_template;
+      return false;
+    }
+    close(src_fd);
+    std::string src_path(src_name.data());
+    std::ofstream src_file(src_path);
+    src_file << kernel_;
+    src_file.close();
+
+    std::string tmp_lib_path =
+        lib_path + ".tmp" + std::to_string(std::random_device()());
+    std::string command = ShellQuote(FLAGS_cpu_jit_compiler) + " " +
+                          kCPUCompileOptions + " -o " +
+                          ShellQuote(tmp_lib_path) + " " +
+                          ShellQuote(src_path) + " 2>&1";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+      LOG_FIRST_N(WARNING, 1) << "Cannot run the command: " << command;
+      std::remove(src_path.c_str());
+      return false;
+    }
+    std::string log;
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+      log += buffer;
+    }
+    int status = pclose(pipe);
+    std::remove(src_path.c_str());
+    if (status != 0) {
+      LOG(WARNING) << "JIT compiling of C++ code failed:"
+                   << "\n  Kernel name: " << name_ << "\n  Kernel body:\n"
+                   << kernel_ << "\n  Command: " << command
+                   << "\n  Compiling log: " << log;
+      std::remove(tmp_lib_path.c_str());
+      return false;
+    }
+    if (std::rename(tmp_lib_path.c_str(), lib_path.c_str()) != 0) {
+      std::remove(tmp_lib_path.c_str());
+      return false;
+    }
+  }
+
+  handle_ = dlopen(lib_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_ == nullptr) {
+    LOG_FIRST_N(WARNING, 1) << "Call dlopen for < " << name_
+                            << " > failed: " << dlerror();
+    return false;
+  }
+  function_ =
+      reinterpret_cast<void (*)(void**)>(dlsym(handle_, name_.c_str()));
+  if (function_ == nullptr) {
+    LOG_FIRST_N(WARNING, 1) << "Call dlsym for < " << name_
+                            << " > failed: " << dlerror();
+    return false;
+  }
+
+  is_compiled_ = true;
+  return true;
+}
+
+void CPUDeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
+  PADDLE_ENFORCE_EQ(
+      is_compiled_, true,
+      errors::PreconditionNotMet(
+          "Please compile the code before launching the kernel."));
+  function_(args->data());
 }
 
 #ifdef PADDLE_WITH_CUDA
@@ -186,6 +387,33 @@ CUDADeviceCode::CUDADeviceCode(const Place& place, const std::string& name,
   kernel_ = kernel;
 }
 
+static bool LoadPTX(const std::string& path, std::vector<char>* ptx) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  ptx->assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  ptx->push_back('\0');
+  return ptx->size() > 1U;
+}
+
+// Write to a temporary file first, so that the processes never load a
+// partial PTX.
+static void SavePTX(const std::string& path, const std::vector<char>& ptx) {
+  std::string tmp_path = path + ".tmp" + std::to_string(std::random_device()());
+  std::ofstream file(tmp_path, std::ios::binary);
+  if (!file.is_open()) {
+    LOG_FIRST_N(WARNING, 1) << "Cannot write the PTX to " << tmp_path;
+    return;
+  }
+  file.write(ptx.data(), strlen(ptx.data()));
+  file.close();
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+  }
+}
+
 bool CUDADeviceCode::Compile(bool include_path) {
   is_compiled_ = false;
   if (!dynload::HasNVRTC() || !dynload::HasCUDADriver()) {
@@ -194,6 +422,54 @@ bool CUDADeviceCode::Compile(bool include_path) {
     return false;
   }
 
+  auto* dev_ctx = reinterpret_cast<CUDADeviceContext*>(
+      DeviceContextPool::Instance().Get(place_));
+  int compute_capability = dev_ctx->GetComputeCapability();
+
+  // The PTX depends on the code, the compute capability and the version of
+  // NVRTC.
+  std::string cache_path;
+  if (!FLAGS_device_code_cache_dir.empty()) {
+    int nvrtc_major = 0;
+    int nvrtc_minor = 0;
+    dynload::nvrtcVersion(&nvrtc_major, &nvrtc_minor);
+    std::ostringstream key;
+    key << kernel_ << compute_capability << include_path << nvrtc_major << "."
+        << nvrtc_minor;
+    std::ostringstream path;
+    path << FLAGS_device_code_cache_dir << "/" << name_ << "_" << std::hex
+         << std::hash<std::string>()(key.str()) << ".ptx";
+    cache_path = path.str();
+  }
+
+  if (!cache_path.empty() && LoadPTX(cache_path, &ptx_)) {
+    VLOG(3) << "Load the PTX of " << name_ << " from " << cache_path;
+  } else {
+    if (!CompileToPTX(compute_capability, include_path)) {
+      return false;
+    }
+    if (!cache_path.empty()) {
+      SavePTX(cache_path, ptx_);
+    }
+  }
+
+  if (!CheckCUDADriverResult(dynload::cuModuleLoadData(&module_, ptx_.data()),
+                             "cuModuleLoadData", name_)) {
+    return false;
+  }
+
+  if (!CheckCUDADriverResult(
+          dynload::cuModuleGetFunction(&function_, module_, name_.c_str()),
+          "cuModuleGetFunction", name_)) {
+    return false;
+  }
+
+  max_threads_ = dev_ctx->GetMaxPhysicalThreadCount();
+  is_compiled_ = true;
+  return true;
+}
+
+bool CUDADeviceCode::CompileToPTX(int compute_capability, bool include_path) {
   nvrtcProgram program;
   if (!CheckNVRTCResult(dynload::nvrtcCreateProgram(&program,
                                                     kernel_.c_str(),  // buffer
@@ -206,9 +482,6 @@ bool CUDADeviceCode::Compile(bool include_path) {
   }
 
   // Compile the program for specified compute_capability
-  auto* dev_ctx = reinterpret_cast<CUDADeviceContext*>(
-      DeviceContextPool::Instance().Get(place_));
-  int compute_capability = dev_ctx->GetComputeCapability();
   std::string compute_flag =
       "--gpu-architecture=compute_" + std::to_string(compute_capability);
   std::vector<const char*> options = {"--std=c++11", compute_flag.c_str()};
@@ -260,20 +533,6 @@ bool CUDADeviceCode::Compile(bool include_path) {
                         "nvrtcDestroyProgram")) {
     return false;
   }
-
-  if (!CheckCUDADriverResult(dynload::cuModuleLoadData(&module_, ptx_.data()),
-                             "cuModuleLoadData", name_)) {
-    return false;
-  }
-
-  if (!CheckCUDADriverResult(
-          dynload::cuModuleGetFunction(&function_, module_, name_.c_str()),
-          "cuModuleGetFunction", name_)) {
-    return false;
-  }
-
-  max_threads_ = dev_ctx->GetMaxPhysicalThreadCount();
-  is_compiled_ = true;
   return true;
 }
 
@@ -43,6 +43,26 @@ class DeviceCode {
   std::string kernel_;
 };
 
+/*
+ * Compile the C++ code into a shared library by the host compiler. The
+ * kernel is an extern "C" function taking the pointers to the arguments,
+ * i.e. void kernel(void** args), the same as the arguments of the CUDA
+ * kernels launched by cuLaunchKernel.
+ */
+class CPUDeviceCode : public DeviceCode {
+ public:
+  explicit CPUDeviceCode(const Place& place, const std::string& name,
+                         const std::string& kernel);
+  ~CPUDeviceCode();
+  bool Compile(bool include_path = false) override;
+  void Launch(const size_t n, std::vector<void*>* args) const override;
+
+ private:
+  bool is_compiled_{false};
+  void* handle_{nullptr};
+  void (*function_)(void**){nullptr};
+};
+
 #ifdef PADDLE_WITH_CUDA
 class CUDADeviceCode : public DeviceCode {
  public:
@@ -60,6 +80,8 @@ class CUDADeviceCode : public DeviceCode {
   static bool IsAvailable() { return available_; }
 
  private:
+  // Compile the kernel to ptx_ by NVRTC.
+  bool CompileToPTX(int compute_capability, bool include_path);
   bool CheckNVRTCResult(nvrtcResult result, std::string function);
 
   static bool available_;
@@ -92,6 +114,8 @@ class DeviceCodePool {
   static DeviceCodePool& Init(const std::vector<platform::Place>& places) {
     if (pool == nullptr) {
       pool = new DeviceCodePool(places);
+    } else {
+      pool->AddPlaces(places);
     }
     return *pool;
   }
@@ -110,6 +134,8 @@ class DeviceCodePool {
   }
 
  private:
+  void AddPlaces(const std::vector<platform::Place>& places);
+
   static DeviceCodePool* pool;
   std::map<Place, DeviceCodeMap> device_codes_;
   DISABLE_COPY_AND_ASSIGN(DeviceCodePool);
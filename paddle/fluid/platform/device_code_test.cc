@@ -13,11 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/device_code.h"
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
 #include <utility>
+#include <vector>
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/platform/init.h"
 
+DECLARE_string(device_code_cache_dir);
+
 constexpr auto saxpy_code = R"(
 extern "C" __global__
 void saxpy_kernel(float a, float *x, float* y, float* z, size_t n) {
@@ -28,6 +36,77 @@ void saxpy_kernel(float a, float *x, float* y, float* z, size_t n) {
 }
 )";
 
+constexpr auto saxpy_cpu_code = R"(
+#include <cstddef>
+
+extern "C" void saxpy_kernel(void** args) {
+  float a = *static_cast<float*>(args[0]);
+  float* x = *static_cast<float**>(args[1]);
+  float* y = *static_cast<float**>(args[2]);
+  float* z = *static_cast<float**>(args[3]);
+  size_t n = *static_cast<size_t*>(args[4]);
+  for (size_t i = 0; i < n; ++i) {
+    z[i] = a * x[i] + y[i];
+  }
+}
+)";
+
+TEST(DeviceCode, cpu) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode code(place, "saxpy_kernel", saxpy_cpu_code);
+  EXPECT_EQ(code.Compile(), true);
+
+  float scale = 2;
+  size_t n = 1024;
+  std::vector<float> cpu_x(n);
+  std::vector<float> cpu_y(n, 0.5);
+  std::vector<float> cpu_z(n);
+  for (size_t i = 0; i < n; ++i) {
+    cpu_x[i] = static_cast<float>(i);
+  }
+  float* x_data = cpu_x.data();
+  float* y_data = cpu_y.data();
+  float* z_data = cpu_z.data();
+
+  std::vector<void*> args = {&scale, &x_data, &y_data, &z_data, &n};
+  code.Launch(n, &args);
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_EQ(cpu_z[i], static_cast<float>(i) * scale + 0.5);
+  }
+
+  // The library is loaded from the disk at the second time.
+  paddle::platform::CPUDeviceCode code_again(place, "saxpy_kernel",
+                                             saxpy_cpu_code);
+  EXPECT_EQ(code_again.Compile(), true);
+}
+
+TEST(DeviceCode, cpu_cache_dir) {
+  // the paths are quoted in the command compiling the code
+  char dir[] = "/tmp/paddle device_code's XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  FLAGS_device_code_cache_dir = dir;
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode code(place, "saxpy_kernel", saxpy_cpu_code);
+  EXPECT_EQ(code.Compile(), true);
+
+  // only the library is left in the cache directory
+  int num_files = 0;
+  DIR* dir_stream = opendir(dir);
+  ASSERT_NE(dir_stream, nullptr);
+  while (auto* entry = readdir(dir_stream)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    ++num_files;
+    EXPECT_EQ(name.substr(name.size() - 3), ".so");
+    std::remove((std::string(dir) + "/" + name).c_str());
+  }
+  closedir(dir_stream);
+  EXPECT_EQ(num_files, 1);
+  rmdir(dir);
+  FLAGS_device_code_cache_dir = "";
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(DeviceCode, cuda) {
   if (!paddle::platform::dynload::HasNVRTC() ||
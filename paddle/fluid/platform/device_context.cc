@@ -10,6 +10,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
+#include <limits>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -18,12 +19,21 @@ limitations under the License. */
 #include "paddle/fluid/memory/memory.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/cuda_device_context_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/cudnn_workspace_helper.h"
+#include "paddle/fluid/platform/resource_pool.h"
 #endif
 
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 
+#ifdef PADDLE_WITH_MKLDNN
+DECLARE_uint64(mkldnn_cache_capacity_mb);
+#endif
+
 namespace paddle {
 namespace memory {
 
@@ -34,11 +44,18 @@ AllocationPtr Alloc(const platform::DeviceContext& dev_ctx, size_t size) {
     return Alloc(place, size);
   }
   auto* default_dev_ctx = static_cast<platform::CUDADeviceContext*>(
-      platform::DeviceContextPool::Instance().Get(place));
+      platform::DeviceContextPool::Instance().GetDefault(place));
   auto& desired_dev_ctx =
       static_cast<const platform::CUDADeviceContext&>(dev_ctx);
   if (default_dev_ctx->stream() == desired_dev_ctx.stream()) {
     return Alloc(place, size);
+  } else if (allocation::GetAllocatorStrategy() ==
+             allocation::AllocatorStrategy::kAutoGrowth) {
+    // The auto_growth allocator keeps a free list for each stream, so that
+    // the memory can be freed without stream callback.
+    return allocation::AllocatorFacade::Instance().Alloc(
+        BOOST_GET_CONST(platform::CUDAPlace, place), size,
+        desired_dev_ctx.stream());
   } else {
     return allocation::CUDADeviceContextAllocatorPool::Instance().Alloc(
         desired_dev_ctx, size);
@@ -48,6 +65,26 @@ AllocationPtr Alloc(const platform::DeviceContext& dev_ctx, size_t size) {
 #endif
 }
 
+void RecordStream(Allocation* allocation,
+                  const platform::DeviceContext& dev_ctx) {
+#ifdef PADDLE_WITH_CUDA
+  auto place = dev_ctx.GetPlace();
+  if (allocation == nullptr || !platform::is_gpu_place(place) ||
+      allocation::GetAllocatorStrategy() !=
+          allocation::AllocatorStrategy::kAutoGrowth) {
+    return;
+  }
+  auto* default_dev_ctx = static_cast<platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().GetDefault(place));
+  auto stream =
+      static_cast<const platform::CUDADeviceContext&>(dev_ctx).stream();
+  // The allocations of the default stream are kept in the free list of
+  // nullptr stream inside the allocator.
+  allocation::AllocatorFacade::Instance().RecordStream(
+      allocation, stream == default_dev_ctx->stream() ? nullptr : stream);
+#endif
+}
+
 }  // namespace memory
 }  // namespace paddle
 
@@ -56,7 +93,19 @@ namespace platform {
 
 DeviceContextPool* DeviceContextPool::pool = nullptr;
 
+// The device context set by DeviceContextGuard on the calling thread.
+static thread_local DeviceContext* guarded_dev_ctx = nullptr;
+
 platform::DeviceContext* DeviceContextPool::Get(const platform::Place& place) {
+  if (UNLIKELY(guarded_dev_ctx != nullptr) &&
+      platform::is_same_place(guarded_dev_ctx->GetPlace(), place)) {
+    return guarded_dev_ctx;
+  }
+  return GetDefault(place);
+}
+
+platform::DeviceContext* DeviceContextPool::GetDefault(
+    const platform::Place& place) {
   auto it = device_contexts_.find(place);
   if (it == device_contexts_.end()) {
     PADDLE_THROW(
@@ -69,6 +118,73 @@ platform::DeviceContext* DeviceContextPool::Get(const platform::Place& place) {
   return it->second.get().get();
 }
 
+platform::DeviceContext* DeviceContextPool::GetStreamContext(
+    const platform::Place& place, size_t stream_id) {
+  auto* default_dev_ctx = GetDefault(place);
+  if (stream_id == 0) return default_dev_ctx;
+  PADDLE_ENFORCE_EQ(platform::is_gpu_place(place), true,
+                    platform::errors::Unimplemented(
+                        "Only CUDAPlace supports more than one stream, but "
+                        "the stream %d of %s is required.",
+                        stream_id, place));
+#ifdef PADDLE_WITH_CUDA
+  std::lock_guard<std::mutex> guard(stream_contexts_mtx_);
+  auto& dev_ctxes = stream_contexts_[place];
+  while (dev_ctxes.size() < stream_id) {
+    dev_ctxes.emplace_back(
+        new CUDADeviceContext(BOOST_GET_CONST(CUDAPlace, place)));
+  }
+  return dev_ctxes[stream_id - 1].get();
+#else
+  return default_dev_ctx;
+#endif
+}
+
+void DeviceContextPool::WaitAllStreams(const platform::Place& place) {
+  GetDefault(place)->Wait();
+  std::lock_guard<std::mutex> guard(stream_contexts_mtx_);
+  auto iter = stream_contexts_.find(place);
+  if (iter == stream_contexts_.end()) return;
+  for (auto& dev_ctx : iter->second) {
+    dev_ctx->Wait();
+  }
+}
+
+// Let the memory allocated on the calling thread be used on the stream of
+// dev_ctx, nullptr for the default stream.
+static void SetThreadAllocationStream(DeviceContext* dev_ctx) {
+#ifdef PADDLE_WITH_CUDA
+  if (memory::allocation::GetAllocatorStrategy() !=
+      memory::allocation::AllocatorStrategy::kAutoGrowth) {
+    return;
+  }
+  CUDAPlace place;
+  cudaStream_t stream = nullptr;
+  if (dev_ctx != nullptr && platform::is_gpu_place(dev_ctx->GetPlace())) {
+    place = BOOST_GET_CONST(CUDAPlace, dev_ctx->GetPlace());
+    auto* default_dev_ctx = static_cast<CUDADeviceContext*>(
+        DeviceContextPool::Instance().GetDefault(place));
+    auto* cuda_dev_ctx = static_cast<CUDADeviceContext*>(dev_ctx);
+    if (cuda_dev_ctx->stream() != default_dev_ctx->stream()) {
+      stream = cuda_dev_ctx->stream();
+    }
+  }
+  memory::allocation::AllocatorFacade::Instance().SetThreadStream(place,
+                                                                  stream);
+#endif
+}
+
+DeviceContextGuard::DeviceContextGuard(DeviceContext* dev_ctx)
+    : prev_dev_ctx_(guarded_dev_ctx) {
+  guarded_dev_ctx = dev_ctx;
+  SetThreadAllocationStream(dev_ctx);
+}
+
+DeviceContextGuard::~DeviceContextGuard() {
+  guarded_dev_ctx = prev_dev_ctx_;
+  SetThreadAllocationStream(prev_dev_ctx_);
+}
+
 template <typename DevCtx, typename PlaceType>
 inline void EmplaceDeviceContext(
     std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>*
@@ -213,6 +329,18 @@ class EigenCudaStreamDevice : public Eigen::StreamInterface {
   mutable std::unordered_map<void*, memory::AllocationPtr> allocations_;
 };
 
+void* CudnnWorkspaceHandle::Workspace(size_t bytes, bool cache) {
+  if (bytes == 0) return nullptr;
+  if (WorkspaceSize() >= bytes) return allocation_->ptr();
+  void* workspace =
+      context_->CachedCudnnWorkspace(device_context_, bytes, cache);
+  if (workspace != nullptr) return workspace;
+  ReallocWorkspace(bytes);
+  VLOG(2) << "Cudnn workspace size out of the cache: "
+          << static_cast<double>(WorkspaceSize()) / (1 << 20) << " MB";
+  return allocation_->ptr();
+}
+
 void CudnnWorkspaceHandle::ReallocWorkspace(size_t required_workspace_bytes) {
   if (required_workspace_bytes <= WorkspaceSize()) {
     return;
@@ -227,6 +355,82 @@ thread_local std::unordered_map<const CUDADeviceContext*,
     CUDADeviceContext::thread_ctx_;
 thread_local std::mutex CUDADeviceContext::ctx_mtx_;
 
+// The bytes of the cudnn workspaces cached by the CUDAContexts of every
+// device. They are limited by FLAGS_conv_workspace_size_limit in total, so
+// that the pooled contexts hold no more than one context may use.
+class CachedCudnnWorkspaceBytes {
+ public:
+  // Returns false if growing a workspace from old_bytes to new_bytes would
+  // exceed the limit.
+  static bool Grow(int device, size_t old_bytes, size_t new_bytes) {
+    size_t limit = static_cast<size_t>(GetDefaultConvWorkspaceSizeLimitMB())
+                   << 20;
+    std::lock_guard<std::mutex> guard(Mutex());
+    auto& bytes = Bytes()[device];
+    if (bytes - old_bytes + new_bytes > limit) return false;
+    bytes = bytes - old_bytes + new_bytes;
+    return true;
+  }
+
+  static void Release(int device, size_t old_bytes) {
+    std::lock_guard<std::mutex> guard(Mutex());
+    Bytes()[device] -= old_bytes;
+  }
+
+ private:
+  static std::mutex& Mutex() {
+    static std::mutex mtx;
+    return mtx;
+  }
+
+  static std::unordered_map<int, size_t>& Bytes() {
+    static std::unordered_map<int, size_t> bytes;
+    return bytes;
+  }
+};
+
+void* CUDAContext::CachedCudnnWorkspace(const CUDADeviceContext& dev_ctx,
+                                        size_t bytes, bool grow) {
+  if (cudnn_workspace_bytes_ >= bytes) {
+    return cudnn_workspace_->ptr();
+  }
+  if (!grow || !CachedCudnnWorkspaceBytes::Grow(
+                   place_.device, cudnn_workspace_bytes_, bytes)) {
+    return nullptr;
+  }
+  // reset allocation first before re-allocate to save memory
+  cudnn_workspace_.reset();
+  cudnn_workspace_ = memory::Alloc(dev_ctx, bytes);
+  cudnn_workspace_bytes_ = bytes;
+  VLOG(2) << "Cached cudnn workspace size: "
+          << static_cast<double>(bytes) / (1 << 20) << " MB";
+  return cudnn_workspace_->ptr();
+}
+
+// The CUDAContexts of ResetThreadContext are pooled by the device and the
+// priority, so that the threads, e.g. of the predictor clones, reuse the
+// streams, handles and workspaces of the exited threads.
+static std::shared_ptr<CUDAContext> NewThreadCUDAContext(
+    const CUDAPlace& place, const stream::Priority& priority) {
+  static std::mutex mtx;
+  static std::map<std::pair<int, int>,
+                  std::shared_ptr<ResourcePool<CUDAContext>>>
+      pools;
+  std::shared_ptr<ResourcePool<CUDAContext>> pool;
+  {
+    std::lock_guard<std::mutex> guard(mtx);
+    auto& pool_of_place =
+        pools[std::make_pair(place.device, static_cast<int>(priority))];
+    if (pool_of_place == nullptr) {
+      pool_of_place = ResourcePool<CUDAContext>::Create(
+          [place, priority] { return new CUDAContext(place, priority); },
+          [](CUDAContext* context) { delete context; });
+    }
+    pool = pool_of_place;
+  }
+  return pool->New();
+}
+
 void CUDAContext::InitEigenContext() {
   eigen_stream_.reset(new EigenCudaStreamDevice());
   eigen_stream_->Reinitialize(&RawStream(), place_);
@@ -246,6 +450,9 @@ CUDAContext::CUDAContext(const CUDAPlace& place,
 
 CUDAContext::~CUDAContext() {
   CUDADeviceGuard guard(place_.device);
+  if (cudnn_workspace_bytes_ > 0) {
+    CachedCudnnWorkspaceBytes::Release(place_.device, cudnn_workspace_bytes_);
+  }
   DestoryCuDNNContext();
   DestoryCuBlasContext();
   DestoryCuSolverContext();
@@ -306,6 +513,11 @@ CUDADeviceContext::~CUDADeviceContext() {
 
 Place CUDADeviceContext::GetPlace() const { return place_; }
 
+void CUDADeviceContext::ResetThreadContext(const stream::Priority& priority) {
+  std::lock_guard<std::mutex> guard(ctx_mtx_);
+  thread_ctx_[this] = NewThreadCUDAContext(place_, priority);
+}
+
 void CUDADeviceContext::Wait() const { context()->Stream()->Wait(); }
 
 int CUDADeviceContext::GetComputeCapability() const {
@@ -339,7 +551,7 @@ cudnnHandle_t CUDADeviceContext::cudnn_handle() const {
 }
 
 CudnnWorkspaceHandle CUDADeviceContext::cudnn_workspace_handle() const {
-  return CudnnWorkspaceHandle(*this, &cudnn_handle_mtx_);
+  return CudnnWorkspaceHandle(*this, context());
 }
 
 cusolverDnHandle_t CUDADeviceContext::cusolver_dn_handle() const {
@@ -373,6 +585,7 @@ MKLDNNDeviceContext::MKLDNNDeviceContext(CPUPlace place)
       p_blobmap_() {
   p_blobmap_.reset(new BlobMap());
   p_mutex_.reset(new std::mutex());
+  p_stats_.reset(new CacheStats());
 }
 
 MKLDNNDeviceContextThreadLocals::Body::Body() {
@@ -410,8 +623,13 @@ MKLDNNDeviceContextThreadLocals::Body::get_cur_paddle_data_layout(void) {
 }
 
 void MKLDNNDeviceContext::ResetBlobMap() const {
-  VLOG(3) << "Clearing DNNL cache.";
+  std::lock_guard<decltype(*p_mutex_)> lock(*p_mutex_);
+  VLOG(3) << "Clearing DNNL cache, hits: " << p_stats_->hits
+          << ", misses: " << p_stats_->misses
+          << ", evictions: " << p_stats_->evictions
+          << ", bytes: " << p_stats_->bytes;
   p_blobmap_->clear();
+  p_stats_->bytes = 0;
 }
 
 size_t MKLDNNDeviceContext::GetShapeBlobSize() const {
@@ -423,14 +641,38 @@ size_t MKLDNNDeviceContext::GetShapeBlobSize() const {
         "MKLDNNDeviceContext don't find cur_mkldnn_session_id: %d.",
         tls().cur_mkldnn_session_id));
   }
-  return map_it->second->size();
+  return map_it->second->shapes.size();
+}
+
+MKLDNNDeviceContext::CacheStats MKLDNNDeviceContext::GetCacheStats() const {
+  std::lock_guard<decltype(*p_mutex_)> lock(*p_mutex_);
+  return *p_stats_;
+}
+
+void MKLDNNDeviceContext::EvictShapeBlobs(int sid, ShapeBlob* sBlob,
+                                          size_t max_shapes,
+                                          size_t max_bytes) const {
+  const std::string& cur_shape = tls().cur_input_shape_str;
+  auto lru_it = sBlob->lru.end();
+  while (lru_it != sBlob->lru.begin() &&
+         (sBlob->shapes.size() >= max_shapes || sBlob->bytes > max_bytes)) {
+    --lru_it;
+    if (*lru_it == cur_shape) continue;
+    auto shape_it = sBlob->shapes.find(*lru_it);
+    VLOG(2) << "sid=" << sid << ", remove all blobs of shape: " << *lru_it
+            << ", " << shape_it->second.bytes << " bytes";
+    sBlob->bytes -= shape_it->second.bytes;
+    p_stats_->bytes -= shape_it->second.bytes;
+    ++p_stats_->evictions;
+    sBlob->shapes.erase(shape_it);
+    lru_it = sBlob->lru.erase(lru_it);
+  }
 }
 
 void MKLDNNDeviceContext::SetBlob(const std::string& name,
-                                  BlobPtr_t<void> data) const {
+                                  BlobPtr_t<void> data, size_t bytes) const {
   BlobMap* pMap = p_blobmap_.get();
   BlobPtr_t<ShapeBlob> sBlob = nullptr;
-  BlobPtr_t<KeyBlob> pBlob = nullptr;
 
   int sid = tls().get_cur_mkldnn_session_id();
 
@@ -449,32 +691,44 @@ void MKLDNNDeviceContext::SetBlob(const std::string& name,
   }
 
   // Find KeyBlob for current input shape
-  auto key_it = sBlob->find(tls().cur_input_shape_str);
+  const std::string& cur_shape = tls().cur_input_shape_str;
+  auto key_it = sBlob->shapes.find(cur_shape);
 
-  if (key_it == sBlob->end()) {
+  if (key_it == sBlob->shapes.end()) {
     // In cache clearing mode, cur_input_shape_cache_capacity defines
     // max pblob capacity
-    if ((static_cast<size_t>(sid) ==
-         MKLDNNDeviceContextThreadLocals::kMKLDNNSessionID_CacheClearing) &&
-        sBlob->size() &&
-        (sBlob->size() >=
-         static_cast<size_t>(tls().cur_input_shape_cache_capacity))) {
-      VLOG(2) << "sid=" << sid
-              << ", remove all blobs of shape: " << sBlob->begin()->first;
-      sBlob->erase(sBlob->begin()->first);
+    if (static_cast<size_t>(sid) ==
+        MKLDNNDeviceContextThreadLocals::kMKLDNNSessionID_CacheClearing) {
+      EvictShapeBlobs(
+          sid, sBlob.get(),
+          static_cast<size_t>(tls().cur_input_shape_cache_capacity),
+          std::numeric_limits<size_t>::max());
     }
-    pBlob = std::make_shared<KeyBlob>();
-    (*sBlob)[tls().cur_input_shape_str] = pBlob;
-  } else {
-    pBlob = key_it->second;
+    sBlob->lru.push_front(cur_shape);
+    key_it = sBlob->shapes.emplace(cur_shape, ShapeBlob::Entry()).first;
+    key_it->second.blobs = std::make_shared<KeyBlob>();
+    key_it->second.lru_pos = sBlob->lru.begin();
   }
-
-  // Find Blob via name
-  auto blob_it = pBlob->find(name);
-  if (blob_it == pBlob->end()) {
-    (*pBlob)[name] = data;
-  } else {
-    blob_it->second = data;  // set data to existing blob
+  auto& entry = key_it->second;
+
+  // Find Blob via name, and replace its bytes if it exists
+  (*entry.blobs)[name] = data;
+  auto bytes_it = entry.blob_bytes.find(name);
+  if (bytes_it != entry.blob_bytes.end()) {
+    entry.bytes -= bytes_it->second;
+    sBlob->bytes -= bytes_it->second;
+    p_stats_->bytes -= bytes_it->second;
+    entry.blob_bytes.erase(bytes_it);
+  }
+  if (bytes > 0) {
+    entry.blob_bytes[name] = bytes;
+    entry.bytes += bytes;
+    sBlob->bytes += bytes;
+    p_stats_->bytes += bytes;
+    if (FLAGS_mkldnn_cache_capacity_mb > 0) {
+      EvictShapeBlobs(sid, sBlob.get(), std::numeric_limits<size_t>::max(),
+                      FLAGS_mkldnn_cache_capacity_mb << 20);
+    }
   }
   VLOG(2) << "SetBlob: sid=" << sid << ", add blob=" << name << "\n";
   // lock will be automatically released when out of scope
@@ -495,28 +749,34 @@ MKLDNNDeviceContext::BlobPtr_t<void> MKLDNNDeviceContext::GetBlob(
   auto map_it = pMap->find(sid);
   if (map_it == pMap->end()) {
     VLOG(2) << "GetBlob: sid=" << sid << ", miss sid\n";
+    ++p_stats_->misses;
     return nullptr;
   }
   sBlob = map_it->second;
 
-  // Find KeyBlob for current input shape secondly
-  auto sBlob_it = sBlob->find(tls().cur_input_shape_str);
-  if (sBlob_it == sBlob->end()) {
+  // Find KeyBlob for current input shape secondly, and mark the shape as
+  // the most recently used
+  auto sBlob_it = sBlob->shapes.find(tls().cur_input_shape_str);
+  if (sBlob_it == sBlob->shapes.end()) {
     VLOG(2) << "GetBlob: sid=" << tls().cur_input_shape_str
             << ", miss input_shape_str\n";
+    ++p_stats_->misses;
     return nullptr;
   }
-  pBlob = sBlob_it->second;
+  sBlob->lru.splice(sBlob->lru.begin(), sBlob->lru, sBlob_it->second.lru_pos);
+  pBlob = sBlob_it->second.blobs;
 
   // Find Blob via name
   auto key_it = pBlob->find(name);
 
   if (key_it == pBlob->end()) {
     VLOG(2) << "GetBlob sid=" << sid << ", miss blob=" << name << "\n";
+    ++p_stats_->misses;
     return nullptr;
   }
 
   VLOG(2) << "GetBlob sid=" << sid << ", get blob=" << name << "\n";
+  ++p_stats_->hits;
   // lock will be automatically released when out of scope
   return key_it->second;
 }
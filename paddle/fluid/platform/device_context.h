@@ -12,6 +12,7 @@ limitations under the License. */
 
 #include <future>  // NOLINT
 #include <memory>
+#include <list>
 #include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
@@ -80,6 +81,7 @@ struct DefaultDeviceContextType<platform::CPUPlace> {
 
 class EigenCudaStreamDevice;
 class CudnnWorkspaceHandle;
+class CUDADeviceContext;
 
 class CUDAContext {
  public:
@@ -138,6 +140,17 @@ class CUDAContext {
     }
   }
 
+  /*! \brief  The mutex of the cudnn calls using the cached workspace. */
+  std::mutex& CudnnWorkspaceMutex() const { return cudnn_workspace_mtx_; }
+
+  /*! \brief  Return the cudnn workspace cached by the context, which has at
+   *  least `bytes`. If it is smaller and `grow` is true, it grows unless
+   *  the cached workspaces of the device would exceed
+   *  FLAGS_conv_workspace_size_limit in total. Otherwise returns nullptr.
+   *  The caller must hold CudnnWorkspaceMutex(). */
+  void* CachedCudnnWorkspace(const CUDADeviceContext& dev_ctx, size_t bytes,
+                             bool grow);
+
  private:
   void InitEigenContext();
 
@@ -209,6 +222,10 @@ class CUDAContext {
   std::unique_ptr<CublasHandleHolder> cublas_handle_;
   std::unique_ptr<CublasHandleHolder> cublas_tensor_core_handle_;
   cusolverDnHandle_t cusolver_dn_handle_;
+  // The largest cudnn workspace required on the context so far.
+  memory::allocation::AllocationPtr cudnn_workspace_;
+  size_t cudnn_workspace_bytes_{0};
+  mutable std::mutex cudnn_workspace_mtx_;
   DISABLE_COPY_AND_ASSIGN(CUDAContext);
 };
 
@@ -300,10 +317,13 @@ class CUDADeviceContext : public DeviceContext {
     default_ctx_.reset(new CUDAContext(place_, priority));
   }
 
-  void ResetThreadContext(const stream::Priority& priority) {
-    std::lock_guard<std::mutex> guard(ctx_mtx_);
-    thread_ctx_[this].reset(new CUDAContext(place_, priority));
-  }
+  // Let the calling thread run on its own context, i.e. stream, handles and
+  // cudnn workspace. The contexts are pooled, the one of an exited thread
+  // is reused by the others.
+  void ResetThreadContext(const stream::Priority& priority);
+
+  // Whether the calling thread has its own context by ResetThreadContext.
+  bool HasThreadContext() const { return thread_ctx_.count(this) > 0; }
 
   std::shared_ptr<CUDAContext> context() const {
     if (!thread_ctx_.count(this)) {
@@ -323,8 +343,6 @@ class CUDADeviceContext : public DeviceContext {
       thread_ctx_;
   static thread_local std::mutex ctx_mtx_;
 
-  mutable std::mutex cudnn_handle_mtx_;
-
 #if defined(PADDLE_WITH_NCCL)
   // NCCL communicator (single process version) for NCCL collective operations.
   // NCCL collective operations provides fast collectives over multiple GPUs
@@ -345,32 +363,32 @@ class CUDADeviceContext : public DeviceContext {
   DISABLE_COPY_AND_ASSIGN(CUDADeviceContext);
 };
 
+/*! \brief  CudnnWorkspaceHandle runs the cudnn functions with the workspace
+ *  cached by the CUDAContext of the calling thread, which grows to the
+ *  largest size required. When the cached workspaces would exceed
+ *  FLAGS_conv_workspace_size_limit in total, a workspace owned by the handle
+ *  is allocated instead, and released with the handle. */
 class CudnnWorkspaceHandle {
  public:
-  inline CudnnWorkspaceHandle(const CUDADeviceContext& dev_ctx, std::mutex* mtx)
-      : device_context_(dev_ctx), mtx_(mtx) {}
+  inline CudnnWorkspaceHandle(const CUDADeviceContext& dev_ctx,
+                              std::shared_ptr<CUDAContext> context)
+      : device_context_(dev_ctx), context_(std::move(context)) {}
 
   template <typename Callback>
   inline void RunFunc(Callback&& cudnn_func, size_t required_workspace_bytes) {
-    if (required_workspace_bytes > WorkspaceSize()) {
-      ReallocWorkspace(required_workspace_bytes);
-    }
-    VLOG(2) << "Cudnn workspace size at RunFunc: "
-            << static_cast<double>(WorkspaceSize()) / (1 << 20) << " MB";
-    {
-      std::lock_guard<std::mutex> guard(*mtx_);
-      cudnn_func(allocation_ ? allocation_->ptr() : nullptr);
-    }
+    std::lock_guard<std::mutex> guard(context_->CudnnWorkspaceMutex());
+    cudnn_func(Workspace(required_workspace_bytes, /*cache=*/true));
   }
 
   /*! \brief Thread which call RunFuncSync() would release gpu memory after
    *  running the function. Currently this function is only used when cudnn
    *  exhaustive searching and callers have to guarantee that the input function
-   *  is host blocking */
+   *  is host blocking. So the workspace is not cached. */
   template <typename Callback>
   inline void RunFuncSync(Callback&& cudnn_func,
                           size_t required_workspace_bytes) {
-    RunFunc(cudnn_func, required_workspace_bytes);
+    std::lock_guard<std::mutex> guard(context_->CudnnWorkspaceMutex());
+    cudnn_func(Workspace(required_workspace_bytes, /*cache=*/false));
     ResetWorkspace();
   }
 
@@ -389,9 +407,13 @@ class CudnnWorkspaceHandle {
   CudnnWorkspaceHandle& operator=(CudnnWorkspaceHandle&&) = delete;
 
  private:
+  // Returns the workspace of at least `bytes`, the cached one if `cache` is
+  // true or it is large enough. Must be called with the mutex held.
+  void* Workspace(size_t bytes, bool cache);
+
   memory::allocation::AllocationPtr allocation_;
   const CUDADeviceContext& device_context_;
-  std::mutex* mtx_;
+  std::shared_ptr<CUDAContext> context_;
 };
 
 template <>
@@ -474,13 +496,36 @@ class MKLDNNDeviceContext : public CPUDeviceContext {
   // Following three maps are used to cache MKLDNN primitives.
   // There relations are:
   // - BlobMap = Map<cur_thread_id, ShapeBlob>
-  // - ShapeBlob = Map<cur_input_shape_str, KeyBlob>
+  // - ShapeBlob = LRU<cur_input_shape_str, KeyBlob>
   // - KeyBlob  = Map<blob_name, blob>
 
   using KeyBlob = umap_key_string_t<void>;
-  using ShapeBlob = umap_key_string_t<KeyBlob>;
+
+  // The blobs of the input shapes of a session, the most recently used shape
+  // first. The blobs of one shape are evicted together, since the ops need
+  // all of them in an iteration, e.g. the grad ops reuse the forward pds.
+  struct ShapeBlob {
+    struct Entry {
+      BlobPtr_t<KeyBlob> blobs;
+      // The bytes of the memory allocated by MKLDNN for the blobs.
+      std::unordered_map<std::string, size_t> blob_bytes;
+      size_t bytes{0};
+      std::list<std::string>::iterator lru_pos;
+    };
+    std::unordered_map<std::string, Entry> shapes;
+    std::list<std::string> lru;
+    size_t bytes{0};
+  };
   using BlobMap = umap_value_smart_t<int, ShapeBlob>;
 
+  struct CacheStats {
+    size_t hits{0};
+    size_t misses{0};
+    // The input shapes evicted for the shape capacity or the byte budget.
+    size_t evictions{0};
+    size_t bytes{0};
+  };
+
   explicit MKLDNNDeviceContext(CPUPlace place);
 
   /* \brief  Get the active engine */
@@ -492,20 +537,34 @@ class MKLDNNDeviceContext : public CPUDeviceContext {
   // Get the ShapeBlob size in cur_mkldnn_session_id.
   size_t GetShapeBlobSize() const;
 
-  // Set data to blob (i.e. name/data pair). Create blob if not existing
-  void SetBlob(const std::string& name, std::shared_ptr<void> data) const;
+  // Set data to blob (i.e. name/data pair). Create blob if not existing.
+  // bytes is the size of the memory allocated by MKLDNN for data, which
+  // counts towards FLAGS_mkldnn_cache_capacity_mb.
+  void SetBlob(const std::string& name, std::shared_ptr<void> data,
+               size_t bytes = 0) const;
 
   // Find a saved blob. Return nullptr if not found
   std::shared_ptr<void> GetBlob(const std::string& name) const;
 
+  // The hits and the misses of GetBlob, the evictions and the cached bytes
+  // of all the sessions.
+  CacheStats GetCacheStats() const;
+
   static auto tls() -> decltype(MKLDNNDeviceContextThreadLocals::fetch()) {
     return MKLDNNDeviceContextThreadLocals::fetch();
   }
 
  private:
   mkldnn::engine engine_;
+  // Evict the least recently used input shapes of sBlob but the current
+  // one, until there are fewer than max_shapes shapes and the blobs take
+  // at most max_bytes.
+  void EvictShapeBlobs(int sid, ShapeBlob* sBlob, size_t max_shapes,
+                       size_t max_bytes) const;
+
   std::shared_ptr<BlobMap> p_blobmap_;
   std::shared_ptr<std::mutex> p_mutex_;
+  std::shared_ptr<CacheStats> p_stats_;
 };
 #endif
 
@@ -529,9 +588,24 @@ class DeviceContextPool {
 
   static void SetPool(DeviceContextPool* dev_pool) { pool = dev_pool; }
 
-  /*! \brief  Return handle of single device context. */
+  /*! \brief  Return handle of single device context. It is the one set by
+   *  DeviceContextGuard on the calling thread if any. */
   platform::DeviceContext* Get(const platform::Place& place);
 
+  /*! \brief  Return the default device context of place, ignoring the
+   *  DeviceContextGuard. */
+  platform::DeviceContext* GetDefault(const platform::Place& place);
+
+  /*! \brief  Return the device context of place running on its stream_id-th
+   *  stream, with its own cudnn and cublas handles. It is created at the
+   *  first call, and the 0-th one is GetDefault(place). Only CUDAPlace
+   *  supports more than one stream. */
+  platform::DeviceContext* GetStreamContext(const platform::Place& place,
+                                            size_t stream_id);
+
+  /*! \brief  Wait for all the streams of place. */
+  void WaitAllStreams(const platform::Place& place);
+
   template <typename Place>
   const typename DefaultDeviceContextType<Place>::TYPE* GetByPlace(
       const Place& place) {
@@ -545,8 +619,29 @@ class DeviceContextPool {
   static DeviceContextPool* pool;
   std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>
       device_contexts_;
+  // The device contexts of the non-default streams, the i-th one runs on the
+  // (i + 1)-th stream.
+  std::map<Place, std::vector<std::unique_ptr<DeviceContext>>>
+      stream_contexts_;
+  std::mutex stream_contexts_mtx_;
   DISABLE_COPY_AND_ASSIGN(DeviceContextPool);
 };
 
+/*! \brief  Let DeviceContextPool::Get return dev_ctx for its place on the
+ *  calling thread while the guard is alive, so that the kernels run on the
+ *  stream of dev_ctx. The memory allocated meanwhile on the place is reused
+ *  only on that stream after it is freed, when
+ *  FLAGS_allocator_strategy=auto_growth. */
+class DeviceContextGuard {
+ public:
+  explicit DeviceContextGuard(DeviceContext* dev_ctx);
+  ~DeviceContextGuard();
+
+ private:
+  DeviceContext* prev_dev_ctx_;
+
+  DISABLE_COPY_AND_ASSIGN(DeviceContextGuard);
+};
+
 }  // namespace platform
 }  // namespace paddle
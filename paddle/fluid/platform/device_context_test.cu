@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
 
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "glog/logging.h"
@@ -66,3 +67,50 @@ TEST(Device, DeviceContextPool) {
     ASSERT_NE(dev_ctx, nullptr);
   }
 }
+
+TEST(Device, PooledThreadContext) {
+  using paddle::platform::CUDADeviceContext;
+  using paddle::platform::CUDAPlace;
+
+  CUDADeviceContext* device_context = new CUDADeviceContext(CUDAPlace(0));
+  auto run_on_thread_context = [device_context]() {
+    device_context->ResetThreadContext(
+        paddle::platform::stream::Priority::kNormal);
+    EXPECT_TRUE(device_context->HasThreadContext());
+    return device_context->stream();
+  };
+
+  cudaStream_t stream1 = nullptr;
+  cudaStream_t stream2 = nullptr;
+  std::thread thread1([&]() { stream1 = run_on_thread_context(); });
+  thread1.join();
+  // The context of the exited thread is reused.
+  std::thread thread2([&]() { stream2 = run_on_thread_context(); });
+  thread2.join();
+  ASSERT_NE(stream1, nullptr);
+  ASSERT_EQ(stream1, stream2);
+  ASSERT_NE(stream1, device_context->stream());
+  delete device_context;
+}
+
+TEST(Device, CachedCudnnWorkspace) {
+  using paddle::platform::CUDADeviceContext;
+  using paddle::platform::CUDAPlace;
+
+  CUDADeviceContext* device_context = new CUDADeviceContext(CUDAPlace(0));
+  void* workspace1 = nullptr;
+  void* workspace2 = nullptr;
+  void* workspace3 = nullptr;
+  device_context->cudnn_workspace_handle().RunFunc(
+      [&](void* workspace) { workspace1 = workspace; }, 1 << 20);
+  device_context->cudnn_workspace_handle().RunFunc(
+      [&](void* workspace) { workspace2 = workspace; }, 1 << 10);
+  // The workspace of RunFuncSync is not cached.
+  device_context->cudnn_workspace_handle().RunFuncSync(
+      [&](void* workspace) { workspace3 = workspace; }, 2 << 20);
+  ASSERT_NE(workspace1, nullptr);
+  ASSERT_EQ(workspace1, workspace2);
+  ASSERT_NE(workspace3, nullptr);
+  ASSERT_NE(workspace1, workspace3);
+  delete device_context;
+}
@@ -18,7 +18,9 @@ limitations under the License. */
 #include <list>
 #include <map>
 #include <mutex>  // NOLINT
+#include <iomanip>
 #include <numeric>
+#include <set>
 #include <sstream>
 #include <string>
 #include <thread>  // NOLINT
@@ -49,6 +51,98 @@ std::map<uint32_t, int32_t> system_thread_id_map;
 std::once_flag tracer_once_flag;
 DeviceTracer *tracer = nullptr;
 
+// Writes the events in the Trace Event Format of chrome://tracing.
+class ChromeTraceWriter {
+ public:
+  explicit ChromeTraceWriter(const std::string &path, uint64_t start_ns)
+      : out_(path, std::ios::out | std::ios::trunc), start_ns_(start_ns) {
+    PADDLE_ENFORCE_EQ(out_.is_open(), true,
+                      platform::errors::Unavailable(
+                          "Can not open %s to write the chrome trace.", path));
+    out_ << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+  }
+
+  ~ChromeTraceWriter() { out_ << "\n]}\n"; }
+
+  void Complete(const std::string &name, const std::string &cat, int64_t pid,
+                int64_t tid, uint64_t start_ns, uint64_t end_ns,
+                const std::string &args = "") {
+    Begin(name, cat, "X", pid, tid, start_ns);
+    out_ << ", \"dur\": " << (end_ns - start_ns) / 1000.;
+    if (!args.empty()) out_ << ", \"args\": {" << args << "}";
+    out_ << "}";
+  }
+
+  // The flow arrow from the slice enclosing the start to the slice beginning
+  // at the end.
+  void Flow(uint32_t id, int64_t from_pid, int64_t from_tid, uint64_t from_ns,
+            int64_t to_pid, int64_t to_tid, uint64_t to_ns) {
+    Begin("launch", "flow", "s", from_pid, from_tid, from_ns);
+    out_ << ", \"id\": " << id << "}";
+    Begin("launch", "flow", "f", to_pid, to_tid, to_ns);
+    out_ << ", \"id\": " << id << ", \"bp\": \"e\"}";
+  }
+
+  void Counter(const std::string &name, int64_t pid, uint64_t ns,
+               int64_t value) {
+    Begin(name, "memory", "C", pid, 0, ns);
+    out_ << ", \"args\": {\"bytes\": " << value << "}}";
+  }
+
+  void ProcessName(int64_t pid, const std::string &name) {
+    Metadata("process_name", pid, 0, name);
+  }
+
+  void ThreadName(int64_t pid, int64_t tid, const std::string &name) {
+    Metadata("thread_name", pid, tid, name);
+  }
+
+  static std::string Escape(const std::string &str) {
+    std::string escaped;
+    for (char c : str) {
+      if (c == '"' || c == '\\') escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+ private:
+  void Begin(const std::string &name, const std::string &cat, const char *ph,
+             int64_t pid, int64_t tid, uint64_t ns) {
+    out_ << (first_ ? "\n" : ",\n") << "{\"name\": \"" << Escape(name)
+         << "\", \"cat\": \"" << cat << "\", \"ph\": \"" << ph
+         << "\", \"pid\": " << pid << ", \"tid\": " << tid
+         << ", \"ts\": " << Timestamp(ns);
+    first_ = false;
+  }
+
+  void Metadata(const char *kind, int64_t pid, int64_t tid,
+                const std::string &name) {
+    out_ << (first_ ? "\n" : ",\n") << "{\"name\": \"" << kind
+         << "\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << tid
+         << ", \"args\": {\"name\": \"" << Escape(name) << "\"}}";
+    first_ = false;
+  }
+
+  double Timestamp(uint64_t ns) const {
+    return ns > start_ns_ ? (ns - start_ns_) / 1000. : 0.;
+  }
+
+  std::ofstream out_;
+  uint64_t start_ns_;
+  bool first_{true};
+};
+
+std::string PlaceName(const Place &place) {
+  if (platform::is_gpu_place(place)) {
+    return "GPU:" + std::to_string(
+                        BOOST_GET_CONST(platform::CUDAPlace, place).device);
+  } else if (platform::is_cuda_pinned_place(place)) {
+    return "CUDAPinned";
+  }
+  return "CPU";
+}
+
 void PrintCuptiHint() {
   static bool showed = false;
   if (showed) return;
@@ -592,6 +686,120 @@ class DeviceTracerImpl : public DeviceTracer {
     return profile_pb;
   }
 
+  void GenChromeTrace(const std::string &path) {
+    std::lock_guard<std::mutex> l(trace_mu_);
+    if (correlations_.empty()) {
+      for (auto &tmp : correlations_pairs) {
+        for (auto &pair : tmp) correlations_[pair.first] = pair.second;
+      }
+    }
+    auto annotation = [this](uint32_t correlation_id,
+                             const std::string &name) {
+      auto c = correlations_.find(correlation_id);
+      return c != correlations_.end() && c->second != nullptr
+                 ? c->second->name()
+                 : name;
+    };
+    // The host threads are in the process 0, the streams of the device d in
+    // the process d + 1, and the allocated bytes in the last process.
+    const int64_t kHostPid = 0;
+    auto device_pid = [](int64_t device_id) { return device_id + 1; };
+
+    ChromeTraceWriter writer(path, start_ns_);
+    writer.ProcessName(kHostPid, "Host");
+    std::set<int64_t> threads;
+    for (auto &tmp : cpu_records_) {
+      for (const CPURecord &r : tmp) {
+        threads.insert(r.thread_id);
+        writer.Complete(r.name, "op", kHostPid, r.thread_id, r.start_ns,
+                        r.end_ns);
+      }
+    }
+
+    // the launches by the correlation ids, for the flows to the kernels
+    std::unordered_map<uint32_t, const ActiveKindRecord *> launches;
+    for (auto &tmp : active_kind_records_) {
+      for (const ActiveKindRecord &r : tmp) {
+        threads.insert(r.thread_id);
+        launches[r.correlation_id] = &r;
+        writer.Complete(r.name, "cuda_api", kHostPid, r.thread_id, r.start_ns,
+                        r.end_ns,
+                        "\"op\": \"" +
+                            ChromeTraceWriter::Escape(
+                                annotation(r.correlation_id, "")) +
+                            "\"");
+      }
+    }
+    for (auto thread_id : threads) {
+      writer.ThreadName(kHostPid, thread_id,
+                        "thread " + std::to_string(thread_id));
+    }
+
+    std::set<std::pair<int64_t, int64_t>> streams;
+    auto add_device_event = [&](const std::string &name, const char *cat,
+                                int64_t device_id, int64_t stream_id,
+                                uint32_t correlation_id, uint64_t start_ns,
+                                uint64_t end_ns, const std::string &args) {
+      streams.emplace(device_id, stream_id);
+      writer.Complete(annotation(correlation_id, name), cat,
+                      device_pid(device_id), stream_id, start_ns, end_ns,
+                      args);
+      auto launch = launches.find(correlation_id);
+      if (launch != launches.end()) {
+        writer.Flow(correlation_id, kHostPid, launch->second->thread_id,
+                    launch->second->start_ns, device_pid(device_id),
+                    stream_id, start_ns);
+      }
+    };
+    for (const KernelRecord &r : kernel_records_) {
+      bool is_nccl = r.name.find("nccl") != std::string::npos;
+      add_device_event(
+          r.name, is_nccl ? "nccl" : "kernel", r.device_id, r.stream_id,
+          r.correlation_id, r.start_ns, r.end_ns,
+          "\"kernel\": \"" + ChromeTraceWriter::Escape(r.name) + "\"");
+    }
+    for (const MemRecord &r : mem_records_) {
+      add_device_event(r.name, "memcpy", r.device_id, r.stream_id,
+                       r.correlation_id, r.start_ns, r.end_ns,
+                       "\"kind\": \"" + ChromeTraceWriter::Escape(r.name) +
+                           "\", \"bytes\": " + std::to_string(r.bytes));
+    }
+    std::set<int64_t> devices;
+    for (auto &stream : streams) {
+      devices.insert(stream.first);
+      writer.ThreadName(device_pid(stream.first), stream.second,
+                        "stream " + std::to_string(stream.second));
+    }
+    for (auto device_id : devices) {
+      writer.ProcessName(device_pid(device_id),
+                         "GPU " + std::to_string(device_id));
+    }
+
+    // the allocated bytes of each place over time
+    int64_t memory_pid =
+        devices.empty() ? 1 : device_pid(*devices.rbegin()) + 1;
+    std::map<std::string, std::vector<std::pair<uint64_t, int64_t>>> changes;
+    for (auto &tmp : mem_info_record_) {
+      for (const auto &r : tmp) {
+        auto &place_changes = changes[PlaceName(r.place)];
+        place_changes.emplace_back(r.start_ns, static_cast<int64_t>(r.bytes));
+        place_changes.emplace_back(r.end_ns, -static_cast<int64_t>(r.bytes));
+      }
+    }
+    if (!changes.empty()) {
+      writer.ProcessName(memory_pid, "Memory");
+    }
+    for (auto &pair : changes) {
+      std::sort(pair.second.begin(), pair.second.end());
+      int64_t allocated = 0;
+      for (auto &change : pair.second) {
+        allocated += change.second;
+        writer.Counter("allocated " + pair.first, memory_pid, change.first,
+                       allocated);
+      }
+    }
+  }
+
   void Disable() {
 #ifdef PADDLE_WITH_CUPTI
     // flush might cause additional calls to DeviceTracker.
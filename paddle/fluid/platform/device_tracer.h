@@ -127,6 +127,11 @@ class DeviceTracer {
   // Generate a proto after done (Disabled).
   virtual proto::Profile GenProfile(const std::string& profile_path) = 0;
 
+  // Write the host threads, the streams of the devices, the flows from the
+  // launches to the kernels, and the allocated bytes as a chrome trace, viewed
+  // in chrome://tracing directly.
+  virtual void GenChromeTrace(const std::string& path) = 0;
+
   // generate kernel elapsed time into Event
   virtual void GenEventKernelCudaElapsedTime() = 0;
 
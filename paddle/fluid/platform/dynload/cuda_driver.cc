@@ -24,6 +24,9 @@ void* cuda_dso_handle = nullptr;
 #define DEFINE_WRAP(__name) DynLoad__##__name __name
 
 CUDA_ROUTINE_EACH(DEFINE_WRAP);
+#if CUDA_VERSION >= 10020
+CUDA_ROUTINE_EACH_VVM(DEFINE_WRAP);
+#endif
 
 #ifdef PADDLE_USE_DSO
 bool HasCUDADriver() {
@@ -71,10 +71,28 @@ extern bool HasCUDADriver();
   __macro(cuCtxCreate);                                 \
   __macro(cuCtxGetCurrent);                             \
   __macro(cuDeviceGetCount);                            \
+  __macro(cuDeviceGetAttribute);                        \
   __macro(cuDevicePrimaryCtxGetState)
 
 CUDA_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_CUDA_WRAP);
 
+#if CUDA_VERSION >= 10020
+/**
+ * the virtual memory management functions, since CUDA 10.2
+ **/
+#define CUDA_ROUTINE_EACH_VVM(__macro)    \
+  __macro(cuMemGetAllocationGranularity); \
+  __macro(cuMemAddressReserve);           \
+  __macro(cuMemAddressFree);              \
+  __macro(cuMemCreate);                   \
+  __macro(cuMemRelease);                  \
+  __macro(cuMemMap);                      \
+  __macro(cuMemUnmap);                    \
+  __macro(cuMemSetAccess)
+
+CUDA_ROUTINE_EACH_VVM(DECLARE_DYNAMIC_LOAD_CUDA_WRAP);
+#endif
+
 #undef DECLARE_DYNAMIC_LOAD_CUDA_WRAP
 
 }  // namespace dynload
@@ -95,7 +95,8 @@ extern void* mklml_dso_handle;
   __macro(vmsErf);                  \
   __macro(vmdErf);                  \
   __macro(MKL_Free_Buffers);        \
-  __macro(MKL_Set_Num_Threads)
+  __macro(MKL_Set_Num_Threads);     \
+  __macro(MKL_Set_Num_Threads_Local)
 
 MKLML_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_MKLML_WRAP);
 
@@ -33,6 +33,30 @@
 DEFINE_int32(paddle_num_threads, 1,
              "Number of threads for each paddle instance.");
 
+/**
+ * Thread related FLAG
+ * Name: FLAGS_compute_thread_cpus, FLAGS_io_thread_cpus,
+ *       FLAGS_comm_thread_cpus
+ * Since Version: 2.0.0
+ * Value Range: string, default=empty
+ * Example: FLAGS_compute_thread_cpus=0-39,48-87 FLAGS_io_thread_cpus=40-43,
+ *          88-91 FLAGS_comm_thread_cpus=44-47,92-95
+ * Note: The disjoint CPUs of the compute threads, i.e. the trainer threads of
+ *       the device workers, the IO threads, i.e. the reader threads of the
+ *       datasets and the IO thread pool, and the communication threads of
+ *       the communicator. Every compute thread is bound to one CPU, and the
+ *       threads are spread over the NUMA nodes of the CPUs. Empty means the
+ *       threads are not bound. They can also be set by the trainer_desc and
+ *       the data_feed_desc.
+ */
+DEFINE_string(compute_thread_cpus, "",
+              "The CPUs to bind the compute threads to, e.g. 0-39,48-87.");
+DEFINE_string(io_thread_cpus, "",
+              "The CPUs to bind the IO threads to, e.g. 40-43,88-91.");
+DEFINE_string(comm_thread_cpus, "",
+              "The CPUs to bind the communication threads to, e.g. "
+              "44-47,92-95.");
+
 /**
  * Operator related FLAG
  * Name: FLAGS_check_nan_inf
@@ -146,6 +170,22 @@ DEFINE_int64(cudnn_exhaustive_search_times, -1,
              "Exhaustive search times for cuDNN convolution, "
              "default is -1, not exhaustive search");
 
+/**
+ * CUDNN related FLAG
+ * Name: FLAGS_cudnn_algo_cache_file
+ * Since Version: 2.0.0
+ * Value Range: string, default=empty
+ * Example: FLAGS_cudnn_algo_cache_file=/path/to/conv_algo_cache
+ * Note: The file to load the convolution algorithms found by the exhaustive
+ *       search from when the process starts, and to save them to when the
+ *       process exits, so that the restarted processes need not search the
+ *       same layers again. The file is ignored if it is written on the GPU
+ *       of another model or with another version of cuDNN.
+ */
+DEFINE_string(cudnn_algo_cache_file, "",
+              "The file to persist the cuDNN convolution algorithms found "
+              "by the exhaustive search, default is empty, not persisted.");
+
 /**
  * CUDNN related FLAG
  * Name: FLAGS_cudnn_batchnorm_spatial_persistent
@@ -299,6 +339,25 @@ DEFINE_double(memory_fraction_of_eager_deletion, 1.0,
               "only the FLAGS_memory_fraction_of_eager_deletion of the largest "
               "variables would be deleted.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_async_cpu_garbage_collection_mb
+ * Since Version: 2.0.0
+ * Value Range: double, default=-1.0
+ * Example: FLAGS_async_cpu_garbage_collection_mb=64.0, the CPU memory garbage
+ *          is batched until it occupies 64MB of memory, and the batch is
+ *          released by a background thread.
+ * Note: Whether to release the CPU memory garbage asynchronously, which keeps
+ *       the memory release off the executing threads. The garbage is batched
+ *       until it reaches the larger one of this value and
+ *       FLAGS_eager_delete_tensor_gb. Disabled when this value is less than 0.
+ *       Only works when garbage collection strategy is enabled.
+ */
+DEFINE_double(async_cpu_garbage_collection_mb, -1.0,
+              "Memory size threshold (MB) when the CPU garbage collector "
+              "hands the garbage to its background thread. Disabled when "
+              "this value is less than 0");
+
 /**
  * Allocator related FLAG
  * Name: FLAGS_allocator_strategy
@@ -327,6 +386,77 @@ DEFINE_string(
     "on the same GPU card but may lead to more memory fragmentation "
     "(i.e., maximum batch size of models may be smaller).");
 
+/**
+ * Allocator related FLAG
+ * Name: FLAGS_cpu_allocator_strategy
+ * Since Version: 1.8
+ * Value Range: string, {naive_best_fit, slab, numa, registered},
+ *              default=naive_best_fit
+ * Example: FLAGS_cpu_allocator_strategy=slab would serve small CPU tensors
+ *          from the thread caching slab allocator.
+ *          FLAGS_cpu_allocator_strategy=numa would allocate CPU tensors from
+ *          the NUMA node of the calling thread.
+ *          FLAGS_cpu_allocator_strategy=registered would allocate CPU tensors
+ *          from the chunks registered to the RDMA transport.
+ * Note: For selecting CPU allocator policy of PaddlePaddle. registered is
+ *       only available when compiled with WITH_BRPC_RDMA=ON.
+ */
+DEFINE_string(
+    cpu_allocator_strategy, "naive_best_fit",
+    "The CPU allocation strategy, enum in [naive_best_fit, slab, numa, "
+    "registered]. "
+    "naive_best_fit means the original pre-allocated allocator of Paddle. "
+    "slab means that small allocations are served from power-of-two size "
+    "classes cached by each thread, and large allocations are allocated "
+    "from system directly. slab strategy avoids the lock contention when "
+    "many threads allocate small tensors frequently, e.g., the HogwildWorker "
+    "threads of CTR models. numa means that the memory is allocated from "
+    "the auto-growth arena of the NUMA node which the calling thread "
+    "runs on, and the HogwildWorker threads are bound to the NUMA nodes "
+    "round-robin, which avoids the cross-socket memory traffic. registered "
+    "means that the memory is allocated from large chunks which are "
+    "registered as the memory regions of the bRPC RDMA transport, so that "
+    "the tensors are sent from their own memory directly. registered is "
+    "only available when compiled with WITH_BRPC_RDMA=ON, since gRPC and "
+    "the plain bRPC transport have no registration hook.");
+
+/**
+ * Allocator related FLAG
+ * Name: FLAGS_use_virtual_memory_auto_growth
+ * Since Version: 1.8
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_virtual_memory_auto_growth=true would make the
+ *          auto_growth allocator grow its chunks in place in a reserved
+ *          virtual address range.
+ * Note: Only works when FLAGS_allocator_strategy=auto_growth on Linux with
+ *       CUDA 10.2 or higher. FLAGS_gpu_memory_limit_mb does not take effect.
+ */
+DEFINE_bool(use_virtual_memory_auto_growth, false,
+            "Whether to map the GPU memory into a reserved virtual address "
+            "range with the CUDA virtual memory management APIs when "
+            "FLAGS_allocator_strategy=auto_growth. If true, newly allocated "
+            "memory is contiguous with the existing chunks, so that the "
+            "chunks grow in place and the free blocks at their boundaries "
+            "can be merged, which reduces the memory fragmentation.");
+
+/**
+ * Memory related FLAG
+ * Name: FLAGS_use_shm_cache
+ * Since Version: 1.8
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_shm_cache=true would make the DataLoader worker
+ *          processes reuse the shared memory blocks of the batches which
+ *          have been released by the main process.
+ * Note: For reducing the cost of creating shared memory files in the
+ *       multiprocess DataLoader.
+ */
+DEFINE_bool(use_shm_cache, false,
+            "Whether to cache the shared memory blocks sending tensors "
+            "between processes, e.g., from the DataLoader workers to the "
+            "main process. If true, a block released by the receiver is "
+            "reused by the sender instead of creating a new shared memory "
+            "file for each tensor.");
+
 /**
  * Memory related FLAG
  * Name: FLAGS_fraction_of_cpu_memory_to_use
@@ -473,3 +603,21 @@ DEFINE_double(local_exe_sub_scope_limit, 256.0,  // MBytes
               "each CUDAPlace. If you don't need to limit the memory, "
               "you should set FLAGS_local_exe_sub_scope_limit=-1. "
               "The default value is 256 MBytes.");
+
+#ifdef PADDLE_WITH_MKLDNN
+/**
+ * MKLDNN related FLAG
+ * Name: FLAGS_mkldnn_cache_capacity_mb
+ * Since Version: 2.0.0
+ * Value Range: uint64, default=0 (MB)
+ * Example: FLAGS_mkldnn_cache_capacity_mb=1024
+ * Note: The budget of the memory allocated by MKLDNN for the cached
+ *       primitives of a session, e.g. the reordered weights. The least
+ *       recently used input shapes are evicted when it is exceeded, so it
+ *       works with the shapes cached apart, see
+ *       AnalysisConfig::SetMkldnnCacheCapacity. 0 means no budget.
+ */
+DEFINE_uint64(mkldnn_cache_capacity_mb, 0,
+              "The budget in MB of the memory of the MKLDNN primitive cache "
+              "of a session, default is 0, no budget.");
+#endif
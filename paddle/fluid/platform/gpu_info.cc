@@ -110,6 +110,17 @@ dim3 GetGpuMaxGridDimSize(int id) {
   return ret;
 }
 
+std::string GetCUDADeviceName(int id) {
+  PADDLE_ENFORCE_LT(id, GetCUDADeviceCount(),
+                    platform::errors::InvalidArgument(
+                        "Device id must be less than GPU count, "
+                        "but received id is: %d. GPU count is: %d.",
+                        id, GetCUDADeviceCount()));
+  cudaDeviceProp prop;
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaGetDeviceProperties(&prop, id));
+  return prop.name;
+}
+
 int GetCUDARuntimeVersion(int id) {
   PADDLE_ENFORCE_LT(id, GetCUDADeviceCount(),
                     platform::errors::InvalidArgument(
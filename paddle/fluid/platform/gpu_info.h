@@ -30,6 +30,9 @@ int GetCUDADeviceCount();
 //! Get the compute capability of the ith GPU (format: major * 10 + minor)
 int GetCUDAComputeCapability(int i);
 
+//! Get the model name of the ith GPU
+std::string GetCUDADeviceName(int id);
+
 //! Get the runtime version of the ith GPU
 int GetCUDARuntimeVersion(int id);
 
@@ -14,12 +14,15 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include "mkldnn.hpp"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/place.h"
 namespace paddle {
 #ifdef PADDLE_WITH_MKLDNN
@@ -138,6 +141,11 @@ template <>
 inline mkldnn::memory::data_type MKLDNNGetDataType<uint8_t>() {
   return mkldnn::memory::data_type::u8;
 }
+template <>
+inline mkldnn::memory::data_type
+MKLDNNGetDataType<paddle::platform::bfloat16>() {
+  return mkldnn::memory::data_type::bf16;
+}
 
 inline void Reorder(mkldnn::memory src, mkldnn::memory dst,
                     const mkldnn::engine& engine) {
@@ -333,53 +341,69 @@ inline std::string ThreadIDasStr(void) {
       std::hash<std::thread::id>()(std::this_thread::get_id()));
 }
 
-template <typename T>
-inline void AppendKey(std::string* key, const T& num) {
-  key->append(std::to_string(num));
+// The keys of the blobs are hashed from the arguments of CreateKey instead of
+// concatenating their strings, which is slow and ambiguous, e.g. the dims
+// {1, 23} and {12, 3} made the same key. The numbers are hashed by value, so
+// the same dims in int and int64_t still make the same key.
+inline void HashCombine(uint64_t* key, uint64_t value) {
+  *key ^= value + 0x9e3779b97f4a7c15ULL + (*key << 6) + (*key >> 2);
 }
 
-template <>
-inline void AppendKey(std::string* key,
-                      const mkldnn::memory::format_tag& format) {
-  key->append(std::to_string(static_cast<int>(format)));
+inline void HashBytes(uint64_t* key, const char* str, size_t len) {
+  uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+  for (size_t i = 0; i < len; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(str[i])) * 1099511628211ULL;
+  }
+  HashCombine(key, hash);
 }
 
-template <>
-inline void AppendKey(std::string* key,
-                      const mkldnn::memory::data_type& data_type) {
-  key->append(std::to_string(static_cast<int>(data_type)));
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value ||
+                               std::is_enum<T>::value>::type
+AppendKey(uint64_t* key, const T& num) {
+  HashCombine(key, static_cast<uint64_t>(static_cast<int64_t>(num)));
 }
 
-template <>
-inline void AppendKey(std::string* key, const mkldnn::algorithm& algorithm) {
-  key->append(std::to_string(static_cast<int>(algorithm)));
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+AppendKey(uint64_t* key, const T& num) {
+  double value = static_cast<double>(num);
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  HashCombine(key, bits);
 }
 
-template <>
-inline void AppendKey(std::string* key,
-                      const mkldnn::normalization_flags& flags) {
-  key->append(std::to_string(static_cast<int>(flags)));
+inline void AppendKey(uint64_t* key, const std::string& str) {
+  HashBytes(key, str.data(), str.size());
 }
 
-inline void AppendKey(std::string* key, const std::string& str) {
-  key->append(str);
+inline void AppendKey(uint64_t* key, const char* str) {
+  HashBytes(key, str, std::strlen(str));
 }
 
-inline void AppendKey(std::string* key, const char* str) { key->append(str); }
-
 template <typename T>
-inline void AppendKey(std::string* key, const std::vector<T>& dims) {
+inline void AppendKey(uint64_t* key, const std::vector<T>& dims) {
+  HashCombine(key, dims.size());
   for (size_t i = 0; i < dims.size(); i++) {
-    AppendKey(key, std::to_string(dims[i]));
+    AppendKey(key, dims[i]);
   }
 }
 
+// The key is the hash in 11 characters of 6 bits, which fit in the short
+// string buffer, so making and comparing it does not allocate. The handlers
+// append their suffixes to it.
 template <typename... ArgTypes>
 inline std::string CreateKey(ArgTypes&&... args) {
-  std::string key;
-  key.reserve(64);
+  uint64_t hash = 0;
   using expand_type = int[];
-  expand_type{0, (AppendKey(&key, std::forward<ArgTypes>(args)), 0)...};
+  expand_type{0, (AppendKey(&hash, std::forward<ArgTypes>(args)), 0)...};
+  static const char kDigits[] =
+      "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ-_";
+  std::string key(11, '0');
+  for (auto& c : key) {
+    c = kDigits[hash & 63];
+    hash >>= 6;
+  }
   return key;
 }
 
@@ -181,7 +181,7 @@ class MKLDNNHandlerT {
         std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
     if (mem_p == nullptr) {
       mem_p = std::make_shared<mkldnn::memory>(md, engine_);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      dev_ctx_.SetBlob(local_key, mem_p, md.get_size());
     }
     return mem_p;
   }
@@ -361,7 +361,8 @@ class MKLDNNHandler {
                                      {MKLDNN_ARG_TO, *target_memory_p}});
         astream.wait();
       }
-      dev_ctx_.SetBlob(local_key, target_memory_p);
+      dev_ctx_.SetBlob(local_key, target_memory_p,
+                       target_memory_p == user_memory_p ? 0 : md.get_size());
     } else if (!is_persistent) {
       // Make reorder if needed
       auto reorder_p = std::static_pointer_cast<mkldnn::reorder>(
@@ -772,7 +773,7 @@ class PoolingMKLDNNHandler : public MKLDNNHandlerT<T, mkldnn::pooling_forward,
           this->dev_ctx_.GetBlob(local_key));
       if (mem_p == nullptr) {
         mem_p = std::make_shared<mkldnn::memory>(workspace_md, this->engine_);
-        this->dev_ctx_.SetBlob(local_key, mem_p);
+        this->dev_ctx_.SetBlob(local_key, mem_p, workspace_md.get_size());
       }
     }
     return mem_p;
@@ -36,6 +36,20 @@ limitations under the License. */
 #include "paddle/fluid/string/printf.h"
 
 DEFINE_bool(enable_rpc_profiler, false, "Enable rpc profiler or not.");
+DEFINE_bool(profiler_chrome_trace, true,
+            "Whether DisableProfiler also writes the chrome trace of the "
+            "profile to <profile_path>.json, so that tools/timeline.py is not "
+            "needed to view it.");
+DEFINE_double(profiler_peak_gflops, 0.,
+              "The peak GFLOP/s of the device for the roofline summary of "
+              "the profiler, the ops far below the roofline are flagged if "
+              "both the peaks are given.");
+DEFINE_double(profiler_peak_gbps, 0.,
+              "The peak memory bandwidth in GB/s of the device for the "
+              "roofline summary of the profiler.");
+DEFINE_double(profiler_roofline_ratio, 0.1,
+              "The ops below this ratio of the roofline are flagged in the "
+              "roofline summary of the profiler.");
 
 namespace paddle {
 namespace platform {
@@ -64,7 +78,16 @@ double Event::CudaElapsedMs(const Event &e) const {
 }
 
 RecordEvent::RecordEvent(const std::string &name, const EventRole role) {
-  if (g_state == ProfilerState::kDisabled || name.empty()) return;
+  if (name.empty()) return;
+  if (g_state == ProfilerState::kDisabled) {
+    auto &sampler = SampledProfiler::Instance();
+    if (sampler.IsEnabled() && sampler.ShouldSample()) {
+      is_sampled_ = true;
+      sampled_name_id_ = sampler.NameId(name);
+      start_ns_ = PosixInNsec();
+    }
+    return;
+  }
 
   // do some initialization
   start_ns_ = PosixInNsec();
@@ -78,6 +101,11 @@ RecordEvent::RecordEvent(const std::string &name, const EventRole role) {
 }
 
 RecordEvent::~RecordEvent() {
+  if (is_sampled_) {
+    SampledProfiler::Instance().Record(sampled_name_id_, start_ns_,
+                                       PosixInNsec());
+    return;
+  }
   if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
   // lock is not needed, the code below is thread-safe
   DeviceTracer *tracer = GetDeviceTracer();
@@ -190,6 +218,15 @@ Event *PushEvent(const std::string &name, const EventRole role) {
 void PopEvent(const std::string &name, const EventRole role) {
   GetEventList().Record(EventType::kPopRange, name, g_thread_id, role);
 }
+
+void RecordOpCost(const std::string &op_type, double flops, double bytes) {
+  if (g_state == ProfilerState::kDisabled) return;
+  std::lock_guard<std::mutex> guard(g_op_costs_mutex);
+  auto &cost = g_op_costs[op_type];
+  ++cost.calls;
+  cost.flops += flops;
+  cost.bytes += bytes;
+}
 void EnableProfiler(ProfilerState state) {
   PADDLE_ENFORCE_NE(state, ProfilerState::kDisabled,
                     platform::errors::InvalidArgument(
@@ -228,6 +265,8 @@ void ResetProfiler() {
        it != g_all_mem_event_lists.end(); ++it) {
     (*it)->Clear();
   }
+  std::lock_guard<std::mutex> cost_guard(g_op_costs_mutex);
+  g_op_costs.clear();
 }
 
 void DisableProfiler(EventSortingKey sorted_key,
@@ -246,12 +285,17 @@ void DisableProfiler(EventSortingKey sorted_key,
     tracer->Disable();
     tracer->GenEventKernelCudaElapsedTime();
     tracer->GenProfile(profile_path);
+    if (FLAGS_profiler_chrome_trace) {
+      tracer->GenChromeTrace(profile_path + ".json");
+    }
   }
 
   std::vector<std::vector<Event>> all_events = GetAllEvents();
 
   ParseEvents(all_events, true, sorted_key);
   ParseEvents(all_events, false, sorted_key);
+  PrintRoofline(all_events, FLAGS_profiler_peak_gflops,
+                FLAGS_profiler_peak_gbps, FLAGS_profiler_roofline_ratio);
   if (VLOG_IS_ON(5)) {
     std::vector<std::vector<MemEvent>> all_mem_events = GetMemEvents();
     ParseMemEvents(all_mem_events);
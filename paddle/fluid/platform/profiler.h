@@ -27,6 +27,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/event.h"
 #include "paddle/fluid/platform/place.h"
+#include "paddle/fluid/platform/sampled_profiler.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/platform/gpu_info.h"
 #endif
@@ -130,6 +131,9 @@ struct RecordEvent {
   ~RecordEvent();
 
   bool is_enabled_{false};
+  // recorded by the sampled profiler instead
+  bool is_sampled_{false};
+  uint32_t sampled_name_id_;
   uint64_t start_ns_;
   // Event name
   std::string name_;
@@ -194,6 +198,9 @@ struct EventList {
 };
 
 void Mark(const std::string& name);
+// Record the estimated FLOPs and bytes read and written by a run of the op,
+// for the roofline report of the profiler.
+void RecordOpCost(const std::string& op_type, double flops, double bytes);
 void PushMemEvent(uint64_t start_ns, uint64_t end_ns, size_t bytes,
                   const Place& place, const std::string& annotation);
 void PopMemEvent(uint64_t start_ns, uint64_t end_ns, size_t bytes,
@@ -58,6 +58,15 @@ static thread_local std::shared_ptr<EventList<Event>> g_event_list;
 static std::list<std::shared_ptr<EventList<MemEvent>>> g_all_mem_event_lists;
 static thread_local std::shared_ptr<EventList<MemEvent>> g_mem_event_list;
 static std::mutex g_all_mem_event_lists_mutex;
+
+struct OpCostItem {
+  int64_t calls{0};
+  double flops{0.};
+  double bytes{0.};
+};
+static std::mutex g_op_costs_mutex;
+// the costs of the op types recorded by RecordOpCost
+static std::unordered_map<std::string, OpCostItem> g_op_costs;
 static thread_local int32_t g_mem_thread_id;
 static uint32_t g_mem_next_thread_id = 0;
 
@@ -752,6 +761,97 @@ void AnalyzeEvent(
     GetChildMap(sub_child_map, child_map);
   }
 }
+// The achieved FLOP/s and bytes/s of the op types with the costs, by the time
+// of their events. If the peaks of the device are given, the ops whose
+// performance is below the ratio of the roofline, i.e.
+// min(peak FLOP/s, intensity * peak bytes/s), are flagged.
+void PrintRoofline(const std::vector<std::vector<Event>> &events,
+                   double peak_gflops, double peak_gbps, double flag_ratio) {
+  std::unordered_map<std::string, OpCostItem> costs;
+  {
+    std::lock_guard<std::mutex> guard(g_op_costs_mutex);
+    costs = g_op_costs;
+  }
+  if (costs.empty()) return;
+
+  std::unordered_map<std::string, double> times;
+  for (auto &thread_events : events) {
+    std::unordered_map<std::string, std::vector<const Event *>> pushed;
+    for (auto &event : thread_events) {
+      if (!costs.count(event.name())) continue;
+      auto &stack = pushed[event.name()];
+      if (event.type() == EventType::kPushRange) {
+        stack.push_back(&event);
+      } else if (event.type() == EventType::kPopRange && !stack.empty()) {
+        double gpu_time = 0.;
+#ifdef PADDLE_WITH_CUDA
+        gpu_time = stack.back()->CudaElapsedMs(event);
+#endif
+        double cpu_time = stack.back()->CpuElapsedMs(event);
+        times[event.name()] += g_state == ProfilerState::kCUDA
+                                   ? gpu_time
+                                   : g_state == ProfilerState::kCPU
+                                         ? cpu_time
+                                         : gpu_time + cpu_time;
+        stack.pop_back();
+      }
+    }
+  }
+
+  std::vector<std::pair<std::string, double>> sorted(times.begin(),
+                                                     times.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<std::string, double> &a,
+               const std::pair<std::string, double> &b) {
+              return a.second > b.second;
+            });
+  const size_t name_width = 32, data_width = 14;
+  std::cout << "\n-------------------------"
+            << "      Roofline Summary     "
+            << "-------------------------\n\n";
+  if (peak_gflops > 0. && peak_gbps > 0.) {
+    std::cout << "Peak: " << peak_gflops << " GFLOP/s, " << peak_gbps
+              << " GB/s, flagged below " << flag_ratio * 100
+              << "% of the roofline\n\n";
+  }
+  std::cout.setf(std::ios::left);
+  std::cout << std::setw(name_width) << "Op" << std::setw(data_width)
+            << "Calls" << std::setw(data_width) << "Time(ms)"
+            << std::setw(data_width) << "GFLOP/s" << std::setw(data_width)
+            << "GB/s" << std::setw(data_width) << "FLOP/Byte";
+  if (peak_gflops > 0. && peak_gbps > 0.) {
+    std::cout << std::setw(data_width) << "Bound" << std::setw(data_width)
+              << "Roofline";
+  }
+  std::cout << std::endl;
+  for (auto &pair : sorted) {
+    auto &cost = costs[pair.first];
+    double ms = pair.second;
+    if (ms <= 0.) continue;
+    double gflops = cost.flops / ms / 1e6;
+    double gbps = cost.bytes / ms / 1e6;
+    double intensity = cost.bytes > 0. ? cost.flops / cost.bytes : 0.;
+    std::cout << std::setw(name_width) << pair.first << std::setw(data_width)
+              << cost.calls << std::setw(data_width) << ms
+              << std::setw(data_width) << gflops << std::setw(data_width)
+              << gbps << std::setw(data_width) << intensity;
+    if (peak_gflops > 0. && peak_gbps > 0.) {
+      bool memory_bound = intensity * peak_gbps < peak_gflops;
+      // the ops without FLOPs are measured by the bandwidth
+      double efficiency =
+          cost.flops > 0.
+              ? gflops / std::min(peak_gflops, intensity * peak_gbps)
+              : gbps / peak_gbps;
+      std::cout << std::setw(data_width)
+                << (memory_bound ? "memory" : "compute")
+                << std::setw(data_width)
+                << string::Sprintf("%.1f%%%s", efficiency * 100,
+                                   efficiency < flag_ratio ? " <<" : "");
+    }
+    std::cout << std::endl;
+  }
+}
+
 // Parse the event list and output the profiling report
 void ParseEvents(const std::vector<std::vector<Event>> &events,
                  bool merge_thread,
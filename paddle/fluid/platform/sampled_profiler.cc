@@ -0,0 +1,235 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampled_profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include "glog/logging.h"
+#include "paddle/fluid/platform/comm_stats.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+// The ring buffer of a thread holds at most kRingSize events between two
+// flushes, the events beyond are dropped.
+constexpr size_t kRingSize = 1 << 14;
+
+thread_local int g_step_depth = 0;
+
+}  // namespace
+
+// The ring buffer is written by its thread and read by the flushing thread
+// only, so that the head and the tail are enough to synchronize them.
+struct SampledProfiler::ThreadBuffer {
+  struct Entry {
+    uint32_t name_id;
+    uint64_t start_ns;
+    uint64_t end_ns;
+  };
+
+  ThreadBuffer() : entries(kRingSize) {}
+
+  bool Push(uint32_t name_id, uint64_t start_ns, uint64_t end_ns) {
+    size_t head_pos = head.load(std::memory_order_relaxed);
+    if (head_pos - tail.load(std::memory_order_acquire) == kRingSize) {
+      return false;
+    }
+    entries[head_pos % kRingSize] = Entry{name_id, start_ns, end_ns};
+    head.store(head_pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::vector<Entry> entries;
+  std::atomic<size_t> head{0};
+  std::atomic<size_t> tail{0};
+
+  // Only the thread looks up the ids, and the names are appended under the
+  // mutex, which is taken by the new names and the flushes only.
+  std::unordered_map<std::string, uint32_t> ids;
+  std::vector<std::string> names;
+  std::mutex names_mutex;
+};
+
+SampledProfiler& SampledProfiler::Instance() {
+  static SampledProfiler profiler;
+  return profiler;
+}
+
+void SampledProfiler::Enable(const SampledProfilerOptions& options) {
+  PADDLE_ENFORCE_GT(options.step_interval, 0,
+                    platform::errors::InvalidArgument(
+                        "The step_interval of the sampled profiler should be "
+                        "positive, but got %d.",
+                        options.step_interval));
+  PADDLE_ENFORCE_GT(options.flush_interval, 0,
+                    platform::errors::InvalidArgument(
+                        "The flush_interval of the sampled profiler should be "
+                        "positive, but got %d.",
+                        options.flush_interval));
+  PADDLE_ENFORCE_EQ(
+      options.event_ratio >= 0. && options.event_ratio <= 1., true,
+      platform::errors::InvalidArgument(
+          "The event_ratio of the sampled profiler should be in [0, 1], but "
+          "got %f.",
+          options.event_ratio));
+  if (IsEnabled()) Disable();
+  {
+    std::lock_guard<std::mutex> guard(flush_mutex_);
+    options_ = options;
+  }
+  step_.store(0, std::memory_order_relaxed);
+  step_sampled_.store(true, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+  VLOG(3) << "Enable the sampled profiler, one step in every "
+          << options.step_interval << " steps, " << options.event_ratio
+          << " of the events.";
+}
+
+void SampledProfiler::Disable() {
+  if (!enabled_.exchange(false, std::memory_order_acq_rel)) return;
+  Flush();
+}
+
+void SampledProfiler::SetFlushCallback(FlushCallback callback) {
+  std::lock_guard<std::mutex> guard(flush_mutex_);
+  callback_ = std::move(callback);
+}
+
+bool SampledProfiler::ShouldSample() {
+  if (!step_sampled_.load(std::memory_order_relaxed)) return false;
+  if (options_.event_ratio >= 1.) return true;
+  thread_local std::minstd_rand engine(
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+  thread_local std::uniform_real_distribution<double> dist(0., 1.);
+  return dist(engine) < options_.event_ratio;
+}
+
+SampledProfiler::ThreadBuffer* SampledProfiler::CurrentBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> guard(buffers_mutex_);
+    buffers_.push_back(buffer);
+  }
+  return buffer.get();
+}
+
+uint32_t SampledProfiler::NameId(const std::string& name) {
+  auto* buffer = CurrentBuffer();
+  auto it = buffer->ids.find(name);
+  if (it != buffer->ids.end()) return it->second;
+  std::lock_guard<std::mutex> guard(buffer->names_mutex);
+  uint32_t id = static_cast<uint32_t>(buffer->names.size());
+  buffer->names.push_back(name);
+  buffer->ids.emplace(name, id);
+  return id;
+}
+
+void SampledProfiler::Record(uint32_t name_id, uint64_t start_ns,
+                             uint64_t end_ns) {
+  if (!CurrentBuffer()->Push(name_id, start_ns, end_ns)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void SampledProfiler::EndStep() {
+  if (!IsEnabled()) return;
+  int64_t step = step_.fetch_add(1, std::memory_order_relaxed) + 1;
+  step_sampled_.store(step % options_.step_interval == 0,
+                      std::memory_order_relaxed);
+  if (step % options_.flush_interval == 0) Flush();
+}
+
+void SampledProfiler::Drain(
+    std::unordered_map<std::string, SampledEventStat>* stats) {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> guard(buffers_mutex_);
+    buffers = buffers_;
+  }
+  for (auto& buffer : buffers) {
+    size_t tail_pos = buffer->tail.load(std::memory_order_relaxed);
+    size_t head_pos = buffer->head.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> guard(buffer->names_mutex);
+    for (size_t i = tail_pos; i < head_pos; ++i) {
+      auto& entry = buffer->entries[i % kRingSize];
+      double ms = (entry.end_ns - entry.start_ns) / 1000000.;
+      auto& name = buffer->names[entry.name_id];
+      auto& stat = (*stats)[name];
+      if (stat.calls == 0) {
+        stat.name = name;
+        stat.min_ms = std::numeric_limits<double>::max();
+      }
+      ++stat.calls;
+      stat.total_ms += ms;
+      stat.min_ms = std::min(stat.min_ms, ms);
+      stat.max_ms = std::max(stat.max_ms, ms);
+    }
+    buffer->tail.store(head_pos, std::memory_order_release);
+  }
+}
+
+void SampledProfiler::Flush() {
+  std::lock_guard<std::mutex> guard(flush_mutex_);
+  std::unordered_map<std::string, SampledEventStat> stat_map;
+  Drain(&stat_map);
+  if (stat_map.empty()) return;
+  std::vector<SampledEventStat> stats;
+  stats.reserve(stat_map.size());
+  for (auto& pair : stat_map) stats.push_back(std::move(pair.second));
+  std::sort(stats.begin(), stats.end(),
+            [](const SampledEventStat& a, const SampledEventStat& b) {
+              return a.total_ms > b.total_ms;
+            });
+
+  int64_t step = step_.load(std::memory_order_relaxed);
+  if (!options_.path.empty()) {
+    std::ofstream file(options_.path, std::ios::out | std::ios::app);
+    if (file.is_open()) {
+      // step name calls total_ms min_ms max_ms, separated by tabs
+      for (auto& stat : stats) {
+        file << step << "\t" << stat.name << "\t" << stat.calls << "\t"
+             << stat.total_ms << "\t" << stat.min_ms << "\t" << stat.max_ms
+             << "\n";
+      }
+    } else {
+      LOG(WARNING) << "Can not open " << options_.path
+                   << " to flush the sampled profiler.";
+    }
+  }
+  if (callback_) callback_(step, stats);
+  VLOG(4) << "Flush " << stats.size() << " sampled events at step " << step
+          << ", " << Dropped() << " events are dropped so far.";
+}
+
+RecordStep::RecordStep() {
+  is_outermost_ = g_step_depth++ == 0;
+}
+
+RecordStep::~RecordStep() {
+  --g_step_depth;
+  if (!is_outermost_) return;
+  SampledProfiler::Instance().EndStep();
+  if (CommStats::IsEnabled()) CommStats::Instance().EndStep();
+}
+
+}  // namespace platform
+}  // namespace paddle
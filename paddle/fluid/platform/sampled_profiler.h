@@ -0,0 +1,123 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+struct SampledProfilerOptions {
+  // Sample one step in every step_interval steps.
+  int step_interval{100};
+  // The probability to sample each event of a sampled step.
+  double event_ratio{1.0};
+  // Flush the aggregated events every flush_interval steps.
+  int flush_interval{1000};
+  // Append the aggregated events to the file, if it is not empty.
+  std::string path;
+};
+
+// The aggregated time of the sampled events of a name.
+struct SampledEventStat {
+  std::string name;
+  int64_t calls{0};
+  double total_ms{0.};
+  double min_ms{0.};
+  double max_ms{0.};
+};
+
+/*
+ * The sampled mode of the profiler, which is cheap enough to be always on in
+ * the training and serving jobs. When the profiler is disabled, RecordEvent
+ * records the sampled events into the ring buffer of its thread without any
+ * lock or allocation, and the events are aggregated by name and flushed
+ * periodically to a file or a callback.
+ *
+ * The steps are counted by RecordStep in the executors, the events outside
+ * of the steps, e.g. in dygraph, are sampled by the event_ratio only.
+ */
+class SampledProfiler {
+ public:
+  using FlushCallback = std::function<void(
+      int64_t step, const std::vector<SampledEventStat>& stats)>;
+
+  static SampledProfiler& Instance();
+
+  void Enable(const SampledProfilerOptions& options);
+  // Flush the remaining events and stop sampling.
+  void Disable();
+  bool IsEnabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  // Called with the stats of every flush, besides writing the file.
+  void SetFlushCallback(FlushCallback callback);
+
+  // Whether to sample the event starting now on the current thread.
+  bool ShouldSample();
+  // The id of the name in the current thread, to record the event without
+  // copying the name.
+  uint32_t NameId(const std::string& name);
+  void Record(uint32_t name_id, uint64_t start_ns, uint64_t end_ns);
+
+  // Decide whether to sample the next step, and flush periodically.
+  void EndStep();
+
+  // Aggregate the recorded events of all threads and flush them.
+  void Flush();
+
+  // The number of the events dropped since the ring buffers are full.
+  int64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct ThreadBuffer;
+
+  SampledProfiler() = default;
+  ThreadBuffer* CurrentBuffer();
+  void Drain(std::unordered_map<std::string, SampledEventStat>* stats);
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> step_sampled_{true};
+  SampledProfilerOptions options_;
+  std::atomic<int64_t> step_{0};
+  std::atomic<int64_t> dropped_{0};
+
+  std::mutex buffers_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+  std::mutex flush_mutex_;
+  FlushCallback callback_;
+};
+
+// Count a step of the sampled profiler and the CommStats, only the outermost
+// one of the nested RecordSteps in a thread, e.g. of the executors running the
+// sub blocks, is counted.
+class RecordStep {
+ public:
+  RecordStep();
+  ~RecordStep();
+
+ private:
+  bool is_outermost_{false};
+};
+
+}  // namespace platform
+}  // namespace paddle
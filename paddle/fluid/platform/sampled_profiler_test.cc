@@ -0,0 +1,101 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampled_profiler.h"
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace platform {
+
+static int64_t SampledCalls(const std::vector<SampledEventStat>& stats,
+                            const std::string& name) {
+  for (auto& stat : stats) {
+    if (stat.name == name) return stat.calls;
+  }
+  return 0;
+}
+
+TEST(SampledProfiler, sample_steps) {
+  auto& sampler = SampledProfiler::Instance();
+  std::vector<int64_t> flushed_steps;
+  int64_t calls = 0;
+  sampler.SetFlushCallback(
+      [&](int64_t step, const std::vector<SampledEventStat>& stats) {
+        flushed_steps.push_back(step);
+        calls += SampledCalls(stats, "op");
+        EXPECT_LE(SampledCalls(stats, "op"), 4);
+      });
+  SampledProfilerOptions options;
+  options.step_interval = 2;
+  options.flush_interval = 4;
+  sampler.Enable(options);
+  for (int step = 0; step < 8; ++step) {
+    RecordStep record_step;
+    for (int i = 0; i < 2; ++i) {
+      RecordEvent event("op");
+    }
+    // the nested steps are not counted
+    RecordStep nested_step;
+  }
+  sampler.Disable();
+  // the steps 0, 2, 4 and 6 are sampled
+  EXPECT_EQ(calls, 8);
+  EXPECT_EQ(flushed_steps, std::vector<int64_t>({4, 8}));
+
+  // the events are not sampled after the profiler is disabled
+  calls = 0;
+  { RecordEvent event("op"); }
+  sampler.Flush();
+  EXPECT_EQ(calls, 0);
+  sampler.SetFlushCallback(nullptr);
+}
+
+TEST(SampledProfiler, sample_events_of_threads) {
+  auto& sampler = SampledProfiler::Instance();
+  int64_t first = 0, second = 0;
+  sampler.SetFlushCallback(
+      [&](int64_t step, const std::vector<SampledEventStat>& stats) {
+        first += SampledCalls(stats, "first");
+        second += SampledCalls(stats, "second");
+      });
+  SampledProfilerOptions options;
+  options.event_ratio = 0.5;
+  sampler.Enable(options);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; ++i) {
+        RecordEvent event(i % 2 ? "first" : "second");
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  sampler.Disable();
+  EXPECT_GT(first, 0);
+  EXPECT_LT(first, 2000);
+  EXPECT_GT(second, 0);
+  EXPECT_LT(second, 2000);
+  EXPECT_EQ(sampler.Dropped(), 0);
+  sampler.SetFlushCallback(nullptr);
+
+  options.step_interval = 0;
+  EXPECT_ANY_THROW(sampler.Enable(options));
+}
+
+}  // namespace platform
+}  // namespace paddle
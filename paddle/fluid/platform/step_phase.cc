@@ -0,0 +1,95 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/step_phase.h"
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <sstream>
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+uint64_t NowInNsec() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// the innermost phase of the current thread
+thread_local RecordStepPhase* g_current_phase = nullptr;
+
+}  // namespace
+
+const char* StepPhaseName(StepPhase phase) {
+  switch (phase) {
+    case StepPhase::kDataWait:
+      return "data_wait";
+    case StepPhase::kCompute:
+      return "compute";
+    case StepPhase::kComm:
+      return "comm";
+  }
+  return "unknown";
+}
+
+double StepPhaseTimes::Total() const {
+  double total = 0.;
+  for (auto t : ms) total += t;
+  return total;
+}
+
+void StepPhaseTimes::Reset() {
+  for (auto& t : ms) t = 0.;
+}
+
+std::string StepPhaseTimes::Summary(int64_t steps) const {
+  double total = Total();
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(3);
+  for (int i = 0; i < kNumStepPhases; ++i) {
+    if (i > 0) ss << ", ";
+    ss << StepPhaseName(static_cast<StepPhase>(i)) << ": "
+       << (steps > 0 ? ms[i] / steps : 0.) << "ms/step ("
+       << std::setprecision(1) << (total > 0. ? ms[i] / total * 100. : 0.)
+       << "%)" << std::setprecision(3);
+  }
+  return ss.str();
+}
+
+StepPhaseTimes* ThreadStepPhaseTimes() {
+  static thread_local StepPhaseTimes times;
+  return &times;
+}
+
+RecordStepPhase::RecordStepPhase(StepPhase phase, const std::string& name)
+    : phase_(phase),
+      start_ns_(NowInNsec()),
+      parent_(g_current_phase),
+      event_(std::string(StepPhaseName(phase)) + "/" + name,
+             EventRole::kInnerOp) {
+  g_current_phase = this;
+}
+
+RecordStepPhase::~RecordStepPhase() {
+  uint64_t elapsed_ns = NowInNsec() - start_ns_;
+  uint64_t self_ns = elapsed_ns > nested_ns_ ? elapsed_ns - nested_ns_ : 0;
+  ThreadStepPhaseTimes()->ms[static_cast<int>(phase_)] += self_ns / 1e6;
+  if (parent_ != nullptr) parent_->nested_ns_ += elapsed_ns;
+  g_current_phase = parent_;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,71 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace platform {
+
+// The phases a training step is split into.
+enum class StepPhase {
+  // waiting for the readers and the data feeds
+  kDataWait = 0,
+  kCompute = 1,
+  // the communication with the parameter servers and the other trainers
+  kComm = 2,
+};
+
+constexpr int kNumStepPhases = 3;
+
+const char* StepPhaseName(StepPhase phase);
+
+// The time of each phase spent by a thread, the nested phases are excluded
+// from the enclosing one.
+struct StepPhaseTimes {
+  double ms[kNumStepPhases] = {0., 0., 0.};
+
+  double Total() const;
+  void Reset();
+  // The mean time per step and the percentage of each phase.
+  std::string Summary(int64_t steps) const;
+};
+
+// The times of the current thread.
+StepPhaseTimes* ThreadStepPhaseTimes();
+
+/*
+ * Add the time of the scope to the phase of the current thread, and record
+ * an event named "<phase>/<name>" in the profiler. The phases can be nested,
+ * e.g., a reader op waiting for the data in the compute phase.
+ */
+class RecordStepPhase {
+ public:
+  RecordStepPhase(StepPhase phase, const std::string& name);
+  ~RecordStepPhase();
+
+ private:
+  StepPhase phase_;
+  uint64_t start_ns_;
+  // the time of the nested phases
+  uint64_t nested_ns_{0};
+  RecordStepPhase* parent_;
+  RecordEvent event_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,61 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/step_phase.h"
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(StepPhase, nested_phases) {
+  auto* times = ThreadStepPhaseTimes();
+  times->Reset();
+  {
+    RecordStepPhase compute(StepPhase::kCompute, "ops");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+      RecordStepPhase data_wait(StepPhase::kDataWait, "read");
+      std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    {
+      RecordStepPhase comm(StepPhase::kComm, "send");
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  EXPECT_GE(times->ms[static_cast<int>(StepPhase::kDataWait)], 30.);
+  EXPECT_GE(times->ms[static_cast<int>(StepPhase::kComm)], 10.);
+  double compute_ms = times->ms[static_cast<int>(StepPhase::kCompute)];
+  EXPECT_GE(compute_ms, 20.);
+  // the nested phases are excluded
+  EXPECT_LT(compute_ms, 30.);
+  EXPECT_GE(times->Total(), 60.);
+
+  auto summary = times->Summary(2);
+  EXPECT_NE(summary.find("data_wait"), std::string::npos);
+  EXPECT_NE(summary.find("compute"), std::string::npos);
+  EXPECT_NE(summary.find("comm"), std::string::npos);
+
+  // the times are of each thread
+  std::thread([] {
+    EXPECT_DOUBLE_EQ(ThreadStepPhaseTimes()->Total(), 0.);
+  }).join();
+  times->Reset();
+  EXPECT_DOUBLE_EQ(times->Total(), 0.);
+}
+
+}  // namespace platform
+}  // namespace paddle
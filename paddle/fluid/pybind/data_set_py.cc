@@ -243,6 +243,8 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("load_into_memory", &framework::Dataset::LoadIntoMemory,
            py::call_guard<py::gil_scoped_release>())
+      .def("convert_to_binary", &framework::Dataset::ConvertToBinary,
+           py::call_guard<py::gil_scoped_release>())
       .def("preload_into_memory", &framework::Dataset::PreLoadIntoMemory,
            py::call_guard<py::gil_scoped_release>())
       .def("wait_preload_done", &framework::Dataset::WaitPreLoadDone,
@@ -308,6 +310,27 @@ void BindDataset(py::module *m) {
       .def("set_fleet_send_sleep_seconds",
            &framework::Dataset::SetFleetSendSleepSeconds,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_fleet_send_window_size",
+           &framework::Dataset::SetFleetSendWindowSize,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_compress_shuffle_msg",
+           &framework::Dataset::SetCompressShuffleMsg,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_channel_shard_num", &framework::Dataset::SetChannelShardNum,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_spill_config", &framework::Dataset::SetSpillConfig,
+           py::call_guard<py::gil_scoped_release>())
+      .def("start_spill_stream", &framework::Dataset::StartSpillStream,
+           py::call_guard<py::gil_scoped_release>())
+      .def("wait_spill_stream_done",
+           &framework::Dataset::WaitSpillStreamDone,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_read_ahead", &framework::Dataset::SetReadAhead,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_pipeline_stat", &framework::Dataset::GetPipelineStat,
+           py::call_guard<py::gil_scoped_release>())
+      .def("reset_pipeline_stat", &framework::Dataset::ResetPipelineStat,
+           py::call_guard<py::gil_scoped_release>())
       .def("enable_pv_merge", &framework::Dataset::EnablePvMerge,
            py::call_guard<py::gil_scoped_release>());
 
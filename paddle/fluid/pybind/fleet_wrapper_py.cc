@@ -70,6 +70,9 @@ void BindFleetWrapper(py::module* m) {
       .def("shrink_sparse_table", &framework::FleetWrapper::ShrinkSparseTable)
       .def("shrink_dense_table", &framework::FleetWrapper::ShrinkDenseTable)
       .def("print_table_stat", &framework::FleetWrapper::PrintTableStat)
+      .def("set_sparse_row_cache", &framework::FleetWrapper::SetSparseRowCache)
+      .def("print_sparse_row_cache_stat",
+           &framework::FleetWrapper::PrintSparseRowCacheStat)
       .def("client_flush", &framework::FleetWrapper::ClientFlush)
       .def("load_from_paddle_model",
            &framework::FleetWrapper::LoadFromPaddleModel)
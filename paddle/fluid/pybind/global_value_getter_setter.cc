@@ -33,31 +33,52 @@ DECLARE_bool(use_mkldnn);
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(cpu_deterministic);
 DECLARE_bool(enable_rpc_profiler);
+DECLARE_bool(profiler_chrome_trace);
+DECLARE_double(profiler_peak_gflops);
+DECLARE_double(profiler_peak_gbps);
+DECLARE_double(profiler_roofline_ratio);
 DECLARE_int32(multiple_of_cupti_buffer_size);
 DECLARE_bool(reader_queue_speed_test_mode);
+DECLARE_int32(reader_max_buffer_size);
 // device management
 DECLARE_int32(paddle_num_threads);
 // executor
 DECLARE_bool(enable_parallel_graph);
 DECLARE_string(pe_profile_fname);
+DECLARE_string(pe_timeline_fname);
+DECLARE_int32(pe_timeline_step);
 DECLARE_string(print_sub_graph_dir);
 DECLARE_bool(use_ngraph);
 // memory management
 DECLARE_string(allocator_strategy);
+DECLARE_string(cpu_allocator_strategy);
 DECLARE_double(eager_delete_tensor_gb);
+DECLARE_double(async_cpu_garbage_collection_mb);
 DECLARE_double(fraction_of_cpu_memory_to_use);
 DECLARE_bool(free_idle_chunk);
 DECLARE_bool(free_when_no_cache_hit);
+DECLARE_bool(compact_when_oom);
+DECLARE_bool(use_virtual_memory_auto_growth);
 DECLARE_int32(fuse_parameter_groups_size);
+DECLARE_bool(fuse_grad_in_ready_order);
 DECLARE_double(fuse_parameter_memory_size);
 DECLARE_bool(init_allocated_mem);
 DECLARE_uint64(initial_cpu_memory_in_mb);
 DECLARE_double(memory_fraction_of_eager_deletion);
 DECLARE_bool(use_pinned_memory);
 DECLARE_bool(use_system_allocator);
+DECLARE_uint64(huge_page_threshold_mb);
+DECLARE_bool(use_shm_cache);
 // others
 DECLARE_bool(benchmark);
 DECLARE_int32(inner_op_parallelism);
+DECLARE_bool(cache_runtime_infer_shape);
+DECLARE_bool(cache_transformed_persistable_vars);
+DECLARE_bool(tensor_copy_on_write);
+DECLARE_bool(borrow_numpy_feed);
+DECLARE_bool(async_checkpoint);
+DECLARE_int32(executor_num_threads);
+DECLARE_int32(executor_prepare_cache_capacity);
 DECLARE_string(tracer_profile_fname);
 #ifdef PADDLE_WITH_CUDA
 // cudnn
@@ -65,6 +86,7 @@ DECLARE_uint64(conv_workspace_size_limit);
 DECLARE_bool(cudnn_batchnorm_spatial_persistent);
 DECLARE_bool(cudnn_deterministic);
 DECLARE_bool(cudnn_exhaustive_search);
+DECLARE_string(cudnn_algo_cache_file);
 // data processing
 DECLARE_bool(enable_cublas_tensor_op_math);
 // device management
@@ -80,6 +102,9 @@ DECLARE_uint64(reallocate_gpu_memory_in_mb);
 // others
 DECLARE_bool(sync_nccl_allreduce);
 #endif
+#ifdef PADDLE_WITH_MKLDNN
+DECLARE_uint64(mkldnn_cache_capacity_mb);
+#endif
 #ifdef PADDLE_WITH_DISTRIBUTE
 DECLARE_int32(rpc_send_thread_num);
 DECLARE_int32(rpc_get_thread_num);
@@ -332,31 +357,47 @@ void BindGlobalValueGetterSetter(pybind11::module *module) {
 static void RegisterGlobalVarGetterSetter() {
   REGISTER_PRIVATE_GLOBAL_VAR(/*is_writable=*/false, FLAGS_use_mkldnn,
                               FLAGS_free_idle_chunk,
-                              FLAGS_free_when_no_cache_hit);
+                              FLAGS_free_when_no_cache_hit,
+                              FLAGS_compact_when_oom,
+                              FLAGS_use_virtual_memory_auto_growth);
 
   REGISTER_PUBLIC_GLOBAL_VAR(
       FLAGS_eager_delete_tensor_gb, FLAGS_enable_parallel_graph,
       FLAGS_allocator_strategy, FLAGS_use_system_allocator, FLAGS_check_nan_inf,
       FLAGS_cpu_deterministic, FLAGS_enable_rpc_profiler,
+      FLAGS_profiler_chrome_trace, FLAGS_profiler_peak_gflops,
+      FLAGS_profiler_peak_gbps, FLAGS_profiler_roofline_ratio,
       FLAGS_multiple_of_cupti_buffer_size, FLAGS_reader_queue_speed_test_mode,
+      FLAGS_reader_max_buffer_size,
       FLAGS_pe_profile_fname, FLAGS_print_sub_graph_dir,
       FLAGS_fraction_of_cpu_memory_to_use, FLAGS_fuse_parameter_groups_size,
       FLAGS_fuse_parameter_memory_size, FLAGS_init_allocated_mem,
       FLAGS_initial_cpu_memory_in_mb, FLAGS_memory_fraction_of_eager_deletion,
       FLAGS_use_pinned_memory, FLAGS_benchmark, FLAGS_inner_op_parallelism,
-      FLAGS_tracer_profile_fname, FLAGS_paddle_num_threads);
+      FLAGS_tracer_profile_fname, FLAGS_paddle_num_threads,
+      FLAGS_cpu_allocator_strategy, FLAGS_huge_page_threshold_mb,
+      FLAGS_use_shm_cache, FLAGS_executor_num_threads,
+      FLAGS_executor_prepare_cache_capacity, FLAGS_cache_runtime_infer_shape,
+      FLAGS_async_cpu_garbage_collection_mb,
+      FLAGS_cache_transformed_persistable_vars, FLAGS_tensor_copy_on_write,
+      FLAGS_fuse_grad_in_ready_order, FLAGS_pe_timeline_fname,
+      FLAGS_pe_timeline_step, FLAGS_async_checkpoint, FLAGS_borrow_numpy_feed);
 
 #ifdef PADDLE_WITH_CUDA
   REGISTER_PUBLIC_GLOBAL_VAR(
       FLAGS_gpu_memory_limit_mb, FLAGS_cudnn_deterministic,
       FLAGS_conv_workspace_size_limit, FLAGS_cudnn_batchnorm_spatial_persistent,
-      FLAGS_cudnn_exhaustive_search, FLAGS_eager_delete_scope,
+      FLAGS_cudnn_exhaustive_search, FLAGS_cudnn_algo_cache_file,
+      FLAGS_eager_delete_scope,
       FLAGS_fast_eager_deletion_mode,
       FLAGS_fraction_of_cuda_pinned_memory_to_use,
       FLAGS_fraction_of_gpu_memory_to_use, FLAGS_initial_gpu_memory_in_mb,
       FLAGS_reallocate_gpu_memory_in_mb, FLAGS_enable_cublas_tensor_op_math,
       FLAGS_selected_gpus, FLAGS_sync_nccl_allreduce);
 #endif
+#ifdef PADDLE_WITH_MKLDNN
+  REGISTER_PUBLIC_GLOBAL_VAR(FLAGS_mkldnn_cache_capacity_mb);
+#endif
 #ifdef PADDLE_WITH_DITRIBUTE
   REGISTER_PUBLIC_GLOBAL_VAR(FLAGS_rpc_send_thread_num,
                              FLAGS_rpc_get_thread_num,
@@ -29,10 +29,12 @@ limitations under the License. */
 #include "paddle/fluid/imperative/backward_strategy.h"
 #include "paddle/fluid/imperative/basic_engine.h"
 #include "paddle/fluid/imperative/data_loader.h"
+#include "paddle/fluid/imperative/jit/traced_program_cache.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/nccl_context.h"
 #include "paddle/fluid/imperative/partial_grad_engine.h"
 #include "paddle/fluid/imperative/profiler.h"
+#include "paddle/fluid/imperative/reducer.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
@@ -494,6 +496,18 @@ void BindImperative(py::module *m_ptr) {
 
         By Default: False
 
+        **num_threads**:
+
+        The number of threads running the independent grad ops concurrently, e.g. the branches of the heads sharing a trunk. The gradients of the ops running on GPU are still computed on the stream of the device one kernel after another, and the gradients may be summed in a different order without sort_sum_gradient.
+
+        By Default: 1
+
+        **release_intermediate_grads**:
+
+        If framework will release the gradients of the non-leaf variables, i.e. the variables computed from the variables requiring gradients, once all the grad ops reading them are done. It lowers the peak memory of backward, while the gradients of these variables can not be fetched after backward.
+
+        By Default: False
+
         Examples:
             .. code-block:: python
 
@@ -521,6 +535,28 @@ void BindImperative(py::module *m_ptr) {
                     [](imperative::detail::BackwardStrategy &self,
                        bool sorted_sum_gradient) {
                       self.sorted_sum_gradient_ = sorted_sum_gradient;
+                    })
+      .def_property("num_threads",
+                    [](const imperative::detail::BackwardStrategy &self) {
+                      return self.num_threads_;
+                    },
+                    [](imperative::detail::BackwardStrategy &self,
+                       size_t num_threads) {
+                      PADDLE_ENFORCE_GT(num_threads, 0UL,
+                                        platform::errors::InvalidArgument(
+                                            "The num_threads of "
+                                            "BackwardStrategy must be "
+                                            "positive."));
+                      self.num_threads_ = num_threads;
+                    })
+      .def_property("release_intermediate_grads",
+                    [](const imperative::detail::BackwardStrategy &self) {
+                      return self.release_intermediate_grads_;
+                    },
+                    [](imperative::detail::BackwardStrategy &self,
+                       bool release_intermediate_grads) {
+                      self.release_intermediate_grads_ =
+                          release_intermediate_grads;
                     });
 
   m.def("start_imperative_gperf_profiler",
@@ -528,6 +564,37 @@ void BindImperative(py::module *m_ptr) {
 
   m.def("stop_imperative_gperf_profiler", []() { imperative::StopProfile(); });
 
+  m.def("_start_op_profiler",
+        [](size_t capacity, bool sync_device) {
+          imperative::OpProfiler::Instance().Start(capacity, sync_device);
+        },
+        py::arg("capacity"), py::arg("sync_device") = false);
+  m.def("_stop_op_profiler",
+        []() { imperative::OpProfiler::Instance().Stop(); });
+  m.def("_is_op_profiler_enabled",
+        []() { return imperative::OpProfiler::Instance().IsEnabled(); });
+  m.def("_op_profiler_summary", [](size_t max_rows) {
+    return imperative::OpProfiler::Instance().Summary(max_rows);
+  });
+  m.def("_op_profiler_records", []() {
+    py::list records;
+    for (auto &record : imperative::OpProfiler::Instance().Records()) {
+      py::dict item;
+      item["type"] = record.type;
+      item["layer"] = record.scope;
+      item["backward"] = record.is_backward;
+      item["time_ns"] = record.end_ns - record.start_ns;
+      item["output_bytes"] = record.output_bytes;
+      records.append(item);
+    }
+    return records;
+  });
+  m.def("_export_op_profiler_chrome_trace", [](const std::string &path) {
+    imperative::OpProfiler::Instance().ExportChromeTrace(path);
+  });
+  m.def("_push_op_profiler_scope", &imperative::OpProfiler::PushScope);
+  m.def("_pop_op_profiler_scope", &imperative::OpProfiler::PopScope);
+
   m.def("_is_dygraph_debug_enabled",
         []() { return imperative::IsDebugEnabled(); });
   m.def("_dygraph_debug_level", []() { return imperative::GetDebugLevel(); });
@@ -837,6 +904,26 @@ void BindImperative(py::module *m_ptr) {
            &imperative::jit::ProgramDescTracer::CreateProgramDesc)
       .def("reset", &imperative::jit::ProgramDescTracer::Reset);
 
+  py::class_<imperative::jit::TracedProgramCache>(m, "TracedProgramCache", "")
+      .def("__init__",
+           [](imperative::jit::TracedProgramCache &self,
+              const platform::CPUPlace &place,
+              const std::vector<std::string> &passes) {
+             new (&self) imperative::jit::TracedProgramCache(place, passes);
+           })
+      .def("__init__",
+           [](imperative::jit::TracedProgramCache &self,
+              const platform::CUDAPlace &place,
+              const std::vector<std::string> &passes) {
+             new (&self) imperative::jit::TracedProgramCache(place, passes);
+           })
+      .def_static("signature", &imperative::jit::TracedProgramCache::Signature)
+      .def("has", &imperative::jit::TracedProgramCache::Has)
+      .def("size", &imperative::jit::TracedProgramCache::Size)
+      .def("insert", &imperative::jit::TracedProgramCache::Insert)
+      .def("run", &imperative::jit::TracedProgramCache::Run,
+           py::call_guard<py::gil_scoped_release>());
+
   py::class_<imperative::Tracer, std::shared_ptr<imperative::Tracer>>(
       m, "Tracer",
       R"DOC()DOC")
@@ -847,6 +934,10 @@ void BindImperative(py::module *m_ptr) {
                     &imperative::Tracer::SetEnableProgramDescTracing)
       .def_property("_train_mode", &imperative::Tracer::HasGrad,
                     &imperative::Tracer::SetHasGrad)
+      .def_property("_enable_autocast",
+                    &imperative::Tracer::IsAutoCastEnabled,
+                    &imperative::Tracer::SetEnableAutoCast)
+      .def("_set_amp_op_list", &imperative::Tracer::SetAmpOpLists)
       .def_property(
           "_expected_place",
           [](const imperative::Tracer &self) -> py::object {
@@ -960,6 +1051,14 @@ void BindImperative(py::module *m_ptr) {
       .def(py::init<const imperative::ParallelStrategy &,
                     const platform::CUDAPlace &>())
       .def("init", [](imperative::NCCLParallelContext &self) { self.Init(); });
+
+  py::class_<imperative::Reducer, std::shared_ptr<imperative::Reducer>>(
+      m, "Reducer")
+      .def(py::init<const std::vector<std::shared_ptr<imperative::VarBase>> &,
+                    const std::vector<bool> &,
+                    const imperative::ParallelStrategy &, size_t>())
+      .def("finalize_backward", &imperative::Reducer::FinalizeBackward,
+           py::call_guard<py::gil_scoped_release>());
 #endif
 }
 
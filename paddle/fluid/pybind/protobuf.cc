@@ -182,6 +182,7 @@ void BindVarDsec(pybind11::module *m) {
       .value("INT32", pd::proto::VarType::INT32)
       .value("INT64", pd::proto::VarType::INT64)
       .value("FP16", pd::proto::VarType::FP16)
+      .value("BF16", pd::proto::VarType::BF16)
       .value("FP32", pd::proto::VarType::FP32)
       .value("FP64", pd::proto::VarType::FP64)
       .value("LOD_TENSOR", pd::proto::VarType::LOD_TENSOR)
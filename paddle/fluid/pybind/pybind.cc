@@ -22,6 +22,7 @@ limitations under the License. */
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
@@ -34,6 +35,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/framework/memory_profiler.h"
 #include "paddle/fluid/framework/op_compatible_info.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -47,10 +49,12 @@ limitations under the License. */
 #include "paddle/fluid/framework/type_defs.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/fluid/operators/activation_op.h"
 #include "paddle/fluid/operators/py_func_op.h"
+#include "paddle/fluid/platform/comm_stats.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/dynload/dynamic_loader.h"
@@ -339,21 +343,36 @@ PYBIND11_MODULE(core_noavx, m) {
 
   m.def("set_num_threads", &platform::SetNumThreads);
 
+  // The tensor shares the memory of the capsule without copying. DLPack
+  // carries no stream, so the producer must have finished writing the memory
+  // before handing the capsule over.
   m.def("from_dlpack", [](py::capsule *dltensor) {
+    PADDLE_ENFORCE_EQ(
+        PyCapsule_IsValid(dltensor->ptr(), "dltensor"), 1,
+        platform::errors::InvalidArgument(
+            "The capsule is not a dltensor, or it has been consumed."));
     DLManagedTensor *dmt = reinterpret_cast<DLManagedTensor *>(
         PyCapsule_GetPointer(dltensor->ptr(), "dltensor"));
     PyCapsule_SetName(dltensor->ptr(), "used_dltensor");
-    DLTensor dl = dmt->dl_tensor;
-    Tensor tensor;
 
-    if (dl.ctx.device_type == kDLCPU) {
-      paddle::framework::TensorFromDLPack(dl, &tensor);
-    }
-#ifdef PADDLE_WITH_CUDA
-    if (dl.ctx.device_type == kDLGPU) {
-      paddle::framework::TensorFromDLPack(dl, &tensor);
-    }
-#endif
+    // The deleter of the producer may run Python code, e.g. release a cupy
+    // array, and the tensor may be destroyed by a thread without the GIL.
+    auto *wrapper = new DLManagedTensor;
+    wrapper->dl_tensor = dmt->dl_tensor;
+    wrapper->manager_ctx = dmt;
+    wrapper->deleter = [](DLManagedTensor *arg) {
+      auto *inner = static_cast<DLManagedTensor *>(arg->manager_ctx);
+      delete arg;
+      if (inner->deleter == nullptr) return;
+      if (!Py_IsInitialized()) {
+        inner->deleter(inner);
+        return;
+      }
+      py::gil_scoped_acquire gil;
+      inner->deleter(inner);
+    };
+    Tensor tensor;
+    paddle::framework::TensorFromDLPack(wrapper, &tensor);
     return tensor;
   });
 
@@ -378,6 +397,35 @@ PYBIND11_MODULE(core_noavx, m) {
           CreateVariableIfNotExit(vec_var_list, scope, executor);
         });
 
+  m.def("_wait_async_checkpoints",
+        [](const std::string &path) {
+          AsyncCheckpointWriter::Instance().Wait(path);
+        },
+        py::arg("path") = "", py::call_guard<py::gil_scoped_release>());
+
+  m.def("_add_async_checkpoint_callback", [](const py::function &callback) {
+    // The callback is called and released on the IO threads.
+    std::shared_ptr<py::function> func(
+        new py::function(callback), [](py::function *f) {
+          py::gil_scoped_acquire guard;
+          delete f;
+        });
+    return AsyncCheckpointWriter::Instance().AddCallback(
+        [func](const std::string &path, const std::string &error) {
+          py::gil_scoped_acquire guard;
+          try {
+            (*func)(path, error);
+          } catch (py::error_already_set &e) {
+            LOG(WARNING) << "The callback of the checkpoint " << path
+                         << " fails: " << e.what();
+          }
+        });
+  });
+
+  m.def("_remove_async_checkpoint_callback", [](int id) {
+    AsyncCheckpointWriter::Instance().RemoveCallback(id);
+  });
+
   m.def("_save_dygraph_dict", [](const std::string &str_file_name,
                                  const PyNameVarBaseMap &state_dict) {
     auto vec_var_base_list = GetVarBaseList(state_dict);
@@ -505,11 +553,14 @@ PYBIND11_MODULE(core_noavx, m) {
            })
       .def("_clear", &Tensor::clear)
       .def("set", SetTensorFromPyArray<paddle::platform::CPUPlace>,
-           py::arg("array"), py::arg("place"), py::arg("zero_copy") = false)
+           py::arg("array"), py::arg("place"), py::arg("zero_copy") = false,
+           py::arg("copy_on_write") = false)
       .def("set", SetTensorFromPyArray<paddle::platform::CUDAPlace>,
-           py::arg("array"), py::arg("place"), py::arg("zero_copy") = false)
+           py::arg("array"), py::arg("place"), py::arg("zero_copy") = false,
+           py::arg("copy_on_write") = false)
       .def("set", SetTensorFromPyArray<paddle::platform::CUDAPinnedPlace>,
            py::arg("array"), py::arg("place"), py::arg("zero_copy") = false,
+           py::arg("copy_on_write") = false,
            R"DOC(
         Set the data of LoDTensor on place with given numpy array.
         
@@ -519,6 +570,9 @@ PYBIND11_MODULE(core_noavx, m) {
           LoDTensor is to be set.
           zero_copy (bool, optional): Whether to share memory with the input numpy array.
           This parameter only works with CPUPlace. Default: False.
+          copy_on_write (bool, optional): Whether the shared numpy array is
+          copied before the LoDTensor is modified, so that it is never written
+          by Paddle. This parameter only works with zero_copy. Default: False.
 
         Returns:
             None.
@@ -552,21 +606,25 @@ PYBIND11_MODULE(core_noavx, m) {
            )DOC")
       .def("_to_dlpack",
            [](Tensor &self) {
+             // The capsule shares the memory of the tensor and keeps it
+             // alive. The kernels of Paddle writing the tensor may be still
+             // running on its stream, so wait for them as the consumer can
+             // not know the stream.
+             if (platform::is_gpu_place(self.place())) {
+               platform::DeviceContextPool::Instance()
+                   .Get(self.place())
+                   ->Wait();
+             }
              DLPackTensor dlpack_tensor(self, 1);
              DLManagedTensor *dmt =
                  dlpack_tensor.ToCudfCompatibleDLManagedTensor();
              auto capsule = py::capsule(
                  static_cast<void *>(dmt), "dltensor", [](PyObject *ptr) {
-                   if (ptr) {
-                     auto dltensor = new DLManagedTensor;
-                     try {
-                       dltensor = reinterpret_cast<DLManagedTensor *>(
-                           PyCapsule_GetPointer(ptr, "used_dltensor"));
-                       return;
-                     } catch (...) {
-                       dltensor = reinterpret_cast<DLManagedTensor *>(
-                           PyCapsule_GetPointer(ptr, "dltensor"));
-                     }
+                   // a consumed capsule is renamed to "used_dltensor", and
+                   // the consumer calls the deleter
+                   if (ptr && PyCapsule_IsValid(ptr, "dltensor")) {
+                     auto *dltensor = reinterpret_cast<DLManagedTensor *>(
+                         PyCapsule_GetPointer(ptr, "dltensor"));
                      dltensor->deleter(dltensor);
                    }
                  });
@@ -894,14 +952,17 @@ PYBIND11_MODULE(core_noavx, m) {
               platform::errors::PreconditionNotMet(
                 "LoDTensor is not in shared memory."
                 "Now only LoDTensor on shared memory can be serialized."));
+            // The cached block is released by the reader from now on.
+            mmap_writer_allocation->MarkShared();
             int type_idx = static_cast<int>(t.type());
 
             return py::make_tuple(mmap_writer_allocation->ipc_name(),
                                   mmap_writer_allocation->size(),
-                                  type_idx, vectorize(t.dims()), t.lod());
+                                  type_idx, vectorize(t.dims()), t.lod(),
+                                  mmap_writer_allocation->mapped_size());
           },
           [](py::tuple t) {  // __setstate__
-            if (t.size() != 5)
+            if (t.size() != 6)
               throw std::runtime_error("Invalid LoDTensor state!");
 
             // 1. Create a new C++ instance
@@ -910,9 +971,10 @@ PYBIND11_MODULE(core_noavx, m) {
             // 2. Rebuild Allocation
             const std::string &ipc_name = t[0].cast<std::string>();
             size_t size = t[1].cast<size_t>();
+            size_t mapped_size = t[5].cast<size_t>();
             auto shared_reader_holder =
               memory::allocation::RebuildMemoryMapReaderAllocation(
-                ipc_name, size);
+                ipc_name, size, mapped_size);
 
             // 3. Maintain global fd set
             VLOG(3) << "LoDTensor ipc name: " << ipc_name;
@@ -1717,6 +1779,56 @@ All parameter, weight, gradient are variables in Paddle.
            py::return_value_policy::take_ownership);
 
   m.def("op_support_gpu", OpSupportGPU);
+
+  py::class_<memory::allocation::AllocatorStats>(m, "AllocatorStats")
+      .def_readonly("allocated_bytes",
+                    &memory::allocation::AllocatorStats::allocated_bytes)
+      .def_readonly("peak_allocated_bytes",
+                    &memory::allocation::AllocatorStats::peak_allocated_bytes)
+      .def_readonly("reserved_bytes",
+                    &memory::allocation::AllocatorStats::reserved_bytes)
+      .def_readonly(
+          "largest_free_chunk_bytes",
+          &memory::allocation::AllocatorStats::largest_free_chunk_bytes)
+      .def_property_readonly(
+          "alloc_counts",
+          [](const memory::allocation::AllocatorStats &self) {
+            return std::vector<uint64_t>(self.alloc_counts.begin(),
+                                         self.alloc_counts.end());
+          })
+      .def("fragmentation_ratio",
+           &memory::allocation::AllocatorStats::FragmentationRatio);
+
+  auto get_allocator_stats = [](const platform::Place &place) -> py::object {
+    memory::allocation::AllocatorStats stats;
+    if (!memory::allocation::AllocatorFacade::Instance().GetStats(place,
+                                                                  &stats)) {
+      return py::none();
+    }
+    return py::cast(stats);
+  };
+  m.def("get_allocator_stats",
+        [get_allocator_stats](const platform::CPUPlace &place) {
+          return get_allocator_stats(place);
+        });
+  m.def("get_allocator_stats",
+        [get_allocator_stats](const platform::CUDAPlace &place) {
+          return get_allocator_stats(place);
+        });
+  m.def("get_allocator_stats",
+        [get_allocator_stats](const platform::CUDAPinnedPlace &place) {
+          return get_allocator_stats(place);
+        });
+  m.def("release_memory", [](const platform::CPUPlace &place) {
+    return memory::allocation::AllocatorFacade::Instance().Release(place);
+  });
+  m.def("release_memory", [](const platform::CUDAPlace &place) {
+    return memory::allocation::AllocatorFacade::Instance().Release(place);
+  });
+  m.def("release_memory", [](const platform::CUDAPinnedPlace &place) {
+    return memory::allocation::AllocatorFacade::Instance().Release(place);
+  });
+
 #ifdef PADDLE_WITH_CUDA
   m.def("get_cuda_device_count", platform::GetCUDADeviceCount);
 
@@ -1754,6 +1866,82 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_profiler", platform::DisableProfiler);
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
+  m.def("_enable_sampled_profiler",
+        [](int step_interval, double event_ratio, int flush_interval,
+           const std::string &path) {
+          platform::SampledProfilerOptions options;
+          options.step_interval = step_interval;
+          options.event_ratio = event_ratio;
+          options.flush_interval = flush_interval;
+          options.path = path;
+          platform::SampledProfiler::Instance().Enable(options);
+        });
+  m.def("_disable_sampled_profiler",
+        [] { platform::SampledProfiler::Instance().Disable(); });
+  m.def("_flush_sampled_profiler",
+        [] { platform::SampledProfiler::Instance().Flush(); });
+  m.def("_is_sampled_profiler_enabled",
+        [] { return platform::SampledProfiler::Instance().IsEnabled(); });
+  m.def("_enable_memory_profiler",
+        [] { framework::MemoryProfiler::Instance().Enable(); });
+  m.def("_disable_memory_profiler",
+        [] { framework::MemoryProfiler::Instance().Disable(); });
+  m.def("_memory_profiler_report", [](size_t max_tensors) {
+    return framework::MemoryProfiler::Instance().Report(max_tensors);
+  });
+  m.def("_memory_profiler_peaks", [] {
+    py::list peaks;
+    for (auto &pair : framework::MemoryProfiler::Instance().Peaks()) {
+      py::list tensors;
+      for (auto &tensor : pair.second.tensors) {
+        py::dict info;
+        info["name"] = tensor.name;
+        info["shape"] = py::cast(tensor.dims);
+        info["producer"] = tensor.producer;
+        info["bytes"] = tensor.bytes;
+        tensors.append(info);
+      }
+      py::dict peak;
+      std::stringstream place;
+      place << pair.first;
+      peak["place"] = place.str();
+      peak["bytes"] = pair.second.live_bytes;
+      peak["op_type"] = pair.second.op_type;
+      peak["tensors"] = tensors;
+      peaks.append(peak);
+    }
+    return peaks;
+  });
+  m.def("_enable_comm_stats",
+        [] { platform::CommStats::Instance().Enable(); });
+  m.def("_disable_comm_stats",
+        [] { platform::CommStats::Instance().Disable(); });
+  m.def("_comm_stats_report",
+        [] { return platform::CommStats::Instance().Report(); });
+  m.def("_comm_stats", [] {
+    auto to_list = [](const std::vector<platform::CommStat> &stats) {
+      py::list list;
+      for (auto &stat : stats) {
+        py::dict item;
+        item["kind"] = stat.kind;
+        item["bucket"] = stat.bucket;
+        item["nranks"] = stat.nranks;
+        item["calls"] = stat.calls;
+        item["bytes"] = stat.bytes;
+        item["wait_ms"] = stat.wait_ms;
+        item["transfer_ms"] = stat.transfer_ms;
+        item["max_transfer_ms"] = stat.max_transfer_ms;
+        item["algo_gbps"] = stat.AlgorithmBandwidth();
+        item["bus_gbps"] = stat.BusBandwidth();
+        list.append(item);
+      }
+      return list;
+    };
+    py::dict stats;
+    stats["buckets"] = to_list(platform::CommStats::Instance().BucketStats());
+    stats["steps"] = to_list(platform::CommStats::Instance().StepStats());
+    return stats;
+  });
   m.def("get_pass", [](const std::string &pass_type) {
     auto pass = framework::ir::PassRegistry::Instance().Get(pass_type);
     return std::shared_ptr<framework::ir::Pass>(std::move(pass));
@@ -1919,6 +2107,34 @@ All parameter, weight, gradient are variables in Paddle.
           },
           R"DOC(This config that the this is distributed training with parameter server
               )DOC")
+      .def_property(
+          "use_critical_path_priority",
+          [](const ExecutionStrategy &self) {
+            return self.use_critical_path_priority_;
+          },
+          [](ExecutionStrategy &self, bool use_critical_path_priority) {
+            self.use_critical_path_priority_ = use_critical_path_priority;
+          },
+          R"DOC(The type is BOOL, use_critical_path_priority indicates whether
+                to run the ready operators in the descending order of their
+                critical path lengths, so that the operators which the
+                communication depends on start earlier. It only works with
+                the experimental executor. Default False.
+              )DOC")
+      .def_property(
+          "drop_scope_in_background",
+          [](const ExecutionStrategy &self) {
+            return self.drop_scope_in_background_;
+          },
+          [](ExecutionStrategy &self, bool drop_scope_in_background) {
+            self.drop_scope_in_background_ = drop_scope_in_background;
+          },
+          R"DOC(The type is BOOL, drop_scope_in_background indicates whether
+                to destroy the variables of the local execution scopes on a
+                background thread when they are dropped every
+                num_iteration_per_drop_scope iterations, so that the training
+                thread does not wait for releasing the memory. Default False.
+              )DOC")
       .def_property("_dry_run",
                     [](const ExecutionStrategy &self) { return self.dry_run_; },
                     [](ExecutionStrategy &self, bool dry_run) {
@@ -2131,6 +2347,34 @@ All parameter, weight, gradient are variables in Paddle.
                         build_strategy = fluid.BuildStrategy()
                         build_strategy.remove_unnecessary_lock = True
           )DOC")
+      .def_property(
+          "num_streams",
+          [](const BuildStrategy &self) { return self.num_streams_; },
+          [](BuildStrategy &self, size_t num_streams) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            PADDLE_ENFORCE_GE(num_streams, 1,
+                              platform::errors::InvalidArgument(
+                                  "num_streams should be at least 1, but "
+                                  "received %d.",
+                                  num_streams));
+            self.num_streams_ = num_streams;
+          },
+          R"DOC((int, optional): The number of CUDA streams of every GPU.
+                If it is larger than 1, the independent ops, e.g. the
+                branches of inception blocks, are assigned to different
+                streams and run concurrently. It only works when
+                FLAGS_allocator_strategy=auto_growth. Default is 1.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.num_streams = 4
+          )DOC")
       .def_property(
           "num_trainers",
           [](const BuildStrategy &self) { return self.num_trainers_; },
@@ -2173,6 +2417,77 @@ All parameter, weight, gradient are variables in Paddle.
                     [](BuildStrategy &self, int nranks) {
                       self.hierarchical_allreduce_inter_nranks_ = nranks;
                     })
+      .def_property(
+          "fp16_allreduce",
+          [](const BuildStrategy &self) { return self.fp16_allreduce_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.fp16_allreduce_ = b;
+          },
+          R"DOC((bool, optional): fp16_allreduce indicates whether to cast
+                the FP32 gradients to FP16 before all reducing them on GPU,
+                and cast the results back to FP32. It halves the
+                communication volume at the cost of precision. Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fp16_allreduce = True
+                )DOC")
+      .def_property(
+          "fp16_allreduce_error_feedback",
+          [](const BuildStrategy &self) {
+            return self.fp16_allreduce_error_feedback_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.fp16_allreduce_error_feedback_ = b;
+          },
+          R"DOC((bool, optional): fp16_allreduce_error_feedback indicates
+                whether to keep the error of casting the gradients to FP16
+                and add it to the gradients of the next step. It only works
+                when fp16_allreduce is True. Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fp16_allreduce = True
+                        build_strategy.fp16_allreduce_error_feedback = True
+                )DOC")
+      .def_property(
+          "use_sparse_all_gather",
+          [](const BuildStrategy &self) { return self.use_sparse_all_gather_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.use_sparse_all_gather_ = b;
+          },
+          R"DOC((bool, optional): use_sparse_all_gather indicates whether to
+                all gather the sparse(SelectedRows) gradients with NCCL in
+                AllReduce strategy. The duplicated rows are merged before and
+                after all gathering on every device, so no device has to
+                reduce and broadcast the gradients of others. It has no
+                effect on CPU or with hierarchical allreduce. Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.use_sparse_all_gather = True
+                )DOC")
 
       .def_property(
           "fuse_elewise_add_act_ops",
@@ -2218,6 +2533,29 @@ All parameter, weight, gradient are variables in Paddle.
                         build_strategy = fluid.BuildStrategy()
                         build_strategy.fuse_bn_act_ops = True
                      )DOC")
+      .def_property(
+          "fuse_bn_add_act_ops",
+          [](const BuildStrategy &self) { return self.fuse_bn_add_act_ops_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.fuse_bn_add_act_ops_ = b;
+          },
+          R"DOC((bool, optional): fuse_bn_add_act_ops indicate whether
+                to fuse batch_norm, elementwise_add and activation_op of the
+                residual blocks in training, it may make the execution faster
+                and save the memory of the intermediate activations. Only
+                the float16 inputs in NHWC on GPU are fused. Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fuse_bn_add_act_ops = True
+                     )DOC")
       .def_property(
           "enable_auto_fusion",
           [](const BuildStrategy &self) { return self.enable_auto_fusion_; },
@@ -2231,7 +2569,9 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC((bool, optional): Whether to enable fusing subgraph to a
                 fusion_group. Now we only support fusing subgraph that composed
                 of elementwise-like operators, such as elementwise_add/mul
-                without broadcast and activations.
+                and activations, and the reduce_sum/mean over the last axis
+                on GPU. The elementwise-like operators without broadcast are
+                compiled to C++ loops on CPU.
 
                 Examples:
                     .. code-block:: python
@@ -2327,6 +2667,96 @@ All parameter, weight, gradient are variables in Paddle.
                         build_strategy = fluid.BuildStrategy()
                         build_strategy.sync_batch_norm = True
                 )DOC")
+      .def_property(
+          "shard_optimizer_states",
+          [](const BuildStrategy &self) {
+            return self.shard_optimizer_states_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.shard_optimizer_states_ = b;
+          },
+          R"DOC((bool, optional): shard_optimizer_states indicates whether to
+                partition the optimizer states, e.g., the moments of Adam,
+                across devices. It only works when reduce_strategy is
+                ReduceStrategy.Reduce, where the gradients are reduced to
+                the device which updates the parameter and the parameters
+                are broadcast after updating. With this option, the
+                parameters are balanced by the bytes of their gradients and
+                optimizer states, and each device except the 0th one only
+                keeps the optimizer states it updates. Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.reduce_strategy = fluid.BuildStrategy.ReduceStrategy.Reduce
+                        build_strategy.shard_optimizer_states = True
+                )DOC")
+      .def_property(
+          "enable_recompute",
+          [](const BuildStrategy &self) { return self.enable_recompute_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.enable_recompute_ = b;
+          },
+          R"DOC((bool, optional): enable_recompute indicates whether to
+                recompute the activations between checkpoints in backward
+                instead of holding them from forward to backward, which
+                trades compute for memory. It only saves memory when
+                eager deletion is enabled, i.e.,
+                FLAGS_eager_delete_tensor_gb >= 0. Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.enable_recompute = True
+                )DOC")
+      .def_property(
+          "recompute_checkpoints",
+          [](const BuildStrategy &self) {
+            return self.recompute_checkpoints_;
+          },
+          [](BuildStrategy &self, const std::vector<std::string> &names) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            self.recompute_checkpoints_ = names;
+          },
+          R"DOC((list(str), optional): The names of the checkpoint variables
+                of recompute. If it is empty, the checkpoints are picked
+                by recompute_memory_budget. Default is [].)DOC")
+      .def_property(
+          "recompute_memory_budget",
+          [](const BuildStrategy &self) {
+            return self.recompute_memory_budget_;
+          },
+          [](BuildStrategy &self, int64_t budget) {
+            PADDLE_ENFORCE_NE(self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy has been finlaized, cannot be "
+                                  "configured again."));
+            PADDLE_ENFORCE_GE(budget, 0,
+                              platform::errors::InvalidArgument(
+                                  "recompute_memory_budget should not be "
+                                  "negative, but received %d.",
+                                  budget));
+            self.recompute_memory_budget_ = budget;
+          },
+          R"DOC((int, optional): The estimated bytes of the activations
+                between two checkpoints picked automatically, where the
+                unknown dimensions are taken as 1. 0 means picking sqrt(n)
+                checkpoints for n activations. Default is 0.)DOC")
       .def_property(
           "memory_optimize",
           [](const BuildStrategy &self) -> py::object {
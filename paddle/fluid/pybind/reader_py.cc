@@ -405,7 +405,9 @@ void BindReader(py::module *module) {
       .def("close", &reader::LoDTensorBlockingQueue::Close)
       .def("kill", &reader::LoDTensorBlockingQueue::Kill)
       .def("wait_for_inited", &reader::LoDTensorBlockingQueue::WaitForInited,
-           py::call_guard<py::gil_scoped_release>());
+           py::call_guard<py::gil_scoped_release>())
+      .def("push_wait_ms", &reader::LoDTensorBlockingQueue::PushWaitMs)
+      .def("pop_wait_ms", &reader::LoDTensorBlockingQueue::PopWaitMs);
 
   py::class_<reader::OrderedMultiDeviceLoDTensorBlockingQueue,
              std::shared_ptr<reader::OrderedMultiDeviceLoDTensorBlockingQueue>>(
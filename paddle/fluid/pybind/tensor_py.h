@@ -25,6 +25,7 @@ limitations under the License. */
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/math/concat_and_split.h"
 #include "paddle/fluid/operators/strided_memcpy.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/float16.h"
 #include "pybind11/numpy.h"
@@ -58,6 +59,23 @@ struct npy_format_descriptor<paddle::platform::float16> {
   static PYBIND11_DESCR name() { return _("float16"); }
 };
 
+// Note: numpy has no bfloat16, paddle::platform::bfloat16 is exposed as
+// numpy.uint16 holding its bits.
+constexpr int NPY_UINT16_ = 4;
+
+template <>
+struct npy_format_descriptor<paddle::platform::bfloat16> {
+  static py::dtype dtype() {
+    handle ptr = npy_api::get().PyArray_DescrFromType_(NPY_UINT16_);
+    return reinterpret_borrow<py::dtype>(ptr);
+  }
+  static std::string format() {
+    // Note: "H" represents uint16.
+    return "H";
+  }
+  static PYBIND11_DESCR name() { return _("bfloat16"); }
+};
+
 }  // namespace detail
 }  // namespace pybind11
 
@@ -103,6 +121,7 @@ struct ValidDTypeToPyArrayChecker {
   }
 
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(platform::float16);
+DECLARE_VALID_DTYPE_TO_PY_ARRAY(platform::bfloat16);
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(float);
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(double);
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(bool);
@@ -177,7 +196,7 @@ template <typename T, typename P>
 void SetTensorFromPyArrayT(
     framework::Tensor *self,
     const py::array_t<T, py::array::c_style | py::array::forcecast> &array,
-    const P &place, bool zero_copy) {
+    const P &place, bool zero_copy, bool copy_on_write) {
   std::vector<int64_t> dims;
   dims.reserve(array.ndim());
   for (decltype(array.ndim()) i = 0; i < array.ndim(); ++i) {
@@ -189,7 +208,12 @@ void SetTensorFromPyArrayT(
     if (zero_copy) {
       auto holder = std::make_shared<details::NumpyAllocation<T>>(array);
       auto type = framework::ToDataType(std::type_index(typeid(T)));
-      self->ResetHolderWithType(holder, type);
+      if (copy_on_write) {
+        // the kernels writing the tensor in place copy the array first
+        self->ResetHolderCopyOnWrite(holder, type);
+      } else {
+        self->ResetHolderWithType(holder, type);
+      }
     } else {
       auto dst = self->mutable_data<T>(place);
       std::memcpy(dst, array.data(), array.nbytes());
@@ -200,8 +224,14 @@ void SetTensorFromPyArrayT(
     if (paddle::platform::is_cuda_pinned_place(place)) {
       std::memcpy(dst, array.data(), array.nbytes());
     } else if (paddle::platform::is_gpu_place(place)) {
-      paddle::platform::GpuMemcpySync(dst, array.data(), array.nbytes(),
-                                      cudaMemcpyHostToDevice);
+      // The copy is staged in pinned memory and issued to the stream of the
+      // device context, so it overlaps with the running kernels.
+      auto gpu_place =
+          BOOST_GET_CONST(platform::CUDAPlace, platform::Place(place));
+      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+          platform::DeviceContextPool::Instance().Get(gpu_place));
+      paddle::memory::Copy(gpu_place, dst, platform::CPUPlace(), array.data(),
+                           array.nbytes(), dev_ctx->stream());
     } else {
       PADDLE_THROW(platform::errors::InvalidArgument(
           "Incompatible place type: Tensor.set() supports "
@@ -219,32 +249,41 @@ void SetTensorFromPyArrayT(
 
 template <typename P>
 void SetTensorFromPyArray(framework::Tensor *self, const py::object &obj,
-                          const P &place, bool zero_copy) {
+                          const P &place, bool zero_copy,
+                          bool copy_on_write = false) {
   auto array = obj.cast<py::array>();
   if (py::isinstance<py::array_t<float>>(array)) {
-    SetTensorFromPyArrayT<float, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<float, P>(self, array, place, zero_copy,
+                                    copy_on_write);
   } else if (py::isinstance<py::array_t<int>>(array)) {
-    SetTensorFromPyArrayT<int, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<int, P>(self, array, place, zero_copy,
+                                  copy_on_write);
   } else if (py::isinstance<py::array_t<int64_t>>(array)) {
-    SetTensorFromPyArrayT<int64_t, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<int64_t, P>(self, array, place, zero_copy,
+                                      copy_on_write);
   } else if (py::isinstance<py::array_t<double>>(array)) {
-    SetTensorFromPyArrayT<double, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<double, P>(self, array, place, zero_copy,
+                                     copy_on_write);
   } else if (py::isinstance<py::array_t<int8_t>>(array)) {
-    SetTensorFromPyArrayT<int8_t, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<int8_t, P>(self, array, place, zero_copy,
+                                     copy_on_write);
   } else if (py::isinstance<py::array_t<int16_t>>(array)) {
-    SetTensorFromPyArrayT<int16_t, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<int16_t, P>(self, array, place, zero_copy,
+                                      copy_on_write);
   } else if (py::isinstance<py::array_t<uint8_t>>(array)) {
-    SetTensorFromPyArrayT<uint8_t, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<uint8_t, P>(self, array, place, zero_copy,
+                                      copy_on_write);
   } else if (py::isinstance<py::array_t<paddle::platform::float16>>(array)) {
-    SetTensorFromPyArrayT<paddle::platform::float16, P>(self, array, place,
-                                                        zero_copy);
+    SetTensorFromPyArrayT<paddle::platform::float16, P>(
+        self, array, place, zero_copy, copy_on_write);
   } else if (py::isinstance<py::array_t<uint16_t>>(array)) {
     // TODO(cql): temporary keeping uint16, which is used for casting float16
     // before. It should be depracated later.
-    SetTensorFromPyArrayT<paddle::platform::float16, P>(self, array, place,
-                                                        zero_copy);
+    SetTensorFromPyArrayT<paddle::platform::float16, P>(
+        self, array, place, zero_copy, copy_on_write);
   } else if (py::isinstance<py::array_t<bool>>(array)) {
-    SetTensorFromPyArrayT<bool, P>(self, array, place, zero_copy);
+    SetTensorFromPyArrayT<bool, P>(self, array, place, zero_copy,
+                                   copy_on_write);
   } else {
     PADDLE_THROW(platform::errors::InvalidArgument(
         "Incompatible data type: tensor.set() supports bool, float16, "
@@ -450,6 +489,8 @@ inline framework::Tensor *_sliceTensor(const framework::Tensor &self,
   switch (src_type) {
     case framework::proto::VarType::FP16:
       return _sliceAndConcat<paddle::platform::float16>(self, obj, dim);
+    case framework::proto::VarType::BF16:
+      return _sliceAndConcat<paddle::platform::bfloat16>(self, obj, dim);
     case framework::proto::VarType::FP32:
       return _sliceAndConcat<float>(self, obj, dim);
     case framework::proto::VarType::FP64:
@@ -171,11 +171,20 @@ def __bootstrap__():
         'dist_threadpool_size', 'eager_delete_tensor_gb',
         'fast_eager_deletion_mode', 'memory_fraction_of_eager_deletion',
         'allocator_strategy', 'reader_queue_speed_test_mode',
+        'reader_max_buffer_size',
         'print_sub_graph_dir', 'pe_profile_fname', 'inner_op_parallelism',
         'enable_parallel_graph', 'fuse_parameter_groups_size',
         'multiple_of_cupti_buffer_size', 'fuse_parameter_memory_size',
         'tracer_profile_fname', 'dygraph_debug', 'use_system_allocator',
-        'enable_unused_var_check', 'free_idle_chunk', 'free_when_no_cache_hit'
+        'enable_unused_var_check', 'free_idle_chunk', 'free_when_no_cache_hit',
+        'cpu_allocator_strategy', 'huge_page_threshold_mb', 'use_shm_cache',
+        'compact_when_oom', 'use_virtual_memory_auto_growth',
+        'executor_num_threads', 'executor_prepare_cache_capacity',
+        'cache_runtime_infer_shape', 'async_cpu_garbage_collection_mb',
+        'cache_transformed_persistable_vars', 'tensor_copy_on_write',
+        'fuse_grad_in_ready_order', 'pe_timeline_fname', 'pe_timeline_step',
+        'async_checkpoint', 'profiler_chrome_trace', 'profiler_peak_gflops',
+        'profiler_peak_gbps', 'profiler_roofline_ratio', 'borrow_numpy_feed'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
@@ -183,8 +192,14 @@ def __bootstrap__():
     if os.name != 'nt':
         read_env_flags.append('cpu_deterministic')
 
+    # the runtime compiled kernels of fusion_group
+    if os.name != 'nt' and 'Darwin' not in sysstr:
+        read_env_flags.append('device_code_cache_dir')
+        read_env_flags.append('cpu_jit_compiler')
+
     if core.is_compiled_with_mkldnn():
         read_env_flags.append('use_mkldnn')
+        read_env_flags.append('mkldnn_cache_capacity_mb')
 
     if core.is_compiled_with_dist():
         #env for rpc
@@ -197,6 +212,11 @@ def __bootstrap__():
         read_env_flags.append('rpc_prefetch_thread_num')
         read_env_flags.append('rpc_disable_reuse_port')
         read_env_flags.append('rpc_retry_bind_port')
+        read_env_flags.append('rpc_recv_buffer_num')
+        read_env_flags.append('rpc_send_encoding')
+        read_env_flags.append('rpc_compress_rows')
+        read_env_flags.append('rpc_backup_trainer_num')
+        read_env_flags.append('sparse_table_spill_dir')
 
         read_env_flags.append('worker_update_interval_secs')
 
@@ -204,13 +224,18 @@ def __bootstrap__():
             read_env_flags.append('max_body_size')
             #set brpc max body size
             os.environ['FLAGS_max_body_size'] = "2147483647"
+        else:
+            # the rpc tracing is only implemented by grpc
+            read_env_flags.append('rpc_trace')
+            read_env_flags.append('rpc_trace_slow_ms')
 
     if core.is_compiled_with_cuda():
         read_env_flags += [
             'fraction_of_gpu_memory_to_use', 'initial_gpu_memory_in_mb',
             'reallocate_gpu_memory_in_mb', 'cudnn_deterministic',
             'enable_cublas_tensor_op_math', 'conv_workspace_size_limit',
-            'cudnn_exhaustive_search', 'selected_gpus', 'sync_nccl_allreduce',
+            'cudnn_exhaustive_search', 'cudnn_algo_cache_file',
+            'selected_gpus', 'sync_nccl_allreduce',
             'cudnn_batchnorm_spatial_persistent', 'gpu_allocator_retry_time',
             'local_exe_sub_scope_limit', 'gpu_memory_limit_mb'
         ]
@@ -24,6 +24,7 @@ from . import framework
 from . import core
 from . import name_scope
 from .dygraph import base as imperative_base
+from .layer_helper import LayerHelper
 
 __all__ = [
     'set_gradient_clip', 'ErrorClipByValue', 'GradientClipByValue',
@@ -181,6 +182,10 @@ class GradientClipByValue(GradientClipBase):
         need_clip (function, optional): Type: function. This function accepts a ``Parameter`` and returns ``bool`` 
             (True: the gradient of this ``Parameter`` need to be clipped, False: not need). Default: None, 
             and gradients of all parameters in the network will be clipped.
+        use_fused_op (bool, optional): Whether to clip the gradients by a single ``clip_by_global_norm``
+            op instead of several ops for every gradient. It is only used when all the gradients to be
+            clipped are dense and of the same data type, and not compatible with the ``Reduce`` strategy
+            of ``ParallelExecutor``. Default: False.
 
     Examples:
         .. code-block:: python
@@ -557,16 +562,70 @@ class GradientClipByGlobalNorm(GradientClipBase):
 
     """
 
-    def __init__(self, clip_norm, group_name="default_group", need_clip=None):
+    def __init__(self,
+                 clip_norm,
+                 group_name="default_group",
+                 need_clip=None,
+                 use_fused_op=False):
         super(GradientClipByGlobalNorm, self).__init__(need_clip)
         self.clip_norm = float(clip_norm)
         self.group_name = group_name
+        self.use_fused_op = use_fused_op
 
     def __str__(self):
         return "Gradient Clip By GlobalNorm, global_norm=%f" % (self.clip_norm)
 
+    def _can_fuse(self, grads):
+        if not self.use_fused_op or len(grads) == 0:
+            return False
+        dtype = grads[0].dtype
+        if dtype not in [core.VarDesc.VarType.FP32, core.VarDesc.VarType.FP64]:
+            return False
+        return all(g.type == core.VarDesc.VarType.LOD_TENSOR and
+                   g.dtype == dtype for g in grads)
+
+    def _fused_clip(self, params_grads):
+        """
+        Clip the gradients by one clip_by_global_norm op, return None if the
+        gradients can not be fused.
+        """
+        grads = []
+        for p, g in params_grads:
+            if g is None:
+                continue
+            if self._need_clip_func is not None and not self._need_clip_func(p):
+                continue
+            grads.append(g)
+        if not self._can_fuse(grads):
+            return None
+
+        helper = LayerHelper('clip_by_global_norm')
+        new_grads = [
+            helper.create_variable_for_type_inference(dtype=g.dtype)
+            for g in grads
+        ]
+        helper.append_op(
+            type='clip_by_global_norm',
+            inputs={'X': grads},
+            outputs={'Out': new_grads},
+            attrs={'max_global_norm': self.clip_norm})
+        new_grad_dict = dict()
+        for g, new_grad in zip(grads, new_grads):
+            new_grad_dict[g.name] = new_grad
+
+        params_and_grads = []
+        for p, g in params_grads:
+            if g is None:
+                continue
+            params_and_grads.append((p, new_grad_dict.get(g.name, g)))
+        return params_and_grads
+
     @imperative_base.no_grad
     def _dygraph_clip(self, params_grads):
+        fused_params_grads = self._fused_clip(params_grads)
+        if fused_params_grads is not None:
+            return fused_params_grads
+
         params_and_grads = []
         sum_square_list = []
         for p, g in params_grads:
@@ -610,6 +669,10 @@ class GradientClipByGlobalNorm(GradientClipBase):
         params_and_grads = []
         sum_square_list = []
         with framework.name_scope('gradient_clip'):
+            fused_params_grads = self._static_fused_clip(params_grads)
+            if fused_params_grads is not None:
+                return fused_params_grads
+
             for p, g in params_grads:
                 if g is None:
                     continue
@@ -658,6 +721,24 @@ class GradientClipByGlobalNorm(GradientClipBase):
         _correct_clip_op_role_var(params_and_grads, param_new_grad_name_dict)
         return params_and_grads
 
+    def _static_fused_clip(self, params_grads):
+        last = [(p, g) for p, g in params_grads if g is not None]
+        if len(last) == 0:
+            return None
+        p, g = last[-1]
+        # Like the sum of the norms of the unfused ops, the fused op takes
+        # the role var of the last gradient.
+        with p.block.program._optimized_guard([p, g]):
+            params_and_grads = self._fused_clip(params_grads)
+        if params_and_grads is None:
+            return None
+        param_new_grad_name_dict = dict()
+        for (p, g), (_, new_grad) in zip(last, params_and_grads):
+            if new_grad is not g:
+                param_new_grad_name_dict[p.name] = new_grad.name
+        _correct_clip_op_role_var(params_and_grads, param_new_grad_name_dict)
+        return params_and_grads
+
     def _process_context(self, context, param, grad):
         if self.group_name not in context:
             context[self.group_name] = []
@@ -15,7 +15,9 @@
 from __future__ import print_function
 from . import decorator
 from .decorator import *
-from .fp16_lists import AutoMixedPrecisionLists
+from .fp16_lists import AutoMixedPrecisionLists, AutoMixedPrecisionListsBF16
+from .fp16_utils import rewrite_program_bf16
 
 __all__ = decorator.__all__
 __all__ += fp16_lists.__all__
+__all__ += ['rewrite_program_bf16']
@@ -12,6 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from ... import core
 from ... import default_main_program
 from ... import default_startup_program
 from ... import layers
@@ -38,6 +39,9 @@ class OptimizerWithMixedPrecision(object):
         amp_lists (AutoMixedPrecisionLists): An AutoMixedPrecisionLists object.
         init_loss_scaling (float): The initial loss scaling factor.
         use_dynamic_loss_scaling (bool): Whether to use dynamic loss scaling.
+                                         Either way, the gradients of a step
+                                         are zeroed if any of them is inf or
+                                         nan.
         incr_every_n_steps(int): Increases loss scaling every n consecutive 
                                  steps with finite gradients.
         decr_every_n_nan_or_inf(int): Decreases loss scaling every n 
@@ -59,6 +63,7 @@ class OptimizerWithMixedPrecision(object):
         self._train_program = default_main_program()
         self._startup_prog = default_startup_program()
         self._scaled_loss = None
+        self._found_inf = None
         self._loss_scaling = layers.create_global_var(
             name=unique_name.generate("loss_scaling"),
             shape=[1],
@@ -139,8 +144,41 @@ class OptimizerWithMixedPrecision(object):
         # Change the op_role_var attr for some ops, so that gradients
         # transferred across GPUs can be FP16.
         update_role_var_grad(self._train_program, self._params_grads)
+        return self._unscale_grads(self._params_grads)
+
+    def _unscale_grads(self, params_grads):
+        """
+        Unscale the dense gradients in place and check them for inf or nan
+        with one amp_check_finite_and_scale op, whose GPU kernel takes a
+        fixed number of launches for all of them. The gradients are zeroed
+        if any of them is not finite. Unscaling in place keeps the gradients
+        of the optimizer ops the ones coalesced by fuse_all_optimizer_ops,
+        so the fused optimizer op steps all of them at once.
+        """
+        block = self._train_program.global_block()
+        dense_grads = [
+            g for _, g in params_grads
+            if g.type == core.VarDesc.VarType.LOD_TENSOR
+        ]
+        with self._train_program._optimized_guard([]):
+            if dense_grads:
+                inv_loss_scaling = 1.0 / self._loss_scaling
+                self._found_inf = block.create_var(
+                    name=unique_name.generate("found_infinite"),
+                    shape=[1],
+                    dtype='bool')
+                block.append_op(
+                    type='amp_check_finite_and_scale',
+                    inputs={'X': dense_grads,
+                            'Scale': [inv_loss_scaling]},
+                    outputs={'Out': dense_grads,
+                             'FoundInfinite': [self._found_inf]})
+
         scaled_params_grads = []
-        for p, g in self._params_grads:
+        for p, g in params_grads:
+            if g.type == core.VarDesc.VarType.LOD_TENSOR:
+                scaled_params_grads.append([p, g])
+                continue
             with self._train_program._optimized_guard([p, g]):
                 scaled_g = g / self._loss_scaling
                 scaled_params_grads.append([p, scaled_g])
@@ -159,28 +197,16 @@ class OptimizerWithMixedPrecision(object):
             A list of optimize operators.
         """
 
-        if self._use_dynamic_loss_scaling:
-
-            grads = [layers.reduce_sum(g) for [_, g] in scaled_params_grads]
-            all_grads = layers.concat(grads)
-            all_grads_sum = layers.reduce_sum(all_grads)
-            is_overall_finite = layers.isfinite(all_grads_sum)
-
+        # The gradients have been zeroed by amp_check_finite_and_scale if any
+        # of them is not finite, only the loss scaling is left to update.
+        if self._use_dynamic_loss_scaling and self._found_inf is not None:
+            is_overall_finite = layers.logical_not(self._found_inf)
             update_loss_scaling(is_overall_finite, self._loss_scaling,
                                 self._num_good_steps, self._num_bad_steps,
                                 self._incr_every_n_steps,
                                 self._decr_every_n_nan_or_inf, self._incr_ratio,
                                 self._decr_ratio)
 
-            # apply_gradient append all ops in global block, thus we shouldn't
-            # apply gradient in the switch branch.
-            with layers.Switch() as switch:
-                with switch.case(is_overall_finite):
-                    pass
-                with switch.default():
-                    for _, g in scaled_params_grads:
-                        layers.assign(layers.zeros_like(g), g)
-
         optimize_ops = self._optimizer.apply_gradients(scaled_params_grads)
 
         return optimize_ops
@@ -240,6 +266,10 @@ def decorate(optimizer,
         decr_ratio(float): The less-than-one-multiplier to use when decreasing 
                            the loss scaling.
         use_dynamic_loss_scaling(bool): Whether to use dynamic loss scaling.
+                                        Either way, the gradients of a step
+                                        are zeroed if any of them is inf or
+                                        nan, so the step leaves the
+                                        parameters unchanged by them.
 
     Returns:
         An optimizer acting like a normal one but with mixed-precision training 
@@ -14,7 +14,7 @@
 
 import copy
 
-__all__ = ["AutoMixedPrecisionLists"]
+__all__ = ["AutoMixedPrecisionLists", "AutoMixedPrecisionListsBF16"]
 
 
 class AutoMixedPrecisionLists(object):
@@ -282,3 +282,41 @@ unsupported_fp16_list = {
 		
 }
 '''
+
+# The sets of ops for bf16 on CPU, the white list ops have MKLDNN bf16 kernels
+# and the gray list ops have CPU bf16 kernels.
+bf16_white_list = {'matmul', }
+
+bf16_black_list = copy.copy(black_list)
+
+bf16_gray_list = {
+    'elementwise_add',
+    'elementwise_sub',
+    'elementwise_mul',
+    'relu',
+    'reduce_sum',
+    'cast',
+}
+
+
+class AutoMixedPrecisionListsBF16(AutoMixedPrecisionLists):
+    """
+    AutoMixedPrecisionListsBF16 is the AutoMixedPrecisionLists of the ops
+    executed in bf16 on CPU.
+
+    Args:
+        custom_white_list (set): Users' custom white list.
+        custom_black_list (set): Users' custom black list.
+    """
+
+    def __init__(self,
+                 custom_white_list=None,
+                 custom_black_list=None,
+                 custom_black_varnames=None):
+        self._custom_white_list = custom_white_list
+        self._custom_black_list = custom_black_list
+        self.white_list = copy.copy(bf16_white_list)
+        self.black_list = copy.copy(bf16_black_list)
+        self.gray_list = copy.copy(bf16_gray_list)
+        self.black_varnames = copy.copy(custom_black_varnames)
+        self._update_list()
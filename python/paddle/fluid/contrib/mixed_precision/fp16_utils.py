@@ -44,6 +44,8 @@ def _dtype_to_str(dtype):
     """
     if dtype == core.VarDesc.VarType.FP16:
         return 'fp16'
+    elif dtype == core.VarDesc.VarType.BF16:
+        return 'bf16'
     else:
         return 'fp32'
 
@@ -109,9 +111,9 @@ def _insert_cast_op(block, op, idx, src_dtype, dest_dtype):
                 if out_var.type not in valid_types:
                     continue
                 if out_var.dtype == core.VarDesc.VarType.FP32:
-                    out_var.desc.set_dtype(core.VarDesc.VarType.FP16)
+                    out_var.desc.set_dtype(dest_dtype)
                     if op.has_attr('out_dtype'):
-                        op._set_attr('out_dtype', core.VarDesc.VarType.FP16)
+                        op._set_attr('out_dtype', dest_dtype)
     return num_cast_ops
 
 
@@ -187,7 +189,7 @@ def _is_in_black_varnames(op, amp_lists):
     return False
 
 
-def rewrite_program(main_prog, amp_lists):
+def rewrite_program(main_prog, amp_lists, dest_type=core.VarDesc.VarType.FP16):
     """
     Traverse all ops in current block and insert cast op according to 
     which set current op belongs to.
@@ -206,6 +208,9 @@ def rewrite_program(main_prog, amp_lists):
 
     Args:
         main_prog (Program): The main program for training.
+        amp_lists (AutoMixedPrecisionLists): The black/white/gray lists.
+        dest_type (VarType): The low precision type of the white set ops,
+            FP16 or BF16. Default FP16.
     """
     block = main_prog.global_block()
     ops = block.ops
@@ -261,19 +266,39 @@ def rewrite_program(main_prog, amp_lists):
         op = ops[idx]
         num_cast_ops = 0
         if op in black_op_set:
-            num_cast_ops = _insert_cast_op(block, op, idx,
-                                           core.VarDesc.VarType.FP16,
+            num_cast_ops = _insert_cast_op(block, op, idx, dest_type,
                                            core.VarDesc.VarType.FP32)
         elif op in white_op_set:
             num_cast_ops = _insert_cast_op(block, op, idx,
-                                           core.VarDesc.VarType.FP32,
-                                           core.VarDesc.VarType.FP16)
+                                           core.VarDesc.VarType.FP32, dest_type)
         else:
             pass
 
         idx += num_cast_ops + 1
 
 
+def rewrite_program_bf16(main_prog, amp_lists=None):
+    """
+    Rewrite the program to compute the white set ops in bf16 on CPU, the
+    bf16 counterpart of rewrite_program. The parameters stay fp32 and are
+    cast to bf16 in front of the white set ops, so the optimizers keep
+    updating the fp32 master weights. The white list ops run their MKLDNN
+    bf16 kernels, which use the AVX512_BF16 instructions where available.
+
+    Args:
+        main_prog (Program): The main program to rewrite.
+        amp_lists (AutoMixedPrecisionListsBF16): The black/white/gray lists.
+            Default None, which uses AutoMixedPrecisionListsBF16().
+    """
+    if amp_lists is None:
+        from .fp16_lists import AutoMixedPrecisionListsBF16
+        amp_lists = AutoMixedPrecisionListsBF16()
+    rewrite_program(main_prog, amp_lists, core.VarDesc.VarType.BF16)
+    for op in main_prog.global_block().ops:
+        if op.type in amp_lists.white_list and op.has_attr('use_mkldnn'):
+            op._set_attr('use_mkldnn', True)
+
+
 def update_role_var_grad(main_prog, params_grads):
     """
     Update op_role_var attr for some ops to make sure the gradients
@@ -193,6 +193,33 @@ class TestQuantizationTransformPass(unittest.TestCase):
         self.linear_fc_quant(
             'moving_average_abs_max', 'channel_wise_abs_max', for_ci=True)
 
+    def test_linear_fc_fuse_quant_dequant(self):
+        main = fluid.Program()
+        startup = fluid.Program()
+        with fluid.program_guard(main, startup):
+            loss = linear_fc(3)
+            opt = fluid.optimizer.Adam(learning_rate=0.001)
+            opt.minimize(loss)
+        graph = IrGraph(core.Graph(main.desc), for_test=False)
+        transform_pass = QuantizationTransformPass(
+            scope=fluid.global_scope(),
+            place=fluid.CPUPlace(),
+            activation_quantize_type='moving_average_abs_max',
+            weight_quantize_type='abs_max')
+        transform_pass.apply(graph)
+        op_types = [op.name() for op in graph.all_op_nodes()]
+        num_quant = op_types.count('fake_quantize_moving_average_abs_max')
+        self.assertGreater(num_quant, 0)
+
+        core.get_pass('fake_quant_dequant_fuse_pass').apply(graph.graph)
+        op_types = [op.name() for op in graph.all_op_nodes()]
+        self.assertEqual(
+            op_types.count('fake_quantize_moving_average_abs_max'), 0)
+        self.assertEqual(
+            op_types.count('fake_quantize_dequantize_moving_average_abs_max'),
+            num_quant)
+        self.check_program(graph.to_program())
+
     def residual_block_quant(self,
                              activation_quant_type,
                              weight_quantize_type,
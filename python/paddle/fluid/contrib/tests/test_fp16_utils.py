@@ -38,6 +38,27 @@ class AMPTest(unittest.TestCase):
         res = fp16_utils.find_true_post_op(block.ops, op1, "Y")
         assert (res == [op2])
 
+    def test_rewrite_program_bf16(self):
+        main_prog = fluid.Program()
+        with fluid.program_guard(main_prog, fluid.Program()):
+            x = fluid.data(name='x', shape=[None, 4], dtype='float32')
+            y = fluid.data(name='y', shape=[4, 4], dtype='float32')
+            out = fluid.layers.relu(fluid.layers.matmul(x, y))
+            fluid.layers.softmax(out)
+        fp16_utils.rewrite_program_bf16(main_prog)
+
+        ops = main_prog.global_block().ops
+        op_types = [op.type for op in ops]
+        self.assertEqual(
+            op_types,
+            ['cast', 'cast', 'matmul', 'relu', 'cast', 'softmax'])
+        matmul = ops[2]
+        self.assertTrue(matmul.attr('use_mkldnn'))
+        block = main_prog.global_block()
+        self.assertEqual(
+            block.var(matmul.output('Out')[0]).dtype, core.VarDesc.VarType.BF16)
+        self.assertEqual(ops[4].attr('out_dtype'), core.VarDesc.VarType.FP32)
+
 
 if __name__ == '__main__':
     unittest.main()
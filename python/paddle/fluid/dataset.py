@@ -221,9 +221,74 @@ class DatasetBase(object):
         self.dataset.set_filelist(filelist)
         self.filelist = filelist
 
+    def set_io_thread_cpus(self, cpus):
+        """
+        Set the CPUs of the reader threads, e.g. "40-43,88-91". The readers
+        are spread over the NUMA nodes of the CPUs, and the CPUs should be
+        disjoint with the ones of the trainer threads. It overrides
+        FLAGS_io_thread_cpus.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset()
+              dataset.set_io_thread_cpus("40-43,88-91")
+
+        Args:
+            cpus(str): the CPU list, like "0-3,8,10-11"
+        """
+        self.proto_desc.io_thread_cpus = cpus
+
     def set_input_type(self, input_type):
         self.proto_desc.input_type = input_type
 
+    def set_zero_copy_feed(self, zero_copy_feed=True):
+        """
+        Set whether to scatter the batches into the feed tensors directly.
+        It avoids the intermediate buffers and copies of each slot in every
+        batch, and the feed tensors on GPU are copied from double buffered
+        pinned memory asynchronously. Only InMemoryDataset supports it.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_zero_copy_feed(True)
+
+        Args:
+            zero_copy_feed(bool): whether to enable zero copy feed,
+                                  default is True
+        """
+        self.proto_desc.zero_copy_feed = zero_copy_feed
+
+    def set_length_bucketing(self, slot_name, window_size, seed=0):
+        """
+        Set to batch the records of similar lengths together, which reduces
+        the padding of sequence models. The records are read window_size at a
+        time, sorted by the number of feasigns of the slot slot_name, and
+        split into batches, which are then trained in a random order. The
+        batches are the same in every pass with the same seed. Only
+        InMemoryDataset supports it.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_length_bucketing("words", 1024)
+
+        Args:
+            slot_name(str): the name of the slot to bucket the records by
+            window_size(int): the number of records bucketed at a time, 0
+                              disables the bucketing
+            seed(int): the seed of the order of the batches, default is 0
+        """
+        self.proto_desc.bucket_slot = slot_name
+        self.proto_desc.bucket_window = window_size
+        self.proto_desc.bucket_seed = seed
+
     def set_use_var(self, var_list):
         """
         Set Variables which you will use.
@@ -288,6 +353,83 @@ class DatasetBase(object):
         """
         self.dataset.set_download_cmd(download_cmd)
 
+    def set_read_ahead(self,
+                       depth,
+                       tmp_dir="/tmp",
+                       download_thread_num=2,
+                       decompress_thread_num=2):
+        """
+        Set the read-ahead of the files. At most depth files after the ones
+        being read are downloaded into tmp_dir in the background, and the .gz
+        files are decompressed in parallel, so that reading does not wait for
+        the download and decompression. The temporary files are removed after
+        they are read. depth=0 disables the read-ahead.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset()
+              dataset.set_read_ahead(4, "./read_ahead_tmp")
+
+        Args:
+            depth(int): the number of files to read ahead
+            tmp_dir(str): the directory of the temporary files, default is
+                          "/tmp"
+            download_thread_num(int): the number of download threads,
+                                      default is 2
+            decompress_thread_num(int): the number of decompress threads,
+                                        default is 2
+        """
+        self.dataset.set_read_ahead(depth, tmp_dir, download_thread_num,
+                                    decompress_thread_num)
+
+    def get_pipeline_stat(self):
+        """
+        Get the stat of each stage of the data pipeline, which helps to tell
+        whether the training is bound by reading, parsing or training, and
+        to tune thread_num and channel_num.
+
+        The stages are "read" (read and parse the files), "shuffle", "merge"
+        (merge by ins id), "feed" (copy the batches to the feed variables)
+        and "consume" (train with the batches). The stat of a stage includes
+        records, bytes, busy_sec summed over the threads, wall_sec, and
+        records_per_sec and bytes_per_sec in the wall time.
+
+        The stat of "input_channel", "output_channel" and "consume_channel"
+        includes the current size, and the read_blocked_sec and
+        write_blocked_sec since the channels are created.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              filelist = ["a.txt", "b.txt"]
+              dataset.set_filelist(filelist)
+              dataset.load_into_memory()
+              stat = dataset.get_pipeline_stat()
+              print(stat["read"]["records_per_sec"])
+
+        Returns:
+            A dict of stage name to the dict of stat name to value
+        """
+        return self.dataset.get_pipeline_stat()
+
+    def reset_pipeline_stat(self):
+        """
+        Reset the stat of the stages of the data pipeline to zero.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.reset_pipeline_stat()
+
+        """
+        self.dataset.reset_pipeline_stat()
+
     def _prepare_to_run(self):
         """
         Set data_feed_desc before load or shuffle,
@@ -349,6 +491,12 @@ class InMemoryDataset(DatasetBase):
         self.enable_pv_merge = False
         self.merge_by_lineid = False
         self.fleet_send_sleep_seconds = None
+        self.fleet_send_window_size = None
+        self.compress_shuffle_msg = False
+        self.channel_shard_num = 1
+        self.spill_dir = None
+        self.spill_memory_budget_mb = 1024
+        self.spill_bucket_num = 64
 
     def set_feed_type(self, data_feed_type):
         """
@@ -372,6 +520,11 @@ class InMemoryDataset(DatasetBase):
         self.dataset.set_parse_logkey(self.parse_logkey)
         self.dataset.set_merge_by_sid(self.merge_by_sid)
         self.dataset.set_enable_pv_merge(self.enable_pv_merge)
+        if self.spill_dir is not None:
+            self.dataset.set_spill_config(self.spill_dir,
+                                          self.spill_memory_budget_mb,
+                                          self.spill_bucket_num)
+        self.dataset.set_channel_shard_num(self.channel_shard_num)
         self.dataset.set_data_feed_desc(self.desc())
         self.dataset.create_channel()
         self.dataset.create_readers()
@@ -380,8 +533,12 @@ class InMemoryDataset(DatasetBase):
         if not self.is_user_set_queue_num:
             self.dataset.dynamic_adjust_channel_num(thread_num, False)
         self.dataset.dynamic_adjust_readers_num(thread_num)
+        if self.spill_dir is not None:
+            self.dataset.start_spill_stream()
 
     def _dynamic_adjust_after_train(self):
+        if self.spill_dir is not None:
+            self.dataset.wait_spill_stream_done()
         if not self.is_user_set_queue_num:
             self.dataset.dynamic_adjust_channel_num(self.thread_num, False)
         self.dataset.dynamic_adjust_readers_num(self.thread_num)
@@ -578,6 +735,93 @@ class InMemoryDataset(DatasetBase):
         """
         self.fleet_send_sleep_seconds = fleet_send_sleep_seconds
 
+    def set_spill(self, spill_dir, memory_budget_mb=1024, bucket_num=64):
+        """
+        Set the spill mode, for the dataset larger than the host memory.
+        load_into_memory partitions the records into bucket_num shuffle
+        buckets in spill_dir on local disk, instead of holding them in
+        memory. In each pass of training, the buckets are streamed back in
+        random order, and the records in each bucket are shuffled, so
+        local_shuffle is not needed. memory_budget_mb bounds the memory to
+        buffer the buckets and the streamed records, and a bucket should be
+        smaller than half of it. Global shuffle and preload are not
+        supported in the spill mode.
+
+        Args:
+            spill_dir(str): the local directory of the buckets
+            memory_budget_mb(int): the memory budget in MB, default is 1024
+            bucket_num(int): the number of buckets, default is 64
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_spill("/ssd/spill", memory_budget_mb=4096)
+
+        """
+        self.spill_dir = spill_dir
+        self.spill_memory_budget_mb = memory_budget_mb
+        self.spill_bucket_num = bucket_num
+
+    def set_fleet_send_window_size(self, fleet_send_window_size=16):
+        """
+        Set the max number of messages each global shuffle thread keeps in
+        flight, default is 16. A thread waits for its oldest message only
+        when the window is full, so serializing and sending are pipelined.
+        0 means to wait for all messages of a batch before sending the next.
+
+        Args:
+            fleet_send_window_size(int): fleet send window size
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_fleet_send_window_size(32)
+
+        """
+        self.fleet_send_window_size = fleet_send_window_size
+
+    def set_compress_shuffle_msg(self, compress_shuffle_msg=True):
+        """
+        Set whether to compress the messages of global shuffle with zlib,
+        default is False. It reduces the network traffic at the cost of cpu.
+
+        Args:
+            compress_shuffle_msg(bool): whether to compress the messages
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_compress_shuffle_msg(True)
+
+        """
+        self.compress_shuffle_msg = compress_shuffle_msg
+
+    def set_channel_shard_num(self, channel_shard_num):
+        """
+        Set the shard num of the channels which keep the records in memory,
+        default is 1. Each shard has its own lock, so that many reader
+        threads can write the channels concurrently without waiting for one
+        lock. The records in a sharded channel are not kept in order.
+
+        Args:
+            channel_shard_num(int): the shard num of the channels
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_channel_shard_num(16)
+
+        """
+        self.channel_shard_num = channel_shard_num
+
     def set_merge_by_lineid(self, merge_size=2):
         """
         Set merge by line id, instances of same line id will be merged after
@@ -624,6 +868,37 @@ class InMemoryDataset(DatasetBase):
         self._prepare_to_run()
         self.dataset.load_into_memory()
 
+    def convert_to_binary(self, output_dir):
+        """
+        Convert the text data files into the slot-columnar binary format,
+        and write them to output_dir with the same file names. The binary
+        files are loaded much faster with the feed type
+        "MultiSlotBinaryInMemoryDataFeed", since no number is parsed.
+
+        The slots of the binary files are the used slots of this dataset,
+        and the ins_id, content and logkey are kept if they are parsed.
+
+        Args:
+            output_dir(str): the directory of the binary files
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_filelist(["a.txt", "b.txt"])
+              dataset.convert_to_binary("binary_data")
+              dataset.set_feed_type("MultiSlotBinaryInMemoryDataFeed")
+              dataset.set_filelist(["binary_data/a.txt", "binary_data/b.txt"])
+              dataset.load_into_memory()
+        """
+        feed_type = self.proto_desc.name
+        self.proto_desc.name = "MultiSlotBinaryInMemoryDataFeed"
+        self._prepare_to_run()
+        self.dataset.convert_to_binary(output_dir)
+        self.dataset.destroy_readers()
+        self.proto_desc.name = feed_type
+
     def preload_into_memory(self, thread_num=None):
         """
         Load data into memory in async mode
@@ -712,10 +987,14 @@ class InMemoryDataset(DatasetBase):
             self.fleet_send_batch_size = 1024
         if self.fleet_send_sleep_seconds is None:
             self.fleet_send_sleep_seconds = 0
+        if self.fleet_send_window_size is None:
+            self.fleet_send_window_size = 16
         self.dataset.register_client2client_msg_handler()
         self.dataset.set_trainer_num(trainer_num)
         self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
         self.dataset.set_fleet_send_sleep_seconds(self.fleet_send_sleep_seconds)
+        self.dataset.set_fleet_send_window_size(self.fleet_send_window_size)
+        self.dataset.set_compress_shuffle_msg(self.compress_shuffle_msg)
         if fleet is not None:
             fleet._role_maker.barrier_worker()
         self.dataset.global_shuffle(thread_num)
@@ -406,6 +406,9 @@ class Section(DeviceWorker):
         section_param.queue_size = pipeline_opt["queue_size"]
         section_param.sync_steps = pipeline_opt["sync_steps"]
         section_param.start_cpu_core_id = pipeline_opt["start_cpu_core_id"]
+        if pipeline_opt.get("schedule_mode", "Async") == "1F1B":
+            section_param.schedule_mode = section_param.OneFOneB
+        section_param.num_microbatches = pipeline_opt.get("num_microbatches", 1)
         for e in pipeline_opt["param_need_sync"]:
             section_param.param_need_sync.append(e)
         for i, program in enumerate(pipeline_opt["section_program_list"]):
@@ -419,6 +422,7 @@ class Section(DeviceWorker):
                 cfg.place = cfg.CPUPlace
             elif isinstance(place, core.CUDAPlace):
                 cfg.place = cfg.CUDAPlace
+                cfg.place_id = place.gpu_device_id()
             elif isinstance(place, core.CUDAPinnedPlace):
                 cfg.place = cfg.CUDAPinnedPlace
             else:
@@ -53,6 +53,9 @@ from .dygraph_to_static import ProgramTranslator
 from . import rnn
 from .rnn import *
 
+from . import amp
+from .amp import *
+
 __all__ = []
 __all__ += layers.__all__
 __all__ += base.__all__
@@ -64,4 +67,5 @@ __all__ += learning_rate_scheduler.__all__
 __all__ += backward_strategy.__all__
 __all__ += jit.__all__
 __all__ += rnn.__all__
+__all__ += amp.__all__
 __all__ += ['ProgramTranslator']
@@ -0,0 +1,188 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except jin compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import numpy as np
+
+from .. import framework
+from ..wrapped_decorator import signature_safe_contextmanager
+from .base import to_variable
+
+__all__ = ['amp_guard', 'AmpScaler']
+
+
+@signature_safe_contextmanager
+def amp_guard(enable=True, custom_white_list=None, custom_black_list=None):
+    """
+    Enable the automatic mixed precision of the ops on GPU in the context.
+    The float inputs of the ops in the white list, e.g. conv2d and matmul,
+    are cast to float16, the inputs of the ops in the black list, e.g.
+    softmax and mean, are cast to float32, and the other ops with both
+    float16 and float32 inputs run in float32. The float16 casts of the
+    parameters are reused until the context exits, so a context usually
+    holds the forward of a step.
+
+    Args:
+        enable(bool, optional): Whether to enable the auto cast. Default: True.
+        custom_white_list(set, optional): The ops added to the white list.
+        custom_black_list(set, optional): The ops added to the black list.
+
+    Examples:
+        .. code-block:: python
+
+            import numpy as np
+            import paddle.fluid as fluid
+
+            with fluid.dygraph.guard(fluid.CUDAPlace(0)):
+                conv = fluid.dygraph.Conv2D(3, 2, 3)
+                x = fluid.dygraph.to_variable(
+                    np.random.random([1, 3, 8, 8]).astype('float32'))
+                with fluid.dygraph.amp_guard():
+                    y = conv(x)
+                    print(y.dtype)  # VarType.FP16
+    """
+    from ..contrib.mixed_precision.fp16_lists import AutoMixedPrecisionLists
+    amp_lists = AutoMixedPrecisionLists(custom_white_list, custom_black_list)
+    tracer = framework._dygraph_tracer()
+    assert tracer is not None, "amp_guard only works in dygraph mode"
+    original_enable = tracer._enable_autocast
+    if enable:
+        tracer._set_amp_op_list(amp_lists.white_list, amp_lists.black_list)
+    tracer._enable_autocast = enable
+    try:
+        yield
+    finally:
+        tracer._enable_autocast = original_enable
+
+
+class AmpScaler(object):
+    """
+    The dynamic loss scaling of the automatic mixed precision in dygraph.
+    The loss is scaled before backward to keep the small float16 gradients,
+    and the gradients are unscaled before the optimizer updates the
+    parameters. If any gradient is inf or nan, the step is skipped, and the
+    loss scaling is decreased after decr_every_n_nan_or_inf such steps. The
+    loss scaling is increased after incr_every_n_steps finite steps in a row.
+
+    Args:
+        init_loss_scaling(float, optional): The initial loss scaling.
+            Default: 2**15.
+        incr_ratio(float, optional): The multiplier to increase the loss
+            scaling. Default: 2.0.
+        decr_ratio(float, optional): The multiplier to decrease the loss
+            scaling. Default: 0.5.
+        incr_every_n_steps(int, optional): Default: 1000.
+        decr_every_n_nan_or_inf(int, optional): Default: 2.
+        use_dynamic_loss_scaling(bool, optional): Whether to update the loss
+            scaling. Default: True.
+
+    Examples:
+        .. code-block:: python
+
+            import numpy as np
+            import paddle.fluid as fluid
+
+            with fluid.dygraph.guard(fluid.CUDAPlace(0)):
+                linear = fluid.dygraph.Linear(4, 4)
+                sgd = fluid.optimizer.SGD(
+                    learning_rate=0.01, parameter_list=linear.parameters())
+                scaler = fluid.dygraph.AmpScaler()
+                x = fluid.dygraph.to_variable(
+                    np.random.random([2, 4]).astype('float32'))
+                with fluid.dygraph.amp_guard():
+                    loss = fluid.layers.mean(linear(x))
+                scaled = scaler.scale(loss)
+                scaled.backward()
+                scaler.minimize(sgd, scaled)
+                linear.clear_gradients()
+    """
+
+    def __init__(self,
+                 init_loss_scaling=2.**15,
+                 incr_ratio=2.0,
+                 decr_ratio=0.5,
+                 incr_every_n_steps=1000,
+                 decr_every_n_nan_or_inf=2,
+                 use_dynamic_loss_scaling=True):
+        self._loss_scaling = float(init_loss_scaling)
+        self._incr_ratio = incr_ratio
+        self._decr_ratio = decr_ratio
+        self._incr_every_n_steps = incr_every_n_steps
+        self._decr_every_n_nan_or_inf = decr_every_n_nan_or_inf
+        self._use_dynamic_loss_scaling = use_dynamic_loss_scaling
+        self._num_good_steps = 0
+        self._num_bad_steps = 0
+
+    @property
+    def loss_scaling(self):
+        return self._loss_scaling
+
+    def scale(self, var):
+        """
+        Return the var multiplied by the loss scaling.
+        """
+        return var * self._loss_scaling
+
+    @framework.dygraph_only
+    def minimize(self, optimizer, *args, **kwargs):
+        """
+        Unscale the gradients of the parameters of the optimizer, and call
+        optimizer.minimize(*args, **kwargs) if all of them are finite.
+
+        Returns:
+            bool: Whether the step is skipped for inf or nan gradients.
+        """
+        grads = []
+        for param in optimizer._parameter_list:
+            grad = param._grad_ivar()
+            # only the dense gradients are checked
+            if grad is not None and not grad._is_sparse():
+                grads.append(grad)
+
+        found_inf = False
+        if grads:
+            scale = to_variable(
+                np.array([1.0 / self._loss_scaling]).astype('float32'))
+            found_inf_var = to_variable(np.array([False]))
+            framework._dygraph_tracer().trace_op(
+                'amp_check_finite_and_scale', {'X': grads,
+                                               'Scale': [scale]},
+                {'Out': grads,
+                 'FoundInfinite': [found_inf_var]}, {},
+                stop_gradient=True)
+            found_inf = bool(found_inf_var.numpy()[0])
+
+        if not found_inf:
+            optimizer.minimize(*args, **kwargs)
+        if self._use_dynamic_loss_scaling:
+            self._update_loss_scaling(found_inf)
+        return found_inf
+
+    def _update_loss_scaling(self, found_inf):
+        if found_inf:
+            self._num_good_steps = 0
+            self._num_bad_steps += 1
+            if self._num_bad_steps == self._decr_every_n_nan_or_inf:
+                self._loss_scaling = max(
+                    self._loss_scaling * self._decr_ratio, 1.0)
+                self._num_bad_steps = 0
+        else:
+            self._num_bad_steps = 0
+            self._num_good_steps += 1
+            if self._num_good_steps == self._incr_every_n_steps:
+                new_loss_scaling = self._loss_scaling * self._incr_ratio
+                if np.isfinite(new_loss_scaling):
+                    self._loss_scaling = new_loss_scaling
+                self._num_good_steps = 0
@@ -14,7 +14,9 @@
 
 from __future__ import print_function
 
-__all__ = ['TracedLayer', 'declarative', 'dygraph_to_static_func']
+__all__ = [
+    'TracedLayer', 'CachedTracedLayer', 'declarative', 'dygraph_to_static_func'
+]
 
 import logging
 from paddle.fluid import core
@@ -462,3 +464,71 @@ class TracedLayer(object):
                 target_vars=target_vars,
                 executor=self._exe,
                 main_program=self._program.clone())
+
+
+class CachedTracedLayer(object):
+    """
+    :api_attr: imperative
+
+    CachedTracedLayer traces the forward of a dygraph layer once for every
+    signature of the inputs, i.e. their dtypes and shapes, and replays the
+    traced program by the C++ :code:`NaiveExecutor` on the later calls with
+    the same signature, so that the ops are no longer run one by one through
+    Python and the tracer. The first call of a signature runs the layer in
+    dygraph mode and returns its outputs.
+
+    The traced programs share the parameters with the layer, and see the
+    updates of them. The outputs of the replays have no gradient, so it is
+    for the forward only passes, e.g. the evaluation of a model in a dygraph
+    training loop. Like :code:`TracedLayer`, the layer should be independent
+    with the tensor data.
+
+    Args:
+        layer (Layer): the layer to trace.
+        passes (list[str], optional): the IR passes applied to every traced
+            program, which should not rewrite the parameters. Default None.
+
+    Examples:
+        .. code-block:: python:
+
+            import paddle.fluid as fluid
+            from paddle.fluid.dygraph import Linear, to_variable, CachedTracedLayer
+            import numpy as np
+
+            with fluid.dygraph.guard():
+                layer = Linear(3, 10)
+                cached_layer = CachedTracedLayer(layer)
+                for _ in range(3):
+                    in_var = to_variable(
+                        np.random.random([2, 3]).astype('float32'))
+                    # traced by the first call, and replayed by the others
+                    out = cached_layer(in_var)
+                print(out.shape) # [2, 10]
+    """
+
+    @dygraph_only
+    def __init__(self, layer, passes=None):
+        assert isinstance(layer, Layer)
+        self._layer = layer
+        place = _current_expected_place()
+        if isinstance(place, core.CUDAPinnedPlace):
+            place = core.CPUPlace()
+        self._cache = core.TracedProgramCache(place, passes or [])
+        # signature -> whether the layer returns a list or tuple
+        self._returns_list = {}
+
+    def __call__(self, *inputs):
+        var_list = extract_vars(list(inputs))
+        signature = core.TracedProgramCache.signature(var_list)
+        if not self._cache.has(signature):
+            outputs, program, feed_names, fetch_names, parameters = _trace(
+                self._layer, list(inputs))
+            self._cache.insert(signature, program.desc, feed_names,
+                               fetch_names, parameters)
+            self._returns_list[signature] = isinstance(outputs, (list, tuple))
+            return outputs
+
+        outputs = self._cache.run(signature, var_list)
+        if self._returns_list[signature]:
+            return outputs
+        return outputs[0]
@@ -462,8 +462,15 @@ class Layer(core.Layer):
                         self._parameters.values())
             self._built = True
 
-        with param_guard(self._parameters):
-            outputs = self.forward(*inputs, **kwargs)
+        profiling = core._is_op_profiler_enabled()
+        if profiling:
+            core._push_op_profiler_scope(self._full_name)
+        try:
+            with param_guard(self._parameters):
+                outputs = self.forward(*inputs, **kwargs)
+        finally:
+            if profiling:
+                core._pop_op_profiler_scope()
 
         for forward_post_hook in self._forward_post_hooks.values():
             hook_result = forward_post_hook(self, inputs, outputs)
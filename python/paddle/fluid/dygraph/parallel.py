@@ -235,6 +235,11 @@ class DataParallel(layers.Layer):
         layers(Layer): The module that should be executed by data parallel.
         strategy(ParallelStrategy): The strategy of data parallelism, contains 
             environment configuration related to parallel execution.
+        comm_buffer_size(int, optional): The max size in MB of the buckets of
+            gradients allreduced during backward, which overlaps the
+            communication with the calculation on GPU. If None, the gradients
+            are allreduced in apply_collective_grads after backward instead.
+            Default: None.
 
     Returns:
         Layer: The data paralleled module.
@@ -279,12 +284,28 @@ class DataParallel(layers.Layer):
                linear.clear_gradients()
     """
 
-    def __init__(self, layers, strategy):
+    def __init__(self, layers, strategy, comm_buffer_size=None):
         super(DataParallel,
               self).__init__(layers.full_name() + "_data_parallel")
 
         self._layers = layers
         self._strategy = strategy
+        self._reducer = None
+        if comm_buffer_size is not None and self._is_data_parallel_mode() and \
+                hasattr(core, "Reducer") and \
+                isinstance(framework._current_expected_place(), core.CUDAPlace):
+            params = [p for p in self._layers.parameters() if p.trainable]
+            if params:
+                # decided by the layers rather than by the gradients, so
+                # that all the trainers agree on the buckets
+                sparse_params = set()
+                for layer in [self._layers] + self._layers.sublayers():
+                    if getattr(layer, "_is_sparse", False):
+                        for p in layer.parameters(include_sublayers=False):
+                            sparse_params.add(p.name)
+                is_sparse = [p.name in sparse_params for p in params]
+                self._reducer = core.Reducer(params, is_sparse, self._strategy,
+                                             comm_buffer_size * 1024 * 1024)
 
     def forward(self, *inputs, **kwargs):
         return self._layers(*inputs, **kwargs)
@@ -418,6 +439,10 @@ class DataParallel(layers.Layer):
         if not self._is_data_parallel_mode():
             return
 
+        if self._reducer is not None:
+            self._reducer.finalize_backward()
+            return
+
         grad_var_set = set()
         grad_vars = []
         sparse_grad_vars = []
@@ -15,10 +15,17 @@
 from __future__ import print_function
 
 from .. import core
+from ..wrapped_decorator import signature_safe_contextmanager
 
 __all__ = [
     'start_gperf_profiler',
     'stop_gperf_profiler',
+    'start_op_profiler',
+    'stop_op_profiler',
+    'op_profiler_summary',
+    'op_profiler_records',
+    'export_op_profiler_chrome_trace',
+    'op_profiler',
 ]
 
 
@@ -28,3 +35,83 @@ def start_gperf_profiler():
 
 def stop_gperf_profiler():
     core.stop_imperative_gperf_profiler()
+
+
+def start_op_profiler(capacity=100000, sync_device=False):
+    """
+    Start recording the traced ops and their grad ops, with the time, the
+    bytes of the outputs, and the layers calling them. The latest `capacity`
+    ops are kept.
+
+    Args:
+        capacity(int, optional): The number of the ops kept. Default: 100000.
+        sync_device(bool, optional): Whether to wait the device after each op,
+            so that the time covers the kernels on the device. It slows down
+            the GPU runs. Default: False.
+    """
+    core._start_op_profiler(capacity, sync_device)
+
+
+def stop_op_profiler():
+    """
+    Stop recording the ops, the records are kept until the next start.
+    """
+    core._stop_op_profiler()
+
+
+def op_profiler_summary(max_rows=50):
+    """
+    Return the tables of the ops grouped by the layer, the op type and the
+    pass, and of the layers, sorted by the total time.
+    """
+    return core._op_profiler_summary(max_rows)
+
+
+def op_profiler_records():
+    """
+    Return the records as a list of dicts with the keys type, layer, backward,
+    time_ns and output_bytes.
+    """
+    return core._op_profiler_records()
+
+
+def export_op_profiler_chrome_trace(path):
+    """
+    Export the records to a file viewed in chrome://tracing.
+    """
+    core._export_op_profiler_chrome_trace(path)
+
+
+@signature_safe_contextmanager
+def op_profiler(capacity=100000,
+                sync_device=False,
+                summary=True,
+                chrome_trace_path=None):
+    """
+    Record the ops run in the context, print the summary and export the
+    chrome trace on exit.
+
+    Examples:
+        .. code-block:: python
+
+            import numpy as np
+            import paddle.fluid as fluid
+            from paddle.fluid.dygraph import profiler
+
+            with fluid.dygraph.guard():
+                linear = fluid.dygraph.Linear(4, 4)
+                x = fluid.dygraph.to_variable(
+                    np.random.random([2, 4]).astype('float32'))
+                with profiler.op_profiler(chrome_trace_path='/tmp/ops.json'):
+                    loss = fluid.layers.mean(linear(x))
+                    loss.backward()
+    """
+    start_op_profiler(capacity, sync_device)
+    try:
+        yield
+    finally:
+        stop_op_profiler()
+        if summary:
+            print(op_profiler_summary())
+        if chrome_trace_path is not None:
+            export_op_profiler_chrome_trace(chrome_trace_path)
@@ -212,11 +212,44 @@ def monkey_patch_varbase():
     def __bool__(self):
         return self.__nonzero__()
 
+    def _create_inplace_unary(op_type):
+        @framework.dygraph_only
+        def __impl__(self):
+            """
+            Run the op in place, i.e., write the output to the memory of this
+            Variable and return it. This Variable must not require gradient,
+            and the gradients needing its old value fail in backward.
+            """
+            framework._dygraph_tracer().trace_op(op_type, {'X': [self]},
+                                                 {'Out': [self]}, {})
+            return self
+
+        __impl__.__name__ = op_type + '_'
+        return __impl__
+
+    @framework.dygraph_only
+    def scale_(self, scale=1.0, bias=0.0, bias_after_scale=True):
+        """
+        The inplace version of fluid.layers.scale, see relu_ for the
+        restrictions.
+        """
+        framework._dygraph_tracer().trace_op(
+            'scale', {'X': [self]}, {'Out': [self]}, {
+                'scale': float(scale),
+                'bias': float(bias),
+                'bias_after_scale': bias_after_scale
+            })
+        return self
+
     for method_name, method in (
         ("__bool__", __bool__), ("__nonzero__", __nonzero__),
         ("set_value", set_value), ("block", block), ("backward", backward),
-        ("gradient", gradient), ("__str__", __str__), ("to_string", to_string)):
+        ("gradient", gradient), ("__str__", __str__), ("to_string", to_string),
+        ("scale_", scale_)):
         setattr(core.VarBase, method_name, method)
 
+    for op_type in ['relu', 'sigmoid', 'tanh', 'sqrt', 'exp']:
+        setattr(core.VarBase, op_type + '_', _create_inplace_unary(op_type))
+
     # patch math methods for varbase
     monkey_patch_math_varbase()
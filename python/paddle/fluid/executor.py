@@ -390,7 +390,7 @@ def _get_program_cache_key(feed, fetch_list):
     return str(feed_var_names + fetch_var_names)
 
 
-def _as_lodtensor(data, place, dtype=None):
+def _as_lodtensor(data, place, dtype=None, borrow=False):
     """
         Convert numpy.ndarray to Tensor, its only support Tensor without LoD information.
         For higher dimensional sequence data, please use LoDTensor directly.
@@ -407,6 +407,9 @@ def _as_lodtensor(data, place, dtype=None):
             data(numpy.ndarray): a instance of array
             data(core.Place): the place of created tensor
             dtype(core.VarDesc.VarType): the expected data type of created tensor
+            borrow(bool): whether the created tensor on CPUPlace shares the
+                memory of a C-contiguous data without copying, the data is
+                copied before the tensor is modified
 
         Returns:
             LoDTensor
@@ -428,7 +431,11 @@ def _as_lodtensor(data, place, dtype=None):
 
     # single tensor case
     tensor = core.LoDTensor()
-    tensor.set(data, place)
+    if borrow and isinstance(place, core.CPUPlace) and isinstance(
+            data, np.ndarray) and data.flags['C_CONTIGUOUS']:
+        tensor.set(data, place, zero_copy=True, copy_on_write=True)
+    else:
+        tensor.set(data, place)
     return tensor
 
 
@@ -636,13 +643,15 @@ class Executor(object):
     def _feed_data(self, program, feed, feed_var_name, scope):
         # feed var to framework
         global_block = program.global_block()
+        borrow = core.globals()['FLAGS_borrow_numpy_feed']
         for op in global_block.ops:
             if op.desc.type() == 'feed':
                 feed_target_name = op.desc.output('Out')[0]
                 cur_feed = feed[feed_target_name]
                 var = global_block.var(feed_target_name)
                 if not isinstance(cur_feed, core.LoDTensor):
-                    cur_feed = _as_lodtensor(cur_feed, self.place, var.dtype)
+                    cur_feed = _as_lodtensor(cur_feed, self.place, var.dtype,
+                                             borrow)
                 check_feed_shape_type(var, cur_feed)
                 idx = op.desc.attr('col')
                 core.set_feed_variable(scope, cur_feed, feed_var_name, idx)
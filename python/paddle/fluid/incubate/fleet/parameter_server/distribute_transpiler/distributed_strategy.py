@@ -44,6 +44,10 @@ class TrainerRuntimeConfig(object):
             "FLAGS_communicator_send_wait_times", "5")
         self.runtime_configs['communicator_is_sgd_optimizer'] = os.getenv(
             "FLAGS_communicator_is_sgd_optimizer", "1")
+        self.runtime_configs['communicator_merge_thread_num'] = os.getenv(
+            "FLAGS_communicator_merge_thread_num", "0")
+        self.runtime_configs['communicator_batch_var_max_bytes'] = os.getenv(
+            "FLAGS_communicator_batch_var_max_bytes", "0")
 
         # not used 
         self.runtime_configs['rpc_deadline'] = os.getenv("FLAGS_rpc_deadline",
@@ -63,7 +67,7 @@ class TrainerRuntimeConfig(object):
             need_keys = [
                 'communicator_max_merge_var_num',
                 'communicator_send_wait_times', 'communicator_thread_pool_size',
-                'communicator_send_queue_size'
+                'communicator_send_queue_size', 'communicator_merge_thread_num'
             ]
         elif self.mode == DistributedMode.GEO:
             mode_str = "GEO"
@@ -270,6 +270,42 @@ class PSLib(Fleet):
             self._fleet_ptr.print_table_stat(table_id)
         self._role_maker._barrier_worker()
 
+    def set_sparse_row_cache(self, table_id, capacity, max_age):
+        """
+        cache at most capacity hot rows of sparse table table_id in each
+        worker, so that they are not pulled from servers in every batch.
+        a cached row is used for at most max_age batches after it is pulled,
+        and the gradients are always pushed to servers.
+        it should be called before training.
+
+        Args:
+            table_id(int): the id of sparse table
+            capacity(int): the max number of cached rows, 0 means no cache
+            max_age(int): the max number of batches a cached row is used
+
+        Example:
+            .. code-block:: python
+
+              fleet.set_sparse_row_cache(0, 1000000, 10)
+
+        """
+        self._fleet_ptr.set_sparse_row_cache(table_id, capacity, max_age)
+
+    def print_sparse_row_cache_stat(self, table_id):
+        """
+        print the size and hit ratio of the sparse row cache of table_id
+
+        Args:
+            table_id(int): the id of sparse table
+
+        Example:
+            .. code-block:: python
+
+              fleet.print_sparse_row_cache_stat(0)
+
+        """
+        self._fleet_ptr.print_sparse_row_cache_stat(table_id)
+
     def save_persistables(self, executor, dirname, main_program=None, **kwargs):
         """
         save presistable parameters,
@@ -15,6 +15,7 @@
 from __future__ import print_function
 
 import os
+import atexit
 import errno
 import warnings
 import six
@@ -62,6 +63,9 @@ __all__ = [
     'set_program_state',
     'get_program_parameter',
     'get_program_persistable_vars',
+    'wait_async_checkpoints',
+    'add_async_checkpoint_callback',
+    'remove_async_checkpoint_callback',
 ] + reader.__all__ + paddle.reader.__all__
 
 _logger = get_logger(
@@ -663,6 +667,67 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
             filename=filename)
 
 
+def wait_async_checkpoints(path=None):
+    """
+    Wait for the files saved in the background. If the flag
+    :code:`FLAGS_async_checkpoint` is true, the save and save_combine ops
+    only copy the variables to the host memory, so the training continues
+    while the files are written by the IO threads. Each file is written to
+    a temporary file and renamed when it is complete. The pending files are
+    waited for when the program exits.
+
+    Args:
+        path(str, optional): The file to wait for. If it is None, wait for all
+            the files. Default: None.
+
+    Raises:
+        EnforceNotMet: If a file waited for failed to be written.
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            fluid.set_flags({'FLAGS_async_checkpoint': True})
+            image = fluid.data(name='img', shape=[None, 28, 28], dtype='float32')
+            predict = fluid.layers.fc(input=image, size=10, act='softmax')
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+            fluid.io.save_persistables(exe, "./my_paddle_model")
+            # the training continues here
+            fluid.io.wait_async_checkpoints()
+    """
+    core._wait_async_checkpoints(path or "")
+
+
+def add_async_checkpoint_callback(callback):
+    """
+    Add a callback called when a file saved in the background is written.
+
+    Args:
+        callback(callable): Called as :code:`callback(path, error)` on an IO
+            thread, :code:`error` is an empty string if the file is written
+            successfully.
+
+    Returns:
+        int: The id to remove the callback.
+    """
+    return core._add_async_checkpoint_callback(callback)
+
+
+def remove_async_checkpoint_callback(callback_id):
+    """
+    Remove the callback added by :code:`add_async_checkpoint_callback`.
+
+    Args:
+        callback_id(int): The id returned by add_async_checkpoint_callback.
+    """
+    core._remove_async_checkpoint_callback(callback_id)
+
+
+atexit.register(wait_async_checkpoints)
+
+
 @dygraph_not_support
 def load_vars(executor,
               dirname,
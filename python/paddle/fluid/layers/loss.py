@@ -37,6 +37,7 @@ __all__ = [
     'hsigmoid',
     'sampled_softmax_with_cross_entropy',
     'softmax_with_cross_entropy',
+    'chunked_softmax_with_cross_entropy',
     'rank_loss',
     'margin_rank_loss',
     'sigmoid_cross_entropy_with_logits',
@@ -1130,8 +1131,6 @@ def sampled_softmax_with_cross_entropy(logits,
     sampled_logits \
         = helper.create_variable_for_type_inference(dtype=logits.dtype)
     sampled_label = helper.create_variable_for_type_inference(dtype='int64')
-    sampled_softlabel = helper.create_variable_for_type_inference(
-        dtype=logits.dtype)
     logits_dim = helper.create_variable_for_type_inference(dtype=logits.dtype)
     labels_dim = helper.create_variable_for_type_inference(dtype=label.type)
 
@@ -1158,26 +1157,16 @@ def sampled_softmax_with_cross_entropy(logits,
             'num_samples': num_samples,
             'seed': seed
         })
+    # each of the num_true sampled labels takes a probability of 1 / num_true
     loss = helper.create_variable_for_type_inference(dtype=logits.dtype)
-    softmax = helper.create_variable_for_type_inference(dtype=logits.dtype)
+    log_sum_exp = helper.create_variable_for_type_inference(dtype=logits.dtype)
     helper.append_op(
-        type='one_hot',
-        inputs={'X': sampled_label},
-        attrs={'depth': num_samples + 1},
-        outputs={'Out': sampled_softlabel})
-
-    helper.append_op(
-        type='softmax_with_cross_entropy',
+        type='chunked_softmax_with_cross_entropy',
         inputs={'Logits': sampled_logits,
-                'Label': sampled_softlabel},
-        outputs={'Softmax': softmax,
-                 'Loss': loss},
-        attrs={
-            'soft_label': True,
-            'ignore_index': False,
-            'numeric_stable_mode': False
-        })
-    return loss / num_true
+                'Label': sampled_label},
+        outputs={'Loss': loss,
+                 'LogSumExp': log_sum_exp})
+    return loss
 
 
 def softmax_with_cross_entropy(logits,
@@ -1313,6 +1302,73 @@ def softmax_with_cross_entropy(logits,
     return loss
 
 
+def chunked_softmax_with_cross_entropy(logits,
+                                       label,
+                                       ignore_index=kIgnoreIndex,
+                                       chunk_size=4096):
+    """
+    This operator computes the same loss as :ref:`api_fluid_layers_softmax_with_cross_entropy`
+    with hard labels on the last dimension, but never stores the softmax of
+    the logits. The log-sum-exp of every row is computed over the chunks of
+    the classes with an online max, and the gradient of the logits recomputes
+    the softmax from the logits. It saves the memory of a [batch, classes]
+    activation when the number of classes is large, e.g., the vocabulary of a
+    language model.
+
+    The label can hold T true labels per row, each of them takes a probability
+    of 1 / T:
+
+    .. math::
+
+        loss_j = \\frac{1}{T}\\sum_{t=1}^{T}\\left(-\\text{logits}_{label_t} +
+        \\log\\left(\\sum_{i=0}^{K}\\exp(\\text{logits}_i)\\right)\\right)
+
+    Args:
+        logits (Variable): A multi-dimension ``Tensor`` of unscaled log
+            probabilities, whose last dimension is the classes. The data type
+            is float32 or float64.
+        label (Variable): The ground truth ``Tensor`` of int64, in the same
+            shape with :attr:`logits` except the last dimension as the number
+            of true labels.
+        ignore_index (int, optional): Specifies a target value that is ignored
+            and does not contribute to the loss and the input gradient.
+            Default: kIgnoreIndex(-100).
+        chunk_size (int, optional): The number of classes normalized at a time
+            on CPU. Default: 4096.
+
+    Returns:
+        Variable: The cross entropy loss, in the same shape with :attr:`logits`
+            except the last dimension as 1.
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            data = fluid.data(name='data', shape=[-1, 128], dtype='float32')
+            label = fluid.data(name='label', shape=[-1, 1], dtype='int64')
+            fc = fluid.layers.fc(input=data, size=100000)
+            out = fluid.layers.chunked_softmax_with_cross_entropy(
+                logits=fc, label=label)
+    """
+    check_variable_and_dtype(logits, 'logits', ['float32', 'float64'],
+                             'chunked_softmax_with_cross_entropy')
+    check_variable_and_dtype(label, 'label', ['int64'],
+                             'chunked_softmax_with_cross_entropy')
+    helper = LayerHelper('chunked_softmax_with_cross_entropy', **locals())
+    loss = helper.create_variable_for_type_inference(dtype=logits.dtype)
+    log_sum_exp = helper.create_variable_for_type_inference(dtype=logits.dtype)
+    helper.append_op(
+        type='chunked_softmax_with_cross_entropy',
+        inputs={'Logits': logits,
+                'Label': label},
+        outputs={'Loss': loss,
+                 'LogSumExp': log_sum_exp},
+        attrs={'ignore_index': ignore_index,
+               'chunk_size': chunk_size})
+    return loss
+
+
 def rank_loss(label, left, right, name=None):
     """
     :alias_main: paddle.nn.functional.rank_loss
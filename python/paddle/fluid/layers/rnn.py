@@ -2886,7 +2886,8 @@ def beam_search(pre_ids,
                 level=0,
                 is_accumulated=True,
                 name=None,
-                return_parent_idx=False):
+                return_parent_idx=False,
+                is_logits=False):
     """
 	:alias_main: paddle.nn.beam_search
 	:alias: paddle.nn.beam_search,paddle.nn.decode.beam_search
@@ -2954,6 +2955,10 @@ def beam_search(pre_ids,
             in output, which stores the selected ids' parent index in
             ``pre_ids`` and can be used to update RNN's states by gather operator.
             Default False.
+        is_logits(bool, optional): Whether the input ``scores`` are the logits
+            of single step, whose log-softmax is fused into this operator and
+            added up with ``pre_scores``. ``ids`` should be None then.
+            Default False.
 
     Returns:
         tuple: The tuple contains two or three LodTensor variables. The two LodTensor, \
@@ -3030,6 +3035,7 @@ def beam_search(pre_ids,
             'beam_size': beam_size,
             'end_id': end_id,
             'is_accumulated': is_accumulated,
+            'is_logits': is_logits,
         })
     if return_parent_idx:
         return selected_ids, selected_scores, parent_idx
@@ -3574,13 +3574,23 @@ class PipelineOptimizer(object):
     Args:
         optimizer (Optimizer): The based optimizer, such as SGD.
         cut_list (list of Variable list): The cut variable of the main_program.
-        place_list (list of Place): The place where the section will run on.
+        place_list (list of Place): The place where the section will run on. The \
+                        section of CUDAPlace(i) runs on the i-th GPU of its pipeline, so that \
+                        a model which does not fit one GPU can be split to several GPUs.
         concurrency_list (list of int): The concurrency degree.
         queue_size (int): Each section will consume scopes from its in-scope queue 
                         and produce scopes to out-scope queue. And this parameter 
                         specify the scope queue size. [Optional. Default: 30].
         sync_steps (int): The synchronization steps between different cards. [Optional. Default: 1].
         start_cpu_core_id (int): specify the first cpu core id. [Optional. Default:0].
+        schedule_mode (str): The schedule of micro-batches, "Async" or "1F1B". In the \
+                        "Async" mode, each section runs a micro-batch as soon as it receives one. \
+                        In the "1F1B" mode, the stage i of n stages keeps at most n-i micro-batches \
+                        in flight and alternates one forward and one backward, so that the \
+                        activation memory is bounded. [Optional. Default: "Async"].
+        num_microbatches (int): The number of micro-batches in a mini-batch. The "1F1B" \
+                        schedule flushes the pipeline every num_microbatches micro-batches. \
+                        [Optional. Default: 1].
 
     Examples:
         .. code-block:: python
@@ -3629,9 +3639,19 @@ class PipelineOptimizer(object):
                  concurrency_list=None,
                  queue_size=30,
                  sync_steps=1,
-                 start_cpu_core_id=0):
+                 start_cpu_core_id=0,
+                 schedule_mode="Async",
+                 num_microbatches=1):
         if framework.in_dygraph_mode():
             raise Exception("In dygraph, don't support PipelineOptimizer.")
+        if schedule_mode not in ["Async", "1F1B"]:
+            raise ValueError(
+                "schedule_mode should be 'Async' or '1F1B', but got %s." %
+                schedule_mode)
+        if num_microbatches < 1:
+            raise ValueError(
+                "num_microbatches should be larger than 0, but got %d." %
+                num_microbatches)
         # TODO: check properties
         self._optimizer = optimizer
         self._cut_list = cut_list
@@ -3640,6 +3660,8 @@ class PipelineOptimizer(object):
         self._queue_size = queue_size
         self._sync_steps = sync_steps
         self._start_cpu_core_id = start_cpu_core_id
+        self._schedule_mode = schedule_mode
+        self._num_microbatches = num_microbatches
 
     def _create_vars(self, block, main_program):
         used_var_set = set()
@@ -3851,7 +3873,9 @@ class PipelineOptimizer(object):
             "queue_size": self._queue_size,
             "start_cpu_core_id": self._start_cpu_core_id,
             "sync_steps": self._sync_steps,
-            "param_need_sync": param_need_sync
+            "param_need_sync": param_need_sync,
+            "schedule_mode": self._schedule_mode,
+            "num_microbatches": self._num_microbatches
         }
 
 
@@ -21,7 +21,9 @@ import six
 
 __all__ = [
     'cuda_profiler', 'reset_profiler', 'profiler', 'start_profiler',
-    'stop_profiler'
+    'stop_profiler', 'start_sampled_profiler', 'stop_sampled_profiler',
+    'start_memory_profiler', 'stop_memory_profiler', 'memory_profiler',
+    'start_comm_stats', 'stop_comm_stats'
 ]
 
 NVPROF_CONFIG = [
@@ -213,6 +215,10 @@ def stop_profiler(sorted_key=None, profile_path='/tmp/profile'):
             The `ave` means sorting by the average execution time.
             and write it into `profile_path`. The default profile_path is `/tmp/profile`. 
         profile_path (str, optional) : If state == 'All', it will generate timeline,
+            and the chrome trace of the host threads, the GPU streams and the
+            allocated memory to `profile_path + '.json'`, which is opened in
+            chrome://tracing directly, unless FLAGS_profiler_chrome_trace is
+            False.
 
     Raises:
         ValueError: If `sorted_key` is not in
@@ -351,3 +357,189 @@ def profiler(state,
         yield
     finally:
         stop_profiler(sorted_key, profile_path)
+
+
+def start_sampled_profiler(step_interval=100,
+                           event_ratio=1.0,
+                           flush_interval=1000,
+                           profile_path='/tmp/sampled_profile'):
+    """
+    Enable the sampled profiler, which is cheap enough to be always on in the
+    training and serving jobs. It samples one step in every `step_interval`
+    steps of the executors, and `event_ratio` of the events of the sampled
+    steps, records them into the lock-free buffers of the threads, and appends
+    the time of the events aggregated by name to `profile_path` every
+    `flush_interval` steps. Each line of the file is
+    `step name calls total_ms min_ms max_ms` separated by tabs.
+
+    The sampled profiler only works while the profiler, i.e.
+    `start_profiler`, is disabled.
+
+    Args:
+        step_interval (int, optional): Sample one step in every step_interval
+            steps. Default is 100.
+        event_ratio (float, optional): The probability to sample each event
+            of a sampled step, in [0, 1]. Default is 1.0.
+        flush_interval (int, optional): The number of steps between two
+            flushes. Default is 1000.
+        profile_path (str, optional): The file to append the aggregated
+            events to. Default is `/tmp/sampled_profile`.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_sampled_profiler(step_interval=100,
+                                            flush_interval=1000)
+            # the training loop
+            profiler.stop_sampled_profiler()
+    """
+    core._enable_sampled_profiler(step_interval, event_ratio, flush_interval,
+                                  profile_path)
+
+
+def stop_sampled_profiler():
+    """
+    Flush the remaining sampled events and disable the sampled profiler.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_sampled_profiler()
+            # the training loop
+            profiler.stop_sampled_profiler()
+    """
+    core._disable_sampled_profiler()
+
+
+def start_memory_profiler():
+    """
+    Enable the memory profiler, which tracks the live bytes of each place
+    over the ops run by the executors, and records the peak with the live
+    tensors and the high-water mark of each op type.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_memory_profiler()
+            # run the program
+            print(profiler.stop_memory_profiler())
+    """
+    core._enable_memory_profiler()
+
+
+def stop_memory_profiler(max_tensors=20):
+    """
+    Disable the memory profiler, and return the report of the peak of each
+    place with at most `max_tensors` of the largest live tensors, and the
+    table of the max live bytes and the max increase of each op type.
+
+    Args:
+        max_tensors (int, optional): The number of the tensors listed for
+            each peak. Default is 20.
+
+    Returns:
+        str: The report.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_memory_profiler()
+            # run the program
+            print(profiler.stop_memory_profiler())
+    """
+    core._disable_memory_profiler()
+    return core._memory_profiler_report(max_tensors)
+
+
+@signature_safe_contextmanager
+def memory_profiler(max_tensors=20):
+    """
+    The memory profiler interface, which prints the report of
+    `stop_memory_profiler` at the exit.
+
+    Args:
+        max_tensors (int, optional): The number of the tensors listed for
+            each peak. Default is 20.
+
+    Examples:
+
+        .. code-block:: python
+
+            import numpy as np
+            import paddle.fluid as fluid
+            import paddle.fluid.profiler as profiler
+
+            data = fluid.data(name='data', shape=[None, 64], dtype='float32')
+            out = fluid.layers.fc(data, 128)
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+            with profiler.memory_profiler():
+                exe.run(feed={'data': np.random.random([32, 64]).astype('float32')},
+                        fetch_list=[out])
+    """
+    start_memory_profiler()
+    try:
+        yield
+    finally:
+        print(stop_memory_profiler(max_tensors))
+
+
+def start_comm_stats():
+    """
+    Enable the metrics of the collective communication of the all reduce op
+    handles of the ParallelExecutor and the collective ops, i.e., the bytes,
+    the time waiting for the inputs, the transfer time and the bandwidths of
+    each bucket of variables, and the totals of each step.
+
+    Note:
+        The communication streams are synchronized before and after each
+        collective while the metrics are enabled, so the communication is
+        not overlapped with the computation.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_comm_stats()
+            # run the distributed program
+            report, stats = profiler.stop_comm_stats()
+            print(report)
+    """
+    core._enable_comm_stats()
+
+
+def stop_comm_stats():
+    """
+    Disable the metrics of the collective communication.
+
+    Returns:
+        tuple: The report, and a dict whose `buckets` and `steps` are the
+        lists of the metrics of each bucket and of the latest steps.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_comm_stats()
+            # run the distributed program
+            report, stats = profiler.stop_comm_stats()
+            print(report)
+    """
+    core._disable_comm_stats()
+    return core._comm_stats_report(), core._comm_stats()
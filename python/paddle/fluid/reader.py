@@ -1716,6 +1716,9 @@ class DatasetLoader(DataLoaderBase):
     def __iter__(self):
         self._dataset._finish_to_run()
         self._dataset._prepare_to_run()
+        if isinstance(self._dataset, InMemoryDataset) and \
+                self._dataset.spill_dir is not None:
+            self._dataset.dataset.start_spill_stream()
         self._iterable_dataset._start()
         return self
 
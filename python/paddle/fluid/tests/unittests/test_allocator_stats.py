@@ -0,0 +1,62 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle.fluid as fluid
+import unittest
+import numpy as np
+
+
+class TestAllocatorStats(unittest.TestCase):
+    def check_stats(self, place):
+        stats = fluid.core.get_allocator_stats(place)
+        if stats is None:
+            return
+        allocated_bytes = stats.allocated_bytes
+
+        t = fluid.LoDTensor()
+        t.set(np.ones([1024, 1024], dtype='float32'), place)
+        stats = fluid.core.get_allocator_stats(place)
+        self.assertGreaterEqual(stats.allocated_bytes,
+                                allocated_bytes + 1024 * 1024 * 4)
+        self.assertGreaterEqual(stats.peak_allocated_bytes,
+                                stats.allocated_bytes)
+        self.assertGreaterEqual(stats.reserved_bytes, stats.allocated_bytes)
+        self.assertGreater(sum(stats.alloc_counts), 0)
+        ratio = stats.fragmentation_ratio()
+        self.assertTrue(ratio >= 0.0 and ratio <= 1.0)
+
+    def check_release(self, place):
+        t = fluid.LoDTensor()
+        t.set(np.ones([1024, 1024], dtype='float32'), place)
+        del t
+        stats = fluid.core.get_allocator_stats(place)
+        released_bytes = fluid.core.release_memory(place)
+        self.assertGreaterEqual(released_bytes, 0)
+        if stats is not None:
+            new_stats = fluid.core.get_allocator_stats(place)
+            self.assertEqual(new_stats.reserved_bytes,
+                             stats.reserved_bytes - released_bytes)
+
+    def test_cpu(self):
+        self.check_stats(fluid.CPUPlace())
+        self.check_release(fluid.CPUPlace())
+
+    def test_gpu(self):
+        if fluid.is_compiled_with_cuda():
+            self.check_stats(fluid.CUDAPlace(0))
+            self.check_release(fluid.CUDAPlace(0))
+
+
+if __name__ == '__main__':
+    unittest.main()
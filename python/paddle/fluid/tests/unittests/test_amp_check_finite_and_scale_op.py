@@ -84,5 +84,55 @@ class TestAmpCheckFiniteAndScaleOpWithInf(OpTest):
         self.check_output(no_check_set=['Out'])
 
 
+class TestAmpCheckFiniteAndScaleOpMultiTensor(OpTest):
+    def setUp(self):
+        self.op_type = "amp_check_finite_and_scale"
+        self.init_dtype()
+        x0 = np.random.random((37, 5)).astype(self.dtype)
+        x1 = np.random.random((1)).astype(self.dtype)
+        x2 = np.random.random((64, 33)).astype(self.dtype)
+        scale = np.random.random((1)).astype(self.dtype)
+
+        self.inputs = {
+            'X': [('x0', x0), ('x1', x1), ('x2', x2)],
+            'Scale': scale
+        }
+        self.outputs = {
+            'FoundInfinite': np.array([0]),
+            'Out': [('out0', x0 * scale), ('out1', x1 * scale),
+                    ('out2', x2 * scale)],
+        }
+
+    def init_dtype(self):
+        self.dtype = np.float32
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestAmpCheckFiniteAndScaleOpMultiTensorWithInf(OpTest):
+    def setUp(self):
+        self.op_type = "amp_check_finite_and_scale"
+        self.init_dtype()
+        x0 = np.random.random((37, 5)).astype(self.dtype)
+        x1 = np.random.random((64, 33)).astype(self.dtype)
+        x1[63][32] = np.inf
+        scale = np.random.random((1)).astype(self.dtype)
+
+        self.inputs = {'X': [('x0', x0), ('x1', x1)], 'Scale': scale}
+        # all the outputs are zeroed, so that the step does not change the
+        # parameters
+        self.outputs = {
+            'FoundInfinite': np.array([1]),
+            'Out': [('out0', np.zeros_like(x0)), ('out1', np.zeros_like(x1))],
+        }
+
+    def init_dtype(self):
+        self.dtype = np.float32
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == '__main__':
     unittest.main()
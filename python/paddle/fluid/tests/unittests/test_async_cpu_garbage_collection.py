@@ -0,0 +1,64 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+
+class TestAsyncCPUGarbageCollection(unittest.TestCase):
+    def tearDown(self):
+        fluid.set_flags({'FLAGS_async_cpu_garbage_collection_mb': -1.0})
+
+    def train(self, async_gc_mb):
+        fluid.set_flags({
+            'FLAGS_eager_delete_tensor_gb': 0.0,
+            'FLAGS_async_cpu_garbage_collection_mb': async_gc_mb
+        })
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[-1, 16], dtype='float32')
+            hidden = fluid.layers.fc(x, size=32, act='relu')
+            hidden = fluid.layers.fc(hidden, size=32, act='relu')
+            loss = fluid.layers.reduce_mean(fluid.layers.fc(hidden, size=1))
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        np.random.seed(1)
+        losses = []
+        with fluid.scope_guard(fluid.Scope()):
+            exe.run(startup_program)
+            for _ in range(5):
+                x_np = np.random.random([8, 16]).astype('float32')
+                losses.extend(
+                    exe.run(main_program, feed={'x': x_np},
+                            fetch_list=[loss]))
+        return losses
+
+    def test_main(self):
+        expected = self.train(-1.0)
+        for async_gc_mb in [0.0, 1.0]:
+            losses = self.train(async_gc_mb)
+            self.assertEqual(len(losses), len(expected))
+            for loss, value in zip(losses, expected):
+                self.assertTrue(np.allclose(loss, value))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -98,6 +98,73 @@ class BeamSearchOpTester(unittest.TestCase):
         tensor.set_lod(self.lod)
 
 
+class BeamSearchLogitsOpTester(BeamSearchOpTester):
+    """unittest of beam_search_op with the logits as the scores"""
+
+    def test_run(self):
+        op = Operator(
+            'beam_search',
+            pre_ids='pre_ids',
+            pre_scores='pre_scores',
+            scores='scores',
+            selected_ids='selected_ids',
+            selected_scores='selected_scores',
+            parent_idx='parent_idx',
+            level=0,
+            beam_size=2,
+            end_id=0,
+            is_logits=True)
+        op.run(self.scope, core.CPUPlace())
+        selected_ids = self.scope.find_var("selected_ids").get_tensor()
+        selected_scores = self.scope.find_var("selected_scores").get_tensor()
+        parent_idx = self.scope.find_var("parent_idx").get_tensor()
+
+        logits = self.logits.astype('float64')
+        log_softmax = logits - np.log(
+            np.sum(np.exp(logits), axis=1, keepdims=True))
+        scores = self.pre_scores.reshape([-1, 1]) + log_softmax
+        expected_ids, expected_scores, expected_parents = [], [], []
+        for start, end in zip(self.lod[0][:-1], self.lod[0][1:]):
+            candidates = [(scores[i, j], i, j) for i in range(start, end)
+                          for j in range(scores.shape[1])]
+            top = sorted(candidates, key=lambda c: -c[0])[:2]
+            for _, i, j in sorted(top, key=lambda c: c[1]):
+                expected_ids.append(j)
+                expected_scores.append(scores[i, j])
+                expected_parents.append(i)
+        self.assertTrue(
+            np.array_equal(
+                np.array(selected_ids),
+                np.array(expected_ids)[:, np.newaxis]))
+        self.assertTrue(
+            np.allclose(
+                np.array(selected_scores),
+                np.array(expected_scores)[:, np.newaxis],
+                atol=1e-5))
+        self.assertTrue(
+            np.array_equal(np.array(parent_idx), np.array(expected_parents)))
+
+    def _create_pre_scores(self):
+        self.pre_scores = np.array(
+            [[-0.1], [-0.2], [-0.3], [-0.4]], dtype='float32')
+        tensor = create_tensor(self.scope, 'pre_scores', self.pre_scores)
+
+    def _create_ids(self):
+        self.lod = [[0, 2, 4], [0, 1, 2, 3, 4]]
+
+    def _create_scores(self):
+        self.logits = np.array(
+            [
+                [1.0, 3.0, 0.5, 2.0],
+                [2.5, 0.1, 0.2, 0.3],
+                [0.1, 0.2, 4.0, 0.3],
+                [1.5, 1.6, 0.2, 3.0],
+            ],
+            dtype='float32')
+        tensor = create_tensor(self.scope, "scores", self.logits)
+        tensor.set_lod(self.lod)
+
+
 class TestBeamSearchOpError(unittest.TestCase):
     def test_errors(self):
         with program_guard(Program(), Program()):
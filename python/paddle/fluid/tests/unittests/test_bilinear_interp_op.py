@@ -258,6 +258,19 @@ class TestBilinearInterpDataLayout(TestBilinearInterpOp):
         self.data_layout = "NHWC"
 
 
+class TestBilinearInterpDataLayoutUpsample(TestBilinearInterpOp):
+    def init_test_case(self):
+        self.interp_method = 'bilinear'
+        self.input_shape = [2, 5, 7, 4]
+        self.out_h = 10
+        self.out_w = 14
+        self.scale = 0.
+        self.out_size = None
+        self.align_corners = False
+        self.align_mode = 0
+        self.data_layout = "NHWC"
+
+
 class TestBilinearInterpOpUint8(OpTest):
     def setUp(self):
         self.out_size = None
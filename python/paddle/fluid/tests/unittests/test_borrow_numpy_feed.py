@@ -0,0 +1,62 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy as np
+import paddle.fluid as fluid
+
+
+class TestBorrowNumpyFeed(unittest.TestCase):
+    def setUp(self):
+        fluid.set_flags({'FLAGS_borrow_numpy_feed': True})
+
+    def tearDown(self):
+        fluid.set_flags({'FLAGS_borrow_numpy_feed': False})
+
+    def test_feed(self):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[None, 3], dtype='float32')
+            y = fluid.layers.scale(x, scale=2.0)
+            counter = fluid.data(name='counter', shape=[1], dtype='float32')
+            fluid.layers.increment(counter, value=1.0, in_place=True)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+        x_np = np.random.random([4, 3]).astype('float32')
+        counter_np = np.array([1.0]).astype('float32')
+        y_np, counter_out = exe.run(main_program,
+                                    feed={'x': x_np,
+                                          'counter': counter_np},
+                                    fetch_list=[y, counter])
+        self.assertTrue(np.allclose(y_np, x_np * 2.0))
+        self.assertTrue(np.allclose(counter_out, [2.0]))
+        # the op writing the feed in place does not modify the numpy array
+        self.assertTrue(np.allclose(counter_np, [1.0]))
+
+        # the arrays which are not C-contiguous are copied
+        x_t = np.random.random([3, 4]).astype('float32').T
+        y_np, = exe.run(main_program,
+                        feed={'x': x_t,
+                              'counter': counter_np},
+                        fetch_list=[y])
+        self.assertTrue(np.allclose(y_np, x_t * 2.0))
+
+
+if __name__ == '__main__':
+    unittest.main()
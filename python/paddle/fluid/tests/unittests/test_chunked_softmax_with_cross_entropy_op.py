@@ -0,0 +1,117 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+from op_test import OpTest
+
+
+def chunked_cross_entropy(logits, labels, ignore_index):
+    num_classes = logits.shape[-1]
+    num_labels = labels.shape[-1]
+    logits_2d = logits.reshape((-1, num_classes))
+    labels_2d = labels.reshape((-1, num_labels))
+    max_val = logits_2d.max(axis=1, keepdims=True)
+    lse = max_val + np.log(
+        np.exp(logits_2d - max_val).sum(axis=1, keepdims=True))
+    loss = np.zeros_like(lse)
+    for i in range(labels_2d.shape[0]):
+        for lbl in labels_2d[i]:
+            if lbl != ignore_index:
+                loss[i, 0] += lse[i, 0] - logits_2d[i, lbl]
+    loss /= num_labels
+    out_shape = list(logits.shape[:-1]) + [1]
+    return loss.reshape(out_shape), lse.reshape(out_shape)
+
+
+class TestChunkedSoftmaxWithCrossEntropyOp(OpTest):
+    def initParams(self):
+        self.shape = [41, 37]
+        self.num_labels = 1
+        self.chunk_size = 4096
+        self.ignore_index = -100
+
+    def setUp(self):
+        self.op_type = "chunked_softmax_with_cross_entropy"
+        self.dtype = np.float64
+        self.initParams()
+
+        logits = np.random.uniform(-5.0, 5.0, self.shape).astype(self.dtype)
+        label_shape = self.shape[:-1] + [self.num_labels]
+        labels = np.random.randint(
+            0, self.shape[-1], label_shape, dtype="int64")
+        loss, lse = chunked_cross_entropy(logits, labels, self.ignore_index)
+
+        self.inputs = {"Logits": logits, "Label": labels}
+        self.outputs = {
+            "Loss": loss.astype(self.dtype),
+            "LogSumExp": lse.astype(self.dtype)
+        }
+        self.attrs = {
+            "ignore_index": self.ignore_index,
+            "chunk_size": self.chunk_size
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(["Logits"], "Loss", max_relative_error=0.05)
+
+
+class TestChunkedSoftmaxWithCrossEntropyOpChunks(
+        TestChunkedSoftmaxWithCrossEntropyOp):
+    def initParams(self):
+        self.shape = [3, 5, 1031]
+        self.num_labels = 1
+        self.chunk_size = 100
+        self.ignore_index = -100
+
+
+class TestChunkedSoftmaxWithCrossEntropyOpMultiLabels(
+        TestChunkedSoftmaxWithCrossEntropyOp):
+    def initParams(self):
+        self.shape = [17, 53]
+        self.num_labels = 3
+        self.chunk_size = 8
+        self.ignore_index = 5
+
+
+class TestChunkedSoftmaxWithCrossEntropyLayer(unittest.TestCase):
+    def test_same_as_softmax_with_cross_entropy(self):
+        np.random.seed(1)
+        logits_np = np.random.uniform(-3., 3., [8, 2000]).astype("float32")
+        label_np = np.random.randint(0, 2000, [8, 1]).astype("int64")
+        main, startup = fluid.Program(), fluid.Program()
+        with fluid.program_guard(main, startup):
+            logits = fluid.data(name='logits', shape=[8, 2000], dtype='float32')
+            label = fluid.data(name='label', shape=[8, 1], dtype='int64')
+            chunked = fluid.layers.chunked_softmax_with_cross_entropy(
+                logits, label, chunk_size=300)
+            expected = fluid.layers.softmax_with_cross_entropy(logits, label)
+        exe = fluid.Executor(fluid.CPUPlace())
+        chunked_np, expected_np = exe.run(
+            main,
+            feed={'logits': logits_np,
+                  'label': label_np},
+            fetch_list=[chunked, expected])
+        self.assertTrue(np.allclose(chunked_np, expected_np, atol=1e-5))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,63 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestClipByGlobalNormOp(OpTest):
+    def setUp(self):
+        self.op_type = "clip_by_global_norm"
+        self.dtype = np.float32
+        self.max_global_norm = 1.0
+        self.init_config()
+        # The tensors are smaller and larger than one chunk.
+        shapes = [(10, 20), (1, ), (102, 105), (3, 4, 5)]
+        xs = [
+            np.random.uniform(-1, 1, shape).astype(self.dtype)
+            for shape in shapes
+        ]
+        global_norm = np.sqrt(sum([np.sum(np.square(x)) for x in xs]))
+        scale = self.max_global_norm / max(global_norm, self.max_global_norm)
+
+        self.inputs = {'X': [('x' + str(i), x) for i, x in enumerate(xs)]}
+        self.attrs = {'max_global_norm': self.max_global_norm}
+        self.outputs = {
+            'Out': [('out' + str(i), x * scale) for i, x in enumerate(xs)],
+            'GlobalNorm': np.array([global_norm]).astype(self.dtype)
+        }
+
+    def init_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestClipByGlobalNormOpNoClip(TestClipByGlobalNormOp):
+    def init_config(self):
+        self.max_global_norm = 1000.0
+
+
+class TestClipByGlobalNormOpFP64(TestClipByGlobalNormOp):
+    def init_config(self):
+        self.dtype = np.float64
+        self.max_global_norm = 5.0
+
+
+if __name__ == "__main__":
+    unittest.main()
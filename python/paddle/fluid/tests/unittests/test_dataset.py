@@ -257,6 +257,245 @@ class TestDataset(unittest.TestCase):
         os.remove("./test_in_memory_dataset_run_a.txt")
         os.remove("./test_in_memory_dataset_run_b.txt")
 
+    def test_in_memory_dataset_binary(self):
+        """
+        Testcase for converting InMemoryDataset into the binary format.
+        """
+        with open("test_in_memory_dataset_binary_a.txt", "w") as f:
+            data = "1 a 1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 b 1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 c 1 3 2 3 5 4 7 7 7 7 1 3\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        def load_data(feed_type, filelist, output_dir=None):
+            dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+            dataset.set_batch_size(2)
+            dataset.set_thread(1)
+            dataset.set_parse_ins_id(True)
+            dataset.set_pipe_command("cat")
+            dataset.set_use_var(slots_vars)
+            dataset.set_filelist(filelist)
+            if output_dir is not None:
+                dataset.convert_to_binary(output_dir)
+            dataset.set_feed_type(feed_type)
+            dataset.load_into_memory()
+            data_loader = fluid.io.DataLoader.from_dataset(
+                dataset, fluid.cpu_places(1), drop_last=False)
+            batches = []
+            for data in data_loader():
+                batches.append(
+                    [np.array(data[0][slot]).tolist() for slot in slots])
+            return dataset.get_memory_data_size(), batches
+
+        text_size, text_batches = load_data(
+            "MultiSlotInMemoryDataFeed", ["test_in_memory_dataset_binary_a.txt"],
+            "test_in_memory_dataset_binary")
+        binary_size, binary_batches = load_data(
+            "MultiSlotBinaryInMemoryDataFeed",
+            ["test_in_memory_dataset_binary/test_in_memory_dataset_binary_a.txt"])
+        self.assertEqual(text_size, 3)
+        self.assertEqual(text_size, binary_size)
+        self.assertEqual(text_batches, binary_batches)
+
+        os.remove("./test_in_memory_dataset_binary_a.txt")
+        os.remove(
+            "./test_in_memory_dataset_binary/test_in_memory_dataset_binary_a.txt")
+        os.rmdir("./test_in_memory_dataset_binary")
+
+    def test_in_memory_dataset_zero_copy_feed(self):
+        """
+        Testcase for InMemoryDataset with zero copy feed.
+        """
+        with open("test_in_memory_dataset_zero_copy_feed_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 0.5\n"
+            data += "1 0 2 0 0 4 6 6 6 6 1 0\n"
+            data += "1 3 2 3 5 4 7 0 7 7 2 1.5 2.5\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots[:3]:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+        slots_vars.append(
+            fluid.layers.data(
+                name=slots[3], shape=[1], dtype="float32", lod_level=1))
+
+        def load_data(zero_copy_feed):
+            dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+            dataset.set_batch_size(2)
+            dataset.set_thread(1)
+            dataset.set_pipe_command("cat")
+            dataset.set_use_var(slots_vars)
+            dataset.set_filelist(
+                ["test_in_memory_dataset_zero_copy_feed_a.txt"])
+            dataset.set_zero_copy_feed(zero_copy_feed)
+            dataset.load_into_memory()
+            data_loader = fluid.io.DataLoader.from_dataset(
+                dataset, fluid.cpu_places(1), drop_last=False)
+            batches = []
+            for data in data_loader():
+                batches.append([(np.array(data[0][slot]).tolist(),
+                                 data[0][slot].recursive_sequence_lengths())
+                                for slot in slots])
+            return batches
+
+        self.assertEqual(load_data(False), load_data(True))
+
+        os.remove("./test_in_memory_dataset_zero_copy_feed_a.txt")
+
+    def test_in_memory_dataset_length_bucketing(self):
+        """
+        Testcase for InMemoryDataset with length bucketing.
+        """
+        with open("test_in_memory_dataset_length_bucketing_a.txt", "w") as f:
+            data = ""
+            for i in range(16):
+                length = (i * 7) % 16 + 1
+                data += "1 %d %d %s\n" % (i + 1, length, " ".join(
+                    [str(i + 1)] * length))
+            f.write(data)
+
+        slots = ["slot1", "slot2"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        def load_data(seed):
+            dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+            dataset.set_batch_size(4)
+            dataset.set_thread(1)
+            dataset.set_pipe_command("cat")
+            dataset.set_use_var(slots_vars)
+            dataset.set_filelist(
+                ["test_in_memory_dataset_length_bucketing_a.txt"])
+            dataset.set_length_bucketing("slot2", 8, seed)
+            dataset.load_into_memory()
+            data_loader = fluid.io.DataLoader.from_dataset(
+                dataset, fluid.cpu_places(1), drop_last=False)
+            batches = []
+            for data in data_loader():
+                batches.append(
+                    tuple(data[0]["slot2"].recursive_sequence_lengths()[0]))
+            return batches
+
+        batches = load_data(1)
+        self.assertEqual(len(batches), 4)
+        for lengths in batches:
+            # each window of 8 records is split into two batches, of the
+            # shorter and the longer ones
+            self.assertEqual(list(lengths), sorted(lengths))
+            self.assertLess(max(lengths) - min(lengths), 12)
+        self.assertEqual(batches, load_data(1))
+
+        os.remove("./test_in_memory_dataset_length_bucketing_a.txt")
+
+    def test_in_memory_dataset_spill(self):
+        """
+        Testcase for InMemoryDataset with the spill mode.
+        """
+        with open("test_in_memory_dataset_spill_a.txt", "w") as f:
+            data = ""
+            for i in range(1, 201):
+                data += "1 %d 2 %d %d 1 %d\n" % (i, i, i + 1, i % 7 + 1)
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        def load_data(spill):
+            dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+            dataset.set_batch_size(1)
+            dataset.set_thread(2)
+            dataset.set_pipe_command("cat")
+            dataset.set_use_var(slots_vars)
+            dataset.set_filelist(["test_in_memory_dataset_spill_a.txt"])
+            if spill:
+                dataset.set_spill(
+                    "./test_in_memory_dataset_spill",
+                    memory_budget_mb=1,
+                    bucket_num=4)
+            dataset.load_into_memory()
+            self.assertEqual(dataset.get_memory_data_size(), 200)
+            data_loader = fluid.io.DataLoader.from_dataset(
+                dataset, fluid.cpu_places(1), drop_last=False)
+            passes = []
+            for epoch in range(2):
+                records = []
+                for data in data_loader():
+                    records.append(
+                        tuple(
+                            tuple(np.array(data[0][slot]).flatten().tolist())
+                            for slot in slots))
+                passes.append(records)
+            dataset.release_memory()
+            return passes
+
+        expected = load_data(False)
+        spilled = load_data(True)
+        self.assertEqual(len(spilled[0]), 200)
+        for records in spilled:
+            self.assertEqual(sorted(records), sorted(expected[0]))
+
+        os.remove("./test_in_memory_dataset_spill_a.txt")
+        os.rmdir("./test_in_memory_dataset_spill")
+
+    def test_in_memory_dataset_read_ahead(self):
+        """
+        Testcase for InMemoryDataset with the read-ahead of files.
+        """
+        filelist = []
+        for i in range(4):
+            filename = "test_in_memory_dataset_read_ahead_%d.txt" % i
+            with open(filename, "w") as f:
+                f.write("1 %d 1 %d 1 %d\n" % (i, i + 1, i + 2))
+            if i % 2 == 0:
+                os.system("gzip -f " + filename)
+                filename += ".gz"
+            filelist.append(filename)
+
+        slots = ["slot1", "slot2", "slot3"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+        dataset.set_batch_size(1)
+        dataset.set_thread(2)
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.set_filelist(filelist)
+        dataset.set_read_ahead(2, "./test_in_memory_dataset_read_ahead")
+        dataset.load_into_memory()
+        self.assertEqual(dataset.get_memory_data_size(), 4)
+        stat = dataset.get_pipeline_stat()
+        self.assertEqual(stat["read"]["records"], 4)
+        self.assertGreater(stat["read"]["bytes"], 0)
+        self.assertEqual(stat["input_channel"]["size"], 4)
+        dataset.reset_pipeline_stat()
+        self.assertEqual(dataset.get_pipeline_stat()["read"]["records"], 0)
+        dataset.release_memory()
+
+        for filename in filelist:
+            os.remove(filename)
+        os.rmdir("./test_in_memory_dataset_read_ahead")
+
     def test_in_memory_dataset_masterpatch(self):
         """
         Testcase for InMemoryDataset from create to run.
@@ -394,6 +633,7 @@ class TestDataset(unittest.TestCase):
         Testcase for InMemoryDataset from create to run.
         Use CUDAPlace
         Use float type id
+        Use sharded channels
         """
         with open("test_in_memory_dataset_run_a.txt", "w") as f:
             data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
@@ -423,6 +663,7 @@ class TestDataset(unittest.TestCase):
         ])
         dataset.set_pipe_command("cat")
         dataset.set_use_var(slots_vars)
+        dataset.set_channel_shard_num(4)
         dataset.load_into_memory()
         dataset.local_shuffle()
 
@@ -940,6 +1181,8 @@ class TestDataset2(unittest.TestCase):
             dataset.set_pipe_command("cat")
             dataset.set_use_var(slots_vars)
             dataset.load_into_memory()
+            dataset.set_fleet_send_window_size(8)
+            dataset.set_compress_shuffle_msg(True)
             try:
                 dataset.global_shuffle(fleet)
             except:
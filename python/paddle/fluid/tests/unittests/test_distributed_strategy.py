@@ -122,6 +122,11 @@ class TestStrategyFactor(unittest.TestCase):
                       trainer_communicator_flags)
         self.assertEqual(
             trainer_communicator_flags['communicator_send_queue_size'], '20')
+        self.assertEqual(
+            trainer_communicator_flags['communicator_merge_thread_num'], '0')
+        self.assertEqual(
+            trainer_communicator_flags['communicator_batch_var_max_bytes'],
+            '0')
 
         # test set_trainer_runtime_config exception
         trainer_runtime_config_dict['unknown'] = None
@@ -0,0 +1,67 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+os.environ['CPU_NUM'] = str(2)
+
+
+class TestDropScopeInBackground(unittest.TestCase):
+    def train(self, drop_scope_in_background):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[-1, 16], dtype='float32')
+            hidden = fluid.layers.fc(x, size=32, act='relu')
+            hidden = fluid.layers.dropout(hidden, dropout_prob=0.0)
+            loss = fluid.layers.reduce_mean(fluid.layers.fc(hidden, size=1))
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+        exec_strategy = fluid.ExecutionStrategy()
+        exec_strategy.num_iteration_per_drop_scope = 2
+        exec_strategy.drop_scope_in_background = drop_scope_in_background
+        self.assertEqual(exec_strategy.drop_scope_in_background,
+                         drop_scope_in_background)
+        compiled_program = fluid.CompiledProgram(
+            main_program).with_data_parallel(
+                loss_name=loss.name, exec_strategy=exec_strategy)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        np.random.seed(1)
+        losses = []
+        with fluid.scope_guard(fluid.Scope()):
+            exe.run(startup_program)
+            for _ in range(7):
+                x_np = np.random.random([8, 16]).astype('float32')
+                loss_np, = exe.run(compiled_program,
+                                   feed={'x': x_np},
+                                   fetch_list=[loss])
+                losses.append(np.mean(loss_np))
+            compiled_program._executor.drop_local_exe_scopes()
+        return losses
+
+    def test_main(self):
+        expected = self.train(False)
+        losses = self.train(True)
+        self.assertTrue(np.allclose(losses, expected))
+
+
+if __name__ == '__main__':
+    unittest.main()
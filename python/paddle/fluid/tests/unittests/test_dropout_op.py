@@ -214,6 +214,72 @@ class TestFP16DropoutOp2(TestFP16DropoutOp):
         self.fix_seed = False
 
 
+class TestDropoutOpRecomputeMask(TestDropoutOp):
+    def setUp(self):
+        self.op_type = "dropout"
+        self.inputs = {'X': np.random.random((32, 64)).astype("float32")}
+        self.attrs = {
+            'dropout_prob': 0.0,
+            'fix_seed': True,
+            'seed': 7,
+            'is_test': False,
+            'recompute_mask': True
+        }
+        self.outputs = {
+            'Out': self.inputs['X'],
+            'SeedOut': np.array([7]).astype('int32')
+        }
+
+
+class TestDropoutRecomputeMaskGrad(unittest.TestCase):
+    def run_dropout(self, place, dropout_prob):
+        main = fluid.Program()
+        with fluid.program_guard(main, fluid.Program()):
+            x = fluid.data(name='x', shape=[64, 128], dtype='float32')
+            x.stop_gradient = False
+            block = main.global_block()
+            out = block.create_var(name='out', dtype='float32')
+            mask = block.create_var(name='mask', dtype='uint8')
+            seed_out = block.create_var(name='seed_out', dtype='int32')
+            block.append_op(
+                type='dropout',
+                inputs={'X': [x]},
+                outputs={'Out': [out],
+                         'Mask': [mask],
+                         'SeedOut': [seed_out]},
+                attrs={
+                    'dropout_prob': dropout_prob,
+                    'is_test': False,
+                    'recompute_mask': True,
+                    'dropout_implementation': 'upscale_in_train'
+                })
+            loss = fluid.layers.reduce_sum(out)
+            fluid.backward.append_backward(loss)
+        x_np = np.random.uniform(0.5, 1, (64, 128)).astype('float32')
+        exe = fluid.Executor(place)
+        return exe.run(main,
+                       feed={'x': x_np},
+                       fetch_list=[out, x.name + '@GRAD']) + [x_np]
+
+    def check_place(self, place):
+        dropout_prob = 0.3
+        out, x_grad, x = self.run_dropout(place, dropout_prob)
+        keep = out != 0
+        ratio = 1.0 - np.mean(keep)
+        self.assertTrue(abs(ratio - dropout_prob) < 0.05)
+        scale = 1.0 / (1.0 - dropout_prob)
+        # the backward regenerates the same mask as the forward
+        self.assertTrue(np.allclose(out, x * keep * scale))
+        self.assertTrue(np.allclose(x_grad, keep * scale))
+
+    def test_cpu(self):
+        self.check_place(fluid.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.check_place(fluid.CUDAPlace(0))
+
+
 class TestDropoutOpError(unittest.TestCase):
     def test_errors(self):
         with program_guard(Program(), Program()):
@@ -164,5 +164,65 @@ class TestElementwiseSubOp_xsize_lessthan_ysize(TestElementwiseOp):
         }
 
 
+# The float32 sub runs the jit kernels on the CPU.
+class TestElementwiseSubFP32Op(OpTest):
+    def setUp(self):
+        self.op_type = "elementwise_sub"
+        self.init_input_output()
+
+    def init_input_output(self):
+        # not a multiple of the block size of the same dims
+        self.inputs = {
+            'X': np.random.rand(3, 4099).astype(np.float32),
+            'Y': np.random.rand(3, 4099).astype(np.float32)
+        }
+        self.outputs = {'Out': self.inputs['X'] - self.inputs['Y']}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestElementwiseSubFP32Op_rowwise(TestElementwiseSubFP32Op):
+    def init_input_output(self):
+        self.inputs = {
+            'X': np.random.rand(70, 33).astype(np.float32),
+            'Y': np.random.rand(33).astype(np.float32)
+        }
+        self.outputs = {'Out': self.inputs['X'] - self.inputs['Y']}
+
+
+class TestElementwiseSubFP32Op_midwise(TestElementwiseSubFP32Op):
+    def init_input_output(self):
+        self.inputs = {
+            'X': np.random.rand(2, 5, 7, 9).astype(np.float32),
+            'Y': np.random.rand(5).astype(np.float32)
+        }
+        self.attrs = {'axis': 1}
+        self.outputs = {
+            'Out': self.inputs['X'] - self.inputs['Y'].reshape(1, 5, 1, 1)
+        }
+
+
+class TestElementwiseSubFP32Op_inverse_rowwise(TestElementwiseSubFP32Op):
+    def init_input_output(self):
+        self.inputs = {
+            'X': np.random.rand(33).astype(np.float32),
+            'Y': np.random.rand(70, 33).astype(np.float32)
+        }
+        self.outputs = {'Out': self.inputs['X'] - self.inputs['Y']}
+
+
+class TestElementwiseSubFP32Op_inverse_midwise(TestElementwiseSubFP32Op):
+    def init_input_output(self):
+        self.inputs = {
+            'X': np.random.rand(5).astype(np.float32),
+            'Y': np.random.rand(2, 5, 7, 9).astype(np.float32)
+        }
+        self.attrs = {'axis': 1}
+        self.outputs = {
+            'Out': self.inputs['X'].reshape(1, 5, 1, 1) - self.inputs['Y']
+        }
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,74 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+
+class TestExecutorParallelOps(unittest.TestCase):
+    def build_program(self):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[-1, 32], dtype='float32')
+            label = fluid.data(name='label', shape=[-1, 1], dtype='int64')
+            # Several independent towers, which can run in parallel.
+            towers = []
+            for _ in range(4):
+                hidden = fluid.layers.fc(x, size=64, act='relu')
+                towers.append(fluid.layers.fc(hidden, size=16, act='relu'))
+            concat = fluid.layers.concat(towers, axis=1)
+            prediction = fluid.layers.fc(concat, size=10, act='softmax')
+            loss = fluid.layers.mean(
+                fluid.layers.cross_entropy(
+                    input=prediction, label=label))
+            fluid.optimizer.SGD(learning_rate=0.1).minimize(loss)
+        return main_program, startup_program, loss
+
+    def run_program(self, num_threads):
+        fluid.set_flags({'FLAGS_executor_num_threads': num_threads})
+        main_program, startup_program, loss = self.build_program()
+        exe = fluid.Executor(fluid.CPUPlace())
+        scope = fluid.Scope()
+        np.random.seed(0)
+        losses = []
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            for _ in range(5):
+                feed = {
+                    'x': np.random.random([8, 32]).astype('float32'),
+                    'label': np.random.randint(
+                        0, 10, size=[8, 1]).astype('int64')
+                }
+                loss_value, = exe.run(main_program,
+                                      feed=feed,
+                                      fetch_list=[loss])
+                losses.append(loss_value)
+        fluid.set_flags({'FLAGS_executor_num_threads': 1})
+        return losses
+
+    def test_parallel_ops(self):
+        serial_losses = self.run_program(1)
+        parallel_losses = self.run_program(4)
+        for serial_loss, parallel_loss in zip(serial_losses, parallel_losses):
+            self.assertTrue(np.allclose(serial_loss, parallel_loss))
+
+
+if __name__ == '__main__':
+    unittest.main()
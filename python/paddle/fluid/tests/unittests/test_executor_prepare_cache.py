@@ -0,0 +1,73 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+
+class TestExecutorPrepareCache(unittest.TestCase):
+    def tearDown(self):
+        fluid.set_flags({'FLAGS_executor_prepare_cache_capacity': 8})
+
+    def run_programs(self, capacity):
+        fluid.set_flags({'FLAGS_executor_prepare_cache_capacity': capacity})
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[-1, 4], dtype='float32')
+            y = fluid.layers.scale(x, scale=2.0)
+            z = fluid.layers.elementwise_add(x, y)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        x_np = np.random.random([3, 4]).astype('float32')
+        results = []
+        with fluid.scope_guard(fluid.Scope()):
+            exe.run(startup_program)
+            # Run the same program repeatedly with different fetch targets.
+            for _ in range(3):
+                results.extend(
+                    exe.run(main_program, feed={'x': x_np}, fetch_list=[y]))
+                results.extend(
+                    exe.run(main_program,
+                            feed={'x': x_np},
+                            fetch_list=[y, z]))
+            # The context prepared before must not be reused after the program
+            # is changed.
+            with fluid.program_guard(main_program, startup_program):
+                w = fluid.layers.scale(z, scale=3.0)
+            for _ in range(2):
+                results.extend(
+                    exe.run(main_program, feed={'x': x_np}, fetch_list=[w]))
+
+        expected = [x_np * 2] + [x_np * 2, x_np * 3]
+        expected = expected * 3 + [x_np * 9] * 2
+        self.assertEqual(len(results), len(expected))
+        for result, value in zip(results, expected):
+            self.assertTrue(np.allclose(result, value))
+
+    def test_with_cache(self):
+        self.run_programs(8)
+
+    def test_small_cache(self):
+        self.run_programs(1)
+
+    def test_without_cache(self):
+        self.run_programs(0)
+
+
+if __name__ == '__main__':
+    unittest.main()
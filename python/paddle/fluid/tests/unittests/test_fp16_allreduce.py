@@ -0,0 +1,75 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestFP16AllReduce(unittest.TestCase):
+    def train(self, fp16_allreduce, error_feedback, fuse_all_reduce_ops):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[-1, 16], dtype='float32')
+            hidden = fluid.layers.fc(x, size=32, act='relu')
+            hidden = fluid.layers.fc(hidden, size=32, act='relu')
+            loss = fluid.layers.reduce_mean(fluid.layers.fc(hidden, size=1))
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+        build_strategy = fluid.BuildStrategy()
+        build_strategy.fuse_all_reduce_ops = fuse_all_reduce_ops
+        build_strategy.fp16_allreduce = fp16_allreduce
+        build_strategy.fp16_allreduce_error_feedback = error_feedback
+        self.assertEqual(build_strategy.fp16_allreduce, fp16_allreduce)
+        self.assertEqual(build_strategy.fp16_allreduce_error_feedback,
+                         error_feedback)
+        compiled_program = fluid.CompiledProgram(
+            main_program).with_data_parallel(
+                loss_name=loss.name, build_strategy=build_strategy)
+
+        exe = fluid.Executor(fluid.CUDAPlace(0))
+        np.random.seed(1)
+        losses = []
+        with fluid.scope_guard(fluid.Scope()):
+            exe.run(startup_program)
+            for _ in range(5):
+                x_np = np.random.random([8, 16]).astype('float32')
+                loss_np, = exe.run(compiled_program,
+                                   feed={'x': x_np},
+                                   fetch_list=[loss])
+                losses.append(np.mean(loss_np))
+        return losses
+
+    def check(self, fuse_all_reduce_ops):
+        if not core.is_compiled_with_cuda():
+            return
+        expected = self.train(False, False, fuse_all_reduce_ops)
+        for error_feedback in [False, True]:
+            losses = self.train(True, error_feedback, fuse_all_reduce_ops)
+            self.assertTrue(np.allclose(losses, expected, rtol=1e-2))
+
+    def test_fp16_allreduce(self):
+        self.check(fuse_all_reduce_ops=False)
+
+    def test_fused_fp16_allreduce(self):
+        self.check(fuse_all_reduce_ops=True)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -99,6 +99,17 @@ class TestFuseAllReduceOpsAndOptiOps(TestFuseAllReduceOps):
             fuse_all_optimizer_ops=True)
 
 
+class TestFuseAllReduceOpsInReadyOrder(TestFuseAllReduceOps):
+    @classmethod
+    def setUpClass(cls):
+        os.environ['CPU_NUM'] = str(4)
+        fluid.set_flags({'FLAGS_fuse_grad_in_ready_order': True})
+
+    @classmethod
+    def tearDownClass(cls):
+        fluid.set_flags({'FLAGS_fuse_grad_in_ready_order': False})
+
+
 class TestFuseAllReduceOpsWithSparseGrad(TestFuseAllReduceOpsBase):
     @classmethod
     def setUpClass(cls):
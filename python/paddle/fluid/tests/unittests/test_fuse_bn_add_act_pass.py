@@ -0,0 +1,94 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import paddle
+import paddle.fluid as fluid
+import unittest
+
+
+@unittest.skipIf(not fluid.core.is_compiled_with_cuda(),
+                 "Paddle core is not compiled with CUDA")
+class TestFuseBatchNormAddActPass(unittest.TestCase):
+    def conv_bn(self, x, num_filters, act):
+        conv = fluid.layers.conv2d(
+            input=x,
+            filter_size=3,
+            num_filters=num_filters,
+            stride=1,
+            padding=1,
+            act=None,
+            bias_attr=False,
+            data_format='NHWC')
+        return fluid.layers.batch_norm(
+            input=conv, act=act, data_layout='NHWC')
+
+    def build_program(self, main_program, startup_program, seed=1):
+        main_program.random_seed = seed
+        startup_program.random_seed = seed
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[28, 28, 1], dtype='float32')
+            y = fluid.layers.data(name="y", shape=[1], dtype='int64')
+            shortcut = self.conv_bn(x, 16, 'relu')
+            hidden = self.conv_bn(shortcut, 16, 'relu')
+            hidden = self.conv_bn(hidden, 16, None)
+            # the end of a residual block, act(bn(x) + z)
+            out = fluid.layers.elementwise_add(x=shortcut, y=hidden, act='relu')
+            prediction = fluid.layers.fc(input=out, size=10, act='softmax')
+            loss = fluid.layers.cross_entropy(input=prediction, label=y)
+            loss = fluid.layers.mean(loss)
+            sgd = fluid.optimizer.SGD(learning_rate=0.001)
+            sgd = fluid.contrib.mixed_precision.decorate(
+                sgd, use_dynamic_loss_scaling=True, init_loss_scaling=128.0)
+            sgd.minimize(loss)
+        return x, y, loss
+
+    def train(self, main_program, startup_program, x, y, loss, fuse):
+        place = fluid.CUDAPlace(0)
+        exe = fluid.Executor(place)
+        feeder = fluid.DataFeeder(feed_list=[x, y], place=place)
+        build_strategy = fluid.BuildStrategy()
+        build_strategy.fuse_bn_add_act_ops = fuse
+        binary = fluid.CompiledProgram(main_program).with_data_parallel(
+            loss_name=loss.name, build_strategy=build_strategy)
+        train_reader = paddle.batch(paddle.dataset.mnist.train(), batch_size=16)
+        loss_vals = []
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            for _ in range(self.iters):
+                data = next(train_reader())
+                img = [(d[0].reshape([28, 28, 1]), d[1]) for d in data]
+                loss_v = exe.run(binary,
+                                 feed=feeder.feed(img),
+                                 fetch_list=[loss])
+                loss_vals.append(loss_v[0][0])
+        return loss_vals
+
+    def test_fuse_bn_add_act_pass(self):
+        self.iters = 10
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        x, y, loss = self.build_program(main_program, startup_program)
+        loss_vals = self.train(main_program, startup_program, x, y, loss,
+                               False)
+        loss_vals_fused = self.train(main_program, startup_program, x, y, loss,
+                                     True)
+        for i in range(self.iters):
+            self.assertAlmostEqual(loss_vals[i], loss_vals_fused[i], delta=1e-3)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -90,6 +90,32 @@ class TestFuseMomentumOps(TestFuseAdamOps):
             learning_rate=learning_rate, momentum=0.1)
 
 
+class TestFuseAdagradOps(TestFuseAdamOps):
+    def optimizer(self, learning_rate=1e-3):
+        return fluid.optimizer.Adagrad(learning_rate=learning_rate)
+
+
+class TestFuseRMSPropOps(TestFuseAdamOps):
+    def optimizer(self, learning_rate=1e-3):
+        return fluid.optimizer.RMSProp(
+            learning_rate=learning_rate, momentum=0.1, centered=True)
+
+
+class TestFuseLambOps(TestFuseAdamOps):
+    def optimizer(self, learning_rate=1e-3):
+        # the biases are not decayed, the fused op applies the weight decay
+        # of each parameter
+        return fluid.optimizer.Lamb(
+            learning_rate=learning_rate,
+            exclude_from_weight_decay_fn=lambda p: '.b_' in p.name)
+
+
+class TestFuseLarsMomentumOps(TestFuseAdamOps):
+    def optimizer(self, learning_rate=1e-3):
+        return fluid.optimizer.LarsMomentum(
+            learning_rate=learning_rate, momentum=0.1)
+
+
 class TestSpareFuseAdamOps(TestFuseOptimizationOps):
     @classmethod
     def setUpClass(cls):
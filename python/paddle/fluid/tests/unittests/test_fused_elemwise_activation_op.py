@@ -305,6 +305,27 @@ def mul_scale_func(x, y, x_bcast, y_bcast, scale, mode=0):
         return y, x, x * scale, y_bcast * (x_bcast * scale)
 
 
+def mul_relu_func(x, y, x_bcast, y_bcast, mode=0):
+    # Avoid the numeric gradient of relu near 0, see add_relu_func.
+    if mode == 0:
+        y[np.abs(y) < 0.005] = 0.02
+        y_bcast[np.abs(y_bcast) < 0.005] = 0.02
+        return x, y, np.maximum(y, 0), x_bcast * np.maximum(y_bcast, 0)
+    else:
+        x[np.abs(x) < 0.005] = 0.02
+        x_bcast[np.abs(x_bcast) < 0.005] = 0.02
+        return y, x, np.maximum(x, 0), y_bcast * np.maximum(x_bcast, 0)
+
+
+def sigmoid_mul_func(x, y, x_bcast, y_bcast, mode=0):
+    intermediate_out = x_bcast * y_bcast
+    out = 1.0 / (1.0 + np.exp(-intermediate_out))
+    if mode == 0:
+        return x, y, intermediate_out, out
+    else:
+        return y, x, intermediate_out, out
+
+
 scale = 0.1
 scale_add_func = partial(scale_add_func, scale=scale)
 add_scale_func = partial(add_scale_func, scale=scale)
@@ -316,6 +337,8 @@ for mode in {0, 1}:
     mul_scale_func = partial(mul_scale_func, mode=mode)
     relu_add_func = partial(relu_add_func, mode=mode)
     add_relu_func = partial(add_relu_func, mode=mode)
+    mul_relu_func = partial(mul_relu_func, mode=mode)
+    sigmoid_mul_func = partial(sigmoid_mul_func, mode=mode)
 
     for save_intermediate_out in {True, False}:
         suffix = ("_save_intermediate_out" if save_intermediate_out else "") \
@@ -343,6 +366,14 @@ for mode in {0, 1}:
             'functor_list': ["elementwise_mul", "scale"],
             'save_intermediate_out': save_intermediate_out,
         })
+        create_test_class('mul_relu' + suffix, mul_relu_func, {
+            'functor_list': ["elementwise_mul", "relu"],
+            'save_intermediate_out': save_intermediate_out,
+        })
+        create_test_class('sigmoid_mul' + suffix, sigmoid_mul_func, {
+            'functor_list': ["sigmoid", "elementwise_mul"],
+            'save_intermediate_out': save_intermediate_out,
+        })
         if core.is_compiled_with_cuda():
             create_test_class(
                 'scale_add_fp16' + suffix,
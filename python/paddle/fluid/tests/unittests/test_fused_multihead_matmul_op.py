@@ -32,8 +32,6 @@ def stable_softmax(x):
     return exps / np.sum(exps)
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "Paddle core is not compiled with CUDA")
 class TestFusedMultiheadMatmulOp(OpTest):
     def config(self):
         self.seq_len = 128
@@ -108,8 +106,9 @@ class TestFusedMultiheadMatmulOp(OpTest):
         self.outputs = {"Out": reshape_qkv}
 
     def test_check_output(self):
-        place = core.CUDAPlace(0)
-        self.check_output_with_place(place, atol=2e-3)
+        self.check_output_with_place(core.CPUPlace(), atol=2e-3)
+        if core.is_compiled_with_cuda():
+            self.check_output_with_place(core.CUDAPlace(0), atol=2e-3)
 
 
 class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
@@ -121,5 +120,14 @@ class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
         self.scale = 0.125
 
 
+class TestFusedMultiHeadMatmulOp3(TestFusedMultiheadMatmulOp):
+    def config(self):
+        self.seq_len = 7
+        self.size_per_head = 5
+        self.head_number = 3
+        self.batch_size = 2
+        self.scale = 0.5
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,54 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from paddle.fluid import core
+
+
+class TestFusedSoftmaxMaskOp(OpTest):
+    def config(self):
+        self.shape = (1, 12, 128, 128)
+        self.scale = 0.125
+
+    def setUp(self):
+        self.op_type = "fused_softmax_mask"
+        self.config()
+        x = np.random.random(self.shape).astype("float32") - 0.5
+        mask = np.random.random(self.shape).astype("float32") - 0.5
+        mask[..., -3:] = -10000.
+
+        z = x * self.scale + mask
+        exps = np.exp(z - np.max(z, axis=-1, keepdims=True))
+        out = exps / np.sum(exps, axis=-1, keepdims=True)
+
+        self.inputs = {'X': x, 'Mask': mask}
+        self.attrs = {'scale': self.scale}
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1e-5)
+
+
+class TestFusedSoftmaxMaskOpOddWidth(TestFusedSoftmaxMaskOp):
+    def config(self):
+        self.shape = (2, 3, 7, 11)
+        self.scale = 1.
+
+
+if __name__ == '__main__':
+    unittest.main()
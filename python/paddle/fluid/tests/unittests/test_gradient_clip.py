@@ -182,6 +182,21 @@ class TestGradientClipByGlobalNorm(TestGradientClip):
         self.clip_gradient = func
         self.check_gradient_clip(fluid.CPUPlace())
 
+    # test whether the ouput is right when clip by the fused op
+    def test_fused_gradient_clip(self):
+        def func(params_grads):
+            clip = fluid.clip.GradientClipByGlobalNorm(
+                clip_norm=self.clip_norm, use_fused_op=True)
+            params_grads = clip(params_grads)
+            op_types = [op.type for op in fluid.default_main_program().ops]
+            self.assertEqual(op_types.count('clip_by_global_norm'), 1)
+            self.assertNotIn('elementwise_mul', op_types)
+            return params_grads
+
+        self.clip_gradient = func
+        for place in self.get_places():
+            self.check_gradient_clip(place)
+
     # invoke 'set_gradient_clip' in a wrong order
     def test_wrong_API_order(self):
         def backward_func(cost):
@@ -399,6 +414,21 @@ class TestDygraphGradientClipByGlobalNorm(TestDygraphGradientClip):
             % (a, b))
 
 
+class TestDygraphGradientClipByGlobalNormFused(
+        TestDygraphGradientClipByGlobalNorm):
+    def setUp(self):
+        def fileter_func(param):
+            return param.name == "x"
+
+        self.clip_norm = 0.8
+        self.clip1 = fluid.clip.GradientClipByGlobalNorm(
+            clip_norm=self.clip_norm,
+            need_clip=fileter_func,
+            use_fused_op=True)
+        self.clip2 = fluid.clip.GradientClipByGlobalNorm(
+            clip_norm=self.clip_norm, use_fused_op=True)
+
+
 class TestDygraphGradientClipByNorm(TestDygraphGradientClip):
     def setUp(self):
         # only clip gradient of linear_0.w_0 (ParamBase)
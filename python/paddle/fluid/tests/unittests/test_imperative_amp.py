@@ -0,0 +1,79 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestImperativeAmp(unittest.TestCase):
+    def test_amp_guard(self):
+        data = np.random.uniform(-1, 1, [2, 3, 8, 8]).astype('float32')
+        with fluid.dygraph.guard(fluid.CUDAPlace(0)):
+            conv = fluid.dygraph.Conv2D(3, 2, 3)
+            x = fluid.dygraph.to_variable(data)
+            with fluid.dygraph.amp_guard():
+                y = conv(x)
+                # the black op runs in float32
+                loss = fluid.layers.mean(y)
+            self.assertEqual(y.dtype, core.VarDesc.VarType.FP16)
+            self.assertEqual(loss.dtype, core.VarDesc.VarType.FP32)
+            self.assertEqual(conv.weight.dtype, core.VarDesc.VarType.FP32)
+
+            ref = conv(x)
+            self.assertEqual(ref.dtype, core.VarDesc.VarType.FP32)
+            self.assertTrue(
+                np.allclose(
+                    y.numpy().astype('float32'), ref.numpy(), atol=1e-2))
+
+            loss.backward()
+            self.assertEqual(conv.weight.gradient().dtype, np.float32)
+
+    def test_scaler_skips_inf(self):
+        with fluid.dygraph.guard(fluid.CUDAPlace(0)):
+            linear = fluid.dygraph.Linear(4, 4)
+            sgd = fluid.optimizer.SGD(learning_rate=0.1,
+                                      parameter_list=linear.parameters())
+            scaler = fluid.dygraph.AmpScaler(
+                init_loss_scaling=1024., decr_every_n_nan_or_inf=1)
+            weight = linear.weight.numpy()
+
+            x = fluid.dygraph.to_variable(
+                np.array([[np.inf] * 4] * 2).astype('float32'))
+            with fluid.dygraph.amp_guard():
+                loss = fluid.layers.mean(linear(x))
+            scaled = scaler.scale(loss)
+            scaled.backward()
+            self.assertTrue(scaler.minimize(sgd, scaled))
+            linear.clear_gradients()
+            self.assertTrue(np.array_equal(linear.weight.numpy(), weight))
+            self.assertEqual(scaler.loss_scaling, 512.)
+
+            x = fluid.dygraph.to_variable(np.ones([2, 4]).astype('float32'))
+            with fluid.dygraph.amp_guard():
+                loss = fluid.layers.mean(linear(x))
+            scaled = scaler.scale(loss)
+            scaled.backward()
+            self.assertFalse(scaler.minimize(sgd, scaled))
+            self.assertFalse(np.array_equal(linear.weight.numpy(), weight))
+
+
+if __name__ == '__main__':
+    unittest.main()
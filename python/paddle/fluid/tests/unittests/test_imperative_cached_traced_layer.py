@@ -0,0 +1,62 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+from paddle.fluid.dygraph import Linear, to_variable, CachedTracedLayer
+
+
+class SimpleNet(fluid.dygraph.Layer):
+    def __init__(self):
+        super(SimpleNet, self).__init__()
+        self._fc1 = Linear(3, 8, act='relu')
+        self._fc2 = Linear(8, 4)
+
+    def forward(self, x):
+        hidden = self._fc1(x)
+        return self._fc2(hidden), hidden
+
+
+class TestCachedTracedLayer(unittest.TestCase):
+    def test_replay(self):
+        with fluid.dygraph.guard(fluid.CPUPlace()):
+            net = SimpleNet()
+            cached_net = CachedTracedLayer(net)
+            for batch_size in [2, 2, 5, 2, 5]:
+                x = to_variable(
+                    np.random.random([batch_size, 3]).astype('float32'))
+                outs = cached_net(x)
+                expected = net(x)
+                self.assertEqual(len(outs), 2)
+                for out, exp in zip(outs, expected):
+                    self.assertTrue(
+                        np.allclose(out.numpy(), exp.numpy(), atol=1e-6))
+            # one program per batch size
+            self.assertEqual(cached_net._cache.size(), 2)
+
+            # the replays see the updated parameters
+            weight = net._fc2.weight
+            weight.set_value(np.ones(weight.shape).astype('float32'))
+            x = to_variable(np.random.random([2, 3]).astype('float32'))
+            out, _ = cached_net(x)
+            expected, _ = net(x)
+            self.assertTrue(
+                np.allclose(out.numpy(), expected.numpy(), atol=1e-6))
+
+
+if __name__ == '__main__':
+    unittest.main()
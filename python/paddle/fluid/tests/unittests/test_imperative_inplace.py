@@ -0,0 +1,69 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+from paddle.fluid import core
+from paddle.fluid.dygraph import to_variable
+
+
+class TestImperativeInplace(unittest.TestCase):
+    def setUp(self):
+        self.x_np = np.random.uniform(-1, 1, [4, 6]).astype('float32')
+
+    def test_inplace_unary(self):
+        with fluid.dygraph.guard():
+            x = to_variable(self.x_np)
+            y = x.relu_()
+            self.assertTrue(y is x)
+            self.assertTrue(np.allclose(x.numpy(), np.maximum(self.x_np, 0)))
+            x.scale_(scale=2.0, bias=1.0)
+            self.assertTrue(
+                np.allclose(x.numpy(), np.maximum(self.x_np, 0) * 2 + 1))
+
+    def test_view(self):
+        with fluid.dygraph.guard():
+            x = to_variable(self.x_np)
+            view = fluid.layers.reshape(x, [6, 4])
+            x.scale_(scale=2.0)
+            self.assertTrue(
+                np.allclose(view.numpy(), self.x_np.reshape([6, 4]) * 2))
+
+    def test_modified_saved_variable(self):
+        with fluid.dygraph.guard():
+            x = to_variable(self.x_np)
+            w = to_variable(self.x_np)
+            w.stop_gradient = False
+            loss = fluid.layers.reduce_sum(fluid.layers.elementwise_mul(x, w))
+            # the gradient of w needs the old value of x
+            x.exp_()
+            with self.assertRaises(core.EnforceNotMet):
+                loss.backward()
+
+    def test_variable_requiring_grad(self):
+        with fluid.dygraph.guard():
+            w = to_variable(self.x_np)
+            w.stop_gradient = False
+            with self.assertRaises(core.EnforceNotMet):
+                w.tanh_()
+            with fluid.dygraph.no_grad():
+                w.tanh_()
+            self.assertTrue(np.allclose(w.numpy(), np.tanh(self.x_np)))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,79 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import json
+import os
+import tempfile
+import unittest
+import numpy as np
+
+import paddle.fluid as fluid
+from paddle.fluid.dygraph import profiler
+
+
+class TestImperativeOpProfiler(unittest.TestCase):
+    def run_model(self):
+        linear = fluid.dygraph.Linear(4, 4)
+        x = fluid.dygraph.to_variable(
+            np.random.random([2, 4]).astype('float32'))
+        loss = fluid.layers.mean(linear(x))
+        loss.backward()
+        return linear
+
+    def test_records(self):
+        with fluid.dygraph.guard():
+            with profiler.op_profiler(summary=False):
+                linear = self.run_model()
+            records = profiler.op_profiler_records()
+            forward_layers = set(r['layer'] for r in records
+                                 if not r['backward'])
+            self.assertIn(linear.full_name(), forward_layers)
+            backward_types = set(r['type'] for r in records if r['backward'])
+            self.assertIn('matmul_grad', backward_types)
+            for r in records:
+                if r['layer'] == linear.full_name() and r['type'] == 'matmul':
+                    self.assertEqual(r['output_bytes'], 2 * 4 * 4)
+            self.assertIn('matmul_grad (backward)',
+                          profiler.op_profiler_summary())
+
+            # not recorded once stopped
+            num_records = len(records)
+            self.run_model()
+            self.assertEqual(len(profiler.op_profiler_records()), num_records)
+
+    def test_ring_buffer(self):
+        with fluid.dygraph.guard():
+            profiler.start_op_profiler(capacity=3)
+            self.run_model()
+            profiler.stop_op_profiler()
+            records = profiler.op_profiler_records()
+            self.assertEqual(len(records), 3)
+            # the latest ops are kept
+            self.assertTrue(records[-1]['backward'])
+
+    def test_chrome_trace(self):
+        path = os.path.join(tempfile.mkdtemp(), 'ops.json')
+        with fluid.dygraph.guard():
+            with profiler.op_profiler(summary=False, chrome_trace_path=path):
+                self.run_model()
+        with open(path) as f:
+            events = json.load(f)['traceEvents']
+        self.assertEqual(len(events), len(profiler.op_profiler_records()))
+        self.assertEqual(set(e['ph'] for e in events), set(['X']))
+
+
+if __name__ == '__main__':
+    unittest.main()
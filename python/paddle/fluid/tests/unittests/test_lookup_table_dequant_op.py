@@ -51,5 +51,98 @@ class TestLookupTableDequantOp(OpTest):
         self.check_output()
 
 
+def round_half_away(x):
+    return np.sign(x) * np.floor(np.abs(x) + np.float32(0.5))
+
+
+def quantize_table(table, quant_type):
+    rows = []
+    for row in table:
+        if quant_type == "fp16":
+            rows.append(row.astype("float16").view("float32"))
+            continue
+        max_abs = np.abs(row).max()
+        if quant_type == "int8":
+            scale = np.float32(max_abs / np.float32(127.))
+            q = round_half_away(row * (np.float32(1.) / scale)).astype("int8")
+            packed = q.view("float32")
+        else:
+            scale = np.float32(max_abs / np.float32(7.))
+            q = round_half_away(row * (np.float32(1.) / scale)) + 8
+            q = q.astype("uint8")
+            packed = (q[0::2] | (q[1::2] << 4)).view("float32")
+        rows.append(np.concatenate([[scale], packed]).astype("float32"))
+    return np.asarray(rows)
+
+
+def dequantize_rows(rows, quant_type):
+    output = []
+    for row in rows:
+        if quant_type == "fp16":
+            output.append(row.view("float16").astype("float32"))
+        elif quant_type == "int8":
+            output.append(row[0] * row[1:].view("int8").astype("float32"))
+        else:
+            b = row[1:].view("uint8")
+            q = np.stack([b & 0xF, b >> 4], axis=1).flatten()
+            output.append(row[0] * (q.astype("float32") - 8))
+    return np.asarray(output, dtype="float32")
+
+
+class TestLookupTableQuantOp(OpTest):
+    def setUp(self):
+        self.op_type = "lookup_table_quant"
+        self.init_quant_type()
+        table = np.random.uniform(-1, 1, (17, 32)).astype("float32")
+        self.inputs = {'W': table}
+        self.attrs = {'quant_type': self.quant_type}
+        self.outputs = {'Out': quantize_table(table, self.quant_type)}
+
+    def init_quant_type(self):
+        self.quant_type = "int8"
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace())
+
+
+class TestLookupTableQuantOpFP16(TestLookupTableQuantOp):
+    def init_quant_type(self):
+        self.quant_type = "fp16"
+
+
+class TestLookupTableQuantOpInt4(TestLookupTableQuantOp):
+    def init_quant_type(self):
+        self.quant_type = "int4"
+
+
+class TestLookupTableDequantOpInt8(OpTest):
+    def setUp(self):
+        self.op_type = "lookup_table_dequant"
+        self.init_quant_type()
+        table = np.random.uniform(-1, 1, (17, 32)).astype("float32")
+        quantized = quantize_table(table, self.quant_type)
+        ids = np.random.randint(0, 17, 6).astype("int64")
+        self.inputs = {'W': quantized, 'Ids': np.expand_dims(ids, axis=1)}
+        self.attrs = {'quant_type': self.quant_type}
+        output = dequantize_rows(quantized[ids], self.quant_type)
+        self.outputs = {'Out': output}
+
+    def init_quant_type(self):
+        self.quant_type = "int8"
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestLookupTableDequantOpFP16(TestLookupTableDequantOpInt8):
+    def init_quant_type(self):
+        self.quant_type = "fp16"
+
+
+class TestLookupTableDequantOpInt4(TestLookupTableDequantOpInt8):
+    def init_quant_type(self):
+        self.quant_type = "int4"
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,88 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+import unittest
+
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestRuntimeAccumulation(unittest.TestCase):
+    def build_program(self):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[8], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='float32')
+            hidden = fluid.layers.fc(
+                input=x,
+                size=16,
+                act='relu',
+                param_attr=fluid.ParamAttr(name='fc_0.w'),
+                bias_attr=fluid.ParamAttr(name='fc_0.b'))
+            pred = fluid.layers.fc(input=hidden,
+                                   size=1,
+                                   param_attr=fluid.ParamAttr(name='fc_1.w'),
+                                   bias_attr=fluid.ParamAttr(name='fc_1.b'))
+            loss = fluid.layers.mean(
+                fluid.layers.square_error_cost(
+                    input=pred, label=y))
+            fluid.optimizer.Momentum(
+                learning_rate=0.1, momentum=0.9).minimize(loss)
+        return main_program, startup_program, loss
+
+    def run_program(self, num_repeats, batches):
+        main_program, startup_program, loss = self.build_program()
+        build_strategy = fluid.BuildStrategy()
+        if num_repeats > 1:
+            pass_builder = build_strategy._finalize_strategy_and_create_passes()
+            merge_pass = pass_builder.insert_pass(0, "multi_batch_merge_pass")
+            merge_pass.set("num_repeats", num_repeats)
+            merge_pass.set("runtime_accumulation", True)
+        compiled = fluid.CompiledProgram(main_program).with_data_parallel(
+            loss_name=loss.name, build_strategy=build_strategy)
+
+        place = fluid.CPUPlace()
+        exe = fluid.Executor(place)
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            for x, y in batches:
+                exe.run(compiled, feed={'x': x, 'y': y}, fetch_list=[loss])
+            return np.array(scope.find_var('fc_0.w').get_tensor())
+
+    def test_runtime_accumulation(self):
+        os.environ['CPU_NUM'] = str(1)
+        np.random.seed(10)
+        xs = np.random.random((4, 8, 8)).astype('float32')
+        ys = np.random.random((4, 8, 1)).astype('float32')
+        large_batches = [(xs[i], ys[i]) for i in range(4)]
+        small_batches = []
+        for x, y in large_batches:
+            small_batches.append((x[:4], y[:4]))
+            small_batches.append((x[4:], y[4:]))
+
+        expected = self.run_program(1, large_batches)
+        actual = self.run_program(2, small_batches)
+        self.assertTrue(np.allclose(expected, actual, atol=1e-5))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,141 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_adam_op import adam_step
+
+
+class TestMultiTensorAdamOp(OpTest):
+    def setUp(self):
+        self.op_type = "multi_tensor_adam"
+        self.dtype = np.float32
+        self.init_dtype()
+        # The tensors are smaller and larger than one chunk.
+        shapes = [(10, 20), (1, ), (102, 105), (3, 4, 5)]
+
+        learning_rate = np.array([0.004]).astype(self.dtype)
+        beta1 = 0.78
+        beta2 = 0.836
+        epsilon = 1e-4
+        self.attrs = {'epsilon': epsilon, 'beta1': beta1, 'beta2': beta2}
+
+        self.inputs = {'LearningRate': learning_rate}
+        self.outputs = {}
+        names = [
+            'Param', 'Grad', 'Moment1', 'Moment2', 'Beta1Pow', 'Beta2Pow'
+        ]
+        out_names = [
+            'ParamOut', 'Moment1Out', 'Moment2Out', 'Beta1PowOut',
+            'Beta2PowOut'
+        ]
+        for name in names:
+            self.inputs[name] = []
+        for name in out_names:
+            self.outputs[name] = []
+
+        for i, shape in enumerate(shapes):
+            inputs = {
+                'Param': np.random.uniform(-1, 1, shape).astype(self.dtype),
+                'Grad': np.random.uniform(-1, 1, shape).astype(self.dtype),
+                'Moment1': np.random.uniform(-1, 1, shape).astype(self.dtype),
+                # The second moment is positive
+                'Moment2': np.random.random(shape).astype(self.dtype),
+                'LearningRate': learning_rate,
+                'Beta1Pow': np.array([beta1**(i + 1)]).astype(self.dtype),
+                'Beta2Pow': np.array([beta2**(i + 1)]).astype(self.dtype)
+            }
+            param_out, moment1_out, moment2_out = adam_step(inputs,
+                                                            self.attrs)
+            outputs = {
+                'ParamOut': param_out,
+                'Moment1Out': moment1_out,
+                'Moment2Out': moment2_out,
+                'Beta1PowOut': inputs['Beta1Pow'] * beta1,
+                'Beta2PowOut': inputs['Beta2Pow'] * beta2
+            }
+            for name in names:
+                self.inputs[name].append((name.lower() + str(i),
+                                          inputs[name]))
+            for name in out_names:
+                self.outputs[name].append((name.lower() + str(i),
+                                           outputs[name]))
+
+    def init_dtype(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestMultiTensorAdamOpFP64(TestMultiTensorAdamOp):
+    def init_dtype(self):
+        self.dtype = np.float64
+
+
+class TestMultiTensorMomentumOp(OpTest):
+    def setUp(self):
+        self.op_type = "multi_tensor_momentum"
+        self.dtype = np.float32
+        self.use_nesterov = False
+        self.init_config()
+        shapes = [(123, 321), (7, ), (16, 16)]
+
+        learning_rate = np.array([0.001]).astype(self.dtype)
+        mu = 0.0001
+        self.attrs = {'mu': mu, 'use_nesterov': self.use_nesterov}
+
+        self.inputs = {
+            'Param': [],
+            'Grad': [],
+            'Velocity': [],
+            'LearningRate': learning_rate
+        }
+        self.outputs = {'ParamOut': [], 'VelocityOut': []}
+        for i, shape in enumerate(shapes):
+            param = np.random.random(shape).astype(self.dtype)
+            grad = np.random.random(shape).astype(self.dtype)
+            velocity = np.random.random(shape).astype(self.dtype)
+
+            velocity_out = mu * velocity + grad
+            if self.use_nesterov:
+                param_out = param - grad * learning_rate - \
+                            velocity_out * mu * learning_rate
+            else:
+                param_out = param - learning_rate * velocity_out
+
+            self.inputs['Param'].append(('param' + str(i), param))
+            self.inputs['Grad'].append(('grad' + str(i), grad))
+            self.inputs['Velocity'].append(('velocity' + str(i), velocity))
+            self.outputs['ParamOut'].append(('param_out' + str(i), param_out))
+            self.outputs['VelocityOut'].append(('velocity_out' + str(i),
+                                                velocity_out))
+
+    def init_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestMultiTensorMomentumOpNesterov(TestMultiTensorMomentumOp):
+    def init_config(self):
+        self.use_nesterov = True
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -225,6 +225,18 @@ class TestNearestNeighborInterpDataLayout(TestNearestInterpOp):
         self.data_layout = "NHWC"
 
 
+class TestNearestNeighborInterpDataLayoutUpsample(TestNearestInterpOp):
+    def init_test_case(self):
+        self.interp_method = 'nearest'
+        self.input_shape = [2, 4, 5, 4]
+        self.out_h = 8
+        self.out_w = 10
+        self.scale = 0.
+        self.out_size = None
+        self.align_corners = False
+        self.data_layout = "NHWC"
+
+
 class TestNearestInterpOpUint8(OpTest):
     def setUp(self):
         self.out_size = None
@@ -0,0 +1,81 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import paddle.fluid as fluid
+import numpy as np
+import os
+
+
+class TestShardOptimizerStates(unittest.TestCase):
+    def run_program(self, use_cuda, shard_optimizer_states):
+        place = fluid.CUDAPlace(0) if use_cuda else fluid.CPUPlace()
+        if not use_cuda:
+            os.environ['CPU_NUM'] = str(2)
+
+        main = fluid.Program()
+        startup = fluid.Program()
+        main.random_seed = 1
+        startup.random_seed = 1
+        with fluid.program_guard(main, startup):
+            x = fluid.layers.data(name='X', shape=[4], dtype='float32')
+            y = fluid.layers.data(name='Y', shape=[1], dtype='float32')
+            hidden = fluid.layers.fc(input=x, size=16, act='relu')
+            hidden = fluid.layers.fc(input=hidden, size=8, act='relu')
+            pred = fluid.layers.fc(input=hidden, size=1)
+            loss = fluid.layers.mean(
+                fluid.layers.square_error_cost(
+                    input=pred, label=y))
+            fluid.optimizer.Adam(learning_rate=0.01).minimize(loss)
+
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            exe = fluid.Executor(place)
+            exe.run(startup)
+
+            build_strategy = fluid.BuildStrategy()
+            build_strategy.reduce_strategy = \
+                fluid.BuildStrategy.ReduceStrategy.Reduce
+            build_strategy.shard_optimizer_states = shard_optimizer_states
+            binary = fluid.CompiledProgram(main).with_data_parallel(
+                loss_name=loss.name, build_strategy=build_strategy)
+
+            np.random.seed(10)
+            losses = []
+            for _ in range(10):
+                feed = {
+                    'X': np.random.random((8, 4)).astype('float32'),
+                    'Y': np.random.random((8, 1)).astype('float32')
+                }
+                loss_v, = exe.run(binary, feed=feed, fetch_list=[loss.name])
+                losses.append(np.array(loss_v).mean())
+        return losses
+
+    def check_shard_optimizer_states(self, use_cuda):
+        expected = self.run_program(use_cuda, False)
+        actual = self.run_program(use_cuda, True)
+        self.assertTrue(np.allclose(expected, actual, rtol=1e-4))
+
+    def test_cpu(self):
+        self.check_shard_optimizer_states(use_cuda=False)
+
+    def test_gpu(self):
+        if fluid.core.is_compiled_with_cuda():
+            self.check_shard_optimizer_states(use_cuda=True)
+
+
+if __name__ == '__main__':
+    unittest.main()
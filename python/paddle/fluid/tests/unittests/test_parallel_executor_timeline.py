@@ -0,0 +1,87 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import json
+import os
+import tempfile
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+os.environ['CPU_NUM'] = str(2)
+
+
+class TestParallelExecutorTimeline(unittest.TestCase):
+    def run_and_load_timeline(self, use_experimental_executor):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[-1, 16], dtype='float32')
+            hidden = fluid.layers.fc(x, size=32, act='relu')
+            loss = fluid.layers.reduce_mean(fluid.layers.fc(hidden, size=1))
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+        exec_strategy = fluid.ExecutionStrategy()
+        exec_strategy.use_experimental_executor = use_experimental_executor
+        build_strategy = fluid.BuildStrategy()
+        build_strategy.fuse_all_reduce_ops = False
+        compiled_program = fluid.CompiledProgram(
+            main_program).with_data_parallel(
+                loss_name=loss.name,
+                build_strategy=build_strategy,
+                exec_strategy=exec_strategy)
+
+        fd, fname = tempfile.mkstemp(suffix='.json')
+        os.close(fd)
+        os.remove(fname)
+        fluid.set_flags({
+            'FLAGS_pe_timeline_fname': fname,
+            'FLAGS_pe_timeline_step': 1
+        })
+        try:
+            exe = fluid.Executor(fluid.CPUPlace())
+            with fluid.scope_guard(fluid.Scope()):
+                exe.run(startup_program)
+                for _ in range(3):
+                    x_np = np.random.random([8, 16]).astype('float32')
+                    exe.run(compiled_program,
+                            feed={'x': x_np},
+                            fetch_list=[loss])
+            with open(fname) as f:
+                return json.load(f)['traceEvents']
+        finally:
+            fluid.set_flags({'FLAGS_pe_timeline_fname': ''})
+            if os.path.exists(fname):
+                os.remove(fname)
+
+    def check(self, use_experimental_executor):
+        events = self.run_and_load_timeline(use_experimental_executor)
+        names = set(e['name'] for e in events)
+        self.assertIn('all_reduce', names)
+        self.assertIn('Fetch', names)
+        for e in events:
+            self.assertGreaterEqual(e['dur'], 0)
+            self.assertGreaterEqual(e['args']['wait_us'], 0)
+            self.assertLessEqual(e['args']['ready_us'], e['ts'])
+
+    def test_threaded_executor(self):
+        self.check(False)
+
+    def test_fast_threaded_executor(self):
+        self.check(True)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -248,6 +248,93 @@ class TestPipeline(unittest.TestCase):
         self.single_section(True)
         self.single_section(False)
 
+    def test_pipeline_1f1b(self):
+        program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(program, startup_program):
+            x = fluid.layers.data(
+                name='x', shape=[1], dtype='int64', lod_level=0)
+            y = fluid.layers.data(
+                name='y', shape=[1], dtype='int64', lod_level=0)
+            emb_x = layers.embedding(
+                input=x,
+                param_attr=fluid.ParamAttr(name="embx"),
+                size=[10, 2],
+                is_sparse=False)
+            emb_y = layers.embedding(
+                input=y,
+                param_attr=fluid.ParamAttr(name="emby"),
+                size=[10, 2],
+                is_sparse=False)
+            concat = layers.concat([emb_x, emb_y], axis=1)
+            fc = layers.fc(input=concat,
+                           name="fc",
+                           size=1,
+                           num_flatten_dims=1,
+                           bias_attr=False)
+            loss = layers.reduce_mean(fc)
+
+            optimizer = fluid.optimizer.SGD(learning_rate=0.5)
+            optimizer = fluid.optimizer.PipelineOptimizer(
+                optimizer,
+                cut_list=[[emb_x, emb_y], [loss]],
+                place_list=[
+                    fluid.CPUPlace(), fluid.CUDAPlace(0), fluid.CPUPlace()
+                ],
+                concurrency_list=[1, 1, 1],
+                queue_size=4,
+                sync_steps=-1,
+                schedule_mode="1F1B",
+                num_microbatches=2)
+            optimizer.minimize(loss)
+            self.assertEqual(program._pipeline_opt["schedule_mode"], "1F1B")
+            self.assertEqual(program._pipeline_opt["num_microbatches"], 2)
+
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(startup_program)
+            batch_size = 10
+
+            def binary_print(slot, fout):
+                num = np.int16(len(slot) + 1)
+                num.tofile(fout)
+                a = np.int64(batch_size)
+                a.tofile(fout)
+                slot.tofile(fout)
+
+            batch = np.ones(
+                (batch_size, 2, 1)).astype("int64").reshape(batch_size, 2, 1)
+            filelist = ["test_pipeline_1f1b_input_0"]
+            for f in filelist:
+                with open(f, "wb") as fout:
+                    for _ in range(4):
+                        for ins in batch:
+                            for slot in ins:
+                                binary_print(slot, fout)
+
+            dataset = fluid.DatasetFactory().create_dataset(
+                "FileInstantDataset")
+            dataset.set_use_var([x, y])
+            dataset.set_batch_size(batch_size)
+            dataset.set_filelist(filelist)
+            exe.train_from_dataset(
+                program,
+                dataset,
+                thread=1,
+                debug=False,
+                fetch_list=[],
+                fetch_info=[],
+                print_period=1)
+
+            for f in filelist:
+                os.remove(f)
+
+    def test_pipeline_invalid_schedule_mode(self):
+        optimizer = fluid.optimizer.SGD(learning_rate=0.5)
+        with self.assertRaises(ValueError):
+            fluid.optimizer.PipelineOptimizer(optimizer, schedule_mode="GPipe")
+        with self.assertRaises(ValueError):
+            fluid.optimizer.PipelineOptimizer(optimizer, num_microbatches=0)
+
 
 if __name__ == '__main__':
     unittest.main()
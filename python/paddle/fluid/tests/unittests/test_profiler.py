@@ -185,6 +185,68 @@ class TestProfiler(unittest.TestCase):
             #self.net_profiler('All', "AllOpDetail", use_parallel_executor=True)
 
 
+class TestSampledProfiler(unittest.TestCase):
+    def test_sampled_steps(self):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[None, 16], dtype='float32')
+            out = fluid.layers.fc(input=x, size=8)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+
+        profile_path = os.path.join(tempfile.gettempdir(), "sampled_profile")
+        open(profile_path, "w").write("")
+        profiler.start_sampled_profiler(
+            step_interval=2, flush_interval=4, profile_path=profile_path)
+        self.assertTrue(core._is_sampled_profiler_enabled())
+        for _ in range(10):
+            exe.run(main_program,
+                    feed={'x': np.random.random((4, 16)).astype('float32')},
+                    fetch_list=[out])
+        profiler.stop_sampled_profiler()
+        self.assertFalse(core._is_sampled_profiler_enabled())
+
+        calls = {}
+        for line in open(profile_path).readlines():
+            step, name, num, total, min_ms, max_ms = line.split('\t')
+            self.assertIn(int(step), [4, 8, 10])
+            calls[name] = calls.get(name, 0) + int(num)
+        # the steps 0, 2, 4, 6 and 8 are sampled
+        self.assertEqual(calls['mul'], 5)
+
+        with self.assertRaises(Exception):
+            profiler.start_sampled_profiler(step_interval=0)
+
+
+class TestMemoryProfiler(unittest.TestCase):
+    def test_peak(self):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[None, 64], dtype='float32')
+            hidden = fluid.layers.fc(input=x, size=1024)
+            out = fluid.layers.fc(input=hidden, size=8)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+
+        profiler.start_memory_profiler()
+        exe.run(main_program,
+                feed={'x': np.random.random((256, 64)).astype('float32')},
+                fetch_list=[out])
+        report = profiler.stop_memory_profiler()
+        self.assertIn('mul', report)
+
+        peaks = core._memory_profiler_peaks()
+        self.assertEqual(len(peaks), 1)
+        names = [tensor['name'] for tensor in peaks[0]['tensors']]
+        self.assertIn(hidden.name, names)
+        for tensor in peaks[0]['tensors']:
+            if tensor['name'] == hidden.name:
+                self.assertEqual(tensor['shape'], [256, 1024])
+                self.assertGreaterEqual(tensor['bytes'], 256 * 1024 * 4)
+
+
 class TestProfilerAPIError(unittest.TestCase):
     def test_errors(self):
         options = utils.ProfilerOptions()
@@ -0,0 +1,62 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from paddle.fluid import core
+
+
+class TestSkipLayerNormOp(OpTest):
+    def config(self):
+        self.shape = (2, 16, 768)
+        self.begin_norm_axis = 2
+        self.epsilon = 1e-5
+
+    def setUp(self):
+        self.op_type = "skip_layernorm"
+        self.config()
+        right = int(np.prod(self.shape[self.begin_norm_axis:]))
+        x = np.random.random(self.shape).astype("float32") - 0.5
+        y = np.random.random(self.shape).astype("float32") - 0.5
+        scale = np.random.random((right, )).astype("float32")
+        bias = np.random.random((right, )).astype("float32")
+
+        z = (x + y).reshape((-1, right))
+        mean = np.mean(z, axis=1, keepdims=True)
+        var = np.var(z, axis=1, keepdims=True)
+        out = (z - mean) / np.sqrt(var + self.epsilon) * scale + bias
+
+        self.inputs = {'X': x, 'Y': y, 'Scale': scale, 'Bias': bias}
+        self.attrs = {
+            'epsilon': self.epsilon,
+            'begin_norm_axis': self.begin_norm_axis
+        }
+        self.outputs = {'Out': out.reshape(self.shape)}
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1e-4)
+
+
+class TestSkipLayerNormOpOddWidth(TestSkipLayerNormOp):
+    def config(self):
+        self.shape = (3, 5, 7, 13)
+        self.begin_norm_axis = 2
+        self.epsilon = 1e-5
+
+
+if __name__ == '__main__':
+    unittest.main()
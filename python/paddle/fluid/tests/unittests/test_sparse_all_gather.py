@@ -0,0 +1,71 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestSparseAllGather(unittest.TestCase):
+    def train(self, use_sparse_all_gather):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            ids = fluid.data(name='ids', shape=[-1, 1], dtype='int64')
+            label = fluid.data(name='label', shape=[-1, 1], dtype='float32')
+            emb = fluid.embedding(ids, size=[100, 16], is_sparse=True)
+            hidden = fluid.layers.fc(emb, size=16, act='relu')
+            predict = fluid.layers.fc(hidden, size=1)
+            loss = fluid.layers.reduce_mean(
+                fluid.layers.square_error_cost(predict, label))
+            fluid.optimizer.SGD(learning_rate=0.1).minimize(loss)
+
+        build_strategy = fluid.BuildStrategy()
+        build_strategy.use_sparse_all_gather = use_sparse_all_gather
+        self.assertEqual(build_strategy.use_sparse_all_gather,
+                         use_sparse_all_gather)
+        compiled_program = fluid.CompiledProgram(
+            main_program).with_data_parallel(
+                loss_name=loss.name, build_strategy=build_strategy)
+
+        exe = fluid.Executor(fluid.CUDAPlace(0))
+        np.random.seed(1)
+        losses = []
+        with fluid.scope_guard(fluid.Scope()):
+            exe.run(startup_program)
+            for _ in range(5):
+                # Many duplicated ids, so the rows are merged.
+                ids_np = np.random.randint(0, 10, [32, 1]).astype('int64')
+                label_np = np.random.random([32, 1]).astype('float32')
+                loss_np, = exe.run(compiled_program,
+                                   feed={'ids': ids_np,
+                                         'label': label_np},
+                                   fetch_list=[loss])
+                losses.append(np.mean(loss_np))
+        return losses
+
+    def test_main(self):
+        if not core.is_compiled_with_cuda():
+            return
+        expected = self.train(False)
+        losses = self.train(True)
+        self.assertTrue(np.allclose(losses, expected, rtol=1e-5))
+
+
+if __name__ == '__main__':
+    unittest.main()
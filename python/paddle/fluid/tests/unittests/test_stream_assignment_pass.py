@@ -0,0 +1,84 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+
+def multi_tower_net(x, y, num_towers=4):
+    towers = []
+    for i in range(num_towers):
+        hidden = fluid.layers.fc(input=x, size=64, act='relu')
+        hidden = fluid.layers.fc(input=hidden, size=32, act='tanh')
+        towers.append(hidden)
+    concat = fluid.layers.concat(towers, axis=1)
+    prediction = fluid.layers.fc(input=concat, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=y)
+    return fluid.layers.mean(loss)
+
+
+class TestStreamAssignmentPass(unittest.TestCase):
+    def run_program(self, num_streams, iters=5, batch_size=16):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[32], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            loss = multi_tower_net(x, y)
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+        build_strategy = fluid.BuildStrategy()
+        build_strategy.num_streams = num_streams
+        binary = fluid.CompiledProgram(main_program).with_data_parallel(
+            loss_name=loss.name,
+            build_strategy=build_strategy,
+            places=[fluid.CUDAPlace(0)])
+
+        rng = np.random.RandomState(0)
+        exe = fluid.Executor(fluid.CUDAPlace(0))
+        losses = []
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            for _ in range(iters):
+                feed = {
+                    'x': rng.random_sample((batch_size, 32)).astype('float32'),
+                    'y': rng.randint(0, 10, (batch_size, 1)).astype('int64')
+                }
+                loss_v, = exe.run(binary, feed=feed, fetch_list=[loss])
+                losses.append(loss_v[0])
+        return losses
+
+    def test_multi_stream(self):
+        if not fluid.core.is_compiled_with_cuda():
+            return
+        single_stream_losses = self.run_program(num_streams=1)
+        multi_stream_losses = self.run_program(num_streams=4)
+        for single, multi in zip(single_stream_losses, multi_stream_losses):
+            self.assertAlmostEqual(single, multi, delta=1e-5)
+
+    def test_num_streams(self):
+        build_strategy = fluid.BuildStrategy()
+        self.assertEqual(build_strategy.num_streams, 1)
+        build_strategy.num_streams = 2
+        self.assertEqual(build_strategy.num_streams, 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
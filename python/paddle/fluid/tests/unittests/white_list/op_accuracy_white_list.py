@@ -31,6 +31,7 @@ NO_FP64_CHECK_GRAD_OP_LIST = [
     'depthwise_conv2d', \
     'depthwise_conv2d_transpose', \
     'dropout', \
+    'fake_quantize_dequantize_moving_average_abs_max', \
     'fused_elemwise_activation', \
     'hinge_loss', \
     'huber_loss', \
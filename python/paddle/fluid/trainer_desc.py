@@ -123,6 +123,12 @@ class TrainerDesc(object):
     def _set_thread_barrier(self, thread_barrier):
         self.proto_desc.thread_barrier = thread_barrier
 
+    def _set_compute_thread_cpus(self, cpus):
+        self.proto_desc.compute_thread_cpus = cpus
+
+    def _set_comm_thread_cpus(self, cpus):
+        self.proto_desc.comm_thread_cpus = cpus
+
     def _set_check_nan_var_names(self, check_nan_var_names):
         for var in check_nan_var_names:
             self.proto_desc.check_nan_var_names.append(var)
@@ -131,6 +137,10 @@ class TrainerDesc(object):
         for loss in loss_names:
             self.proto_desc.loss_names.append(loss)
 
+    def _set_pipeline_pull_sparse(self, pipeline_pull_sparse=False):
+        self.proto_desc.downpour_param.pipeline_pull_sparse = \
+                pipeline_pull_sparse
+
     def _set_adjust_ins_weight(self, config_dict):
         self.proto_desc.adjust_ins_weight_config.need_adjust = \
                 config_dict.get("need_adjust", False)
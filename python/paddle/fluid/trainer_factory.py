@@ -80,6 +80,11 @@ class TrainerFactory(object):
                 if opt_info.get("random_with_lineid") is not None:
                     trainer._set_random_with_lineid(opt_info[
                         "random_with_lineid"])
+                if opt_info.get("compute_thread_cpus") is not None:
+                    trainer._set_compute_thread_cpus(opt_info[
+                        "compute_thread_cpus"])
+                if opt_info.get("comm_thread_cpus") is not None:
+                    trainer._set_comm_thread_cpus(opt_info["comm_thread_cpus"])
 
             if "fleet_desc" in opt_info:
                 device_worker._set_fleet_desc(opt_info["fleet_desc"])
@@ -100,6 +105,9 @@ class TrainerFactory(object):
                         "check_nan_var_names"])
                 if opt_info.get("loss_names") is not None:
                     trainer._set_loss_names(opt_info["loss_names"])
+                if opt_info.get("pipeline_pull_sparse") is not None:
+                    trainer._set_pipeline_pull_sparse(opt_info[
+                        "pipeline_pull_sparse"])
             trainer._set_device_worker(device_worker)
         return trainer
 
@@ -209,7 +209,11 @@ class GradAllReduce(Collective):
     def _insert_allreduce_ops(self):
         block = self.main_program.global_block()
         ring_id = -1
-        grad = None
+        # the ring of each allreduced grad. c_allreduce_sum waits for its
+        # producer by a CUDA event, and the ops reading the grad wait for
+        # the allreduce by c_sync_comm_stream, so the communication overlaps
+        # the rest of the backward
+        grad_rings = collections.OrderedDict()
         for idx, op in reversed(list(enumerate(block.ops))):
             if self._is_backward_op(op) and \
                     self.op_role_var_key in op.attr_names:
@@ -219,28 +223,17 @@ class GradAllReduce(Collective):
                     continue
                 assert len(op_role_var) % 2 == 0
 
-                offset = idx
                 for i in range(0, len(op_role_var), 2):
                     param = block.vars[op_role_var[i]]
                     grad = block.vars[op_role_var[i + 1]]
                     if param.is_distributed:
                         continue
 
-                    if offset == idx:
-                        offset += 1
-                        block._insert_op(
-                            offset,
-                            type='c_sync_calc_stream',
-                            inputs={'X': grad},
-                            outputs={'Out': grad},
-                            attrs={self.op_role_key: OpRole.Backward})
-                        offset += 1
-
                     # As we search ops reversedly, we should insert c_allreduce_sum
                     # op in the same way to keep the ring_id alternate
                     ring_id = (ring_id + 1) % self.nrings
                     block._insert_op(
-                        offset,
+                        idx + 1,
                         type='c_allreduce_sum',
                         inputs={'X': grad},
                         outputs={'Out': grad},
@@ -248,23 +241,45 @@ class GradAllReduce(Collective):
                             'ring_id': ring_id,
                             self.op_role_key: OpRole.Backward
                         })
+                    grad_rings[grad.name] = ring_id
 
-        if grad is None:
+        if len(grad_rings) == 0:
             return
 
-        for idx, op in enumerate(block.ops):
+        idx = 0
+        while idx < len(block.ops):
+            op = block.ops[idx]
             if self._is_optimizer_op(op):
-                for ring_id in range(self.nrings):
-                    block._insert_op(
-                        idx + ring_id,
-                        type='c_sync_comm_stream',
-                        inputs={'X': grad},
-                        outputs={'Out': grad},
-                        attrs={
-                            'ring_id': ring_id,
-                            self.op_role_key: OpRole.Backward
-                        })
-                break
+                grads = [
+                    name for name in grad_rings
+                    if name in op.input_arg_names
+                ]
+                idx += self._insert_sync_comm_ops(idx, grads, grad_rings)
+            idx += 1
+        # the grads which are not read by the optimizer still must be
+        # allreduced before the next step
+        self._insert_sync_comm_ops(
+            len(block.ops), list(grad_rings.keys()), grad_rings)
+
+    def _insert_sync_comm_ops(self, idx, grads, grad_rings):
+        block = self.main_program.global_block()
+        rings = sorted(set(grad_rings[name] for name in grads))
+        for ring_id in rings:
+            ring_grads = [name for name in grads if grad_rings[name] == ring_id]
+            block._insert_op(
+                idx,
+                type='c_sync_comm_stream',
+                inputs={'X': ring_grads},
+                outputs={'Out': ring_grads},
+                attrs={
+                    'ring_id': ring_id,
+                    'wait_vars_only': True,
+                    self.op_role_key: OpRole.Backward
+                })
+            idx += 1
+        for name in grads:
+            del grad_rings[name]
+        return len(rings)
 
 
 class LocalSGD(Collective):
@@ -324,15 +339,9 @@ class LocalSGD(Collective):
                             'Y': [param]},
                     outputs={'Out': [param]},
                     attrs={self.op_role_key: OpRole.Optimize})
-                block._insert_op(
-                    idx + 2,
-                    type='c_sync_calc_stream',
-                    inputs={'X': param},
-                    outputs={'Out': param},
-                    attrs={self.op_role_key: OpRole.Optimize})
                 ring_id = (ring_id + 1) % self.nrings
                 block._insert_op(
-                    idx + 3,
+                    idx + 2,
                     type='c_allreduce_sum',
                     inputs={'X': [param]},
                     outputs={'Out': [param]},
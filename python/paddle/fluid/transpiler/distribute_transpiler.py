@@ -168,6 +168,13 @@ class DistributeTranspilerConfig(object):
           https://github.com/PaddlePaddle/Paddle/blob/develop/python/paddle/fluid/transpiler/distribute_transpiler.py
           .
 
+    .. py:attribute:: async_prefetch (bool)
+
+          Whether the remote lookups of the distributed embedding tables are
+          asynchronous, default is False. If True, the lookup requests are
+          sent right after the ids are produced, and the ops which do not
+          depend on the embeddings run while the requests are in flight.
+
     Examples:
         .. code-block:: python
 
@@ -196,6 +203,9 @@ class DistributeTranspilerConfig(object):
     half_async = False
     completely_not_async = False
 
+    # overlap the remote lookups of the embedding tables with other ops
+    async_prefetch = False
+
     # Geo-sgd algorithm
     geo_sgd_mode = False
     geo_sgd_need_push_nums = 100
@@ -525,8 +535,18 @@ class DistributeTranspiler(object):
                             "height_sections": height_sections,
                             "endpoints": endpoints,
                             "padding_idx": padding_idx,
-                            "trainer_id": self.trainer_id
+                            "trainer_id": self.trainer_id,
+                            "async_prefetch": self.config.async_prefetch
                         })
+                    if self.config.async_prefetch:
+                        # wait right before the first op reading the
+                        # embeddings, which moves down by one after the
+                        # insertion above
+                        program.global_block()._insert_op(
+                            index=min(outputs_idxs) + 1,
+                            type="distributed_lookup_table_wait",
+                            inputs={"X": outputs},
+                            outputs={"Out": outputs})
                 else:
                     raise ValueError(
                         "something wrong with distribute_transpiler, submit a issue is recommended"